@@ -49,6 +49,13 @@ const char* ArrowParms::OPEN_ON_COMPLETE    = "open_on_complete";
 const char* ArrowParms::ASSET               = "asset";
 const char* ArrowParms::REGION              = "region";
 const char* ArrowParms::CREDENTIALS         = "credentials";
+const char* ArrowParms::ROW_GROUP_SIZE      = "row_group_size";
+const char* ArrowParms::STREAMING           = "streaming";
+const char* ArrowParms::COMPRESSION         = "compression";
+const char* ArrowParms::DICTIONARY          = "dictionary";
+const char* ArrowParms::PARALLEL            = "parallel";
+const char* ArrowParms::SPATIAL_SORT        = "spatial_sort";
+const char* ArrowParms::COLUMNS             = "columns";
 
 const char* ArrowParms::OBJECT_TYPE = "ArrowParms";
 const char* ArrowParms::LuaMetaName = "ArrowParms";
@@ -57,6 +64,7 @@ const struct luaL_Reg ArrowParms::LuaMetaTable[] = {
     {"isfeather",   luaIsFeather},
     {"isparquet",   luaIsParquet},
     {"iscsv",       luaIsCSV},
+    {"isarrow",     luaIsArrow},
     {"path",        luaPath},
     {NULL,          NULL}
 };
@@ -97,7 +105,13 @@ ArrowParms::ArrowParms (lua_State* L, int index):
     format              (NATIVE),
     open_on_complete    (false),
     asset_name          (NULL),
-    region              (NULL)
+    region              (NULL),
+    row_group_size      (DEFAULT_ROW_GROUP_SIZE),
+    streaming           (false),
+    compression         (GZIP),
+    dictionary          (true),
+    parallel            (true),
+    spatial_sort        (0)
 {
     fromLua(L, index);
 }
@@ -150,6 +164,54 @@ void ArrowParms::fromLua (lua_State* L, int index)
             if(field_provided) mlog(DEBUG, "Setting %s to %s", ASSET, asset_name);
             lua_pop(L, 1);
 
+            /* Row Group Size */
+            lua_getfield(L, index, ROW_GROUP_SIZE);
+            row_group_size = LuaObject::getLuaInteger(L, -1, true, row_group_size, &field_provided);
+            if(row_group_size <= 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid %s: %ld", ROW_GROUP_SIZE, row_group_size);
+            if(field_provided) mlog(DEBUG, "Setting %s to %ld", ROW_GROUP_SIZE, row_group_size);
+            lua_pop(L, 1);
+
+            /* Streaming */
+            lua_getfield(L, index, STREAMING);
+            streaming = LuaObject::getLuaBoolean(L, -1, true, streaming, &field_provided);
+            if(field_provided) mlog(DEBUG, "Setting %s to %d", STREAMING, (int)streaming);
+            lua_pop(L, 1);
+
+            /* Compression */
+            lua_getfield(L, index, COMPRESSION);
+            const char* compression_str = LuaObject::getLuaString(L, -1, true, NULL, &field_provided);
+            if(field_provided)
+            {
+                compression = str2compression(compression_str);
+                if(compression == INVALID_COMPRESSION) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid %s: %s", COMPRESSION, compression_str);
+                mlog(DEBUG, "Setting %s to %s", COMPRESSION, compression_str);
+            }
+            lua_pop(L, 1);
+
+            /* Dictionary Encoding */
+            lua_getfield(L, index, DICTIONARY);
+            dictionary = LuaObject::getLuaBoolean(L, -1, true, dictionary, &field_provided);
+            if(field_provided) mlog(DEBUG, "Setting %s to %d", DICTIONARY, (int)dictionary);
+            lua_pop(L, 1);
+
+            /* Parallel Column Writing */
+            lua_getfield(L, index, PARALLEL);
+            parallel = LuaObject::getLuaBoolean(L, -1, true, parallel, &field_provided);
+            if(field_provided) mlog(DEBUG, "Setting %s to %d", PARALLEL, (int)parallel);
+            lua_pop(L, 1);
+
+            /* Spatial Sort */
+            lua_getfield(L, index, SPATIAL_SORT);
+            spatial_sort = LuaObject::getLuaInteger(L, -1, true, spatial_sort, &field_provided);
+            if(spatial_sort < 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid %s: %ld", SPATIAL_SORT, spatial_sort);
+            if(field_provided) mlog(DEBUG, "Setting %s to %ld", SPATIAL_SORT, spatial_sort);
+            lua_pop(L, 1);
+
+            /* Per Column Options (inherit the settings above) */
+            lua_getfield(L, index, COLUMNS);
+            if(lua_istable(L, -1)) columnsFromLua(L, lua_gettop(L));
+            lua_pop(L, 1);
+
             #ifdef __aws__
             /* Region */
             lua_getfield(L, index, REGION);
@@ -214,6 +276,8 @@ void ArrowParms::cleanup (void)
         delete [] region;
         region = NULL;
     }
+
+    columns.clear();
 }
 
 /*----------------------------------------------------------------------------
@@ -226,9 +290,65 @@ ArrowParms::format_t ArrowParms::str2outputformat (const char* fmt_str)
     else if(StringLib::match(fmt_str, "feather"))   return FEATHER;
     else if(StringLib::match(fmt_str, "parquet"))   return PARQUET;
     else if(StringLib::match(fmt_str, "csv"))       return CSV;
+    else if(StringLib::match(fmt_str, "arrow"))     return ARROW;
     else                                            return UNSUPPORTED;
 }
 
+/*----------------------------------------------------------------------------
+ * str2compression
+ *----------------------------------------------------------------------------*/
+ArrowParms::compression_t ArrowParms::str2compression (const char* str)
+{
+    if     (!str)                               return INVALID_COMPRESSION;
+    else if(StringLib::match(str, "gzip"))      return GZIP;
+    else if(StringLib::match(str, "zstd"))      return ZSTD;
+    else if(StringLib::match(str, "lz4"))       return LZ4;
+    else if(StringLib::match(str, "snappy"))    return SNAPPY;
+    else if(StringLib::match(str, "none"))      return UNCOMPRESSED;
+    else                                        return INVALID_COMPRESSION;
+}
+
+/*----------------------------------------------------------------------------
+ * columnsFromLua
+ *
+ *  { <column name> = { compression = <codec>, dictionary = <bool> }, ... }
+ *----------------------------------------------------------------------------*/
+void ArrowParms::columnsFromLua (lua_State* L, int index)
+{
+    lua_pushnil(L); // first key
+    while(lua_next(L, index) != 0)
+    {
+        bool field_provided = false;
+        const char* column_name = LuaObject::getLuaString(L, -2);
+        column_parms_t column = {compression, dictionary};
+
+        if(lua_istable(L, -1))
+        {
+            lua_getfield(L, -1, COMPRESSION);
+            const char* compression_str = LuaObject::getLuaString(L, -1, true, NULL, &field_provided);
+            if(field_provided)
+            {
+                column.compression = str2compression(compression_str);
+                if(column.compression == INVALID_COMPRESSION) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid %s for column %s: %s", COMPRESSION, column_name, compression_str);
+            }
+            lua_pop(L, 1);
+
+            lua_getfield(L, -1, DICTIONARY);
+            column.dictionary = LuaObject::getLuaBoolean(L, -1, true, column.dictionary, &field_provided);
+            lua_pop(L, 1);
+        }
+        else
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Options for column %s must be supplied as a lua table", column_name);
+        }
+
+        columns.add(column_name, column);
+        mlog(DEBUG, "Setting %s for column %s to %d, %d", COLUMNS, column_name, (int)column.compression, (int)column.dictionary);
+
+        lua_pop(L, 1); // remove value, keep key for next iteration
+    }
+}
+
 /*----------------------------------------------------------------------------
  * luaIsNative
  *----------------------------------------------------------------------------*/
@@ -293,6 +413,22 @@ int ArrowParms::luaIsCSV (lua_State* L)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * luaIsArrow
+ *----------------------------------------------------------------------------*/
+int ArrowParms::luaIsArrow (lua_State* L)
+{
+    try
+    {
+        ArrowParms* lua_obj = (ArrowParms*)getLuaSelf(L, 1);
+        return returnLuaStatus(L, lua_obj->format == ARROW);
+    }
+    catch(const RunTimeException& e)
+    {
+        return luaL_error(L, "method invoked from invalid object: %s", __FUNCTION__);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * luaPath
  *----------------------------------------------------------------------------*/
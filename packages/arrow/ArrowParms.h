@@ -47,6 +47,7 @@
 #include "OsApi.h"
 #include "LuaObject.h"
 #include "Asset.h"
+#include "Dictionary.h"
 
 #ifdef __aws__
 #include "aws.h"
@@ -68,9 +69,24 @@ class ArrowParms: public LuaObject
             FEATHER = 1,
             PARQUET = 2,
             CSV = 3,
-            UNSUPPORTED = 4
+            ARROW = 4, // ipc stream
+            UNSUPPORTED = 5
         } format_t;
 
+        typedef enum {
+            GZIP = 0,
+            ZSTD = 1,
+            LZ4 = 2,
+            SNAPPY = 3,
+            UNCOMPRESSED = 4,
+            INVALID_COMPRESSION = 5
+        } compression_t;
+
+        typedef struct {
+            compression_t   compression;
+            bool            dictionary;
+        } column_parms_t;
+
         /*--------------------------------------------------------------------
         * Constants
         *--------------------------------------------------------------------*/
@@ -82,6 +98,15 @@ class ArrowParms: public LuaObject
         static const char* ASSET;
         static const char* REGION;
         static const char* CREDENTIALS;
+        static const char* ROW_GROUP_SIZE;
+        static const char* STREAMING;
+        static const char* COMPRESSION;
+        static const char* DICTIONARY;
+        static const char* PARALLEL;
+        static const char* SPATIAL_SORT;
+        static const char* COLUMNS;
+
+        static const long DEFAULT_ROW_GROUP_SIZE = 262144; // rows
 
         static const char* OBJECT_TYPE;
         static const char* LuaMetaName;
@@ -96,6 +121,13 @@ class ArrowParms: public LuaObject
         bool            open_on_complete;               // flag to client to open file on completion
         const char*     asset_name;
         const char*     region;
+        long            row_group_size;                 // number of rows accumulated into each parquet row group
+        bool            streaming;                      // stream file to client as it is written (size not known up front)
+        compression_t   compression;                    // codec used for columns not listed in columns
+        bool            dictionary;                     // dictionary encoding for columns not listed in columns
+        bool            parallel;                       // encode and compress the columns of a row group in parallel
+        long            spatial_sort;                   // rows of geoparquet output buffered and sorted along a hilbert curve, 0 to disable
+        Dictionary<column_parms_t> columns;             // per column overrides of compression and dictionary, keyed by column name
 
         #ifdef __aws__
         CredentialStore::Credential credentials;
@@ -118,10 +150,13 @@ class ArrowParms: public LuaObject
 
         void        cleanup             (void);
         format_t    str2outputformat    (const char* fmt_str);
+        static compression_t str2compression (const char* str);
+        void        columnsFromLua      (lua_State* L, int index);
         static int  luaIsNative         (lua_State* L);
         static int  luaIsFeather        (lua_State* L);
         static int  luaIsParquet        (lua_State* L);
         static int  luaIsCSV            (lua_State* L);
+        static int  luaIsArrow          (lua_State* L);
         static int  luaPath             (lua_State* L);
 };
 
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/table.h>
+#include <arrow/io/file.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/reader.h>
+#include <parquet/arrow/reader.h>
+
+#include "core.h"
+#include "CoordinateReader.h"
+
+#ifdef __aws__
+#include "aws.h"
+#endif
+
+using std::shared_ptr;
+using std::vector;
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* CoordinateReader::DEFAULT_LON_COLUMN = "lon";
+const char* CoordinateReader::DEFAULT_LAT_COLUMN = "lat";
+const char* CoordinateReader::GEOMETRY_COLUMN = "geometry";
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * readColumn
+ *
+ *  returns NULL when the file has no column of that name
+ *----------------------------------------------------------------------------*/
+static shared_ptr<arrow::ChunkedArray> readColumn (parquet::arrow::FileReader* parquet_reader, shared_ptr<arrow::Table> table, const char* name)
+{
+    shared_ptr<arrow::ChunkedArray> column;
+
+    if(parquet_reader)
+    {
+        /* Read Only the Requested Column of the Parquet File */
+        shared_ptr<arrow::Schema> schema;
+        if(!parquet_reader->GetSchema(&schema).ok()) return column;
+        int index = schema->GetFieldIndex(name);
+        if(index < 0) return column;
+        arrow::Status status = parquet_reader->ReadColumn(index, &column);
+        if(!status.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read column %s: %s", name, status.ToString().c_str());
+    }
+    else
+    {
+        column = table->GetColumnByName(name);
+    }
+
+    return column;
+}
+
+/*----------------------------------------------------------------------------
+ * copyValues
+ *
+ *  copies a floating point column into dst, nulls become NaN
+ *----------------------------------------------------------------------------*/
+static void copyValues (const shared_ptr<arrow::ChunkedArray>& column, double* dst)
+{
+    int64_t i = 0;
+    for(const shared_ptr<arrow::Array>& chunk: column->chunks())
+    {
+        int64_t length = chunk->length();
+        switch(chunk->type_id())
+        {
+            case arrow::Type::DOUBLE:
+            {
+                const double* values = std::static_pointer_cast<arrow::DoubleArray>(chunk)->raw_values();
+                LocalLib::copy(&dst[i], values, length * sizeof(double));
+                break;
+            }
+            case arrow::Type::FLOAT:
+            {
+                const float* values = std::static_pointer_cast<arrow::FloatArray>(chunk)->raw_values();
+                for(int64_t j = 0; j < length; j++) dst[i + j] = values[j];
+                break;
+            }
+            default:
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported coordinate type: %s", chunk->type()->ToString().c_str());
+            }
+        }
+
+        if(chunk->null_count() > 0)
+        {
+            for(int64_t j = 0; j < length; j++)
+            {
+                if(chunk->IsNull(j)) dst[i + j] = NAN;
+            }
+        }
+
+        i += length;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * copyPoints
+ *
+ *  copies the coordinates of a column of WKB points, anything that is not a
+ *  point becomes NaN
+ *----------------------------------------------------------------------------*/
+static void copyPoints (const shared_ptr<arrow::ChunkedArray>& column, double* lons, double* lats)
+{
+    const int WKB_POINT_SIZE = 21; // byte order, type, x, y
+
+    int64_t i = 0;
+    for(const shared_ptr<arrow::Array>& chunk: column->chunks())
+    {
+        if(chunk->type_id() != arrow::Type::BINARY)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported geometry type: %s", chunk->type()->ToString().c_str());
+        }
+
+        const arrow::BinaryArray* wkb = static_cast<const arrow::BinaryArray*>(chunk.get());
+        for(int64_t j = 0; j < wkb->length(); j++, i++)
+        {
+            int32_t size = 0;
+            const uint8_t* point = wkb->GetValue(j, &size);
+            uint32_t type = 0;
+            bool swap = false;
+            if(!wkb->IsNull(j) && size >= WKB_POINT_SIZE)
+            {
+                #ifdef __be__
+                swap = (point[0] == 1);
+                #else
+                swap = (point[0] == 0);
+                #endif
+                LocalLib::copy(&type, &point[1], sizeof(type));
+                if(swap) type = LocalLib::swapl(type);
+            }
+
+            if(type == 1)
+            {
+                uint64_t x, y;
+                LocalLib::copy(&x, &point[5], sizeof(x));
+                LocalLib::copy(&y, &point[13], sizeof(y));
+                if(swap)
+                {
+                    x = LocalLib::swapll(x);
+                    y = LocalLib::swapll(y);
+                }
+                LocalLib::copy(&lons[i], &x, sizeof(double));
+                LocalLib::copy(&lats[i], &y, sizeof(double));
+            }
+            else
+            {
+                lons[i] = NAN;
+                lats[i] = NAN;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * luaRead - coordinates(<path>, [<lon column>], [<lat column>], [<region>], [<asset>]) -> points, num_points
+ *
+ *  path is a local file or s3://<bucket>/<key>; the points are returned as
+ *  one string of native doubles holding all of the longitudes followed by
+ *  all of the latitudes, which raster:samples accepts in place of a table
+ *----------------------------------------------------------------------------*/
+int CoordinateReader::luaRead (lua_State* L)
+{
+    bool status = false;
+    int num_rets = 1;
+    uint8_t* object_data = NULL;
+
+    try
+    {
+        /* Get Parameters */
+        const char* path        = LuaObject::getLuaString(L, 1);
+        const char* lon_column  = LuaObject::getLuaString(L, 2, true, DEFAULT_LON_COLUMN);
+        const char* lat_column  = LuaObject::getLuaString(L, 3, true, DEFAULT_LAT_COLUMN);
+        const char* region      = LuaObject::getLuaString(L, 4, true, NULL);
+        const char* asset_name  = LuaObject::getLuaString(L, 5, true, NULL);
+
+        /* Open Input */
+        shared_ptr<arrow::io::RandomAccessFile> input;
+        if((StringLib::size(path) > 5) && (StringLib::find(path, "s3://", 5) == path))
+        {
+            #ifdef __aws__
+            /* Get Bucket and Key */
+            char* bucket = StringLib::duplicate(&path[5]);
+            char* key = bucket;
+            while(*key != '\0' && *key != '/') key++;
+            if(*key != '/')
+            {
+                delete [] bucket;
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid S3 url: %s", path);
+            }
+            *key = '\0';
+            key++;
+
+            /* Read Whole Object into Memory */
+            CredentialStore::Credential credentials = CredentialStore::get(asset_name ? asset_name : S3CurlIODriver::DEFAULT_ASSET_NAME);
+            int64_t size = S3CurlIODriver::get(&object_data, bucket, key, region ? region : S3CurlIODriver::DEFAULT_REGION, &credentials);
+            delete [] bucket;
+            if(!object_data) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read %s", path);
+            input = std::make_shared<arrow::io::BufferReader>(std::make_shared<arrow::Buffer>(object_data, size));
+            #else
+            (void)region;
+            (void)asset_name;
+            throw RunTimeException(CRITICAL, RTE_ERROR, "path specifies S3, but server not compiled with AWS support: %s", path);
+            #endif
+        }
+        else
+        {
+            arrow::Result<shared_ptr<arrow::io::ReadableFile>> result = arrow::io::ReadableFile::Open(path);
+            if(!result.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open %s: %s", path, result.status().ToString().c_str());
+            input = result.ValueOrDie();
+        }
+
+        /* Determine Format from Leading Magic */
+        char magic[6] = {0};
+        arrow::Result<int64_t> magic_result = input->ReadAt(0, sizeof(magic), magic);
+        if(!magic_result.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read %s: %s", path, magic_result.status().ToString().c_str());
+
+        std::unique_ptr<parquet::arrow::FileReader> parquet_reader;
+        shared_ptr<arrow::Table> table;
+        if(memcmp(magic, "PAR1", 4) == 0)
+        {
+            /* Parquet File */
+            parquet::arrow::FileReaderBuilder builder;
+            arrow::Status open_status = builder.Open(input);
+            if(open_status.ok()) open_status = builder.Build(&parquet_reader);
+            if(!open_status.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open parquet file %s: %s", path, open_status.ToString().c_str());
+        }
+        else if(memcmp(magic, "ARROW1", 6) == 0)
+        {
+            /* Arrow IPC File */
+            arrow::Result<shared_ptr<arrow::ipc::RecordBatchFileReader>> reader = arrow::ipc::RecordBatchFileReader::Open(input);
+            if(!reader.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open arrow file %s: %s", path, reader.status().ToString().c_str());
+            vector<shared_ptr<arrow::RecordBatch>> batches;
+            for(int b = 0; b < reader.ValueOrDie()->num_record_batches(); b++)
+            {
+                arrow::Result<shared_ptr<arrow::RecordBatch>> batch = reader.ValueOrDie()->ReadRecordBatch(b);
+                if(!batch.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read arrow file %s: %s", path, batch.status().ToString().c_str());
+                batches.push_back(batch.ValueOrDie());
+            }
+            arrow::Result<shared_ptr<arrow::Table>> result = arrow::Table::FromRecordBatches(reader.ValueOrDie()->schema(), batches);
+            if(!result.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read arrow file %s: %s", path, result.status().ToString().c_str());
+            table = result.ValueOrDie();
+        }
+        else
+        {
+            /* Arrow IPC Stream */
+            arrow::Result<shared_ptr<arrow::ipc::RecordBatchStreamReader>> reader = arrow::ipc::RecordBatchStreamReader::Open(input);
+            if(!reader.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open arrow stream %s: %s", path, reader.status().ToString().c_str());
+            arrow::Result<shared_ptr<arrow::Table>> result = reader.ValueOrDie()->ToTable();
+            if(!result.ok()) throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read arrow stream %s: %s", path, result.status().ToString().c_str());
+            table = result.ValueOrDie();
+        }
+
+        /* Get Coordinate Columns */
+        shared_ptr<arrow::ChunkedArray> lons = readColumn(parquet_reader.get(), table, lon_column);
+        shared_ptr<arrow::ChunkedArray> lats = readColumn(parquet_reader.get(), table, lat_column);
+        shared_ptr<arrow::ChunkedArray> geometry;
+        if(!lons || !lats)
+        {
+            geometry = readColumn(parquet_reader.get(), table, GEOMETRY_COLUMN);
+            if(!geometry) throw RunTimeException(CRITICAL, RTE_ERROR, "no %s/%s or %s columns in %s", lon_column, lat_column, GEOMETRY_COLUMN, path);
+        }
+        else if(lons->length() != lats->length())
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "mismatched coordinate columns in %s: %ld != %ld", path, (long)lons->length(), (long)lats->length());
+        }
+
+        /* Copy Coordinates Straight into Lua String */
+        int64_t num_points = geometry ? geometry->length() : lons->length();
+        size_t size = num_points * 2 * sizeof(double);
+        luaL_Buffer lua_buffer;
+        double* points = (double*)luaL_buffinitsize(L, &lua_buffer, size);
+        if(geometry)
+        {
+            copyPoints(geometry, points, &points[num_points]);
+        }
+        else
+        {
+            copyValues(lons, points);
+            copyValues(lats, &points[num_points]);
+        }
+        luaL_pushresultsize(&lua_buffer, size);
+        lua_pushinteger(L, num_points);
+
+        mlog(DEBUG, "Read %ld coordinates from %s", (long)num_points, path);
+        num_rets += 2;
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error reading coordinates: %s", e.what());
+    }
+
+    /* Clean Up */
+    delete [] object_data;
+
+    /* Return Results */
+    lua_pushboolean(L, status);
+    return num_rets;
+}
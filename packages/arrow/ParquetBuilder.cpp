@@ -34,9 +34,11 @@
  ******************************************************************************/
 
 #include <iostream>
+#include <algorithm>
 #include <arrow/builder.h>
 #include <arrow/table.h>
 #include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
 #include <arrow/util/key_value_metadata.h>
 #include <parquet/arrow/writer.h>
 #include <parquet/arrow/schema.h>
@@ -56,6 +58,257 @@ using std::unique_ptr;
 using std::make_shared;
 using std::vector;
 
+/******************************************************************************
+ * OUTPUT STREAMS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * PublisherOutputStream
+ *
+ *  writes the parquet file directly into the response queue as arrowrec.data
+ *  records; since the size of the file is not known until it is closed, an
+ *  arrowrec.meta record with a size of -1 is sent ahead of the first data
+ *  record, and a second arrowrec.meta record with the actual size is sent
+ *  once the file is closed
+ *----------------------------------------------------------------------------*/
+class PublisherOutputStream: public arrow::io::OutputStream
+{
+    public:
+
+        PublisherOutputStream (Publisher* _outq, const char* _filename):
+            outQ(_outq),
+            dataRecord(ParquetBuilder::dataRecType, 0, false),
+            bufferSize(0),
+            position(0),
+            metaSent(false),
+            isClosed(false)
+        {
+            data = (ParquetBuilder::arrow_file_data_t*)dataRecord.getRecordData();
+            StringLib::copy(&fileName[0], _filename, ParquetBuilder::FILE_NAME_MAX_LEN);
+            StringLib::copy(&data->filename[0], _filename, ParquetBuilder::FILE_NAME_MAX_LEN);
+        }
+
+        ~PublisherOutputStream (void) override
+        {
+            (void)Close();
+        }
+
+        arrow::Status Close (void) override
+        {
+            if(isClosed) return closeStatus;
+            isClosed = true;
+            closeStatus = postData();
+            if(closeStatus.ok()) closeStatus = postMeta(position);
+            return closeStatus;
+        }
+
+        bool closed (void) const override
+        {
+            return isClosed;
+        }
+
+        arrow::Result<int64_t> Tell (void) const override
+        {
+            return position;
+        }
+
+        arrow::Status Write (const void* buffer, int64_t nbytes) override
+        {
+            if(isClosed) return arrow::Status::IOError("write to closed stream: ", fileName);
+            const uint8_t* src = (const uint8_t*)buffer;
+            while(nbytes > 0)
+            {
+                int64_t bytes_to_copy = MIN(nbytes, ParquetBuilder::FILE_BUFFER_RSPS_SIZE - bufferSize);
+                LocalLib::copy(&data->data[bufferSize], src, bytes_to_copy);
+                bufferSize += bytes_to_copy;
+                position += bytes_to_copy;
+                src += bytes_to_copy;
+                nbytes -= bytes_to_copy;
+                if(bufferSize == ParquetBuilder::FILE_BUFFER_RSPS_SIZE)
+                {
+                    ARROW_RETURN_NOT_OK(postData());
+                }
+            }
+            return arrow::Status::OK();
+        }
+
+        arrow::Status Flush (void) override
+        {
+            if(isClosed) return arrow::Status::OK();
+            return postData();
+        }
+
+    private:
+
+        arrow::Status postMeta (long size)
+        {
+            RecordObject meta_record(ParquetBuilder::metaRecType);
+            ParquetBuilder::arrow_file_meta_t* meta = (ParquetBuilder::arrow_file_meta_t*)meta_record.getRecordData();
+            StringLib::copy(&meta->filename[0], fileName, ParquetBuilder::FILE_NAME_MAX_LEN);
+            meta->size = size;
+            if(!meta_record.post(outQ)) return arrow::Status::IOError("failed to post meta record for ", fileName);
+            return arrow::Status::OK();
+        }
+
+        arrow::Status postData (void)
+        {
+            if(!metaSent)
+            {
+                ARROW_RETURN_NOT_OK(postMeta(-1));
+                metaSent = true;
+            }
+            if(bufferSize > 0)
+            {
+                if(!dataRecord.post(outQ, offsetof(ParquetBuilder::arrow_file_data_t, data) + bufferSize))
+                {
+                    return arrow::Status::IOError("failed to post data record for ", fileName);
+                }
+                bufferSize = 0;
+            }
+            return arrow::Status::OK();
+        }
+
+        Publisher*                          outQ;
+        char                                fileName[ParquetBuilder::FILE_NAME_MAX_LEN];
+        RecordObject                        dataRecord; // reused for every data record posted
+        ParquetBuilder::arrow_file_data_t*  data;
+        int64_t                             bufferSize;
+        int64_t                             position;
+        bool                                metaSent;
+        bool                                isClosed;
+        arrow::Status                       closeStatus;
+};
+
+#ifdef __aws__
+/*----------------------------------------------------------------------------
+ * S3OutputStream
+ *
+ *  writes the parquet file directly to S3 as a multipart upload; each part
+ *  is handed off to upload in the background as soon as it fills, so the
+ *  file uploads while it is still being written; the upload is completed
+ *  when the stream is closed and aborted if the stream is destroyed before
+ *----------------------------------------------------------------------------*/
+class S3OutputStream: public arrow::io::OutputStream
+{
+    public:
+
+        S3OutputStream (const char* _bucket, const char* _key, const char* _region, CredentialStore::Credential* _credentials):
+            bucket(StringLib::duplicate(_bucket)),
+            key(StringLib::duplicate(_key)),
+            upload(_bucket, _key, _region, _credentials, S3CurlIODriver::getUploadConcurrency()),
+            partSize(S3CurlIODriver::getPartSize()),
+            buffer(NULL),
+            bufferSize(0),
+            numParts(0),
+            position(0),
+            isClosed(false)
+        {
+            assert(partSize >= S3CurlIODriver::MIN_PART_SIZE);
+        }
+
+        const char* getBucket (void) const
+        {
+            return bucket;
+        }
+
+        const char* getKey (void) const
+        {
+            return key;
+        }
+
+        ~S3OutputStream (void) override
+        {
+            delete [] buffer;
+            delete [] bucket;
+            delete [] key;
+        }
+
+        arrow::Status Close (void) override
+        {
+            if(isClosed) return closeStatus;
+            isClosed = true;
+            closeStatus = uploadBuffer(); // last part may be smaller than the minimum
+            if(closeStatus.ok())
+            {
+                try
+                {
+                    upload.complete();
+                }
+                catch(const RunTimeException& e)
+                {
+                    closeStatus = arrow::Status::IOError(e.what());
+                }
+            }
+            return closeStatus;
+        }
+
+        bool closed (void) const override
+        {
+            return isClosed;
+        }
+
+        arrow::Result<int64_t> Tell (void) const override
+        {
+            return position;
+        }
+
+        arrow::Status Write (const void* data, int64_t nbytes) override
+        {
+            if(isClosed) return arrow::Status::IOError("write to closed stream: ", key);
+            const uint8_t* src = (const uint8_t*)data;
+            while(nbytes > 0)
+            {
+                if(!buffer) buffer = new uint8_t [partSize];
+                int64_t bytes_to_copy = MIN(nbytes, partSize - bufferSize);
+                LocalLib::copy(&buffer[bufferSize], src, bytes_to_copy);
+                bufferSize += bytes_to_copy;
+                position += bytes_to_copy;
+                src += bytes_to_copy;
+                nbytes -= bytes_to_copy;
+                if(bufferSize == partSize)
+                {
+                    ARROW_RETURN_NOT_OK(uploadBuffer());
+                }
+            }
+            return arrow::Status::OK();
+        }
+
+    private:
+
+        arrow::Status uploadBuffer (void)
+        {
+            try
+            {
+                if(bufferSize > 0 || numParts == 0) // an upload needs at least one part
+                {
+                    if(!buffer) buffer = new uint8_t [1];
+                    uint8_t* part = buffer;
+                    buffer = NULL; // ownership passes to the upload
+                    upload.uploadPart(part, bufferSize);
+                    bufferSize = 0;
+                    numParts++;
+                }
+            }
+            catch(const RunTimeException& e)
+            {
+                return arrow::Status::IOError(e.what());
+            }
+            return arrow::Status::OK();
+        }
+
+        char*                           bucket;
+        char*                           key;
+        S3Upload                        upload;
+        int64_t                         partSize;
+        uint8_t*                        buffer; // part being filled
+        int64_t                         bufferSize;
+        int                             numParts;
+        int64_t                         position;
+        bool                            isClosed;
+        arrow::Status                   closeStatus;
+};
+#endif
+
 /******************************************************************************
  * PRIVATE IMPLEMENTATION
  ******************************************************************************/
@@ -63,23 +316,168 @@ using std::vector;
 struct ParquetBuilder::impl
 {
     shared_ptr<arrow::Schema>               schema;
+    shared_ptr<arrow::io::OutputStream>     outputStream; // temporary file, response queue, or S3
     unique_ptr<parquet::arrow::FileWriter>  parquetWriter;
+    shared_ptr<arrow::ipc::RecordBatchWriter> ipcWriter; // used in place of parquetWriter for the arrow format
+    vector<unique_ptr<arrow::ArrayBuilder>> builders; // one per schema column, accumulating the current row group
+    vector<uint8_t>                         gatherBuffer; // contiguous values of one column of a record
+    vector<uint64_t>                        sortKeys; // hilbert index in upper half, row in sort buffer in lower half
 
-    static shared_ptr<arrow::Schema> defineTableSchema (field_list_t& field_list, const char* rec_type, bool as_geo);
+    static shared_ptr<arrow::Schema> defineTableSchema (field_list_t& field_list, const char* rec_type, bool as_geo, bool covering);
+    static shared_ptr<arrow::DataType> bboxType (void);
     static bool addFieldsToSchema (vector<shared_ptr<arrow::Field>>& schema_vector, field_list_t& field_list, const char* rec_type, int offset);
+    static unique_ptr<arrow::ArrayBuilder> createBuilder (RecordObject::fieldType_t type);
+    static parquet::Compression::type toCodec (ArrowParms::compression_t compression);
+    #ifdef __aws__
+    static shared_ptr<arrow::io::OutputStream> openS3Stream (const char* s3dst, ArrowParms* parms, Publisher* outq);
+    #endif
+
+    template <typename T, typename B>
+    void appendColumn (arrow::ArrayBuilder* builder, RecordObject* record, RecordObject::field_t field, int num_rows, int row_size_bytes);
 };
 
+#ifdef __aws__
+/*----------------------------------------------------------------------------
+ * openS3Stream
+ *
+ *  s3dst is <bucket>/<key>; returns NULL on an invalid path
+ *----------------------------------------------------------------------------*/
+shared_ptr<arrow::io::OutputStream> ParquetBuilder::impl::openS3Stream (const char* s3dst, ArrowParms* parms, Publisher* outq)
+{
+    shared_ptr<arrow::io::OutputStream> output_stream;
+
+    /* Get Bucket and Key */
+    char* bucket = StringLib::duplicate(s3dst);
+    char* key = bucket;
+    while(*key != '\0' && *key != '/') key++;
+    if(*key == '/')
+    {
+        *key = '\0';
+        key++;
+
+        /* Send Initial Status */
+        LuaEndpoint::generateExceptionStatus(RTE_INFO, INFO, outq, NULL, "Initiated upload of results to S3, bucket = %s, key = %s", bucket, key);
+
+        /* Create Stream */
+        output_stream = make_shared<S3OutputStream>(bucket, key, parms->region, &parms->credentials);
+    }
+    else
+    {
+        LuaEndpoint::generateExceptionStatus(RTE_ERROR, CRITICAL, outq, NULL, "Invalid S3 url: %s", s3dst);
+    }
+
+    /* Clean Up */
+    delete [] bucket;
+
+    /* Return Stream */
+    return output_stream;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * toCodec
+ *----------------------------------------------------------------------------*/
+parquet::Compression::type ParquetBuilder::impl::toCodec (ArrowParms::compression_t compression)
+{
+    switch(compression)
+    {
+        case ArrowParms::ZSTD:          return parquet::Compression::ZSTD;
+        case ArrowParms::LZ4:           return parquet::Compression::LZ4;
+        case ArrowParms::SNAPPY:        return parquet::Compression::SNAPPY;
+        case ArrowParms::UNCOMPRESSED:  return parquet::Compression::UNCOMPRESSED;
+        default:                        return parquet::Compression::GZIP;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * createBuilder
+ *
+ *  matches the column types chosen by addFieldsToSchema
+ *----------------------------------------------------------------------------*/
+unique_ptr<arrow::ArrayBuilder> ParquetBuilder::impl::createBuilder (RecordObject::fieldType_t type)
+{
+    switch(type)
+    {
+        case RecordObject::INT8:    return unique_ptr<arrow::ArrayBuilder>(new arrow::Int8Builder());
+        case RecordObject::INT16:   return unique_ptr<arrow::ArrayBuilder>(new arrow::Int16Builder());
+        case RecordObject::INT32:   return unique_ptr<arrow::ArrayBuilder>(new arrow::Int32Builder());
+        case RecordObject::INT64:   return unique_ptr<arrow::ArrayBuilder>(new arrow::Int64Builder());
+        case RecordObject::UINT8:   return unique_ptr<arrow::ArrayBuilder>(new arrow::UInt8Builder());
+        case RecordObject::UINT16:  return unique_ptr<arrow::ArrayBuilder>(new arrow::UInt16Builder());
+        case RecordObject::UINT32:  return unique_ptr<arrow::ArrayBuilder>(new arrow::UInt32Builder());
+        case RecordObject::UINT64:  return unique_ptr<arrow::ArrayBuilder>(new arrow::UInt64Builder());
+        case RecordObject::FLOAT:   return unique_ptr<arrow::ArrayBuilder>(new arrow::FloatBuilder());
+        case RecordObject::DOUBLE:  return unique_ptr<arrow::ArrayBuilder>(new arrow::DoubleBuilder());
+        case RecordObject::TIME8:   return unique_ptr<arrow::ArrayBuilder>(new arrow::Date64Builder());
+        case RecordObject::STRING:  return unique_ptr<arrow::ArrayBuilder>(new arrow::StringBuilder());
+        default:                    return unique_ptr<arrow::ArrayBuilder>(new arrow::BinaryBuilder()); // geometry
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * appendColumn
+ *
+ *  native fixed width fields are gathered from the strided rows of the
+ *  record into a contiguous buffer and appended in bulk; anything else
+ *  goes through the record accessors one value at a time
+ *----------------------------------------------------------------------------*/
+template <typename T, typename B>
+void ParquetBuilder::impl::appendColumn (arrow::ArrayBuilder* builder, RecordObject* record, RecordObject::field_t field, int num_rows, int row_size_bytes)
+{
+    B* typed_builder = static_cast<B*>(builder);
+
+    if((field.type == RecordObject::nativeType<T>()) && ((field.flags & (RecordObject::POINTER | RecordObject::BIGENDIAN)) == NATIVE_FLAGS))
+    {
+        /* Strided Gather */
+        gatherBuffer.resize(num_rows * sizeof(T));
+        T* values = (T*)gatherBuffer.data();
+        const uint8_t* src = record->getRecordData() + TOBYTES(field.offset);
+        for(int row = 0; row < num_rows; row++)
+        {
+            memcpy(&values[row], src, sizeof(T));
+            src += row_size_bytes;
+        }
+        (void)typed_builder->AppendValues(values, num_rows);
+    }
+    else
+    {
+        /* Accessor Per Value */
+        (void)typed_builder->Reserve(num_rows);
+        for(int row = 0; row < num_rows; row++)
+        {
+            typed_builder->UnsafeAppend(record->getValue<T>(field));
+            field.offset += row_size_bytes * 8;
+        }
+    }
+}
+
 /*----------------------------------------------------------------------------
  * defineTableSchema
  *----------------------------------------------------------------------------*/
-shared_ptr<arrow::Schema> ParquetBuilder::impl::defineTableSchema (field_list_t& field_list, const char* rec_type, bool as_geo)
+shared_ptr<arrow::Schema> ParquetBuilder::impl::defineTableSchema (field_list_t& field_list, const char* rec_type, bool as_geo, bool covering)
 {
     vector<shared_ptr<arrow::Field>> schema_vector;
     addFieldsToSchema(schema_vector, field_list, rec_type, 0);
     if(as_geo) schema_vector.push_back(arrow::field("geometry", arrow::binary()));
+    if(covering) schema_vector.push_back(arrow::field("bbox", bboxType()));
     return make_shared<arrow::Schema>(schema_vector);
 }
 
+/*----------------------------------------------------------------------------
+ * bboxType
+ *
+ *  GeoParquet 1.1 bbox covering of a geometry
+ *----------------------------------------------------------------------------*/
+shared_ptr<arrow::DataType> ParquetBuilder::impl::bboxType (void)
+{
+    return arrow::struct_({
+        arrow::field("xmin", arrow::float64()),
+        arrow::field("ymin", arrow::float64()),
+        arrow::field("xmax", arrow::float64()),
+        arrow::field("ymax", arrow::float64())
+    });
+}
+
 /*----------------------------------------------------------------------------
  * addFieldsToSchema
  *----------------------------------------------------------------------------*/
@@ -185,6 +583,7 @@ int ParquetBuilder::luaCreate (lua_State* L)
         /* Build Geometry Fields */
         geo_data_t geo;
         geo.as_geo = false;
+        geo.covering = false;
         if((lat_key != NULL) && (lon_key != NULL))
         {
             geo.as_geo = true;
@@ -258,26 +657,88 @@ ParquetBuilder::ParquetBuilder (lua_State* L, ArrowParms* _parms, const char* ou
 
     /* Initialize GeoParquet Option */
     geoData = geo;
+    geoData.covering = geoData.as_geo && (parms->spatial_sort > 0);
 
     /* Define Table Schema */
-    pimpl->schema = pimpl->defineTableSchema(fieldList, rec_type, geoData.as_geo);
+    pimpl->schema = pimpl->defineTableSchema(fieldList, rec_type, geoData.as_geo, geoData.covering);
     fieldIterator = new field_iterator_t(fieldList);
 
+    /* Create Column Builders */
+    for(int i = 0; i < fieldIterator->length; i++)
+    {
+        pimpl->builders.push_back(pimpl->createBuilder((*fieldIterator)[i].type));
+    }
+    if(geoData.as_geo) pimpl->builders.push_back(pimpl->createBuilder(RecordObject::INVALID_FIELD));
+    if(geoData.covering)
+    {
+        vector<shared_ptr<arrow::ArrayBuilder>> bbox_builders;
+        for(int i = 0; i < 4; i++) bbox_builders.push_back(make_shared<arrow::DoubleBuilder>());
+        pimpl->builders.push_back(unique_ptr<arrow::ArrayBuilder>(new arrow::StructBuilder(pimpl->bboxType(), arrow::default_memory_pool(), bbox_builders)));
+    }
+    numBufferedRows = 0;
+
+    /* Allocate Spatial Sort Buffers (row index must fit in lower half of sort key) */
+    sortRecord = NULL;
+    sortedRecord = NULL;
+    numSortRows = 0;
+    sortCapacity = 0;
+    if(geoData.covering && rowSizeBytes > 0)
+    {
+        sortCapacity = MIN(parms->spatial_sort, (long)(INT32_MAX / rowSizeBytes));
+        sortRecord = new RecordObject(rec_type, sortCapacity * rowSizeBytes, false);
+        sortedRecord = new RecordObject(rec_type, sortCapacity * rowSizeBytes, false);
+        pimpl->sortKeys.resize(sortCapacity);
+    }
+
     /* Create Unique Temporary Filename */
     SafeString tmp_file("%s%s.parquet", TMP_FILE_PREFIX, id);
     fileName = tmp_file.getString(true);
 
+    /* Record Batches of an IPC Stream are Always Sent as They are Written */
+    streamOutput = parms->streaming || (parms->format == ArrowParms::ARROW);
+
     /* Create Arrow Output Stream */
-    shared_ptr<arrow::io::FileOutputStream> file_output_stream;
-    PARQUET_ASSIGN_OR_THROW(file_output_stream, arrow::io::FileOutputStream::Open(fileName));
+    const char* s3dst = getS3Path(parms->path);
+    if(s3dst)
+    {
+        #ifdef __aws__
+        pimpl->outputStream = pimpl->openS3Stream(s3dst, parms, outQ);
+        #else
+        LuaEndpoint::generateExceptionStatus(RTE_ERROR, CRITICAL, outQ, NULL, "Output path specifies S3, but server not compiled with AWS support");
+        #endif
+    }
+    else if(streamOutput)
+    {
+        pimpl->outputStream = make_shared<PublisherOutputStream>(outQ, parms->path);
+    }
+    else
+    {
+        shared_ptr<arrow::io::FileOutputStream> file_output_stream;
+        PARQUET_ASSIGN_OR_THROW(file_output_stream, arrow::io::FileOutputStream::Open(fileName));
+        pimpl->outputStream = file_output_stream;
+    }
+
+    /* Early Exit on No Output Stream (leaves parquet writer unopened) */
+    if(!pimpl->outputStream) return;
 
     /* Create Writer Properties */
     parquet::WriterProperties::Builder writer_props_builder;
-    writer_props_builder.compression(parquet::Compression::GZIP);
+    writer_props_builder.compression(pimpl->toCodec(parms->compression));
+    if(parms->dictionary) writer_props_builder.enable_dictionary();
+    else writer_props_builder.disable_dictionary();
+    ArrowParms::column_parms_t column;
+    const char* column_name = parms->columns.first(&column);
+    while(column_name != NULL)
+    {
+        writer_props_builder.compression(column_name, pimpl->toCodec(column.compression));
+        if(column.dictionary) writer_props_builder.enable_dictionary(column_name);
+        else writer_props_builder.disable_dictionary(column_name);
+        column_name = parms->columns.next(&column);
+    }
     shared_ptr<parquet::WriterProperties> writer_props = writer_props_builder.build();
 
-    /* Create Arrow Writer Properties */
-    auto arrow_writer_props = parquet::ArrowWriterProperties::Builder().store_schema()->build();
+    /* Create Arrow Writer Properties (columns of a row group are encoded on arrow's cpu pool when parallel) */
+    auto arrow_writer_props = parquet::ArrowWriterProperties::Builder().store_schema()->set_use_threads(parms->parallel)->build();
 
     /* Build GeoParquet MetaData */
     if(geoData.as_geo)
@@ -289,19 +750,28 @@ ParquetBuilder::ParquetBuilder (lua_State* L, ArrowParms* _parms, const char* ou
         delete [] metadata_str;
     }
 
+    /* Create Arrow IPC Stream Writer */
+    if(parms->format == ArrowParms::ARROW)
+    {
+        arrow::Result<shared_ptr<arrow::ipc::RecordBatchWriter>> ipc_result = arrow::ipc::MakeStreamWriter(pimpl->outputStream, pimpl->schema);
+        if(ipc_result.ok()) pimpl->ipcWriter = ipc_result.ValueOrDie();
+        else mlog(CRITICAL, "Failed to open arrow ipc writer: %s", ipc_result.status().ToString().c_str());
+        return;
+    }
+
     /* Create Parquet Writer */
     #ifdef APACHE_ARROW_10_COMPAT
-        (void)parquet::arrow::FileWriter::Open(*pimpl->schema, ::arrow::default_memory_pool(), file_output_stream, writer_props, arrow_writer_props, &pimpl->parquetWriter);
+        (void)parquet::arrow::FileWriter::Open(*pimpl->schema, ::arrow::default_memory_pool(), pimpl->outputStream, writer_props, arrow_writer_props, &pimpl->parquetWriter);
     #elif 0 // alternative method of creating file writer
         std::shared_ptr<parquet::SchemaDescriptor> parquet_schema;
         (void)parquet::arrow::ToParquetSchema(pimpl->schema.get(), *writer_props, *arrow_writer_props, &parquet_schema);
         auto schema_node = std::static_pointer_cast<parquet::schema::GroupNode>(parquet_schema->schema_root());
         std::unique_ptr<parquet::ParquetFileWriter> base_writer;
-        base_writer = parquet::ParquetFileWriter::Open(std::move(file_output_stream), schema_node, std::move(writer_props), metadata);
+        base_writer = parquet::ParquetFileWriter::Open(pimpl->outputStream, schema_node, std::move(writer_props), metadata);
         auto schema_ptr = std::make_shared<::arrow::Schema>(*pimpl->schema);
         (void)parquet::arrow::FileWriter::Make(::arrow::default_memory_pool(), std::move(base_writer), std::move(schema_ptr), std::move(arrow_writer_props), &pimpl->parquetWriter);
     #else
-        arrow::Result<std::unique_ptr<parquet::arrow::FileWriter>> result = parquet::arrow::FileWriter::Open(*pimpl->schema, ::arrow::default_memory_pool(), file_output_stream, writer_props, arrow_writer_props);
+        arrow::Result<std::unique_ptr<parquet::arrow::FileWriter>> result = parquet::arrow::FileWriter::Open(*pimpl->schema, ::arrow::default_memory_pool(), pimpl->outputStream, writer_props, arrow_writer_props);
         if(result.ok()) pimpl->parquetWriter = std::move(result).ValueOrDie();
         else mlog(CRITICAL, "Failed to open parquet writer: %s", result.status().ToString().c_str());
     #endif
@@ -313,14 +783,20 @@ ParquetBuilder::ParquetBuilder (lua_State* L, ArrowParms* _parms, const char* ou
 ParquetBuilder::~ParquetBuilder(void)
 {
     parms->releaseLuaObject();
+    delete pimpl; // output streams post to outQ
     delete [] fileName;
     delete outQ;
     delete fieldIterator;
-    delete pimpl;
+    delete sortRecord;
+    delete sortedRecord;
 }
 
 /*----------------------------------------------------------------------------
  * processRecord
+ *
+ *  appends the rows of the record to the column builders (by way of the sort
+ *  buffer when spatially sorting), writing a row group each time the
+ *  configured number of rows has accumulated
  *----------------------------------------------------------------------------*/
 bool ParquetBuilder::processRecord (RecordObject* record, okey_t key)
 {
@@ -336,170 +812,145 @@ bool ParquetBuilder::processRecord (RecordObject* record, okey_t key)
         return false;
     }
 
-    /* Loop Through Fields in Schema */
-    vector<shared_ptr<arrow::Array>> columns;
-    for(int i = 0; i < fieldIterator->length; i++)
+    /* Early Exit on No Writer */
+    if(!pimpl->parquetWriter && !pimpl->ipcWriter) return true;
+
+    /* Accumulate Rows into Row Groups */
+    tableMut.lock();
     {
-        RecordObject::field_t field = (*fieldIterator)[i];
-        shared_ptr<arrow::Array> column;
+        if(sortRecord) bufferRows(record, num_rows);
+        else appendRecord(record, num_rows);
+    }
+    tableMut.unlock();
 
-        /* Loop Through Each Row */
-        switch(field.type)
-        {
-            case RecordObject::DOUBLE:
-            {
-                arrow::DoubleBuilder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((double)record->getValueReal(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+    /* Return Success */
+    return true;
+}
 
-            case RecordObject::FLOAT:
-            {
-                arrow::FloatBuilder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((float)record->getValueReal(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+/*----------------------------------------------------------------------------
+ * processTimeout
+ *----------------------------------------------------------------------------*/
+bool ParquetBuilder::processTimeout (void)
+{
+    return true;
+}
 
-            case RecordObject::INT8:
-            {
-                arrow::Int8Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((int8_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+/*----------------------------------------------------------------------------
+ * processTermination
+ *
+ *  Note that RecordDispatcher will only call this once
+ *----------------------------------------------------------------------------*/
+bool ParquetBuilder::processTermination (void)
+{
+    /* Early Exit on No Writer */
+    if(!pimpl->parquetWriter && !pimpl->ipcWriter) return false;
 
-            case RecordObject::INT16:
-            {
-                arrow::Int16Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((int16_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+    /* Write Remaining Rows */
+    tableMut.lock();
+    {
+        if(sortRecord) sortRows();
+        writeRowGroup();
+    }
+    tableMut.unlock();
 
-            case RecordObject::INT32:
-            {
-                arrow::Int32Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((int32_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+    /* Close Writer (ipc writer ends the stream with its end-of-stream marker) */
+    if(pimpl->ipcWriter) (void)pimpl->ipcWriter->Close();
+    else (void)pimpl->parquetWriter->Close();
 
-            case RecordObject::INT64:
-            {
-                arrow::Int64Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((int64_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+    /* Send File to User */
+    const char* s3dst = getS3Path(parms->path);
+    if(s3dst)
+    {
+        /* Complete Upload */
+        return send2S3(s3dst);
+    }
+    else if(streamOutput)
+    {
+        /* Flush Remaining Data and Final Meta Record */
+        arrow::Status status = pimpl->outputStream->Close();
+        if(!status.ok()) mlog(CRITICAL, "Failed to stream parquet file %s: %s", parms->path, status.ToString().c_str());
+        return status.ok();
+    }
+    else
+    {
+        /* Stream Back to Client */
+        return send2Client();
+    }
+}
 
-            case RecordObject::UINT8:
-            {
-                arrow::UInt8Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((uint8_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+/*----------------------------------------------------------------------------
+ * appendRecord
+ *
+ *  appends the first num_rows rows of the record, writing a row group each
+ *  time the configured number of rows has accumulated; must be called with
+ *  tableMut locked
+ *----------------------------------------------------------------------------*/
+void ParquetBuilder::appendRecord (RecordObject* record, int num_rows)
+{
+    int row = 0;
+    while(row < num_rows)
+    {
+        int rows_to_append = (int)MIN((long)(num_rows - row), parms->row_group_size - numBufferedRows);
+        appendRows(record, row, rows_to_append);
+        numBufferedRows += rows_to_append;
+        row += rows_to_append;
 
-            case RecordObject::UINT16:
-            {
-                arrow::UInt16Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((uint16_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+        if(numBufferedRows >= parms->row_group_size)
+        {
+            writeRowGroup();
+        }
+    }
+}
 
-            case RecordObject::UINT32:
-            {
-                arrow::UInt32Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((uint32_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+/*----------------------------------------------------------------------------
+ * appendRows
+ *
+ *  must be called with tableMut locked
+ *----------------------------------------------------------------------------*/
+void ParquetBuilder::appendRows (RecordObject* record, int first_row, int num_rows)
+{
+    /* Append Each Field in Schema */
+    for(int i = 0; i < fieldIterator->length; i++)
+    {
+        RecordObject::field_t field = (*fieldIterator)[i];
+        field.offset += first_row * rowSizeBytes * 8;
+        arrow::ArrayBuilder* builder = pimpl->builders[i].get();
 
-            case RecordObject::UINT64:
-            {
-                arrow::UInt64Builder builder;
-                (void)builder.Reserve(num_rows);
-                for(int row = 0; row < num_rows; row++)
-                {
-                    builder.UnsafeAppend((uint64_t)record->getValueInteger(field));
-                    field.offset += rowSizeBytes * 8;
-                }
-                (void)builder.Finish(&column);
-                break;
-            }
+        switch(field.type)
+        {
+            case RecordObject::DOUBLE:  pimpl->appendColumn<double,   arrow::DoubleBuilder>(builder, record, field, num_rows, rowSizeBytes);  break;
+            case RecordObject::FLOAT:   pimpl->appendColumn<float,    arrow::FloatBuilder>(builder, record, field, num_rows, rowSizeBytes);   break;
+            case RecordObject::INT8:    pimpl->appendColumn<int8_t,   arrow::Int8Builder>(builder, record, field, num_rows, rowSizeBytes);    break;
+            case RecordObject::INT16:   pimpl->appendColumn<int16_t,  arrow::Int16Builder>(builder, record, field, num_rows, rowSizeBytes);   break;
+            case RecordObject::INT32:   pimpl->appendColumn<int32_t,  arrow::Int32Builder>(builder, record, field, num_rows, rowSizeBytes);   break;
+            case RecordObject::INT64:   pimpl->appendColumn<int64_t,  arrow::Int64Builder>(builder, record, field, num_rows, rowSizeBytes);   break;
+            case RecordObject::UINT8:   pimpl->appendColumn<uint8_t,  arrow::UInt8Builder>(builder, record, field, num_rows, rowSizeBytes);   break;
+            case RecordObject::UINT16:  pimpl->appendColumn<uint16_t, arrow::UInt16Builder>(builder, record, field, num_rows, rowSizeBytes);  break;
+            case RecordObject::UINT32:  pimpl->appendColumn<uint32_t, arrow::UInt32Builder>(builder, record, field, num_rows, rowSizeBytes);  break;
+            case RecordObject::UINT64:  pimpl->appendColumn<uint64_t, arrow::UInt64Builder>(builder, record, field, num_rows, rowSizeBytes);  break;
 
             case RecordObject::TIME8:
             {
-                arrow::Date64Builder builder;
-                (void)builder.Reserve(num_rows);
+                arrow::Date64Builder* date_builder = static_cast<arrow::Date64Builder*>(builder);
+                (void)date_builder->Reserve(num_rows);
                 for(int row = 0; row < num_rows; row++)
                 {
-                    builder.UnsafeAppend((int64_t)record->getValueInteger(field));
+                    date_builder->UnsafeAppend((int64_t)record->getValueInteger(field));
                     field.offset += rowSizeBytes * 8;
                 }
-                (void)builder.Finish(&column);
                 break;
             }
 
             case RecordObject::STRING:
             {
-                arrow::StringBuilder builder;
-                (void)builder.Reserve(num_rows);
+                arrow::StringBuilder* string_builder = static_cast<arrow::StringBuilder*>(builder);
+                (void)string_builder->Reserve(num_rows);
                 for(int row = 0; row < num_rows; row++)
                 {
                     const char* str = record->getValueText(field);
-                    builder.UnsafeAppend(str, StringLib::size(str));
+                    (void)string_builder->Append(str, StringLib::size(str));
                     field.offset += rowSizeBytes * 8;
                 }
-                (void)builder.Finish(&column);
                 break;
             }
 
@@ -508,18 +959,29 @@ bool ParquetBuilder::processRecord (RecordObject* record, okey_t key)
                 break;
             }
         }
-
-        /* Add Column to Columns */
-        columns.push_back(column);
     }
 
-    /* Add Geometry Column (if GeoParquet) */
+    /* Append Geometry (if GeoParquet) */
     if(geoData.as_geo)
     {
         RecordObject::field_t lon_field = geoData.lon_field;
         RecordObject::field_t lat_field = geoData.lat_field;
-        shared_ptr<arrow::Array> column;
-        arrow::BinaryBuilder builder;
+        lon_field.offset += first_row * rowSizeBytes * 8;
+        lat_field.offset += first_row * rowSizeBytes * 8;
+        arrow::BinaryBuilder* geo_builder = static_cast<arrow::BinaryBuilder*>(pimpl->builders[fieldIterator->length].get());
+        (void)geo_builder->Reserve(num_rows);
+        (void)geo_builder->ReserveData(num_rows * sizeof(wkbpoint_t));
+        arrow::StructBuilder* bbox_builder = NULL;
+        arrow::DoubleBuilder* bbox[4] = {NULL, NULL, NULL, NULL}; // xmin, ymin, xmax, ymax
+        if(geoData.covering)
+        {
+            bbox_builder = static_cast<arrow::StructBuilder*>(pimpl->builders[fieldIterator->length + 1].get());
+            for(int i = 0; i < 4; i++)
+            {
+                bbox[i] = static_cast<arrow::DoubleBuilder*>(bbox_builder->field_builder(i));
+                (void)bbox[i]->Reserve(num_rows);
+            }
+        }
         for(int row = 0; row < num_rows; row++)
         {
             wkbpoint_t point = {
@@ -529,133 +991,184 @@ bool ParquetBuilder::processRecord (RecordObject* record, okey_t key)
                 .byteOrder = 1,
                 #endif
                 .wkbType = 1,
-                .x = record->getValueReal(lon_field),
-                .y = record->getValueReal(lat_field)
+                .x = record->getValue<double>(lon_field),
+                .y = record->getValue<double>(lat_field)
             };
-            (void)builder.Append((uint8_t*)&point, sizeof(wkbpoint_t));
+            geo_builder->UnsafeAppend((uint8_t*)&point, sizeof(wkbpoint_t));
+            if(bbox_builder)
+            {
+                /* Bounding Box of a Point */
+                bbox[0]->UnsafeAppend(point.x);
+                bbox[1]->UnsafeAppend(point.y);
+                bbox[2]->UnsafeAppend(point.x);
+                bbox[3]->UnsafeAppend(point.y);
+            }
             lon_field.offset += rowSizeBytes * 8;
             lat_field.offset += rowSizeBytes * 8;
         }
-        (void)builder.Finish(&column);
-        columns.push_back(column);
+        if(bbox_builder) (void)bbox_builder->AppendValues(num_rows, NULL);
     }
+}
+
+/*----------------------------------------------------------------------------
+ * bufferRows
+ *
+ *  copies the rows of the record into the sort buffer along with their
+ *  position on the curve, sorting and writing out the buffer each time it
+ *  fills; must be called with tableMut locked
+ *----------------------------------------------------------------------------*/
+void ParquetBuilder::bufferRows (RecordObject* record, int num_rows)
+{
+    RecordObject::field_t lon_field = geoData.lon_field;
+    RecordObject::field_t lat_field = geoData.lat_field;
 
-    /* Write Table */
-    if(pimpl->parquetWriter)
+    int row = 0;
+    while(row < num_rows)
     {
-        tableMut.lock();
+        int rows_to_copy = (int)MIN((long)(num_rows - row), sortCapacity - numSortRows);
+        LocalLib::copy(sortRecord->getRecordData() + (numSortRows * rowSizeBytes), record->getRecordData() + ((long)row * rowSizeBytes), rows_to_copy * rowSizeBytes);
+        for(int i = 0; i < rows_to_copy; i++)
         {
-            /* Build and Write Table */
-            shared_ptr<arrow::Table> table = arrow::Table::Make(pimpl->schema, columns);
-            (void)pimpl->parquetWriter->WriteTable(*table, num_rows);
+            uint64_t index = hilbertIndex(record->getValue<double>(lon_field), record->getValue<double>(lat_field));
+            pimpl->sortKeys[numSortRows + i] = (index << 32) | (uint64_t)(numSortRows + i);
+            lon_field.offset += rowSizeBytes * 8;
+            lat_field.offset += rowSizeBytes * 8;
+        }
+        numSortRows += rows_to_copy;
+        row += rows_to_copy;
+
+        if(numSortRows >= sortCapacity)
+        {
+            sortRows();
         }
-        tableMut.unlock();
     }
+}
 
-    /* Return Success */
-    return true;
+/*----------------------------------------------------------------------------
+ * sortRows
+ *
+ *  writes the sort buffer out in curve order and ends the row group so that
+ *  no row group spans two buffers; must be called with tableMut locked
+ *----------------------------------------------------------------------------*/
+void ParquetBuilder::sortRows (void)
+{
+    if(numSortRows == 0) return;
+
+    std::sort(pimpl->sortKeys.begin(), pimpl->sortKeys.begin() + numSortRows);
+
+    const uint8_t* src = sortRecord->getRecordData();
+    uint8_t* dst = sortedRecord->getRecordData();
+    for(long i = 0; i < numSortRows; i++)
+    {
+        long row = (long)(pimpl->sortKeys[i] & 0xFFFFFFFF);
+        LocalLib::copy(&dst[i * rowSizeBytes], &src[row * rowSizeBytes], rowSizeBytes);
+    }
+
+    appendRecord(sortedRecord, numSortRows);
+    writeRowGroup();
+    numSortRows = 0;
 }
 
 /*----------------------------------------------------------------------------
- * processTimeout
+ * hilbertIndex
+ *
+ *  distance along a Hilbert curve of HILBERT_ORDER over the lon/lat plane
  *----------------------------------------------------------------------------*/
-bool ParquetBuilder::processTimeout (void)
+uint32_t ParquetBuilder::hilbertIndex (double lon, double lat)
 {
-    return true;
+    const uint32_t n = 1 << HILBERT_ORDER;
+    uint32_t x = (uint32_t)MAX(MIN((lon + 180.0) / 360.0 * n, n - 1.0), 0.0);
+    uint32_t y = (uint32_t)MAX(MIN((lat + 90.0) / 180.0 * n, n - 1.0), 0.0);
+
+    uint32_t d = 0;
+    for(uint32_t s = n / 2; s > 0; s /= 2)
+    {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        /* Rotate Quadrant */
+        if(ry == 0)
+        {
+            if(rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            uint32_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+
+    return d;
 }
 
 /*----------------------------------------------------------------------------
- * processTermination
+ * writeRowGroup
  *
- *  Note that RecordDispatcher will only call this once
+ *  must be called with tableMut locked
  *----------------------------------------------------------------------------*/
-bool ParquetBuilder::processTermination (void)
+void ParquetBuilder::writeRowGroup (void)
 {
-    /* Early Exit on No Writer */
-    if(!pimpl->parquetWriter) return false;
+    if(numBufferedRows == 0) return;
 
-    /* Close Parquet Writer */
-    (void)pimpl->parquetWriter->Close();
+    /* Finish Columns (resets the builders for the next row group) */
+    vector<shared_ptr<arrow::Array>> columns;
+    for(size_t i = 0; i < pimpl->builders.size(); i++)
+    {
+        shared_ptr<arrow::Array> column;
+        (void)pimpl->builders[i]->Finish(&column);
+        columns.push_back(column);
+    }
 
-    /* Send File to User */
-    int file_path_len = StringLib::size(parms->path);
-    if((file_path_len > 5) &&
-       (parms->path[0] == 's') &&
-       (parms->path[1] == '3') &&
-       (parms->path[2] == ':') &&
-       (parms->path[3] == '/') &&
-       (parms->path[4] == '/'))
+    /* Build Table from Columns */
+    shared_ptr<arrow::Table> table = arrow::Table::Make(pimpl->schema, columns);
+    if(pimpl->ipcWriter)
     {
-        #ifdef __aws__
-        return send2S3(&parms->path[5]);
-        #else
-        LuaEndpoint::generateExceptionStatus(RTE_ERROR, CRITICAL, outQ, NULL, "Output path specifies S3, but server not compiled with AWS support");
-        #endif
+        /* Write Table as a Record Batch and Push it Out */
+        (void)pimpl->ipcWriter->WriteTable(*table);
+        (void)pimpl->outputStream->Flush();
     }
     else
     {
-        /* Stream Back to Client */
-        return send2Client();
+        /* Write Table as a Single Row Group */
+        (void)pimpl->parquetWriter->WriteTable(*table, numBufferedRows);
     }
+    numBufferedRows = 0;
 }
 
 /*----------------------------------------------------------------------------
  * send2S3
+ *
+ *  the parts were uploaded while the file was written; this completes the
+ *  upload and reports the result
  *----------------------------------------------------------------------------*/
 bool ParquetBuilder::send2S3 (const char* s3dst)
 {
     #ifdef __aws__
 
-    bool status = true;
-
-    /* Check Path */
-    if(!s3dst) return false;
+    (void)s3dst;
 
-    /* Get Bucket and Key */
-    char* bucket = StringLib::duplicate(s3dst);
-    char* key = bucket;
-    while(*key != '\0' && *key != '/') key++;
-    if(*key == '/')
+    /* Complete Upload */
+    S3OutputStream* s3_stream = static_cast<S3OutputStream*>(pimpl->outputStream.get());
+    arrow::Status status = s3_stream->Close();
+    if(status.ok())
     {
-        *key = '\0';
+        /* Send Successful Status */
+        LuaEndpoint::generateExceptionStatus(RTE_INFO, INFO, outQ, NULL, "Upload to S3 completed, bucket = %s, key = %s, size = %ld", s3_stream->getBucket(), s3_stream->getKey(), (long)s3_stream->Tell().ValueOrDie());
     }
     else
     {
-        status = false;
-        mlog(CRITICAL, "invalid S3 url: %s", s3dst);
+        /* Send Error Status */
+        LuaEndpoint::generateExceptionStatus(RTE_ERROR, CRITICAL, outQ, NULL, "Upload to S3 failed, bucket = %s, key = %s, error = %s", s3_stream->getBucket(), s3_stream->getKey(), status.ToString().c_str());
     }
-    key++;
-
-    /* Put File */
-    if(status)
-    {
-        /* Send Initial Status */
-        LuaEndpoint::generateExceptionStatus(RTE_INFO, INFO, outQ, NULL, "Initiated upload of results to S3, bucket = %s, key = %s", bucket, key);
-
-        try
-        {
-            /* Upload to S3 */
-            int64_t bytes_uploaded = S3CurlIODriver::put(fileName, bucket, key, parms->region, &parms->credentials);
-
-            /* Send Successful Status */
-            LuaEndpoint::generateExceptionStatus(RTE_INFO, INFO, outQ, NULL, "Upload to S3 completed, bucket = %s, key = %s, size = %ld", bucket, key, bytes_uploaded);
-        }
-        catch(const RunTimeException& e)
-        {
-            status = false;
-
-            /* Send Error Status */
-            LuaEndpoint::generateExceptionStatus(RTE_ERROR, e.level(), outQ, NULL, "Upload to S3 failed, bucket = %s, key = %s, error = %s", bucket, key, e.what());
-        }
-    }
-
-    /* Clean Up */
-    delete [] bucket;
 
     /* Return Status */
-    return status;
+    return status.ok();
 
     #else
+    (void)s3dst;
     return false;
     #endif
 }
@@ -732,6 +1245,25 @@ bool ParquetBuilder::send2Client (void)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * getS3Path
+ *
+ *  returns the <bucket>/<key> portion of an s3:// path, or NULL
+ *----------------------------------------------------------------------------*/
+const char* ParquetBuilder::getS3Path (const char* path)
+{
+    if((StringLib::size(path) > 5) &&
+       (path[0] == 's') &&
+       (path[1] == '3') &&
+       (path[2] == ':') &&
+       (path[3] == '/') &&
+       (path[4] == '/'))
+    {
+        return &path[5];
+    }
+    return NULL;
+}
+
 /*----------------------------------------------------------------------------
  * buildGeoMetaData
  *----------------------------------------------------------------------------*/
@@ -786,6 +1318,21 @@ const char* ParquetBuilder::buildGeoMetaData (void)
         }
     })json");
 
+    /* Bbox Covering */
+    if(geoData.covering)
+    {
+        geostr.replace("\"version\": \"1.0.0-beta.1\"", "\"version\": \"1.1.0\"");
+        geostr.replace("\"edges\": \"planar\",", R"json("covering": {
+                    "bbox": {
+                        "xmin": ["bbox", "xmin"],
+                        "ymin": ["bbox", "ymin"],
+                        "xmax": ["bbox", "xmax"],
+                        "ymax": ["bbox", "ymax"]
+                    }
+                },
+                "edges": "planar",)json");
+    }
+
     geostr.replace("    ", "");
     geostr.replace("\n", " ");
 
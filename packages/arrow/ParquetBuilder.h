@@ -38,6 +38,24 @@
  * then it expects to receive records that are arrays (or batches) of that record
  * type.  The field defined as an array is transparent to this class - it just
  * expects the record to be a single array.
+ *
+ * Output to an s3:// path is uploaded as the file is written.  Otherwise the
+ * file is sent back to the client as an arrowrec.meta record holding its size
+ * followed by arrowrec.data records.  When streaming is set in the parameters
+ * the data records are sent as the file is written instead of after it is
+ * complete; the leading arrowrec.meta record then has a size of -1 and a
+ * trailing arrowrec.meta record holds the actual size.
+ *
+ * When the output format is arrow, the same columns are written as an Arrow
+ * IPC stream instead of a parquet file, one record batch per row group, and
+ * the stream is always sent to the client as it is written.
+ *
+ * When GeoParquet output has spatial_sort set in the parameters, rows are
+ * collected into a buffer of that many rows, ordered along a Hilbert curve
+ * over lon/lat, and written as row groups that never span two buffers.  A
+ * GeoParquet 1.1 bbox covering column is added as well, so the statistics of
+ * each row group bound its points and readers can skip row groups outside a
+ * spatial filter.
  */
 
 /******************************************************************************
@@ -79,6 +97,8 @@ class ParquetBuilder: public DispatchObject
 
         static const char* TMP_FILE_PREFIX;
 
+        static const int HILBERT_ORDER = 16; // bits per axis of the sort curve
+
         /*--------------------------------------------------------------------
          * Types
          *--------------------------------------------------------------------*/
@@ -112,6 +132,7 @@ class ParquetBuilder: public DispatchObject
 
         typedef struct {
             bool                    as_geo;
+            bool                    covering; // bbox column alongside geometry
             RecordObject::field_t   lon_field;
             RecordObject::field_t   lat_field;
         } geo_data_t;
@@ -134,7 +155,13 @@ class ParquetBuilder: public DispatchObject
         Publisher*          outQ;
         int                 rowSizeBytes;
         const char*         fileName; // used locally to build file
+        long                numBufferedRows; // rows in the row group being accumulated
+        bool                streamOutput; // send data records to client as the file is written
         geo_data_t          geoData;
+        RecordObject*       sortRecord; // rows waiting to be spatially sorted, NULL when not sorting
+        RecordObject*       sortedRecord; // rows of sortRecord in curve order
+        long                numSortRows;
+        long                sortCapacity;
 
         struct impl; // arrow implementation
         impl* pimpl; // private arrow data
@@ -149,8 +176,15 @@ class ParquetBuilder: public DispatchObject
         bool                processRecord           (RecordObject* record, okey_t key) override;
         bool                processTimeout          (void) override;
         bool                processTermination      (void) override;
+        void                appendRecord            (RecordObject* record, int num_rows);
+        void                appendRows              (RecordObject* record, int first_row, int num_rows);
+        void                bufferRows              (RecordObject* record, int num_rows);
+        void                sortRows                (void);
+        static uint32_t     hilbertIndex            (double lon, double lat);
+        void                writeRowGroup           (void);
         bool                send2Client             (void);
         bool                send2S3                 (const char* s3dst);
+        static const char*  getS3Path               (const char* path);
         const char*         buildGeoMetaData        (void);
 };
 
@@ -37,6 +37,7 @@
  ******************************************************************************/
 
 #include "ArrowParms.h"
+#include "CoordinateReader.h"
 #include "ParquetBuilder.h"
 
 /******************************************************************************
@@ -44,7 +44,8 @@
  ******************************************************************************/
 
 Mutex CredentialStore::credentialLock;
-Dictionary<CredentialStore::Credential> CredentialStore::credentialStore(STARTING_STORE_SIZE);
+std::atomic<CredentialStore::snapshot_t*> CredentialStore::currentSnapshot(NULL);
+CredentialStore::snapshot_t* CredentialStore::retiredSnapshots = NULL;
 Dictionary<int32_t> CredentialStore::metricIds(STARTING_STORE_SIZE);
 
 const char* CredentialStore::LIBRARY_NAME = "CredentialStore";
@@ -80,27 +81,35 @@ void CredentialStore::init (void)
  *----------------------------------------------------------------------------*/
 void CredentialStore::deinit (void)
 {
+    credentialLock.lock();
+    {
+        delete currentSnapshot.exchange(NULL);
+        while(retiredSnapshots)
+        {
+            snapshot_t* snapshot = retiredSnapshots;
+            retiredSnapshots = snapshot->next;
+            delete snapshot;
+        }
+    }
+    credentialLock.unlock();
 }
 
 /*----------------------------------------------------------------------------
  * get
+ *
+ *  lock free; reads the current snapshot, which is never modified once
+ *  published and is kept alive after being replaced long enough for any
+ *  reader still holding it to finish
  *----------------------------------------------------------------------------*/
 CredentialStore::Credential CredentialStore::get (const char* host)
 {
     Credential credential;
 
-    credentialLock.lock();
+    const snapshot_t* snapshot = currentSnapshot.load(std::memory_order_acquire);
+    if(snapshot && host)
     {
-        try
-        {
-            credential = credentialStore[host];
-        }
-        catch(const RunTimeException& e)
-        {
-            (void)e;
-        }
+        snapshot->store.find(host, &credential);
     }
-    credentialLock.unlock();
 
     return credential;
 }
@@ -114,8 +123,45 @@ bool CredentialStore::put (const char* host, Credential& credential)
 
     credentialLock.lock();
     {
-        /* Store Credentials */
-        status = credentialStore.add(host, credential);
+        /* Build New Snapshot with Credentials */
+        snapshot_t* snapshot = new snapshot_t;
+        snapshot_t* old_snapshot = currentSnapshot.load(std::memory_order_relaxed);
+        if(old_snapshot)
+        {
+            Dictionary<Credential>::Iterator iterator(old_snapshot->store);
+            for(int i = 0; i < iterator.length; i++)
+            {
+                Credential entry(iterator[i].value);
+                snapshot->store.add(iterator[i].key, entry);
+            }
+        }
+        status = snapshot->store.add(host, credential);
+
+        /* Publish Snapshot */
+        currentSnapshot.store(snapshot, std::memory_order_release);
+
+        /* Retire Old Snapshot and Free Expired Ones */
+        double now = TimeLib::latchtime();
+        if(old_snapshot)
+        {
+            old_snapshot->retiredTime = now;
+            old_snapshot->next = retiredSnapshots;
+            retiredSnapshots = old_snapshot;
+        }
+        snapshot_t** link = &retiredSnapshots;
+        while(*link)
+        {
+            snapshot_t* retired = *link;
+            if(now - retired->retiredTime > RETIRED_SNAPSHOT_LIFETIME)
+            {
+                *link = retired->next;
+                delete retired;
+            }
+            else
+            {
+                link = &retired->next;
+            }
+        }
 
         /* Find/Register Metric Id */
         int32_t metric_id = EventLib::INVALID_METRIC;
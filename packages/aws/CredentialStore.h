@@ -42,6 +42,8 @@
 #include "LuaObject.h"
 #include "TimeLib.h"
 
+#include <atomic>
+
 /******************************************************************************
  * AWS S3 LIBRARY CLASS
  ******************************************************************************/
@@ -56,6 +58,7 @@ class CredentialStore
 
         static const int STARTING_STORE_SIZE = 8;
         static const int MAX_KEY_SIZE = 2048;
+        static const int RETIRED_SNAPSHOT_LIFETIME = 600; // seconds a replaced snapshot is kept for readers still using it
 
         static const char* LIBRARY_NAME;
         static const char* EXPIRATION_GPS_METRIC;
@@ -249,12 +252,25 @@ class CredentialStore
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Typdefs
+         *--------------------------------------------------------------------*/
+
+        struct snapshot_t {
+            Dictionary<Credential>  store;
+            double                  retiredTime;
+            snapshot_t*             next;
+
+            snapshot_t(void): store(STARTING_STORE_SIZE), retiredTime(0.0), next(NULL) {};
+        };
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        static Mutex credentialLock;
-        static Dictionary<Credential> credentialStore;
+        static Mutex credentialLock; // serializes writers, readers use the snapshot
+        static std::atomic<snapshot_t*> currentSnapshot;
+        static snapshot_t* retiredSnapshots;
         static Dictionary<int32_t> metricIds;
 };
 
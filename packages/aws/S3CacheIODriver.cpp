@@ -44,6 +44,8 @@
 #include <stdio.h>
 #include <dirent.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 /******************************************************************************
  * STATIC DATA
@@ -54,12 +56,14 @@ const char* S3CacheIODriver::FORMAT = "s3cache";
 const char* S3CacheIODriver::DEFAULT_CACHE_ROOT = ".cache";
 const char* S3CacheIODriver::cacheRoot = NULL;
 
-int         S3CacheIODriver::cacheMaxSize = 0;
+int         S3CacheIODriver::cacheMaxFiles = 0;
+int64_t     S3CacheIODriver::cacheMaxBytes = 0;
+int64_t     S3CacheIODriver::cacheBytes = 0;
 okey_t      S3CacheIODriver::cacheIndex = 0;
-Mutex       S3CacheIODriver::cacheMut;
+Mutex       S3CacheIODriver::cacheMut("s3.cache");
 
-Dictionary<okey_t> S3CacheIODriver::cacheLookUp;
-MgOrdering<const char*, okey_t, true> S3CacheIODriver::cacheFiles;
+SkipOrdering<S3CacheIODriver::cache_entry_t*> S3CacheIODriver::cacheFiles;
+S3CacheIODriver::cache_stripe_t S3CacheIODriver::cacheStripes[NUM_CACHE_STRIPES];
 
 /******************************************************************************
  * FILE IO DRIVER CLASS
@@ -71,7 +75,8 @@ MgOrdering<const char*, okey_t, true> S3CacheIODriver::cacheFiles;
 void S3CacheIODriver::init (void)
 {
     cacheRoot = NULL;
-    cacheMaxSize = DEFAULT_MAX_CACHE_FILES;
+    cacheMaxFiles = DEFAULT_MAX_CACHE_FILES;
+    cacheMaxBytes = DEFAULT_MAX_CACHE_BYTES;
 }
 /*----------------------------------------------------------------------------
  * create
@@ -82,7 +87,7 @@ Asset::IODriver* S3CacheIODriver::create (const Asset* _asset, const char* resou
 }
 
 /*----------------------------------------------------------------------------
- * luaCreateCache - s3cache(<root>, [<max_files>])
+ * luaCreateCache - s3cache(<root>, [<max_files>], [<max_bytes>])
  *----------------------------------------------------------------------------*/
 int S3CacheIODriver::luaCreateCache(lua_State* L)
 {
@@ -91,9 +96,10 @@ int S3CacheIODriver::luaCreateCache(lua_State* L)
         /* Get Parameters */
         const char* cache_root  = LuaObject::getLuaString(L, 1, true, DEFAULT_CACHE_ROOT);
         int         max_files   = LuaObject::getLuaInteger(L, 2, true, DEFAULT_MAX_CACHE_FILES);
+        int64_t     max_bytes   = LuaObject::getLuaInteger(L, 3, true, DEFAULT_MAX_CACHE_BYTES);
 
         /* Create Cache */
-        createCache(cache_root, max_files);
+        createCache(cache_root, max_files, max_bytes);
 
         lua_pushboolean(L, true);
         return 1;
@@ -108,69 +114,112 @@ int S3CacheIODriver::luaCreateCache(lua_State* L)
 
 /*----------------------------------------------------------------------------
  * createCache
+ *
+ *  the cache is bounded by max_bytes and, when greater than zero, by
+ *  max_files; the least recently opened files that are not open are evicted
  *----------------------------------------------------------------------------*/
-int S3CacheIODriver::createCache (const char* cache_root, int max_files)
+int S3CacheIODriver::createCache (const char* cache_root, int max_files, int64_t max_bytes)
 {
     int file_count = 0;
 
-    cacheMut.lock();
+    /* Create Cache Directory (if it doesn't exist) */
+    int ret = mkdir(cache_root, 0700);
+    if(ret == -1 && errno != EEXIST)
     {
-        /* Create Cache Directory (if it doesn't exist) */
-        int ret = mkdir(cache_root, 0700);
-        if(ret == -1 && errno != EEXIST)
+        throw RunTimeException(CRITICAL, RTE_ERROR, "Failed to create cache directory %s: %s", cache_root, strerror(errno));
+    }
+
+    /* Clear Out Cache Lookup Tables */
+    for(int i = 0; i < NUM_CACHE_STRIPES; i++)
+    {
+        cache_stripe_t* stripe = &cacheStripes[i];
+        stripe->mut.lock();
+        cacheMut.lock();
         {
-            cacheMut.unlock();
-            throw RunTimeException(CRITICAL, RTE_ERROR, "Failed to create cache directory %s: %s", cache_root, strerror(errno));
+            cache_entry_t* entry = NULL;
+            const char* key = stripe->lookup.first(&entry);
+            while(key != NULL)
+            {
+                /* Entries Still Pinned by Drivers are Freed on Last Unpin */
+                entry->cached = false;
+                entry->detached = true;
+                if(entry->pins == 0)
+                {
+                    delete [] entry->key;
+                    delete entry;
+                }
+                key = stripe->lookup.next(&entry);
+            }
+            stripe->lookup.clear();
         }
+        cacheMut.unlock();
+        stripe->mut.unlock();
+    }
 
+    cacheMut.lock();
+    {
         /* Set Cache Root */
         if(cacheRoot) delete [] cacheRoot;
         cacheRoot = StringLib::duplicate(cache_root);
 
-        /* Set Maximum Number of Files */
-        cacheMaxSize = max_files;
+        /* Set Cache Limits */
+        cacheMaxFiles = max_files;
+        cacheMaxBytes = max_bytes;
 
-        /* Clear Out Cache Lookup Table and Files */
-        cacheLookUp.clear();
+        /* Clear Out Cache Files */
         cacheFiles.clear();
+        cacheBytes = 0;
+    }
+    cacheMut.unlock();
 
-        /* Traverse Directory and Build Cache (if it does exist) */
-        DIR *dir;
-        if((dir = opendir(cacheRoot)) != NULL)
+    /* Traverse Directory and Build Cache (if it does exist) */
+    DIR *dir;
+    if((dir = opendir(cache_root)) != NULL)
+    {
+        struct dirent *ent;
+        while((ent = readdir(dir)) != NULL)
         {
-            struct dirent *ent;
-            while((ent = readdir(dir)) != NULL)
+            if(!StringLib::match(".", ent->d_name) && !StringLib::match("..", ent->d_name))
             {
-                if(!StringLib::match(".", ent->d_name) && !StringLib::match("..", ent->d_name))
+                char cache_filepath[MAX_STR_SIZE];
+                StringLib::format(cache_filepath, MAX_STR_SIZE, "%s%c%s", cache_root, PATH_DELIMETER, ent->d_name);
+
+                /* Get Size of File */
+                struct stat file_stat;
+                if(stat(cache_filepath, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) continue;
+
+                /* Reformat Filename to Key */
+                SafeString key("%s", ent->d_name);
+                key.replace("#", PATH_DELIMETER_STR);
+
+                /* Add File to Cache */
+                cache_stripe_t* stripe = cacheStripe(key.getString());
+                stripe->mut.lock();
                 {
-                    if(file_count++ < cacheMaxSize)
+                    if(!stripe->lookup.find(key.getString()))
                     {
-                        char cache_filepath[MAX_STR_SIZE];
-                        StringLib::format(cache_filepath, MAX_STR_SIZE, "%s%c%s", cacheRoot, PATH_DELIMETER, ent->d_name);
-
-                        /* Reformat Filename to Key */
-                        SafeString key("%s", ent->d_name);
-                        key.replace("#", PATH_DELIMETER_STR);
-
-                        /* Add File to Cache */
-                        cacheIndex++;
-                        cacheLookUp.add(key.getString(), cacheIndex);
-                        const char* cache_key = StringLib::duplicate(key.getString());
-                        cacheFiles.add(cacheIndex, cache_key);
+                        cache_entry_t* entry = cacheNewEntry(key.getString());
+                        stripe->lookup.add(key.getString(), entry);
+                        cacheInsert(entry, file_stat.st_size);
+                        file_count++;
                         mlog(INFO, "Caching %s for S3 retrieval", key.getString());
                     }
                 }
+                stripe->mut.unlock();
             }
-            closedir(dir);
+        }
+        closedir(dir);
 
-            /* Log Status */
-            if(file_count > 0)
+        /* Log Status */
+        if(file_count > 0)
+        {
+            cacheMut.lock();
             {
-                mlog(INFO, "Loaded %ld of %d files into S3 cache", cacheFiles.length(), file_count);
+                mlog(INFO, "Loaded %ld of %d files (%ld bytes) into S3 cache", cacheFiles.length(), file_count, (long)cacheBytes);
             }
+            cacheMut.unlock();
         }
     }
-    cacheMut.unlock();
 
     return file_count;
 }
@@ -180,14 +229,60 @@ int S3CacheIODriver::createCache (const char* cache_root, int max_files)
  *----------------------------------------------------------------------------*/
 int64_t S3CacheIODriver::ioRead (uint8_t* data, int64_t size, uint64_t pos)
 {
-    /* Seek to New Position */
-    if(fseek(ioFile, pos, SEEK_SET) != 0)
+    /* Wait for Parts of File Being Read */
+    if(ioDownload)
+    {
+        bool finished = false;
+        bool failed = false;
+        bool ready = false;
+        ioDownload->cond.lock();
+        {
+            while(!ready)
+            {
+                finished = ioDownload->finished;
+                failed = ioDownload->failed;
+                if(finished || failed)
+                {
+                    ready = true;
+                }
+                else if(ioDownload->num_parts > 0)
+                {
+                    /* Check Parts Covering Request */
+                    int64_t end = MIN((int64_t)pos + size, ioDownload->size);
+                    int first_part = pos / DOWNLOAD_PART_SIZE;
+                    int last_part = (end - 1) / DOWNLOAD_PART_SIZE;
+                    ready = true;
+                    for(int part = first_part; ready && part <= last_part; part++)
+                    {
+                        ready = ioDownload->part_complete[part];
+                    }
+                }
+
+                if(!ready) ioDownload->cond.wait(0, SYS_TIMEOUT);
+            }
+        }
+        ioDownload->cond.unlock();
+
+        /* Check Status of Download */
+        if(failed)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "failed to download resource");
+        }
+        else if(finished)
+        {
+            downloadRelease(ioDownload);
+            ioDownload = NULL;
+        }
+    }
+
+    /* Read Data - positional reads bypass stdio buffering of a partially downloaded file */
+    int64_t bytes_read = IoRing::read(fileno(ioFile), data, size, pos); // falls back to pread when no ring is active
+    if(bytes_read < 0)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to go to I/O position: 0x%lx", pos);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read I/O position 0x%lx: %s", (unsigned long)pos, strerror(-bytes_read));
     }
 
-    /* Read Data */
-    return fread(data, 1, size, ioFile);
+    return bytes_read;
 }
 
 /*----------------------------------------------------------------------------
@@ -197,6 +292,8 @@ S3CacheIODriver::S3CacheIODriver (const Asset* _asset, const char* resource):
     S3CurlIODriver(_asset, resource)
 {
     ioFile = NULL;
+    ioEntry = NULL;
+    ioDownload = NULL;
 
     /* Check if Cache Created */
     if(cacheRoot == NULL) throw RunTimeException(CRITICAL, RTE_ERROR, "cache has not been created yet");
@@ -212,6 +309,8 @@ S3CacheIODriver::S3CacheIODriver (const Asset* _asset, const char* resource):
     /* Check if File Opened */
     if(ioFile == NULL)
     {
+        if(ioDownload) downloadRelease(ioDownload);
+        if(ioEntry) cacheUnpin(ioEntry);
         throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open resource");
     }
 }
@@ -223,80 +322,473 @@ S3CacheIODriver::~S3CacheIODriver (void)
 {
     if(ioFile) fclose(ioFile);
     ioFile = NULL;
+
+    if(ioDownload) downloadRelease(ioDownload);
+    ioDownload = NULL;
+
+    if(ioEntry) cacheUnpin(ioEntry);
+    ioEntry = NULL;
 }
 
 /*----------------------------------------------------------------------------
  * fileGet
+ *
+ *  on a cache miss the object is downloaded in parallel ranged parts by
+ *  detached worker threads; the driver returns as soon as the download has
+ *  started and reads block in ioRead until the parts they need are written
  *----------------------------------------------------------------------------*/
 bool S3CacheIODriver::fileGet (const char* bucket, const char* key, const char** file)
 {
-    /* Check Cache */
+    const char* cache_filepath = cacheFilePath(key);
+    cache_stripe_t* stripe = cacheStripe(key);
+
+    /* Check Cache and Downloads in Progress */
     bool found_in_cache = false;
-    cacheMut.lock();
+    bool start_download = false;
+    cache_entry_t* entry = NULL;
+    download_t* download = NULL;
+    stripe->mut.lock();
     {
-        if(cacheLookUp.find(key))
+        /* Drop Entry if Evicted */
+        if(stripe->lookup.find(key, &entry))
         {
-            cacheIndex++;
-            cacheFiles.remove(cacheLookUp[key]);
-            cacheLookUp.add(key, cacheIndex);
-            const char* cache_key = StringLib::duplicate(key);
-            cacheFiles.add(cacheIndex, cache_key);
-            found_in_cache = true;
+            bool free_entry = false;
+            cacheMut.lock();
+            {
+                if(entry->evicted)
+                {
+                    stripe->lookup.remove(key);
+                    entry->detached = true;
+                    free_entry = (entry->pins == 0);
+                    if(!free_entry) entry = NULL;
+                }
+            }
+            cacheMut.unlock();
+
+            if(free_entry)
+            {
+                delete [] entry->key;
+                delete entry;
+                entry = NULL;
+            }
         }
-    }
-    cacheMut.unlock();
 
-    /* Build Cache Filename */
-    SafeString cache_filename("%s", key);
-    cache_filename.replace(PATH_DELIMETER_STR, "#");
-    SafeString cache_filepath("%s%c%s", cacheRoot, PATH_DELIMETER, cache_filename.getString());
+        if(entry)
+        {
+            /* Cache Hit or Join Download */
+            cachePin(entry);
+            download = entry->download;
+            if(download)
+            {
+                download->cond.lock();
+                download->refs++;
+                download->cond.unlock();
+            }
+            else
+            {
+                found_in_cache = true;
+            }
+        }
+        else
+        {
+            /* Cache Miss */
+            int fd = open(cache_filepath, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            if(fd >= 0)
+            {
+                download = new download_t;
+                download->bucket = StringLib::duplicate(bucket);
+                download->key = StringLib::duplicate(key);
+                download->region = StringLib::duplicate(asset->getRegion());
+                download->filepath = StringLib::duplicate(cache_filepath);
+                download->credentials = latestCredentials;
+                download->fd = fd;
+                download->size = 0;
+                download->num_parts = 0;
+                download->part_complete = NULL;
+                download->next_part = 0;
+                download->workers = 0;
+                download->refs = 1;
+                download->failed = false;
+                download->finished = false;
+
+                entry = cacheNewEntry(key);
+                entry->download = download;
+                stripe->lookup.add(key, entry);
+                cachePin(entry);
+                start_download = true;
+            }
+            else
+            {
+                mlog(CRITICAL, "Failed to create cache file %s: %s", cache_filepath, strerror(errno));
+            }
+        }
+    }
+    stripe->mut.unlock();
 
     /* Log Operation */
-    mlog(DEBUG, "S3 %s object %s in bucket %s: %s", found_in_cache ? "cache hit on" : "download of", key, bucket, cache_filepath.getString());
+    mlog(DEBUG, "S3 %s object %s in bucket %s: %s", found_in_cache ? "cache hit on" : "download of", key, bucket, cache_filepath);
 
     /* Quick Exit If Cache Hit */
     if(found_in_cache)
     {
-        *file = cache_filepath.getString(true);
+        ioEntry = entry;
+        *file = cache_filepath;
         return true;
     }
 
-    /* Download File */
-    int64_t bytes_read = get(cache_filepath.getString(), bucket, key, asset->getRegion(), &latestCredentials);
-    if(bytes_read <= 0)
+    /* Check Download */
+    if(download == NULL)
     {
-        mlog(CRITICAL, "Failed to download S3 object: %ld", (long int)bytes_read);
+        delete [] cache_filepath;
         return false;
     }
 
-    /* Populate Cache */
-    cacheMut.lock();
+    /* Start Download */
+    if(start_download)
     {
-        if(cacheLookUp.length() >= cacheMaxSize)
+        int64_t object_size = getSize(bucket, key, download->region, &download->credentials);
+        if(object_size > 0 && ftruncate(download->fd, object_size) == 0)
         {
-            /* Get Oldest File from Cache */
-            const char* oldest_key = NULL;
-            okey_t index = cacheFiles.first(&oldest_key);
-            if(oldest_key != NULL)
+            /* Download Parts in Parallel */
+            int num_parts = (object_size + DOWNLOAD_PART_SIZE - 1) / DOWNLOAD_PART_SIZE;
+            int num_workers = MIN(DOWNLOAD_THREADS, num_parts);
+            download->cond.lock();
             {
-                /* Delete File in Local File System */
-                SafeString oldest_filename("%s", oldest_key);
-                oldest_filename.replace(PATH_DELIMETER_STR, "#");
-                SafeString oldest_filepath("%s%c%s", cacheRoot, PATH_DELIMETER, oldest_filename.getString());
-                remove(oldest_filepath.getString());
-                cacheFiles.remove(index);
+                download->size = object_size;
+                download->num_parts = num_parts;
+                download->part_complete = new bool [num_parts];
+                for(int i = 0; i < num_parts; i++) download->part_complete[i] = false;
+                download->workers = num_workers;
+                download->refs += num_workers;
+            }
+            download->cond.unlock();
+
+            for(int i = 0; i < num_workers; i++)
+            {
+                Thread* worker = new Thread(downloadThread, download, false);
+                delete worker; // detached
             }
         }
+        else
+        {
+            /* Fall Back to Single Streaming Download */
+            close(download->fd);
+            download->fd = -1;
+            int64_t bytes_read = 0;
+            try
+            {
+                bytes_read = get(download->filepath, bucket, key, download->region, &download->credentials);
+            }
+            catch(const RunTimeException& e)
+            {
+                mlog(e.level(), "Failed to download S3 object %s: %s", key, e.what());
+            }
+            if(bytes_read <= 0) mlog(CRITICAL, "Failed to download S3 object: %ld", (long int)bytes_read);
+            download->size = bytes_read;
+            downloadFinish(download, bytes_read > 0);
+        }
+    }
 
-        /* Add New File to Cache */
-        cacheIndex++;
-        cacheLookUp.add(key, cacheIndex);
-        const char* cache_key = StringLib::duplicate(key);
-        cacheFiles.add(cacheIndex, cache_key);
+    /* Check Download Status */
+    bool failed = false;
+    download->cond.lock();
+    {
+        failed = download->failed;
+    }
+    download->cond.unlock();
+    if(failed)
+    {
+        downloadRelease(download);
+        cacheUnpin(entry);
+        delete [] cache_filepath;
+        return false;
     }
-    cacheMut.unlock();
 
     /* Return Success */
-    *file = cache_filepath.getString(true);
+    ioEntry = entry;
+    ioDownload = download;
+    *file = cache_filepath;
     return true;
 }
+
+/*----------------------------------------------------------------------------
+ * cacheStripe
+ *----------------------------------------------------------------------------*/
+S3CacheIODriver::cache_stripe_t* S3CacheIODriver::cacheStripe (const char* key)
+{
+    unsigned int h = 0;
+    for(const char* ptr = key; *ptr != '\0'; ptr++)
+    {
+        h += *ptr;
+        h += (h << 10);
+        h ^= (h >> 6);
+    }
+    h += (h << 3);
+    h ^= (h >> 11);
+    h += (h << 15);
+
+    return &cacheStripes[h % NUM_CACHE_STRIPES];
+}
+
+/*----------------------------------------------------------------------------
+ * cacheFilePath
+ *----------------------------------------------------------------------------*/
+const char* S3CacheIODriver::cacheFilePath (const char* key)
+{
+    SafeString cache_filename("%s", key);
+    cache_filename.replace(PATH_DELIMETER_STR, "#");
+    SafeString cache_filepath("%s%c%s", cacheRoot, PATH_DELIMETER, cache_filename.getString());
+    return cache_filepath.getString(true);
+}
+
+/*----------------------------------------------------------------------------
+ * cacheNewEntry
+ *----------------------------------------------------------------------------*/
+S3CacheIODriver::cache_entry_t* S3CacheIODriver::cacheNewEntry (const char* key)
+{
+    cache_entry_t* entry = new cache_entry_t;
+    entry->key = StringLib::duplicate(key);
+    entry->size = 0;
+    entry->index = 0;
+    entry->pins = 0;
+    entry->cached = false;
+    entry->evicted = false;
+    entry->detached = false;
+    entry->download = NULL;
+    return entry;
+}
+
+/*----------------------------------------------------------------------------
+ * cachePin
+ *
+ *  pins entry and moves it to the most recently used position; must be
+ *  called with the entry's stripe locked
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::cachePin (cache_entry_t* entry)
+{
+    cacheMut.lock();
+    {
+        entry->pins++;
+        if(entry->cached)
+        {
+            cacheFiles.remove(entry->index);
+            entry->index = ++cacheIndex;
+            cacheFiles.add(entry->index, entry);
+        }
+    }
+    cacheMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * cacheUnpin
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::cacheUnpin (cache_entry_t* entry)
+{
+    bool free_entry = false;
+    cacheMut.lock();
+    {
+        entry->pins--;
+        if(entry->pins == 0)
+        {
+            if(entry->detached) free_entry = true;
+            else                cacheEvict(); // entry may have been holding cache over budget
+        }
+    }
+    cacheMut.unlock();
+
+    if(free_entry)
+    {
+        delete [] entry->key;
+        delete entry;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * cacheInsert
+ *
+ *  adds a downloaded file to the cache; must be called with the entry's
+ *  stripe locked
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::cacheInsert (cache_entry_t* entry, int64_t size)
+{
+    cacheMut.lock();
+    {
+        entry->size = size;
+        entry->cached = true;
+        entry->index = ++cacheIndex;
+        cacheFiles.add(entry->index, entry);
+        cacheBytes += size;
+        cacheEvict();
+    }
+    cacheMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * cacheEvict
+ *
+ *  removes least recently used files that are not pinned until the cache
+ *  is within its limits; must be called with cacheMut locked - evicted
+ *  entries are dropped from their lookup the next time the key is opened
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::cacheEvict (void)
+{
+    while((cacheMaxBytes > 0 && cacheBytes > cacheMaxBytes) ||
+          (cacheMaxFiles > 0 && cacheFiles.length() > cacheMaxFiles))
+    {
+        /* Find Least Recently Used Entry Not Pinned */
+        cache_entry_t* entry = NULL;
+        okey_t index = cacheFiles.first(&entry);
+        while(index != (okey_t)INVALID_KEY && entry->pins > 0)
+        {
+            index = cacheFiles.next(&entry);
+        }
+
+        /* Check if Everything is Pinned */
+        if(index == (okey_t)INVALID_KEY) break;
+
+        /* Evict Entry */
+        cacheFiles.remove(index);
+        cacheBytes -= entry->size;
+        entry->cached = false;
+        entry->evicted = true;
+
+        /* Delete File in Local File System */
+        const char* filepath = cacheFilePath(entry->key);
+        remove(filepath);
+        delete [] filepath;
+        mlog(DEBUG, "Evicted %s (%ld bytes) from S3 cache", entry->key, (long)entry->size);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * downloadThread
+ *----------------------------------------------------------------------------*/
+void* S3CacheIODriver::downloadThread (void* parm)
+{
+    download_t* download = (download_t*)parm;
+    uint8_t* buffer = new uint8_t [DOWNLOAD_PART_SIZE];
+
+    while(true)
+    {
+        /* Claim Next Part */
+        int part = -1;
+        download->cond.lock();
+        {
+            if(!download->failed && download->next_part < download->num_parts)
+            {
+                part = download->next_part++;
+            }
+        }
+        download->cond.unlock();
+        if(part < 0) break;
+
+        /* Download Part */
+        bool status = false;
+        int64_t pos = part * DOWNLOAD_PART_SIZE;
+        int64_t part_size = MIN(DOWNLOAD_PART_SIZE, download->size - pos);
+        try
+        {
+            get(buffer, part_size, pos, download->bucket, download->key, download->region, &download->credentials);
+            status = (pwrite(download->fd, buffer, part_size, pos) == part_size);
+            if(!status) mlog(CRITICAL, "Failed to write part %d of %s: %s", part, download->filepath, strerror(errno));
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failed to download part %d of S3 object %s: %s", part, download->key, e.what());
+        }
+
+        /* Signal Part Complete */
+        download->cond.lock();
+        {
+            if(status)  download->part_complete[part] = true;
+            else        download->failed = true;
+            download->cond.signal(0, Cond::NOTIFY_ALL);
+        }
+        download->cond.unlock();
+    }
+
+    delete [] buffer;
+
+    /* Last Worker Finishes Download */
+    bool last_worker = false;
+    bool failed = false;
+    download->cond.lock();
+    {
+        last_worker = (--download->workers == 0);
+        failed = download->failed;
+    }
+    download->cond.unlock();
+    if(last_worker)
+    {
+        downloadFinish(download, !failed);
+    }
+
+    downloadRelease(download);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * downloadFinish
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::downloadFinish (download_t* download, bool status)
+{
+    if(download->fd >= 0) close(download->fd);
+    download->fd = -1;
+
+    /* Move Download into Cache */
+    cache_stripe_t* stripe = cacheStripe(download->key);
+    stripe->mut.lock();
+    {
+        cache_entry_t* entry = NULL;
+        if(stripe->lookup.find(download->key, &entry) && entry->download == download)
+        {
+            entry->download = NULL;
+            if(status)
+            {
+                cacheInsert(entry, download->size);
+            }
+            else
+            {
+                cacheMut.lock();
+                {
+                    entry->evicted = true;
+                    remove(download->filepath);
+                }
+                cacheMut.unlock();
+            }
+        }
+    }
+    stripe->mut.unlock();
+
+    /* Signal Readers */
+    download->cond.lock();
+    {
+        download->failed = !status;
+        download->finished = true;
+        download->cond.signal(0, Cond::NOTIFY_ALL);
+    }
+    download->cond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * downloadRelease
+ *----------------------------------------------------------------------------*/
+void S3CacheIODriver::downloadRelease (download_t* download)
+{
+    bool last_ref = false;
+    download->cond.lock();
+    {
+        last_ref = (--download->refs == 0);
+    }
+    download->cond.unlock();
+
+    if(last_ref)
+    {
+        delete [] download->bucket;
+        delete [] download->key;
+        delete [] download->region;
+        delete [] download->filepath;
+        delete [] download->part_complete;
+        delete download;
+    }
+}
@@ -39,7 +39,7 @@
 #include "OsApi.h"
 #include "Asset.h"
 #include "LuaEngine.h"
-#include "Ordering.h"
+#include "SkipOrdering.h"
 #include "Dictionary.h"
 #include "S3CurlIODriver.h"
 
@@ -58,7 +58,11 @@ class S3CacheIODriver: public S3CurlIODriver
         static const char* FORMAT;
 
         static const char* DEFAULT_CACHE_ROOT;
-        static const int DEFAULT_MAX_CACHE_FILES = 16;
+        static const int DEFAULT_MAX_CACHE_FILES = 0; // no limit
+        static const int64_t DEFAULT_MAX_CACHE_BYTES = 0x400000000LL; // 16GB
+        static const int NUM_CACHE_STRIPES = 16; // lookup locks
+        static const int DOWNLOAD_THREADS = 8; // ranged GETs per object download
+        static const int64_t DOWNLOAD_PART_SIZE = 0x800000; // 8MB
 
         /*--------------------------------------------------------------------
          * Methods
@@ -67,33 +71,85 @@ class S3CacheIODriver: public S3CurlIODriver
         static void         init            (void);
         static IODriver*    create          (const Asset* _asset, const char* resource);
         static int          luaCreateCache  (lua_State* L);
-        static int          createCache     (const char* cache_root=DEFAULT_CACHE_ROOT, int max_files=DEFAULT_MAX_CACHE_FILES);
+        static int          createCache     (const char* cache_root=DEFAULT_CACHE_ROOT, int max_files=DEFAULT_MAX_CACHE_FILES, int64_t max_bytes=DEFAULT_MAX_CACHE_BYTES);
         int64_t             ioRead          (uint8_t* data, int64_t size, uint64_t pos);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            const char*                 bucket;
+            const char*                 key;
+            const char*                 region;
+            const char*                 filepath;
+            CredentialStore::Credential credentials;
+            int                         fd;
+            int64_t                     size;
+            int                         num_parts;
+            bool*                       part_complete;
+            int                         next_part;
+            int                         workers;    // worker threads still running
+            int                         refs;       // drivers and workers holding download
+            bool                        failed;
+            bool                        finished;
+            Cond                        cond;
+        } download_t;
+
+        typedef struct {
+            const char*                 key;
+            int64_t                     size;
+            okey_t                      index;      // position in cacheFiles
+            int                         pins;       // drivers reading the file
+            bool                        cached;     // in cacheFiles and counted in cacheBytes
+            bool                        evicted;    // file removed, entry waiting to be dropped
+            bool                        detached;   // no longer in lookup, freed on last unpin
+            download_t*                 download;   // set while file is being downloaded
+        } cache_entry_t;
+
+        typedef struct {
+            Mutex                       mut;
+            Dictionary<cache_entry_t*>  lookup;
+        } cache_stripe_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                S3CacheIODriver     (const Asset* _asset, const char* resource);
-                ~S3CacheIODriver    (void);
+                        S3CacheIODriver     (const Asset* _asset, const char* resource);
+                        ~S3CacheIODriver    (void);
+
+        bool            fileGet             (const char* bucket, const char* key, const char** file);
 
-        bool    fileGet             (const char* bucket, const char* key, const char** file);
+        static cache_stripe_t*  cacheStripe     (const char* key);
+        static const char*      cacheFilePath   (const char* key);
+        static cache_entry_t*   cacheNewEntry   (const char* key);
+        static void             cachePin        (cache_entry_t* entry);
+        static void             cacheUnpin      (cache_entry_t* entry);
+        static void             cacheInsert     (cache_entry_t* entry, int64_t size);
+        static void             cacheEvict      (void);
+        static void*            downloadThread  (void* parm);
+        static void             downloadFinish  (download_t* download, bool status);
+        static void             downloadRelease (download_t* download);
 
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        static const char*                              cacheRoot;
-        static int                                      cacheMaxSize;
-        static Mutex                                    cacheMut;
-        static okey_t                                   cacheIndex;
-        static Dictionary<okey_t>                       cacheLookUp;
-        static MgOrdering<const char*, okey_t, true>    cacheFiles;
+        static const char*                  cacheRoot;
+        static int                          cacheMaxFiles;
+        static int64_t                      cacheMaxBytes;
+        static int64_t                      cacheBytes;     // size of files in cacheFiles
+        static Mutex                        cacheMut;       // protects cacheFiles and entry state
+        static okey_t                       cacheIndex;
+        static SkipOrdering<cache_entry_t*> cacheFiles;     // least recently used first
+        static cache_stripe_t               cacheStripes[NUM_CACHE_STRIPES];
 
-        const Asset*    asset;
         fileptr_t       ioFile;
+        cache_entry_t*  ioEntry;    // pinned while driver is open
+        download_t*     ioDownload; // set while object is still being downloaded
 };
 
 #endif  /* __s3_cache_io_driver__ */
@@ -38,8 +38,116 @@
 
 #include "OsApi.h"
 #include "Dictionary.h"
+#include "List.h"
 #include "Asset.h"
 #include "CredentialStore.h"
+#include "LatencyHistogram.h"
+
+#include <vector>
+
+/******************************************************************************
+ * AWS S3 FUTURE CLASS
+ ******************************************************************************/
+
+class S3Future
+{
+    public:
+
+        /*--------------------------------------------------------------------
+        * Typedefs
+        *--------------------------------------------------------------------*/
+
+        typedef enum {
+            INVALID     = -1,
+            TIMEOUT     = 0,
+            COMPLETE    = 1
+        } rc_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                S3Future        (uint8_t* _data, int64_t _size);
+                ~S3Future       (void);
+
+        rc_t    wait            (int timeout); // ms
+        void    finish          (bool _valid);
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        uint8_t*    data;       // caller supplied buffer
+        int64_t     size;       // bytes requested
+
+    private:
+
+        bool        complete;
+        bool        valid;
+        Cond        sync;
+};
+
+/******************************************************************************
+ * AWS S3 MULTIPART UPLOAD CLASS
+ ******************************************************************************/
+
+class S3Upload
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int ATTEMPTS_PER_PART = 3;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                S3Upload        (const char* _bucket, const char* _key, const char* _region,
+                                 CredentialStore::Credential* _credentials, int _concurrency);
+                ~S3Upload       (void); // aborts the upload if not completed
+
+        void    uploadPart      (uint8_t* data, int64_t size); // takes ownership of data (new [])
+        void    complete        (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            S3Upload*   upload;
+            int         part_number;
+            uint8_t*    data;
+            int64_t     size;
+        } part_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void*    partThread      (void* parm);
+        void            waitForParts    (int max_inflight);
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        char*                       bucket;
+        char*                       key;
+        char*                       region;
+        CredentialStore::Credential credentials;
+        char*                       uploadId;
+        std::vector<char*>          etags; // entity tag of each part, indexed by part number - 1
+        int                         concurrency;
+        int                         inflight;
+        bool                        failed;
+        bool                        completed;
+        Cond                        cond;
+};
 
 /******************************************************************************
  * AWS S3 CLIENT CLASS
@@ -60,22 +168,63 @@ class S3CurlIODriver: public Asset::IODriver
         static const long ATTEMPTS_PER_REQUEST = 3;
         static const long SSL_VERIFYPEER = 0;
         static const long SSL_VERIFYHOST = 0;
+        static const int DEFAULT_COALESCE_WINDOW = 0; // milliseconds, zero disables coalescing
+        static const int64_t DEFAULT_COALESCE_GAP = 0x10000; // 64KB
+        static const int64_t MAX_COALESCE_SIZE = 0x4000000; // 64MB
+        static const int64_t MIN_PART_SIZE = 0x500000; // 5MB, smallest multipart upload part allowed by S3
+        static const int64_t DEFAULT_PART_SIZE = 0x800000; // 8MB
+        static const int DEFAULT_UPLOAD_CONCURRENCY = 4; // parts in flight per upload
+        static const int NUM_SHARE_LOCKS = 8; // at least CURL_LOCK_DATA_LAST
+        static const int MAX_POOLED_HANDLES = 64;
+        static const int ASYNC_MAX_CONNECTIONS = 256; // in flight transfers, the rest are queued by curl
+        static const int ASYNC_POLL_TIMEOUT = 100; // milliseconds
+        static const int DEFAULT_HEDGE_PERCENTILE = 95; // latency percentile after which a get is duplicated, zero disables hedging
+        static const double DEFAULT_HEDGE_BUDGET; // fraction of gets that may be hedged
+        static const int64_t MAX_HEDGE_SIZE = 0x800000; // 8MB, larger gets are bandwidth bound and are not hedged
+        static const int HEDGE_SAMPLES = 512; // recent get latencies the threshold is taken from
+        static const int HEDGE_RECALC = 64; // samples between recalculations of the threshold
+        static const int MIN_HEDGE_THRESHOLD = 20; // milliseconds
         static const char* DEFAULT_REGION;
         static const char* DEFAULT_ASSET_NAME;
         static const char* FORMAT;
+        static const char* METRIC_CATEGORY;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
+        static void         init            (void);
+        static void         deinit          (void);
         static IODriver*    create          (const Asset* _asset, const char* resource);
+        static void*        acquireHandle   (void); // CURL*
+        static void         releaseHandle   (void* handle);
         virtual int64_t     ioRead          (uint8_t* data, int64_t size, uint64_t pos) override;
+        virtual void        ioReadv         (io_read_t* reads, int num_reads) override;
 
         // fixed GET - memory preallocated
         static int64_t      get             (uint8_t* data, int64_t size, uint64_t pos,
                                              const char* bucket, const char* key, const char* region,
                                              CredentialStore::Credential* credentials);
 
+        // coalesced GET - nearby concurrent ranges of an object merged into one request
+        static int64_t      coalescedGet    (uint8_t* data, int64_t size, uint64_t pos,
+                                             const char* bucket, const char* key, const char* region,
+                                             CredentialStore::Credential* credentials);
+
+        // asynchronous GET - memory preallocated, completion signaled through future
+        static S3Future*    getAsync        (uint8_t* data, int64_t size, uint64_t pos,
+                                             const char* bucket, const char* key, const char* region,
+                                             CredentialStore::Credential* credentials);
+
+        // vectored GET - ranges issued together on the asynchronous engine
+        static void         readv           (io_read_t* reads, int num_reads,
+                                             const char* bucket, const char* key, const char* region,
+                                             CredentialStore::Credential* credentials);
+
+        // size of object - determined from a single byte GET
+        static int64_t      getSize         (const char* bucket, const char* key, const char* region,
+                                             CredentialStore::Credential* credentials);
+
         // streaming GET - memory allocated and returned
         static int64_t      get             (uint8_t** data,
                                              const char* bucket, const char* key, const char* region,
@@ -91,17 +240,73 @@ class S3CurlIODriver: public Asset::IODriver
                                              const char* bucket, const char* key, const char* region,
                                              CredentialStore::Credential* credentials);
 
+        // multipart upload - parts (all but the last) must be at least MIN_PART_SIZE;
+        // S3Upload uploads the parts concurrently
+        static int64_t      getPartSize             (void);
+        static int          getUploadConcurrency    (void);
+        static char*        createMultipartUpload   (const char* bucket, const char* key, const char* region,
+                                                     CredentialStore::Credential* credentials);
+        static char*        uploadPart              (const char* bucket, const char* key, const char* region,
+                                                     CredentialStore::Credential* credentials,
+                                                     const char* upload_id, int part_number,
+                                                     const uint8_t* data, int64_t size);
+        static void         completeMultipartUpload (const char* bucket, const char* key, const char* region,
+                                                     CredentialStore::Credential* credentials,
+                                                     const char* upload_id, const char** etags, int num_parts);
+        static void         abortMultipartUpload    (const char* bucket, const char* key, const char* region,
+                                                     CredentialStore::Credential* credentials,
+                                                     const char* upload_id);
+
         static int          luaGet          (lua_State* L);
         static int          luaDownload     (lua_State* L);
         static int          luaRead         (lua_State* L);
+        static int          luaReadv        (lua_State* L);
         static int          luaUpload       (lua_State* L);
+        static int          luaCoalesce     (lua_State* L);
+        static int          luaHedge        (lua_State* L);
+        static int          luaSignRate     (lua_State* L);
+        static int          luaMultipart    (lua_State* L);
 
     protected:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            uint8_t*                data;
+            int64_t                 size;
+            uint64_t                pos;
+            int                     first;      // index of first request in group (owner only)
+            int                     last;       // index of last request in group (owner only)
+            bool                    owner;      // issues the request for its group
+            bool                    planned;
+            bool                    complete;
+            bool                    valid;
+        } coalesce_rqst_t;
+
+        struct async_rqst_t; // defined in implementation, holds cURL state
+
+        typedef struct {
+            List<coalesce_rqst_t*>  rqsts;
+            coalesce_rqst_t**       sorted;     // requests ordered by position
+            int                     refs;
+        } coalesce_batch_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
+        static bool         startAsync      (void);
+        static void*        asyncThread     (void* parm);
+        static void         coalescePlan    (coalesce_batch_t* batch);
+        static bool         coalesceIssue   (coalesce_batch_t* batch, coalesce_rqst_t* owner,
+                                             const char* bucket, const char* key, const char* region,
+                                             CredentialStore::Credential* credentials);
+        static int          hedgeThreshold  (int64_t size); // milliseconds before a get is hedged, zero if it is not
+        static bool         hedgeAdmit      (void);
+        static void         hedgeRecord     (int64_t size, double seconds);
+
                             S3CurlIODriver  (const Asset* _asset);
                             S3CurlIODriver  (const Asset* _asset, const char* resource);
         virtual             ~S3CurlIODriver (void);
@@ -110,6 +315,40 @@ class S3CurlIODriver: public Asset::IODriver
          * Data
          *--------------------------------------------------------------------*/
 
+        static void*                                curlShare; // CURLSH handle
+        static Mutex                                shareLocks[NUM_SHARE_LOCKS];
+        static Mutex                                poolMutex;
+        static List<void*>                          curlPool; // idle CURL handles
+        static int32_t                              newConnMetric;
+        static int32_t                              reusedConnMetric;
+        static LatencyHistogram*                    getLatency;
+
+        static bool                                 asyncActive;
+        static Thread*                              asyncPid;
+        static void*                                asyncMulti; // CURLM handle
+        static Mutex                                asyncMutex;
+        static List<async_rqst_t*>                  asyncQueue; // requests waiting to be added to asyncMulti
+        static async_rqst_t*                        asyncInflight; // requests added to asyncMulti
+
+        static int                                  coalesceWindow;
+        static int64_t                              coalesceGap;
+        static Cond                                 coalesceCond;
+        static Dictionary<coalesce_batch_t*>        coalesceBatches;
+
+        static int                                  hedgePercentile;
+        static double                               hedgeBudget;
+        static Mutex                                hedgeMutex;
+        static double                               hedgeSamples[HEDGE_SAMPLES]; // seconds, ring
+        static long                                 hedgeSampleCount;
+        static int                                  hedgeThresholdMs; // zero until enough samples
+        static long                                 hedgeGets; // gets eligible for hedging
+        static long                                 hedgesIssued;
+        static int32_t                              hedgeMetric;
+        static int32_t                              hedgeWinMetric;
+
+        static int64_t                              partSize;
+        static int                                  uploadConcurrency;
+
         const Asset*                asset;
         CredentialStore::Credential latestCredentials;
         char*                       ioBucket;
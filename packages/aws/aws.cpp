@@ -57,7 +57,12 @@ int aws_open (lua_State *L)
         {"s3get",       S3CurlIODriver::luaGet},
         {"s3download",  S3CurlIODriver::luaDownload},
         {"s3read",      S3CurlIODriver::luaRead},
+        {"s3readv",     S3CurlIODriver::luaReadv},
         {"s3upload",    S3CurlIODriver::luaUpload},
+        {"s3coalesce",  S3CurlIODriver::luaCoalesce},
+        {"s3hedge",     S3CurlIODriver::luaHedge},
+        {"s3signrate",  S3CurlIODriver::luaSignRate},
+        {"s3multipart", S3CurlIODriver::luaMultipart},
         {"s3cache",     S3CacheIODriver::luaCreateCache},
         {NULL,          NULL}
     };
@@ -77,6 +82,7 @@ void initaws (void)
 {
     /* Initialize Modules */
     CredentialStore::init();
+    S3CurlIODriver::init();
 
     /* Register I/O Drivers */
     Asset::registerDriver(S3CacheIODriver::FORMAT, S3CacheIODriver::create);
@@ -95,6 +101,7 @@ void initaws (void)
 void deinitaws (void)
 {
     /* Uninitialize Modules */
+    S3CurlIODriver::deinit();
     CredentialStore::deinit();
 }
 }
@@ -37,6 +37,7 @@
 #include "core.h"
 
 #include <math.h>
+#include <string.h>
 
 /******************************************************************************
  * CCSDS SPACE PACKET - PUBLIC FUNCTIONS
@@ -567,22 +568,35 @@ bool CcsdsSpacePacket::validChecksum(void) const
  *----------------------------------------------------------------------------*/
 int CcsdsSpacePacket::computeChecksum(void) const
 {
-    uint16_t    len = getLEN();
+    int         len = getLEN();
     uint8_t     cs  = 0xFF;
     int         i   = 0;
 
-    if(getLEN() > 7 && isCMD() && hasSHDR())
+    if(len > 7 && isCMD() && hasSHDR())
     {
         if((max_pkt_len <= 0) || (len <= max_pkt_len))
         {
-            while (len--)
+            /* XOR Eight Bytes at a Time and Fold */
+            uint64_t acc = 0;
+            for(; i + 8 <= len; i += 8)
             {
-                if(i != 7)
-                {
-                    cs ^= buffer[i];
-                }
-                i++;
+                uint64_t word;
+                memcpy(&word, &buffer[i], sizeof(word));
+                acc ^= word;
             }
+            acc ^= acc >> 32;
+            acc ^= acc >> 16;
+            acc ^= acc >> 8;
+            cs ^= (uint8_t)acc;
+
+            /* Remaining Bytes */
+            for(; i < len; i++)
+            {
+                cs ^= buffer[i];
+            }
+
+            /* Exclude Checksum Byte */
+            cs ^= buffer[7];
             return cs;
         }
     }
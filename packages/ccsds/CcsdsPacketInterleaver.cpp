@@ -36,7 +36,10 @@
 #include "CcsdsPacketInterleaver.h"
 #include "CcsdsPacket.h"
 #include "core.h"
+
 #include <float.h>
+#include <algorithm>
+#include <vector>
 
 /******************************************************************************
  * STATIC DATA
@@ -146,6 +149,10 @@ CcsdsPacketInterleaver::~CcsdsPacketInterleaver(void)
 
 /*----------------------------------------------------------------------------
  * processorThread
+ *
+ *  k-way merge of the input streams by packet time; inputs holding a packet
+ *  are kept in a min-heap on the time of their next packet, and an input
+ *  is only read again (in batches) once all of its received packets are sent
  *----------------------------------------------------------------------------*/
 void* CcsdsPacketInterleaver::processorThread(void* parm)
 {
@@ -161,125 +168,174 @@ void* CcsdsPacketInterleaver::processorThread(void* parm)
         return NULL;
     }
 
-    /* Create Packet Arrays */
-    double* pkt_times = new double[num_inputs];
-    Subscriber::msgRef_t* pkt_refs = new Subscriber::msgRef_t[num_inputs];
-    bool* inq_valid = new bool[num_inputs];
-
-    /* Initialize Packet Arrays */
+    /* Create Inputs */
+    input_t* inputs = new input_t[num_inputs];
+    std::vector<int> heap; // indices of inputs with a packet, earliest on top
+    std::vector<int> empty; // indices of inputs that need to be read
+    heap.reserve(num_inputs);
+    empty.reserve(num_inputs);
     for(int i = 0; i < num_inputs; i++)
     {
-        pkt_refs[i].size = 0;
-        inq_valid[i] = true;
+        inputs[i].head = 0;
+        inputs[i].count = 0;
+        inputs[i].valid = true;
+        empty.push_back(i);
     }
 
+    /* Heap Order - later packet (ties broken by input) sinks */
+    auto later = [inputs](int a, int b) {
+        double ta = inputs[a].times[inputs[a].head];
+        double tb = inputs[b].times[inputs[b].head];
+        return (ta > tb) || (ta == tb && a > b);
+    };
+
     /* Loop While Read Active */
     int num_valid = num_inputs;
     while(processor->active && num_valid > 0)
     {
-        /* Read Packets */
-        for(int i = 0; i < num_inputs; i++)
+        /* Read Inputs That Have Run Out of Packets */
+        size_t e = 0;
+        while(e < empty.size())
         {
-            if(inq_valid[i] && pkt_refs[i].size == 0)
+            int i = empty[e];
+            input_t* input = &inputs[i];
+            if(processor->readInput(i, input))
             {
-                int status = processor->inQs[i]->receiveRef(pkt_refs[i], SYS_TIMEOUT);
-                if(status > 0)
-                {
-                    if(pkt_refs[i].size > 0)
-                    {
-                        /* Capture Packet Time */
-                        CcsdsSpacePacket pkt((unsigned char*)pkt_refs[i].data, pkt_refs[i].size);
-                        pkt_times[i] = pkt.getCdsTime();
-
-                        /* Check Time Filter */
-                        if(processor->startTime > 0 && pkt_times[i] < processor->startTime)
-                        {
-                            processor->inQs[i]->dereference(pkt_refs[i]);
-                            pkt_refs[i].size = 0;
-                        }
-                        else if(processor->stopTime > 0 && pkt_times[i] > processor->stopTime)
-                        {
-                            processor->inQs[i]->dereference(pkt_refs[i]);
-                            pkt_refs[i].size = 0;
-                        }
-                    }
-                    else
-                    {
-                        /* Terminator Received */
-                        processor->inQs[i]->dereference(pkt_refs[i]);
-                        inq_valid[i] = false;
-                        num_valid--;
-                        mlog(DEBUG, "Terminator received on %s (%d remaining)", processor->inQs[i]->getName(), num_valid);
-                    }
-                }
-                else if(status != MsgQ::STATE_TIMEOUT)
-                {
-                    mlog(CRITICAL, "Failed to read from input queue %s: %d", processor->inQs[i]->getName(), status);
-                    inq_valid[i] = false;
-                    num_valid--;
-                }
+                heap.push_back(i);
+                std::push_heap(heap.begin(), heap.end(), later);
+                empty[e] = empty.back();
+                empty.pop_back();
             }
-        }
-
-        /* Find Packet To Send */
-        int earliest_pkt = -1;
-        double earliest_pkt_time = DBL_MAX;
-        for(int i = 0; i < num_inputs; i++)
-        {
-            if(inq_valid[i] && pkt_refs[i].size > 0)
+            else if(!input->valid)
             {
-                if(pkt_times[i] < earliest_pkt_time)
-                {
-                    earliest_pkt = i;
-                    earliest_pkt_time = pkt_times[i];
-                }
+                num_valid--;
+                empty[e] = empty.back();
+                empty.pop_back();
+            }
+            else
+            {
+                e++; // still empty (timed out)
             }
         }
 
         /* Send Earliest Packet */
-        if(earliest_pkt >= 0)
+        if(!heap.empty())
         {
+            int i = heap.front();
+            input_t* input = &inputs[i];
+            Subscriber::msgRef_t& ref = input->refs[input->head];
+            std::pop_heap(heap.begin(), heap.end(), later);
+            heap.pop_back();
+
             int status = MsgQ::STATE_TIMEOUT;
             while(processor->active && status == MsgQ::STATE_TIMEOUT)
             {
-                status = processor->outQ->postCopy(pkt_refs[earliest_pkt].data, pkt_refs[earliest_pkt].size, SYS_TIMEOUT);
-                if(status > 0)
-                {
-                    processor->inQs[earliest_pkt]->dereference(pkt_refs[earliest_pkt]);
-                    pkt_refs[earliest_pkt].size = 0;
-                }
-                else if(status == MsgQ::STATE_TIMEOUT)
+                status = processor->outQ->postCopy(ref.data, ref.size, SYS_TIMEOUT);
+                if(status == MsgQ::STATE_TIMEOUT)
                 {
                     mlog(WARNING, "Unexepected timeout in interleaver on %s", processor->outQ->getName());
                 }
-                else
+                else if(status <= 0)
                 {
                     mlog(CRITICAL, "Failed to post to %s... exiting interleaver!", processor->outQ->getName());
                     processor->active = false;
                 }
             }
+
+            /* Advance Input (packet left in place when not sent) */
+            if(status > 0)
+            {
+                processor->inQs[i]->dereference(ref);
+                input->head++;
+            }
+            if(input->head < input->count)
+            {
+                heap.push_back(i);
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+            else
+            {
+                empty.push_back(i);
+            }
         }
     }
 
     /* Dereference Outstanding Messages */
     for(int i = 0; i < num_inputs; i++)
     {
-        if(inq_valid[i] && pkt_refs[i].size > 0)
+        while(inputs[i].head < inputs[i].count)
         {
-            processor->inQs[i]->dereference(pkt_refs[i]);
+            processor->inQs[i]->dereference(inputs[i].refs[inputs[i].head++]);
         }
     }
 
-    /* Free Packet Arrays */
-    delete [] pkt_times;
-    delete [] pkt_refs;
-    delete [] inq_valid;
+    /* Free Inputs */
+    delete [] inputs;
 
     /* Signal Complete */
     processor->signalComplete();
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * readInput
+ *
+ *  receives the next batch of packets on an input, dropping those outside
+ *  of the time filter; returns true if the input now holds a packet
+ *----------------------------------------------------------------------------*/
+bool CcsdsPacketInterleaver::readInput(int i, input_t* input)
+{
+    input->head = 0;
+    input->count = 0;
+
+    /* Nothing Follows a Terminator */
+    if(!input->valid) return false;
+
+    int status = inQs[i]->receiveBatch(input->refs, INPUT_BATCH_SIZE, SYS_TIMEOUT);
+    if(status > 0)
+    {
+        for(int r = 0; r < status; r++)
+        {
+            Subscriber::msgRef_t& ref = input->refs[r];
+            if(ref.size > 0 && input->valid)
+            {
+                /* Capture Packet Time */
+                CcsdsSpacePacket pkt((unsigned char*)ref.data, ref.size);
+                double pkt_time = pkt.getCdsTime();
+
+                /* Check Time Filter */
+                if((startTime > 0 && pkt_time < startTime) || (stopTime > 0 && pkt_time > stopTime))
+                {
+                    inQs[i]->dereference(ref);
+                }
+                else
+                {
+                    input->refs[input->count] = ref;
+                    input->times[input->count] = pkt_time;
+                    input->count++;
+                }
+            }
+            else
+            {
+                /* Terminator Received (or packet after terminator) */
+                inQs[i]->dereference(ref);
+                if(input->valid)
+                {
+                    input->valid = false;
+                    mlog(DEBUG, "Terminator received on %s", inQs[i]->getName());
+                }
+            }
+        }
+    }
+    else if(status != MsgQ::STATE_TIMEOUT)
+    {
+        mlog(CRITICAL, "Failed to read from input queue %s: %d", inQs[i]->getName(), status);
+        input->valid = false;
+    }
+
+    return input->count > 0;
+}
+
 /*----------------------------------------------------------------------------
  * luaSetStartTime - :start(<gmt time>)
  *----------------------------------------------------------------------------*/
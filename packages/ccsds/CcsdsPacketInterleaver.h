@@ -74,6 +74,24 @@ class CcsdsPacketInterleaver: public LuaObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int INPUT_BATCH_SIZE = 64; // packets received from an input at a time
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            Subscriber::msgRef_t    refs[INPUT_BATCH_SIZE];
+            double                  times[INPUT_BATCH_SIZE];
+            int                     head;       // next packet to send
+            int                     count;      // packets received in batch
+            bool                    valid;      // input not yet terminated
+        } input_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -90,6 +108,7 @@ class CcsdsPacketInterleaver: public LuaObject
          *--------------------------------------------------------------------*/
 
         static void*    processorThread (void* parm);
+        bool            readInput       (int i, input_t* input);
         static int      luaSetStartTime (lua_State* L);
         static int      luaSetStopTime  (lua_State* L);
 };
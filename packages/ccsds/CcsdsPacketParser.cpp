@@ -472,6 +472,21 @@ bool CcsdsPacketParser::processMsg (unsigned char* msg, int bytes)
         /* Determine Number of Bytes left */
         int bytes_left = recv_bytes - recv_index;
 
+        /* Process Packets Contained in Buffer In Place */
+        unsigned char* view = NULL;
+        int view_size = 0;
+        int view_bytes = parser->parseView(&recv_buffer[recv_index], bytes_left, pkt, &view, &view_size);
+        if(view_bytes > 0)
+        {
+            if(!parserInSync) mlog(INFO, "Parser %s re-established sync at %ld", getName(), parserBytes);
+            parserInSync = true;
+
+            CcsdsSpacePacket view_pkt(view, view_size, false);
+            processPkt(&view_pkt);
+            recv_index += view_bytes;
+            continue;
+        }
+
         /* Parse Buffer */
         int parse_bytes = parser->parseBuffer(&recv_buffer[recv_index], bytes_left, pkt);
         if(parse_bytes >= 0)
@@ -496,93 +511,99 @@ bool CcsdsPacketParser::processMsg (unsigned char* msg, int bytes)
         /* Full Packet Received */
         if(pkt->isFull())
         {
-            uint16_t  apid    = pkt->getAPID();
-            uint16_t  len     = pkt->getLEN();
-            if(filter[apid])
+            processPkt(pkt);
+            pkt->resetPkt();
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processPkt
+ *----------------------------------------------------------------------------*/
+void CcsdsPacketParser::processPkt (CcsdsPacket* _pkt)
+{
+    uint16_t  apid    = _pkt->getAPID();
+    uint16_t  len     = _pkt->getLEN();
+    if(filter[apid])
+    {
+        /* Validate Packet */
+        bool valid = true;
+        if(_pkt->getType() == CcsdsPacket::SPACE_PACKET)
+        {
+            valid = isValid(_pkt->getBuffer(), _pkt->getLEN(), true);
+        }
+        else if(_pkt->getType() == CcsdsPacket::ENCAPSULATION_PACKET)
+        {
+            valid = _pkt->getAPID() != CCSDS_ENCAP_PROTO_IDLE;
+        }
+
+        /* Process Packet */
+        if(valid == true || passInvalid == true)
+        {
+            /* Increment Stats */
+            apidStats[apid].total_pkts++;
+            apidStats[apid].curr_pkts++;
+            apidStats[ALL_APIDS].total_pkts++;
+            apidStats[ALL_APIDS].curr_pkts++;
+            apidStats[apid].total_bytes += len;
+            apidStats[apid].curr_bytes += len;
+            apidStats[ALL_APIDS].total_bytes += len;
+            apidStats[ALL_APIDS].curr_bytes += len;
+
+            /* Post Packet */
+            if(outQ != NULL)
             {
-                /* Validate Packet */
-                bool valid = true;
-                if(pkt->getType() == CcsdsPacket::SPACE_PACKET)
-                {
-                    valid = isValid(pkt->getBuffer(), pkt->getLEN(), true);
-                }
-                else if(pkt->getType() == CcsdsPacket::ENCAPSULATION_PACKET)
+                int status = MsgQ::STATE_TIMEOUT;
+                while(isActive() && status == MsgQ::STATE_TIMEOUT)
                 {
-                    valid = pkt->getAPID() != CCSDS_ENCAP_PROTO_IDLE;
-                }
+                    /* Get Buffer and Buffer Size */
+                    unsigned char* bufptr = _pkt->getBuffer();
+                    int buflen = _pkt->getLEN();
+                    if(stripHdrOnPost)
+                    {
+                        bufptr += _pkt->getHdrSize();
+                        buflen -= _pkt->getHdrSize();
+                    }
 
-                /* Process Packet */
-                if(valid == true || passInvalid == true)
-                {
-                    /* Increment Stats */
-                    apidStats[apid].total_pkts++;
-                    apidStats[apid].curr_pkts++;
-                    apidStats[ALL_APIDS].total_pkts++;
-                    apidStats[ALL_APIDS].curr_pkts++;
-                    apidStats[apid].total_bytes += len;
-                    apidStats[apid].curr_bytes += len;
-                    apidStats[ALL_APIDS].total_bytes += len;
-                    apidStats[ALL_APIDS].curr_bytes += len;
-
-                    /* Post Packet */
-                    if(outQ != NULL)
+                    /* Check Buffer Size */
+                    if(buflen <= 0)
                     {
-                        int status = MsgQ::STATE_TIMEOUT;
-                        while(isActive() && status == MsgQ::STATE_TIMEOUT)
-                        {
-                            /* Get Buffer and Buffer Size */
-                            unsigned char* bufptr = pkt->getBuffer();
-                            int buflen = pkt->getLEN();
-                            if(stripHdrOnPost)
-                            {
-                                bufptr += pkt->getHdrSize();
-                                buflen -= pkt->getHdrSize();
-                            }
-
-                            /* Check Buffer Size */
-                            if(buflen <= 0)
-                            {
-                                mlog(CRITICAL, "Packet %04X has invalid size %d", pkt->getAPID(), buflen);
-                                break;
-                            }
-
-                            /* Post Buffer */
-                            status = outQ->postCopy(bufptr, buflen, SYS_TIMEOUT);
-                            if((status != MsgQ::STATE_TIMEOUT) && (status < 0))
-                            {
-                                mlog(CRITICAL, "Packet %04X unable to be posted[%d] to output stream %s", pkt->getAPID(), status, outQ->getName());
-                                apidStats[apid].pkts_dropped++;
-                                apidStats[ALL_APIDS].pkts_dropped++;
-                                break;
-                            }
-                        }
+                        mlog(CRITICAL, "Packet %04X has invalid size %d", _pkt->getAPID(), buflen);
+                        break;
                     }
-                }
-                else
-                {
-                    mlog(WARNING, "Packet %04X dropped", pkt->getAPID());
-                    apidStats[apid].pkts_dropped++;
-                    apidStats[ALL_APIDS].pkts_dropped++;
-                }
 
-                /* Handle Bad Packets */
-                if(valid == false && resetInvalid == true)
-                {
-                    parser->gotoInitState(true);
+                    /* Post Buffer */
+                    status = outQ->postCopy(bufptr, buflen, SYS_TIMEOUT);
+                    if((status != MsgQ::STATE_TIMEOUT) && (status < 0))
+                    {
+                        mlog(CRITICAL, "Packet %04X unable to be posted[%d] to output stream %s", _pkt->getAPID(), status, outQ->getName());
+                        apidStats[apid].pkts_dropped++;
+                        apidStats[ALL_APIDS].pkts_dropped++;
+                        break;
+                    }
                 }
             }
-            else
-            {
-                apidStats[apid].pkts_filtered++;
-                apidStats[ALL_APIDS].pkts_filtered++;
-            }
+        }
+        else
+        {
+            mlog(WARNING, "Packet %04X dropped", _pkt->getAPID());
+            apidStats[apid].pkts_dropped++;
+            apidStats[ALL_APIDS].pkts_dropped++;
+        }
 
-            /* Reset Packet */
-            pkt->resetPkt();
+        /* Handle Bad Packets */
+        if(valid == false && resetInvalid == true)
+        {
+            parser->gotoInitState(true);
         }
     }
-
-    return true;
+    else
+    {
+        apidStats[apid].pkts_filtered++;
+        apidStats[ALL_APIDS].pkts_filtered++;
+    }
 }
 
 /*----------------------------------------------------------------------------
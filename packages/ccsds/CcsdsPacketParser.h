@@ -140,6 +140,7 @@ class CcsdsPacketParser: public MsgProcessor
 
         bool            deinitProcessing        (void) override;
         bool            processMsg              (unsigned char* msg, int bytes) override;
+        void            processPkt              (CcsdsPacket* _pkt);
         bool            isValid                 (unsigned char* _pkt, unsigned int _len, bool ignore_length);
 
         static CcsdsPacket::type_t  str2pkttype         (const char* str);
@@ -93,6 +93,13 @@ CcsdsPacketizer::CcsdsPacketizer(lua_State* L, const char* inq_name, const char*
     else hdrLength = 0;
     LocalLib::set(seqTable, 0, sizeof(seqTable));
 
+    /* Build Telemetry Header Template */
+    LocalLib::set(hdrBuffer, 0, sizeof(hdrBuffer));
+    hdrTemplate = new CcsdsSpacePacket(hdrBuffer, sizeof(hdrBuffer), false);
+    hdrTemplate->setAPID(apid);
+    hdrTemplate->setSHDR(true);
+    hdrTemplate->setTLM();
+
     /* Set Streams - Required: names cannot be NULL */
     outQ = new Publisher(outq_name);
 
@@ -109,6 +116,7 @@ CcsdsPacketizer::~CcsdsPacketizer(void)
     stop();
 
     delete outQ;
+    delete hdrTemplate;
 }
 
 /*----------------------------------------------------------------------------
@@ -116,6 +124,12 @@ CcsdsPacketizer::~CcsdsPacketizer(void)
  *----------------------------------------------------------------------------*/
 bool CcsdsPacketizer::processMsg (unsigned char* msg, int bytes)
 {
+    /* Telemetry Uses Header Template */
+    if(pktType == TLM_PKT)
+    {
+        return packetizeTlm(msg, bytes);
+    }
+
     int pkt_len = hdrLength + bytes;
 
     if(pkt_len > maxLength)
@@ -157,6 +171,57 @@ bool CcsdsPacketizer::processMsg (unsigned char* msg, int bytes)
     return true;
 }
 
+/*----------------------------------------------------------------------------
+ * packetizeTlm
+ *
+ *  patches the header template for each packet and posts it along with its
+ *  slice of the message, so the payload is copied once, straight into the
+ *  queue; messages larger than a packet are split into segmented packets
+ *  that all carry the time latched when the message arrived
+ *----------------------------------------------------------------------------*/
+bool CcsdsPacketizer::packetizeTlm (unsigned char* msg, int bytes)
+{
+    int max_payload = maxLength - hdrLength;
+    if(max_payload <= 0)
+    {
+        mlog(ERROR, "Maximum packet length in %s leaves no room for payload: %d", getName(), maxLength);
+        return false;
+    }
+
+    /* Latch Time Once for Message */
+    hdrTemplate->setLEN(maxLength); // time is only set when length covers secondary header
+    hdrTemplate->setCdsTime(getCurrGPSTime());
+
+    /* Post Packets */
+    int offset = 0;
+    do
+    {
+        int payload = MIN(bytes - offset, max_payload);
+        bool first = (offset == 0);
+        bool last = (offset + payload >= bytes);
+
+        /* Patch Header */
+        if(first && last)   hdrTemplate->setSEQFLG(CcsdsSpacePacket::SEG_NONE);
+        else if(first)      hdrTemplate->setSEQFLG(CcsdsSpacePacket::SEG_START);
+        else if(last)       hdrTemplate->setSEQFLG(CcsdsSpacePacket::SEG_STOP);
+        else                hdrTemplate->setSEQFLG(CcsdsSpacePacket::SEG_CONTINUE);
+        hdrTemplate->setSEQ(seqTable[hdrTemplate->getAPID()]++);
+        hdrTemplate->setLEN(hdrLength + payload);
+
+        /* Post Header and Payload Slice */
+        int status = outQ->postCopy(hdrBuffer, hdrLength, msg + offset, payload);
+        if(status <= 0)
+        {
+            mlog(ERROR, "failed to post packetized record %04X", apid);
+            break; // rest of a segmented message is of no use
+        }
+
+        offset += payload;
+    } while(offset < bytes);
+
+    return true;
+}
+
 /*----------------------------------------------------------------------------
  * getCurrGPSTime
  *----------------------------------------------------------------------------*/
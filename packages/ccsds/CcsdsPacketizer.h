@@ -84,6 +84,9 @@ class CcsdsPacketizer: public MsgProcessor
 
         uint16_t            seqTable[CCSDS_NUM_APIDS];
 
+        unsigned char       hdrBuffer[CcsdsSpacePacket::CCSDS_TLMPAY_OFFSET]; // telemetry header template, patched per packet
+        CcsdsSpacePacket*   hdrTemplate;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -92,6 +95,7 @@ class CcsdsPacketizer: public MsgProcessor
                         ~CcsdsPacketizer    (void);
 
         bool            processMsg          (unsigned char* msg, int bytes); // OVERLOAD
+        bool            packetizeTlm        (unsigned char* msg, int bytes);
 
         static double   getCurrGPSTime      (void);
 };
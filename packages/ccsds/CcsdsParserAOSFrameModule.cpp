@@ -479,8 +479,31 @@ uint16_t CcsdsParserAOSFrameModule::crc16(uint8_t* data, uint32_t len, uint16_t
         0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
     };
 
-    uint32_t i;
-    for (i = 0 ; i < len ; i++)
+    /* Slicing-by-8 Tables - CrcTable advanced by 0 to 7 additional bytes */
+    struct crc_slices_t {
+        uint16_t t[8][256];
+        crc_slices_t(const uint16_t* t0) {
+            for(int b = 0; b < 256; b++) t[0][b] = t0[b];
+            for(int k = 1; k < 8; k++)
+                for(int b = 0; b < 256; b++)
+                    t[k][b] = (t[k-1][b] >> 8) ^ t0[t[k-1][b] & 0x00FF];
+        }
+    };
+    static const crc_slices_t Slices(CrcTable);
+
+    /* Eight Bytes at a Time */
+    uint32_t i = 0;
+    for(; i + 8 <= len; i += 8)
+    {
+        const uint8_t* d = &data[i];
+        crc ^= (uint16_t)(d[0] | (d[1] << 8));
+        crc = Slices.t[7][crc & 0x00FF] ^ Slices.t[6][crc >> 8] ^
+              Slices.t[5][d[2]] ^ Slices.t[4][d[3]] ^ Slices.t[3][d[4]] ^
+              Slices.t[2][d[5]] ^ Slices.t[1][d[6]] ^ Slices.t[0][d[7]];
+    }
+
+    /* Remaining Bytes */
+    for(; i < len; i++)
     {
        crc = ( (crc >> 8 ) & 0x00FF) ^ CrcTable[( crc ^ data[i]) & 0x00FF];
     }
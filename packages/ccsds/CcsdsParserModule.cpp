@@ -77,6 +77,7 @@ int CcsdsParserModule::luaCreate (lua_State* L)
 CcsdsParserModule::CcsdsParserModule(lua_State* L):
     LuaObject(L, OBJECT_TYPE, LuaMetaName, LuaMetaTable)
 {
+    passThrough = true;
     gotoInitState(true);
 }
 
@@ -86,6 +87,7 @@ CcsdsParserModule::CcsdsParserModule(lua_State* L):
 CcsdsParserModule::CcsdsParserModule(lua_State* L, const char* meta_name, const struct luaL_Reg meta_table[]):
     LuaObject(L, OBJECT_TYPE, meta_name, meta_table)
 {
+    passThrough = false; // derived modules provide their own views
     gotoInitState(true);
 }
 
@@ -104,6 +106,19 @@ int CcsdsParserModule::parseBuffer (unsigned char* buffer, int bytes, CcsdsPacke
     return pkt->appendStream(buffer, bytes);
 }
 
+/*----------------------------------------------------------------------------
+ * parseView
+ *
+ *  When the next packet lies entirely within the buffer, points view at it
+ *  so that it can be processed in place instead of being copied into pkt;
+ *  returns 0 when the packet must be reassembled through parseBuffer
+ *----------------------------------------------------------------------------*/
+int CcsdsParserModule::parseView (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size)
+{
+    if(!passThrough) return 0;
+    return viewSpacePacket(buffer, bytes, pkt, view, view_size);
+}
+
 /*----------------------------------------------------------------------------
  * gotoInitState
  *----------------------------------------------------------------------------*/
@@ -111,3 +126,26 @@ void CcsdsParserModule::gotoInitState(bool reset)
 {
     (void)reset;
 }
+
+/******************************************************************************
+ * PROTECTED METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * viewSpacePacket
+ *----------------------------------------------------------------------------*/
+int CcsdsParserModule::viewSpacePacket (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size)
+{
+    /* Only Whole Space Packets Not Already Started */
+    if(pkt->getType() != CcsdsPacket::SPACE_PACKET) return 0;
+    if(pkt->getIndex() != 0) return 0;
+    if(bytes < CCSDS_SPACE_HEADER_SIZE) return 0;
+
+    /* Check Packet Does Not Straddle Buffer */
+    int len = CCSDS_GET_LEN(buffer);
+    if(len > bytes) return 0;
+
+    *view = buffer;
+    *view_size = len;
+    return len;
+}
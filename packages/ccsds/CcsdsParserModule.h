@@ -62,6 +62,7 @@ class CcsdsParserModule: public LuaObject
         static int      luaCreate       (lua_State* L);
 
         virtual int     parseBuffer     (unsigned char* buffer, int bytes, CcsdsPacket* pkt); // returns number of bytes consumed
+        virtual int     parseView       (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size); // returns number of bytes consumed, 0 if no view
         virtual void    gotoInitState   (bool reset);
 
     protected:
@@ -74,6 +75,8 @@ class CcsdsParserModule: public LuaObject
         CcsdsParserModule   (lua_State* L, const char* meta_name, const struct luaL_Reg meta_table[]);
         ~CcsdsParserModule  (void);
 
+        int             viewSpacePacket (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size);
+
     private:
 
         /*--------------------------------------------------------------------
@@ -82,6 +85,12 @@ class CcsdsParserModule: public LuaObject
 
         static const char*  LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        bool                passThrough;    // module does not transform the stream
 };
 
 #endif  /* __ccsds_parser_module__ */
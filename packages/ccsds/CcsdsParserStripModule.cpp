@@ -130,6 +130,20 @@ int CcsdsParserStripModule::parseBuffer (unsigned char* buffer, int bytes, Ccsds
     return parse_index;
 }
 
+/*----------------------------------------------------------------------------
+ * parseView
+ *----------------------------------------------------------------------------*/
+int CcsdsParserStripModule::parseView (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size)
+{
+    /* Only When Header and Packet Are Both in Buffer */
+    if(state != HDR || HdrBytes != HDR_SIZE || bytes <= HDR_SIZE) return 0;
+
+    int view_bytes = viewSpacePacket(&buffer[HDR_SIZE], bytes - HDR_SIZE, pkt, view, view_size);
+    if(view_bytes <= 0) return 0;
+
+    return HDR_SIZE + view_bytes;
+}
+
 /*----------------------------------------------------------------------------
  * gotoInitState
  *----------------------------------------------------------------------------*/
@@ -54,6 +54,7 @@ class CcsdsParserStripModule: public CcsdsParserModule
 
         static int  luaCreate       (lua_State* L);
         int         parseBuffer     (unsigned char* buffer, int bytes, CcsdsPacket* pkt); // returns number of bytes consumed
+        int         parseView       (unsigned char* buffer, int bytes, CcsdsPacket* pkt, unsigned char** view, int* view_size);
         void        gotoInitState   (bool reset);
 
     private:
@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __array_list__
+#define __array_list__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "RTExcept.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <new>
+#include <utility>
+
+/******************************************************************************
+ * ARRAY LIST TEMPLATE
+ *
+ *  Contiguous alternative to List with the same interface.  Elements are held
+ *  in a single array that doubles in size as needed, so get is a direct index
+ *  and begin/end walk the elements in memory order.  Elements are moved rather
+ *  than copied when the array grows or shifts, and add accepts rvalues, so
+ *  non-POD types such as std::string are not copied needlessly.  Pointers and
+ *  references to elements are invalidated by add, remove, and reserve.
+ ******************************************************************************/
+
+template <class T>
+class ArrayList
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DEFAULT_LIST_SIZE = 16;
+
+        /*--------------------------------------------------------------------
+         * Iterator Subclass
+         *--------------------------------------------------------------------*/
+
+        class Iterator
+        {
+            public:
+                                    Iterator    (const ArrayList& l);
+                                    ~Iterator   (void);
+                const T&            operator[]  (int index) const;
+                const int           length;
+            private:
+                const T*            elements;
+        };
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                    ArrayList   (int initial_size=DEFAULT_LIST_SIZE);
+                    ArrayList   (const ArrayList& l1);
+                    ArrayList   (ArrayList&& l1);
+        virtual     ~ArrayList  (void);
+
+        int         add         (const T& data);
+        int         add         (T&& data);
+        bool        remove      (int index);
+        T&          get         (int index);
+        const T&    get         (int index) const;
+        bool        set         (int index, T& data, bool with_delete=true);
+        int         length      (void) const;
+        void        clear       (void);
+        void        sort        (void);
+        void        reserve     (int size);
+        int         capacity    (void) const;
+
+        T*          begin       (void);
+        T*          end         (void);
+        const T*    begin       (void) const;
+        const T*    end         (void) const;
+
+        T&          operator[]  (int index);
+        const T&    operator[]  (int index) const;
+        ArrayList&  operator=   (const ArrayList& l1);
+        ArrayList&  operator=   (ArrayList&& l1);
+
+    protected:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        T*              elements;   // raw storage, only [0, len) is constructed
+        int             len;
+        int             maxLen;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        void            copy                (const ArrayList& l1);
+        void            grow                (int size);
+        void            destroy             (void);
+        virtual void    freeNode            (int index);
+        void            quicksort           (T* array, int start, int end);
+        int             quicksortpartition  (T* array, int start, int end);
+};
+
+/******************************************************************************
+ * MANAGED ARRAY LIST TEMPLATE
+ ******************************************************************************/
+
+template <class T, bool is_array=false>
+class MgArrayList: public ArrayList<T>
+{
+    public:
+        MgArrayList (int initial_size=ArrayList<T>::DEFAULT_LIST_SIZE);
+        ~MgArrayList (void);
+    private:
+        void freeNode (int index);
+};
+
+/******************************************************************************
+ * ITERATOR METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::Iterator::Iterator(const ArrayList& l):
+    length(l.len),
+    elements(l.elements)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::Iterator::~Iterator(void)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * []
+ *----------------------------------------------------------------------------*/
+template <class T>
+const T& ArrayList<T>::Iterator::operator[](int index) const
+{
+    if( (index < length) && (index >= 0) )
+    {
+        return elements[index];
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "ArrayList::Iterator index out of range");
+    }
+}
+
+/******************************************************************************
+ * ARRAY LIST METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::ArrayList(int initial_size)
+{
+    assert(initial_size > 0);
+
+    elements = static_cast<T*>(::operator new(sizeof(T) * initial_size));
+    len = 0;
+    maxLen = initial_size;
+}
+
+/*----------------------------------------------------------------------------
+ * Copy Constructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::ArrayList(const ArrayList<T>& l1)
+{
+    elements = static_cast<T*>(::operator new(sizeof(T) * l1.maxLen));
+    len = 0;
+    maxLen = l1.maxLen;
+    copy(l1);
+}
+
+/*----------------------------------------------------------------------------
+ * Move Constructor
+ *
+ *  takes over the storage, leaving l1 empty with no capacity
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::ArrayList(ArrayList<T>&& l1)
+{
+    elements = l1.elements;
+    len = l1.len;
+    maxLen = l1.maxLen;
+
+    l1.elements = NULL;
+    l1.len = 0;
+    l1.maxLen = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>::~ArrayList(void)
+{
+    /* freeNode is virtual, so managed lists clear in their own destructor */
+    destroy();
+    ::operator delete(elements);
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *----------------------------------------------------------------------------*/
+template <class T>
+int ArrayList<T>::add(const T& data)
+{
+    if(len >= maxLen)
+    {
+        T tmp(data); // data may be an element of this list
+        grow(maxLen > 0 ? maxLen * 2 : DEFAULT_LIST_SIZE);
+        new (&elements[len]) T(std::move(tmp));
+    }
+    else
+    {
+        new (&elements[len]) T(data);
+    }
+
+    return len++;
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *----------------------------------------------------------------------------*/
+template <class T>
+int ArrayList<T>::add(T&& data)
+{
+    if(len >= maxLen)
+    {
+        T tmp(std::move(data)); // data may be an element of this list
+        grow(maxLen > 0 ? maxLen * 2 : DEFAULT_LIST_SIZE);
+        new (&elements[len]) T(std::move(tmp));
+    }
+    else
+    {
+        new (&elements[len]) T(std::move(data));
+    }
+
+    return len++;
+}
+
+/*----------------------------------------------------------------------------
+ * remove
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool ArrayList<T>::remove(int index)
+{
+    if( (index < len) && (index >= 0) )
+    {
+        /* Remove the Data */
+        freeNode(index);
+
+        /* Shift Remaining Elements */
+        for(int i = index; i < len - 1; i++)
+        {
+            elements[i] = std::move(elements[i + 1]);
+        }
+
+        /* Destroy Vacated Element */
+        len--;
+        elements[len].~T();
+
+        return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * get
+ *----------------------------------------------------------------------------*/
+template <class T>
+T& ArrayList<T>::get(int index)
+{
+    if( (index < len) && (index >= 0) )
+    {
+        return elements[index];
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "ArrayList::get index out of range");
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * get (const)
+ *----------------------------------------------------------------------------*/
+template <class T>
+const T& ArrayList<T>::get(int index) const
+{
+    if( (index < len) && (index >= 0) )
+    {
+        return elements[index];
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "ArrayList::get index out of range");
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * set
+ *
+ *  with_delete which is defaulted to true, can be set to false for times when
+ *  the list is reordered in place and the caller wants control over deallocation
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool ArrayList<T>::set(int index, T& data, bool with_delete)
+{
+    if( (index < len) && (index >= 0) )
+    {
+        if(with_delete) freeNode(index);
+        elements[index] = data;
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * length
+ *----------------------------------------------------------------------------*/
+template <class T>
+int ArrayList<T>::length(void) const
+{
+    return len;
+}
+
+/*----------------------------------------------------------------------------
+ * clear
+ *
+ *  capacity is kept so the list can be refilled without reallocating
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::clear(void)
+{
+    for(int i = 0; i < len; i++) freeNode(i);
+    destroy();
+}
+
+/*----------------------------------------------------------------------------
+ * sort
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::sort(void)
+{
+    quicksort(elements, 0, len - 1);
+}
+
+/*----------------------------------------------------------------------------
+ * reserve
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::reserve(int size)
+{
+    if(size > maxLen) grow(size);
+}
+
+/*----------------------------------------------------------------------------
+ * capacity
+ *----------------------------------------------------------------------------*/
+template <class T>
+int ArrayList<T>::capacity(void) const
+{
+    return maxLen;
+}
+
+/*----------------------------------------------------------------------------
+ * begin
+ *----------------------------------------------------------------------------*/
+template <class T>
+T* ArrayList<T>::begin(void)
+{
+    return elements;
+}
+
+/*----------------------------------------------------------------------------
+ * end
+ *----------------------------------------------------------------------------*/
+template <class T>
+T* ArrayList<T>::end(void)
+{
+    return elements + len;
+}
+
+/*----------------------------------------------------------------------------
+ * begin
+ *----------------------------------------------------------------------------*/
+template <class T>
+const T* ArrayList<T>::begin(void) const
+{
+    return elements;
+}
+
+/*----------------------------------------------------------------------------
+ * end
+ *----------------------------------------------------------------------------*/
+template <class T>
+const T* ArrayList<T>::end(void) const
+{
+    return elements + len;
+}
+
+/*----------------------------------------------------------------------------
+ * []
+ *----------------------------------------------------------------------------*/
+template <class T>
+T& ArrayList<T>::operator[](int index)
+{
+    return get(index);
+}
+
+/*----------------------------------------------------------------------------
+ * [] (const)
+ *----------------------------------------------------------------------------*/
+template <class T>
+const T& ArrayList<T>::operator[](int index) const
+{
+    return get(index);
+}
+
+/*----------------------------------------------------------------------------
+ * =
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>& ArrayList<T>::operator= (const ArrayList<T>& l1)
+{
+    if(this == &l1) return *this;
+    clear();
+    copy(l1);
+    return *this;
+}
+
+/*----------------------------------------------------------------------------
+ * = (move)
+ *----------------------------------------------------------------------------*/
+template <class T>
+ArrayList<T>& ArrayList<T>::operator= (ArrayList<T>&& l1)
+{
+    if(this == &l1) return *this;
+    clear();
+    ::operator delete(elements);
+
+    elements = l1.elements;
+    len = l1.len;
+    maxLen = l1.maxLen;
+
+    l1.elements = NULL;
+    l1.len = 0;
+    l1.maxLen = 0;
+
+    return *this;
+}
+
+/*----------------------------------------------------------------------------
+ * copy
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::copy(const ArrayList<T>& l1)
+{
+    reserve(l1.len);
+    for(int i = 0; i < l1.len; i++)
+    {
+        new (&elements[i]) T(l1.elements[i]);
+    }
+    len = l1.len;
+}
+
+/*----------------------------------------------------------------------------
+ * grow
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::grow(int size)
+{
+    T* new_elements = static_cast<T*>(::operator new(sizeof(T) * size));
+    for(int i = 0; i < len; i++)
+    {
+        new (&new_elements[i]) T(std::move(elements[i]));
+        elements[i].~T();
+    }
+    ::operator delete(elements);
+
+    elements = new_elements;
+    maxLen = size;
+}
+
+/*----------------------------------------------------------------------------
+ * destroy
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::destroy(void)
+{
+    for(int i = 0; i < len; i++) elements[i].~T();
+    len = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::freeNode(int index)
+{
+    (void)index;
+}
+
+/*----------------------------------------------------------------------------
+ * quicksort
+ *----------------------------------------------------------------------------*/
+template <class T>
+void ArrayList<T>::quicksort(T* array, int start, int end)
+{
+    if(start < end)
+    {
+        int partition = quicksortpartition(array, start, end);
+        quicksort(array, start, partition);
+        quicksort(array, partition + 1, end);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * quicksortpartition
+ *----------------------------------------------------------------------------*/
+template <class T>
+int ArrayList<T>::quicksortpartition(T* array, int start, int end)
+{
+    T pivot = array[(start + end) / 2];
+
+    start--;
+    end++;
+    while(true)
+    {
+        while (array[++start] < pivot);
+        while (pivot < array[--end]);
+        if (start >= end) return end;
+
+        std::swap(array[start], array[end]);
+    }
+}
+
+/******************************************************************************
+ * MANAGED ARRAY LIST METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+MgArrayList<T, is_array>::MgArrayList(int initial_size): ArrayList<T>(initial_size)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+MgArrayList<T, is_array>::~MgArrayList(void)
+{
+    ArrayList<T>::clear();
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+void MgArrayList<T, is_array>::freeNode(int index)
+{
+    if(!is_array)   delete ArrayList<T>::elements[index];
+    else            delete [] ArrayList<T>::elements[index];
+}
+
+#endif  /* __array_list__ */
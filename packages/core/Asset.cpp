@@ -41,6 +41,8 @@
 #include "OsApi.h"
 #include "StringLib.h"
 
+#include <cmath>
+
 /******************************************************************************
  * STATIC DATA
  ******************************************************************************/
@@ -50,6 +52,8 @@ const char* Asset::LuaMetaName = "Asset";
 const struct luaL_Reg Asset::LuaMetaTable[] = {
     {"info",        luaInfo},
     {"load",        luaLoad},
+    {"loadindex",   luaLoadIndex},
+    {"saveindex",   luaSaveIndex},
     {NULL,          NULL}
 };
 
@@ -156,12 +160,16 @@ Asset::IODriver* Asset::createDriver (const char* resource) const
  *----------------------------------------------------------------------------*/
 Asset::~Asset (void)
 {
+    loaderActive = false;
+    if(loaderPid) delete loaderPid;
+    if(loaderFile) delete [] loaderFile;
+
     if(attributes.name)     delete [] attributes.name;
-    if(attributes.format)   delete [] attributes.format;
     if(attributes.path)     delete [] attributes.path;
     if(attributes.index)    delete [] attributes.index;
-    if(attributes.region)   delete [] attributes.region;
-    if(attributes.endpoint) delete [] attributes.endpoint;
+
+    for(int c = 0; c < attrColumns.length(); c++) delete attrColumns[c];
+    for(int b = 0; b < namePool.length(); b++) delete [] namePool[b];
 }
 
 /*----------------------------------------------------------------------------
@@ -169,15 +177,148 @@ Asset::~Asset (void)
  *----------------------------------------------------------------------------*/
 int Asset::load (resource_t& resource)
 {
-    return resources.add(resource);
+    resourceMut.lock();
+    int index = addResource(resource.name, StringLib::size(resource.name, RESOURCE_NAME_LENGTH));
+    double value;
+    const char* key = resource.attributes.first(&value);
+    while(key)
+    {
+        int column = addColumn(key);
+        (*attrColumns[column])[index] = value;
+        key = resource.attributes.next(&value);
+    }
+    resourceMut.unlock();
+    return index;
+}
+
+/*----------------------------------------------------------------------------
+ * loadIndex
+ *
+ *  loads every resource listed in an index file, which is either a csv
+ *  file with a header row naming the columns (the "name" column is the
+ *  resource and every other column is an attribute), or a snapshot
+ *  written by saveIndex; snapshots are recognized by their header
+ *----------------------------------------------------------------------------*/
+bool Asset::loadIndex (const char* file)
+{
+    size_t size = 0;
+    const uint8_t* buffer = (const uint8_t*)LocalLib::mapfile(file, &size);
+    if(!buffer)
+    {
+        mlog(CRITICAL, "Failed to open asset index %s: %s", file, LocalLib::err2str(errno));
+        return false;
+    }
+
+    bool status;
+    const snapshot_hdr_t* hdr = (const snapshot_hdr_t*)buffer;
+    if(size >= sizeof(snapshot_hdr_t) && hdr->magic == SNAPSHOT_MAGIC)
+    {
+        status = loadSnapshot(file, buffer, size);
+    }
+    else
+    {
+        status = loadCsv(file, (const char*)buffer, size);
+    }
+
+    LocalLib::unmapfile(buffer, size);
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * saveIndex
+ *
+ *  writes the resources of the asset as a snapshot that loadIndex can
+ *  read back without parsing any text
+ *----------------------------------------------------------------------------*/
+bool Asset::saveIndex (const char* file)
+{
+    bool status = false;
+
+    resourceMut.lock();
+    {
+        /* Build Header */
+        snapshot_hdr_t hdr;
+        LocalLib::set(&hdr, 0, sizeof(hdr));
+        hdr.magic = SNAPSHOT_MAGIC;
+        hdr.version = SNAPSHOT_VERSION;
+        hdr.num_attrs = attrNames.length();
+        hdr.num_resources = resources.length();
+
+        /* Write Snapshot */
+        FILE* fp = fopen(file, "wb");
+        if(fp)
+        {
+            status = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+
+            for(int a = 0; status && a < attrNames.length(); a++)
+            {
+                char name[SNAPSHOT_ATTR_NAME_SIZE];
+                LocalLib::set(name, 0, SNAPSHOT_ATTR_NAME_SIZE);
+                StringLib::copy(name, attrNames[a], SNAPSHOT_ATTR_NAME_SIZE);
+                status = (fwrite(name, SNAPSHOT_ATTR_NAME_SIZE, 1, fp) == 1);
+            }
+
+            double* values = new double [hdr.num_attrs > 0 ? hdr.num_attrs : 1];
+            for(int r = 0; status && r < resources.length(); r++)
+            {
+                char name[RESOURCE_NAME_LENGTH];
+                LocalLib::set(name, 0, RESOURCE_NAME_LENGTH);
+                StringLib::copy(name, resources[r], RESOURCE_NAME_LENGTH);
+                for(uint32_t a = 0; a < hdr.num_attrs; a++) values[a] = (*attrColumns[a])[r];
+                status = (fwrite(name, RESOURCE_NAME_LENGTH, 1, fp) == 1) &&
+                         (fwrite(values, sizeof(double), hdr.num_attrs, fp) == hdr.num_attrs);
+            }
+            delete [] values;
+
+            if(fclose(fp) != 0) status = false;
+        }
+    }
+    resourceMut.unlock();
+
+    if(!status)
+    {
+        mlog(CRITICAL, "Failed to write asset index snapshot %s: %s", file, LocalLib::err2str(errno));
+    }
+
+    return status;
 }
 
 /*----------------------------------------------------------------------------
- * operator[]
+ * getResource
+ *
+ *  names are pooled and never move, so the returned name outlives the lock
  *----------------------------------------------------------------------------*/
-Asset::resource_t& Asset::operator[](int i)
+const char* Asset::getResource (int i) const
 {
-    return resources[i];
+    resourceMut.lock();
+    const char* name = resources[i];
+    resourceMut.unlock();
+    return name;
+}
+
+/*----------------------------------------------------------------------------
+ * readColumn
+ *
+ *  copies the value of an attribute for the first num resources into every
+ *  stride'th entry of values; entries for resources without the attribute,
+ *  or past the end of the asset, are NaN; returns false if no resource has
+ *  the attribute
+ *----------------------------------------------------------------------------*/
+bool Asset::readColumn (const char* attr, double* values, int num, int stride) const
+{
+    resourceMut.lock();
+    int column = -1;
+    bool found = attrIndex.find(attr, &column);
+    int i = 0;
+    if(found)
+    {
+        ArrayList<double>& col = *attrColumns[column];
+        int n = MIN(num, col.length());
+        for(; i < n; i++) values[i * stride] = col[i];
+    }
+    for(; i < num; i++) values[i * stride] = NAN;
+    resourceMut.unlock();
+    return found;
 }
 
 /*----------------------------------------------------------------------------
@@ -185,7 +326,10 @@ Asset::resource_t& Asset::operator[](int i)
  *----------------------------------------------------------------------------*/
 int Asset::size(void) const
 {
-    return resources.length();
+    resourceMut.lock();
+    int num_resources = resources.length();
+    resourceMut.unlock();
+    return num_resources;
 }
 
 /*----------------------------------------------------------------------------
@@ -243,12 +387,324 @@ Asset::Asset (lua_State* L, attributes_t _attributes, new_driver_t _driver):
     LuaObject(L, OBJECT_TYPE, LuaMetaName, LuaMetaTable)
 {
     attributes.name     = StringLib::duplicate(_attributes.name);
-    attributes.format   = StringLib::duplicate(_attributes.format);
+    attributes.format   = StringLib::intern(_attributes.format);
     attributes.path     = StringLib::duplicate(_attributes.path);
     attributes.index    = StringLib::duplicate(_attributes.index);
-    attributes.region   = StringLib::duplicate(_attributes.region);
-    attributes.endpoint = StringLib::duplicate(_attributes.endpoint);
+    attributes.region   = StringLib::intern(_attributes.region);
+    attributes.endpoint = StringLib::intern(_attributes.endpoint);
     driver              = _driver;
+    loaderActive        = true;
+    loaderPid           = NULL;
+    loaderFile          = NULL;
+    namePoolUsed        = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * addResource - caller must hold resourceMut
+ *
+ *  pools the name and extends every attribute column with a NaN for the new
+ *  resource; returns the index of the resource
+ *----------------------------------------------------------------------------*/
+int Asset::addResource (const char* name, int len)
+{
+    len = MIN(len, RESOURCE_NAME_LENGTH - 1);
+    if(namePool.length() == 0 || namePoolUsed + len + 1 > NAME_POOL_BLOCK_SIZE)
+    {
+        namePool.add(new char [NAME_POOL_BLOCK_SIZE]);
+        namePoolUsed = 0;
+    }
+
+    char* pooled = namePool[namePool.length() - 1] + namePoolUsed;
+    LocalLib::copy(pooled, name, len);
+    pooled[len] = '\0';
+    namePoolUsed += len + 1;
+
+    for(int c = 0; c < attrColumns.length(); c++) attrColumns[c]->add(NAN);
+    return resources.add(pooled);
+}
+
+/*----------------------------------------------------------------------------
+ * addColumn - caller must hold resourceMut
+ *
+ *  returns the column of the attribute, creating it with a NaN for every
+ *  resource already loaded if it does not exist
+ *----------------------------------------------------------------------------*/
+int Asset::addColumn (const char* attr)
+{
+    int column = -1;
+    if(!attrIndex.find(attr, &column))
+    {
+        ArrayList<double>* values = new ArrayList<double>;
+        values->reserve(resources.length());
+        for(int r = 0; r < resources.length(); r++) values->add(NAN);
+        column = attrColumns.add(values);
+        attrNames.add(StringLib::intern(attr));
+        attrIndex.add(attr, column);
+    }
+    return column;
+}
+
+/*----------------------------------------------------------------------------
+ * loadCsv
+ *
+ *  the rows after the header are cut into chunks on line boundaries and
+ *  parsed concurrently, each chunk into its own flat arrays, which are then
+ *  appended to the asset in file order
+ *----------------------------------------------------------------------------*/
+bool Asset::loadCsv (const char* file, const char* buffer, size_t size)
+{
+    /* Parse Header */
+    size_t header_end = 0;
+    while(header_end < size && buffer[header_end] != '\n') header_end++;
+
+    List<const char*> columns;
+    int name_column = -1;
+    size_t field_start = 0;
+    while(field_start <= header_end && header_end > 0)
+    {
+        size_t field_end = field_start;
+        while(field_end < header_end && buffer[field_end] != ',') field_end++;
+
+        size_t s = field_start, e = field_end;
+        while(s < e && (buffer[s] == ' ' || buffer[s] == '\t' || buffer[s] == '"')) s++;
+        while(e > s && (buffer[e-1] == ' ' || buffer[e-1] == '\t' || buffer[e-1] == '\r' || buffer[e-1] == '"')) e--;
+        char field[MAX_STR_SIZE];
+        int len = MIN((int)(e - s), MAX_STR_SIZE - 1);
+        LocalLib::copy(field, &buffer[s], len);
+        field[len] = '\0';
+
+        if(StringLib::match(field, "name")) name_column = columns.length();
+        columns.add(StringLib::intern(field));
+
+        field_start = field_end + 1;
+    }
+
+    if(name_column < 0)
+    {
+        mlog(CRITICAL, "Asset index %s has no name column", file);
+        return false;
+    }
+
+    /* Cut Rows into Chunks */
+    size_t rows_start = MIN(header_end + 1, size);
+    size_t rows_size = size - rows_start;
+    int num_chunks = MIN(MIN(LocalLib::nproc(), ASSET_MAX_LOADER_THREADS), (int)(rows_size / ASSET_MIN_LOADER_CHUNK) + 1);
+    num_chunks = MAX(num_chunks, 1);
+
+    csv_chunk_t* chunks = new csv_chunk_t [num_chunks];
+    size_t chunk_start = rows_start;
+    for(int i = 0; i < num_chunks; i++)
+    {
+        size_t chunk_end = (i == num_chunks - 1) ? size : MAX(chunk_start, rows_start + ((rows_size / num_chunks) * (i + 1)));
+        while(chunk_end < size && buffer[chunk_end - 1] != '\n') chunk_end++;
+        chunks[i].buffer = buffer;
+        chunks[i].start = chunk_start;
+        chunks[i].end = chunk_end;
+        chunks[i].num_columns = columns.length();
+        chunks[i].name_column = name_column;
+        chunks[i].active = &loaderActive;
+        chunk_start = chunk_end;
+    }
+
+    /* Parse Chunks */
+    if(num_chunks == 1)
+    {
+        parseCsv(&chunks[0]);
+    }
+    else
+    {
+        Thread** pids = new Thread* [num_chunks];
+        for(int i = 0; i < num_chunks; i++) pids[i] = new Thread(csvThread, &chunks[i]);
+        for(int i = 0; i < num_chunks; i++) delete pids[i];
+        delete [] pids;
+    }
+
+    /* Append Chunks to Asset */
+    int num_loaded = 0;
+    int* column_map = new int [columns.length()];
+    for(int i = 0; i < num_chunks && loaderActive; i++)
+    {
+        csv_chunk_t& chunk = chunks[i];
+        resourceMut.lock();
+        {
+            for(int c = 0; c < columns.length(); c++)
+            {
+                column_map[c] = (c != name_column) ? addColumn(columns[c]) : -1;
+            }
+
+            int num_rows = chunk.name_start.length();
+            int first = resources.length();
+            resources.reserve(first + num_rows);
+            for(int c = 0; c < attrColumns.length(); c++) attrColumns[c]->reserve(first + num_rows);
+
+            for(int r = 0; r < num_rows; r++)
+            {
+                int index = addResource(&buffer[chunk.name_start[r]], chunk.name_length[r]);
+                const double* values = &chunk.values[r * columns.length()];
+                for(int c = 0; c < columns.length(); c++)
+                {
+                    if(column_map[c] >= 0 && !std::isnan(values[c]))
+                    {
+                        (*attrColumns[column_map[c]])[index] = values[c];
+                    }
+                }
+            }
+            num_loaded += num_rows;
+        }
+        resourceMut.unlock();
+    }
+    delete [] column_map;
+    delete [] chunks;
+
+    mlog(INFO, "Loaded %d resources into %s from %s using %d threads", num_loaded, attributes.name, file, num_chunks);
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * loadSnapshot
+ *----------------------------------------------------------------------------*/
+bool Asset::loadSnapshot (const char* file, const uint8_t* buffer, size_t size)
+{
+    const snapshot_hdr_t* hdr = (const snapshot_hdr_t*)buffer;
+    size_t resource_size = RESOURCE_NAME_LENGTH + (hdr->num_attrs * sizeof(double));
+    if(hdr->version != SNAPSHOT_VERSION ||
+       size != sizeof(snapshot_hdr_t) + (hdr->num_attrs * SNAPSHOT_ATTR_NAME_SIZE) + (hdr->num_resources * resource_size))
+    {
+        mlog(CRITICAL, "Unable to load asset index snapshot %s: snapshot is truncated or of a different version", file);
+        return false;
+    }
+
+    const char* attr_names = (const char*)(buffer + sizeof(snapshot_hdr_t));
+    const uint8_t* rec = buffer + sizeof(snapshot_hdr_t) + (hdr->num_attrs * SNAPSHOT_ATTR_NAME_SIZE);
+    int* column_map = new int [hdr->num_attrs > 0 ? hdr->num_attrs : 1];
+    uint32_t num_loaded = 0;
+
+    resourceMut.lock();
+    {
+        for(uint32_t a = 0; a < hdr->num_attrs; a++)
+        {
+            char name[SNAPSHOT_ATTR_NAME_SIZE];
+            StringLib::copy(name, &attr_names[a * SNAPSHOT_ATTR_NAME_SIZE], SNAPSHOT_ATTR_NAME_SIZE);
+            column_map[a] = addColumn(name);
+        }
+
+        resources.reserve(resources.length() + hdr->num_resources);
+        while(num_loaded < hdr->num_resources && loaderActive)
+        {
+            int index = addResource((const char*)rec, StringLib::size((const char*)rec, RESOURCE_NAME_LENGTH));
+            const uint8_t* values = rec + RESOURCE_NAME_LENGTH;
+            for(uint32_t a = 0; a < hdr->num_attrs; a++)
+            {
+                double value;
+                LocalLib::copy(&value, values + (a * sizeof(double)), sizeof(double));
+                if(!std::isnan(value)) (*attrColumns[column_map[a]])[index] = value;
+            }
+            num_loaded++;
+            rec += resource_size;
+        }
+    }
+    resourceMut.unlock();
+    delete [] column_map;
+
+    mlog(INFO, "Loaded %u resources into %s from snapshot %s", num_loaded, attributes.name, file);
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * loaderThread
+ *----------------------------------------------------------------------------*/
+void* Asset::loaderThread (void* parm)
+{
+    Asset* asset = (Asset*)parm;
+    asset->loadIndex(asset->loaderFile);
+    asset->signalComplete();
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * csvThread
+ *----------------------------------------------------------------------------*/
+void* Asset::csvThread (void* parm)
+{
+    parseCsv((csv_chunk_t*)parm);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * parseCsv
+ *
+ *  parses the rows of a chunk into flat arrays without touching the asset;
+ *  rows without a resource name are skipped
+ *----------------------------------------------------------------------------*/
+void Asset::parseCsv (csv_chunk_t* chunk)
+{
+    const char* buffer = chunk->buffer;
+    size_t line_start = chunk->start;
+    while(line_start < chunk->end && *chunk->active)
+    {
+        /* Find End of Line */
+        size_t line_end = line_start;
+        while(line_end < chunk->end && buffer[line_end] != '\n') line_end++;
+
+        /* Skip Blank Lines */
+        if(line_end == line_start || (line_end == line_start + 1 && buffer[line_start] == '\r'))
+        {
+            line_start = line_end + 1;
+            continue;
+        }
+
+        /* Parse Fields */
+        int first_value = chunk->values.length();
+        for(int c = 0; c < chunk->num_columns; c++) chunk->values.add(NAN);
+        int64_t name_start = -1;
+        int32_t name_length = 0;
+        int column = 0;
+        size_t field_start = line_start;
+        while(field_start <= line_end && column < chunk->num_columns)
+        {
+            size_t field_end = field_start;
+            while(field_end < line_end && buffer[field_end] != ',') field_end++;
+
+            /* Trim Field */
+            size_t s = field_start, e = field_end;
+            while(s < e && (buffer[s] == ' ' || buffer[s] == '\t' || buffer[s] == '"')) s++;
+            while(e > s && (buffer[e-1] == ' ' || buffer[e-1] == '\t' || buffer[e-1] == '\r' || buffer[e-1] == '"')) e--;
+
+            if(column == chunk->name_column)
+            {
+                name_start = s;
+                name_length = e - s;
+            }
+            else if(e > s)
+            {
+                char field[MAX_STR_SIZE];
+                int len = MIN((int)(e - s), MAX_STR_SIZE - 1);
+                LocalLib::copy(field, &buffer[s], len);
+                field[len] = '\0';
+                double value;
+                if(StringLib::str2double(field, &value))
+                {
+                    chunk->values[first_value + column] = value;
+                }
+            }
+
+            column++;
+            field_start = field_end + 1;
+        }
+
+        /* Keep Row */
+        if(name_length > 0)
+        {
+            chunk->name_start.add(name_start);
+            chunk->name_length.add(name_length);
+        }
+        else
+        {
+            while(chunk->values.length() > first_value) chunk->values.remove(chunk->values.length() - 1);
+        }
+
+        line_start = line_end + 1;
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -345,3 +801,72 @@ int Asset::luaLoad (lua_State* L)
     /* Return Status */
     return returnLuaStatus(L, status);
 }
+
+/*----------------------------------------------------------------------------
+ * luaLoadIndex - :loadindex(<file>, [<background>]) --> boolean status
+ *
+ *  when background is true the index is loaded by a separate thread and
+ *  :waiton() can be used to wait for it to finish loading
+ *----------------------------------------------------------------------------*/
+int Asset::luaLoadIndex (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        Asset* lua_obj = (Asset*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        const char* file = getLuaString(L, 2);
+        bool background = getLuaBoolean(L, 3, true, false);
+
+        /* Load Index */
+        if(background)
+        {
+            if(lua_obj->loaderPid) throw RunTimeException(CRITICAL, RTE_ERROR, "index already loading in background");
+            lua_obj->loaderFile = StringLib::duplicate(file);
+            lua_obj->loaderPid = new Thread(loaderThread, lua_obj);
+            status = true;
+        }
+        else
+        {
+            status = lua_obj->loadIndex(file);
+            lua_obj->signalComplete();
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error loading index: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaSaveIndex - :saveindex(<file>) --> boolean status
+ *----------------------------------------------------------------------------*/
+int Asset::luaSaveIndex (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        Asset* lua_obj = (Asset*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        const char* file = getLuaString(L, 2);
+
+        /* Save Index */
+        status = lua_obj->saveIndex(file);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error saving index: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
@@ -37,9 +37,11 @@
  ******************************************************************************/
 
 #include "OsApi.h"
+#include "ArrayList.h"
 #include "Dictionary.h"
 #include "List.h"
 #include "LuaObject.h"
+#include "OsApi.h"
 
 /******************************************************************************
  * DEFINES
@@ -49,8 +51,12 @@
 #define ASSET_STARTING_ATTRIBUTES_PER_RESOURCE  4
 #endif
 
-#ifndef ASSET_STARTING_RESOURCES_PER_INDEX
-#define ASSET_STARTING_RESOURCES_PER_INDEX      16
+#ifndef ASSET_MAX_LOADER_THREADS
+#define ASSET_MAX_LOADER_THREADS                16
+#endif
+
+#ifndef ASSET_MIN_LOADER_CHUNK
+#define ASSET_MIN_LOADER_CHUNK                  0x400000 // 4MB of index per loader thread
 #endif
 
 /******************************************************************************
@@ -67,10 +73,25 @@ class Asset: public LuaObject
         class IODriver
         {
             public:
+                typedef enum {
+                    ADVISE_RANDOM,      // reads jump around the resource (e.g. metadata)
+                    ADVISE_SEQUENTIAL,  // reads proceed through the range in order
+                    ADVISE_WILLNEED     // range is about to be read
+                } advice_t;
+
+                typedef struct {
+                    uint8_t*    data;
+                    int64_t     size;
+                    uint64_t    pos;
+                    int64_t     bytes;  // set by driver
+                } io_read_t;
+
                                 IODriver    (void) {};
                 virtual         ~IODriver   (void) {};
 
                 virtual int64_t ioRead      (uint8_t* data, int64_t size, uint64_t pos) = 0;
+                virtual void    ioReadv     (io_read_t* reads, int num_reads) { for(int i = 0; i < num_reads; i++) reads[i].bytes = ioRead(reads[i].data, reads[i].size, reads[i].pos); };
+                virtual void    ioAdvise    (uint64_t pos, int64_t size, advice_t advice) { (void)pos; (void)size; (void)advice; }; // size of zero is the whole resource
         };
 
         /*--------------------------------------------------------------------
@@ -104,7 +125,10 @@ class Asset: public LuaObject
         virtual         ~Asset          (void);
 
         int             load            (resource_t& resource);
-        resource_t&     operator[]      (int i);
+        bool            loadIndex       (const char* file);
+        bool            saveIndex       (const char* file);
+        const char*     getResource     (int i) const;
+        bool            readColumn      (const char* attr, double* values, int num, int stride=1) const;
 
         int             size            (void) const;
         const char*     getName         (void) const;
@@ -123,10 +147,24 @@ class Asset: public LuaObject
         static const char*              LuaMetaName;
         static const struct luaL_Reg    LuaMetaTable[];
 
+        static const uint64_t           SNAPSHOT_MAGIC = 0x3154455353415253LL; // "SRASSET1"
+        static const uint32_t           SNAPSHOT_VERSION = 1;
+        static const int                SNAPSHOT_ATTR_NAME_SIZE = 64;
+
+        static const int                NAME_POOL_BLOCK_SIZE = 0x100000; // 1MB
+
         /*--------------------------------------------------------------------
          * Typedefs
          *--------------------------------------------------------------------*/
 
+        typedef struct {
+            uint64_t                    magic;
+            uint32_t                    version;
+            uint32_t                    num_attrs;      // followed by attribute names
+            uint32_t                    num_resources;  // followed by resources (name and a value per attribute, NaN when absent)
+            uint32_t                    reserved;
+        } snapshot_hdr_t;
+
         typedef struct {
             const char*                 name;
             const char*                 format;
@@ -136,6 +174,18 @@ class Asset: public LuaObject
             const char*                 endpoint;
         } attributes_t;
 
+        typedef struct {
+            const char*                 buffer;         // mapped csv file
+            size_t                      start;          // first row of chunk
+            size_t                      end;            // one past last row of chunk
+            int                         num_columns;
+            int                         name_column;
+            const bool*                 active;
+            ArrayList<int64_t>          name_start;     // offset of each resource name in buffer
+            ArrayList<int32_t>          name_length;
+            ArrayList<double>           values;         // num_columns per row, NaN when not a number
+        } csv_chunk_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -146,7 +196,19 @@ class Asset: public LuaObject
         attributes_t                    attributes;
         new_driver_t                    driver;
 
-        List<resource_t,ASSET_STARTING_RESOURCES_PER_INDEX> resources;
+        /* Resources are held as columns: a pooled name and a value for each
+         * attribute per resource, NaN when the resource lacks the attribute */
+        ArrayList<const char*>          resources;
+        ArrayList<const char*>          attrNames;
+        ArrayList<ArrayList<double>*>   attrColumns;
+        Dictionary<int>                 attrIndex;
+        List<char*>                     namePool;
+        int                             namePoolUsed;
+        mutable Mutex                   resourceMut;
+
+        bool                            loaderActive;
+        Thread*                         loaderPid;
+        const char*                     loaderFile;
 
         /*--------------------------------------------------------------------
          * Methods
@@ -154,8 +216,19 @@ class Asset: public LuaObject
 
                         Asset       (lua_State* L, attributes_t _attributes, new_driver_t _driver);
 
+        int             addResource (const char* name, int len);
+        int             addColumn   (const char* attr);
+
+        bool            loadCsv     (const char* file, const char* buffer, size_t size);
+        bool            loadSnapshot(const char* file, const uint8_t* buffer, size_t size);
+        static void*    loaderThread(void* parm);
+        static void*    csvThread   (void* parm);
+        static void     parseCsv    (csv_chunk_t* chunk);
+
         static int      luaInfo     (lua_State* L);
         static int      luaLoad     (lua_State* L);
+        static int      luaLoadIndex(lua_State* L);
+        static int      luaSaveIndex(lua_State* L);
 };
 
 #endif  /* __asset__ */
@@ -41,10 +41,16 @@
 #include "EventLib.h"
 #include "Dictionary.h"
 #include "List.h"
-#include "Ordering.h"
+#include "ArrayList.h"
+#include "SkipOrdering.h"
 #include "LuaObject.h"
 #include "LuaEngine.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <math.h>
+
 /******************************************************************************
  * ASSET INDEX CLASS
  ******************************************************************************/
@@ -59,6 +65,7 @@ class AssetIndex: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int DEFAULT_THRESHOLD = 8;
+        static const int MAX_SPAN_ATTRS = 4;
 
         /*--------------------------------------------------------------------
          * Types
@@ -66,6 +73,8 @@ class AssetIndex: public LuaObject
 
         static const char* OBJECT_TYPE;
 
+        typedef bool (*spanfilter_t) (const T& span, void* parm); // refines intersect, false excludes
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -79,41 +88,88 @@ class AssetIndex: public LuaObject
          *--------------------------------------------------------------------*/
 
         typedef struct tsnode {
-            List<int>*      ril;        // resource index list (data = index), NULL if branch
+            ArrayList<int>* ril;        // resource index list (data = index), NULL if branch
             T               span;       // for entire subtree rooted at this node
             struct tsnode*  left;       // left subtree
             struct tsnode*  right;      // right subtree
             int             depth;      // depth of tree at this node
         } node_t;
 
+        typedef struct {
+            T               span;       // for entire subtree rooted at this node
+            int32_t         first;      // first child in packedNodes, or first entry in packedResources if leaf
+            int32_t         count;      // number of children or resources
+            bool            leaf;
+        } packed_node_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                                AssetIndex      (lua_State* L, Asset& _asset, const char* meta_name, const struct luaL_Reg meta_table[], int _threshold=DEFAULT_THRESHOLD);
+                                AssetIndex      (lua_State* L, Asset& _asset, const char* meta_name, const struct luaL_Reg meta_table[], int _threshold=DEFAULT_THRESHOLD, bool _packed=false);
         virtual                 ~AssetIndex     (void);
 
         virtual void            build           (void);
         virtual T               get             (int index);
-        virtual bool            add             (const T& span); // NOT thread safe
-        virtual Ordering<int>*  query           (const T& span);
+        virtual bool            add             (const T& span); // safe to call while other threads query
+        virtual SkipOrdering<int>* query        (const T& span, spanfilter_t filter=NULL, void* parm=NULL);
+        virtual void            querybatch      (const T* qspans, int num_spans, ArrayList<int32_t>* ids, ArrayList<int32_t>* offsets);
         virtual void            display         (void);
+        virtual bool            save            (const char* path);
+        virtual bool            load            (const char* path);
 
         virtual void            split           (node_t* node, T& lspan, T& rspan) = 0;
         virtual bool            isleft          (node_t* node, const T& span) = 0;
         virtual bool            isright         (node_t* node, const T& span) = 0;
         virtual bool            intersect       (const T& span1, const T& span2) = 0;
         virtual T               combine         (const T& span1, const T& span2) = 0;
-        virtual T               attr2span       (Dictionary<double>* attr, bool* provided=NULL) = 0;
+        virtual int             spanattrs       (const char* names[MAX_SPAN_ATTRS]) = 0; // asset attributes a span is built from
+        virtual T               attr2span       (const double* values, bool* provided=NULL) = 0; // values in spanattrs order, NaN if absent
         virtual T               luatable2span   (lua_State* L, int parm) = 0;
         virtual void            displayspan     (const T& span) = 0;
+        virtual double          sortkey         (const T& span, int dim) = 0; // center of span along dimension, used by packed build
+        virtual int             dimensions      (void);
         
         static int              luaAdd          (lua_State* L);
+        void                    pushresources   (lua_State* L, SkipOrdering<int>* ro);
+
         static int              luaQuery        (lua_State* L);
+        static int              luaQueryBatch   (lua_State* L);
         static int              luaDisplay      (lua_State* L);
+        static int              luaSave         (lua_State* L);
+        static int              luaLoad         (lua_State* L);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const uint32_t SNAPSHOT_MAGIC = 0x58444941; // "AIDX"
+        static const uint32_t SNAPSHOT_VERSION = 1;
+        static const int SNAPSHOT_TYPE_SIZE = 32;
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            uint32_t        magic;
+            uint32_t        version;
+            uint32_t        span_size;  // sizeof(T)
+            uint32_t        node_size;  // sizeof(packed_node_t)
+            int32_t         num_assets; // resources in asset when saved
+            int32_t         num_spans;
+            int32_t         num_nodes;
+            int32_t         num_resources;
+            char            index_type[SNAPSHOT_TYPE_SIZE];
+        } snapshot_hdr_t; // followed by spans, nodes, resources
+
+        typedef struct {
+            node_t*         tree;
+            ArrayList<T>    spans;
+        } version_t; // immutable once published
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -121,20 +177,61 @@ class AssetIndex: public LuaObject
         void        buildtree       (node_t* root, int* maxdepth);
         void        updatenode      (int i, node_t** node, int* maxdepth);
         void        balancenode     (node_t** root);
-        void        querynode       (const T& span, node_t* curr, Ordering<int>* list);
+        void        querynode       (const T& span, spanfilter_t filter, void* parm, node_t* curr, version_t* version, SkipOrdering<int>* list);
         node_t*     newnode         (const T& span);
+        node_t*     clonenode       (const node_t* node);
         void        deletenode      (node_t* node);
         bool        prunenode       (node_t* node);
         void        displaynode     (node_t* curr);
+        double*     readattrs       (int* num_resources, int* num_attrs);
+        void        pack            (void);
+        void        packspans       (void);
+        void        setviews        (void);
+        void        clearviews      (void);
+        void        strsort         (int32_t* items, const double* keys, int n, int dim, int dims, int capacity);
+        void        querypacked     (const T& span, spanfilter_t filter, void* parm, SkipOrdering<int>* list);
+        void        batchnode       (const T* qspans, const int32_t* active, int num_active, node_t* curr, version_t* version, ArrayList<int64_t>* hits);
+        void        batchpacked     (const T* qspans, const int32_t* active, int num_active, int32_t node_index, ArrayList<int64_t>* hits);
+        void        displaypacked   (int32_t node, int depth);
+        void        publish         (void);
+        void        retire          (version_t* version);
+        version_t*  readbegin       (int* parity);
+        void        readend         (int parity);
 
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        Asset&      asset;
-        List<T>     spans; // parallels asset resource list
-        int32_t     threshold;
-        node_t*     tree;
+        Asset&       asset;
+        ArrayList<T> spans; // parallels asset resource list
+        int32_t      threshold;
+        node_t*      tree;
+
+        /* Published Version (read-copy-update)
+         *
+         *  tree and spans above belong to the writer, which holds writeMut;
+         *  readers only touch the published copy, announcing themselves in
+         *  the reader count for the current epoch so that a writer can wait
+         *  for them to drain before freeing the version they were using */
+        Mutex                       writeMut;
+        std::atomic<version_t*>     published;
+        std::atomic<uint64_t>       epoch;
+        std::atomic<int32_t>        readers[2];
+
+        /* Packed (Bulk Loaded) Index */
+        bool                        packed;
+        ArrayList<packed_node_t>    packedNodes;        // bottom up by level, root is last
+        ArrayList<int32_t>          packedResources;    // resource indexes in leaf order
+
+        /* Packed Views (into the lists above, or into a mapped snapshot) */
+        const T*                    viewSpans;
+        const packed_node_t*        viewNodes;
+        const int32_t*              viewResources;
+        int32_t                     numViewSpans;
+        int32_t                     numViewNodes;
+        int32_t                     numViewResources;
+        const void*                 mapping;
+        size_t                      mappingSize;
 };
 
 /******************************************************************************
@@ -152,12 +249,20 @@ const char* AssetIndex<T>::OBJECT_TYPE = "AssetIndex";
  * Constructor
  *----------------------------------------------------------------------------*/
 template <class T>
-AssetIndex<T>::AssetIndex (lua_State* L, Asset& _asset, const char* meta_name, const struct luaL_Reg meta_table[], int _threshold):
+AssetIndex<T>::AssetIndex (lua_State* L, Asset& _asset, const char* meta_name, const struct luaL_Reg meta_table[], int _threshold, bool _packed):
     LuaObject(L, OBJECT_TYPE, meta_name, meta_table),
     asset(_asset),
-    threshold(_threshold)
+    threshold(_threshold),
+    packed(_packed)
 {
     tree = NULL;
+    published = NULL;
+    epoch = 0;
+    readers[0] = 0;
+    readers[1] = 0;
+    mapping = NULL;
+    mappingSize = 0;
+    clearviews();
 }
 
 /*----------------------------------------------------------------------------
@@ -168,6 +273,8 @@ AssetIndex<T>::~AssetIndex (void)
 {
     asset.releaseLuaObject();
     deletenode(tree);
+    retire(published.exchange(NULL));
+    LocalLib::unmapfile(mapping, mappingSize);
 }
 
 /*----------------------------------------------------------------------------
@@ -176,12 +283,23 @@ AssetIndex<T>::~AssetIndex (void)
 template <class T>
 void AssetIndex<T>::build (void)
 {
+    /* Build Packed Index */
+    if(packed)
+    {
+        pack();
+        return;
+    }
+
+    /* Read Attributes */
+    int num_resources, num_attrs;
+    double* values = readattrs(&num_resources, &num_attrs);
+
     /* Build Tree Node */
     spans.clear();
-    for(int i = 0; i < asset.size(); i++)
+    for(int i = 0; i < num_resources; i++)
     {
         bool provided = false;
-        T span = attr2span(&asset[i].attributes, &provided);
+        T span = attr2span(&values[i * num_attrs], &provided);
         if(provided)
         {
             /* Add to Global Resource List */
@@ -197,10 +315,14 @@ void AssetIndex<T>::build (void)
             tree->ril->add(index);
         }
     }
+    delete [] values;
 
     /* Build Tree Structure */
     int maxdepth = 0;
     buildtree(tree, &maxdepth);
+
+    /* Make Visible to Readers */
+    publish();
 }
 
 /*----------------------------------------------------------------------------
@@ -209,7 +331,13 @@ void AssetIndex<T>::build (void)
 template <class T>
 T AssetIndex<T>::get (int index)
 {
-    return spans[index];
+    if(packed) return viewSpans[index];
+
+    int parity;
+    version_t* version = readbegin(&parity);
+    T span = version->spans[index];
+    readend(parity);
+    return span;
 }
 
 /*----------------------------------------------------------------------------
@@ -223,31 +351,257 @@ T AssetIndex<T>::get (int index)
 template <class T>
 bool AssetIndex<T>::add (const T& span)
 {
-    int maxdepth = 0;
-    int index = spans.add(span);
-    updatenode(index, &tree, &maxdepth);
-    balancenode(&tree);
+    if(packed)
+    {
+        mlog(CRITICAL, "Unable to add resource to a packed index");
+        return false;
+    }
+
+    writeMut.lock();
+    {
+        int maxdepth = 0;
+        int index = spans.add(span);
+        updatenode(index, &tree, &maxdepth);
+        balancenode(&tree);
+        publish();
+    }
+    writeMut.unlock();
+
     return true;
 }
 
 /*----------------------------------------------------------------------------
  * query
+ *
+ *  returns resources whose span intersects the query span; when a filter is
+ *  supplied, subtrees and resources it rejects are excluded as well
  *----------------------------------------------------------------------------*/
 template <class T>
-Ordering<int>* AssetIndex<T>::query (const T& span)
+SkipOrdering<int>* AssetIndex<T>::query (const T& span, spanfilter_t filter, void* parm)
 {
-    Ordering<int>* list = new Ordering<int>();
-    querynode(span, tree, list);
+    SkipOrdering<int>* list = new SkipOrdering<int>();
+    if(packed)
+    {
+        querypacked(span, filter, parm, list);
+    }
+    else
+    {
+        int parity;
+        version_t* version = readbegin(&parity);
+        if(version) querynode(span, filter, parm, version->tree, version, list);
+        readend(parity);
+    }
     return list;
 }
 
+/*----------------------------------------------------------------------------
+ * querybatch
+ *
+ *  answers every span in a single walk of the index; the resource indexes
+ *  matching qspans[i] are ids[offsets[i]] through ids[offsets[i+1]-1], in
+ *  ascending order without duplicates
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::querybatch (const T* qspans, int num_spans, ArrayList<int32_t>* ids, ArrayList<int32_t>* offsets)
+{
+    ids->clear();
+    offsets->clear();
+    if(num_spans <= 0)
+    {
+        offsets->add(0);
+        return;
+    }
+
+    /* All Spans Start Active at Root */
+    int32_t* active = new int32_t [num_spans];
+    for(int i = 0; i < num_spans; i++) active[i] = i;
+
+    /* Collect Hits as (span << 32 | resource) */
+    ArrayList<int64_t> hits;
+    if(packed)
+    {
+        if(numViewNodes > 0) batchpacked(qspans, active, num_spans, numViewNodes - 1, &hits);
+    }
+    else
+    {
+        int parity;
+        version_t* version = readbegin(&parity);
+        if(version) batchnode(qspans, active, num_spans, version->tree, version, &hits);
+        readend(parity);
+    }
+    delete [] active;
+
+    /* Sort and Pack Hits by Span */
+    std::sort(hits.begin(), hits.end());
+    ids->reserve(hits.length());
+    offsets->reserve(num_spans + 1);
+    int h = 0;
+    for(int i = 0; i < num_spans; i++)
+    {
+        offsets->add(ids->length());
+        int64_t prev = -1;
+        while(h < hits.length() && (hits[h] >> 32) == i)
+        {
+            if(hits[h] != prev) ids->add((int32_t)(hits[h] & 0xFFFFFFFF));
+            prev = hits[h++];
+        }
+    }
+    offsets->add(ids->length());
+}
+
 /*----------------------------------------------------------------------------
  * display
  *----------------------------------------------------------------------------*/
 template <class T>
 void AssetIndex<T>::display (void)
 {
-    displaynode(tree);
+    if(packed)
+    {
+        displaypacked(numViewNodes - 1, 0);
+    }
+    else
+    {
+        writeMut.lock();
+        displaynode(tree);
+        writeMut.unlock();
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * save
+ *
+ *  writes the packed form of the index; an index that is not packed is
+ *  packed from its current spans for the purpose of the snapshot
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool AssetIndex<T>::save (const char* path)
+{
+    writeMut.lock();
+
+    if(!packed) packspans();
+
+    /* Build Header */
+    snapshot_hdr_t hdr;
+    LocalLib::set(&hdr, 0, sizeof(hdr));
+    hdr.magic = SNAPSHOT_MAGIC;
+    hdr.version = SNAPSHOT_VERSION;
+    hdr.span_size = sizeof(T);
+    hdr.node_size = sizeof(packed_node_t);
+    hdr.num_assets = asset.size();
+    hdr.num_spans = numViewSpans;
+    hdr.num_nodes = numViewNodes;
+    hdr.num_resources = numViewResources;
+    StringLib::copy(hdr.index_type, LuaMetaName, SNAPSHOT_TYPE_SIZE);
+
+    /* Write Snapshot */
+    bool status = false;
+    FILE* fp = fopen(path, "wb");
+    if(fp)
+    {
+        status = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1) &&
+                 (fwrite(viewSpans, sizeof(T), numViewSpans, fp) == (size_t)numViewSpans) &&
+                 (fwrite(viewNodes, sizeof(packed_node_t), numViewNodes, fp) == (size_t)numViewNodes) &&
+                 (fwrite(viewResources, sizeof(int32_t), numViewResources, fp) == (size_t)numViewResources);
+        if(fclose(fp) != 0) status = false;
+    }
+
+    if(!status)
+    {
+        mlog(CRITICAL, "Failed to write index snapshot %s: %s", path, LocalLib::err2str(errno));
+    }
+
+    /* Release Temporary Packing */
+    if(!packed)
+    {
+        packedNodes.clear();
+        packedResources.clear();
+        clearviews();
+    }
+
+    writeMut.unlock();
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * load
+ *
+ *  memory maps a snapshot written by save; the index becomes packed and
+ *  queries run directly against the mapped pages
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool AssetIndex<T>::load (const char* path)
+{
+    size_t size = 0;
+    const uint8_t* base = (const uint8_t*)LocalLib::mapfile(path, &size);
+    if(!base)
+    {
+        mlog(CRITICAL, "Failed to map index snapshot %s: %s", path, LocalLib::err2str(errno));
+        return false;
+    }
+
+    /* Validate Snapshot */
+    const snapshot_hdr_t* hdr = (const snapshot_hdr_t*)base;
+    const char* error = NULL;
+    if(size < sizeof(snapshot_hdr_t) || hdr->magic != SNAPSHOT_MAGIC || hdr->version != SNAPSHOT_VERSION)
+    {
+        error = "not an index snapshot";
+    }
+    else if(hdr->span_size != sizeof(T) || hdr->node_size != sizeof(packed_node_t) ||
+            StringLib::match(hdr->index_type, LuaMetaName, SNAPSHOT_TYPE_SIZE) == false)
+    {
+        error = "snapshot is for a different index type";
+    }
+    else if(hdr->num_assets != asset.size())
+    {
+        error = "snapshot does not match asset";
+    }
+    else if(hdr->num_spans < 0 || hdr->num_nodes < 0 || hdr->num_resources < 0 ||
+            size != sizeof(snapshot_hdr_t) + (hdr->num_spans * sizeof(T)) +
+                    (hdr->num_nodes * sizeof(packed_node_t)) + (hdr->num_resources * sizeof(int32_t)))
+    {
+        error = "snapshot is truncated";
+    }
+
+    if(error)
+    {
+        mlog(CRITICAL, "Unable to load index snapshot %s: %s", path, error);
+        LocalLib::unmapfile(base, size);
+        return false;
+    }
+
+    /* Release Current Index */
+    writeMut.lock();
+    retire(published.exchange(NULL));
+    deletenode(tree);
+    tree = NULL;
+    spans.clear();
+    packedNodes.clear();
+    packedResources.clear();
+    LocalLib::unmapfile(mapping, mappingSize);
+
+    /* Point Views into Mapping */
+    mapping = base;
+    mappingSize = size;
+    packed = true;
+    numViewSpans = hdr->num_spans;
+    numViewNodes = hdr->num_nodes;
+    numViewResources = hdr->num_resources;
+    viewSpans = (const T*)(base + sizeof(snapshot_hdr_t));
+    viewNodes = (const packed_node_t*)(viewSpans + numViewSpans);
+    viewResources = (const int32_t*)(viewNodes + numViewNodes);
+    writeMut.unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * dimensions
+ *----------------------------------------------------------------------------*/
+template <class T>
+int AssetIndex<T>::dimensions (void)
+{
+    return 1;
 }
 
 /*----------------------------------------------------------------------------
@@ -278,6 +632,23 @@ int AssetIndex<T>::luaAdd (lua_State* L)
     return returnLuaStatus(L, status, 2);
 }
 
+/*----------------------------------------------------------------------------
+ * pushresources - pushes table of resource names onto stack
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::pushresources (lua_State* L, SkipOrdering<int>* ro)
+{
+    lua_newtable(L);
+    int r = 1;
+    unsigned long resource_index = ro->first(NULL);
+    while(resource_index != INVALID_KEY)
+    {
+        lua_pushstring(L, asset.getResource(resource_index));
+        lua_rawseti(L, -2, r++);
+        resource_index = ro->next(NULL);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * luaQuery - :query(<index span>)
  *----------------------------------------------------------------------------*/
@@ -295,18 +666,10 @@ int AssetIndex<T>::luaQuery (lua_State* L)
         T span = lua_obj->luatable2span(L, 2);
 
         /* Query Resources */
-        Ordering<int>* ro = lua_obj->query(span);
+        SkipOrdering<int>* ro = lua_obj->query(span);
 
         /* Return Resources */
-        lua_newtable(L);
-        int r = 1;
-        unsigned long resource_index = ro->first(NULL);
-        while(resource_index != INVALID_KEY)
-        {
-            lua_pushstring(L, lua_obj->asset[resource_index].name);
-            lua_rawseti(L, -2, r++);
-            resource_index = ro->next(NULL);
-        }
+        lua_obj->pushresources(L, ro);
 
         /* Free Resource Index List */
         delete ro;
@@ -323,6 +686,74 @@ int AssetIndex<T>::luaQuery (lua_State* L)
     return returnLuaStatus(L, status, 2);
 }
 
+/*----------------------------------------------------------------------------
+ * luaQueryBatch - :querybatch({<index span>, ...})
+ *
+ *  returns two integer arrays: the resource indexes (positions in the
+ *  asset) of every match, and for each span the offset of its first match
+ *  followed by a final entry equal to the total number of matches; the
+ *  matches for span i are ids[offsets[i]+1] through ids[offsets[i+1]]
+ *----------------------------------------------------------------------------*/
+template <class T>
+int AssetIndex<T>::luaQueryBatch (lua_State* L)
+{
+    bool status = false;
+    T* qspans = NULL;
+
+    try
+    {
+        /* Get Self */
+        AssetIndex<T>* lua_obj = (AssetIndex<T>*)getLuaSelf(L, 1);
+
+        /* Get Query Spans */
+        if(!lua_istable(L, 2))
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "must supply a table of spans");
+        }
+        int num_spans = lua_rawlen(L, 2);
+        qspans = new T [num_spans];
+        for(int i = 0; i < num_spans; i++)
+        {
+            lua_rawgeti(L, 2, i + 1);
+            qspans[i] = lua_obj->luatable2span(L, lua_gettop(L));
+            lua_pop(L, 1);
+        }
+
+        /* Query Resources */
+        ArrayList<int32_t> ids;
+        ArrayList<int32_t> offsets;
+        lua_obj->querybatch(qspans, num_spans, &ids, &offsets);
+
+        /* Return Resource Indexes */
+        lua_createtable(L, ids.length(), 0);
+        for(int i = 0; i < ids.length(); i++)
+        {
+            lua_pushinteger(L, ids[i]);
+            lua_rawseti(L, -2, i + 1);
+        }
+
+        /* Return Offsets */
+        lua_createtable(L, offsets.length(), 0);
+        for(int i = 0; i < offsets.length(); i++)
+        {
+            lua_pushinteger(L, offsets[i]);
+            lua_rawseti(L, -2, i + 1);
+        }
+
+        /* Set Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error querying batch: %s", e.what());
+    }
+
+    delete [] qspans;
+
+    /* Return Status */
+    return returnLuaStatus(L, status, 3);
+}
+
 /*----------------------------------------------------------------------------
  * luaDisplay - :display()
  *----------------------------------------------------------------------------*/
@@ -351,6 +782,62 @@ int AssetIndex<T>::luaDisplay (lua_State* L)
     return returnLuaStatus(L, status);
 }
 
+/*----------------------------------------------------------------------------
+ * luaSave - :save(<path>)
+ *----------------------------------------------------------------------------*/
+template <class T>
+int AssetIndex<T>::luaSave (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        AssetIndex<T>* lua_obj = (AssetIndex<T>*)getLuaSelf(L, 1);
+
+        /* Get Path */
+        const char* path = getLuaString(L, 2);
+
+        /* Save Snapshot */
+        status = lua_obj->save(path);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error saving: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaLoad - :load(<path>)
+ *----------------------------------------------------------------------------*/
+template <class T>
+int AssetIndex<T>::luaLoad (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        AssetIndex<T>* lua_obj = (AssetIndex<T>*)getLuaSelf(L, 1);
+
+        /* Get Path */
+        const char* path = getLuaString(L, 2);
+
+        /* Load Snapshot */
+        status = lua_obj->load(path);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error loading: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
 /*----------------------------------------------------------------------------
  * buildtree
  *----------------------------------------------------------------------------*/
@@ -599,13 +1086,14 @@ void AssetIndex<T>::balancenode (node_t** root)
  * querynode
  *----------------------------------------------------------------------------*/
 template <class T>
-void AssetIndex<T>::querynode (const T& span, node_t* curr, Ordering<int>* list)
+void AssetIndex<T>::querynode (const T& span, spanfilter_t filter, void* parm, node_t* curr, version_t* version, SkipOrdering<int>* list)
 {
     /* Return on Null Path */
     if(curr == NULL) return;
 
     /* Return if no Intersection with Tree */
     if(!intersect(span, curr->span)) return;
+    if(filter && !filter(curr->span, parm)) return;
     
     /* If Leaf Node */
     if(curr->ril)
@@ -614,7 +1102,8 @@ void AssetIndex<T>::querynode (const T& span, node_t* curr, Ordering<int>* list)
         for(int i = 0; i < curr->ril->length(); i++)
         {
             int resource_index = curr->ril->get(i);
-            if(intersect(span, spans[resource_index]))
+            T& resource_span = version->spans[resource_index];
+            if(intersect(span, resource_span) && (!filter || filter(resource_span, parm)))
             {
                 list->add(resource_index, resource_index, true);
             }
@@ -623,10 +1112,50 @@ void AssetIndex<T>::querynode (const T& span, node_t* curr, Ordering<int>* list)
     else /* Branch Node */
     {
         /* Goto Before Tree */
-        querynode(span, curr->left, list);
+        querynode(span, filter, parm, curr->left, version, list);
 
         /* Goto Before Tree */
-        querynode(span, curr->right, list);
+        querynode(span, filter, parm, curr->right, version, list);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * batchnode
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::batchnode (const T* qspans, const int32_t* active, int num_active, node_t* curr, version_t* version, ArrayList<int64_t>* hits)
+{
+    /* Return on Null Path */
+    if(curr == NULL) return;
+
+    /* Narrow to Spans that Intersect Tree */
+    ArrayList<int32_t> remaining(num_active);
+    for(int q = 0; q < num_active; q++)
+    {
+        if(intersect(qspans[active[q]], curr->span)) remaining.add(active[q]);
+    }
+    if(remaining.length() == 0) return;
+
+    /* If Leaf Node */
+    if(curr->ril)
+    {
+        for(int i = 0; i < curr->ril->length(); i++)
+        {
+            int resource_index = curr->ril->get(i);
+            T& resource_span = version->spans[resource_index];
+            for(int q = 0; q < remaining.length(); q++)
+            {
+                if(intersect(qspans[remaining[q]], resource_span))
+                {
+                    hits->add(((int64_t)remaining[q] << 32) | resource_index);
+                }
+            }
+        }
+    }
+    else /* Branch Node */
+    {
+        batchnode(qspans, remaining.begin(), remaining.length(), curr->left, version, hits);
+        batchnode(qspans, remaining.begin(), remaining.length(), curr->right, version, hits);
     }
 }
 
@@ -637,7 +1166,7 @@ template <class T>
 typename AssetIndex<T>::node_t* AssetIndex<T>::newnode (const T& span)
 {
     node_t* node = new node_t;
-    node->ril = new List<int>;
+    node->ril = new ArrayList<int>;
     node->span = span;
     node->left = NULL;
     node->right = NULL;
@@ -645,6 +1174,23 @@ typename AssetIndex<T>::node_t* AssetIndex<T>::newnode (const T& span)
     return node;
 }
 
+/*----------------------------------------------------------------------------
+ * clonenode
+ *----------------------------------------------------------------------------*/
+template <class T>
+typename AssetIndex<T>::node_t* AssetIndex<T>::clonenode (const node_t* node)
+{
+    if(node == NULL) return NULL;
+
+    node_t* copy = new node_t;
+    copy->ril = node->ril ? new ArrayList<int>(*node->ril) : NULL;
+    copy->span = node->span;
+    copy->left = clonenode(node->left);
+    copy->right = clonenode(node->right);
+    copy->depth = node->depth;
+    return copy;
+}
+
 /*----------------------------------------------------------------------------
  * displaynode
  *----------------------------------------------------------------------------*/
@@ -712,7 +1258,7 @@ bool AssetIndex<T>::prunenode (node_t* node)
             }
 
             /* Copy Indexes Into Branch Node */
-            node->ril = new List<int>;
+            node->ril = new ArrayList<int>;
             for(int i = 0; i < prune->ril->length(); i++)
             {
                 int ri = prune->ril->get(i);
@@ -752,7 +1298,7 @@ void AssetIndex<T>::displaynode (node_t* curr)
         for(int i = 0; i < curr->ril->length(); i++)
         {
             int resource_index = curr->ril->get(i);
-            print2term("%s ", asset[resource_index].name);
+            print2term("%s ", asset.getResource(resource_index));
         }
     }
     else
@@ -769,4 +1315,393 @@ void AssetIndex<T>::displaynode (node_t* curr)
     displaynode(curr->right);
 }
 
+/*----------------------------------------------------------------------------
+ * readattrs
+ *
+ *  copies the attribute columns spans are built from out of the asset in a
+ *  single pass per column; returned array is resource-major and owned by
+ *  the caller
+ *----------------------------------------------------------------------------*/
+template <class T>
+double* AssetIndex<T>::readattrs (int* num_resources, int* num_attrs)
+{
+    const char* names[MAX_SPAN_ATTRS];
+    *num_attrs = spanattrs(names);
+    *num_resources = asset.size();
+
+    double* values = new double [MAX(*num_resources * *num_attrs, 1)];
+    for(int a = 0; a < *num_attrs; a++)
+    {
+        if(!asset.readColumn(names[a], &values[a], *num_resources, *num_attrs) && *num_resources > 0)
+        {
+            mlog(CRITICAL, "Failed to index asset %s: no resource has attribute %s", asset.getName(), names[a]);
+        }
+    }
+
+    return values;
+}
+
+/*----------------------------------------------------------------------------
+ * pack
+ *
+ *  Bulk loads every span into an immutable array of nodes using sort-tile-
+ *  recursive packing: resources are ordered along each dimension in turn and
+ *  cut into leaves of threshold entries, and each level above is packed the
+ *  same way from the level below.  Every resource appears in exactly one leaf.
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::pack (void)
+{
+    /* Gather Spans */
+    int num_resources, num_attrs;
+    double* values = readattrs(&num_resources, &num_attrs);
+    spans.clear();
+    spans.reserve(num_resources);
+    for(int i = 0; i < num_resources; i++)
+    {
+        bool provided = false;
+        T span = attr2span(&values[i * num_attrs], &provided);
+        if(provided) spans.add(span);
+    }
+    delete [] values;
+
+    packspans();
+}
+
+/*----------------------------------------------------------------------------
+ * packspans
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::packspans (void)
+{
+    const int capacity = MAX(threshold, 2);
+    const int dims = dimensions();
+
+    packedNodes.clear();
+    packedResources.clear();
+
+    int n = spans.length();
+    for(int i = 0; i < n; i++) packedResources.add(i);
+    if(n == 0)
+    {
+        setviews();
+        return;
+    }
+
+    /* Order Resources */
+    double* keys = new double [n * dims];
+    for(int i = 0; i < n; i++)
+    {
+        for(int d = 0; d < dims; d++)
+        {
+            keys[(i * dims) + d] = sortkey(spans[i], d);
+        }
+    }
+    strsort(packedResources.begin(), keys, n, 0, dims, capacity);
+
+    /* Build Leaves */
+    packedNodes.reserve(((n + capacity - 1) / capacity) * 2);
+    for(int i = 0; i < n; i += capacity)
+    {
+        packed_node_t node;
+        node.span = spans[packedResources[i]];
+        node.first = i;
+        node.count = MIN(capacity, n - i);
+        node.leaf = true;
+        for(int j = i + 1; j < i + node.count; j++)
+        {
+            node.span = combine(node.span, spans[packedResources[j]]);
+        }
+        packedNodes.add(node);
+    }
+
+    /* Build Branches Until a Single Root Remains */
+    int level_start = 0;
+    int level_count = packedNodes.length();
+    while(level_count > 1)
+    {
+        /* Order Nodes in Level */
+        packed_node_t* level = &packedNodes[level_start];
+        int32_t* order = new int32_t [level_count];
+        delete [] keys;
+        keys = new double [level_count * dims];
+        for(int i = 0; i < level_count; i++)
+        {
+            order[i] = i;
+            for(int d = 0; d < dims; d++)
+            {
+                keys[(i * dims) + d] = sortkey(level[i].span, d);
+            }
+        }
+        strsort(order, keys, level_count, 0, dims, capacity);
+
+        /* Rearrange Level (children of each level are already placed) */
+        packed_node_t* sorted = new packed_node_t [level_count];
+        for(int i = 0; i < level_count; i++) sorted[i] = level[order[i]];
+        for(int i = 0; i < level_count; i++) level[i] = sorted[i];
+        delete [] sorted;
+        delete [] order;
+
+        /* Add Parent Level */
+        int parent_start = packedNodes.length();
+        for(int i = 0; i < level_count; i += capacity)
+        {
+            packed_node_t node;
+            node.span = packedNodes[level_start + i].span;
+            node.first = level_start + i;
+            node.count = MIN(capacity, level_count - i);
+            node.leaf = false;
+            for(int j = 1; j < node.count; j++)
+            {
+                node.span = combine(node.span, packedNodes[node.first + j].span);
+            }
+            packedNodes.add(node);
+        }
+
+        level_start = parent_start;
+        level_count = packedNodes.length() - parent_start;
+    }
+
+    delete [] keys;
+
+    setviews();
+}
+
+/*----------------------------------------------------------------------------
+ * setviews
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::setviews (void)
+{
+    viewSpans = spans.begin();
+    viewNodes = packedNodes.begin();
+    viewResources = packedResources.begin();
+    numViewSpans = spans.length();
+    numViewNodes = packedNodes.length();
+    numViewResources = packedResources.length();
+}
+
+/*----------------------------------------------------------------------------
+ * clearviews
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::clearviews (void)
+{
+    viewSpans = NULL;
+    viewNodes = NULL;
+    viewResources = NULL;
+    numViewSpans = 0;
+    numViewNodes = 0;
+    numViewResources = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * strsort
+ *
+ *  orders items so that consecutive runs of capacity entries are compact;
+ *  keys are indexed by item value, dims per item
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::strsort (int32_t* items, const double* keys, int n, int dim, int dims, int capacity)
+{
+    if(n <= capacity || dim >= dims) return;
+
+    /* Sort Along Dimension */
+    std::sort(items, items + n, [keys, dim, dims](int32_t a, int32_t b) {
+        return keys[(a * dims) + dim] < keys[(b * dims) + dim];
+    });
+
+    /* Tile Into Slices and Sort Each Along Next Dimension */
+    if(dim < dims - 1)
+    {
+        int pages = (n + capacity - 1) / capacity;
+        int slices = (int)ceil(pow((double)pages, 1.0 / (double)(dims - dim)));
+        int slice_size = capacity * ((pages + slices - 1) / slices);
+        for(int i = 0; i < n; i += slice_size)
+        {
+            strsort(&items[i], keys, MIN(slice_size, n - i), dim + 1, dims, capacity);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * querypacked
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::querypacked (const T& span, spanfilter_t filter, void* parm, SkipOrdering<int>* list)
+{
+    if(numViewNodes == 0) return;
+
+    ArrayList<int32_t> stack;
+    stack.add(numViewNodes - 1);
+    while(stack.length() > 0)
+    {
+        /* Pop Node */
+        int last = stack.length() - 1;
+        const packed_node_t& node = viewNodes[stack[last]];
+        stack.remove(last);
+
+        /* Skip if no Intersection with Subtree */
+        if(!intersect(span, node.span)) continue;
+        if(filter && !filter(node.span, parm)) continue;
+
+        if(node.leaf)
+        {
+            for(int i = node.first; i < node.first + node.count; i++)
+            {
+                int resource_index = viewResources[i];
+                const T& resource_span = viewSpans[resource_index];
+                if(intersect(span, resource_span) && (!filter || filter(resource_span, parm)))
+                {
+                    list->add(resource_index, resource_index, true);
+                }
+            }
+        }
+        else
+        {
+            for(int i = node.first + node.count - 1; i >= node.first; i--)
+            {
+                stack.add(i);
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * batchpacked
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::batchpacked (const T* qspans, const int32_t* active, int num_active, int32_t node_index, ArrayList<int64_t>* hits)
+{
+    const packed_node_t& node = viewNodes[node_index];
+
+    /* Narrow to Spans that Intersect Subtree */
+    ArrayList<int32_t> remaining(num_active);
+    for(int q = 0; q < num_active; q++)
+    {
+        if(intersect(qspans[active[q]], node.span)) remaining.add(active[q]);
+    }
+    if(remaining.length() == 0) return;
+
+    if(node.leaf)
+    {
+        for(int i = node.first; i < node.first + node.count; i++)
+        {
+            int resource_index = viewResources[i];
+            for(int q = 0; q < remaining.length(); q++)
+            {
+                if(intersect(qspans[remaining[q]], viewSpans[resource_index]))
+                {
+                    hits->add(((int64_t)remaining[q] << 32) | resource_index);
+                }
+            }
+        }
+    }
+    else
+    {
+        for(int i = node.first; i < node.first + node.count; i++)
+        {
+            batchpacked(qspans, remaining.begin(), remaining.length(), i, hits);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * displaypacked
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::displaypacked (int32_t node_index, int depth)
+{
+    if(node_index < 0) return;
+
+    const packed_node_t& node = viewNodes[node_index];
+
+    /* Display */
+    displayspan(node.span);
+    print2term(" <%d>\n", depth);
+    if(node.leaf)
+    {
+        for(int i = node.first; i < node.first + node.count; i++)
+        {
+            print2term("%s ", asset.getResource(viewResources[i]));
+        }
+        print2term("\n\n");
+    }
+    else
+    {
+        print2term("%d children\n\n", node.count);
+        for(int i = node.first; i < node.first + node.count; i++)
+        {
+            displaypacked(i, depth + 1);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * publish - caller is the writer
+ *
+ *  copies the writer's tree and spans into a new version, swaps it in for
+ *  readers, and frees the version it replaced once no reader can hold it
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::publish (void)
+{
+    version_t* version = new version_t;
+    version->tree = clonenode(tree);
+    version->spans = spans;
+    retire(published.exchange(version));
+}
+
+/*----------------------------------------------------------------------------
+ * retire - caller is the writer
+ *
+ *  advances the epoch and waits for readers that entered before the advance
+ *  (and so may be holding the retired version) to leave
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::retire (version_t* version)
+{
+    if(version == NULL) return;
+
+    uint64_t previous = epoch.fetch_add(1);
+    while(readers[previous & 1].load() > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    deletenode(version->tree);
+    delete version;
+}
+
+/*----------------------------------------------------------------------------
+ * readbegin
+ *
+ *  lock free; the returned version stays valid until readend
+ *----------------------------------------------------------------------------*/
+template <class T>
+typename AssetIndex<T>::version_t* AssetIndex<T>::readbegin (int* parity)
+{
+    while(true)
+    {
+        uint64_t current = epoch.load();
+        *parity = current & 1;
+        readers[*parity].fetch_add(1);
+        if(epoch.load() == current) break;
+
+        /* Epoch Advanced Before Announcement Was Visible - Retry */
+        readers[*parity].fetch_sub(1);
+    }
+
+    return published.load();
+}
+
+/*----------------------------------------------------------------------------
+ * readend
+ *----------------------------------------------------------------------------*/
+template <class T>
+void AssetIndex<T>::readend (int parity)
+{
+    readers[parity].fetch_sub(1);
+}
+
 #endif  /* __asset_index__ */
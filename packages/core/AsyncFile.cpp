@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "AsyncFile.h"
+#include "OsApi.h"
+#include "EventLib.h"
+#include "RTExcept.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * open
+ *
+ *  returns a stream for writing to a new file, or NULL with errno set; a
+ *  file system that does not support direct i/o falls back to the page cache
+ *----------------------------------------------------------------------------*/
+FILE* AsyncFile::open (const char* path, bool direct, long prealloc_size, long buffer_size)
+{
+    /* Open File */
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    int fd = -1;
+    if(direct)
+    {
+        fd = ::open(path, flags | O_DIRECT, 0644);
+        if(fd < 0 && errno == EINVAL)
+        {
+            mlog(WARNING, "Direct i/o not supported for %s, writing through page cache", path);
+            direct = false;
+        }
+    }
+    if(fd < 0) fd = ::open(path, flags, 0644);
+    if(fd < 0) return NULL;
+
+    /* Preallocate File */
+    bool preallocated = false;
+    if(prealloc_size > 0)
+    {
+        int status = posix_fallocate(fd, 0, prealloc_size);
+        if(status == 0) preallocated = true;
+        else mlog(DEBUG, "Unable to preallocate %ld bytes for %s: %s", prealloc_size, path, LocalLib::err2str(status));
+    }
+
+    /* Create Stream */
+    AsyncFile* file = NULL;
+    try
+    {
+        file = new AsyncFile(fd, direct, preallocated, buffer_size);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Failed to create asynchronous file %s: %s", path, e.what());
+        ::close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    cookie_io_functions_t funcs = { NULL, cookieWrite, NULL, cookieClose };
+    FILE* fp = fopencookie(file, "w", funcs);
+    if(fp == NULL)
+    {
+        int err = errno;
+        delete file;
+        errno = err;
+    }
+
+    return fp;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+AsyncFile::AsyncFile (int _fd, bool _direct, bool _preallocated, long buffer_size):
+    ioCond(2)
+{
+    fd = _fd;
+    direct = _direct;
+    preallocated = _preallocated;
+    bufferSize = ((MAX(buffer_size, ALIGNMENT) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+    fillIndex = 0;
+    fillSize = 0;
+    pendingIndex = -1;
+    pendingSize = 0;
+    bytesWritten = 0;
+    ioError = 0;
+
+    for(int i = 0; i < NUM_BUFFERS; i++)
+    {
+        void* buf = NULL;
+        if(posix_memalign(&buf, ALIGNMENT, bufferSize) != 0)
+        {
+            for(int j = 0; j < i; j++) free(buffers[j]);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unable to allocate %ld byte buffer", bufferSize);
+        }
+        buffers[i] = (uint8_t*)buf;
+    }
+
+    active = true;
+    ioPid = new Thread(ioThread, this);
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+AsyncFile::~AsyncFile (void)
+{
+    ioCond.lock();
+    {
+        active = false;
+        ioCond.signal(FULL_SIG);
+    }
+    ioCond.unlock();
+    delete ioPid;
+
+    for(int i = 0; i < NUM_BUFFERS; i++) free(buffers[i]);
+    if(fd >= 0) ::close(fd);
+}
+
+/*----------------------------------------------------------------------------
+ * handOff
+ *
+ *  gives the buffer being filled to the i/o thread once it is done with the
+ *  previous one, and switches to filling the other buffer
+ *----------------------------------------------------------------------------*/
+bool AsyncFile::handOff (void)
+{
+    bool status;
+
+    ioCond.lock();
+    {
+        while(pendingIndex != -1) ioCond.wait(FREE_SIG, IO_PEND);
+        status = (ioError == 0);
+        if(status)
+        {
+            pendingIndex = fillIndex;
+            pendingSize = fillSize;
+            ioCond.signal(FULL_SIG);
+        }
+    }
+    ioCond.unlock();
+
+    fillIndex = (fillIndex + 1) % NUM_BUFFERS;
+    fillSize = 0;
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * drain
+ *
+ *  waits for the i/o thread to finish the buffer it has
+ *----------------------------------------------------------------------------*/
+bool AsyncFile::drain (void)
+{
+    bool status;
+
+    ioCond.lock();
+    {
+        while(pendingIndex != -1) ioCond.wait(FREE_SIG, IO_PEND);
+        status = (ioError == 0);
+    }
+    ioCond.unlock();
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * writeAll
+ *----------------------------------------------------------------------------*/
+bool AsyncFile::writeAll (const uint8_t* buf, long size)
+{
+    long offset = 0;
+    while(offset < size)
+    {
+        ssize_t ret = ::write(fd, &buf[offset], size - offset);
+        if(ret < 0)
+        {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        offset += ret;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * ioThread
+ *----------------------------------------------------------------------------*/
+void* AsyncFile::ioThread (void* parm)
+{
+    AsyncFile* file = (AsyncFile*)parm;
+
+    file->ioCond.lock();
+    while(true)
+    {
+        while(file->pendingIndex == -1 && file->active)
+        {
+            file->ioCond.wait(FULL_SIG, IO_PEND);
+        }
+        if(file->pendingIndex == -1) break;
+
+        /* Write Buffer Outside of Lock */
+        const uint8_t* buf = file->buffers[file->pendingIndex];
+        long size = file->pendingSize;
+        file->ioCond.unlock();
+        int err = file->writeAll(buf, size) ? 0 : errno;
+        file->ioCond.lock();
+
+        /* Release Buffer */
+        if(err != 0 && file->ioError == 0) file->ioError = err;
+        file->pendingIndex = -1;
+        file->ioCond.signal(FREE_SIG);
+    }
+    file->ioCond.unlock();
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * cookieWrite
+ *
+ *  a failed write is reported on the next call, since data handed to the
+ *  i/o thread has already been accepted
+ *----------------------------------------------------------------------------*/
+ssize_t AsyncFile::cookieWrite (void* cookie, const char* buf, size_t size)
+{
+    AsyncFile* file = (AsyncFile*)cookie;
+
+    size_t offset = 0;
+    while(offset < size)
+    {
+        long bytes_to_copy = MIN((long)(size - offset), file->bufferSize - file->fillSize);
+        LocalLib::copy(&file->buffers[file->fillIndex][file->fillSize], &buf[offset], bytes_to_copy);
+        file->fillSize += bytes_to_copy;
+        offset += bytes_to_copy;
+
+        if(file->fillSize == file->bufferSize)
+        {
+            if(!file->handOff())
+            {
+                errno = file->ioError;
+                return -1;
+            }
+        }
+    }
+
+    file->bytesWritten += size;
+    return size;
+}
+
+/*----------------------------------------------------------------------------
+ * cookieClose
+ *----------------------------------------------------------------------------*/
+int AsyncFile::cookieClose (void* cookie)
+{
+    AsyncFile* file = (AsyncFile*)cookie;
+
+    bool status = file->drain();
+
+    /* Write Remaining Data */
+    if(status && file->fillSize > 0)
+    {
+        if(file->direct && (file->fillSize % ALIGNMENT) != 0)
+        {
+            int flags = fcntl(file->fd, F_GETFL);
+            fcntl(file->fd, F_SETFL, flags & ~O_DIRECT);
+        }
+        status = file->writeAll(file->buffers[file->fillIndex], file->fillSize);
+        if(!status) file->ioError = errno;
+    }
+
+    /* Release Unused Preallocation */
+    if(file->preallocated && ftruncate(file->fd, file->bytesWritten) != 0)
+    {
+        if(status) file->ioError = errno;
+        status = false;
+    }
+
+    int err = file->ioError;
+    if(::close(file->fd) != 0 && status)
+    {
+        err = errno;
+        status = false;
+    }
+    file->fd = -1;
+
+    delete file;
+
+    if(!status)
+    {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
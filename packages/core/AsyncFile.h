@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __async_file__
+#define __async_file__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+#include <stdio.h>
+
+/******************************************************************************
+ * ASYNC FILE CLASS
+ *
+ *  Write-only file whose data is written to disk by a dedicated thread.  The
+ *  caller fills one of two aligned buffers while the other is being written,
+ *  so it only blocks when it fills a buffer before the previous one reaches
+ *  the disk.  The file is returned as an ordinary stdio stream, and closing
+ *  the stream writes out whatever is left and waits for the thread.
+ *
+ *  Direct i/o bypasses the page cache; the last partial buffer is written
+ *  without it.  Preallocating reserves the expected size of the file up front
+ *  to keep it contiguous, and the file is truncated to what was written when
+ *  it is closed.
+ ******************************************************************************/
+
+class AsyncFile
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const long DEFAULT_BUFFER_SIZE = 0x400000; // 4MB
+        static const long ALIGNMENT = 0x1000; // required by direct i/o
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static FILE*    open            (const char* path, bool direct=false, long prealloc_size=0, long buffer_size=DEFAULT_BUFFER_SIZE);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int NUM_BUFFERS = 2;
+        static const int FULL_SIG = 0;
+        static const int FREE_SIG = 1;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        int             fd;
+        bool            direct;
+        bool            preallocated;
+        long            bufferSize;
+        uint8_t*        buffers[NUM_BUFFERS];
+        int             fillIndex;      // buffer being filled by the caller
+        long            fillSize;
+        int             pendingIndex;   // buffer handed to the i/o thread, or -1
+        long            pendingSize;
+        long            bytesWritten;
+        int             ioError;        // errno of the first failed write
+        bool            active;
+        Cond            ioCond;
+        Thread*         ioPid;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        AsyncFile       (int _fd, bool _direct, bool _preallocated, long buffer_size);
+                        ~AsyncFile      (void);
+
+        bool            handOff         (void);
+        bool            drain           (void);
+        bool            writeAll        (const uint8_t* buf, long size);
+
+        static void*    ioThread        (void* parm);
+        static ssize_t  cookieWrite     (void* cookie, const char* buf, size_t size);
+        static int      cookieClose     (void* cookie);
+};
+
+#endif  /* __async_file__ */
@@ -45,6 +45,7 @@ const struct luaL_Reg CaptureDispatch::LuaMetaTable[] = {
     {"capture",     luaCapture},
     {"clear",       luaClear},
     {"remove",      luaRemove},
+    {"lookup",      luaLookup},
     {NULL,          NULL}
 };
 
@@ -53,17 +54,27 @@ const struct luaL_Reg CaptureDispatch::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<output stream name>)
+ * luaCreate - create([<output stream name>], [<history size in bytes>])
+ *
+ *  captured values are kept in a fixed size ring buffer, indexed by field
+ *  name, so that the latest value of each field can be looked up
  *----------------------------------------------------------------------------*/
 int CaptureDispatch::luaCreate (lua_State* L)
 {
     try
     {
         /* Get Parameters */
-        const char* outq_name = getLuaString(L, 1, true);
+        const char* outq_name = getLuaString(L, 1, true, NULL);
+        long history_size = getLuaInteger(L, 2, true, DEFAULT_HISTORY_SIZE);
+
+        /* Check History Size */
+        if(history_size < (long)sizeof(captured_t) || history_size > INT_MAX)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid history size: %ld", history_size);
+        }
 
         /* Return Dispatch Object */
-        return createLuaObject(L, new CaptureDispatch(L, outq_name));
+        return createLuaObject(L, new CaptureDispatch(L, outq_name, history_size));
     }
     catch(const RunTimeException& e)
     {
@@ -79,12 +90,20 @@ int CaptureDispatch::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-CaptureDispatch::CaptureDispatch (lua_State* L, const char* outq_name):
+CaptureDispatch::CaptureDispatch (lua_State* L, const char* outq_name, int history_size):
     DispatchObject(L, LuaMetaName, LuaMetaTable)
 
 {
     outQ = NULL;
     if(outq_name) outQ = new Publisher(outq_name);
+
+    historySlots = history_size / sizeof(captured_t);
+    historyNext = 0;
+    history = new captured_t [historySlots];
+    for(int i = 0; i < historySlots; i++)
+    {
+        history[i].field_name = NULL;
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -93,6 +112,7 @@ CaptureDispatch::CaptureDispatch (lua_State* L, const char* outq_name):
 CaptureDispatch::~CaptureDispatch (void)
 {
     if(outQ) delete outQ;
+    delete [] history;
 }
 
 /*----------------------------------------------------------------------------
@@ -108,6 +128,52 @@ void CaptureDispatch::freeCaptureEntry (void* obj, void* parm)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * addHistory
+ *
+ *  Notes: must be called inside capMut lock
+ *----------------------------------------------------------------------------*/
+void CaptureDispatch::addHistory (const char* field_name, long id, const char* value)
+{
+    captured_t* slot = &history[historyNext];
+
+    /* Drop Index of Overwritten Value */
+    if(slot->field_name)
+    {
+        int latest;
+        if(historyIndex.find(slot->field_name, &latest) && latest == historyNext)
+        {
+            historyIndex.remove(slot->field_name);
+        }
+    }
+
+    /* Store Value */
+    slot->field_name = field_name;
+    slot->id = id;
+    StringLib::copy(slot->value, value, RecordObject::MAX_VAL_STR_SIZE);
+    historyIndex.add(field_name, historyNext);
+
+    /* Advance Ring */
+    historyNext = (historyNext + 1) % historySlots;
+}
+
+/*----------------------------------------------------------------------------
+ * removeCapture
+ *
+ *  Notes: must be called inside capMut lock
+ *----------------------------------------------------------------------------*/
+void CaptureDispatch::removeCapture (capture_t* cap)
+{
+    for(int i = 0; i < captures.length(); i++)
+    {
+        if(captures[i] == cap)
+        {
+            captures.remove(i);
+            break;
+        }
+    }
+}
+
 /*----------------------------------------------------------------------------
  * processRecord
  *----------------------------------------------------------------------------*/
@@ -133,8 +199,11 @@ bool CaptureDispatch::processRecord (RecordObject* record, okey_t key)
 
             /* Capture */
             char valbuf[RecordObject::MAX_VAL_STR_SIZE];
-            if(record->getValueText(record->getField(cap->field_name), valbuf))
+            if(record->getValueText(cap->field->resolve(record), valbuf))
             {
+                /* Keep Value */
+                addHistory(cap->field_name, record->getRecordId(), valbuf);
+
                 /* Signal Blocking Command */
                 if(cap->timeout > 0)
                 {
@@ -176,11 +245,9 @@ int CaptureDispatch::luaCapture (lua_State* L)
         capture_t* cap = new capture_t(filter, id, field_str, timeout);
 
         /* Add Capture to Captures */
-        int cap_index;
         lua_obj->capMut.lock();
         {
             lua_obj->captures.add(cap);
-            cap_index = lua_obj->captures.length() - 1;
         }
         lua_obj->capMut.unlock();
 
@@ -196,10 +263,10 @@ int CaptureDispatch::luaCapture (lua_State* L)
                 throw RunTimeException(CRITICAL, RTE_ERROR, "timed out waiting to capture field");
             }
 
-            /* Delete Capture */
+            /* Delete Capture (by pointer, other captures may have come and gone) */
             lua_obj->capMut.lock();
             {
-                lua_obj->captures.remove(cap_index);
+                lua_obj->removeCapture(cap);
             }
             lua_obj->capMut.unlock();
         }
@@ -269,7 +336,7 @@ int CaptureDispatch::luaRemove (lua_State* L)
             {
                 if(StringLib::match(lua_obj->captures[i]->field_name, field_str))
                 {
-                    lua_obj->captures.remove(i);
+                    lua_obj->captures.remove(i--);
                     status = true;
                 }
             }
@@ -285,3 +352,49 @@ int CaptureDispatch::luaRemove (lua_State* L)
     /* Return Status */
     return returnLuaStatus(L, status);
 }
+
+/*----------------------------------------------------------------------------
+ * luaLookup - :lookup(<field name>) --> latest captured value, id | nil
+ *----------------------------------------------------------------------------*/
+int CaptureDispatch::luaLookup (lua_State* L)
+{
+    try
+    {
+        /* Get Self */
+        CaptureDispatch* lua_obj = (CaptureDispatch*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        const char* field_str = getLuaString(L, 2);
+
+        /* Lookup Latest Value */
+        bool found = false;
+        char value[RecordObject::MAX_VAL_STR_SIZE];
+        long id = 0;
+        lua_obj->capMut.lock();
+        {
+            int slot;
+            if(lua_obj->historyIndex.find(field_str, &slot))
+            {
+                StringLib::copy(value, lua_obj->history[slot].value, RecordObject::MAX_VAL_STR_SIZE);
+                id = lua_obj->history[slot].id;
+                found = true;
+            }
+        }
+        lua_obj->capMut.unlock();
+
+        /* Return Value */
+        if(found)
+        {
+            lua_pushstring(L, value);
+            lua_pushinteger(L, id);
+            return 2;
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error looking up capture: %s", e.what());
+    }
+
+    lua_pushnil(L);
+    return 1;
+}
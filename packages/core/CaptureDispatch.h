@@ -39,6 +39,7 @@
 #include "DispatchObject.h"
 #include "OsApi.h"
 #include "List.h"
+#include "Dictionary.h"
 #include "RecordObject.h"
 #include "MsgQ.h"
 
@@ -57,6 +58,8 @@ class CaptureDispatch: public DispatchObject
         static const char* LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
 
+        static const int DEFAULT_HISTORY_SIZE = 0x10000; // bytes
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -75,17 +78,25 @@ class CaptureDispatch: public DispatchObject
             long            id;
             Cond            cond;
             int             timeout;
-            const char*     field_name;
+            const char*     field_name; // interned
+            RecordObject::FieldHandle* field;
 
             capture_t(bool _filter_id, long _id, const char* _field_str, int _timeout)
                 { filter_id = _filter_id;
                   id = _id;
-                  field_name = StringLib::duplicate(_field_str);
+                  field_name = StringLib::intern(_field_str);
+                  field = new RecordObject::FieldHandle(_field_str);
                   timeout = _timeout; }
             ~capture_t(void)
-                { if(field_name) delete [] field_name; }
+                { delete field; }
         };
 
+        typedef struct {
+            const char*     field_name; // interned, NULL if slot unused
+            long            id;
+            char            value[RecordObject::MAX_VAL_STR_SIZE];
+        } captured_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -93,15 +104,21 @@ class CaptureDispatch: public DispatchObject
         MgList<capture_t*>  captures;
         Mutex               capMut;
         Publisher*          outQ;
+        captured_t*         history;        // ring buffer of captured values
+        int                 historySlots;
+        int                 historyNext;
+        Dictionary<int>     historyIndex;   // field name --> slot of latest value
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                    CaptureDispatch     (lua_State* L, const char* outq_name);
+                    CaptureDispatch     (lua_State* L, const char* outq_name, int history_size);
                     ~CaptureDispatch    (void);
 
         static void freeCaptureEntry    (void* obj, void* parm);
+        void        addHistory          (const char* field_name, long id, const char* value);
+        void        removeCapture       (capture_t* cap);
 
         /* overridden methods */
         bool        processRecord       (RecordObject* record, okey_t key);
@@ -110,6 +127,7 @@ class CaptureDispatch: public DispatchObject
         static int  luaCapture          (lua_State* L);
         static int  luaClear            (lua_State* L);
         static int  luaRemove           (lua_State* L);
+        static int  luaLookup           (lua_State* L);
 };
 
 #endif  /* __capture_dispatch__ */
@@ -40,12 +40,15 @@
 #include "StringLib.h"
 #include "TimeLib.h"
 
+#include <string.h>
+#include <sys/uio.h>
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - cluster(<role>, <protocol>, <ip_addr>, <port>, <"SERVER"|"CLIENT">, <stream name>)
+ * luaCreate - cluster(<role>, <protocol>, <ip_addr>, <port>, <"SERVER"|"CLIENT">, <stream name>, [<compress>])
  *
  *  where <protocol> is:
  *
@@ -68,6 +71,7 @@ int ClusterSocket::luaCreate (lua_State* L)
         int         port      = (int)getLuaInteger(L, 4);
         bool        is_server = getLuaBoolean(L, 5);
         const char* q_name    = getLuaString(L, 6);
+        bool        compress  = getLuaBoolean(L, 7, true, false);
 
         /* Get Server Parameter */
         if(is_server)
@@ -79,7 +83,7 @@ int ClusterSocket::luaCreate (lua_State* L)
         }
 
         /* Return File Device Object */
-        return createLuaObject(L, new ClusterSocket(L, ip_addr, port, (ClusterSocket::role_t)role, (ClusterSocket::protocol_t)protocol, is_server, false, q_name));
+        return createLuaObject(L, new ClusterSocket(L, ip_addr, port, (ClusterSocket::role_t)role, (ClusterSocket::protocol_t)protocol, is_server, false, q_name, compress));
     }
     catch(const RunTimeException& e)
     {
@@ -91,7 +95,7 @@ int ClusterSocket::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-ClusterSocket::ClusterSocket(lua_State* L, const char* _ip_addr, int _port, role_t _role, protocol_t _protocol, bool _is_server, bool _is_blind, const char* passthruq):
+ClusterSocket::ClusterSocket(lua_State* L, const char* _ip_addr, int _port, role_t _role, protocol_t _protocol, bool _is_server, bool _is_blind, const char* passthruq, bool _compress):
     TcpSocket(L, INVALID_RC, _ip_addr, _port, _role),
     read_connections(MAX_NUM_CONNECTIONS),
     write_connections(MAX_NUM_CONNECTIONS)
@@ -99,6 +103,7 @@ ClusterSocket::ClusterSocket(lua_State* L, const char* _ip_addr, int _port, role
     protocol = _protocol;
     is_server = _is_server;
     is_blind = _is_blind;
+    compress = _compress;
 
     if(passthruq)
     {
@@ -152,8 +157,7 @@ ClusterSocket::~ClusterSocket(void)
     while (fd != (int)INVALID_KEY)
     {
         SockLib::sockclose(fd);
-        if(readCon->payload) delete [] readCon->payload;
-        if(readCon) delete readCon;
+        freeConnection(readCon);
         fd = read_connections.next( &readCon );
     }
 
@@ -161,7 +165,7 @@ ClusterSocket::~ClusterSocket(void)
     while (fd != (int)INVALID_KEY)
     {
         SockLib::sockclose(fd);
-        if(writeCon) delete writeCon;
+        freeConnection(writeCon);
         fd = write_connections.next( &writeCon );
     }
 }
@@ -324,17 +328,32 @@ int ClusterSocket::onRead(int fd)
                 connection->buffer_size = 0;
             }
 
-            /* Read More Data */
-            int bytes_left = MSG_BUFFER_SIZE - connection->buffer_size;
-            if(bytes_left > MIN_BUFFER_SIZE)
+            /* Read Large Payload Directly Into Its Allocation */
+            int pay_bytes_left = connection->payload_size - connection->payload_index;
+            if(connection->payload && connection->payload_index >= 0 &&
+               connection->buffer_size == 0 && pay_bytes_left > DIRECT_READ_SIZE)
             {
-                int bytes = SockLib::sockrecv(fd, &connection->buffer[connection->buffer_size], bytes_left, IO_CHECK);
+                int bytes = SockLib::sockrecv(fd, &connection->payload[connection->payload_index], pay_bytes_left, IO_CHECK);
                 if(bytes > 0)
                 {
-                    connection->buffer_size += bytes;
+                    connection->payload_index += bytes;
                     spin_block = false;
                 }
             }
+            else
+            {
+                /* Read More Data */
+                int bytes_left = MSG_BUFFER_SIZE - connection->buffer_size;
+                if(bytes_left > MIN_BUFFER_SIZE)
+                {
+                    int bytes = SockLib::sockrecv(fd, &connection->buffer[connection->buffer_size], bytes_left, IO_CHECK);
+                    if(bytes > 0)
+                    {
+                        connection->buffer_size += bytes;
+                        spin_block = false;
+                    }
+                }
+            }
         }
         else if(role == WRITER)
         {
@@ -362,7 +381,9 @@ int ClusterSocket::onRead(int fd)
 /*----------------------------------------------------------------------------
  * onWrite
  *
- *  Notes: performed for every connection that is ready to have data written to it
+ *  Notes: performed for every connection that is ready to have data written to it;
+ *  queued messages are sent in place, each behind its header, with as many
+ *  messages as are waiting gathered into a single send
  *----------------------------------------------------------------------------*/
 int ClusterSocket::onWrite(int fd)
 {
@@ -375,110 +396,108 @@ int ClusterSocket::onWrite(int fd)
         /* Check Meter */
         if(connection->meter < METER_SEND_THRESH || is_blind)
         {
-            /* While room in buffer for at least header */
-            while(connection->buffer_index < (MSG_BUFFER_SIZE - MSG_HDR_SIZE))
+            while(true)
             {
-                /* Check If Payload Reference Has More Data */
-                if(connection->payload_left > 0)
+                /* Gather Messages */
+                if(connection->num_refs < MAX_SEND_MSGS)
                 {
-                    /* Populate Buffer */
-                    uint32_t bytes_left = MSG_BUFFER_SIZE - connection->buffer_index;
-                    uint32_t cpylen = connection->payload_left < bytes_left ? connection->payload_left : bytes_left;
-                    int payload_index = connection->payload_ref.size - connection->payload_left;
-                    uint8_t* payload_buffer = (uint8_t*)connection->payload_ref.data;
-                    LocalLib::copy(&connection->buffer[connection->buffer_index], &payload_buffer[payload_index], cpylen);
-                    connection->buffer_index += cpylen;
-                    connection->payload_left -= cpylen;
-                }
-
-                /* Get New Payload Reference */
-                if((connection->payload_left == 0) &&
-                   (connection->buffer_index < (MSG_BUFFER_SIZE - MSG_HDR_SIZE)))
-                {
-                    int status = connection->subconnq->receiveRef(connection->payload_ref, IO_CHECK);
-                    if(status > 0)
+                    int received = connection->subconnq->receiveBatch(&connection->refs[connection->num_refs], MAX_SEND_MSGS - connection->num_refs, IO_CHECK);
+                    for(int i = 0; i < received; i++)
                     {
-                        /* Populate Header */
-                        connection->buffer[connection->buffer_index++] = (uint8_t)(connection->payload_ref.size >> 24);
-                        connection->buffer[connection->buffer_index++] = (uint8_t)(connection->payload_ref.size >> 16);
-                        connection->buffer[connection->buffer_index++] = (uint8_t)(connection->payload_ref.size >>  8);
-                        connection->buffer[connection->buffer_index++] = (uint8_t)(connection->payload_ref.size >>  0);
-
-                        /* Populate Rest of Buffer */
-                        int bytes_left = MSG_BUFFER_SIZE - connection->buffer_index;
-                        int cpylen = connection->payload_ref.size < bytes_left ? connection->payload_ref.size : bytes_left;
-                        LocalLib::copy(&connection->buffer[connection->buffer_index], connection->payload_ref.data, cpylen);
-                        connection->buffer_index += cpylen;
-
-                        /* Calculate Payload Left and Dereference if Payload Fully Buffered */
-                        connection->payload_left = connection->payload_ref.size - cpylen;
-                        if(connection->payload_left == 0)
+                        int r = connection->num_refs++;
+                        uint32_t size = (uint32_t)connection->refs[r].size;
+                        connection->zdata[r] = NULL;
+                        connection->sizes[r] = size;
+
+                        /* Compress Payload */
+                        if(compress && size >= MIN_COMPRESS_SIZE)
                         {
-                            connection->subconnq->dereference(connection->payload_ref);
+                            if(!connection->deflater) connection->deflater = new GzipStream(GzipStream::DEFLATE);
+                            const uint8_t* deflated = NULL;
+                            long deflated_size = connection->deflater->deflate(connection->refs[r].data, size, false, &deflated);
+                            connection->zdata[r] = new uint8_t [deflated_size];
+                            LocalLib::copy(connection->zdata[r], deflated, deflated_size);
+                            connection->sizes[r] = (uint32_t)deflated_size;
+                            size = (uint32_t)deflated_size | COMPRESSED_FLAG;
                         }
 
-                        /* Release Spin Block */
-                        spin_block = false;
+                        /* Populate Header */
+                        connection->headers[r][0] = (uint8_t)(size >> 24);
+                        connection->headers[r][1] = (uint8_t)(size >> 16);
+                        connection->headers[r][2] = (uint8_t)(size >>  8);
+                        connection->headers[r][3] = (uint8_t)(size >>  0);
+                    }
+                }
+
+                /* Check Nothing to Send */
+                if(connection->num_refs == 0) break;
+
+                /* Build Send Vector - skipping what was already sent of the first message */
+                struct iovec iov[MAX_SEND_MSGS * 2];
+                int iovcnt = 0;
+                uint32_t skip = connection->bytes_sent;
+                int64_t total = 0;
+                for(int r = 0; r < connection->num_refs; r++)
+                {
+                    uint32_t size = connection->sizes[r];
+                    if(skip < MSG_HDR_SIZE)
+                    {
+                        iov[iovcnt].iov_base = &connection->headers[r][skip];
+                        iov[iovcnt].iov_len = MSG_HDR_SIZE - skip;
+                        total += iov[iovcnt++].iov_len;
+                        skip = 0;
                     }
                     else
                     {
-                        // If queue is empty, then stop populating buffer
-                        // and continue to code that sends it
-                        break;
+                        skip -= MSG_HDR_SIZE;
                     }
+                    if(skip < size)
+                    {
+                        uint8_t* payload = connection->zdata[r] ? connection->zdata[r] : (uint8_t*)connection->refs[r].data;
+                        iov[iovcnt].iov_base = payload + skip;
+                        iov[iovcnt].iov_len = size - skip;
+                        total += iov[iovcnt++].iov_len;
+                    }
+                    skip = 0;
                 }
-            }
 
-            /* Send Data */
-            while(connection->bytes_processed < connection->buffer_index)
-            {
-                int bytes_left = connection->buffer_index - connection->bytes_processed;
-                int bytes = SockLib::socksend(fd, &connection->buffer[connection->bytes_processed], bytes_left, IO_CHECK);
-                if(bytes > 0)
-                {
-                    connection->bytes_processed += bytes;
-                    spin_block = false;
-                }
-                else
+                /* Send Data */
+                int bytes = SockLib::socksendv(fd, iov, iovcnt);
+                if(bytes < 0)
                 {
                     // Failed to send data on socket that was marked for writing;
                     // therefore return failure which will close socket
                     return -1;
                 }
-            }
-
-            /* Check If Buffer Data Finished Being Sent */
-            if(connection->bytes_processed == connection->buffer_index)
-            {
-                /* Reset Buffer Index */
-                connection->buffer_index = 0;
-                connection->bytes_processed = 0;
-
-                /* Optimization - Send Unbuffered Payload Data */
-                while(connection->payload_left > 0)
+                else if(bytes == 0)
                 {
-                    int payload_index = connection->payload_ref.size - connection->payload_left;
-                    uint8_t* byte_buffer = (uint8_t*)connection->payload_ref.data;
-                    int bytes = SockLib::socksend(fd, &byte_buffer[payload_index], connection->payload_left, IO_CHECK);
-                    if(bytes > 0)
-                    {
-                        connection->payload_left -= bytes;
-                        spin_block = false;
+                    // socket buffer full, continue on next poll cycle
+                    break;
+                }
+                spin_block = false;
 
-                        /* Dereference If Payload Fully Sent */
-                        if(connection->payload_left <= 0)
-                        {
-                            connection->subconnq->dereference(connection->payload_ref);
-                        }
-                    }
-                    else
-                    {
-                        // don't return error since this is an optimization check
-                        // instead stop for now, code will do the right thing on next
-                        // poll cycle
-                        break;
-                    }
+                /* Release Messages Fully Sent */
+                int sent = 0;
+                uint64_t bytes_sent = (uint64_t)connection->bytes_sent + bytes;
+                while(sent < connection->num_refs && bytes_sent >= (uint64_t)(MSG_HDR_SIZE + connection->sizes[sent]))
+                {
+                    bytes_sent -= MSG_HDR_SIZE + connection->sizes[sent];
+                    delete [] connection->zdata[sent];
+                    sent++;
                 }
+                if(sent > 0)
+                {
+                    connection->subconnq->dereferenceBatch(connection->refs, sent);
+                    connection->num_refs -= sent;
+                    memmove(&connection->refs[0], &connection->refs[sent], connection->num_refs * sizeof(Subscriber::msgRef_t));
+                    memmove(&connection->zdata[0], &connection->zdata[sent], connection->num_refs * sizeof(uint8_t*));
+                    memmove(&connection->sizes[0], &connection->sizes[sent], connection->num_refs * sizeof(uint32_t));
+                    memmove(&connection->headers[0], &connection->headers[sent], connection->num_refs * MSG_HDR_SIZE);
+                }
+                connection->bytes_sent = (uint32_t)bytes_sent;
+
+                /* Stop on Partial Send */
+                if(bytes < total) break;
             }
         }
     }
@@ -514,6 +533,12 @@ int ClusterSocket::onAlive(int fd)
                 SockLib::socksend(fd, &meter, 1, IO_CHECK);
             }
 
+            /* Post Payload Completed by a Direct Read */
+            if(connection->payload && connection->payload_index >= connection->payload_size)
+            {
+                if(!postPayload(connection)) return 0;
+            }
+
             while(connection->buffer_index < connection->buffer_size)
             {
                 /* Process Header */
@@ -526,6 +551,9 @@ int ClusterSocket::onAlive(int fd)
                     /* Header Complete */
                     if(connection->payload_index == 0)
                     {
+                        uint32_t header = (uint32_t)connection->payload_size;
+                        connection->compressed = (header & COMPRESSED_FLAG) != 0;
+                        connection->payload_size = (int32_t)(header & ~COMPRESSED_FLAG);
                         if(connection->payload_size > 0 && connection->payload_size <= MAX_MSG_SIZE)
                         {
                             connection->payload = new uint8_t [connection->payload_size];
@@ -551,24 +579,7 @@ int ClusterSocket::onAlive(int fd)
                     /* Payload Complete */
                     if(connection->payload_index >= connection->payload_size)
                     {
-                        /* Publisher queue is single exit point for a cluster socket... block is appropriate below */
-                        int status = pubsockq->postCopy(connection->payload, connection->payload_size, SYS_TIMEOUT);
-                        if(status > 0 || is_blind)
-                        {
-                            delete [] connection->payload;
-                            connection->payload = NULL;
-                            connection->payload_size = 0;
-                            connection->payload_index = -MSG_HDR_SIZE;
-                            spin_block = false;
-                        }
-                        else
-                        {
-                            // If metering is working correctly, then this message should never come out.
-                            // A timed out post indicates a full queue.  If the reader is able to send the
-                            // meter to the writer, it then would indicate not to send anymore data.
-                            mlog(CRITICAL, "Cluster socket timed out on post to %s", pubsockq->getName());
-                            break; // exit loop to allow other processing to continue
-                        }
+                        if(!postPayload(connection)) break; // exit loop to allow other processing to continue
                     }
                 }
             }
@@ -652,8 +663,7 @@ int ClusterSocket::onDisconnect(int fd)
         if(role == READER)
         {
             read_connection_t* connection = read_connections[fd];
-            if(connection->payload) delete [] connection->payload;
-            delete connection;
+            freeConnection(connection);
             if(!read_connections.remove(fd))
             {
                 mlog(CRITICAL, "Cluster socket on %s:%d failed to remove connection information for reader file descriptor %d", getIpAddr(), getPort(), fd);
@@ -663,8 +673,9 @@ int ClusterSocket::onDisconnect(int fd)
         if(role == WRITER)
         {
             write_connection_t* connection = write_connections[fd];
+            if(connection->num_refs > 0) connection->subconnq->dereferenceBatch(connection->refs, connection->num_refs);
             if(protocol == BUS && connection->subconnq) delete connection->subconnq;
-            delete connection;
+            freeConnection(connection);
             if(!write_connections.remove(fd))
             {
                 mlog(CRITICAL, "Cluster socket on %s:%d failed to remove connection information for writer file descriptor %d", getIpAddr(), getPort(), fd);
@@ -682,6 +693,82 @@ int ClusterSocket::onDisconnect(int fd)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * postPayload
+ *
+ *  hands the completed payload to the queue without copying it; returns
+ *  false if the post fails (full queue or no subscribers yet), leaving the
+ *  payload to be posted again
+ *----------------------------------------------------------------------------*/
+bool ClusterSocket::postPayload(read_connection_t* connection)
+{
+    /* Decompress Payload (only once, the post may be retried) */
+    if(connection->compressed)
+    {
+        if(!connection->inflater) connection->inflater = new GzipStream(GzipStream::INFLATE);
+        const uint8_t* inflated = NULL;
+        long inflated_size = connection->inflater->inflate(connection->payload, connection->payload_size, &inflated);
+        if(inflated_size <= 0 || inflated_size > MAX_MSG_SIZE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid compressed message of size %d", connection->payload_size);
+        }
+        delete [] connection->payload;
+        connection->payload = new uint8_t [inflated_size];
+        LocalLib::copy(connection->payload, inflated, inflated_size);
+        connection->payload_size = (int32_t)inflated_size;
+        connection->compressed = false;
+    }
+
+    /* Publisher queue is single exit point for a cluster socket... block is appropriate below */
+    int status = pubsockq->postRef(connection->payload, connection->payload_size, SYS_TIMEOUT);
+    if(status != MsgQ::STATE_OKAY)
+    {
+        if(status == MsgQ::STATE_NO_SUBSCRIBERS && !is_blind)
+        {
+            // Hold the payload until something subscribes; the reader stops
+            // consuming the connection which meters the writer back
+            return false;
+        }
+        else if(!is_blind)
+        {
+            // If metering is working correctly, then this message should never come out.
+            // A timed out post indicates a full queue.  If the reader is able to send the
+            // meter to the writer, it then would indicate not to send anymore data.
+            mlog(CRITICAL, "Cluster socket timed out on post to %s", pubsockq->getName());
+            return false;
+        }
+        delete [] connection->payload; // not taken by the queue
+    }
+
+    connection->payload = NULL;
+    connection->payload_size = 0;
+    connection->payload_index = -MSG_HDR_SIZE;
+    spin_block = false;
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * freeConnection
+ *----------------------------------------------------------------------------*/
+void ClusterSocket::freeConnection(read_connection_t* connection)
+{
+    if(connection->payload) delete [] connection->payload;
+    delete connection->inflater;
+    delete connection;
+}
+
+/*----------------------------------------------------------------------------
+ * freeConnection
+ *
+ *  refs still held must already be dereferenced by the caller
+ *----------------------------------------------------------------------------*/
+void ClusterSocket::freeConnection(write_connection_t* connection)
+{
+    for(int r = 0; r < connection->num_refs; r++) delete [] connection->zdata[r];
+    delete connection->deflater;
+    delete connection;
+}
+
 /*----------------------------------------------------------------------------
  * qMeter
  *----------------------------------------------------------------------------*/
@@ -41,6 +41,7 @@
 #include "OsApi.h"
 #include "DeviceObject.h"
 #include "TcpSocket.h"
+#include "GzipStream.h"
 
 /******************************************************************************
  * CLUSTER SOCKET CLASS
@@ -63,6 +64,10 @@ class ClusterSocket: public TcpSocket
         static const int MSG_BUFFER_SIZE        = 0x10000; // 64KB
         static const int MIN_BUFFER_SIZE        = 0x0400; // 1KB
         static const int MAX_MSG_SIZE           = 0x10000000; // 256MB
+        static const int MAX_SEND_MSGS          = 64; // messages gathered into one send
+        static const int DIRECT_READ_SIZE       = 0x4000; // 16KB, payloads left larger than this bypass the read buffer
+        static const int MIN_COMPRESS_SIZE      = 256; // smaller messages are sent as is
+        static const uint32_t COMPRESSED_FLAG   = 0x80000000; // set in the size header of compressed messages
         static const int MAX_NUM_CONNECTIONS    = 256;
 
         /*--------------------------------------------------------------------
@@ -80,7 +85,7 @@ class ClusterSocket: public TcpSocket
 
         static int      luaCreate           (lua_State* L);
 
-                        ClusterSocket       (lua_State* L, const char* _ip_addr, int _port, role_t _role, protocol_t _protocol, bool _is_server, bool _is_blind=false, const char* passthruq=NULL);
+                        ClusterSocket       (lua_State* L, const char* _ip_addr, int _port, role_t _role, protocol_t _protocol, bool _is_server, bool _is_blind=false, const char* passthruq=NULL, bool _compress=false);
                         ~ClusterSocket      (void);
 
         bool            isConnected         (int num_connections = 1) override;
@@ -102,17 +107,21 @@ class ClusterSocket: public TcpSocket
             int32_t   payload_index; // goes negative for header
             int32_t   buffer_index; // signed for comparisons
             int32_t   buffer_size; // returned from receive call
+            bool      compressed; // payload must be inflated before it is posted
+            GzipStream* inflater; // created on the first compressed message
             uint8_t   buffer[MSG_BUFFER_SIZE];
         } read_connection_t;
 
         typedef struct
         {
             Subscriber* subconnq;
-            Subscriber::msgRef_t payload_ref;
-            uint32_t  payload_left;
-            uint32_t  bytes_processed;
-            uint32_t  buffer_index;
-            uint8_t   buffer[MSG_BUFFER_SIZE];
+            Subscriber::msgRef_t refs[MAX_SEND_MSGS]; // gathered and not yet fully sent
+            uint8_t*  zdata[MAX_SEND_MSGS]; // compressed payload sent in place of the ref, or NULL
+            uint32_t  sizes[MAX_SEND_MSGS]; // payload bytes put on the wire
+            uint8_t   headers[MAX_SEND_MSGS][MSG_HDR_SIZE];
+            GzipStream* deflater; // created on the first compressed message
+            int       num_refs;
+            uint32_t  bytes_sent; // of the first message, header included
             uint8_t   meter;
         } write_connection_t;
 
@@ -128,6 +137,7 @@ class ClusterSocket: public TcpSocket
         protocol_t                      protocol;
         bool                            is_server;
         bool                            is_blind; // send as fast as you can, tolerate drops in data
+        bool                            compress; // gzip messages written to connections
 
         const char*                     sockqname;
         Publisher*                      pubsockq;
@@ -148,6 +158,9 @@ class ClusterSocket: public TcpSocket
         int             onAlive             (int fd);
         int             onConnect           (int fd);
         int             onDisconnect        (int fd);
+        bool            postPayload         (read_connection_t* connection);
+        void            freeConnection      (read_connection_t* connection);
+        void            freeConnection      (write_connection_t* connection);
         uint8_t         qMeter              (void);
 };
 
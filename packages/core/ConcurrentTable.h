@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __concurrent_table__
+#define __concurrent_table__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <assert.h>
+#include <atomic>
+#include <thread>
+#include "OsApi.h"
+
+/******************************************************************************
+ * CONCURRENT TABLE TEMPLATE
+ ******************************************************************************/
+/*
+ * ConcurrentTable - bounded hash of data type T and index type K shared by
+ *  many threads; lookups take no lock, writers lock one stripe of buckets,
+ *  and entries leave the table approximately least recently used first
+ *
+ *  Entries are immutable once added (an overwrite replaces the node), so a
+ *  reader copies out a consistent value.  Nodes unlinked by a writer are
+ *  retired and only freed after every reader that could still be walking
+ *  them has left; the eviction function is called on an entry at that point,
+ *  regardless of whether it was removed, overwritten, evicted, or cleared.
+ */
+template <class T, typename K=unsigned long>
+class ConcurrentTable
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * CONSTANTS
+         *--------------------------------------------------------------------*/
+
+        static const long DEFAULT_TABLE_SIZE = 256;
+        static const int DEFAULT_NUM_STRIPES = 16;
+        static const int EVICTION_SAMPLES = 8;      // entries compared when choosing a victim
+        static const int RECLAIM_THRESHOLD = 64;    // retired nodes allowed before they are freed
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef K (*hash_func_t) (K);
+        typedef void (*evict_func_t) (K key, T& data, void* parm);
+        typedef bool (*iterate_func_t) (K key, const T& data, void* parm);
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                    ConcurrentTable     (long max_entries=DEFAULT_TABLE_SIZE, hash_func_t _hash=identity,
+                                         evict_func_t _evict=NULL, void* _parm=NULL, int num_stripes=DEFAULT_NUM_STRIPES);
+                    ~ConcurrentTable    (void);
+
+        bool        add                 (K key, const T& data, bool overwrite=false);
+        bool        find                (K key, T* data, bool touch=true);
+        bool        remove              (K key);
+        long        evict               (long num_entries);
+        long        iterate             (iterate_func_t func, void* parm);
+        long        length              (void) const;
+        bool        isfull              (void) const;
+        void        clear               (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        struct node_t {
+            node_t (K _key, const T& _data, uint64_t _used): key(_key), data(_data), used(_used), next(NULL), retired(NULL) {}
+            const K                 key;
+            const T                 data;
+            std::atomic<uint64_t>   used;       // clock value when last added or found
+            std::atomic<node_t*>    next;       // next entry in bucket chain
+            node_t*                 retired;    // next node waiting to be freed
+        };
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        hash_func_t             hash;
+        evict_func_t            evictFunc;
+        void*                   evictParm;
+        long                    maxEntries;
+        long                    numBuckets;
+        std::atomic<node_t*>*   buckets;
+        int                     numStripes;
+        Mutex*                  stripes;
+        std::atomic<long>       numEntries;
+        std::atomic<uint64_t>   clock;          // advanced by every add
+        std::atomic<uint64_t>   hand;           // next bucket sampled for eviction
+        std::atomic<uint64_t>   epoch;
+        std::atomic<long>       readers[2];     // readers active in even and odd epochs
+        Mutex                   retireMut;
+        node_t*                 retiredList;
+        long                    numRetired;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static K        identity        (K key);
+        uint64_t        enter           (void);
+        void            leave           (uint64_t e);
+        void            retire          (node_t* node);
+        void            reclaim         (bool force);
+        void            freeNode        (node_t* node);
+};
+
+/******************************************************************************
+ CONCURRENT TABLE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+ConcurrentTable<T,K>::ConcurrentTable(long max_entries, hash_func_t _hash, evict_func_t _evict, void* _parm, int num_stripes):
+    numEntries(0),
+    clock(0),
+    hand(0),
+    epoch(0)
+{
+    assert(max_entries > 0);
+    assert(num_stripes > 0);
+
+    hash        = _hash;
+    evictFunc   = _evict;
+    evictParm   = _parm;
+    maxEntries  = max_entries;
+    readers[0]  = 0;
+    readers[1]  = 0;
+    retiredList = NULL;
+    numRetired  = 0;
+
+    /* Allocate Buckets (load factor of one when full) */
+    numBuckets = max_entries;
+    buckets = new std::atomic<node_t*> [numBuckets];
+    for(long b = 0; b < numBuckets; b++)
+    {
+        buckets[b].store(NULL, std::memory_order_relaxed);
+    }
+
+    /* Allocate Stripes */
+    numStripes = num_stripes;
+    stripes = new Mutex [numStripes];
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *
+ *  no other thread may be using the table
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+ConcurrentTable<T,K>::~ConcurrentTable(void)
+{
+    clear();
+    delete [] buckets;
+    delete [] stripes;
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *
+ *  returns false if the key is already present and overwrite is not set;
+ *  adding past the maximum number of entries evicts the least recently used
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool ConcurrentTable<T,K>::add(K key, const T& data, bool overwrite)
+{
+    long b = hash(key) % numBuckets;
+    node_t* node = new node_t(key, data, clock.fetch_add(1, std::memory_order_relaxed) + 1);
+    node_t* replaced = NULL;
+    bool added = false;
+
+    Mutex& stripe = stripes[b % numStripes];
+    stripe.lock();
+    {
+        std::atomic<node_t*>* link = &buckets[b];
+        node_t* curr = link->load(std::memory_order_relaxed);
+        while(curr != NULL && curr->key != key)
+        {
+            link = &curr->next;
+            curr = link->load(std::memory_order_relaxed);
+        }
+
+        if(curr == NULL)
+        {
+            /* Append to Chain */
+            link->store(node, std::memory_order_release);
+            added = true;
+        }
+        else if(overwrite)
+        {
+            /* Replace Node in Chain */
+            node->next.store(curr->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            link->store(node, std::memory_order_release);
+            replaced = curr;
+            added = true;
+        }
+    }
+    stripe.unlock();
+
+    if(!added)
+    {
+        delete node; // never published
+    }
+    else if(replaced)
+    {
+        retire(replaced);
+    }
+    else if(numEntries.fetch_add(1) >= maxEntries)
+    {
+        evict(1);
+    }
+
+    return added;
+}
+
+/*----------------------------------------------------------------------------
+ * find
+ *
+ *  copies the entry into data when provided; touching the entry marks it
+ *  as recently used so that it is among the last to be evicted
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool ConcurrentTable<T,K>::find(K key, T* data, bool touch)
+{
+    long b = hash(key) % numBuckets;
+    bool found = false;
+
+    uint64_t e = enter();
+    {
+        node_t* node = buckets[b].load(std::memory_order_acquire);
+        while(node != NULL && node->key != key)
+        {
+            node = node->next.load(std::memory_order_acquire);
+        }
+
+        if(node != NULL)
+        {
+            if(touch)
+            {
+                /* Only Write When Stale to Keep Hot Entries Shared in Cache */
+                uint64_t now = clock.load(std::memory_order_relaxed);
+                if(node->used.load(std::memory_order_relaxed) != now)
+                {
+                    node->used.store(now, std::memory_order_relaxed);
+                }
+            }
+            if(data) *data = node->data;
+            found = true;
+        }
+    }
+    leave(e);
+
+    return found;
+}
+
+/*----------------------------------------------------------------------------
+ * remove
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool ConcurrentTable<T,K>::remove(K key)
+{
+    long b = hash(key) % numBuckets;
+    node_t* removed = NULL;
+
+    Mutex& stripe = stripes[b % numStripes];
+    stripe.lock();
+    {
+        std::atomic<node_t*>* link = &buckets[b];
+        node_t* curr = link->load(std::memory_order_relaxed);
+        while(curr != NULL && curr->key != key)
+        {
+            link = &curr->next;
+            curr = link->load(std::memory_order_relaxed);
+        }
+
+        if(curr != NULL)
+        {
+            /* Unlink Node; Readers on It Still See the Rest of the Chain */
+            link->store(curr->next.load(std::memory_order_relaxed), std::memory_order_release);
+            removed = curr;
+        }
+    }
+    stripe.unlock();
+
+    if(!removed) return false;
+
+    numEntries--;
+    retire(removed);
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * evict
+ *
+ *  removes up to num_entries entries, each the least recently used of a
+ *  sample taken from successive buckets; returns the number removed
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+long ConcurrentTable<T,K>::evict(long num_entries)
+{
+    long evicted = 0;
+    while(evicted < num_entries && numEntries.load() > 0)
+    {
+        K victim = (K)0;
+        bool have_victim = false;
+        uint64_t oldest = 0;
+        int samples = 0;
+
+        uint64_t e = enter();
+        for(long scanned = 0; scanned < numBuckets && samples < EVICTION_SAMPLES; scanned++)
+        {
+            long b = hand.fetch_add(1, std::memory_order_relaxed) % numBuckets;
+            node_t* node = buckets[b].load(std::memory_order_acquire);
+            while(node != NULL)
+            {
+                uint64_t used = node->used.load(std::memory_order_relaxed);
+                if(!have_victim || used < oldest)
+                {
+                    victim = node->key;
+                    oldest = used;
+                    have_victim = true;
+                }
+                samples++;
+                node = node->next.load(std::memory_order_acquire);
+            }
+        }
+        leave(e);
+
+        if(!have_victim) break;
+        if(remove(victim)) evicted++;
+    }
+
+    return evicted;
+}
+
+/*----------------------------------------------------------------------------
+ * iterate
+ *
+ *  calls func on each entry until it returns false; entries added or
+ *  removed during the walk may or may not be seen; returns entries visited
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+long ConcurrentTable<T,K>::iterate(iterate_func_t func, void* parm)
+{
+    long count = 0;
+    bool more = true;
+
+    uint64_t e = enter();
+    for(long b = 0; b < numBuckets && more; b++)
+    {
+        node_t* node = buckets[b].load(std::memory_order_acquire);
+        while(node != NULL && more)
+        {
+            more = func(node->key, node->data, parm);
+            count++;
+            node = node->next.load(std::memory_order_acquire);
+        }
+    }
+    leave(e);
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * length
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+long ConcurrentTable<T,K>::length(void) const
+{
+    return numEntries.load();
+}
+
+/*----------------------------------------------------------------------------
+ * isfull
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool ConcurrentTable<T,K>::isfull(void) const
+{
+    return numEntries.load() >= maxEntries;
+}
+
+/*----------------------------------------------------------------------------
+ * clear
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void ConcurrentTable<T,K>::clear(void)
+{
+    for(long b = 0; b < numBuckets; b++)
+    {
+        node_t* chain = NULL;
+        Mutex& stripe = stripes[b % numStripes];
+        stripe.lock();
+        {
+            chain = buckets[b].exchange(NULL);
+        }
+        stripe.unlock();
+
+        while(chain != NULL)
+        {
+            node_t* next = chain->next.load(std::memory_order_relaxed);
+            numEntries--;
+            retire(chain);
+            chain = next;
+        }
+    }
+
+    reclaim(true);
+}
+
+/*----------------------------------------------------------------------------
+ * identity
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+K ConcurrentTable<T,K>::identity(K key)
+{
+    return key;
+}
+
+/*----------------------------------------------------------------------------
+ * enter
+ *
+ *  registers a reader in the current epoch; the epoch is checked again after
+ *  registering so that a reader never holds a node from an epoch that a
+ *  writer has already started waiting out
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+uint64_t ConcurrentTable<T,K>::enter(void)
+{
+    while(true)
+    {
+        uint64_t e = epoch.load();
+        readers[e & 1]++;
+        if(epoch.load() == e) return e;
+        readers[e & 1]--;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * leave
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void ConcurrentTable<T,K>::leave(uint64_t e)
+{
+    readers[e & 1]--;
+}
+
+/*----------------------------------------------------------------------------
+ * retire
+ *
+ *  node must already be unlinked from its chain
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void ConcurrentTable<T,K>::retire(node_t* node)
+{
+    bool full = false;
+    retireMut.lock();
+    {
+        node->retired = retiredList;
+        retiredList = node;
+        full = ++numRetired >= RECLAIM_THRESHOLD;
+    }
+    retireMut.unlock();
+
+    if(full) reclaim(false);
+}
+
+/*----------------------------------------------------------------------------
+ * reclaim
+ *
+ *  advances the epoch and waits for the readers of the previous epoch to
+ *  leave, after which no reader can reach a node retired before the advance
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void ConcurrentTable<T,K>::reclaim(bool force)
+{
+    node_t* list = NULL;
+    retireMut.lock();
+    {
+        if(force || numRetired >= RECLAIM_THRESHOLD)
+        {
+            list = retiredList;
+            retiredList = NULL;
+            numRetired = 0;
+
+            if(list != NULL)
+            {
+                uint64_t e = epoch++;
+                while(readers[e & 1].load() > 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+    retireMut.unlock();
+
+    while(list != NULL)
+    {
+        node_t* next = list->retired;
+        freeNode(list);
+        list = next;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void ConcurrentTable<T,K>::freeNode(node_t* node)
+{
+    if(evictFunc)
+    {
+        T data = node->data;
+        evictFunc(node->key, data, evictParm);
+    }
+    delete node;
+}
+
+#endif  /* __concurrent_table__ */
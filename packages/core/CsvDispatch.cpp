@@ -52,7 +52,11 @@ const struct luaL_Reg CsvDispatch::LuaMetaTable[] = {
 /*----------------------------------------------------------------------------
  * luaCreate
  *
- *   <field name table> <outq_name>
+ *   <field name table> <outq_name> [<block size>]
+ *
+ *  each row is posted as it is formatted unless a <block size> is supplied,
+ *  in which case rows are accumulated into blocks of up to <block size> bytes
+ *  which are posted when full and whenever the dispatcher times out or terminates
  *----------------------------------------------------------------------------*/
 int CsvDispatch::luaCreate (lua_State* L)
 {
@@ -62,6 +66,13 @@ int CsvDispatch::luaCreate (lua_State* L)
         /* Get Output Queue Name */
         int tblindex = 1;
         const char* outq_name = getLuaString(L, 2);
+        long block_size = getLuaInteger(L, 3, true, DEFAULT_BLOCK_SIZE);
+
+        /* Check Block Size */
+        if(block_size < 0 || block_size > INT_MAX)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid block size: %ld", block_size);
+        }
 
         /* Parse Header Columns */
         const char** _columns = NULL;
@@ -83,7 +94,7 @@ int CsvDispatch::luaCreate (lua_State* L)
         }
 
         /* Create Report Dispatch */
-        return createLuaObject(L, new CsvDispatch(L, outq_name, _columns, _num_columns));
+        return createLuaObject(L, new CsvDispatch(L, outq_name, _columns, _num_columns, block_size));
     }
     catch(const RunTimeException& e)
     {
@@ -101,7 +112,7 @@ int CsvDispatch::luaCreate (lua_State* L)
  *
  *  Note: object takes ownership of columns pointer and must free memory
  *----------------------------------------------------------------------------*/
-CsvDispatch::CsvDispatch (lua_State* L, const char* outq_name, const char** _columns, int _num_columns):
+CsvDispatch::CsvDispatch (lua_State* L, const char* outq_name, const char** _columns, int _num_columns, int block_size):
     DispatchObject(L, LuaMetaName, LuaMetaTable)
 {
     assert(_columns);
@@ -111,6 +122,20 @@ CsvDispatch::CsvDispatch (lua_State* L, const char* outq_name, const char** _col
     columns = _columns;
     num_columns = _num_columns;
 
+    /* Resolve Columns Once Per Record Type */
+    columnFields = new RecordObject::FieldHandle* [num_columns];
+    for(int i = 0; i < num_columns; i++)
+    {
+        columnFields[i] = new RecordObject::FieldHandle(columns[i]);
+    }
+
+    /* Allocate Block (always large enough for a row) */
+    maxRowSize = num_columns * (RecordObject::MAX_VAL_STR_SIZE + 2); // value plus separator
+    postRows = (block_size == 0);
+    blockSize = MAX(block_size, maxRowSize + 1);
+    blockLen = 0;
+    block = new char [blockSize];
+
     /* Build Header Row */
     char hdrrow[MAX_STR_SIZE];
     hdrrow[0] = '\0';
@@ -134,45 +159,139 @@ CsvDispatch::CsvDispatch (lua_State* L, const char* outq_name, const char** _col
  *----------------------------------------------------------------------------*/
 CsvDispatch::~CsvDispatch (void)
 {
+    postBlock();
     delete outQ;
+    delete [] block;
 
     for(int i = 0; i < num_columns; i++)
     {
         delete [] columns[i];
+        delete columnFields[i];
     }
     delete [] columns;
+    delete [] columnFields;
 }
 
 /*----------------------------------------------------------------------------
  * processRecord
+ *
+ *  formats integers and reals directly into the block; text and pointer
+ *  fields still go through getValueText
  *----------------------------------------------------------------------------*/
 bool CsvDispatch::processRecord (RecordObject* record, okey_t key)
 {
     (void)key;
 
-    char valrow[MAX_STR_SIZE];
+    bool status = true;
 
-    /* Build Row */
-    valrow[0] = '\0';
-    for(int i = 0; i < num_columns; i++)
+    blockMut.lock();
     {
-        const char* fmtstr = "%s, ";
-        if(i == (num_columns - 1)) fmtstr = "%s\n";
+        /* Post Block if Row Might Not Fit */
+        if(blockLen + maxRowSize >= blockSize)
+        {
+            status = postBlock();
+        }
+
+        /* Build Row */
+        int row_start = blockLen;
+        try
+        {
+            for(int i = 0; i < num_columns; i++)
+            {
+                RecordObject::field_t field = columnFields[i]->resolve(record);
+                char* valstr = &block[blockLen];
+                int len = 0;
 
-        char valstr[RecordObject::MAX_VAL_STR_SIZE];
-        RecordObject::field_t field = record->getField(columns[i]);
+                if(field.flags & RecordObject::POINTER)
+                {
+                    if(!record->getValueText(field, valstr)) continue; // column skipped
+                    len = StringLib::size(valstr, RecordObject::MAX_VAL_STR_SIZE);
+                }
+                else
+                {
+                    switch(RecordObject::getValueType(field))
+                    {
+                        case RecordObject::INTEGER: len = StringLib::long2str(valstr, RecordObject::MAX_VAL_STR_SIZE, record->getValueInteger(field));                  break;
+                        case RecordObject::REAL:    len = StringLib::double2str(valstr, RecordObject::MAX_VAL_STR_SIZE, record->getValueReal(field), DOUBLE_PRECISION); break;
+                        case RecordObject::TEXT:    if(!record->getValueText(field, valstr)) continue;
+                                                    len = StringLib::size(valstr, RecordObject::MAX_VAL_STR_SIZE);                                                  break;
+                        default:                    continue; // column skipped
+                    }
+                }
+
+                /* Add Separator */
+                blockLen += len;
+                if(i == (num_columns - 1))
+                {
+                    block[blockLen++] = '\n';
+                }
+                else
+                {
+                    block[blockLen++] = ',';
+                    block[blockLen++] = ' ';
+                }
+            }
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failed to format row of %s: %s", record->getRecordType(), e.what());
+            blockLen = row_start;
+            status = false;
+        }
 
-        if(record->getValueText(field, valstr))
+        /* Post Row if Not Blocking */
+        if(postRows && status)
         {
-            char colstr[RecordObject::MAX_VAL_STR_SIZE];
-            StringLib::format(colstr, RecordObject::MAX_VAL_STR_SIZE, fmtstr, valstr);
-            StringLib::concat(valrow, colstr, MAX_STR_SIZE);
+            status = postBlock();
         }
     }
+    blockMut.unlock();
+
+    /* Return Status */
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * processTimeout
+ *----------------------------------------------------------------------------*/
+bool CsvDispatch::processTimeout (void)
+{
+    blockMut.lock();
+    {
+        postBlock();
+    }
+    blockMut.unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processTermination
+ *----------------------------------------------------------------------------*/
+bool CsvDispatch::processTermination (void)
+{
+    blockMut.lock();
+    {
+        postBlock();
+    }
+    blockMut.unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * postBlock
+ *
+ *  Notes: must be called inside blockMut lock, except from the destructor
+ *----------------------------------------------------------------------------*/
+bool CsvDispatch::postBlock (void)
+{
+    if(blockLen == 0) return true;
 
-    /* Send Out Row */
-    int len = StringLib::size(valrow, MAX_STR_SIZE) + 1;
-    int status = outQ->postCopy(valrow, len, SYS_TIMEOUT);
+    /* Send Out Rows */
+    block[blockLen] = '\0';
+    int status = outQ->postCopy(block, blockLen + 1, SYS_TIMEOUT);
+    blockLen = 0;
 
     /* Check and Return Status */
     return status > 0;
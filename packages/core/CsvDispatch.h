@@ -39,6 +39,7 @@
 #include "DispatchObject.h"
 #include "RecordObject.h"
 #include "MsgQ.h"
+#include "OsApi.h"
 
 /******************************************************************************
  * REPORT DISPATCH
@@ -55,6 +56,9 @@ class CsvDispatch: public DispatchObject
         static const char* LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
 
+        static const int DEFAULT_BLOCK_SIZE = 0; // each row is posted on its own
+        static const int DOUBLE_PRECISION = 6; // matches RecordObject::DEFAULT_DOUBLE_FORMAT
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -70,15 +74,26 @@ class CsvDispatch: public DispatchObject
         Publisher*      outQ;
         const char**    columns;
         int             num_columns;
+        RecordObject::FieldHandle** columnFields;
+        Mutex           blockMut;
+        char*           block;          // rows are formatted here and posted together
+        int             blockSize;
+        int             blockLen;
+        int             maxRowSize;
+        bool            postRows;       // no block size supplied
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                        CsvDispatch     (lua_State* L, const char* outq_name, const char** _columns, int _num_columns);
-        virtual         ~CsvDispatch    (void);
+                        CsvDispatch         (lua_State* L, const char* outq_name, const char** _columns, int _num_columns, int block_size=DEFAULT_BLOCK_SIZE);
+        virtual         ~CsvDispatch        (void);
+
+        bool            processRecord       (RecordObject* record, okey_t key) override;
+        bool            processTimeout      (void) override;
+        bool            processTermination  (void) override;
 
-        bool            processRecord   (RecordObject* record, okey_t key) override;
+        bool            postBlock           (void);
 };
 
 #endif  /* __csv_dispatch__ */
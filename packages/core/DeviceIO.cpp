@@ -76,6 +76,7 @@ DeviceIO::DeviceIO(lua_State* L, DeviceObject* _device):
     device              = _device;
     dieOnDisconnect     = true;
     blockCfg            = SYS_TIMEOUT;
+    batchSize           = 1;
 
     /* Initialize Counters */
     bytesProcessed      = 0;
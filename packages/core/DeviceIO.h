@@ -57,6 +57,7 @@ class DeviceIO: public LuaObject
         static const char* OBJECT_TYPE;
         static const char* LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
+        static const int MAX_BATCH_SIZE = 256; // messages moved between device and queue at once
 
     protected:
 
@@ -69,6 +70,7 @@ class DeviceIO: public LuaObject
         DeviceObject*   device;
         bool            dieOnDisconnect;
         int             blockCfg;
+        int             batchSize;
         int             bytesProcessed;
         int             bytesDropped;
         int             packetsProcessed;
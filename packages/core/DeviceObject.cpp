@@ -122,6 +122,53 @@ char* DeviceObject::getDeviceList(void)
     return liststr;
 }
 
+/*----------------------------------------------------------------------------
+ * readRef
+ *
+ *  Notes: devices that can hand out their data in place return a pointer
+ *  to up to len bytes that stays valid until the next read; all others
+ *  must be read through readBuffer
+ *----------------------------------------------------------------------------*/
+int DeviceObject::readRef (const void** buf, int len, int timeout)
+{
+    (void)buf;
+    (void)len;
+    (void)timeout;
+    return PARM_ERR_RC;
+}
+
+/*----------------------------------------------------------------------------
+ * readBatch
+ *
+ *  Notes: devices that deliver discrete messages (e.g. datagrams) can read
+ *  up to n of them in one call; lens[i] is the size of bufs[i] on entry and
+ *  the length of the message read into it on return, and the number of
+ *  messages read is returned
+ *----------------------------------------------------------------------------*/
+int DeviceObject::readBatch (void** bufs, int* lens, int n, int timeout)
+{
+    (void)bufs;
+    (void)lens;
+    (void)n;
+    (void)timeout;
+    return PARM_ERR_RC;
+}
+
+/*----------------------------------------------------------------------------
+ * writeBatch
+ *
+ *  Notes: counterpart of readBatch; returns the number of messages written,
+ *  which may be fewer than n
+ *----------------------------------------------------------------------------*/
+int DeviceObject::writeBatch (const void** bufs, const int* lens, int n, int timeout)
+{
+    (void)bufs;
+    (void)lens;
+    (void)n;
+    (void)timeout;
+    return PARM_ERR_RC;
+}
+
 /*----------------------------------------------------------------------------
  * luaList - list()
  *----------------------------------------------------------------------------*/
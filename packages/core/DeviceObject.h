@@ -85,6 +85,9 @@ class DeviceObject: public LuaObject
         virtual int         readBuffer          (void* buf, int len, int timeout=SYS_TIMEOUT) = 0;
         virtual int         getUniqueId         (void) = 0;
         virtual const char* getConfig           (void) = 0;
+        virtual int         readRef             (const void** buf, int len, int timeout=SYS_TIMEOUT); // PARM_ERR_RC if not supported
+        virtual int         readBatch           (void** bufs, int* lens, int n, int timeout=SYS_TIMEOUT); // PARM_ERR_RC if not supported
+        virtual int         writeBatch          (const void** bufs, const int* lens, int n, int timeout=SYS_TIMEOUT); // PARM_ERR_RC if not supported
 
     private:
 
@@ -43,7 +43,7 @@
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - reader(<device>, <output stream name>)
+ * luaCreate - reader(<device>, <output stream name>, [<batch size>])
  *----------------------------------------------------------------------------*/
 int DeviceReader::luaCreate (lua_State* L)
 {
@@ -53,9 +53,16 @@ int DeviceReader::luaCreate (lua_State* L)
         /* Get Parameters */
         _device = (DeviceObject*)getLuaObject(L, 1, DeviceObject::OBJECT_TYPE);
         const char* q_name  = getLuaString(L, 2, true, NULL);
+        long        batch   = getLuaInteger(L, 3, true, 1);
+
+        /* Check Batch Size */
+        if(batch < 1 || batch > MAX_BATCH_SIZE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid batch size: %ld", batch);
+        }
 
         /* Return DeviceReader Object */
-        return createLuaObject(L, new DeviceReader(L, _device, q_name));
+        return createLuaObject(L, new DeviceReader(L, _device, q_name, (int)batch));
     }
     catch(const RunTimeException& e)
     {
@@ -72,9 +79,10 @@ int DeviceReader::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-DeviceReader::DeviceReader(lua_State* L, DeviceObject* _device, const char* outq_name):
+DeviceReader::DeviceReader(lua_State* L, DeviceObject* _device, const char* outq_name, int batch_size):
     DeviceIO(L, _device)
 {
+    batchSize = batch_size;
     outq = NULL;
     if(outq_name)
     {
@@ -112,34 +120,80 @@ void* DeviceReader::readerThread (void* parm)
     DeviceReader* dr = (DeviceReader*)parm;
     int io_maxsize = LocalLib::getIOMaxsize();
     unsigned char* buf = new unsigned char [io_maxsize];
+    bool by_ref = true; // until device says otherwise
+
+    /* Batch Buffers - devices that deliver datagrams read a batch per call */
+    int batch_size = dr->batchSize;
+    bool batched = batch_size > 1;
+    unsigned char* batch_buf = NULL;
+    void** bufs = NULL;
+    int* lens = NULL;
+    if(batched)
+    {
+        batch_buf = new unsigned char [(long)batch_size * io_maxsize];
+        bufs = new void* [batch_size];
+        lens = new int [batch_size];
+        for(int i = 0; i < batch_size; i++)
+        {
+            bufs[i] = &batch_buf[(long)i * io_maxsize];
+        }
+    }
 
     /* Read Loop */
     while(dr->ioActive)
     {
-        /* Read Device */
-        int bytes = dr->device->readBuffer(buf, io_maxsize);
-        if(bytes > 0)
+        int bytes = PARM_ERR_RC;
+
+        if(batched)
         {
-            /* Post Message */
-            int post_status = MsgQ::STATE_ERROR;
-            while(dr->ioActive && (post_status = dr->outq->postCopy(buf, bytes, dr->blockCfg)) <= 0)
+            /* Read Batch of Messages */
+            for(int i = 0; i < batch_size; i++) lens[i] = io_maxsize;
+            bytes = dr->device->readBatch(bufs, lens, batch_size);
+            if(bytes > 0)
             {
-                mlog(ERROR, "Device reader unable to post to stream %s: %d", dr->outq->getName(), post_status);
+                dr->postBatch(bufs, lens, bytes);
             }
-
-            /* Update Statistics */
-            if(post_status > 0)
+            else if(bytes == PARM_ERR_RC)
             {
-                dr->bytesProcessed += bytes;
-                dr->packetsProcessed += 1;
+                batched = false; // device reads one message at a time
+                continue;
             }
-            else
+        }
+        else
+        {
+            /* Read Device - in place if supported, saving a copy */
+            const void* data = buf;
+            if(by_ref) bytes = dr->device->readRef(&data, io_maxsize);
+            if(bytes == PARM_ERR_RC)
+            {
+                by_ref = false;
+                data = buf;
+                bytes = dr->device->readBuffer(buf, io_maxsize);
+            }
+            if(bytes > 0)
             {
-                dr->bytesDropped += bytes;
-                dr->packetsDropped += 1;
+                /* Post Message */
+                int post_status = MsgQ::STATE_ERROR;
+                while(dr->ioActive && (post_status = dr->outq->postCopy(data, bytes, dr->blockCfg)) <= 0)
+                {
+                    mlog(ERROR, "Device reader unable to post to stream %s: %d", dr->outq->getName(), post_status);
+                }
+
+                /* Update Statistics */
+                if(post_status > 0)
+                {
+                    dr->bytesProcessed += bytes;
+                    dr->packetsProcessed += 1;
+                }
+                else
+                {
+                    dr->bytesDropped += bytes;
+                    dr->packetsDropped += 1;
+                }
             }
         }
-        else if(bytes != TIMEOUT_RC)
+
+        if(bytes <= 0 && bytes != TIMEOUT_RC)
         {
             /* Handle Non-Timeout Errors */
             if(dr->dieOnDisconnect)
@@ -159,8 +213,62 @@ void* DeviceReader::readerThread (void* parm)
 
     /* Clean Up */
     delete [] buf;
+    delete [] batch_buf;
+    delete [] bufs;
+    delete [] lens;
     dr->device->closeConnection();
     dr->signalComplete();
     dr->outq->postCopy("", 0); // send terminator
     return NULL;
 }
+
+/*----------------------------------------------------------------------------
+ * postBatch
+ *
+ *  posts a batch of messages read from the device with as few queue
+ *  operations as possible; empty messages are dropped since an empty post
+ *  terminates the stream
+ *----------------------------------------------------------------------------*/
+void DeviceReader::postBatch (void** bufs, int* lens, int n)
+{
+    /* Remove Empty Messages */
+    int num_msgs = 0;
+    for(int i = 0; i < n; i++)
+    {
+        if(lens[i] > 0)
+        {
+            void* tmp = bufs[num_msgs];
+            bufs[num_msgs] = bufs[i];
+            bufs[i] = tmp;
+            lens[num_msgs] = lens[i];
+            num_msgs++;
+        }
+    }
+
+    /* Post Messages */
+    int posted = 0;
+    while(ioActive && posted < num_msgs)
+    {
+        int post_status = outq->postCopyBatch((const void**)&bufs[posted], &lens[posted], num_msgs - posted, blockCfg);
+        if(post_status > 0)
+        {
+            for(int i = posted; i < posted + post_status; i++)
+            {
+                bytesProcessed += lens[i];
+            }
+            packetsProcessed += post_status;
+            posted += post_status;
+        }
+        else
+        {
+            mlog(ERROR, "Device reader unable to post to stream %s: %d", outq->getName(), post_status);
+        }
+    }
+
+    /* Count Dropped Messages */
+    for(int i = posted; i < num_msgs; i++)
+    {
+        bytesDropped += lens[i];
+        packetsDropped += 1;
+    }
+}
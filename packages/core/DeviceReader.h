@@ -66,10 +66,11 @@ class DeviceReader: public DeviceIO
          * Methods
          *--------------------------------------------------------------------*/
 
-                        DeviceReader        (lua_State* L, DeviceObject* _device, const char* outq_name);
+                        DeviceReader        (lua_State* L, DeviceObject* _device, const char* outq_name, int batch_size);
                         ~DeviceReader       (void);
 
         static void*    readerThread        (void* parm);
+        void            postBatch           (void** bufs, int* lens, int n);
 };
 
 #endif  /* __device_reader__ */
@@ -43,7 +43,7 @@
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - writer(<device>, <output stream name>)
+ * luaCreate - writer(<device>, <input stream name>, [<batch size>])
  *----------------------------------------------------------------------------*/
 int DeviceWriter::luaCreate (lua_State* L)
 {
@@ -53,9 +53,16 @@ int DeviceWriter::luaCreate (lua_State* L)
         /* Get Parameters */
         _device = (DeviceObject*)getLuaObject(L, 1, DeviceObject::OBJECT_TYPE);
         const char* q_name  = getLuaString(L, 2, true, NULL);
+        long        batch   = getLuaInteger(L, 3, true, 1);
+
+        /* Check Batch Size */
+        if(batch < 1 || batch > MAX_BATCH_SIZE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid batch size: %ld", batch);
+        }
 
         /* Return DeviceReader Object */
-        return createLuaObject(L, new DeviceWriter(L, _device, q_name));
+        return createLuaObject(L, new DeviceWriter(L, _device, q_name, (int)batch));
     }
     catch(const RunTimeException& e)
     {
@@ -72,9 +79,10 @@ int DeviceWriter::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-DeviceWriter::DeviceWriter(lua_State* L, DeviceObject* _device, const char* inq_name):
+DeviceWriter::DeviceWriter(lua_State* L, DeviceObject* _device, const char* inq_name, int batch_size):
     DeviceIO(L, _device)
 {
+    batchSize = batch_size;
     inq = NULL;
     if(inq_name)
     {
@@ -111,58 +119,76 @@ void* DeviceWriter::writerThread (void* parm)
     assert(parm != NULL);
     DeviceWriter* dw = (DeviceWriter*)parm;
 
+    /* Batch Buffers - devices that send datagrams write a batch per call */
+    int batch_size = dw->batchSize;
+    bool batched = batch_size > 1;
+    Subscriber::msgRef_t* refs = new Subscriber::msgRef_t [batch_size];
+    const void** bufs = new const void* [batch_size];
+    int* lens = new int [batch_size];
+
     /* Read Loop */
     while(dw->ioActive)
     {
-        /* Read Bytes */
-        Subscriber::msgRef_t ref;
-        int status = dw->inq->receiveRef(ref, dw->blockCfg);
+        /* Read Messages */
+        int status;
+        if(batch_size > 1)  status = dw->inq->receiveBatch(refs, batch_size, dw->blockCfg);
+        else                status = dw->inq->receiveRef(refs[0], dw->blockCfg);
 
-        /* Process Bytes */
+        /* Process Messages */
         if(status > 0)
         {
-            if(ref.size > 0)
+            int num_refs = (batch_size > 1) ? status : 1;
+
+            /* Stop at Terminator */
+            int num_msgs = 0;
+            while(num_msgs < num_refs && refs[num_msgs].size > 0) num_msgs++;
+
+            /* Send Messages */
+            int sent = 0;
+            while(sent < num_msgs && dw->ioActive)
             {
-                /* Send Message */
-                int bytes_sent = 0;
-                while(bytes_sent <= 0 && dw->ioActive)
+                if(batched)
                 {
-                    bytes_sent = dw->device->writeBuffer(ref.data, ref.size);
-                    if(bytes_sent > 0)
+                    int num_batch = num_msgs - sent;
+                    for(int i = 0; i < num_batch; i++)
+                    {
+                        bufs[i] = refs[sent + i].data;
+                        lens[i] = refs[sent + i].size;
+                    }
+
+                    int c = dw->device->writeBatch(bufs, lens, num_batch);
+                    if(c > 0)
+                    {
+                        for(int i = 0; i < c; i++) dw->bytesProcessed += lens[i];
+                        dw->packetsProcessed += c;
+                        sent += c;
+                        continue;
+                    }
+                    else if(c == TIMEOUT_RC)
                     {
-                        dw->bytesProcessed += bytes_sent;
-                        dw->packetsProcessed += 1;
+                        continue;
                     }
-                    else if(bytes_sent != TIMEOUT_RC)
+                    else if(c == PARM_ERR_RC)
                     {
-                        dw->bytesDropped += ref.size;
-                        dw->packetsDropped += 1;
-                        mlog(ERROR, "Failed (%d) to write to device with error: %s", bytes_sent, LocalLib::err2str(errno));
-
-                        /* Handle Non-Timeout Errors */
-                        if(dw->dieOnDisconnect)
-                        {
-                            mlog(INFO, "... closing connection and exiting writer!");
-                            dw->ioActive = false; // breaks out of loop
-                        }
-                        else
-                        {
-                            mlog(ERROR, "failed to write to device with error... sleeping and going on to next message!");
-                            LocalLib::sleep(1); // prevent spin
-                            break; // stop trying to send this message and go to the next one
-                        }
+                        batched = false; // device writes one message at a time
+                        continue;
                     }
+                    // other errors are handled by sending the message on its own
                 }
+
+                dw->sendMessage(refs[sent].data, refs[sent].size);
+                sent++;
             }
-            else
+
+            /* Received Terminating Message */
+            if(num_msgs < num_refs)
             {
-                /* Received Terminating Message */
                 mlog(DEBUG, "Terminator received on %s, exiting device writer", dw->inq->getName());
                 dw->ioActive = false; // breaks out of loop
             }
 
-            /* Dereference Message */
-            dw->inq->dereference(ref);
+            /* Dereference Messages */
+            dw->inq->dereferenceBatch(refs, num_refs);
         }
         else if(status != MsgQ::STATE_TIMEOUT)
         {
@@ -177,7 +203,46 @@ void* DeviceWriter::writerThread (void* parm)
     }
 
     /* Clean Up */
+    delete [] refs;
+    delete [] bufs;
+    delete [] lens;
     dw->device->closeConnection();
     dw->signalComplete();
     return NULL;
 }
+
+/*----------------------------------------------------------------------------
+ * sendMessage
+ *----------------------------------------------------------------------------*/
+void DeviceWriter::sendMessage (const void* data, int size)
+{
+    int bytes_sent = 0;
+    while(bytes_sent <= 0 && ioActive)
+    {
+        bytes_sent = device->writeBuffer(data, size);
+        if(bytes_sent > 0)
+        {
+            bytesProcessed += bytes_sent;
+            packetsProcessed += 1;
+        }
+        else if(bytes_sent != TIMEOUT_RC)
+        {
+            bytesDropped += size;
+            packetsDropped += 1;
+            mlog(ERROR, "Failed (%d) to write to device with error: %s", bytes_sent, LocalLib::err2str(errno));
+
+            /* Handle Non-Timeout Errors */
+            if(dieOnDisconnect)
+            {
+                mlog(INFO, "... closing connection and exiting writer!");
+                ioActive = false; // breaks out of loop
+            }
+            else
+            {
+                mlog(ERROR, "failed to write to device with error... sleeping and going on to next message!");
+                LocalLib::sleep(1); // prevent spin
+                break; // stop trying to send this message and go to the next one
+            }
+        }
+    }
+}
@@ -66,10 +66,11 @@ class DeviceWriter: public DeviceIO
          * Methods
          *--------------------------------------------------------------------*/
 
-                        DeviceWriter        (lua_State* L, DeviceObject* device, const char* inq_name);
+                        DeviceWriter        (lua_State* L, DeviceObject* device, const char* inq_name, int batch_size);
                         ~DeviceWriter       (void);
 
         static void*    writerThread        (void* parm);
+        void            sendMessage         (const void* data, int size);
 };
 
 #endif  /* __device_writer__ */
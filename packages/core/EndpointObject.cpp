@@ -38,6 +38,8 @@
 #include "OsApi.h"
 #include "StringLib.h"
 
+#include <ctype.h>
+
 /******************************************************************************
  * STATIC DATA
  ******************************************************************************/
@@ -51,13 +53,13 @@ const char* EndpointObject::OBJECT_TYPE = "EndpointObject";
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-EndpointObject::Request::Request (const char* _id):
-    headers(EXPECTED_MAX_HEADER_FIELDS)
+EndpointObject::Request::Request (const char* _id)
 {
-    id          = StringLib::duplicate(_id);
+    id          = arena.duplicate(_id);
     path        = NULL;
     resource    = NULL;
     verb        = UNRECOGNIZED;
+    num_headers = 0;
     body        = NULL;
     length      = 0;
 }
@@ -67,20 +69,27 @@ EndpointObject::Request::Request (const char* _id):
  *----------------------------------------------------------------------------*/
 EndpointObject::Request::~Request (void)
 {
-    /* Clear Out Headers */
-    const char* header;
-    const char* key = headers.first(&header);
-    while(key != NULL)
+    /* Free Allocated Members - strings are freed with arena */
+    if(body) delete [] body;
+}
+
+/*----------------------------------------------------------------------------
+ * getHeader
+ *----------------------------------------------------------------------------*/
+bool EndpointObject::Request::getHeader (const char* name, const char** value) const
+{
+    for(int h = 0; h < num_headers; h++)
     {
-        delete [] header;
-        key = headers.next(&header);
+        const header_t& hdr = headers[h];
+        int i = 0;
+        while(i < hdr.key_len && name[i] != '\0' && tolower(hdr.key[i]) == tolower(name[i])) i++;
+        if(i == hdr.key_len && name[i] == '\0')
+        {
+            *value = hdr.value;
+            return true;
+        }
     }
-
-    /* Free Allocate Members */
-    if(body) delete [] body;
-    if(resource) delete [] resource;
-    if(path) delete [] path;
-    delete [] id;
+    return false;
 }
 
 /******************************************************************************
@@ -165,6 +174,7 @@ const char* EndpointObject::code2str (code_t code)
         case Not_Found:                 return "Not Found";
         case Method_Not_Allowed:        return "Method Not Allowed";
         case Request_Timeout:           return "Request Timeout";
+        case Too_Many_Requests:         return "Too Many Requests";
         case Method_Not_Implemented:    return "Method Not Implemented";
         default:                        break;
     }
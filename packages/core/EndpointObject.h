@@ -54,7 +54,7 @@ class EndpointObject: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int MAX_HDR_SIZE = MAX_STR_SIZE;
-        static const int EXPECTED_MAX_HEADER_FIELDS = 32;
+        static const int MAX_HEADER_FIELDS = 64;
         static const char* OBJECT_TYPE;
 
         /*--------------------------------------------------------------------
@@ -81,6 +81,7 @@ class EndpointObject: public LuaObject
             Not_Found = 404,
             Method_Not_Allowed = 405,
             Request_Timeout = 408,
+            Too_Many_Requests = 429,
             Internal_Server_Error = 500,
             Method_Not_Implemented = 501,
             Service_Unavailable = 503
@@ -100,16 +101,30 @@ class EndpointObject: public LuaObject
         {
             public:
 
+                /* Header Field
+                 *  key and value point into the copy of the header held in
+                 *  the arena; the key is not terminated, the value is */
+                typedef struct {
+                    const char*             key;
+                    int                     key_len;
+                    const char*             value;
+                    int                     value_len;
+                } header_t;
+
                 const char*                 path;
                 const char*                 resource;
                 verb_t                      verb;
-                Dictionary<const char*>     headers;
+                header_t                    headers[MAX_HEADER_FIELDS];
+                int                         num_headers;
                 uint8_t*                    body;
                 long                        length; // of body
                 const char*                 id; // must be unique
+                StringLib::Arena            arena; // id, path, resource, and header strings; freed with request
 
                 Request (const char* _id);
                 ~Request (void);
+
+                bool getHeader (const char* name, const char** value) const; // name is case insensitive
         };
 
         /*--------------------------------------------------------------------
@@ -38,6 +38,7 @@
 #include "TimeLib.h"
 #include "MsgQ.h"
 #include "RecordObject.h"
+#include "RecordPool.h"
 #include "Dictionary.h"
 #include "List.h"
 
@@ -84,7 +85,32 @@ event_level_t EventLib::metric_level;
 
 Mutex EventLib::metric_mut;
 Dictionary<Dictionary<int32_t>*> EventLib::metric_categories(MAX_METRICS, 1.0);
-List<EventLib::metric_t> EventLib::metric_vals;
+std::atomic<EventLib::metric_cell_t*> EventLib::metric_cells[MAX_METRIC_IDS];
+std::atomic<int32_t> EventLib::metric_count{0};
+std::atomic<int> EventLib::metric_shard_next{0};
+thread_local int EventLib::metric_shard = -1;
+bool EventLib::metric_flushing = false;
+Cond EventLib::metric_signal;
+Thread* EventLib::metric_flusher = NULL;
+
+EventLib::log_slot_t* EventLib::log_ring = NULL;
+std::atomic<uint64_t> EventLib::log_enqueue{0};
+std::atomic<uint64_t> EventLib::log_dequeue{0};
+std::atomic<uint32_t> EventLib::log_sample_count{0};
+std::atomic<bool> EventLib::log_sleeping{false};
+bool EventLib::log_draining = false;
+Cond EventLib::log_signal;
+Thread* EventLib::log_drainer = NULL;
+int32_t EventLib::log_dropped_metric = EventLib::INVALID_METRIC;
+int32_t EventLib::log_sampled_metric = EventLib::INVALID_METRIC;
+int32_t EventLib::trace_dropped_metric = EventLib::INVALID_METRIC;
+std::atomic<uint64_t> EventLib::trace_sample_threshold{EventLib::TRACE_SAMPLE_ALL};
+
+/******************************************************************************
+ * LOCAL DEFINES
+ ******************************************************************************/
+
+#define NO_PENDING_METRIC (-1)
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -109,6 +135,28 @@ void EventLib::init (const char* eventq)
 
     /* Create Output Q */
     outq = new Publisher(eventq);
+
+    /* Start Metric Flusher */
+    metric_flushing = true;
+    metric_flusher = new Thread(metricFlusher, NULL);
+
+    /* Register Log Backpressure Metrics */
+    log_dropped_metric = registerMetric("eventlib", COUNTER, "%s", "log.dropped");
+    log_sampled_metric = registerMetric("eventlib", COUNTER, "%s", "log.sampled");
+    trace_dropped_metric = registerMetric("eventlib", COUNTER, "%s", "trace.dropped");
+
+    /* Create Log Ring */
+    log_ring = new log_slot_t [LOG_RING_SIZE];
+    for(int i = 0; i < LOG_RING_SIZE; i++)
+    {
+        log_ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    log_enqueue = 0;
+    log_dequeue = 0;
+
+    /* Start Log Drainer */
+    log_draining = true;
+    log_drainer = new Thread(logDrainer, NULL);
 }
 
 /*----------------------------------------------------------------------------
@@ -116,6 +164,28 @@ void EventLib::init (const char* eventq)
  *----------------------------------------------------------------------------*/
 void EventLib::deinit (void)
 {
+    /* Stop Metric Flusher */
+    metric_signal.lock();
+    {
+        metric_flushing = false;
+        metric_signal.signal();
+    }
+    metric_signal.unlock();
+    delete metric_flusher;
+    metric_flusher = NULL;
+
+    /* Stop Log Drainer - drains what is left in the ring */
+    log_signal.lock();
+    {
+        log_draining = false;
+        log_signal.signal();
+    }
+    log_signal.unlock();
+    delete log_drainer;
+    log_drainer = NULL;
+    delete [] log_ring;
+    log_ring = NULL;
+
     /* Cleanup Output Q */
     delete outq;
 
@@ -130,11 +200,18 @@ void EventLib::deinit (void)
             category = metric_categories.next(&ids);
         }
 
-        for(int m = 0; m < metric_vals.length(); m++)
+        int32_t num_metrics = metric_count.load();
+        for(int32_t m = 0; m < num_metrics; m++)
         {
-            delete [] metric_vals[m].name;
-            delete [] metric_vals[m].category;
+            metric_cell_t* cell = metric_cells[m].exchange(NULL);
+            if(cell)
+            {
+                delete [] cell->name;
+                delete [] cell->category;
+                delete cell;
+            }
         }
+        metric_count = 0;
     }
     metric_mut.unlock();
 }
@@ -226,46 +303,104 @@ const char* EventLib::subtype2str (subtype_t subtype)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * setTraceSampling
+ *
+ *  rate is the fraction of root traces (those with no parent) that are
+ *  recorded; every span under a root inherits its decision
+ *----------------------------------------------------------------------------*/
+bool EventLib::setTraceSampling (double rate)
+{
+    if(rate < 0.0 || rate > 1.0) return false;
+    trace_sample_threshold = (uint64_t)(rate * 4294967296.0);
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * getTraceSampling
+ *----------------------------------------------------------------------------*/
+double EventLib::getTraceSampling (void)
+{
+    return (double)trace_sample_threshold / 4294967296.0;
+}
+
 /*----------------------------------------------------------------------------
  * startTrace
+ *
+ *  unsampled traces are handed an id with UNSAMPLED_TRACE set so that their
+ *  children and their stop can return without producing an event
  *----------------------------------------------------------------------------*/
 uint32_t EventLib::startTrace(uint32_t parent, const char* name, event_level_t lvl, const char* attr_fmt, ...)
 {
-    event_t event;
-
     /* Return Here If Nothing to Do */
     if(lvl < trace_level) return parent;
+    if(parent & UNSAMPLED_TRACE) return parent;
+
+    /* Allocate Trace ID */
+    uint32_t id = trace_id++ & ~UNSAMPLED_TRACE;
+    if(id == ORIGIN) id = trace_id++ & ~UNSAMPLED_TRACE;
+
+    /* Head Based Sampling of Root Traces */
+    if(parent == ORIGIN && trace_sample_threshold < TRACE_SAMPLE_ALL)
+    {
+        uint32_t hash = id * 2654435761U; // spreads sequential ids across the range
+        if((uint64_t)hash >= trace_sample_threshold) return id | UNSAMPLED_TRACE;
+    }
+
+    /* Reserve Event */
+    event_t local_event;
+    event_t* event = &local_event;
+    uint64_t pos = 0;
+    log_slot_t* slot = NULL;
+    log_slot_t* ring = log_ring;
+    if(ring)
+    {
+        slot = reserveEvent(ring, &pos);
+        if(!slot)
+        {
+            metric_cell_t* cell = getMetric(trace_dropped_metric);
+            if(cell) addMetric(cell, 1.0);
+            return id;
+        }
+        event = &slot->event;
+    }
 
     /* Initialize Trace */
-    event.systime   = TimeLib::gettimems();
-    event.tid       = Thread::getId();
-    event.id        = trace_id++;;
-    event.parent    = parent;
-    event.flags     = START;
-    event.type      = TRACE;
-    event.level     = lvl;
-    event.name[0]   = '\0';
-    event.attr[0]   = '\0';
+    event->systime  = TimeLib::gettimems();
+    event->tid      = Thread::getId();
+    event->id       = id;
+    event->parent   = parent;
+    event->flags    = START;
+    event->type     = TRACE;
+    event->level    = lvl;
 
     /* Copy IP Address */
-    StringLib::copy(event.ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
+    StringLib::copy(event->ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
 
     /* Copy Name */
-    StringLib::copy(event.name, name, MAX_NAME_SIZE);
+    StringLib::copy(event->name, name, MAX_NAME_SIZE);
 
     /* Build Attribute */
     va_list args;
     va_start(args, attr_fmt);
-    int vlen = vsnprintf(event.attr, MAX_ATTR_SIZE - 1, attr_fmt, args);
+    int vlen = vsnprintf(event->attr, MAX_ATTR_SIZE - 1, attr_fmt, args);
     int attr_size = MAX(MIN(vlen + 1, MAX_ATTR_SIZE), 1);
-    event.attr[attr_size - 1] = '\0';
+    event->attr[attr_size - 1] = '\0';
     va_end(args);
 
     /* Send Event */
-    sendEvent(&event, attr_size);
+    if(slot)
+    {
+        slot->attr_size = attr_size;
+        publishEvent(slot, pos);
+    }
+    else
+    {
+        sendEvent(event, attr_size);
+    }
 
     /* Return Trace ID */
-    return event.id;
+    return id;
 }
 
 /*----------------------------------------------------------------------------
@@ -273,28 +408,52 @@ uint32_t EventLib::startTrace(uint32_t parent, const char* name, event_level_t l
  *----------------------------------------------------------------------------*/
 void EventLib::stopTrace(uint32_t id, event_level_t lvl)
 {
-    event_t event;
-
     /* Return Here If Nothing to Do */
     if(lvl < trace_level) return;
+    if(id & UNSAMPLED_TRACE) return;
+
+    /* Reserve Event */
+    event_t local_event;
+    event_t* event = &local_event;
+    uint64_t pos = 0;
+    log_slot_t* slot = NULL;
+    log_slot_t* ring = log_ring;
+    if(ring)
+    {
+        slot = reserveEvent(ring, &pos);
+        if(!slot)
+        {
+            metric_cell_t* cell = getMetric(trace_dropped_metric);
+            if(cell) addMetric(cell, 1.0);
+            return;
+        }
+        event = &slot->event;
+    }
 
     /* Initialize Trace */
-    event.systime   = TimeLib::gettimems();
-    event.tid       = 0;
-    event.id        = id;
-    event.parent    = ORIGIN;
-    event.flags     = STOP;
-    event.type      = TRACE;
-    event.level     = lvl;
-    event.name[0]   = '\0';
-    event.attr[0]   = '\0';
+    event->systime  = TimeLib::gettimems();
+    event->tid      = 0;
+    event->id       = id;
+    event->parent   = ORIGIN;
+    event->flags    = STOP;
+    event->type     = TRACE;
+    event->level    = lvl;
+    event->name[0]  = '\0';
+    event->attr[0]  = '\0';
 
     /* Copy IP Address */
-    StringLib::copy(event.ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
-
+    StringLib::copy(event->ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
 
     /* Send Event */
-    sendEvent(&event, 1);
+    if(slot)
+    {
+        slot->attr_size = 1;
+        publishEvent(slot, pos);
+    }
+    else
+    {
+        sendEvent(event, 1);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -316,41 +475,74 @@ uint32_t EventLib::grabId (void)
 
 /*----------------------------------------------------------------------------
  * logMsg
+ *
+ *  messages are formatted by the caller directly into a slot of the log ring
+ *  and posted to the event queue by the log drainer; when the ring backs up,
+ *  debug and info messages are sampled and then dropped, while errors are
+ *  posted synchronously so they are never lost
  *----------------------------------------------------------------------------*/
 void EventLib::logMsg(const char* file_name, unsigned int line_number, event_level_t lvl, const char* msg_fmt, ...)
 {
-    event_t event;
-
     /* Return Here If Nothing to Do */
     if(lvl < log_level) return;
 
-    /* Initialize Log Message */
-    event.systime   = TimeLib::gettimems();
-    event.tid       = Thread::getId();
-    event.id        = ORIGIN;
-    event.parent    = ORIGIN;
-    event.flags     = 0;
-    event.type      = LOG;
-    event.level     = lvl;
+    /* Synchronous Post When Ring Not Running */
+    log_slot_t* ring = log_ring;
+    if(ring == NULL)
+    {
+        event_t event;
+        va_list args;
+        va_start(args, msg_fmt);
+        int attr_size = buildLog(&event, file_name, line_number, lvl, msg_fmt, args);
+        va_end(args);
+        sendEvent(&event, attr_size);
+        return;
+    }
 
-    /* Copy IP Address */
-    StringLib::copy(event.ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
+    /* Sample Low Priority Messages Under Backpressure */
+    if(lvl < WARNING)
+    {
+        uint64_t depth = log_enqueue.load(std::memory_order_relaxed) - log_dequeue.load(std::memory_order_relaxed);
+        if(depth > LOG_SAMPLE_THRESHOLD && (log_sample_count++ % LOG_SAMPLE_RATE) != 0)
+        {
+            metric_cell_t* cell = getMetric(log_sampled_metric);
+            if(cell) addMetric(cell, 1.0);
+            return;
+        }
+    }
 
-    /* Build Name - <Filename>:<Line Number> */
-    const char* last_path_delimeter = StringLib::find(file_name, PATH_DELIMETER, false);
-    const char* file_name_only = last_path_delimeter ? last_path_delimeter + 1 : file_name;
-    StringLib::format(event.name, MAX_NAME_SIZE, "%s:%d", file_name_only, line_number);
+    /* Reserve Slot in Ring */
+    uint64_t pos;
+    log_slot_t* slot = reserveEvent(ring, &pos);
 
-    /* Build Attribute - <log message> */
+    /* Handle Full Ring */
+    if(slot == NULL)
+    {
+        if(lvl >= ERROR)
+        {
+            event_t event;
+            va_list args;
+            va_start(args, msg_fmt);
+            int attr_size = buildLog(&event, file_name, line_number, lvl, msg_fmt, args);
+            va_end(args);
+            sendEvent(&event, attr_size);
+        }
+        else
+        {
+            metric_cell_t* cell = getMetric(log_dropped_metric);
+            if(cell) addMetric(cell, 1.0);
+        }
+        return;
+    }
+
+    /* Build Log Message in Slot */
     va_list args;
     va_start(args, msg_fmt);
-    int vlen = vsnprintf(event.attr, MAX_ATTR_SIZE - 1, msg_fmt, args);
-    int attr_size = MAX(MIN(vlen + 1, MAX_ATTR_SIZE), 1);
-    event.attr[attr_size - 1] = '\0';
+    slot->attr_size = buildLog(&slot->event, file_name, line_number, lvl, msg_fmt, args);
     va_end(args);
 
-    /* Post Log Message */
-    sendEvent(&event, attr_size);
+    /* Publish Slot */
+    publishEvent(slot, pos);
 }
 
 /*----------------------------------------------------------------------------
@@ -389,27 +581,43 @@ int32_t EventLib::registerMetric (const char* category, subtype_t subtype, const
             }
         }
 
-        /* Create Metric */
-        metric_t metric;
-        metric.value    = 0.0;
-        metric.subtype  = subtype;
-        metric.name     = StringLib::duplicate(name_buf);
-        metric.category = StringLib::duplicate(category);
-        metric.id       = metric_vals.length();
-        metric_vals.add(metric);
-
-        /* Register Metric */
-        if(ids->add(metric.name, metric.id, true))
+        /* Check for Existing Metric */
+        if(ids->find(name_buf, &metric_id))
         {
-            metric_id = metric.id;
+            /* metric id returned below */
         }
-        else try // getting existing metric
+        else if(metric_count.load() >= MAX_METRIC_IDS)
         {
-            metric_id = ids->get(metric.name);
+            mlog(CRITICAL, "Failed to register metric %s: maximum number of metrics (%d) exceeded", name_buf, MAX_METRIC_IDS);
         }
-        catch(const RunTimeException& e)
+        else
         {
-            mlog(e.level(), "Failed to register metric %s", metric.name);
+            /* Create Metric */
+            metric_cell_t* cell = new metric_cell_t;
+            for(int s = 0; s < NUM_METRIC_SHARDS; s++)
+            {
+                cell->shards[s].value.store(0.0, std::memory_order_relaxed);
+            }
+            cell->pending.store(NO_PENDING_METRIC, std::memory_order_relaxed);
+            cell->subtype  = subtype;
+            cell->name     = StringLib::duplicate(name_buf);
+            cell->category = StringLib::duplicate(category);
+
+            /* Register Metric */
+            int32_t id = metric_count.load();
+            if(ids->add(cell->name, id, true))
+            {
+                metric_cells[id].store(cell, std::memory_order_release);
+                metric_count = id + 1;
+                metric_id = id;
+            }
+            else
+            {
+                mlog(ERROR, "Failed to register metric %s", cell->name);
+                delete [] cell->name;
+                delete [] cell->category;
+                delete cell;
+            }
         }
     }
     metric_mut.unlock();
@@ -420,22 +628,24 @@ int32_t EventLib::registerMetric (const char* category, subtype_t subtype, const
 
 /*----------------------------------------------------------------------------
  * updateMetric
+ *
+ *  gauges are set rather than accumulated, so the value is placed in the
+ *  first shard and the others are cleared
  *----------------------------------------------------------------------------*/
 void EventLib::updateMetric (int32_t id, double value)
 {
-    metric_mut.lock();
+    metric_cell_t* cell = getMetric(id);
+    if(!cell)
     {
-        try
-        {
-            metric_t& metric = metric_vals[id];
-            metric.value = value;
-        }
-        catch(const RunTimeException& e)
-        {
-            mlog(e.level(), "Failed to update metric %d: %s", id, e.what());
-        }
+        mlog(ERROR, "Failed to update metric %d: invalid id", id);
+        return;
     }
-    metric_mut.unlock();
+
+    for(int s = 1; s < NUM_METRIC_SHARDS; s++)
+    {
+        cell->shards[s].value.store(0.0, std::memory_order_relaxed);
+    }
+    cell->shards[0].value.store(value, std::memory_order_relaxed);
 }
 
 /*----------------------------------------------------------------------------
@@ -443,69 +653,56 @@ void EventLib::updateMetric (int32_t id, double value)
  *----------------------------------------------------------------------------*/
 void EventLib::incrementMetric (int32_t id, double value)
 {
-    metric_mut.lock();
+    metric_cell_t* cell = getMetric(id);
+    if(!cell)
     {
-        try
-        {
-            metric_t& metric = metric_vals[id];
-            metric.value += value;
-        }
-        catch(const RunTimeException& e)
+        mlog(ERROR, "Failed to increment metric %d: invalid id", id);
+        return;
+    }
+
+    addMetric(cell, value);
+}
+
+/*----------------------------------------------------------------------------
+ * incrementMetrics
+ *----------------------------------------------------------------------------*/
+void EventLib::incrementMetrics (const int32_t* ids, const double* values, int num_metrics)
+{
+    for(int i = 0; i < num_metrics; i++)
+    {
+        metric_cell_t* cell = getMetric(ids[i]);
+        if(!cell)
         {
-            mlog(e.level(), "Failed to increment metric %d: %s", id, e.what());
+            mlog(ERROR, "Failed to increment metric %d: invalid id", ids[i]);
+            continue;
         }
+
+        addMetric(cell, values[i]);
     }
-    metric_mut.unlock();
 }
 
 /*----------------------------------------------------------------------------
  * generateMetric
+ *
+ *  only marks the metric as pending; the event is sent by the metric flusher
+ *  so that repeated updates within a flush period produce a single event
  *----------------------------------------------------------------------------*/
 void EventLib::generateMetric (int32_t id, event_level_t lvl)
 {
-    event_t event;
-    metric_t metric;
-
     /* Return Here If Nothing to Do */
     if(lvl < metric_level) return;
 
     /* Get Metric */
-    metric_mut.lock();
+    metric_cell_t* cell = getMetric(id);
+    if(!cell)
     {
-        try
-        {
-            metric = metric_vals[id];
-        }
-        catch(const RunTimeException& e)
-        {
-            mlog(e.level(), "Failed to generate metric %d: %s", id, e.what());
-            metric.id = INVALID_METRIC;
-        }
+        mlog(ERROR, "Failed to generate metric %d: invalid id", id);
+        return;
     }
-    metric_mut.unlock();
-
-    /* Check for Valid Metric */
-    if (metric.id == INVALID_METRIC) return;
 
-    /* Initialize Log Message */
-    event.systime   = TimeLib::gettimems();
-    event.tid       = Thread::getId();
-    event.id        = metric.id;
-    event.parent    = metric.subtype;
-    event.flags     = 0;
-    event.type      = METRIC;
-    event.level     = lvl;
-
-    /* Copy IP Address */
-    StringLib::copy(event.ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
-
-    /* Copy Name and Attribute */
-    StringLib::copy(event.name, metric.name, MAX_NAME_SIZE);
-    StringLib::copy(event.attr, metric.category, MAX_ATTR_SIZE);
-
-    /* Post Metric */
-    int attr_size = StringLib::size(metric.category) + 1;
-    sendEvent(&event, attr_size);
+    /* Raise Pending Level */
+    int pending = cell->pending.load(std::memory_order_relaxed);
+    while(pending < (int)lvl && !cell->pending.compare_exchange_weak(pending, (int)lvl, std::memory_order_relaxed));
 }
 
 /*----------------------------------------------------------------------------
@@ -518,8 +715,17 @@ void EventLib::_iterateMetric (Dictionary<int32_t>* ids, metric_func_t cb, void*
     const char* name = ids->first(&id);
     while(name != NULL)
     {
-        metric_t metric = metric_vals[id];
-        cb(metric, i++, parm);
+        metric_cell_t* cell = getMetric(id);
+        if(cell)
+        {
+            metric_t metric;
+            metric.id       = id;
+            metric.subtype  = cell->subtype;
+            metric.name     = cell->name;
+            metric.category = cell->category;
+            metric.value    = readMetric(cell);
+            cb(metric, i++, parm);
+        }
         name = ids->next(&id);
     }
 }
@@ -568,3 +774,269 @@ int EventLib::sendEvent (event_t* event, int attr_size)
     LocalLib::copy(data, event, event_record_size);
     return record.post(outq, 0, NULL, false);
 }
+
+/*----------------------------------------------------------------------------
+ * getMetric
+ *----------------------------------------------------------------------------*/
+EventLib::metric_cell_t* EventLib::getMetric (int32_t id)
+{
+    if(id < 0 || id >= MAX_METRIC_IDS) return NULL;
+    return metric_cells[id].load(std::memory_order_acquire);
+}
+
+/*----------------------------------------------------------------------------
+ * readMetric
+ *----------------------------------------------------------------------------*/
+double EventLib::readMetric (metric_cell_t* cell)
+{
+    double value = 0.0;
+    for(int s = 0; s < NUM_METRIC_SHARDS; s++)
+    {
+        value += cell->shards[s].value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+/*----------------------------------------------------------------------------
+ * addMetric
+ *
+ *  each thread is assigned a shard on first use, so the compare and swap
+ *  below is normally uncontended
+ *----------------------------------------------------------------------------*/
+void EventLib::addMetric (metric_cell_t* cell, double value)
+{
+    if(metric_shard < 0)
+    {
+        metric_shard = metric_shard_next++ % NUM_METRIC_SHARDS;
+    }
+
+    std::atomic<double>& shard = cell->shards[metric_shard].value;
+    double current = shard.load(std::memory_order_relaxed);
+    while(!shard.compare_exchange_weak(current, current + value, std::memory_order_relaxed));
+}
+
+/*----------------------------------------------------------------------------
+ * flushMetrics
+ *----------------------------------------------------------------------------*/
+void EventLib::flushMetrics (void)
+{
+    int32_t num_metrics = metric_count.load();
+    for(int32_t id = 0; id < num_metrics; id++)
+    {
+        metric_cell_t* cell = getMetric(id);
+        if(!cell) continue;
+
+        /* Check for Pending Event */
+        int lvl = cell->pending.exchange(NO_PENDING_METRIC, std::memory_order_relaxed);
+        if(lvl == NO_PENDING_METRIC) continue;
+
+        /* Initialize Metric Event */
+        event_t event;
+        event.systime   = TimeLib::gettimems();
+        event.tid       = Thread::getId();
+        event.id        = id;
+        event.parent    = cell->subtype;
+        event.flags     = 0;
+        event.type      = METRIC;
+        event.level     = lvl;
+
+        /* Copy IP Address */
+        StringLib::copy(event.ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
+
+        /* Copy Name and Attribute */
+        StringLib::copy(event.name, cell->name, MAX_NAME_SIZE);
+        StringLib::copy(event.attr, cell->category, MAX_ATTR_SIZE);
+
+        /* Post Metric */
+        int attr_size = StringLib::size(cell->category) + 1;
+        sendEvent(&event, attr_size);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * metricFlusher
+ *----------------------------------------------------------------------------*/
+void* EventLib::metricFlusher (void* parm)
+{
+    (void)parm;
+
+    bool flushing = true;
+    while(flushing)
+    {
+        metric_signal.lock();
+        {
+            if(metric_flushing) metric_signal.wait(0, METRIC_FLUSH_PERIOD_MS);
+            flushing = metric_flushing;
+        }
+        metric_signal.unlock();
+
+        flushMetrics();
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * reserveEvent
+ *
+ *  claims the next slot of the event ring for the caller to fill in; returns
+ *  NULL when the ring is full
+ *----------------------------------------------------------------------------*/
+EventLib::log_slot_t* EventLib::reserveEvent (log_slot_t* ring, uint64_t* pos)
+{
+    uint64_t p = log_enqueue.load(std::memory_order_relaxed);
+    while(true)
+    {
+        log_slot_t* slot = &ring[p & (LOG_RING_SIZE - 1)];
+        int64_t diff = (int64_t)slot->seq.load(std::memory_order_acquire) - (int64_t)p;
+        if(diff == 0)
+        {
+            if(log_enqueue.compare_exchange_weak(p, p + 1, std::memory_order_relaxed))
+            {
+                *pos = p;
+                return slot;
+            }
+        }
+        else if(diff < 0)
+        {
+            return NULL; // ring is full
+        }
+        else
+        {
+            p = log_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * publishEvent
+ *----------------------------------------------------------------------------*/
+void EventLib::publishEvent (log_slot_t* slot, uint64_t pos)
+{
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+    /* Wake Drainer */
+    if(log_sleeping.load(std::memory_order_acquire))
+    {
+        log_signal.lock();
+        log_signal.signal();
+        log_signal.unlock();
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * buildLog
+ *----------------------------------------------------------------------------*/
+int EventLib::buildLog (event_t* event, const char* file_name, unsigned int line_number, event_level_t lvl, const char* msg_fmt, va_list args)
+{
+    /* Initialize Log Message */
+    event->systime  = TimeLib::gettimems();
+    event->tid      = Thread::getId();
+    event->id       = ORIGIN;
+    event->parent   = ORIGIN;
+    event->flags    = 0;
+    event->type     = LOG;
+    event->level    = lvl;
+
+    /* Copy IP Address */
+    StringLib::copy(event->ipv4, SockLib::sockipv4(), SockLib::IPV4_STR_LEN);
+
+    /* Build Name - <Filename>:<Line Number> */
+    const char* last_path_delimeter = StringLib::find(file_name, PATH_DELIMETER, false);
+    const char* file_name_only = last_path_delimeter ? last_path_delimeter + 1 : file_name;
+    StringLib::format(event->name, MAX_NAME_SIZE, "%s:%d", file_name_only, line_number);
+
+    /* Build Attribute - <log message> */
+    int vlen = vsnprintf(event->attr, MAX_ATTR_SIZE - 1, msg_fmt, args);
+    int attr_size = MAX(MIN(vlen + 1, MAX_ATTR_SIZE), 1);
+    event->attr[attr_size - 1] = '\0';
+
+    return attr_size;
+}
+
+/*----------------------------------------------------------------------------
+ * drainLogs
+ *
+ *  moves up to a batch of published log messages out of the ring and posts
+ *  them to the event queue together; returns the number of messages drained
+ *----------------------------------------------------------------------------*/
+int EventLib::drainLogs (void)
+{
+    void* refs[LOG_BATCH_SIZE];
+    int sizes[LOG_BATCH_SIZE];
+    int num_logs = 0;
+
+    /* Serialize Published Slots */
+    uint64_t pos = log_dequeue.load(std::memory_order_relaxed);
+    while(num_logs < LOG_BATCH_SIZE)
+    {
+        log_slot_t* slot = &log_ring[pos & (LOG_RING_SIZE - 1)];
+        if(slot->seq.load(std::memory_order_acquire) != pos + 1) break;
+
+        int event_record_size = offsetof(event_t, attr) + slot->attr_size;
+        RecordObject record(rec_type, event_record_size, false);
+        LocalLib::copy(record.getRecordData(), &slot->event, event_record_size);
+        unsigned char* rec_buf = NULL;
+        sizes[num_logs] = record.serialize(&rec_buf, RecordObject::TAKE_OWNERSHIP);
+        refs[num_logs++] = rec_buf;
+
+        /* Release Slot */
+        slot->seq.store(pos + LOG_RING_SIZE, std::memory_order_release);
+        log_dequeue.store(++pos, std::memory_order_relaxed);
+    }
+
+    /* Post Batch */
+    int posted = 0;
+    while(posted < num_logs)
+    {
+        int status = outq->postBatch(&refs[posted], &sizes[posted], num_logs - posted, SYS_TIMEOUT);
+        if(status > 0) posted += status;
+        else if(status != MsgQ::STATE_TIMEOUT) break;
+    }
+
+    /* Release Unposted Records */
+    for(int i = posted; i < num_logs; i++)
+    {
+        RecordPool::release(refs[i]);
+    }
+
+    return num_logs;
+}
+
+/*----------------------------------------------------------------------------
+ * logDrainer
+ *----------------------------------------------------------------------------*/
+void* EventLib::logDrainer (void* parm)
+{
+    (void)parm;
+
+    while(true)
+    {
+        /* Drain Until Empty */
+        if(drainLogs() > 0) continue;
+
+        /* Wait for More Logs */
+        log_signal.lock();
+        {
+            if(!log_draining)
+            {
+                log_signal.unlock();
+                break;
+            }
+
+            log_sleeping.store(true, std::memory_order_release);
+            uint64_t pos = log_dequeue.load(std::memory_order_relaxed);
+            if(log_ring[pos & (LOG_RING_SIZE - 1)].seq.load(std::memory_order_acquire) != pos + 1)
+            {
+                log_signal.wait(0, LOG_DRAIN_PERIOD_MS);
+            }
+            log_sleeping.store(false, std::memory_order_relaxed);
+        }
+        log_signal.unlock();
+    }
+
+    /* Drain Remaining */
+    while(drainLogs() > 0);
+
+    return NULL;
+}
@@ -41,6 +41,7 @@
 #include "List.h"
 
 #include <atomic>
+#include <cstdarg>
 
 /******************************************************************************
  * DEFINES
@@ -74,6 +75,16 @@ class EventLib
         static const int MAX_NAME_SIZE = 32;
         static const int MAX_ATTR_SIZE = 1024;
         static const int MAX_METRICS = 128;
+        static const int MAX_METRIC_IDS = 4096;
+        static const int NUM_METRIC_SHARDS = 16;
+        static const int METRIC_FLUSH_PERIOD_MS = 1000;
+        static const int LOG_RING_SIZE = 1024; // must be a power of two
+        static const int LOG_BATCH_SIZE = 64;
+        static const int LOG_SAMPLE_THRESHOLD = (LOG_RING_SIZE * 3) / 4;
+        static const int LOG_SAMPLE_RATE = 16;
+        static const int LOG_DRAIN_PERIOD_MS = 100;
+        static const uint32_t UNSAMPLED_TRACE = 0x80000000;
+        static const uint64_t TRACE_SAMPLE_ALL = 0x100000000ULL;
         static const int32_t INVALID_METRIC = -1;
 
         static const char* rec_type;
@@ -135,6 +146,8 @@ class EventLib
         static  const char*     type2str        (type_t type);
         static  const char*     subtype2str     (subtype_t subtype);
 
+        static bool             setTraceSampling(double rate);
+        static double           getTraceSampling(void);
         static uint32_t         startTrace      (uint32_t parent, const char* name, event_level_t lvl, const char* attr_fmt, ...) VARG_CHECK(printf, 4, 5);
         static void             stopTrace       (uint32_t id, event_level_t lvl);
         static void             stashId         (uint32_t id);
@@ -145,17 +158,52 @@ class EventLib
         static int32_t          registerMetric  (const char* category, subtype_t subtype, const char* name_fmt, ...) VARG_CHECK(printf, 3, 4);
         static void             updateMetric    (int32_t id, double value); // for gauges
         static void             incrementMetric (int32_t id, double value=1.0); // for counters
+        static void             incrementMetrics(const int32_t* ids, const double* values, int num_metrics); // for counters updated together
         static void             generateMetric  (int32_t id, event_level_t lvl);
         static void             iterateMetric   (const char* category, metric_func_t cb, void* parm);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            std::atomic<double> value;
+            char                pad[64 - sizeof(std::atomic<double>)]; // keeps each shard on its own cache line
+        } metric_shard_t;
+
+        typedef struct {
+            metric_shard_t      shards[NUM_METRIC_SHARDS];  // summed on read
+            std::atomic<int>    pending;                    // highest level of unflushed metric event
+            subtype_t           subtype;
+            const char*         name;
+            const char*         category;
+        } metric_cell_t;
+
+        /* Slot of the event ring shared by log messages and trace events */
+        typedef struct {
+            std::atomic<uint64_t> seq;                      // ring position the slot is ready for
+            int                 attr_size;
+            event_t             event;
+        } log_slot_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
         static int              sendEvent       (event_t* event, int attr_size);
         static void             _iterateMetric  (Dictionary<int32_t>* ids, metric_func_t cb, void* parm);
+        static metric_cell_t*   getMetric       (int32_t id);
+        static double           readMetric      (metric_cell_t* cell);
+        static void             addMetric       (metric_cell_t* cell, double value);
+        static void             flushMetrics    (void);
+        static void*            metricFlusher   (void* parm);
+        static log_slot_t*      reserveEvent    (log_slot_t* ring, uint64_t* pos);
+        static void             publishEvent    (log_slot_t* slot, uint64_t pos);
+        static int              buildLog        (event_t* event, const char* file_name, unsigned int line_number, event_level_t lvl, const char* msg_fmt, va_list args);
+        static int              drainLogs       (void);
+        static void*            logDrainer      (void* parm);
 
         /*--------------------------------------------------------------------
          * Data
@@ -170,7 +218,26 @@ class EventLib
 
         static Mutex metric_mut;
         static Dictionary<Dictionary<int32_t>*> metric_categories;
-        static List<metric_t> metric_vals;
+        static std::atomic<metric_cell_t*> metric_cells[MAX_METRIC_IDS];
+        static std::atomic<int32_t> metric_count;
+        static std::atomic<int> metric_shard_next;
+        static thread_local int metric_shard;
+        static bool metric_flushing;
+        static Cond metric_signal;
+        static Thread* metric_flusher;
+
+        static log_slot_t* log_ring;
+        static std::atomic<uint64_t> log_enqueue;
+        static std::atomic<uint64_t> log_dequeue;
+        static std::atomic<uint32_t> log_sample_count;
+        static std::atomic<bool> log_sleeping;
+        static bool log_draining;
+        static Cond log_signal;
+        static Thread* log_drainer;
+        static int32_t log_dropped_metric;
+        static int32_t log_sampled_metric;
+        static int32_t trace_dropped_metric;
+        static std::atomic<uint64_t> trace_sample_threshold;
 };
 
 #endif  /* __eventlib__ */
@@ -34,9 +34,11 @@
  ******************************************************************************/
 
 #include <glob.h>
+#include <sys/mman.h>
 
 #include "OsApi.h"
 #include "File.h"
+#include "AsyncFile.h"
 #include "StringLib.h"
 #include "EventLib.h"
 #include "DeviceObject.h"
@@ -63,7 +65,11 @@
  *  <file i/o> is either core.FLUSHED or core.CACHED.  Flushed means that the file
  *  descriptor is flushed after every write, and cached means that the file descriptor
  *  is flushed when the operating system decides to perform the flush.
- *  It is only specified for writers.
+ *  For binary readers core.MAPPED memory maps each file for sequential access
+ *  and reads from the mapping instead of through stdio.  For writers
+ *  core.ASYNC hands full buffers to a thread that writes them to disk while
+ *  the next buffer is filled, and core.DIRECT does the same bypassing the
+ *  page cache; both preallocate files up to the max file size.
  *
  *  <max file size> is the size of the file to be written.  It is only
  *  specified for writers. Once reached causes the file to be closed and a new
@@ -123,6 +129,9 @@ File::File (lua_State* L, const char* _filename, type_t _type, role_t _role, io_
     fileList = NULL;
     numFiles = 0;
     currFile = 0;
+    mapData = NULL;
+    mapSize = 0;
+    mapOffset = 0;
     if(role == READER)
     {
         int num_files = createFileListForReading(filename, NULL);
@@ -187,6 +196,12 @@ bool File::isConnected (int num_open)
  *----------------------------------------------------------------------------*/
 void File::closeConnection (void)
 {
+    if(mapData != NULL)
+    {
+        munmap(mapData, mapSize);
+        mapData = NULL;
+    }
+
     if(fp != NULL)
     {
         if(fp != stdout && fp != stderr)
@@ -310,7 +325,14 @@ int File::writeBuffer (const void* buf, int len, int timeout)
  *----------------------------------------------------------------------------*/
 int File::readBuffer (void* buf, int len, int timeout)
 {
-    (void)timeout;
+    /* Copy Out of Mapping */
+    if(io == MAPPED && role == READER)
+    {
+        const void* data = NULL;
+        int status = readRef(&data, len, timeout);
+        if(status > 0) LocalLib::copy(buf, data, status);
+        if(status != PARM_ERR_RC) return status; // otherwise file is not mapped
+    }
 
     /* Check Access */
     if(role != READER)
@@ -325,27 +347,8 @@ int File::readBuffer (void* buf, int len, int timeout)
     /* Manage Files */
     if(fp == NULL)
     {
-        /* Open Next File */
-        if(StringLib::match(fileList[currFile], "STDIN") || StringLib::match(fileList[currFile], "stdin"))
-        {
-            fp = stdin;
-        }
-        else
-        {
-            if(type == BINARY || type == FIFO)  fp = fopen(fileList[currFile], "rb");
-            else                                fp = fopen(fileList[currFile], "r");
-        }
-
-        /* Check Error */
-        if(fp == NULL)
-        {
-            mlog(CRITICAL, "Unable to open file %s: %s", fileList[currFile], LocalLib::err2str(errno));
-            return INVALID_RC;
-        }
-        else
-        {
-            mlog(INFO, "Opened file %s", fileList[currFile]);
-        }
+        int status = openNextFileForReading();
+        if(status < 0) return status;
     }
 
     /* Read File */
@@ -356,9 +359,7 @@ int File::readBuffer (void* buf, int len, int timeout)
         recv_bytes = (int)fread(buf, 1, len, fp);
         if(recv_bytes < len)
         {
-            currFile++;
-            fclose(fp);
-            fp = NULL;
+            closeFileForReading();
         }
     }
     else if(type == ASCII)
@@ -377,9 +378,7 @@ int File::readBuffer (void* buf, int len, int timeout)
             }
             else if(ch == EOF)
             {
-                currFile++;
-                fclose(fp);
-                fp = NULL;
+                closeFileForReading();
                 break;
             }
             else
@@ -414,6 +413,60 @@ int File::readBuffer (void* buf, int len, int timeout)
     return recv_bytes;
 }
 
+/*----------------------------------------------------------------------------
+ * readRef
+ *
+ *  Notes: only supported by binary readers with MAPPED i/o; the returned
+ *  pointer is into the mapping of the current file and is valid until the
+ *  next read (which may unmap it)
+ *----------------------------------------------------------------------------*/
+int File::readRef (const void** buf, int len, int timeout)
+{
+    (void)timeout;
+
+    /* Check Access */
+    if(role != READER)
+    {
+        return ACC_ERR_RC;
+    }
+    else if(io != MAPPED || type != BINARY)
+    {
+        return PARM_ERR_RC;
+    }
+
+    /* Release File Finished on Previous Read */
+    if(mapData != NULL && mapOffset >= mapSize)
+    {
+        closeFileForReading();
+    }
+
+    /* Check for Completion */
+    if(currFile >= numFiles)
+    {
+        return SHUTDOWN_RC;
+    }
+
+    /* Manage Files */
+    if(fp == NULL)
+    {
+        int status = openNextFileForReading();
+        if(status < 0) return status;
+    }
+
+    /* Files That Could Not Be Mapped */
+    if(mapData == NULL)
+    {
+        return PARM_ERR_RC;
+    }
+
+    /* Return Next Slice of Mapping */
+    long bytes_left = mapSize - mapOffset;
+    int recv_bytes = (bytes_left < len) ? (int)bytes_left : len;
+    *buf = &mapData[mapOffset];
+    mapOffset += recv_bytes;
+    return recv_bytes;
+}
+
 /*----------------------------------------------------------------------------
  * getUniqueId
  *----------------------------------------------------------------------------*/
@@ -485,6 +538,9 @@ File::io_t File::str2io (const char* str)
 {
          if(StringLib::match(str, "FLUSHED"))   return FLUSHED;
     else if(StringLib::match(str, "CACHED"))    return CACHED;
+    else if(StringLib::match(str, "MAPPED"))    return MAPPED;
+    else if(StringLib::match(str, "ASYNC"))     return ASYNC;
+    else if(StringLib::match(str, "DIRECT"))    return DIRECT;
     else                                        return INVALID_IO;
 }
 
@@ -495,6 +551,9 @@ const char* File::io2str (io_t _io)
 {
          if(_io == FLUSHED) return "FLUSHED";
     else if(_io == CACHED)  return "CACHED";
+    else if(_io == MAPPED)  return "MAPPED";
+    else if(_io == ASYNC)   return "ASYNC";
+    else if(_io == DIRECT)  return "DIRECT";
     else                    return "INVALID";
 }
 
@@ -531,8 +590,19 @@ bool File::openNewFileForWriting(void)
     activeFile[len] = '\0';
 
     /* Open Active File */
-    if(type == BINARY)  fp = fopen(activeFile, "wb");
-    else                fp = fopen(activeFile, "w");
+    if(io == ASYNC || io == DIRECT)
+    {
+        long prealloc_size = (maxFileSize != INFINITE_FILE_MAX_SIZE) ? maxFileSize : 0;
+        fp = AsyncFile::open(activeFile, io == DIRECT, prealloc_size);
+    }
+    else if(type == BINARY)
+    {
+        fp = fopen(activeFile, "wb");
+    }
+    else
+    {
+        fp = fopen(activeFile, "w");
+    }
 
     /* Check for Errors */
     if(fp == NULL)
@@ -589,6 +659,83 @@ int File::createFileListForReading (char* input_string, char** file_list)
     return num_files;
 }
 
+/*----------------------------------------------------------------------------
+ * openNextFileForReading
+ *
+ *  Notes: binary files read with MAPPED i/o are mapped in their entirety and
+ *  advised for sequential access; files that cannot be mapped (e.g. STDIN or
+ *  empty files) are read through stdio
+ *----------------------------------------------------------------------------*/
+int File::openNextFileForReading (void)
+{
+    /* Open Next File */
+    if(StringLib::match(fileList[currFile], "STDIN") || StringLib::match(fileList[currFile], "stdin"))
+    {
+        fp = stdin;
+    }
+    else
+    {
+        if(type == BINARY || type == FIFO)  fp = fopen(fileList[currFile], "rb");
+        else                                fp = fopen(fileList[currFile], "r");
+    }
+
+    /* Check Error */
+    if(fp == NULL)
+    {
+        mlog(CRITICAL, "Unable to open file %s: %s", fileList[currFile], LocalLib::err2str(errno));
+        return INVALID_RC;
+    }
+    else
+    {
+        mlog(INFO, "Opened file %s", fileList[currFile]);
+    }
+
+    /* Map File */
+    if(io == MAPPED && type == BINARY && fp != stdin)
+    {
+        if(fseek(fp, 0, SEEK_END) == 0)
+        {
+            long file_size = ftell(fp);
+            rewind(fp);
+            if(file_size > 0)
+            {
+                void* addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+                if(addr != MAP_FAILED)
+                {
+                    madvise(addr, file_size, MADV_SEQUENTIAL);
+                    mapData = (unsigned char*)addr;
+                    mapSize = file_size;
+                    mapOffset = 0;
+                }
+                else
+                {
+                    mlog(WARNING, "Unable to map file %s, reading through stdio: %s", fileList[currFile], LocalLib::err2str(errno));
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ * closeFileForReading
+ *----------------------------------------------------------------------------*/
+void File::closeFileForReading (void)
+{
+    if(mapData != NULL)
+    {
+        munmap(mapData, mapSize);
+        mapData = NULL;
+        mapSize = 0;
+        mapOffset = 0;
+    }
+
+    if(fp != NULL && fp != stdin) fclose(fp);
+    fp = NULL;
+    currFile++;
+}
+
 /*----------------------------------------------------------------------------
  * writeFileHeader
  *----------------------------------------------------------------------------*/
@@ -70,6 +70,9 @@ class File: public DeviceObject
         typedef enum {
             FLUSHED,
             CACHED,
+            MAPPED,
+            ASYNC,
+            DIRECT,
             INVALID_IO
         } io_t;
 
@@ -86,6 +89,7 @@ class File: public DeviceObject
         void                closeConnection     (void) override;             // close the file
         int                 writeBuffer         (const void* buf, int len, int timeout=SYS_TIMEOUT) override;
         int                 readBuffer          (void* buf, int len, int timeout=SYS_TIMEOUT) override;
+        int                 readRef             (const void** buf, int len, int timeout=SYS_TIMEOUT) override;
         int                 getUniqueId         (void) override;             // returns file descriptor
         const char*         getConfig           (void) override;             // returns filename with attribute list
 
@@ -121,6 +125,9 @@ class File: public DeviceObject
         char**          fileList; // list of files being read
         int             numFiles; // number of files in the list above
         int             currFile; // current file being read
+        unsigned char*  mapData; // mapping of current file (MAPPED binary readers)
+        long            mapSize; // size of mapping
+        long            mapOffset; // next byte of mapping to be read
 
         /*--------------------------------------------------------------------
          * Methods
@@ -128,6 +135,8 @@ class File: public DeviceObject
 
         bool            openNewFileForWriting       (void);
         int             createFileListForReading    (char* input_string, char** file_list);
+        int             openNextFileForReading      (void);
+        void            closeFileForReading         (void);
         int             readFifo                    (unsigned char* buf, int len);
         virtual int     writeFileHeader             (void);
 };
@@ -36,6 +36,16 @@
 #include "FileIODriver.h"
 #include "OsApi.h"
 #include "Asset.h"
+#include "Dictionary.h"
+#include "LuaObject.h"
+#include "StringLib.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************
  * STATIC DATA
@@ -43,6 +53,12 @@
 
 const char* FileIODriver::FORMAT = "file";
 
+const char* FileIODriver::MODE_NAMES[] = {"pread", "mmap", "uring"};
+
+std::atomic<int> FileIODriver::ioMode(PREAD_MODE);
+Dictionary<FileIODriver::file_t*> FileIODriver::openFiles;
+Mutex FileIODriver::openMut;
+
 /******************************************************************************
  * FILE IO DRIVER CLASS
  ******************************************************************************/
@@ -60,14 +76,160 @@ Asset::IODriver* FileIODriver::create (const Asset* _asset, const char* resource
  *----------------------------------------------------------------------------*/
 int64_t FileIODriver::ioRead (uint8_t* data, int64_t size, uint64_t pos)
 {
-    /* Seek to New Position */
-    if(fseek(ioFile, pos, SEEK_SET) != 0)
+    /* Copy from Mapping */
+    if(mode == MMAP_MODE)
+    {
+        if((int64_t)pos >= file->size) return 0;
+        int64_t bytes = MIN(size, file->size - (int64_t)pos);
+        memcpy(data, &file->map[pos], bytes);
+        return bytes;
+    }
+
+    /* Read at Position (reads can return less than asked for) */
+    int64_t bytes = 0;
+    while(bytes < size)
+    {
+        int64_t ret;
+        if(mode == URING_MODE)
+        {
+            ret = IoRing::read(file->fd, &data[bytes], size - bytes, pos + bytes);
+        }
+        else
+        {
+            ret = pread(file->fd, &data[bytes], size - bytes, pos + bytes);
+            if(ret < 0) ret = -errno;
+        }
+        if(ret > 0)
+        {
+            bytes += ret;
+        }
+        else if(ret == 0)
+        {
+            break; // end of file
+        }
+        else if(ret != -EINTR)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read %ld bytes at I/O position 0x%lx: %s", (long)(size - bytes), (unsigned long)(pos + bytes), strerror(-ret));
+        }
+    }
+
+    return bytes;
+}
+
+/*----------------------------------------------------------------------------
+ * ioReadv
+ *
+ *  in uring mode the reads are submitted together; any read that completes
+ *  short is finished individually
+ *----------------------------------------------------------------------------*/
+void FileIODriver::ioReadv (io_read_t* reads, int num_reads)
+{
+    if(mode != URING_MODE)
+    {
+        IODriver::ioReadv(reads, num_reads);
+        return;
+    }
+
+    IoRing::read_t* rds = new IoRing::read_t [num_reads];
+    for(int i = 0; i < num_reads; i++)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to go to I/O position: 0x%lx", pos);
+        rds[i].fd = file->fd;
+        rds[i].buf = reads[i].data;
+        rds[i].size = reads[i].size;
+        rds[i].offset = reads[i].pos;
+        rds[i].result = 0;
     }
+    IoRing::readv(rds, num_reads);
 
-    /* Read Data */
-    return fread(data, 1, size, ioFile);
+    try
+    {
+        for(int i = 0; i < num_reads; i++)
+        {
+            int64_t bytes = MAX(rds[i].result, 0);
+            if(bytes < reads[i].size && rds[i].result != 0)
+            {
+                bytes += ioRead(&reads[i].data[bytes], reads[i].size - bytes, reads[i].pos + bytes);
+            }
+            reads[i].bytes = bytes;
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        delete [] rds;
+        throw;
+    }
+    delete [] rds;
+}
+
+/*----------------------------------------------------------------------------
+ * ioAdvise
+ *
+ *  the advice applies to the file, and so to every reader of it
+ *----------------------------------------------------------------------------*/
+void FileIODriver::ioAdvise (uint64_t pos, int64_t size, advice_t advice)
+{
+    if(mode == MMAP_MODE)
+    {
+        int madv = MADV_NORMAL;
+        switch(advice)
+        {
+            case ADVISE_RANDOM:     madv = MADV_RANDOM;     break;
+            case ADVISE_SEQUENTIAL: madv = MADV_SEQUENTIAL; break;
+            case ADVISE_WILLNEED:   madv = MADV_WILLNEED;   break;
+        }
+
+        /* Align Range to Pages */
+        uint64_t page_size = sysconf(_SC_PAGESIZE);
+        uint64_t start = pos & ~(page_size - 1);
+        if((int64_t)start >= file->size) return;
+        uint64_t end = (size > 0) ? MIN(pos + size, (uint64_t)file->size) : (uint64_t)file->size;
+        madvise(&file->map[start], end - start, madv);
+    }
+    else
+    {
+        int fadv = POSIX_FADV_NORMAL;
+        switch(advice)
+        {
+            case ADVISE_RANDOM:     fadv = POSIX_FADV_RANDOM;       break;
+            case ADVISE_SEQUENTIAL: fadv = POSIX_FADV_SEQUENTIAL;   break;
+            case ADVISE_WILLNEED:   fadv = POSIX_FADV_WILLNEED;     break;
+        }
+        posix_fadvise(file->fd, pos, size, fadv);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * luaMode - filemode([<"pread"|"mmap"|"uring">])
+ *
+ *  sets how files are read by drivers created from now on; returns the mode
+ *  in effect, which stays unchanged when io_uring is not available
+ *----------------------------------------------------------------------------*/
+int FileIODriver::luaMode (lua_State* L)
+{
+    try
+    {
+        const char* mode_str = LuaObject::getLuaString(L, 1, true, NULL);
+        if(mode_str)
+        {
+            if(StringLib::match(mode_str, "pread"))     ioMode = PREAD_MODE;
+            else if(StringLib::match(mode_str, "mmap")) ioMode = MMAP_MODE;
+            else if(StringLib::match(mode_str, "uring"))
+            {
+                if(IoRing::init())  ioMode = URING_MODE;
+                else                mlog(WARNING, "io_uring is not available, file mode left as %s", MODE_NAMES[ioMode]);
+            }
+            else throw RunTimeException(CRITICAL, RTE_ERROR, "invalid file mode: %s", mode_str);
+        }
+
+        lua_pushstring(L, MODE_NAMES[ioMode]);
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting file mode: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -77,11 +239,15 @@ FileIODriver::FileIODriver (const Asset* _asset, const char* resource):
     asset(_asset)
 {
     SafeString filepath("%s/%s", asset->getPath(), resource);
-    ioFile = fopen(filepath.getString(), "r");
-    if(ioFile == NULL)
+    filePath = StringLib::duplicate(filepath.getString());
+    mode = (io_mode_t)ioMode.load();
+    file = openFile(filePath, mode == MMAP_MODE);
+    if(file == NULL)
     {
+        delete [] filePath;
         throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open resource");
     }
+    if(mode == MMAP_MODE && file->map == NULL) mode = PREAD_MODE;
 }
 
 /*----------------------------------------------------------------------------
@@ -89,6 +255,73 @@ FileIODriver::FileIODriver (const Asset* _asset, const char* resource):
  *----------------------------------------------------------------------------*/
 FileIODriver::~FileIODriver (void)
 {
-    if(ioFile) fclose(ioFile);
-    ioFile = NULL;
+    closeFile(filePath);
+    delete [] filePath;
+}
+
+/*----------------------------------------------------------------------------
+ * openFile
+ *
+ *  a file that cannot be mapped (e.g. is empty) is read with pread
+ *----------------------------------------------------------------------------*/
+FileIODriver::file_t* FileIODriver::openFile (const char* path, bool map)
+{
+    file_t* file = NULL;
+
+    openMut.lock();
+    {
+        if(!openFiles.find(path, &file))
+        {
+            struct stat st;
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if(fd >= 0 && fstat(fd, &st) == 0)
+            {
+                file = new file_t;
+                file->fd = fd;
+                file->map = NULL;
+                file->size = st.st_size;
+                file->refs = 0;
+                openFiles.add(path, file);
+            }
+            else if(fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+        if(file)
+        {
+            /* Map File (a file opened for pread is mapped by its first mmap reader) */
+            if(map && file->map == NULL && file->size > 0)
+            {
+                void* addr = mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+                if(addr != MAP_FAILED)  file->map = (uint8_t*)addr;
+                else                    mlog(WARNING, "Unable to map %s, reading instead: %s", path, strerror(errno));
+            }
+
+            file->refs++;
+        }
+    }
+    openMut.unlock();
+
+    return file;
+}
+
+/*----------------------------------------------------------------------------
+ * closeFile
+ *----------------------------------------------------------------------------*/
+void FileIODriver::closeFile (const char* path)
+{
+    openMut.lock();
+    {
+        file_t* file = NULL;
+        if(openFiles.find(path, &file) && --file->refs == 0)
+        {
+            if(file->map) munmap(file->map, file->size);
+            close(file->fd);
+            openFiles.remove(path);
+            delete file;
+        }
+    }
+    openMut.unlock();
 }
@@ -38,9 +38,19 @@
 
 #include "OsApi.h"
 #include "Asset.h"
+#include "Dictionary.h"
+#include "LuaEngine.h"
+
+#include <atomic>
 
 /******************************************************************************
  * FILE IO DRIVER CLASS
+ *
+ *  Reads are positional and keep no seek state, so any number of readers can
+ *  share a driver.  Each file is opened once for the process no matter how
+ *  many drivers read from it; in mmap mode the file is also mapped once and
+ *  reads are copies out of the shared mapping, and in uring mode reads are
+ *  submitted to the process io_uring (batches with a single system call).
  ******************************************************************************/
 
 class FileIODriver: Asset::IODriver
@@ -53,28 +63,63 @@ class FileIODriver: Asset::IODriver
 
         static const char* FORMAT;
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            PREAD_MODE = 0,
+            MMAP_MODE = 1,
+            URING_MODE = 2
+        } io_mode_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-        static IODriver*    create  (const Asset* _asset, const char* resource);
-        int64_t             ioRead  (uint8_t* data, int64_t size, uint64_t pos);
+        static IODriver*    create      (const Asset* _asset, const char* resource);
+        int64_t             ioRead      (uint8_t* data, int64_t size, uint64_t pos) override;
+        void                ioReadv     (io_read_t* reads, int num_reads) override;
+        void                ioAdvise    (uint64_t pos, int64_t size, advice_t advice) override;
+
+        static int          luaMode     (lua_State* L);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            int         fd;
+            uint8_t*    map;    // NULL until opened in mmap mode
+            int64_t     size;
+            int         refs;
+        } file_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-        FileIODriver (const Asset* _asset, const char* resource);
-        ~FileIODriver (void);
+                            FileIODriver    (const Asset* _asset, const char* resource);
+                            ~FileIODriver   (void);
+
+        static file_t*      openFile        (const char* path, bool map);
+        static void         closeFile       (const char* path);
 
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
+        static const char*          MODE_NAMES[];
+        static std::atomic<int>     ioMode;
+        static Dictionary<file_t*>  openFiles;  // shared by every driver reading the file
+        static Mutex                openMut;
+
         const Asset*    asset;
-        fileptr_t       ioFile;
+        char*           filePath;
+        file_t*         file;
+        io_mode_t       mode;
 };
 
 #endif  /* __file_io_driver__ */
@@ -0,0 +1,744 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __flat_dictionary__
+#define __flat_dictionary__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "RTExcept.h"
+#include "OsApi.h"
+#include <climits>
+#include <string.h>
+#include <assert.h>
+
+/******************************************************************************
+ * FLAT DICTIONARY TEMPLATE
+ *
+ *  Drop-in alternative to Dictionary that stores entries directly in an
+ *  open addressed table (robin hood probing with backward shift deletion).
+ *  Short keys are held inline in the slot and every slot carries its full
+ *  hash, so a lookup usually touches one cache line and compares strings
+ *  only on a hash match.  Unlike Dictionary, key pointers returned by
+ *  first/next/prev/last and the Iterator are only valid until the next
+ *  add or remove.
+ ******************************************************************************/
+
+template <class T>
+class FlatDictionary
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int            DEFAULT_HASH_TABLE_SIZE = 256;
+        static const int            INLINE_KEY_SIZE         = 24; // includes null terminator
+        static const unsigned int   EMPTY_ENTRY             = 0;
+        static const unsigned int   NULL_INDEX              = UINT_MAX;
+        static const double         DEFAULT_HASH_TABLE_LOAD; // statically defined below
+
+        /*--------------------------------------------------------------------
+         * Iterator Subclass
+         *--------------------------------------------------------------------*/
+
+        typedef struct kv {
+            kv(const char* _key, const T& _value): key(_key), value(_value) {};
+            ~kv(void) {};
+            const char* key;
+            const T&    value;
+        } kv_t;
+
+        class Iterator
+        {
+            public:
+                                    Iterator    (const FlatDictionary& d);
+                                    ~Iterator   (void);
+                kv_t                operator[]  (int index) const;
+                const int           length;
+            private:
+                const T**           elements;
+                const char**        keys;
+        };
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        FlatDictionary  (int hash_size=DEFAULT_HASH_TABLE_SIZE, double hash_load=DEFAULT_HASH_TABLE_LOAD);
+        virtual         ~FlatDictionary (void);
+
+        bool            add             (const char* key, T& data, bool unique=false);
+        T&              get             (const char* key) const;
+        bool            find            (const char* key, T* data=NULL) const;
+        bool            remove          (const char* key);
+        int             length          (void) const;
+        int             getHashSize     (void) const;
+        int             getMaxChain     (void) const; // longest probe sequence
+        int             getKeys         (char*** keys) const;
+        void            clear           (void);
+
+        const char*     first           (T* data);
+        const char*     next            (T* data);
+        const char*     prev            (T* data);
+        const char*     last            (T* data);
+
+        FlatDictionary& operator=       (const FlatDictionary& other);
+        T&              operator[]      (const char* key) const;
+
+    protected:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            unsigned int    hash;                       // unconstrained hash value
+            unsigned int    probe;                      // distance from home slot plus one, 0 indicates empty
+            char*           long_key;                   // heap copy of keys that do not fit inline, else NULL
+            char            short_key[INLINE_KEY_SIZE];
+            T               data;
+        } slot_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        slot_t*         hashTable;
+        unsigned int    hashSize;   // always a power of two
+        unsigned int    hashMask;
+        unsigned int    numEntries;
+        unsigned int    maxChain;
+        double          hashLoad;
+        unsigned int    currIndex;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static unsigned int hashKey (const char* key);
+        static const char*  keyOf   (const slot_t& slot);
+        unsigned int        getNode (const char* key) const;
+        void                place   (slot_t& entry);
+        void                rehash  (void);
+        virtual void        freeNode(unsigned int hash_index);
+};
+
+/******************************************************************************
+ * MANAGED FLAT DICTIONARY TEMPLATE
+ ******************************************************************************/
+
+template <class T, bool is_array=false>
+class MgFlatDictionary: public FlatDictionary<T>
+{
+    public:
+        MgFlatDictionary (int hash_size=FlatDictionary<T>::DEFAULT_HASH_TABLE_SIZE, double hash_load=FlatDictionary<T>::DEFAULT_HASH_TABLE_LOAD);
+        ~MgFlatDictionary (void);
+    private:
+        void freeNode (unsigned int hash_index);
+};
+
+/******************************************************************************
+ * ITERATOR METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+FlatDictionary<T>::Iterator::Iterator(const FlatDictionary& d):
+    length(d.numEntries)
+{
+    elements = new const T* [length];
+    keys = new const char* [length];
+    for(unsigned int i = 0, j = 0; i < d.hashSize; i++)
+    {
+        if(d.hashTable[i].probe != EMPTY_ENTRY)
+        {
+            elements[j] = &d.hashTable[i].data;
+            keys[j] = keyOf(d.hashTable[i]);
+            j++;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+FlatDictionary<T>::Iterator::~Iterator(void)
+{
+    delete [] elements;
+    delete [] keys;
+}
+
+/*----------------------------------------------------------------------------
+ * []
+ *----------------------------------------------------------------------------*/
+template <class T>
+typename FlatDictionary<T>::kv_t FlatDictionary<T>::Iterator::operator[](int index) const
+{
+    if( (index < length) && (index >= 0) )
+    {
+        FlatDictionary<T>::kv_t pair(keys[index], *elements[index]);
+        return pair;
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "FlatDictionary::Iterator index out of range");
+    }
+}
+
+/******************************************************************************
+ * PUBLIC STATIC DATA
+ ******************************************************************************/
+
+template <class T>
+const double FlatDictionary<T>::DEFAULT_HASH_TABLE_LOAD = 0.75;
+
+/******************************************************************************
+ * FLAT DICTIONARY METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+FlatDictionary<T>::FlatDictionary(int hash_size, double hash_load)
+{
+    assert(hash_size > 0);
+
+    /* Round Up to Power of Two */
+    hashSize = 1;
+    while(hashSize < (unsigned int)hash_size) hashSize <<= 1;
+    hashMask = hashSize - 1;
+
+    if(hash_load <= 0.0 || hash_load >= 1.0)
+    {
+        hashLoad = DEFAULT_HASH_TABLE_LOAD;
+    }
+    else
+    {
+        hashLoad = hash_load;
+    }
+
+    hashTable = new slot_t [hashSize];
+    for(unsigned int i = 0; i < hashSize; i++)
+    {
+        hashTable[i].probe = EMPTY_ENTRY;
+        hashTable[i].long_key = NULL;
+    }
+
+    currIndex = 0;
+    numEntries = 0;
+    maxChain = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T>
+FlatDictionary<T>::~FlatDictionary(void)
+{
+    clear();
+    delete [] hashTable;
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *
+ *  if not unique then old data is automatically deleted and overwritten
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool FlatDictionary<T>::add(const char* key, T& data, bool unique)
+{
+    assert(key);
+
+    /* Check for Existing Entry */
+    unsigned int index = getNode(key);
+    if(index != NULL_INDEX)
+    {
+        if(unique) return false; // refuse to overwrite existing node
+        freeNode(index);
+        hashTable[index].data = data;
+        return true;
+    }
+
+    /* Check for Rehash Needed */
+    if((numEntries + 1) > (hashSize * hashLoad))
+    {
+        if((hashSize << 1) <= hashSize) return false; // unable to make hash larger
+        rehash();
+    }
+
+    /* Build Entry */
+    slot_t entry;
+    size_t len = strlen(key);
+    entry.hash = hashKey(key);
+    entry.probe = 1;
+    entry.data = data;
+    if(len < (size_t)INLINE_KEY_SIZE)
+    {
+        memcpy(entry.short_key, key, len + 1);
+        entry.long_key = NULL;
+    }
+    else
+    {
+        entry.long_key = new char [len + 1];
+        memcpy(entry.long_key, key, len + 1);
+    }
+
+    /* Place Entry */
+    place(entry);
+    numEntries++;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * get
+ *----------------------------------------------------------------------------*/
+template <class T>
+T& FlatDictionary<T>::get(const char* key) const
+{
+    unsigned int index = getNode(key);
+    if(index != NULL_INDEX) return hashTable[index].data;
+    else                    throw RunTimeException(CRITICAL, RTE_ERROR, "key <%s> not found", key);
+}
+
+/*----------------------------------------------------------------------------
+ * find
+ *
+ *  returns false if key not in dictionary, else returns true
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool FlatDictionary<T>::find(const char* key, T* data) const
+{
+    unsigned int index = getNode(key);
+    if(index != NULL_INDEX)
+    {
+        if(data) *data = hashTable[index].data;
+        return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * remove
+ *
+ *  entries following the removed one are shifted back so that no
+ *  tombstones are needed
+ *----------------------------------------------------------------------------*/
+template <class T>
+bool FlatDictionary<T>::remove(const char* key)
+{
+    unsigned int index = getNode(key);
+    if(index == NULL_INDEX) return false;
+
+    /* Delete Node */
+    delete [] hashTable[index].long_key;
+    freeNode(index);
+
+    /* Shift Back Displaced Entries */
+    unsigned int next_index = (index + 1) & hashMask;
+    while(hashTable[next_index].probe > 1)
+    {
+        hashTable[index] = hashTable[next_index];
+        hashTable[index].probe--;
+        index = next_index;
+        next_index = (next_index + 1) & hashMask;
+    }
+
+    /* Empty Last Slot */
+    hashTable[index].probe = EMPTY_ENTRY;
+    hashTable[index].long_key = NULL;
+
+    numEntries--;
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * length
+ *----------------------------------------------------------------------------*/
+template <class T>
+int FlatDictionary<T>::length(void) const
+{
+    return numEntries;
+}
+
+/*----------------------------------------------------------------------------
+ * getHashSize
+ *----------------------------------------------------------------------------*/
+template <class T>
+int FlatDictionary<T>::getHashSize(void) const
+{
+    return hashSize;
+}
+
+/*----------------------------------------------------------------------------
+ * getMaxChain
+ *----------------------------------------------------------------------------*/
+template <class T>
+int FlatDictionary<T>::getMaxChain(void) const
+{
+    return maxChain;
+}
+
+/*----------------------------------------------------------------------------
+ * getKeys
+ *----------------------------------------------------------------------------*/
+template <class T>
+int FlatDictionary<T>::getKeys (char*** keys) const
+{
+    if (numEntries <= 0) return 0;
+
+    *keys = new char* [numEntries];
+    for(unsigned int i = 0, j = 0; i < hashSize; i++)
+    {
+        if(hashTable[i].probe != EMPTY_ENTRY)
+        {
+            const char* key = keyOf(hashTable[i]);
+            size_t len = strlen(key);
+            char* new_key = new char[len + 1];
+            memcpy(new_key, key, len + 1);
+            (*keys)[j++] = new_key;
+        }
+    }
+
+    return numEntries;
+}
+
+/*----------------------------------------------------------------------------
+ * clear
+ *
+ *  deletes everything in the dictionary
+ *----------------------------------------------------------------------------*/
+template <class T>
+void FlatDictionary<T>::clear (void)
+{
+    for(unsigned int i = 0; numEntries > 0 && i < hashSize; i++)
+    {
+        if(hashTable[i].probe != EMPTY_ENTRY)
+        {
+            hashTable[i].probe = EMPTY_ENTRY;
+            delete [] hashTable[i].long_key;
+            hashTable[i].long_key = NULL;
+            numEntries--;
+            freeNode(i);
+        }
+    }
+
+    maxChain = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * first
+ *----------------------------------------------------------------------------*/
+template <class T>
+const char* FlatDictionary<T>::first (T* data)
+{
+    for(currIndex = 0; currIndex < hashSize; currIndex++)
+    {
+        if(hashTable[currIndex].probe != EMPTY_ENTRY)
+        {
+            if(data) *data = hashTable[currIndex].data;
+            return keyOf(hashTable[currIndex]);
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * next
+ *----------------------------------------------------------------------------*/
+template <class T>
+const char* FlatDictionary<T>::next (T* data)
+{
+    while(++currIndex < hashSize)
+    {
+        if(hashTable[currIndex].probe != EMPTY_ENTRY)
+        {
+            if(data) *data = hashTable[currIndex].data;
+            return keyOf(hashTable[currIndex]);
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * prev
+ *----------------------------------------------------------------------------*/
+template <class T>
+const char* FlatDictionary<T>::prev (T* data)
+{
+    while(--currIndex < hashSize) // since we are using unsigned math, the .lt. is appropriate
+    {
+        if(hashTable[currIndex].probe != EMPTY_ENTRY)
+        {
+            if(data) *data = hashTable[currIndex].data;
+            return keyOf(hashTable[currIndex]);
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * last
+ *----------------------------------------------------------------------------*/
+template <class T>
+const char* FlatDictionary<T>::last (T* data)
+{
+    for(currIndex = hashSize - 1; currIndex < hashSize; currIndex--)
+    {
+        if(hashTable[currIndex].probe != EMPTY_ENTRY)
+        {
+            if(data) *data = hashTable[currIndex].data;
+            return keyOf(hashTable[currIndex]);
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * operator=
+ *----------------------------------------------------------------------------*/
+template <class T>
+FlatDictionary<T>& FlatDictionary<T>::operator=(const FlatDictionary& other)
+{
+    if(this == &other) return *this;
+
+    /* Clear Existing Dictionary */
+    clear();
+    delete [] hashTable;
+
+    /* Copy Other Dictionary */
+    hashSize = other.hashSize;
+    hashMask = other.hashMask;
+    hashLoad = other.hashLoad;
+    hashTable = new slot_t [hashSize];
+    for(unsigned int i = 0; i < hashSize; i++)
+    {
+        hashTable[i] = other.hashTable[i];
+        if(other.hashTable[i].probe != EMPTY_ENTRY && other.hashTable[i].long_key)
+        {
+            size_t len = strlen(other.hashTable[i].long_key);
+            hashTable[i].long_key = new char [len + 1];
+            memcpy(hashTable[i].long_key, other.hashTable[i].long_key, len + 1);
+        }
+        else
+        {
+            hashTable[i].long_key = NULL;
+        }
+    }
+    currIndex = 0;
+    numEntries = other.numEntries;
+    maxChain = other.maxChain;
+
+    return *this;
+}
+
+/*----------------------------------------------------------------------------
+ * []
+ *
+ *  indexed by key
+ *----------------------------------------------------------------------------*/
+template <class T>
+T& FlatDictionary<T>::operator[](const char* key) const
+{
+    return get(key);
+}
+
+/*----------------------------------------------------------------------------
+ * hashKey - FNV-1a
+ *----------------------------------------------------------------------------*/
+template <class T>
+unsigned int FlatDictionary<T>::hashKey(const char *key)
+{
+    unsigned int h = 2166136261U;
+    for(const unsigned char* ptr = (const unsigned char*)key; *ptr != '\0'; ptr++)
+    {
+        h ^= *ptr;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*----------------------------------------------------------------------------
+ * keyOf
+ *----------------------------------------------------------------------------*/
+template <class T>
+const char* FlatDictionary<T>::keyOf(const slot_t& slot)
+{
+    return slot.long_key ? slot.long_key : slot.short_key;
+}
+
+/*----------------------------------------------------------------------------
+ * getNode
+ *
+ *  the search stops as soon as it reaches an entry closer to its home slot
+ *  than the key being searched for would be
+ *----------------------------------------------------------------------------*/
+template <class T>
+unsigned int FlatDictionary<T>::getNode(const char* key) const
+{
+    if(key == NULL) return NULL_INDEX;
+
+    unsigned int hash = hashKey(key);
+    unsigned int index = hash & hashMask;
+    unsigned int probe = 1;
+
+    while(hashTable[index].probe >= probe)
+    {
+        if(hashTable[index].hash == hash && strcmp(keyOf(hashTable[index]), key) == 0)
+        {
+            return index;
+        }
+        index = (index + 1) & hashMask;
+        probe++;
+    }
+
+    return NULL_INDEX;
+}
+
+/*----------------------------------------------------------------------------
+ * place
+ *
+ *  robin hood insertion: an entry further from its home slot takes the
+ *  place of one that is closer to its own
+ *----------------------------------------------------------------------------*/
+template <class T>
+void FlatDictionary<T>::place(slot_t& entry)
+{
+    unsigned int index = entry.hash & hashMask;
+    entry.probe = 1;
+
+    while(true)
+    {
+        if(hashTable[index].probe == EMPTY_ENTRY)
+        {
+            hashTable[index] = entry;
+            if(entry.probe > maxChain) maxChain = entry.probe;
+            return;
+        }
+        else if(hashTable[index].probe < entry.probe)
+        {
+            if(entry.probe > maxChain) maxChain = entry.probe;
+            slot_t displaced = hashTable[index];
+            hashTable[index] = entry;
+            entry = displaced;
+        }
+
+        index = (index + 1) & hashMask;
+        entry.probe++;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * rehash
+ *----------------------------------------------------------------------------*/
+template <class T>
+void FlatDictionary<T>::rehash(void)
+{
+    unsigned int old_hash_size = hashSize;
+    slot_t* old_hash_table = hashTable;
+
+    hashSize <<= 1;
+    hashMask = hashSize - 1;
+    hashTable = new slot_t [hashSize];
+    for(unsigned int i = 0; i < hashSize; i++)
+    {
+        hashTable[i].probe = EMPTY_ENTRY;
+        hashTable[i].long_key = NULL;
+    }
+
+    /* Move Entries (keys are moved, not reallocated) */
+    maxChain = 0;
+    for(unsigned int i = 0; i < old_hash_size; i++)
+    {
+        if(old_hash_table[i].probe != EMPTY_ENTRY)
+        {
+            place(old_hash_table[i]);
+        }
+    }
+
+    delete [] old_hash_table;
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T>
+void FlatDictionary<T>::freeNode(unsigned int hash_index)
+{
+    (void)hash_index;
+}
+
+/******************************************************************************
+ * MANAGED FLAT DICTIONARY METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+MgFlatDictionary<T, is_array>::MgFlatDictionary(int hash_size, double hash_load): FlatDictionary<T>(hash_size, hash_load)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+MgFlatDictionary<T, is_array>::~MgFlatDictionary(void)
+{
+    /* see MgDictionary - must clear in the context of this freeNode */
+    FlatDictionary<T>::clear();
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T, bool is_array>
+void MgFlatDictionary<T, is_array>::freeNode(unsigned int hash_index)
+{
+    if(!is_array)   delete FlatDictionary<T>::hashTable[hash_index].data;
+    else            delete [] FlatDictionary<T>::hashTable[hash_index].data;
+}
+
+#endif  /* __flat_dictionary__ */
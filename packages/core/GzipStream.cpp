@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "GzipStream.h"
+#include "OsApi.h"
+#include "RTExcept.h"
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  inflating accepts both gzip and zlib headers
+ *----------------------------------------------------------------------------*/
+GzipStream::GzipStream(direction_t _direction, int level)
+{
+    direction = _direction;
+    finished = false;
+    buffer = NULL;
+    bufferSize = 0;
+
+    LocalLib::set(&strm, 0, sizeof(strm));
+    int status;
+    if(direction == DEFLATE)    status = deflateInit2(&strm, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+    else                        status = inflateInit2(&strm, MAX_WBITS + 32);
+    if(status != Z_OK)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to initialize gzip stream: %d", status);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+GzipStream::~GzipStream(void)
+{
+    if(direction == DEFLATE)    deflateEnd(&strm);
+    else                        inflateEnd(&strm);
+    delete [] buffer;
+}
+
+/*----------------------------------------------------------------------------
+ * deflate
+ *
+ *  compresses and flushes the input; finish ends the stream and writes the
+ *  gzip trailer.  Returns the number of bytes in out.
+ *----------------------------------------------------------------------------*/
+long GzipStream::deflate(const void* in, long in_size, bool finish, const uint8_t** out)
+{
+    assert(direction == DEFLATE);
+
+    /* Size Buffer for Worst Case */
+    long bound = deflateBound(&strm, in_size) + 16; // sync flush marker
+    if(bound > bufferSize) grow(bound, 0);
+
+    strm.next_in = (Bytef*)in;
+    strm.avail_in = (uInt)in_size;
+    long used = 0;
+    int status;
+    do
+    {
+        if(used == bufferSize) grow(bufferSize * 2, used);
+        strm.next_out = &buffer[used];
+        strm.avail_out = (uInt)(bufferSize - used);
+        status = ::deflate(&strm, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        used = bufferSize - strm.avail_out;
+        if(status == Z_STREAM_ERROR)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "failed to deflate gzip stream");
+        }
+    } while(strm.avail_out == 0 || (finish && status != Z_STREAM_END));
+
+    finished = finish;
+    *out = buffer;
+    return used;
+}
+
+/*----------------------------------------------------------------------------
+ * inflate
+ *
+ *  decompresses all of the input; returns the number of bytes in out,
+ *  which can be zero when the input only ends the stream
+ *----------------------------------------------------------------------------*/
+long GzipStream::inflate(const void* in, long in_size, const uint8_t** out)
+{
+    assert(direction == INFLATE);
+
+    if(bufferSize == 0) grow(MAX(in_size * 4, MIN_BUFFER_SIZE), 0);
+
+    strm.next_in = (Bytef*)in;
+    strm.avail_in = (uInt)in_size;
+    long used = 0;
+    while(!finished && (strm.avail_in > 0 || used == bufferSize))
+    {
+        if(used == bufferSize) grow(bufferSize * 2, used);
+        strm.next_out = &buffer[used];
+        strm.avail_out = (uInt)(bufferSize - used);
+        int status = ::inflate(&strm, Z_SYNC_FLUSH);
+        used = bufferSize - strm.avail_out;
+        if(status == Z_STREAM_END)
+        {
+            finished = true;
+        }
+        else if(status != Z_OK && status != Z_BUF_ERROR)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "failed to inflate gzip stream: %d", status);
+        }
+        else if(status == Z_BUF_ERROR && strm.avail_out > 0)
+        {
+            break; // input exhausted mid block, the rest arrives with the next call
+        }
+    }
+
+    *out = buffer;
+    return used;
+}
+
+/*----------------------------------------------------------------------------
+ * isFinished
+ *----------------------------------------------------------------------------*/
+bool GzipStream::isFinished(void)
+{
+    return finished;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * grow - keeps the first used bytes
+ *----------------------------------------------------------------------------*/
+void GzipStream::grow(long size, long used)
+{
+    uint8_t* new_buffer = new uint8_t [size];
+    if(used > 0) LocalLib::copy(new_buffer, buffer, used);
+    delete [] buffer;
+    buffer = new_buffer;
+    bufferSize = size;
+}
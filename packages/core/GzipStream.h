@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __gzip_stream__
+#define __gzip_stream__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <zlib.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * GZIP STREAM CLASS
+ *
+ *  One direction of a gzip stream carried over a connection.  Every call to
+ *  deflate flushes, so each piece of input can be inflated as soon as it
+ *  arrives at the other end, and message boundaries survive the trip.  The
+ *  output is held in a buffer owned by the stream, valid until the next call.
+ ******************************************************************************/
+
+class GzipStream
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DEFAULT_LEVEL = 1; // fastest; record streams compress well at any level
+        static const int MIN_BUFFER_SIZE = 0x4000; // 16KB
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            DEFLATE,
+            INFLATE
+        } direction_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        GzipStream  (direction_t _direction, int level=DEFAULT_LEVEL);
+                        ~GzipStream (void);
+
+        long            deflate     (const void* in, long in_size, bool finish, const uint8_t** out);
+        long            inflate     (const void* in, long in_size, const uint8_t** out);
+        bool            isFinished  (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        direction_t     direction;
+        z_stream        strm;
+        bool            finished;
+        uint8_t*        buffer;
+        long            bufferSize;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        void            grow        (long size, long used);
+};
+
+#endif  /* __gzip_stream__ */
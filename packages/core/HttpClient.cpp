@@ -44,6 +44,9 @@
  * STATIC DATA
  ******************************************************************************/
 
+Mutex HttpClient::poolMut;
+Dictionary<List<HttpClient*>*> HttpClient::clientPool;
+
 const char* HttpClient::OBJECT_TYPE = "HttpClient";
 const char* HttpClient::LuaMetaName = "HttpClient";
 const struct luaL_Reg HttpClient::LuaMetaTable[] = {
@@ -56,6 +59,29 @@ const struct luaL_Reg HttpClient::LuaMetaTable[] = {
  * PUBLIC METHODS
  ******************************************************************************/
 
+/*----------------------------------------------------------------------------
+ * deinit
+ *----------------------------------------------------------------------------*/
+void HttpClient::deinit (void)
+{
+    poolMut.lock();
+    {
+        List<HttpClient*>* clients;
+        const char* key = clientPool.first(&clients);
+        while(key != NULL)
+        {
+            for(int i = 0; i < clients->length(); i++)
+            {
+                delete clients->get(i);
+            }
+            delete clients;
+            key = clientPool.next(&clients);
+        }
+        clientPool.clear();
+    }
+    poolMut.unlock();
+}
+
 /*----------------------------------------------------------------------------
  * luaCreate - server(<ip_addr>, <port>)
  *----------------------------------------------------------------------------*/
@@ -92,9 +118,11 @@ HttpClient::HttpClient(lua_State* L, const char* _ip_addr, int _port):
     active = true;
     ipAddr = StringLib::duplicate(_ip_addr);
     port = _port;
+    poolUrl = NULL;
     sock = initializeSocket(ipAddr, port);
     requestPub = new Publisher(NULL);
     requestPid = NULL;
+    initializeState();
 }
 
 /*----------------------------------------------------------------------------
@@ -107,6 +135,7 @@ HttpClient::HttpClient(lua_State* L, const char* url):
     active = false;
     ipAddr = NULL;
     port = -1;
+    poolUrl = StringLib::duplicate(url);
 
     // Parse URL
     char url_buf[MAX_URL_LEN];
@@ -144,6 +173,7 @@ HttpClient::HttpClient(lua_State* L, const char* url):
     // Create Request Queue and Thread
     requestPub = new Publisher(NULL);
     requestPid = NULL;
+    initializeState();
 }
 
 /*----------------------------------------------------------------------------
@@ -155,28 +185,173 @@ HttpClient::~HttpClient(void)
     if(requestPid) delete requestPid;
     if(requestPub) delete requestPub;
     if(ipAddr) delete [] ipAddr;
+    if(poolUrl) delete [] poolUrl;
     if(sock) delete sock;
 }
 
+/*----------------------------------------------------------------------------
+ * acquire
+ *
+ *  returns an idle keep-alive connection to the url, or a new client if none
+ *  are available; give it back with release when done
+ *----------------------------------------------------------------------------*/
+HttpClient* HttpClient::acquire (const char* _url)
+{
+    HttpClient* client = NULL;
+
+    poolMut.lock();
+    {
+        List<HttpClient*>* clients;
+        if(clientPool.find(_url, &clients) && clients->length() > 0)
+        {
+            int last = clients->length() - 1;
+            client = clients->get(last);
+            clients->remove(last);
+        }
+    }
+    poolMut.unlock();
+
+    if(!client)
+    {
+        client = new HttpClient(NULL, _url);
+    }
+
+    return client;
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *
+ *  returns the client to the pool if its connection can be used again,
+ *  otherwise deletes it
+ *----------------------------------------------------------------------------*/
+void HttpClient::release (HttpClient* client)
+{
+    bool pooled = false;
+
+    if(client->poolUrl && client->reusable && client->pendingResponses == 0 && client->sock->isConnected())
+    {
+        poolMut.lock();
+        {
+            List<HttpClient*>* clients;
+            if(!clientPool.find(client->poolUrl, &clients))
+            {
+                clients = new List<HttpClient*>;
+                clientPool.add(client->poolUrl, clients);
+            }
+            if(clients->length() < MAX_POOLED_CLIENTS)
+            {
+                clients->add(client);
+                pooled = true;
+            }
+        }
+        poolMut.unlock();
+    }
+
+    if(!pooled)
+    {
+        delete client;
+    }
+}
+
 /*----------------------------------------------------------------------------
  * request
+ *
+ *  passthru responses are relayed as received: the body is not requested
+ *  compressed and large chunks are read straight into the message posted
+ *  to the output queue
  *----------------------------------------------------------------------------*/
-HttpClient::rsps_t HttpClient::request (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, Publisher* outq, int timeout)
+HttpClient::rsps_t HttpClient::request (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, Publisher* outq, int timeout, bool passthru)
 {
-    if(sock->isConnected() && makeRequest(verb, resource, data, keep_alive))
+    rsps_t rsps = {
+        .code = EndpointObject::Service_Unavailable,
+        .response = NULL,
+        .size = 0
+    };
+
+    /* Check for Outstanding Pipelined Requests */
+    if(pendingResponses > 0)
     {
-        rsps_t rsps = parseResponse(outq, timeout);
+        mlog(CRITICAL, "Unable to make request to %s:%d with %d pipelined responses outstanding", getIpAddr(), port, pendingResponses);
         return rsps;
     }
-    else
+
+    /* Replace Connection That Cannot Be Reused */
+    if(numRequests > 0 && !reusable) reconnect();
+    bool reused = numRequests > 0;
+
+    /* Make Request */
+    if(sock->isConnected() && makeRequest(verb, resource, data, keep_alive, !passthru))
+    {
+        rsps = parseResponse(outq, timeout, passthru);
+
+        /* Retry Once if Server Closed Idle Connection */
+        if(reused && !rspsStarted)
+        {
+            mlog(DEBUG, "Kept connection to %s:%d was closed, reconnecting", getIpAddr(), port);
+            reconnect();
+            if(rsps.response) delete [] rsps.response;
+            rsps.code = EndpointObject::Service_Unavailable;
+            rsps.response = NULL;
+            rsps.size = 0;
+            if(sock->isConnected() && makeRequest(verb, resource, data, keep_alive, !passthru))
+            {
+                rsps = parseResponse(outq, timeout, passthru);
+            }
+        }
+    }
+
+    return rsps;
+}
+
+/*----------------------------------------------------------------------------
+ * pipeline
+ *
+ *  sends a keep-alive request without waiting for the responses of the
+ *  requests before it; each call must be matched by a call to response,
+ *  and the responses are returned in the order the requests were sent
+ *----------------------------------------------------------------------------*/
+bool HttpClient::pipeline (EndpointObject::verb_t verb, const char* resource, const char* data)
+{
+    /* Replace Connection That Cannot Be Reused */
+    if(pendingResponses == 0 && numRequests > 0 && !reusable) reconnect();
+
+    /* Send Request */
+    if(sock->isConnected() && makeRequest(verb, resource, data, true))
+    {
+        pendingResponses++;
+        return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * response
+ *
+ *  reads the response to the oldest outstanding pipelined request
+ *----------------------------------------------------------------------------*/
+HttpClient::rsps_t HttpClient::response (Publisher* outq, int timeout)
+{
+    rsps_t rsps = {
+        .code = EndpointObject::Service_Unavailable,
+        .response = NULL,
+        .size = 0
+    };
+
+    if(pendingResponses <= 0)
     {
-        rsps_t rsps = {
-            .code = EndpointObject::Service_Unavailable,
-            .response = NULL,
-            .size = 0
-        };
+        mlog(CRITICAL, "No pipelined requests outstanding to %s:%d", getIpAddr(), port);
         return rsps;
     }
+
+    pendingResponses--;
+    rsps = parseResponse(outq, timeout);
+
+    /* Remaining Responses Lost With Connection */
+    if(!reusable) pendingResponses = 0;
+
+    return rsps;
 }
 
 /*----------------------------------------------------------------------------
@@ -205,10 +380,33 @@ TcpSocket* HttpClient::initializeSocket(const char* _ip_addr, int _port)
     return new TcpSocket(NULL, _ip_addr, _port, false, &block, false);
 }
 
+/*----------------------------------------------------------------------------
+ * initializeState
+ *----------------------------------------------------------------------------*/
+void HttpClient::initializeState (void)
+{
+    rspsLeftover = 0;
+    rspsStarted = false;
+    pendingResponses = 0;
+    numRequests = 0;
+    keepAlive = false;
+    reusable = false;
+}
+
+/*----------------------------------------------------------------------------
+ * reconnect
+ *----------------------------------------------------------------------------*/
+void HttpClient::reconnect (void)
+{
+    delete sock;
+    sock = initializeSocket(ipAddr, port);
+    initializeState();
+}
+
 /*----------------------------------------------------------------------------
  * makeRequest
  *----------------------------------------------------------------------------*/
-bool HttpClient::makeRequest (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive)
+bool HttpClient::makeRequest (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, bool accept_gzip)
 {
     bool status = true;
     int rqst_len = 0;
@@ -230,15 +428,20 @@ bool HttpClient::makeRequest (EndpointObject::verb_t verb, const char* resource,
         const char* keep_alive_header = "";
         if(keep_alive) keep_alive_header = "Connection: keep-alive\r\n";
 
+        /* Set Accept Encoding Header */
+        const char* accept_encoding_header = "";
+        if(accept_gzip) accept_encoding_header = "Accept-Encoding: gzip\r\n";
+
         /* Build Request */
         if(verb != EndpointObject::RAW)
         {
             /* Build Request Header */
-            SafeString rqst_hdr("%s %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: sliderule/%s\r\nAccept: */*\r\n%sContent-Length: %d\r\n\r\n",
+            SafeString rqst_hdr("%s %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: sliderule/%s\r\nAccept: */*\r\n%s%sContent-Length: %d\r\n\r\n",
                                 EndpointObject::verb2str(verb),
                                 resource,
                                 getIpAddr(),
                                 LIBID,
+                                accept_encoding_header,
                                 keep_alive_header,
                                 content_length);
 
@@ -282,6 +485,10 @@ bool HttpClient::makeRequest (EndpointObject::verb_t verb, const char* resource,
         {
             throw RunTimeException(ERROR, RTE_ERROR, "failed to send request: act=%d, exp=%d", bytes_written, rqst_len);
         }
+
+        /* Update Connection State */
+        numRequests++;
+        keepAlive = keep_alive;
     }
     catch(const RunTimeException& e)
     {
@@ -295,7 +502,7 @@ bool HttpClient::makeRequest (EndpointObject::verb_t verb, const char* resource,
 /*----------------------------------------------------------------------------
  * parseResponse
  *----------------------------------------------------------------------------*/
-HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
+HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout, bool passthru)
 {
     rsps_t rsps = {
         .code = EndpointObject::OK,
@@ -313,22 +520,56 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
     bool    chunk_header_complete   = false;
     bool    chunk_payload_complete  = false;
     bool    chunk_trailer_complete  = false;
+    bool    last_chunk              = false;
     bool    headers_complete        = false;
     bool    response_complete       = false;
+    bool    connection_close        = !keepAlive;
+    GzipStream* gzip                = NULL; // set when the content is gzip encoded
 
     /* Process Response */
+    rspsStarted = false;
+    reusable = false;
     try
     {
         while(active && !response_complete)
         {
-            int bytes_read = sock->readBuffer(&rspsBuf[rsps_buf_index], MAX_RSPS_BUF_LEN-rsps_buf_index, timeout);
+            int bytes_read;
+            if(rspsLeftover > 0)
+            {
+                /* Start From Bytes Read With Previous Response */
+                bytes_read = rspsLeftover;
+                rspsLeftover = 0;
+            }
+            else if(passthru && chunk_encoding && chunk_header_complete && !chunk_payload_complete &&
+                    rsps.response && rsps_buf_index == 0 && chunk_remaining > DIRECT_READ_SIZE)
+            {
+                /* Read Chunk Payload In Place - last byte goes through the buffer to complete the chunk */
+                int payload_read = sock->readBuffer(&rsps.response[rsps_index], (int)(chunk_remaining - 1), timeout);
+                if(payload_read > 0)
+                {
+                    rsps_index += payload_read;
+                    chunk_remaining -= payload_read;
+                    rspsStarted = true;
+                    bytes_read = TIMEOUT_RC; // nothing to parse
+                }
+                else
+                {
+                    bytes_read = payload_read;
+                }
+            }
+            else
+            {
+                bytes_read = sock->readBuffer(&rspsBuf[rsps_buf_index], MAX_RSPS_BUF_LEN-rsps_buf_index, timeout);
+            }
+
             if(bytes_read > 0)
             {
                 int line_start = 0;
                 int line_term = 0;
                 bytes_read += rsps_buf_index;
                 rsps_buf_index = 0;
-                while(line_start < bytes_read)
+                rspsStarted = true;
+                while(line_start < bytes_read && !response_complete)
                 {
                     //////////////////////////
                     // Process Headers
@@ -376,6 +617,26 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                                         chunk_encoding = true;
                                     }
                                 }
+                                /* Process Content Encoding Header */
+                                else if(StringLib::match(hdr.key, "content-encoding"))
+                                {
+                                    if(hdr.value && StringLib::match(hdr.value, "gzip") && !gzip)
+                                    {
+                                        gzip = new GzipStream(GzipStream::INFLATE);
+                                    }
+                                    else if(hdr.value && !StringLib::match(hdr.value, "identity"))
+                                    {
+                                        throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported content encoding: %s", hdr.value);
+                                    }
+                                }
+                                /* Process Connection Header */
+                                else if(StringLib::match(hdr.key, "connection"))
+                                {
+                                    if(hdr.value && StringLib::match(hdr.value, "close"))
+                                    {
+                                        connection_close = true;
+                                    }
+                                }
                             }
 
                             /* Go To Next Header */
@@ -387,6 +648,12 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                             line_start += 2; // move past header delimeter
                             line_term = line_start;
                             headers_complete = true;
+
+                            /* Check for Empty Body */
+                            if(!chunk_encoding && !unbounded_content && content_remaining == 0)
+                            {
+                                response_complete = true;
+                            }
                         }
                         else // header line not complete (line_term == 0)
                         {
@@ -408,6 +675,7 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                             if(StringLib::str2long(chunk_length_str, &chunk_remaining, 16))
                             {
                                 rsps.size = chunk_remaining;
+                                last_chunk = (chunk_remaining == 0);
                                 chunk_header_complete = true;
                                 chunk_payload_complete = false;
                                 line_start = line_term;
@@ -495,6 +763,21 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                         /* Post Completed Chunk */
                         if(chunk_remaining <= 0)
                         {
+                            /* Decompress Chunk - each chunk is flushed whole by the sender */
+                            if(gzip && rsps.size > 0)
+                            {
+                                const uint8_t* inflated = NULL;
+                                long inflated_size = gzip->inflate(rsps.response, rsps.size, &inflated);
+                                delete [] rsps.response;
+                                rsps.response = NULL;
+                                rsps.size = inflated_size;
+                                if(inflated_size > 0)
+                                {
+                                    rsps.response = new char [inflated_size];
+                                    LocalLib::copy(rsps.response, inflated, inflated_size);
+                                }
+                            }
+
                             int post_status = MsgQ::STATE_TIMEOUT;
                             while(rsps.size && active && post_status == MsgQ::STATE_TIMEOUT)
                             {
@@ -529,6 +812,10 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                             chunk_header_complete = false;
                             line_start += 2;
                             line_term = line_start;
+                            if(last_chunk)
+                            {
+                                response_complete = true;
+                            }
                         }
                         else if(line_term > 0) // chunk invalid
                         {
@@ -550,11 +837,19 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
                         throw RunTimeException(CRITICAL, RTE_ERROR, "invalid http parsing state");
                     }
                 }
+
+                /* Hold On to Start of Next Pipelined Response */
+                if(response_complete && line_start < bytes_read)
+                {
+                    rspsLeftover = bytes_read - line_start;
+                    LocalLib::move(&rspsBuf[0], &rspsBuf[line_start], rspsLeftover);
+                }
             }
             else if((bytes_read == SHUTDOWN_RC) && headers_complete && unbounded_content)
             {
                 rsps.size = rsps_index;
                 response_complete = true;
+                connection_close = true;
             }
             else if(bytes_read != TIMEOUT_RC)
             {
@@ -566,8 +861,37 @@ HttpClient::rsps_t HttpClient::parseResponse (Publisher* outq, int timeout)
     {
         mlog(CRITICAL, "Failed to process response: %s", e.what());
         rsps.code = EndpointObject::Internal_Server_Error;
+        response_complete = false;
     }
 
+    /* Decompress Whole Response */
+    if(gzip && response_complete && !chunk_encoding && rsps.response)
+    {
+        try
+        {
+            const uint8_t* inflated = NULL;
+            long inflated_size = gzip->inflate(rsps.response, rsps.size, &inflated);
+            delete [] rsps.response;
+            rsps.response = new char [inflated_size + 1]; // add one byte for terminator
+            LocalLib::copy(rsps.response, inflated, inflated_size);
+            rsps.response[inflated_size] = '\0';
+            rsps.size = inflated_size;
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(CRITICAL, "Failed to decompress response: %s", e.what());
+            delete [] rsps.response;
+            rsps.response = NULL;
+            rsps.code = EndpointObject::Internal_Server_Error;
+            response_complete = false;
+        }
+    }
+    delete gzip;
+
+    /* Determine if Connection Can Carry Another Request */
+    reusable = response_complete && !connection_close && sock->isConnected();
+    if(!reusable) rspsLeftover = 0;
+
     /* Return Response */
     return rsps;
 }
@@ -39,6 +39,7 @@
 #include "MsgQ.h"
 #include "OsApi.h"
 #include "List.h"
+#include "Dictionary.h"
 #include "StringLib.h"
 #include "TcpSocket.h"
 #include "LuaEngine.h"
@@ -63,6 +64,8 @@ class HttpClient: public LuaObject
         static const int MAX_URL_LEN        = 1024;
         static const int MAX_TIMEOUTS       = 5;
         static const int MAX_DIGITS         = 10;
+        static const int MAX_POOLED_CLIENTS = 32; // idle keep-alive connections held per url
+        static const int DIRECT_READ_SIZE   = 0x10000; // 64K, passthru chunk payloads left larger than this bypass the response buffer
 
         static const char* OBJECT_TYPE;
         static const char* LuaMetaName;
@@ -82,13 +85,18 @@ class HttpClient: public LuaObject
          * Methods
          *--------------------------------------------------------------------*/
 
+        static void     deinit          (void);
         static int      luaCreate       (lua_State* L);
+        static HttpClient* acquire      (const char* url);
+        static void     release         (HttpClient* client);
 
                         HttpClient      (lua_State* L, const char* _ip_addr, int _port);
                         HttpClient      (lua_State* L, const char* url);
                         ~HttpClient     (void);
 
-        rsps_t          request         (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, Publisher* outq, int timeout=SYS_TIMEOUT);
+        rsps_t          request         (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, Publisher* outq, int timeout=SYS_TIMEOUT, bool passthru=false);
+        bool            pipeline        (EndpointObject::verb_t verb, const char* resource, const char* data);
+        rsps_t          response        (Publisher* outq, int timeout=SYS_TIMEOUT);
         const char*     getIpAddr       (void);
         int             getPort         (void);
 
@@ -119,6 +127,9 @@ class HttpClient: public LuaObject
          * Data
          *--------------------------------------------------------------------*/
 
+        static Mutex                            poolMut;
+        static Dictionary<List<HttpClient*>*>   clientPool; // idle connections by url
+
         bool                            active;
         Thread*                         requestPid;
         Publisher*                      requestPub;
@@ -127,14 +138,23 @@ class HttpClient: public LuaObject
         int                             port;
         char                            rqstBuf[MAX_RQST_BUF_LEN];
         char                            rspsBuf[MAX_RSPS_BUF_LEN];
+        int                             rspsLeftover;       // bytes of the next pipelined response already read
+        bool                            rspsStarted;        // bytes of the current response have been received
+        int                             pendingResponses;   // pipelined requests sent but not yet read
+        long                            numRequests;        // requests made on the current connection
+        bool                            keepAlive;          // last request asked for the connection to be kept
+        bool                            reusable;           // connection can carry another request
+        char*                           poolUrl;            // pool key, NULL if created from ip address and port
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
         TcpSocket*      initializeSocket    (const char* _ip_addr, int _port);
-        bool            makeRequest         (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive);
-        rsps_t          parseResponse       (Publisher* outq, int timeout);
+        void            initializeState     (void);
+        void            reconnect           (void);
+        bool            makeRequest         (EndpointObject::verb_t verb, const char* resource, const char* data, bool keep_alive, bool accept_gzip=true);
+        rsps_t          parseResponse       (Publisher* outq, int timeout, bool passthru=false);
         long            parseLine           (int start, int end);
         status_line_t   parseStatusLine     (int start, int term);
         hdr_kv_t        parseHeaderLine     (int start, int term);
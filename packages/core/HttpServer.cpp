@@ -34,10 +34,47 @@
  ******************************************************************************/
 
 #include <atomic>
+#include <sys/uio.h>
 
 #include "HttpServer.h"
 #include "core.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * scanFor - returns the first occurrence of the character before the end,
+ *           or the end if not found; 16 bytes are compared at a time
+ *----------------------------------------------------------------------------*/
+static inline const char* scanFor (const char* p, const char* end, char c)
+{
+#if defined(__SSE2__)
+    const __m128i target = _mm_set1_epi8(c);
+    for(; p + 16 <= end; p += 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), target));
+        if(mask) return p + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t target = vdupq_n_u8((uint8_t)c);
+    for(; p + 16 <= end; p += 16)
+    {
+        uint8x16_t eq = vceqq_u8(vld1q_u8((const uint8_t*)p), target);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0); // 4 bits per byte
+        if(mask) return p + (__builtin_ctzll(mask) >> 2);
+    }
+#endif
+    while(p < end && *p != c) p++;
+    return p;
+}
+
 /******************************************************************************
  * STATIC DATA
  ******************************************************************************/
@@ -49,6 +86,8 @@ const char* HttpServer::LuaMetaName = "HttpServer";
 const struct luaL_Reg HttpServer::LuaMetaTable[] = {
     {"attach",      luaAttach},
     {"metric",      luaMetric},
+    {"zerocopy",    luaZeroCopy},
+    {"compress",    luaCompress},
     {"untilup",     luaUntilUp},
     {NULL,          NULL}
 };
@@ -60,7 +99,7 @@ std::atomic<uint64_t> HttpServer::requestId{0};
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - server(<ip_addr>, <port>, [<max connections>])
+ * luaCreate - server(<ip_addr>, <port>, [<max connections>], [<num threads>])
  *----------------------------------------------------------------------------*/
 int HttpServer::luaCreate (lua_State* L)
 {
@@ -70,6 +109,11 @@ int HttpServer::luaCreate (lua_State* L)
         int         port            = (int)getLuaInteger(L, 1);
         const char* ip_addr         = getLuaString(L, 2, true, NULL);
         int         max_connections = (int)getLuaInteger(L, 3, true, DEFAULT_MAX_CONNECTIONS);
+        int         num_threads     = (int)getLuaInteger(L, 4, true, DEFAULT_NUM_THREADS);
+
+        /* Check Parameters */
+        if(max_connections <= 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid maximum number of connections: %d", max_connections);
+        if(num_threads <= 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid number of threads: %d", num_threads);
 
         /* Get Server Parameter */
         if( ip_addr && (StringLib::match(ip_addr, "0.0.0.0") || StringLib::match(ip_addr, "*")) )
@@ -78,7 +122,7 @@ int HttpServer::luaCreate (lua_State* L)
         }
 
         /* Return File Device Object */
-        return createLuaObject(L, new HttpServer(L, ip_addr, port, max_connections));
+        return createLuaObject(L, new HttpServer(L, ip_addr, port, max_connections, num_threads));
     }
     catch(const RunTimeException& e)
     {
@@ -90,18 +134,31 @@ int HttpServer::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-HttpServer::HttpServer(lua_State* L, const char* _ip_addr, int _port, int max_connections):
+HttpServer::HttpServer(lua_State* L, const char* _ip_addr, int _port, int max_connections, int num_threads):
     LuaObject(L, OBJECT_TYPE, LuaMetaName, LuaMetaTable),
-    connections(max_connections)
+    connections(MAX(max_connections, num_threads))
 {
     ipAddr = StringLib::duplicate(_ip_addr);
     port = _port;
 
+    zeroCopySize = 0;
+    compressLevel = 0;
+    metricId = EventLib::INVALID_METRIC;
+    writeLatency = NULL;
+
+    numThreads = num_threads;
+    maxConnections = max_connections;
+
     active = true;
     listening = false;
-    listenerPid = new Thread(listenerThread, this);
-
-    metricId = EventLib::INVALID_METRIC;
+    /* Start Listeners - spread across the numa nodes when requests are placed by node */
+    listenerPids = new Thread* [numThreads];
+    bool spread = Thread::getPlacement() == Thread::PLACE_NODE;
+    for(int t = 0; t < numThreads; t++)
+    {
+        Thread::attr_t attr = {.name = "http.listener", .node = spread ? Thread::nextNode() : Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+        listenerPids[t] = new Thread(listenerThread, this, attr);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -110,9 +167,11 @@ HttpServer::HttpServer(lua_State* L, const char* _ip_addr, int _port, int max_co
 HttpServer::~HttpServer(void)
 {
     active = false;
-    delete listenerPid;
+    for(int t = 0; t < numThreads; t++) delete listenerPids[t];
+    delete [] listenerPids;
 
     if(ipAddr) delete [] ipAddr;
+    if(writeLatency) delete writeLatency;
 
     EndpointObject* endpoint;
     const char* key = routeTable.first(&endpoint);
@@ -158,10 +217,12 @@ void HttpServer::initConnection (connection_t* connection)
     LocalLib::set(&connection->rsps_state, 0, sizeof(rsps_state_t));
     connection->start_time = TimeLib::latchtime();
     connection->keep_alive = false;
+    connection->accept_gzip = false;
     connection->id = new char [REQUEST_ID_LEN];
     StringLib::format(connection->id, REQUEST_ID_LEN, "%s.%ld", getName(), cnt);
     connection->rsps_state.rspq = new Subscriber(connection->id);
     connection->request = new EndpointObject::Request(connection->id);
+    connection->zc_pending = NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -169,17 +230,27 @@ void HttpServer::initConnection (connection_t* connection)
  *----------------------------------------------------------------------------*/
 void HttpServer::deinitConnection (connection_t* connection)
 {
-    /* Free Stream Buffer */
-    if(connection->rsps_state.stream_buf) delete [] connection->rsps_state.stream_buf;
-
     /* Free Message Queue */
     if(connection->rsps_state.ref_status > 0)
     {
         connection->rsps_state.rspq->dereference(connection->rsps_state.ref);
         connection->rsps_state.ref_status = 0;
     }
+    if(connection->zc_pending)
+    {
+        for(int i = 0; i < connection->zc_pending->length(); i++)
+        {
+            connection->rsps_state.rspq->dereference(connection->zc_pending->get(i).ref);
+        }
+        delete connection->zc_pending;
+        connection->zc_pending = NULL;
+    }
     delete connection->rsps_state.rspq;
 
+    /* Free Compression State */
+    delete connection->rsps_state.gzip;
+    delete [] connection->rsps_state.zheader;
+
     /* Free Id */
     delete [] connection->id;
 
@@ -187,12 +258,42 @@ void HttpServer::deinitConnection (connection_t* connection)
     if(connection->request) delete connection->request;
 }
 
+/*----------------------------------------------------------------------------
+ * getConnection
+ *----------------------------------------------------------------------------*/
+HttpServer::connection_t* HttpServer::getConnection (int fd)
+{
+    connMutex.lock();
+    connection_t* connection = connections[fd];
+    connMutex.unlock();
+    return connection;
+}
+
+/*----------------------------------------------------------------------------
+ * reapZeroCopy
+ *
+ *  releases the refs whose zerocopy sends the kernel has finished with
+ *----------------------------------------------------------------------------*/
+void HttpServer::reapZeroCopy (int fd, connection_t* connection)
+{
+    if(!connection->zc_pending || connection->zc_pending->length() == 0) return;
+
+    SockLib::sockzcreap(fd, &connection->zc_completed);
+    while(connection->zc_pending->length() > 0)
+    {
+        zc_ref_t& pending = connection->zc_pending->get(0);
+        if((int32_t)(connection->zc_completed - pending.last_id) <= 0) break; // still in flight
+        connection->rsps_state.rspq->dereference(pending.ref);
+        connection->zc_pending->remove(0);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * extractPath
  *
- *  Note: must delete returned strings
+ *  Note: returned strings are owned by the arena
  *----------------------------------------------------------------------------*/
-void HttpServer::extractPath (const char* url, const char** path, const char** resource)
+void HttpServer::extractPath (const char* url, const char** path, const char** resource, StringLib::Arena& arena)
 {
     const char* src;
     char* dst;
@@ -208,7 +309,7 @@ void HttpServer::extractPath (const char* url, const char** path, const char** r
         {
             /* Get Endpoint */
             int path_len = second_slash - first_slash + 1; // this includes null terminator and slash
-            dst = new char[path_len];
+            dst = (char*)arena.alloc(path_len);
             src = first_slash ; // include the slash
             *path = dst;
             while(src < second_slash) *dst++ = *src++;
@@ -219,7 +320,7 @@ void HttpServer::extractPath (const char* url, const char** path, const char** r
             if(terminator)
             {
                 int resource_len = terminator - second_slash; // this includes null terminator
-                dst = new char[resource_len];
+                dst = (char*)arena.alloc(resource_len);
                 src = second_slash + 1; // do NOT include the slash
                 *resource = dst;
                 while(src < terminator) *dst++ = *src++;
@@ -231,65 +332,84 @@ void HttpServer::extractPath (const char* url, const char** path, const char** r
 
 /*----------------------------------------------------------------------------
  * processHttpHeader
+ *
+ *  Notes: the header is copied once into the request's arena and parsed in
+ *         place; header fields are recorded as views into the copy, with
+ *         each value terminated where its line ends, so no header is
+ *         allocated or copied individually
  *----------------------------------------------------------------------------*/
-bool HttpServer::processHttpHeader (char* buf, EndpointObject::Request* request)
+bool HttpServer::processHttpHeader (const char* buf, int len, EndpointObject::Request* request)
 {
-    bool status = true;
-
-    /* Parse Request */
-    SafeString http_header("%s", buf);
-    List<SafeString>* header_list = http_header.split('\r');
+    /* Copy Header into Request */
+    char* hdr = (char*)request->arena.alloc(len + 1);
+    LocalLib::copy(hdr, buf, len);
+    hdr[len] = '\0';
+    const char* end = hdr + len;
 
     /* Parse Request Line */
-    try
+    char* line_end = (char*)scanFor(hdr, end, '\r');
+    *line_end = '\0';
+    char* verb_str = hdr;
+    char* url_str = (char*)scanFor(verb_str, line_end, ' ');
+    if(url_str == line_end)
     {
-        List<SafeString>* request_line = (*header_list)[0].split(' ');
-        const char* verb_str = (*request_line)[0].getString();
-        const char* url_str = (*request_line)[1].getString();
+        mlog(CRITICAL, "Invalid request line: %s", hdr);
+        return false;
+    }
+    *url_str++ = '\0';
+    char* version_str = (char*)scanFor(url_str, line_end, ' ');
+    *version_str = '\0';
 
-        /* Get Verb */
-        request->verb = EndpointObject::str2verb(verb_str);
+    /* Get Verb */
+    request->verb = EndpointObject::str2verb(verb_str);
 
-        /* Get Endpoint and URL */
-        extractPath(url_str, &request->path, &request->resource);
-        if(!request->path || !request->resource)
-        {
-            mlog(CRITICAL, "Unable to extract endpoint and url: %s", url_str);
-            status = false;
-        }
-
-        /* Clean Up Allocated Memory */
-        delete request_line;
-    }
-    catch(const RunTimeException& e)
+    /* Get Endpoint and URL */
+    extractPath(url_str, &request->path, &request->resource, request->arena);
+    if(!request->path || !request->resource)
     {
-        mlog(e.level(), "Invalid request line: %s", e.what());
+        mlog(CRITICAL, "Unable to extract endpoint and url: %s", url_str);
+        return false;
     }
 
     /* Parse Headers */
-    for(int h = 1; h < header_list->length(); h++)
+    char* line = line_end + 1;
+    while(line < end)
     {
-        /* Create Key/Value Pairs */
-        List<SafeString>* keyvalue_list = (*header_list)[h].split(':');
-        try
+        if(*line == '\n') line++;
+        line_end = (char*)scanFor(line, end, '\r');
+        if(line_end == line) break;
+
+        /* Split Key and Value */
+        char* colon = (char*)scanFor(line, line_end, ':');
+        if(colon == line_end)
         {
-            char* key = (char*)(*keyvalue_list)[0].getString();
-            const char* value = (*keyvalue_list)[1].getString(true);
-            StringLib::convertLower(key);
-            request->headers.add(key, value, true);
+            mlog(ERROR, "Invalid header in http request: %.*s", (int)(line_end - line), line);
         }
-        catch(const RunTimeException& e)
+        else if(request->num_headers >= EndpointObject::MAX_HEADER_FIELDS)
         {
-            mlog(e.level(), "Invalid header in http request: %s: %s", (*header_list)[h].getString(), e.what());
+            mlog(ERROR, "Too many headers in http request, dropping: %.*s", (int)(line_end - line), line);
+        }
+        else
+        {
+            /* Trim Whitespace from Value */
+            char* value = colon + 1;
+            char* value_end = line_end;
+            while(value < value_end && (*value == ' ' || *value == '\t')) value++;
+            while(value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) value_end--;
+            *value_end = '\0';
+
+            /* Record Field */
+            EndpointObject::Request::header_t* field = &request->headers[request->num_headers++];
+            field->key = line;
+            field->key_len = colon - line;
+            field->value = value;
+            field->value_len = value_end - value;
         }
-        delete keyvalue_list;
-    }
 
-    /* Clean Up Header List */
-    delete header_list;
+        line = line_end + 1;
+    }
 
-    /* Return Status */
-    return status;
+    return true;
 }
 
 /*----------------------------------------------------------------------------
@@ -302,7 +422,9 @@ void* HttpServer::listenerThread(void* parm)
     while(s->active)
     {
         /* Start Http Server */
-        int status = SockLib::startserver(s->getIpAddr(), s->getPort(), DEFAULT_MAX_CONNECTIONS, pollHandler, activeHandler, &s->active, (void*)s, &(s->listening));
+        int max_connections = MAX(s->maxConnections / s->numThreads, 1); // per thread
+        bool reuse_port = s->numThreads > 1;
+        int status = SockLib::startepollserver(s->getIpAddr(), s->getPort(), max_connections, pollHandler, activeHandler, &s->active, (void*)s, &(s->listening), reuse_port);
         if(status < 0)
         {
             mlog(CRITICAL, "Http server on %s:%d returned error: %d", s->getIpAddr(), s->getPort(), status);
@@ -330,7 +452,7 @@ int HttpServer::pollHandler(int fd, short* events, void* parm)
     HttpServer* s = (HttpServer*)parm;
 
     /* Get Connection */
-    connection_t* connection = s->connections[fd];
+    connection_t* connection = s->getConnection(fd);
     rsps_state_t* state = &connection->rsps_state;
 
     /* Set Read Polling Flag (if request is ready) */
@@ -372,7 +494,7 @@ int HttpServer::activeHandler(int fd, int flags, void* parm)
 int HttpServer::onRead(int fd)
 {
     int status = 0;
-    connection_t* connection = connections[fd];
+    connection_t* connection = getConnection(fd);
     rqst_state_t* state = &connection->rqst_state;
 
 
@@ -411,92 +533,126 @@ int HttpServer::onRead(int fd)
             state->body_size += bytes;
         }
 
-        /* Look Through Existing Header Received */
-        while(!state->header_complete && (state->header_index <= (state->header_size - 4)))
+        /* Process Request */
+        if(processRequest(connection) < 0)
         {
-            /* If Header Complete (look for \r\n\r\n separator) */
-            if( (state->header_buf[state->header_index + 0] == '\r') &&
-                (state->header_buf[state->header_index + 1] == '\n') &&
-                (state->header_buf[state->header_index + 2] == '\r') &&
-                (state->header_buf[state->header_index + 3] == '\n') )
-            {
-                state->header_buf[state->header_index] = '\0';
-                state->header_complete = true;
-                state->header_index += 4;
+            status = INVALID_RC; // will close socket
+        }
+    }
+    else
+    {
+        /* Failed to receive data on socket that was marked for reading */
+        status = INVALID_RC; // will close socket
+    }
 
-                /* Process HTTP Header */
-                if(processHttpHeader(state->header_buf, connection->request))
-                {
-                    /* Get Content Length */
-                    try
-                    {
-                        if(StringLib::str2long(connection->request->headers["content-length"], &connection->request->length))
-                        {
-                            /* Allocate and Prepopulate Request Body */
-                            connection->request->body = new uint8_t[connection->request->length + 1];
-                            connection->request->body[connection->request->length] = '\0';
-                            int bytes_to_copy = state->header_size - state->header_index;
-                            LocalLib::copy(connection->request->body, &state->header_buf[state->header_index], bytes_to_copy);
-                            state->body_size += bytes_to_copy;
-                        }
-                        else
-                        {
-                            mlog(CRITICAL, "Invalid Content-Length header: %s", connection->request->headers["content-length"]);
-                            status = INVALID_RC; // will close socket
-                        }
-                    }
-                    catch(const RunTimeException& e)
-                    {
-                        connection->request->length = 0;
-                    }
+    return status;
+}
 
-                    /* Get Keep Alive Setting */
-                    try
+/*----------------------------------------------------------------------------
+ * processRequest
+ *
+ *  Notes: parses what has been received of the request and hands it to the
+ *         endpoint once complete; bytes received past the end of the request
+ *         are the start of the next one (pipelined on a keep-alive connection)
+ *         and are left at the front of the header buffer
+ *----------------------------------------------------------------------------*/
+int HttpServer::processRequest(connection_t* connection)
+{
+    int status = 0;
+    rqst_state_t* state = &connection->rqst_state;
+
+    /* Look Through Existing Header Received */
+    while(!state->header_complete && (state->header_index <= (state->header_size - 4)))
+    {
+        /* Skip to Next Carriage Return */
+        const char* cr = scanFor(&state->header_buf[state->header_index], &state->header_buf[state->header_size - 3], '\r');
+        state->header_index = cr - state->header_buf;
+        if(state->header_index > (state->header_size - 4)) break;
+
+        /* If Header Complete (look for \r\n\r\n separator) */
+        if( (state->header_buf[state->header_index + 0] == '\r') &&
+            (state->header_buf[state->header_index + 1] == '\n') &&
+            (state->header_buf[state->header_index + 2] == '\r') &&
+            (state->header_buf[state->header_index + 3] == '\n') )
+        {
+            int header_len = state->header_index;
+            state->header_complete = true;
+            state->header_index += 4;
+
+            /* Process HTTP Header */
+            if(processHttpHeader(state->header_buf, header_len, connection->request))
+            {
+                /* Get Content Length */
+                const char* content_length = NULL;
+                if(connection->request->getHeader("content-length", &content_length))
+                {
+                    if(StringLib::str2long(content_length, &connection->request->length))
                     {
-                        if(StringLib::match(connection->request->headers["connection"], "keep-alive"))
-                        {
-                            connection->keep_alive = true;
-                        }
+                        /* Allocate and Prepopulate Request Body */
+                        connection->request->body = new uint8_t[connection->request->length + 1];
+                        connection->request->body[connection->request->length] = '\0';
+                        int bytes_to_copy = MIN(state->header_size - state->header_index, connection->request->length);
+                        LocalLib::copy(connection->request->body, &state->header_buf[state->header_index], bytes_to_copy);
+                        state->body_size += bytes_to_copy;
                     }
-                    catch(const RunTimeException& e)
+                    else
                     {
-                        connection->keep_alive = false;
+                        mlog(CRITICAL, "Invalid Content-Length header: %s", content_length);
+                        status = INVALID_RC; // will close socket
                     }
                 }
                 else
                 {
-                    status = INVALID_RC; // will close socket
+                    connection->request->length = 0;
+                }
+
+                /* Get Keep Alive Setting */
+                const char* connection_hdr = NULL;
+                connection->keep_alive = connection->request->getHeader("connection", &connection_hdr) && StringLib::match(connection_hdr, "keep-alive");
+
+                /* Get Accepted Encodings */
+                const char* accept_encoding = NULL;
+                if(connection->request->getHeader("accept-encoding", &accept_encoding))
+                {
+                    connection->accept_gzip = StringLib::find(accept_encoding, "gzip") != NULL;
                 }
             }
             else
             {
-                /* Go to Next Character in Header */
-                state->header_index++;
+                status = INVALID_RC; // will close socket
             }
         }
-
-        /* Check If Body Complete */
-        if(state->header_complete && (state->body_size >= connection->request->length) && (status >= 0))
+        else
         {
-            /* Handle Request */
-            try
-            {
-                EndpointObject* endpoint = routeTable[connection->request->path];
-                connection->response_type = endpoint->handleRequest(connection->request);
-                connection->request = NULL; // no longer owned by HttpServer, owned by EndpointObject
-                LocalLib::set(&connection->rqst_state, 0, sizeof(rqst_state_t));
-            }
-            catch(const RunTimeException& e)
-            {
-                mlog(e.level(), "No attached endpoint at %s: %s", connection->request->path, e.what());
-                status = INVALID_RC; // will close socket
-            }
+            /* Go to Next Character in Header */
+            state->header_index++;
         }
     }
-    else
+
+    /* Check If Body Complete */
+    if(state->header_complete && (state->body_size >= connection->request->length) && (status >= 0))
     {
-        /* Failed to receive data on socket that was marked for reading */
-        status = INVALID_RC; // will close socket
+        /* Locate Start of Next Request */
+        int next_start = state->header_index + connection->request->length;
+        int next_size = MAX(state->header_size - next_start, 0);
+
+        /* Handle Request */
+        try
+        {
+            EndpointObject* endpoint = routeTable[connection->request->path];
+            connection->response_type = endpoint->handleRequest(connection->request);
+            connection->request = NULL; // no longer owned by HttpServer, owned by EndpointObject
+            if(next_size > 0) LocalLib::move(&state->header_buf[0], &state->header_buf[next_start], next_size);
+            state->header_index = 0;
+            state->header_size = next_size;
+            state->header_complete = false;
+            state->body_size = 0;
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "No attached endpoint at %s: %s", connection->request->path, e.what());
+            status = INVALID_RC; // will close socket
+        }
     }
 
     return status;
@@ -510,7 +666,7 @@ int HttpServer::onRead(int fd)
 int HttpServer::onWrite(int fd)
 {
     int status = 0;
-    connection_t* connection = connections[fd];
+    connection_t* connection = getConnection(fd);
     rsps_state_t* state = &connection->rsps_state;
     bool ref_complete = false;
 
@@ -520,83 +676,87 @@ int HttpServer::onWrite(int fd)
     /* If Something to Send */
     if(state->ref_status > 0)
     {
-        if(state->header_sent && connection->response_type == EndpointObject::STREAMING) /* Setup Streaming */
+        LatencyHistogram::Sample sample(writeLatency);
+
+        if(state->header_sent && connection->response_type == EndpointObject::STREAMING) /* Send Chunk */
         {
-            /* Allocate Streaming Buffer (if necessary) */
-            if(state->ref.size + STREAM_OVERHEAD_SIZE > state->stream_mem_size)
+            /* Select Chunk Data - compressed data ends the gzip stream with the last chunk */
+            const void* data = state->ref.data;
+            int data_size = state->ref.size > 0 ? state->ref.size : 0;
+            const char* trailer = "\r\n";
+            int trailer_size = 2;
+            if(state->gzip)
             {
-                /* Delete Old Buffer */
-                if(state->stream_buf) delete [] state->stream_buf;
-
-                /* Allocate New Buffer */
-                state->stream_mem_size = state->ref.size + STREAM_OVERHEAD_SIZE;
-                state->stream_buf = new uint8_t [state->stream_mem_size];
+                if(state->chunk_header_size == 0)
+                {
+                    try
+                    {
+                        state->zsize = state->gzip->deflate(state->ref.data, data_size, state->ref.size == 0, &state->zdata);
+                    }
+                    catch(const RunTimeException& e)
+                    {
+                        mlog(e.level(), "Failed to compress response %s: %s", connection->id, e.what());
+                        return INVALID_RC; // will close socket
+                    }
+                }
+                data = state->zdata;
+                data_size = (int)state->zsize;
+                if(state->ref.size == 0)
+                {
+                    trailer = "\r\n0\r\n\r\n";
+                    trailer_size = 7;
+                }
             }
 
-            /* Build Stream Buffer */
-            if(state->stream_buf_size == 0)
+            /* Build Chunk Header - HTTP */
+            if(state->chunk_header_size == 0)
             {
-                /* Write Chunk Header - HTTP */
-                unsigned long chunk_size = state->ref.size > 0 ? state->ref.size : 0;
-                StringLib::format((char*)state->stream_buf, STREAM_OVERHEAD_SIZE, "%lX\r\n", chunk_size);
-                state->stream_buf_size = StringLib::size((const char*)state->stream_buf, state->stream_mem_size);
+                unsigned long chunk_size = data_size;
+                StringLib::format(state->chunk_header, CHUNK_HEADER_SIZE, "%lX\r\n", chunk_size);
+                state->chunk_header_size = StringLib::size(state->chunk_header, CHUNK_HEADER_SIZE);
+            }
 
-                if(state->ref.size > 0)
+            /* Gather Header, Message Data (in place), and Trailer */
+            struct iovec iov[3];
+            int iovcnt = 0;
+            int skip = state->chunk_index;
+            const int chunk_total = state->chunk_header_size + data_size + trailer_size;
+            struct { const void* base; int len; } segments[3] = {
+                {state->chunk_header, state->chunk_header_size},
+                {data, data_size},
+                {trailer, trailer_size}
+            };
+            for(int seg = 0; seg < 3; seg++)
+            {
+                if(skip >= segments[seg].len)
                 {
-                    /* Write Message Data */
-                    LocalLib::copy(&state->stream_buf[state->stream_buf_size], state->ref.data, state->ref.size);
-                    state->stream_buf_size += state->ref.size;
+                    skip -= segments[seg].len;
+                    continue;
                 }
-
-                /* Write Chunk Trailer - HTTP */
-                StringLib::format((char*)&state->stream_buf[state->stream_buf_size], STREAM_OVERHEAD_SIZE, "\r\n");
-                state->stream_buf_size += 2;
+                iov[iovcnt].iov_base = (uint8_t*)segments[seg].base + skip;
+                iov[iovcnt].iov_len = segments[seg].len - skip;
+                iovcnt++;
+                skip = 0;
             }
 
-            /* Setup Write State */
-            buffer = &state->stream_buf[state->stream_buf_index];
-            bytes_left = state->stream_buf_size - state->stream_buf_index;
-        }
-        else /* Setup Normal */
-        {
-            /* Setup Write State */
-            buffer = ((uint8_t*)state->ref.data) + state->ref_index;
-            bytes_left = state->ref.size - state->ref_index;
-        }
-
-        /* If Anything Left to Send */
-        if(bytes_left > 0)
-        {
-            /* Write Data to Socket */
-            int bytes = SockLib::socksend(fd, buffer, bytes_left, IO_CHECK);
+            /* Write Chunk to Socket */
+            bool zerocopy = connection->zerocopy && !connection->keep_alive && !state->gzip && (data_size >= zeroCopySize);
+            int bytes = SockLib::socksendv(fd, iov, iovcnt, zerocopy);
             if(bytes >= 0)
             {
-                /* Update Status */
+                /* Update Streaming Write State */
                 status += bytes;
-
-                /* Update Write State */
-                if(state->header_sent && connection->response_type == EndpointObject::STREAMING)
+                if(zerocopy && bytes > 0)
                 {
-                    /* Update Streaming Write State */
-                    state->stream_buf_index += bytes;
-                    if(state->stream_buf_index == state->stream_buf_size)
-                    {
-                        state->stream_buf_index = 0;
-                        state->stream_buf_size = 0;
-                        ref_complete = true;
-                    }
+                    connection->zc_issued++;
+                    state->ref_zerocopy = true;
                 }
-                else
+                state->chunk_index += bytes;
+                if(state->chunk_index == chunk_total)
                 {
-                    /* Update Normal Write State
-                    *  note that this code will be executed once for the
-                    *  header of a streaming write as well */
-                    state->ref_index += bytes;
-                    if(state->ref_index == state->ref.size)
-                    {
-                        state->header_sent = true;
-                        ref_complete = true;
-                    }
+                    state->chunk_index = 0;
+                    state->chunk_header_size = 0;
+                    ref_complete = true;
                 }
             }
             else
@@ -605,6 +765,45 @@ int HttpServer::onWrite(int fd)
                 status = INVALID_RC; // will close socket
             }
         }
+        else /* Send Normal (also the header of a streaming response) */
+        {
+            /* Start Compressed Stream */
+            if(!state->header_sent && connection->response_type == EndpointObject::STREAMING && state->ref_index == 0)
+            {
+                startCompression(connection);
+            }
+
+            uint8_t* data = (uint8_t*)state->ref.data;
+            int data_size = state->ref.size;
+            if(state->zheader)
+            {
+                data = (uint8_t*)state->zheader;
+                data_size = state->zheader_size;
+            }
+            buffer = data + state->ref_index;
+            bytes_left = data_size - state->ref_index;
+            if(bytes_left > 0)
+            {
+                /* Write Data to Socket */
+                int bytes = SockLib::socksend(fd, buffer, bytes_left, IO_CHECK);
+                if(bytes >= 0)
+                {
+                    /* Update Normal Write State */
+                    status += bytes;
+                    state->ref_index += bytes;
+                    if(state->ref_index == data_size)
+                    {
+                        state->header_sent = true;
+                        ref_complete = true;
+                    }
+                }
+                else
+                {
+                    /* Failed to Write Ready Socket */
+                    status = INVALID_RC; // will close socket
+                }
+            }
+        }
 
         /* Check if Done with Entire Response
          *  a valid reference of size zero indicates that
@@ -619,24 +818,80 @@ int HttpServer::onWrite(int fd)
         /* Reset State */
         if(ref_complete)
         {
-            state->rspq->dereference(state->ref);
+            if(state->ref_zerocopy)
+            {
+                /* Hold Ref Until Kernel is Done Sending From It */
+                zc_ref_t pending = {state->ref, connection->zc_issued - 1};
+                if(!connection->zc_pending) connection->zc_pending = new List<zc_ref_t>;
+                connection->zc_pending->add(pending);
+                state->ref_zerocopy = false;
+            }
+            else
+            {
+                state->rspq->dereference(state->ref);
+            }
             state->ref_status = 0;
             state->ref_index = 0;
             state->ref.size = 0;
         }
 
+        /* Keep Socket Open Until Zerocopy Sends Complete (onAlive closes it) */
+        if(state->response_complete && connection->zc_pending && connection->zc_pending->length() > 0)
+        {
+            status = 0;
+        }
+
         /* Check for Keep Alive */
         if(state->response_complete && connection->keep_alive)
         {
             deinitConnection(connection);
             initConnection(connection);
             status = 0; // will keep socket open
+
+            /* Start Pipelined Request Already Received */
+            if(connection->rqst_state.header_size > 0)
+            {
+                status = processRequest(connection);
+            }
         }
     }
 
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * startCompression
+ *
+ *  a streamed response is compressed when the server has compression
+ *  enabled, the request accepts gzip, and the endpoint's header is for a
+ *  successful chunked response; the header is rewritten to announce it
+ *----------------------------------------------------------------------------*/
+void HttpServer::startCompression (connection_t* connection)
+{
+    rsps_state_t* state = &connection->rsps_state;
+    const char* header = (const char*)state->ref.data;
+    int header_size = state->ref.size;
+
+    if(compressLevel <= 0 || !connection->accept_gzip || header_size < 4) return;
+    if(header_size < 12 || !StringLib::match(header, "HTTP/1.1 200", 12)) return;
+    if(header[header_size - 4] != '\r' || header[header_size - 3] != '\n' || header[header_size - 2] != '\r' || header[header_size - 1] != '\n') return;
+
+    try
+    {
+        const char* encoding = "Content-Encoding: gzip\r\n\r\n";
+        int encoding_size = StringLib::size(encoding);
+        state->gzip = new GzipStream(GzipStream::DEFLATE, compressLevel);
+        state->zheader_size = header_size - 2 + encoding_size;
+        state->zheader = new char [state->zheader_size];
+        LocalLib::copy(state->zheader, header, header_size - 2);
+        LocalLib::copy(&state->zheader[header_size - 2], encoding, encoding_size);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Unable to compress response %s: %s", connection->id, e.what());
+    }
+}
+
 /*----------------------------------------------------------------------------
  * onAlive
  *
@@ -644,13 +899,20 @@ int HttpServer::onWrite(int fd)
  *----------------------------------------------------------------------------*/
 int HttpServer::onAlive(int fd)
 {
-    connection_t* connection = connections[fd];
+    connection_t* connection = getConnection(fd);
     rsps_state_t* state = &connection->rsps_state;
 
+    /* Release Completed Zerocopy Sends */
+    reapZeroCopy(fd, connection);
+
     if(!state->response_complete && state->ref_status <= 0)
     {
         state->ref_status = state->rspq->receiveRef(state->ref, IO_CHECK);
     }
+    else if(state->response_complete && connection->zc_pending && connection->zc_pending->length() == 0)
+    {
+        return INVALID_RC; // close socket held open for zerocopy sends
+    }
 
     return 0;
 }
@@ -669,8 +931,16 @@ int HttpServer::onConnect(int fd)
     initConnection(connection);
     LocalLib::set(&connection->rqst_state, 0, sizeof(rqst_state_t));
 
+    /* Enable Zerocopy Sends */
+    connection->zerocopy = (zeroCopySize > 0) && (SockLib::sockzerocopy(fd) == 0);
+    connection->zc_issued = 0;
+    connection->zc_completed = 0;
+
     /* Register Connection */
-    if(!connections.add(fd, connection, false))
+    connMutex.lock();
+    bool registered = connections.add(fd, connection, false);
+    connMutex.unlock();
+    if(!registered)
     {
         mlog(CRITICAL, "HTTP server at %s failed to register connection due to duplicate entry", connection->id);
         status = INVALID_RC; // will disconnect and free connection
@@ -688,7 +958,7 @@ int HttpServer::onDisconnect(int fd)
 {
     int status = 0;
 
-    connection_t* connection = connections[fd];
+    connection_t* connection = getConnection(fd);
 
     /* Update Metrics */
     if(metricId != EventLib::INVALID_METRIC)
@@ -698,7 +968,10 @@ int HttpServer::onDisconnect(int fd)
     }
 
     /* Remove Connection */
-    if(connections.remove(fd))
+    connMutex.lock();
+    bool removed = connections.remove(fd);
+    connMutex.unlock();
+    if(removed)
     {
         /* Free Connection */
         deinitConnection(connection);
@@ -764,6 +1037,7 @@ int HttpServer::luaMetric (lua_State* L)
         {
             throw RunTimeException(ERROR, RTE_ERROR, "Registry failed for %s.%s", obj_name, DURATION_METRIC);
         }
+        if(!lua_obj->writeLatency) lua_obj->writeLatency = new LatencyHistogram(obj_name, "write");
 
         /* Set return Status */
         status = true;
@@ -777,6 +1051,70 @@ int HttpServer::luaMetric (lua_State* L)
     return returnLuaStatus(L, status);
 }
 
+/*----------------------------------------------------------------------------
+ * luaZeroCopy - :zerocopy([<min chunk size>])
+ *
+ * Note: NOT thread safe, must be called before first request
+ *----------------------------------------------------------------------------*/
+int HttpServer::luaZeroCopy (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        HttpServer* lua_obj = (HttpServer*)getLuaSelf(L, 1);
+
+        /* Get Minimum Size of Chunks Sent With Zerocopy (zero disables) */
+        long zc_size = getLuaInteger(L, 2, true, DEFAULT_ZEROCOPY_SIZE);
+        if(zc_size < 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid zerocopy size: %ld", zc_size);
+        lua_obj->zeroCopySize = (int)zc_size;
+
+        /* Set return Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting zerocopy: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaCompress - :compress([<level>])
+ *
+ *  gzip streamed responses to clients that accept it; level 0 disables
+ *
+ * Note: NOT thread safe, must be called before first request
+ *----------------------------------------------------------------------------*/
+int HttpServer::luaCompress (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        HttpServer* lua_obj = (HttpServer*)getLuaSelf(L, 1);
+
+        /* Get Compression Level */
+        long level = getLuaInteger(L, 2, true, DEFAULT_COMPRESS_LEVEL);
+        if(level < 0 || level > 9) throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid compression level: %ld", level);
+        lua_obj->compressLevel = (int)level;
+
+        /* Set return Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting compression: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
 /*----------------------------------------------------------------------------
  * luaUntilUp - :untilup(<seconds to wait>)
  *----------------------------------------------------------------------------*/
@@ -44,6 +44,8 @@
 #include "StringLib.h"
 #include "LuaObject.h"
 #include "EndpointObject.h"
+#include "LatencyHistogram.h"
+#include "GzipStream.h"
 
 /******************************************************************************
  * HTTP SERVER CLASS
@@ -62,7 +64,10 @@ class HttpServer: public LuaObject
         static const int CONNECTION_TIMEOUT         = 5; // seconds
         static const int INITIAL_POLL_SIZE          = 16;
         static const int DEFAULT_MAX_CONNECTIONS    = 256;
-        static const int STREAM_OVERHEAD_SIZE       = 128; // chunk size, record size, and line breaks
+        static const int DEFAULT_NUM_THREADS        = 1; // more than one shards connections across threads on the same port
+        static const int CHUNK_HEADER_SIZE          = 32; // chunk size in hex and line break
+        static const int DEFAULT_ZEROCOPY_SIZE      = 0x10000; // 64KB, smallest chunk worth sending with MSG_ZEROCOPY
+        static const int DEFAULT_COMPRESS_LEVEL     = GzipStream::DEFAULT_LEVEL;
 
         static const char* DURATION_METRIC;
 
@@ -76,7 +81,7 @@ class HttpServer: public LuaObject
 
         static int          luaCreate       (lua_State* L);
 
-                            HttpServer      (lua_State* L, const char* _ip_addr, int _port, int max_connections);
+                            HttpServer      (lua_State* L, const char* _ip_addr, int _port, int max_connections, int num_threads=DEFAULT_NUM_THREADS);
                             ~HttpServer     (void);
 
         const char*         getIpAddr       (void);
@@ -103,20 +108,35 @@ class HttpServer: public LuaObject
             int                         ref_status;
             int                         ref_index;
             Subscriber*                 rspq;
-            uint8_t*                    stream_buf;
-            int                         stream_buf_index;
-            int                         stream_buf_size;
-            int                         stream_mem_size;
+            char                        chunk_header[CHUNK_HEADER_SIZE];
+            int                         chunk_header_size; // zero until the chunk of the current ref is started
+            int                         chunk_index; // bytes of the chunk (header, data, trailer) sent
+            bool                        ref_zerocopy; // current ref has zerocopy sends in flight
+            GzipStream*                 gzip; // set when the streamed response is compressed
+            const uint8_t*              zdata; // compressed data of the current ref, owned by gzip
+            long                        zsize;
+            char*                       zheader; // response header with content encoding added
+            int                         zheader_size;
         } rsps_state_t;
 
+        typedef struct {
+            Subscriber::msgRef_t        ref;
+            uint32_t                    last_id; // completion id of the last send from the ref
+        } zc_ref_t;
+
         typedef struct {
             char*                       id;
             rqst_state_t                rqst_state;
             rsps_state_t                rsps_state;
             double                      start_time;
             bool                        keep_alive;
+            bool                        accept_gzip; // request accepts a gzip content encoding
             EndpointObject::rsptype_t   response_type;
             EndpointObject::Request*    request;
+            bool                        zerocopy; // socket accepts MSG_ZEROCOPY sends
+            uint32_t                    zc_issued; // zerocopy sends made on the socket
+            uint32_t                    zc_completed; // zerocopy sends the kernel is done with
+            List<zc_ref_t>*             zc_pending; // refs held until their sends complete
         } connection_t;
 
         /*--------------------------------------------------------------------
@@ -127,7 +147,10 @@ class HttpServer: public LuaObject
 
         bool                            active;
         bool                            listening;
-        Thread*                         listenerPid;
+        Thread**                        listenerPids;
+        int                             numThreads;
+        int                             maxConnections;
+        Mutex                           connMutex; // connections are shared by the listener threads
         Table<connection_t*, int>       connections;
 
         Dictionary<EndpointObject*>     routeTable;
@@ -135,7 +158,10 @@ class HttpServer: public LuaObject
         char*                           ipAddr;
         int                             port;
 
+        int                             zeroCopySize; // zero disables zerocopy sends
+        int                             compressLevel; // zero disables compression of streamed responses
         int32_t                         metricId;
+        LatencyHistogram*               writeLatency;
 
         /*--------------------------------------------------------------------
          * Methods
@@ -143,8 +169,12 @@ class HttpServer: public LuaObject
 
         void                initConnection      (connection_t* connection);
         void                deinitConnection    (connection_t* connection);
-        void                extractPath         (const char* url, const char** path, const char** resource);
-        bool                processHttpHeader   (char* buf, EndpointObject::Request* request);
+        void                reapZeroCopy        (int fd, connection_t* connection);
+        void                startCompression    (connection_t* connection);
+        connection_t*       getConnection       (int fd);
+        int                 processRequest      (connection_t* connection);
+        void                extractPath         (const char* url, const char** path, const char** resource, StringLib::Arena& arena);
+        bool                processHttpHeader   (const char* buf, int len, EndpointObject::Request* request);
 
         static void*        listenerThread      (void* parm);
         static int          pollHandler         (int fd, short* events, void* parm);
@@ -157,6 +187,8 @@ class HttpServer: public LuaObject
 
         static int          luaAttach           (lua_State* L);
         static int          luaMetric           (lua_State* L);
+        static int          luaZeroCopy         (lua_State* L);
+        static int          luaCompress         (lua_State* L);
         static int          luaUntilUp          (lua_State* L);
 };
 
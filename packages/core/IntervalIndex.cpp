@@ -33,6 +33,8 @@
  * INCLUDES
  ******************************************************************************/
 
+#include <cmath>
+
 #include "OsApi.h"
 #include "AssetIndex.h"
 #include "Asset.h"
@@ -47,7 +49,10 @@ const char* IntervalIndex::LuaMetaName = "IntervalIndex";
 const struct luaL_Reg IntervalIndex::LuaMetaTable[] = {
     {"add",         luaAdd},
     {"query",       luaQuery},
+    {"querybatch",  luaQueryBatch},
     {"display",     luaDisplay},
+    {"save",        luaSave},
+    {"load",        luaLoad},
     {NULL,          NULL}
 };
 
@@ -56,7 +61,7 @@ const struct luaL_Reg IntervalIndex::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<asset>, <field1>, <field2>, [<threshold>])
+ * luaCreate - create(<asset>, <field1>, <field2>, [<threshold>], [<packed>])
  *----------------------------------------------------------------------------*/
 int IntervalIndex::luaCreate (lua_State* L)
 {
@@ -67,9 +72,10 @@ int IntervalIndex::luaCreate (lua_State* L)
         const char* _fieldname0 = getLuaString(L, 2);
         const char* _fieldname1 = getLuaString(L, 3);
         int         _threshold  = getLuaInteger(L, 4, true, DEFAULT_THRESHOLD);
+        bool        _packed     = getLuaBoolean(L, 5, true, false);
 
         /* Return AssetIndex Object */
-        return createLuaObject(L, new IntervalIndex(L, _asset, _fieldname0, _fieldname1, _threshold));
+        return createLuaObject(L, new IntervalIndex(L, _asset, _fieldname0, _fieldname1, _threshold, _packed));
     }
     catch(const RunTimeException& e)
     {
@@ -81,8 +87,8 @@ int IntervalIndex::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-IntervalIndex::IntervalIndex(lua_State* L, Asset*_asset, const char* _fieldname0, const char* _fieldname1, int _threshold):
-    AssetIndex<intervalspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold)
+IntervalIndex::IntervalIndex(lua_State* L, Asset*_asset, const char* _fieldname0, const char* _fieldname1, int _threshold, bool _packed):
+    AssetIndex<intervalspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold, _packed)
 {
     assert(_fieldname0);
     assert(_fieldname1);
@@ -184,28 +190,28 @@ intervalspan_t IntervalIndex::combine (const intervalspan_t& span1, const interv
     return span;
 }
 
+/*----------------------------------------------------------------------------
+ * spanattrs
+ *----------------------------------------------------------------------------*/
+int IntervalIndex::spanattrs (const char* names[MAX_SPAN_ATTRS])
+{
+    names[0] = fieldname0;
+    names[1] = fieldname1;
+    return 2;
+}
+
 /*----------------------------------------------------------------------------
  * attr2span
  *----------------------------------------------------------------------------*/
-intervalspan_t IntervalIndex::attr2span (Dictionary<double>* attr, bool* provided)
+intervalspan_t IntervalIndex::attr2span (const double* values, bool* provided)
 {
     intervalspan_t span;
-    bool status = false;
-    
-    try 
-    {
-        span.t0 = (*attr)[fieldname0];
-        span.t1 = (*attr)[fieldname1];
-        status = true;
-    }
-    catch(RunTimeException& e)
-    {
-        mlog(e.level(), "Failed to index asset: %s", e.what());
-    }
+    span.t0 = values[0];
+    span.t1 = values[1];
 
     if(provided)
     {
-        *provided = status;
+        *provided = !std::isnan(values[0]) && !std::isnan(values[1]);
     }
 
     return span;
@@ -250,3 +256,12 @@ void IntervalIndex::displayspan (const intervalspan_t& span)
 {
     print2term("[%.3lf, %.3lf]", span.t0, span.t1);
 }
+
+/*----------------------------------------------------------------------------
+ * sortkey
+ *----------------------------------------------------------------------------*/
+double IntervalIndex::sortkey (const intervalspan_t& span, int dim)
+{
+    (void)dim;
+    return (span.t0 + span.t1) / 2.0;
+}
@@ -58,7 +58,7 @@ class IntervalIndex: public AssetIndex<intervalspan_t>
          * Methods
          *--------------------------------------------------------------------*/
 
-                        IntervalIndex   (lua_State* L, Asset* _asset, const char* _fieldname0, const char* _fieldname1, int _threshold);
+                        IntervalIndex   (lua_State* L, Asset* _asset, const char* _fieldname0, const char* _fieldname1, int _threshold, bool _packed);
                         ~IntervalIndex  (void);
 
         static int      luaCreate       (lua_State* L);
@@ -68,9 +68,11 @@ class IntervalIndex: public AssetIndex<intervalspan_t>
         bool            isright         (node_t* node, const intervalspan_t& span) override;
         bool            intersect       (const intervalspan_t& span1, const intervalspan_t& span2) override;
         intervalspan_t  combine         (const intervalspan_t& span1, const intervalspan_t& span2) override;
-        intervalspan_t  attr2span       (Dictionary<double>* attr, bool* provided=NULL) override;
+        int             spanattrs       (const char* names[MAX_SPAN_ATTRS]) override;
+        intervalspan_t  attr2span       (const double* values, bool* provided=NULL) override;
         intervalspan_t  luatable2span   (lua_State* L, int parm) override;
         void            displayspan     (const intervalspan_t& span) override;
+        double          sortkey         (const intervalspan_t& span, int dim) override;
     
     private:
 
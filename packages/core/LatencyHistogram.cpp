@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "LatencyHistogram.h"
+#include "core.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* LatencyHistogram::COUNT_METRIC = "count";
+const char* LatencyHistogram::SUM_METRIC = "sum_us";
+
+/******************************************************************************
+ * SAMPLE SUBCLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+LatencyHistogram::Sample::Sample (LatencyHistogram* _histogram):
+    histogram(_histogram),
+    start(_histogram ? TimeLib::latchtime() : 0.0)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+LatencyHistogram::Sample::~Sample (void)
+{
+    if(histogram) histogram->record(TimeLib::latchtime() - start);
+}
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  metrics are named <stage>.latency.le_<bound>us, <stage>.latency.le_inf,
+ *  <stage>.latency.count, and <stage>.latency.sum_us
+ *----------------------------------------------------------------------------*/
+LatencyHistogram::LatencyHistogram (const char* category, const char* stage)
+{
+    assert(category);
+    assert(stage);
+
+    registered = true;
+    for(int b = 0; b < NUM_BOUNDS; b++)
+    {
+        metricIds[b] = EventLib::registerMetric(category, EventLib::COUNTER, "%s.latency.le_%ldus", stage, MIN_BOUND_US << b);
+    }
+    metricIds[NUM_BOUNDS] = EventLib::registerMetric(category, EventLib::COUNTER, "%s.latency.le_inf", stage);
+    metricIds[NUM_BUCKETS] = EventLib::registerMetric(category, EventLib::COUNTER, "%s.latency.%s", stage, COUNT_METRIC);
+    metricIds[NUM_BUCKETS + 1] = EventLib::registerMetric(category, EventLib::COUNTER, "%s.latency.%s", stage, SUM_METRIC);
+
+    for(int m = 0; m < NUM_BUCKETS + 2; m++)
+    {
+        if(metricIds[m] == EventLib::INVALID_METRIC)
+        {
+            mlog(ERROR, "Failed to register latency histogram for %s.%s", category, stage);
+            registered = false;
+            break;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+LatencyHistogram::~LatencyHistogram (void)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * record
+ *----------------------------------------------------------------------------*/
+void LatencyHistogram::record (double seconds)
+{
+    if(!registered) return;
+
+    /* Find Bucket (smallest power of two bound that holds the sample) */
+    long us = MAX((long)(seconds * 1000000.0), 1L);
+    int shift = (us > 1) ? (64 - __builtin_clzl(us - 1)) : 0;
+    int bucket = MIN(MAX(shift - MIN_BOUND_SHIFT, 0), NUM_BOUNDS);
+
+    /* Update Metrics */
+    int32_t ids[3] = { metricIds[bucket], metricIds[NUM_BUCKETS], metricIds[NUM_BUCKETS + 1] };
+    double values[3] = { 1.0, 1.0, (double)us };
+    EventLib::incrementMetrics(ids, values, 3);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __latency_histogram__
+#define __latency_histogram__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+#include "EventLib.h"
+
+/******************************************************************************
+ * LATENCY HISTOGRAM CLASS
+ ******************************************************************************/
+
+/*
+ * Logarithmic latency histogram registered as a set of EventLib counters
+ * so that it is scraped along with every other metric.  Bucket b counts
+ * the samples that took at most MIN_BOUND_US << b microseconds (and more
+ * than the bound of the bucket before it); the last bucket counts
+ * everything longer.  A count and a sum in microseconds are kept as well,
+ * and recording a sample takes a single pass through the metric lock.
+ */
+class LatencyHistogram
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int    MIN_BOUND_SHIFT = 6;                        // 64us
+        static const long   MIN_BOUND_US    = 1L << MIN_BOUND_SHIFT;
+        static const int    NUM_BOUNDS      = 21;                       // up to ~67s
+        static const int    NUM_BUCKETS     = NUM_BOUNDS + 1;           // plus overflow
+        static const char*  COUNT_METRIC;
+        static const char*  SUM_METRIC;
+
+        /*--------------------------------------------------------------------
+         * Sample Subclass
+         *--------------------------------------------------------------------*/
+
+        /* times its own scope into a histogram, which may be NULL */
+        class Sample
+        {
+            public:
+                explicit Sample (LatencyHistogram* _histogram);
+                ~Sample (void);
+            private:
+                LatencyHistogram*   histogram;
+                double              start;
+        };
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                LatencyHistogram    (const char* category, const char* stage);
+                ~LatencyHistogram   (void);
+
+        void    record              (double seconds);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        /* bucket metrics followed by the count and sum metrics */
+        int32_t metricIds[NUM_BUCKETS + 2];
+        bool    registered;
+};
+
+#endif  /* __latency_histogram__ */
@@ -52,30 +52,65 @@ const struct luaL_Reg LimitDispatch::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - :limit(<field>, <value of id to filter on>, <min>, <max>)
+ * luaCreate - :limit(<field>, <value of id to filter on>, <min>, <max>, [<deepq>], [<limitq>])
+ *             :limit(<table of limits>, [<deepq>], [<limitq>])
+ *
+ *  where each limit in the table is {field=<name>, id=<id>, min=<min>, max=<max>};
+ *  all limits of a dispatch are checked in a single pass over each record
  *----------------------------------------------------------------------------*/
 int LimitDispatch::luaCreate (lua_State* L)
 {
+    LimitRecord::limit_t* _limits = NULL;
+
     try
     {
-        LimitRecord::limit_t rec;
-        LocalLib::set(&rec, 0, sizeof(LimitRecord::limit_t));
+        int num_limits = 0;
+        int parm_index;
 
-        /* Initialize Limit Record with Parameters */
-        StringLib::format(rec.field_name, LimitRecord::MAX_FIELD_NAME_SIZE, "%s", getLuaString(L, 1));
-        rec.id    = getLuaInteger(L, 2, true, 0, &rec.filter_id);
-        rec.d_min = getLuaFloat(L, 3, true, 0.0, &rec.limit_min);
-        rec.d_max = getLuaFloat(L, 4, true, 0.0, &rec.limit_max);
+        if(lua_istable(L, 1))
+        {
+            /* Initialize Limit Records from Table */
+            num_limits = lua_rawlen(L, 1);
+            if(num_limits <= 0 || num_limits > MAX_LIMITS)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid number of limits: %d", num_limits);
+            }
+
+            _limits = new LimitRecord::limit_t [num_limits];
+            for(int i = 0; i < num_limits; i++)
+            {
+                lua_rawgeti(L, 1, i + 1);
+                bool valid = parseLimit(L, lua_gettop(L), &_limits[i]);
+                lua_pop(L, 1);
+                if(!valid) throw RunTimeException(CRITICAL, RTE_ERROR, "limit %d must be a table with a field", i + 1);
+            }
+
+            parm_index = 2;
+        }
+        else
+        {
+            /* Initialize Limit Record with Parameters */
+            num_limits = 1;
+            _limits = new LimitRecord::limit_t [num_limits];
+            LocalLib::set(&_limits[0], 0, sizeof(LimitRecord::limit_t));
+            StringLib::format(_limits[0].field_name, LimitRecord::MAX_FIELD_NAME_SIZE, "%s", getLuaString(L, 1));
+            _limits[0].id    = getLuaInteger(L, 2, true, 0, &_limits[0].filter_id);
+            _limits[0].d_min = getLuaFloat(L, 3, true, 0.0, &_limits[0].limit_min);
+            _limits[0].d_max = getLuaFloat(L, 4, true, 0.0, &_limits[0].limit_max);
+
+            parm_index = 5;
+        }
 
         /* Get Limit Dispatch Parameters */
-        const char* deepq  = getLuaString(L, 5, true, NULL); // for posting the offending record
-        const char* limitq = getLuaString(L, 6, true, NULL); // for posting the limit record
+        const char* deepq  = getLuaString(L, parm_index, true, NULL); // for posting the offending record
+        const char* limitq = getLuaString(L, parm_index + 1, true, NULL); // for posting the limit record
 
         /* Create Record Monitor */
-        return createLuaObject(L, new LimitDispatch(L, rec, deepq, limitq));
+        return createLuaObject(L, new LimitDispatch(L, _limits, num_limits, deepq, limitq));
     }
     catch(const RunTimeException& e)
     {
+        if(_limits) delete [] _limits;
         mlog(e.level(), "Error creating %s: %s", LuaMetaName, e.what());
         return returnLuaStatus(L, false);
     }
@@ -87,17 +122,33 @@ int LimitDispatch::luaCreate (lua_State* L)
 
 /*----------------------------------------------------------------------------
  * Constructor
+ *
+ *  Note: object takes ownership of limits pointer and must free memory
  *----------------------------------------------------------------------------*/
-LimitDispatch::LimitDispatch (lua_State* L, LimitRecord::limit_t _limit, const char* deepq_name, const char* limitq_name):
+LimitDispatch::LimitDispatch (lua_State* L, LimitRecord::limit_t* _limits, int _num_limits, const char* deepq_name, const char* limitq_name):
     DispatchObject(L, LuaMetaName, LuaMetaTable)
 {
+    assert(_limits);
+
     LimitRecord::defineRecord(LimitRecord::rec_type, "TYPE", sizeof(LimitRecord::limit_t), LimitRecord::rec_def, LimitRecord::rec_elem);
 
-    limit = _limit;
+    limits = _limits;
+    numLimits = _num_limits;
     logLevel = ERROR;
     inError = false;
     gmtDisplay = false;
 
+    filterId = false;
+    for(int l = 0; l < numLimits; l++)
+    {
+        filterId = filterId || limits[l].filter_id;
+    }
+
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
+    {
+        plans[i] = NULL;
+    }
+
     limitQ = NULL;
     if(limitq_name)
     {
@@ -118,82 +169,259 @@ LimitDispatch::~LimitDispatch(void)
 {
     if(limitQ) delete limitQ;
     if(deepQ) delete deepQ;
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
+    {
+        plan_t* plan = plans[i].load();
+        if(plan) freePlan(plan);
+    }
+    delete [] limits;
 }
 
 /*----------------------------------------------------------------------------
- * processRecord
+ * compilePlan
+ *
+ *  resolves every limit against the record's definition; complete is set
+ *  false when a field is missing, since it may still be defined later
  *----------------------------------------------------------------------------*/
-bool LimitDispatch::processRecord (RecordObject* record, okey_t key)
+LimitDispatch::plan_t* LimitDispatch::compilePlan (RecordObject* record, bool* complete)
 {
-    bool status = true;
-    bool enabled = true;
+    plan_t* plan = new plan_t;
+    plan->rec_type = record->getRecordType();
+    plan->num_checks = 0;
+    plan->checks = new check_t [numLimits];
+    *complete = true;
 
-    /* Filter on ID */
-    if(limit.filter_id)
+    for(int l = 0; l < numLimits; l++)
     {
-        if(limit.id != record->getRecordId())
+        RecordObject::field_t field = record->getField(limits[l].field_name);
+        if(field.type == RecordObject::INVALID_FIELD)
         {
-            enabled = false;
+            if(inError == false)
+            {
+                inError = true;
+                mlog(WARNING, "Failed to find field %s in record %s", limits[l].field_name, record->getRecordType());
+            }
+            *complete = false;
+            continue;
         }
+
+        check_t& check = plan->checks[plan->num_checks++];
+        check.limit = l;
+        check.type = field.type;
+        check.offset = TOBYTES(field.offset);
+        check.field = field;
+        check.direct = ((field.flags & (RecordObject::POINTER | RecordObject::BIGENDIAN)) == NATIVE_FLAGS) &&
+                       (field.type <= RecordObject::UINT64 || field.type == RecordObject::FLOAT || field.type == RecordObject::DOUBLE);
     }
 
-    /* Limit Check */
-    if(enabled)
+    if(*complete) inError = false;
+
+    return plan;
+}
+
+/*----------------------------------------------------------------------------
+ * getPlan
+ *
+ *  Plans are immutable once published, so readers need no lock (same scheme
+ *  as RecordObject::FieldHandle); a plan that is not cached is temporary and
+ *  must be freed by the caller
+ *----------------------------------------------------------------------------*/
+LimitDispatch::plan_t* LimitDispatch::getPlan (RecordObject* record, bool* temporary)
+{
+    const char* rec_type = record->getRecordType();
+    *temporary = false;
+
+    /* Check Cache */
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
     {
-        RecordObject::field_t field = record->getField(limit.field_name);
-        if(field.type != RecordObject::INVALID_FIELD)
+        plan_t* plan = plans[i].load(std::memory_order_acquire);
+        if(plan == NULL) break;
+        if(plan->rec_type == rec_type) return plan;
+    }
+
+    /* Compile Plan */
+    bool complete;
+    plan_t* new_plan = compilePlan(record, &complete);
+
+    /* Cache Plan */
+    if(complete)
+    {
+        for(int i = 0; i < MAX_CACHED_TYPES; i++)
         {
-            inError = false;
-            double val = record->getValueReal(field);
-            if( ((limit.limit_min) && (limit.d_min > val)) ||
-                ((limit.limit_max) && (limit.d_max < val)) )
+            plan_t* expected = NULL;
+            if(plans[i].compare_exchange_strong(expected, new_plan, std::memory_order_acq_rel))
+            {
+                return new_plan;
+            }
+            else if(expected->rec_type == rec_type)
             {
-                /* Create Limit Violation */
-                LimitRecord violation(limit);
-                violation.limit->d_val = val;
-                StringLib::format(violation.limit->record_name, LimitRecord::MAX_RECORD_NAME_SIZE, "%s", record->getRecordType());
-
-                /* Log Error Message */
-                if(gmtDisplay)
-                {
-                    TimeLib::gmt_time_t index_time = TimeLib::gps2gmttime(key);
-                    mlog(logLevel, "Limit violation for %s - %s(%ld): %lf violates %s: [%lf, %lf] at %d:%d:%d:%d:%d:%d",
-                            limit.field_name, violation.limit->record_name, record->getRecordId(),
-                            violation.limit->d_val, ObjectType, limit.d_min, limit.d_max,
-                            index_time.year, index_time.doy, index_time.hour, index_time.minute, index_time.second, index_time.millisecond);
-                }
-                else
-                {
-                    mlog(logLevel, "Limit violation for %s - %s(%ld): %lf violates %s: [%lf, %lf]",
-                            limit.field_name, violation.limit->record_name, record->getRecordId(),
-                            violation.limit->d_val, ObjectType, limit.d_min, limit.d_max);
-                }
-
-                /* Post Violation to Limit Q */
-                if(limitQ)
-                {
-                    unsigned char* buffer; // reference to serial buffer
-                    int size = violation.serialize(&buffer, RecordObject::REFERENCE);
-                    if(size > 0) limitQ->postCopy(buffer, size);
-                }
-
-                /* Post Record to Deep Copy Q */
-                if(deepQ)
-                {
-                    unsigned char* buffer; // reference to serial buffer
-                    int size = record->serialize(&buffer, RecordObject::REFERENCE);
-                    if(size > 0) deepQ->postCopy(buffer, size);
-                }
+                freePlan(new_plan); // another thread cached the same type
+                return expected;
             }
         }
-        else if(inError == false)
+    }
+
+    *temporary = true;
+    return new_plan;
+}
+
+/*----------------------------------------------------------------------------
+ * freePlan
+ *----------------------------------------------------------------------------*/
+void LimitDispatch::freePlan (plan_t* plan)
+{
+    delete [] plan->checks;
+    delete plan;
+}
+
+/*----------------------------------------------------------------------------
+ * checkValue
+ *----------------------------------------------------------------------------*/
+double LimitDispatch::checkValue (const check_t& check, RecordObject* record, const unsigned char* data)
+{
+    if(check.direct)
+    {
+        const unsigned char* v = data + check.offset;
+        switch(check.type)
+        {
+            case RecordObject::INT8:    return (double)*(const int8_t*)v;
+            case RecordObject::INT16:   return (double)*(const int16_t*)v;
+            case RecordObject::INT32:   return (double)*(const int32_t*)v;
+            case RecordObject::INT64:   return (double)*(const int64_t*)v;
+            case RecordObject::UINT8:   return (double)*(const uint8_t*)v;
+            case RecordObject::UINT16:  return (double)*(const uint16_t*)v;
+            case RecordObject::UINT32:  return (double)*(const uint32_t*)v;
+            case RecordObject::UINT64:  return (double)*(const uint64_t*)v;
+            case RecordObject::FLOAT:   return (double)*(const float*)v;
+            case RecordObject::DOUBLE:  return *(const double*)v;
+            default:                    break;
+        }
+    }
+
+    return record->getValue<double>(check.field);
+}
+
+/*----------------------------------------------------------------------------
+ * processRecord
+ *
+ *  one pass over the compiled checks sets a bit per violation; violations
+ *  are then reported in limit order
+ *----------------------------------------------------------------------------*/
+bool LimitDispatch::processRecord (RecordObject* record, okey_t key)
+{
+    bool temporary;
+    plan_t* plan = getPlan(record, &temporary);
+    const unsigned char* data = record->getRecordData();
+    long id = filterId ? record->getRecordId() : 0;
+
+    /* Check Limits */
+    uint64_t violations[MAX_LIMITS / 64];
+    int num_words = (plan->num_checks + 63) / 64;
+    LocalLib::set(violations, 0, num_words * sizeof(uint64_t));
+    for(int c = 0; c < plan->num_checks; c++)
+    {
+        const check_t& check = plan->checks[c];
+        const LimitRecord::limit_t& limit = limits[check.limit];
+        if(limit.filter_id && limit.id != id) continue;
+
+        double val = checkValue(check, record, data);
+        if( ((limit.limit_min) && (limit.d_min > val)) ||
+            ((limit.limit_max) && (limit.d_max < val)) )
+        {
+            violations[c >> 6] |= 1ULL << (c & 63);
+        }
+    }
+
+    /* Report Violations */
+    for(int w = 0; w < num_words; w++)
+    {
+        uint64_t bits = violations[w];
+        while(bits)
         {
-            inError = true;
-            mlog(WARNING, "Failed to find field %s in record %s", limit.field_name, record->getRecordType());
+            int c = (w << 6) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            const check_t& check = plan->checks[c];
+            reportViolation(limits[check.limit], checkValue(check, record, data), record, key);
         }
     }
 
-    return status;
+    if(temporary) freePlan(plan);
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * reportViolation
+ *----------------------------------------------------------------------------*/
+void LimitDispatch::reportViolation (const LimitRecord::limit_t& limit, double val, RecordObject* record, okey_t key)
+{
+    /* Create Limit Violation */
+    LimitRecord violation(limit);
+    violation.limit->d_val = val;
+    StringLib::format(violation.limit->record_name, LimitRecord::MAX_RECORD_NAME_SIZE, "%s", record->getRecordType());
+
+    /* Log Error Message */
+    if(gmtDisplay)
+    {
+        TimeLib::gmt_time_t index_time = TimeLib::gps2gmttime(key);
+        mlog(logLevel, "Limit violation for %s - %s(%ld): %lf violates %s: [%lf, %lf] at %d:%d:%d:%d:%d:%d",
+                limit.field_name, violation.limit->record_name, record->getRecordId(),
+                violation.limit->d_val, ObjectType, limit.d_min, limit.d_max,
+                index_time.year, index_time.doy, index_time.hour, index_time.minute, index_time.second, index_time.millisecond);
+    }
+    else
+    {
+        mlog(logLevel, "Limit violation for %s - %s(%ld): %lf violates %s: [%lf, %lf]",
+                limit.field_name, violation.limit->record_name, record->getRecordId(),
+                violation.limit->d_val, ObjectType, limit.d_min, limit.d_max);
+    }
+
+    /* Post Violation to Limit Q */
+    if(limitQ)
+    {
+        unsigned char* buffer; // reference to serial buffer
+        int size = violation.serialize(&buffer, RecordObject::REFERENCE);
+        if(size > 0) limitQ->postCopy(buffer, size);
+    }
+
+    /* Post Record to Deep Copy Q */
+    if(deepQ)
+    {
+        unsigned char* buffer; // reference to serial buffer
+        int size = record->serialize(&buffer, RecordObject::REFERENCE);
+        if(size > 0) deepQ->postCopy(buffer, size);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * parseLimit - {field=<name>, id=<id>, min=<min>, max=<max>}
+ *----------------------------------------------------------------------------*/
+bool LimitDispatch::parseLimit (lua_State* L, int index, LimitRecord::limit_t* limit)
+{
+    LocalLib::set(limit, 0, sizeof(LimitRecord::limit_t));
+    if(!lua_istable(L, index)) return false;
+
+    bool provided = false;
+
+    lua_getfield(L, index, "field");
+    const char* field_str = getLuaString(L, -1, true, NULL, &provided);
+    if(provided) StringLib::format(limit->field_name, LimitRecord::MAX_FIELD_NAME_SIZE, "%s", field_str);
+    lua_pop(L, 1);
+    if(!provided) return false;
+
+    lua_getfield(L, index, "id");
+    limit->id = getLuaInteger(L, -1, true, 0, &limit->filter_id);
+    lua_pop(L, 1);
+
+    lua_getfield(L, index, "min");
+    limit->d_min = getLuaFloat(L, -1, true, 0.0, &limit->limit_min);
+    lua_pop(L, 1);
+
+    lua_getfield(L, index, "max");
+    limit->d_max = getLuaFloat(L, -1, true, 0.0, &limit->limit_max);
+    lua_pop(L, 1);
+
+    return true;
 }
 
 /*----------------------------------------------------------------------------
@@ -60,6 +60,9 @@ class LimitDispatch: public DispatchObject
         static const char* LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
 
+        static const int MAX_LIMITS = 1024;
+        static const int MAX_CACHED_TYPES = 8;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -68,11 +71,32 @@ class LimitDispatch: public DispatchObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            int                         limit;      // index into limits
+            bool                        direct;     // native scalar read straight from the record data
+            RecordObject::fieldType_t   type;
+            uint32_t                    offset;     // bytes into record data
+            RecordObject::field_t       field;      // used when not direct
+        } check_t;
+
+        typedef struct {
+            const char*                 rec_type;   // pointer into the record definition
+            int                         num_checks;
+            check_t*                    checks;
+        } plan_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        LimitRecord::limit_t    limit;
+        LimitRecord::limit_t*   limits;
+        int                     numLimits;
+        bool                    filterId;   // any limit filters on record id
+        std::atomic<plan_t*>    plans[MAX_CACHED_TYPES];
         event_level_t           logLevel;
         bool                    inError;
         Publisher*              limitQ;
@@ -83,9 +107,16 @@ class LimitDispatch: public DispatchObject
          * Methods
          *--------------------------------------------------------------------*/
 
-                    LimitDispatch       (lua_State* L, LimitRecord::limit_t _limit, const char* deepq_name, const char* limitq_name);
+                    LimitDispatch       (lua_State* L, LimitRecord::limit_t* _limits, int _num_limits, const char* deepq_name, const char* limitq_name);
                     ~LimitDispatch      (void);
 
+        plan_t*     compilePlan         (RecordObject* record, bool* complete);
+        plan_t*     getPlan             (RecordObject* record, bool* temporary);
+        static void freePlan            (plan_t* plan);
+        static double checkValue        (const check_t& check, RecordObject* record, const unsigned char* data);
+        void        reportViolation     (const LimitRecord::limit_t& limit, double val, RecordObject* record, okey_t key);
+        static bool parseLimit          (lua_State* L, int index, LimitRecord::limit_t* limit);
+
         /* overridden methods */
         bool        processRecord       (RecordObject* record, okey_t key);
 
@@ -44,6 +44,10 @@ const char* LuaEndpoint::LuaMetaName = "LuaEndpoint";
 const struct luaL_Reg LuaEndpoint::LuaMetaTable[] = {
     {"metric",      luaMetric},
     {"auth",        luaAuth},
+    {"admission",   luaAdmission},
+    {"weight",      luaWeight},
+    {"tenants",     luaTenants},
+    {"ceiling",     luaCeiling},
     {NULL,          NULL}
 };
 
@@ -117,7 +121,7 @@ bool LuaEndpoint::init (void)
 }
 
 /*----------------------------------------------------------------------------
- * luaCreate - endpoint([<normal memory threshold>], [<stream memory threshold>])
+ * luaCreate - endpoint([<normal memory threshold>], [<stream memory threshold>], [<log level>], [<num workers>], [<engine pool size>])
  *----------------------------------------------------------------------------*/
 int LuaEndpoint::luaCreate (lua_State* L)
 {
@@ -127,9 +131,15 @@ int LuaEndpoint::luaCreate (lua_State* L)
         double normal_mem_thresh = getLuaFloat(L, 1, true, DEFAULT_NORMAL_REQUEST_MEMORY_THRESHOLD);
         double stream_mem_thresh = getLuaFloat(L, 2, true, DEFAULT_STREAM_REQUEST_MEMORY_THRESHOLD);
         event_level_t lvl = (event_level_t)getLuaInteger(L, 3, true, INFO);
+        long num_workers = getLuaInteger(L, 4, true, DEFAULT_NUM_WORKERS);
+        long pool_size = getLuaInteger(L, 5, true, DEFAULT_ENGINE_POOL_SIZE);
+
+        /* Check Parameters */
+        if(num_workers < 1) throw RunTimeException(CRITICAL, RTE_ERROR, "invalid number of workers: %ld", num_workers);
+        if(pool_size < 0) throw RunTimeException(CRITICAL, RTE_ERROR, "invalid engine pool size: %ld", pool_size);
 
         /* Create Lua Endpoint */
-        return createLuaObject(L, new LuaEndpoint(L, normal_mem_thresh, stream_mem_thresh, lvl));
+        return createLuaObject(L, new LuaEndpoint(L, normal_mem_thresh, stream_mem_thresh, lvl, num_workers, pool_size));
     }
     catch(const RunTimeException& e)
     {
@@ -168,14 +178,38 @@ void LuaEndpoint::generateExceptionStatus (int code, event_level_t level, Publis
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-LuaEndpoint::LuaEndpoint(lua_State* L, double normal_mem_thresh, double stream_mem_thresh, event_level_t lvl):
+LuaEndpoint::LuaEndpoint(lua_State* L, double normal_mem_thresh, double stream_mem_thresh, event_level_t lvl, int num_workers, int pool_size):
     EndpointObject(L, LuaMetaName, LuaMetaTable),
     metricIds(INITIAL_NUM_ENDPOINTS),
     normalRequestMemoryThreshold(normal_mem_thresh),
     streamRequestMemoryThreshold(stream_mem_thresh),
     logLevel(lvl),
-    authenticator(NULL)
+    authenticator(NULL),
+    numWorkers(num_workers),
+    enginePoolSize(pool_size),
+    streamMut("lua.streams"),
+    maxStreams(DEFAULT_MAX_STREAMS),
+    maxQueuedStreams(DEFAULT_MAX_QUEUED_STREAMS),
+    runningStreams(0),
+    streamCeiling(DEFAULT_STREAM_CEILING),
+    streamSpill(NULL)
 {
+    active = true;
+
+    /* Start Engine Warmer */
+    warmerPid = NULL;
+    if(enginePoolSize > 0)
+    {
+        warmerPid = new Thread(warmerThread, this);
+    }
+
+    /* Start Workers */
+    workerPids = new Thread* [numWorkers];
+    for(int i = 0; i < numWorkers; i++)
+    {
+        Thread::attr_t attr = {.name = "lua.worker", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+        workerPids[i] = new Thread(workerThread, this, attr);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -183,6 +217,55 @@ LuaEndpoint::LuaEndpoint(lua_State* L, double normal_mem_thresh, double stream_m
  *----------------------------------------------------------------------------*/
 LuaEndpoint::~LuaEndpoint(void)
 {
+    active = false;
+
+    /* Stop Workers */
+    requestSignal.lock();
+    {
+        requestSignal.signal();
+    }
+    requestSignal.unlock();
+    for(int i = 0; i < numWorkers; i++)
+    {
+        delete workerPids[i];
+    }
+    delete [] workerPids;
+
+    /* Stop Engine Warmer */
+    poolSignal.lock();
+    {
+        poolSignal.signal();
+    }
+    poolSignal.unlock();
+    delete warmerPid;
+
+    /* Free Spill Directory */
+    if(streamSpill) delete [] streamSpill;
+
+    /* Drop Requests Never Serviced */
+    for(int i = 0; i < requestQ.length(); i++)
+    {
+        delete requestQ[i]->request;
+        delete requestQ[i];
+    }
+    tenant_t* tenant;
+    const char* key = tenants.first(&tenant);
+    while(key != NULL)
+    {
+        for(int i = 0; i < tenant->queue.length(); i++)
+        {
+            delete tenant->queue[i].info->request;
+            delete tenant->queue[i].info;
+        }
+        delete tenant;
+        key = tenants.next(&tenant);
+    }
+
+    /* Free Pre-Warmed Engines */
+    for(int i = 0; i < enginePool.length(); i++)
+    {
+        delete enginePool[i];
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -191,83 +274,373 @@ LuaEndpoint::~LuaEndpoint(void)
 void* LuaEndpoint::requestThread (void* parm)
 {
     EndpointObject::info_t* info = (EndpointObject::info_t*)parm;
-    EndpointObject::Request* request = info->request;
     LuaEndpoint* lua_endpoint = (LuaEndpoint*)info->endpoint;
 
+    /* Begin Request */
+    request_t* rqst = lua_endpoint->beginRequest(info, true);
+
+    /* Dispatch Handle Request */
+    if(rqst->authorized)
+    {
+        switch(info->request->verb)
+        {
+            case GET:   lua_endpoint->normalResponse(rqst->script, info->request, rqst->rspq, rqst->traceId); break;
+            case POST:  lua_endpoint->streamResponse(rqst->script, info->request, rqst->rspq, rqst->traceId); break;
+            default:    break;
+        }
+    }
+
+    /* End Request */
+    endRequest(rqst);
+
+    /* Return */
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * asyncRequest
+ *
+ *  runs a streaming request's script on the LuaEngine scheduler; returns true
+ *  if the script was started there, in which case asyncDone finishes the
+ *  request and the calling thread is free to exit
+ *----------------------------------------------------------------------------*/
+bool LuaEndpoint::asyncRequest (stream_t* stream)
+{
+    EndpointObject::info_t* info = stream->info;
+    LuaEndpoint* lua_endpoint = (LuaEndpoint*)info->endpoint;
+
+    /* Begin Request - scheduler threads serve many requests so none are placed */
+    request_t* rqst = lua_endpoint->beginRequest(info, false);
+    rqst->stream = stream;
+
+    /* Start Script */
+    if(rqst->authorized)
+    {
+        rqst->engine = lua_endpoint->streamStart(rqst->script, info->request, rqst->rspq, rqst->traceId);
+        if(rqst->engine)
+        {
+            RequestAccount::detach(rqst->previous);
+            if(rqst->engine->executeAsync(asyncDone, rqst))
+            {
+                return true;
+            }
+
+            /* Scheduler Not Running */
+            rqst->previous = RequestAccount::attach(rqst->account);
+            rqst->engine->executeEngine(IO_PEND);
+            lua_endpoint->streamFinish(rqst->engine, rqst->rspq);
+        }
+    }
+
+    /* End Request */
+    endRequest(rqst);
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * asyncDone
+ *
+ *  called from a scheduler thread when a streaming script finishes
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::asyncDone (LuaEngine* engine, void* parm)
+{
+    request_t* rqst = (request_t*)parm;
+    LuaEndpoint* lua_endpoint = (LuaEndpoint*)rqst->info->endpoint;
+    stream_t* stream = rqst->stream;
+    tenant_t* tenant = stream->tenant;
+
+    /* Finish Request */
+    rqst->previous = RequestAccount::attach(rqst->account);
+    lua_endpoint->streamFinish(engine, rqst->rspq);
+    endRequest(rqst);
+    delete stream;
+
+    /* Admit Next Stream into Slot */
+    stream_t* next = lua_endpoint->nextStream(tenant);
+    if(next) lua_endpoint->startStream(next);
+}
+
+/*----------------------------------------------------------------------------
+ * beginRequest
+ *
+ *  everything done for a request before its script runs; the request's
+ *  account is attached to the calling thread on return
+ *----------------------------------------------------------------------------*/
+LuaEndpoint::request_t* LuaEndpoint::beginRequest (info_t* info, bool place)
+{
+    EndpointObject::Request* request = info->request;
+    request_t* rqst = new request_t;
+    rqst->info = info;
+    rqst->stream = NULL;
+    rqst->engine = NULL;
+
     /* Get Request Script */
-    const char* script_pathname = LuaEngine::sanitize(request->resource);
+    rqst->script = LuaEngine::sanitize(request->resource);
 
     /* Start Trace */
-    uint32_t trace_id = start_trace(INFO, lua_endpoint->getTraceId(), "lua_endpoint", "{\"rqst_id\":\"%s\", \"verb\":\"%s\", \"resource\":\"%s\"}", request->id, verb2str(request->verb), request->resource);
+    rqst->traceId = start_trace(INFO, getTraceId(), "lua_endpoint", "{\"rqst_id\":\"%s\", \"verb\":\"%s\", \"resource\":\"%s\"}", request->id, verb2str(request->verb), request->resource);
 
     /* Log Request */
-    mlog(lua_endpoint->logLevel, "%s %s: %s", verb2str(request->verb), request->resource, request->body);
+    mlog(logLevel, "%s %s: %s", verb2str(request->verb), request->resource, request->body);
 
     /* Update Metrics */
-    int32_t metric_id = lua_endpoint->getMetricId(request->resource);
+    int32_t metric_id = getMetricId(request->resource);
     if(metric_id != EventLib::INVALID_METRIC)
     {
         increment_metric(DEBUG, metric_id);
     }
 
-    /* Create Publisher */
-    Publisher* rspq = new Publisher(request->id);
+    /* Place Request - threads started by the script inherit the node */
+    rqst->placed = false;
+    if(place && Thread::getPlacement() == Thread::PLACE_NODE)
+    {
+        rqst->placed = Thread::bindNode(Thread::nextNode());
+    }
+
+    /* Create Publisher - a slow client holds back a streaming script once its response reaches the ceiling */
+    rqst->rspq = new Publisher(request->id);
+    if(request->verb == POST && streamCeiling > 0)
+    {
+        rqst->rspq->setMaxBytes(streamCeiling);
+
+        /* Spill Past the Ceiling - the script keeps running and the client reads the spill back in order */
+        streamMut.lock();
+        {
+            if(streamSpill)
+            {
+                SafeString spill_path("%s/%s.spill", streamSpill, request->id);
+                rqst->rspq->setSpill(spill_path.getString());
+            }
+        }
+        streamMut.unlock();
+    }
+
+    /* Open Resource Account */
+    rqst->account = RequestAccount::open(rqst->traceId);
+    rqst->previous = RequestAccount::attach(rqst->account);
+
+    /* Cancel Request When Client Leaves - the server's subscription to the response goes with the connection */
+    rqst->rspq->watchSubs(cancelRequest, rqst->account);
 
     /* Check Authentication */
-    bool authorized = false;
-    if(lua_endpoint->authenticator)
+    rqst->authorized = false;
+    if(authenticator)
     {
         char* bearer_token = NULL;
 
         /* Extract Bearer Token */
         const char* auth_hdr = NULL;
-        if(request->headers.find("Authorization", &auth_hdr))
+        if(request->getHeader("authorization", &auth_hdr))
         {
             bearer_token = StringLib::find(auth_hdr, ' ');
             if(bearer_token) bearer_token += 1;
         }
 
         /* Validate Bearer Token */
-        authorized = lua_endpoint->authenticator->isValid(bearer_token);
+        rqst->authorized = authenticator->isValid(bearer_token);
     }
     else // no authentication required
     {
-        authorized = true;
+        rqst->authorized = true;
     }
 
-    /* Dispatch Handle Request */
-    if(authorized)
-    {
-        switch(request->verb)
-        {
-            case GET:   lua_endpoint->normalResponse(script_pathname, request, rspq, trace_id); break;
-            case POST:  lua_endpoint->streamResponse(script_pathname, request, rspq, trace_id); break;
-            default:    break;
-        }
-    }
-    else
+    /* Respond to Unauthorized Request */
+    if(!rqst->authorized)
     {
         char header[MAX_HDR_SIZE];
         int header_length = buildheader(header, Unauthorized);
-        rspq->postCopy(header, header_length);
+        rqst->rspq->postCopy(header, header_length);
     }
 
+    return rqst;
+}
+
+/*----------------------------------------------------------------------------
+ * endRequest
+ *
+ *  everything done for a request after its script runs; called on the
+ *  thread the request's account is attached to, and frees the request
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::endRequest (request_t* rqst)
+{
     /* End Response */
-    rspq->postCopy("", 0);
+    rqst->rspq->postCopy("", 0);
+
+    /* Close Resource Account */
+    rqst->rspq->unwatchSubs(cancelRequest, rqst->account);
+    RequestAccount::count(RequestAccount::RSPQ_SPILL_BYTES, rqst->rspq->getSpillBytes());
+    RequestAccount::detach(rqst->previous);
+    rqst->account->peak(RequestAccount::RSPQ_PEAK_BYTES, rqst->rspq->getPeakBytes());
+    rqst->account->report();
+    rqst->account->release();
 
     /* Clean Up */
-    delete rspq;
-    delete [] script_pathname;
-    delete request;
-    delete info;
+    delete rqst->rspq;
+    delete [] rqst->script;
+    delete rqst->info->request;
+    delete rqst->info;
+
+    /* Release Placement - worker threads go on to serve other requests */
+    if(rqst->placed) Thread::bindNode(Thread::ANY_NODE);
 
     /* Stop Trace */
-    stop_trace(INFO, trace_id);
+    stop_trace(INFO, rqst->traceId);
+
+    delete rqst;
+}
+
+/*----------------------------------------------------------------------------
+ * cancelRequest
+ *
+ *  called when the last subscriber leaves a request's response queue; runs
+ *  with the queue locked, so it only flags the account
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::cancelRequest (void* parm)
+{
+    RequestAccount* account = (RequestAccount*)parm;
+    account->cancel();
+}
+
+/*----------------------------------------------------------------------------
+ * workerThread
+ *----------------------------------------------------------------------------*/
+void* LuaEndpoint::workerThread (void* parm)
+{
+    LuaEndpoint* lua_endpoint = (LuaEndpoint*)parm;
+
+    while(lua_endpoint->active)
+    {
+        EndpointObject::info_t* info = NULL;
+
+        /* Wait for Request */
+        lua_endpoint->requestSignal.lock();
+        {
+            if(lua_endpoint->requestQ.length() == 0)
+            {
+                lua_endpoint->requestSignal.wait(0, SYS_TIMEOUT);
+            }
+            if(lua_endpoint->active && lua_endpoint->requestQ.length() > 0)
+            {
+                info = lua_endpoint->requestQ[0];
+                lua_endpoint->requestQ.remove(0);
+            }
+        }
+        lua_endpoint->requestSignal.unlock();
+
+        /* Service Request */
+        if(info) requestThread(info);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * streamThread
+ *
+ *  runs streaming requests until no queued request is admitted into the
+ *  slot freed by the last one, or until a request's script is handed off to
+ *  the scheduler
+ *----------------------------------------------------------------------------*/
+void* LuaEndpoint::streamThread (void* parm)
+{
+    stream_t* stream = (stream_t*)parm;
+    LuaEndpoint* lua_endpoint = (LuaEndpoint*)stream->info->endpoint;
+
+    while(stream)
+    {
+        tenant_t* tenant = stream->tenant;
+
+        /* Run Request - once handed off to the scheduler the stream continues from asyncDone */
+        if(LuaEngine::isScheduled())
+        {
+            if(asyncRequest(stream)) break;
+        }
+        else
+        {
+            requestThread(stream->info);
+        }
+
+        delete stream;
+        stream = lua_endpoint->nextStream(tenant);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * warmerThread
+ *
+ *  creating a lua state and opening every extension library is the bulk of
+ *  the cost of starting a script; it is done here ahead of the requests
+ *----------------------------------------------------------------------------*/
+void* LuaEndpoint::warmerThread (void* parm)
+{
+    LuaEndpoint* lua_endpoint = (LuaEndpoint*)parm;
+
+    while(lua_endpoint->active)
+    {
+        /* Wait for Pool to Drain */
+        bool refill = false;
+        lua_endpoint->poolSignal.lock();
+        {
+            if(lua_endpoint->enginePool.length() >= lua_endpoint->enginePoolSize)
+            {
+                lua_endpoint->poolSignal.wait(0, SYS_TIMEOUT);
+            }
+            refill = lua_endpoint->enginePool.length() < lua_endpoint->enginePoolSize;
+        }
+        lua_endpoint->poolSignal.unlock();
+
+        /* Add Engine to Pool */
+        if(refill && lua_endpoint->active)
+        {
+            LuaEngine* engine = new LuaEngine();
+            lua_endpoint->poolSignal.lock();
+            {
+                lua_endpoint->enginePool.add(engine);
+            }
+            lua_endpoint->poolSignal.unlock();
+        }
+    }
 
-    /* Return */
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * acquireEngine
+ *
+ *  engines are not returned to the pool; a script leaves globals and lua
+ *  objects behind in its state, so every request gets a fresh one
+ *----------------------------------------------------------------------------*/
+LuaEngine* LuaEndpoint::acquireEngine (const char* scriptpath, const char* arg, uint32_t trace_id)
+{
+    LuaEngine* engine = NULL;
+
+    /* Take Pre-Warmed Engine */
+    poolSignal.lock();
+    {
+        int num_engines = enginePool.length();
+        if(num_engines > 0)
+        {
+            engine = enginePool[num_engines - 1];
+            enginePool.remove(num_engines - 1);
+            poolSignal.signal();
+        }
+    }
+    poolSignal.unlock();
+
+    /* Pool Exhausted */
+    if(!engine)
+    {
+        engine = new LuaEngine();
+    }
+
+    /* Supply Script */
+    engine->prepare(scriptpath, arg, trace_id);
+
+    return engine;
+}
+
 /*----------------------------------------------------------------------------
  * handleRequest
  *----------------------------------------------------------------------------*/
@@ -277,14 +650,225 @@ EndpointObject::rsptype_t LuaEndpoint::handleRequest (Request* request)
     info->endpoint = this;
     info->request = request;
 
-    /* Start Thread */
-    Thread pid(requestThread, info, false);
+    if(request->verb == POST)
+    {
+        /* Admit Streaming Request */
+        admitStream(info);
+    }
+    else
+    {
+        /* Queue to Workers */
+        requestSignal.lock();
+        {
+            requestQ.add(info);
+            requestSignal.signal(0, Cond::NOTIFY_ONE);
+        }
+        requestSignal.unlock();
+    }
 
     /* Return Response Type */
     if(request->verb == POST)   return STREAMING;
     else                        return NORMAL;
 }
 
+/*----------------------------------------------------------------------------
+ * admitStream
+ *
+ *  streaming requests are queued per endpoint and principal once the limit
+ *  on running streams is reached, and rejected once that queue is full
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::admitStream (info_t* info)
+{
+    char principal[MAX_PRINCIPAL_SIZE];
+    getPrincipal(info->request, principal);
+    SafeString key("%s:%s", info->request->resource, principal);
+
+    stream_t* stream = NULL;
+    bool rejected = false;
+
+    streamMut.lock();
+    {
+        /* Get Tenant */
+        tenant_t* tenant;
+        if(!tenants.find(key.getString(), &tenant))
+        {
+            tenant = new tenant_t;
+            StringLib::copy(tenant->principal, principal, MAX_PRINCIPAL_SIZE);
+            tenant->running = 0;
+            tenant->admitted = 0;
+            tenant->rejected = 0;
+            tenant->queueTime = 0.0;
+            tenant->maxQueueTime = 0.0;
+            tenants.add(key.getString(), tenant);
+        }
+
+        /* Run, Queue, or Reject */
+        if(maxStreams <= 0 || runningStreams < maxStreams)
+        {
+            tenant->running++;
+            tenant->admitted++;
+            runningStreams++;
+            stream = new stream_t;
+            stream->info = info;
+            stream->tenant = tenant;
+        }
+        else if(tenant->queue.length() < maxQueuedStreams)
+        {
+            queued_stream_t queued = {
+                .info = info,
+                .enqueued = TimeLib::latchtime()
+            };
+            tenant->queue.add(queued);
+        }
+        else
+        {
+            tenant->rejected++;
+            rejected = true;
+        }
+    }
+    streamMut.unlock();
+
+    if(stream)
+    {
+        startStream(stream);
+    }
+    else if(rejected)
+    {
+        mlog(WARNING, "Rejected request %s for %s, %d streams already queued", info->request->id, key.getString(), maxQueuedStreams);
+        rejectRequest(info, Too_Many_Requests);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * nextStream
+ *
+ *  frees the slot of a finished stream and admits the next queued request
+ *  into it, if any
+ *----------------------------------------------------------------------------*/
+LuaEndpoint::stream_t* LuaEndpoint::nextStream (tenant_t* finished)
+{
+    stream_t* stream = NULL;
+
+    streamMut.lock();
+    {
+        finished->running--;
+        runningStreams--;
+        if(active && (maxStreams <= 0 || runningStreams < maxStreams))
+        {
+            stream = pickStream();
+        }
+    }
+    streamMut.unlock();
+
+    return stream;
+}
+
+/*----------------------------------------------------------------------------
+ * pickStream
+ *
+ *  weighted fair share of the running slots: the queued request of the
+ *  tenant with the fewest running streams per unit of weight is admitted,
+ *  the longest waiting one on a tie; must be called with streamMut locked
+ *----------------------------------------------------------------------------*/
+LuaEndpoint::stream_t* LuaEndpoint::pickStream (void)
+{
+    tenant_t* selected = NULL;
+    double selected_share = 0.0;
+
+    tenant_t* tenant;
+    const char* key = tenants.first(&tenant);
+    while(key != NULL)
+    {
+        if(tenant->queue.length() > 0)
+        {
+            int weight = DEFAULT_PRINCIPAL_WEIGHT;
+            principalWeights.find(tenant->principal, &weight);
+            double share = (tenant->running + 1) / (double)MAX(weight, 1);
+            if( !selected || (share < selected_share) ||
+                (share == selected_share && tenant->queue[0].enqueued < selected->queue[0].enqueued) )
+            {
+                selected = tenant;
+                selected_share = share;
+            }
+        }
+        key = tenants.next(&tenant);
+    }
+
+    if(!selected) return NULL;
+
+    /* Dequeue Request */
+    queued_stream_t queued = selected->queue[0];
+    selected->queue.remove(0);
+    double queue_time = TimeLib::latchtime() - queued.enqueued;
+    selected->queueTime += queue_time;
+    selected->maxQueueTime = MAX(selected->maxQueueTime, queue_time);
+    selected->running++;
+    selected->admitted++;
+    runningStreams++;
+    mlog(DEBUG, "Admitted request %s after %.3lf seconds queued", queued.info->request->id, queue_time);
+
+    stream_t* stream = new stream_t;
+    stream->info = queued.info;
+    stream->tenant = selected;
+    return stream;
+}
+
+/*----------------------------------------------------------------------------
+ * startStream
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::startStream (stream_t* stream)
+{
+    /* Start Thread - streaming scripts can run indefinitely */
+    Thread::attr_t attr = {.name = "lua.request", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+    Thread pid(streamThread, stream, attr, false);
+}
+
+/*----------------------------------------------------------------------------
+ * rejectRequest
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::rejectRequest (info_t* info, code_t code)
+{
+    Publisher rspq(info->request->id);
+    char header[MAX_HDR_SIZE];
+    int header_length = buildheader(header, code);
+    rspq.postCopy(header, header_length);
+    rspq.postCopy("", 0);
+    delete info->request;
+    delete info;
+}
+
+/*----------------------------------------------------------------------------
+ * getPrincipal
+ *
+ *  requests are attributed to a hash of their bearer token so that tokens
+ *  are never kept or reported
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::getPrincipal (Request* request, char* principal)
+{
+    const char* auth_hdr = NULL;
+    const char* bearer_token = NULL;
+    if(request->getHeader("authorization", &auth_hdr))
+    {
+        bearer_token = StringLib::find(auth_hdr, ' ');
+        if(bearer_token) bearer_token += 1;
+    }
+
+    if(bearer_token && *bearer_token)
+    {
+        uint32_t hash = 2166136261U; // FNV-1a
+        for(const char* c = bearer_token; *c; c++)
+        {
+            hash ^= (uint8_t)*c;
+            hash *= 16777619U;
+        }
+        StringLib::format(principal, MAX_PRINCIPAL_SIZE, "token.%08X", hash);
+    }
+    else
+    {
+        StringLib::copy(principal, "anonymous", MAX_PRINCIPAL_SIZE);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * normalResponse
  *----------------------------------------------------------------------------*/
@@ -300,7 +884,7 @@ void LuaEndpoint::normalResponse (const char* scriptpath, Request* request, Publ
         ((mem = LocalLib::memusage()) < normalRequestMemoryThreshold) )
     {
         /* Launch Engine */
-        engine = new LuaEngine(scriptpath, (const char*)request->body, trace_id, NULL, true);
+        engine = acquireEngine(scriptpath, (const char*)request->body, trace_id);
         bool status = engine->executeEngine(MAX_RESPONSE_TIME_MS);
 
         /* Send Response */
@@ -342,6 +926,27 @@ void LuaEndpoint::normalResponse (const char* scriptpath, Request* request, Publ
  * streamResponse
  *----------------------------------------------------------------------------*/
 void LuaEndpoint::streamResponse (const char* scriptpath, Request* request, Publisher* rspq, uint32_t trace_id)
+{
+    LuaEngine* engine = streamStart(scriptpath, request, rspq, trace_id);
+    if(engine)
+    {
+        /* Execute Engine
+        *  The call to execute the script blocks on completion of the script. The lua state context
+        *  is locked and cannot be accessed until the script completes */
+        engine->executeEngine(IO_PEND);
+
+        /* Report and Clean Up */
+        streamFinish(engine, rspq);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * streamStart
+ *
+ *  sends the response header and returns the engine ready to run the script,
+ *  or NULL if the request is refused
+ *----------------------------------------------------------------------------*/
+LuaEngine* LuaEndpoint::streamStart (const char* scriptpath, Request* request, Publisher* rspq, uint32_t trace_id)
 {
     char header[MAX_HDR_SIZE];
     double mem;
@@ -357,16 +962,11 @@ void LuaEndpoint::streamResponse (const char* scriptpath, Request* request, Publ
         rspq->postCopy(header, header_length);
 
         /* Create Engine */
-        engine = new LuaEngine(scriptpath, (const char*)request->body, trace_id, NULL, true);
+        engine = acquireEngine(scriptpath, (const char*)request->body, trace_id);
 
         /* Supply Global Variables to Script */
         engine->setString(LUA_RESPONSE_QUEUE, rspq->getName());
         engine->setString(LUA_REQUEST_ID, request->id);
-
-        /* Execute Engine
-        *  The call to execute the script blocks on completion of the script. The lua state context
-        *  is locked and cannot be accessed until the script completes */
-        engine->executeEngine(IO_PEND);
     }
     else
     {
@@ -375,8 +975,29 @@ void LuaEndpoint::streamResponse (const char* scriptpath, Request* request, Publ
         rspq->postCopy(header, header_length);
     }
 
+    return engine;
+}
+
+/*----------------------------------------------------------------------------
+ * streamFinish
+ *
+ *  reports the resources used by a finished script and deletes its engine
+ *----------------------------------------------------------------------------*/
+void LuaEndpoint::streamFinish (LuaEngine* engine, Publisher* rspq)
+{
+    /* Report Resources Used */
+    RequestAccount* rqst_account = RequestAccount::share();
+    if(rqst_account)
+    {
+        char resources[MAX_EXCEPTION_TEXT_SIZE];
+        rqst_account->peak(RequestAccount::RSPQ_PEAK_BYTES, rspq->getPeakBytes());
+        rqst_account->toJson(resources, sizeof(resources));
+        generateExceptionStatus(RTE_INFO, INFO, rspq, NULL, "resources: %s", resources);
+        rqst_account->release();
+    }
+
     /* Clean Up */
-    if(engine) delete engine;
+    delete engine;
 }
 
 /*----------------------------------------------------------------------------
@@ -483,3 +1104,193 @@ int LuaEndpoint::luaAuth (lua_State* L)
     /* Return Status */
     return returnLuaStatus(L, status);
 }
+
+/*----------------------------------------------------------------------------
+ * luaAdmission - :admission(<max running streams>, [<max queued streams>])
+ *
+ *  zero running streams is unlimited; the queue limit applies to each
+ *  endpoint and principal
+ *----------------------------------------------------------------------------*/
+int LuaEndpoint::luaAdmission (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        LuaEndpoint* lua_obj = (LuaEndpoint*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        long max_streams = getLuaInteger(L, 2);
+        long max_queued = getLuaInteger(L, 3, true, lua_obj->maxQueuedStreams);
+        if(max_streams < 0 || max_queued < 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid admission limits: %ld, %ld", max_streams, max_queued);
+        }
+
+        /* Set Limits and Admit Requests Into Any New Slots */
+        List<stream_t*> started;
+        lua_obj->streamMut.lock();
+        {
+            lua_obj->maxStreams = max_streams;
+            lua_obj->maxQueuedStreams = max_queued;
+            while(lua_obj->maxStreams <= 0 || lua_obj->runningStreams < lua_obj->maxStreams)
+            {
+                stream_t* stream = lua_obj->pickStream();
+                if(!stream) break;
+                started.add(stream);
+            }
+        }
+        lua_obj->streamMut.unlock();
+        for(int i = 0; i < started.length(); i++)
+        {
+            lua_obj->startStream(started[i]);
+        }
+
+        /* Set return Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting admission limits: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaWeight - :weight(<principal>, <weight>)
+ *
+ *  principals are as reported by :tenants()
+ *----------------------------------------------------------------------------*/
+int LuaEndpoint::luaWeight (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        LuaEndpoint* lua_obj = (LuaEndpoint*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        const char* principal = getLuaString(L, 2);
+        int weight = (int)getLuaInteger(L, 3);
+        if(weight <= 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "weight must be greater than zero: %d", weight);
+        }
+
+        /* Set Weight */
+        lua_obj->streamMut.lock();
+        {
+            lua_obj->principalWeights.add(principal, weight);
+        }
+        lua_obj->streamMut.unlock();
+
+        /* Set return Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting weight: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaCeiling - :ceiling(<bytes>, [<spill directory>])
+ *
+ *  bounds the data a streamed response holds before the client reads it;
+ *  producers posting to the response queue wait at the ceiling, and the
+ *  readers and dispatchers feeding them stop pulling more data in turn; when
+ *  a spill directory is given, posts past the ceiling are written to a file
+ *  there instead and are read back in order as the client catches up, so the
+ *  request completes without holding its data in memory
+ *----------------------------------------------------------------------------*/
+int LuaEndpoint::luaCeiling (lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        LuaEndpoint* lua_obj = (LuaEndpoint*)getLuaSelf(L, 1);
+
+        /* Get Ceiling */
+        long ceiling = getLuaInteger(L, 2);
+        if(ceiling < 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid ceiling: %ld", ceiling);
+        }
+
+        /* Get Spill Directory */
+        const char* spill_dir = getLuaString(L, 3, true, NULL);
+
+        /* Set Ceiling - applies to requests started afterwards */
+        lua_obj->streamMut.lock();
+        {
+            lua_obj->streamCeiling = ceiling;
+            if(lua_obj->streamSpill) delete [] lua_obj->streamSpill;
+            lua_obj->streamSpill = StringLib::duplicate(spill_dir);
+        }
+        lua_obj->streamMut.unlock();
+
+        /* Set return Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting stream ceiling: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaTenants - :tenants() --> {<endpoint:principal>: {stats}}
+ *----------------------------------------------------------------------------*/
+int LuaEndpoint::luaTenants (lua_State* L)
+{
+    try
+    {
+        /* Get Self */
+        LuaEndpoint* lua_obj = (LuaEndpoint*)getLuaSelf(L, 1);
+
+        /* Build Table of Tenants */
+        lua_newtable(L);
+        lua_obj->streamMut.lock();
+        {
+            tenant_t* tenant;
+            const char* key = lua_obj->tenants.first(&tenant);
+            while(key != NULL)
+            {
+                int weight = DEFAULT_PRINCIPAL_WEIGHT;
+                lua_obj->principalWeights.find(tenant->principal, &weight);
+                lua_pushstring(L, key);
+                lua_newtable(L);
+                LuaEngine::setAttrStr(L, "principal", tenant->principal);
+                LuaEngine::setAttrInt(L, "weight", weight);
+                LuaEngine::setAttrInt(L, "running", tenant->running);
+                LuaEngine::setAttrInt(L, "queued", tenant->queue.length());
+                LuaEngine::setAttrNum(L, "admitted", tenant->admitted);
+                LuaEngine::setAttrNum(L, "rejected", tenant->rejected);
+                LuaEngine::setAttrNum(L, "queue_time", tenant->queueTime);
+                LuaEngine::setAttrNum(L, "max_queue_time", tenant->maxQueueTime);
+                lua_settable(L, -3);
+                key = lua_obj->tenants.next(&tenant);
+            }
+        }
+        lua_obj->streamMut.unlock();
+
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error getting tenants: %s", e.what());
+        return returnLuaStatus(L, false);
+    }
+}
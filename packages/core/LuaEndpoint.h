@@ -69,6 +69,13 @@ class LuaEndpoint: public EndpointObject
         static const int MAX_RESPONSE_TIME_MS = 5000;
         static const int INITIAL_NUM_ENDPOINTS = 32;
         static const int MAX_EXCEPTION_TEXT_SIZE = 256;
+        static const int DEFAULT_NUM_WORKERS = 4;
+        static const int DEFAULT_ENGINE_POOL_SIZE = 4;
+        static const int DEFAULT_MAX_STREAMS = 0; // unlimited
+        static const int DEFAULT_MAX_QUEUED_STREAMS = 64; // per endpoint and principal
+        static const int DEFAULT_PRINCIPAL_WEIGHT = 1;
+        static const long DEFAULT_STREAM_CEILING = 0; // bytes a streamed response may hold unsent, 0 is unlimited
+        static const int MAX_PRINCIPAL_SIZE = 32;
         static const char* LUA_RESPONSE_QUEUE;
         static const char* LUA_REQUEST_ID;
         static const char* UNREGISTERED_ENDPOINT;
@@ -118,24 +125,88 @@ class LuaEndpoint: public EndpointObject
 
     protected:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Streaming Request Waiting for a Slot */
+        typedef struct {
+            info_t*         info;
+            double          enqueued;       // time queued, seconds
+        } queued_stream_t;
+
+        /* Streaming Requests to One Endpoint From One Principal */
+        typedef struct {
+            List<queued_stream_t> queue;
+            char            principal[MAX_PRINCIPAL_SIZE];
+            int             running;
+            long            admitted;
+            long            rejected;
+            double          queueTime;      // total time admitted requests waited, seconds
+            double          maxQueueTime;
+        } tenant_t;
+
+        /* Streaming Request Holding a Slot */
+        typedef struct {
+            info_t*         info;
+            tenant_t*       tenant;
+        } stream_t;
+
+        /* Request in Progress */
+        typedef struct {
+            info_t*         info;
+            stream_t*       stream;         // slot held by a streaming request run on the scheduler
+            const char*     script;
+            uint32_t        traceId;
+            Publisher*      rspq;
+            RequestAccount* account;
+            RequestAccount* previous;       // account attached to the thread before the request's
+            LuaEngine*      engine;
+            bool            placed;
+            bool            authorized;
+        } request_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                            LuaEndpoint     (lua_State* L, double normal_mem_thresh, double stream_mem_thresh, event_level_t lvl);
+                            LuaEndpoint     (lua_State* L, double normal_mem_thresh, double stream_mem_thresh, event_level_t lvl, int num_workers, int pool_size);
         virtual             ~LuaEndpoint    (void);
 
         static void*        requestThread   (void* parm);
+        static bool         asyncRequest    (stream_t* stream);
+        static void         asyncDone       (LuaEngine* engine, void* parm);
+        request_t*          beginRequest    (info_t* info, bool place);
+        static void         endRequest      (request_t* rqst);
+        static void         cancelRequest   (void* parm);
+        static void*        workerThread    (void* parm);
+        static void*        warmerThread    (void* parm);
+        static void*        streamThread    (void* parm);
+
+        void                admitStream     (info_t* info);
+        stream_t*           nextStream      (tenant_t* finished);
+        stream_t*           pickStream      (void);
+        void                startStream     (stream_t* stream);
+        static void         rejectRequest   (info_t* info, code_t code);
+        static void         getPrincipal    (Request* request, char* principal);
+
+        LuaEngine*          acquireEngine   (const char* scriptpath, const char* arg, uint32_t trace_id);
 
         rsptype_t           handleRequest   (Request* request) override;
 
         void                normalResponse  (const char* scriptpath, Request* request, Publisher* rspq, uint32_t trace_id);
         void                streamResponse  (const char* scriptpath, Request* request, Publisher* rspq, uint32_t trace_id);
+        LuaEngine*          streamStart     (const char* scriptpath, Request* request, Publisher* rspq, uint32_t trace_id);
+        void                streamFinish    (LuaEngine* engine, Publisher* rspq);
 
         int32_t             getMetricId     (const char* endpoint);
 
         static int          luaMetric       (lua_State* L);
         static int          luaAuth         (lua_State* L);
+        static int          luaAdmission    (lua_State* L);
+        static int          luaWeight       (lua_State* L);
+        static int          luaTenants      (lua_State* L);
+        static int          luaCeiling      (lua_State* L);
 
         /*--------------------------------------------------------------------
          * Data
@@ -147,6 +218,24 @@ class LuaEndpoint: public EndpointObject
         double              streamRequestMemoryThreshold;
         event_level_t       logLevel;
         Authenticator*      authenticator;
+
+        bool                active;
+        Thread**            workerPids;     // persistent threads serving normal requests
+        int                 numWorkers;
+        List<info_t*>       requestQ;
+        Cond                requestSignal;
+        Thread*             warmerPid;      // keeps the engine pool filled
+        List<LuaEngine*>    enginePool;     // pre-warmed engines, each used for a single request
+        int                 enginePoolSize;
+        Cond                poolSignal;
+        Mutex               streamMut;      // admission of streaming requests
+        Dictionary<tenant_t*> tenants;      // by endpoint and principal
+        Dictionary<int>     principalWeights;
+        int                 maxStreams;     // streaming requests run at once, 0 is unlimited
+        int                 maxQueuedStreams;
+        int                 runningStreams;
+        long                streamCeiling;  // bytes of a streamed response held before the script waits on the client
+        const char*         streamSpill;    // directory a streamed response spills to past the ceiling instead of waiting, NULL is no spilling
 };
 
 #endif  /* __lua_endpoint__ */
@@ -52,6 +52,16 @@ Mutex LuaEngine::pkgInitTableMutex;
 
 std::atomic<uint64_t> LuaEngine::engineIds{1};
 
+Dictionary<LuaEngine::chunk_t> LuaEngine::chunkCache;
+Mutex LuaEngine::chunkCacheMutex;
+
+Cond LuaEngine::schedSignal;
+List<LuaEngine*> LuaEngine::readyQ;
+List<LuaEngine*> LuaEngine::sleepQ;
+Thread** LuaEngine::schedPids = NULL;
+int LuaEngine::numSchedThreads = 0;
+bool LuaEngine::schedActive = false;
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -69,6 +79,13 @@ LuaEngine::LuaEngine(const char* name, int lua_argc, char lua_argv[][MAX_LUA_ARG
     traceId         = start_trace(CRITICAL, trace_id, "lua_engine", "{\"name\":\"%s\"}", name);
     dInfo           = NULL;
     L               = createState(hook);
+    co              = NULL;
+    coState         = CO_IDLE;
+    wakePending     = false;
+    wakeTimeout     = false;
+    wakeDeadline    = 0.0;
+    onDone          = NULL;
+    onDoneParm      = NULL;
 
     /* Create Lua Thread */
     if(lua_argc > 0) assert(lua_argv);
@@ -107,12 +124,20 @@ LuaEngine::LuaEngine(const char* script, const char* arg, uint32_t trace_id, lua
     traceId         = start_trace(CRITICAL, trace_id, "lua_engine", "{\"script\":\"%s\"}", script);
     pInfo           = NULL;
     L               = createState(hook);
+    co              = NULL;
+    coState         = CO_IDLE;
+    wakePending     = false;
+    wakeTimeout     = false;
+    wakeDeadline    = 0.0;
+    onDone          = NULL;
+    onDoneParm      = NULL;
 
     /* Create Script Thread */
     dInfo = new directThread_t;
     dInfo->engine = this;
     dInfo->script = StringLib::duplicate(script);
     dInfo->arg    = StringLib::duplicate(arg, 0);
+    dInfo->account = RequestAccount::share();
 
     /* Start Script Thread */
     engineActive = false;
@@ -123,6 +148,33 @@ LuaEngine::LuaEngine(const char* script, const char* arg, uint32_t trace_id, lua
     }
 }
 
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  DIRECT_MODE - state is created ahead of time; script supplied by prepare
+ *----------------------------------------------------------------------------*/
+LuaEngine::LuaEngine(luaStepHook hook)
+{
+    /* Initialize Parameters */
+    engineId        = engineIds++;
+    mode            = DIRECT_MODE;
+    traceId         = ORIGIN;
+    pInfo           = NULL;
+    dInfo           = NULL;
+    L               = createState(hook);
+    co              = NULL;
+    coState         = CO_IDLE;
+    wakePending     = false;
+    wakeTimeout     = false;
+    wakeDeadline    = 0.0;
+    onDone          = NULL;
+    onDoneParm      = NULL;
+
+    /* Script Thread Started by executeEngine */
+    engineActive    = false;
+    engineThread    = NULL;
+}
+
 /*----------------------------------------------------------------------------
  * Destructor
  *----------------------------------------------------------------------------*/
@@ -139,6 +191,7 @@ LuaEngine::~LuaEngine(void)
     {
         if(dInfo->script) delete [] dInfo->script;
         if(dInfo->arg) delete [] dInfo->arg;
+        if(dInfo->account) dInfo->account->release();
         delete dInfo;
     }
 
@@ -152,8 +205,8 @@ LuaEngine::~LuaEngine(void)
         delete pInfo;
     }
 
-    /* Stop Trace */
-    stop_trace(CRITICAL, traceId);
+    /* Stop Trace (pre-warmed engines that were never prepared have none) */
+    if(dInfo || pInfo) stop_trace(CRITICAL, traceId);
 }
 
 /*----------------------------------------------------------------------------
@@ -168,6 +221,16 @@ void LuaEngine::init(void)
  *----------------------------------------------------------------------------*/
 void LuaEngine::deinit(void)
 {
+    /* Stop Scheduler */
+    schedActive = false;
+    for(int i = 0; i < numSchedThreads; i++)
+    {
+        delete schedPids[i];
+    }
+    delete [] schedPids;
+    schedPids = NULL;
+    numSchedThreads = 0;
+
     /* Free memory stored in pkgInitTable list */
     pkgInitTableMutex.lock();
     {
@@ -190,6 +253,20 @@ void LuaEngine::deinit(void)
         }
     }
     libInitTableMutex.unlock();
+
+    /* Free compiled scripts */
+    chunkCacheMutex.lock();
+    {
+        chunk_t chunk;
+        const char* key = chunkCache.first(&chunk);
+        while(key != NULL)
+        {
+            delete [] chunk.data;
+            key = chunkCache.next(&chunk);
+        }
+        chunkCache.clear();
+    }
+    chunkCacheMutex.unlock();
 }
 
 /*----------------------------------------------------------------------------
@@ -371,6 +448,144 @@ const char* LuaEngine::sanitize (const char* filename)
     return safe_pathname.getString(true);
 }
 
+/*----------------------------------------------------------------------------
+ * luaScheduler - core.scheduler(<number of threads>)
+ *
+ *  starts a pool of threads that run streaming scripts as coroutines; a
+ *  script that blocks in a call able to suspend (e.g. waiton) yields its
+ *  thread to other scripts until it is woken.  The pool can be started once
+ *----------------------------------------------------------------------------*/
+int LuaEngine::luaScheduler (lua_State* L)
+{
+    bool status = false;
+
+    int num_threads = (int)luaL_checkinteger(L, 1);
+
+    schedSignal.lock();
+    {
+        if(schedActive)
+        {
+            mlog(CRITICAL, "Scheduler already running with %d threads", numSchedThreads);
+        }
+        else if(num_threads <= 0 || num_threads > MAX_SCHEDULER_THREADS)
+        {
+            mlog(CRITICAL, "Invalid number of scheduler threads: %d", num_threads);
+        }
+        else
+        {
+            schedActive = true;
+            numSchedThreads = num_threads;
+            schedPids = new Thread* [numSchedThreads];
+            for(int i = 0; i < numSchedThreads; i++)
+            {
+                Thread::attr_t attr = {.name = "lua.sched", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+                schedPids[i] = new Thread(schedulerThread, NULL, attr);
+            }
+            status = true;
+        }
+    }
+    schedSignal.unlock();
+
+    lua_pushboolean(L, status);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * isScheduled
+ *----------------------------------------------------------------------------*/
+bool LuaEngine::isScheduled (void)
+{
+    return schedActive;
+}
+
+/*----------------------------------------------------------------------------
+ * getEngine
+ *----------------------------------------------------------------------------*/
+LuaEngine* LuaEngine::getEngine (lua_State* L)
+{
+    lua_pushstring(L, LUA_SELFKEY);
+    lua_gettable(L, LUA_REGISTRYINDEX); /* retrieve value */
+    LuaEngine* engine = (LuaEngine*)lua_touserdata(L, -1);
+    lua_pop(L, 1);
+    return engine;
+}
+
+/*----------------------------------------------------------------------------
+ * canSuspend
+ *
+ *  only the script's own coroutine is suspended; a coroutine the script
+ *  creates itself would yield back into the script
+ *----------------------------------------------------------------------------*/
+bool LuaEngine::canSuspend (lua_State* L)
+{
+    LuaEngine* engine = getEngine(L);
+    return engine && (engine->co == L) && lua_isyieldable(L);
+}
+
+/*----------------------------------------------------------------------------
+ * suspend
+ *
+ *  yields the script's coroutine until wake is called on its engine or the
+ *  timeout expires, then continues in k; only called when canSuspend is true.
+ *  Wakes may be spurious, so k rechecks what it waits on
+ *----------------------------------------------------------------------------*/
+int LuaEngine::suspend (lua_State* L, int timeout_ms, lua_KFunction k, lua_KContext ctx)
+{
+    LuaEngine* engine = getEngine(L);
+
+    schedSignal.lock();
+    {
+        engine->wakeTimeout = false;
+        if(timeout_ms < 0)  engine->wakeDeadline = 0.0;
+        else                engine->wakeDeadline = TimeLib::latchtime() + (timeout_ms / 1000.0);
+    }
+    schedSignal.unlock();
+
+    return lua_yieldk(L, 0, ctx, k);
+}
+
+/*----------------------------------------------------------------------------
+ * timedOut
+ *----------------------------------------------------------------------------*/
+bool LuaEngine::timedOut (lua_State* L)
+{
+    LuaEngine* engine = getEngine(L);
+    return engine && engine->wakeTimeout;
+}
+
+/*----------------------------------------------------------------------------
+ * wake
+ *
+ *  safe to call from any thread, and before the engine has finished yielding
+ *----------------------------------------------------------------------------*/
+void LuaEngine::wake (void* parm)
+{
+    LuaEngine* engine = (LuaEngine*)parm;
+
+    schedSignal.lock();
+    {
+        if(engine->coState == CO_SUSPENDED)
+        {
+            for(int i = 0; i < sleepQ.length(); i++)
+            {
+                if(sleepQ[i] == engine)
+                {
+                    sleepQ.remove(i);
+                    break;
+                }
+            }
+            engine->coState = CO_READY;
+            readyQ.add(engine);
+            schedSignal.signal(0, Cond::NOTIFY_ONE);
+        }
+        else if(engine->coState == CO_RUNNING)
+        {
+            engine->wakePending = true;
+        }
+    }
+    schedSignal.unlock();
+}
+
 /*----------------------------------------------------------------------------
  * getEngineId
  *----------------------------------------------------------------------------*/
@@ -379,6 +594,37 @@ uint64_t LuaEngine::getEngineId(void)
     return engineId;
 }
 
+/*----------------------------------------------------------------------------
+ * prepare
+ *
+ *  supplies the script to a pre-warmed engine; called once, before executeEngine
+ *----------------------------------------------------------------------------*/
+void LuaEngine::prepare(const char* script, const char* arg, uint32_t trace_id)
+{
+    engineSignal.lock();
+    {
+        if(mode == DIRECT_MODE && dInfo == NULL)
+        {
+            /* Start Trace */
+            traceId = start_trace(CRITICAL, trace_id, "lua_engine", "{\"script\":\"%s\"}", script);
+            lua_pushnumber(L, traceId);
+            lua_setglobal(L, LUA_TRACEID);
+
+            /* Create Script Thread Info */
+            dInfo = new directThread_t;
+            dInfo->engine = this;
+            dInfo->script = StringLib::duplicate(script);
+            dInfo->arg    = StringLib::duplicate(arg, 0);
+            dInfo->account = RequestAccount::share();
+        }
+        else
+        {
+            mlog(CRITICAL, "Unable to prepare engine %lu, script already supplied", (unsigned long)engineId);
+        }
+    }
+    engineSignal.unlock();
+}
+
 /*----------------------------------------------------------------------------
  * executeEngine
  *----------------------------------------------------------------------------*/
@@ -414,6 +660,71 @@ bool LuaEngine::executeEngine(int timeout_ms)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * executeAsync
+ *
+ *  runs a prepared direct mode script as a coroutine on the scheduler and
+ *  returns immediately; done is called from a scheduler thread once the
+ *  script finishes, and may delete the engine.  Returns false, without
+ *  running the script, if the scheduler is not running
+ *----------------------------------------------------------------------------*/
+bool LuaEngine::executeAsync(doneFunc done, void* parm)
+{
+    bool status = false;
+    bool loaded = false;
+
+    engineSignal.lock();
+    {
+        if(schedActive && !engineActive && mode == DIRECT_MODE && dInfo)
+        {
+            /* Create Arg Table */
+            lua_createtable(L, 1, 0);
+            lua_pushstring(L, dInfo->arg);
+            lua_rawseti(L, -2, 1);
+            lua_setglobal(L, "arg");
+
+            /* Create Coroutine - left on the main stack so it is not collected */
+            co = lua_newthread(L);
+            onDone = done;
+            onDoneParm = parm;
+            engineActive = true;
+            status = true;
+
+            /* Load Script */
+            if(loadScript(co, dInfo->script) == LUA_OK)
+            {
+                loaded = true;
+            }
+            else
+            {
+                lua_xmove(co, L, 1);
+                logErrorMessage();
+                engineActive = false;
+                engineSignal.signal(ENGINE_EXIT_SIGNAL);
+            }
+        }
+    }
+    engineSignal.unlock();
+
+    /* Schedule Script */
+    if(loaded)
+    {
+        schedSignal.lock();
+        {
+            coState = CO_READY;
+            readyQ.add(this);
+            schedSignal.signal(0, Cond::NOTIFY_ONE);
+        }
+        schedSignal.unlock();
+    }
+    else if(status && onDone)
+    {
+        onDone(this, onDoneParm);
+    }
+
+    return status;
+}
+
 /*----------------------------------------------------------------------------
  * isActive
  *----------------------------------------------------------------------------*/
@@ -559,6 +870,9 @@ void* LuaEngine::directThread (void* parm)
 {
     directThread_t* d = (directThread_t*)parm;
 
+    /* Charge Script to Request */
+    RequestAccount* previous = RequestAccount::attach(d->account);
+
     d->engine->engineSignal.lock();
     {
         lua_State* L = d->engine->L;
@@ -570,7 +884,7 @@ void* LuaEngine::directThread (void* parm)
         lua_setglobal(L, "arg");
 
         /* Execute Script */
-        int status = luaL_loadfile(L, d->script);
+        int status = loadScript(L, d->script);
         if(status == LUA_OK)
         {
             status = lua_pcall(L, 0, LUA_MULTRET, 0);
@@ -582,6 +896,9 @@ void* LuaEngine::directThread (void* parm)
             d->engine->logErrorMessage();
         }
 
+        /* Settle Account before Request can Report It */
+        RequestAccount::detach(previous);
+
         /* Set Inactive */
         d->engine->engineActive = false;
         d->engine->engineSignal.signal(ENGINE_EXIT_SIGNAL);
@@ -591,6 +908,233 @@ void* LuaEngine::directThread (void* parm)
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * schedulerThread
+ *----------------------------------------------------------------------------*/
+void* LuaEngine::schedulerThread (void* parm)
+{
+    (void)parm;
+
+    while(schedActive)
+    {
+        LuaEngine* engine = NULL;
+
+        schedSignal.lock();
+        {
+            /* Ready Engines Whose Deadline Passed */
+            double now = TimeLib::latchtime();
+            double next_deadline = 0.0;
+            for(int i = sleepQ.length() - 1; i >= 0; i--)
+            {
+                LuaEngine* sleeper = sleepQ[i];
+                if(sleeper->wakeDeadline <= now)
+                {
+                    sleepQ.remove(i);
+                    sleeper->wakeTimeout = true;
+                    sleeper->coState = CO_READY;
+                    readyQ.add(sleeper);
+                }
+                else if(next_deadline == 0.0 || sleeper->wakeDeadline < next_deadline)
+                {
+                    next_deadline = sleeper->wakeDeadline;
+                }
+            }
+
+            /* Wait for Ready Engine */
+            if(readyQ.length() == 0)
+            {
+                int timeout_ms = SYS_TIMEOUT;
+                if(next_deadline > 0.0) timeout_ms = MIN(timeout_ms, (int)((next_deadline - now) * 1000.0) + 1);
+                schedSignal.wait(0, timeout_ms);
+            }
+
+            /* Take Next Engine */
+            if(readyQ.length() > 0)
+            {
+                engine = readyQ[0];
+                readyQ.remove(0);
+                engine->coState = CO_RUNNING;
+                engine->wakePending = false;
+            }
+        }
+        schedSignal.unlock();
+
+        /* Run Engine until it Yields or Finishes */
+        if(engine) engine->resumeEngine();
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * resumeEngine
+ *----------------------------------------------------------------------------*/
+void LuaEngine::resumeEngine (void)
+{
+    int status;
+
+    /* Charge Script to Request */
+    RequestAccount* previous = RequestAccount::attach(dInfo->account);
+
+    engineSignal.lock();
+    {
+        /* Resume Script */
+        status = lua_resume(co, L, 0);
+
+        /* Script Finished */
+        if(status != LUA_YIELD)
+        {
+            if(status != LUA_OK)
+            {
+                lua_xmove(co, L, 1);
+                logErrorMessage();
+            }
+            engineActive = false;
+            engineSignal.signal(ENGINE_EXIT_SIGNAL);
+        }
+    }
+    engineSignal.unlock();
+
+    /* Settle Account */
+    RequestAccount::detach(previous);
+
+    if(status == LUA_YIELD)
+    {
+        /* Park Engine */
+        schedSignal.lock();
+        {
+            if(wakePending)
+            {
+                wakePending = false;
+                coState = CO_READY;
+                readyQ.add(this);
+                schedSignal.signal(0, Cond::NOTIFY_ONE);
+            }
+            else
+            {
+                coState = CO_SUSPENDED;
+                if(wakeDeadline > 0.0)
+                {
+                    sleepQ.add(this);
+                    schedSignal.signal(0, Cond::NOTIFY_ONE); // a waiting thread picks up the new deadline
+                }
+            }
+        }
+        schedSignal.unlock();
+    }
+    else
+    {
+        /* Report Completion - engine may be deleted */
+        schedSignal.lock();
+        {
+            coState = CO_IDLE;
+        }
+        schedSignal.unlock();
+        if(onDone) onDone(this, onDoneParm);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * loadScript
+ *
+ *  same as luaL_loadfile, but the script is only parsed the first time (and
+ *  whenever the file changes); afterwards the cached bytecode is loaded
+ *----------------------------------------------------------------------------*/
+int LuaEngine::loadScript (lua_State* L, const char* script)
+{
+    int64_t mtime = LocalLib::filetime(script);
+    SafeString chunkname("@%s", script);
+
+    /* Load Cached Bytecode */
+    int status = LUA_OK;
+    bool cached = false;
+    chunkCacheMutex.lock();
+    {
+        chunk_t chunk;
+        if(mtime >= 0 && chunkCache.find(script, &chunk) && chunk.mtime == mtime)
+        {
+            status = luaL_loadbufferx(L, chunk.data, chunk.size, chunkname.getString(), "b");
+            cached = true;
+        }
+    }
+    chunkCacheMutex.unlock();
+    if(cached) return status;
+
+    /* Parse Script */
+    status = luaL_loadfile(L, script);
+    if(status != LUA_OK || mtime < 0) return status;
+
+    /* Cache Bytecode (debug information kept for error messages) */
+    List<chunk_t> pieces;
+    if(lua_dump(L, chunkWriter, &pieces, 0) == 0)
+    {
+        chunk_t chunk = {NULL, 0, mtime};
+        for(int i = 0; i < pieces.length(); i++) chunk.size += pieces[i].size;
+        chunk.data = new char [chunk.size];
+        size_t offset = 0;
+        for(int i = 0; i < pieces.length(); i++)
+        {
+            memcpy(&chunk.data[offset], pieces[i].data, pieces[i].size);
+            offset += pieces[i].size;
+        }
+
+        chunkCacheMutex.lock();
+        {
+            chunk_t old_chunk;
+            if(chunkCache.find(script, &old_chunk)) delete [] old_chunk.data;
+            chunkCache.add(script, chunk);
+        }
+        chunkCacheMutex.unlock();
+    }
+    for(int i = 0; i < pieces.length(); i++) delete [] pieces[i].data;
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * luaSearcher - same as the standard lua searcher but loads through loadScript
+ *----------------------------------------------------------------------------*/
+int LuaEngine::luaSearcher (lua_State* L)
+{
+    const char* name = luaL_checkstring(L, 1);
+
+    /* Find Module File */
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchpath");
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+    if(lua_isnil(L, -2))
+    {
+        return 1; // error message explaining where the module was looked for
+    }
+
+    /* Load Module */
+    const char* filename = lua_tostring(L, -2);
+    if(loadScript(L, filename) != LUA_OK)
+    {
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, filename, lua_tostring(L, -1));
+    }
+
+    /* Return Loader and File Name */
+    lua_pushstring(L, filename);
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * chunkWriter
+ *----------------------------------------------------------------------------*/
+int LuaEngine::chunkWriter (lua_State* L, const void* p, size_t sz, void* ud)
+{
+    (void)L;
+
+    List<chunk_t>* pieces = (List<chunk_t>*)ud;
+    chunk_t piece = {new char [sz], sz, 0};
+    memcpy(piece.data, p, sz);
+    pieces->add(piece);
+    return 0;
+}
+
 /*----------------------------------------------------------------------------
  * createState
  *----------------------------------------------------------------------------*/
@@ -650,6 +1194,12 @@ lua_State* LuaEngine::createState(luaStepHook hook)
     lua_pop(l, 1 ); // get rid of the string on the stack we just pushed on line 5
     lua_pushstring(l, lpath.getString(false)); // push the new one
     lua_setfield(l, -2, "path" ); // set the field "path" in table at -2 with value at top of stack
+
+    /* Replace Lua File Searcher (modules loaded by require come from the bytecode cache) */
+    lua_getfield(l, -1, "searchers");
+    lua_pushcfunction(l, luaSearcher);
+    lua_rawseti(l, -2, 2); // searchers[2] is the standard lua file searcher
+    lua_pop(l, 1); // get rid of searchers table
     lua_pop(l, 1 ); // get rid of package table from top of stack
 
     /* Return State */
@@ -40,6 +40,8 @@
 #include "EventLib.h"
 #include "StringLib.h"
 #include "List.h"
+#include "Dictionary.h"
+#include "RequestAccount.h"
 
 #include <atomic>
 
@@ -81,12 +83,15 @@ class LuaEngine
 
         typedef void (*luaStepHook) (lua_State *L, lua_Debug *ar);
 
+        typedef void (*doneFunc) (LuaEngine* engine, void* parm);
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
                             LuaEngine       (const char* name, int lua_argc, char lua_argv[][MAX_LUA_ARG], uint32_t trace_id=ORIGIN, luaStepHook hook=NULL, bool paused=false); // protected mode
                             LuaEngine       (const char* script, const char* arg, uint32_t trace_id=ORIGIN, luaStepHook hook=NULL, bool paused=false); // direct mode
+                            LuaEngine       (luaStepHook hook=NULL); // direct mode, pre-warmed until prepare supplies the script
                             ~LuaEngine      (void);
 
         static void         init            (void);
@@ -103,9 +108,18 @@ class LuaEngine
         static void         setAttrFunc     (lua_State* l, const char* name, lua_CFunction val);
         static void         showStack       (lua_State* l, const char* prefix=NULL);
         static const char*  sanitize        (const char* filename);
+        static int          luaScheduler    (lua_State* L);
+        static bool         isScheduled     (void);
+        static LuaEngine*   getEngine       (lua_State* L);
+        static bool         canSuspend      (lua_State* L);
+        static int          suspend         (lua_State* L, int timeout_ms, lua_KFunction k, lua_KContext ctx);
+        static bool         timedOut        (lua_State* L);
+        static void         wake            (void* engine);
 
         uint64_t            getEngineId     (void);
+        void                prepare         (const char* script, const char* arg, uint32_t trace_id=ORIGIN);
         bool                executeEngine   (int timeout_ms);
+        bool                executeAsync    (doneFunc done, void* parm);
         bool                isActive        (void);
         void                setBoolean      (const char* name, bool val);
         void                setInteger      (const char* name, int val);
@@ -122,6 +136,7 @@ class LuaEngine
          *--------------------------------------------------------------------*/
 
         static const int ENGINE_EXIT_SIGNAL = 0;
+        static const int MAX_SCHEDULER_THREADS = 256;
 
         /*--------------------------------------------------------------------
          * Types
@@ -147,8 +162,22 @@ class LuaEngine
             LuaEngine*      engine;
             const char*     script;
             const char*     arg;
+            RequestAccount* account;    // referenced, request the script runs for
         } directThread_t;
 
+        typedef enum {
+            CO_IDLE,        // not running on the scheduler
+            CO_READY,       // on the ready queue
+            CO_RUNNING,     // being resumed by a scheduler thread
+            CO_SUSPENDED    // yielded, waiting on a wake or its deadline
+        } co_state_t;
+
+        typedef struct {
+            char*           data;
+            size_t          size;
+            int64_t         mtime; // modification time of script when compiled
+        } chunk_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -161,6 +190,16 @@ class LuaEngine
 
         static std::atomic<uint64_t>    engineIds;
 
+        static Dictionary<chunk_t>      chunkCache; // compiled scripts run in direct mode
+        static Mutex                    chunkCacheMutex;
+
+        static Cond                     schedSignal;    // guards the scheduler queues and coroutine states
+        static List<LuaEngine*>         readyQ;         // engines to resume, in order
+        static List<LuaEngine*>         sleepQ;         // suspended engines with a deadline
+        static Thread**                 schedPids;
+        static int                      numSchedThreads;
+        static bool                     schedActive;
+
         lua_State*                      L;      // lua state variable
 
         uint64_t                        engineId;
@@ -173,12 +212,25 @@ class LuaEngine
         protectedThread_t*              pInfo;
         directThread_t*                 dInfo;
 
+        lua_State*                      co;             // script coroutine when run on the scheduler
+        co_state_t                      coState;
+        bool                            wakePending;    // woken while running, resume again after yielding
+        bool                            wakeTimeout;    // last resume was due to the deadline
+        double                          wakeDeadline;   // seconds, 0.0 is none
+        doneFunc                        onDone;
+        void*                           onDoneParm;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
         static void*    protectedThread     (void* parm);
         static void*    directThread        (void* parm);
+        static void*    schedulerThread     (void* parm);
+               void     resumeEngine        (void);
+        static int      loadScript          (lua_State* L, const char* script);
+        static int      chunkWriter         (lua_State* L, const void* p, size_t sz, void* ud);
+        static int      luaSearcher         (lua_State* L);
         lua_State*      createState         (luaStepHook hook);
                void     logErrorMessage     (void);
 
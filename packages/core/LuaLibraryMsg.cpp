@@ -55,6 +55,8 @@ const struct luaL_Reg LuaLibraryMsg::msgLibsF [] = {
 
 const struct luaL_Reg LuaLibraryMsg::pubLibsM [] = {
     {"sendstring",    LuaLibraryMsg::lmsg_sendstring},
+    {"sendstrings",   LuaLibraryMsg::lmsg_sendstrings},
+    {"sendcolumns",   LuaLibraryMsg::lmsg_sendcolumns},
     {"sendrecord",    LuaLibraryMsg::lmsg_sendrecord},
     {"sendlog",       LuaLibraryMsg::lmsg_sendlog},
     {"numsubs",       LuaLibraryMsg::lmsg_numsubs},
@@ -66,6 +68,9 @@ const struct luaL_Reg LuaLibraryMsg::pubLibsM [] = {
 const struct luaL_Reg LuaLibraryMsg::subLibsM [] = {
     {"recvstring",    LuaLibraryMsg::lmsg_recvstring},
     {"recvrecord",    LuaLibraryMsg::lmsg_recvrecord},
+    {"recvstrings",   LuaLibraryMsg::lmsg_recvstrings},
+    {"recvrecords",   LuaLibraryMsg::lmsg_recvrecords},
+    {"recvcolumns",   LuaLibraryMsg::lmsg_recvcolumns},
     {"drain",         LuaLibraryMsg::lmsg_drain},
     {"destroy",       LuaLibraryMsg::lmsg_deletesub},
     {"__gc",          LuaLibraryMsg::lmsg_deletesub},
@@ -225,6 +230,168 @@ RecordObject* LuaLibraryMsg::associateRecord (const char* recclass, unsigned cha
     return record;
 }
 
+/*----------------------------------------------------------------------------
+ * getColumns
+ *
+ *  builds the columns for the fields listed in the table at index, or for
+ *  every field of the record type when there is no table (or index is 0);
+ *  returns the
+ *  number of columns or -1 if a listed field is not in the record type
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::getColumns (lua_State* L, int index, const char* rec_type, column_t** columns)
+{
+    char** fieldnames = NULL;
+    int num_fields = 0;
+    bool listed = (index > 0) && lua_istable(L, index);
+
+    /* Get Field Names */
+    if(listed)
+    {
+        num_fields = lua_rawlen(L, index);
+        if(num_fields > 0) fieldnames = new char* [num_fields];
+        for(int i = 0; i < num_fields; i++)
+        {
+            lua_rawgeti(L, index, i + 1);
+            const char* name = lua_tostring(L, -1);
+            fieldnames[i] = StringLib::duplicate(name ? name : "");
+            lua_pop(L, 1);
+        }
+    }
+    else
+    {
+        RecordObject::field_t** fields = NULL;
+        num_fields = RecordObject::getRecordFields(rec_type, &fieldnames, &fields);
+        for(int i = 0; i < num_fields; i++) delete fields[i];
+        if(num_fields > 0) delete [] fields;
+    }
+
+    /* Look Up Fields */
+    int num_columns = 0;
+    *columns = (num_fields > 0) ? new column_t [num_fields] : NULL;
+    for(int i = 0; i < num_fields; i++)
+    {
+        column_t& column = (*columns)[num_columns];
+        column.name = fieldnames[i];
+        column.field = RecordObject::getDefinedField(rec_type, fieldnames[i]);
+        column.type = RecordObject::getValueType(column.field);
+        if(column.type == RecordObject::TEXT || column.type == RecordObject::REAL || column.type == RecordObject::INTEGER)
+        {
+            num_columns++;
+        }
+        else if(listed)
+        {
+            mlog(CRITICAL, "Field %s is not a value in record type %s", fieldnames[i], rec_type);
+            for(int j = i; j < num_fields; j++) delete [] fieldnames[j];
+            delete [] fieldnames;
+            freeColumns(*columns, num_columns);
+            *columns = NULL;
+            return -1;
+        }
+        else
+        {
+            delete [] fieldnames[i]; // skip structures and other non-value fields
+        }
+    }
+    if(fieldnames) delete [] fieldnames;
+
+    return num_columns;
+}
+
+/*----------------------------------------------------------------------------
+ * freeColumns
+ *----------------------------------------------------------------------------*/
+void LuaLibraryMsg::freeColumns (column_t* columns, int num_columns)
+{
+    if(columns == NULL) return;
+    for(int i = 0; i < num_columns; i++) delete [] columns[i].name;
+    delete [] columns;
+}
+
+/*----------------------------------------------------------------------------
+ * pushColumnValue
+ *
+ *  pushes the value of the column's field in the record; array fields are
+ *  pushed as a table of their elements
+ *----------------------------------------------------------------------------*/
+void LuaLibraryMsg::pushColumnValue (lua_State* L, RecordObject* record, const column_t& column)
+{
+    const RecordObject::field_t& field = column.field;
+    try
+    {
+        if(column.type == RecordObject::TEXT)
+        {
+            char valbuf[RecordObject::MAX_VAL_STR_SIZE];
+            const char* val = record->getValueText(field, valbuf);
+            if(val) lua_pushstring(L, val);
+            else    lua_pushnil(L);
+        }
+        else if(field.elements == 1)
+        {
+            if(column.type == RecordObject::REAL)   lua_pushnumber(L, record->getValueReal(field));
+            else                                    lua_pushinteger(L, record->getValueInteger(field));
+        }
+        else
+        {
+            int num_elements = field.elements;
+            if(num_elements <= 0)
+            {
+                num_elements = (record->getAllocatedDataSize() - (field.offset / 8)) / RecordObject::FIELD_TYPE_BYTES[field.type];
+            }
+            lua_createtable(L, num_elements, 0);
+            for(int e = 0; e < num_elements; e++)
+            {
+                if(column.type == RecordObject::REAL)   lua_pushnumber(L, record->getValueReal(field, e));
+                else                                    lua_pushinteger(L, record->getValueInteger(field, e));
+                lua_rawseti(L, -2, e + 1);
+            }
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Unable to read field %s: %s", column.name, e.what());
+        lua_pushnil(L);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * setColumnValue
+ *
+ *  sets the column's field in the record from the value on the top of the
+ *  stack; nil values leave the field unchanged
+ *----------------------------------------------------------------------------*/
+void LuaLibraryMsg::setColumnValue (lua_State* L, RecordObject* record, const column_t& column)
+{
+    const RecordObject::field_t& field = column.field;
+    try
+    {
+        if(column.type == RecordObject::TEXT)
+        {
+            if(lua_isstring(L, -1)) record->setValueText(field, lua_tostring(L, -1));
+        }
+        else if(lua_istable(L, -1))
+        {
+            int num_elements = lua_rawlen(L, -1);
+            if(field.elements > 0 && num_elements > field.elements) num_elements = field.elements;
+            for(int e = 0; e < num_elements; e++)
+            {
+                lua_rawgeti(L, -1, e + 1);
+                if(column.type == RecordObject::REAL)   record->setValueReal(field, lua_tonumber(L, -1), e);
+                else                                    record->setValueInteger(field, (long)lua_tointeger(L, -1), e);
+                lua_pop(L, 1);
+            }
+        }
+        else if(lua_isnumber(L, -1))
+        {
+            if(column.type == RecordObject::REAL)   record->setValueReal(field, lua_tonumber(L, -1));
+            else                                    record->setValueInteger(field, (long)lua_tointeger(L, -1));
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Unable to set field %s: %s", column.name, e.what());
+    }
+}
+
 /******************************************************************************
  * MESSAGE QUEUE LIBRARY EXTENSION METHODS
  ******************************************************************************/
@@ -364,6 +531,170 @@ int LuaLibraryMsg::lmsg_sendstring (lua_State* L)
     return 1;                                           /* number of results */
 }
 
+/*----------------------------------------------------------------------------
+ * lmsg_sendstrings - num_posted = pub:sendstrings({<string>, ...}, [<timeout>])
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::lmsg_sendstrings (lua_State* L)
+{
+    msgPublisherData_t* msg_data = (msgPublisherData_t*)luaL_checkudata(L, 1, LUA_PUBMETANAME);
+    if(msg_data == NULL)
+    {
+        return luaL_error(L, "invalid message queue");
+    }
+
+    if(!lua_istable(L, 2))
+    {
+        return luaL_error(L, "must supply a table of strings");
+    }
+
+    int timeoutms = IO_CHECK;
+    if(lua_isinteger(L, 3))
+    {
+        timeoutms = (int)lua_tointeger(L, 3);
+    }
+
+    /* Collect Strings (kept alive by the table) */
+    int num_strs = lua_rawlen(L, 2);
+    if(num_strs <= 0)
+    {
+        lua_pushinteger(L, 0);
+        return 1;
+    }
+
+    const void** strs = new const void* [num_strs];
+    int* sizes = new int [num_strs];
+    for(int i = 0; i < num_strs; i++)
+    {
+        size_t len = 0;
+        lua_rawgeti(L, 2, i + 1);
+        strs[i] = lua_tolstring(L, -1, &len);
+        sizes[i] = (int)len;
+        lua_pop(L, 1);
+        if(strs[i] == NULL)
+        {
+            delete [] strs;
+            delete [] sizes;
+            return luaL_error(L, "table entry %d is not a string", i + 1);
+        }
+    }
+
+    /* Post Strings */
+    int status = msg_data->pub->postCopyBatch(strs, sizes, num_strs, timeoutms);
+    delete [] strs;
+    delete [] sizes;
+
+    lua_pushinteger(L, status > 0 ? status : 0);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lmsg_sendcolumns - num_posted = pub:sendcolumns({_type=<record type>, <field>={<value>, ...}, ...}, [<timeout>])
+ *
+ *  posts one record per row of the columns; fields without a column, or
+ *  with a nil entry in the row, keep their default value
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::lmsg_sendcolumns (lua_State* L)
+{
+    msgPublisherData_t* msg_data = (msgPublisherData_t*)luaL_checkudata(L, 1, LUA_PUBMETANAME);
+    if(msg_data == NULL)
+    {
+        return luaL_error(L, "invalid message queue");
+    }
+
+    if(!lua_istable(L, 2))
+    {
+        return luaL_error(L, "must supply a table of columns");
+    }
+
+    int timeoutms = IO_CHECK;
+    if(lua_isinteger(L, 3))
+    {
+        timeoutms = (int)lua_tointeger(L, 3);
+    }
+
+    /* Create Record */
+    lua_getfield(L, 2, REC_TYPE_ATTR);
+    const char* rec_type = lua_tostring(L, -1);
+    RecordObject* record = NULL;
+    try
+    {
+        if(rec_type) record = new RecordObject(rec_type);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Unable to create record %s: %s", rec_type, e.what());
+    }
+    lua_pop(L, 1);
+    if(record == NULL)
+    {
+        return luaL_error(L, "table must have a valid type attribute");
+    }
+
+    /* Collect Columns Present in Table */
+    column_t* all_columns = NULL;
+    int num_all_columns = getColumns(L, 0, record->getRecordType(), &all_columns);
+    int* column_index = new int [num_all_columns > 0 ? num_all_columns : 1];
+    int num_columns = 0;
+    int num_rows = 0;
+    for(int i = 0; i < num_all_columns; i++)
+    {
+        lua_getfield(L, 2, all_columns[i].name);
+        if(lua_istable(L, -1))
+        {
+            int rows = lua_rawlen(L, -1);
+            if(rows > num_rows) num_rows = rows;
+            column_index[num_columns++] = i;
+        }
+        lua_pop(L, 1);
+    }
+
+    /* Serialize a Record per Row */
+    int rec_size = record->getAllocatedMemory();
+    unsigned char* buffer = new unsigned char [(num_rows > 0 ? num_rows : 1) * rec_size];
+    const void** recs = new const void* [num_rows > 0 ? num_rows : 1];
+    int* sizes = new int [num_rows > 0 ? num_rows : 1];
+    for(int c = 0; c < num_columns; c++)
+    {
+        lua_getfield(L, 2, all_columns[column_index[c]].name); // columns stay on stack while rows are built
+    }
+    int stack_base = lua_gettop(L) - num_columns;
+    for(int row = 0; row < num_rows; row++)
+    {
+        for(int c = 0; c < num_columns; c++)
+        {
+            lua_rawgeti(L, stack_base + c + 1, row + 1);
+            setColumnValue(L, record, all_columns[column_index[c]]);
+            lua_pop(L, 1);
+        }
+        unsigned char* rec_buf = &buffer[row * rec_size];
+        sizes[row] = record->serialize(&rec_buf, RecordObject::COPY);
+        recs[row] = rec_buf;
+    }
+    lua_pop(L, num_columns);
+
+    /* Post Records */
+    int status = 0;
+    if(num_rows > 0)
+    {
+        status = msg_data->pub->postCopyBatch(recs, sizes, num_rows, timeoutms);
+        if(status < 0)
+        {
+            mlog(CRITICAL, "Failed to post %s records to %s with error code %d", record->getRecordType(), msg_data->pub->getName(), status);
+        }
+    }
+
+    /* Clean Up */
+    delete [] sizes;
+    delete [] recs;
+    delete [] buffer;
+    delete [] column_index;
+    freeColumns(all_columns, num_all_columns);
+    delete record;
+
+    lua_pushinteger(L, status > 0 ? status : 0);
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * lmsg_sendrecord - <record | population string>
  *
@@ -636,6 +967,212 @@ int LuaLibraryMsg::lmsg_recvrecord (lua_State* L)
     return 2;
 }
 
+/*----------------------------------------------------------------------------
+ * lmsg_recvstrings - {<string>, ...} = sub:recvstrings(<max>, <timeout>)
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::lmsg_recvstrings (lua_State* L)
+{
+    msgSubscriberData_t* msg_data = (msgSubscriberData_t*)luaL_checkudata(L, 1, LUA_SUBMETANAME);
+    if(msg_data == NULL)
+    {
+        return luaL_error(L, "invalid message queue");
+    }
+
+    int max_strs = (int)lua_tointeger(L, 2);
+    int timeoutms = (int)lua_tointeger(L, 3);
+    if(max_strs <= 0)
+    {
+        return luaL_error(L, "invalid maximum number of strings: %d", max_strs);
+    }
+
+    /* Receive Strings */
+    Subscriber::msgRef_t* refs = new Subscriber::msgRef_t [max_strs];
+    int status = msg_data->sub->receiveBatch(refs, max_strs, timeoutms);
+
+    /* Return Table of Strings */
+    lua_newtable(L);
+    if(status > 0)
+    {
+        for(int i = 0; i < status; i++)
+        {
+            lua_pushlstring(L, (const char*)refs[i].data, refs[i].size);
+            lua_rawseti(L, -2, i + 1);
+        }
+        msg_data->sub->dereferenceBatch(refs, status);
+    }
+    else if(status != MsgQ::STATE_TIMEOUT && status != MsgQ::STATE_EMPTY)
+    {
+        mlog(CRITICAL, "Failed (%d) to receive strings on message queue %s", status, msg_data->sub->getName());
+    }
+
+    delete [] refs;
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lmsg_recvrecords - {<record>, ...}, <terminator> = sub:recvrecords(<max>, <timeout>, [<record class>])
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::lmsg_recvrecords (lua_State* L)
+{
+    msgSubscriberData_t* msg_data = (msgSubscriberData_t*)luaL_checkudata(L, 1, LUA_SUBMETANAME);
+    if(msg_data == NULL)
+    {
+        return luaL_error(L, "invalid message queue");
+    }
+
+    int max_recs = (int)lua_tointeger(L, 2);
+    int timeoutms = (int)lua_tointeger(L, 3);
+    const char* recclass = NULL;
+    if(lua_isstring(L, 4))
+    {
+        recclass = (const char*)lua_tostring(L, 4);
+    }
+
+    if(max_recs <= 0)
+    {
+        return luaL_error(L, "invalid maximum number of records: %d", max_recs);
+    }
+
+    bool terminator = false;
+
+    /* Receive Records */
+    Subscriber::msgRef_t* refs = new Subscriber::msgRef_t [max_recs];
+    int status = msg_data->sub->receiveBatch(refs, max_recs, timeoutms);
+
+    /* Return Table of Records */
+    lua_newtable(L);
+    if(status > 0)
+    {
+        int num_recs = 0;
+        for(int i = 0; i < status; i++)
+        {
+            if(refs[i].size > 0)
+            {
+                RecordObject* record = associateRecord(recclass, (unsigned char*)refs[i].data, refs[i].size);
+                if(record)
+                {
+                    LuaLibraryMsg::recUserData_t* rec_data = (LuaLibraryMsg::recUserData_t*)lua_newuserdata(L, sizeof(LuaLibraryMsg::recUserData_t));
+                    rec_data->record_str = NULL;
+                    rec_data->rec = record;
+                    luaL_getmetatable(L, LUA_RECMETANAME);
+                    lua_setmetatable(L, -2); // associates the record meta table with the record user data
+                    lua_rawseti(L, -2, ++num_recs);
+                }
+                else
+                {
+                    mlog(WARNING, "Unable to create record object: %s", recclass);
+                }
+            }
+            else
+            {
+                terminator = true;
+            }
+        }
+        msg_data->sub->dereferenceBatch(refs, status);
+    }
+    else if(status != MsgQ::STATE_TIMEOUT && status != MsgQ::STATE_EMPTY)
+    {
+        mlog(CRITICAL, "Failed (%d) to receive records on message queue %s", status, msg_data->sub->getName());
+    }
+
+    delete [] refs;
+    lua_pushboolean(L, terminator);
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * lmsg_recvcolumns - {_type=<record type>, _count=<n>, <field>={<value>, ...}, ...}, <terminator> = sub:recvcolumns(<record type>, <max>, <timeout>, [{<field>, ...}])
+ *
+ *  receives up to max records and returns their fields as one array per
+ *  field, with one row per record of the requested type; records of other
+ *  types are dropped
+ *----------------------------------------------------------------------------*/
+int LuaLibraryMsg::lmsg_recvcolumns (lua_State* L)
+{
+    msgSubscriberData_t* msg_data = (msgSubscriberData_t*)luaL_checkudata(L, 1, LUA_SUBMETANAME);
+    if(msg_data == NULL)
+    {
+        return luaL_error(L, "invalid message queue");
+    }
+
+    const char* rec_type = lua_tostring(L, 2);
+    int max_recs = (int)lua_tointeger(L, 3);
+    int timeoutms = (int)lua_tointeger(L, 4);
+    if(rec_type == NULL || !RecordObject::isRecord(rec_type))
+    {
+        return luaL_error(L, "invalid record type: %s", rec_type);
+    }
+    else if(max_recs <= 0)
+    {
+        return luaL_error(L, "invalid maximum number of records: %d", max_recs);
+    }
+
+    /* Look Up Fields Once for the Batch */
+    column_t* columns = NULL;
+    int num_columns = getColumns(L, 5, rec_type, &columns);
+    if(num_columns < 0)
+    {
+        return luaL_error(L, "invalid field list for record type %s", rec_type);
+    }
+
+    bool terminator = false;
+
+    /* Receive Records */
+    Subscriber::msgRef_t* refs = new Subscriber::msgRef_t [max_recs];
+    RecordInterface** records = new RecordInterface* [max_recs];
+    int num_recs = 0;
+    int status = msg_data->sub->receiveBatch(refs, max_recs, timeoutms);
+    for(int i = 0; i < status; i++)
+    {
+        if(refs[i].size > 0)
+        {
+            try
+            {
+                RecordInterface* record = new RecordInterface((unsigned char*)refs[i].data, refs[i].size);
+                if(record->isRecordType(rec_type))  records[num_recs++] = record;
+                else                                delete record;
+            }
+            catch(const RunTimeException& e)
+            {
+                mlog(WARNING, "Unable to interpret record: %s", e.what());
+            }
+        }
+        else
+        {
+            terminator = true;
+        }
+    }
+    if(status < 0 && status != MsgQ::STATE_TIMEOUT && status != MsgQ::STATE_EMPTY)
+    {
+        mlog(CRITICAL, "Failed (%d) to receive records on message queue %s", status, msg_data->sub->getName());
+    }
+
+    /* Return Table of Columns */
+    lua_createtable(L, 0, num_columns + 2);
+    LuaEngine::setAttrStr(L, REC_TYPE_ATTR, rec_type);
+    LuaEngine::setAttrInt(L, "_count", num_recs);
+    for(int c = 0; c < num_columns; c++)
+    {
+        lua_createtable(L, num_recs, 0);
+        for(int r = 0; r < num_recs; r++)
+        {
+            pushColumnValue(L, records[r], columns[c]);
+            lua_rawseti(L, -2, r + 1);
+        }
+        lua_setfield(L, -2, columns[c].name);
+    }
+
+    /* Clean Up (records point into the references) */
+    for(int r = 0; r < num_recs; r++) delete records[r];
+    if(status > 0) msg_data->sub->dereferenceBatch(refs, status);
+    delete [] records;
+    delete [] refs;
+    freeColumns(columns, num_columns);
+
+    lua_pushboolean(L, terminator);
+    return 2;
+}
+
 /*----------------------------------------------------------------------------
  * lmsg_drain
  *----------------------------------------------------------------------------*/
@@ -99,6 +99,12 @@ class LuaLibraryMsg
             associateRecFunc    associate;
         } recClass_t;
 
+        typedef struct {
+            const char*                 name;
+            RecordObject::field_t       field;
+            RecordObject::valType_t     type;
+        } column_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -121,6 +127,10 @@ class LuaLibraryMsg
 
         static RecordObject* populateRecord (const char* population_string);
         static RecordObject* associateRecord (const char* recclass, unsigned char* data, int size);
+        static int      getColumns          (lua_State* L, int index, const char* rec_type, column_t** columns);
+        static void     freeColumns         (column_t* columns, int num_columns);
+        static void     pushColumnValue     (lua_State* L, RecordObject* record, const column_t& column);
+        static void     setColumnValue      (lua_State* L, RecordObject* record, const column_t& column);
 
         /* message library functions */
         static int      lmsg_publish        (lua_State* L);
@@ -130,6 +140,8 @@ class LuaLibraryMsg
 
         /* publisher meta functions */
         static int      lmsg_sendstring     (lua_State* L);
+        static int      lmsg_sendstrings    (lua_State* L);
+        static int      lmsg_sendcolumns    (lua_State* L);
         static int      lmsg_sendrecord     (lua_State* L);
         static int      lmsg_sendlog        (lua_State* L);
         static int      lmsg_numsubs        (lua_State* L);
@@ -138,6 +150,9 @@ class LuaLibraryMsg
         /* subscriber meta functions */
         static int      lmsg_recvstring     (lua_State* L);
         static int      lmsg_recvrecord     (lua_State* L);
+        static int      lmsg_recvstrings    (lua_State* L);
+        static int      lmsg_recvrecords    (lua_State* L);
+        static int      lmsg_recvcolumns    (lua_State* L);
         static int      lmsg_drain          (lua_State* L);
         static int      lmsg_deletesub      (lua_State* L);
 
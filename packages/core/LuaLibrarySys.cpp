@@ -52,6 +52,7 @@ const struct luaL_Reg LuaLibrarySys::sysLibs [] = {
     {"wait",        LuaLibrarySys::lsys_wait},
     {"log",         LuaLibrarySys::lsys_log},
     {"metric",      LuaLibrarySys::lsys_metric},
+    {"prometheus",  LuaLibrarySys::lsys_prometheus},
     {"lsmsgq",      LuaLibrarySys::lsys_lsmsgq},
     {"setenvver",   LuaLibrarySys::lsys_setenvver},
     {"type",        LuaLibrarySys::lsys_type},
@@ -60,11 +61,19 @@ const struct luaL_Reg LuaLibrarySys::sysLibs [] = {
     {"getiosz",     LuaLibrarySys::lsys_getiosize},
     {"setlvl",      LuaLibrarySys::lsys_seteventlvl},
     {"getlvl",      LuaLibrarySys::lsys_geteventlvl},
+    {"tracesample", LuaLibrarySys::lsys_tracesample},
     {"healthy",     LuaLibrarySys::lsys_healthy},
     {"ipv4",        LuaLibrarySys::lsys_ipv4},
     {"lsrec",       LuaLibrarySys::lsys_lsrec},
     {"cwd",         LuaLibrarySys::lsys_cwd},
     {"memu",        LuaLibrarySys::lsys_memu},
+    {"recpool",     LuaLibrarySys::lsys_recpool},
+    {"threads",     LuaLibrarySys::lsys_threads},
+    {"placement",   LuaLibrarySys::lsys_placement},
+    {"locks",       LuaLibrarySys::lsys_locks},
+    {"profile",     LuaLibrarySys::lsys_profile},
+    {"b64encode",   LuaLibrarySys::lsys_b64encode},
+    {"b64decode",   LuaLibrarySys::lsys_b64decode},
     {"lsdev",       DeviceObject::luaList},
     {NULL,          NULL}
 };
@@ -277,6 +286,18 @@ int LuaLibrarySys::lsys_metric (lua_State* L)
     return 1;
 }
 
+/*----------------------------------------------------------------------------
+ * lsys_prometheus - .prometheus() --> metrics in prometheus text format
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_prometheus (lua_State* L)
+{
+    MetricEndpoint::exposition_t exposition = {NULL, 0, 0};
+    MetricEndpoint::writeExposition(&exposition);
+    lua_pushlstring(L, exposition.buffer, exposition.length);
+    delete [] exposition.buffer;
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * lsys_lsmsgq
  *----------------------------------------------------------------------------*/
@@ -468,6 +489,24 @@ int LuaLibrarySys::lsys_geteventlvl (lua_State* L)
     return 3;
 }
 
+/*----------------------------------------------------------------------------
+ * lsys_tracesample - .tracesample([<rate 0.0 - 1.0>]) --> rate
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_tracesample (lua_State* L)
+{
+    if(lua_isnumber(L, 1))
+    {
+        double rate = lua_tonumber(L, 1);
+        if(!EventLib::setTraceSampling(rate))
+        {
+            mlog(CRITICAL, "trace sample rate must be between 0.0 and 1.0: %lf", rate);
+        }
+    }
+
+    lua_pushnumber(L, EventLib::getTraceSampling());
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * lsys_healthy
  *  - this is currently a placeholder for a more sophisticated health check
@@ -540,3 +579,167 @@ int LuaLibrarySys::lsys_memu (lua_State* L)
     lua_pushnumber(L, m);
     return 1;
 }
+
+/*----------------------------------------------------------------------------
+ * lsys_recpool - record pool usage
+ *
+ *  {<block size>={in_use=, high_water=, free=, chunks=, allocs=}, ...}, heap_allocs
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_recpool (lua_State* L)
+{
+    RecordPool::stats_t stats[RecordPool::NUM_CLASSES];
+    RecordPool::getStats(stats);
+
+    lua_newtable(L);
+    for(int i = 0; i < RecordPool::NUM_CLASSES; i++)
+    {
+        lua_pushinteger(L, stats[i].block_size);
+        lua_newtable(L);
+        LuaEngine::setAttrInt(L, "in_use", stats[i].in_use);
+        LuaEngine::setAttrInt(L, "high_water", stats[i].high_water);
+        LuaEngine::setAttrInt(L, "free", stats[i].free_blocks);
+        LuaEngine::setAttrInt(L, "chunks", stats[i].chunks);
+        LuaEngine::setAttrInt(L, "allocs", stats[i].allocs);
+        lua_settable(L, -3);
+    }
+
+    lua_pushinteger(L, RecordPool::getHeapAllocs());
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_threads - thread budget usage, optionally setting the budget
+ *
+ *  threads([<budget>]) --> {budget=, in_use=, high_water=, throttled=}
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_threads (lua_State* L)
+{
+    if(lua_isnumber(L, 1))
+    {
+        ThreadBudget::setBudget((int)lua_tointeger(L, 1));
+    }
+
+    ThreadBudget::stats_t stats;
+    ThreadBudget::getStats(&stats);
+
+    lua_newtable(L);
+    LuaEngine::setAttrInt(L, "budget", stats.budget);
+    LuaEngine::setAttrInt(L, "in_use", stats.in_use);
+    LuaEngine::setAttrInt(L, "high_water", stats.high_water);
+    LuaEngine::setAttrInt(L, "throttled", stats.throttled);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_placement - thread placement policy, optionally setting the policy
+ *
+ *  placement([<"any"|"node">]) --> policy, number of numa nodes
+ *
+ *  "node" binds each request to one numa node, round robin, so the readers
+ *  and dispatchers it starts share the node's cache and memory; set it before
+ *  creating the http server so that its listeners are spread over the nodes
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_placement (lua_State* L)
+{
+    if(lua_isstring(L, 1))
+    {
+        const char* policy = lua_tostring(L, 1);
+        if(StringLib::match(policy, "node"))        Thread::setPlacement(Thread::PLACE_NODE);
+        else if(StringLib::match(policy, "any"))    Thread::setPlacement(Thread::PLACE_ANY);
+        else mlog(CRITICAL, "Invalid thread placement policy: %s", policy);
+    }
+
+    lua_pushstring(L, Thread::getPlacement() == Thread::PLACE_NODE ? "node" : "any");
+    lua_pushinteger(L, Thread::getNumNodes());
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_locks - contention counters of the named locks
+ *
+ *  locks() --> {<name>={acquired=, contended=, parked=, spins=}, ...}
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_locks (lua_State* L)
+{
+    Mutex::stats_t stats[Mutex::MAX_LOCK_NAMES];
+    int num_stats = Mutex::getNamedStats(stats, Mutex::MAX_LOCK_NAMES);
+
+    lua_newtable(L);
+    for(int i = 0; i < num_stats; i++)
+    {
+        lua_pushstring(L, stats[i].name);
+        lua_newtable(L);
+        LuaEngine::setAttrNum(L, "acquired", stats[i].acquired);
+        LuaEngine::setAttrNum(L, "contended", stats[i].contended);
+        LuaEngine::setAttrNum(L, "parked", stats[i].parked);
+        LuaEngine::setAttrNum(L, "spins", stats[i].spins);
+        lua_settable(L, -3);
+    }
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_profile - .profile(<seconds>, [<frequency>]) --> folded stacks, samples, dropped
+ *
+ *  blocks for the duration; returns nil when a profile is already running
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_profile (lua_State* L)
+{
+    double duration = lua_isnumber(L, 1) ? lua_tonumber(L, 1) : 10.0;
+    int frequency = lua_isnumber(L, 2) ? (int)lua_tointeger(L, 2) : Profiler::DEFAULT_FREQUENCY;
+
+    long num_samples = 0;
+    long num_dropped = 0;
+    const char* folded = Profiler::profile(duration, frequency, &num_samples, &num_dropped);
+    if(folded == NULL)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    lua_pushstring(L, folded);
+    lua_pushinteger(L, num_samples);
+    lua_pushinteger(L, num_dropped);
+    delete [] folded;
+    return 3;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_b64encode - .b64encode(<binary string>) --> base64 string
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_b64encode (lua_State* L)
+{
+    size_t len = 0;
+    const char* data = lua_tolstring(L, 1, &len);
+    if(data == NULL || len == 0)
+    {
+        lua_pushstring(L, "");
+        return 1;
+    }
+
+    int size = (int)len;
+    char* encoded = StringLib::b64encode(data, &size);
+    lua_pushlstring(L, encoded, size - 1); // size includes null terminator
+    delete [] encoded;
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lsys_b64decode - .b64decode(<base64 string>) --> binary string
+ *----------------------------------------------------------------------------*/
+int LuaLibrarySys::lsys_b64decode (lua_State* L)
+{
+    size_t len = 0;
+    const char* data = lua_tolstring(L, 1, &len);
+    if(data == NULL || len == 0)
+    {
+        lua_pushstring(L, "");
+        return 1;
+    }
+
+    int size = (int)len;
+    unsigned char* decoded = StringLib::b64decode(data, &size);
+    lua_pushlstring(L, (const char*)decoded, size);
+    delete [] decoded;
+    return 1;
+}
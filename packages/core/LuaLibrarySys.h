@@ -77,6 +77,7 @@ class LuaLibrarySys
         static int      lsys_wait           (lua_State* L);
         static int      lsys_log            (lua_State* L);
         static int      lsys_metric         (lua_State* L);
+        static int      lsys_prometheus     (lua_State* L);
         static int      lsys_lsmsgq         (lua_State* L);
         static int      lsys_setenvver      (lua_State* L);
         static int      lsys_type           (lua_State* L);
@@ -85,11 +86,19 @@ class LuaLibrarySys
         static int      lsys_getiosize      (lua_State* L);
         static int      lsys_seteventlvl    (lua_State* L);
         static int      lsys_geteventlvl    (lua_State* L);
+        static int      lsys_tracesample    (lua_State* L);
         static int      lsys_healthy        (lua_State* L);
         static int      lsys_ipv4           (lua_State* L);
         static int      lsys_lsrec          (lua_State* L);
         static int      lsys_cwd            (lua_State* L);
         static int      lsys_memu           (lua_State* L);
+        static int      lsys_recpool        (lua_State* L);
+        static int      lsys_threads        (lua_State* L);
+        static int      lsys_placement      (lua_State* L);
+        static int      lsys_locks          (lua_State* L);
+        static int      lsys_profile        (lua_State* L);
+        static int      lsys_b64encode      (lua_State* L);
+        static int      lsys_b64decode      (lua_State* L);
 
         /*--------------------------------------------------------------------
          * Data
@@ -37,6 +37,7 @@
 #include "LuaEngine.h"
 #include "EventLib.h"
 #include "StringLib.h"
+#include "TimeLib.h"
 #include "OsApi.h"
 
 /******************************************************************************
@@ -45,7 +46,7 @@
 
 const char* LuaObject::BASE_OBJECT_TYPE = "LuaObject";
 Dictionary<LuaObject*> LuaObject::globalObjects;
-Mutex LuaObject::globalMut;
+Mutex LuaObject::globalMut("luaobject");
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -321,6 +322,9 @@ LuaObject::LuaObject (lua_State* L, const char* object_type, const char* meta_na
 
     /* Start Trace */
     traceId = start_trace(DEBUG, engine_trace_id, "lua_object", "{\"object_type\":\"%s\", \"meta_name\":\"%s\"}", object_type, meta_name);
+
+    /* Account to Request Creating Object */
+    account = RequestAccount::share();
 }
 
 /*----------------------------------------------------------------------------
@@ -331,6 +335,9 @@ LuaObject::~LuaObject (void)
     stop_trace(DEBUG, traceId);
     mlog(DEBUG, "Deleting %s/%s", getType(), getName());
 
+    /* Release Request Account */
+    if(account) account->release();
+
     /* Remove Name from Global Objects */
     globalMut.lock();
     {
@@ -448,11 +455,18 @@ int LuaObject::luaName(lua_State* L)
 }
 
 /*----------------------------------------------------------------------------
- * luaWaitOn - :waiton([<timeout is milliseconds>])
+ * luaWaitOn - :waiton([<timeout is milliseconds>], [<queue name>])
+ *
+ *  blocks until the object completes or the timeout expires; when a queue is
+ *  supplied it also returns as soon as the last subscriber to that queue
+ *  detaches (e.g. the client of a request disconnects), so callers need not
+ *  wake up periodically to check on it.  A script running on the scheduler
+ *  is suspended instead of blocking its thread
  *----------------------------------------------------------------------------*/
 int LuaObject::luaWaitOn(lua_State* L)
 {
     bool status = false;
+    waiton_t* waiton = NULL;
 
     try
     {
@@ -461,27 +475,143 @@ int LuaObject::luaWaitOn(lua_State* L)
 
         /* Get Parameters */
         int timeout = getLuaInteger(L, 2, true, IO_PEND);
+        const char* qname = getLuaString(L, 3, true, NULL);
+
+        /* Suspend Script */
+        if(timeout != IO_CHECK && LuaEngine::canSuspend(L))
+        {
+            LuaEngine* engine = LuaEngine::getEngine(L);
+            bool subscribed = true;
+
+            /* Watch Queue */
+            MsgQ* watchq = NULL;
+            if(qname)
+            {
+                watchq = new MsgQ(qname);
+                subscribed = watchq->watchSubs(LuaEngine::wake, engine);
+            }
 
-        /* Wait On Signal */
-        lua_obj->objSignal.lock();
+            /* Register for Completion */
+            lua_obj->objSignal.lock();
+            {
+                status = lua_obj->objComplete;
+                if(!status && subscribed) lua_obj->objWaiters.add(engine);
+            }
+            lua_obj->objSignal.unlock();
+
+            if(!status && subscribed)
+            {
+                waiton = new waiton_t;
+                waiton->obj = lua_obj;
+                waiton->watchq = watchq;
+                waiton->deadline = (timeout < 0) ? 0.0 : TimeLib::latchtime() + (timeout / 1000.0);
+            }
+            else if(watchq)
+            {
+                watchq->unwatchSubs(LuaEngine::wake, engine);
+                delete watchq;
+            }
+        }
+        else
         {
-            if(!lua_obj->objComplete)
+            /* Watch Queue */
+            MsgQ* watchq = NULL;
+            bool subscribed = true;
+            if(qname)
+            {
+                watchq = new MsgQ(qname);
+                subscribed = watchq->watchSubs(&lua_obj->objSignal, SIGNAL_COMPLETE);
+            }
+
+            /* Wait On Signal */
+            lua_obj->objSignal.lock();
             {
-                lua_obj->objSignal.wait(SIGNAL_COMPLETE, timeout);
+                while(!lua_obj->objComplete && subscribed)
+                {
+                    if(!lua_obj->objSignal.wait(SIGNAL_COMPLETE, timeout)) break;
+                    if(watchq) subscribed = watchq->getSubCnt() > 0;
+                }
+                status = lua_obj->objComplete;
+            }
+            lua_obj->objSignal.unlock();
+
+            /* Stop Watching Queue */
+            if(watchq)
+            {
+                watchq->unwatchSubs(&lua_obj->objSignal);
+                delete watchq;
             }
-            status = lua_obj->objComplete;
         }
-        lua_obj->objSignal.unlock();
     }
     catch(const RunTimeException& e)
     {
         mlog(e.level(), "Error locking object: %s", e.what());
     }
 
+    /* Yield - outside of the try block as it does not return */
+    if(waiton)
+    {
+        int timeout_ms = (waiton->deadline == 0.0) ? IO_PEND : (int)((waiton->deadline - TimeLib::latchtime()) * 1000.0);
+        return LuaEngine::suspend(L, MAX(timeout_ms, 0), luaWaitOnK, (lua_KContext)waiton);
+    }
+
     /* Return Completion Status */
     return returnLuaStatus(L, status);
 }
 
+/*----------------------------------------------------------------------------
+ * luaWaitOnK - continues waiton when a suspended script is resumed
+ *----------------------------------------------------------------------------*/
+int LuaObject::luaWaitOnK(lua_State* L, int status, lua_KContext ctx)
+{
+    (void)status;
+
+    waiton_t* waiton = (waiton_t*)ctx;
+    LuaObject* lua_obj = waiton->obj;
+    LuaEngine* engine = LuaEngine::getEngine(L);
+
+    /* Check Wait */
+    bool complete;
+    lua_obj->objSignal.lock();
+    {
+        complete = lua_obj->objComplete;
+    }
+    lua_obj->objSignal.unlock();
+    bool subscribed = (waiton->watchq == NULL) || (waiton->watchq->getSubCnt() > 0);
+
+    /* Spurious Wake */
+    if(!complete && subscribed && !LuaEngine::timedOut(L))
+    {
+        int timeout_ms = (waiton->deadline == 0.0) ? IO_PEND : (int)((waiton->deadline - TimeLib::latchtime()) * 1000.0);
+        return LuaEngine::suspend(L, MAX(timeout_ms, 0), luaWaitOnK, ctx);
+    }
+
+    /* Unregister */
+    lua_obj->objSignal.lock();
+    {
+        for(int i = 0; i < lua_obj->objWaiters.length(); i++)
+        {
+            if(lua_obj->objWaiters[i] == engine)
+            {
+                lua_obj->objWaiters.remove(i);
+                break;
+            }
+        }
+    }
+    lua_obj->objSignal.unlock();
+
+    /* Stop Watching Queue */
+    if(waiton->watchq)
+    {
+        waiton->watchq->unwatchSubs(LuaEngine::wake, engine);
+        delete waiton->watchq;
+    }
+    delete waiton;
+
+    /* Return Completion Status */
+    return returnLuaStatus(L, complete);
+}
+
 /*----------------------------------------------------------------------------
  * signalComplete
  *----------------------------------------------------------------------------*/
@@ -492,12 +622,27 @@ void LuaObject::signalComplete (void)
         if(!objComplete)
         {
             objSignal.signal(SIGNAL_COMPLETE);
+            for(int i = 0; i < objWaiters.length(); i++)
+            {
+                LuaEngine::wake(objWaiters[i]);
+            }
         }
         objComplete = true;
     }
     objSignal.unlock();
 }
 
+/*----------------------------------------------------------------------------
+ * isCancelled
+ *
+ *  checked by the object's threads so that they stop once the client of the
+ *  request that created the object has disconnected
+ *----------------------------------------------------------------------------*/
+bool LuaObject::isCancelled (void)
+{
+    return account && account->isCancelled();
+}
+
 /*----------------------------------------------------------------------------
  * associateMetaTable
  *----------------------------------------------------------------------------*/
@@ -53,6 +53,8 @@
 #include "OsApi.h"
 #include "Dictionary.h"
 #include "LuaEngine.h"
+#include "MsgQ.h"
+#include "List.h"
 
 #include <atomic>
 
@@ -119,6 +121,7 @@ class LuaObject
                             LuaObject           (lua_State* L, const char* object_type, const char* meta_name, const struct luaL_Reg meta_table[]);
 
         void                signalComplete      (void);
+        bool                isCancelled         (void); // request the object works for has been abandoned
         static void         associateMetaTable  (lua_State* L, const char* meta_name, const struct luaL_Reg meta_table[]);
         static int          createLuaObject     (lua_State* L, LuaObject* lua_obj);
         static LuaObject*   getLuaObject        (lua_State* L, int parm, const char* object_type, bool optional=false, LuaObject* dfltval=NULL);
@@ -130,9 +133,21 @@ class LuaObject
          *--------------------------------------------------------------------*/
 
         uint32_t            traceId;
+        RequestAccount*     account;        /* request charged for work done by the object's threads */
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Script Suspended in waiton */
+        typedef struct {
+            LuaObject*      obj;
+            MsgQ*           watchq;     // queue whose subscribers are watched, NULL if none
+            double          deadline;   // seconds, 0.0 is none
+        } waiton_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -141,6 +156,7 @@ class LuaObject
         static int          luaDelete           (lua_State* L);
         static int          luaName             (lua_State* L);
         static int          luaWaitOn           (lua_State* L);
+        static int          luaWaitOnK          (lua_State* L, int status, lua_KContext ctx);
 
         /*--------------------------------------------------------------------
          * Data
@@ -152,6 +168,7 @@ class LuaObject
         std::atomic<long>               referenceCount;
         Cond                            objSignal;
         bool                            objComplete;
+        List<LuaEngine*>                objWaiters;     // engines suspended in waiton, woken on completion
 };
 
 #endif  /* __lua_object__ */
@@ -213,6 +213,35 @@ MathLib::coord_t MathLib::point2coord (const point_t p, proj_t projection)
     return c;
 }
 
+/*----------------------------------------------------------------------------
+ * coord2point - batch
+ *
+ *  projects n coordinates supplied as separate longitude and latitude arrays
+ *----------------------------------------------------------------------------*/
+void MathLib::coord2point (const double* lon, const double* lat, point_t* p, int n, proj_t projection)
+{
+    projectCoords(lon, lat, 1, p, n, projection);
+}
+
+/*----------------------------------------------------------------------------
+ * coord2point - batch
+ *----------------------------------------------------------------------------*/
+void MathLib::coord2point (const coord_t* c, point_t* p, int n, proj_t projection)
+{
+    projectCoords(&c[0].lon, &c[0].lat, sizeof(coord_t) / sizeof(double), p, n, projection);
+}
+
+/*----------------------------------------------------------------------------
+ * point2coord - batch
+ *----------------------------------------------------------------------------*/
+void MathLib::point2coord (const point_t* p, coord_t* c, int n, proj_t projection)
+{
+    for(int i = 0; i < n; i++)
+    {
+        c[i] = point2coord(p[i], projection);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * inpoly
  *
@@ -262,10 +291,185 @@ bool MathLib::inpoly (point_t* poly, int len, point_t point)
     return c == 1;
 }
 
+/*----------------------------------------------------------------------------
+ * polycreate
+ *
+ *  preprocesses a polygon for repeated inclusion tests; the result must be
+ *  freed with polydelete
+ *----------------------------------------------------------------------------*/
+MathLib::poly_t* MathLib::polycreate (const point_t* poly, int len)
+{
+    poly_t* p = new poly_t;
+
+    /* Vertical Extent */
+    p->min_y = len > 0 ? poly[0].y : 0.0;
+    p->max_y = p->min_y;
+    for(int i = 1; i < len; i++)
+    {
+        if(poly[i].y < p->min_y) p->min_y = poly[i].y;
+        if(poly[i].y > p->max_y) p->max_y = poly[i].y;
+    }
+
+    /* Size Slabs - roughly one per edge */
+    p->num_slabs = MAX(1, MIN(len, MAX_POLY_SLABS));
+    double height = p->max_y - p->min_y;
+    p->slab_scale = height > 0.0 ? p->num_slabs / height : 0.0;
+    p->slab_offset = new int [p->num_slabs + 1];
+    for(int s = 0; s <= p->num_slabs; s++) p->slab_offset[s] = 0;
+
+    /* Count Edges in Each Slab */
+    for(int i = 0, j = len - 1; i < len; j = i++)
+    {
+        int first_slab = getPolySlab(p, MIN(poly[i].y, poly[j].y));
+        int last_slab = getPolySlab(p, MAX(poly[i].y, poly[j].y));
+        for(int s = first_slab; s <= last_slab; s++) p->slab_offset[s + 1]++;
+    }
+    for(int s = 0; s < p->num_slabs; s++) p->slab_offset[s + 1] += p->slab_offset[s];
+
+    /* Populate Edges */
+    int num_edges = p->slab_offset[p->num_slabs];
+    p->x0 = new double [num_edges];
+    p->y0 = new double [num_edges];
+    p->x1 = new double [num_edges];
+    p->y1 = new double [num_edges];
+    int* fill = new int [p->num_slabs];
+    for(int s = 0; s < p->num_slabs; s++) fill[s] = p->slab_offset[s];
+    for(int i = 0, j = len - 1; i < len; j = i++)
+    {
+        int first_slab = getPolySlab(p, MIN(poly[i].y, poly[j].y));
+        int last_slab = getPolySlab(p, MAX(poly[i].y, poly[j].y));
+        for(int s = first_slab; s <= last_slab; s++)
+        {
+            int e = fill[s]++;
+            p->x0[e] = poly[i].x;
+            p->y0[e] = poly[i].y;
+            p->x1[e] = poly[j].x;
+            p->y1[e] = poly[j].y;
+        }
+    }
+    delete [] fill;
+
+    return p;
+}
+
+/*----------------------------------------------------------------------------
+ * polydelete
+ *----------------------------------------------------------------------------*/
+void MathLib::polydelete (poly_t* poly)
+{
+    if(poly)
+    {
+        delete [] poly->slab_offset;
+        delete [] poly->x0;
+        delete [] poly->y0;
+        delete [] poly->x1;
+        delete [] poly->y1;
+        delete poly;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * inpoly
+ *
+ *  same crossing number test as above, restricted to the edges in the slab
+ *  containing the point
+ *----------------------------------------------------------------------------*/
+bool MathLib::inpoly (const poly_t* poly, point_t point)
+{
+    /* Points outside vertical extent cannot cross any edge */
+    if(point.y < poly->min_y || point.y >= poly->max_y) return false;
+
+    int slab = getPolySlab(poly, point.y);
+    const double* x0 = poly->x0;
+    const double* y0 = poly->y0;
+    const double* x1 = poly->x1;
+    const double* y1 = poly->y1;
+
+    /* Branchless crossing count over slab edges */
+    int c = 0;
+    for(int e = poly->slab_offset[slab]; e < poly->slab_offset[slab + 1]; e++)
+    {
+        double x_extent = (x1[e] - x0[e]) * (point.y - y0[e]) / (y1[e] - y0[e]) + x0[e];
+        c ^= ((y0[e] > point.y) != (y1[e] > point.y)) & (point.x < x_extent);
+    }
+
+    return c == 1;
+}
+
+/*----------------------------------------------------------------------------
+ * inpolybatch
+ *
+ *  tests n points against a preprocessed polygon, populating the inclusion
+ *  array; returns number of points inside the polygon
+ *----------------------------------------------------------------------------*/
+int MathLib::inpolybatch (const poly_t* poly, const point_t* points, int n, bool* inclusion)
+{
+    int count = 0;
+    for(int i = 0; i < n; i++)
+    {
+        inclusion[i] = inpoly(poly, points[i]);
+        count += inclusion[i];
+    }
+    return count;
+}
+
 /******************************************************************************
  * PRIVATE METHODS
  ******************************************************************************/
 
+/*----------------------------------------------------------------------------
+ * projectCoords
+ *
+ *  the projection is selected once and each loop is free of branches so the
+ *  compiler can vectorize it; results match the single coordinate version
+ *----------------------------------------------------------------------------*/
+void MathLib::projectCoords (const double* lon, const double* lat, int stride, point_t* p, int n, proj_t projection)
+{
+    if(projection == NORTH_POLAR)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            double lonrad = lon[i * stride] * M_PI / 180.0;
+            double latrad = lat[i * stride] * M_PI / 180.0;
+            double r = 2 * tan((M_PI / 4.0) - (latrad / 2.0));
+            p[i].x = r * cos(lonrad);
+            p[i].y = r * sin(lonrad);
+        }
+    }
+    else if(projection == SOUTH_POLAR)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            double lonrad = lon[i * stride] * M_PI / 180.0;
+            double latrad = lat[i * stride] * M_PI / 180.0;
+            double r = -2 * tan(-(M_PI / 4.0) - (latrad / 2.0));
+            p[i].x = r * cos(-lonrad);
+            p[i].y = r * sin(-lonrad);
+        }
+    }
+    else if(projection == PLATE_CARREE)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            p[i].x = EARTHRADIUS * (lon[i * stride] * M_PI / 180.0);
+            p[i].y = EARTHRADIUS * (lat[i * stride] * M_PI / 180.0);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * getPolySlab
+ *
+ *  slab containing y, clamped to the valid slabs
+ *----------------------------------------------------------------------------*/
+int MathLib::getPolySlab (const poly_t* poly, double y)
+{
+    int slab = (int)((y - poly->min_y) * poly->slab_scale);
+    if(slab < 0) slab = 0;
+    else if(slab >= poly->num_slabs) slab = poly->num_slabs - 1;
+    return slab;
+}
+
 /*----------------------------------------------------------------------------
  * swapComplex
  *
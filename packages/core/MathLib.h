@@ -45,6 +45,7 @@ class MathLib
         static const int MAXFREQSPEC = 8192;
         static const int LOG2DATASIZE = 13;
         static const double EARTHRADIUS;
+        static const int MAX_POLY_SLABS = 1024;
 
         /*--------------------------------------------------------------------
          * Types
@@ -75,6 +76,23 @@ class MathLib
             double  y;
         } point_t;
 
+        /* Preprocessed Polygon
+         *  edges are bucketed into horizontal slabs so that a point is only
+         *  tested against the edges that cross its y coordinate; the edges of
+         *  each slab are stored as separate coordinate arrays so the crossing
+         *  test runs as a branchless loop the compiler can vectorize */
+        typedef struct {
+            double  min_y;
+            double  max_y;
+            double  slab_scale;     // slabs per unit of y
+            int     num_slabs;
+            int*    slab_offset;    // [num_slabs + 1] index of first edge in each slab
+            double* x0;             // edge start points
+            double* y0;
+            double* x1;             // edge end points
+            double* y1;
+        } poly_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -82,7 +100,14 @@ class MathLib
         static double   FFT         (double result[], int data[], unsigned long size);
         static point_t  coord2point (const coord_t c, proj_t projection);
         static coord_t  point2coord (const point_t p, proj_t projection);
+        static void     coord2point (const double* lon, const double* lat, point_t* p, int n, proj_t projection);
+        static void     coord2point (const coord_t* c, point_t* p, int n, proj_t projection);
+        static void     point2coord (const point_t* p, coord_t* c, int n, proj_t projection);
         static bool     inpoly      (point_t* poly, int len, point_t point);
+        static poly_t*  polycreate  (const point_t* poly, int len);
+        static void     polydelete  (poly_t* poly);
+        static bool     inpoly      (const poly_t* poly, point_t point);
+        static int      inpolybatch (const poly_t* poly, const point_t* points, int n, bool* inclusion);
 
     private:
 
@@ -95,6 +120,8 @@ class MathLib
         static void     freqCorrelation     (complex_t data[], unsigned long size, int isign);
         static double   getPolarMagnitude   (double ReX, double ImX);
         static double   getPolarPhase       (double ReX, double ImX);
+        static int      getPolySlab         (const poly_t* poly, double y);
+        static void     projectCoords       (const double* lon, const double* lat, int stride, point_t* p, int n, proj_t projection);
 };
 
 #endif /* __math_lib__ */
@@ -48,6 +48,8 @@ const struct luaL_Reg MetricDispatch::LuaMetaTable[] = {
     {"keyoffset",   luaSetKeyOffset},
     {"keyrange",    luaSetKeyRange},
     {"filter",      luaAddFilter},
+    {"retain",      luaRetain},
+    {"replay",      luaReplay},
     {NULL,          NULL}
 };
 
@@ -112,9 +114,14 @@ MetricDispatch::MetricDispatch(lua_State* L, const char* _data_field, const char
 
     /* Initialize Key Count/Offset/Min/Max */
     dataField           = StringLib::duplicate(_data_field);
+    dataHandle          = new RecordObject::FieldHandle(_data_field);
     idFilter            = _id_filter;
     fieldFilter         = NULL;
     outQ                = new Publisher(outq_name, freeSerialBuffer);
+
+    /* Initialize Retained Series */
+    maxRetained         = 0;
+    numRetained         = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -123,9 +130,11 @@ MetricDispatch::MetricDispatch(lua_State* L, const char* _data_field, const char
 MetricDispatch::~MetricDispatch(void)
 {
     if(dataField)   delete [] dataField;
+    delete dataHandle;
     if(idFilter)    delete idFilter;
     if(fieldFilter) delete fieldFilter;
     if(outQ)        delete outQ;
+    clearSeries();
 }
 
 /*----------------------------------------------------------------------------
@@ -139,6 +148,117 @@ void MetricDispatch::freeSerialBuffer(void* obj, void* parm)
     delete [] (char*)obj;
 }
 
+/*----------------------------------------------------------------------------
+ * retainSample  -
+ *
+ *   Notes: caller holds metricMutex
+ *----------------------------------------------------------------------------*/
+void MetricDispatch::retainSample (okey_t key, double value)
+{
+    /* Start New Block When Current One is Full or Key Does Not Fit a Delta */
+    seriesBlock_t* block = series.length() > 0 ? series[series.length() - 1] : NULL;
+    if(block && key < block->lastKey)
+    {
+        mlog(DEBUG, "Sample at key %lu out of order in %s, not retained", (unsigned long)key, getName());
+        return;
+    }
+    else if(!block || block->count >= SERIES_BLOCK_SIZE || (key - block->lastKey) > (okey_t)UINT32_MAX)
+    {
+        block = new seriesBlock_t;
+        block->firstKey = key;
+        block->lastKey = key;
+        block->count = 0;
+        series.add(block);
+    }
+
+    /* Append Sample */
+    block->keyDelta[block->count] = (uint32_t)(key - block->lastKey);
+    block->value[block->count] = value;
+    block->lastKey = key;
+    block->count++;
+    numRetained++;
+
+    /* Drop Oldest Block When Over Limit */
+    if(numRetained - series[0]->count >= maxRetained)
+    {
+        numRetained -= series[0]->count;
+        delete series[0];
+        series.remove(0);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * clearSeries  -
+ *----------------------------------------------------------------------------*/
+void MetricDispatch::clearSeries (void)
+{
+    for(int i = 0; i < series.length(); i++)
+    {
+        delete series[i];
+    }
+    series.clear();
+    numRetained = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * findBlock  - index of the first block that could hold a key at or above
+ *              the one supplied
+ *----------------------------------------------------------------------------*/
+int MetricDispatch::findBlock (okey_t key)
+{
+    int low = 0;
+    int high = series.length();
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+        if(series[mid]->lastKey < key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+/*----------------------------------------------------------------------------
+ * replaySeries  - posts retained samples between keys (inclusive)
+ *----------------------------------------------------------------------------*/
+long MetricDispatch::replaySeries (okey_t min_key, okey_t max_key)
+{
+    long posted = 0;
+
+    metricMutex.lock();
+    {
+        for(int b = findBlock(min_key); b < series.length(); b++)
+        {
+            seriesBlock_t* block = series[b];
+            if(block->firstKey > max_key) break;
+
+            /* Decode Keys in Place */
+            okey_t key = block->firstKey;
+            for(int i = 0; i < block->count; i++)
+            {
+                key += block->keyDelta[i];
+                if(key < min_key) continue;
+                else if(key > max_key) break;
+
+                MetricRecord metric(key, block->value[i], NULL, NULL, NULL, 0);
+                unsigned char* buffer;
+                int size = metric.serialize(&buffer, RecordObject::ALLOCATE);
+                int status = outQ->postRef(buffer, size, SYS_TIMEOUT);
+                if(status <= 0)
+                {
+                    mlog(CRITICAL, "Replay of %s stopped (%d) at key %lu", getName(), status, (unsigned long)key);
+                    delete [] buffer;
+                    b = series.length();
+                    break;
+                }
+                posted++;
+            }
+        }
+    }
+    metricMutex.unlock();
+
+    return posted;
+}
+
 /*----------------------------------------------------------------------------
  * processRecord
  *----------------------------------------------------------------------------*/
@@ -197,7 +317,7 @@ bool MetricDispatch::processRecord (RecordObject* record, okey_t key)
                     const char* field_name = fieldFilter->first(&filter_value);
                     while(enabled && field_name)
                     {
-                        RecordObject::field_t field = record->getField(field_name);
+                        RecordObject::field_t field = filter_value->field->resolve(record);
                         RecordObject::valType_t field_type = record->getValueType(field);
                         if((field_type == RecordObject::INTEGER) && (filter_value->lvalue != record->getValueInteger(field)))
                         {
@@ -225,7 +345,7 @@ bool MetricDispatch::processRecord (RecordObject* record, okey_t key)
             if(enabled)
             {
                 /* Generate Data Point */
-                RecordObject::field_t data_field = record->getField(dataField);
+                RecordObject::field_t data_field = dataHandle->resolve(record);
                 if(data_field.type != RecordObject::INVALID_FIELD)
                 {
                     /* Playback Source */
@@ -246,6 +366,16 @@ bool MetricDispatch::processRecord (RecordObject* record, okey_t key)
                     /* Playback Value */
                     double value = record->getValueReal(data_field);
 
+                    /* Retain Data Point */
+                    if(maxRetained > 0)
+                    {
+                        metricMutex.lock();
+                        {
+                            retainSample(key, value);
+                        }
+                        metricMutex.unlock();
+                    }
+
                     /* Index Data Point*/
                     MetricRecord metric(key, value, text, name, src, size);
                     serialBuffer_t sb; // value copy in ordering add is okay
@@ -484,7 +614,7 @@ int MetricDispatch::luaAddFilter(lua_State* L)
             }
 
             /* Add Field Filter */
-            fieldValue_t* value = new fieldValue_t(enable, field_val_l, field_val_d, field_val_s);
+            fieldValue_t* value = new fieldValue_t(field_name, enable, field_val_l, field_val_d, field_val_s);
 
             /* Add to Dictionary */
             status = lua_obj->fieldFilter->add(field_name, value);
@@ -504,3 +634,75 @@ int MetricDispatch::luaAddFilter(lua_State* L)
     /* Return Status */
     return returnLuaStatus(L, status);
 }
+
+/*----------------------------------------------------------------------------
+ * luaRetain - :retain(<maximum number of samples, 0 to disable>)
+ *----------------------------------------------------------------------------*/
+int MetricDispatch::luaRetain(lua_State* L)
+{
+    bool status = false;
+
+    try
+    {
+        /* Get Self */
+        MetricDispatch* lua_obj = (MetricDispatch*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        long max_samples = getLuaInteger(L, 2);
+        if(max_samples < 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid number of samples to retain: %ld", max_samples);
+        }
+
+        /* Set Retention */
+        lua_obj->metricMutex.lock();
+        {
+            lua_obj->maxRetained = max_samples;
+            if(max_samples == 0) lua_obj->clearSeries();
+        }
+        lua_obj->metricMutex.unlock();
+
+        /* Set Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting retention: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * luaReplay - :replay([<min key>], [<max key>]) --> number of samples posted
+ *----------------------------------------------------------------------------*/
+int MetricDispatch::luaReplay(lua_State* L)
+{
+    bool status = false;
+    long posted = 0;
+
+    try
+    {
+        /* Get Self */
+        MetricDispatch* lua_obj = (MetricDispatch*)getLuaSelf(L, 1);
+
+        /* Get Parameters */
+        bool max_provided = false;
+        okey_t min_key = (okey_t)getLuaInteger(L, 2, true, 0);
+        okey_t max_key = (okey_t)getLuaInteger(L, 3, true, 0, &max_provided);
+        if(!max_provided) max_key = INVALID_KEY;
+
+        /* Replay Samples */
+        posted = lua_obj->replaySeries(min_key, max_key);
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error replaying metrics: %s", e.what());
+    }
+
+    /* Return Status */
+    lua_pushinteger(L, posted);
+    return returnLuaStatus(L, status, 2);
+}
@@ -41,6 +41,7 @@
 #include "DispatchObject.h"
 #include "OsApi.h"
 #include "MetricRecord.h"
+#include "ArrayList.h"
 
 /******************************************************************************
  * METRIC DISPATCH CLASS
@@ -70,6 +71,7 @@ class MetricDispatch: public DispatchObject
          *--------------------------------------------------------------------*/
 
         static const int FIELD_FILTER_DICT_SIZE = 10;
+        static const int SERIES_BLOCK_SIZE = 256; // samples per retained block
 
         /*--------------------------------------------------------------------
          * Types
@@ -86,26 +88,42 @@ class MetricDispatch: public DispatchObject
             long            lvalue;
             double          dvalue;
             const char*     svalue;
+            RecordObject::FieldHandle* field;
 
-            fieldValue_t(bool _enable, long _lvalue, double _dvalue, const char* _svalue)
+            fieldValue_t(const char* _field_name, bool _enable, long _lvalue, double _dvalue, const char* _svalue)
             {
                 enable = _enable;
                 lvalue = _lvalue;
                 dvalue = _dvalue;
                 svalue = StringLib::duplicate(_svalue);
+                field = new RecordObject::FieldHandle(_field_name);
             }
 
             ~fieldValue_t(void)
             {
                 if(svalue) delete [] svalue;
+                delete field;
             }
         };
 
+        /* Retained samples are held in fixed size columnar blocks; keys are
+         * stored as deltas from the previous key so a block of samples from a
+         * steady stream costs twelve bytes a sample, and the first key of each
+         * block indexes it for a binary search on playback */
+        typedef struct {
+            okey_t          firstKey;
+            okey_t          lastKey;
+            int             count;
+            uint32_t        keyDelta[SERIES_BLOCK_SIZE];    // from previous key, first is zero
+            double          value[SERIES_BLOCK_SIZE];
+        } seriesBlock_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
         const char*                     dataField;      // value of metric
+        RecordObject::FieldHandle*      dataHandle;     // resolved data field
         List<long>*                     idFilter;       // id of record, not data or key
         MgDictionary<fieldValue_t*>*    fieldFilter;    // more computationally intensive filter, matches field to value
         Publisher*                      outQ;           // output queue metrics are posted to
@@ -119,6 +137,10 @@ class MetricDispatch: public DispatchObject
 
         Mutex                           metricMutex;
 
+        ArrayList<seriesBlock_t*>       series;         // retained samples, ordered by key
+        long                            maxRetained;    // zero disables retention
+        long                            numRetained;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -127,6 +149,10 @@ class MetricDispatch: public DispatchObject
                     ~MetricDispatch     (void);
 
         static void freeSerialBuffer    (void* obj, void* parm);
+        void        retainSample        (okey_t key, double value);
+        void        clearSeries         (void);
+        int         findBlock           (okey_t key);
+        long        replaySeries        (okey_t min_key, okey_t max_key);
 
         /* Overridden Methods */
         bool        processRecord       (RecordObject* record, okey_t key);
@@ -138,6 +164,8 @@ class MetricDispatch: public DispatchObject
         static int  luaSetKeyOffset     (lua_State* L);
         static int  luaSetKeyRange      (lua_State* L);
         static int  luaAddFilter        (lua_State* L);
+        static int  luaRetain           (lua_State* L);
+        static int  luaReplay           (lua_State* L);
 };
 
 #endif  /* __metric_dispatch__ */
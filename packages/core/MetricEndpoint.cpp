@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <ctype.h>
+
+#include "MetricEndpoint.h"
+#include "core.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* MetricEndpoint::LuaMetaName = "MetricEndpoint";
+const struct luaL_Reg MetricEndpoint::LuaMetaTable[] = {
+    {NULL,          NULL}
+};
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * luaCreate - prometheus([<max age ms>])
+ *----------------------------------------------------------------------------*/
+int MetricEndpoint::luaCreate (lua_State* L)
+{
+    try
+    {
+        /* Get Parameters */
+        long max_age_ms = getLuaInteger(L, 1, true, 0);
+
+        /* Check Parameters */
+        if(max_age_ms < 0) throw RunTimeException(CRITICAL, RTE_ERROR, "invalid maximum age: %ld", max_age_ms);
+
+        /* Create Metric Endpoint */
+        return createLuaObject(L, new MetricEndpoint(L, max_age_ms));
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error creating %s: %s", LuaMetaName, e.what());
+        return returnLuaStatus(L, false);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * writeExposition
+ *
+ *  rewrites the exposition from the start, growing its buffer as needed
+ *----------------------------------------------------------------------------*/
+void MetricEndpoint::writeExposition (exposition_t* exposition)
+{
+    if(exposition->buffer == NULL)
+    {
+        exposition->size = INITIAL_BUFFER_SIZE;
+        exposition->buffer = new char [exposition->size];
+    }
+    exposition->length = 0;
+
+    EventLib::iterateMetric(NULL, writeMetric, exposition);
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+MetricEndpoint::MetricEndpoint(lua_State* L, int64_t max_age_ms):
+    EndpointObject(L, LuaMetaName, LuaMetaTable)
+{
+    exposition.buffer = NULL;
+    exposition.size = 0;
+    exposition.length = 0;
+    maxAgeMs = max_age_ms;
+    builtMs = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+MetricEndpoint::~MetricEndpoint(void)
+{
+    delete [] exposition.buffer;
+}
+
+/*----------------------------------------------------------------------------
+ * handleRequest
+ *
+ *  responds from the calling server thread; the request is owned by the
+ *  endpoint once handed over and is freed here
+ *----------------------------------------------------------------------------*/
+EndpointObject::rsptype_t MetricEndpoint::handleRequest (Request* request)
+{
+    Publisher rspq(request->id);
+    char header[MAX_HDR_SIZE];
+
+    if(request->verb == GET)
+    {
+        expositionMut.lock();
+        {
+            /* Rewrite Exposition Once It is Older than Maximum Age */
+            int64_t now = TimeLib::gettimems();
+            if(exposition.buffer == NULL || (now - builtMs) >= maxAgeMs)
+            {
+                writeExposition(&exposition);
+                builtMs = now;
+            }
+
+            /* Send Exposition */
+            int header_length = buildheader(header, OK, "text/plain; version=0.0.4", exposition.length);
+            rspq.postCopy(header, header_length);
+            if(exposition.length > 0) rspq.postCopy(exposition.buffer, exposition.length);
+        }
+        expositionMut.unlock();
+    }
+    else
+    {
+        int header_length = buildheader(header, Method_Not_Allowed);
+        rspq.postCopy(header, header_length);
+    }
+
+    /* End Response */
+    rspq.postCopy("", 0);
+    delete request;
+
+    return NORMAL;
+}
+
+/*----------------------------------------------------------------------------
+ * writeMetric
+ *
+ *  metric name is <category>_<name> with any character prometheus does not
+ *  allow in a name replaced by an underscore
+ *----------------------------------------------------------------------------*/
+void MetricEndpoint::writeMetric (const EventLib::metric_t& metric, int32_t index, void* parm)
+{
+    (void)index;
+
+    exposition_t* exposition = (exposition_t*)parm;
+
+    /* Build Metric Name */
+    char name[MAX_STR_SIZE];
+    StringLib::format(name, MAX_STR_SIZE, "%s.%s", metric.category, metric.name);
+    for(int i = 0; name[i] != '\0'; i++)
+    {
+        if(!isalnum((unsigned char)name[i]) && name[i] != '_') name[i] = '_';
+    }
+
+    /* Append Metric */
+    char line[MAX_STR_SIZE * 3];
+    int len = StringLib::formats(line, sizeof(line), "\n# TYPE %s %s\n%s %.17g\n", name, EventLib::subtype2str(metric.subtype), name, metric.value);
+    append(exposition, line, len);
+}
+
+/*----------------------------------------------------------------------------
+ * append
+ *----------------------------------------------------------------------------*/
+void MetricEndpoint::append (exposition_t* exposition, const char* str, int len)
+{
+    if(exposition->length + len > exposition->size)
+    {
+        int size = MAX(exposition->size * 2, exposition->length + len);
+        char* buffer = new char [size];
+        LocalLib::copy(buffer, exposition->buffer, exposition->length);
+        delete [] exposition->buffer;
+        exposition->buffer = buffer;
+        exposition->size = size;
+    }
+
+    LocalLib::copy(&exposition->buffer[exposition->length], str, len);
+    exposition->length += len;
+}
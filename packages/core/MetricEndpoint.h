@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __metric_endpoint__
+#define __metric_endpoint__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "EndpointObject.h"
+#include "EventLib.h"
+#include "OsApi.h"
+
+/******************************************************************************
+ * METRIC ENDPOINT CLASS
+ ******************************************************************************/
+
+/*
+ * MetricEndpoint - serves every metric registered with EventLib in the
+ *  Prometheus text exposition format directly from the server thread, without
+ *  a LuaEngine.  The exposition is written into a buffer that is reused from
+ *  scrape to scrape and, when a maximum age is given, served as is to scrapes
+ *  arriving within that age.
+ */
+class MetricEndpoint: public EndpointObject
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const char* LuaMetaName;
+        static const struct luaL_Reg LuaMetaTable[];
+
+        static const int INITIAL_BUFFER_SIZE = 0x10000; // 64KB
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            char*   buffer;
+            int     size;   // allocated
+            int     length; // written
+        } exposition_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static int      luaCreate       (lua_State* L);
+        static void     writeExposition (exposition_t* exposition);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        Mutex           expositionMut;
+        exposition_t    exposition;
+        int64_t         maxAgeMs;
+        int64_t         builtMs;    // when exposition was last written
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        MetricEndpoint  (lua_State* L, int64_t max_age_ms);
+                        ~MetricEndpoint (void);
+
+        rsptype_t       handleRequest   (Request* request) override;
+
+        static void     writeMetric     (const EventLib::metric_t& metric, int32_t index, void* parm);
+        static void     append          (exposition_t* exposition, const char* str, int len);
+};
+
+#endif  /* __metric_endpoint__ */
@@ -94,6 +94,14 @@ Monitor::Monitor(lua_State* L, uint8_t type_mask, event_level_t level, format_t
     eventTailArray  = NULL;
     eventTailSize   = 0;
     eventTailIndex  = 0;
+    batchBuffer     = NULL;
+    batchSize       = 0;
+
+    /* Initialize Binary Batch */
+    if(outputFormat == BINARY)
+    {
+        batchBuffer = new char [BINARY_BATCH_SIZE];
+    }
 
     /* Initialize Output Q */
     if(outq_name)   outQ = new Publisher(outq_name);
@@ -105,8 +113,10 @@ Monitor::Monitor(lua_State* L, uint8_t type_mask, event_level_t level, format_t
  *----------------------------------------------------------------------------*/
 Monitor::~Monitor(void)
 {
+    if(batchBuffer) flushBatch();
     if(outQ) delete outQ;
     if(eventTailArray) delete [] eventTailArray;
+    if(batchBuffer) delete [] batchBuffer;
 }
 
 /*----------------------------------------------------------------------------
@@ -137,6 +147,18 @@ bool Monitor::processRecord (RecordObject* record, okey_t key)
         int size = record->serialize(&buffer, RecordObject::REFERENCE);
         if(outQ) outQ->postCopy(buffer, size, IO_CHECK);
     }
+    else if(outputFormat == BINARY)
+    {
+        /* Batch Event as Binary Frame */
+        binaryOutput(event);
+
+        /* (Optionally) Tail Event - text is only produced for the tail */
+        if(eventTailArray)
+        {
+            textOutput(event, &eventTailArray[eventTailIndex * MAX_EVENT_SIZE]);
+            eventTailIndex = (eventTailIndex + 1) % eventTailSize;
+        }
+    }
     else
     {
         /* Format Event */
@@ -173,6 +195,24 @@ bool Monitor::processRecord (RecordObject* record, okey_t key)
     return true;
 }
 
+/*----------------------------------------------------------------------------
+ * processTimeout
+ *----------------------------------------------------------------------------*/
+bool Monitor::processTimeout (void)
+{
+    if(batchBuffer) flushBatch();
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processTermination
+ *----------------------------------------------------------------------------*/
+bool Monitor::processTermination (void)
+{
+    if(batchBuffer) flushBatch();
+    return true;
+}
+
 /*----------------------------------------------------------------------------
  * textOutput
  *----------------------------------------------------------------------------*/
@@ -241,6 +281,59 @@ int Monitor::cloudOutput (EventLib::event_t* event, char* event_buffer)
     return msg - event_buffer + 1;
 }
 
+/*----------------------------------------------------------------------------
+ * binaryOutput
+ *
+ *  appends the event to the batch as a length prefixed frame; the batch is
+ *  posted when the next frame does not fit or when the dispatcher goes idle
+ *----------------------------------------------------------------------------*/
+void Monitor::binaryOutput (EventLib::event_t* event)
+{
+    /* Size Frame */
+    int ipv4_size = StringLib::size(event->ipv4, SockLib::IPV4_STR_LEN - 1) + 1;
+    int name_size = StringLib::size(event->name, EventLib::MAX_NAME_SIZE - 1) + 1;
+    int attr_size = StringLib::size(event->attr, EventLib::MAX_ATTR_SIZE - 1) + 1;
+    int frame_size = sizeof(binary_frame_t) + ipv4_size + name_size + attr_size;
+
+    /* Make Room in Batch */
+    if(batchSize + frame_size > BINARY_BATCH_SIZE)
+    {
+        flushBatch();
+    }
+
+    /* Populate Header */
+    binary_frame_t frame;
+    frame.size      = frame_size;
+    frame.type      = event->type;
+    frame.level     = event->level;
+    frame.flags     = event->flags;
+    frame.id        = event->id;
+    frame.parent    = event->parent;
+    frame.systime   = event->systime;
+    frame.tid       = event->tid;
+
+    /* Append Frame */
+    char* dst = &batchBuffer[batchSize];
+    LocalLib::copy(dst, &frame, sizeof(binary_frame_t));    dst += sizeof(binary_frame_t);
+    LocalLib::copy(dst, event->ipv4, ipv4_size - 1);        dst += ipv4_size; dst[-1] = '\0';
+    LocalLib::copy(dst, event->name, name_size - 1);        dst += name_size; dst[-1] = '\0';
+    LocalLib::copy(dst, event->attr, attr_size - 1);        dst += attr_size; dst[-1] = '\0';
+    batchSize += frame_size;
+}
+
+/*----------------------------------------------------------------------------
+ * flushBatch
+ *----------------------------------------------------------------------------*/
+void Monitor::flushBatch (void)
+{
+    if(batchSize <= 0) return;
+
+    if(outQ) outQ->postCopy(batchBuffer, batchSize, IO_CHECK);
+    else     fwrite(batchBuffer, 1, batchSize, stdout);
+
+    batchSize = 0;
+}
+
 /*----------------------------------------------------------------------------
  * luaConfig - :config([<type mask>], [<level>]) --> type mask, level, status
  *----------------------------------------------------------------------------*/
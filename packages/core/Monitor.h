@@ -65,9 +65,24 @@ class Monitor: public DispatchObject
             TEXT,
             JSON,
             CLOUD,
-            RECORD
+            RECORD,
+            BINARY
         } format_t;
 
+        /* Binary Output Frame
+         *  each frame is this header followed by the null terminated ipv4,
+         *  name, and attribute strings; size covers the whole frame */
+        typedef struct {
+            uint32_t    size;
+            uint8_t     type;
+            uint8_t     level;
+            uint16_t    flags;
+            uint32_t    id;
+            uint32_t    parent;
+            int64_t     systime;
+            int64_t     tid;
+        } binary_frame_t;
+
         typedef enum {
             TERM = 0,
             LOCAL = 1,
@@ -88,6 +103,7 @@ class Monitor: public DispatchObject
 
         static const int MAX_EVENT_SIZE = 1280;
         static const int MAX_TAIL_SIZE = 65536;
+        static const int BINARY_BATCH_SIZE = 0x10000; // bytes of frames posted together
 
         /*--------------------------------------------------------------------
          * Methods
@@ -97,8 +113,12 @@ class Monitor: public DispatchObject
                     ~Monitor        (void);
 
         bool        processRecord   (RecordObject* record, okey_t key) override;
+        bool        processTimeout  (void) override;
+        bool        processTermination (void) override;
 
         int         textOutput      (EventLib::event_t* event, char* event_buffer);
+        void        binaryOutput    (EventLib::event_t* event);
+        void        flushBatch      (void);
         int         jsonOutput      (EventLib::event_t* event, char* event_buffer);
         int         cloudOutput     (EventLib::event_t* event, char* event_buffer);
 
@@ -117,6 +137,8 @@ class Monitor: public DispatchObject
         char*           eventTailArray; // [][MAX_EVENT_SIZE]
         int             eventTailSize;
         int             eventTailIndex;
+        char*           batchBuffer;    // binary frames pending post
+        int             batchSize;
 };
 
 #endif  /* __monitor__ */
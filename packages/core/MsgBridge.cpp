@@ -109,50 +109,72 @@ MsgBridge::~MsgBridge(void)
 
 /*----------------------------------------------------------------------------
  * bridgeThread
+ *
+ *  drains the input queue in batches; messages posted by reference are handed
+ *  to the output queue without a copy when no other subscriber holds them and
+ *  both queues free data the same way, everything else is copied
  *----------------------------------------------------------------------------*/
 void* MsgBridge::bridgeThread(void* parm)
 {
     MsgBridge* bridge = (MsgBridge*)parm;
+    Subscriber::msgRef_t refs[BATCH_SIZE];
+    void* data[BATCH_SIZE];
+    int sizes[BATCH_SIZE];
 
     /* Loop Forever */
     while(bridge->active)
     {
-        /* Receive Message */
-        Subscriber::msgRef_t ref;
-        int recv_status = bridge->inQ->receiveRef(ref, SYS_TIMEOUT);
-        if(recv_status > 0)
+        /* Receive Messages */
+        int num_refs = bridge->inQ->receiveBatch(refs, BATCH_SIZE, SYS_TIMEOUT);
+        if(num_refs > 0)
         {
-            unsigned char* msg = (unsigned char*)ref.data;
-            int len = ref.size;
-
-            /* Dispatch Record */
-            if(len > 0)
+            MsgQ::free_func_t in_free = bridge->inQ->getFreeFunc();
+            bool by_ref = (in_free != NULL) && (in_free == bridge->outQ->getFreeFunc());
+            bool terminated = false;
+
+            /* Dispatch Records in Runs of Copies and References */
+            int run = 0;
+            bool run_by_ref = false;
+            for(int i = 0; i < num_refs && bridge->active; i++)
             {
-                int status = MsgQ::STATE_TIMEOUT;
-                while(bridge->active && status == MsgQ::STATE_TIMEOUT)
+                if(refs[i].size <= 0)
+                {
+                    /* Terminating Message */
+                    mlog(DEBUG, "Terminator received on %s, exiting bridge", bridge->inQ->getName());
+                    terminated = true;
+                    break;
+                }
+
+                bool detached = by_ref && bridge->inQ->detach(refs[i]);
+                if(run > 0 && detached != run_by_ref)
                 {
-                    status = bridge->outQ->postCopy(msg, len, SYS_TIMEOUT);
-                    if(status < 0)
-                    {
-                        mlog(CRITICAL, "Failed (%d) bridge from %s to %s... exiting!", status, bridge->inQ->getName(), bridge->outQ->getName());
-                        bridge->active = false;
-                    }
+                    bridge->forward(data, sizes, run, run_by_ref);
+                    run = 0;
                 }
+
+                run_by_ref = detached;
+                data[run] = refs[i].data;
+                sizes[run] = refs[i].size;
+                run++;
             }
-            else
+
+            if(run > 0)
             {
-                /* Terminating Message */
-                mlog(DEBUG, "Terminator received on %s, exiting bridge", bridge->inQ->getName());
-                bridge->active = false; // breaks out of loop
+                bridge->forward(data, sizes, run, run_by_ref);
             }
 
-            /* Dereference Message */
-            bridge->inQ->dereference(ref);
+            /* Dereference Messages */
+            bridge->inQ->dereferenceBatch(refs, num_refs);
+
+            if(terminated)
+            {
+                bridge->active = false; // breaks out of loop
+            }
         }
-        else if(recv_status != MsgQ::STATE_TIMEOUT)
+        else if(num_refs != MsgQ::STATE_TIMEOUT)
         {
             /* Break Out on Failure */
-            mlog(CRITICAL, "Failed queue receive on %s with error %d", bridge->inQ->getName(), recv_status);
+            mlog(CRITICAL, "Failed queue receive on %s with error %d", bridge->inQ->getName(), num_refs);
             bridge->active = false; // breaks out of loop
         }
     }
@@ -162,3 +184,51 @@ void* MsgBridge::bridgeThread(void* parm)
 
     return NULL;
 }
+
+/*----------------------------------------------------------------------------
+ * forward
+ *
+ *  posts messages to the output queue; references that are not posted are
+ *  freed here since the bridge owns them.  Returns the number posted.
+ *----------------------------------------------------------------------------*/
+int MsgBridge::forward(void** data, int* sizes, int n, bool by_ref)
+{
+    int posted = 0;
+    int status = MsgQ::STATE_OKAY;
+
+    while(posted < n)
+    {
+        if(by_ref)  status = outQ->postBatch(&data[posted], &sizes[posted], n - posted, SYS_TIMEOUT);
+        else        status = outQ->postCopyBatch((const void**)&data[posted], &sizes[posted], n - posted, SYS_TIMEOUT);
+
+        if(status > 0)
+        {
+            posted += status;
+        }
+        else if(status != MsgQ::STATE_TIMEOUT || !active)
+        {
+            break;
+        }
+    }
+
+    if(posted < n)
+    {
+        /* no subscribers drops the messages, as it does for copies */
+        if(status < 0 && status != MsgQ::STATE_NO_SUBSCRIBERS)
+        {
+            mlog(CRITICAL, "Failed (%d) bridge from %s to %s... exiting!", status, inQ->getName(), outQ->getName());
+            active = false;
+        }
+
+        if(by_ref)
+        {
+            MsgQ::free_func_t out_free = outQ->getFreeFunc();
+            for(int i = posted; i < n; i++)
+            {
+                (*out_free)(data[i], NULL);
+            }
+        }
+    }
+
+    return posted;
+}
@@ -60,6 +60,7 @@ class MsgBridge: public LuaObject
          * Constants
          *--------------------------------------------------------------------*/
 
+        static const int BATCH_SIZE = 256;
         static const char* LuaMetaName;
         static const struct luaL_Reg LuaMetaTable[];
 
@@ -86,6 +87,7 @@ class MsgBridge: public LuaObject
          *--------------------------------------------------------------------*/
 
         static void*    bridgeThread    (void* parm);
+        int             forward         (void** data, int* sizes, int n, bool by_ref);
 };
 
 #endif  /* __msg_bridge__ */
@@ -37,8 +37,16 @@
 #include "OsApi.h"
 #include "Dictionary.h"
 #include "StringLib.h"
+#include "RecordPool.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include <cstdarg>
+#include <thread>
 
 /******************************************************************************
  * STATIC DATA
@@ -46,7 +54,7 @@
 
 int MsgQ::StandardQueueDepth = MsgQ::CFG_DEPTH_INFINITY;
 Dictionary<MsgQ::message_queue_t*> MsgQ::queues;
-Mutex MsgQ::listmut;
+Mutex MsgQ::listmut("msgq.list");
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -76,15 +84,35 @@ MsgQ::MsgQ(const char* name, MsgQ::free_func_t free_func, int depth, int data_si
             msgQ->back              = NULL;
             msgQ->name              = StringLib::duplicate(name);
             msgQ->len               = 0;
+            msgQ->bytes             = 0;
+            msgQ->peak_bytes        = 0;
+            msgQ->max_bytes         = 0;
             msgQ->max_data_size     = data_size;
             msgQ->soo_count         = 0;
             msgQ->free_func         = free_func;
-            msgQ->locknblock        = new Cond(NUMSIGS);
+            msgQ->locknblock        = new Cond(NUMSIGS, "msgq");
             msgQ->state             = STATE_OKAY;
             msgQ->attachments       = 1;
             msgQ->subscriptions     = 0;
             msgQ->max_subscribers   = MSGQ_DEFAULT_SUBSCRIBERS;
             msgQ->free_blocks       = 0;
+            msgQ->spsc_declared     = false;
+            msgQ->spsc_active       = false;
+            msgQ->spsc_post_busy    = false;
+            msgQ->spsc_recv_busy    = false;
+            msgQ->spsc_post_waiting = false;
+            msgQ->spsc_recv_waiting = false;
+            msgQ->ring_head         = 0;
+            msgQ->ring_tail         = 0;
+            msgQ->ring              = NULL;
+            msgQ->ring_mask         = 0;
+            msgQ->spill_path        = NULL;
+            msgQ->spill_fd          = -1;
+            msgQ->spill_write_pos   = 0;
+            msgQ->spill_read_pos    = 0;
+            msgQ->spill_count       = 0;
+            msgQ->spill_bytes       = 0;
+            msgQ->sub_watchers      = NULL;
 
             // Set depth
             if(depth == CFG_DEPTH_STANDARD) msgQ->depth = StandardQueueDepth;
@@ -147,6 +175,15 @@ MsgQ::~MsgQ()
             delete [] msgQ->free_block_stack;
             delete [] msgQ->subscriber_type;
             delete [] msgQ->curr_nodes;
+            delete [] msgQ->ring;
+            if(msgQ->spill_fd >= 0) close(msgQ->spill_fd);
+            if(msgQ->spill_path) delete [] msgQ->spill_path;
+            while(msgQ->sub_watchers)
+            {
+                sub_watcher_t* watcher = msgQ->sub_watchers;
+                msgQ->sub_watchers = watcher->next;
+                delete watcher;
+            }
 
             /* Free Message Q */
             delete msgQ;
@@ -160,6 +197,7 @@ MsgQ::~MsgQ()
  *----------------------------------------------------------------------------*/
 int MsgQ::getCount(void)
 {
+    if(msgQ->spsc_active) return (int)(msgQ->ring_tail - msgQ->ring_head);
     return msgQ->len;
 }
 
@@ -171,6 +209,84 @@ int MsgQ::getDepth(void)
     return msgQ->depth;
 }
 
+/*----------------------------------------------------------------------------
+ * getPeakBytes
+ *
+ *  nodes passed through the single producer/single consumer ring are not
+ *  counted, as they never sit on the chain
+ *----------------------------------------------------------------------------*/
+int64_t MsgQ::getPeakBytes(void)
+{
+    int64_t peak_bytes;
+    msgQ->locknblock->lock();
+    {
+        peak_bytes = msgQ->peak_bytes;
+    }
+    msgQ->locknblock->unlock();
+    return peak_bytes;
+}
+
+/*----------------------------------------------------------------------------
+ * setMaxBytes
+ *
+ *  bounds the data held by the queue in addition to its depth: posts wait
+ *  while the messages not yet released by every subscriber add up to the
+ *  limit, so a slow subscriber holds its publishers back by memory rather
+ *  than by message count; a message of any size is accepted while the queue
+ *  is under the limit.  Zero removes the limit.  Messages stay on the node
+ *  chain, where they are counted, while a limit is set
+ *----------------------------------------------------------------------------*/
+void MsgQ::setMaxBytes(int64_t max_bytes)
+{
+    msgQ->locknblock->lock();
+    {
+        spscStop();
+        msgQ->max_bytes = MAX(max_bytes, 0);
+        spscStart();
+        msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ALL);
+    }
+    msgQ->locknblock->unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * setSpill
+ *
+ *  posts made while the queue is full go to the spill file at path instead of
+ *  waiting, and are read back in order once the subscriber has received
+ *  everything on the chain; the file is created on the first spill and is
+ *  removed from the file system as soon as it is open.  Spilling starts only
+ *  while the queue has a single subscriber, and keeps the chain in use.  NULL
+ *  stops further spilling
+ *----------------------------------------------------------------------------*/
+bool MsgQ::setSpill(const char* path)
+{
+    msgQ->locknblock->lock();
+    {
+        spscStop();
+        if(msgQ->spill_path) delete [] msgQ->spill_path;
+        msgQ->spill_path = StringLib::duplicate(path);
+        spscStart();
+        msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ALL);
+    }
+    msgQ->locknblock->unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * getSpillBytes
+ *----------------------------------------------------------------------------*/
+int64_t MsgQ::getSpillBytes(void)
+{
+    int64_t spill_bytes;
+    msgQ->locknblock->lock();
+    {
+        spill_bytes = msgQ->spill_bytes;
+    }
+    msgQ->locknblock->unlock();
+    return spill_bytes;
+}
+
 /*----------------------------------------------------------------------------
  * getName
  *----------------------------------------------------------------------------*/
@@ -187,6 +303,54 @@ int MsgQ::getSubCnt(void)
     return msgQ->subscriptions;
 }
 
+/*----------------------------------------------------------------------------
+ * getFreeFunc
+ *----------------------------------------------------------------------------*/
+MsgQ::free_func_t MsgQ::getFreeFunc(void)
+{
+    return msgQ->free_func;
+}
+
+/*----------------------------------------------------------------------------
+ * watchSubs
+ *
+ *  cond is signalled on sig, with its lock held, when the last subscriber
+ *  detaches from the queue; returns false without registering if the queue
+ *  has no subscribers.  The watcher must call unwatchSubs before cond is
+ *  deleted, and must not hold cond's lock while calling either method
+ *----------------------------------------------------------------------------*/
+bool MsgQ::watchSubs(Cond* cond, int sig)
+{
+    return addWatcher(cond, sig, NULL, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * watchSubs
+ *
+ *  same as above, but func is called with parm while the queue is locked, so
+ *  it must not use the queue
+ *----------------------------------------------------------------------------*/
+bool MsgQ::watchSubs(watch_func_t func, void* parm)
+{
+    return addWatcher(NULL, 0, func, parm);
+}
+
+/*----------------------------------------------------------------------------
+ * unwatchSubs
+ *----------------------------------------------------------------------------*/
+void MsgQ::unwatchSubs(Cond* cond)
+{
+    removeWatcher(cond, NULL, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * unwatchSubs
+ *----------------------------------------------------------------------------*/
+void MsgQ::unwatchSubs(watch_func_t func, void* parm)
+{
+    removeWatcher(NULL, func, parm);
+}
+
 /*----------------------------------------------------------------------------
  * getState
  *----------------------------------------------------------------------------*/
@@ -200,7 +364,15 @@ int MsgQ::getState(void)
  *----------------------------------------------------------------------------*/
 bool MsgQ::isFull(void)
 {
-    if(msgQ->depth == CFG_DEPTH_INFINITY)
+    if(msgQ->spsc_active)
+    {
+        return spscFull();
+    }
+    else if(msgQ->max_bytes > 0 && msgQ->bytes >= msgQ->max_bytes)
+    {
+        return true;
+    }
+    else if(msgQ->depth == CFG_DEPTH_INFINITY)
     {
         return false;
     }
@@ -214,6 +386,40 @@ bool MsgQ::isFull(void)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * declareSPSC
+ *
+ *  the caller guarantees that only one thread posts to and only one thread
+ *  receives from the queue; while the queue has a single subscriber of
+ *  confidence, messages are then passed through a lock-free ring instead
+ *  of the node chain, and the queue reverts to the chain as soon as another
+ *  subscriber attaches; only queues of finite depth can be declared
+ *----------------------------------------------------------------------------*/
+bool MsgQ::declareSPSC(void)
+{
+    bool status = false;
+
+    msgQ->locknblock->lock();
+    {
+        if(msgQ->depth > 0)
+        {
+            if(!msgQ->spsc_declared)
+            {
+                uint64_t ring_size = 1;
+                while(ring_size < (uint64_t)msgQ->depth) ring_size <<= 1;
+                msgQ->ring = new queue_node_t* [ring_size];
+                msgQ->ring_mask = ring_size - 1;
+                msgQ->spsc_declared = true;
+            }
+            spscStart();
+            status = true;
+        }
+    }
+    msgQ->locknblock->unlock();
+
+    return status;
+}
+
 /*----------------------------------------------------------------------------
  * init
  *
@@ -239,6 +445,7 @@ void MsgQ::deinit(void)
         delete [] curr_q->free_block_stack;
         delete [] curr_q->subscriber_type;
         delete [] curr_q->curr_nodes;
+        delete [] curr_q->ring;
         delete curr_q;
         curr_name = queues.next(&curr_q);
     }
@@ -290,6 +497,29 @@ int MsgQ::listQ(queueDisplay_t* list, int list_size)
     return j;
 }
 
+/*----------------------------------------------------------------------------
+ * totalBytes
+ *
+ *  sums the data held on the chains of all queues; the chains are read
+ *  without their locks, so the total is approximate
+ *----------------------------------------------------------------------------*/
+int64_t MsgQ::totalBytes(void)
+{
+    int64_t total = 0;
+    listmut.lock();
+    {
+        message_queue_t* curr_q = NULL;
+        const char* curr_name = queues.first(&curr_q);
+        while(curr_name)
+        {
+            total += curr_q->bytes;
+            curr_name = queues.next(&curr_q);
+        }
+    }
+    listmut.unlock();
+    return total;
+}
+
 /*----------------------------------------------------------------------------
  * setStdQDepth
  *----------------------------------------------------------------------------*/
@@ -306,6 +536,198 @@ bool MsgQ::setStdQDepth(int depth)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * spscEnter
+ *
+ *  marks the caller as inside the fast path and then checks that the ring is
+ *  active; spscStop clears active before waiting for both sides to leave, so
+ *  either the caller sees the ring inactive or spscStop waits for it
+ *----------------------------------------------------------------------------*/
+bool MsgQ::spscEnter(std::atomic<bool>& busy)
+{
+    busy = true;
+    if(msgQ->spsc_active) return true;
+    busy = false;
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * spscFull
+ *----------------------------------------------------------------------------*/
+bool MsgQ::spscFull(void)
+{
+    return (msgQ->ring_tail - msgQ->ring_head) >= (uint64_t)msgQ->depth;
+}
+
+/*----------------------------------------------------------------------------
+ * spscEmpty
+ *----------------------------------------------------------------------------*/
+bool MsgQ::spscEmpty(void)
+{
+    return msgQ->ring_head == msgQ->ring_tail;
+}
+
+/*----------------------------------------------------------------------------
+ * spscStart
+ *
+ *  must be called with the queue locked; the ring is only started when the
+ *  node chain is empty so that message order is preserved
+ *----------------------------------------------------------------------------*/
+void MsgQ::spscStart(void)
+{
+    if( msgQ->spsc_declared && !msgQ->spsc_active && (msgQ->max_bytes == 0) &&
+        (msgQ->subscriptions == 1) && (msgQ->soo_count == 0) &&
+        (msgQ->front == NULL) && (msgQ->spill_path == NULL) )
+    {
+        msgQ->ring_head = 0;
+        msgQ->ring_tail = 0;
+        msgQ->spsc_active = true;
+
+        /* wake publishers and subscribers blocked on the chain */
+        msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ALL);
+        msgQ->locknblock->signal(READY2RECV, Cond::NOTIFY_ALL);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * spscStop
+ *
+ *  must be called with the queue locked; waits for the publisher and the
+ *  subscriber to leave the fast path and then moves the contents of the ring
+ *  onto the node chain for the current subscriber
+ *----------------------------------------------------------------------------*/
+void MsgQ::spscStop(void)
+{
+    if(!msgQ->spsc_active) return;
+
+    /* Stop Fast Path */
+    msgQ->spsc_active = false;
+    while(msgQ->spsc_post_busy || msgQ->spsc_recv_busy)
+    {
+        std::this_thread::yield();
+    }
+
+    /* Find Current Subscriber */
+    int sub_id = -1;
+    for(int i = 0; i < msgQ->max_subscribers; i++)
+    {
+        if(msgQ->subscriber_type[i] != UNSUBSCRIBED)
+        {
+            sub_id = i;
+            break;
+        }
+    }
+
+    /* Move Ring onto Chain */
+    uint64_t head = msgQ->ring_head;
+    uint64_t tail = msgQ->ring_tail;
+    for(uint64_t i = head; i < tail; i++)
+    {
+        queue_node_t* node = msgQ->ring[i & msgQ->ring_mask];
+        node->next = NULL;
+        node->refs = 1;
+        node->spsc = false;
+
+        if(msgQ->back == NULL)  msgQ->front = node;
+        else                    msgQ->back->next = node;
+        msgQ->back = node;
+
+        if(sub_id >= 0 && msgQ->curr_nodes[sub_id] == NULL)
+        {
+            msgQ->curr_nodes[sub_id] = node;
+        }
+
+        msgQ->len++;
+        msgQ->bytes += node->mask & ~MSGQ_COPYQ_MASK;
+    }
+    msgQ->ring_head = tail;
+    if(msgQ->bytes > msgQ->peak_bytes) msgQ->peak_bytes = msgQ->bytes;
+
+    /* wake publishers and subscribers blocked on the ring */
+    msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ALL);
+    msgQ->locknblock->signal(READY2RECV, Cond::NOTIFY_ALL);
+}
+
+/*----------------------------------------------------------------------------
+ * addWatcher
+ *----------------------------------------------------------------------------*/
+bool MsgQ::addWatcher(Cond* cond, int sig, watch_func_t func, void* parm)
+{
+    bool status = false;
+    msgQ->locknblock->lock();
+    {
+        if(msgQ->subscriptions > 0)
+        {
+            sub_watcher_t* watcher = new sub_watcher_t;
+            watcher->cond = cond;
+            watcher->sig = sig;
+            watcher->func = func;
+            watcher->parm = parm;
+            watcher->next = msgQ->sub_watchers;
+            msgQ->sub_watchers = watcher;
+            status = true;
+        }
+    }
+    msgQ->locknblock->unlock();
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * removeWatcher
+ *----------------------------------------------------------------------------*/
+void MsgQ::removeWatcher(Cond* cond, watch_func_t func, void* parm)
+{
+    msgQ->locknblock->lock();
+    {
+        sub_watcher_t** link = &msgQ->sub_watchers;
+        while(*link != NULL)
+        {
+            sub_watcher_t* watcher = *link;
+            if(watcher->cond == cond && watcher->func == func && watcher->parm == parm)
+            {
+                *link = watcher->next;
+                delete watcher;
+                break;
+            }
+            link = &watcher->next;
+        }
+    }
+    msgQ->locknblock->unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * spillReady
+ *
+ *  must be called with the queue locked; once anything is spilled every post
+ *  is spilled until the file has been read back so that order is kept
+ *----------------------------------------------------------------------------*/
+bool MsgQ::spillReady(void)
+{
+    if(msgQ->spill_count > 0) return true;
+    else if(msgQ->spill_path == NULL) return false;
+    else return (msgQ->subscriptions == 1) && isFull();
+}
+
+/*----------------------------------------------------------------------------
+ * spillReset
+ *
+ *  must be called with the queue locked; discards the contents of the spill
+ *  file so that it is reused from the start
+ *----------------------------------------------------------------------------*/
+void MsgQ::spillReset(void)
+{
+    if(msgQ->spill_fd >= 0 && msgQ->spill_write_pos > 0)
+    {
+        if(ftruncate(msgQ->spill_fd, 0) != 0)
+        {
+            dlog("Failed to truncate spill file of %s: %s", msgQ->name, strerror(errno));
+        }
+    }
+    msgQ->spill_write_pos = 0;
+    msgQ->spill_read_pos = 0;
+    msgQ->spill_count = 0;
+}
+
 /******************************************************************************
  * PUBLISHER METHODS
  ******************************************************************************/
@@ -420,7 +842,7 @@ int Publisher::postString(const char* format_string, ...)
 void Publisher::defaultFree(void* obj, void* parm)
 {
     (void)parm;
-    delete [] (char*)obj;
+    RecordPool::release(obj); // falls back to delete [] for non-pool memory
 }
 
 /*----------------------------------------------------------------------------
@@ -431,157 +853,478 @@ int Publisher::post(void* data, unsigned int mask, void* secondary_data, unsigne
     int     post_state  = STATE_OKAY;
     bool    copy        = (mask & MSGQ_COPYQ_MASK) != 0;
     int     data_size   = mask & ~MSGQ_COPYQ_MASK;
+    bool    retry       = true;
+    bool    spilled     = false;
 
-    /* post data */
-    msgQ->locknblock->lock();
+    while(retry)
     {
-        /* check ability to queue */
-        if(msgQ->max_data_size != CFG_SIZE_INFINITY &&
-           (data_size + secondary_size) > (unsigned int)msgQ->max_data_size)
-        {
-            /* size is too big */
-            post_state = STATE_SIZE_ERROR;
-        }
-        else if(msgQ->subscriptions <= 0)
+        /* single producer/single consumer fast path */
+        if(msgQ->spsc_active.load(std::memory_order_relaxed))
         {
-            /* don't post messages to a queue with no subscribers */
-            post_state = STATE_NO_SUBSCRIBERS;
+            post_state = spscPost(data, mask, secondary_data, secondary_size, timeout);
+            if(post_state != STATE_SPSC_INACTIVE) return post_state;
         }
-        else if(timeout != IO_CHECK)
+
+        /* post data */
+        post_state = STATE_OKAY;
+        retry = false;
+        msgQ->locknblock->lock();
         {
-            /* wait for room in queue */
-            while(isFull())
+            /* check ability to queue */
+            if(msgQ->spsc_active)
             {
-                if(!msgQ->locknblock->wait(READY2POST, timeout))
-                {
-                    post_state = MsgQ::STATE_TIMEOUT;
-                    break;
-                }
+                /* ring started - retry outside of lock */
+                retry = true;
             }
-        }
-        else if(isFull())
-        {
-            /* post check on full queue */
-            post_state = STATE_FULL;
-        }
-
-        /* if state is okay proceed with enqueue */
-        if(post_state == STATE_OKAY)
-        {
-            /* Allocate Memory for Node */
-            int memory_needed = sizeof(queue_node_t);
-            if(copy)
+            else if(msgQ->max_data_size != CFG_SIZE_INFINITY &&
+               (data_size + secondary_size) > (unsigned int)msgQ->max_data_size)
             {
-                memory_needed += data_size;
-                if(secondary_data)
-                {
-                    memory_needed += secondary_size;
-                }
+                /* size is too big */
+                post_state = STATE_SIZE_ERROR;
             }
-
-            /* create temp node */
-            queue_node_t* temp = (queue_node_t*) new char [memory_needed];
-
-            /* perform copy if queue is a copy queue */
-            if(copy)
+            else if(msgQ->subscriptions <= 0)
+            {
+                /* don't post messages to a queue with no subscribers */
+                post_state = STATE_NO_SUBSCRIBERS;
+            }
+            else if(spillReady() && spill(data, mask, secondary_data, secondary_size))
             {
-                temp->data = ((char*)temp) + sizeof(queue_node_t);
-                LocalLib::copy(temp->data, data, data_size);
-                if(secondary_data)
+                /* posted to spill file */
+                spilled = true;
+            }
+            else if(timeout != IO_CHECK)
+            {
+                /* wait for room in queue */
+                while(!msgQ->spsc_active && isFull())
                 {
-                    LocalLib::copy(temp->data + data_size, secondary_data, secondary_size);
+                    if(!msgQ->locknblock->wait(READY2POST, timeout))
+                    {
+                        post_state = MsgQ::STATE_TIMEOUT;
+                        break;
+                    }
                 }
+                retry = msgQ->spsc_active;
             }
-            else
+            else if(isFull())
             {
-                temp->data = (char*)data;
+                /* post check on full queue */
+                post_state = STATE_FULL;
             }
 
-            /* construct node to be added */
-            temp->mask = mask + secondary_size;
-            temp->next = NULL; // for queue
-            temp->refs = msgQ->subscriptions;
+            /* if state is okay proceed with enqueue */
+            if(retry)
+            {
+                /* enqueue through ring */
+            }
+            else if(spilled)
+            {
+                /* trigger ready */
+                msgQ->locknblock->signal(READY2RECV);
+            }
+            else if(post_state == STATE_OKAY)
+            {
+                /* create node to be added */
+                queue_node_t* temp = createNode(data, mask, secondary_data, secondary_size);
+                temp->refs = msgQ->subscriptions;
+                enqueue(temp);
 
-            /* place temp node into queue */
-            if(msgQ->back == NULL)  msgQ->front = temp;
-            else                    msgQ->back->next = temp;
-            msgQ->back = temp;
+                /* trigger ready */
+                msgQ->locknblock->signal(READY2RECV);
+            }
+            else if(post_state == STATE_NO_SUBSCRIBERS && copy)
+            {
+                /* The STATE_NO_SUBSCRIBERS error is only raised when passing by
+                 * reference because the publisher message queue object does not
+                 * own the ability to dereference the data being attempted
+                 * to be posted (that is a function of the subscriber); so the
+                 * poster must handle the deallocation on a failed post in this
+                 * case. No error is raised when posting by copy since the poster
+                 * has no responsibility in either case (success or failure). */
+                post_state = STATE_OKAY;
+            }
 
-            /* update subscribers */
-            for(int i = 0; i < msgQ->max_subscribers; i++)
+            if(!retry)
             {
-                /* modify current node if necessary */
-                if( (msgQ->subscriber_type[i] != UNSUBSCRIBED) &&
-                    (msgQ->curr_nodes[i] == NULL) )
+                /* set queue state */
+                msgQ->state = post_state;
+
+                /* if still room wake up other publishers */
+                if(!isFull())
                 {
-                    msgQ->curr_nodes[i] = temp;
+                    msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
                 }
             }
-
-            /* increment queue size */
-            msgQ->len++;
-
-            /* trigger ready */
-            msgQ->locknblock->signal(READY2RECV);
-        }
-        else if(post_state == STATE_NO_SUBSCRIBERS && copy)
-        {
-            /* The STATE_NO_SUBSCRIBERS error is only raised when passing by
-             * reference because the publisher message queue object does not
-             * own the ability to dereference the data being attempted
-             * to be posted (that is a function of the subscriber); so the
-             * poster must handle the deallocation on a failed post in this
-             * case. No error is raised when posting by copy since the poster
-             * has no responsibility in either case (success or failure). */
-            post_state = STATE_OKAY;
-        }
-
-        /* set queue state */
-        msgQ->state = post_state;
-
-        /* if still room wake up other publishers */
-        if(!isFull())
-        {
-            msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
         }
+        msgQ->locknblock->unlock();
     }
-    msgQ->locknblock->unlock();
 
     /* return */
     return post_state;
 }
 
-/******************************************************************************
- * SUBSCRIBER METHODS
- ******************************************************************************/
-
 /*----------------------------------------------------------------------------
- * Constructor
+ * postBatch
+ *
+ *  posts n messages by reference, taking the queue lock once for as many of
+ *  them as fit and waking subscribers once per group; returns the number of
+ *  messages posted, or the error state if none were - the caller still owns
+ *  any references past the returned count
  *----------------------------------------------------------------------------*/
-Subscriber::Subscriber(const char* name, subscriber_type_t type, int depth, int data_size): MsgQ(name, NULL, depth, data_size)
+int Publisher::postBatch(void** refs, int* sizes, int n, int timeout)
 {
-    init_subscriber(type);
+    return batch(refs, sizes, n, false, timeout);
 }
 
 /*----------------------------------------------------------------------------
- * Constructor
+ * postCopyBatch
  *----------------------------------------------------------------------------*/
-Subscriber::Subscriber(const MsgQ& existing_q, subscriber_type_t type): MsgQ(existing_q, NULL)
+int Publisher::postCopyBatch(const void** data, int* sizes, int n, int timeout)
 {
-    init_subscriber(type);
+    return batch((void**)data, sizes, n, true, timeout);
 }
 
 /*----------------------------------------------------------------------------
- * Destructor
+ * batch
  *----------------------------------------------------------------------------*/
-Subscriber::~Subscriber()
+int Publisher::batch(void** data, int* sizes, int n, bool copy, int timeout)
 {
-    bool space_reclaimed = false;
+    int posted = 0;
+    int post_state = STATE_OKAY;
 
-    msgQ->locknblock->lock();
+    while(post_state == STATE_OKAY && posted < n)
     {
-        /* Dereference All Nodes */
-        queue_node_t* node = msgQ->curr_nodes[id];
+        /* single producer/single consumer fast path */
+        if(msgQ->spsc_active.load(std::memory_order_relaxed))
+        {
+            unsigned int mask = copy ? (sizes[posted] | MSGQ_COPYQ_MASK) : sizes[posted];
+            post_state = spscPost(data[posted], mask, NULL, 0, timeout);
+            if(post_state == STATE_OKAY) posted++;
+            if(post_state != STATE_SPSC_INACTIVE) continue;
+            post_state = STATE_OKAY;
+        }
+
+        /* post data */
+        msgQ->locknblock->lock();
+        {
+            int enqueued = 0;
+            while(posted < n && !msgQ->spsc_active)
+            {
+                if(msgQ->max_data_size != CFG_SIZE_INFINITY && sizes[posted] > msgQ->max_data_size)
+                {
+                    /* size is too big */
+                    post_state = STATE_SIZE_ERROR;
+                    break;
+                }
+                else if(msgQ->subscriptions <= 0)
+                {
+                    /* don't post messages to a queue with no subscribers */
+                    post_state = STATE_NO_SUBSCRIBERS;
+                    break;
+                }
+                else if(spillReady() && spill(data[posted], copy ? (sizes[posted] | MSGQ_COPYQ_MASK) : sizes[posted], NULL, 0))
+                {
+                    /* posted to spill file */
+                    posted++;
+                    enqueued++;
+                }
+                else if(isFull())
+                {
+                    /* post check on full queue */
+                    if(timeout == IO_CHECK)
+                    {
+                        post_state = STATE_FULL;
+                        break;
+                    }
+
+                    /* let subscribers start on what has been queued so far */
+                    if(enqueued > 0)
+                    {
+                        msgQ->locknblock->signal(READY2RECV);
+                        enqueued = 0;
+                    }
+
+                    /* wait for room in queue */
+                    if(!msgQ->locknblock->wait(READY2POST, timeout))
+                    {
+                        post_state = MsgQ::STATE_TIMEOUT;
+                        break;
+                    }
+                }
+                else
+                {
+                    unsigned int mask = copy ? (sizes[posted] | MSGQ_COPYQ_MASK) : sizes[posted];
+                    queue_node_t* temp = createNode(data[posted], mask, NULL, 0);
+                    temp->refs = msgQ->subscriptions;
+                    enqueue(temp);
+                    posted++;
+                    enqueued++;
+                }
+            }
+
+            /* trigger ready */
+            if(enqueued > 0)
+            {
+                msgQ->locknblock->signal(READY2RECV);
+            }
+
+            /* posting copies with no subscribers is not an error (see post) */
+            if(post_state == STATE_NO_SUBSCRIBERS && copy)
+            {
+                post_state = STATE_OKAY;
+                posted = n;
+            }
+
+            /* set queue state */
+            msgQ->state = post_state;
+
+            /* if still room wake up other publishers */
+            if(!isFull())
+            {
+                msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
+            }
+        }
+        msgQ->locknblock->unlock();
+    }
+
+    /* return */
+    if(posted > 0)  return posted;
+    else            return post_state;
+}
+
+/*----------------------------------------------------------------------------
+ * enqueue
+ *
+ *  must be called with the queue locked
+ *----------------------------------------------------------------------------*/
+void MsgQ::enqueue(queue_node_t* node)
+{
+    /* place node into queue */
+    if(msgQ->back == NULL)  msgQ->front = node;
+    else                    msgQ->back->next = node;
+    msgQ->back = node;
+
+    /* update subscribers */
+    for(int i = 0; i < msgQ->max_subscribers; i++)
+    {
+        /* modify current node if necessary */
+        if( (msgQ->subscriber_type[i] != UNSUBSCRIBED) &&
+            (msgQ->curr_nodes[i] == NULL) )
+        {
+            msgQ->curr_nodes[i] = node;
+        }
+    }
+
+    /* increment queue size */
+    msgQ->len++;
+    msgQ->bytes += node->mask & ~MSGQ_COPYQ_MASK;
+    if(msgQ->bytes > msgQ->peak_bytes) msgQ->peak_bytes = msgQ->bytes;
+}
+
+/*----------------------------------------------------------------------------
+ * spill
+ *
+ *  must be called with the queue locked; appends the message to the spill
+ *  file, releasing it if posted by reference; returns false if it could not
+ *  be written, in which case the message is posted to the chain as usual
+ *----------------------------------------------------------------------------*/
+bool Publisher::spill(void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size)
+{
+    bool copy = (mask & MSGQ_COPYQ_MASK) != 0;
+    uint32_t data_size = mask & ~MSGQ_COPYQ_MASK;
+    uint32_t total_size = data_size + (secondary_data ? secondary_size : 0);
+
+    /* Open Spill File */
+    if(msgQ->spill_fd < 0)
+    {
+        if(msgQ->spill_path == NULL) return false;
+        msgQ->spill_fd = open(msgQ->spill_path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if(msgQ->spill_fd < 0)
+        {
+            dlog("Failed to open spill file %s: %s", msgQ->spill_path, strerror(errno));
+            delete [] msgQ->spill_path;
+            msgQ->spill_path = NULL;
+            return false;
+        }
+        unlink(msgQ->spill_path); // file lives until closed
+    }
+
+    /* Write Message */
+    struct iovec iov[3] = {
+        {(void*)&total_size, sizeof(total_size)},
+        {data, data_size},
+        {secondary_data, secondary_data ? secondary_size : 0}
+    };
+    ssize_t expected = sizeof(total_size) + total_size;
+    if(pwritev(msgQ->spill_fd, iov, 3, msgQ->spill_write_pos) != expected)
+    {
+        dlog("Failed to write %u bytes to spill file of %s: %s", total_size, msgQ->name, strerror(errno));
+        return false;
+    }
+    msgQ->spill_write_pos += expected;
+    msgQ->spill_count++;
+    msgQ->spill_bytes += total_size;
+
+    /* Release Message Posted by Reference */
+    if(!copy && msgQ->free_func)
+    {
+        (*msgQ->free_func)(data, NULL);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * spscPost
+ *
+ *  lock-free post into the ring; the lock is only taken to wake a subscriber
+ *  blocked on an empty ring or to block on a full ring; returns
+ *  STATE_SPSC_INACTIVE when the ring is stopped and the chain must be used
+ *----------------------------------------------------------------------------*/
+int Publisher::spscPost(void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size, int timeout)
+{
+    unsigned int data_size = mask & ~MSGQ_COPYQ_MASK;
+    if(msgQ->max_data_size != CFG_SIZE_INFINITY && (data_size + secondary_size) > (unsigned int)msgQ->max_data_size)
+    {
+        return STATE_SIZE_ERROR;
+    }
+
+    while(spscEnter(msgQ->spsc_post_busy))
+    {
+        if(!spscFull())
+        {
+            /* Place Node into Ring */
+            queue_node_t* node = createNode(data, mask, secondary_data, secondary_size);
+            node->refs = 1;
+            node->spsc = true;
+            uint64_t tail = msgQ->ring_tail.load(std::memory_order_relaxed);
+            msgQ->ring[tail & msgQ->ring_mask] = node;
+            msgQ->ring_tail = tail + 1;
+            msgQ->spsc_post_busy = false;
+
+            /* Wake Subscriber Blocked on Empty Ring */
+            if(msgQ->spsc_recv_waiting)
+            {
+                msgQ->locknblock->lock();
+                msgQ->locknblock->signal(READY2RECV);
+                msgQ->locknblock->unlock();
+            }
+
+            return STATE_OKAY;
+        }
+        msgQ->spsc_post_busy = false;
+
+        /* Post Check on Full Ring */
+        if(timeout == IO_CHECK)
+        {
+            return STATE_FULL;
+        }
+
+        /* Wait for Room in Ring */
+        bool timed_out = false;
+        msgQ->locknblock->lock();
+        {
+            msgQ->spsc_post_waiting = true;
+            while(msgQ->spsc_active && spscFull())
+            {
+                if(!msgQ->locknblock->wait(READY2POST, timeout))
+                {
+                    timed_out = true;
+                    break;
+                }
+            }
+            msgQ->spsc_post_waiting = false;
+        }
+        msgQ->locknblock->unlock();
+
+        if(timed_out)
+        {
+            return STATE_TIMEOUT;
+        }
+    }
+
+    return STATE_SPSC_INACTIVE;
+}
+
+/*----------------------------------------------------------------------------
+ * createNode
+ *----------------------------------------------------------------------------*/
+MsgQ::queue_node_t* Publisher::createNode(void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size)
+{
+    bool    copy        = (mask & MSGQ_COPYQ_MASK) != 0;
+    int     data_size   = mask & ~MSGQ_COPYQ_MASK;
+
+    /* Allocate Memory for Node */
+    int memory_needed = sizeof(queue_node_t);
+    if(copy)
+    {
+        memory_needed += data_size;
+        if(secondary_data)
+        {
+            memory_needed += secondary_size;
+        }
+    }
+
+    /* create temp node */
+    queue_node_t* temp = (queue_node_t*) new char [memory_needed];
+
+    /* perform copy if queue is a copy queue */
+    if(copy)
+    {
+        temp->data = ((char*)temp) + sizeof(queue_node_t);
+        LocalLib::copy(temp->data, data, data_size);
+        if(secondary_data)
+        {
+            LocalLib::copy(temp->data + data_size, secondary_data, secondary_size);
+        }
+    }
+    else
+    {
+        temp->data = (char*)data;
+    }
+
+    /* construct node to be added */
+    temp->mask = mask + secondary_size;
+    temp->next = NULL; // for queue
+    temp->refs = 0;
+    temp->spsc = false;
+
+    return temp;
+}
+
+/******************************************************************************
+ * SUBSCRIBER METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+Subscriber::Subscriber(const char* name, subscriber_type_t type, int depth, int data_size): MsgQ(name, NULL, depth, data_size)
+{
+    init_subscriber(type);
+}
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+Subscriber::Subscriber(const MsgQ& existing_q, subscriber_type_t type): MsgQ(existing_q, NULL)
+{
+    init_subscriber(type);
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+Subscriber::~Subscriber()
+{
+    bool space_reclaimed = false;
+
+    msgQ->locknblock->lock();
+    {
+        /* Revert to Node Chain */
+        spscStop();
+
+        /* Dereference All Nodes */
+        queue_node_t* node = msgQ->curr_nodes[id];
         while(node != NULL)
         {
             node->refs--;
@@ -614,11 +1357,32 @@ Subscriber::~Subscriber()
         msgQ->subscriber_type[id] = UNSUBSCRIBED;
         msgQ->subscriptions--;
 
+        /* Signal Watchers */
+        if(msgQ->subscriptions == 0)
+        {
+            for(sub_watcher_t* watcher = msgQ->sub_watchers; watcher != NULL; watcher = watcher->next)
+            {
+                if(watcher->cond)
+                {
+                    watcher->cond->lock();
+                    watcher->cond->signal(watcher->sig);
+                    watcher->cond->unlock();
+                }
+                if(watcher->func)
+                {
+                    watcher->func(watcher->parm);
+                }
+            }
+        }
+
         /* Signal Publishers */
         if(space_reclaimed)
         {
             msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
         }
+
+        /* Restart Ring for Remaining Subscriber */
+        spscStart();
     }
     msgQ->locknblock->unlock();
 }
@@ -632,6 +1396,13 @@ bool Subscriber::dereference(msgRef_t& ref, bool with_delete)
 
     queue_node_t* node = (queue_node_t*)ref._handle;
 
+    /* nodes received from the ring are owned by the subscriber */
+    if(node->spsc)
+    {
+        spscFree(node, with_delete);
+        return true;
+    }
+
     msgQ->locknblock->lock();
     {
         node->refs--;
@@ -641,12 +1412,98 @@ bool Subscriber::dereference(msgRef_t& ref, bool with_delete)
         {
             msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
         }
+
+        spscStart();
     }
     msgQ->locknblock->unlock();
 
     return true;
 }
 
+/*----------------------------------------------------------------------------
+ * dereferenceBatch
+ *
+ *  releases references returned by receiveBatch under a single lock
+ *----------------------------------------------------------------------------*/
+bool Subscriber::dereferenceBatch(msgRef_t* refs, int n, bool with_delete)
+{
+    bool chained = false;
+
+    /* nodes received from the ring are owned by the subscriber */
+    for(int i = 0; i < n; i++)
+    {
+        assert(refs[i]._handle);
+        queue_node_t* node = (queue_node_t*)refs[i]._handle;
+        if(node->spsc)  spscFree(node, with_delete);
+        else            chained = true;
+    }
+
+    if(chained)
+    {
+        msgQ->locknblock->lock();
+        {
+            for(int i = 0; i < n; i++)
+            {
+                queue_node_t* node = (queue_node_t*)refs[i]._handle;
+                if(!node->spsc) node->refs--;
+            }
+
+            bool space_reclaimed = reclaim_nodes(with_delete);
+
+            if(space_reclaimed)
+            {
+                msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
+            }
+
+            spscStart();
+        }
+        msgQ->locknblock->unlock();
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * detach
+ *
+ *  takes ownership of the data of a received message so that it can be
+ *  posted by reference to another queue; only possible for messages posted
+ *  by reference that no other subscriber still holds.  On success the caller
+ *  frees the data with the queue's free function (see getFreeFunc), and must
+ *  still dereference the message, which then leaves the data alone
+ *----------------------------------------------------------------------------*/
+bool Subscriber::detach(msgRef_t& ref)
+{
+    assert(ref._handle);
+
+    queue_node_t* node = (queue_node_t*)ref._handle;
+    bool detached = false;
+
+    if((node->mask & MSGQ_COPYQ_MASK) != 0 || !msgQ->free_func)
+    {
+        return false;
+    }
+
+    /* nodes received from the ring are owned by the subscriber */
+    if(node->spsc)
+    {
+        node->mask |= MSGQ_COPYQ_MASK;
+        return true;
+    }
+
+    msgQ->locknblock->lock();
+    {
+        if(node->refs == 1)
+        {
+            node->mask |= MSGQ_COPYQ_MASK; // node no longer frees data when reclaimed
+            detached = true;
+        }
+    }
+    msgQ->locknblock->unlock();
+
+    return detached;
+}
+
 /*----------------------------------------------------------------------------
  * drain
  *----------------------------------------------------------------------------*/
@@ -654,6 +1511,9 @@ void Subscriber::drain(bool with_delete)
 {
     msgQ->locknblock->lock();
     {
+        /* Move Ring onto Node Chain */
+        spscStop();
+
         /* Dereference All Nodes */
         queue_node_t* node = msgQ->curr_nodes[id];
         while(node != NULL)
@@ -663,11 +1523,14 @@ void Subscriber::drain(bool with_delete)
         }
         bool space_reclaimed = reclaim_nodes(with_delete);
         msgQ->curr_nodes[id] = NULL;
+        spillReset();
 
         if(space_reclaimed)
         {
             msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
         }
+
+        spscStart();
     }
     msgQ->locknblock->unlock();
 }
@@ -677,7 +1540,8 @@ void Subscriber::drain(bool with_delete)
  *----------------------------------------------------------------------------*/
 bool Subscriber::isEmpty(void)
 {
-    if(msgQ->curr_nodes[id] == NULL)    return true;
+    if(msgQ->spsc_active)               return spscEmpty();
+    else if(msgQ->curr_nodes[id] == NULL) return true;
     else                                return false;
 }
 
@@ -727,6 +1591,110 @@ int Subscriber::receiveCopy(void* data, int size, int timeout)
     else                        return status;
 }
 
+/*----------------------------------------------------------------------------
+ * receiveBatch
+ *
+ *  Notes
+ *  1. waits up to the timeout for the first message and then returns by
+ *     reference every message already queued, up to max, under one lock
+ *  2. returns the number of references filled in, or the error state if
+ *     none were; each reference must be released with dereference or
+ *     dereferenceBatch
+ *----------------------------------------------------------------------------*/
+int Subscriber::receiveBatch(msgRef_t* refs, int max, int timeout)
+{
+    int received = 0;
+    int state = STATE_OKAY;
+    bool retry = true;
+
+    if(max <= 0) return 0;
+
+    while(retry)
+    {
+        /* single producer/single consumer fast path */
+        if(msgQ->spsc_active.load(std::memory_order_relaxed))
+        {
+            refs[0].state = STATE_OKAY;
+            refs[0]._handle = 0;
+            state = spscReceive(refs[0], CFG_SIZE_INFINITY, timeout, false);
+            if(state == STATE_OKAY)
+            {
+                for(received = 1; received < max; received++)
+                {
+                    refs[received].state = STATE_OKAY;
+                    refs[received]._handle = 0;
+                    if(spscReceive(refs[received], CFG_SIZE_INFINITY, IO_CHECK, false) != STATE_OKAY)
+                    {
+                        break;
+                    }
+                }
+                return received;
+            }
+            else if(state != STATE_SPSC_INACTIVE)
+            {
+                return state;
+            }
+        }
+
+        /* receive data */
+        state = STATE_OKAY;
+        retry = false;
+        msgQ->locknblock->lock();
+        {
+            /* check state of queue */
+            if(msgQ->spsc_active)
+            {
+                /* ring started - retry outside of lock */
+                retry = true;
+            }
+            else if(timeout != IO_CHECK)
+            {
+                /* wait for message to be posted */
+                while(!msgQ->spsc_active && isEmpty() && !unspill())
+                {
+                    if(!msgQ->locknblock->wait(READY2RECV, timeout))
+                    {
+                        state = MsgQ::STATE_TIMEOUT;
+                        break;
+                    }
+                }
+                retry = msgQ->spsc_active;
+            }
+            else if(isEmpty() && !unspill())
+            {
+                /* receive check on empty queue */
+                state = STATE_EMPTY;
+            }
+
+            /* dequeue data */
+            if(!retry && state == STATE_OKAY)
+            {
+                while(received < max && msgQ->curr_nodes[id] != NULL)
+                {
+                    queue_node_t* node = msgQ->curr_nodes[id];
+                    msgQ->curr_nodes[id] = node->next;
+                    refs[received].data = node->data;
+                    refs[received].size = node->mask & ~MSGQ_COPYQ_MASK;
+                    refs[received].state = STATE_OKAY;
+                    refs[received]._handle = (void*)node;
+                    received++;
+                }
+            }
+
+            /* set queue state */
+            if(!retry)
+            {
+                msgQ->state = state;
+            }
+        }
+        msgQ->locknblock->unlock();
+    }
+
+    /* return status */
+    if(received > 0)    return received;
+    else                return state;
+}
+
 /*----------------------------------------------------------------------------
  * receive
  *
@@ -737,43 +1705,140 @@ int Subscriber::receiveCopy(void* data, int size, int timeout)
 int Subscriber::receive(msgRef_t& ref, int size, int timeout, bool copy)
 {
     bool space_reclaimed = false;
+    bool retry = true;
 
-    /* initialize reference structure */
-    ref.state = STATE_OKAY;
-    ref.size = size;
-    ref._handle = 0;
-
-    /* receive data */
-    msgQ->locknblock->lock();
+    while(retry)
     {
-        /* check state of queue */
-        if(timeout != IO_CHECK)
+        /* initialize reference structure */
+        ref.state = STATE_OKAY;
+        ref.size = size;
+        ref._handle = 0;
+
+        /* single producer/single consumer fast path */
+        if(msgQ->spsc_active.load(std::memory_order_relaxed))
         {
-            /* wait for message to be posted */
-            while(isEmpty())
+            int state = spscReceive(ref, size, timeout, copy);
+            if(state != STATE_SPSC_INACTIVE) return state;
+            ref.state = STATE_OKAY;
+            ref.size = size;
+        }
+
+        /* receive data */
+        retry = false;
+        msgQ->locknblock->lock();
+        {
+            /* check state of queue */
+            if(msgQ->spsc_active)
             {
-                if(!msgQ->locknblock->wait(READY2RECV, timeout))
+                /* ring started - retry outside of lock */
+                retry = true;
+            }
+            else if(timeout != IO_CHECK)
+            {
+                /* wait for message to be posted */
+                while(!msgQ->spsc_active && isEmpty() && !unspill())
                 {
-                    ref.state = MsgQ::STATE_TIMEOUT;
-                    break;
+                    if(!msgQ->locknblock->wait(READY2RECV, timeout))
+                    {
+                        ref.state = MsgQ::STATE_TIMEOUT;
+                        break;
+                    }
                 }
+                retry = msgQ->spsc_active;
+            }
+            else if(isEmpty() && !unspill())
+            {
+                /* receive check on empty queue */
+                ref.state = STATE_EMPTY;
+            }
+
+            /* dequeue data */
+            if(retry)
+            {
+                /* dequeue through ring */
+            }
+            else if(ref.state == STATE_OKAY)
+            {
+                /* update queue status*/
+                queue_node_t* node = msgQ->curr_nodes[id];
+                msgQ->curr_nodes[id] = node->next;
+                int node_size = node->mask & ~MSGQ_COPYQ_MASK;
+
+                /* perform dequeue */
+                if(copy == false)
+                {
+                    ref.data = node->data;
+                    ref.size = node_size;
+                    ref._handle = (void*)node;
+                }
+                else
+                {
+                    if(node_size <= size)
+                    {
+                        LocalLib::copy(ref.data, node->data, node_size);
+                    }
+                    else
+                    {
+                        ref.state = STATE_SIZE_ERROR;
+                    }
+
+                    ref.size = node_size;
+                    node->refs--;
+                    space_reclaimed = reclaim_nodes(true);
+                }
+            }
+
+            if(!retry)
+            {
+                /* set queue state */
+                msgQ->state = ref.state;
+
+                /* signal publishers */
+                if(space_reclaimed)
+                {
+                    msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
+                }
+
+                /* switch to ring once chain has drained */
+                spscStart();
             }
         }
-        else if(isEmpty())
-        {
-            /* receive check on empty queue */
-            ref.state = STATE_EMPTY;
-        }
+        msgQ->locknblock->unlock();
+    }
 
-        /* dequeue data */
-        if(ref.state == STATE_OKAY)
+    /* return status */
+    return ref.state;
+}
+
+/*----------------------------------------------------------------------------
+ * spscReceive
+ *
+ *  lock-free receive from the ring; the lock is only taken to wake a
+ *  publisher blocked on a full ring or to block on an empty ring; returns
+ *  STATE_SPSC_INACTIVE when the ring is stopped and the chain must be used
+ *----------------------------------------------------------------------------*/
+int Subscriber::spscReceive(msgRef_t& ref, int size, int timeout, bool copy)
+{
+    while(spscEnter(msgQ->spsc_recv_busy))
+    {
+        uint64_t head = msgQ->ring_head.load(std::memory_order_relaxed);
+        if(head != msgQ->ring_tail)
         {
-            /* update queue status*/
-            queue_node_t* node = msgQ->curr_nodes[id];
-            msgQ->curr_nodes[id] = node->next;
-            int node_size = node->mask & ~MSGQ_COPYQ_MASK;
+            /* Remove Node from Ring */
+            queue_node_t* node = msgQ->ring[head & msgQ->ring_mask];
+            msgQ->ring_head = head + 1;
+            msgQ->spsc_recv_busy = false;
 
-            /* perform dequeue */
+            /* Wake Publisher Blocked on Full Ring */
+            if(msgQ->spsc_post_waiting)
+            {
+                msgQ->locknblock->lock();
+                msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
+                msgQ->locknblock->unlock();
+            }
+
+            /* Perform Dequeue */
+            int node_size = node->mask & ~MSGQ_COPYQ_MASK;
             if(copy == false)
             {
                 ref.data = node->data;
@@ -792,24 +1857,108 @@ int Subscriber::receive(msgRef_t& ref, int size, int timeout, bool copy)
                 }
 
                 ref.size = node_size;
-                node->refs--;
-                space_reclaimed = reclaim_nodes(true);
+                spscFree(node, true);
             }
+
+            return ref.state;
         }
+        msgQ->spsc_recv_busy = false;
 
-        /* set queue state */
-        msgQ->state = ref.state;
+        /* Receive Check on Empty Ring */
+        if(timeout == IO_CHECK)
+        {
+            ref.state = STATE_EMPTY;
+            return ref.state;
+        }
 
-        /* signal publishers */
-        if(space_reclaimed)
+        /* Wait for Message in Ring */
+        bool timed_out = false;
+        msgQ->locknblock->lock();
         {
-            msgQ->locknblock->signal(READY2POST, Cond::NOTIFY_ONE);
+            msgQ->spsc_recv_waiting = true;
+            while(msgQ->spsc_active && spscEmpty())
+            {
+                if(!msgQ->locknblock->wait(READY2RECV, timeout))
+                {
+                    timed_out = true;
+                    break;
+                }
+            }
+            msgQ->spsc_recv_waiting = false;
+        }
+        msgQ->locknblock->unlock();
+
+        if(timed_out)
+        {
+            ref.state = STATE_TIMEOUT;
+            return ref.state;
         }
     }
-    msgQ->locknblock->unlock();
 
-    /* return status */
-    return ref.state;
+    return STATE_SPSC_INACTIVE;
+}
+
+/*----------------------------------------------------------------------------
+ * spscFree
+ *----------------------------------------------------------------------------*/
+void Subscriber::spscFree(queue_node_t* node, bool delete_data)
+{
+    if((node->mask & MSGQ_COPYQ_MASK) == 0)
+    {
+        if(msgQ->free_func && delete_data)  (*msgQ->free_func)(node->data, NULL);
+        else                                assert(msgQ->free_func);
+    }
+    delete [] (char*)node;
+}
+
+/*----------------------------------------------------------------------------
+ * unspill
+ *
+ *  must be called with the queue locked and the subscriber caught up; moves
+ *  spilled messages back onto the chain, at least one and then as many as
+ *  fit under the queue's limits; returns true if any were moved
+ *----------------------------------------------------------------------------*/
+bool Subscriber::unspill(void)
+{
+    bool moved = false;
+
+    while(msgQ->spill_count > 0 && (!moved || !isFull()))
+    {
+        /* Read Message */
+        uint32_t size = 0;
+        queue_node_t* node = NULL;
+        bool valid = pread(msgQ->spill_fd, &size, sizeof(size), msgQ->spill_read_pos) == sizeof(size);
+        if(valid)
+        {
+            node = (queue_node_t*) new char [sizeof(queue_node_t) + size];
+            node->data = ((char*)node) + sizeof(queue_node_t);
+            valid = pread(msgQ->spill_fd, node->data, size, msgQ->spill_read_pos + sizeof(size)) == (ssize_t)size;
+        }
+
+        if(!valid)
+        {
+            dlog("Failed to read spill file of %s, dropping %d messages: %s", msgQ->name, msgQ->spill_count, strerror(errno));
+            if(node) delete [] (char*)node;
+            spillReset();
+            break;
+        }
+
+        /* Place Message on Chain */
+        node->mask = size | MSGQ_COPYQ_MASK;
+        node->next = NULL;
+        node->refs = msgQ->subscriptions;
+        node->spsc = false;
+        enqueue(node);
+        moved = true;
+
+        msgQ->spill_read_pos += sizeof(size) + size;
+        if(--msgQ->spill_count == 0)
+        {
+            spillReset();
+        }
+    }
+
+    return moved;
 }
 
 /*----------------------------------------------------------------------------
@@ -861,6 +2010,7 @@ bool Subscriber::reclaim_nodes(bool delete_data)
         else                            msgQ->front = msgQ->front->next;
 
         /* deallocate memory block and free data */
+        msgQ->bytes -= node->mask & ~MSGQ_COPYQ_MASK;
         msgQ->free_block_stack[msgQ->free_blocks++] = (char*)node;
         if(msgQ->free_blocks == MAX_FREE_STACK_SIZE)
         {
@@ -892,6 +2042,9 @@ void Subscriber::init_subscriber(subscriber_type_t type)
 {
     msgQ->locknblock->lock();
     {
+        /* Revert to Node Chain */
+        spscStop();
+
         /* Check Need to Resize */
         int old_max_subscribers = msgQ->max_subscribers;
         if(msgQ->subscriptions >= msgQ->max_subscribers)
@@ -945,6 +2098,8 @@ void Subscriber::init_subscriber(subscriber_type_t type)
                 break;
             }
         }
+
+        spscStart();
     }
     msgQ->locknblock->unlock();
 }
@@ -39,6 +39,8 @@
 #include "OsApi.h"
 #include "Dictionary.h"
 
+#include <atomic>
+
 /******************************************************************************
  * DEFINES
  ******************************************************************************/
@@ -74,6 +76,7 @@ class MsgQ
         } queueDisplay_t;
 
         typedef void (*free_func_t) (void* obj, void* parm);
+        typedef void (*watch_func_t) (void* parm);
 
         /*--------------------------------------------------------------------
          * Constants
@@ -100,16 +103,27 @@ class MsgQ
 
                 int     getCount        (void);
                 int     getDepth        (void);
+                int64_t getPeakBytes    (void); // most data held on the chain at once
+                void    setMaxBytes     (int64_t max_bytes);
+                bool    setSpill        (const char* path);
+                int64_t getSpillBytes   (void); // data written to the spill file
          const  char*   getName         (void);
                 int     getSubCnt       (void);
+                free_func_t getFreeFunc (void);
+                bool    watchSubs       (Cond* cond, int sig); // signal when the last subscriber leaves
+                bool    watchSubs       (watch_func_t func, void* parm); // call when the last subscriber leaves
+                void    unwatchSubs     (Cond* cond);
+                void    unwatchSubs     (watch_func_t func, void* parm);
                 int     getState        (void);
                 bool    isFull          (void);
+                bool    declareSPSC     (void);
 
         static  void    init            (void);
         static  void    deinit          (void);
         static  bool    existQ          (const char* qname);
         static  int     numQ            (void); // number of registered queues
         static  int     listQ           (queueDisplay_t* list, int list_size);
+        static  int64_t totalBytes      (void); // data held on all queues
         static  bool    setStdQDepth    (int depth);
 
     protected:
@@ -120,6 +134,7 @@ class MsgQ
 
         static const int MSGQ_DEFAULT_SUBSCRIBERS = 2;
         static const unsigned int MSGQ_COPYQ_MASK = 1 << ((sizeof(unsigned int) * 8) - 1);
+        static const int STATE_SPSC_INACTIVE = -100; // internal: fast path not available, use node chain
 
         /*--------------------------------------------------------------------
          * Types
@@ -138,8 +153,18 @@ class MsgQ
             struct queue_node_s*    next;                               // used for FIFO message queue
             unsigned int            mask;                               // msb is type, rest is size
             int                     refs;                               // reference count used for dynamic deallocation
+            bool                    spsc;                               // delivered through ring, freed directly by subscriber
         } queue_node_t;
 
+        /* sub_watcher_t */
+        typedef struct sub_watcher {
+            Cond*                   cond;                               // signalled on sig, unless NULL
+            int                     sig;
+            watch_func_t            func;                               // called with parm, unless NULL
+            void*                   parm;
+            struct sub_watcher*     next;
+        } sub_watcher_t;
+
         /* message_queue_t */
         typedef struct {
             queue_node_t*           front;                              // queue out
@@ -147,6 +172,9 @@ class MsgQ
             const char*             name;                               // name of the message queue
             int                     depth;                              // maximum number of items queue can hold
             int                     len;                                // current number of items queue is holding
+            int64_t                 bytes;                              // current number of data bytes held by the chain
+            int64_t                 peak_bytes;                         // high water mark of bytes
+            int64_t                 max_bytes;                          // bytes the chain can hold before posts wait, 0 is no limit
             int                     max_data_size;                      // maximum size of an item that is allowed to be queued
             int                     soo_count;                          // the number of subscriber of opportunities subscribed to this queue
             free_func_t             free_func;                          // call-back to delete data when nodes reclaimed
@@ -159,8 +187,40 @@ class MsgQ
             queue_node_t**          curr_nodes;                         // [max_subscribers] used for subscriptions
             char**                  free_block_stack;                   // [free_stack_size] optimization of memory usage: deallocate in groups
             int                     free_blocks;                        // current number of blocks of free_block_stack
+            bool                    spsc_declared;                      // user guarantees a single posting and a single receiving thread
+            std::atomic<bool>       spsc_active;                        // nodes are passed through the ring instead of the chain
+            std::atomic<bool>       spsc_post_busy;                     // publisher is inside the lock-free fast path
+            std::atomic<bool>       spsc_recv_busy;                     // subscriber is inside the lock-free fast path
+            std::atomic<bool>       spsc_post_waiting;                  // publisher is blocked on a full ring
+            std::atomic<bool>       spsc_recv_waiting;                  // subscriber is blocked on an empty ring
+            std::atomic<uint64_t>   ring_head;                          // next ring slot to receive (written by subscriber)
+            std::atomic<uint64_t>   ring_tail;                          // next ring slot to post (written by publisher)
+            queue_node_t**          ring;                               // [ring_mask + 1] single producer/single consumer ring
+            uint64_t                ring_mask;
+            const char*             spill_path;                         // file posts go to while the queue is full, NULL is no spilling
+            int                     spill_fd;                           // open spill file, -1 until first spill
+            int64_t                 spill_write_pos;                    // end of spilled messages in file
+            int64_t                 spill_read_pos;                     // next spilled message to read back
+            int                     spill_count;                        // spilled messages not yet read back
+            int64_t                 spill_bytes;                        // total data bytes spilled
+            sub_watcher_t*          sub_watchers;                       // conditions signalled when subscriptions drop to zero
         } message_queue_t;
 
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                bool    spscEnter       (std::atomic<bool>& busy);
+                bool    spscFull        (void);
+                bool    spscEmpty       (void);
+                void    spscStart       (void);
+                void    spscStop        (void);
+                bool    spillReady      (void);
+                bool    addWatcher      (Cond* cond, int sig, watch_func_t func, void* parm);
+                void    removeWatcher   (Cond* cond, watch_func_t func, void* parm);
+                void    spillReset      (void);
+                void    enqueue         (queue_node_t* node);
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -191,12 +251,18 @@ class Publisher: public MsgQ
         int     postCopy        (const void* data, int size, int timeout=IO_CHECK);
         int     postCopy        (const void* data, int size, const void* secondary_data, int secondary_size, int timeout=IO_CHECK);
         int     postString      (const char* format_string, ...) VARG_CHECK(printf, 2, 3); // "this" is 1
+        int     postBatch       (void** refs, int* sizes, int n, int timeout=IO_CHECK);
+        int     postCopyBatch   (const void** data, int* sizes, int n, int timeout=IO_CHECK);
 
         static void defaultFree (void* obj, void* parm);
 
     private:
 
         int     post            (void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size, int timeout);
+        int     spscPost        (void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size, int timeout);
+        int     batch           (void** data, int* sizes, int n, bool copy, int timeout);
+        bool    spill           (void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size);
+        static queue_node_t* createNode (void* data, unsigned int mask, void* secondary_data, unsigned int secondary_size);
 
 };
 
@@ -220,19 +286,25 @@ class Subscriber: public MsgQ
                 ~Subscriber     (void);
 
         bool    dereference     (msgRef_t& ref, bool with_delete=true);
+        bool    dereferenceBatch(msgRef_t* refs, int n, bool with_delete=true);
+        bool    detach          (msgRef_t& ref);
         void    drain           (bool with_delete=true);
         bool    isEmpty         (void);
         void*   getData         (void* _handle, int* size=NULL);
 
         int     receiveRef      (msgRef_t& ref, int timeout);
         int     receiveCopy     (void* data, int size, int timeout);
+        int     receiveBatch    (msgRef_t* refs, int max, int timeout);
 
     private:
 
         int id;                 // index into current node table
 
         int     receive         (msgRef_t& ref, int size, int timeout, bool copy=false);
+        int     spscReceive     (msgRef_t& ref, int size, int timeout, bool copy);
+        void    spscFree        (queue_node_t* node, bool delete_data);
         bool    reclaim_nodes   (bool delete_data);
+        bool    unspill         (void);
         void    init_subscriber (subscriber_type_t type);
 };
 
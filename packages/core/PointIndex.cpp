@@ -33,6 +33,8 @@
  * INCLUDES
  ******************************************************************************/
 
+#include <cmath>
+
 #include "OsApi.h"
 #include "AssetIndex.h"
 #include "Asset.h"
@@ -47,7 +49,10 @@ const char* PointIndex::LuaMetaName = "PointIndex";
 const struct luaL_Reg PointIndex::LuaMetaTable[] = {
     {"add",         luaAdd},
     {"query",       luaQuery},
+    {"querybatch",  luaQueryBatch},
     {"display",     luaDisplay},
+    {"save",        luaSave},
+    {"load",        luaLoad},
     {NULL,          NULL}
 };
 
@@ -56,7 +61,7 @@ const struct luaL_Reg PointIndex::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<asset>, <fieldname>, [<threshold>])
+ * luaCreate - create(<asset>, <fieldname>, [<threshold>], [<packed>])
  *----------------------------------------------------------------------------*/
 int PointIndex::luaCreate (lua_State* L)
 {
@@ -66,9 +71,10 @@ int PointIndex::luaCreate (lua_State* L)
         Asset*      _asset      = (Asset*)getLuaObject(L, 1, Asset::OBJECT_TYPE);
         const char* _fieldname  = getLuaString(L, 2);
         int         _threshold  = getLuaInteger(L, 3, true, DEFAULT_THRESHOLD);
+        bool        _packed     = getLuaBoolean(L, 4, true, false);
 
         /* Return AssetIndex Object */
-        return createLuaObject(L, new PointIndex(L, _asset, _fieldname, _threshold));
+        return createLuaObject(L, new PointIndex(L, _asset, _fieldname, _threshold, _packed));
     }
     catch(const RunTimeException& e)
     {
@@ -80,8 +86,8 @@ int PointIndex::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-PointIndex::PointIndex(lua_State* L, Asset* _asset, const char* _fieldname, int _threshold):
-    AssetIndex<pointspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold)
+PointIndex::PointIndex(lua_State* L, Asset* _asset, const char* _fieldname, int _threshold, bool _packed):
+    AssetIndex<pointspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold, _packed)
 {
     assert(_fieldname);
 
@@ -153,28 +159,27 @@ pointspan_t PointIndex::combine (const pointspan_t& span1, const pointspan_t& sp
     return span;
 }
 
+/*----------------------------------------------------------------------------
+ * spanattrs
+ *----------------------------------------------------------------------------*/
+int PointIndex::spanattrs (const char* names[MAX_SPAN_ATTRS])
+{
+    names[0] = fieldname;
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * attr2span
  *----------------------------------------------------------------------------*/
-pointspan_t PointIndex::attr2span (Dictionary<double>* attr, bool* provided)
+pointspan_t PointIndex::attr2span (const double* values, bool* provided)
 {
     pointspan_t span;
-    bool status = false;
-    
-    try 
-    {
-        span.maxval = (*attr)[fieldname];
-        span.minval = span.maxval;
-        status = true;
-    }
-    catch(RunTimeException& e)
-    {
-        mlog(e.level(), "Failed to index asset: %s", e.what());
-    }
+    span.maxval = values[0];
+    span.minval = span.maxval;
 
     if(provided)
     {
-        *provided = status;
+        *provided = !std::isnan(values[0]);
     }
 
     return span;
@@ -222,3 +227,12 @@ void PointIndex::displayspan (const pointspan_t& span)
 {
     print2term("[%.3lf, %.3lf]", span.minval, span.maxval);
 }
+
+/*----------------------------------------------------------------------------
+ * sortkey
+ *----------------------------------------------------------------------------*/
+double PointIndex::sortkey (const pointspan_t& span, int dim)
+{
+    (void)dim;
+    return (span.minval + span.maxval) / 2.0;
+}
@@ -58,7 +58,7 @@ class PointIndex: public AssetIndex<pointspan_t>
          * Methods
          *--------------------------------------------------------------------*/
 
-                        PointIndex      (lua_State* L, Asset* _asset, const char* _fieldname, int _threshold);
+                        PointIndex      (lua_State* L, Asset* _asset, const char* _fieldname, int _threshold, bool _packed);
                         ~PointIndex     (void);
 
         static int      luaCreate       (lua_State* L);
@@ -68,9 +68,11 @@ class PointIndex: public AssetIndex<pointspan_t>
         bool            isright         (node_t* node, const pointspan_t& span) override;
         bool            intersect       (const pointspan_t& span1, const pointspan_t& span2) override;
         pointspan_t     combine         (const pointspan_t& span1, const pointspan_t& span2) override;
-        pointspan_t     attr2span       (Dictionary<double>* attr, bool* provided=NULL) override;
+        int             spanattrs       (const char* names[MAX_SPAN_ATTRS]) override;
+        pointspan_t     attr2span       (const double* values, bool* provided=NULL) override;
         pointspan_t     luatable2span   (lua_State* L, int parm) override;
         void            displayspan     (const pointspan_t& span) override;
+        double          sortkey         (const pointspan_t& span, int dim) override;
 
     private:
 
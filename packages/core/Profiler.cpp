@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "Profiler.h"
+#include "OsApi.h"
+#include "Dictionary.h"
+#include "StringLib.h"
+#include "EventLib.h"
+
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+std::atomic<bool>       Profiler::active(false);
+std::atomic<bool>       Profiler::sampling(false);
+std::atomic<int>        Profiler::inHandler(0);
+std::atomic<long>       Profiler::sampleIndex(0);
+Profiler::sample_t*     Profiler::samples = NULL;
+long                    Profiler::maxSamples = 0;
+bool                    Profiler::installed = false;
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void Profiler::init (void)
+{
+    /* The first call to backtrace loads the unwinder, which is not safe
+     * to do from inside a signal handler, so it is done here */
+    void* frames[1];
+    backtrace(frames, 1);
+}
+
+/*----------------------------------------------------------------------------
+ * profile
+ *
+ *  samples the process for the duration and returns the stacks seen in
+ *  folded format: one line per unique stack with frames from the root to
+ *  the leaf separated by semicolons, followed by a space and the number of
+ *  samples; returns NULL if a profile is already being taken.  The caller
+ *  owns the returned string.
+ *----------------------------------------------------------------------------*/
+const char* Profiler::profile (double duration, int frequency, long* num_samples, long* num_dropped)
+{
+    /* Only One Profile at a Time */
+    if(active.exchange(true)) return NULL;
+
+    /* Bound Request */
+    if(duration <= 0.0 || duration > MAX_DURATION) duration = MAX_DURATION;
+    if(frequency <= 0 || frequency > MAX_FREQUENCY) frequency = DEFAULT_FREQUENCY;
+
+    /* Allocate Sample Buffer */
+    maxSamples = (long)(duration * frequency * LocalLib::nproc());
+    if(maxSamples > MAX_SAMPLES) maxSamples = MAX_SAMPLES;
+    samples = new sample_t [maxSamples];
+    sampleIndex = 0;
+
+    /* Install Handler (left installed since a late SIGPROF would otherwise terminate the process) */
+    if(!installed)
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = handler;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if(sigaction(SIGPROF, &sa, NULL) != 0)
+        {
+            mlog(CRITICAL, "Failed to install profiling signal handler: %s", LocalLib::err2str(errno));
+            delete [] samples;
+            samples = NULL;
+            active = false;
+            return NULL;
+        }
+        installed = true;
+    }
+
+    /* Start Timer */
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / frequency;
+    timer.it_value = timer.it_interval;
+    sampling = true;
+    if(setitimer(ITIMER_PROF, &timer, NULL) != 0)
+    {
+        mlog(CRITICAL, "Failed to start profiling timer: %s", LocalLib::err2str(errno));
+        sampling = false;
+        delete [] samples;
+        samples = NULL;
+        active = false;
+        return NULL;
+    }
+
+    /* Profile */
+    LocalLib::sleep(duration);
+
+    /* Stop Timer and Wait for Handlers in Flight */
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sampling = false;
+    while(inHandler > 0) LocalLib::sleep(0.001);
+
+    /* Fold Stacks */
+    long total = sampleIndex;
+    long recorded = total < maxSamples ? total : maxSamples;
+    Dictionary<long> stacks;
+    MgDictionary<const char*, true> symbols;
+    for(long i = 0; i < recorded; i++)
+    {
+        SafeString stack(MAX_STR_SIZE);
+        for(int j = samples[i].depth - 1; j >= SKIP_FRAMES; j--)
+        {
+            char addr_key[32];
+            snprintf(addr_key, sizeof(addr_key), "%p", samples[i].frames[j]);
+            const char* symbol = NULL;
+            if(!symbols.find(addr_key, &symbol))
+            {
+                symbol = symbolize(samples[i].frames[j]);
+                symbols.add(addr_key, symbol);
+            }
+            if(j != samples[i].depth - 1) stack += ";";
+            stack += symbol;
+        }
+        const char* key = stack.getString();
+        if(key[0] == '\0') continue;
+        if(stacks.find(key))
+        {
+            stacks[key]++;
+        }
+        else
+        {
+            long count = 1;
+            stacks.add(key, count);
+        }
+    }
+
+    /* Build Output */
+    SafeString folded(MAX_STR_SIZE);
+    long count = 0;
+    const char* key = stacks.first(&count);
+    while(key != NULL)
+    {
+        SafeString line("%s %ld\n", key, count);
+        folded += line;
+        key = stacks.next(&count);
+    }
+
+    /* Clean Up */
+    delete [] samples;
+    samples = NULL;
+    if(num_samples) *num_samples = recorded;
+    if(num_dropped) *num_dropped = total - recorded;
+    active = false;
+
+    return folded.getString(true);
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * handler
+ *
+ *  runs in signal context on the thread that was interrupted; only claims a
+ *  slot and unwinds into it
+ *----------------------------------------------------------------------------*/
+void Profiler::handler (int sig, siginfo_t* info, void* context)
+{
+    (void)sig;
+    (void)info;
+    (void)context;
+
+    int saved_errno = errno;
+    inHandler++;
+    if(sampling)
+    {
+        long i = sampleIndex++;
+        if(i < maxSamples)
+        {
+            samples[i].depth = backtrace(samples[i].frames, MAX_STACK_DEPTH);
+        }
+    }
+    inHandler--;
+    errno = saved_errno;
+}
+
+/*----------------------------------------------------------------------------
+ * symbolize
+ *
+ *  returns the demangled function name without its parameters, or the
+ *  module and offset when the symbol is not exported
+ *----------------------------------------------------------------------------*/
+const char* Profiler::symbolize (void* addr)
+{
+    Dl_info info;
+    if(dladdr(addr, &info) && info.dli_sname)
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        const char* name = (status == 0 && demangled) ? demangled : info.dli_sname;
+        char* symbol = StringLib::duplicate(name);
+        if(demangled) free(demangled);
+
+        /* Strip Parameters (the last balanced parenthesis group) */
+        char* close = strrchr(symbol, ')');
+        if(close)
+        {
+            int depth = 0;
+            for(char* c = close; c > symbol; c--)
+            {
+                if(*c == ')') depth++;
+                else if(*c == '(' && --depth == 0)
+                {
+                    *c = '\0';
+                    break;
+                }
+            }
+        }
+
+        /* Semicolons and Spaces Delimit the Folded Format */
+        for(char* c = symbol; *c; c++)
+        {
+            if(*c == ';' || *c == ' ') *c = '_';
+        }
+        return symbol;
+    }
+    else if(info.dli_fname)
+    {
+        const char* module = strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+        SafeString symbol("%s+0x%lx", module, (unsigned long)((uint8_t*)addr - (uint8_t*)info.dli_fbase));
+        return symbol.getString(true);
+    }
+    else
+    {
+        SafeString symbol("0x%lx", (unsigned long)addr);
+        return symbol.getString(true);
+    }
+}
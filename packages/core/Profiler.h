@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __profiler__
+#define __profiler__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+#include <atomic>
+#include <signal.h>
+
+/******************************************************************************
+ * PROFILER CLASS
+ *
+ *  Statistical CPU profiler for the running process.  While a profile is
+ *  being taken, the process CPU timer (ITIMER_PROF) raises SIGPROF at the
+ *  requested frequency and the handler records the stack of whichever thread
+ *  was running into a preallocated sample buffer.  Nothing runs between
+ *  profiles other than the installed (idle) handler.
+ ******************************************************************************/
+
+class Profiler
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DEFAULT_FREQUENCY  = 99;       // Hz, off the beat of periodic work
+        static const int MAX_FREQUENCY      = 1000;     // Hz
+        static const int MAX_DURATION       = 300;      // seconds
+        static const int MAX_STACK_DEPTH    = 48;
+        static const int MAX_SAMPLES        = 32768;    // samples beyond this are counted as dropped
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void         init        (void);
+        static const char*  profile     (double duration, int frequency, long* num_samples=NULL, long* num_dropped=NULL);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int SKIP_FRAMES = 2; // signal handler and signal trampoline
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            int     depth;
+            void*   frames[MAX_STACK_DEPTH];
+        } sample_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static std::atomic<bool>    active;         // a profile is being taken
+        static std::atomic<bool>    sampling;       // handler records samples
+        static std::atomic<int>     inHandler;
+        static std::atomic<long>    sampleIndex;
+        static sample_t*            samples;
+        static long                 maxSamples;
+        static bool                 installed;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void         handler     (int sig, siginfo_t* info, void* context);
+        static const char*  symbolize   (void* addr);
+};
+
+#endif  /* __profiler__ */
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __quantile_sketch__
+#define __quantile_sketch__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <math.h>
+#include <algorithm>
+#include "OsApi.h"
+
+/******************************************************************************
+ * QUANTILE SKETCH TEMPLATE
+ ******************************************************************************/
+/*
+ * QuantileSketch - bounded memory approximation of the distribution of a
+ *  stream of values (a merging t-digest) that holds at most N centroids
+ *
+ *  Values are buffered and folded into the centroids when the buffer fills.
+ *  Centroids near the tails are kept small so extreme quantiles stay
+ *  accurate, and two sketches (or the centroids exported from one) can be
+ *  merged, so partial sketches built on different threads or nodes combine
+ *  into the sketch of the whole stream.  Not thread safe.
+ */
+template <int N=32>
+class QuantileSketch
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int CAPACITY = N;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                    QuantileSketch  (void);
+
+        void        add             (double value, uint32_t weight=1);
+        void        merge           (const QuantileSketch& other);
+        void        merge           (const float* means, const uint32_t* weights, int num_centroids, double min_value, double max_value);
+        double      quantile        (double q);
+        int         centroids       (float* means, uint32_t* weights);
+        uint64_t    count           (void) const;
+        void        clear           (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            double      mean;
+            uint64_t    weight;
+        } centroid_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        centroid_t  summary[N];
+        int         numSummary;
+        centroid_t  buffer[N];
+        int         numBuffered;
+        uint64_t    total;
+        double      minValue;
+        double      maxValue;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        void        compress        (void);
+        static bool compare         (const centroid_t& a, const centroid_t& b);
+};
+
+/******************************************************************************
+ QUANTILE SKETCH METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <int N>
+QuantileSketch<N>::QuantileSketch(void)
+{
+    clear();
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *----------------------------------------------------------------------------*/
+template <int N>
+void QuantileSketch<N>::add(double value, uint32_t weight)
+{
+    if(isnan(value) || weight == 0) return;
+
+    if(numBuffered >= N) compress();
+    buffer[numBuffered].mean = value;
+    buffer[numBuffered].weight = weight;
+    numBuffered++;
+
+    total += weight;
+    minValue = MIN(minValue, value);
+    maxValue = MAX(maxValue, value);
+}
+
+/*----------------------------------------------------------------------------
+ * merge
+ *----------------------------------------------------------------------------*/
+template <int N>
+void QuantileSketch<N>::merge(const QuantileSketch& other)
+{
+    for(int i = 0; i < other.numSummary; i++)
+    {
+        if(numBuffered >= N) compress();
+        buffer[numBuffered++] = other.summary[i];
+    }
+
+    for(int i = 0; i < other.numBuffered; i++)
+    {
+        if(numBuffered >= N) compress();
+        buffer[numBuffered++] = other.buffer[i];
+    }
+
+    total += other.total;
+    minValue = MIN(minValue, other.minValue);
+    maxValue = MAX(maxValue, other.maxValue);
+}
+
+/*----------------------------------------------------------------------------
+ * merge
+ *
+ *  folds in centroids exported by another sketch along with the smallest
+ *  and largest values that sketch saw
+ *----------------------------------------------------------------------------*/
+template <int N>
+void QuantileSketch<N>::merge(const float* means, const uint32_t* weights, int num_centroids, double min_value, double max_value)
+{
+    bool merged = false;
+    for(int i = 0; i < num_centroids; i++)
+    {
+        if(weights[i] == 0) continue;
+        if(numBuffered >= N) compress();
+        buffer[numBuffered].mean = means[i];
+        buffer[numBuffered].weight = weights[i];
+        numBuffered++;
+        total += weights[i];
+        merged = true;
+    }
+
+    if(merged)
+    {
+        minValue = MIN(minValue, min_value);
+        maxValue = MAX(maxValue, max_value);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * quantile
+ *
+ *  q is a fraction between 0 and 1; interpolates linearly between the
+ *  centers of neighbouring centroids and out to the extreme values at the
+ *  ends; returns NAN for an empty sketch
+ *----------------------------------------------------------------------------*/
+template <int N>
+double QuantileSketch<N>::quantile(double q)
+{
+    compress();
+
+    if(numSummary == 0) return NAN;
+    if(q <= 0.0) return minValue;
+    if(q >= 1.0) return maxValue;
+    if(numSummary == 1) return summary[0].mean;
+
+    double target = q * total;
+
+    /* Below Center of First Centroid */
+    double center = summary[0].weight / 2.0;
+    if(target < center)
+    {
+        return minValue + ((summary[0].mean - minValue) * (target / center));
+    }
+
+    /* Between Centers of Neighbouring Centroids */
+    for(int i = 0; i < numSummary - 1; i++)
+    {
+        double span = (summary[i].weight + summary[i + 1].weight) / 2.0;
+        if(target < center + span)
+        {
+            return summary[i].mean + ((summary[i + 1].mean - summary[i].mean) * ((target - center) / span));
+        }
+        center += span;
+    }
+
+    /* Above Center of Last Centroid */
+    double tail = total - center;
+    return summary[numSummary - 1].mean + ((maxValue - summary[numSummary - 1].mean) * ((target - center) / tail));
+}
+
+/*----------------------------------------------------------------------------
+ * centroids
+ *
+ *  exports the centroids in ascending order into arrays of at least N
+ *  elements and returns how many were written
+ *----------------------------------------------------------------------------*/
+template <int N>
+int QuantileSketch<N>::centroids(float* means, uint32_t* weights)
+{
+    compress();
+
+    for(int i = 0; i < numSummary; i++)
+    {
+        means[i] = (float)summary[i].mean;
+        weights[i] = (uint32_t)summary[i].weight;
+    }
+
+    return numSummary;
+}
+
+/*----------------------------------------------------------------------------
+ * count
+ *----------------------------------------------------------------------------*/
+template <int N>
+uint64_t QuantileSketch<N>::count(void) const
+{
+    return total;
+}
+
+/*----------------------------------------------------------------------------
+ * clear
+ *----------------------------------------------------------------------------*/
+template <int N>
+void QuantileSketch<N>::clear(void)
+{
+    numSummary = 0;
+    numBuffered = 0;
+    total = 0;
+    minValue = INFINITY;
+    maxValue = -INFINITY;
+}
+
+/*----------------------------------------------------------------------------
+ * compress
+ *
+ *  sorts the buffered values in with the centroids and greedily merges
+ *  neighbours while the merged centroid spans no more than one unit of the
+ *  arcsine scale k(q) = N/2pi * asin(2q - 1), which bounds the result to
+ *  about N centroids; any left over are merged pairwise from the smallest
+ *----------------------------------------------------------------------------*/
+template <int N>
+void QuantileSketch<N>::compress(void)
+{
+    if(numBuffered == 0) return;
+
+    centroid_t scratch[N * 2];
+    int n = 0;
+    for(int i = 0; i < numSummary; i++) scratch[n++] = summary[i];
+    for(int i = 0; i < numBuffered; i++) scratch[n++] = buffer[i];
+    numBuffered = 0;
+    std::sort(scratch, scratch + n, compare);
+
+    /* Merge Neighbours Within Scale Limit */
+    const double scale = N / (2.0 * M_PI);
+    double weight_so_far = 0.0;
+    double q_limit = (sin((asin(-1.0) * scale + 1.0) / scale) + 1.0) / 2.0;
+    int m = 0;
+    scratch[m] = scratch[0];
+    for(int i = 1; i < n; i++)
+    {
+        double q = (weight_so_far + scratch[m].weight + scratch[i].weight) / total;
+        if(q <= q_limit)
+        {
+            uint64_t weight = scratch[m].weight + scratch[i].weight;
+            scratch[m].mean += (scratch[i].mean - scratch[m].mean) * scratch[i].weight / weight;
+            scratch[m].weight = weight;
+        }
+        else
+        {
+            weight_so_far += scratch[m].weight;
+            double k = asin(MIN((2.0 * weight_so_far / total) - 1.0, 1.0)) * scale + 1.0;
+            q_limit = (k >= scale * M_PI / 2.0) ? 1.0 : (sin(k / scale) + 1.0) / 2.0;
+            scratch[++m] = scratch[i];
+        }
+    }
+    n = m + 1;
+
+    /* Enforce Capacity */
+    while(n > N)
+    {
+        int s = 0;
+        for(int i = 1; i < n - 1; i++)
+        {
+            if(scratch[i].weight + scratch[i + 1].weight < scratch[s].weight + scratch[s + 1].weight) s = i;
+        }
+        uint64_t weight = scratch[s].weight + scratch[s + 1].weight;
+        scratch[s].mean += (scratch[s + 1].mean - scratch[s].mean) * scratch[s + 1].weight / weight;
+        scratch[s].weight = weight;
+        for(int i = s + 1; i < n - 1; i++) scratch[i] = scratch[i + 1];
+        n--;
+    }
+
+    for(int i = 0; i < n; i++) summary[i] = scratch[i];
+    numSummary = n;
+}
+
+/*----------------------------------------------------------------------------
+ * compare
+ *----------------------------------------------------------------------------*/
+template <int N>
+bool QuantileSketch<N>::compare(const centroid_t& a, const centroid_t& b)
+{
+    return a.mean < b.mean;
+}
+
+#endif  /* __quantile_sketch__ */
@@ -40,8 +40,15 @@
  * STATIC DATA
  ******************************************************************************/
 
+const char* RecordDispatcher::METRIC_CATEGORY = "dispatch";
+
 Dictionary<RecordDispatcher::calcFunc_t> RecordDispatcher::keyCalcFunctions;
 
+std::atomic<long> RecordDispatcher::numDispatchTables(0);
+LatencyHistogram* RecordDispatcher::processLatency = NULL;
+thread_local RecordDispatcher::dispatch_cache_t RecordDispatcher::dispatchCache[DISPATCH_CACHE_SIZE];
+thread_local int RecordDispatcher::dispatchCacheNext = 0;
+
 const char* RecordDispatcher::LuaMetaName = "RecordDispatcher";
 const struct luaL_Reg RecordDispatcher::LuaMetaTable[] = {
     {"run",         luaRun},
@@ -57,7 +64,15 @@ const struct luaL_Reg RecordDispatcher::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - dispatcher(<input stream name>, [<num threads>], [<key mode>, <key parm>], [<subscriber type>])
+ * init
+ *----------------------------------------------------------------------------*/
+void RecordDispatcher::init (void)
+{
+    processLatency = new LatencyHistogram(METRIC_CATEGORY, "process");
+}
+
+/*----------------------------------------------------------------------------
+ * luaCreate - dispatcher(<input stream name>, [<num threads>], [<key mode>, <key parm>], [<subscriber type>], [<partitioned>])
  *----------------------------------------------------------------------------*/
 int RecordDispatcher::luaCreate (lua_State* L)
 {
@@ -95,8 +110,11 @@ int RecordDispatcher::luaCreate (lua_State* L)
         /* Set Subscriber Type */
         MsgQ::subscriber_type_t type = (MsgQ::subscriber_type_t)getLuaInteger(L, 5, true, MsgQ::SUBSCRIBER_OF_CONFIDENCE);
 
+        /* Set Partitioning */
+        bool partitioned = getLuaBoolean(L, 6, true, false);
+
         /* Create Record Dispatcher */
-        return createLuaObject(L, new RecordDispatcher(L, qname, key_mode, key_field, key_func, num_threads, type));
+        return createLuaObject(L, new RecordDispatcher(L, qname, key_mode, key_field, key_func, num_threads, type, partitioned));
     }
     catch(const RunTimeException& e)
     {
@@ -147,13 +165,14 @@ bool RecordDispatcher::addKeyCalcFunc(const char* calc_name, calcFunc_t func)
  *----------------------------------------------------------------------------*/
 RecordDispatcher::RecordDispatcher( lua_State* L, const char* inputq_name,
                                     keyMode_t key_mode, const char* key_field, calcFunc_t key_func,
-                                    int num_threads, MsgQ::subscriber_type_t type):
+                                    int num_threads, MsgQ::subscriber_type_t type, bool _partitioned):
     LuaObject(L, BASE_OBJECT_TYPE, LuaMetaName, LuaMetaTable)
 {
     assert(inputq_name);
     assert(num_threads > 0);
 
     /* Initialize Attributes */
+    tableId         = ++numDispatchTables;
     keyMode         = key_mode;
     keyRecCnt       = 0;
     keyField        = StringLib::duplicate(key_field);
@@ -170,6 +189,26 @@ RecordDispatcher::RecordDispatcher( lua_State* L, const char* inputq_name,
     abortOnTimeout = false;
     threadPool = new Thread* [numThreads];
     for(int i = 0; i < numThreads; i++) threadPool[i] = NULL;
+
+    /*
+     * Create Partitions
+     *  each partition queue has exactly one poster (the router thread) and
+     *  one receiver (its dispatcher thread), and so is declared SPSC
+     */
+    partitioned = _partitioned;
+    routerPid = NULL;
+    partitions = NULL;
+    if(partitioned)
+    {
+        partitions = new partition_t [numThreads];
+        for(int i = 0; i < numThreads; i++)
+        {
+            partitions[i].dispatcher = this;
+            partitions[i].pubQ = new Publisher(NULL, NULL);
+            partitions[i].subQ = new Subscriber(*partitions[i].pubQ);
+            partitions[i].pubQ->declareSPSC();
+        }
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -178,11 +217,39 @@ RecordDispatcher::RecordDispatcher( lua_State* L, const char* inputq_name,
 RecordDispatcher::~RecordDispatcher(void)
 {
     dispatcherActive = false;
+    int threads_started = 0;
+    if(routerPid)
+    {
+        delete routerPid;
+        threads_started++;
+    }
     for(int i = 0; i < numThreads; i++)
     {
-        if (threadPool[i]) delete threadPool[i];
+        if (threadPool[i])
+        {
+            delete threadPool[i];
+            threads_started++;
+        }
     }
     delete [] threadPool;
+    ThreadBudget::release(threads_started);
+
+    if(partitions)
+    {
+        for(int i = 0; i < numThreads; i++)
+        {
+            /* Release Records Left in Partition */
+            routed_t routed;
+            while(partitions[i].subQ->receiveCopy(&routed, sizeof(routed), IO_CHECK) > 0)
+            {
+                delete routed.record;
+                inQ->dereference(routed.ref);
+            }
+            delete partitions[i].subQ;
+            delete partitions[i].pubQ;
+        }
+        delete [] partitions;
+    }
 
     delete inQ;
 
@@ -221,11 +288,27 @@ int RecordDispatcher::luaRun(lua_State* L)
         /* Get Self */
         RecordDispatcher* lua_obj = (RecordDispatcher*)getLuaSelf(L, 1);
 
-        /* Start Threads */
+        /* Start Threads (always admitted, the dispatcher cannot run with fewer)
+         *  threads inherit the node of the request that runs the dispatcher,
+         *  keeping them next to the readers posting the records */
         lua_obj->dispatcherActive = true;
-        for(int i = 0; i < lua_obj->numThreads; i++)
+        ThreadBudget::reserve(lua_obj->numThreads + (lua_obj->partitioned ? 1 : 0));
+        Thread::attr_t attr = {.name = "dispatcher", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+        if(lua_obj->partitioned)
         {
-            lua_obj->threadPool[i] = new Thread(dispatcherThread, lua_obj);
+            for(int i = 0; i < lua_obj->numThreads; i++)
+            {
+                lua_obj->threadPool[i] = new Thread(partitionThread, &lua_obj->partitions[i], attr);
+            }
+            attr.name = "dispatch.router";
+            lua_obj->routerPid = new Thread(routerThread, lua_obj, attr);
+        }
+        else
+        {
+            for(int i = 0; i < lua_obj->numThreads; i++)
+            {
+                lua_obj->threadPool[i] = new Thread(dispatcherThread, lua_obj, attr);
+            }
         }
 
         /* Set Success */
@@ -311,6 +394,7 @@ int RecordDispatcher::luaAttachDispatch(lua_State* L)
             }
 
             /* Replace Dispatch Table Entry */
+            lua_obj->tableId = ++numDispatchTables;
             if(!lua_obj->dispatchTable.add(rec_type, new_dispatch))
             {
                 delete [] new_dispatch.list;
@@ -424,6 +508,7 @@ int RecordDispatcher::luaAbortOnTimeout (lua_State* L)
 void* RecordDispatcher::dispatcherThread(void* parm)
 {
     RecordDispatcher* dispatcher = (RecordDispatcher*)parm;
+    RequestAccount* previous = RequestAccount::attach(dispatcher->account);
 
     /* Loop Forever */
     while(dispatcher->dispatcherActive)
@@ -436,8 +521,8 @@ void* RecordDispatcher::dispatcherThread(void* parm)
             unsigned char* msg = (unsigned char*)ref.data;
             int len = ref.size;
 
-            /* Dispatch Record */
-            if(len > 0)
+            /* Dispatch Record - records of a cancelled request are drained without processing */
+            if(len > 0 && !dispatcher->isCancelled())
             {
                 try
                 {
@@ -448,27 +533,10 @@ void* RecordDispatcher::dispatcherThread(void* parm)
                 }
                 catch (const RunTimeException& e)
                 {
-                    if(!dispatcher->recError)
-                    {
-                        int num_newlines = len / 16 + 3;
-                        char* msg_str = new char[len * 2 + num_newlines + 1];
-                        mlog(e.level(), "%s unable to create record from message: %s", dispatcher->ObjectType, e.what());
-                        int msg_index = 0;
-                        for(int i = 0; i < len; i++)
-                        {
-                            sprintf(&msg_str[msg_index], "%02X", msg[i]);
-                            msg_index += 2;
-                            if(i % 16 == 15) msg_str[msg_index++] = '\n';
-                        }
-                        msg_str[msg_index++] = '\n';
-                        msg_str[msg_index++] = '\0';
-                        mlog(DEBUG, "%s", msg_str);
-                        delete [] msg_str;
-                    }
-                    dispatcher->recError = true;
+                    dispatcher->reportRecordError(e, msg, len);
                 }
             }
-            else
+            else if(len <= 0)
             {
                 /* Terminating Message */
                 mlog(DEBUG, "Terminator received on %s, exiting dispatcher", dispatcher->inQ->getName());
@@ -503,15 +571,170 @@ void* RecordDispatcher::dispatcherThread(void* parm)
         }
     }
 
+    /* Settle Account before Termination is Processed */
+    RequestAccount::detach(previous);
+
     /* Handle Termination */
-    dispatcher->threadMut.lock();
+    dispatcher->completeThread();
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * routerThread
+ *
+ *  sole receiver of the input stream when partitioned; creates each record,
+ *  calculates its key, and hands it to the partition owning the key so that
+ *  every key is only ever processed by one dispatcher thread
+ *----------------------------------------------------------------------------*/
+void* RecordDispatcher::routerThread(void* parm)
+{
+    RecordDispatcher* dispatcher = (RecordDispatcher*)parm;
+    RequestAccount* previous = RequestAccount::attach(dispatcher->account);
+
+    /* Loop Until Input Ends */
+    bool routing = true;
+    while(routing && dispatcher->dispatcherActive)
+    {
+        /* Receive Message */
+        Subscriber::msgRef_t ref;
+        int recv_status = dispatcher->inQ->receiveRef(ref, SYS_TIMEOUT);
+        if(recv_status > 0)
+        {
+            unsigned char* msg = (unsigned char*)ref.data;
+            int len = ref.size;
+
+            /* Route Record - records of a cancelled request are drained without processing */
+            if(len > 0 && !dispatcher->isCancelled())
+            {
+                try
+                {
+                    /* Create & Route Record (partition dereferences message) */
+                    RecordObject* record = dispatcher->createRecord(msg, len);
+                    dispatcher->routeRecord(record, ref);
+                    continue;
+                }
+                catch (const RunTimeException& e)
+                {
+                    dispatcher->reportRecordError(e, msg, len);
+                }
+            }
+            else if(len <= 0)
+            {
+                /* Terminating Message */
+                mlog(DEBUG, "Terminator received on %s, exiting dispatcher", dispatcher->inQ->getName());
+                routing = false;
+            }
+
+            /* Dereference Message */
+            dispatcher->inQ->dereference(ref);
+        }
+        else if(recv_status == MsgQ::STATE_TIMEOUT)
+        {
+            /* Check if Aborting on Timeout (partitions signal their own timeouts) */
+            if(dispatcher->abortOnTimeout)
+            {
+                routing = false;
+            }
+        }
+        else
+        {
+            /* Break Out on Failure */
+            mlog(CRITICAL, "Failed queue receive on %s with error %d", dispatcher->inQ->getName(), recv_status);
+            routing = false;
+        }
+    }
+
+    /* Terminate Partitions (queued records are processed first) */
+    for(int i = 0; i < dispatcher->numThreads; i++)
+    {
+        int post_status = MsgQ::STATE_TIMEOUT;
+        while(dispatcher->dispatcherActive && (post_status = dispatcher->partitions[i].pubQ->postCopy("", 0, SYS_TIMEOUT)) == MsgQ::STATE_TIMEOUT);
+    }
+
+    /* Settle Account */
+    RequestAccount::detach(previous);
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * partitionThread
+ *----------------------------------------------------------------------------*/
+void* RecordDispatcher::partitionThread(void* parm)
+{
+    partition_t* partition = (partition_t*)parm;
+    RecordDispatcher* dispatcher = partition->dispatcher;
+    RequestAccount* previous = RequestAccount::attach(dispatcher->account);
+
+    /* Loop Until Terminated by Router */
+    while(dispatcher->dispatcherActive)
     {
-        dispatcher->threadsComplete++;
-        if(dispatcher->threadsComplete == dispatcher->numThreads)
+        /* Receive Routed Record */
+        routed_t routed;
+        int recv_status = partition->subQ->receiveCopy(&routed, sizeof(routed), SYS_TIMEOUT);
+        if(recv_status == sizeof(routed))
         {
+            /* Process Record */
+            {
+                LatencyHistogram::Sample sample(processLatency);
+                for (int i = 0; i < routed.dispatch.size; i++)
+                {
+                    routed.dispatch.list[i]->processRecord(routed.record, routed.key);
+                }
+            }
+            delete routed.record;
+            dispatcher->inQ->dereference(routed.ref);
+        }
+        else if(recv_status == 0)
+        {
+            /* Terminating Message */
+            break;
+        }
+        else if(recv_status == MsgQ::STATE_TIMEOUT)
+        {
+            /* Signal Timeout to Dispatches */
+            int num_dispatches = dispatcher->dispatchList.length();
+            for(int d = 0; d < num_dispatches; d++)
+            {
+                DispatchObject* dis = dispatcher->dispatchList[d];
+                dis->processTimeout();
+            }
+        }
+        else
+        {
+            mlog(CRITICAL, "Failed partition receive on %s with error %d", dispatcher->inQ->getName(), recv_status);
+            break;
+        }
+    }
+
+    /* Settle Account before Termination is Processed */
+    RequestAccount::detach(previous);
+
+    /* Handle Termination */
+    dispatcher->completeThread();
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * completeThread
+ *
+ *  the last dispatcher thread to exit processes termination for each dispatch
+ *----------------------------------------------------------------------------*/
+void RecordDispatcher::completeThread(void)
+{
+    threadMut.lock();
+    {
+        threadsComplete++;
+        if(threadsComplete == numThreads)
+        {
+            /* Stop Dispatcher */
+            dispatcherActive = false;
+
             /* Process Termination for each Dispatch */
             dispatch_t dispatch;
-            const char* key = dispatcher->dispatchTable.first(&dispatch);
+            const char* key = dispatchTable.first(&dispatch);
             while(key != NULL)
             {
                 for(int d = 0; d < dispatch.size; d++)
@@ -521,16 +744,14 @@ void* RecordDispatcher::dispatcherThread(void* parm)
                         mlog(ERROR, "Failed to process termination on %s for %s", key, dispatch.list[d]->getName());
                     }
                 }
-                key = dispatcher->dispatchTable.next(&dispatch);
+                key = dispatchTable.next(&dispatch);
             }
 
             /* Signal Completion */
-            dispatcher->signalComplete();
+            signalComplete();
         }
     }
-    dispatcher->threadMut.unlock();
-
-    return NULL;
+    threadMut.unlock();
 }
 
 /*----------------------------------------------------------------------------
@@ -541,29 +762,14 @@ void RecordDispatcher::dispatchRecord (RecordObject* record)
     /* Dispatch Dispatches */
     try
     {
-        dispatch_t& dis = dispatchTable[record->getRecordType()];
+        dispatch_t dis = lookupDispatch(record->getRecordType());
+        if(!dis.list) return;
 
         /* Get Key */
-        okey_t key = 0;
-        if(keyMode == FIELD_KEY_MODE)
-        {
-            RecordObject::field_t key_field = record->getField(keyField);
-            key = (okey_t)record->getValueInteger(key_field);
-        }
-        else if(keyMode == RECEIPT_KEY_MODE)
-        {
-            dispatchMutex.lock();
-            {
-                key = keyRecCnt++;
-            }
-            dispatchMutex.unlock();
-        }
-        else if(keyMode == CALCULATED_KEY_MODE)
-        {
-            key = keyFunc(record->getRecordData(), record->getRecordDataSize());
-        }
+        okey_t key = calcKey(record);
 
         /* Process Record */
+        LatencyHistogram::Sample sample(processLatency);
         for (int i = 0; i < dis.size; i++)
         {
             dis.list[i]->processRecord(record, key);
@@ -574,3 +780,127 @@ void RecordDispatcher::dispatchRecord (RecordObject* record)
         (void)e;
     }
 }
+
+/*----------------------------------------------------------------------------
+ * routeRecord
+ *
+ *  takes ownership of the record and the input message; keys are spread
+ *  over the partitions by modulus, so keys carrying a track or pair number
+ *  in their low bits keep each track on a single thread
+ *----------------------------------------------------------------------------*/
+void RecordDispatcher::routeRecord (RecordObject* record, Subscriber::msgRef_t& ref)
+{
+    routed_t routed = {record, 0, {NULL, 0}, ref};
+
+    try
+    {
+        routed.dispatch = lookupDispatch(record->getRecordType());
+        if(routed.dispatch.list)
+        {
+            /* Get Key */
+            routed.key = calcKey(record);
+
+            /* Post to Partition */
+            partition_t* partition = &partitions[routed.key % numThreads];
+            int post_status = MsgQ::STATE_TIMEOUT;
+            while(dispatcherActive && (post_status = partition->pubQ->postCopy(&routed, sizeof(routed), SYS_TIMEOUT)) == MsgQ::STATE_TIMEOUT);
+            if(post_status > 0) return;
+        }
+    }
+    catch(RunTimeException& e)
+    {
+        (void)e;
+    }
+
+    /* Record Not Routed */
+    delete record;
+    inQ->dereference(ref);
+}
+
+/*----------------------------------------------------------------------------
+ * calcKey
+ *----------------------------------------------------------------------------*/
+okey_t RecordDispatcher::calcKey (RecordObject* record)
+{
+    okey_t key = 0;
+    if(keyMode == FIELD_KEY_MODE)
+    {
+        RecordObject::field_t key_field = record->getField(keyField);
+        key = (okey_t)record->getValueInteger(key_field);
+    }
+    else if(keyMode == RECEIPT_KEY_MODE)
+    {
+        key = keyRecCnt++;
+    }
+    else if(keyMode == CALCULATED_KEY_MODE)
+    {
+        key = keyFunc(record->getRecordData(), record->getRecordDataSize());
+    }
+    return key;
+}
+
+/*----------------------------------------------------------------------------
+ * lookupDispatch
+ *
+ *  dispatch table lookups are cached per thread so dispatcher threads
+ *  never contend over the table; entries are keyed by the table id which
+ *  changes on every attach, and record types with nothing attached are
+ *  cached too so they stop costing a failed lookup per record
+ *----------------------------------------------------------------------------*/
+RecordDispatcher::dispatch_t RecordDispatcher::lookupDispatch (const char* rec_type)
+{
+    /* Check Cache */
+    for(int c = 0; c < DISPATCH_CACHE_SIZE; c++)
+    {
+        dispatch_cache_t* entry = &dispatchCache[c];
+        if(entry->table_id == tableId && StringLib::match(entry->rec_type, rec_type))
+        {
+            return entry->dispatch;
+        }
+    }
+
+    /* Look Up Dispatch Table */
+    dispatch_t dispatch = {NULL, 0};
+    dispatchTable.find(rec_type, &dispatch);
+
+    /* Cache Lookup */
+    int type_len = StringLib::size(rec_type, MAX_CACHED_TYPE_SIZE);
+    if(type_len < MAX_CACHED_TYPE_SIZE)
+    {
+        dispatch_cache_t* entry = &dispatchCache[dispatchCacheNext];
+        dispatchCacheNext = (dispatchCacheNext + 1) % DISPATCH_CACHE_SIZE;
+        entry->table_id = tableId;
+        LocalLib::copy(entry->rec_type, rec_type, type_len + 1);
+        entry->dispatch = dispatch;
+    }
+
+    return dispatch;
+}
+
+/*----------------------------------------------------------------------------
+ * reportRecordError
+ *
+ *  only the first failure is logged (with a dump of the message) until the
+ *  error is cleared
+ *----------------------------------------------------------------------------*/
+void RecordDispatcher::reportRecordError (const RunTimeException& e, const unsigned char* msg, int len)
+{
+    if(!recError)
+    {
+        int num_newlines = len / 16 + 3;
+        char* msg_str = new char[len * 2 + num_newlines + 1];
+        mlog(e.level(), "%s unable to create record from message: %s", ObjectType, e.what());
+        int msg_index = 0;
+        for(int i = 0; i < len; i++)
+        {
+            sprintf(&msg_str[msg_index], "%02X", msg[i]);
+            msg_index += 2;
+            if(i % 16 == 15) msg_str[msg_index++] = '\n';
+        }
+        msg_str[msg_index++] = '\n';
+        msg_str[msg_index++] = '\0';
+        mlog(DEBUG, "%s", msg_str);
+        delete [] msg_str;
+    }
+    recError = true;
+}
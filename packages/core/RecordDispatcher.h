@@ -36,6 +36,8 @@
  * INCLUDES
  ******************************************************************************/
 
+#include <atomic>
+
 #include "DispatchObject.h"
 #include "LuaObject.h"
 #include "Dictionary.h"
@@ -43,6 +45,7 @@
 #include "MsgQ.h"
 #include "RecordObject.h"
 #include "OsApi.h"
+#include "LatencyHistogram.h"
 
 /******************************************************************************
  * RECORD DISPATCHER CLASS
@@ -70,11 +73,13 @@ class RecordDispatcher: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int DISPATCH_TIMEOUT = 1000; // milliseconds
+        static const char* METRIC_CATEGORY;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
+        static void         init            (void);
         static int          luaCreate       (lua_State* L);
 
         static keyMode_t    str2mode        (const char* str);
@@ -102,7 +107,7 @@ class RecordDispatcher: public LuaObject
 
                                 RecordDispatcher    (lua_State* L, const char* inputq_name,
                                                      keyMode_t key_mode, const char* key_field, calcFunc_t key_func,
-                                                     int num_threads, MsgQ::subscriber_type_t type);
+                                                     int num_threads, MsgQ::subscriber_type_t type, bool _partitioned=false);
         virtual                 ~RecordDispatcher   (void);
         virtual RecordObject*   createRecord        (unsigned char* buffer, int size);
 
@@ -114,6 +119,13 @@ class RecordDispatcher: public LuaObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DISPATCH_CACHE_SIZE = 4;
+        static const int MAX_CACHED_TYPE_SIZE = 64;
+
         /*--------------------------------------------------------------------
          * Types
          *--------------------------------------------------------------------*/
@@ -123,10 +135,37 @@ class RecordDispatcher: public LuaObject
             int                 size;
         } dispatch_t;
 
+        /* Per Thread Cache of Dispatch Table Lookups */
+        typedef struct {
+            long                table_id;                           // dispatch table the lookup was made in
+            char                rec_type[MAX_CACHED_TYPE_SIZE];
+            dispatch_t          dispatch;                           // list is NULL when nothing is attached to the type
+        } dispatch_cache_t;
+
+        /* Record Routed to a Partition */
+        typedef struct {
+            RecordObject*           record;
+            okey_t                  key;
+            dispatch_t              dispatch;
+            Subscriber::msgRef_t    ref;                            // input message, dereferenced by the partition
+        } routed_t;
+
+        /* Partition Owned by a Single Dispatcher Thread */
+        typedef struct {
+            RecordDispatcher*       dispatcher;
+            Publisher*              pubQ;                           // posted to by the router thread only
+            Subscriber*             subQ;                           // received from by the partition thread only
+        } partition_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
+        static std::atomic<long>                numDispatchTables;
+        static thread_local dispatch_cache_t    dispatchCache[DISPATCH_CACHE_SIZE];
+        static thread_local int                 dispatchCacheNext;
+        static LatencyHistogram*                processLatency;
+
         bool                    dispatcherActive;
         bool                    abortOnTimeout;
         Thread**                threadPool;
@@ -136,19 +175,29 @@ class RecordDispatcher: public LuaObject
         Subscriber*             inQ;
         List<DispatchObject*>   dispatchList;   // for processTimeout
         Dictionary<dispatch_t>  dispatchTable;  // for processRecord
-        Mutex                   dispatchMutex;
+        long                    tableId;        // changes on every attach, invalidating cached lookups
         keyMode_t               keyMode;        // determines key of metric
-        okey_t                  keyRecCnt;      // used with RECEIPT_KEY_MODE
+        std::atomic<okey_t>     keyRecCnt;      // used with RECEIPT_KEY_MODE
         const char*             keyField;       // used with FIELD_KEY_MODE
         calcFunc_t              keyFunc;        // used with CALCULATED_KEY_MODE
         bool                    recError;
+        bool                    partitioned;    // records are routed to threads by key
+        Thread*                 routerPid;      // used when partitioned
+        partition_t*            partitions;     // [numThreads] used when partitioned
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
         static void*    dispatcherThread    (void* parm);
+        static void*    routerThread        (void* parm);
+        static void*    partitionThread     (void* parm);
         void            dispatchRecord      (RecordObject* record);
+        void            routeRecord         (RecordObject* record, Subscriber::msgRef_t& ref);
+        okey_t          calcKey             (RecordObject* record);
+        dispatch_t      lookupDispatch      (const char* rec_type);
+        void            reportRecordError   (const RunTimeException& e, const unsigned char* msg, int len);
+        void            completeThread      (void);
 
         void            startThreads        (void);
         void            stopThreads         (void);
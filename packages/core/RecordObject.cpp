@@ -40,19 +40,21 @@
  ******************************************************************************/
 
 #include "RecordObject.h"
+#include "RecordPool.h"
 #include "StringLib.h"
 #include "OsApi.h"
 #include "EventLib.h"
 #include "Dictionary.h"
 
 #include <math.h>
+#include <string.h>
 
 /******************************************************************************
  * STATIC DATA
  ******************************************************************************/
 
-MgDictionary<RecordObject::definition_t*> RecordObject::definitions;
-Mutex RecordObject::defMut;
+std::atomic<RecordObject::registry_t*> RecordObject::registry(NULL);
+Mutex RecordObject::defMut("recdef");
 
 const char* RecordObject::DEFAULT_DOUBLE_FORMAT = "%.6lf";
 const char* RecordObject::DEFAULT_LONG_FORMAT = "%ld";
@@ -182,60 +184,107 @@ RecordObject::valType_t RecordObject::Field::getValueType(void)
 }
 
 /******************************************************************************
- * PUBLIC METHODS
+ * RECORD OBJECT FIELD HANDLE METHODS
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
  * Constructor
- *
- *  Attempts to create record from a string specification
  *----------------------------------------------------------------------------*/
-RecordObject::RecordObject(const char* rec_type, int allocated_memory, bool clear)
+RecordObject::FieldHandle::FieldHandle(const char* _field_name)
 {
-    assert(rec_type);
+    assert(_field_name);
 
-    /* Attempt to Get Record Type */
-    recordDefinition = getDefinition(rec_type);
+    fieldName = StringLib::intern(_field_name);
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
+    {
+        entries[i] = NULL;
+    }
+}
 
-    /* Attempt to Initialize Record */
-    if(recordDefinition != NULL)
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+RecordObject::FieldHandle::~FieldHandle(void)
+{
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
     {
-        int data_size;
+        delete entries[i].load();
+    }
+}
 
-        /* Calculate Memory to Allocate */
-        if(allocated_memory == 0)
-        {
-            memoryAllocated = recordDefinition->record_size;
-            data_size = recordDefinition->data_size;
-        }
-        else if(allocated_memory + (int)sizeof(rec_hdr_t) + recordDefinition->type_size >= recordDefinition->record_size)
+/*----------------------------------------------------------------------------
+ * resolve
+ *
+ *  Entries are immutable once published, so readers need no lock; a miss
+ *  resolves the name and claims the first empty slot.  Fields that fail to
+ *  resolve are not cached since they may be defined later, and once every
+ *  slot is taken further record types are resolved by name each time.
+ *----------------------------------------------------------------------------*/
+RecordObject::field_t RecordObject::FieldHandle::resolve(RecordObject* rec)
+{
+    const void* def = rec->recordDefinition;
+
+    /* Check Cache */
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
+    {
+        entry_t* entry = entries[i].load(std::memory_order_acquire);
+        if(entry == NULL) break;
+        if(entry->definition == def) return entry->field;
+    }
+
+    /* Resolve Field */
+    field_t f = rec->getField(fieldName);
+    if(f.type == INVALID_FIELD) return f;
+
+    /* Cache Field */
+    entry_t* new_entry = new entry_t;
+    new_entry->definition = def;
+    new_entry->field = f;
+    for(int i = 0; i < MAX_CACHED_TYPES; i++)
+    {
+        entry_t* expected = NULL;
+        if(entries[i].compare_exchange_strong(expected, new_entry, std::memory_order_acq_rel))
         {
-            memoryAllocated = allocated_memory + sizeof(rec_hdr_t) + recordDefinition->type_size;
-            data_size = allocated_memory;
+            return f;
         }
-        else
+        else if(expected->definition == def)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid memory allocation in record creation");
+            break; // another thread cached the same type
         }
+    }
+
+    delete new_entry;
+    return f;
+}
+
+/*----------------------------------------------------------------------------
+ * getName
+ *----------------------------------------------------------------------------*/
+const char* RecordObject::FieldHandle::getName(void)
+{
+    return fieldName;
+}
 
-        /* Allocate Record Memory */
-        memoryOwner = true;
-        recordMemory = new unsigned char[memoryAllocated];
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
 
-        /* Populate Header */
-        rec_hdr_t hdr = {
-            .version = LocalLib::swaps(RECORD_FORMAT_VERSION),
-            .type_size = LocalLib::swaps(recordDefinition->type_size),
-            .data_size = LocalLib::swapl(data_size)
-        };
-        LocalLib::copy(recordMemory, &hdr, sizeof(rec_hdr_t));
-        LocalLib::copy(&recordMemory[sizeof(rec_hdr_t)], recordDefinition->type_name, recordDefinition->type_size);
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  Attempts to create record from a string specification
+ *----------------------------------------------------------------------------*/
+RecordObject::RecordObject(const char* rec_type, int allocated_memory, bool clear)
+{
+    assert(rec_type);
 
-        /* Set Record Data Pointer */
-        recordData = &recordMemory[sizeof(rec_hdr_t) + recordDefinition->type_size];
+    /* Attempt to Get Record Type */
+    recordDefinition = getDefinition(rec_type);
 
-        /* Zero Out Record Data */
-        if(clear) LocalLib::set(recordData, 0, recordDefinition->data_size);
+    /* Attempt to Initialize Record */
+    if(recordDefinition != NULL)
+    {
+        allocateRecord(allocated_memory, clear);
     }
     else
     {
@@ -259,7 +308,7 @@ RecordObject::RecordObject(unsigned char* buffer, int size)
             /* Set Record Memory */
             memoryOwner = true;
             memoryAllocated = size;
-            recordMemory = new unsigned char[memoryAllocated];
+            recordMemory = RecordPool::allocate(memoryAllocated);
             LocalLib::copy(recordMemory, buffer, memoryAllocated);
 
             /* Set Record Data */
@@ -281,7 +330,7 @@ RecordObject::RecordObject(unsigned char* buffer, int size)
  *----------------------------------------------------------------------------*/
 RecordObject::~RecordObject(void)
 {
-    if(memoryOwner) delete [] recordMemory;
+    if(memoryOwner) RecordPool::release(recordMemory);
 }
 
 /*----------------------------------------------------------------------------
@@ -317,6 +366,10 @@ bool RecordObject::deserialize(unsigned char* buffer, int size)
 
 /*----------------------------------------------------------------------------
  * serialize
+ *
+ *  record memory is kept in its serialized form (header, type, data), so
+ *  the REFERENCE and TAKE_OWNERSHIP modes return it without copying; the
+ *  latter is meant for posting the record memory itself with postRef
  *----------------------------------------------------------------------------*/
 int RecordObject::serialize(unsigned char** buffer, serialMode_t mode, int size)
 {
@@ -386,7 +439,7 @@ bool RecordObject::post(Publisher* outq, int size, bool* active, bool verbose)
     /* Handle Status */
     if(post_status <= 0)
     {
-        delete [] rec_buf; // we've taken ownership
+        RecordPool::release(rec_buf); // we've taken ownership
         if(verbose) mlog(ERROR, "Failed to post %s to stream %s: %d", getRecordType(), outq->getName(), post_status);
         status = false;
     }
@@ -1031,7 +1084,16 @@ bool RecordObject::isType(unsigned char* buffer, int size, const char* rec_type)
  *----------------------------------------------------------------------------*/
 int RecordObject::getRecords(char*** rec_types)
 {
-    return definitions.getKeys(rec_types);
+    registry_t* reg = registry.load(std::memory_order_acquire);
+    if(reg == NULL || reg->num_defs == 0) return 0;
+
+    *rec_types = new char* [reg->num_defs];
+    for(int i = 0; i < reg->num_defs; i++)
+    {
+        (*rec_types)[i] = StringLib::duplicate(reg->by_id[i]->type_name);
+    }
+
+    return reg->num_defs;
 }
 
 /*----------------------------------------------------------------------------
@@ -1295,25 +1357,41 @@ const char* RecordObject::vt2str (valType_t vt)
  *----------------------------------------------------------------------------*/
 unsigned long RecordObject::unpackBitField (unsigned char* buf, int bit_offset, int bit_length)
 {
-    /* Setup Parameters */
-    int bits_left = bit_length;
     int bits_to_lsb = bit_length + bit_offset;
     int initial_shift = (sizeof(long) - bits_to_lsb) % 8;
     int byte_index = TOBYTES(bits_to_lsb - 1);
+    uint64_t mask = (bit_length >= 64) ? UINT64_MAX : ((1UL << bit_length) - 1);
 
-    /* Decompose Packet */
-    int i = 0;
-    unsigned long _value = 0;
-    while(bits_left > 0)
+    return extractBitField(buf, byte_index, initial_shift, mask);
+}
+
+/*----------------------------------------------------------------------------
+ * unpackBitFields
+ *
+ *  Bulk form of unpackBitField for the same set of fields repeated num_reps
+ *  times every rep_size bytes; values are written as values[rep][field].
+ *  Each field is read with a single 64-bit load, and its parameters are only
+ *  calculated once for all repetitions.
+ *----------------------------------------------------------------------------*/
+void RecordObject::unpackBitFields (unsigned char* buf, const field_t* fields, int num_fields, unsigned long* values, int num_reps, int rep_size)
+{
+    for(int f = 0; f < num_fields; f++)
     {
-        unsigned int contribution = buf[byte_index--] >> initial_shift;
-        unsigned int byte_mask = (1 << MIN(8, bits_left)) - 1;
-        _value += (contribution & byte_mask) * (1L << (i++ * 8));
-        bits_left -= 8;
-        initial_shift = 0;
-    }
+        int bit_length = fields[f].elements;
+        int bits_to_lsb = bit_length + fields[f].offset;
+        int initial_shift = (sizeof(long) - bits_to_lsb) % 8;
+        int byte_index = TOBYTES(bits_to_lsb - 1);
+        uint64_t mask = (bit_length >= 64) ? UINT64_MAX : ((1UL << bit_length) - 1);
 
-    return _value;
+        unsigned char* rec = buf;
+        unsigned long* val = &values[f];
+        for(int r = 0; r < num_reps; r++)
+        {
+            *val = extractBitField(rec, byte_index, initial_shift, mask);
+            rec += rep_size;
+            val += num_fields;
+        }
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -1344,6 +1422,36 @@ void RecordObject::packBitField (unsigned char* buf, int bit_offset, int bit_len
     }
 }
 
+/*----------------------------------------------------------------------------
+ * extractBitField
+ *
+ *  Reads the big endian 64-bit word whose last byte is byte_index and applies
+ *  the same byte arithmetic as the original per-byte unpacking loop: only the
+ *  least significant byte is shifted down, then the result is masked to the
+ *  field length.  Never reads past byte_index.
+ *----------------------------------------------------------------------------*/
+inline uint64_t RecordObject::extractBitField (const unsigned char* buf, int byte_index, int initial_shift, uint64_t mask)
+{
+    uint64_t word = 0;
+    if(byte_index >= 7)
+    {
+        memcpy(&word, &buf[byte_index - 7], sizeof(word));
+        #ifndef __be__
+        word = LocalLib::swapll(word);
+        #endif
+    }
+    else
+    {
+        for(int i = 0; i <= byte_index; i++)
+        {
+            word = (word << 8) | buf[i];
+        }
+    }
+
+    word = (word & ~0xFFUL) | ((word & 0xFFUL) >> initial_shift);
+    return word & mask;
+}
+
 /*----------------------------------------------------------------------------
  * parseImmediateField
  *
@@ -1450,6 +1558,64 @@ RecordObject::RecordObject(void)
     memoryOwner = false;
 }
 
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  for callers that already hold the definition (see TypedRecord)
+ *----------------------------------------------------------------------------*/
+RecordObject::RecordObject(definition_t* def, int allocated_memory, bool clear)
+{
+    assert(def);
+
+    recordDefinition = def;
+    allocateRecord(allocated_memory, clear);
+}
+
+/*----------------------------------------------------------------------------
+ * allocateRecord
+ *
+ *  allocates and initializes the record memory for recordDefinition
+ *----------------------------------------------------------------------------*/
+void RecordObject::allocateRecord(int allocated_memory, bool clear)
+{
+    int data_size;
+
+    /* Calculate Memory to Allocate */
+    if(allocated_memory == 0)
+    {
+        memoryAllocated = recordDefinition->record_size;
+        data_size = recordDefinition->data_size;
+    }
+    else if(allocated_memory + (int)sizeof(rec_hdr_t) + recordDefinition->type_size >= recordDefinition->record_size)
+    {
+        memoryAllocated = allocated_memory + sizeof(rec_hdr_t) + recordDefinition->type_size;
+        data_size = allocated_memory;
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid memory allocation in record creation");
+    }
+
+    /* Allocate Record Memory */
+    memoryOwner = true;
+    recordMemory = RecordPool::allocate(memoryAllocated);
+
+    /* Populate Header */
+    rec_hdr_t hdr = {
+        .version = LocalLib::swaps(RECORD_FORMAT_VERSION),
+        .type_size = LocalLib::swaps(recordDefinition->type_size),
+        .data_size = LocalLib::swapl(data_size)
+    };
+    LocalLib::copy(recordMemory, &hdr, sizeof(rec_hdr_t));
+    LocalLib::copy(&recordMemory[sizeof(rec_hdr_t)], recordDefinition->type_name, recordDefinition->type_size);
+
+    /* Set Record Data Pointer */
+    recordData = &recordMemory[sizeof(rec_hdr_t) + recordDefinition->type_size];
+
+    /* Zero Out Record Data */
+    if(clear) LocalLib::set(recordData, 0, recordDefinition->data_size);
+}
+
 /*----------------------------------------------------------------------------
  * addDefinition
  *
@@ -1576,7 +1742,8 @@ RecordObject::field_t RecordObject::getUserField (definition_t* def, const char*
         }
         else
         {
-            definition_t* subdef = definitions[field.exttype];
+            definition_t* subdef = getDefinition(field.exttype);
+            if(subdef == NULL) throw RunTimeException(CRITICAL, RTE_ERROR, "undefined record type %s", field.exttype);
             field_t subfield = getUserField(subdef, subfield_name);
             subfield.offset += field.offset;
             field = subfield;
@@ -1619,12 +1786,7 @@ RecordObject::recordDefErr_t RecordObject::addDefinition(definition_t** rec_def,
         {
             assert(data_size > 0);
             def = new definition_t(rec_type, id_field, data_size, max_fields);
-            if(!definitions.add(rec_type, def))
-            {
-                delete def;
-                def = NULL;
-                status = REGERR_DEF;
-            }
+            registerDefinition(def);
         }
         else
         {
@@ -1693,13 +1855,26 @@ RecordObject::recordDefErr_t RecordObject::addField(definition_t* def, const cha
 
 /*----------------------------------------------------------------------------
  * getDefinition
+ *
+ *  lock free; probes the current registry snapshot
  *----------------------------------------------------------------------------*/
 RecordObject::definition_t* RecordObject::getDefinition(const char* rec_type)
 {
-    definition_t* def = NULL;
-    try { def = definitions[rec_type]; }
-    catch (RunTimeException& e) { (void)e; }
-    return def;
+    registry_t* reg = registry.load(std::memory_order_acquire);
+    if(reg == NULL || rec_type == NULL) return NULL;
+
+    uint32_t mask = reg->hash_size - 1;
+    uint32_t slot = hashTypeName(rec_type) & mask;
+    while(reg->by_hash[slot] != NULL)
+    {
+        if(StringLib::match(reg->by_hash[slot]->type_name, rec_type))
+        {
+            return reg->by_hash[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -1707,15 +1882,32 @@ RecordObject::definition_t* RecordObject::getDefinition(const char* rec_type)
  *
  *  Notes:
  *   1. operates on serialized data (not a population string)
+ *   2. records of one type usually arrive together, so the definition last
+ *      found by the calling thread is checked before the registry
  *----------------------------------------------------------------------------*/
 RecordObject::definition_t* RecordObject::getDefinition(unsigned char* buffer, int size)
 {
+    static thread_local definition_t* last_def = NULL;
+
     /* Check Parameters */
     if(buffer == NULL) throw RunTimeException(CRITICAL, RTE_ERROR, "Null buffer used to retrieve record definition");
     else if(size <= (int)sizeof(rec_hdr_t)) throw RunTimeException(CRITICAL, RTE_ERROR, "Buffer too small to retrieve record definition");
 
-    /* Get Record Definitions */
+    /* Check Last Definition */
     char* rec_type = (char*)&buffer[sizeof(rec_hdr_t)];
+    if(last_def != NULL)
+    {
+        rec_hdr_t* hdr = (rec_hdr_t*)buffer;
+        int type_size = LocalLib::swaps(hdr->type_size);
+        if( (type_size == last_def->type_size) &&
+            (size >= (int)sizeof(rec_hdr_t) + type_size) &&
+            (memcmp(rec_type, last_def->type_name, type_size) == 0) )
+        {
+            return last_def;
+        }
+    }
+
+    /* Get Record Definitions */
     definition_t* def = getDefinition(rec_type);
 
     /* Check Record Definition */
@@ -1724,9 +1916,71 @@ RecordObject::definition_t* RecordObject::getDefinition(unsigned char* buffer, i
     if(def == NULL) return NULL;
 
     /* Return Definition*/
+    last_def = def;
     return def;
 }
 
+/*----------------------------------------------------------------------------
+ * getDefinition
+ *----------------------------------------------------------------------------*/
+RecordObject::definition_t* RecordObject::getDefinition(int id)
+{
+    registry_t* reg = registry.load(std::memory_order_acquire);
+    if(reg == NULL || id < 0 || id >= reg->num_defs) return NULL;
+    return reg->by_id[id];
+}
+
+/*----------------------------------------------------------------------------
+ * registerDefinition
+ *
+ *  must be called with defMut locked; publishes a new snapshot of the
+ *  registry that includes def
+ *----------------------------------------------------------------------------*/
+void RecordObject::registerDefinition(definition_t* def)
+{
+    registry_t* old_reg = registry.load(std::memory_order_relaxed);
+    int old_num_defs = old_reg ? old_reg->num_defs : 0;
+
+    /* Build New Snapshot */
+    registry_t* reg = new registry_t;
+    reg->num_defs = old_num_defs + 1;
+    reg->hash_size = 16;
+    while(reg->hash_size < reg->num_defs * 2) reg->hash_size *= 2;
+    reg->by_id = new definition_t* [reg->num_defs];
+    reg->by_hash = new definition_t* [reg->hash_size];
+    reg->prev = old_reg;
+    LocalLib::set(reg->by_hash, 0, sizeof(definition_t*) * reg->hash_size);
+
+    def->id = old_num_defs;
+    for(int i = 0; i < old_num_defs; i++) reg->by_id[i] = old_reg->by_id[i];
+    reg->by_id[def->id] = def;
+
+    uint32_t mask = reg->hash_size - 1;
+    for(int i = 0; i < reg->num_defs; i++)
+    {
+        uint32_t slot = hashTypeName(reg->by_id[i]->type_name) & mask;
+        while(reg->by_hash[slot] != NULL) slot = (slot + 1) & mask;
+        reg->by_hash[slot] = reg->by_id[i];
+    }
+
+    /* Publish Snapshot */
+    registry.store(reg, std::memory_order_release);
+}
+
+/*----------------------------------------------------------------------------
+ * hashTypeName - FNV-1a
+ *----------------------------------------------------------------------------*/
+uint32_t RecordObject::hashTypeName(const char* rec_type)
+{
+    uint32_t hash = 2166136261u;
+    for(const char* c = rec_type; *c != '\0'; c++)
+    {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
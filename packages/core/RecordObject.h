@@ -43,6 +43,8 @@
 
 #include <exception>
 #include <stdexcept>
+#include <atomic>
+#include <type_traits>
 
 /******************************************************************************
  * DEFINES
@@ -62,6 +64,27 @@
     } \
 }
 
+/*
+ * Typed Records
+ *
+ *  RECTYPE associates a record structure with the name of its record type;
+ *  it must be used at global scope, after the structure is declared.
+ *  RECFIELD builds the field definition of a structure member, taking the
+ *  type, offset, and number of elements from the member itself, and the
+ *  record type of members that are themselves records from their RECTYPE.
+ *  RECFIELD_VAR is the same for a variable length array at the end of the
+ *  record (elements of zero).
+ */
+
+#define RECTYPE(rec, rec_type) \
+template <> struct RecordTraits<rec> { static const char* type (void) { return rec_type; } };
+
+#define RECFIELD(rec, member, name) \
+    {name, RecordFieldType<decltype(((rec*)0)->member)>::type, offsetof(rec, member), RecordFieldType<decltype(((rec*)0)->member)>::elements, RecordFieldType<decltype(((rec*)0)->member)>::exttype(), NATIVE_FLAGS}
+
+#define RECFIELD_VAR(rec, member, name) \
+    {name, RecordFieldType<decltype(((rec*)0)->member)>::type, offsetof(rec, member), 0, RecordFieldType<decltype(((rec*)0)->member)>::exttype(), NATIVE_FLAGS}
+
 /******************************************************************************
  * RECORD OBJECT CLASS
  ******************************************************************************/
@@ -104,7 +127,7 @@ class RecordObject
             COPY,
             ALLOCATE,
             REFERENCE,
-            TAKE_OWNERSHIP
+            TAKE_OWNERSHIP      // caller frees with RecordPool::release (e.g. via Publisher::defaultFree)
         } serialMode_t;
 
         typedef enum {
@@ -185,6 +208,37 @@ class RecordObject
                 int             element;        // for arrays
         };
 
+        /*--------------------------------------------------------------------
+         * FieldHandle (subclass)
+         *
+         *  Resolves a field name once per record definition and returns the
+         *  cached field_t for later records of the same type; lookups are a
+         *  pointer compare and are safe from multiple dispatcher threads
+         *--------------------------------------------------------------------*/
+
+        class FieldHandle
+        {
+            public:
+
+                static const int MAX_CACHED_TYPES = 4;
+
+                explicit    FieldHandle     (const char* _field_name);
+                            ~FieldHandle    (void);
+
+                field_t     resolve         (RecordObject* rec);
+                const char* getName         (void);
+
+            private:
+
+                typedef struct {
+                    const void*     definition;     // record definition the field was resolved against
+                    field_t         field;
+                } entry_t;
+
+                const char*             fieldName;
+                std::atomic<entry_t*>   entries[MAX_CACHED_TYPES];
+        };
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -222,6 +276,8 @@ class RecordObject
         const char*             getValueText        (const field_t& field, char* valbuf=NULL, int element=0);
         double                  getValueReal        (const field_t& field, int element=0);
         long                    getValueInteger     (const field_t& field, int element=0);
+        template <typename T> T getValue            (const field_t& field, int element=0);
+        template <typename T> void setValue         (const field_t& field, T val, int element=0);
 
         /* Definition Static Methods */
         static field_t          getDefinedField     (const char* rec_type, const char* field_name);
@@ -246,8 +302,10 @@ class RecordObject
         static const char*      ft2str              (fieldType_t ft);
         static const char*      vt2str              (valType_t vt);
         static unsigned long    unpackBitField      (unsigned char* buf, int bit_offset, int bit_length);
+        static void             unpackBitFields     (unsigned char* buf, const field_t* fields, int num_fields, unsigned long* values, int num_reps=1, int rep_size=0);
         static void             packBitField        (unsigned char* buf, int bit_offset, int bit_length, long val);
         static field_t          parseImmediateField (const char* str);
+        template <typename T> static fieldType_t nativeType (void);
 
     protected:
 
@@ -274,6 +332,7 @@ class RecordObject
             int                     type_size;      // size in bytes of type name string including null termination
             int                     data_size;      // number of bytes of binary data
             int                     record_size;    // total size of memory allocated for record
+            int                     id;             // index into the registry, in order of definition
             Dictionary<field_t>     fields;
 
             definition_t(const char* _type_name, const char* _id_field, int _data_size, int _max_fields):
@@ -282,6 +341,7 @@ class RecordObject
                   type_size = (int)StringLib::size(_type_name) + 1;
                   id_field = StringLib::duplicate(_id_field);
                   data_size = _data_size;
+                  id = -1;
                   record_size = sizeof(rec_hdr_t) + type_size + _data_size; }
             ~definition_t(void)
                 { if(type_name) delete [] type_name;
@@ -292,7 +352,21 @@ class RecordObject
          * Data
          *--------------------------------------------------------------------*/
 
-        static MgDictionary<definition_t*>  definitions;
+        /*
+         * Immutable snapshot of all definitions, replaced on each definition
+         * so that lookups take no lock; snapshots that have been replaced are
+         * kept since readers may still be using them
+         */
+        struct registry_t
+        {
+            int                     num_defs;
+            int                     hash_size;      // power of two, at least twice num_defs
+            definition_t**          by_id;          // [num_defs]
+            definition_t**          by_hash;        // [hash_size] open addressing on type name
+            registry_t*             prev;
+        };
+
+        static std::atomic<registry_t*>     registry;
         static Mutex                        defMut;
 
         definition_t*   recordDefinition;
@@ -305,18 +379,24 @@ class RecordObject
          * Methods
          *--------------------------------------------------------------------*/
 
-        /* Protected Constructor */
+        /* Protected Constructors */
                                 RecordObject        (void);
+                                RecordObject        (definition_t* def, int allocated_memory, bool clear);
 
         /* Regular Methods */
+        void                    allocateRecord      (int allocated_memory, bool clear);
         field_t                 getPointedToField   (field_t field, bool allow_null, int element=0);
         static field_t          getUserField        (definition_t* def, const char* field_name);
         static recordDefErr_t   addDefinition       (definition_t** rec_def, const char* rec_type, const char* id_field, int data_size, const fieldDef_t* fields, int num_fields, int max_fields);
         static recordDefErr_t   addField            (definition_t* def, const char* field_name, fieldType_t type, int offset, int elements, const char* exttype, unsigned int flags);
+        static uint64_t         extractBitField     (const unsigned char* buf, int byte_index, int initial_shift, uint64_t mask);
 
         /* Overloaded Methods */
         static definition_t*    getDefinition       (const char* rec_type);
         static definition_t*    getDefinition       (unsigned char* buffer, int size);
+        static definition_t*    getDefinition       (int id);
+        static void             registerDefinition  (definition_t* def);
+        static uint32_t         hashTypeName        (const char* rec_type);
 };
 
 /*----------------------------------------------------------------------------
@@ -325,6 +405,76 @@ class RecordObject
 
 typedef RecordObject::Field RecordField;
 
+/******************************************************************************
+ * RECORD OBJECT TEMPLATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * nativeType
+ *
+ *  field type whose in-memory representation is exactly T; INVALID_FIELD
+ *  for types that always go through the generic accessors
+ *----------------------------------------------------------------------------*/
+template <typename T> inline RecordObject::fieldType_t RecordObject::nativeType (void) { return INVALID_FIELD; }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<int8_t>   (void) { return INT8;   }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<int16_t>  (void) { return INT16;  }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<int32_t>  (void) { return INT32;  }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<int64_t>  (void) { return INT64;  }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<uint8_t>  (void) { return UINT8;  }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<uint16_t> (void) { return UINT16; }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<uint32_t> (void) { return UINT32; }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<uint64_t> (void) { return UINT64; }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<float>    (void) { return FLOAT;  }
+template <> inline RecordObject::fieldType_t RecordObject::nativeType<double>   (void) { return DOUBLE; }
+
+/*----------------------------------------------------------------------------
+ * getValue
+ *
+ *  When the field is stored natively as T this is a single load; any other
+ *  field (pointer, byte swapped, bit field, different type) falls back to
+ *  getValueReal or getValueInteger and is converted to T
+ *----------------------------------------------------------------------------*/
+template <typename T>
+inline T RecordObject::getValue (const field_t& f, int element)
+{
+    if( (f.type == nativeType<T>()) &&
+        ((f.flags & (POINTER | BIGENDIAN)) == NATIVE_FLAGS) &&
+        (element == 0 || f.elements <= 0 || element < f.elements) )
+    {
+        return *(T*)(recordData + TOBYTES(f.offset) + (element * sizeof(T)));
+    }
+    else if(std::is_floating_point<T>::value)
+    {
+        return (T)getValueReal(f, element);
+    }
+    else
+    {
+        return (T)getValueInteger(f, element);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * setValue
+ *----------------------------------------------------------------------------*/
+template <typename T>
+inline void RecordObject::setValue (const field_t& f, T val, int element)
+{
+    if( (f.type == nativeType<T>()) &&
+        ((f.flags & (POINTER | BIGENDIAN)) == NATIVE_FLAGS) &&
+        (element == 0 || f.elements <= 0 || element < f.elements) )
+    {
+        *(T*)(recordData + TOBYTES(f.offset) + (element * sizeof(T))) = val;
+    }
+    else if(std::is_floating_point<T>::value)
+    {
+        setValueReal(f, (double)val, element);
+    }
+    else
+    {
+        setValueInteger(f, (long)val, element);
+    }
+}
+
 /******************************************************************************
  * RECORD INTERFACE CLASS
  ******************************************************************************/
@@ -336,4 +486,167 @@ class RecordInterface: public RecordObject
         virtual ~RecordInterface    (void);
 };
 
+/******************************************************************************
+ * RECORD TRAITS
+ ******************************************************************************/
+
+/* record type of a structure; specialized by RECTYPE */
+template <typename T> struct RecordTraits;
+
+/* field type of a structure member; members that are not native types must be records */
+template <typename T> struct RecordFieldType
+{
+    static const RecordObject::fieldType_t type = RecordObject::USER;
+    static const int elements = 1;
+    static const char* exttype (void) { return RecordTraits<T>::type(); }
+};
+
+#define RECFIELD_NATIVE(ctype, ftype) \
+template <> struct RecordFieldType<ctype> \
+{ \
+    static const RecordObject::fieldType_t type = RecordObject::ftype; \
+    static const int elements = 1; \
+    static const char* exttype (void) { return NULL; } \
+};
+
+RECFIELD_NATIVE(int8_t,     INT8)
+RECFIELD_NATIVE(int16_t,    INT16)
+RECFIELD_NATIVE(int32_t,    INT32)
+RECFIELD_NATIVE(int64_t,    INT64)
+RECFIELD_NATIVE(uint8_t,    UINT8)
+RECFIELD_NATIVE(uint16_t,   UINT16)
+RECFIELD_NATIVE(uint32_t,   UINT32)
+RECFIELD_NATIVE(uint64_t,   UINT64)
+RECFIELD_NATIVE(float,      FLOAT)
+RECFIELD_NATIVE(double,     DOUBLE)
+
+#undef RECFIELD_NATIVE
+
+/* arrays */
+template <typename T, size_t N> struct RecordFieldType<T[N]>
+{
+    static const RecordObject::fieldType_t type = RecordFieldType<T>::type;
+    static const int elements = N;
+    static const char* exttype (void) { return RecordFieldType<T>::exttype(); }
+};
+
+/* flexible array members are variable length */
+template <typename T> struct RecordFieldType<T[]>
+{
+    static const RecordObject::fieldType_t type = RecordFieldType<T>::type;
+    static const int elements = 0;
+    static const char* exttype (void) { return RecordFieldType<T>::exttype(); }
+};
+
+/* character arrays are strings */
+template <size_t N> struct RecordFieldType<char[N]>
+{
+    static const RecordObject::fieldType_t type = RecordObject::STRING;
+    static const int elements = N;
+    static const char* exttype (void) { return NULL; }
+};
+
+template <> struct RecordFieldType<char[]>
+{
+    static const RecordObject::fieldType_t type = RecordObject::STRING;
+    static const int elements = 0;
+    static const char* exttype (void) { return NULL; }
+};
+
+/******************************************************************************
+ * TYPED RECORD CLASS
+ *
+ *  Record whose structure is known at compile time.  The definition is looked
+ *  up once per type and reused, and the record data is accessed directly as
+ *  the structure instead of through named fields.  The record type must be
+ *  defined (RECDEF) before the first record is created.
+ ******************************************************************************/
+
+template <typename T>
+class TypedRecord: public RecordObject
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        explicit    TypedRecord     (int allocated_memory=0, bool clear=true);
+        virtual     ~TypedRecord    (void) {}
+
+        T*          data            (void) { return typedData; }
+        T*          operator->      (void) { return typedData; }
+
+        static T*   cast            (unsigned char* buffer, int size);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        T*          typedData;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static definition_t* definition (void);
+};
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <typename T>
+TypedRecord<T>::TypedRecord (int allocated_memory, bool clear):
+    RecordObject(definition(), allocated_memory, clear)
+{
+    typedData = (T*)recordData;
+}
+
+/*----------------------------------------------------------------------------
+ * cast
+ *
+ *  returns the data of a serialized record of this type without copying it,
+ *  or NULL if the buffer holds a different record or is too small
+ *----------------------------------------------------------------------------*/
+template <typename T>
+T* TypedRecord<T>::cast (unsigned char* buffer, int size)
+{
+    definition_t* def = definition();
+    if(buffer == NULL || size < def->record_size) return NULL;
+
+    const rec_hdr_t* hdr = (const rec_hdr_t*)buffer;
+    if(LocalLib::swaps(hdr->version) != RECORD_FORMAT_VERSION ||
+       LocalLib::swaps(hdr->type_size) != def->type_size ||
+       !StringLib::match((const char*)&buffer[sizeof(rec_hdr_t)], def->type_name))
+    {
+        return NULL;
+    }
+
+    return (T*)&buffer[sizeof(rec_hdr_t) + def->type_size];
+}
+
+/*----------------------------------------------------------------------------
+ * definition
+ *----------------------------------------------------------------------------*/
+template <typename T>
+RecordObject::definition_t* TypedRecord<T>::definition (void)
+{
+    static std::atomic<definition_t*> cached(NULL);
+
+    definition_t* def = cached.load(std::memory_order_acquire);
+    if(def == NULL)
+    {
+        def = getDefinition(RecordTraits<T>::type());
+        if(def == NULL)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "could not locate record definition %s", RecordTraits<T>::type());
+        }
+        cached.store(def, std::memory_order_release);
+    }
+
+    return def;
+}
+
 #endif  /* __record_object__ */
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "RecordPool.h"
+#include "OsApi.h"
+
+#include <stdlib.h>
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+RecordPool::size_class_t            RecordPool::classes[NUM_CLASSES];
+std::atomic<uintptr_t>              RecordPool::chunkTable[CHUNK_TABLE_SIZE];
+std::atomic<int>                    RecordPool::numChunks(0);
+std::atomic<long>                   RecordPool::heapAllocs(0);
+thread_local RecordPool::thread_cache_t RecordPool::localCache;
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * allocate
+ *
+ *  requests larger than the largest size class, or made once the pool has
+ *  reached MAX_CHUNKS, are served from the heap; when the thread cache of the
+ *  size class is empty it is refilled with a batch of blocks from the shared
+ *  free list, but a new chunk is only added for the block being returned
+ *----------------------------------------------------------------------------*/
+unsigned char* RecordPool::allocate(int size)
+{
+    int index = sizeClass(size);
+    if(index >= 0)
+    {
+        /* Take Block from Thread Cache */
+        thread_cache_t* cache = &localCache;
+        if(cache->free_list[index])
+        {
+            free_block_t* fb = cache->free_list[index];
+            cache->free_list[index] = fb->next;
+            cache->count[index]--;
+            return (unsigned char*)fb;
+        }
+
+        /* Refill Thread Cache from Size Class */
+        size_class_t* sc = &classes[index];
+        int batch = (cacheLimit(index) / 2) + 1;
+        unsigned char* block = NULL;
+
+        sc->mut.lock();
+        {
+            for(int b = 0; b < batch; b++)
+            {
+                unsigned char* next = NULL;
+                if(sc->free_list)
+                {
+                    next = (unsigned char*)sc->free_list;
+                    sc->free_list = sc->free_list->next;
+                    sc->stats.free_blocks--;
+                }
+                else if(sc->bump < sc->bump_end || (b == 0 && addChunk(sc, index)))
+                {
+                    next = sc->bump;
+                    sc->bump += 1 << (index + MIN_BLOCK_SHIFT);
+                }
+                else
+                {
+                    break;
+                }
+
+                sc->stats.allocs++;
+                sc->stats.in_use++;
+
+                if(block == NULL)
+                {
+                    block = next;
+                }
+                else
+                {
+                    free_block_t* fb = (free_block_t*)next;
+                    fb->next = cache->free_list[index];
+                    cache->free_list[index] = fb;
+                    cache->count[index]++;
+                }
+            }
+
+            if(sc->stats.in_use > sc->stats.high_water)
+            {
+                sc->stats.high_water = sc->stats.in_use;
+            }
+        }
+        sc->mut.unlock();
+
+        if(block) return block;
+    }
+
+    heapAllocs++;
+    return new unsigned char [size];
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *
+ *  safe to call on memory allocated with new [] outside of the pool; pool
+ *  blocks go to the thread cache of the calling thread, and once the cache
+ *  is over its limit half of it is returned to the shared free list
+ *----------------------------------------------------------------------------*/
+void RecordPool::release(void* block)
+{
+    if(block == NULL) return;
+
+    int index = chunkClass((uintptr_t)block & ~(uintptr_t)(CHUNK_SIZE - 1));
+    if(index < 0)
+    {
+        delete [] (unsigned char*)block;
+        return;
+    }
+
+    thread_cache_t* cache = &localCache;
+    free_block_t* fb = (free_block_t*)block;
+    fb->next = cache->free_list[index];
+    cache->free_list[index] = fb;
+    cache->count[index]++;
+
+    int limit = cacheLimit(index);
+    if(cache->count[index] > limit)
+    {
+        flush(cache, index, cache->count[index] - (limit / 2));
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * owns
+ *----------------------------------------------------------------------------*/
+bool RecordPool::owns(void* block)
+{
+    if(block == NULL) return false;
+    return chunkClass((uintptr_t)block & ~(uintptr_t)(CHUNK_SIZE - 1)) >= 0;
+}
+
+/*----------------------------------------------------------------------------
+ * getStats
+ *----------------------------------------------------------------------------*/
+void RecordPool::getStats(stats_t* stats)
+{
+    for(int i = 0; i < NUM_CLASSES; i++)
+    {
+        classes[i].mut.lock();
+        {
+            stats[i] = classes[i].stats;
+        }
+        classes[i].mut.unlock();
+        stats[i].block_size = 1 << (i + MIN_BLOCK_SHIFT);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * getHeapAllocs
+ *----------------------------------------------------------------------------*/
+long RecordPool::getHeapAllocs(void)
+{
+    return heapAllocs;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * thread_cache_t::Constructor
+ *----------------------------------------------------------------------------*/
+RecordPool::thread_cache_t::thread_cache_t(void)
+{
+    for(int i = 0; i < NUM_CLASSES; i++)
+    {
+        free_list[i] = NULL;
+        count[i] = 0;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * thread_cache_t::Destructor
+ *----------------------------------------------------------------------------*/
+RecordPool::thread_cache_t::~thread_cache_t(void)
+{
+    for(int i = 0; i < NUM_CLASSES; i++)
+    {
+        if(count[i] > 0) flush(this, i, count[i]);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * sizeClass
+ *----------------------------------------------------------------------------*/
+int RecordPool::sizeClass(int size)
+{
+    if(size <= 0 || size > MAX_BLOCK_SIZE) return -1;
+
+    int index = 0;
+    while((1 << (index + MIN_BLOCK_SHIFT)) < size) index++;
+    return index;
+}
+
+/*----------------------------------------------------------------------------
+ * chunkClass
+ *
+ *  lock-free lookup; entries are only ever added to the chunk table
+ *----------------------------------------------------------------------------*/
+int RecordPool::chunkClass(uintptr_t base)
+{
+    uint64_t slot = ((base / CHUNK_SIZE) * 0x9E3779B97F4A7C15ULL) % CHUNK_TABLE_SIZE;
+    for(int i = 0; i < CHUNK_TABLE_SIZE; i++)
+    {
+        uintptr_t entry = chunkTable[slot];
+        if(entry == 0) return -1;
+        if((entry & ~(uintptr_t)(CHUNK_SIZE - 1)) == base)
+        {
+            return (int)(entry & (CHUNK_SIZE - 1));
+        }
+        slot = (slot + 1) % CHUNK_TABLE_SIZE;
+    }
+    return -1;
+}
+
+/*----------------------------------------------------------------------------
+ * addChunk
+ *
+ *  called with the size class locked
+ *----------------------------------------------------------------------------*/
+bool RecordPool::addChunk(size_class_t* sc, int index)
+{
+    /* Check Pool Limit */
+    if(numChunks++ >= MAX_CHUNKS)
+    {
+        numChunks--;
+        return false;
+    }
+
+    /* Allocate Chunk Aligned to its Size */
+    unsigned char* chunk = (unsigned char*)aligned_alloc(CHUNK_SIZE, CHUNK_SIZE);
+    if(chunk == NULL)
+    {
+        numChunks--;
+        return false;
+    }
+
+    /* Register Chunk */
+    uintptr_t base = (uintptr_t)chunk;
+    uint64_t slot = ((base / CHUNK_SIZE) * 0x9E3779B97F4A7C15ULL) % CHUNK_TABLE_SIZE;
+    while(true)
+    {
+        uintptr_t empty = 0;
+        if(chunkTable[slot].compare_exchange_strong(empty, base | (uintptr_t)index)) break;
+        slot = (slot + 1) % CHUNK_TABLE_SIZE;
+    }
+
+    /* Carve Chunk */
+    sc->bump = chunk;
+    sc->bump_end = chunk + CHUNK_SIZE;
+    sc->stats.chunks++;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * cacheLimit
+ *
+ *  number of blocks a thread may keep cached for a size class; larger
+ *  classes keep fewer blocks so idle threads do not strand much memory
+ *----------------------------------------------------------------------------*/
+int RecordPool::cacheLimit(int index)
+{
+    int limit = MAX_CACHE_BYTES >> (index + MIN_BLOCK_SHIFT);
+    if(limit < 1) return 1;
+    if(limit > MAX_CACHE_BLOCKS) return MAX_CACHE_BLOCKS;
+    return limit;
+}
+
+/*----------------------------------------------------------------------------
+ * flush
+ *
+ *  moves blocks from a thread cache back onto the shared free list
+ *----------------------------------------------------------------------------*/
+void RecordPool::flush(thread_cache_t* cache, int index, int count)
+{
+    size_class_t* sc = &classes[index];
+    sc->mut.lock();
+    {
+        for(int b = 0; b < count && cache->free_list[index]; b++)
+        {
+            free_block_t* fb = cache->free_list[index];
+            cache->free_list[index] = fb->next;
+            cache->count[index]--;
+
+            fb->next = sc->free_list;
+            sc->free_list = fb;
+            sc->stats.free_blocks++;
+            sc->stats.in_use--;
+        }
+    }
+    sc->mut.unlock();
+}
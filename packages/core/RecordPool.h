@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __record_pool__
+#define __record_pool__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+#include <atomic>
+
+/******************************************************************************
+ * RECORD POOL CLASS
+ ******************************************************************************/
+
+/*
+ * Slab allocator for record memory.  Blocks are carved out of chunks that
+ * are aligned to their own size, so any pointer can be checked for pool
+ * membership without dereferencing it; this lets release() be used as the
+ * free function for memory that may or may not have come from the pool.
+ * Chunks are kept for the life of the process and recycled through a free
+ * list per size class.  Each thread keeps a small cache of blocks per size
+ * class in front of the shared free lists, and moves blocks to and from the
+ * shared lists in batches, so a thread producing records and a thread
+ * releasing them (through the MsgQ free function) only take the class lock
+ * once per batch.
+ */
+class RecordPool
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int MIN_BLOCK_SHIFT = 6;                           // 64 bytes
+        static const int MAX_BLOCK_SHIFT = 18;                          // 256KB
+        static const int NUM_CLASSES = MAX_BLOCK_SHIFT - MIN_BLOCK_SHIFT + 1;
+        static const int MAX_BLOCK_SIZE = 1 << MAX_BLOCK_SHIFT;
+        static const long CHUNK_SIZE = 0x100000;                        // 1MB
+        static const int MAX_CHUNKS = 4096;                             // 4GB
+        static const int CHUNK_TABLE_SIZE = MAX_CHUNKS * 2;
+        static const int MAX_CACHE_BLOCKS = 32;                         // per thread per size class
+        static const int MAX_CACHE_BYTES = 0x40000;                     // 256KB per thread per size class
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            int         block_size;     // size of each block in class
+            long        in_use;         // blocks currently allocated (includes blocks in thread caches)
+            long        high_water;     // maximum blocks allocated at once
+            long        free_blocks;    // blocks on the free list
+            long        chunks;         // chunks carved into blocks of this class
+            long        allocs;         // total blocks handed out to threads
+        } stats_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static unsigned char*   allocate    (int size);
+        static void             release     (void* block);
+        static bool             owns        (void* block);
+        static void             getStats    (stats_t* stats); // stats[NUM_CLASSES]
+        static long             getHeapAllocs (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef struct free_block_s {
+            struct free_block_s* next;
+        } free_block_t;
+
+        typedef struct {
+            Mutex           mut;
+            free_block_t*   free_list;
+            unsigned char*  bump;       // next unused block in current chunk
+            unsigned char*  bump_end;   // end of current chunk
+            stats_t         stats;
+        } size_class_t;
+
+        struct thread_cache_t {
+            free_block_t*   free_list[NUM_CLASSES];
+            int             count[NUM_CLASSES];
+                            thread_cache_t  (void);
+                            ~thread_cache_t (void);  // returns blocks to shared free lists on thread exit
+        };
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static size_class_t             classes[NUM_CLASSES];
+        static std::atomic<uintptr_t>   chunkTable[CHUNK_TABLE_SIZE];   // chunk base | class index
+        static std::atomic<int>         numChunks;
+        static std::atomic<long>        heapAllocs;
+        static thread_local thread_cache_t localCache;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static int      sizeClass   (int size);
+        static int      chunkClass  (uintptr_t base);
+        static bool     addChunk    (size_class_t* sc, int index);
+        static int      cacheLimit  (int index);
+        static void     flush       (thread_cache_t* cache, int index, int count);
+};
+
+#endif  /* __record_pool__ */
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "ReplayIODriver.h"
+#include "OsApi.h"
+#include "Asset.h"
+#include "LuaObject.h"
+#include "TimeLib.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* ReplayIODriver::FORMAT = "replay";
+
+std::atomic<double>  ReplayIODriver::latency(0.0);
+std::atomic<double>  ReplayIODriver::bandwidth(0.0);
+std::atomic<int64_t> ReplayIODriver::statRequests(0);
+std::atomic<int64_t> ReplayIODriver::statBytes(0);
+std::atomic<int64_t> ReplayIODriver::statDelayUs(0);
+
+/******************************************************************************
+ * REPLAY IO DRIVER CLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * create
+ *----------------------------------------------------------------------------*/
+Asset::IODriver* ReplayIODriver::create (const Asset* _asset, const char* resource)
+{
+    return new ReplayIODriver(_asset, resource);
+}
+
+/*----------------------------------------------------------------------------
+ * ioRead
+ *
+ *  the request takes at least as long as the configured latency plus the
+ *  time to transfer the bytes read at the configured bandwidth
+ *----------------------------------------------------------------------------*/
+int64_t ReplayIODriver::ioRead (uint8_t* data, int64_t size, uint64_t pos)
+{
+    double start = TimeLib::latchtime();
+
+    /* Seek to New Position */
+    if(fseek(ioFile, pos, SEEK_SET) != 0)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to go to I/O position: 0x%lx", pos);
+    }
+
+    /* Read Data */
+    int64_t bytes = fread(data, 1, size, ioFile);
+
+    /* Inject Delay */
+    double transfer = latency.load();
+    double rate = bandwidth.load();
+    if(rate > 0.0 && bytes > 0) transfer += bytes / rate;
+    double remaining = transfer - (TimeLib::latchtime() - start);
+    if(remaining > 0.0)
+    {
+        LocalLib::sleep(remaining);
+        statDelayUs += (int64_t)(remaining * 1000000.0);
+    }
+
+    /* Update Statistics */
+    statRequests++;
+    if(bytes > 0) statBytes += bytes;
+
+    return bytes;
+}
+
+/*----------------------------------------------------------------------------
+ * luaConfig - replay([<latency ms>], [<bandwidth MB/s>])
+ *
+ *  returns the latency and bandwidth in effect; a bandwidth of zero is
+ *  unlimited
+ *----------------------------------------------------------------------------*/
+int ReplayIODriver::luaConfig (lua_State* L)
+{
+    try
+    {
+        bool latency_provided = false;
+        bool bandwidth_provided = false;
+        double latency_ms = LuaObject::getLuaFloat(L, 1, true, 0.0, &latency_provided);
+        double bandwidth_mbps = LuaObject::getLuaFloat(L, 2, true, 0.0, &bandwidth_provided);
+
+        if(latency_provided) latency = latency_ms / 1000.0;
+        if(bandwidth_provided) bandwidth = bandwidth_mbps * 1000000.0;
+
+        lua_pushnumber(L, latency.load() * 1000.0);
+        lua_pushnumber(L, bandwidth.load() / 1000000.0);
+        return 2;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error configuring replay driver: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * luaStats - replaystats([<reset>])
+ *----------------------------------------------------------------------------*/
+int ReplayIODriver::luaStats (lua_State* L)
+{
+    try
+    {
+        bool reset = LuaObject::getLuaBoolean(L, 1, true, false);
+
+        lua_newtable(L);
+        LuaEngine::setAttrNum(L, "requests", statRequests.load());
+        LuaEngine::setAttrNum(L, "bytes", statBytes.load());
+        LuaEngine::setAttrNum(L, "delay", statDelayUs.load() / 1000000.0);
+
+        if(reset)
+        {
+            statRequests = 0;
+            statBytes = 0;
+            statDelayUs = 0;
+        }
+
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error getting replay driver statistics: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+ReplayIODriver::ReplayIODriver (const Asset* _asset, const char* resource):
+    asset(_asset)
+{
+    SafeString filepath("%s/%s", asset->getPath(), resource);
+    ioFile = fopen(filepath.getString(), "r");
+    if(ioFile == NULL)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open recorded resource %s", filepath.getString());
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+ReplayIODriver::~ReplayIODriver (void)
+{
+    if(ioFile) fclose(ioFile);
+    ioFile = NULL;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __replay_io_driver__
+#define __replay_io_driver__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+#include "Asset.h"
+#include "LuaEngine.h"
+
+#include <atomic>
+
+/******************************************************************************
+ * REPLAY IO DRIVER CLASS
+ *
+ *  Serves resources from local copies of recorded granules while imposing
+ *  a configurable latency and bandwidth on every read, so that pipelines
+ *  can be measured against object storage like behavior without its
+ *  variance
+ ******************************************************************************/
+
+class ReplayIODriver: Asset::IODriver
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const char* FORMAT;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static IODriver*    create      (const Asset* _asset, const char* resource);
+        int64_t             ioRead      (uint8_t* data, int64_t size, uint64_t pos);
+
+        static int          luaConfig   (lua_State* L);
+        static int          luaStats    (lua_State* L);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        ReplayIODriver (const Asset* _asset, const char* resource);
+        ~ReplayIODriver (void);
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static std::atomic<double>  latency;        // seconds per request
+        static std::atomic<double>  bandwidth;      // bytes per second per request, zero is unlimited
+        static std::atomic<int64_t> statRequests;
+        static std::atomic<int64_t> statBytes;
+        static std::atomic<int64_t> statDelayUs;    // time spent in injected delays
+
+        const Asset*    asset;
+        fileptr_t       ioFile;
+};
+
+#endif  /* __replay_io_driver__ */
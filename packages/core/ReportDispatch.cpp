@@ -182,6 +182,17 @@ ReportDispatch::ReportFile::ReportFile(lua_State* L, const char* _filename, form
 {
     headerInProgress = false;
     indexDisplay = INT_DISPLAY;
+    block = new char [BLOCK_SIZE];
+    blockLen = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor - ReportFile
+ *----------------------------------------------------------------------------*/
+ReportDispatch::ReportFile::~ReportFile(void)
+{
+    flushBlock();
+    delete [] block;
 }
 
 /*----------------------------------------------------------------------------
@@ -225,7 +236,7 @@ int ReportDispatch::ReportFile::writeFileData (void)
         char index_str[MAX_INDEX_STR_SIZE];
         if(indexDisplay == ReportDispatch::INT_DISPLAY)
         {
-            StringLib::format(index_str, MAX_INDEX_STR_SIZE, "%llu", (unsigned long long)index);
+            StringLib::ulong2str(index_str, MAX_INDEX_STR_SIZE, (unsigned long long)index);
         }
         else if(indexDisplay == ReportDispatch::GMT_DISPLAY)
         {
@@ -237,51 +248,78 @@ int ReportDispatch::ReportFile::writeFileData (void)
             index_str[0] = '\0';
         }
 
-        /* Build Row String and Clear Values */
-        SafeString row;
-        row += index_str;
+        /* Append Row and Clear Values */
+        bool status = append(index_str, StringLib::size(index_str, MAX_INDEX_STR_SIZE));
         const char* value = NULL;
         const char* column = values.first(&value);
         while(column)
         {
-            row += ",";
-            if(value)   row += value;
+            status = append(",", 1) && status;
+            if(value) status = append(value, StringLib::size(value)) && status;
             const char* space = StringLib::duplicate(REPORT_SPACE);
             values.add(column, space);
             column = values.next(&value);
         }
-        row += "\n";
+        status = append("\n", 1) && status;
 
-        /* Write Row String */
-        return File::writeBuffer(row.getString(false), row.getLength() - 1);       // SafeString includes null terminator in length
+        return status ? 1 : -1;
     }
     else if(format == JSON)
     {
-        /* Build JSON String */
-        SafeString json("{\n");
+        /* Append JSON Object and Clear Values */
+        bool status = append("{\n", 2);
         const char* value = NULL;
         const char* column = values.first(&value);
         while(column)
         {
-            json += "\t\"";
-            json += column;
-            json += "\": \"";
-            if(value) json += value;
-            json += "\"";
+            status = append("\t\"", 2) && status;
+            status = append(column, StringLib::size(column)) && status;
+            status = append("\": \"", 4) && status;
+            if(value) status = append(value, StringLib::size(value)) && status;
+            status = append("\"", 1) && status;
             const char* space = StringLib::duplicate(REPORT_SPACE);
             values.add(column, space);
             column = values.next(&value);
-            if(column)  json += ",\n";
-            else        json += "\n}";
+            if(column)  status = append(",\n", 2) && status;
+            else        status = append("\n}", 2) && status;
         }
 
-        /* Write Row String */
-        return File::writeBuffer(json.getString(false), json.getLength() - 1);     // SafeString includes null terminator in length
+        return status ? 1 : -1;
     }
 
     return 0;
 }
 
+/*----------------------------------------------------------------------------
+ * flushBlock
+ *
+ *  writes out rows accumulated by writeFileData; must precede any direct
+ *  write to the file (e.g. the header) to keep rows in order
+ *----------------------------------------------------------------------------*/
+int ReportDispatch::ReportFile::flushBlock (void)
+{
+    if(blockLen == 0) return 0;
+    int status = File::writeBuffer(block, blockLen);
+    blockLen = 0;
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * append
+ *----------------------------------------------------------------------------*/
+bool ReportDispatch::ReportFile::append (const char* str, int len)
+{
+    if(blockLen + len > BLOCK_SIZE)
+    {
+        if(flushBlock() < 0) return false;
+        if(len > BLOCK_SIZE) return File::writeBuffer(str, len) >= 0;
+    }
+
+    LocalLib::copy(&block[blockLen], str, len);
+    blockLen += len;
+    return true;
+}
+
 /******************************************************************************
  * PRIVATE METHODS - REPORT DISAPTCH
  *******************************************************************************/
@@ -372,6 +410,34 @@ bool ReportDispatch::processRecord (RecordObject* record, okey_t key)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * processTimeout
+ *----------------------------------------------------------------------------*/
+bool ReportDispatch::processTimeout (void)
+{
+    reportMut.lock();
+    {
+        report.flushBlock();
+    }
+    reportMut.unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processTermination
+ *----------------------------------------------------------------------------*/
+bool ReportDispatch::processTermination (void)
+{
+    reportMut.lock();
+    {
+        report.flushBlock();
+    }
+    reportMut.unlock();
+
+    return true;
+}
+
 /*----------------------------------------------------------------------------
  * postEntry
  *
@@ -433,6 +499,7 @@ bool ReportDispatch::flushRow(void)
     if(writeHeader)
     {
         writeHeader = false;
+        report.flushBlock();
         int hdr_written = report.writeFileHeader();
         if(hdr_written < 0)
         {
@@ -522,6 +589,7 @@ int ReportDispatch::luaFlushRow(lua_State* L)
             if(flush_all && lua_obj->entries) lua_obj->entries->flush();
             lua_obj->flushRow();
             lua_obj->lastIndex = INVALID_KEY;
+            lua_obj->report.flushBlock();
         }
         lua_obj->reportMut.unlock();
 
@@ -118,15 +118,25 @@ class ReportDispatch: public DispatchObject
             public:
 
                         ReportFile          (lua_State* L, const char* _filename, format_t _format);
+                        ~ReportFile         (void);
                 int     writeFileHeader     (void); // overload
                 int     writeFileData       (void);
+                int     flushBlock          (void);
 
                 static const int            MAX_INDEX_STR_SIZE = 256;
+                static const int            BLOCK_SIZE = 0x10000;
                 format_t                    format;
                 MgDictionary<const char*, true> values; // indexed by data point names
                 okey_t                      index;
                 bool                        headerInProgress;
                 indexDisplay_t              indexDisplay;
+
+            private:
+
+                bool    append              (const char* str, int len);
+
+                char*                       block; // rows are written to the file a block at a time
+                int                         blockLen;
         };
 
         /*--------------------------------------------------------------------
@@ -153,6 +163,8 @@ class ReportDispatch: public DispatchObject
 
         /* overridden methods */
         virtual bool    processRecord       (RecordObject* record, okey_t key);
+        virtual bool    processTimeout      (void);
+        virtual bool    processTermination  (void);
 
         /* lua functions */
         static int      luaSetIndexDisplay  (lua_State* L);
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "RequestAccount.h"
+#include "OsApi.h"
+#include "EventLib.h"
+#include "StringLib.h"
+
+#include <time.h>
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* RequestAccount::METRIC_CATEGORY = "request";
+const char* RequestAccount::COUNTER_NAMES[NUM_COUNTERS] = {
+    "cpu_ns",
+    "s3_bytes",
+    "s3_requests",
+    "cache_hits",
+    "cache_misses",
+    "rspq_peak_bytes",
+    "rspq_spill_bytes"
+};
+
+int32_t RequestAccount::metricIds[NUM_COUNTERS];
+thread_local RequestAccount* RequestAccount::localAccount = NULL;
+thread_local int64_t RequestAccount::localStart = 0;
+thread_local bool RequestAccount::localCancellable = true;
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void RequestAccount::init (void)
+{
+    for(int i = 0; i < NUM_COUNTERS; i++)
+    {
+        EventLib::subtype_t subtype = (i == RSPQ_PEAK_BYTES) ? EventLib::GAUGE : EventLib::COUNTER;
+        metricIds[i] = EventLib::registerMetric(METRIC_CATEGORY, subtype, "%s", COUNTER_NAMES[i]);
+        if(metricIds[i] == EventLib::INVALID_METRIC)
+        {
+            mlog(ERROR, "Registry failed for %s.%s", METRIC_CATEGORY, COUNTER_NAMES[i]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * open
+ *
+ *  trace ids are not unique to a request when tracing is filtered, so the
+ *  account is never looked up by it; it is only carried for reporting
+ *----------------------------------------------------------------------------*/
+RequestAccount* RequestAccount::open (uint32_t trace_id)
+{
+    return new RequestAccount(trace_id);
+}
+
+/*----------------------------------------------------------------------------
+ * share
+ *
+ *  used by objects that hand work to their own threads, so that the work is
+ *  charged to the request that created them
+ *----------------------------------------------------------------------------*/
+RequestAccount* RequestAccount::share (void)
+{
+    RequestAccount* account = localAccount;
+    if(account) account->refs++;
+    return account;
+}
+
+/*----------------------------------------------------------------------------
+ * attach
+ *
+ *  the cpu time of the calling thread up to this point is charged to the
+ *  account it was previously attached to
+ *----------------------------------------------------------------------------*/
+RequestAccount* RequestAccount::attach (RequestAccount* account)
+{
+    RequestAccount* previous = localAccount;
+    int64_t now = threadCpuTime();
+    if(previous) previous->counters[CPU_NS] += now - localStart;
+    localAccount = account;
+    localStart = now;
+    return previous;
+}
+
+/*----------------------------------------------------------------------------
+ * detach
+ *----------------------------------------------------------------------------*/
+void RequestAccount::detach (RequestAccount* previous)
+{
+    attach(previous);
+}
+
+/*----------------------------------------------------------------------------
+ * count
+ *----------------------------------------------------------------------------*/
+void RequestAccount::count (counter_t counter, int64_t value)
+{
+    RequestAccount* account = localAccount;
+    if(account) account->counters[counter] += value;
+}
+
+/*----------------------------------------------------------------------------
+ * cancelled
+ *----------------------------------------------------------------------------*/
+bool RequestAccount::cancelled (void)
+{
+    RequestAccount* account = localAccount;
+    return localCancellable && account && account->cancelFlag.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+ * cancellable
+ *
+ *  work the calling thread does on behalf of other requests as well as its
+ *  own (e.g. a read shared between requests) is charged to its account but
+ *  must not stop when that account alone is cancelled
+ *----------------------------------------------------------------------------*/
+bool RequestAccount::cancellable (void)
+{
+    return localCancellable;
+}
+
+/*----------------------------------------------------------------------------
+ * cancellable
+ *----------------------------------------------------------------------------*/
+bool RequestAccount::cancellable (bool enable)
+{
+    bool previous = localCancellable;
+    localCancellable = enable;
+    return previous;
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *----------------------------------------------------------------------------*/
+void RequestAccount::release (void)
+{
+    if(--refs == 0)
+    {
+        delete this;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * cancel
+ *
+ *  safe to call from any thread, including while a queue is locked
+ *----------------------------------------------------------------------------*/
+void RequestAccount::cancel (void)
+{
+    cancelFlag.store(true, std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+ * isCancelled
+ *----------------------------------------------------------------------------*/
+bool RequestAccount::isCancelled (void)
+{
+    return cancelFlag.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------
+ * peak
+ *----------------------------------------------------------------------------*/
+void RequestAccount::peak (counter_t counter, int64_t value)
+{
+    int64_t current = counters[counter];
+    while(value > current && !counters[counter].compare_exchange_weak(current, value));
+}
+
+/*----------------------------------------------------------------------------
+ * value
+ *----------------------------------------------------------------------------*/
+int64_t RequestAccount::value (counter_t counter)
+{
+    return counters[counter];
+}
+
+/*----------------------------------------------------------------------------
+ * getTraceId
+ *----------------------------------------------------------------------------*/
+uint32_t RequestAccount::getTraceId (void)
+{
+    return traceId;
+}
+
+/*----------------------------------------------------------------------------
+ * report
+ *
+ *  adds the account to the request metrics; the cpu time of a thread still
+ *  attached is charged when it detaches and is reported by then
+ *----------------------------------------------------------------------------*/
+void RequestAccount::report (void)
+{
+    for(int i = 0; i < NUM_COUNTERS; i++)
+    {
+        if(metricIds[i] == EventLib::INVALID_METRIC) continue;
+        if(i == RSPQ_PEAK_BYTES)    EventLib::updateMetric(metricIds[i], (double)counters[i]);
+        else                        EventLib::incrementMetric(metricIds[i], (double)counters[i]);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * toJson
+ *----------------------------------------------------------------------------*/
+int RequestAccount::toJson (char* buffer, int size)
+{
+    return StringLib::formats(buffer, size, "{\"%s\":%ld,\"%s\":%ld,\"%s\":%ld,\"%s\":%ld,\"%s\":%ld,\"%s\":%ld,\"%s\":%ld}",
+                                COUNTER_NAMES[CPU_NS],          (long)counters[CPU_NS],
+                                COUNTER_NAMES[S3_BYTES],        (long)counters[S3_BYTES],
+                                COUNTER_NAMES[S3_REQUESTS],     (long)counters[S3_REQUESTS],
+                                COUNTER_NAMES[CACHE_HITS],      (long)counters[CACHE_HITS],
+                                COUNTER_NAMES[CACHE_MISSES],    (long)counters[CACHE_MISSES],
+                                COUNTER_NAMES[RSPQ_PEAK_BYTES], (long)counters[RSPQ_PEAK_BYTES],
+                                COUNTER_NAMES[RSPQ_SPILL_BYTES],(long)counters[RSPQ_SPILL_BYTES]);
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+RequestAccount::RequestAccount (uint32_t trace_id):
+    traceId(trace_id),
+    refs(1),
+    cancelFlag(false)
+{
+    for(int i = 0; i < NUM_COUNTERS; i++)
+    {
+        counters[i] = 0;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+RequestAccount::~RequestAccount (void)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * threadCpuTime
+ *----------------------------------------------------------------------------*/
+int64_t RequestAccount::threadCpuTime (void)
+{
+    struct timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return ((int64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __request_account__
+#define __request_account__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+#include <atomic>
+
+/******************************************************************************
+ * REQUEST ACCOUNT CLASS
+ *
+ *  Resources consumed on behalf of a single request.  An account is opened by
+ *  the endpoint for the trace id it hands to the lua engine, and every thread
+ *  doing work for the request attaches to it; counts made through
+ *  RequestAccount::count are charged to the account attached to the calling
+ *  thread, and are dropped when there is none.  Work handed to another thread
+ *  carries a shared reference to the account along with it.
+ *
+ *  An account is cancelled when the client of its request goes away; work
+ *  for the request checks the account it carries and stops early.
+ ******************************************************************************/
+
+class RequestAccount
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            CPU_NS          = 0,    // thread cpu time of attached threads
+            S3_BYTES        = 1,    // bytes read from S3
+            S3_REQUESTS     = 2,    // reads issued to S3
+            CACHE_HITS      = 3,    // h5coro reads served from a cache
+            CACHE_MISSES    = 4,    // h5coro reads that went to the driver
+            RSPQ_PEAK_BYTES = 5,    // most data queued on the response at once
+            RSPQ_SPILL_BYTES= 6,    // response data spilled to disk past the ceiling
+            NUM_COUNTERS    = 7
+        } counter_t;
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const char* METRIC_CATEGORY;
+        static const char* COUNTER_NAMES[NUM_COUNTERS];
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void             init        (void);
+
+        static RequestAccount*  open        (uint32_t trace_id);
+        static RequestAccount*  share       (void); // returns referenced account of calling thread or NULL
+        static RequestAccount*  attach      (RequestAccount* account); // returns account previously attached
+        static void             detach      (RequestAccount* previous);
+        static void             count       (counter_t counter, int64_t value=1);
+        static bool             cancelled   (void); // whether account of calling thread is cancelled
+        static bool             cancellable (void); // whether work of calling thread stops with its account
+        static bool             cancellable (bool enable); // returns previous setting
+
+        void                    release     (void); // pairs with open(..) and share(..)
+        void                    cancel      (void);
+        bool                    isCancelled (void);
+        void                    peak        (counter_t counter, int64_t value);
+        int64_t                 value       (counter_t counter);
+        uint32_t                getTraceId  (void);
+        void                    report      (void);
+        int                     toJson      (char* buffer, int size);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static int32_t                          metricIds[NUM_COUNTERS];
+        static thread_local RequestAccount*     localAccount;
+        static thread_local int64_t             localStart; // thread cpu time when attached
+        static thread_local bool                localCancellable;
+
+        uint32_t                    traceId;
+        std::atomic<int>            refs;
+        std::atomic<bool>           cancelFlag;
+        std::atomic<int64_t>        counters[NUM_COUNTERS];
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                                RequestAccount  (uint32_t trace_id);
+                                ~RequestAccount (void);
+
+        static int64_t          threadCpuTime   (void);
+};
+
+#endif  /* __request_account__ */
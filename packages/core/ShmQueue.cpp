@@ -0,0 +1,546 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <string.h>
+
+#include "ShmQueue.h"
+#include "OsApi.h"
+#include "StringLib.h"
+#include "EventLib.h"
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * shmFutex - shared (not private) futex so that waiters in other processes
+ *            mapping the segment are woken
+ *----------------------------------------------------------------------------*/
+static long shmFutex (std::atomic<uint32_t>* addr, int op, uint32_t val, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), op, val, timeout, NULL, 0);
+}
+
+/******************************************************************************
+ * SHARED MEMORY QUEUE CLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * luaCreate - shmq(<role>, <name>, [<ring size>])
+ *
+ *  <role> is either core.READER or core.WRITER
+ *
+ *  <name> identifies the segment; the first device to attach to a name
+ *  creates it and the last to close removes it
+ *
+ *  <ring size> is the number of bytes of messages the ring holds, rounded up
+ *  to a power of two; it is only used by the device that creates the segment
+ *----------------------------------------------------------------------------*/
+int ShmQueue::luaCreate (lua_State* L)
+{
+    try
+    {
+        /* Get Parameters */
+        int         role      = (int)getLuaInteger(L, 1);
+        const char* name_str  = getLuaString(L, 2);
+        long        ring_size = getLuaInteger(L, 3, true, DEFAULT_RING_SIZE);
+
+        /* Check Parameters */
+        if(role != ShmQueue::READER && role != ShmQueue::WRITER)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unrecognized shared memory queue role specified: %d", role);
+        }
+        if(name_str[0] == '\0' || StringLib::size(name_str) >= NAME_MAX_CHARS || StringLib::find(name_str, '/'))
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid shared memory queue name: %s", name_str);
+        }
+
+        /* Return Shared Memory Queue Device Object */
+        return createLuaObject(L, new ShmQueue(L, name_str, (ShmQueue::role_t)role, ring_size));
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error creating ShmQueue: %s", e.what());
+        return returnLuaStatus(L, false);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+ShmQueue::ShmQueue (lua_State* L, const char* _name, role_t _role, long ring_size):
+    DeviceObject(L, _role)
+{
+    assert(_name);
+
+    name = StringLib::duplicate(_name);
+    fd = INVALID_RC;
+    map = NULL;
+    mapSize = 0;
+    ring = NULL;
+    data = NULL;
+    mask = 0;
+    connected = false;
+    writerSeen = false;
+    pendingTail = 0;
+
+    /* Build Names */
+    char buf[NAME_MAX_CHARS + 64];
+    shmName = StringLib::duplicate(StringLib::format(buf, sizeof(buf), "/sliderule.%s", name));
+
+    /* Round Ring Size to Power of Two */
+    uint64_t size = MIN_RING_SIZE;
+    while((long)size < ring_size) size <<= 1;
+
+    /* Create or Open Segment */
+    bool creator = false;
+    fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, 0660);
+    if(fd >= 0)
+    {
+        creator = true;
+        if(ftruncate(fd, DATA_OFFSET + size) != 0)
+        {
+            mlog(CRITICAL, "Failed to size shared memory segment %s: %s", shmName, LocalLib::err2str(errno));
+            shm_unlink(shmName);
+            ::close(fd);
+            fd = INVALID_RC;
+        }
+    }
+    else if(errno == EEXIST)
+    {
+        fd = shm_open(shmName, O_RDWR, 0);
+        if(fd < 0) mlog(CRITICAL, "Failed to open shared memory segment %s: %s", shmName, LocalLib::err2str(errno));
+    }
+    else
+    {
+        mlog(CRITICAL, "Failed to create shared memory segment %s: %s", shmName, LocalLib::err2str(errno));
+    }
+
+    /* Wait for Creator to Size Segment */
+    int waited_ms = 0;
+    while(fd >= 0)
+    {
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size > DATA_OFFSET)
+        {
+            mapSize = st.st_size;
+            break;
+        }
+        else if(waited_ms >= ATTACH_TIMEOUT_MS)
+        {
+            mlog(CRITICAL, "Timed out waiting for shared memory segment %s to be created", shmName);
+            ::close(fd);
+            fd = INVALID_RC;
+        }
+        else
+        {
+            LocalLib::sleep(0.01);
+            waited_ms += 10;
+        }
+    }
+
+    /* Map Segment */
+    if(fd >= 0)
+    {
+        void* addr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(addr != MAP_FAILED)
+        {
+            map = (uint8_t*)addr;
+            ring = (ring_t*)map;
+            data = map + DATA_OFFSET;
+        }
+        else
+        {
+            mlog(CRITICAL, "Failed to map shared memory segment %s: %s", shmName, LocalLib::err2str(errno));
+            ::close(fd);
+            fd = INVALID_RC;
+        }
+    }
+
+    /* Initialize or Validate Header */
+    if(ring)
+    {
+        if(creator)
+        {
+            /* ftruncate zero fills the header */
+            ring->size = size;
+            ring->magic.store(RING_MAGIC, std::memory_order_release);
+        }
+        else
+        {
+            while(ring->magic.load(std::memory_order_acquire) != RING_MAGIC && waited_ms < ATTACH_TIMEOUT_MS)
+            {
+                LocalLib::sleep(0.01);
+                waited_ms += 10;
+            }
+        }
+
+        if(ring->magic.load(std::memory_order_acquire) == RING_MAGIC &&
+           (long)(DATA_OFFSET + ring->size) <= mapSize)
+        {
+            mask = ring->size - 1;
+            ring->attached++;
+            std::atomic<uint32_t>& count = (role == READER) ? ring->readers : ring->writers;
+            if(count.fetch_add(1) == 0)
+            {
+                connected = true;
+            }
+            else
+            {
+                count--;
+                mlog(CRITICAL, "Shared memory queue %s already has a %s", name, role == READER ? "reader" : "writer");
+            }
+        }
+        else
+        {
+            mlog(CRITICAL, "Shared memory segment %s is not a valid queue", shmName);
+            ring->attached++;
+        }
+    }
+
+    /* Build Configuration */
+    config = StringLib::duplicate(StringLib::format(buf, sizeof(buf), "%s(%s,%ld)", name, role == READER ? "READER" : "WRITER", ring ? (long)ring->size : 0L));
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+ShmQueue::~ShmQueue (void)
+{
+    closeConnection();
+    delete [] name;
+    delete [] shmName;
+    delete [] config;
+}
+
+/*----------------------------------------------------------------------------
+ * isConnected
+ *----------------------------------------------------------------------------*/
+bool ShmQueue::isConnected (int num_connections)
+{
+    if(!connected) return false;
+    return (int)(ring->readers.load() + ring->writers.load()) >= num_connections;
+}
+
+/*----------------------------------------------------------------------------
+ * closeConnection
+ *----------------------------------------------------------------------------*/
+void ShmQueue::closeConnection (void)
+{
+    if(ring)
+    {
+        /* Detach and Wake Peer */
+        if(connected)
+        {
+            connected = false;
+            if(role == READER)
+            {
+                release();
+                ring->readers--;
+                wake(&ring->tail_seq, &ring->writer_waiting);
+            }
+            else
+            {
+                ring->writers--;
+                wake(&ring->head_seq, &ring->reader_waiting);
+            }
+        }
+
+        /* Remove Segment When Last to Leave */
+        if(ring->attached.fetch_sub(1) == 1)
+        {
+            shm_unlink(shmName);
+        }
+
+        munmap(map, mapSize);
+        map = NULL;
+        ring = NULL;
+        data = NULL;
+    }
+
+    if(fd >= 0)
+    {
+        ::close(fd);
+        fd = INVALID_RC;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * writeBuffer
+ *----------------------------------------------------------------------------*/
+int ShmQueue::writeBuffer (const void* buf, int len, int timeout)
+{
+    if(!connected || role != WRITER) return INVALID_RC;
+    if(buf == NULL || len <= 0) return TIMEOUT_RC;
+    if(frameSize(len) > (ring->size / 2)) return BUFF_ERR_RC;
+
+    for(int attempt = 0; attempt < 2; attempt++)
+    {
+        uint32_t seq = ring->tail_seq.load();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        if(reserve(buf, len, &head))
+        {
+            publish(head);
+            return len;
+        }
+        else if(attempt > 0 || !waitOn(&ring->tail_seq, seq, &ring->writer_waiting, timeout))
+        {
+            break;
+        }
+    }
+
+    return TIMEOUT_RC;
+}
+
+/*----------------------------------------------------------------------------
+ * readBuffer
+ *----------------------------------------------------------------------------*/
+int ShmQueue::readBuffer (void* buf, int len, int timeout)
+{
+    const void* ref = NULL;
+    int bytes = readRef(&ref, len, timeout);
+    if(bytes > 0)
+    {
+        memcpy(buf, ref, bytes);
+        release();
+    }
+    return bytes;
+}
+
+/*----------------------------------------------------------------------------
+ * readRef - message is valid until the next read
+ *----------------------------------------------------------------------------*/
+int ShmQueue::readRef (const void** buf, int len, int timeout)
+{
+    if(!connected || role != READER) return INVALID_RC;
+
+    /* Free Previous Message */
+    release();
+
+    /* Wait for Message */
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint32_t seq = ring->head_seq.load();
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if(head == tail)
+    {
+        if(ring->writers.load() > 0)    writerSeen = true;
+        else if(writerSeen)             return SHUTDOWN_RC;
+
+        if(!waitOn(&ring->head_seq, seq, &ring->reader_waiting, timeout)) return TIMEOUT_RC;
+        head = ring->head.load(std::memory_order_acquire);
+        if(head == tail) return TIMEOUT_RC;
+    }
+
+    /* Skip to Start of Ring */
+    uint32_t msg_len = *(uint32_t*)(data + (tail & mask));
+    if(msg_len == WRAP_MARKER)
+    {
+        tail += ring->size - (tail & mask);
+        msg_len = *(uint32_t*)data;
+    }
+
+    /* Return Message */
+    uint64_t next_tail = tail + frameSize(msg_len);
+    if((int)msg_len > len)
+    {
+        pendingTail = next_tail;
+        release();
+        return BUFF_ERR_RC;
+    }
+
+    *buf = data + (tail & mask) + sizeof(uint32_t);
+    pendingTail = next_tail;
+    return msg_len;
+}
+
+/*----------------------------------------------------------------------------
+ * writeBatch - publishes as many messages as fit in one update of the head
+ *----------------------------------------------------------------------------*/
+int ShmQueue::writeBatch (const void** bufs, const int* lens, int n, int timeout)
+{
+    if(!connected || role != WRITER) return INVALID_RC;
+    if(n <= 0) return TIMEOUT_RC;
+
+    for(int attempt = 0; attempt < 2; attempt++)
+    {
+        uint32_t seq = ring->tail_seq.load();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        int count = 0;
+        while(count < n)
+        {
+            if(lens[count] <= 0 || frameSize(lens[count]) > (ring->size / 2))
+            {
+                if(count == 0) return BUFF_ERR_RC; // caller sends message on its own
+                break;
+            }
+            if(!reserve(bufs[count], lens[count], &head)) break;
+            count++;
+        }
+
+        if(count > 0)
+        {
+            publish(head);
+            return count;
+        }
+        else if(attempt > 0 || !waitOn(&ring->tail_seq, seq, &ring->writer_waiting, timeout))
+        {
+            break;
+        }
+    }
+
+    return TIMEOUT_RC;
+}
+
+/*----------------------------------------------------------------------------
+ * getUniqueId
+ *----------------------------------------------------------------------------*/
+int ShmQueue::getUniqueId (void)
+{
+    return fd;
+}
+
+/*----------------------------------------------------------------------------
+ * getConfig
+ *----------------------------------------------------------------------------*/
+const char* ShmQueue::getConfig (void)
+{
+    return config;
+}
+
+/*----------------------------------------------------------------------------
+ * reserve - copies message into ring at head, advancing head past it;
+ *           returns false if there is not room (head is left unchanged)
+ *----------------------------------------------------------------------------*/
+bool ShmQueue::reserve (const void* buf, int len, uint64_t* head)
+{
+    uint64_t pos = *head;
+    uint64_t offset = pos & mask;
+    uint64_t frame = frameSize(len);
+    uint64_t contiguous = ring->size - offset;
+    uint64_t needed = (frame > contiguous) ? contiguous + frame : frame;
+    uint64_t used = pos - ring->tail.load(std::memory_order_acquire);
+    if(used + needed > ring->size) return false;
+
+    /* Wrap to Start of Ring - frames are 8 byte aligned so the marker always fits */
+    if(frame > contiguous)
+    {
+        *(uint32_t*)(data + offset) = WRAP_MARKER;
+        pos += contiguous;
+        offset = 0;
+    }
+
+    *(uint32_t*)(data + offset) = (uint32_t)len;
+    memcpy(data + offset + sizeof(uint32_t), buf, len);
+    *head = pos + frame;
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * publish - makes messages up to head visible to the reader
+ *----------------------------------------------------------------------------*/
+void ShmQueue::publish (uint64_t head)
+{
+    ring->head.store(head, std::memory_order_release);
+    wake(&ring->head_seq, &ring->reader_waiting);
+}
+
+/*----------------------------------------------------------------------------
+ * release - frees the message last returned by reference
+ *----------------------------------------------------------------------------*/
+void ShmQueue::release (void)
+{
+    if(pendingTail)
+    {
+        ring->tail.store(pendingTail, std::memory_order_release);
+        pendingTail = 0;
+        wake(&ring->tail_seq, &ring->writer_waiting);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * waitOn - waits for the sequence to move on from val; the waiting flag is
+ *          raised before sleeping so the peer only makes the wake system call
+ *          when someone is asleep; returns false on timeout
+ *----------------------------------------------------------------------------*/
+bool ShmQueue::waitOn (std::atomic<uint32_t>* seq, uint32_t val, std::atomic<uint32_t>* waiting, int timeout)
+{
+    if(timeout == IO_CHECK) return false;
+
+    struct timespec ts;
+    struct timespec* tsp = NULL;
+    if(timeout > 0)
+    {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000L;
+        tsp = &ts;
+    }
+
+    waiting->store(1);
+    long ret = 0;
+    if(seq->load() == val)
+    {
+        ret = shmFutex(seq, FUTEX_WAIT, val, tsp);
+    }
+    waiting->store(0);
+
+    return !(ret != 0 && errno == ETIMEDOUT);
+}
+
+/*----------------------------------------------------------------------------
+ * wake - bumps the sequence and wakes the peer if it is asleep on it
+ *----------------------------------------------------------------------------*/
+void ShmQueue::wake (std::atomic<uint32_t>* seq, std::atomic<uint32_t>* waiting)
+{
+    seq->fetch_add(1);
+    if(waiting->load())
+    {
+        shmFutex(seq, FUTEX_WAKE, 1, NULL);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * frameSize - length word plus message, padded to keep frames 8 byte aligned
+ *----------------------------------------------------------------------------*/
+uint64_t ShmQueue::frameSize (int len)
+{
+    return ((uint64_t)len + sizeof(uint32_t) + 7) & ~(uint64_t)7;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __shm_queue__
+#define __shm_queue__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <atomic>
+
+#include "OsApi.h"
+#include "DeviceObject.h"
+
+/******************************************************************************
+ * SHARED MEMORY QUEUE CLASS
+ *
+ *  A ring of messages in a named shared memory segment, connecting a queue
+ *  in one process to a queue in another on the same node: a device writer
+ *  drains a local queue into the ring and a device reader posts what it
+ *  reads from the ring onto a local queue, so both sides keep using the
+ *  Publisher and Subscriber interfaces.  Each ring has one writer and one
+ *  reader; they wait on each other with futexes in the segment.
+ ******************************************************************************/
+
+class ShmQueue: public DeviceObject
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const long DEFAULT_RING_SIZE = 0x4000000; // 64MB
+        static const long MIN_RING_SIZE = 0x10000; // 64KB
+        static const int ATTACH_TIMEOUT_MS = 5000; // time given to the creator of the segment to set it up
+        static const int NAME_MAX_CHARS = 128;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static int          luaCreate           (lua_State* L);
+
+                            ShmQueue            (lua_State* L, const char* _name, role_t _role, long ring_size=DEFAULT_RING_SIZE);
+        virtual             ~ShmQueue           (void);
+
+        bool                isConnected         (int num_connections=0) override; // number of readers and writers attached
+        void                closeConnection     (void) override;
+        int                 writeBuffer         (const void* buf, int len, int timeout=SYS_TIMEOUT) override;
+        int                 readBuffer          (void* buf, int len, int timeout=SYS_TIMEOUT) override;
+        int                 readRef             (const void** buf, int len, int timeout=SYS_TIMEOUT) override;
+        int                 writeBatch          (const void** bufs, const int* lens, int n, int timeout=SYS_TIMEOUT) override;
+        int                 getUniqueId         (void) override; // returns file descriptor of segment
+        const char*         getConfig           (void) override; // returns <name>(<role>,<ring size>)
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const uint32_t RING_MAGIC = 0x53484D51; // "SHMQ"
+        static const uint32_t WRAP_MARKER = 0xFFFFFFFF; // rest of ring is skipped
+        static const long DATA_OFFSET = 256; // ring data follows header
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Segment Header - positions count bytes since the ring was created */
+        typedef struct {
+            std::atomic<uint32_t>   magic;          // set last by the creator
+            uint32_t                pad0;
+            uint64_t                size;           // bytes of ring data, a power of two
+            std::atomic<uint32_t>   attached;       // devices mapping the segment
+            std::atomic<uint32_t>   readers;
+            std::atomic<uint32_t>   writers;
+            alignas(64) std::atomic<uint64_t> head; // written by writer
+            std::atomic<uint32_t>   head_seq;       // futex: bumped when data is written or the writer leaves
+            std::atomic<uint32_t>   reader_waiting;
+            alignas(64) std::atomic<uint64_t> tail; // written by reader
+            std::atomic<uint32_t>   tail_seq;       // futex: bumped when space is freed or the reader leaves
+            std::atomic<uint32_t>   writer_waiting;
+        } ring_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        char*           name;
+        char*           shmName;
+        char*           config;
+        int             fd;
+        uint8_t*        map;
+        long            mapSize;
+        ring_t*         ring;
+        uint8_t*        data;
+        uint64_t        mask;
+        bool            connected;
+        bool            writerSeen;     // reader: a writer has attached, so its leaving ends the stream
+        uint64_t        pendingTail;    // reader: end of message returned by reference, released on next read
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        bool            reserve             (const void* buf, int len, uint64_t* head);
+        void            publish             (uint64_t head);
+        void            release             (void);
+        bool            waitOn              (std::atomic<uint32_t>* seq, uint32_t val, std::atomic<uint32_t>* waiting, int timeout);
+        void            wake                (std::atomic<uint32_t>* seq, std::atomic<uint32_t>* waiting);
+
+        static uint64_t frameSize           (int len);
+};
+
+#endif  /* __shm_queue__ */
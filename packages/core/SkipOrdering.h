@@ -0,0 +1,658 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __skip_ordering__
+#define __skip_ordering__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <assert.h>
+#include "RTExcept.h"
+#include "OsApi.h"
+
+/******************************************************************************
+ * SKIP ORDERING TEMPLATE
+ ******************************************************************************/
+/*
+ * SkipOrdering - sorted skip list of data type T and index type K
+ *
+ *  Drop-in alternative to Ordering with O(log n) add, get and remove.  The
+ *  bottom level is a doubly linked list, so first/next/last/prev walk the
+ *  entries in key order with the same cursor behaviour as Ordering; get
+ *  positions the cursor at the node it returns.  Duplicate keys are kept,
+ *  with the newest entry placed ahead of existing entries of the same key.
+ */
+template <class T, typename K=unsigned long>
+class SkipOrdering
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            EXACT_MATCH,
+            GREATER_THAN_OR_EQUAL,
+            LESS_THAN_OR_EQUAL,
+            GREATER_THAN,
+            LESS_THAN
+        } searchMode_t;
+
+        typedef int (*postFunc_t) (void* data, int size, void* parm);
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const long INFINITE_LIST_SIZE = -1;
+        static const int MAX_LEVELS = 16; // with a branching factor of 4, good for 4 billion entries
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        SkipOrdering    (postFunc_t post_func=NULL, void* post_parm=NULL, K max_list_size=INFINITE_LIST_SIZE);
+        virtual         ~SkipOrdering   (void);
+
+        bool            add             (K key, T& data, bool unique=false);
+        T&              get             (K key, searchMode_t smode=EXACT_MATCH);
+        bool            remove          (K key, searchMode_t smode=EXACT_MATCH);
+        long            length          (void);
+        void            flush           (void);
+        void            clear           (void);
+
+        K               first           (T* data);
+        K               next            (T* data);
+        K               last            (T* data);
+        K               prev            (T* data);
+
+        SkipOrdering&   operator=       (const SkipOrdering& other);
+        T&              operator[]      (K key);
+
+    protected:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct skip_block_t {
+            K                       key;
+            T                       data;
+            struct skip_block_t*    prev;       // level 0 only
+            int                     height;     // number of forward links
+            struct skip_block_t**   forward;    // forward[0] is the next node in key order
+        } sorted_node_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        sorted_node_t*  head[MAX_LEVELS];
+        sorted_node_t*  lastNode;
+        sorted_node_t*  curr;
+        int             levels;
+        long            len;
+        long            maxListSize;
+        postFunc_t      postFunc;
+        void*           postParm;
+        uint32_t        seed;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        bool            setMaxListSize  (long _max_list_size);
+        sorted_node_t*  search          (K key, searchMode_t smode);
+        sorted_node_t*  lowerBound      (K key, sorted_node_t** update);
+        sorted_node_t*  upperBound      (K key);
+        void            unlink          (sorted_node_t* node);
+        int             randomHeight    (void);
+        void            postNode        (sorted_node_t* node);
+        virtual void    freeNode        (sorted_node_t* node);
+};
+
+/******************************************************************************
+ * MANAGED SKIP ORDERING TEMPLATE
+ ******************************************************************************/
+
+template <class T, typename K=unsigned long, bool is_array=false>
+class MgSkipOrdering: public SkipOrdering<T,K>
+{
+    public:
+        MgSkipOrdering (typename SkipOrdering<T,K>::postFunc_t post_func=NULL, void* post_parm=NULL, K max_list_size=SkipOrdering<T,K>::INFINITE_LIST_SIZE);
+        ~MgSkipOrdering (void);
+    private:
+        void freeNode (typename SkipOrdering<T,K>::sorted_node_t* node);
+};
+
+/******************************************************************************
+ SKIP ORDERING METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+SkipOrdering<T,K>::SkipOrdering(postFunc_t post_func, void* post_parm, K max_list_size)
+{
+    for(int i = 0; i < MAX_LEVELS; i++) head[i] = NULL;
+    lastNode    = NULL;
+    curr        = NULL;
+    levels      = 1;
+    len         = 0;
+    seed        = 0x2545F491;
+
+    postFunc    = post_func;
+    postParm    = post_parm;
+
+    setMaxListSize(max_list_size);
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor  -
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+SkipOrdering<T,K>::~SkipOrdering(void)
+{
+    clear();
+}
+
+/*----------------------------------------------------------------------------
+ * add
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool SkipOrdering<T,K>::add(K key, T& data, bool unique)
+{
+    sorted_node_t* update[MAX_LEVELS];
+
+    /* Find Insertion Point */
+    sorted_node_t* succ = lowerBound(key, update);
+
+    /* Check Uniqueness */
+    if(unique && succ && succ->key == key)
+    {
+        return false;
+    }
+
+    /* Allocate New Node */
+    sorted_node_t* new_node = new sorted_node_t;
+    new_node->key = key;
+    new_node->data = data;
+    new_node->height = randomHeight();
+    new_node->forward = new sorted_node_t* [new_node->height];
+    len++;
+
+    /* Grow List Height */
+    while(levels < new_node->height)
+    {
+        update[levels++] = NULL;
+    }
+
+    /* Link Node */
+    for(int i = 0; i < new_node->height; i++)
+    {
+        sorted_node_t** link = update[i] ? &update[i]->forward[i] : &head[i];
+        new_node->forward[i] = *link;
+        *link = new_node;
+    }
+    new_node->prev = update[0];
+    if(succ)    succ->prev = new_node;
+    else        lastNode = new_node; // reposition last node
+    curr = new_node;
+
+    /* Post or Remove First Node */
+    while((maxListSize != INFINITE_LIST_SIZE) && (len > maxListSize))
+    {
+        sorted_node_t* old_node = head[0];
+        if(curr == old_node) curr = old_node->forward[0];
+        unlink(old_node);
+        postNode(old_node);
+        delete [] old_node->forward;
+        delete old_node;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * get
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+T& SkipOrdering<T,K>::get(K key, searchMode_t smode)
+{
+    sorted_node_t* node = search(key, smode);
+    if(node)
+    {
+        curr = node;
+        return node->data;
+    }
+
+    throw RunTimeException(CRITICAL, RTE_ERROR, "key not found");
+}
+
+/*----------------------------------------------------------------------------
+ * remove
+ *
+ *  removes the node that get would return for the same key and mode
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool SkipOrdering<T,K>::remove(K key, searchMode_t smode)
+{
+    sorted_node_t* node = search(key, smode);
+    if(node == NULL) return false;
+
+    /* Reposition Current */
+    if(node->forward[0] != NULL)    curr = node->forward[0];
+    else                            curr = node->prev;
+
+    /* Delete Node */
+    freeNode(node);
+    unlink(node);
+    delete [] node->forward;
+    delete node;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * length
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+long SkipOrdering<T,K>::length(void)
+{
+    return len;
+}
+
+/*----------------------------------------------------------------------------
+ * flush
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void SkipOrdering<T,K>::flush(void)
+{
+    sorted_node_t* node = head[0];
+    while(node != NULL)
+    {
+        sorted_node_t* next_node = node->forward[0];
+        postNode(node);
+        delete [] node->forward;
+        delete node;
+        node = next_node;
+    }
+
+    /* Reset Parameters */
+    for(int i = 0; i < MAX_LEVELS; i++) head[i] = NULL;
+    lastNode = NULL;
+    curr = NULL;
+    levels = 1;
+    len = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * clear
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void SkipOrdering<T,K>::clear(void)
+{
+    sorted_node_t* node = head[0];
+    while(node != NULL)
+    {
+        sorted_node_t* next_node = node->forward[0];
+        freeNode(node);
+        delete [] node->forward;
+        delete node;
+        node = next_node;
+    }
+
+    /* Reset Parameters */
+    for(int i = 0; i < MAX_LEVELS; i++) head[i] = NULL;
+    lastNode = NULL;
+    curr = NULL;
+    levels = 1;
+    len = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * first
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+K SkipOrdering<T,K>::first(T* data)
+{
+    curr = head[0];
+
+    if(curr != NULL)
+    {
+        if(data != NULL) *data = curr->data;
+        return curr->key;
+    }
+
+    return (K)INVALID_KEY;
+}
+
+/*----------------------------------------------------------------------------
+ * next
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+K SkipOrdering<T,K>::next(T* data)
+{
+    if(curr != NULL)
+    {
+        curr = curr->forward[0];
+    }
+
+    if(curr != NULL)
+    {
+        if(data != NULL) *data = curr->data;
+        return curr->key;
+    }
+
+    return (K)INVALID_KEY;
+}
+
+/*----------------------------------------------------------------------------
+ * last
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+K SkipOrdering<T,K>::last(T* data)
+{
+    curr = lastNode;
+
+    if(curr != NULL)
+    {
+        if(data != NULL) *data = curr->data;
+        return curr->key;
+    }
+
+    return (K)INVALID_KEY;
+}
+
+/*----------------------------------------------------------------------------
+ * prev
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+K SkipOrdering<T,K>::prev(T* data)
+{
+    if(curr != NULL)
+    {
+        curr = curr->prev;
+    }
+
+    if(curr != NULL)
+    {
+        if(data != NULL) *data = curr->data;
+        return curr->key;
+    }
+
+    return (K)INVALID_KEY;
+}
+
+/*----------------------------------------------------------------------------
+ * operator=
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+SkipOrdering<T,K>& SkipOrdering<T,K>::operator=(const SkipOrdering& other)
+{
+    if(this == &other) return *this;
+
+    /* clear existing list */
+    clear();
+
+    /* set parameters */
+    maxListSize = other.maxListSize;
+
+    /* copy over post attributes */
+    postFunc = other.postFunc;
+    postParm = other.postParm;
+
+    /* build new list - adding in reverse preserves the order of duplicates */
+    for(sorted_node_t* node = other.lastNode; node != NULL; node = node->prev)
+    {
+        add(node->key, node->data);
+    }
+
+    /* return */
+    return *this;
+}
+
+/*----------------------------------------------------------------------------
+ * operator[]
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+T& SkipOrdering<T,K>::operator[](K key)
+{
+    return get(key, EXACT_MATCH);
+}
+
+/*----------------------------------------------------------------------------
+ * setMaxListSize
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+bool SkipOrdering<T,K>::setMaxListSize(long _max_list_size)
+{
+    if(_max_list_size >= INFINITE_LIST_SIZE)
+    {
+        maxListSize = _max_list_size;
+        return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * search
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+typename SkipOrdering<T,K>::sorted_node_t* SkipOrdering<T,K>::search(K key, searchMode_t smode)
+{
+    sorted_node_t* node = NULL;
+
+    if(smode == EXACT_MATCH)
+    {
+        node = lowerBound(key, NULL);
+        if(node && node->key != key) node = NULL;
+    }
+    else if(smode == GREATER_THAN_OR_EQUAL) // first node greater than or equal to the key
+    {
+        node = lowerBound(key, NULL);
+    }
+    else if(smode == LESS_THAN_OR_EQUAL) // last node less than or equal to the key
+    {
+        node = upperBound(key);
+        node = node ? node->prev : lastNode;
+    }
+    else if(smode == GREATER_THAN) // first node greater than the key
+    {
+        node = upperBound(key);
+    }
+    else if(smode == LESS_THAN) // last node less than the key
+    {
+        node = lowerBound(key, NULL);
+        node = node ? node->prev : lastNode;
+    }
+    else // invalid search mode
+    {
+        assert(false);
+    }
+
+    return node;
+}
+
+/*----------------------------------------------------------------------------
+ * lowerBound
+ *
+ *  returns the first node with a key greater than or equal to the key, and
+ *  optionally fills in the last node before it on each level (NULL for head)
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+typename SkipOrdering<T,K>::sorted_node_t* SkipOrdering<T,K>::lowerBound(K key, sorted_node_t** update)
+{
+    sorted_node_t* pred = NULL;
+    for(int i = levels - 1; i >= 0; i--)
+    {
+        sorted_node_t* node = pred ? pred->forward[i] : head[i];
+        while(node && node->key < key)
+        {
+            pred = node;
+            node = node->forward[i];
+        }
+        if(update) update[i] = pred;
+    }
+
+    return pred ? pred->forward[0] : head[0];
+}
+
+/*----------------------------------------------------------------------------
+ * upperBound
+ *
+ *  returns the first node with a key greater than the key
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+typename SkipOrdering<T,K>::sorted_node_t* SkipOrdering<T,K>::upperBound(K key)
+{
+    sorted_node_t* pred = NULL;
+    for(int i = levels - 1; i >= 0; i--)
+    {
+        sorted_node_t* node = pred ? pred->forward[i] : head[i];
+        while(node && node->key <= key)
+        {
+            pred = node;
+            node = node->forward[i];
+        }
+    }
+
+    return pred ? pred->forward[0] : head[0];
+}
+
+/*----------------------------------------------------------------------------
+ * unlink
+ *
+ *  removes the node from every level; with duplicate keys the search on
+ *  each level continues past equal keys until the node itself is found
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void SkipOrdering<T,K>::unlink(sorted_node_t* node)
+{
+    sorted_node_t* update[MAX_LEVELS];
+    lowerBound(node->key, update);
+
+    for(int i = 0; i < node->height; i++)
+    {
+        sorted_node_t** link = update[i] ? &update[i]->forward[i] : &head[i];
+        while(*link != node) link = &(*link)->forward[i];
+        *link = node->forward[i];
+    }
+
+    if(node->forward[0] != NULL)    node->forward[0]->prev = node->prev;
+    else                            lastNode = node->prev; // reposition last node
+
+    while(levels > 1 && head[levels - 1] == NULL) levels--;
+    len--;
+}
+
+/*----------------------------------------------------------------------------
+ * randomHeight
+ *
+ *  each additional level is kept with a probability of 1/4
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+int SkipOrdering<T,K>::randomHeight(void)
+{
+    /* xorshift32 */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    int height = 1;
+    uint32_t bits = seed;
+    while(height < MAX_LEVELS && (bits & 3) == 0)
+    {
+        height++;
+        bits >>= 2;
+    }
+
+    return height;
+}
+
+/*----------------------------------------------------------------------------
+ * postNode
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void SkipOrdering<T,K>::postNode(sorted_node_t* node)
+{
+    int status = 0;
+    if(postFunc) status = postFunc(&(node->data), sizeof(T), postParm);
+    if(status <= 0) freeNode(node);
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T, typename K>
+void SkipOrdering<T,K>::freeNode(sorted_node_t* node)
+{
+    (void)node;
+}
+
+/******************************************************************************
+ MANAGED SKIP ORDERING METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+template <class T, typename K, bool is_array>
+MgSkipOrdering<T,K,is_array>::MgSkipOrdering(typename SkipOrdering<T,K>::postFunc_t post_func, void* post_parm, K max_list_size):
+    SkipOrdering<T,K>(post_func, post_parm, max_list_size)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+template <class T, typename K, bool is_array>
+MgSkipOrdering<T,K,is_array>::~MgSkipOrdering(void)
+{
+    SkipOrdering<T,K>::clear();
+}
+
+/*----------------------------------------------------------------------------
+ * freeNode
+ *----------------------------------------------------------------------------*/
+template <class T, typename K, bool is_array>
+void MgSkipOrdering<T,K,is_array>::freeNode(typename SkipOrdering<T,K>::sorted_node_t* node)
+{
+    if(!is_array)   delete node->data;
+    else            delete [] node->data;
+}
+
+#endif  /* __skip_ordering__ */
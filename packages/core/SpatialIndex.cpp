@@ -52,12 +52,16 @@ const char* SpatialIndex::LuaMetaName = "SpatialIndex";
 const struct luaL_Reg SpatialIndex::LuaMetaTable[] = {
     {"add",         luaAdd},
     {"query",       luaQuery},
+    {"querybatch",  luaQueryBatch},
     {"display",     luaDisplay},
+    {"save",        luaSave},
+    {"load",        luaLoad},
     {"project",     luaProject},
     {"sphere",      luaSphere},
     {"split",       luaSplit},
     {"intersect",   luaIntersect},
     {"combine",     luaCombine},
+    {"querypoly",   luaQueryPoly},
     {NULL,          NULL}
 };
 
@@ -66,7 +70,7 @@ const struct luaL_Reg SpatialIndex::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<asset>, [<threshold>])
+ * luaCreate - create(<asset>, <projection>, [<threshold>], [<packed>])
  *----------------------------------------------------------------------------*/
 int SpatialIndex::luaCreate (lua_State* L)
 {
@@ -76,9 +80,10 @@ int SpatialIndex::luaCreate (lua_State* L)
         Asset*          _asset      = (Asset*)getLuaObject(L, 1, Asset::OBJECT_TYPE);
         MathLib::proj_t _projection = (MathLib::proj_t)getLuaInteger(L, 2);
         int             _threshold  = getLuaInteger(L, 3, true, DEFAULT_THRESHOLD);
+        bool            _packed     = getLuaBoolean(L, 4, true, false);
 
         /* Return AssetIndex Object */
-        return createLuaObject(L, new SpatialIndex(L, _asset, _projection, _threshold));
+        return createLuaObject(L, new SpatialIndex(L, _asset, _projection, _threshold, _packed));
     }
     catch(const RunTimeException& e)
     {
@@ -90,8 +95,8 @@ int SpatialIndex::luaCreate (lua_State* L)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-SpatialIndex::SpatialIndex(lua_State* L, Asset* _asset, MathLib::proj_t _projection, int _threshold):
-    AssetIndex<spatialspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold)
+SpatialIndex::SpatialIndex(lua_State* L, Asset* _asset, MathLib::proj_t _projection, int _threshold, bool _packed):
+    AssetIndex<spatialspan_t>(L, *_asset, LuaMetaName, LuaMetaTable, _threshold, _packed)
 {
     projection = _projection;
 
@@ -261,29 +266,35 @@ spatialspan_t SpatialIndex::combine (const spatialspan_t& span1, const spatialsp
     return span;
 }
 
+/*----------------------------------------------------------------------------
+ * spanattrs
+ *----------------------------------------------------------------------------*/
+int SpatialIndex::spanattrs (const char* names[MAX_SPAN_ATTRS])
+{
+    names[0] = "lat0";
+    names[1] = "lon0";
+    names[2] = "lat1";
+    names[3] = "lon1";
+    return 4;
+}
+
 /*----------------------------------------------------------------------------
  * attr2span
  *----------------------------------------------------------------------------*/
-spatialspan_t SpatialIndex::attr2span (Dictionary<double>* attr, bool* provided)
+spatialspan_t SpatialIndex::attr2span (const double* values, bool* provided)
 {
     spatialspan_t span;
     bool status = false;
 
-    try
+    span.c0.lat = values[0];
+    span.c0.lon = values[1];
+    span.c1.lat = values[2];
+    span.c1.lon = values[3];
+    if( !std::isnan(span.c0.lon) && !std::isnan(span.c1.lat) && !std::isnan(span.c1.lon) &&
+        ((projection == MathLib::NORTH_POLAR && span.c0.lat >= 0.0) ||
+         (projection == MathLib::SOUTH_POLAR && span.c0.lat <  0.0)) )
     {
-        span.c0.lat = (*attr)["lat0"];
-        span.c0.lon = (*attr)["lon0"];
-        span.c1.lat = (*attr)["lat1"];
-        span.c1.lon = (*attr)["lon1"];
-        if( (projection == MathLib::NORTH_POLAR && span.c0.lat >= 0.0) ||
-            (projection == MathLib::SOUTH_POLAR && span.c0.lat <  0.0) )
-        {
-            status = true;
-        }
-    }
-    catch(RunTimeException& e)
-    {
-        mlog(e.level(), "Failed to index asset %s", e.what());
+        status = true;
     }
 
     if(provided)
@@ -337,6 +348,63 @@ void SpatialIndex::displayspan (const spatialspan_t& span)
     print2term("[%d,%d x %d,%d]", (int)(proj.p0.x*100), (int)(proj.p0.y*100), (int)(proj.p1.x*100), (int)(proj.p1.y*100));
 }
 
+/*----------------------------------------------------------------------------
+ * sortkey
+ *
+ *  center of the projected span; dimension 0 is x and dimension 1 is y
+ *----------------------------------------------------------------------------*/
+double SpatialIndex::sortkey (const spatialspan_t& span, int dim)
+{
+    projspan_t proj = project(span);
+    if(dim == 0)    return (proj.p0.x + proj.p1.x) / 2.0;
+    else            return (proj.p0.y + proj.p1.y) / 2.0;
+}
+
+/*----------------------------------------------------------------------------
+ * dimensions
+ *----------------------------------------------------------------------------*/
+int SpatialIndex::dimensions (void)
+{
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * querypoly
+ *
+ *  returns resources whose projected span overlaps the polygon itself rather
+ *  than just its bounding span; subtrees are pruned by the same test
+ *----------------------------------------------------------------------------*/
+SkipOrdering<int>* SpatialIndex::querypoly (const MathLib::coord_t* poly, int num_points)
+{
+    if(num_points <= 0) return new SkipOrdering<int>();
+
+    /* Project Polygon and Build Bounding Span */
+    polyfilter_t filter = {this, new MathLib::point_t [num_points], num_points};
+    projspan_t bounds;
+    MathLib::coord2point(poly, filter.points, num_points, projection);
+    for(int i = 0; i < num_points; i++)
+    {
+        MathLib::point_t p = filter.points[i];
+        if(i == 0)
+        {
+            bounds.p0 = p;
+            bounds.p1 = p;
+        }
+        else
+        {
+            bounds.p0.x = MIN(bounds.p0.x, p.x);
+            bounds.p0.y = MIN(bounds.p0.y, p.y);
+            bounds.p1.x = MAX(bounds.p1.x, p.x);
+            bounds.p1.y = MAX(bounds.p1.y, p.y);
+        }
+    }
+
+    /* Query */
+    SkipOrdering<int>* list = query(restore(bounds), polyfilter, &filter);
+    delete [] filter.points;
+    return list;
+}
+
 /******************************************************************************
  * PRIVATE METHODS
  ******************************************************************************/
@@ -375,6 +443,76 @@ spatialspan_t SpatialIndex::restore (projspan_t proj)
     return span;
 }
 
+/*----------------------------------------------------------------------------
+ * polyfilter
+ *----------------------------------------------------------------------------*/
+bool SpatialIndex::polyfilter (const spatialspan_t& span, void* parm)
+{
+    polyfilter_t* filter = (polyfilter_t*)parm;
+    projspan_t rect = filter->index->project(span);
+    return polyintersect(filter->points, filter->num_points, rect);
+}
+
+/*----------------------------------------------------------------------------
+ * polyintersect
+ *
+ *  the rectangle and polygon overlap if a vertex of either lies inside the
+ *  other, or if any polygon edge crosses a rectangle edge
+ *----------------------------------------------------------------------------*/
+bool SpatialIndex::polyintersect (MathLib::point_t* poly, int len, const projspan_t& rect)
+{
+    MathLib::point_t corners[4] = {
+        {rect.p0.x, rect.p0.y},
+        {rect.p1.x, rect.p0.y},
+        {rect.p1.x, rect.p1.y},
+        {rect.p0.x, rect.p1.y}
+    };
+
+    /* Polygon Vertex Inside Rectangle */
+    for(int i = 0; i < len; i++)
+    {
+        if(poly[i].x >= rect.p0.x && poly[i].x <= rect.p1.x &&
+           poly[i].y >= rect.p0.y && poly[i].y <= rect.p1.y)
+        {
+            return true;
+        }
+    }
+
+    /* Rectangle Corner Inside Polygon */
+    for(int c = 0; c < 4; c++)
+    {
+        if(MathLib::inpoly(poly, len, corners[c])) return true;
+    }
+
+    /* Edges Cross */
+    for(int i = 0; i < len; i++)
+    {
+        const MathLib::point_t& a = poly[i];
+        const MathLib::point_t& b = poly[(i + 1) % len];
+        for(int c = 0; c < 4; c++)
+        {
+            if(segintersect(a, b, corners[c], corners[(c + 1) % 4])) return true;
+        }
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * segintersect
+ *----------------------------------------------------------------------------*/
+bool SpatialIndex::segintersect (const MathLib::point_t& a, const MathLib::point_t& b, const MathLib::point_t& c, const MathLib::point_t& d)
+{
+    double d1 = ((d.x - c.x) * (a.y - c.y)) - ((d.y - c.y) * (a.x - c.x));
+    double d2 = ((d.x - c.x) * (b.y - c.y)) - ((d.y - c.y) * (b.x - c.x));
+    double d3 = ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+    double d4 = ((b.x - a.x) * (d.y - a.y)) - ((b.y - a.y) * (d.x - a.x));
+
+    /* Proper Crossing; touching cases are caught by the vertex tests */
+    return (((d1 > 0.0 && d2 < 0.0) || (d1 < 0.0 && d2 > 0.0)) &&
+            ((d3 > 0.0 && d4 < 0.0) || (d3 < 0.0 && d4 > 0.0)));
+}
+
 /*----------------------------------------------------------------------------
  * luaProject: project(<lon>, <lat>)
  *----------------------------------------------------------------------------*/
@@ -554,3 +692,61 @@ int SpatialIndex::luaCombine (lua_State* L)
     /* Return Failure */
     return returnLuaStatus(L, false);
 }
+
+/*----------------------------------------------------------------------------
+ * luaQueryPoly - :querypoly({{lat=<lat>, lon=<lon>}, ...})
+ *----------------------------------------------------------------------------*/
+int SpatialIndex::luaQueryPoly (lua_State* L)
+{
+    bool status = false;
+    MathLib::coord_t* poly = NULL;
+
+    try
+    {
+        /* Get Self */
+        SpatialIndex* lua_obj = (SpatialIndex*)getLuaSelf(L, 1);
+
+        /* Get Polygon */
+        if(!lua_istable(L, 2))
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "must supply a table of coordinates");
+        }
+        int num_points = lua_rawlen(L, 2);
+        poly = new MathLib::coord_t [num_points];
+        for(int i = 0; i < num_points; i++)
+        {
+            lua_rawgeti(L, 2, i + 1);
+
+            lua_getfield(L, -1, "lon");
+            poly[i].lon = getLuaFloat(L, -1);
+            lua_pop(L, 1);
+
+            lua_getfield(L, -1, "lat");
+            poly[i].lat = getLuaFloat(L, -1);
+            lua_pop(L, 1);
+
+            lua_pop(L, 1);
+        }
+
+        /* Query Resources */
+        SkipOrdering<int>* ro = lua_obj->querypoly(poly, num_points);
+
+        /* Return Resources */
+        lua_obj->pushresources(L, ro);
+
+        /* Free Resource Index List */
+        delete ro;
+
+        /* Set Status */
+        status = true;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error querying polygon: %s", e.what());
+    }
+
+    delete [] poly;
+
+    /* Return Status */
+    return returnLuaStatus(L, status, 2);
+}
@@ -59,7 +59,7 @@ class SpatialIndex: public AssetIndex<spatialspan_t>
          * Methods
          *--------------------------------------------------------------------*/
 
-                        SpatialIndex    (lua_State* L, Asset* _asset, MathLib::proj_t _projection, int _threshold);
+                        SpatialIndex    (lua_State* L, Asset* _asset, MathLib::proj_t _projection, int _threshold, bool _packed);
                         ~SpatialIndex   (void);
 
         static int      luaCreate       (lua_State* L);
@@ -69,9 +69,14 @@ class SpatialIndex: public AssetIndex<spatialspan_t>
         bool            isright         (node_t* node, const spatialspan_t& span) override;
         bool            intersect       (const spatialspan_t& span1, const spatialspan_t& span2) override;
         spatialspan_t   combine         (const spatialspan_t& span1, const spatialspan_t& span2) override;
-        spatialspan_t   attr2span       (Dictionary<double>* attr, bool* provided=NULL) override;
+        int             spanattrs       (const char* names[MAX_SPAN_ATTRS]) override;
+        spatialspan_t   attr2span       (const double* values, bool* provided=NULL) override;
         spatialspan_t   luatable2span   (lua_State* L, int parm) override;
         void            displayspan     (const spatialspan_t& span) override;
+        double          sortkey         (const spatialspan_t& span, int dim) override;
+        int             dimensions      (void) override;
+
+        SkipOrdering<int>* querypoly    (const MathLib::coord_t* poly, int num_points);
 
     private:
 
@@ -84,6 +89,12 @@ class SpatialIndex: public AssetIndex<spatialspan_t>
             MathLib::point_t p1;
         } projspan_t;
 
+        typedef struct {
+            SpatialIndex*       index;
+            MathLib::point_t*   points;     // projected polygon
+            int                 num_points;
+        } polyfilter_t;
+
         /*--------------------------------------------------------------------
          * Constants
          *--------------------------------------------------------------------*/
@@ -98,11 +109,16 @@ class SpatialIndex: public AssetIndex<spatialspan_t>
         projspan_t      project         (spatialspan_t span);
         spatialspan_t   restore         (projspan_t proj);
 
+        static bool     polyfilter      (const spatialspan_t& span, void* parm);
+        static bool     polyintersect   (MathLib::point_t* poly, int len, const projspan_t& rect);
+        static bool     segintersect    (const MathLib::point_t& a, const MathLib::point_t& b, const MathLib::point_t& c, const MathLib::point_t& d);
+
         static int      luaProject      (lua_State* L);
         static int      luaSphere       (lua_State* L);
         static int      luaSplit        (lua_State* L);
         static int      luaIntersect    (lua_State* L);
         static int      luaCombine      (lua_State* L);
+        static int      luaQueryPoly    (lua_State* L);
 
         /*--------------------------------------------------------------------
          * Data
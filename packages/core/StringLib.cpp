@@ -34,18 +34,40 @@
  ******************************************************************************/
 
 #include "StringLib.h"
+#include "Dictionary.h"
 #include "OsApi.h"
 
 #include <cstdarg>
 #include <string.h>
 #include <limits.h>
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 /******************************************************************************
  * STRING STATIC DATA
  ******************************************************************************/
 
+static Mutex internMut;
+static Dictionary<const char*> internTable;
+
 const char* StringLib::B64CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+const char* StringLib::DIGIT_PAIRS = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
 const int StringLib::B64INDEX[256] =
 {
     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
@@ -58,6 +80,222 @@ const int StringLib::B64INDEX[256] =
     41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51
 };
 
+/******************************************************************************
+ * VECTORIZED CODECS
+ *
+ *  each returns the number of input bytes consumed so the scalar code can
+ *  finish the remainder; the b64 decoders stop at the first block holding a
+ *  character outside the standard alphabet (padding, url safe characters,
+ *  garbage) and leave it to the scalar table so the results do not change
+ ******************************************************************************/
+
+#if defined(__AVX2__)
+
+/*----------------------------------------------------------------------------
+ * b64encodeAVX2 - 24 bytes to 32 characters per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b64encodeAVX2 (const uint8_t* src, size_t len, char* dst)
+{
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                               'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    size_t j = 0;
+    for(; i + 28 <= len; i += 24, j += 32) // second lane loads 4 bytes past the 24 consumed
+    {
+        /* Spread 3 byte groups into 4 byte words */
+        __m128i lo = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i hi = _mm_loadu_si128((const __m128i*)&src[i + 12]);
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        /* Extract 6 bit indices */
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        /* Translate indices to characters */
+        __m256i offset = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        offset = _mm256_or_si256(offset, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        const __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, offset), indices);
+        _mm256_storeu_si256((__m256i*)&dst[j], chars);
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * b64decodeAVX2 - 32 characters to 24 bytes per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b64decodeAVX2 (const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len)
+{
+    const __m256i shift_lut = _mm256_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                               0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_lut = _mm256_setr_epi8((char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+                                              (char)0xF8, (char)0xF8, (char)0xF0, 0x54, 0x50, 0x50, 0x50, 0x54,
+                                              (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+                                              (char)0xF8, (char)0xF8, (char)0xF0, 0x54, 0x50, 0x50, 0x50, 0x54);
+    const __m256i bitpos_lut = _mm256_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    size_t j = 0;
+    for(; i + 32 <= len && j + 28 <= dst_len; i += 32, j += 24) // stores write 4 bytes past the 24 produced
+    {
+        const __m256i in = _mm256_loadu_si256((const __m256i*)&src[i]);
+
+        /* Validate against standard alphabet */
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        const __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        const __m256i valid_his = _mm256_shuffle_epi8(mask_lut, lo_nibbles);
+        const __m256i hi_bit = _mm256_shuffle_epi8(bitpos_lut, hi_nibbles);
+        const __m256i invalid = _mm256_cmpeq_epi8(_mm256_and_si256(valid_his, hi_bit), _mm256_setzero_si256());
+        if(_mm256_movemask_epi8(invalid)) break;
+
+        /* Translate characters to 6 bit values ('/' shares a nibble with '+') */
+        const __m256i eq_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+        const __m256i shift = _mm256_blendv_epi8(_mm256_shuffle_epi8(shift_lut, hi_nibbles), _mm256_set1_epi8(16), eq_slash);
+        const __m256i values = _mm256_add_epi8(in, shift);
+
+        /* Pack 4 x 6 bits into 3 bytes */
+        const __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i words = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        const __m256i out = _mm256_shuffle_epi8(words, pack);
+        _mm_storeu_si128((__m128i*)&dst[j], _mm256_castsi256_si128(out));
+        _mm_storeu_si128((__m128i*)&dst[j + 12], _mm256_extracti128_si256(out, 1));
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * b16encodeAVX2 - 32 bytes to 64 characters per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b16encodeAVX2 (const uint8_t* src, size_t len, const char* digits, char* dst)
+{
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)digits));
+    size_t i = 0;
+    for(; i + 32 <= len; i += 32)
+    {
+        const __m256i in = _mm256_loadu_si256((const __m256i*)&src[i]);
+        const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), _mm256_set1_epi8(0x0f)));
+        const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, _mm256_set1_epi8(0x0f)));
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)&dst[i * 2], _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i*)&dst[i * 2 + 32], _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+/*----------------------------------------------------------------------------
+ * b64encodeNEON - 48 bytes to 64 characters per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b64encodeNEON (const uint8_t* src, size_t len, const char* alphabet, char* dst)
+{
+    uint8x16x4_t lut;
+    lut.val[0] = vld1q_u8((const uint8_t*)&alphabet[0]);
+    lut.val[1] = vld1q_u8((const uint8_t*)&alphabet[16]);
+    lut.val[2] = vld1q_u8((const uint8_t*)&alphabet[32]);
+    lut.val[3] = vld1q_u8((const uint8_t*)&alphabet[48]);
+    const uint8x16_t mask = vdupq_n_u8(0x3f);
+
+    size_t i = 0;
+    size_t j = 0;
+    for(; i + 48 <= len; i += 48, j += 64)
+    {
+        uint8x16x3_t in = vld3q_u8(&src[i]);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = vqtbl4q_u8(lut, out.val[0]);
+        out.val[1] = vqtbl4q_u8(lut, out.val[1]);
+        out.val[2] = vqtbl4q_u8(lut, out.val[2]);
+        out.val[3] = vqtbl4q_u8(lut, out.val[3]);
+        vst4q_u8((uint8_t*)&dst[j], out);
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * b64decodeNEON - 64 characters to 48 bytes per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b64decodeNEON (const uint8_t* src, size_t len, uint8_t* dst)
+{
+    /* Standard alphabet only, 0xFF for everything else */
+    static const uint8_t decode_lut[128] = {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,
+         52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+        255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+         15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,
+        255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+         41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255
+    };
+    uint8x16x4_t lut_lo, lut_hi;
+    for(int k = 0; k < 4; k++)
+    {
+        lut_lo.val[k] = vld1q_u8(&decode_lut[k * 16]);
+        lut_hi.val[k] = vld1q_u8(&decode_lut[64 + k * 16]);
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    for(; i + 64 <= len; i += 64, j += 48)
+    {
+        uint8x16x4_t in = vld4q_u8(&src[i]);
+
+        /* Translate - indices past each table return 0, so or'ing selects the hit */
+        uint8x16_t invalid = vdupq_n_u8(0);
+        for(int k = 0; k < 4; k++)
+        {
+            uint8x16_t c = in.val[k];
+            uint8x16_t v = vorrq_u8(vqtbl4q_u8(lut_lo, c), vqtbl4q_u8(lut_hi, vsubq_u8(c, vdupq_n_u8(64))));
+            invalid = vorrq_u8(invalid, vorrq_u8(vcgtq_u8(v, vdupq_n_u8(63)), vcgeq_u8(c, vdupq_n_u8(128))));
+            in.val[k] = v;
+        }
+        if(vmaxvq_u8(invalid)) break;
+
+        /* Pack 4 x 6 bits into 3 bytes */
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+        vst3q_u8(&dst[j], out);
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * b16encodeNEON - 16 bytes to 32 characters per iteration
+ *----------------------------------------------------------------------------*/
+static size_t b16encodeNEON (const uint8_t* src, size_t len, const char* digits, char* dst)
+{
+    const uint8x16_t lut = vld1q_u8((const uint8_t*)digits);
+    size_t i = 0;
+    for(; i + 16 <= len; i += 16)
+    {
+        uint8x16_t in = vld1q_u8(&src[i]);
+        uint8x16x2_t out;
+        out.val[0] = vqtbl1q_u8(lut, vshrq_n_u8(in, 4));
+        out.val[1] = vqtbl1q_u8(lut, vandq_u8(in, vdupq_n_u8(0x0f)));
+        vst2q_u8((uint8_t*)&dst[i * 2], out);
+    }
+    return i;
+}
+
+#endif
+
 /******************************************************************************
  * STRING PUBLIC METHODS
  ******************************************************************************/
@@ -494,6 +732,98 @@ void SafeString::reset(void)
     len = 1;
 }
 
+/******************************************************************************
+ * ARENA PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+StringLib::Arena::Arena(long _block_size)
+{
+    head = NULL;
+    blockSize = _block_size > 0 ? _block_size : DEFAULT_BLOCK_SIZE;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+StringLib::Arena::~Arena(void)
+{
+    reset();
+}
+
+/*----------------------------------------------------------------------------
+ * alloc
+ *
+ *  returns 8 byte aligned memory owned by the arena; requests larger than a
+ *  block get a block of their own
+ *----------------------------------------------------------------------------*/
+void* StringLib::Arena::alloc(long size)
+{
+    long aligned_size = (size + 7) & ~7L;
+
+    if(!head || (head->used + aligned_size > head->size))
+    {
+        long data_size = MAX(aligned_size, blockSize);
+        block_t* new_block = (block_t*)new uint64_t [(sizeof(block_t) + data_size + 7) / 8];
+        new_block->size = data_size;
+        new_block->used = 0;
+        new_block->next = head;
+        head = new_block;
+    }
+
+    void* ptr = (uint8_t*)(head + 1) + head->used;
+    head->used += aligned_size;
+    return ptr;
+}
+
+/*----------------------------------------------------------------------------
+ * duplicate
+ *----------------------------------------------------------------------------*/
+char* StringLib::Arena::duplicate(const char* str, int size)
+{
+    int len;
+    if(str == NULL) return NULL;
+    if(size > 0) len = (int)strnlen(str, size - 1) + 1;
+    else len = (int)strlen(str) + 1;
+    char* dup = (char*)alloc(len);
+    StringLib::copy(dup, str, len);
+    return dup;
+}
+
+/*----------------------------------------------------------------------------
+ * concat
+ *----------------------------------------------------------------------------*/
+char* StringLib::Arena::concat(const char* str1, const char* str2, const char* str3)
+{
+    long str1len = str1 ? strlen(str1) : 0;
+    long str2len = str2 ? strlen(str2) : 0;
+    long str3len = str3 ? strlen(str3) : 0;
+
+    char* dst = (char*)alloc(str1len + str2len + str3len + 1);
+    if(str1) memcpy(dst, str1, str1len);
+    if(str2) memcpy(dst + str1len, str2, str2len);
+    if(str3) memcpy(dst + str1len + str2len, str3, str3len);
+    dst[str1len + str2len + str3len] = '\0';
+
+    return dst;
+}
+
+/*----------------------------------------------------------------------------
+ * reset
+ *
+ *  frees everything allocated from the arena
+ *----------------------------------------------------------------------------*/
+void StringLib::Arena::reset(void)
+{
+    while(head)
+    {
+        block_t* next = head->next;
+        delete [] (uint64_t*)head;
+        head = next;
+    }
+}
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -514,6 +844,31 @@ char* StringLib::duplicate(const char* str1, int size)
     return dup;
 }
 
+/*----------------------------------------------------------------------------
+ * intern
+ *
+ *  returns a process wide copy of the string; equal strings return the same
+ *  pointer, which must not be freed and remains valid for the life of the
+ *  process
+ *----------------------------------------------------------------------------*/
+const char* StringLib::intern(const char* str)
+{
+    if(str == NULL) return NULL;
+
+    const char* interned = NULL;
+    internMut.lock();
+    {
+        if(!internTable.find(str, &interned))
+        {
+            interned = duplicate(str);
+            internTable.add(interned, interned);
+        }
+    }
+    internMut.unlock();
+
+    return interned;
+}
+
 /*----------------------------------------------------------------------------
  * concat
  *
@@ -589,6 +944,120 @@ int StringLib::formats(char* dststr, int size, const char* _format, ...)
     return slen;
 }
 
+/*----------------------------------------------------------------------------
+ * long2str
+ *
+ *  no memory allocated; formats as "%lld" without going through vsnprintf
+ *  returns size of formatted string (not including null terminator)
+ *----------------------------------------------------------------------------*/
+int StringLib::long2str(char* dststr, int size, long long val)
+{
+    if(dststr == NULL || size < 2) return 0;
+    if(val >= 0) return ulong2str(dststr, size, (unsigned long long)val);
+    dststr[0] = '-';
+    int len = ulong2str(&dststr[1], size - 1, 0ULL - (unsigned long long)val);
+    return (len > 0) ? len + 1 : 0;
+}
+
+/*----------------------------------------------------------------------------
+ * ulong2str
+ *
+ *  no memory allocated; formats as "%llu" two digits at a time
+ *  returns size of formatted string (not including null terminator)
+ *----------------------------------------------------------------------------*/
+int StringLib::ulong2str(char* dststr, int size, unsigned long long val)
+{
+    char digits[24];
+    int i = sizeof(digits);
+
+    if(dststr == NULL) return 0;
+
+    while(val >= 100)
+    {
+        int d = (int)(val % 100) * 2;
+        val /= 100;
+        digits[--i] = DIGIT_PAIRS[d + 1];
+        digits[--i] = DIGIT_PAIRS[d];
+    }
+
+    if(val >= 10)
+    {
+        int d = (int)val * 2;
+        digits[--i] = DIGIT_PAIRS[d + 1];
+        digits[--i] = DIGIT_PAIRS[d];
+    }
+    else
+    {
+        digits[--i] = '0' + (char)val;
+    }
+
+    int len = sizeof(digits) - i;
+    if(len >= size) return 0;
+    memcpy(dststr, &digits[i], len);
+    dststr[len] = '\0';
+    return len;
+}
+
+/*----------------------------------------------------------------------------
+ * double2str
+ *
+ *  no memory allocated; formats as "%.<precision>lf", using integer
+ *  arithmetic for values that fit and vsnprintf for everything else
+ *  returns size of formatted string (not including null terminator)
+ *----------------------------------------------------------------------------*/
+int StringLib::double2str(char* dststr, int size, double val, int precision)
+{
+    static const unsigned long long scales[] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+                                                1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL};
+    static const int MAX_FAST_SIZE = 32; // sign + 16 integer digits + point + 9 fractional digits
+    static const double MAX_FAST_VALUE = 4.0e15; // scaled values below 2^52 have a resolution of at least 0.5
+
+    if(dststr == NULL) return 0;
+
+    /* Scale */
+    unsigned long long scale = (precision >= 0 && precision <= 9) ? scales[precision] : 0;
+    double prod = fabs(val) * (double)scale;
+
+    /* Fall Back to vsnprintf */
+    if(scale == 0 || !(prod < MAX_FAST_VALUE) || size < MAX_FAST_SIZE)
+    {
+        return formats(dststr, size, "%.*lf", precision, val);
+    }
+
+    /* Round Half to Even on the Exact Product (matches vsnprintf) */
+    double err = fma(fabs(val), (double)scale, -prod);
+    double whole = floor(prod);
+    double frac = prod - whole;
+    unsigned long long scaled = (unsigned long long)whole;
+    if(frac > 0.5 || (frac == 0.5 && (err > 0.0 || (err == 0.0 && (scaled & 1)))))
+    {
+        scaled++;
+    }
+
+    /* Sign */
+    char* p = dststr;
+    if(signbit(val)) *p++ = '-';
+
+    /* Integer Part */
+    p += ulong2str(p, MAX_FAST_SIZE, scaled / scale);
+
+    /* Fractional Part */
+    if(precision > 0)
+    {
+        unsigned long long digits = scaled % scale;
+        *p++ = '.';
+        for(int i = precision - 1; i >= 0; i--)
+        {
+            p[i] = '0' + (char)(digits % 10);
+            digits /= 10;
+        }
+        p += precision;
+    }
+
+    *p = '\0';
+    return (int)(p - dststr);
+}
+
 /*----------------------------------------------------------------------------
  * copy
  *----------------------------------------------------------------------------*/
@@ -1000,10 +1469,18 @@ char* StringLib::b64encode(const void* data, int* size)
     str[encoded_len - 2] = '=';
 
     unsigned char *p = (unsigned  char*) data;
-    size_t j = 0, pad = len % 3;
+    size_t i = 0, j = 0, pad = len % 3;
     const size_t last = len - pad;
 
-    for (size_t i = 0; i < last; i += 3)
+#if defined(__AVX2__)
+    i = b64encodeAVX2(p, len, str);
+    j = i / 3 * 4;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    i = b64encodeNEON(p, last, B64CHARS, str);
+    j = i / 3 * 4;
+#endif
+
+    for (; i < last; i += 3)
     {
         int n = int(p[i]) << 16 | int(p[i + 1]) << 8 | p[i + 2];
         str[j++] = B64CHARS[n >> 18];
@@ -1049,7 +1526,16 @@ unsigned char* StringLib::b64decode(const void* data, int* size)
     str[decoded_len - 1] = '\0';
     str[decoded_len - 2] = '\0';
 
-    for (size_t i = 0; i < last; i += 4)
+    size_t i = 0;
+#if defined(__AVX2__)
+    i = b64decodeAVX2(p, last, str, decoded_len);
+    j = i / 4 * 3;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    i = b64decodeNEON(p, last, str);
+    j = i / 4 * 3;
+#endif
+
+    for (; i < last; i += 4)
     {
         int n = B64INDEX[p[i]] << 18 | B64INDEX[p[i + 1]] << 12 | B64INDEX[p[i + 2]] << 6 | B64INDEX[p[i + 3]];
         str[j++] = n >> 16;
@@ -1093,7 +1579,14 @@ char* StringLib::b16encode(const void* data, int size, bool lower_case, char* ds
     str[encoded_len] = '\0';
 
     uint8_t* data_ptr = (uint8_t*)data;
-    for(int i = 0, j = 0; i < size; i++)
+    int i = 0;
+#if defined(__AVX2__)
+    i = (int)b16encodeAVX2(data_ptr, size, digits, str);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    i = (int)b16encodeNEON(data_ptr, size, digits, str);
+#endif
+
+    for(int j = i * 2; i < size; i++)
     {
         str[j++] = digits[data_ptr[i] >> 4];
         str[j++] = digits[data_ptr[i] & 0x0F];
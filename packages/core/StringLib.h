@@ -85,6 +85,39 @@ class StringLib
                 long    maxlen;
         };
 
+        /*--------------------------------------------------------------------
+         * Arena (subclass)
+         *
+         *  bump allocator for strings that share a lifetime (e.g. a request);
+         *  nothing is freed individually, all memory is released together
+         *--------------------------------------------------------------------*/
+
+        class Arena
+        {
+            public:
+
+                static const long DEFAULT_BLOCK_SIZE = 4096;
+
+                                Arena       (long _block_size=DEFAULT_BLOCK_SIZE);
+                                ~Arena      (void);
+
+                void*           alloc       (long size);
+                char*           duplicate   (const char* str, int size=MAX_STR_SIZE);
+                char*           concat      (const char* str1, const char* str2, const char* str3=NULL);
+                void            reset       (void);
+
+            private:
+
+                typedef struct block {
+                    struct block*   next;
+                    long            size;   // bytes of data following header
+                    long            used;
+                } block_t;
+
+                block_t*    head;
+                long        blockSize;
+        };
+
         /*--------------------------------------------------------------------
          * Typedefs
          *--------------------------------------------------------------------*/
@@ -98,8 +131,12 @@ class StringLib
         static char*            duplicate       (const char* str, int size=MAX_STR_SIZE);
         static char*            concat          (const char* str1, const char* str2, const char* str3=NULL);
         static void             concat          (char* str1, const char* str2, int size);
+        static const char*      intern          (const char* str);
         static char*            format          (char* dststr, int size, const char* _format, ...) VARG_CHECK(printf, 3, 4);
         static int              formats         (char* dststr, int size, const char* _format, ...) VARG_CHECK(printf, 3, 4);
+        static int              long2str        (char* dststr, int size, long long val);
+        static int              ulong2str       (char* dststr, int size, unsigned long long val);
+        static int              double2str      (char* dststr, int size, double val, int precision);
         static char*            copy            (char* dst, const char* src, int _size);
         static char*            find            (const char* big, const char* little, int len=MAX_STR_SIZE);
         static char*            find            (const char* str, const char c, bool first=true);
@@ -132,6 +169,7 @@ class StringLib
 
         static const char* B64CHARS;
         static const int B64INDEX[256];
+        static const char* DIGIT_PAIRS;
 };
 
 /*---------------------------------------------------------------------------
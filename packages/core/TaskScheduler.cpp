@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "TaskScheduler.h"
+#include "core.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+TaskScheduler::worker_t*        TaskScheduler::workers = NULL;
+Thread**                        TaskScheduler::workerPid = NULL;
+int                             TaskScheduler::numWorkers = 0;
+bool                            TaskScheduler::active = false;
+Cond                            TaskScheduler::signals(NUM_SIGS);
+std::atomic<long>               TaskScheduler::numQueued(0);
+std::atomic<int>                TaskScheduler::numSleeping(0);
+std::atomic<unsigned>           TaskScheduler::nextDeque(0);
+thread_local int                TaskScheduler::localWorker = -1;
+
+/******************************************************************************
+ * GROUP SUBCLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Group::Constructor
+ *----------------------------------------------------------------------------*/
+TaskScheduler::Group::Group (void):
+    pending(0)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * Group::Destructor
+ *----------------------------------------------------------------------------*/
+TaskScheduler::Group::~Group (void)
+{
+    wait();
+}
+
+/*----------------------------------------------------------------------------
+ * Group::submit
+ *
+ *  the task runs on the calling thread when the pool is not running or the
+ *  selected deque is full
+ *----------------------------------------------------------------------------*/
+void TaskScheduler::Group::submit (task_func_t func, void* parm)
+{
+    task_t task = {func, parm, this};
+    pending++;
+    if(!active || !push(task))
+    {
+        run(task);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Group::wait
+ *
+ *  runs queued tasks, from any group, until every task of this group is done
+ *----------------------------------------------------------------------------*/
+void TaskScheduler::Group::wait (void)
+{
+    while(pending > 0)
+    {
+        task_t task;
+        if(pop(&task))
+        {
+            run(task);
+        }
+        else
+        {
+            /* Remaining Tasks Are Running Elsewhere */
+            signals.lock();
+            {
+                if(pending > 0 && numQueued == 0)
+                {
+                    signals.wait(GROUP_DONE, SYS_TIMEOUT);
+                }
+            }
+            signals.unlock();
+        }
+    }
+}
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void TaskScheduler::init (int num_workers)
+{
+    if(active) return;
+
+    numWorkers = num_workers > 0 ? num_workers : LocalLib::nproc();
+    numWorkers = MAX(MIN(numWorkers, MAX_WORKERS), 1);
+
+    workers = new worker_t [numWorkers];
+    for(int w = 0; w < numWorkers; w++)
+    {
+        workers[w].head = 0;
+        workers[w].tail = 0;
+    }
+
+    active = true;
+    workerPid = new Thread* [numWorkers];
+    for(int w = 0; w < numWorkers; w++)
+    {
+        workerPid[w] = new Thread(workerThread, &workers[w]);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * deinit
+ *
+ *  tasks still queued when the pool stops are run by the stopping thread
+ *----------------------------------------------------------------------------*/
+void TaskScheduler::deinit (void)
+{
+    if(!active) return;
+
+    /* Stop Workers */
+    signals.lock();
+    {
+        active = false;
+        signals.signal(TASK_READY, Cond::NOTIFY_ALL);
+    }
+    signals.unlock();
+    for(int w = 0; w < numWorkers; w++)
+    {
+        delete workerPid[w];
+    }
+    delete [] workerPid;
+    workerPid = NULL;
+
+    /* Drain Deques */
+    task_t task;
+    while(pop(&task)) run(task);
+
+    delete [] workers;
+    workers = NULL;
+    numWorkers = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * getWorkers
+ *----------------------------------------------------------------------------*/
+int TaskScheduler::getWorkers (void)
+{
+    return numWorkers;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * workerThread
+ *----------------------------------------------------------------------------*/
+void* TaskScheduler::workerThread (void* parm)
+{
+    worker_t* worker = (worker_t*)parm;
+    localWorker = worker - workers;
+
+    while(active)
+    {
+        task_t task;
+        if(pop(&task))
+        {
+            run(task);
+        }
+        else
+        {
+            /*
+             * Sleep Until Work Is Queued
+             *  the sleeping count is raised before the queued count is
+             *  checked, and push() raises the queued count before checking
+             *  the sleeping count, so a task is never left without a waker
+             */
+            signals.lock();
+            {
+                numSleeping++;
+                if(active && numQueued == 0)
+                {
+                    signals.wait(TASK_READY, SYS_TIMEOUT);
+                }
+                numSleeping--;
+            }
+            signals.unlock();
+        }
+    }
+
+    localWorker = -1;
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * push
+ *
+ *  workers push onto their own deque, other threads onto the next deque in
+ *  round-robin order
+ *----------------------------------------------------------------------------*/
+bool TaskScheduler::push (const task_t& task)
+{
+    int index = localWorker >= 0 ? localWorker : (int)(nextDeque++ % numWorkers);
+    worker_t* worker = &workers[index];
+
+    /* Add Task to Back of Deque */
+    bool status = false;
+    worker->mut.lock();
+    {
+        if(worker->tail - worker->head < DEQUE_SIZE)
+        {
+            worker->deque[worker->tail % DEQUE_SIZE] = task;
+            worker->tail++;
+            status = true;
+        }
+    }
+    worker->mut.unlock();
+    if(!status) return false;
+
+    /* Wake a Sleeping Worker */
+    numQueued++;
+    if(numSleeping > 0)
+    {
+        signals.lock();
+        {
+            signals.signal(TASK_READY, Cond::NOTIFY_ONE);
+        }
+        signals.unlock();
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * pop
+ *
+ *  a worker takes the newest task of its own deque, which is the one most
+ *  likely still in cache; otherwise the oldest task of another deque is
+ *  stolen, which for nested submissions tends to be the largest
+ *----------------------------------------------------------------------------*/
+bool TaskScheduler::pop (task_t* task)
+{
+    if(numQueued == 0 || numWorkers == 0) return false;
+
+    /* Take From Own Deque */
+    if(localWorker >= 0)
+    {
+        worker_t* worker = &workers[localWorker];
+        bool found = false;
+        worker->mut.lock();
+        {
+            if(worker->tail > worker->head)
+            {
+                worker->tail--;
+                *task = worker->deque[worker->tail % DEQUE_SIZE];
+                found = true;
+            }
+        }
+        worker->mut.unlock();
+        if(found)
+        {
+            numQueued--;
+            return true;
+        }
+    }
+
+    /* Steal From Other Deques */
+    int start = localWorker >= 0 ? localWorker + 1 : (int)(nextDeque % numWorkers);
+    for(int i = 0; i < numWorkers; i++)
+    {
+        worker_t* victim = &workers[(start + i) % numWorkers];
+        if(victim->tail.load(std::memory_order_relaxed) == victim->head.load(std::memory_order_relaxed)) continue; // unlocked peek, rechecked below
+
+        bool found = false;
+        victim->mut.lock();
+        {
+            if(victim->tail > victim->head)
+            {
+                *task = victim->deque[victim->head % DEQUE_SIZE];
+                victim->head++;
+                found = true;
+            }
+        }
+        victim->mut.unlock();
+        if(found)
+        {
+            numQueued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * run
+ *----------------------------------------------------------------------------*/
+void TaskScheduler::run (const task_t& task)
+{
+    try
+    {
+        task.func(task.parm);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Unhandled exception in scheduled task: %s", e.what());
+    }
+
+    /* Wake Threads Waiting on Group */
+    if(--task.group->pending == 0)
+    {
+        signals.lock();
+        {
+            signals.signal(GROUP_DONE, Cond::NOTIFY_ALL);
+        }
+        signals.unlock();
+    }
+}
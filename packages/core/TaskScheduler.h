@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __task_scheduler__
+#define __task_scheduler__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+#include <atomic>
+
+/******************************************************************************
+ * TASK SCHEDULER CLASS
+ ******************************************************************************/
+
+/*
+ * Process wide pool of workers that dispatch objects hand sub-tasks to from
+ * inside processRecord.  Each worker owns a deque of tasks; a worker runs
+ * the newest task of its own deque and, when that is empty, steals the
+ * oldest task of another worker's deque.  Tasks submitted from threads that
+ * are not workers (e.g. RecordDispatcher threads) are spread round-robin
+ * over the deques.  A thread waiting on a group runs queued tasks itself
+ * until the group is done, so waiting never idles a thread and nested
+ * submissions cannot deadlock.  Since the pool is shared by every
+ * dispatcher in the process, a dispatcher with a few large records borrows
+ * the cores left idle by the others.
+ */
+class TaskScheduler
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int MAX_WORKERS = 256;
+        static const int DEQUE_SIZE = 1024;     // per worker; tasks submitted to a full deque run inline
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef void (*task_func_t) (void* parm);
+
+        /*--------------------------------------------------------------------
+         * Group Subclass
+         *--------------------------------------------------------------------*/
+
+        /* Tasks Waited On Together */
+        class Group
+        {
+            public:
+
+                        Group       (void);
+                        ~Group      (void);     // waits on outstanding tasks
+
+                void    submit      (task_func_t func, void* parm);
+                void    wait        (void);
+
+            private:
+
+                friend class TaskScheduler;
+                std::atomic<int> pending;
+        };
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void     init        (int num_workers=0); // zero sizes the pool to the node
+        static void     deinit      (void);
+        static int      getWorkers  (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            task_func_t     func;
+            void*           parm;
+            Group*          group;
+        } task_t;
+
+        typedef struct {
+            Mutex           mut;
+            task_t          deque[DEQUE_SIZE];
+            std::atomic<long> head;     // oldest task, stolen by other workers
+            std::atomic<long> tail;     // one past newest task, run by the owner
+        } worker_t;
+
+        typedef enum {
+            TASK_READY = 0,
+            GROUP_DONE = 1,
+            NUM_SIGS = 2
+        } signal_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static worker_t*                workers;
+        static Thread**                 workerPid;
+        static int                      numWorkers;
+        static bool                     active;
+        static Cond                     signals;
+        static std::atomic<long>        numQueued;
+        static std::atomic<int>         numSleeping;
+        static std::atomic<unsigned>    nextDeque;
+        static thread_local int         localWorker;    // index of the calling worker, -1 if not a worker
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void*    workerThread    (void* parm);
+        static bool     push            (const task_t& task);
+        static bool     pop             (task_t* task);
+        static void     run             (const task_t& task);
+};
+
+#endif  /* __task_scheduler__ */
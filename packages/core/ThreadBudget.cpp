@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "ThreadBudget.h"
+#include "core.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+Mutex                   ThreadBudget::mut;
+ThreadBudget::stats_t   ThreadBudget::stats = {0, 0, 0, 0};
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void ThreadBudget::init (int budget)
+{
+    setBudget(budget > 0 ? budget : LocalLib::nproc() * DEFAULT_LOAD_FACTOR);
+}
+
+/*----------------------------------------------------------------------------
+ * setBudget
+ *----------------------------------------------------------------------------*/
+void ThreadBudget::setBudget (int budget)
+{
+    mut.lock();
+    {
+        stats.budget = MAX(budget, 1);
+    }
+    mut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * acquire
+ *
+ *  returns the number of threads granted, between one and wanted
+ *----------------------------------------------------------------------------*/
+int ThreadBudget::acquire (int wanted, int priority)
+{
+    if(wanted <= 0) return 0;
+    if(priority < LOW_PRIORITY) priority = LOW_PRIORITY;
+    else if(priority >= NUM_PRIORITIES) priority = HIGH_PRIORITY;
+
+    int granted;
+    mut.lock();
+    {
+        /* Determine Share of Unused Budget */
+        int unused = MAX(stats.budget - stats.in_use, 0);
+        int share = unused >> (HIGH_PRIORITY - priority);
+
+        /* Grant Threads */
+        granted = MAX(MIN(wanted, share), 1);
+        if(granted < wanted) stats.throttled++;
+        stats.in_use += granted;
+        stats.high_water = MAX(stats.high_water, stats.in_use);
+    }
+    mut.unlock();
+
+    return granted;
+}
+
+/*----------------------------------------------------------------------------
+ * reserve
+ *----------------------------------------------------------------------------*/
+void ThreadBudget::reserve (int count)
+{
+    if(count <= 0) return;
+
+    mut.lock();
+    {
+        stats.in_use += count;
+        stats.high_water = MAX(stats.high_water, stats.in_use);
+    }
+    mut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *----------------------------------------------------------------------------*/
+void ThreadBudget::release (int count)
+{
+    if(count <= 0) return;
+
+    mut.lock();
+    {
+        stats.in_use -= count;
+        assert(stats.in_use >= 0);
+    }
+    mut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * getStats
+ *----------------------------------------------------------------------------*/
+void ThreadBudget::getStats (stats_t* _stats)
+{
+    mut.lock();
+    {
+        *_stats = stats;
+    }
+    mut.unlock();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __thread_budget__
+#define __thread_budget__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+
+/******************************************************************************
+ * THREAD BUDGET CLASS
+ ******************************************************************************/
+
+/*
+ * Process wide accounting of the threads started on behalf of requests.
+ * Threads that a component needs in order to function at all (a thread per
+ * track, the threads of a dispatcher) are reserved and always admitted;
+ * threads that only add parallelism (subsetting partitions, chunk workers)
+ * are acquired, and are granted at most a share of what is left of the
+ * budget, where the share depends on the priority of the request.  Every
+ * acquisition is granted at least one thread so that a request always
+ * makes progress, which means the budget can be exceeded by the threads of
+ * concurrent requests but not multiplied by them.
+ */
+class ThreadBudget
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DEFAULT_LOAD_FACTOR = 4;   // budgeted threads per core
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            LOW_PRIORITY = 0,       // up to a quarter of the unused budget
+            NORMAL_PRIORITY = 1,    // up to half of the unused budget
+            HIGH_PRIORITY = 2,      // up to all of the unused budget
+            NUM_PRIORITIES = 3
+        } priority_t;
+
+        typedef struct {
+            int         budget;
+            int         in_use;
+            int         high_water;
+            long        throttled;  // acquisitions granted fewer threads than wanted
+        } stats_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void     init        (int budget=0); // zero sizes the budget to the node
+        static void     setBudget   (int budget);
+        static int      acquire     (int wanted, int priority=NORMAL_PRIORITY);
+        static void     reserve     (int count);
+        static void     release     (int count);
+        static void     getStats    (stats_t* stats);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static Mutex    mut;
+        static stats_t  stats;
+};
+
+#endif  /* __thread_budget__ */
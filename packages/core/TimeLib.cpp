@@ -194,6 +194,48 @@ TimeLib::gmt_time_t TimeLib::gps2gmttime(int64_t ms)
     return cds2gmttime((int)(ms / TIME_MILLISECS_IN_A_DAY), (int)(ms % TIME_MILLISECS_IN_A_DAY));
 }
 
+/*----------------------------------------------------------------------------
+ * gps2gmt_batch
+ *
+ *  converts an array of gps times (milliseconds since GPS epoch) to GMT time;
+ *  the date and leap seconds are calculated once per day and reused for all
+ *  subsequent times that fall within that day, so sorted or clustered inputs
+ *  only pay for the time of day arithmetic
+ *----------------------------------------------------------------------------*/
+void TimeLib::gps2gmt_batch(const int64_t* ms, gmt_time_t* gmt, int n)
+{
+    gmt_time_t  day;
+    int64_t     day_start = 0;
+    int64_t     window_start = 0;
+    int64_t     window_end = 0; // empty window forces first lookup
+
+    for(int i = 0; i < n; i++)
+    {
+        int64_t gps_ms = ms[i];
+
+        /* Update Cached Day */
+        if(gps_ms < window_start || gps_ms >= window_end)
+        {
+            if(!gmtday(gps_ms, &day, &day_start, &window_start, &window_end))
+            {
+                gmt[i] = gps2gmttime(gps_ms);
+                continue;
+            }
+        }
+
+        /* Time of Day */
+        int64_t msecs = gps_ms - day_start;
+        gmt[i].year         = day.year;
+        gmt[i].doy          = day.doy;
+        gmt[i].hour         = (int)(msecs / TIME_MILLISECS_IN_AN_HOUR);
+        msecs              %= TIME_MILLISECS_IN_AN_HOUR;
+        gmt[i].minute       = (int)(msecs / TIME_MILLISECS_IN_A_MINUTE);
+        msecs              %= TIME_MILLISECS_IN_A_MINUTE;
+        gmt[i].second       = (int)(msecs / TIME_MILLISECS_IN_A_SECOND);
+        gmt[i].millisecond  = (int)(msecs % TIME_MILLISECS_IN_A_SECOND);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * cds2gmttime
  *
@@ -636,18 +678,8 @@ int TimeLib::daysinmonth (int year, int month)
  *----------------------------------------------------------------------------*/
 int TimeLib::getleapms(int64_t current_time, int64_t start_time)
 {
-    int start_index = leapCount;
-    int current_index = 0;
-
-    /* Find the index of the last leap second before the current time */
-    for (int i = leapCount - 1; i > 0; i--)
-    {
-        if (current_time > leapSeconds[i])
-        {
-            current_index = i;
-            break;
-        }
-    }
+    int start_index;
+    int current_index = leapindex(current_time);
 
     /* If not GPS_EPOCH_START, find the index of the supplied epoch*/
     if (start_time == TIME_GPS_EPOCH_START)
@@ -656,14 +688,16 @@ int TimeLib::getleapms(int64_t current_time, int64_t start_time)
     }
     else
     {
-       for (int i = 0; i < leapCount; i++)
-       {
-            if (start_time < leapSeconds[i])
-            {
-                start_index = i;
-                break;
-            }
+        /* Binary search for first leap second after start time */
+        int lo = 0;
+        int hi = leapCount;
+        while(lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if(start_time < leapSeconds[mid]) hi = mid;
+            else lo = mid + 1;
         }
+        start_index = lo;
     }
 
     /* Leap seconds elapsed between start time and current time */
@@ -741,6 +775,72 @@ void TimeLib::heartbeat(void)
     currentTimeMs = baseTimeMs + (runningTimeUs / 1000);
 }
 
+/*----------------------------------------------------------------------------
+ * leapindex
+ *
+ *  index of the last leap second before the current time (unix milliseconds);
+ *  the first entry of the table is never selected, matching getleapms
+ *----------------------------------------------------------------------------*/
+int TimeLib::leapindex(int64_t current_time)
+{
+    /* Binary search for number of leap seconds in [1, leapCount) before current time */
+    int lo = 1;
+    int hi = leapCount;
+    while(lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if(current_time > leapSeconds[mid]) lo = mid + 1;
+        else hi = mid;
+    }
+
+    /* Last leap second before current time, or 0 if none */
+    return (lo > 1) ? lo - 1 : 0;
+}
+
+/*----------------------------------------------------------------------------
+ * gmtday
+ *
+ *  calculates the GMT day containing the gps time along with the window of
+ *  gps times over which that day and the leap second count stay constant;
+ *  returns false for times before the epoch which are left to gps2gmttime
+ *----------------------------------------------------------------------------*/
+bool TimeLib::gmtday(int64_t ms, gmt_time_t* day, int64_t* day_start, int64_t* window_start, int64_t* window_end)
+{
+    /* Leap Seconds */
+    int64_t unix_ms = TIME_GPS_TO_UNIX(ms);
+    int index = leapindex(unix_ms);
+    int64_t leap_ms = getleapms(unix_ms);
+
+    /* Start of Day (gps milliseconds) */
+    int64_t utc_ms = ms - leap_ms;
+    if(utc_ms < 0) return false;
+    *day_start = ((utc_ms / TIME_MILLISECS_IN_A_DAY) * TIME_MILLISECS_IN_A_DAY) + leap_ms;
+
+    /* Date */
+    *day = gps2gmttime(ms);
+    day->hour = 0;
+    day->minute = 0;
+    day->second = 0;
+    day->millisecond = 0;
+
+    /* Window - day clipped to range where leap seconds are constant */
+    *window_start = *day_start;
+    *window_end = *day_start + TIME_MILLISECS_IN_A_DAY;
+    if(index > 0)
+    {
+        int64_t leap_start = TIME_UNIX_TO_GPS(leapSeconds[index]) + 1;
+        if(leap_start > *window_start) *window_start = leap_start;
+    }
+    if(index + 1 < leapCount)
+    {
+        int64_t leap_end = TIME_UNIX_TO_GPS(leapSeconds[index + 1]) + 1;
+        if(leap_end < *window_end) *window_end = leap_end;
+    }
+
+    /* Requested time must be inside the window for the day to be valid */
+    return (ms >= *window_start && ms < *window_end);
+}
+
 /*----------------------------------------------------------------------------
  * parsenistfile - parses leap-seconds.list file from NIST
  *----------------------------------------------------------------------------*/
@@ -108,6 +108,7 @@ class TimeLib
         static int64_t      gettimems       (int64_t now=USE_CURRENT_TIME); // optimized, returns milliseconds since gps epoch
         static gmt_time_t   gettime         (int64_t now=USE_CURRENT_TIME); // returns GMT time (includes leap seconds)
         static gmt_time_t   gps2gmttime     (int64_t ms); // returns GMT time (includes leap seconds), takes gps time as milliseconds since gps epoch
+        static void         gps2gmt_batch   (const int64_t* ms, gmt_time_t* gmt, int n); // converts n gps times, reusing the date of the previous conversion when within the same day
         static gmt_time_t   cds2gmttime     (int days, int msecs); // returns GMT time (includes leap seconds)
         static date_t       gmt2date        (const gmt_time_t& gmt_time); // returns date (taking into account leap years)
         static int64_t      gmt2gpstime     (const gmt_time_t& gmt_time); // returns milliseconds from gps epoch to time specified in gmt_time
@@ -154,6 +155,8 @@ class TimeLib
 
         static void heartbeat(void);
         static void parsenistfile(void);
+        static int  leapindex(int64_t current_time);
+        static bool gmtday(int64_t ms, gmt_time_t* day, int64_t* day_start, int64_t* window_start, int64_t* window_end);
 };
 
 #endif  /* __time_lib__ */
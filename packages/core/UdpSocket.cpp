@@ -152,6 +152,24 @@ int UdpSocket::readBuffer(void* buf, int len, int timeout)
     return SockLib::sockrecv(sock, buf, len, timeout);
 }
 
+/*----------------------------------------------------------------------------
+ * readBatch
+ *----------------------------------------------------------------------------*/
+int UdpSocket::readBatch(void** bufs, int* lens, int n, int timeout)
+{
+    if(bufs == NULL || lens == NULL || n <= 0) return PARM_ERR_RC;
+    return SockLib::sockrecvbatch(sock, bufs, lens, n, timeout);
+}
+
+/*----------------------------------------------------------------------------
+ * writeBatch
+ *----------------------------------------------------------------------------*/
+int UdpSocket::writeBatch(const void** bufs, const int* lens, int n, int timeout)
+{
+    if(bufs == NULL || lens == NULL || n <= 0) return PARM_ERR_RC;
+    return SockLib::socksendbatch(sock, bufs, lens, n, timeout);
+}
+
 /*----------------------------------------------------------------------------
  * getUniqueId
  *----------------------------------------------------------------------------*/
@@ -60,6 +60,8 @@ class UdpSocket: public DeviceObject
         void            closeConnection     (void) override;
         int             writeBuffer         (const void* buf, int len, int timeout=SYS_TIMEOUT) override;
         int             readBuffer          (void* buf, int len, int timeout=SYS_TIMEOUT) override;
+        int             readBatch           (void** bufs, int* lens, int n, int timeout=SYS_TIMEOUT) override;
+        int             writeBatch          (const void** bufs, const int* lens, int n, int timeout=SYS_TIMEOUT) override;
         int             getUniqueId         (void) override;
         const char*     getConfig           (void) override;
 
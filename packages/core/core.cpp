@@ -80,11 +80,13 @@ static int core_open (lua_State *L)
         {"tcp",             TcpSocket::luaCreate},
         {"uart",            Uart::luaCreate},
         {"udp",             UdpSocket::luaCreate},
+        {"shmq",            ShmQueue::luaCreate},
         {"reader",          DeviceReader::luaCreate},
         {"writer",          DeviceWriter::luaCreate},
         {"httpd",           HttpServer::luaCreate},
         {"http",            HttpClient::luaCreate},
         {"endpoint",        LuaEndpoint::luaCreate},
+        {"prometheus",      MetricEndpoint::luaCreate},
         {"dispatcher",      RecordDispatcher::luaCreate},
         {"capture",         CaptureDispatch::luaCreate},
         {"limit",           LimitDispatch::luaCreate},
@@ -97,6 +99,10 @@ static int core_open (lua_State *L)
         {"pointindex",      PointIndex::luaCreate},
         {"intervalindex",   IntervalIndex::luaCreate},
         {"spatialindex",    SpatialIndex::luaCreate},
+        {"replay",          ReplayIODriver::luaConfig},
+        {"replaystats",     ReplayIODriver::luaStats},
+        {"filemode",        FileIODriver::luaMode},
+        {"scheduler",       LuaEngine::luaScheduler},
         {NULL,              NULL}
     };
 
@@ -116,6 +122,7 @@ static int core_open (lua_State *L)
     LuaEngine::setAttrInt   (L, "FMT_JSON",                 Monitor::JSON);
     LuaEngine::setAttrInt   (L, "FMT_CLOUD",                Monitor::CLOUD);
     LuaEngine::setAttrInt   (L, "FMT_RECORD",               Monitor::RECORD);
+    LuaEngine::setAttrInt   (L, "FMT_BINARY",               Monitor::BINARY);
     LuaEngine::setAttrStr   (L, "EVENTQ",                   EVENTQ);
     LuaEngine::setAttrInt   (L, "STRING",                   RecordObject::TEXT);
     LuaEngine::setAttrInt   (L, "REAL",                     RecordObject::REAL);
@@ -137,6 +144,9 @@ static int core_open (lua_State *L)
     LuaEngine::setAttrInt   (L, "FIFO",                     File::FIFO);
     LuaEngine::setAttrInt   (L, "FLUSHED",                  File::FLUSHED);
     LuaEngine::setAttrInt   (L, "CACHED",                   File::CACHED);
+    LuaEngine::setAttrInt   (L, "MAPPED",                   File::MAPPED);
+    LuaEngine::setAttrInt   (L, "ASYNC",                    File::ASYNC);
+    LuaEngine::setAttrInt   (L, "DIRECT",                   File::DIRECT);
     LuaEngine::setAttrInt   (L, "NORTH_POLAR",              MathLib::NORTH_POLAR);
     LuaEngine::setAttrInt   (L, "SOUTH_POLAR",              MathLib::SOUTH_POLAR);
     LuaEngine::setAttrInt   (L, "PEND",                     IO_PEND);
@@ -166,15 +176,21 @@ void initcore (void)
     TTYLib::init();
     TimeLib::init();
     EventLib::init(EVENTQ);
+    TaskScheduler::init();
+    ThreadBudget::init();
 
-    /* Register File IO Driver */
+    /* Register File IO Drivers */
     Asset::registerDriver(FileIODriver::FORMAT, FileIODriver::create);
+    Asset::registerDriver(ReplayIODriver::FORMAT, ReplayIODriver::create);
 
     /* Attach OsApi Print Function */
     LocalLib::setPrint(os_print);
 
     /* Initialize Modules */
     LuaEndpoint::init();
+    RecordDispatcher::init();
+    Profiler::init();
+    RequestAccount::init();
 
     /* Initialize Default Lua Extensions */
     LuaLibrarySys::lsys_init();
@@ -204,10 +220,13 @@ void deinitcore (void)
     /* Clean up libraries initialized in initcore() */
     print2term("Exiting... ");
     LuaEngine::deinit();
+    HttpClient::deinit();
+    TaskScheduler::deinit();
     EventLib::deinit();
     TimeLib::deinit();
     TTYLib::deinit();
     SockLib::deinit();
+    IoRing::deinit();
     MsgQ::deinit();
     LocalLib::deinit();
     print2term("cleanup complete (%d errors)\n", appErrors);
@@ -40,8 +40,10 @@
 
 #include "Asset.h"
 #include "AssetIndex.h"
+#include "AsyncFile.h"
 #include "CaptureDispatch.h"
 #include "ClusterSocket.h"
+#include "ConcurrentTable.h"
 #include "CsvDispatch.h"
 #include "DispatchObject.h"
 #include "DeviceIO.h"
@@ -49,14 +51,18 @@
 #include "DeviceReader.h"
 #include "DeviceWriter.h"
 #include "Dictionary.h"
+#include "FlatDictionary.h"
 #include "EndpointObject.h"
 #include "PointIndex.h"
 #include "File.h"
 #include "FileIODriver.h"
+#include "GzipStream.h"
 #include "HttpClient.h"
 #include "HttpServer.h"
+#include "LatencyHistogram.h"
 #include "LimitDispatch.h"
 #include "List.h"
+#include "ArrayList.h"
 #include "LimitRecord.h"
 #include "EventLib.h"
 #include "LuaEndpoint.h"
@@ -68,21 +74,31 @@
 #include "LuaScript.h"
 #include "MathLib.h"
 #include "MetricDispatch.h"
+#include "MetricEndpoint.h"
 #include "MetricRecord.h"
 #include "Monitor.h"
 #include "MsgBridge.h"
 #include "MsgProcessor.h"
 #include "MsgQ.h"
 #include "Ordering.h"
+#include "SkipOrdering.h"
+#include "Profiler.h"
 #include "PublisherDispatch.h"
+#include "QuantileSketch.h"
 #include "RecordObject.h"
+#include "RecordPool.h"
 #include "RecordDispatcher.h"
+#include "RequestAccount.h"
+#include "ReplayIODriver.h"
 #include "ReportDispatch.h"
 #include "RTExcept.h"
+#include "ShmQueue.h"
 #include "SpatialIndex.h"
 #include "StringLib.h"
 #include "Table.h"
+#include "TaskScheduler.h"
 #include "TcpSocket.h"
+#include "ThreadBudget.h"
 #include "IntervalIndex.h"
 #include "TimeLib.h"
 #include "Uart.h"
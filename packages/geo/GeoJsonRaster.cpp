@@ -38,6 +38,7 @@
 
 #include <uuid/uuid.h>
 #include <gdalwarper.h>
+#include <algorithm>
 
 
 /******************************************************************************
@@ -52,6 +53,9 @@
 
 const char* GeoJsonRaster::LuaMetaName = "GeoJsonRaster";
 
+Mutex GeoJsonRaster::bitmapMut;
+Dictionary<GeoJsonRaster::bitmap_t*> GeoJsonRaster::bitmapCache;
+
 const char* GeoJsonRaster::FILEDATA_KEY   = "data";
 const char* GeoJsonRaster::FILELENGTH_KEY = "length";
 const char* GeoJsonRaster::CELLSIZE_KEY   = "cellsize";
@@ -60,6 +64,32 @@ const char* GeoJsonRaster::CELLSIZE_KEY   = "cellsize";
  * PUBLIC METHODS
  ******************************************************************************/
 
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::init (void)
+{
+}
+
+/*----------------------------------------------------------------------------
+ * deinit
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::deinit (void)
+{
+    bitmapMut.lock();
+    {
+        bitmap_t* bm = NULL;
+        const char* key = bitmapCache.first(&bm);
+        while (key != NULL)
+        {
+            deleteBitmap(bm);
+            key = bitmapCache.next(&bm);
+        }
+        bitmapCache.clear();
+    }
+    bitmapMut.unlock();
+}
+
 /*----------------------------------------------------------------------------
  * luaCreate - file(
  *  {
@@ -116,6 +146,8 @@ GeoJsonRaster* GeoJsonRaster::create (lua_State* L, int index)
  *----------------------------------------------------------------------------*/
 bool GeoJsonRaster::includes(double lon, double lat)
 {
+    if(useBitmap) return testBitmap(lon, lat);
+
     List<sample_t> slist;
     int sampleCnt = sample (lon, lat, slist);
 
@@ -125,13 +157,40 @@ bool GeoJsonRaster::includes(double lon, double lat)
     return (static_cast<int>(slist[0].value) == RASTER_PIXEL_ON);
 }
 
+/*----------------------------------------------------------------------------
+ * includes - batch
+ *
+ *  populates inclusion for n points, returns number of points included
+ *----------------------------------------------------------------------------*/
+int GeoJsonRaster::includes(const double* lons, const double* lats, int n, bool* inclusion)
+{
+    int count = 0;
+    if(useBitmap)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            inclusion[i] = testBitmap(lons[i], lats[i]);
+            count += inclusion[i];
+        }
+    }
+    else
+    {
+        for(int i = 0; i < n; i++)
+        {
+            inclusion[i] = includes(lons[i], lats[i]);
+            count += inclusion[i];
+        }
+    }
+    return count;
+}
+
 /*----------------------------------------------------------------------------
  * Destructor
  *----------------------------------------------------------------------------*/
 GeoJsonRaster::~GeoJsonRaster(void)
 {
-    VSIUnlink(rasterFile.c_str());
     VSIUnlink(vrtFile.c_str());
+    releaseBitmap(bitmap);
 }
 
 /******************************************************************************
@@ -154,9 +213,137 @@ static void validatedParams(const char *file, long filelength, double _cellsize)
 
 /*----------------------------------------------------------------------------
  * Constructor
+ *
+ *  the geojson is rasterized once and cached by a hash of its contents, so
+ *  rasters created from the same file and cell size share the rasterization
  *----------------------------------------------------------------------------*/
 GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, long filelength, double _cellsize):
     VrtRaster(L, _parms)
+{
+    char uuid_str[UUID_STR_LEN] = {0};
+
+    validatedParams(file, filelength, _cellsize);
+
+    /* Build Cache Key - FNV-1a hash of geojson */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(long i = 0; i < filelength; i++)
+    {
+        hash ^= static_cast<uint8_t>(file[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    char key[MAX_STR_SIZE];
+    StringLib::format(key, MAX_STR_SIZE, "%016llx:%ld:%lf", (unsigned long long)hash, filelength, _cellsize);
+
+    /* Look Up Cached Rasterization */
+    bitmap = NULL;
+    bitmapMut.lock();
+    {
+        if(bitmapCache.find(key, &bitmap)) bitmap->refs++;
+    }
+    bitmapMut.unlock();
+
+    /* Rasterize GeoJson on Cache Miss */
+    if(!bitmap)
+    {
+        std::string rasterFile = "/vsimem/" + std::string(getUUID(uuid_str)) + ".tif";
+        bitmap_t* bm = rasterize(file, filelength, _cellsize, rasterFile.c_str());
+
+        bitmapMut.lock();
+        {
+            if(bitmapCache.find(key, &bitmap))
+            {
+                /* Lost race with another raster of the same geojson */
+                bitmap->refs++;
+            }
+            else
+            {
+                /* Evict unused entries to make room */
+                if(bitmapCache.length() >= MAX_CACHED_BITMAPS)
+                {
+                    bitmap_t* old_bm = NULL;
+                    const char* old_key = bitmapCache.first(&old_bm);
+                    while(old_key != NULL && bitmapCache.length() >= MAX_CACHED_BITMAPS)
+                    {
+                        if(old_bm->refs == 0)
+                        {
+                            bitmapCache.remove(old_key);
+                            deleteBitmap(old_bm);
+                            old_key = bitmapCache.first(&old_bm);
+                        }
+                        else
+                        {
+                            old_key = bitmapCache.next(&old_bm);
+                        }
+                    }
+                }
+
+                bitmap = bm;
+                bitmap->refs = 1;
+                bitmapCache.add(key, bitmap);
+                bm = NULL;
+            }
+        }
+        bitmapMut.unlock();
+
+        if(bm) deleteBitmap(bm);
+    }
+
+    /* Bitmap only answers nearest neighbour inclusion with no filtering */
+    useBitmap = !bitmap->row_runs.empty() &&
+                (parms->sampling_algo == GRIORA_NearestNeighbour) &&
+                !parms->filter_time && !parms->url_substring;
+
+    try
+    {
+        /* Create vrt file, used in base class as index data set */
+        vrtFile = "/vsimem/" + std::string(getUUID(uuid_str)) + ".vrt";
+        List<std::string> rasterList;
+        rasterList.add(bitmap->rasterFile);
+        buildVRT(vrtFile, rasterList);
+
+        /* Open vrt as base class geoindex file. */
+        openGeoIndex();
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error creating GeoJsonRaster: %s", e.what());
+        VSIUnlink(vrtFile.c_str());
+        releaseBitmap(bitmap);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "GeoJsonRaster failed");
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+ * getIndexFile
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::getIndexFile(std::string &file, double lon, double lat)
+{
+    std::ignore = lon;
+    std::ignore = lat;
+    file = vrtFile;
+}
+
+/*----------------------------------------------------------------------------
+ * getRasterDate
+ *----------------------------------------------------------------------------*/
+bool GeoJsonRaster::getRasterDate(raster_info_t& rinfo)
+{
+    rinfo.gmtDate = bitmap->gmtDate;
+    return true;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * rasterize
+ *
+ *  burns the geojson into raster_file and, when the geojson is in lon/lat,
+ *  run-length encodes the burned pixels so inclusion tests do not need gdal
+ *----------------------------------------------------------------------------*/
+GeoJsonRaster::bitmap_t* GeoJsonRaster::rasterize(const char* file, long filelength, double cellsize, const char* raster_file)
 {
     char uuid_str[UUID_STR_LEN] = {0};
     bool rasterCreated = false;
@@ -164,14 +351,20 @@ GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, l
     GDALDataset *jsonDset   = NULL;
     std::string  jsonFile;
 
-    jsonFile   = "/vsimem/" + std::string(getUUID(uuid_str)) + ".geojson";
-    rasterFile = "/vsimem/" + std::string(getUUID(uuid_str)) + ".tif";
-    vrtFile    = "/vsimem/" + std::string(getUUID(uuid_str)) + ".vrt";
-
-    /* Initialize Class Data Members */
-    bzero(&gmtDate, sizeof(TimeLib::gmt_time_t));
-
-    validatedParams(file, filelength, _cellsize);
+    uuid_t uuid;
+    uuid_generate(uuid);
+    uuid_unparse_lower(uuid, uuid_str);
+    jsonFile = "/vsimem/" + std::string(uuid_str) + ".geojson";
+
+    bitmap_t* bm = new bitmap_t;
+    bm->rasterFile = raster_file;
+    bzero(&bm->gmtDate, sizeof(TimeLib::gmt_time_t));
+    bm->cols = 0;
+    bm->rows = 0;
+    bm->lon_min = 0;
+    bm->lat_max = 0;
+    bm->cellsize = cellsize;
+    bm->refs = 0;
 
     try
     {
@@ -189,7 +382,6 @@ GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, l
         OGRErr ogrerr = srcLayer->GetExtent(&e);
         CHECK_GDALERR(ogrerr);
 
-        double cellsize = _cellsize;
         int cols = int((e.MaxX - e.MinX) / cellsize);
         int rows = int((e.MaxY - e.MinY) / cellsize);
 
@@ -198,7 +390,7 @@ GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, l
 
         GDALDriver *driver = GetGDALDriverManager()->GetDriverByName("GTiff");
         CHECKPTR(driver);
-        rasterDset = (GDALDataset *)driver->Create(rasterFile.c_str(), cols, rows, 1, GDT_Byte, options);
+        rasterDset = (GDALDataset *)driver->Create(raster_file, cols, rows, 1, GDT_Byte, options);
         CSLDestroy(options);
         CHECKPTR(rasterDset);
         double geot[6] = {e.MinX, cellsize, 0, e.MaxY, 0, -cellsize};
@@ -218,40 +410,53 @@ GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, l
         CHECKPTR(rb);
         rb->SetNoDataValue(RASTER_NODATA_VALUE);
 
-        /*
-         * Build params for GDALRasterizeLayers
-         * Raster with 1 band, using first layer from json vector
-         */
-        const int BANDCNT = 1;
-
-        int bandlist[BANDCNT];
-        bandlist[0] = bandInx;
-
-        OGRLayer *layers[BANDCNT];
-        layers[0] = srcLayer;
-
-        double burnValues[BANDCNT];
-        burnValues[0] = RASTER_PIXEL_ON;
-
-        CPLErr cplerr = GDALRasterizeLayers(rasterDset, 1, bandlist, 1, (OGRLayerH *)&layers[0], NULL, NULL, burnValues, NULL, NULL, NULL);
-        CHECK_GDALERR(cplerr);
-        mlog(DEBUG, "Rasterized geojson into raster %s", rasterFile.c_str());
+        /* Fixed geo-transform of the mask */
+        bm->cols = cols;
+        bm->rows = rows;
+        bm->lon_min = e.MinX;
+        bm->lat_max = e.MaxY;
+
+        /* Burn polygons natively when in lon/lat so the mask needs no transform */
+        OGRSpatialReference lonlat;
+        lonlat.importFromEPSG(DEFAULT_EPSG);
+        bool in_lonlat = srcSrs->IsSame(&lonlat) && cols > 0 && rows > 0;
+        if(in_lonlat && scanlineFill(srcLayer, bm))
+        {
+            writeRuns(rb, bm);
+            mlog(DEBUG, "Scanline filled geojson into raster %s with %ld runs", raster_file, (long)bm->runs.size() / 2);
+        }
+        else
+        {
+            /*
+             * Build params for GDALRasterizeLayers
+             * Raster with 1 band, using first layer from json vector
+             */
+            const int BANDCNT = 1;
+
+            int bandlist[BANDCNT];
+            bandlist[0] = bandInx;
+
+            OGRLayer *layers[BANDCNT];
+            layers[0] = srcLayer;
+
+            double burnValues[BANDCNT];
+            burnValues[0] = RASTER_PIXEL_ON;
+
+            CPLErr cplerr = GDALRasterizeLayers(rasterDset, 1, bandlist, 1, (OGRLayerH *)&layers[0], NULL, NULL, burnValues, NULL, NULL, NULL);
+            CHECK_GDALERR(cplerr);
+            mlog(DEBUG, "Rasterized geojson into raster %s", raster_file);
+
+            /* Encode burned pixels when geojson has geometries the scanline fill does not handle */
+            if(in_lonlat) readRuns(rb, bm);
+        }
 
         /* Store raster creation time */
-        gmtDate = TimeLib::gettime();
+        bm->gmtDate = TimeLib::gettime();
 
         /* Must close raster to flush it into file */
         GDALClose((GDALDatasetH)rasterDset);
         rasterDset = NULL;
 
-        /* Create vrt file, used in base class as index data set */
-        List<std::string> rasterList;
-        rasterList.add(rasterFile);
-        buildVRT(vrtFile, rasterList);
-
-        /* Open vrt as base class geoindex file. */
-        openGeoIndex();
-
         rasterCreated = true;
     }
     catch(const RunTimeException& e)
@@ -259,35 +464,237 @@ GeoJsonRaster::GeoJsonRaster(lua_State *L, GeoParms* _parms, const char *file, l
         mlog(e.level(), "Error creating GeoJsonRaster: %s", e.what());
     }
 
-   /* Cleanup */
-   VSIUnlink(jsonFile.c_str());
-   if (jsonDset) GDALClose((GDALDatasetH)jsonDset);
-   if (rasterDset) GDALClose((GDALDatasetH)rasterDset);
+    /* Cleanup */
+    VSIUnlink(jsonFile.c_str());
+    if (jsonDset) GDALClose((GDALDatasetH)jsonDset);
+    if (rasterDset) GDALClose((GDALDatasetH)rasterDset);
 
-   if (!rasterCreated)
+    if (!rasterCreated)
+    {
+        deleteBitmap(bm);
         throw RunTimeException(CRITICAL, RTE_ERROR, "GeoJsonRaster failed");
+    }
+
+    return bm;
 }
 
+/*----------------------------------------------------------------------------
+ * releaseBitmap
+ *
+ *  entries stay cached when no longer used and are evicted when the cache fills
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::releaseBitmap(bitmap_t* bm)
+{
+    bitmapMut.lock();
+    {
+        bm->refs--;
+    }
+    bitmapMut.unlock();
+}
 
 /*----------------------------------------------------------------------------
- * getIndexFile
+ * deleteBitmap
  *----------------------------------------------------------------------------*/
-void GeoJsonRaster::getIndexFile(std::string &file, double lon, double lat)
+void GeoJsonRaster::deleteBitmap(bitmap_t* bm)
 {
-    std::ignore = lon;
-    std::ignore = lat;
-    file = vrtFile;
+    VSIUnlink(bm->rasterFile.c_str());
+    delete bm;
 }
 
 /*----------------------------------------------------------------------------
- * getRasterDate
+ * scanlineFill
+ *
+ *  builds the runs of pixels whose centers are inside a polygon of the layer,
+ *  matching gdal's default rasterization; returns false if the layer has a
+ *  geometry other than a polygon, leaving the mask empty
  *----------------------------------------------------------------------------*/
-bool GeoJsonRaster::getRasterDate(raster_info_t& rinfo)
+bool GeoJsonRaster::scanlineFill(OGRLayer* layer, bitmap_t* bm)
 {
-    rinfo.gmtDate = gmtDate;
+    /* Build Edge Table - edges bucketed by first row crossed */
+    std::vector<std::vector<edge_t>> edge_table(bm->rows);
+    int num_polys = 0;
+    bool supported = true;
+
+    layer->ResetReading();
+    while (OGRFeature* feature = layer->GetNextFeature())
+    {
+        OGRGeometry* geo = feature->GetGeometryRef();
+        if(geo)
+        {
+            std::vector<OGRPolygon*> polys;
+            OGRwkbGeometryType type = wkbFlatten(geo->getGeometryType());
+            if(type == wkbPolygon)
+            {
+                polys.push_back(static_cast<OGRPolygon*>(geo));
+            }
+            else if(type == wkbMultiPolygon)
+            {
+                OGRMultiPolygon* multi = static_cast<OGRMultiPolygon*>(geo);
+                for(int g = 0; g < multi->getNumGeometries(); g++)
+                {
+                    polys.push_back(static_cast<OGRPolygon*>(multi->getGeometryRef(g)));
+                }
+            }
+            else
+            {
+                supported = false;
+            }
+
+            /* Rings of a polygon are filled even-odd, polygons are unioned */
+            for(OGRPolygon* poly: polys)
+            {
+                if(poly->getExteriorRing()) addRing(edge_table, poly->getExteriorRing(), num_polys, bm);
+                for(int r = 0; r < poly->getNumInteriorRings(); r++)
+                {
+                    addRing(edge_table, poly->getInteriorRing(r), num_polys, bm);
+                }
+                num_polys++;
+            }
+        }
+        OGRFeature::DestroyFeature(feature);
+        if(!supported) return false;
+    }
+
+    /* Scan Rows */
+    std::vector<edge_t> active;
+    std::vector<std::pair<int,double>> crossings; // polygon and x of each edge at row center
+    std::vector<std::pair<int32_t,int32_t>> spans;
+    bm->row_runs.resize(bm->rows + 1);
+    for(int row = 0; row < bm->rows; row++)
+    {
+        bm->row_runs[row] = bm->runs.size() / 2;
+
+        /* Update Active Edges */
+        active.erase(std::remove_if(active.begin(), active.end(), [row](const edge_t& edge) { return edge.last < row; }), active.end());
+        active.insert(active.end(), edge_table[row].begin(), edge_table[row].end());
+        std::vector<edge_t>().swap(edge_table[row]);
+        if(active.empty()) continue;
+
+        /* Pair Crossings of Each Polygon into Spans of Columns */
+        const double yc = bm->lat_max - ((row + 0.5) * bm->cellsize);
+        crossings.clear();
+        for(const edge_t& edge: active)
+        {
+            crossings.push_back(std::make_pair(edge.poly, edge.x0 + ((yc - edge.y0) * edge.dxdy)));
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        spans.clear();
+        for(size_t i = 0; i + 1 < crossings.size(); i += 2)
+        {
+            /* Columns whose centers are in [x_in, x_out) */
+            const double c0 = ceil(((crossings[i].second - bm->lon_min) / bm->cellsize) - 0.5);
+            const double c1 = ceil(((crossings[i + 1].second - bm->lon_min) / bm->cellsize) - 0.5);
+            const int32_t start = static_cast<int32_t>(std::max(c0, 0.0));
+            const int32_t end = static_cast<int32_t>(std::min(c1, static_cast<double>(bm->cols)));
+            if(start < end) spans.push_back(std::make_pair(start, end));
+        }
+        std::sort(spans.begin(), spans.end());
+
+        /* Merge Overlapping Spans into Runs */
+        for(size_t i = 0; i < spans.size(); i++)
+        {
+            const size_t n = bm->runs.size();
+            if(n > 2 * bm->row_runs[row] && spans[i].first <= bm->runs[n - 1])
+            {
+                bm->runs[n - 1] = std::max(bm->runs[n - 1], spans[i].second);
+            }
+            else
+            {
+                bm->runs.push_back(spans[i].first);
+                bm->runs.push_back(spans[i].second);
+            }
+        }
+    }
+    bm->row_runs[bm->rows] = bm->runs.size() / 2;
+
     return true;
 }
 
-/******************************************************************************
- * PRIVATE METHODS
- ******************************************************************************/
\ No newline at end of file
+/*----------------------------------------------------------------------------
+ * addRing
+ *
+ *  an edge crosses the rows whose centers are in [y_low, y_high), so a vertex
+ *  shared by two edges is counted once and horizontal edges are skipped
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::addRing(std::vector<std::vector<edge_t>>& edge_table, const OGRLinearRing* ring, int poly, const bitmap_t* bm)
+{
+    const int num_points = ring->getNumPoints();
+    for(int i = 0; i < num_points; i++)
+    {
+        const int j = (i + 1) % num_points;
+        double x0 = ring->getX(i);
+        double y0 = ring->getY(i);
+        double x1 = ring->getX(j);
+        double y1 = ring->getY(j);
+        if(y0 == y1) continue;
+        if(y0 > y1)
+        {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+
+        const double first = std::max(floor(((bm->lat_max - y1) / bm->cellsize) - 0.5) + 1.0, 0.0);
+        const double last = std::min(floor(((bm->lat_max - y0) / bm->cellsize) - 0.5), static_cast<double>(bm->rows - 1));
+        if(first > last) continue;
+
+        edge_t edge = {
+            .x0     = x0,
+            .y0     = y0,
+            .dxdy   = (x1 - x0) / (y1 - y0),
+            .first  = static_cast<int>(first),
+            .last   = static_cast<int>(last),
+            .poly   = poly
+        };
+        edge_table[edge.first].push_back(edge);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * writeRuns
+ *
+ *  burns the runs into the raster a row at a time
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::writeRuns(GDALRasterBand* rb, const bitmap_t* bm)
+{
+    std::vector<uint8_t> line(bm->cols);
+    for(int row = 0; row < bm->rows; row++)
+    {
+        std::fill(line.begin(), line.end(), 0);
+        for(uint32_t r = bm->row_runs[row]; r < bm->row_runs[row + 1]; r++)
+        {
+            std::fill(line.begin() + bm->runs[2 * r], line.begin() + bm->runs[2 * r + 1], RASTER_PIXEL_ON);
+        }
+        CPLErr cplerr = rb->RasterIO(GF_Write, 0, row, bm->cols, 1, line.data(), bm->cols, 1, GDT_Byte, 0, 0, NULL);
+        CHECK_GDALERR(cplerr);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * readRuns
+ *
+ *  run-length encodes the pixels burned into the raster a row at a time
+ *----------------------------------------------------------------------------*/
+void GeoJsonRaster::readRuns(GDALRasterBand* rb, bitmap_t* bm)
+{
+    std::vector<uint8_t> line(bm->cols);
+    bm->row_runs.resize(bm->rows + 1);
+    for(int row = 0; row < bm->rows; row++)
+    {
+        bm->row_runs[row] = bm->runs.size() / 2;
+        CPLErr cplerr = rb->RasterIO(GF_Read, 0, row, bm->cols, 1, line.data(), bm->cols, 1, GDT_Byte, 0, 0, NULL);
+        CHECK_GDALERR(cplerr);
+
+        int32_t col = 0;
+        while(col < bm->cols)
+        {
+            while(col < bm->cols && line[col] != RASTER_PIXEL_ON) col++;
+            if(col == bm->cols) break;
+            const int32_t start = col;
+            while(col < bm->cols && line[col] == RASTER_PIXEL_ON) col++;
+            bm->runs.push_back(start);
+            bm->runs.push_back(col);
+        }
+    }
+    bm->row_runs[bm->rows] = bm->runs.size() / 2;
+}
@@ -53,6 +53,7 @@ class GeoJsonRaster: public VrtRaster
 
         static const int   RASTER_NODATA_VALUE = 200;
         static const int   RASTER_PIXEL_ON = 1;
+        static const int   MAX_CACHED_BITMAPS = 16;
 
         static const char* FILEDATA_KEY;
         static const char* FILELENGTH_KEY;
@@ -67,10 +68,13 @@ class GeoJsonRaster: public VrtRaster
          * Methods
          *--------------------------------------------------------------------*/
 
+        static void           init           (void);
+        static void           deinit         (void);
         static int            luaCreate      (lua_State* L);
         static GeoJsonRaster* create         (lua_State* L, int index);
 
         bool                  includes       (double lon, double lat);
+        int                   includes       (const double* lons, const double* lats, int n, bool* inclusion);
         virtual              ~GeoJsonRaster  (void);
 
         /*--------------------------------------------------------------------
@@ -94,17 +98,81 @@ class GeoJsonRaster: public VrtRaster
         bool    getRasterDate   (raster_info_t& rinfo);
 
     private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Rasterized geojson shared by all rasters created from the same file */
+        typedef struct {
+            std::string             rasterFile; // rasterized geojson in /vsimem
+            TimeLib::gmt_time_t     gmtDate;    // time of rasterization
+            std::vector<uint32_t>   row_runs;   // index of first run in each row, rows + 1 entries; empty if not in lon/lat
+            std::vector<int32_t>    runs;       // start and end (exclusive) column of each run of on pixels, in row order
+            int                     cols;
+            int                     rows;
+            double                  lon_min;    // fixed geo-transform of the bitmap
+            double                  lat_max;
+            double                  cellsize;
+            int                     refs;       // rasters using the entry
+        } bitmap_t;
+
+        /* Polygon edge crossing the centers of rows first to last */
+        typedef struct {
+            double  x0;         // lower end point of edge
+            double  y0;
+            double  dxdy;       // inverse slope
+            int     first;
+            int     last;
+            int     poly;       // polygon the edge belongs to
+        } edge_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        std::string rasterFile;
+        static Mutex                    bitmapMut;
+        static Dictionary<bitmap_t*>    bitmapCache;
+
         std::string vrtFile;
-        TimeLib::gmt_time_t gmtDate;
+        bitmap_t*   bitmap;
+        bool        useBitmap;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
+
+        static bitmap_t*    rasterize       (const char* file, long filelength, double cellsize, const char* raster_file);
+        static void         releaseBitmap   (bitmap_t* bm);
+        static void         deleteBitmap    (bitmap_t* bm);
+        static bool         scanlineFill    (OGRLayer* layer, bitmap_t* bm);
+        static void         addRing         (std::vector<std::vector<edge_t>>& edge_table, const OGRLinearRing* ring, int poly, const bitmap_t* bm);
+        static void         writeRuns       (GDALRasterBand* rb, const bitmap_t* bm);
+        static void         readRuns        (GDALRasterBand* rb, bitmap_t* bm);
+
+        /* Binary search of the runs in the point's row */
+        inline bool testBitmap (double lon, double lat)
+        {
+            const int32_t col = static_cast<int32_t>(floor((lon - bitmap->lon_min) / bitmap->cellsize));
+            const int32_t row = static_cast<int32_t>(floor((bitmap->lat_max - lat) / bitmap->cellsize));
+            if((static_cast<uint32_t>(col) >= static_cast<uint32_t>(bitmap->cols)) ||
+               (static_cast<uint32_t>(row) >= static_cast<uint32_t>(bitmap->rows)))
+            {
+                return false;
+            }
+
+            const int32_t* runs = bitmap->runs.data();
+            uint32_t lo = bitmap->row_runs[row];
+            uint32_t hi = bitmap->row_runs[row + 1];
+            while(lo < hi)
+            {
+                const uint32_t mid = (lo + hi) / 2;
+                if(runs[2 * mid + 1] <= col)    lo = mid + 1;
+                else if(runs[2 * mid] > col)    hi = mid;
+                else                            return true;
+            }
+            return false;
+        }
 };
 
 #endif  /* __geojson_raster__ */
@@ -51,6 +51,8 @@ const char* GeoParms::AUXILIARY_FILES       = "with_flags";
 const char* GeoParms::START_TIME            = "t0";
 const char* GeoParms::STOP_TIME             = "t1";
 const char* GeoParms::URL_SUBSTRING         = "substr";
+const char* GeoParms::CLOSEST_TIME          = "closest_time";
+const char* GeoParms::CLOSEST_COUNT         = "closest_count";
 const char* GeoParms::ASSET                 = "asset";
 
 const char* GeoParms::NEARESTNEIGHBOUR_ALGO = "NearestNeighbour";
@@ -108,6 +110,8 @@ GeoParms::GeoParms (lua_State* L, int index):
     auxiliary_files     (false),
     filter_time         (false),
     url_substring       (NULL),
+    filter_closest_time (false),
+    closest_count       (1),
     asset_name          (NULL),
     asset               (NULL)
 {
@@ -217,6 +221,27 @@ void GeoParms::fromLua (lua_State* L, int index)
             if(url_substring) mlog(DEBUG, "Setting %s to %s", URL_SUBSTRING, url_substring);
             lua_pop(L, 1);
 
+            /* Closest Time */
+            lua_getfield(L, index, CLOSEST_TIME);
+            const char* closest_str = LuaObject::getLuaString(L, -1, true, NULL);
+            if(closest_str)
+            {
+                int64_t gps = TimeLib::str2gpstime(closest_str);
+                if(gps <= 0) throw RunTimeException(CRITICAL, RTE_ERROR, "unable to parse time supplied: %s", closest_str);
+                closest_time = TimeLib::gps2gmttime(gps);
+                filter_closest_time = true;
+                TimeLib::date_t closest_date = TimeLib::gmt2date(closest_time);
+                mlog(DEBUG, "Setting %s to %04d-%02d-%02dT%02d:%02d:%02dZ", CLOSEST_TIME, closest_date.year, closest_date.month, closest_date.day, closest_time.hour, closest_time.minute, closest_time.second);
+            }
+            lua_pop(L, 1);
+
+            /* Closest Count */
+            lua_getfield(L, index, CLOSEST_COUNT);
+            closest_count = (int)LuaObject::getLuaInteger(L, -1, true, closest_count, &field_provided);
+            if(closest_count < 1) throw RunTimeException(CRITICAL, RTE_ERROR, "invalid closest count: %d:", closest_count);
+            if(field_provided) mlog(DEBUG, "Setting %s to %d", CLOSEST_COUNT, closest_count);
+            lua_pop(L, 1);
+
             /* Asset */
             lua_getfield(L, index, ASSET);
             asset_name = StringLib::duplicate(LuaObject::getLuaString(L, -1));
@@ -71,6 +71,8 @@ class GeoParms: public LuaObject
         static const char* START_TIME;
         static const char* STOP_TIME;
         static const char* URL_SUBSTRING;
+        static const char* CLOSEST_TIME;
+        static const char* CLOSEST_COUNT;
         static const char* ASSET;
 
         static const char* NEARESTNEIGHBOUR_ALGO;
@@ -99,6 +101,9 @@ class GeoParms: public LuaObject
         TimeLib::gmt_time_t start_time;
         TimeLib::gmt_time_t stop_time;
         const char*         url_substring;
+        bool                filter_closest_time;
+        TimeLib::gmt_time_t closest_time;
+        int                 closest_count;      // number of rasters closest in time to keep per point
         const char*         asset_name;
         Asset*              asset;
 
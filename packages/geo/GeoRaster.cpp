@@ -45,6 +45,13 @@
 #include <ogr_spatialref.h>
 #include <gdal_priv.h>
 #include <algorithm>
+#include <float.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include "cpl_minixml.h"
 #include "cpl_string.h"
@@ -62,12 +69,28 @@ const struct luaL_Reg GeoRaster::LuaMetaTable[] = {
     {"bbox",        luaBoundingBox},
     {"cell",        luaCellSize},
     {"sample",      luaSamples},
+    {"samples",     luaBatchSamples},
     {NULL,          NULL}
 };
 
 Mutex GeoRaster::factoryMut;
 Dictionary<GeoRaster::factory_t> GeoRaster::factories;
 
+Mutex GeoRaster::blockCacheMut;
+Dictionary<GeoRaster::cached_block_t*> GeoRaster::blockCache;
+GeoRaster::cached_block_t* GeoRaster::blockCacheHead = NULL;
+GeoRaster::cached_block_t* GeoRaster::blockCacheTail = NULL;
+long GeoRaster::blockCacheSize = 0;
+long GeoRaster::blockCacheMax = GeoRaster::DEFAULT_BLOCK_CACHE_SIZE;
+
+Cond GeoRaster::dsetPoolCond;
+Dictionary<GeoRaster::dset_pool_t*> GeoRaster::dsetPool;
+int GeoRaster::dsetPoolIdle = 0;
+TaskScheduler::Group* GeoRaster::dsetOpenGroup = NULL;
+
+Mutex GeoRaster::zonalMaskMut;
+std::vector<int32_t> GeoRaster::zonalMasks[GeoRaster::MAX_SAMPLING_RADIUS_IN_PIXELS + 1];
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -77,6 +100,7 @@ Dictionary<GeoRaster::factory_t> GeoRaster::factories;
  *----------------------------------------------------------------------------*/
 void GeoRaster::init( void )
 {
+    dsetOpenGroup = new TaskScheduler::Group;
 }
 
 /*----------------------------------------------------------------------------
@@ -84,6 +108,78 @@ void GeoRaster::init( void )
  *----------------------------------------------------------------------------*/
 void GeoRaster::deinit( void )
 {
+    /* Wait for outstanding opens, then close pooled datasets */
+    delete dsetOpenGroup;
+    dsetOpenGroup = NULL;
+
+    dsetPoolCond.lock();
+    {
+        dset_pool_t* entry = NULL;
+        const char* key = dsetPool.first(&entry);
+        while (key != NULL)
+        {
+            for (size_t i = 0; i < entry->idle.size(); i++)
+                GDALClose((GDALDatasetH)entry->idle[i]);
+            delete entry;
+            key = dsetPool.next(&entry);
+        }
+        dsetPool.clear();
+        dsetPoolIdle = 0;
+    }
+    dsetPoolCond.unlock();
+
+    blockCacheMut.lock();
+    {
+        while (blockCacheTail != NULL)
+            blockCacheRemove(blockCacheTail);
+    }
+    blockCacheMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * luaBlockCache - blockcache([<max bytes>])
+ *  returns bytes currently cached and the maximum
+ *----------------------------------------------------------------------------*/
+int GeoRaster::luaBlockCache(lua_State *L)
+{
+    bool status = false;
+    int num_ret = 1;
+
+    try
+    {
+        /* Get Parameters */
+        bool provided = false;
+        long max_size = getLuaInteger(L, 1, true, DEFAULT_BLOCK_CACHE_SIZE, &provided);
+        if (provided && max_size < 0)
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid block cache size: %ld", max_size);
+
+        blockCacheMut.lock();
+        {
+            /* Set Maximum and Trim Cache */
+            if (provided)
+            {
+                blockCacheMax = max_size;
+                while (blockCacheSize > blockCacheMax && blockCacheTail != NULL)
+                    blockCacheRemove(blockCacheTail);
+            }
+
+            /* Set Return Values */
+            lua_pushinteger(L, blockCacheSize);
+            lua_pushinteger(L, blockCacheMax);
+            num_ret += 2;
+        }
+        blockCacheMut.unlock();
+
+        /* Set Return Status */
+        status = true;
+    }
+    catch (const RunTimeException &e)
+    {
+        mlog(e.level(), "Error configuring block cache: %s", e.what());
+    }
+
+    /* Return Status */
+    return returnLuaStatus(L, status, num_ret);
 }
 
 /*----------------------------------------------------------------------------
@@ -179,31 +275,167 @@ int GeoRaster::sample(double lon, double lat, List<sample_t>& slist, void* param
 
 
 /*----------------------------------------------------------------------------
- * Destructor
+ * sampleBatch
+ *
+ * Samples n points, results[i] receives the samples of point i. When sorted,
+ * the points are sampled in Z-order so that points falling in the same
+ * raster (and the same blocks within it) are sampled together.
  *----------------------------------------------------------------------------*/
-GeoRaster::~GeoRaster(void)
+int GeoRaster::sampleBatch(const double* lons, const double* lats, int n, List<sample_t>* results, bool sorted)
 {
-    /* Terminate all reader threads */
-    for (uint32_t i=0; i < readerCount; i++)
+    if (!sorted)
+        return sampleInOrder(lons, lats, n, results);
+
+    /* Determine Sampling Order */
+    std::vector<int> order(n);
+    std::vector<uint64_t> zkeys(n);
+    for (int i = 0; i < n; i++)
+    {
+        order[i] = i;
+        zkeys[i] = zOrder(lons[i], lats[i]);
+    }
+    std::stable_sort(order.begin(), order.end(), [&zkeys](int a, int b) { return zkeys[a] < zkeys[b]; });
+
+    /* Sample in Z-Order */
+    std::vector<double> sorted_lons(n);
+    std::vector<double> sorted_lats(n);
+    for (int i = 0; i < n; i++)
     {
-        reader_t *reader = &rasterRreader[i];
-        if (reader->thread != NULL)
+        sorted_lons[i] = lons[order[i]];
+        sorted_lats[i] = lats[order[i]];
+    }
+    List<sample_t>* sorted_results = new List<sample_t> [n];
+    int total = sampleInOrder(sorted_lons.data(), sorted_lats.data(), n, sorted_results);
+
+    /* Hand Out Samples in Original Order */
+    for (int i = 0; i < n; i++)
+        results[order[i]] = sorted_results[i];
+
+    delete [] sorted_results;
+    return total;
+}
+
+/*----------------------------------------------------------------------------
+ * zOrder
+ *
+ * Morton code of the point on a 2^32 x 2^32 global lon/lat grid; the high
+ * bits order the points by coarse cell (roughly by tile) and the low bits
+ * order them within the cell
+ *----------------------------------------------------------------------------*/
+uint64_t GeoRaster::zOrder(double lon, double lat)
+{
+    /* Quantize to Grid */
+    double x = (lon + 180.0) / 360.0;
+    double y = (lat + 90.0) / 180.0;
+    x = (x > 0.0) ? ((x < 1.0) ? x : 1.0) : 0.0; // NaN goes to 0
+    y = (y > 0.0) ? ((y < 1.0) ? y : 1.0) : 0.0;
+    uint64_t xbits = (uint64_t)(x * (double)UINT32_MAX);
+    uint64_t ybits = (uint64_t)(y * (double)UINT32_MAX);
+
+    /* Spread Bits (abcd -> 0a0b0c0d) */
+    const uint64_t masks[] = {0x0000FFFF0000FFFFULL, 0x00FF00FF00FF00FFULL, 0x0F0F0F0F0F0F0F0FULL, 0x3333333333333333ULL, 0x5555555555555555ULL};
+    const int shifts[] = {16, 8, 4, 2, 1};
+    for (int i = 0; i < 5; i++)
+    {
+        xbits = (xbits | (xbits << shifts[i])) & masks[i];
+        ybits = (ybits | (ybits << shifts[i])) & masks[i];
+    }
+
+    /* Interleave */
+    return (ybits << 1) | xbits;
+}
+
+/*----------------------------------------------------------------------------
+ * sampleInOrder
+ *
+ * Points are queued on the rasters that contain them and each raster is
+ * read by one task with all of its points, instead of once per point.
+ *----------------------------------------------------------------------------*/
+int GeoRaster::sampleInOrder(const double* lons, const double* lats, int n, List<sample_t>* results)
+{
+    int total = 0;
+
+    for (int i = 0; i < n; i++)
+        results[i].clear();
+
+    samplingMutex.lock(); /* Serialize sampling on the same object */
+
+    try
+    {
+        for (int i = 0; i < n; i++)
         {
-            reader->sync->lock();
+            invalidateCache();
+
+            /* Initial call, open raster index data set if not already opened */
+            if (geoIndex.dset == NULL)
+                openGeoIndex(lons[i], lats[i]);
+
+            OGRPoint p(lons[i], lats[i]);
+            transformCRS(p);
+
+            /* If point is not in current geoindex, find a new one */
+            if (!geoIndex.containsPoint(p))
             {
-                reader->raster = NULL; /* No raster to read     */
-                reader->run = false;   /* Set run flag to false */
-                reader->sync->signal(DATA_TO_SAMPLE, Cond::NOTIFY_ONE);
+                openGeoIndex(lons[i], lats[i]);
+
+                /* Check against newly opened geoindex */
+                if (!geoIndex.containsPoint(p))
+                    continue;
             }
-            reader->sync->unlock();
 
-            delete reader->thread;  /* delte thread waits on thread to join */
-            delete reader->sync;
+            if (!findCachedRasters(p))
+            {
+                if (findRasters(p))
+                {
+                    /* Updating the cache may remove rasters, sample their queued points first */
+                    const int CNT = parms->auxiliary_files ? 2 : 1;
+                    if ((rasterDict.length() + (rastersList->length() * CNT)) > MAX_CACHED_RASTERS)
+                        total += sampleQueuedRasters(results);
+
+                    updateCache(p);
+                }
+            }
+
+            /* Queue point on each raster selected for it */
+            Raster *raster = NULL;
+            const char *key = rasterDict.first(&raster);
+            while (key != NULL)
+            {
+                assert(raster);
+                if (raster->enabled)
+                {
+                    batch_sample_t entry;
+                    entry.index = static_cast<uint32_t>(i);
+                    entry.point = raster->point;
+                    entry.sampled = false;
+                    bzero(&entry.sample, sizeof(sample_t));
+                    raster->batch.push_back(entry);
+                }
+                key = rasterDict.next(&raster);
+            }
         }
+
+        total += sampleQueuedRasters(results);
     }
+    catch (const RunTimeException &e)
+    {
+        mlog(e.level(), "Error getting batch of samples: %s", e.what());
+        clearQueuedRasters();
+    }
+
+    invalidateCache();
+
+    samplingMutex.unlock();
+
+    return total;
+}
 
-    delete [] rasterRreader;
 
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+GeoRaster::~GeoRaster(void)
+{
     /* Close all rasters */
     Raster* raster = NULL;
     const char* key  = rasterDict.first(&raster);
@@ -285,9 +517,6 @@ GeoRaster::GeoRaster(lua_State *L, GeoParms* _parms):
     rastersList->clear();
     rasterDict.clear();
     fileDict.clear();
-    rasterRreader = new reader_t[MAX_READER_THREADS];
-    bzero(rasterRreader, sizeof(reader_t)*MAX_READER_THREADS);
-    readerCount = 0;
 }
 
 
@@ -317,7 +546,7 @@ int GeoRaster::radius2pixels(double cellSize, int _radius)
 
 /*----------------------------------------------------------------------------
  * processRaster
- * Thread-safe, can be called directly from main thread or reader thread
+ * Thread-safe, can be called directly from main thread or a read task
  *----------------------------------------------------------------------------*/
 void GeoRaster::processRaster(Raster* raster)
 {
@@ -326,7 +555,7 @@ void GeoRaster::processRaster(Raster* raster)
         /* Open raster if first time reading from it */
         if (raster->dset == NULL)
         {
-            raster->dset = (GDALDataset *)GDALOpenEx(raster->fileName.c_str(), GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
+            raster->dset = acquireDataset(raster->fileName);
             if (raster->dset == NULL)
                 throw RunTimeException(CRITICAL, RTE_ERROR, "Failed to opened index raster: %s:", raster->fileName.c_str());
 
@@ -410,62 +639,109 @@ void GeoRaster::processRaster(Raster* raster)
 }
 
 
+/*----------------------------------------------------------------------------
+ * processBatch
+ * Thread-safe, samples each point queued on the raster by sampleBatch
+ *----------------------------------------------------------------------------*/
+void GeoRaster::processBatch(Raster* raster)
+{
+    for (size_t i = 0; i < raster->batch.size(); i++)
+    {
+        batch_sample_t& entry = raster->batch[i];
+
+        raster->point = entry.point;
+        raster->sampled = false;
+        bzero(&raster->sample, sizeof(sample_t));
+        raster->sample.value = INVALID_SAMPLE_VALUE;
+
+        processRaster(raster);
+
+        entry.sampled = raster->sampled;
+        entry.sample = raster->sample;
+    }
+
+    raster->sampled = false;
+    raster->point.empty();
+}
+
+
 /*----------------------------------------------------------------------------
  * sampleRasters
  *----------------------------------------------------------------------------*/
 void GeoRaster::sampleRasters(void)
 {
-    /* Create additional reader threads if needed */
-    createThreads();
+    /* Read each raster which is marked to be sampled */
+    if (readRasters(false) == 0) return;
 
-    /* For each raster which is marked to be sampled, give it to the reader thread */
-    int signaledReaders = 0;
+    /* Update dictionary of used raster files and auxualiary data */
     Raster *raster = NULL;
     const char *key = rasterDict.first(&raster);
-    int i = 0;
     while (key != NULL)
     {
-        assert(raster);
-        if (raster->enabled)
+        if (!raster->isAuxuliary && raster->enabled && raster->sampled)
         {
-            reader_t *reader = &rasterRreader[i++];
-            reader->sync->lock();
-            {
-                reader->raster = raster;
-                reader->sync->signal(DATA_TO_SAMPLE, Cond::NOTIFY_ONE);
-                signaledReaders++;
-            }
-            reader->sync->unlock();
+            std::string fileName = raster->fileName.substr(strlen("/vsis3/"));
+            raster->sample.fileId = fileDictAdd(fileName);
+            raster->sample.flags = raster->getPeerValue();
         }
         key = rasterDict.next(&raster);
     }
+}
 
-    /* Did not signal any reader threads, don't wait */
-    if (signaledReaders == 0) return;
+/*----------------------------------------------------------------------------
+ * sampleQueuedRasters
+ *----------------------------------------------------------------------------*/
+int GeoRaster::sampleQueuedRasters(List<sample_t>* results)
+{
+    /* Read each raster with queued points */
+    if (readRasters(true) == 0) return 0;
 
-    /* Wait and update each raster when it is done */
-    for (int j=0; j<signaledReaders; j++)
+    /* Hand out samples, in the same order sample() returns them for a point */
+    int cnt = 0;
+    Raster *raster = NULL;
+    const char *key = rasterDict.first(&raster);
+    while (key != NULL)
     {
-        /* Wait for reader to finish sampling */
-        reader_t *reader = &rasterRreader[j];
-        reader->sync->lock();
+        if (!raster->isAuxuliary)
         {
-            while (reader->raster != NULL)
-                reader->sync->wait(DATA_SAMPLED, SYS_TIMEOUT);
+            uint32_t fileId = 0;
+            bool fileIdSet = false;
+            for (size_t i = 0; i < raster->batch.size(); i++)
+            {
+                batch_sample_t& entry = raster->batch[i];
+                if (!entry.sampled) continue;
+
+                if (!fileIdSet)
+                {
+                    std::string fileName = raster->fileName.substr(strlen("/vsis3/"));
+                    fileId = fileDictAdd(fileName);
+                    fileIdSet = true;
+                }
+
+                entry.sample.fileId = fileId;
+                entry.sample.flags = raster->getPeerValue(entry.index);
+                results[entry.index].add(entry.sample);
+                cnt++;
+            }
         }
-        reader->sync->unlock();
+        key = rasterDict.next(&raster);
     }
 
-    /* Update dictionary of used raster files and auxualiary data */
-    key = rasterDict.first(&raster);
+    clearQueuedRasters();
+
+    return cnt;
+}
+
+/*----------------------------------------------------------------------------
+ * clearQueuedRasters
+ *----------------------------------------------------------------------------*/
+void GeoRaster::clearQueuedRasters(void)
+{
+    Raster *raster = NULL;
+    const char *key = rasterDict.first(&raster);
     while (key != NULL)
     {
-        if (!raster->isAuxuliary && raster->enabled && raster->sampled)
-        {
-            std::string fileName = raster->fileName.substr(strlen("/vsis3/"));
-            raster->sample.fileId = fileDictAdd(fileName);
-            raster->sample.flags = raster->getPeerValue();
-        }
+        raster->batch.clear();
         key = rasterDict.next(&raster);
     }
 }
@@ -510,6 +786,29 @@ uint32_t GeoRaster::Raster::getPeerValue(void)
     return peerValue;
 }
 
+/*----------------------------------------------------------------------------
+ * getPeerValue
+ *  peer value for a point queued by sampleBatch
+ *----------------------------------------------------------------------------*/
+uint32_t GeoRaster::Raster::getPeerValue(uint32_t index)
+{
+    uint32_t peerValue = 0;
+
+    if (peerRaster)
+    {
+        /* Batch is in point order */
+        std::vector<batch_sample_t>& peerBatch = peerRaster->batch;
+        auto it = std::lower_bound(peerBatch.begin(), peerBatch.end(), index,
+                                   [](const batch_sample_t& entry, uint32_t i) { return entry.index < i; });
+        if (it != peerBatch.end() && it->index == index && it->sampled)
+        {
+            peerValue = static_cast<uint32_t>(it->sample.value);
+        }
+    }
+
+    return peerValue;
+}
+
 /*----------------------------------------------------------------------------
  * readPixel
  *----------------------------------------------------------------------------*/
@@ -525,95 +824,426 @@ void GeoRaster::readPixel(Raster *raster)
         uint32_t xblk = col / raster->xBlockSize;
         uint32_t yblk = row / raster->yBlockSize;
 
-        GDALRasterBlock *block = NULL;
-        int cnt = 2;
-        do
-        {
-            /* Retry read if error */
-            block = raster->band->GetLockedBlockRef(xblk, yblk, false);
-        } while (block == NULL && cnt--);
-        CHECKPTR(block);
-
-        /* Get data block pointer, no copy but block is locked */
-        void *data = block->GetDataRef();
-        if (data == NULL) block->DropLock();
-        CHECKPTR(data);
-
         /* Calculate col, row inside of block */
         uint32_t _col = col % raster->xBlockSize;
         uint32_t _row = row % raster->yBlockSize;
         uint32_t offset = _row * raster->xBlockSize + _col;
 
-        switch(raster->dataType)
+        /*
+         * This version of GDAL does not support 64bit integers
+         * Complex numbers are supported but not needed at this point.
+         */
+        const int elementSize = GDALGetDataTypeSizeBytes(raster->dataType);
+        if (elementSize <= 0 || elementSize > static_cast<int>(sizeof(double)))
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Unsuported dataType in raster: %s:", raster->fileName.c_str());
+
+        uint8_t pixel[sizeof(double)];
+        if (blockCacheMax > 0)
         {
-            case GDT_Byte:
+            /* Served from process wide block cache, read from raster on miss */
+            readCachedBlock(raster, xblk, yblk, static_cast<long>(offset) * elementSize, elementSize, pixel);
+        }
+        else
+        {
+            GDALRasterBlock *block = NULL;
+            int cnt = 2;
+            do
             {
-                uint8_t *p = (uint8_t *)data;
-                raster->sample.value = (double)p[offset];
-            }
-            break;
+                /* Retry read if error */
+                block = raster->band->GetLockedBlockRef(xblk, yblk, false);
+            } while (block == NULL && cnt--);
+            CHECKPTR(block);
 
-            case GDT_UInt16:
+            /* Get data block pointer, no copy but block is locked */
+            void *data = block->GetDataRef();
+            if (data == NULL) block->DropLock();
+            CHECKPTR(data);
+
+            memcpy(pixel, (uint8_t *)data + (static_cast<long>(offset) * elementSize), elementSize);
+
+            /* Done reading, release block lock */
+            block->DropLock();
+        }
+
+        raster->sample.value = pixel2double(pixel, raster->dataType);
+
+        // mlog(DEBUG, "Value: %.2lf, col: %u, row: %u, xblk: %u, yblk: %u, bcol: %u, brow: %u, offset: %u",
+        //      raster->sample.value, col, row, xblk, yblk, _col, _row, offset);
+    }
+    catch (const RunTimeException &e)
+    {
+        mlog(e.level(), "Error reading from raster: %s", e.what());
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * readCachedBlock
+ *  copies len bytes at offset in the decoded block to dst
+ *----------------------------------------------------------------------------*/
+void GeoRaster::readCachedBlock(Raster *raster, int xblk, int yblk, long offset, long len, void *dst)
+{
+    char key[MAX_STR_SIZE];
+    StringLib::format(key, MAX_STR_SIZE, "%s:%d:%d:%d", raster->fileName.c_str(), 1, xblk, yblk);
+
+    if (blockCacheGet(key, offset, len, dst))
+        return;
+
+    /* Miss, decode whole block (edge blocks are padded out to full size) */
+    const long size = static_cast<long>(raster->xBlockSize) * raster->yBlockSize * GDALGetDataTypeSizeBytes(raster->dataType);
+    uint8_t *data = new uint8_t[size];
+
+    int cnt = 2;
+    CPLErr err = CE_None;
+    do
+    {
+        /* Retry read if error */
+        err = raster->band->ReadBlock(xblk, yblk, data);
+    } while (err != CE_None && cnt--);
+
+    if (err != CE_None)
+    {
+        delete [] data;
+        throw RunTimeException(CRITICAL, RTE_ERROR, "ReadBlock call failed");
+    }
+
+    memcpy(dst, &data[offset], len);
+    blockCachePut(key, data, size);
+}
+
+/*----------------------------------------------------------------------------
+ * readCachedWindow
+ *  reads windowSize x windowSize pixels starting at col, row (must be inside
+ *  raster) from the block cache, same result as RasterIO at native resolution
+ *----------------------------------------------------------------------------*/
+void GeoRaster::readCachedWindow(Raster *raster, int col, int row, int windowSize, double *dst)
+{
+    const int elementSize = GDALGetDataTypeSizeBytes(raster->dataType);
+    if (elementSize <= 0 || elementSize > static_cast<int>(sizeof(double)))
+        throw RunTimeException(CRITICAL, RTE_ERROR, "Unsuported dataType in raster: %s:", raster->fileName.c_str());
+
+    const int xbs = raster->xBlockSize;
+    const int ybs = raster->yBlockSize;
+    uint8_t *line = new uint8_t[static_cast<long>(windowSize) * elementSize];
+
+    try
+    {
+        for (int yblk = row / ybs; yblk <= (row + windowSize - 1) / ybs; yblk++)
+        {
+            for (int xblk = col / xbs; xblk <= (col + windowSize - 1) / xbs; xblk++)
             {
-                uint16_t *p = (uint16_t *)data;
-                raster->sample.value = (double)p[offset];
+                /* Part of window inside this block */
+                const int x0 = MAX(col, xblk * xbs);
+                const int x1 = MIN(col + windowSize, (xblk + 1) * xbs);
+                const int y0 = MAX(row, yblk * ybs);
+                const int y1 = MIN(row + windowSize, (yblk + 1) * ybs);
+
+                for (int y = y0; y < y1; y++)
+                {
+                    long offset = (static_cast<long>(y - (yblk * ybs)) * xbs + (x0 - (xblk * xbs))) * elementSize;
+                    readCachedBlock(raster, xblk, yblk, offset, static_cast<long>(x1 - x0) * elementSize, line);
+                    for (int x = x0; x < x1; x++)
+                        dst[(y - row) * windowSize + (x - col)] = pixel2double(&line[(x - x0) * elementSize], raster->dataType);
+                }
             }
-            break;
+        }
+    }
+    catch (const RunTimeException &e)
+    {
+        delete [] line;
+        throw;
+    }
+
+    delete [] line;
+}
+
+/*----------------------------------------------------------------------------
+ * pixel2double
+ *----------------------------------------------------------------------------*/
+double GeoRaster::pixel2double(const void *pixel, GDALDataType dataType)
+{
+    switch(dataType)
+    {
+        case GDT_Byte:      { uint8_t  v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_UInt16:    { uint16_t v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_Int16:     { int16_t  v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_UInt32:    { uint32_t v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_Int32:     { int32_t  v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_Float32:   { float    v; memcpy(&v, pixel, sizeof(v)); return (double)v; }
+        case GDT_Float64:   { double   v; memcpy(&v, pixel, sizeof(v)); return v; }
+        default:
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Unsuported dataType: %d", (int)dataType);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * blockCacheGet
+ *----------------------------------------------------------------------------*/
+bool GeoRaster::blockCacheGet(const char *key, long offset, long len, void *dst)
+{
+    bool found = false;
 
-            case GDT_Int16:
+    blockCacheMut.lock();
+    {
+        cached_block_t *entry = NULL;
+        if (blockCache.find(key, &entry) && (offset + len) <= entry->size)
+        {
+            /* Move to front of LRU list */
+            if (entry != blockCacheHead)
             {
-                int16_t *p = (int16_t *)data;
-                raster->sample.value = (double)p[offset];
+                if (entry->next) entry->next->prev = entry->prev;
+                else blockCacheTail = entry->prev;
+                entry->prev->next = entry->next;
+                entry->prev = NULL;
+                entry->next = blockCacheHead;
+                blockCacheHead->prev = entry;
+                blockCacheHead = entry;
             }
-            break;
 
-            case GDT_UInt32:
+            memcpy(dst, &entry->data[offset], len);
+            found = true;
+        }
+    }
+    blockCacheMut.unlock();
+
+    return found;
+}
+
+/*----------------------------------------------------------------------------
+ * blockCachePut
+ *  takes ownership of data
+ *----------------------------------------------------------------------------*/
+void GeoRaster::blockCachePut(const char *key, uint8_t *data, long size)
+{
+    bool cached = false;
+
+    blockCacheMut.lock();
+    {
+        cached_block_t *entry = NULL;
+        if (size <= blockCacheMax && !blockCache.find(key, &entry))
+        {
+            /* Make room */
+            while ((blockCacheSize + size) > blockCacheMax && blockCacheTail != NULL)
+                blockCacheRemove(blockCacheTail);
+
+            /* Add to front of LRU list */
+            entry = new cached_block_t;
+            entry->key  = StringLib::duplicate(key);
+            entry->data = data;
+            entry->size = size;
+            entry->prev = NULL;
+            entry->next = blockCacheHead;
+            if (blockCacheHead) blockCacheHead->prev = entry;
+            else blockCacheTail = entry;
+            blockCacheHead = entry;
+            blockCache.add(entry->key, entry);
+            blockCacheSize += size;
+            cached = true;
+        }
+    }
+    blockCacheMut.unlock();
+
+    /* Too big or another reader already cached it */
+    if (!cached) delete [] data;
+}
+
+/*----------------------------------------------------------------------------
+ * blockCacheRemove
+ *  blockCacheMut must be locked
+ *----------------------------------------------------------------------------*/
+void GeoRaster::blockCacheRemove(cached_block_t *entry)
+{
+    if (entry->prev) entry->prev->next = entry->next;
+    else blockCacheHead = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else blockCacheTail = entry->prev;
+
+    blockCache.remove(entry->key);
+    blockCacheSize -= entry->size;
+
+    delete [] entry->data;
+    delete [] entry->key;
+    delete entry;
+}
+
+/*----------------------------------------------------------------------------
+ * acquireDataset
+ *  returns an opened dataset for exclusive use by the caller, from the pool
+ *  when one is idle (or being opened), otherwise opened here
+ *----------------------------------------------------------------------------*/
+GDALDataset* GeoRaster::acquireDataset(const std::string& fileName)
+{
+    GDALDataset* dset = NULL;
+
+    dsetPoolCond.lock();
+    {
+        dset_pool_t* entry = NULL;
+        if (dsetPool.find(fileName.c_str(), &entry))
+        {
+            /*
+             * Wait on an open already in progress instead of opening the file twice;
+             * the wait is bounded since the open is a task that may still be queued
+             * behind the calling one
+             */
+            if (entry->idle.empty() && entry->opening > 0)
+                dsetPoolCond.wait(0, SYS_TIMEOUT);
+
+            if (!entry->idle.empty())
             {
-                uint32_t *p = (uint32_t *)data;
-                raster->sample.value = (double)p[offset];
+                dset = entry->idle.back();
+                entry->idle.pop_back();
+                dsetPoolIdle--;
             }
-            break;
 
-            case GDT_Int32:
+            if (entry->idle.empty() && entry->opening == 0)
             {
-                int32_t *p = (int32_t *)data;
-                raster->sample.value = (double)p[offset];
+                dsetPool.remove(fileName.c_str());
+                delete entry;
             }
-            break;
+        }
+    }
+    dsetPoolCond.unlock();
+
+    if (dset == NULL)
+        dset = (GDALDataset *)GDALOpenEx(fileName.c_str(), GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
 
-            case GDT_Float32:
+    return dset;
+}
+
+/*----------------------------------------------------------------------------
+ * releaseDataset
+ *  returns dataset to the pool, closes it (or another idle one) when full
+ *----------------------------------------------------------------------------*/
+void GeoRaster::releaseDataset(const std::string& fileName, GDALDataset* dset)
+{
+    GDALDataset* evicted = NULL;
+
+    /* In memory rasters are private to their GeoRaster object */
+    if (fileName.compare(0, 8, "/vsimem/") == 0)
+    {
+        GDALClose((GDALDatasetH)dset);
+        return;
+    }
+
+    dsetPoolCond.lock();
+    {
+        dset_pool_t* entry = NULL;
+        if (!dsetPool.find(fileName.c_str(), &entry))
+        {
+            entry = new dset_pool_t;
+            entry->opening = 0;
+            dsetPool.add(fileName.c_str(), entry);
+        }
+
+        if (static_cast<int>(entry->idle.size()) >= MAX_POOLED_DATASETS_PER_FILE)
+        {
+            evicted = dset;
+        }
+        else
+        {
+            /* Pool is full, make room by closing an idle dataset of another file */
+            if (dsetPoolIdle >= MAX_POOLED_DATASETS)
             {
-                float *p = (float *)data;
-                raster->sample.value = (double)p[offset];
+                dset_pool_t* other = NULL;
+                const char* key = dsetPool.first(&other);
+                while (key != NULL && evicted == NULL)
+                {
+                    if (other != entry && !other->idle.empty())
+                    {
+                        evicted = other->idle.back();
+                        other->idle.pop_back();
+                        dsetPoolIdle--;
+                        if (other->idle.empty() && other->opening == 0)
+                        {
+                            dsetPool.remove(key);
+                            delete other;
+                        }
+                    }
+                    else key = dsetPool.next(&other);
+                }
             }
-            break;
 
-            case GDT_Float64:
+            if (dsetPoolIdle < MAX_POOLED_DATASETS)
             {
-                double *p = (double *)data;
-                raster->sample.value = (double)p[offset];
+                entry->idle.push_back(dset);
+                dsetPoolIdle++;
             }
-            break;
-
-            default:
-                /*
-                 * This version of GDAL does not support 64bit integers
-                 * Complex numbers are supported but not needed at this point.
-                 */
-                block->DropLock();
-                throw RunTimeException(CRITICAL, RTE_ERROR, "Unsuported dataType in raster: %s:", raster->fileName.c_str());
+            else evicted = dset;
         }
+    }
+    dsetPoolCond.unlock();
 
-        /* Done reading, release block lock */
-        block->DropLock();
+    if (evicted) GDALClose((GDALDatasetH)evicted);
+}
 
-        // mlog(DEBUG, "Value: %.2lf, col: %u, row: %u, xblk: %u, yblk: %u, bcol: %u, brow: %u, offset: %u",
-        //      raster->sample.value, col, row, xblk, yblk, _col, _row, offset);
+/*----------------------------------------------------------------------------
+ * prefetchDataset
+ *  submits an asynchronous open of the file unless one is idle or opening
+ *----------------------------------------------------------------------------*/
+void GeoRaster::prefetchDataset(const std::string& fileName)
+{
+    bool submit = false;
+
+    if (fileName.compare(0, 8, "/vsimem/") == 0)
+        return;
+
+    dsetPoolCond.lock();
+    {
+        dset_pool_t* entry = NULL;
+        if (!dsetPool.find(fileName.c_str(), &entry))
+        {
+            entry = new dset_pool_t;
+            entry->opening = 0;
+            dsetPool.add(fileName.c_str(), entry);
+        }
+
+        if (dsetOpenGroup && entry->idle.empty() && entry->opening == 0)
+        {
+            entry->opening++;
+            submit = true;
+        }
     }
-    catch (const RunTimeException &e)
+    dsetPoolCond.unlock();
+
+    if (submit)
+        dsetOpenGroup->submit(openDatasetTask, StringLib::duplicate(fileName.c_str()));
+}
+
+/*----------------------------------------------------------------------------
+ * openDatasetTask
+ *  parm is the file name, allocated by prefetchDataset
+ *----------------------------------------------------------------------------*/
+void GeoRaster::openDatasetTask(void* parm)
+{
+    char* fileName = static_cast<char*>(parm);
+
+    GDALDataset* dset = (GDALDataset *)GDALOpenEx(fileName, GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
+    if (dset == NULL) mlog(ERROR, "Failed to prefetch raster: %s", fileName);
+
+    dsetPoolCond.lock();
     {
-        mlog(e.level(), "Error reading from raster: %s", e.what());
+        dset_pool_t* entry = NULL;
+        if (dsetPool.find(fileName, &entry))
+        {
+            entry->opening--;
+            if (dset)
+            {
+                /* Wakes up readers waiting in acquireDataset */
+                entry->idle.push_back(dset);
+                dsetPoolIdle++;
+                dset = NULL;
+            }
+            else if (entry->idle.empty() && entry->opening == 0)
+            {
+                dsetPool.remove(fileName);
+                delete entry;
+            }
+        }
+        dsetPoolCond.signal(0, Cond::NOTIFY_ALL);
     }
+    dsetPoolCond.unlock();
+
+    if (dset) GDALClose((GDALDatasetH)dset);
+    delete [] fileName;
 }
 
 
@@ -802,7 +1432,11 @@ void GeoRaster::computeZonalStats(Raster *raster)
         bool validWindow = containsWindow(_col, _row, raster->cols, raster->rows, windowSize);
         if (validWindow)
         {
-            readRasterWithRetry(raster->band, _col, _row, windowSize, windowSize, samplesArray, windowSize, windowSize, &args);
+            /* Native resolution window, can be put together from cached blocks */
+            if (blockCacheMax > 0)
+                readCachedWindow(raster, _col, _row, windowSize, samplesArray);
+            else
+                readRasterWithRetry(raster->band, _col, _row, windowSize, windowSize, samplesArray, windowSize, windowSize, &args);
         }
         else
         {
@@ -812,59 +1446,30 @@ void GeoRaster::computeZonalStats(Raster *raster)
         if(validWindow)
         {
             /* One of the windows (raster or index data set) was valid. Compute zonal stats */
-            double min = std::numeric_limits<double>::max();
-            double max = std::numeric_limits<double>::min();
-            double sum = 0;
-            std::vector<double> validSamples;
 
             /*
              * Only use pixels within radius from pixel containing point of interest.
              * Ignore nodata values.
              */
-            const double x1 = col; /* Pixel of interest */
-            const double y1 = row;
-
-            for (int y = 0; y < windowSize; y++)
+            const std::vector<int32_t>& mask = getZonalMask(radiusInPixels);
+            std::vector<double> validSamples(mask.size());
+            int validSamplesCnt = 0;
+            for (size_t i = 0; i < mask.size(); i++)
             {
-                for (int x = 0; x < windowSize; x++)
-                {
-                    double value = samplesArray[y*windowSize + x];
-                    if (value == noDataValue) continue;
-
-                    double x2 = x + _col;  /* Current pixel in buffer */
-                    double y2 = y + _row;
-                    double xd = std::pow(x2 - x1, 2);
-                    double yd = std::pow(y2 - y1, 2);
-                    double d  = sqrtf64(xd + yd);
-
-                    if(std::islessequal(d, radiusInPixels))
-                    {
-                        if (value < min) min = value;
-                        if (value > max) max = value;
-                        sum += value; /* double may lose precision on overflows, should be ok...*/
-                        validSamples.push_back(value);
-                    }
-                }
+                double value = samplesArray[mask[i]];
+                if (value == noDataValue) continue;
+                validSamples[validSamplesCnt++] = value;
             }
 
-            int validSamplesCnt = validSamples.size();
             if (validSamplesCnt > 0)
             {
-                double stdev = 0;
-                double mad   = 0;
+                double min, max, sum;
+                zonalMoments(validSamples.data(), validSamplesCnt, &min, &max, &sum); /* double may lose precision on overflows, should be ok...*/
                 double mean  = sum / validSamplesCnt;
 
-                for (int i = 0; i < validSamplesCnt; i++)
-                {
-                    double value = validSamples[i];
-
-                    /* Standard deviation */
-                    stdev += std::pow(value - mean, 2);
-
-                    /* Median absolute deviation (MAD) */
-                    mad += fabsf64(value - mean);
-                }
-
+                /* Standard deviation and mean absolute deviation (MAD) */
+                double stdev, mad;
+                zonalDeviations(validSamples.data(), validSamplesCnt, mean, &stdev, &mad);
                 stdev = std::sqrt(stdev / validSamplesCnt);
                 mad   = mad / validSamplesCnt;
 
@@ -874,13 +1479,12 @@ void GeoRaster::computeZonalStats(Raster *raster)
                  * NOTE: (vector will be reordered by nth_element)
                  */
                 std::size_t n = validSamplesCnt / 2;
-                std::nth_element(validSamples.begin(), validSamples.begin() + n, validSamples.end());
+                std::nth_element(validSamples.begin(), validSamples.begin() + n, validSamples.begin() + validSamplesCnt);
                 double median = validSamples[n];
                 if (!(validSamplesCnt & 0x1))
                 {
-                    /* Even number of samples, calculate average of two middle samples */
-                    std::nth_element(validSamples.begin(), validSamples.begin() + n-1, validSamples.end());
-                    median = (median + validSamples[n-1]) / 2;
+                    /* Even number of samples, lower middle sample is the largest one left of n */
+                    median = (median + *std::max_element(validSamples.begin(), validSamples.begin() + n)) / 2;
                 }
 
                 /* Store calculated zonal stats */
@@ -904,12 +1508,172 @@ void GeoRaster::computeZonalStats(Raster *raster)
 }
 
 
+/*----------------------------------------------------------------------------
+ * getZonalMask
+ *
+ *  offsets, into a (2r+1) x (2r+1) window, of the pixels within r pixels of
+ *  the center pixel; built once per radius
+ *----------------------------------------------------------------------------*/
+const std::vector<int32_t>& GeoRaster::getZonalMask(int radiusInPixels)
+{
+    assert(radiusInPixels >= 0 && radiusInPixels <= MAX_SAMPLING_RADIUS_IN_PIXELS);
+
+    zonalMaskMut.lock();
+    {
+        std::vector<int32_t>& mask = zonalMasks[radiusInPixels];
+        if (mask.empty())
+        {
+            const int windowSize = radiusInPixels * 2 + 1;
+            for (int y = 0; y < windowSize; y++)
+            {
+                for (int x = 0; x < windowSize; x++)
+                {
+                    const int xd = x - radiusInPixels;
+                    const int yd = y - radiusInPixels;
+                    if ((xd * xd) + (yd * yd) <= (radiusInPixels * radiusInPixels))
+                        mask.push_back((y * windowSize) + x);
+                }
+            }
+        }
+    }
+    zonalMaskMut.unlock();
+
+    /* Never modified once built */
+    return zonalMasks[radiusInPixels];
+}
+
+/*----------------------------------------------------------------------------
+ * zonalMoments
+ *
+ *  min, max and sum of the samples; runs two samples per instruction where
+ *  SSE2 or NEON is available
+ *----------------------------------------------------------------------------*/
+void GeoRaster::zonalMoments(const double* v, int size, double* min_v, double* max_v, double* sum_v)
+{
+    double lo = DBL_MAX;
+    double hi = -DBL_MAX;
+    double sum = 0.0;
+    int i = 0;
+
+    #if defined(__SSE2__)
+    {
+        __m128d vlo = _mm_set1_pd(DBL_MAX);
+        __m128d vhi = _mm_set1_pd(-DBL_MAX);
+        __m128d vsum = _mm_setzero_pd();
+        for(; i + 2 <= size; i += 2)
+        {
+            __m128d x = _mm_loadu_pd(&v[i]);
+            vlo = _mm_min_pd(vlo, x);
+            vhi = _mm_max_pd(vhi, x);
+            vsum = _mm_add_pd(vsum, x);
+        }
+        double lane_lo[2];
+        double lane_hi[2];
+        double lane_sum[2];
+        _mm_storeu_pd(lane_lo, vlo);
+        _mm_storeu_pd(lane_hi, vhi);
+        _mm_storeu_pd(lane_sum, vsum);
+        lo = MIN(lane_lo[0], lane_lo[1]);
+        hi = MAX(lane_hi[0], lane_hi[1]);
+        sum = lane_sum[0] + lane_sum[1];
+    }
+    #elif defined(__aarch64__)
+    {
+        float64x2_t vlo = vdupq_n_f64(DBL_MAX);
+        float64x2_t vhi = vdupq_n_f64(-DBL_MAX);
+        float64x2_t vsum = vdupq_n_f64(0.0);
+        for(; i + 2 <= size; i += 2)
+        {
+            float64x2_t x = vld1q_f64(&v[i]);
+            vlo = vminq_f64(vlo, x);
+            vhi = vmaxq_f64(vhi, x);
+            vsum = vaddq_f64(vsum, x);
+        }
+        lo = vminvq_f64(vlo);
+        hi = vmaxvq_f64(vhi);
+        sum = vaddvq_f64(vsum);
+    }
+    #endif
+
+    /* Remaining Samples */
+    for(; i < size; i++)
+    {
+        if(v[i] < lo) lo = v[i];
+        if(v[i] > hi) hi = v[i];
+        sum += v[i];
+    }
+
+    *min_v = lo;
+    *max_v = hi;
+    *sum_v = sum;
+}
+
+/*----------------------------------------------------------------------------
+ * zonalDeviations
+ *
+ *  sums of squared and of absolute deviations of the samples from the mean,
+ *  vectorized the same way as zonalMoments
+ *----------------------------------------------------------------------------*/
+void GeoRaster::zonalDeviations(const double* v, int size, double mean, double* sq_dev, double* abs_dev)
+{
+    double sq = 0.0;
+    double ab = 0.0;
+    int i = 0;
+
+    #if defined(__SSE2__)
+    {
+        const __m128d m = _mm_set1_pd(mean);
+        const __m128d sign = _mm_set1_pd(-0.0);
+        __m128d vsq = _mm_setzero_pd();
+        __m128d vab = _mm_setzero_pd();
+        for(; i + 2 <= size; i += 2)
+        {
+            __m128d d = _mm_sub_pd(_mm_loadu_pd(&v[i]), m);
+            vsq = _mm_add_pd(vsq, _mm_mul_pd(d, d));
+            vab = _mm_add_pd(vab, _mm_andnot_pd(sign, d));
+        }
+        double lane_sq[2];
+        double lane_ab[2];
+        _mm_storeu_pd(lane_sq, vsq);
+        _mm_storeu_pd(lane_ab, vab);
+        sq = lane_sq[0] + lane_sq[1];
+        ab = lane_ab[0] + lane_ab[1];
+    }
+    #elif defined(__aarch64__)
+    {
+        const float64x2_t m = vdupq_n_f64(mean);
+        float64x2_t vsq = vdupq_n_f64(0.0);
+        float64x2_t vab = vdupq_n_f64(0.0);
+        for(; i + 2 <= size; i += 2)
+        {
+            float64x2_t d = vsubq_f64(vld1q_f64(&v[i]), m);
+            vsq = vfmaq_f64(vsq, d, d);
+            vab = vaddq_f64(vab, vabsq_f64(d));
+        }
+        sq = vaddvq_f64(vsq);
+        ab = vaddvq_f64(vab);
+    }
+    #endif
+
+    /* Remaining Samples */
+    for(; i < size; i++)
+    {
+        double d = v[i] - mean;
+        sq += d * d;
+        ab += fabs(d);
+    }
+
+    *sq_dev = sq;
+    *abs_dev = ab;
+}
+
+
 /*----------------------------------------------------------------------------
  * clear
  *----------------------------------------------------------------------------*/
 void GeoRaster::Raster::clear(bool close)
 {
-    if(close && dset) GDALClose((GDALDatasetH)dset);
+    if(close && dset) releaseDataset(fileName, dset);
     dset = NULL;
     band = NULL;
     sref = NULL;
@@ -930,6 +1694,7 @@ void GeoRaster::Raster::clear(bool close)
     gpsTime = 0;
     point.empty();
     bzero(&sample, sizeof(sample_t));
+    batch.clear();
 }
 
 /*----------------------------------------------------------------------------
@@ -1005,6 +1770,9 @@ void GeoRaster::updateCache(OGRPoint& p)
                 raster->fileName = key;
                 raster->gpsTime = static_cast<double>(TimeLib::gmt2gpstime(rinfo.gmtDate) / 1000);
                 rasterDict.add(key, raster);
+
+                /* Start opening it now so the reader does not wait on the open */
+                prefetchDataset(raster->fileName);
             }
         }
 
@@ -1046,69 +1814,48 @@ void GeoRaster::updateCache(OGRPoint& p)
 
 
 /*----------------------------------------------------------------------------
- * createThreads
+ * readRasters
+ *
+ *  reads the enabled rasters (or the rasters with queued points) as tasks of
+ *  the process wide TaskScheduler and waits for all of them; the calling
+ *  thread runs queued tasks while it waits
  *----------------------------------------------------------------------------*/
-void GeoRaster::createThreads(void)
+int GeoRaster::readRasters(bool queued)
 {
-    uint32_t threadsNeeded = rasterDict.length();
-    if (threadsNeeded <= readerCount)
-        return;
-
-    uint32_t newThreadsCnt = threadsNeeded - readerCount;
-    // print2term("Creating %d new threads, readerCount: %d, neededThreads: %d\n", newThreadsCnt, readerCount, threadsNeeded);
-
-    for (uint32_t i=0; i < newThreadsCnt; i++)
+    std::vector<read_task_t> tasks;
+    Raster *raster = NULL;
+    const char *key = rasterDict.first(&raster);
+    while (key != NULL)
     {
-        if (readerCount < MAX_READER_THREADS)
-        {
-            reader_t *reader = &rasterRreader[readerCount];
-            reader->raster = NULL;
-            reader->run = true;
-            reader->sync = new Cond(NUM_SYNC_SIGNALS);
-            reader->obj = this;
-            reader->thread = new Thread(readingThread, reader);
-            readerCount++;
-        }
-        else
+        assert(raster);
+        if (queued ? !raster->batch.empty() : raster->enabled)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR,
-                                   "number of rasters to read: %d, is greater than max reading threads %d\n",
-                                   rasterDict.length(), MAX_READER_THREADS);
+            read_task_t task = {this, raster};
+            tasks.push_back(task);
         }
+        key = rasterDict.next(&raster);
     }
-    assert(readerCount == threadsNeeded);
+
+    TaskScheduler::Group group;
+    for (size_t i = 0; i < tasks.size(); i++)
+        group.submit(readTask, &tasks[i]);
+    group.wait();
+
+    return static_cast<int>(tasks.size());
 }
 
 
 /*----------------------------------------------------------------------------
- * readingThread
+ * readTask
  *----------------------------------------------------------------------------*/
-void* GeoRaster::readingThread(void *param)
+void GeoRaster::readTask(void *parm)
 {
-    reader_t *reader = (reader_t*)param;
-    bool run = true;
-
-    while (run)
-    {
-        reader->sync->lock();
-        {
-            /* Wait for raster to work on */
-            while ((reader->raster == NULL) && reader->run)
-                reader->sync->wait(DATA_TO_SAMPLE, SYS_TIMEOUT);
-
-            if(reader->raster != NULL)
-            {
-                reader->obj->processRaster(reader->raster);
-                reader->raster = NULL; /* Done with this raster */
-                reader->sync->signal(DATA_SAMPLED, Cond::NOTIFY_ONE);
-            }
+    read_task_t* task = static_cast<read_task_t*>(parm);
 
-            run = reader->run;
-        }
-        reader->sync->unlock();
-    }
-
-    return NULL;
+    if(task->raster->batch.empty())
+        task->obj->processRaster(task->raster);
+    else
+        task->obj->processBatch(task->raster);
 }
 
 
@@ -1321,3 +2068,138 @@ int GeoRaster::luaSamples(lua_State *L)
     /* Return Status */
     return returnLuaStatus(L, status, num_ret);
 }
+
+
+/*----------------------------------------------------------------------------
+ * luaBatchSamples - :samples({{lon, lat}, ...}|<points>) --> columnar table|nil, status
+ *
+ * Samples all of the coordinates in one batch and returns a table of columns
+ * with one row per sample: point (index of the coordinate), value, time,
+ * file (index into files), and the flags and zonal stats when enabled.
+ * The coordinates can also be a string of native doubles holding all of the
+ * longitudes followed by all of the latitudes (as read by arrow.coordinates)
+ *----------------------------------------------------------------------------*/
+int GeoRaster::luaBatchSamples(lua_State *L)
+{
+    bool status = false;
+    int num_ret = 1;
+
+    double* lons = NULL;
+    double* lats = NULL;
+    List<sample_t>* slists = NULL;
+
+    try
+    {
+        /* Get Self */
+        GeoRaster *lua_obj = (GeoRaster *)getLuaSelf(L, 1);
+
+        /* Get Coordinates */
+        int num_points = 0;
+        if (lua_type(L, 2) == LUA_TSTRING)
+        {
+            size_t size = 0;
+            const char* points = lua_tolstring(L, 2, &size);
+            if (size % (2 * sizeof(double)) != 0)
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid size of coordinates: %ld", (long)size);
+
+            num_points = size / (2 * sizeof(double));
+            lons = new double [num_points];
+            lats = new double [num_points];
+            LocalLib::copy(lons, points, num_points * sizeof(double));
+            LocalLib::copy(lats, &points[num_points * sizeof(double)], num_points * sizeof(double));
+        }
+        else if (lua_istable(L, 2))
+        {
+            num_points = lua_rawlen(L, 2);
+            lons = new double [num_points];
+            lats = new double [num_points];
+            for (int i = 0; i < num_points; i++)
+            {
+                lua_rawgeti(L, 2, i + 1);
+                lua_rawgeti(L, -1, 1);
+                lons[i] = getLuaFloat(L, -1);
+                lua_rawgeti(L, -2, 2);
+                lats[i] = getLuaFloat(L, -1);
+                lua_pop(L, 3);
+            }
+        }
+        else
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "must supply a table of coordinates");
+        }
+
+        /* Sample All Coordinates */
+        slists = new List<sample_t> [num_points];
+        int num_samples = lua_obj->sampleBatch(lons, lats, num_points, slists, true);
+
+        /* Create Return Table */
+        bool zonal_stats = lua_obj->parms->zonal_stats;
+        bool flags = lua_obj->parms->auxiliary_files;
+        lua_createtable(L, 0, 13);
+
+        /* Populate Columns */
+        const char* columns[] = {"point", "value", "time", "file", "flags", "count", "min", "max", "mean", "median", "stdev", "mad"};
+        const int num_columns = sizeof(columns) / sizeof(columns[0]);
+        for (int c = 0; c < num_columns; c++)
+        {
+            if (c == 4 && !flags) continue;
+            if (c >= 5 && !zonal_stats) break;
+
+            lua_createtable(L, num_samples, 0);
+            int row = 0;
+            for (int i = 0; i < num_points; i++)
+            {
+                for (int j = 0; j < slists[i].length(); j++)
+                {
+                    const sample_t& sample = slists[i][j];
+                    switch (c)
+                    {
+                        case 0:  lua_pushinteger(L, i + 1);                break;
+                        case 1:  lua_pushnumber(L, sample.value);          break;
+                        case 2:  lua_pushnumber(L, sample.time);           break;
+                        case 3:  lua_pushinteger(L, sample.fileId + 1);    break;
+                        case 4:  lua_pushinteger(L, sample.flags);         break;
+                        case 5:  lua_pushinteger(L, sample.stats.count);   break;
+                        case 6:  lua_pushnumber(L, sample.stats.min);      break;
+                        case 7:  lua_pushnumber(L, sample.stats.max);      break;
+                        case 8:  lua_pushnumber(L, sample.stats.mean);     break;
+                        case 9:  lua_pushnumber(L, sample.stats.median);   break;
+                        case 10: lua_pushnumber(L, sample.stats.stdev);    break;
+                        default: lua_pushnumber(L, sample.stats.mad);      break;
+                    }
+                    lua_rawseti(L, -2, ++row);
+                }
+            }
+            lua_setfield(L, -2, columns[c]);
+        }
+
+        /* Populate File Names */
+        lua_obj->samplingMutex.lock(); /* File dictionary is updated while sampling */
+        lua_createtable(L, lua_obj->fileDict.length(), 0);
+        uint32_t file_id;
+        const char* file_name = lua_obj->fileDict.first(&file_id);
+        while (file_name != NULL)
+        {
+            lua_pushstring(L, file_name);
+            lua_rawseti(L, -2, file_id + 1);
+            file_name = lua_obj->fileDict.next(&file_id);
+        }
+        lua_obj->samplingMutex.unlock();
+        lua_setfield(L, -2, "files");
+
+        num_ret++;
+        status = true;
+    }
+    catch (const RunTimeException &e)
+    {
+        mlog(e.level(), "Failed to read batch of samples: %s", e.what());
+    }
+
+    /* Clean Up */
+    delete [] slists;
+    delete [] lats;
+    delete [] lons;
+
+    /* Return Status */
+    return returnLuaStatus(L, status, num_ret);
+}
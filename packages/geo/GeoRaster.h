@@ -40,8 +40,10 @@
 #include "OsApi.h"
 #include "TimeLib.h"
 #include "GeoParms.h"
+#include "TaskScheduler.h"
 #include <ogr_geometry.h>
 #include <ogrsf_frmts.h>
+#include <vector>
 
 /******************************************************************************
  * Typedef and macros used by geo package
@@ -85,9 +87,11 @@ class GeoRaster: public LuaObject
 
         static const int   INVALID_SAMPLE_VALUE = -1000000;
         static const int   MAX_SAMPLING_RADIUS_IN_PIXELS = 50;
-        static const int   MAX_READER_THREADS = 200;
         static const int   MAX_CACHED_RASTERS = 50;
         static const int   DEFAULT_EPSG = 4326;
+        static const long  DEFAULT_BLOCK_CACHE_SIZE = 0x10000000; // 256MB of decoded blocks, zero disables
+        static const int   MAX_POOLED_DATASETS = 256; // idle dataset handles kept open across all files
+        static const int   MAX_POOLED_DATASETS_PER_FILE = 4;
 
         static const char* OBJECT_TYPE;
         static const char* LuaMetaName;
@@ -161,6 +165,14 @@ class GeoRaster: public LuaObject
         } raster_info_t;
 
 
+        typedef struct {
+            uint32_t            index;      // of point in batch
+            OGRPoint            point;
+            bool                sampled;
+            sample_t            sample;
+        } batch_sample_t;
+
+
         class Raster
         {
         public:
@@ -188,20 +200,22 @@ class GeoRaster: public LuaObject
             OGRPoint        point;
             sample_t        sample;
 
+            /* Points queued by sampleBatch, in batch order */
+            std::vector<batch_sample_t> batch;
+
             uint32_t getPeerValue(void);
+            uint32_t getPeerValue(uint32_t index);
             void clear(bool close = true);
             Raster(void) { clear(false); }
            ~Raster (void) { clear(); }
         };
 
 
+        /* Raster read handed to the TaskScheduler */
         typedef struct {
             GeoRaster*  obj;
-            Thread*     thread;
             Raster*     raster;
-            Cond*       sync;
-            bool        run;
-        } reader_t;
+        } read_task_t;
 
 
         typedef GeoRaster* (*factory_t) (lua_State* L, GeoParms* _parms);
@@ -213,8 +227,11 @@ class GeoRaster: public LuaObject
         static void    init            (void);
         static void    deinit          (void);
         static int     luaCreate       (lua_State* L);
+        static int     luaBlockCache   (lua_State* L);
         static bool    registerRaster  (const char* _name, factory_t create);
         int            sample          (double lon, double lat, List<sample_t>& slist, void* param=NULL);
+        int            sampleBatch     (const double* lons, const double* lats, int n, List<sample_t>* results, bool sorted=false);
+        static uint64_t zOrder         (double lon, double lat);
         inline bool    hasZonalStats   (void) { return parms->zonal_stats; }
         inline bool    hasAuxiliary    (void) { return parms->auxiliary_files; }
         const char*    getUUID         (char* uuid_str);
@@ -237,11 +254,14 @@ class GeoRaster: public LuaObject
         int             radius2pixels         (double cellSize, int _radius);
         virtual void    sampleRasters         (void);
         void            processRaster         (Raster* raster);
+        void            processBatch          (Raster* raster);
         void            readRasterWithRetry   (GDALRasterBand* band, int col, int row, int colSize, int rowSize,
                                                void* data, int dataColSize, int dataRowSize, GDALRasterIOExtraArg *args);
 
         virtual bool    readGeoIndexData      (OGRPoint* point, int srcWindowSize, int srcOffset,
                                                void* data, int dstWindowSize, GDALRasterIOExtraArg* args);
+        static GDALDataset* acquireDataset    (const std::string& fileName);
+        static void     releaseDataset        (const std::string& fileName, GDALDataset* dset);
 
         inline bool containsPoint (Raster* raster, OGRPoint& p)
         {
@@ -263,12 +283,23 @@ class GeoRaster: public LuaObject
     private:
 
         /*--------------------------------------------------------------------
-         * Constants
+         * Types
          *--------------------------------------------------------------------*/
 
-        static const int DATA_TO_SAMPLE = 0;
-        static const int DATA_SAMPLED = 1;
-        static const int NUM_SYNC_SIGNALS = 2;
+        /* Decoded block in the process wide block cache (LRU list) */
+        typedef struct cached_block {
+            char*                   key;    // <file>:<band>:<block x>:<block y>
+            uint8_t*                data;
+            long                    size;
+            struct cached_block*    prev;   // more recently used
+            struct cached_block*    next;   // less recently used
+        } cached_block_t;
+
+        /* Opened datasets of one file in the process wide dataset pool */
+        typedef struct {
+            std::vector<GDALDataset*>   idle;       // opened and not used by any raster
+            int                         opening;    // opens submitted ahead of need, not yet done
+        } dset_pool_t;
 
         /*--------------------------------------------------------------------
          * Data
@@ -277,9 +308,22 @@ class GeoRaster: public LuaObject
         static Mutex factoryMut;
         static Dictionary<factory_t> factories;
 
+        static Mutex                        blockCacheMut;
+        static Dictionary<cached_block_t*>  blockCache;
+        static cached_block_t*              blockCacheHead;
+        static cached_block_t*              blockCacheTail;
+        static long                         blockCacheSize;
+        static long                         blockCacheMax;
+
+        static Cond                         dsetPoolCond;
+        static Dictionary<dset_pool_t*>     dsetPool;
+        static int                          dsetPoolIdle;
+        static TaskScheduler::Group*        dsetOpenGroup;
+
+        static Mutex                        zonalMaskMut;
+        static std::vector<int32_t>         zonalMasks[MAX_SAMPLING_RADIUS_IN_PIXELS + 1];
+
         Mutex        samplingMutex;
-        reader_t*    rasterRreader;
-        uint32_t     readerCount;
 
         Dictionary<uint32_t> fileDict;
 
@@ -291,17 +335,32 @@ class GeoRaster: public LuaObject
         static int luaBoundingBox(lua_State* L);
         static int luaCellSize(lua_State* L);
         static int luaSamples(lua_State* L);
+        static int luaBatchSamples(lua_State* L);
 
-        static void* readingThread (void *param);
+        static void readTask               (void* parm);
 
-        void       createThreads           (void);
+        int        readRasters             (bool queued);
         void       updateCache             (OGRPoint& p);
         int        sample                  (double lon, double lat);
         void       invalidateCache         (void);
+        int        sampleInOrder           (const double* lons, const double* lats, int n, List<sample_t>* results);
+        int        sampleQueuedRasters     (List<sample_t>* results);
+        void       clearQueuedRasters      (void);
         int        getSampledRastersCount  (void);
         void       readPixel               (Raster* raster);
+        void       readCachedBlock         (Raster* raster, int xblk, int yblk, long offset, long len, void* dst);
+        void       readCachedWindow        (Raster* raster, int col, int row, int windowSize, double* dst);
+        static double pixel2double         (const void* pixel, GDALDataType dataType);
+        static bool blockCacheGet          (const char* key, long offset, long len, void* dst);
+        static void blockCachePut          (const char* key, uint8_t* data, long size);
+        static void blockCacheRemove       (cached_block_t* entry);
+        static void prefetchDataset        (const std::string& fileName);
+        static void openDatasetTask        (void* parm);
         void       resamplePixel           (Raster* raster);
         void       computeZonalStats       (Raster* raster);
+        static const std::vector<int32_t>& getZonalMask (int radiusInPixels);
+        static void zonalMoments           (const double* v, int size, double* min_v, double* max_v, double* sum_v);
+        static void zonalDeviations        (const double* v, int size, double mean, double* sq_dev, double* abs_dev);
         uint32_t   fileDictAdd             (const std::string& fileName);
 
 };
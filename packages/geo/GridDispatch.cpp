@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <math.h>
+#include "core.h"
+#include "GridDispatch.h"
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+const char* GridDispatch::LuaMetaName = "GridDispatch";
+const struct luaL_Reg GridDispatch::LuaMetaTable[] = {
+    {NULL,          NULL}
+};
+
+const char* GridDispatch::cellRecType = "gridrec.cell";
+const RecordObject::fieldDef_t GridDispatch::cellRecDef[] = {
+    RECFIELD(cell_t, row, "row"),
+    RECFIELD(cell_t, col, "col"),
+    RECFIELD(cell_t, x, "x"),
+    RECFIELD(cell_t, y, "y"),
+    RECFIELD(cell_t, count, "count"),
+    RECFIELD(cell_t, mean, "mean"),
+    RECFIELD(cell_t, m2, "m2"),
+    RECFIELD(cell_t, min, "min"),
+    RECFIELD(cell_t, max, "max"),
+    RECFIELD(cell_t, hist, "hist"),
+    RECFIELD(cell_t, quantiles, "quantiles"),
+    RECFIELD(cell_t, centroid_mean, "centroid_mean"),
+    RECFIELD(cell_t, centroid_weight, "centroid_weight")
+};
+
+const char* GridDispatch::gridRecType = "gridrec";
+const RecordObject::fieldDef_t GridDispatch::gridRecDef[] = {
+    RECFIELD(grid_t, epsg, "epsg"),
+    RECFIELD(grid_t, cellsize, "cellsize"),
+    RECFIELD(grid_t, hist_min, "hist_min"),
+    RECFIELD(grid_t, hist_max, "hist_max"),
+    RECFIELD(grid_t, sketch, "sketch"),
+    RECFIELD(grid_t, num_cells, "num_cells"),
+    RECFIELD_VAR(grid_t, cells, "cells") // variable length
+};
+
+const double GridDispatch::Quantiles[NUM_QUANTILES] = {0.10, 0.25, 0.50, 0.75, 0.90};
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * luaCreate - :grid(<outq name>, <rec_type>, <lon_key>, <lat_key>, <value_key>, <cellsize>, [<epsg>], [<hist_min>, <hist_max>], [<sketch>])
+ *----------------------------------------------------------------------------*/
+int GridDispatch::luaCreate (lua_State* L)
+{
+    try
+    {
+        /* Get Parameters */
+        const char* outq_name   = getLuaString(L, 1);
+        const char* rec_type    = getLuaString(L, 2);
+        const char* lon_key     = getLuaString(L, 3);
+        const char* lat_key     = getLuaString(L, 4);
+        const char* value_key   = getLuaString(L, 5);
+        double cellsize         = getLuaFloat(L, 6);
+        long epsg               = getLuaInteger(L, 7, true, GeoRaster::DEFAULT_EPSG);
+        double hist_min         = getLuaFloat(L, 8, true, 0.0);
+        double hist_max         = getLuaFloat(L, 9, true, 0.0);
+        bool sketch             = getLuaBoolean(L, 10, true, false);
+
+        /* Check Parameters */
+        if(cellsize <= 0.0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid cell size: %lf", cellsize);
+        }
+
+        /* Create Dispatch */
+        return createLuaObject(L, new GridDispatch(L, outq_name, rec_type, lon_key, lat_key, value_key, cellsize, (int32_t)epsg, hist_min, hist_max, sketch));
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error creating %s: %s", LuaMetaName, e.what());
+        return returnLuaStatus(L, false);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * init
+ *----------------------------------------------------------------------------*/
+void GridDispatch::init (void)
+{
+    RECDEF(cellRecType, cellRecDef, sizeof(cell_t), NULL);
+    RECDEF(gridRecType, gridRecDef, sizeof(grid_t), NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * deinit
+ *----------------------------------------------------------------------------*/
+void GridDispatch::deinit (void)
+{
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ *******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+GridDispatch::GridDispatch (lua_State* L, const char* outq_name, const char* rec_type, const char* lon_key, const char* lat_key, const char* value_key,
+                            double cellsize, int32_t _epsg, double hist_min, double hist_max, bool sketch):
+    DispatchObject(L, LuaMetaName, LuaMetaTable)
+{
+    assert(outq_name);
+    assert(rec_type);
+    assert(lon_key);
+    assert(lat_key);
+    assert(value_key);
+
+    epsg = _epsg;
+    cellSize = cellsize;
+    histMin = hist_min;
+    histMax = hist_max;
+    useSketch = sketch;
+    transf = NULL;
+    gridPosted = false;
+
+    /* Create Transform into Grid CRS */
+    if(epsg != GeoRaster::DEFAULT_EPSG)
+    {
+        OGRErr ogrerr = source.importFromEPSG(GeoRaster::DEFAULT_EPSG);
+        CHECK_GDALERR(ogrerr);
+        ogrerr = target.importFromEPSG(epsg);
+        CHECK_GDALERR(ogrerr);
+
+        /* Force traditional axis order to avoid lat,lon and lon,lat API madness */
+        target.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+        source.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+
+        transf = OGRCreateCoordinateTransformation(&source, &target);
+        if(transf == NULL)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Failed to create coordinate transform to EPSG:%d", epsg);
+        }
+    }
+
+    outQ = new Publisher(outq_name);
+
+    recordSizeBytes = RecordObject::getRecordDataSize(rec_type);
+    if(recordSizeBytes <= 0)
+    {
+        mlog(CRITICAL, "Failed to get size of point for record type: %s", rec_type);
+    }
+
+    lonField = RecordObject::getDefinedField(rec_type, lon_key);
+    if(lonField.type == RecordObject::INVALID_FIELD)
+    {
+        mlog(CRITICAL, "Failed to get field %s from record type: %s", lon_key, rec_type);
+    }
+
+    latField = RecordObject::getDefinedField(rec_type, lat_key);
+    if(latField.type == RecordObject::INVALID_FIELD)
+    {
+        mlog(CRITICAL, "Failed to get field %s from record type: %s", lat_key, rec_type);
+    }
+
+    valueField = RecordObject::getDefinedField(rec_type, value_key);
+    if(valueField.type == RecordObject::INVALID_FIELD)
+    {
+        mlog(CRITICAL, "Failed to get field %s from record type: %s", value_key, rec_type);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+GridDispatch::~GridDispatch(void)
+{
+    if(transf) OGRCoordinateTransformation::DestroyCT(transf);
+    delete outQ;
+
+    for(std::unordered_map<uint64_t, sketch_t*>::iterator iter = sketches.begin(); iter != sketches.end(); iter++)
+    {
+        delete iter->second;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * processRecord
+ *
+ *  INPUT:  batch of points laid out as consecutive records of rec_type,
+ *          or a grid record from another node which is merged cell by cell
+ *----------------------------------------------------------------------------*/
+bool GridDispatch::processRecord (RecordObject* record, okey_t key)
+{
+    (void)key;
+
+    /* Merge Partial Grid */
+    if(StringLib::match(record->getRecordType(), gridRecType))
+    {
+        return mergeGrid(record);
+    }
+
+    /* Determine Number of Points in Record */
+    int record_size_bytes = record->getAllocatedDataSize();
+    int num_points = record_size_bytes / recordSizeBytes;
+    int left_over = record_size_bytes % recordSizeBytes;
+    if(left_over > 0 || recordSizeBytes <= 0)
+    {
+        mlog(ERROR, "Invalid record size received for %s: %d %% %d != 0", record->getRecordType(), record_size_bytes, recordSizeBytes);
+        return false;
+    }
+
+    /* Initialize Local Fields */
+    RecordObject::field_t lon_field = lonField;
+    RecordObject::field_t lat_field = latField;
+    RecordObject::field_t value_field = valueField;
+
+    /* Get Coordinates and Values of Each Point in Batch */
+    double* x = new double [num_points];
+    double* y = new double [num_points];
+    double* v = new double [num_points];
+    int* valid = new int [num_points];
+    for(int p = 0; p < num_points; p++)
+    {
+        x[p] = record->getValueReal(lon_field);
+        y[p] = record->getValueReal(lat_field);
+        v[p] = record->getValueReal(value_field);
+        valid[p] = true;
+        lon_field.offset += (recordSizeBytes * 8);
+        lat_field.offset += (recordSizeBytes * 8);
+        value_field.offset += (recordSizeBytes * 8);
+    }
+
+    /* Bin Points */
+    gridMut.lock();
+    {
+        /* Project Points (transform is not thread safe) */
+        if(transf && !transf->Transform(num_points, x, y, NULL, valid))
+        {
+            mlog(DEBUG, "Failed to project some of %d points to EPSG:%d", num_points, epsg);
+        }
+
+        for(int p = 0; p < num_points; p++)
+        {
+            if(!valid[p] || std::isnan(v[p])) continue;
+            int32_t row = static_cast<int32_t>(floor(y[p] / cellSize));
+            int32_t col = static_cast<int32_t>(floor(x[p] / cellSize));
+            addValue(getCell(row, col), v[p]);
+            if(useSketch) getSketch(row, col)->add(v[p]);
+        }
+    }
+    gridMut.unlock();
+
+    delete [] x;
+    delete [] y;
+    delete [] v;
+    delete [] valid;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processTimeout
+ *----------------------------------------------------------------------------*/
+bool GridDispatch::processTimeout (void)
+{
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * processTermination
+ *
+ *  posts the grid in records of up to CELLS_PER_RECORD cells; called once for
+ *  each record type the dispatch is attached to, but only posts once
+ *----------------------------------------------------------------------------*/
+bool GridDispatch::processTermination (void)
+{
+    bool status = true;
+
+    gridMut.lock();
+    {
+        if(!gridPosted)
+        {
+            gridPosted = true;
+
+            std::unordered_map<uint64_t, cell_t>::const_iterator iter = cells.begin();
+            size_t cells_left = cells.size();
+            while(status && cells_left > 0)
+            {
+                uint32_t num_cells = MIN(cells_left, (size_t)CELLS_PER_RECORD);
+                cells_left -= num_cells;
+                TypedRecord<grid_t> record(offsetof(grid_t, cells) + (num_cells * sizeof(cell_t)));
+                grid_t* grid = record.data();
+                grid->epsg = epsg;
+                grid->cellsize = cellSize;
+                grid->hist_min = histMin;
+                grid->hist_max = histMax;
+                grid->sketch = useSketch;
+                grid->num_cells = num_cells;
+                for(uint32_t c = 0; c < num_cells; c++, iter++)
+                {
+                    cell_t& cell = grid->cells[c];
+                    cell = iter->second;
+                    if(useSketch)
+                    {
+                        sketch_t* sketch = sketches[iter->first];
+                        for(int q = 0; q < NUM_QUANTILES; q++)
+                        {
+                            cell.quantiles[q] = (float)sketch->quantile(Quantiles[q]);
+                        }
+                        sketch->centroids(cell.centroid_mean, cell.centroid_weight);
+                    }
+                }
+                status = record.post(outQ);
+            }
+
+            mlog(DEBUG, "Posted grid of %ld cells to %s", (long)cells.size(), outQ->getName());
+            cells.clear();
+
+            for(std::unordered_map<uint64_t, sketch_t*>::iterator s_iter = sketches.begin(); s_iter != sketches.end(); s_iter++)
+            {
+                delete s_iter->second;
+            }
+            sketches.clear();
+        }
+    }
+    gridMut.unlock();
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * mergeGrid
+ *----------------------------------------------------------------------------*/
+bool GridDispatch::mergeGrid (RecordObject* record)
+{
+    grid_t* grid = (grid_t*)record->getRecordData();
+    long size = record->getAllocatedDataSize();
+    if(size < (long)offsetof(grid_t, cells) || size < (long)(offsetof(grid_t, cells) + (grid->num_cells * sizeof(cell_t))))
+    {
+        mlog(ERROR, "Invalid grid record size: %d", size);
+        return false;
+    }
+
+    if(grid->epsg != epsg || grid->cellsize != cellSize || grid->hist_min != histMin || grid->hist_max != histMax || (bool)grid->sketch != useSketch)
+    {
+        mlog(ERROR, "Unable to merge grid of %lf in EPSG:%d into grid of %lf in EPSG:%d", grid->cellsize, grid->epsg, cellSize, epsg);
+        return false;
+    }
+
+    gridMut.lock();
+    {
+        for(uint32_t c = 0; c < grid->num_cells; c++)
+        {
+            const cell_t& other = grid->cells[c];
+            mergeCell(getCell(other.row, other.col), other);
+            if(useSketch) getSketch(other.row, other.col)->merge(other.centroid_mean, other.centroid_weight, NUM_CENTROIDS, other.min, other.max);
+        }
+    }
+    gridMut.unlock();
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * cellKey
+ *----------------------------------------------------------------------------*/
+uint64_t GridDispatch::cellKey (int32_t row, int32_t col)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(col);
+}
+
+/*----------------------------------------------------------------------------
+ * getCell
+ *
+ *  must be called with gridMut locked; creates an empty cell on first use
+ *----------------------------------------------------------------------------*/
+GridDispatch::cell_t& GridDispatch::getCell (int32_t row, int32_t col)
+{
+    uint64_t key = cellKey(row, col);
+    std::pair<std::unordered_map<uint64_t, cell_t>::iterator, bool> entry = cells.insert(std::make_pair(key, cell_t()));
+    cell_t& cell = entry.first->second;
+    if(entry.second)
+    {
+        LocalLib::set(&cell, 0, sizeof(cell_t));
+        cell.row = row;
+        cell.col = col;
+        cell.x = (col + 0.5) * cellSize;
+        cell.y = (row + 0.5) * cellSize;
+        cell.min = INFINITY;
+        cell.max = -INFINITY;
+    }
+    return cell;
+}
+
+/*----------------------------------------------------------------------------
+ * getSketch
+ *
+ *  must be called with gridMut locked; creates an empty sketch on first use
+ *----------------------------------------------------------------------------*/
+GridDispatch::sketch_t* GridDispatch::getSketch (int32_t row, int32_t col)
+{
+    sketch_t*& sketch = sketches[cellKey(row, col)];
+    if(!sketch) sketch = new sketch_t();
+    return sketch;
+}
+
+/*----------------------------------------------------------------------------
+ * addValue - Welford's update
+ *----------------------------------------------------------------------------*/
+void GridDispatch::addValue (cell_t& cell, double value)
+{
+    cell.count++;
+    double delta = value - cell.mean;
+    cell.mean += delta / cell.count;
+    cell.m2 += delta * (value - cell.mean);
+    cell.min = MIN(cell.min, value);
+    cell.max = MAX(cell.max, value);
+
+    if(histMax > histMin)
+    {
+        int bin = static_cast<int>(floor((value - histMin) / (histMax - histMin) * NUM_HIST_BINS));
+        bin = MAX(MIN(bin, NUM_HIST_BINS - 1), 0);
+        cell.hist[bin]++;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * mergeCell - Chan's parallel update
+ *----------------------------------------------------------------------------*/
+void GridDispatch::mergeCell (cell_t& cell, const cell_t& other)
+{
+    if(other.count == 0) return;
+
+    uint32_t count = cell.count + other.count;
+    double delta = other.mean - cell.mean;
+    cell.mean += delta * other.count / count;
+    cell.m2 += other.m2 + (delta * delta * cell.count * other.count / count);
+    cell.count = count;
+    cell.min = MIN(cell.min, other.min);
+    cell.max = MAX(cell.max, other.max);
+    for(int b = 0; b < NUM_HIST_BINS; b++)
+    {
+        cell.hist[b] += other.hist[b];
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __grid_dispatch__
+#define __grid_dispatch__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <unordered_map>
+#include "MsgQ.h"
+#include "LuaObject.h"
+#include "RecordObject.h"
+#include "DispatchObject.h"
+#include "OsApi.h"
+#include "QuantileSketch.h"
+#include "GeoRaster.h"
+
+/******************************************************************************
+ * GRID DISPATCH CLASS
+ ******************************************************************************/
+
+/*
+ * GridDispatch - bins a value field of incoming point records into cells of
+ *  a fixed size in a projected CRS and posts one accumulator per occupied cell
+ *  on termination.  The cells are aligned to the CRS origin, so grids built
+ *  on different nodes line up and grid records received from other nodes are
+ *  merged into the local accumulators.  When requested, each cell also keeps
+ *  a quantile sketch whose centroids travel in the cell record so that the
+ *  quantiles of the merged grid are approximately those of all its points.
+ */
+class GridDispatch: public DispatchObject
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const char* LuaMetaName;
+        static const struct luaL_Reg LuaMetaTable[];
+
+        static const char* cellRecType;
+        static const RecordObject::fieldDef_t cellRecDef[];
+
+        static const char* gridRecType;
+        static const RecordObject::fieldDef_t gridRecDef[];
+
+        static const int NUM_HIST_BINS = 16;        // equal width bins between hist_min and hist_max, for quantiles
+        static const int NUM_CENTROIDS = 32;        // capacity of quantile sketch
+        static const int NUM_QUANTILES = 5;
+        static const double Quantiles[NUM_QUANTILES];
+        static const int CELLS_PER_RECORD = 256;
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Cell Accumulator */
+        typedef struct {
+            int32_t             row;
+            int32_t             col;
+            double              x;                  // center of cell in grid crs
+            double              y;
+            uint32_t            count;
+            double              mean;
+            double              m2;                 // sum of squared differences from mean
+            double              min;
+            double              max;
+            uint32_t            hist[NUM_HIST_BINS];
+            float               quantiles[NUM_QUANTILES];       // from sketch, at 10, 25, 50, 75, and 90 percent
+            float               centroid_mean[NUM_CENTROIDS];   // zero weight for unused centroids
+            uint32_t            centroid_weight[NUM_CENTROIDS];
+        } cell_t;
+
+        /* Grid Record */
+        typedef struct {
+            int32_t             epsg;
+            double              cellsize;
+            double              hist_min;
+            double              hist_max;
+            uint8_t             sketch;
+            uint32_t            num_cells;
+            cell_t              cells[];
+        } grid_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static int      luaCreate   (lua_State* L);
+        static void     init        (void);
+        static void     deinit      (void);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef QuantileSketch<NUM_CENTROIDS> sketch_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        Publisher*                              outQ;
+        int                                     recordSizeBytes;
+        RecordObject::field_t                   lonField;
+        RecordObject::field_t                   latField;
+        RecordObject::field_t                   valueField;
+        int32_t                                 epsg;
+        double                                  cellSize;
+        double                                  histMin;
+        double                                  histMax;
+        OGRSpatialReference                     source;
+        OGRSpatialReference                     target;
+        OGRCoordinateTransformation*            transf;     // NULL when grid is in lon/lat
+        Mutex                                   gridMut;
+        std::unordered_map<uint64_t, cell_t>    cells;
+        bool                                    useSketch;
+        std::unordered_map<uint64_t, sketch_t*> sketches;   // by cell key, only when useSketch
+        bool                                    gridPosted;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+                        GridDispatch            (lua_State* L, const char* outq_name, const char* rec_type, const char* lon_key, const char* lat_key, const char* value_key,
+                                                 double cellsize, int32_t _epsg, double hist_min, double hist_max, bool sketch);
+                        ~GridDispatch           (void);
+
+        bool            processRecord           (RecordObject* record, okey_t key) override;
+        bool            processTimeout          (void) override;
+        bool            processTermination      (void) override;
+
+        bool            mergeGrid               (RecordObject* record);
+        static uint64_t cellKey                 (int32_t row, int32_t col);
+        cell_t&         getCell                 (int32_t row, int32_t col);
+        sketch_t*       getSketch               (int32_t row, int32_t col);
+        void            addValue                (cell_t& cell, double value);
+        static void     mergeCell               (cell_t& cell, const cell_t& other);
+};
+
+/******************************************************************************
+ * RECORD TYPES
+ ******************************************************************************/
+
+RECTYPE(GridDispatch::cell_t, GridDispatch::cellRecType)
+RECTYPE(GridDispatch::grid_t, GridDispatch::gridRecType)
+
+#endif  /* __grid_dispatch__ */
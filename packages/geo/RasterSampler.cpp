@@ -47,47 +47,47 @@ const struct luaL_Reg RasterSampler::LuaMetaTable[] = {
 
 const char* RasterSampler::rsSampleRecType = "rsrec.sample";
 const RecordObject::fieldDef_t RasterSampler::rsSampleRecDef[] = {
-    {"value",           RecordObject::DOUBLE,   offsetof(sample_t, value),      1,  NULL, NATIVE_FLAGS},
-    {"time",            RecordObject::DOUBLE,   offsetof(sample_t, time),       1,  NULL, NATIVE_FLAGS},
-    {"file_id",         RecordObject::UINT32,   offsetof(sample_t, file_id),    1,  NULL, NATIVE_FLAGS},
-    {"flags",           RecordObject::UINT32,   offsetof(sample_t, flags),      1,  NULL, NATIVE_FLAGS}
+    RECFIELD(sample_t, value, "value"),
+    RECFIELD(sample_t, time, "time"),
+    RECFIELD(sample_t, file_id, "file_id"),
+    RECFIELD(sample_t, flags, "flags")
 };
 
 const char* RasterSampler::rsGeoRecType = "rsrec";
 const RecordObject::fieldDef_t RasterSampler::rsGeoRecDef[] = {
-    {"index",           RecordObject::UINT64,   offsetof(rs_geo_t, index),           1,  NULL, NATIVE_FLAGS},
-    {"key",             RecordObject::STRING,   offsetof(rs_geo_t, raster_key),      RASTER_KEY_MAX_LEN,  NULL, NATIVE_FLAGS},
-    {"num_samples",     RecordObject::UINT32,   offsetof(rs_geo_t, num_samples),     1,  NULL, NATIVE_FLAGS},
-    {"samples",         RecordObject::USER,     offsetof(rs_geo_t, samples),         0,  rsSampleRecType, NATIVE_FLAGS} // variable length
+    RECFIELD(rs_geo_t, index, "index"),
+    RECFIELD(rs_geo_t, raster_key, "key"),
+    RECFIELD(rs_geo_t, num_samples, "num_samples"),
+    RECFIELD(rs_geo_t, samples, "samples") // variable length
 };
 
 const char* RasterSampler::zsSampleRecType = "zsrec.sample";
 const RecordObject::fieldDef_t RasterSampler::zsSampleRecDef[] = {
-    {"value",           RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, value),           1,  NULL, NATIVE_FLAGS},
-    {"time",            RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, time),            1,  NULL, NATIVE_FLAGS},
-    {"file_id",         RecordObject::UINT32,   offsetof(VrtRaster::sample_t, fileId),          1,  NULL, NATIVE_FLAGS},
-    {"flags",           RecordObject::UINT32,   offsetof(VrtRaster::sample_t, flags),           1,  NULL, NATIVE_FLAGS},
-    {"count",           RecordObject::UINT32,   offsetof(VrtRaster::sample_t, stats.count),     1,  NULL, NATIVE_FLAGS},
-    {"min",             RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.min),       1,  NULL, NATIVE_FLAGS},
-    {"max",             RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.max),       1,  NULL, NATIVE_FLAGS},
-    {"mean",            RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.mean),      1,  NULL, NATIVE_FLAGS},
-    {"median",          RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.median),    1,  NULL, NATIVE_FLAGS},
-    {"stdev",           RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.stdev),     1,  NULL, NATIVE_FLAGS},
-    {"mad",             RecordObject::DOUBLE,   offsetof(VrtRaster::sample_t, stats.mad),       1,  NULL, NATIVE_FLAGS}
+    RECFIELD(VrtRaster::sample_t, value, "value"),
+    RECFIELD(VrtRaster::sample_t, time, "time"),
+    RECFIELD(VrtRaster::sample_t, fileId, "file_id"),
+    RECFIELD(VrtRaster::sample_t, flags, "flags"),
+    RECFIELD(VrtRaster::sample_t, stats.count, "count"),
+    RECFIELD(VrtRaster::sample_t, stats.min, "min"),
+    RECFIELD(VrtRaster::sample_t, stats.max, "max"),
+    RECFIELD(VrtRaster::sample_t, stats.mean, "mean"),
+    RECFIELD(VrtRaster::sample_t, stats.median, "median"),
+    RECFIELD(VrtRaster::sample_t, stats.stdev, "stdev"),
+    RECFIELD(VrtRaster::sample_t, stats.mad, "mad")
 };
 
 const char* RasterSampler::zsGeoRecType = "zsrec";
 const RecordObject::fieldDef_t RasterSampler::zsGeoRecDef[] = {
-    {"index",           RecordObject::UINT64,   offsetof(zs_geo_t, index),           1,  NULL, NATIVE_FLAGS},
-    {"key",             RecordObject::STRING,   offsetof(zs_geo_t, raster_key),      RASTER_KEY_MAX_LEN,  NULL, NATIVE_FLAGS},
-    {"num_samples",     RecordObject::UINT32,   offsetof(zs_geo_t, num_samples),     1,  NULL, NATIVE_FLAGS},
-    {"samples",         RecordObject::USER,     offsetof(zs_geo_t, samples),         0,  zsSampleRecType, NATIVE_FLAGS} // variable length
+    RECFIELD(zs_geo_t, index, "index"),
+    RECFIELD(zs_geo_t, raster_key, "key"),
+    RECFIELD(zs_geo_t, num_samples, "num_samples"),
+    RECFIELD(zs_geo_t, samples, "samples") // variable length
 };
 
 const char* RasterSampler::fileIdRecType = "fileidrec";
 const RecordObject::fieldDef_t RasterSampler::fileIdRecDef[] = {
-    {"file_id",         RecordObject::UINT32,   offsetof(file_directory_entry_t, file_id),      1,  NULL, NATIVE_FLAGS},
-    {"file_name",       RecordObject::STRING,   offsetof(file_directory_entry_t, file_name),    0,  NULL, NATIVE_FLAGS} // variable length
+    RECFIELD(file_directory_entry_t, file_id, "file_id"),
+    RECFIELD(file_directory_entry_t, file_name, "file_name") // variable length
 };
 
 /******************************************************************************
@@ -95,7 +95,7 @@ const RecordObject::fieldDef_t RasterSampler::fileIdRecDef[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - :sampler(<vrt_raster>, <vrt_raster_index>, <outq name>, <rec_type>, <index_key>, <lon_key>, <lat_key>)
+ * luaCreate - :sampler(<vrt_raster>, <vrt_raster_index>, <outq name>, <rec_type>, <index_key>, <lon_key>, <lat_key>, [<sort_batch>])
  *----------------------------------------------------------------------------*/
 int RasterSampler::luaCreate (lua_State* L)
 {
@@ -110,9 +110,16 @@ int RasterSampler::luaCreate (lua_State* L)
         const char* index_key   = getLuaString(L, 5);
         const char* lon_key     = getLuaString(L, 6);
         const char* lat_key     = getLuaString(L, 7);
+        long sort_batch         = getLuaInteger(L, 8, true, DEFAULT_SORT_BATCH);
+
+        /* Check Parameters */
+        if(sort_batch < 0 || sort_batch > INT32_MAX)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid sort batch size: %ld", sort_batch);
+        }
 
         /* Create Dispatch */
-        return createLuaObject(L, new RasterSampler(L, _raster, raster_key, outq_name, rec_type, index_key, lon_key, lat_key));
+        return createLuaObject(L, new RasterSampler(L, _raster, raster_key, outq_name, rec_type, index_key, lon_key, lat_key, (int)sort_batch));
     }
     catch(const RunTimeException& e)
     {
@@ -148,7 +155,7 @@ void RasterSampler::deinit (void)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-RasterSampler::RasterSampler (lua_State* L, VrtRaster* _raster, const char* raster_key, const char* outq_name, const char* rec_type, const char* index_key, const char* lon_key, const char* lat_key):
+RasterSampler::RasterSampler (lua_State* L, VrtRaster* _raster, const char* raster_key, const char* outq_name, const char* rec_type, const char* index_key, const char* lon_key, const char* lat_key, int sort_batch):
     DispatchObject(L, LuaMetaName, LuaMetaTable)
 {
     assert(_raster);
@@ -161,6 +168,10 @@ RasterSampler::RasterSampler (lua_State* L, VrtRaster* _raster, const char* rast
 
     outQ = new Publisher(outq_name);
 
+    sortBatchSize = sort_batch;
+    points = (sortBatchSize > 0) ? new point_t [sortBatchSize] : NULL;
+    numPoints = 0;
+
     recordSizeBytes = RecordObject::getRecordDataSize(rec_type);
     if(recordSizeBytes <= 0)
     {
@@ -194,6 +205,7 @@ RasterSampler::~RasterSampler(void)
     raster->releaseLuaObject();
     delete outQ;
     if(rasterKey) delete [] rasterKey;
+    if(points) delete [] points;
 }
 
 /*----------------------------------------------------------------------------
@@ -203,6 +215,9 @@ RasterSampler::~RasterSampler(void)
  *  INPUT:  batch of atl06 extents
  *          each extent (up to 256 per record) will produce a single output record with one point
  *          that one point may have multiple samples associated with it
+ *
+ *  In sorted mode the extents are buffered across records and sampled once
+ *  sortBatchSize points have accumulated (or on termination)
  *----------------------------------------------------------------------------*/
 bool RasterSampler::processRecord (RecordObject* record, okey_t key)
 {
@@ -225,66 +240,39 @@ bool RasterSampler::processRecord (RecordObject* record, okey_t key)
     RecordObject::field_t lon_field = lonField;
     RecordObject::field_t lat_field = latField;
 
-    /* Loop Through Each Record in Batch */
+    /* Get Coordinates of Each Extent in Batch */
+    point_t* record_points = (sortBatchSize > 0) ? NULL : new point_t [num_extents];
     for(int extent = 0; extent < num_extents; extent++)
     {
+        point_t* point = (sortBatchSize > 0) ? &points[numPoints] : &record_points[extent];
+
         /* Get Extent Id */
-        uint64_t index = (uint64_t)record->getValueInteger(index_field);
+        point->index = (uint64_t)record->getValueInteger(index_field);
         index_field.offset += (recordSizeBytes * 8);
 
         /* Get Longitude */
-        double lon_val = record->getValueReal(lon_field);
+        point->lon = record->getValueReal(lon_field);
         lon_field.offset += (recordSizeBytes * 8);
 
         /* Get Latitude */
-        double lat_val = record->getValueReal(lat_field);
+        point->lat = record->getValueReal(lat_field);
         lat_field.offset += (recordSizeBytes * 8);
 
-        /* Sample Raster */
-        List<VrtRaster::sample_t> slist;
-        int num_samples = raster->sample(lon_val, lat_val, slist);
-
-        if(raster->hasZonalStats())
-        {
-            /* Create and Post Sample Record */
-            int size_of_record = offsetof(zs_geo_t, samples) + (sizeof(VrtRaster::sample_t) * num_samples);
-            RecordObject stats_rec(zsGeoRecType, size_of_record);
-            zs_geo_t* data = (zs_geo_t*)stats_rec.getRecordData();
-            data->index = index;
-            StringLib::copy(data->raster_key, rasterKey, RASTER_KEY_MAX_LEN);
-            data->num_samples = num_samples;
-            for(int i = 0; i < num_samples; i++)
-            {
-                data->samples[i] = slist[i];
-            }
-            if(!stats_rec.post(outQ))
-            {
-                status = false;
-            }
-        }
-        else
+        /* Sample Buffered Points (sorted mode) */
+        if(sortBatchSize > 0 && ++numPoints == sortBatchSize)
         {
-            /* Create and Post Sample Record */
-            int size_of_record = offsetof(rs_geo_t, samples) + (sizeof(sample_t) * num_samples);
-            RecordObject sample_rec(rsGeoRecType, size_of_record);
-            rs_geo_t* data = (rs_geo_t*)sample_rec.getRecordData();
-            data->index = index;
-            StringLib::copy(data->raster_key, rasterKey, RASTER_KEY_MAX_LEN);
-            data->num_samples = num_samples;
-            for(int i = 0; i < num_samples; i++)
-            {
-                data->samples[i].value = slist[i].value;
-                data->samples[i].time = slist[i].time;
-                data->samples[i].file_id = slist[i].fileId;
-                data->samples[i].flags = slist[i].flags;
-            }
-            if(!sample_rec.post(outQ))
-            {
-                status = false;
-            }
+            if(!samplePoints(points, numPoints, true)) status = false;
+            numPoints = 0;
         }
     }
 
+    /* Sample Raster (all extents at once) */
+    if(record_points)
+    {
+        status = samplePoints(record_points, num_extents, false);
+        delete [] record_points;
+    }
+
     /* Return Status */
     return status;
 }
@@ -304,17 +292,106 @@ bool RasterSampler::processTimeout (void)
  *----------------------------------------------------------------------------*/
 bool RasterSampler::processTermination (void)
 {
+    /* Sample Remaining Buffered Points */
+    if(numPoints > 0)
+    {
+        samplePoints(points, numPoints, true);
+        numPoints = 0;
+    }
+
     Dictionary<uint32_t>::Iterator iterator(raster->fileDictGet());
     for(int i = 0; i < iterator.length; i++)
     {
         /* Send File Directory Entry Record for each File in Raster Dictionary */
         int file_name_len = StringLib::size(iterator[i].key) + 1;
         int size = offsetof(file_directory_entry_t, file_name) + file_name_len;
-        RecordObject record(fileIdRecType, size);
-        file_directory_entry_t* entry = (file_directory_entry_t*)record.getRecordData();
+        TypedRecord<file_directory_entry_t> record(size);
+        file_directory_entry_t* entry = record.data();
         entry->file_id = iterator[i].value;
         StringLib::copy(entry->file_name, iterator[i].key, file_name_len);
         record.post(outQ);
     }
     return true;
 }
+
+/*----------------------------------------------------------------------------
+ * samplePoints
+ *
+ *  When sorted, the points are sampled in Z-order so that points falling in
+ *  the same raster (and the same blocks within it) are sampled together; the
+ *  output records are still posted in the order the points were received
+ *----------------------------------------------------------------------------*/
+bool RasterSampler::samplePoints (const point_t* pts, int num_points, bool sorted)
+{
+    bool status = true;
+
+    /* Sample Raster (all points at once) */
+    double* lons = new double [num_points];
+    double* lats = new double [num_points];
+    for(int i = 0; i < num_points; i++)
+    {
+        lons[i] = pts[i].lon;
+        lats[i] = pts[i].lat;
+    }
+    List<VrtRaster::sample_t>* slists = new List<VrtRaster::sample_t> [num_points];
+    raster->sampleBatch(lons, lats, num_points, slists, sorted);
+
+    /* Post Sample Records in Received Order */
+    for(int i = 0; i < num_points; i++)
+    {
+        if(!postSamples(pts[i].index, slists[i]))
+        {
+            status = false;
+        }
+    }
+
+    /* Clean Up */
+    delete [] slists;
+    delete [] lats;
+    delete [] lons;
+
+    /* Return Status */
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * postSamples
+ *----------------------------------------------------------------------------*/
+bool RasterSampler::postSamples (uint64_t index, List<VrtRaster::sample_t>& slist)
+{
+    int num_samples = slist.length();
+
+    if(raster->hasZonalStats())
+    {
+        /* Create and Post Sample Record */
+        int size_of_record = offsetof(zs_geo_t, samples) + (sizeof(VrtRaster::sample_t) * num_samples);
+        TypedRecord<zs_geo_t> stats_rec(size_of_record);
+        zs_geo_t* data = stats_rec.data();
+        data->index = index;
+        StringLib::copy(data->raster_key, rasterKey, RASTER_KEY_MAX_LEN);
+        data->num_samples = num_samples;
+        for(int i = 0; i < num_samples; i++)
+        {
+            data->samples[i] = slist[i];
+        }
+        return stats_rec.post(outQ);
+    }
+    else
+    {
+        /* Create and Post Sample Record */
+        int size_of_record = offsetof(rs_geo_t, samples) + (sizeof(sample_t) * num_samples);
+        TypedRecord<rs_geo_t> sample_rec(size_of_record);
+        rs_geo_t* data = sample_rec.data();
+        data->index = index;
+        StringLib::copy(data->raster_key, rasterKey, RASTER_KEY_MAX_LEN);
+        data->num_samples = num_samples;
+        for(int i = 0; i < num_samples; i++)
+        {
+            data->samples[i].value = slist[i].value;
+            data->samples[i].time = slist[i].time;
+            data->samples[i].file_id = slist[i].fileId;
+            data->samples[i].flags = slist[i].flags;
+        }
+        return sample_rec.post(outQ);
+    }
+}
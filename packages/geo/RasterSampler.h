@@ -75,6 +75,7 @@ class RasterSampler: public DispatchObject
         static const RecordObject::fieldDef_t fileIdRecDef[];
 
         static const int RASTER_KEY_MAX_LEN = 16; // maximum number of characters to represent raster
+        static const int DEFAULT_SORT_BATCH = 0; // number of points buffered and spatially sorted before sampling, zero disables
 
         /*--------------------------------------------------------------------
          * Types
@@ -120,6 +121,17 @@ class RasterSampler: public DispatchObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Buffered Point (sorted mode) */
+        typedef struct {
+            uint64_t            index;
+            double              lon;
+            double              lat;
+        } point_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -132,17 +144,33 @@ class RasterSampler: public DispatchObject
         RecordObject::field_t   lonField;
         RecordObject::field_t   latField;
         bool                    useZonalStats;
+        int                     sortBatchSize;
+        point_t*                points;
+        int                     numPoints;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                        RasterSampler           (lua_State* L, VrtRaster* _raster, const char* raster_key, const char* outq_name, const char* rec_type, const char* index_key, const char* lon_key, const char* lat_key);
+                        RasterSampler           (lua_State* L, VrtRaster* _raster, const char* raster_key, const char* outq_name, const char* rec_type, const char* index_key, const char* lon_key, const char* lat_key, int sort_batch);
                         ~RasterSampler          (void);
 
         bool            processRecord           (RecordObject* record, okey_t key) override;
         bool            processTimeout          (void) override;
         bool            processTermination      (void) override;
+
+        bool            samplePoints            (const point_t* pts, int num_points, bool sorted);
+        bool            postSamples             (uint64_t index, List<VrtRaster::sample_t>& slist);
 };
 
+/******************************************************************************
+ * RECORD TYPES
+ ******************************************************************************/
+
+RECTYPE(RasterSampler::sample_t,                RasterSampler::rsSampleRecType)
+RECTYPE(RasterSampler::rs_geo_t,                RasterSampler::rsGeoRecType)
+RECTYPE(GeoRaster::sample_t,                    RasterSampler::zsSampleRecType)
+RECTYPE(RasterSampler::zs_geo_t,                RasterSampler::zsGeoRecType)
+RECTYPE(RasterSampler::file_directory_entry_t,  RasterSampler::fileIdRecType)
+
 #endif  /* __raster_sampler__ */
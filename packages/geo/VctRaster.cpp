@@ -35,11 +35,19 @@
 
 #include "VctRaster.h"
 
+#include <algorithm>
+#include <numeric>
+#include <math.h>
+#include <stdlib.h>
+
 
 /******************************************************************************
  * STATIC DATA
  ******************************************************************************/
 
+Mutex VctRaster::indexMut;
+Dictionary<VctRaster::feature_index_t*> VctRaster::indexCache;
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -56,6 +64,18 @@ void VctRaster::init (void)
  *----------------------------------------------------------------------------*/
 void VctRaster::deinit (void)
 {
+    indexMut.lock();
+    {
+        feature_index_t* index = NULL;
+        const char* key = indexCache.first(&index);
+        while (key != NULL)
+        {
+            deleteFeatureIndex(index);
+            key = indexCache.next(&index);
+        }
+        indexCache.clear();
+    }
+    indexMut.unlock();
 }
 
 /******************************************************************************
@@ -70,6 +90,15 @@ VctRaster::VctRaster(lua_State *L, GeoParms* _parms, const int target_crs):
 {
     targetCrs = target_crs;
     layer = NULL;
+    featureIndex = NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * Destructor
+ *----------------------------------------------------------------------------*/
+VctRaster::~VctRaster(void)
+{
+    if (featureIndex) releaseFeatureIndex(featureIndex);
 }
 
 /*----------------------------------------------------------------------------
@@ -115,6 +144,11 @@ void VctRaster::openGeoIndex(double lon, double lat)
             GDALClose((GDALDatasetH)geoIndex.dset);
             geoIndex.dset = NULL;
         }
+        if (featureIndex != NULL)
+        {
+            releaseFeatureIndex(featureIndex);
+            featureIndex = NULL;
+        }
 
         /* Open new vector data set*/
         geoIndex.dset = (GDALDataset *)GDALOpenEx(newVctFile.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, NULL, NULL, NULL);
@@ -130,6 +164,9 @@ void VctRaster::openGeoIndex(double lon, double lat)
         if(!cord.source.IsSame(sref))
             throw RunTimeException(CRITICAL, RTE_ERROR, "Vector index file has wrong CRS: %s", newVctFile.c_str());
 
+        /* Features are read from the layer once per index file, then looked up in memory */
+        featureIndex = loadFeatureIndex(newVctFile);
+
         geoIndex.cols = geoIndex.dset->GetRasterXSize();
         geoIndex.rows = geoIndex.dset->GetRasterYSize();
 
@@ -150,6 +187,11 @@ void VctRaster::openGeoIndex(double lon, double lat)
             /* Do NOT clearTransform() - it is created once for all scenes */
             layer = NULL;
         }
+        if (featureIndex)
+        {
+            releaseFeatureIndex(featureIndex);
+            featureIndex = NULL;
+        }
         throw;
     }
 }
@@ -180,3 +222,280 @@ bool VctRaster::findCachedRasters(OGRPoint& p)
 }
 
 
+/*----------------------------------------------------------------------------
+ * findRasters
+ *----------------------------------------------------------------------------*/
+bool VctRaster::findRasters(OGRPoint& p)
+{
+    rastersList->clear();
+
+    if (featureIndex == NULL || featureIndex->nodes.empty())
+        return false;
+
+    const double x = p.getX();
+    const double y = p.getY();
+    const std::vector<feature_t>&    features = featureIndex->features;
+    const std::vector<int32_t>&      items    = featureIndex->items;
+    const std::vector<rtree_node_t>& nodes    = featureIndex->nodes;
+
+    /* Stab packed R-tree starting at root */
+    std::vector<int32_t> hits;
+    std::vector<int32_t> stack;
+    stack.push_back(static_cast<int32_t>(nodes.size()) - 1);
+    while (!stack.empty())
+    {
+        const rtree_node_t& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (!bboxContains(node.bbox, x, y))
+            continue;
+
+        for (int32_t i = node.first; i < node.first + node.count; i++)
+        {
+            if (!node.leaf)
+            {
+                stack.push_back(i);
+            }
+            else
+            {
+                /* Date and url filters are checked before the footprint, rasters they reject are never opened */
+                const feature_t& feature = features[items[i]];
+                if (bboxContains(feature.bbox, x, y) && !filterRaster(feature.rinfo) && feature.geo->Contains(&p))
+                    hits.push_back(items[i]);
+            }
+        }
+    }
+
+    /* Keep only the rasters closest in time */
+    if (parms->filter_closest_time && static_cast<int>(hits.size()) > parms->closest_count)
+    {
+        const int64_t closest = TimeLib::gmt2gpstime(parms->closest_time);
+        std::sort(hits.begin(), hits.end(), [&features, closest](int32_t a, int32_t b) {
+            int64_t da = llabs(features[a].gpsTime - closest);
+            int64_t db = llabs(features[b].gpsTime - closest);
+            return (da < db) || (da == db && a < b);
+        });
+        hits.resize(parms->closest_count);
+    }
+
+    /* Return rasters in the same order as the index file */
+    std::sort(hits.begin(), hits.end());
+    for (size_t i = 0; i < hits.size(); i++)
+        rastersList->add(features[hits[i]].rinfo);
+
+    mlog(DEBUG, "Found %d rasters for (%.2lf, %.2lf)", rastersList->length(), x, y);
+
+    return rastersList->length() > 0;
+}
+
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * loadFeatureIndex
+ *
+ *  returns the features of the index file from the cache, or reads them
+ *  from the opened layer and adds them to the cache
+ *----------------------------------------------------------------------------*/
+VctRaster::feature_index_t* VctRaster::loadFeatureIndex(const std::string& fileName)
+{
+    feature_index_t* index = NULL;
+
+    indexMut.lock();
+    {
+        if (indexCache.find(fileName.c_str(), &index))
+            index->refs++;
+    }
+    indexMut.unlock();
+
+    if (index) return index;
+
+    /* Read all features of the layer */
+    index = new feature_index_t;
+    index->fileName = fileName;
+    index->refs = 1;
+
+    layer->ResetReading();
+    while (OGRFeature* feature = layer->GetNextFeature())
+    {
+        try
+        {
+            OGRGeometry *geo = feature->GetGeometryRef();
+            CHECKPTR(geo);
+
+            feature_t entry;
+            if (getFeatureRaster(feature, entry.rinfo))
+            {
+                OGREnvelope env;
+                geo->getEnvelope(&env);
+                entry.bbox.lon_min = env.MinX;
+                entry.bbox.lat_min = env.MinY;
+                entry.bbox.lon_max = env.MaxX;
+                entry.bbox.lat_max = env.MaxY;
+                entry.geo = geo->clone();
+                entry.gpsTime = TimeLib::gmt2gpstime(entry.rinfo.gmtDate);
+                index->features.push_back(entry);
+            }
+        }
+        catch (const RunTimeException &e)
+        {
+            mlog(e.level(), "Error reading feature from %s: %s", fileName.c_str(), e.what());
+        }
+        OGRFeature::DestroyFeature(feature);
+    }
+
+    packFeatureIndex(index);
+    mlog(DEBUG, "Indexed %ld features of %s", (long)index->features.size(), fileName.c_str());
+
+    /* Add to cache, unless another object loaded it first */
+    indexMut.lock();
+    {
+        feature_index_t* cached = NULL;
+        if (indexCache.find(fileName.c_str(), &cached))
+        {
+            cached->refs++;
+            deleteFeatureIndex(index);
+            index = cached;
+        }
+        else
+        {
+            indexCache.add(fileName.c_str(), index);
+        }
+    }
+    indexMut.unlock();
+
+    return index;
+}
+
+/*----------------------------------------------------------------------------
+ * releaseFeatureIndex
+ *----------------------------------------------------------------------------*/
+void VctRaster::releaseFeatureIndex(feature_index_t* index)
+{
+    indexMut.lock();
+    {
+        index->refs--;
+
+        /* Keep unused indexes loaded while the cache is small */
+        if (index->refs == 0 && indexCache.length() > MAX_CACHED_INDEXES)
+        {
+            indexCache.remove(index->fileName.c_str());
+            deleteFeatureIndex(index);
+        }
+    }
+    indexMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * deleteFeatureIndex
+ *----------------------------------------------------------------------------*/
+void VctRaster::deleteFeatureIndex(feature_index_t* index)
+{
+    for (size_t i = 0; i < index->features.size(); i++)
+        OGRGeometryFactory::destroyGeometry(index->features[i].geo);
+    delete index;
+}
+
+/*----------------------------------------------------------------------------
+ * packFeatureIndex
+ *
+ *  builds the R-tree bottom up, sort-tile-recursive packing each level
+ *----------------------------------------------------------------------------*/
+void VctRaster::packFeatureIndex(feature_index_t* index)
+{
+    const int32_t num_features = static_cast<int32_t>(index->features.size());
+    if (num_features == 0) return;
+
+    /* Leaf Level */
+    std::vector<bbox_t> boxes;
+    for (int32_t i = 0; i < num_features; i++)
+        boxes.push_back(index->features[i].bbox);
+    index->items = packOrder(boxes);
+
+    std::vector<rtree_node_t> level;
+    for (int32_t i = 0; i < num_features; i += RTREE_NODE_SIZE)
+    {
+        rtree_node_t node;
+        node.first = i;
+        node.count = std::min(RTREE_NODE_SIZE, num_features - i);
+        node.leaf = true;
+        node.bbox = index->features[index->items[i]].bbox;
+        for (int32_t j = i + 1; j < i + node.count; j++)
+        {
+            const bbox_t& bbox = index->features[index->items[j]].bbox;
+            node.bbox.lon_min = std::min(node.bbox.lon_min, bbox.lon_min);
+            node.bbox.lat_min = std::min(node.bbox.lat_min, bbox.lat_min);
+            node.bbox.lon_max = std::max(node.bbox.lon_max, bbox.lon_max);
+            node.bbox.lat_max = std::max(node.bbox.lat_max, bbox.lat_max);
+        }
+        level.push_back(node);
+    }
+
+    /* Upper Levels (children of a node are contiguous in nodes) */
+    while (level.size() > 1)
+    {
+        boxes.clear();
+        for (size_t i = 0; i < level.size(); i++)
+            boxes.push_back(level[i].bbox);
+        std::vector<int32_t> order = packOrder(boxes);
+
+        const int32_t base = static_cast<int32_t>(index->nodes.size());
+        const int32_t num_nodes = static_cast<int32_t>(level.size());
+        for (int32_t i = 0; i < num_nodes; i++)
+            index->nodes.push_back(level[order[i]]);
+
+        level.clear();
+        for (int32_t i = 0; i < num_nodes; i += RTREE_NODE_SIZE)
+        {
+            rtree_node_t node;
+            node.first = base + i;
+            node.count = std::min(RTREE_NODE_SIZE, num_nodes - i);
+            node.leaf = false;
+            node.bbox = index->nodes[base + i].bbox;
+            for (int32_t j = base + i + 1; j < base + i + node.count; j++)
+            {
+                const bbox_t& bbox = index->nodes[j].bbox;
+                node.bbox.lon_min = std::min(node.bbox.lon_min, bbox.lon_min);
+                node.bbox.lat_min = std::min(node.bbox.lat_min, bbox.lat_min);
+                node.bbox.lon_max = std::max(node.bbox.lon_max, bbox.lon_max);
+                node.bbox.lat_max = std::max(node.bbox.lat_max, bbox.lat_max);
+            }
+            level.push_back(node);
+        }
+    }
+
+    /* Root */
+    index->nodes.push_back(level[0]);
+}
+
+/*----------------------------------------------------------------------------
+ * packOrder
+ *
+ *  orders boxes so that each run of RTREE_NODE_SIZE boxes is spatially
+ *  compact: sorted into vertical slices by center x, then by center y
+ *----------------------------------------------------------------------------*/
+std::vector<int32_t> VctRaster::packOrder(const std::vector<bbox_t>& boxes)
+{
+    const int32_t num_boxes = static_cast<int32_t>(boxes.size());
+    std::vector<int32_t> order(num_boxes);
+    std::iota(order.begin(), order.end(), 0);
+
+    const int32_t num_nodes = (num_boxes + RTREE_NODE_SIZE - 1) / RTREE_NODE_SIZE;
+    const int32_t num_slices = static_cast<int32_t>(ceil(sqrt(static_cast<double>(num_nodes))));
+    const int32_t slice_size = num_slices * RTREE_NODE_SIZE;
+
+    std::sort(order.begin(), order.end(), [&boxes](int32_t a, int32_t b) {
+        return (boxes[a].lon_min + boxes[a].lon_max) < (boxes[b].lon_min + boxes[b].lon_max);
+    });
+
+    for (int32_t i = 0; i < num_boxes; i += slice_size)
+    {
+        std::sort(order.begin() + i, order.begin() + std::min(i + slice_size, num_boxes), [&boxes](int32_t a, int32_t b) {
+            return (boxes[a].lat_min + boxes[a].lat_max) < (boxes[b].lat_min + boxes[b].lat_max);
+        });
+    }
+
+    return order;
+}
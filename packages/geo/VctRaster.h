@@ -51,6 +51,9 @@ class VctRaster: public GeoRaster
          * Constants
          *--------------------------------------------------------------------*/
 
+        static const int RTREE_NODE_SIZE = 16;          // children (or features) per node of the packed R-tree
+        static const int MAX_CACHED_INDEXES = 32;       // index files kept loaded when no longer used
+
         /*--------------------------------------------------------------------
          * Typedefs
          *--------------------------------------------------------------------*/
@@ -70,10 +73,13 @@ class VctRaster: public GeoRaster
 
 
                      VctRaster         (lua_State* L, GeoParms* _parms, const int target_crs);
+        virtual     ~VctRaster         (void);
         void         openGeoIndex      (double lon=0, double lat=0);
         void         transformCRS      (OGRPoint& p);
         virtual void getIndexFile      (std::string& file, double lon, double lat) = 0;
         virtual void getIndexBbox      (bbox_t& bbox, double lon, double lat) = 0;
+        virtual bool getFeatureRaster  (OGRFeature* feature, raster_info_t& rinfo) = 0;
+        bool         findRasters       (OGRPoint &p);
         bool         findCachedRasters (OGRPoint &p);
 
 
@@ -84,15 +90,58 @@ class VctRaster: public GeoRaster
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        /* Index File Feature */
+        typedef struct {
+            bbox_t          bbox;
+            OGRGeometry*    geo;
+            raster_info_t   rinfo;
+            int64_t         gpsTime;    // of rinfo.gmtDate
+        } feature_t;
+
+        /* Node of Packed R-Tree */
+        typedef struct {
+            bbox_t          bbox;       // of entire subtree rooted at this node
+            int32_t         first;      // first child in nodes, or first entry in items if leaf
+            int32_t         count;      // number of children or items
+            bool            leaf;
+        } rtree_node_t;
+
+        /* Features of an Index File, Shared by All Objects Using It */
+        typedef struct {
+            std::string                 fileName;
+            std::vector<feature_t>      features;   // in layer order
+            std::vector<int32_t>        items;      // feature indices grouped by leaf
+            std::vector<rtree_node_t>   nodes;      // root is last
+            int                         refs;
+        } feature_index_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
-        int targetCrs;
+
+        static Mutex                            indexMut;
+        static Dictionary<feature_index_t*>     indexCache;
+
+        int                 targetCrs;
+        feature_index_t*    featureIndex;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
+        feature_index_t*        loadFeatureIndex    (const std::string& fileName);
+        static void             releaseFeatureIndex (feature_index_t* index);
+        static void             deleteFeatureIndex  (feature_index_t* index);
+        static void             packFeatureIndex    (feature_index_t* index);
+        static std::vector<int32_t> packOrder       (const std::vector<bbox_t>& boxes);
+        static inline bool      bboxContains        (const bbox_t& bbox, double x, double y)
+        {
+            return (x >= bbox.lon_min) && (x <= bbox.lon_max) && (y >= bbox.lat_min) && (y <= bbox.lat_max);
+        }
 };
 
 #endif  /* __vct_raster__ */
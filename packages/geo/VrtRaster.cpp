@@ -42,6 +42,9 @@
  * STATIC DATA
  ******************************************************************************/
 
+Mutex VrtRaster::mosaicMut;
+Dictionary<VrtRaster::mosaic_index_t*> VrtRaster::mosaicIndexes;
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -58,6 +61,18 @@ void VrtRaster::init (void)
  *----------------------------------------------------------------------------*/
 void VrtRaster::deinit (void)
 {
+    mosaicMut.lock();
+    {
+        mosaic_index_t* index = NULL;
+        const char* key = mosaicIndexes.first(&index);
+        while (key != NULL)
+        {
+            delete index;
+            key = mosaicIndexes.next(&index);
+        }
+        mosaicIndexes.clear();
+    }
+    mosaicMut.unlock();
 }
 
 /******************************************************************************
@@ -72,6 +87,7 @@ VrtRaster::VrtRaster(lua_State *L, GeoParms* _parms):
 {
     band = NULL;
     bzero(invGeot, sizeof(invGeot));
+    mosaicIndex = NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -159,6 +175,21 @@ void VrtRaster::openGeoIndex(double lon, double lat)
                 throw RunTimeException(CRITICAL, RTE_ERROR, "Failed to create coordinates transform");
         }
 
+        /* Rasters found in this VRT are remembered for the life of the process (in memory VRTs are private) */
+        mosaicIndex = NULL;
+        if (newVrtFile.compare(0, 8, "/vsimem/") != 0)
+        {
+            mosaicMut.lock();
+            {
+                if (!mosaicIndexes.find(newVrtFile.c_str(), &mosaicIndex))
+                {
+                    mosaicIndex = new mosaic_index_t;
+                    mosaicIndexes.add(newVrtFile.c_str(), mosaicIndex);
+                }
+            }
+            mosaicMut.unlock();
+        }
+
         mlog(DEBUG, "Opened: %s", newVrtFile.c_str());
     }
     catch (const RunTimeException &e)
@@ -170,6 +201,7 @@ void VrtRaster::openGeoIndex(double lon, double lat)
             bzero(invGeot, sizeof(invGeot));
             band = NULL;
         }
+        mosaicIndex = NULL;
         throw;
     }
 }
@@ -196,6 +228,10 @@ bool VrtRaster::findRasters(OGRPoint& p)
 {
     bool foundFile = false;
 
+    /* Raster already found for this VRT, no need to query it */
+    if (mosaicIndex && findMosaicTile(p))
+        return true;
+
     const int32_t col = static_cast<int32_t>(floor(invGeot[0] + invGeot[1] * p.getX() + invGeot[2] * p.getY()));
     const int32_t row = static_cast<int32_t>(floor(invGeot[3] + invGeot[4] * p.getX() + invGeot[5] * p.getY()));
 
@@ -228,6 +264,7 @@ bool VrtRaster::findRasters(OGRPoint& p)
                     getRasterDate(rinfo);
 
                     rastersList->add(rinfo);
+                    if (mosaicIndex) addMosaicTile(rinfo);
                     CPLFree(fname);
                     foundFile = true;
                     /*
@@ -321,3 +358,75 @@ void VrtRaster::buildVRT(std::string& vrtFile, List<std::string>& rlist)
  * PRIVATE METHODS
  ******************************************************************************/
 
+/*----------------------------------------------------------------------------
+ * findMosaicTile
+ *----------------------------------------------------------------------------*/
+bool VrtRaster::findMosaicTile(OGRPoint& p)
+{
+    rastersList->clear();
+
+    mosaicMut.lock();
+    {
+        for (size_t i = 0; i < mosaicIndex->tiles.size(); i++)
+        {
+            const bbox_t& bbox = mosaicIndex->tiles[i].bbox;
+            if ((p.getX() >= bbox.lon_min) && (p.getX() <= bbox.lon_max) &&
+                (p.getY() >= bbox.lat_min) && (p.getY() <= bbox.lat_max))
+            {
+                /* Only one raster with this point in VRT */
+                rastersList->add(mosaicIndex->tiles[i].rinfo);
+                break;
+            }
+        }
+    }
+    mosaicMut.unlock();
+
+    return rastersList->length() > 0;
+}
+
+/*----------------------------------------------------------------------------
+ * addMosaicTile
+ *
+ *  the raster is opened here to get its extent, the dataset is handed to the
+ *  dataset pool so the reader sampling it does not open it again
+ *----------------------------------------------------------------------------*/
+void VrtRaster::addMosaicTile(const raster_info_t& rinfo)
+{
+    GDALDataset* dset = acquireDataset(rinfo.fileName);
+    if (dset == NULL)
+    {
+        mlog(ERROR, "Failed to open mosaic raster: %s", rinfo.fileName.c_str());
+        return;
+    }
+
+    mosaic_tile_t tile;
+    tile.rinfo = rinfo;
+
+    double geot[6] = {0};
+    CPLErr err = dset->GetGeoTransform(geot);
+    if (err == CE_None)
+    {
+        tile.bbox.lon_min = geot[0];
+        tile.bbox.lon_max = geot[0] + dset->GetRasterXSize() * geot[1];
+        tile.bbox.lat_max = geot[3];
+        tile.bbox.lat_min = geot[3] + dset->GetRasterYSize() * geot[5];
+    }
+
+    releaseDataset(rinfo.fileName, dset);
+
+    if (err != CE_None)
+        return;
+
+    mosaicMut.lock();
+    {
+        /* Another object may have added it meanwhile */
+        bool found = false;
+        for (size_t i = 0; i < mosaicIndex->tiles.size() && !found; i++)
+            found = (mosaicIndex->tiles[i].rinfo.fileName == rinfo.fileName);
+
+        if (!found)
+            mosaicIndex->tiles.push_back(tile);
+    }
+    mosaicMut.unlock();
+}
+
@@ -88,16 +88,38 @@ class VrtRaster: public GeoRaster
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        /* Raster of a Mosaic, Found Through the VRT */
+        typedef struct {
+            raster_info_t   rinfo;
+            bbox_t          bbox;
+        } mosaic_tile_t;
+
+        /* Rasters Found So Far in a VRT, Shared by All Objects Using It */
+        typedef struct {
+            std::vector<mosaic_tile_t> tiles;
+        } mosaic_index_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
+
+        static Mutex                        mosaicMut;
+        static Dictionary<mosaic_index_t*>  mosaicIndexes;
+
         GDALRasterBand *band;
         double          invGeot[6];
+        mosaic_index_t* mosaicIndex;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
+        bool         findMosaicTile     (OGRPoint& p);
+        void         addMosaicTile      (const raster_info_t& rinfo);
 };
 
 #endif  /* __vrt_raster__ */
@@ -129,7 +129,9 @@ int geo_open (lua_State* L)
         {"geojson",     GeoJsonRaster::luaCreate},
         {"raster",      GeoRaster::luaCreate},
         {"sampler",     RasterSampler::luaCreate},
+        {"grid",        GridDispatch::luaCreate},
         {"parms",       GeoParms::luaCreate},
+        {"blockcache",  GeoRaster::luaBlockCache},
         {NULL,          NULL}
     };
 
@@ -176,7 +178,9 @@ void initgeo (void)
     GeoRaster::init();
     VrtRaster::init();
     VctRaster::init();
+    GeoJsonRaster::init();
     RasterSampler::init();
+    GridDispatch::init();
 
     /* Register GDAL custom error handler */
     void (*fptrGdalErrorHandler)(CPLErr, int, const char *) = GdalErrHandler;
@@ -194,6 +198,7 @@ void initgeo (void)
 
 void deinitgeo (void)
 {
+    GeoJsonRaster::deinit();
     VctRaster::deinit();
     VrtRaster::deinit();
     GeoRaster::deinit();
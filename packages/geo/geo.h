@@ -41,6 +41,7 @@
 #include "VctRaster.h"
 #include "GeoJsonRaster.h"
 #include "RasterSampler.h"
+#include "GridDispatch.h"
 #include "GeoParms.h"
 
 /******************************************************************************
@@ -54,10 +54,10 @@ class H5Array
          * Methods
          *--------------------------------------------------------------------*/
 
-                H5Array     (const Asset* asset, const char* resource, const char* dataset, H5Coro::context_t* context=NULL, long col=0, long startrow=0, long numrows=H5Coro::ALL_ROWS);
+                H5Array     (const Asset* asset, const char* resource, const char* dataset, H5Coro::context_t* context=NULL, long col=0, long startrow=0, long numrows=H5Coro::ALL_ROWS, const H5Coro::row_range_t* ranges=NULL, int num_ranges=0);
         virtual ~H5Array    (void);
 
-        bool    trim        (long offset);
+        bool    trim        (long offset, long count=H5Coro::ALL_ROWS);
         T&      operator[]  (long index);
         bool    join        (int timeout, bool throw_exception);
 
@@ -90,12 +90,17 @@ class H5Array
  *  Note 2: the asset parameter is used to indicate that this should be a null
  *  array; it is the repsonsibility of the calling function to make sure no
  *  further calls to this class are performed on a null array other than a join
+ *
+ *  Note 3: when row ranges are supplied only those rows are read; the array
+ *  still spans [startrow, startrow + numrows) with the rows outside of the
+ *  ranges zero filled (see H5Coro::readRows)
  *----------------------------------------------------------------------------*/
 template <class T>
-H5Array<T>::H5Array(const Asset* asset, const char* resource, const char* dataset, H5Coro::context_t* context, long col, long startrow, long numrows)
+H5Array<T>::H5Array(const Asset* asset, const char* resource, const char* dataset, H5Coro::context_t* context, long col, long startrow, long numrows, const H5Coro::row_range_t* ranges, int num_ranges)
 {
-    if(asset)   h5f = H5Coro::readp(asset, resource, dataset, RecordObject::DYNAMIC, col, startrow, numrows, context);
-    else        h5f = NULL;
+    if(asset && ranges) h5f = H5Coro::readpRows(asset, resource, dataset, RecordObject::DYNAMIC, col, startrow, numrows, ranges, num_ranges, context);
+    else if(asset)      h5f = H5Coro::readp(asset, resource, dataset, RecordObject::DYNAMIC, col, startrow, numrows, context);
+    else                h5f = NULL;
 
     name    = StringLib::duplicate(dataset);
     size    = 0;
@@ -115,14 +120,18 @@ H5Array<T>::~H5Array(void)
 
 /*----------------------------------------------------------------------------
  * trim
+ *
+ *  moves the start of the array to offset and, when a count is supplied,
+ *  limits the array to that many elements
  *----------------------------------------------------------------------------*/
 template <class T>
-bool H5Array<T>::trim(long offset)
+bool H5Array<T>::trim(long offset, long count)
 {
     if((offset >= 0) && (offset < size))
     {
         pointer = data + offset;
         size = size - offset;
+        if((count >= 0) && (count < size)) size = count;
         return true;
     }
     else
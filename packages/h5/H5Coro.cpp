@@ -38,8 +38,20 @@
 
 #include <assert.h>
 #include <stdexcept>
+#include <algorithm>
+#include <type_traits>
 #include <zlib.h>
 
+#ifdef H5CORO_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 /******************************************************************************
  * DEFINES
  ******************************************************************************/
@@ -58,6 +70,394 @@
 
 #define H5_INVALID(var)  (var == (0xFFFFFFFFFFFFFFFFllu >> (64 - (sizeof(var) * 8))))
 
+/******************************************************************************
+ * SHUFFLE KERNELS
+ *
+ *  Each kernel unshuffles as many whole vectors of elements as it can,
+ *  starting at start_element, and returns the number of elements processed;
+ *  the remaining tail is handled by the scalar loop in shuffleChunk
+ ******************************************************************************/
+
+#if defined(__SSE2__)
+
+/*----------------------------------------------------------------------------
+ * unshuffle2SSE2
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle2SSE2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m128i p0 = _mm_loadu_si128((const __m128i*)&src[0]);
+        __m128i p1 = _mm_loadu_si128((const __m128i*)&src[block_size]);
+        __m128i* dst = (__m128i*)&output[i * 2];
+        _mm_storeu_si128(&dst[0], _mm_unpacklo_epi8(p0, p1));
+        _mm_storeu_si128(&dst[1], _mm_unpackhi_epi8(p0, p1));
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * unshuffle4SSE2
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle4SSE2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m128i p0 = _mm_loadu_si128((const __m128i*)&src[0]);
+        __m128i p1 = _mm_loadu_si128((const __m128i*)&src[block_size]);
+        __m128i p2 = _mm_loadu_si128((const __m128i*)&src[block_size * 2]);
+        __m128i p3 = _mm_loadu_si128((const __m128i*)&src[block_size * 3]);
+        __m128i a0 = _mm_unpacklo_epi8(p0, p1);
+        __m128i a1 = _mm_unpackhi_epi8(p0, p1);
+        __m128i b0 = _mm_unpacklo_epi8(p2, p3);
+        __m128i b1 = _mm_unpackhi_epi8(p2, p3);
+        __m128i* dst = (__m128i*)&output[i * 4];
+        _mm_storeu_si128(&dst[0], _mm_unpacklo_epi16(a0, b0));
+        _mm_storeu_si128(&dst[1], _mm_unpackhi_epi16(a0, b0));
+        _mm_storeu_si128(&dst[2], _mm_unpacklo_epi16(a1, b1));
+        _mm_storeu_si128(&dst[3], _mm_unpackhi_epi16(a1, b1));
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * unshuffle8SSE2
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle8SSE2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m128i p[8];
+        for(int v = 0; v < 8; v++) p[v] = _mm_loadu_si128((const __m128i*)&src[block_size * v]);
+
+        /* Interleave Bytes */
+        __m128i a[8];
+        for(int v = 0; v < 4; v++)
+        {
+            a[v * 2]     = _mm_unpacklo_epi8(p[v * 2], p[(v * 2) + 1]);
+            a[v * 2 + 1] = _mm_unpackhi_epi8(p[v * 2], p[(v * 2) + 1]);
+        }
+
+        /* Interleave Byte Pairs (bytes 0-3 in b[0..3], bytes 4-7 in b[4..7]) */
+        __m128i b[8];
+        for(int h = 0; h < 2; h++)
+        {
+            __m128i* x = &a[h * 4];
+            b[h * 4]     = _mm_unpacklo_epi16(x[0], x[2]);
+            b[h * 4 + 1] = _mm_unpackhi_epi16(x[0], x[2]);
+            b[h * 4 + 2] = _mm_unpacklo_epi16(x[1], x[3]);
+            b[h * 4 + 3] = _mm_unpackhi_epi16(x[1], x[3]);
+        }
+
+        /* Interleave Halves */
+        __m128i* dst = (__m128i*)&output[i * 8];
+        for(int v = 0; v < 4; v++)
+        {
+            _mm_storeu_si128(&dst[v * 2],     _mm_unpacklo_epi32(b[v], b[v + 4]));
+            _mm_storeu_si128(&dst[v * 2 + 1], _mm_unpackhi_epi32(b[v], b[v + 4]));
+        }
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * unshuffleAVX2 - identical to the SSE2 kernels but on both 128-bit lanes,
+ *                 the lower lane produces elements 0-15 and the upper lane
+ *                 elements 16-31, so results are regrouped before storing
+ *----------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static inline void storeLanesAVX2 (__m256i* dst, const __m256i* r, int n)
+{
+    for(int k = 0; k < n; k += 2)
+    {
+        _mm256_storeu_si256(&dst[k / 2],        _mm256_permute2x128_si256(r[k], r[k + 1], 0x20));
+        _mm256_storeu_si256(&dst[(n + k) / 2],  _mm256_permute2x128_si256(r[k], r[k + 1], 0x31));
+    }
+}
+
+__attribute__((target("avx2")))
+static int64_t unshuffle2AVX2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 32 <= num_elements; i += 32)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m256i p0 = _mm256_loadu_si256((const __m256i*)&src[0]);
+        __m256i p1 = _mm256_loadu_si256((const __m256i*)&src[block_size]);
+        __m256i r[2] = { _mm256_unpacklo_epi8(p0, p1), _mm256_unpackhi_epi8(p0, p1) };
+        storeLanesAVX2((__m256i*)&output[i * 2], r, 2);
+    }
+    return i + unshuffle2SSE2(input, block_size, &output[i * 2], start_element + i, num_elements - i);
+}
+
+__attribute__((target("avx2")))
+static int64_t unshuffle4AVX2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 32 <= num_elements; i += 32)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m256i p0 = _mm256_loadu_si256((const __m256i*)&src[0]);
+        __m256i p1 = _mm256_loadu_si256((const __m256i*)&src[block_size]);
+        __m256i p2 = _mm256_loadu_si256((const __m256i*)&src[block_size * 2]);
+        __m256i p3 = _mm256_loadu_si256((const __m256i*)&src[block_size * 3]);
+        __m256i a0 = _mm256_unpacklo_epi8(p0, p1);
+        __m256i a1 = _mm256_unpackhi_epi8(p0, p1);
+        __m256i b0 = _mm256_unpacklo_epi8(p2, p3);
+        __m256i b1 = _mm256_unpackhi_epi8(p2, p3);
+        __m256i r[4] = { _mm256_unpacklo_epi16(a0, b0), _mm256_unpackhi_epi16(a0, b0),
+                         _mm256_unpacklo_epi16(a1, b1), _mm256_unpackhi_epi16(a1, b1) };
+        storeLanesAVX2((__m256i*)&output[i * 4], r, 4);
+    }
+    return i + unshuffle4SSE2(input, block_size, &output[i * 4], start_element + i, num_elements - i);
+}
+
+__attribute__((target("avx2")))
+static int64_t unshuffle8AVX2 (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 32 <= num_elements; i += 32)
+    {
+        const uint8_t* src = &input[start_element + i];
+        __m256i p[8];
+        for(int v = 0; v < 8; v++) p[v] = _mm256_loadu_si256((const __m256i*)&src[block_size * v]);
+
+        __m256i a[8];
+        for(int v = 0; v < 4; v++)
+        {
+            a[v * 2]     = _mm256_unpacklo_epi8(p[v * 2], p[(v * 2) + 1]);
+            a[v * 2 + 1] = _mm256_unpackhi_epi8(p[v * 2], p[(v * 2) + 1]);
+        }
+
+        __m256i b[8];
+        for(int h = 0; h < 2; h++)
+        {
+            __m256i* x = &a[h * 4];
+            b[h * 4]     = _mm256_unpacklo_epi16(x[0], x[2]);
+            b[h * 4 + 1] = _mm256_unpackhi_epi16(x[0], x[2]);
+            b[h * 4 + 2] = _mm256_unpacklo_epi16(x[1], x[3]);
+            b[h * 4 + 3] = _mm256_unpackhi_epi16(x[1], x[3]);
+        }
+
+        __m256i r[8];
+        for(int v = 0; v < 4; v++)
+        {
+            r[v * 2]     = _mm256_unpacklo_epi32(b[v], b[v + 4]);
+            r[v * 2 + 1] = _mm256_unpackhi_epi32(b[v], b[v + 4]);
+        }
+        storeLanesAVX2((__m256i*)&output[i * 8], r, 8);
+    }
+    return i + unshuffle8SSE2(input, block_size, &output[i * 8], start_element + i, num_elements - i);
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+/*----------------------------------------------------------------------------
+ * unshuffle2NEON
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle2NEON (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        uint8x16x2_t v;
+        v.val[0] = vld1q_u8(&src[0]);
+        v.val[1] = vld1q_u8(&src[block_size]);
+        vst2q_u8(&output[i * 2], v);
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * unshuffle4NEON
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle4NEON (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        uint8x16x4_t v;
+        v.val[0] = vld1q_u8(&src[0]);
+        v.val[1] = vld1q_u8(&src[block_size]);
+        v.val[2] = vld1q_u8(&src[block_size * 2]);
+        v.val[3] = vld1q_u8(&src[block_size * 3]);
+        vst4q_u8(&output[i * 4], v);
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * unshuffle8NEON - interleaves byte pairs and then stores them as four
+ *                  interleaved streams of 16-bit values
+ *----------------------------------------------------------------------------*/
+static int64_t unshuffle8NEON (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 16 <= num_elements; i += 16)
+    {
+        const uint8_t* src = &input[start_element + i];
+        uint8x16x2_t z[4];
+        for(int v = 0; v < 4; v++)
+        {
+            z[v] = vzipq_u8(vld1q_u8(&src[block_size * (v * 2)]), vld1q_u8(&src[block_size * ((v * 2) + 1)]));
+        }
+        for(int h = 0; h < 2; h++)
+        {
+            uint16x8x4_t w;
+            for(int v = 0; v < 4; v++) w.val[v] = vreinterpretq_u16_u8(z[v].val[h]);
+            vst4q_u16((uint16_t*)&output[(i + (h * 8)) * 8], w);
+        }
+    }
+    return i;
+}
+
+#endif
+
+/******************************************************************************
+ * CONVERSION KERNELS
+ *
+ *  Each (source, destination) pair of element types gets its own typed loop,
+ *  selected once per call instead of once per element; the typed loops are
+ *  simple enough for the compiler to vectorize, and the conversions it does
+ *  not vectorize well are given explicit vector kernels which, like the
+ *  shuffle kernels, return the number of elements processed
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * convertVector - no vector kernel for the pair, scalar loop does all
+ *----------------------------------------------------------------------------*/
+template<typename S, typename D>
+static inline int64_t convertVector (const S* src, D* dst, int64_t num_elements)
+{
+    (void)src;
+    (void)dst;
+    (void)num_elements;
+    return 0;
+}
+
+#if defined(__SSE2__)
+
+/*----------------------------------------------------------------------------
+ * convertVector - float to double
+ *----------------------------------------------------------------------------*/
+template<>
+inline int64_t convertVector<float, double> (const float* src, double* dst, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 4 <= num_elements; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(&src[i]);
+        _mm_storeu_pd(&dst[i], _mm_cvtps_pd(v));
+        _mm_storeu_pd(&dst[i + 2], _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * convertVector - int32 to double
+ *----------------------------------------------------------------------------*/
+template<>
+inline int64_t convertVector<int32_t, double> (const int32_t* src, double* dst, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 4 <= num_elements; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+        _mm_storeu_pd(&dst[i], _mm_cvtepi32_pd(v));
+        _mm_storeu_pd(&dst[i + 2], _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ * convertVector - double to int32 (truncating)
+ *----------------------------------------------------------------------------*/
+template<>
+inline int64_t convertVector<double, int32_t> (const double* src, int32_t* dst, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 4 <= num_elements; i += 4)
+    {
+        __m128i lo = _mm_cvttpd_epi32(_mm_loadu_pd(&src[i]));
+        __m128i hi = _mm_cvttpd_epi32(_mm_loadu_pd(&src[i + 2]));
+        _mm_storeu_si128((__m128i*)&dst[i], _mm_unpacklo_epi64(lo, hi));
+    }
+    return i;
+}
+
+#elif defined(__aarch64__)
+
+/*----------------------------------------------------------------------------
+ * convertVector - float to double
+ *----------------------------------------------------------------------------*/
+template<>
+inline int64_t convertVector<float, double> (const float* src, double* dst, int64_t num_elements)
+{
+    int64_t i = 0;
+    for(; i + 4 <= num_elements; i += 4)
+    {
+        float32x4_t v = vld1q_f32(&src[i]);
+        vst1q_f64(&dst[i], vcvt_f64_f32(vget_low_f32(v)));
+        vst1q_f64(&dst[i + 2], vcvt_high_f64_f32(v));
+    }
+    return i;
+}
+
+#endif
+
+/*----------------------------------------------------------------------------
+ * convertElements
+ *----------------------------------------------------------------------------*/
+template<typename S, typename D>
+static void convertElements (const uint8_t* src, uint8_t* dst, int64_t num_elements)
+{
+    if(std::is_same<S, D>::value)
+    {
+        LocalLib::copy(dst, src, num_elements * sizeof(S));
+    }
+    else
+    {
+        const S* __restrict s = (const S*)src;
+        D* __restrict d = (D*)dst;
+        int64_t i = convertVector<S, D>(s, d, num_elements);
+        for(; i < num_elements; i++)
+        {
+            d[i] = static_cast<D>(s[i]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * convertFrom - selects the kernel for the source type; returns false if
+ *               the source type cannot be converted
+ *----------------------------------------------------------------------------*/
+template<typename D>
+static bool convertFrom (RecordObject::fieldType_t src_type, const uint8_t* src, uint8_t* dst, int64_t num_elements)
+{
+    switch(src_type)
+    {
+        case RecordObject::INT8:    convertElements<int8_t, D>(src, dst, num_elements);   return true;
+        case RecordObject::INT16:   convertElements<int16_t, D>(src, dst, num_elements);  return true;
+        case RecordObject::INT32:   convertElements<int32_t, D>(src, dst, num_elements);  return true;
+        case RecordObject::INT64:   convertElements<int64_t, D>(src, dst, num_elements);  return true;
+        case RecordObject::UINT8:   convertElements<uint8_t, D>(src, dst, num_elements);  return true;
+        case RecordObject::UINT16:  convertElements<uint16_t, D>(src, dst, num_elements); return true;
+        case RecordObject::UINT32:  convertElements<uint32_t, D>(src, dst, num_elements); return true;
+        case RecordObject::UINT64:  convertElements<uint64_t, D>(src, dst, num_elements); return true;
+        case RecordObject::FLOAT:   convertElements<float, D>(src, dst, num_elements);    return true;
+        case RecordObject::DOUBLE:  convertElements<double, D>(src, dst, num_elements);   return true;
+        default:                    return false;
+    }
+}
+
 /******************************************************************************
  * H5 FUTURE CLASS
  ******************************************************************************/
@@ -133,14 +533,61 @@ H5Future::rc_t H5Future::wait (int timeout)
  * Static Data
  *----------------------------------------------------------------------------*/
 H5FileBuffer::meta_repo_t H5FileBuffer::metaRepo(MAX_META_STORE);
+H5FileBuffer::index_repo_t H5FileBuffer::indexRepo(MAX_INDEX_STORE);
+H5FileBuffer::group_repo_t H5FileBuffer::groupRepo(MAX_GROUP_STORE);
 Mutex H5FileBuffer::metaMutex;
 
+const char* H5FileBuffer::GLOBAL_CACHE_METRICS = "h5coro";
+
+H5FileBuffer::cache_t H5FileBuffer::globalL1(GLOBAL_CACHE_L1_ENTRIES, ioHashL1);
+H5FileBuffer::cache_t H5FileBuffer::globalL2(GLOBAL_CACHE_L2_ENTRIES, ioHashL2);
+Table<bool,uint64_t> H5FileBuffer::globalPending(GLOBAL_CACHE_PENDING);
+Dictionary<uint64_t> H5FileBuffer::globalResources;
+Cond H5FileBuffer::globalCond;
+uint64_t H5FileBuffer::globalNextId = GLOBAL_CACHE_INVALID_ID + 1;
+uint32_t H5FileBuffer::globalGeneration = 0;
+int64_t H5FileBuffer::globalBudget = 0;
+int64_t H5FileBuffer::globalBytes = 0;
+int64_t H5FileBuffer::globalL1Bytes = 0;
+int32_t H5FileBuffer::globalHitMetric = EventLib::INVALID_METRIC;
+int32_t H5FileBuffer::globalMissMetric = EventLib::INVALID_METRIC;
+int32_t H5FileBuffer::globalBytesMetric = EventLib::INVALID_METRIC;
+
+Publisher* H5FileBuffer::inflatePub = NULL;
+Subscriber* H5FileBuffer::inflateSub = NULL;
+Thread** H5FileBuffer::inflatePids = NULL;
+int H5FileBuffer::inflatePoolSize = 0;
+bool H5FileBuffer::inflateActive = false;
+
+H5FileBuffer::shuffle_kernel_t H5FileBuffer::shuffleKernels[MAX_SHUFFLE_TYPESIZE + 1] = { NULL };
+
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
 H5FileBuffer::io_context_t::io_context_t (void):
     l1(IO_CACHE_L1_ENTRIES, ioHashL1),
-    l2(IO_CACHE_L2_ENTRIES, ioHashL2)
+    l2(IO_CACHE_L2_ENTRIES, ioHashL2),
+    mut("h5.cache")
+{
+    pre_prefetch_request = 0;
+    post_prefetch_request = 0;
+    cache_miss = 0;
+    l1_cache_replace = 0;
+    l2_cache_replace = 0;
+    bytes_read = 0;
+    readahead_pending = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *
+ *  sizes the L1 and L2 caches in cache lines; values less than or equal
+ *  to zero select the default number of entries
+ *----------------------------------------------------------------------------*/
+H5FileBuffer::io_context_t::io_context_t (long l1_entries, long l2_entries):
+    l1(l1_entries > 0 ? l1_entries : IO_CACHE_L1_ENTRIES, ioHashL1),
+    l2(l2_entries > 0 ? l2_entries : IO_CACHE_L2_ENTRIES, ioHashL2),
+    mut("h5.cache")
 {
     pre_prefetch_request = 0;
     post_prefetch_request = 0;
@@ -148,6 +595,7 @@ H5FileBuffer::io_context_t::io_context_t (void):
     l1_cache_replace = 0;
     l2_cache_replace = 0;
     bytes_read = 0;
+    readahead_pending = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -155,6 +603,16 @@ H5FileBuffer::io_context_t::io_context_t (void):
  *----------------------------------------------------------------------------*/
 H5FileBuffer::io_context_t::~io_context_t (void)
 {
+    /* Wait for Readaheads Using Context */
+    readahead_cond.lock();
+    {
+        while(readahead_pending > 0)
+        {
+            readahead_cond.wait(0, SYS_TIMEOUT);
+        }
+    }
+    readahead_cond.unlock();
+
     /* Empty L1 Cache */
     {
         cache_entry_t entry;
@@ -183,7 +641,7 @@ H5FileBuffer::io_context_t::~io_context_t (void)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* asset, const char* resource, const char* dataset, long startrow, long numrows, bool _error_checking, bool _verbose, bool _meta_only)
+H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* asset, const char* resource, const char* dataset, long startrow, long numrows, bool _error_checking, bool _verbose, bool _meta_only, const slice_t* slab, int slab_ndims, List<const char*>* group_links)
 {
     assert(asset);
     assert(resource);
@@ -195,19 +653,28 @@ H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* as
     ioContext               = NULL;
     ioBucket                = NULL;
     ioPostPrefetch          = false;
+    ioGlobalId              = GLOBAL_CACHE_INVALID_ID;
+    ioGlobalPending         = INVALID_KEY;
+    ioGlobalGeneration      = 0;
+    ioPageSize              = 0;
     dataChunkBuffer         = NULL;
     dataChunkFilterBuffer   = NULL;
     datasetName             = StringLib::duplicate(dataset);
     datasetPrint            = StringLib::duplicate(dataset);
     datasetStartRow         = startrow;
     datasetNumRows          = numrows;
+    datasetSlabDims         = 0;
     errorChecking           = _error_checking;
     verbose                 = _verbose;
     metaOnly                = _meta_only;
+    groupLinks              = group_links;
     ioKey                   = NULL;
     dataChunkBufferSize     = 0;
     highestDataLevel        = 0;
     dataSizeHint            = 0;
+    inflateParallel         = false;
+    inflatePending          = 0;
+    inflateFailed           = false;
 
     /* Initialize Info */
     info->elements = 0;
@@ -217,11 +684,19 @@ H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* as
     info->numrows  = 0;
     info->numcols  = 0;
 
+    /* Copy Hyperslab Selection (checked against the dataspace when read) */
+    if(slab && slab_ndims > 0)
+    {
+        for(int d = 0; d < MIN(slab_ndims, MAX_NDIMS); d++) datasetSlab[d] = slab[d];
+        datasetSlabDims = slab_ndims;
+    }
+
     /* Process File */
     try
     {
-        /* Initialize Driver */
+        /* Initialize Driver (metadata is read by following addresses around the file) */
         ioDriver = asset->createDriver(resource);
+        if(ioDriver) ioDriver->ioAdvise(0, 0, Asset::IODriver::ADVISE_RANDOM);
 
         /* Set or Create I/O Context */
         if(context)
@@ -235,40 +710,61 @@ H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* as
             ioContextLocal = true;
         }
 
+        /* Assign Resource Id for Global Cache */
+        globalCond.lock();
+        {
+            if(globalBudget > 0)
+            {
+                char global_name[MAX_STR_SIZE];
+                StringLib::format(global_name, MAX_STR_SIZE, "%s/%s", asset->getName(), resource);
+                if(!globalResources.find(global_name, &ioGlobalId))
+                {
+                    /* Start New Generation when Ids Exhausted */
+                    if(globalNextId > GLOBAL_CACHE_MAX_ID)
+                    {
+                        ioGlobalEvict(0);
+                        globalResources.clear();
+                        globalNextId = GLOBAL_CACHE_INVALID_ID + 1;
+                        globalGeneration++;
+                    }
+
+                    ioGlobalId = globalNextId++;
+                    globalResources.add(global_name, ioGlobalId);
+                }
+                ioGlobalGeneration = globalGeneration;
+            }
+        }
+        globalCond.unlock();
+
         /* Check Meta Repository */
         char meta_url[MAX_META_NAME_SIZE];
         metaGetUrl(meta_url, resource, dataset);
         uint64_t meta_key = metaGetKey(meta_url);
         bool meta_found = false;
-        metaMutex.lock();
+
+        /* List Group (links are collected on the way to the object) */
+        if(groupLinks)
         {
-            if(metaRepo.find(meta_key, meta_repo_t::MATCH_EXACTLY, &metaData, true))
+            initMeta(meta_url);
+            parseDataset();
+            uint64_t root_group_offset = readSuperblock();
+            readObjHdr(root_group_offset, 0);
+            if(highestDataLevel < datasetPath.length())
             {
-                meta_found = StringLib::match(metaData.url, meta_url, MAX_META_NAME_SIZE);
+                throw RunTimeException(CRITICAL, RTE_ERROR, "group not found");
             }
+            return;
+        }
+
+        if(metaRepo.find(meta_key, &metaData))
+        {
+            meta_found = StringLib::match(metaData.url, meta_url, MAX_META_NAME_SIZE);
         }
-        metaMutex.unlock();
 
         if(!meta_found)
         {
             /* Initialize Meta Data */
-            LocalLib::copy(metaData.url, meta_url, MAX_META_NAME_SIZE);
-            metaData.type           = UNKNOWN_TYPE;
-            metaData.typesize       = UNKNOWN_VALUE;
-            metaData.fill.fill_ll   = 0LL;
-            metaData.fillsize       = 0;
-            metaData.ndims          = UNKNOWN_VALUE;
-            metaData.chunkelements  = 0;
-            metaData.elementsize    = 0;
-            metaData.offsetsize     = 0;
-            metaData.lengthsize     = 0;
-            metaData.layout         = UNKNOWN_LAYOUT;
-            metaData.address        = 0;
-            metaData.size           = 0;
-            for(int f = 0; f < NUM_FILTERS; f++)
-            {
-                metaData.filter[f]  = INVALID_FILTER;
-            }
+            initMeta(meta_url);
 
             /* Get Dataset Path */
             parseDataset();
@@ -283,22 +779,14 @@ H5FileBuffer::H5FileBuffer (info_t* info, io_context_t* context, const Asset* as
         /* Read Dataset */
         readDataset(info);
 
-        /* Add to Meta Repository */
-        metaMutex.lock();
-        {
-            /* Remove Oldest Entry if Repository is Full */
-            if(metaRepo.isfull())
-            {
-                metaRepo.remove(metaRepo.first(NULL));
-            }
-
-            /* Add Entry to Repository */
-            metaRepo.add(meta_key, metaData, true);
-        }
-        metaMutex.unlock();
+        /* Add to Meta Repository (evicts least recently used entry when full) */
+        metaRepo.add(meta_key, metaData, true);
     }
     catch(const RunTimeException& e)
     {
+        /* Wait for Outstanding Chunks Writing into Data */
+        inflateWait();
+
         /* Clean Up Data Allocations */
         if(info->data) delete [] info->data;
         info->data= NULL;
@@ -321,61 +809,295 @@ H5FileBuffer::~H5FileBuffer (void)
 }
 
 /*----------------------------------------------------------------------------
- * tearDown
+ * initCache
  *----------------------------------------------------------------------------*/
-void H5FileBuffer::tearDown (void)
+void H5FileBuffer::initCache (void)
 {
-    /* Close I/O Resources */
-    if(ioDriver)
+    globalHitMetric = EventLib::registerMetric(GLOBAL_CACHE_METRICS, EventLib::COUNTER, "%s", "cache.hits");
+    globalMissMetric = EventLib::registerMetric(GLOBAL_CACHE_METRICS, EventLib::COUNTER, "%s", "cache.misses");
+    globalBytesMetric = EventLib::registerMetric(GLOBAL_CACHE_METRICS, EventLib::GAUGE, "%s", "cache.bytes");
+    if(globalHitMetric == EventLib::INVALID_METRIC || globalMissMetric == EventLib::INVALID_METRIC || globalBytesMetric == EventLib::INVALID_METRIC)
     {
-        delete ioDriver;
+        mlog(ERROR, "Registry failed for h5coro cache metrics");
     }
+}
 
-    /* Delete Local Context */
-    if(ioContextLocal)
+/*----------------------------------------------------------------------------
+ * initInflaters
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::initInflaters (int num_threads)
+{
+    if(num_threads > 0)
     {
-        if(ioContext) delete ioContext;
+        inflateActive = true;
+        inflatePub = new Publisher(NULL);
+        inflateSub = new Subscriber(*inflatePub);
+        inflatePoolSize = num_threads;
+        inflatePids = new Thread* [inflatePoolSize];
+        for(int t = 0; t < inflatePoolSize; t++)
+        {
+            inflatePids[t] = new Thread(inflateThread, NULL);
+        }
     }
-
-    /* Delete Dataset Strings */
-    delete [] datasetName;
-    delete [] datasetPrint;
-
-    /* Delete Chunk Buffer */
-    if(dataChunkBuffer) delete [] dataChunkBuffer;
-    if(dataChunkFilterBuffer) delete [] dataChunkFilterBuffer;
 }
 
 /*----------------------------------------------------------------------------
- * ioRequest
+ * initShuffle
+ *
+ *  selects the widest unshuffle kernels supported by the running processor;
+ *  type sizes without a kernel fall back to the scalar loop
  *----------------------------------------------------------------------------*/
-void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int64_t hint, bool cache_the_data)
+void H5FileBuffer::initShuffle (void)
 {
-    cache_entry_t entry;
-    int64_t data_offset = 0;
-    uint64_t file_position = *pos;
-    bool cached = false;
-    ioContext->mut.lock();
+    #if defined(__SSE2__)
+    if(__builtin_cpu_supports("avx2"))
     {
-        /* Count I/O Request */
-        if(ioPostPrefetch) ioContext->post_prefetch_request++;
-        else ioContext->pre_prefetch_request++;
+        shuffleKernels[2] = unshuffle2AVX2;
+        shuffleKernels[4] = unshuffle4AVX2;
+        shuffleKernels[8] = unshuffle8AVX2;
+    }
+    else
+    {
+        shuffleKernels[2] = unshuffle2SSE2;
+        shuffleKernels[4] = unshuffle4SSE2;
+        shuffleKernels[8] = unshuffle8SSE2;
+    }
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    shuffleKernels[2] = unshuffle2NEON;
+    shuffleKernels[4] = unshuffle4NEON;
+    shuffleKernels[8] = unshuffle8NEON;
+    #endif
+}
 
-        /* Attempt to fulfill data request from I/O cache
-        *  note that this is only checked if a buffer is supplied;
-        *  otherwise the purpose of the call is to cache the entry */
-        if(buffer)
+/*----------------------------------------------------------------------------
+ * deinitInflaters
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::deinitInflaters (void)
+{
+    if(inflateActive)
+    {
+        inflateActive = false;
+        for(int t = 0; t < inflatePoolSize; t++)
         {
-            if( ioCheckCache(file_position, size, &ioContext->l1, IO_CACHE_L1_MASK, &entry) ||
-                ioCheckCache(file_position, size, &ioContext->l2, IO_CACHE_L2_MASK, &entry) )
-            {
-                /* Entry Found in Cache */
-                cached = true;
-
-                /* Set Offset to Start of Requested Data */
-                data_offset = file_position - entry.pos;
+            delete inflatePids[t];
+        }
+        delete [] inflatePids;
+        delete inflateSub;
+        delete inflatePub;
+        inflatePids = NULL;
+        inflateSub = NULL;
+        inflatePub = NULL;
+        inflatePoolSize = 0;
+    }
+}
 
-                /* Copy Data into Buffer */
+/*----------------------------------------------------------------------------
+ * deinitCache
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::deinitCache (void)
+{
+    setCacheBudget(0);
+}
+
+/*----------------------------------------------------------------------------
+ * setCacheBudget
+ *
+ *  a budget of zero disables the global cache and frees all cached lines
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::setCacheBudget (int64_t budget)
+{
+    globalCond.lock();
+    {
+        globalBudget = MAX(budget, 0);
+        ioGlobalEvict(globalBudget);
+        if(globalBudget == 0)
+        {
+            globalResources.clear();
+            globalNextId = GLOBAL_CACHE_INVALID_ID + 1;
+            globalGeneration++;
+        }
+    }
+    globalCond.unlock();
+
+    EventLib::updateMetric(globalBytesMetric, (double)globalBytes);
+}
+
+/*----------------------------------------------------------------------------
+ * getCacheBudget
+ *----------------------------------------------------------------------------*/
+int64_t H5FileBuffer::getCacheBudget (void)
+{
+    return globalBudget;
+}
+
+/*----------------------------------------------------------------------------
+ * metaSave
+ *
+ *  writes the meta repository to a file so that it can be restored by
+ *  metaLoad when the process restarts; the file is written to a temporary
+ *  name and then renamed so that readers never observe a partial file
+ *----------------------------------------------------------------------------*/
+long H5FileBuffer::metaSave (const char* filename)
+{
+    assert(filename);
+
+    /* Open Temporary File */
+    char tmpname[MAX_STR_SIZE];
+    StringLib::format(tmpname, MAX_STR_SIZE, "%s.tmp", filename);
+    fileptr_t fp = fopen(tmpname, "wb");
+    if(fp == NULL)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open meta file %s: %s", tmpname, LocalLib::err2str(errno));
+    }
+
+    /* Write Entries (repository may change during walk, so count is patched in after) */
+    meta_file_hdr_t hdr = {
+        .signature  = META_FILE_SIGNATURE,
+        .version    = META_FILE_VERSION,
+        .entry_size = sizeof(meta_entry_t),
+        .num_entries= 0
+    };
+    bool status = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    long count = 0;
+    if(status)
+    {
+        count = metaRepo.iterate(metaWriteEntry, fp);
+        hdr.num_entries = count;
+        status = !ferror(fp) && (fseek(fp, 0, SEEK_SET) == 0) && (fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+    }
+
+    /* Close and Move File into Place */
+    if(fclose(fp) != 0) status = false;
+    if(!status || rename(tmpname, filename) != 0)
+    {
+        remove(tmpname);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to write meta file %s", filename);
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * metaLoad
+ *
+ *  adds entries from a file written by metaSave to the meta repository;
+ *  entries whose key does not match the hash of their url are skipped,
+ *  and entries already in the repository are kept
+ *----------------------------------------------------------------------------*/
+long H5FileBuffer::metaLoad (const char* filename)
+{
+    assert(filename);
+
+    /* Open File */
+    fileptr_t fp = fopen(filename, "rb");
+    if(fp == NULL)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to open meta file %s: %s", filename, LocalLib::err2str(errno));
+    }
+
+    /* Read and Verify Header */
+    meta_file_hdr_t hdr;
+    if(fread(&hdr, sizeof(hdr), 1, fp) != 1)
+    {
+        fclose(fp);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read header of meta file %s", filename);
+    }
+    else if(hdr.signature != META_FILE_SIGNATURE || hdr.version != META_FILE_VERSION || hdr.entry_size != sizeof(meta_entry_t))
+    {
+        fclose(fp);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "incompatible meta file %s: version %u, entry size %u", filename, hdr.version, hdr.entry_size);
+    }
+
+    /* Read Entries */
+    long count = 0;
+    for(uint64_t i = 0; i < hdr.num_entries && !metaRepo.isfull(); i++)
+    {
+        uint64_t key;
+        meta_entry_t entry;
+        if(fread(&key, sizeof(key), 1, fp) != 1 || fread(&entry, sizeof(entry), 1, fp) != 1)
+        {
+            mlog(WARNING, "Meta file %s truncated after %ld entries", filename, count);
+            break;
+        }
+
+        entry.url[MAX_META_NAME_SIZE - 1] = '\0';
+        if(key != metaGetKey(entry.url))
+        {
+            mlog(WARNING, "Skipping meta file entry with mismatched key: %s", entry.url);
+            continue;
+        }
+
+        if(metaRepo.add(key, entry))
+        {
+            count++;
+        }
+    }
+
+    fclose(fp);
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * tearDown
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::tearDown (void)
+{
+    /* Release Pending Global Cache Entry */
+    ioGlobalAbort();
+
+    /* Close I/O Resources */
+    if(ioDriver)
+    {
+        delete ioDriver;
+    }
+
+    /* Delete Local Context */
+    if(ioContextLocal)
+    {
+        if(ioContext) delete ioContext;
+    }
+
+    /* Delete Dataset Strings */
+    delete [] datasetName;
+    delete [] datasetPrint;
+
+    /* Delete Chunk Buffer */
+    if(dataChunkBuffer) delete [] dataChunkBuffer;
+    if(dataChunkFilterBuffer) delete [] dataChunkFilterBuffer;
+}
+
+/*----------------------------------------------------------------------------
+ * ioRequest
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int64_t hint, bool cache_the_data, bool page_aligned)
+{
+    cache_entry_t entry;
+    int64_t data_offset = 0;
+    uint64_t file_position = *pos;
+    bool cached = false;
+    ioContext->mut.lock();
+    {
+        /* Count I/O Request */
+        if(ioPostPrefetch) ioContext->post_prefetch_request++;
+        else ioContext->pre_prefetch_request++;
+
+        /* Attempt to fulfill data request from I/O cache
+        *  note that this is only checked if a buffer is supplied;
+        *  otherwise the purpose of the call is to cache the entry */
+        if(buffer)
+        {
+            if( ioCheckCache(file_position, size, &ioContext->l1, IO_CACHE_L1_MASK, &entry) ||
+                ioCheckCache(file_position, size, &ioContext->l2, IO_CACHE_L2_MASK, &entry) )
+            {
+                /* Entry Found in Cache */
+                cached = true;
+                RequestAccount::count(RequestAccount::CACHE_HITS);
+
+                /* Set Offset to Start of Requested Data */
+                data_offset = file_position - entry.pos;
+
+                /* Copy Data into Buffer */
                 LocalLib::copy(buffer, &entry.data[data_offset], size);
             }
             else
@@ -384,43 +1106,93 @@ void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int6
                 ioContext->cache_miss++;
             }
         }
+        else if(hint > 0)
+        {
+            /* Skip Prefetch of Data Already Cached (e.g. by ioPrefetch) */
+            cached = ioCheckCache(file_position, hint, &ioContext->l1, IO_CACHE_L1_MASK, &entry) ||
+                     ioCheckCache(file_position, hint, &ioContext->l2, IO_CACHE_L2_MASK, &entry);
+        }
     }
     ioContext->mut.unlock();
 
     /* Read data to fulfill request */
     if(!cached)
     {
-        /* Cacluate How Much Data to Read and Set Data Buffer */
-        int64_t read_size;
-        if(cache_the_data)
-        {
-            read_size = MAX(size, hint); // overread when caching
-            entry.data = new uint8_t [read_size];
-        }
-        else
+        /* Cacluate How Much Data to Read */
+        int64_t read_size = cache_the_data ? MAX(size, hint) : size; // overread when caching
+        uint64_t read_position = file_position;
+
+        /* Align Read to File Space Pages
+         *  metadata of a file written with paged aggregation is packed into
+         *  pages; reading whole pages keeps a page from being split across
+         *  cache entries, which would otherwise take another request to
+         *  read each field that straddles the end of an entry */
+        if(page_aligned && cache_the_data && ioPageSize > 0)
         {
-            assert(buffer); // logically inconsistent to not cache when buffer is null
-            read_size = size;
-            entry.data = buffer;
+            read_position = file_position - (file_position % ioPageSize);
+            uint64_t read_end = read_position + MAX((uint64_t)read_size, (file_position - read_position) + size);
+            read_end = ((read_end + ioPageSize - 1) / ioPageSize) * ioPageSize;
+            read_size = read_end - read_position;
         }
 
-        /* Mark File Position of Entry */
-        entry.pos = file_position;
-
-        /* Read into Cache */
-        try
+        /* Attempt to fulfill data request from global cache
+         *  a request that provides a buffer only needs the requested bytes
+         *  to be present, whereas a prefetch needs the entire read */
+        bool global_hit = false;
+        if(cache_the_data)
         {
-            entry.size = ioDriver->ioRead(entry.data, read_size, entry.pos);
+            global_hit = ioGlobalGet(file_position, buffer ? size : read_size, &entry);
+            if(global_hit) data_offset = file_position - entry.pos;
         }
-        catch (const RunTimeException& e)
+        if(buffer) RequestAccount::count(global_hit ? RequestAccount::CACHE_HITS : RequestAccount::CACHE_MISSES);
+
+        if(!global_hit)
         {
-            if(cache_the_data) delete [] entry.data;
-            throw; // rethrow exception
+            /* Set Data Buffer */
+            if(cache_the_data)
+            {
+                entry.data = new uint8_t [read_size];
+            }
+            else
+            {
+                assert(buffer); // logically inconsistent to not cache when buffer is null
+                entry.data = buffer;
+            }
+
+            /* Mark File Position of Entry */
+            entry.pos = read_position;
+            data_offset = file_position - read_position;
+
+            /* Read into Cache */
+            try
+            {
+                if(cache_the_data || read_size < IO_DIRECT_THRESHOLD)
+                {
+                    entry.size = ioDriver->ioRead(entry.data, read_size, entry.pos);
+                }
+                else
+                {
+                    entry.size = ioReadDirect(entry.data, read_size, entry.pos);
+                }
+            }
+            catch (const RunTimeException& e)
+            {
+                if(cache_the_data) delete [] entry.data;
+                ioGlobalAbort();
+                throw; // rethrow exception
+            }
+
+            /* Share Entry with Other I/O Contexts */
+            if(cache_the_data)
+            {
+                ioGlobalPut(&entry);
+            }
         }
 
         /* Check Enough Data was Read */
-        if(entry.size < size)
+        if(entry.size < (data_offset + size))
         {
+            if(cache_the_data) delete [] entry.data;
             throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read %ld bytes of data: %ld", size, entry.size);
         }
 
@@ -436,58 +1208,8 @@ void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int6
                 LocalLib::copy(buffer, &entry.data[data_offset], size);
             }
 
-            /* Select Cache */
-            cache_t* cache = NULL;
-            long* cache_replace = NULL;
-            if(entry.size <= IO_CACHE_L1_LINESIZE)
-            {
-                cache = &ioContext->l1;
-                cache_replace = &ioContext->l1_cache_replace;
-            }
-            else
-            {
-                cache = &ioContext->l2;
-                cache_replace = &ioContext->l2_cache_replace;
-            }
-
             /* Cache Entry */
-            ioContext->mut.lock();
-            {
-                /* Ensure Room in Cache */
-                if(cache->isfull())
-                {
-                    /* Replace Oldest Entry */
-                    cache_entry_t oldest_entry;
-                    uint64_t oldest_pos = cache->first(&oldest_entry);
-                    if(oldest_pos != (uint64_t)INVALID_KEY)
-                    {
-                        delete [] oldest_entry.data;
-                        cache->remove(oldest_pos);
-                    }
-                    else
-                    {
-                        ioContext->mut.unlock();
-                        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to make room in cache for %s", datasetPrint);
-                    }
-
-                    /* Count Cache Replacement */
-                    (*cache_replace)++;
-                }
-
-                /* Add Cache Entry */
-                if(!cache->add(file_position, entry))
-                {
-                    /* Free Previously Allocated Entry
-                     *  should only fail to add if the cache line was
-                     *  already added, in which case it is safe to just
-                     *  delete what was allocated and move on */
-                    delete [] entry.data;
-                }
-
-                /* Count Bytes Read */
-                ioContext->bytes_read += entry.size;
-            }
-            ioContext->mut.unlock();
+            ioCacheAdd(ioContext, &entry);
         }
         else // data not being cached
         {
@@ -498,7 +1220,7 @@ void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int6
              *  incur an additional mutex lock, whereas here it only occurs an aditional
              *  time when data isn't being cached (which is rare)
              */
-            ioContext->mut.unlock();
+            ioContext->mut.lock();
             {
                 ioContext->bytes_read += entry.size;
             }
@@ -510,6 +1232,50 @@ void H5FileBuffer::ioRequest (uint64_t* pos, int64_t size, uint8_t* buffer, int6
     *pos += size;
 }
 
+/*----------------------------------------------------------------------------
+ * ioReadDirect
+ *
+ *  reads a large range straight into the caller's buffer as a vector of
+ *  parts, which drivers that support it issue concurrently; returns the
+ *  number of contiguous bytes read from the start of the range
+ *----------------------------------------------------------------------------*/
+int64_t H5FileBuffer::ioReadDirect (uint8_t* data, int64_t size, uint64_t pos)
+{
+    /* Split Range into Parts */
+    int num_parts = (int)((size + IO_DIRECT_PART_SIZE - 1) / IO_DIRECT_PART_SIZE);
+    Asset::IODriver::io_read_t* reads = new Asset::IODriver::io_read_t [num_parts];
+    for(int p = 0; p < num_parts; p++)
+    {
+        int64_t offset = p * IO_DIRECT_PART_SIZE;
+        reads[p].data = &data[offset];
+        reads[p].size = MIN(IO_DIRECT_PART_SIZE, size - offset);
+        reads[p].pos = pos + offset;
+        reads[p].bytes = 0;
+    }
+
+    /* Read Parts */
+    try
+    {
+        ioDriver->ioReadv(reads, num_parts);
+    }
+    catch(const RunTimeException&)
+    {
+        delete [] reads;
+        throw;
+    }
+
+    /* Count Bytes up to First Short Part */
+    int64_t bytes = 0;
+    for(int p = 0; p < num_parts; p++)
+    {
+        if(reads[p].bytes > 0) bytes += reads[p].bytes;
+        if(reads[p].bytes < reads[p].size) break;
+    }
+    delete [] reads;
+
+    return bytes;
+}
+
 /*----------------------------------------------------------------------------
  * ioCheckCache
  *----------------------------------------------------------------------------*/
@@ -531,58 +1297,367 @@ bool H5FileBuffer::ioCheckCache (uint64_t pos, int64_t size, cache_t* cache, uin
 }
 
 /*----------------------------------------------------------------------------
- * ioHashL1
+ * ioCacheAdd
+ *
+ *  adds an entry to the L1 or L2 cache of the context depending on its size,
+ *  replacing the oldest entry if the cache is full; the cache takes ownership
+ *  of the entry's data
  *----------------------------------------------------------------------------*/
-uint64_t H5FileBuffer::ioHashL1 (uint64_t key)
+void H5FileBuffer::ioCacheAdd (io_context_t* context, cache_entry_t* entry)
 {
-    return key & (~IO_CACHE_L1_MASK);
-}
+    /* Select Cache */
+    cache_t* cache = NULL;
+    long* cache_replace = NULL;
+    if(entry->size <= IO_CACHE_L1_LINESIZE)
+    {
+        cache = &context->l1;
+        cache_replace = &context->l1_cache_replace;
+    }
+    else
+    {
+        cache = &context->l2;
+        cache_replace = &context->l2_cache_replace;
+    }
 
-/*----------------------------------------------------------------------------
- * ioHashL2
- *----------------------------------------------------------------------------*/
-uint64_t H5FileBuffer::ioHashL2 (uint64_t key)
-{
-    return key & (~IO_CACHE_L2_MASK);
-}
+    /* Cache Entry */
+    context->mut.lock();
+    {
+        /* Ensure Room in Cache */
+        if(cache->isfull())
+        {
+            /* Replace Oldest Entry */
+            cache_entry_t oldest_entry;
+            uint64_t oldest_pos = cache->first(&oldest_entry);
+            if(oldest_pos != (uint64_t)INVALID_KEY)
+            {
+                delete [] oldest_entry.data;
+                cache->remove(oldest_pos);
+            }
+            else
+            {
+                context->mut.unlock();
+                delete [] entry->data;
+                throw RunTimeException(CRITICAL, RTE_ERROR, "failed to make room in cache at %lu", (unsigned long)entry->pos);
+            }
 
-/*----------------------------------------------------------------------------
- * readField
- *----------------------------------------------------------------------------*/
-void H5FileBuffer::readByteArray (uint8_t* data, int64_t size, uint64_t* pos)
-{
-    assert(data);
-    ioRequest(pos, size, data, IO_CACHE_L1_LINESIZE, true);
+            /* Count Cache Replacement */
+            (*cache_replace)++;
+        }
+
+        /* Add Cache Entry */
+        if(!cache->add(entry->pos, *entry))
+        {
+            /* Free Previously Allocated Entry
+             *  should only fail to add if the cache line was
+             *  already added, in which case it is safe to just
+             *  delete what was allocated and move on */
+            delete [] entry->data;
+        }
+
+        /* Count Bytes Read */
+        context->bytes_read += entry->size;
+    }
+    context->mut.unlock();
 }
 
 /*----------------------------------------------------------------------------
- * readField
+ * ioPrefetch
+ *
+ *  sorts the byte ranges, coalesces those that are close together into
+ *  larger reads, and places the data read into the caches of the context;
+ *  returns the number of read requests issued
  *----------------------------------------------------------------------------*/
-uint64_t H5FileBuffer::readField (int64_t size, uint64_t* pos)
+int H5FileBuffer::ioPrefetch (const Asset* asset, const char* resource, io_context_t* context, io_range_t* ranges, int num_ranges)
 {
-    assert(pos);
-    assert(size > 0);
-    assert(size <= 8);
+    if(num_ranges <= 0) return 0;
 
-    uint64_t value = 0;
-    uint8_t data_ptr[8];
-
-    /* Request Data from I/O */
-    ioRequest(pos, size, data_ptr, IO_CACHE_L1_LINESIZE, true);
-
-    /*  Read Field Value */
-    switch(size)
+    /* Sort Ranges by Position (batches are small) */
+    for(int i = 1; i < num_ranges; i++)
     {
-        case 8:
+        io_range_t range = ranges[i];
+        int j = i - 1;
+        while(j >= 0 && ranges[j].pos > range.pos)
         {
-            value = *(uint64_t*)data_ptr;
-            #ifdef __be__
-                value = LocalLib::swapll(value);
-            #endif
-            break;
+            ranges[j + 1] = ranges[j];
+            j--;
         }
+        ranges[j + 1] = range;
+    }
 
-        case 4:
+    /* Coalesce Ranges */
+    int num_coalesced = 0;
+    for(int i = 1; i < num_ranges; i++)
+    {
+        io_range_t* curr = &ranges[num_coalesced];
+        uint64_t curr_end = curr->pos + curr->size;
+        uint64_t next_end = ranges[i].pos + ranges[i].size;
+        uint64_t merged_end = MAX(curr_end, next_end);
+        if((ranges[i].pos <= (curr_end + IO_COALESCE_GAP)) && ((int64_t)(merged_end - curr->pos) <= IO_COALESCE_MAX_SIZE))
+        {
+            curr->size = merged_end - curr->pos;
+        }
+        else
+        {
+            ranges[++num_coalesced] = ranges[i];
+        }
+    }
+    num_coalesced++;
+
+    /* Read Coalesced Ranges into Context (issued together so a driver can batch them) */
+    Asset::IODriver* driver = asset->createDriver(resource);
+    Asset::IODriver::io_read_t* reads = new Asset::IODriver::io_read_t [num_coalesced];
+    for(int i = 0; i < num_coalesced; i++)
+    {
+        reads[i].data = new uint8_t [ranges[i].size];
+        reads[i].size = ranges[i].size;
+        reads[i].pos = ranges[i].pos;
+        reads[i].bytes = 0;
+        driver->ioAdvise(ranges[i].pos, ranges[i].size, Asset::IODriver::ADVISE_WILLNEED);
+    }
+    try
+    {
+        driver->ioReadv(reads, num_coalesced);
+    }
+    catch(const RunTimeException& e)
+    {
+        for(int i = 0; i < num_coalesced; i++) delete [] reads[i].data;
+        delete [] reads;
+        delete driver;
+        throw;
+    }
+    for(int i = 0; i < num_coalesced; i++)
+    {
+        cache_entry_t entry;
+        entry.pos = reads[i].pos;
+        entry.data = reads[i].data;
+        entry.size = reads[i].bytes;
+        ioCacheAdd(context, &entry);
+    }
+    delete [] reads;
+    delete driver;
+
+    return num_coalesced;
+}
+
+/*----------------------------------------------------------------------------
+ * ioGlobalGet
+ *
+ *  on a hit, the entry is populated with a private copy of the cached line;
+ *  on a miss, the position is registered as pending so that other contexts
+ *  requesting the same line wait for this read instead of issuing their own,
+ *  and the caller must follow up with either ioGlobalPut or ioGlobalAbort
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::ioGlobalGet (uint64_t pos, int64_t size, cache_entry_t* entry)
+{
+    /* Check Global Cache Enabled for Resource */
+    if(ioGlobalId == GLOBAL_CACHE_INVALID_ID || (pos + size) > GLOBAL_CACHE_POS_MASK)
+    {
+        return false;
+    }
+
+    bool found = false;
+    uint64_t key = (ioGlobalId << GLOBAL_CACHE_ID_SHIFT) | pos;
+    globalCond.lock();
+    {
+        while(ioGlobalGeneration == globalGeneration)
+        {
+            cache_entry_t global_entry;
+            if( ioCheckCache(key, size, &globalL1, IO_CACHE_L1_MASK, &global_entry) ||
+                ioCheckCache(key, size, &globalL2, IO_CACHE_L2_MASK, &global_entry) )
+            {
+                /* Copy Line out of Global Cache */
+                entry->data = new uint8_t [global_entry.size];
+                entry->size = global_entry.size;
+                entry->pos  = global_entry.pos & GLOBAL_CACHE_POS_MASK;
+                LocalLib::copy(entry->data, global_entry.data, global_entry.size);
+                found = true;
+                break;
+            }
+            else if(globalPending.find(key, Table<bool,uint64_t>::MATCH_EXACTLY, NULL))
+            {
+                /* Wait for Context Already Reading Line */
+                globalCond.wait(0, SYS_TIMEOUT);
+            }
+            else
+            {
+                /* Register as Reader of Line */
+                bool pending = true;
+                if(globalPending.add(key, pending))
+                {
+                    ioGlobalPending = key;
+                }
+                break;
+            }
+        }
+    }
+    globalCond.unlock();
+
+    /* Update Metrics */
+    EventLib::incrementMetric(found ? globalHitMetric : globalMissMetric);
+
+    return found;
+}
+
+/*----------------------------------------------------------------------------
+ * ioGlobalPut
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::ioGlobalPut (cache_entry_t* entry)
+{
+    /* Only Pending Readers Populate Global Cache */
+    if(ioGlobalPending == (uint64_t)INVALID_KEY)
+    {
+        return;
+    }
+
+    globalCond.lock();
+    {
+        if((ioGlobalGeneration == globalGeneration) && (entry->size > 0) && (entry->size <= globalBudget))
+        {
+            /* Select Cache */
+            bool is_l1 = entry->size <= IO_CACHE_L1_LINESIZE;
+            cache_t* cache = is_l1 ? &globalL1 : &globalL2;
+
+            /* Ensure Room in Cache */
+            ioGlobalEvict(globalBudget - entry->size);
+            if(cache->isfull())
+            {
+                cache_entry_t oldest_entry;
+                uint64_t oldest_pos = cache->first(&oldest_entry);
+                if(oldest_pos != (uint64_t)INVALID_KEY)
+                {
+                    delete [] oldest_entry.data;
+                    cache->remove(oldest_pos);
+                    globalBytes -= oldest_entry.size;
+                    if(is_l1) globalL1Bytes -= oldest_entry.size;
+                }
+            }
+
+            /* Add Copy of Entry */
+            cache_entry_t global_entry;
+            global_entry.data = new uint8_t [entry->size];
+            global_entry.size = entry->size;
+            global_entry.pos  = ioGlobalPending;
+            LocalLib::copy(global_entry.data, entry->data, entry->size);
+            if(cache->add(global_entry.pos, global_entry))
+            {
+                globalBytes += global_entry.size;
+                if(is_l1) globalL1Bytes += global_entry.size;
+            }
+            else
+            {
+                delete [] global_entry.data;
+            }
+        }
+
+        /* Release Waiting Contexts */
+        globalPending.remove(ioGlobalPending);
+        ioGlobalPending = INVALID_KEY;
+        globalCond.signal(0, Cond::NOTIFY_ALL);
+    }
+    globalCond.unlock();
+
+    /* Update Metrics */
+    EventLib::updateMetric(globalBytesMetric, (double)globalBytes);
+}
+
+/*----------------------------------------------------------------------------
+ * ioGlobalAbort
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::ioGlobalAbort (void)
+{
+    if(ioGlobalPending != (uint64_t)INVALID_KEY)
+    {
+        globalCond.lock();
+        {
+            globalPending.remove(ioGlobalPending);
+            ioGlobalPending = INVALID_KEY;
+            globalCond.signal(0, Cond::NOTIFY_ALL);
+        }
+        globalCond.unlock();
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * ioGlobalEvict
+ *
+ *  must be called with globalCond locked; removes least recently used lines,
+ *  drawing from whichever of the L1 or L2 caches holds more bytes, until the
+ *  size of the global cache is within the budget
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::ioGlobalEvict (int64_t budget)
+{
+    while(globalBytes > MAX(budget, 0))
+    {
+        bool is_l1 = globalL1Bytes >= (globalBytes - globalL1Bytes);
+        cache_t* cache = is_l1 ? &globalL1 : &globalL2;
+
+        cache_entry_t oldest_entry;
+        uint64_t oldest_pos = cache->first(&oldest_entry);
+        if(oldest_pos == (uint64_t)INVALID_KEY)
+        {
+            break; // nothing left to evict
+        }
+
+        delete [] oldest_entry.data;
+        cache->remove(oldest_pos);
+        globalBytes -= oldest_entry.size;
+        if(is_l1) globalL1Bytes -= oldest_entry.size;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * ioHashL1
+ *----------------------------------------------------------------------------*/
+uint64_t H5FileBuffer::ioHashL1 (uint64_t key)
+{
+    return key & (~IO_CACHE_L1_MASK);
+}
+
+/*----------------------------------------------------------------------------
+ * ioHashL2
+ *----------------------------------------------------------------------------*/
+uint64_t H5FileBuffer::ioHashL2 (uint64_t key)
+{
+    return key & (~IO_CACHE_L2_MASK);
+}
+
+/*----------------------------------------------------------------------------
+ * readField
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::readByteArray (uint8_t* data, int64_t size, uint64_t* pos)
+{
+    assert(data);
+    ioRequest(pos, size, data, IO_CACHE_L1_LINESIZE, true, true);
+}
+
+/*----------------------------------------------------------------------------
+ * readField
+ *----------------------------------------------------------------------------*/
+uint64_t H5FileBuffer::readField (int64_t size, uint64_t* pos)
+{
+    assert(pos);
+    assert(size > 0);
+    assert(size <= 8);
+
+    uint64_t value = 0;
+    uint8_t data_ptr[8];
+
+    /* Request Data from I/O */
+    ioRequest(pos, size, data_ptr, IO_CACHE_L1_LINESIZE, true, true);
+
+    /*  Read Field Value */
+    switch(size)
+    {
+        case 8:
+        {
+            value = *(uint64_t*)data_ptr;
+            #ifdef __be__
+                value = LocalLib::swapll(value);
+            #endif
+            break;
+        }
+
+        case 4:
         {
             value = *(uint32_t*)data_ptr;
             #ifdef __be__
@@ -606,7 +1681,15 @@ uint64_t H5FileBuffer::readField (int64_t size, uint64_t* pos)
             break;
         }
 
-        default: assert(false);
+        default:
+        {
+            /* Odd Sized Fields (encoded lengths and counts) are Little Endian */
+            for(int64_t i = size - 1; i >= 0; i--)
+            {
+                value = (value << 8) | data_ptr[i];
+            }
+            break;
+        }
     }
 
     /* Return Field Value */
@@ -631,6 +1714,12 @@ void H5FileBuffer::readDataset (info_t* info)
         throw RunTimeException(CRITICAL, RTE_ERROR, "missing data dimension information");
     }
 
+    /* Resolve Hyperslab Selection into the Row Window Spanning It */
+    if(datasetSlabDims > 0)
+    {
+        resolveSlab();
+    }
+
     /* Calculate Size of Data Row (note dimension starts at 1) */
     uint64_t row_size = metaData.typesize;
     for(int d = 1; d < metaData.ndims; d++)
@@ -731,8 +1820,15 @@ void H5FileBuffer::readDataset (info_t* info)
             case COMPACT_LAYOUT:
             case CONTIGUOUS_LAYOUT:
             {
-                uint64_t data_addr = metaData.address + buffer_offset;
-                ioRequest(&data_addr, buffer_size, buffer, IO_CACHE_L1_LINESIZE, false);
+                if(datasetSlabDims > 0)
+                {
+                    readSlabRows(buffer, row_size);
+                }
+                else
+                {
+                    uint64_t data_addr = metaData.address + buffer_offset;
+                    ioRequest(&data_addr, buffer_size, buffer, IO_CACHE_L1_LINESIZE, false);
+                }
                 break;
             }
 
@@ -761,10 +1857,15 @@ void H5FileBuffer::readDataset (info_t* info)
                  *  If reading all of the data from the start of the data segment in the file
                  *  past where the desired subset is consistutes only a 2x increase in the
                  *  overall data that would be read, then prefetch the entire block from the
-                 *  beginning and set the size hint to the L1 cache line size.
+                 *  beginning and set the size hint to the L1 cache line size.  A strided
+                 *  selection skips chunks between its rows, so it is never prefetched.
                  */
                 ioPostPrefetch = true;
-                if(buffer_offset < (uint64_t)buffer_size)
+                if(datasetSlabDims > 0 && datasetSlab[0].stride > 1)
+                {
+                    dataSizeHint = IO_CACHE_L1_LINESIZE;
+                }
+                else if(buffer_offset < (uint64_t)buffer_size)
                 {
                     ioRequest(&metaData.address, 0, NULL, buffer_offset + buffer_size, true);
                     dataSizeHint = IO_CACHE_L1_LINESIZE;
@@ -774,8 +1875,27 @@ void H5FileBuffer::readDataset (info_t* info)
                     dataSizeHint = buffer_size;
                 }
 
-                /* Read B-Tree */
-                readBTreeV1(metaData.address, buffer, buffer_size, buffer_offset);
+                /* Inflate Chunks in Parallel when Reading More than One */
+                inflateParallel = (inflatePoolSize > 0) && metaData.filter[DEFLATE_FILTER] && (buffer_size > dataChunkBufferSize);
+
+                /* Read Chunks from Index (built from B-Tree on first access) */
+                chunk_index_t* index = chunkIndexAcquire();
+                try
+                {
+                    readChunks(index, buffer, buffer_size, buffer_offset);
+                }
+                catch(const RunTimeException&)
+                {
+                    chunkIndexRelease(index);
+                    throw;
+                }
+                chunkIndexRelease(index);
+
+                /* Wait for Outstanding Chunks */
+                if(!inflateWait())
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "failed to inflate one or more chunks");
+                }
 
                 /* Check Need to Flatten Chunks */
                 bool flatten = false;
@@ -875,100 +1995,310 @@ void H5FileBuffer::readDataset (info_t* info)
                 }
             }
         }
+
+        /* Copy Selected Elements out of Row Window */
+        if(datasetSlabDims > 0)
+        {
+            selectSlab(info);
+        }
     }
 }
 
 /*----------------------------------------------------------------------------
- * readSuperblock
+ * resolveSlab
+ *
+ *  checks the hyperslab selection against the dataspace, fills in counts
+ *  and unselected dimensions, and sets the row window to the rows spanning
+ *  the selection
  *----------------------------------------------------------------------------*/
-uint64_t H5FileBuffer::readSuperblock (void)
+void H5FileBuffer::resolveSlab (void)
 {
-    uint64_t pos = 0;
+    if(datasetSlabDims > metaData.ndims)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "selection has more dimensions than dataset: %d > %d", datasetSlabDims, metaData.ndims);
+    }
 
-    /* Read and Verify Superblock Info */
-    if(errorChecking)
+    for(int d = 0; d < metaData.ndims; d++)
     {
-        uint64_t signature = readField(8, &pos);
-        if(signature != H5_SIGNATURE_LE)
-        {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file signature: 0x%llX", (unsigned long long)signature);
-        }
+        slice_t* slice = &datasetSlab[d];
 
-        uint64_t superblock_version = readField(1, &pos);
-        if(superblock_version != 0)
+        /* Select Entire Dimension when Not Specified */
+        if(d >= datasetSlabDims)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file superblock version: %d", (int)superblock_version);
+            slice->start = 0;
+            slice->stride = 1;
+            slice->count = ALL_ROWS;
         }
 
-        uint64_t freespace_version = readField(1, &pos);
-        if(freespace_version != 0)
+        /* Check Selection */
+        long dimension = (long)metaData.dimensions[d];
+        if(slice->start < 0 || slice->start >= dimension || slice->stride < 1)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file free space version: %d", (int)freespace_version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid selection in dimension %d: start=%ld, stride=%ld, size=%ld", d, slice->start, slice->stride, dimension);
         }
 
-        uint64_t roottable_version = readField(1, &pos);
-        if(roottable_version != 0)
+        /* Resolve Count */
+        if(slice->count == ALL_ROWS)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file root table version: %d", (int)roottable_version);
+            slice->count = ((dimension - slice->start - 1) / slice->stride) + 1;
         }
-
-        uint64_t headermsg_version = readField(1, &pos);
-        if(headermsg_version != 0)
+        else if(slice->count <= 0 || (slice->start + ((slice->count - 1) * slice->stride)) >= dimension)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file header message version: %d", (int)headermsg_version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "selection exceeds dimension %d: %ld + (%ld - 1) * %ld >= %ld", d, slice->start, slice->count, slice->stride, dimension);
         }
     }
 
-    /* Read Sizes */
-    pos = 13;
-    metaData.offsetsize = readField(1, &pos);
-    metaData.lengthsize = readField(1, &pos);
-    uint16_t leaf_k     = (uint16_t)readField(2, &pos);
-    uint16_t internal_k = (uint16_t)readField(2, &pos);
+    /* Set Row Window */
+    datasetSlabDims = metaData.ndims;
+    if(metaData.ndims > 0)
+    {
+        datasetStartRow = datasetSlab[0].start;
+        datasetNumRows = ((datasetSlab[0].count - 1) * datasetSlab[0].stride) + 1;
+    }
+}
 
-    /* Read Group Offset */
-    pos = 64;
-    uint64_t root_group_offset = readField(metaData.offsetsize, &pos);
+/*----------------------------------------------------------------------------
+ * slabIntersects
+ *
+ *  returns true if any selected index of the dimension falls in [first, last)
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::slabIntersects (int dim, uint64_t first, uint64_t last)
+{
+    const slice_t* slice = &datasetSlab[dim];
+    uint64_t start = slice->start;
+    uint64_t stride = slice->stride;
 
-    if(verbose)
+    /* First Selected Index at or after Start of Range */
+    uint64_t k = 0;
+    if(first > start)
     {
-        print2term("\n----------------\n");
-        print2term("File Information\n");
-        print2term("----------------\n");
-        print2term("Size of Offsets:                                                 %lu\n",     (unsigned long)metaData.offsetsize);
-        print2term("Size of Lengths:                                                 %lu\n",     (unsigned long)metaData.lengthsize);
-        print2term("Group Leaf Node K:                                               %lu\n",     (unsigned long)leaf_k);
-        print2term("Group Internal Node K:                                           %lu\n",     (unsigned long)internal_k);
-        print2term("Root Object Header Address:                                      0x%lX\n",   (long unsigned)root_group_offset);
+        k = ((first - start) + stride - 1) / stride;
     }
 
-    /* Return Root Group Offset */
-    return root_group_offset;
+    return (k < (uint64_t)slice->count) && ((start + (k * stride)) < last);
 }
 
 /*----------------------------------------------------------------------------
- * readFractalHeap
+ * readSlabRows
+ *
+ *  reads only the selected rows of a contiguous dataset, and only the span
+ *  of each row covering the selected columns, into their place in the row
+ *  window; reads are made through the cache so that neighboring rows share
+ *  cache lines, except for spans large enough to be read directly
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readFractalHeap (msg_type_t msg_type, uint64_t pos, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::readSlabRows (uint8_t* buffer, uint64_t row_size)
 {
-    static const int FRHP_CHECKSUM_DIRECT_BLOCKS = 0x02;
+    /* Calculate Span of Each Row Covering Selected Columns */
+    uint64_t span_offset = 0;
+    uint64_t span_size = row_size;
+    if(metaData.ndims > 1)
+    {
+        uint64_t col_size = row_size / metaData.dimensions[1];
+        span_offset = datasetSlab[1].start * col_size;
+        span_size = (((datasetSlab[1].count - 1) * datasetSlab[1].stride) + 1) * col_size;
+    }
 
-    uint64_t starting_position = pos;
+    /* Read Selected Rows */
+    for(long k = 0; k < datasetSlab[0].count; k++)
+    {
+        uint64_t window_offset = (k * datasetSlab[0].stride * row_size) + span_offset;
+        uint64_t data_addr = metaData.address + (datasetStartRow * row_size) + window_offset;
+        ioRequest(&data_addr, span_size, &buffer[window_offset], IO_CACHE_L1_LINESIZE, (int64_t)span_size < IO_DIRECT_THRESHOLD);
+    }
+}
 
-    if(!errorChecking)
+/*----------------------------------------------------------------------------
+ * selectSlab
+ *
+ *  replaces the row window in the info structure with only the selected
+ *  elements, laid out in row order
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::selectSlab (info_t* info)
+{
+    int ndims = metaData.ndims;
+    if(ndims <= 0) return;
+
+    /* Calculate Size of Each Dimension in Row Window */
+    uint64_t dimsize[MAX_NDIMS];
+    dimsize[ndims - 1] = metaData.typesize;
+    for(int d = ndims - 2; d >= 0; d--)
     {
-        pos += 5;
+        dimsize[d] = dimsize[d + 1] * metaData.dimensions[d + 1];
     }
-    else
+
+    /* Calculate Number of Selected Elements */
+    uint64_t elements = 1;
+    for(int d = 0; d < ndims; d++)
     {
-        uint32_t signature = (uint32_t)readField(4, &pos);
-        if(signature != H5_FRHP_SIGNATURE_LE)
+        elements *= datasetSlab[d].count;
+    }
+
+    /* Copy Contiguous Runs of Last Dimension */
+    int last = ndims - 1;
+    uint64_t run = (datasetSlab[last].stride == 1) ? datasetSlab[last].count : 1;
+    uint64_t run_size = run * metaData.typesize;
+    uint64_t slab_size = elements * metaData.typesize;
+    uint8_t* sbuf = new uint8_t [slab_size];
+
+    uint64_t index[MAX_NDIMS] = {0};
+    for(uint64_t si = 0; si < slab_size; si += run_size)
+    {
+        /* Calculate Offset into Row Window (rows are relative to window start) */
+        uint64_t offset = index[0] * datasetSlab[0].stride * dimsize[0];
+        for(int d = 1; d < ndims; d++)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid heap signature: 0x%llX", (unsigned long long)signature);
+            offset += (datasetSlab[d].start + (index[d] * datasetSlab[d].stride)) * dimsize[d];
         }
 
-        uint8_t version = (uint8_t)readField(1, &pos);
-        if(version != 0)
+        LocalLib::copy(&sbuf[si], &info->data[offset], run_size);
+
+        /* Advance Indices */
+        index[last] += run;
+        for(int d = last; d > 0 && index[d] >= (uint64_t)datasetSlab[d].count; d--)
+        {
+            index[d] = 0;
+            index[d - 1]++;
+        }
+    }
+
+    /* Replace Buffer */
+    delete [] info->data;
+    info->data      = sbuf;
+    info->datasize  = slab_size;
+    info->elements  = elements;
+    info->numrows   = datasetSlab[0].count;
+    info->numcols   = (ndims > 1) ? datasetSlab[1].count : 1;
+}
+
+/*----------------------------------------------------------------------------
+ * readSuperblock
+ *----------------------------------------------------------------------------*/
+uint64_t H5FileBuffer::readSuperblock (void)
+{
+    uint64_t pos = 0;
+
+    /* Read and Verify Superblock Info */
+    if(errorChecking)
+    {
+        uint64_t signature = readField(8, &pos);
+        if(signature != H5_SIGNATURE_LE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file signature: 0x%llX", (unsigned long long)signature);
+        }
+    }
+
+    /* Read Superblock Version */
+    pos = 8;
+    uint64_t superblock_version = readField(1, &pos);
+
+    /* Read Version 2 and 3 Superblocks (written by newer libraries) */
+    if(superblock_version == 2 || superblock_version == 3)
+    {
+        metaData.offsetsize = readField(1, &pos);
+        metaData.lengthsize = readField(1, &pos);
+        pos += 1; // file consistency flags
+        pos += metaData.offsetsize; // base address
+        uint64_t extension_offset = readField(metaData.offsetsize, &pos);
+        pos += metaData.offsetsize; // end of file address
+        uint64_t root_group_offset = readField(metaData.offsetsize, &pos);
+
+        if(verbose)
+        {
+            print2term("\n----------------\n");
+            print2term("File Information\n");
+            print2term("----------------\n");
+            print2term("Superblock Version:                                              %lu\n",     (unsigned long)superblock_version);
+            print2term("Size of Offsets:                                                 %lu\n",     (unsigned long)metaData.offsetsize);
+            print2term("Size of Lengths:                                                 %lu\n",     (unsigned long)metaData.lengthsize);
+            print2term("Superblock Extension Address:                                    0x%lX\n",   (long unsigned)extension_offset);
+            print2term("Root Object Header Address:                                      0x%lX\n",   (long unsigned)root_group_offset);
+        }
+
+        /* Read Superblock Extension (holds the file space page size) */
+        if(!H5_INVALID(extension_offset))
+        {
+            readObjHdr(extension_offset, 0);
+        }
+
+        return root_group_offset;
+    }
+
+    if(errorChecking)
+    {
+        if(superblock_version != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file superblock version: %d", (int)superblock_version);
+        }
+
+        uint64_t freespace_version = readField(1, &pos);
+        if(freespace_version != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file free space version: %d", (int)freespace_version);
+        }
+
+        uint64_t roottable_version = readField(1, &pos);
+        if(roottable_version != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file root table version: %d", (int)roottable_version);
+        }
+
+        uint64_t headermsg_version = readField(1, &pos);
+        if(headermsg_version != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid h5 file header message version: %d", (int)headermsg_version);
+        }
+    }
+
+    /* Read Sizes */
+    pos = 13;
+    metaData.offsetsize = readField(1, &pos);
+    metaData.lengthsize = readField(1, &pos);
+    uint16_t leaf_k     = (uint16_t)readField(2, &pos);
+    uint16_t internal_k = (uint16_t)readField(2, &pos);
+
+    /* Read Group Offset */
+    pos = 64;
+    uint64_t root_group_offset = readField(metaData.offsetsize, &pos);
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("File Information\n");
+        print2term("----------------\n");
+        print2term("Size of Offsets:                                                 %lu\n",     (unsigned long)metaData.offsetsize);
+        print2term("Size of Lengths:                                                 %lu\n",     (unsigned long)metaData.lengthsize);
+        print2term("Group Leaf Node K:                                               %lu\n",     (unsigned long)leaf_k);
+        print2term("Group Internal Node K:                                           %lu\n",     (unsigned long)internal_k);
+        print2term("Root Object Header Address:                                      0x%lX\n",   (long unsigned)root_group_offset);
+    }
+
+    /* Return Root Group Offset */
+    return root_group_offset;
+}
+
+/*----------------------------------------------------------------------------
+ * readFractalHeap
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readFractalHeap (msg_type_t msg_type, uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    static const int FRHP_CHECKSUM_DIRECT_BLOCKS = 0x02;
+
+    uint64_t starting_position = pos;
+
+    if(!errorChecking)
+    {
+        pos += 5;
+    }
+    else
+    {
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_FRHP_SIGNATURE_LE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid heap signature: 0x%llX", (unsigned long long)signature);
+        }
+
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 0)
         {
             throw RunTimeException(CRITICAL, RTE_ERROR, "invalid heap version: %d", (int)version);
         }
@@ -1334,12 +2664,13 @@ int H5FileBuffer::readIndirectBlock (heap_info_t* heap_info, int block_size, uin
 
 /*----------------------------------------------------------------------------
  * readBTreeV1
+ *
+ *  walks the entire chunk b-tree and appends each chunk to the list in key
+ *  order, which sorts the chunks by their offset in the first dimension
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readBTreeV1 (uint64_t pos, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset)
+int H5FileBuffer::readBTreeV1 (uint64_t pos, List<chunk_entry_t>* chunks)
 {
     uint64_t starting_position = pos;
-    uint64_t data_key1 = datasetStartRow;
-    uint64_t data_key2 = datasetStartRow + datasetNumRows - 1;
 
     /* Check Signature and Node Type */
     if(!errorChecking)
@@ -1389,154 +2720,33 @@ int H5FileBuffer::readBTreeV1 (uint64_t pos, uint8_t* buffer, uint64_t buffer_si
         /* Read Next Key */
         btree_node_t next_node = readBTreeNodeV1(metaData.ndims, &pos);
 
-        /*  Get Child Keys */
-        uint64_t child_key1 = curr_node.row_key;
-        uint64_t child_key2 = next_node.row_key; // there is always +1 keys
-        if(next_node.chunk_size == 0 && metaData.ndims > 0)
-        {
-            child_key2 = metaData.dimensions[0];
-        }
-
         /* Display */
         if(verbose && H5_EXTRA_DEBUG)
         {
             print2term("\nEntry:                                                           %d[%d]\n", (int)node_level, e);
             print2term("Chunk Size:                                                      %u | %u\n", (unsigned int)curr_node.chunk_size, (unsigned int)next_node.chunk_size);
             print2term("Filter Mask:                                                     0x%x | 0x%x\n", (unsigned int)curr_node.filter_mask, (unsigned int)next_node.filter_mask);
-            print2term("Chunk Key:                                                       %lu | %lu\n", (unsigned long)child_key1, (unsigned long)child_key2);
-            print2term("Data Key:                                                        %lu | %lu\n", (unsigned long)data_key1, (unsigned long)data_key2);
+            print2term("Chunk Key:                                                       %lu | %lu\n", (unsigned long)curr_node.row_key, (unsigned long)next_node.row_key);
             print2term("Slice:                                                           ");
             for(int s = 0; s < metaData.ndims; s++) print2term("%lu ", (unsigned long)curr_node.slice[s]);
             print2term("\n");
             print2term("Child Address:                                                   0x%lx\n", (unsigned long)child_addr);
         }
 
-        /* Check Inclusion */
-        if ((data_key1  >= child_key1 && data_key1  <  child_key2) ||
-            (data_key2  >= child_key1 && data_key2  <  child_key2) ||
-            (child_key1 >= data_key1  && child_key1 <= data_key2)  ||
-            (child_key2 >  data_key1  && child_key2 <  data_key2))
+        /* Process Child Entry */
+        if(node_level > 0)
         {
-            /* Process Child Entry */
-            if(node_level > 0)
-            {
-                readBTreeV1(child_addr, buffer, buffer_size, buffer_offset);
-            }
-            else
-            {
-                /* Calculate Chunk Location */
-                uint64_t chunk_offset = 0;
-                for(int i = 0; i < metaData.ndims; i++)
-                {
-                    uint64_t slice_size = curr_node.slice[i] * metaData.typesize;
-                    for(int k = 0; k < i; k++)
-                    {
-                        slice_size *= metaData.chunkdims[k];
-                    }
-                    for(int j = i + 1; j < metaData.ndims; j++)
-                    {
-                        slice_size *= metaData.dimensions[j];
-                    }
-                    chunk_offset += slice_size;
-                }
-
-                /* Calculate Buffer Index - offset into data buffer to put chunked data */
-                uint64_t buffer_index = 0;
-                if(chunk_offset > buffer_offset)
-                {
-                    buffer_index = chunk_offset - buffer_offset;
-                    if(buffer_index >= buffer_size)
-                    {
-                        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid location to read data: %ld, %lu", (unsigned long)chunk_offset, (unsigned long)buffer_offset);
-                    }
-                }
-
-                /* Calculate Chunk Index - offset into chunk buffer to read from */
-                uint64_t chunk_index = 0;
-                if(buffer_offset > chunk_offset)
-                {
-                    chunk_index = buffer_offset - chunk_offset;
-                    if((int64_t)chunk_index >= dataChunkBufferSize)
-                    {
-                        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid location to read chunk: %ld, %lu", (unsigned long)chunk_offset, (unsigned long)buffer_offset);
-                    }
-                }
-
-                /* Calculate Chunk Bytes - number of bytes to read from chunk buffer */
-                int64_t chunk_bytes = dataChunkBufferSize - chunk_index;
-                if(chunk_bytes < 0)
-                {
-                    throw RunTimeException(CRITICAL, RTE_ERROR, "no bytes of chunk data to read: %ld, %lu", (long)chunk_bytes, (unsigned long)chunk_index);
-                }
-                else if((buffer_index + chunk_bytes) > buffer_size)
-                {
-                    chunk_bytes = buffer_size - buffer_index;
-                }
-
-                /* Display Info */
-                if(verbose && H5_EXTRA_DEBUG)
-                {
-                    print2term("Chunk Offset:                                                    %ld (%ld)\n", (unsigned long)chunk_offset, (unsigned long)(chunk_offset/metaData.typesize));
-                    print2term("Buffer Index:                                                    %ld (%ld)\n", (unsigned long)buffer_index, (unsigned long)(buffer_index/metaData.typesize));
-                    print2term("Buffer Bytes:                                                    %ld (%ld)\n", (unsigned long)chunk_bytes, (unsigned long)(chunk_bytes/metaData.typesize));
-                }
-
-                /* Read Chunk */
-                if(metaData.filter[DEFLATE_FILTER])
-                {
-                    /* Check Current Node Chunk Size */
-                    if(curr_node.chunk_size > (dataChunkBufferSize * FILTER_SIZE_SCALE))
-                    {
-                        throw RunTimeException(CRITICAL, RTE_ERROR, "Compressed chunk size exceeds buffer: %u > %lu", curr_node.chunk_size, (unsigned long)dataChunkBufferSize);
-                    }
-
-                    /* Read Data into Chunk Filter Buffer (holds the compressed data) */
-                    ioRequest(&child_addr, curr_node.chunk_size, dataChunkFilterBuffer, dataSizeHint, true);
-                    if((chunk_bytes == dataChunkBufferSize) && (!metaData.filter[SHUFFLE_FILTER]))
-                    {
-                        /* Inflate Directly into Data Buffer */
-                        inflateChunk(dataChunkFilterBuffer, curr_node.chunk_size, &buffer[buffer_index], chunk_bytes);
-                    }
-                    else
-                    {
-                        /* Inflate into Data Chunk Buffer */
-                        inflateChunk(dataChunkFilterBuffer, curr_node.chunk_size, dataChunkBuffer, dataChunkBufferSize);
-
-                        if(metaData.filter[SHUFFLE_FILTER])
-                        {
-                            /* Shuffle Data Chunk Buffer into Data Buffer */
-                            shuffleChunk(dataChunkBuffer, dataChunkBufferSize, &buffer[buffer_index], chunk_index, chunk_bytes, metaData.typesize);
-                        }
-                        else
-                        {
-                            /* Copy Data Chunk Buffer into Data Buffer */
-                            LocalLib::copy(&buffer[buffer_index], &dataChunkBuffer[chunk_index], chunk_bytes);
-                        }
-                    }
-
-                    /* Handle Caching */
-                    dataSizeHint = IO_CACHE_L1_LINESIZE;
-                }
-                else /* no supported filters */
-                {
-                    if(errorChecking)
-                    {
-                        if(metaData.filter[SHUFFLE_FILTER])
-                        {
-                            throw RunTimeException(CRITICAL, RTE_ERROR, "shuffle filter unsupported on uncompressed chunk");
-                        }
-                        else if(dataChunkBufferSize != curr_node.chunk_size)
-                        {
-                            throw RunTimeException(CRITICAL, RTE_ERROR, "mismatch in chunk size: %lu, %lu", (unsigned long)curr_node.chunk_size, (unsigned long)dataChunkBufferSize);
-                        }
-                    }
-
-                    /* Read Data into Data Buffer */
-                    uint64_t chunk_offset_addr = child_addr + chunk_index;
-                    ioRequest(&chunk_offset_addr, chunk_bytes, &buffer[buffer_index], dataSizeHint, true);
-                    dataSizeHint = IO_CACHE_L1_LINESIZE;
-                }
-            }
+            readBTreeV1(child_addr, chunks);
+        }
+        else
+        {
+            chunk_entry_t chunk;
+            LocalLib::set(chunk.slice, 0, sizeof(chunk.slice));
+            for(int d = 0; d < metaData.ndims; d++) chunk.slice[d] = curr_node.slice[d];
+            chunk.address = child_addr;
+            chunk.chunk_size = curr_node.chunk_size;
+            chunk.filter_mask = curr_node.filter_mask;
+            chunks->add(chunk);
         }
 
         /* Goto Next Key */
@@ -1547,758 +2757,1055 @@ int H5FileBuffer::readBTreeV1 (uint64_t pos, uint8_t* buffer, uint64_t buffer_si
 }
 
 /*----------------------------------------------------------------------------
- * readBTreeNodeV1
+ * readChunkIndex
+ *
+ *  reads every allocated chunk of the dataset from whichever index the data
+ *  layout message described
  *----------------------------------------------------------------------------*/
-H5FileBuffer::btree_node_t H5FileBuffer::readBTreeNodeV1 (int ndims, uint64_t* pos)
+void H5FileBuffer::readChunkIndex (List<chunk_entry_t>* chunks)
 {
-    btree_node_t node;
-
-    /* Read Key */
-    node.chunk_size = (uint32_t)readField(4, pos);
-    node.filter_mask = (uint32_t)readField(4, pos);
-    for(int d = 0; d < ndims; d++)
+    switch(metaData.chunkindex)
     {
-        node.slice[d] = readField(8, pos);
-    }
+        case BTREE_V1_INDEX:
+        {
+            readBTreeV1(metaData.address, chunks);
+            break;
+        }
 
-    /* Read Trailing Zero */
-    uint64_t trailing_zero = readField(8, pos);
-    if(errorChecking)
-    {
-        if(trailing_zero % metaData.typesize != 0)
+        case SINGLE_CHUNK_INDEX:
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "key did not include a trailing zero: %lu", trailing_zero);
+            chunk_entry_t chunk;
+            LocalLib::set(&chunk, 0, sizeof(chunk));
+            chunk.address = metaData.address;
+            chunk.chunk_size = (metaData.singlesize > 0) ? metaData.singlesize : (metaData.chunkelements * metaData.elementsize);
+            chunk.filter_mask = metaData.singlemask;
+            if(!H5_INVALID(chunk.address)) chunks->add(chunk);
+            break;
         }
-        else if(verbose && H5_EXTRA_DEBUG)
+
+        case IMPLICIT_INDEX:
         {
-            print2term("Trailing Zero:                                                   %d\n", (int)trailing_zero);
+            /* Chunks are Allocated Back to Back in Linear Order */
+            uint64_t chunk_size = metaData.chunkelements * metaData.elementsize;
+            uint64_t num_chunks = 1;
+            for(int d = 0; d < metaData.ndims; d++)
+            {
+                num_chunks *= (metaData.maxdims[d] + metaData.chunkdims[d] - 1) / metaData.chunkdims[d];
+            }
+
+            for(uint64_t idx = 0; idx < num_chunks; idx++)
+            {
+                chunk_entry_t chunk;
+                LocalLib::set(&chunk, 0, sizeof(chunk));
+                chunk.address = metaData.address + (idx * chunk_size);
+                chunk.chunk_size = chunk_size;
+                if(chunkSlice(idx, -1, chunk.slice)) chunks->add(chunk);
+            }
+            break;
         }
-    }
 
-    /* Set Node Key */
-    if(ndims > 0)   node.row_key = node.slice[0];
-    else            node.row_key = 0;
+        case FIXED_ARRAY_INDEX:
+        {
+            readFixedArray(metaData.address, chunks);
+            break;
+        }
 
-    /* Return Copy of Node */
-    return node;
+        case EXTENSIBLE_ARRAY_INDEX:
+        {
+            readExtensibleArray(metaData.address, chunks);
+            break;
+        }
+
+        case BTREE_V2_INDEX:
+        {
+            readBTreeV2(metaData.address, chunks);
+            break;
+        }
+
+        default:
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported chunk index type: %d", (int)metaData.chunkindex);
+        }
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readSymbolTable
+ * readFixedArray
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readSymbolTable (uint64_t pos, uint64_t heap_data_addr, int dlvl)
+void H5FileBuffer::readFixedArray (uint64_t pos, List<chunk_entry_t>* chunks)
 {
     uint64_t starting_position = pos;
 
     /* Check Signature and Version */
     if(!errorChecking)
     {
-        pos += 6;
+        pos += 5;
     }
     else
     {
         uint32_t signature = (uint32_t)readField(4, &pos);
-        if(signature != H5_SNOD_SIGNATURE_LE)
+        if(signature != H5_FAHD_SIGNATURE_LE)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid symbol table signature: 0x%llX", (unsigned long long)signature);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid fixed array header signature: 0x%llX", (unsigned long long)signature);
         }
 
         uint8_t version = (uint8_t)readField(1, &pos);
-        if(version != 1)
+        if(version != 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect version of symbole table: %d", (int)version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid fixed array header version: %d", (int)version);
         }
+    }
 
-        uint8_t reserved0 = (uint8_t)readField(1, &pos);
-        if(reserved0 != 0)
+    /* Read Header */
+    array_info_t array;
+    array.filtered      = (readField(1, &pos) == 1); // client id
+    array.entry_size    = (int)readField(1, &pos);
+    int page_bits       = (int)readField(1, &pos);
+    uint64_t max_entries= readField(metaData.lengthsize, &pos);
+    uint64_t dblk_addr  = readField(metaData.offsetsize, &pos);
+    array.unlimited     = -1;
+    array.arr_off_size  = 0;
+    array.page_nelmts   = 1LLU << page_bits;
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Fixed Array: 0x%lx\n", (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Filtered:                                                        %d\n", (int)array.filtered);
+        print2term("Entry Size:                                                      %d\n", array.entry_size);
+        print2term("Page Bits:                                                       %d\n", page_bits);
+        print2term("Maximum Entries:                                                 %lu\n", (unsigned long)max_entries);
+        print2term("Data Block Address:                                              0x%lx\n", (unsigned long)dblk_addr);
+    }
+
+    if(H5_INVALID(dblk_addr)) return; // no chunks allocated
+
+    /* Check Data Block Signature */
+    pos = dblk_addr;
+    if(errorChecking)
+    {
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_FADB_SIGNATURE_LE)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect reserved value: %d", (int)reserved0);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid fixed array data block signature: 0x%llX", (unsigned long long)signature);
         }
     }
+    pos = dblk_addr + 6 + metaData.offsetsize; // signature, version, client id, header address
 
-    /* Read Symbols */
-    uint16_t num_symbols = (uint16_t)readField(2, &pos);
-    for(int s = 0; s < num_symbols; s++)
+    /* Read Entries */
+    if(max_entries <= array.page_nelmts)
     {
-        /* Read Symbol Entry */
-        uint64_t link_name_offset = readField(metaData.offsetsize, &pos);
-        uint64_t obj_hdr_addr = readField(metaData.offsetsize, &pos);
-        uint32_t cache_type = (uint32_t)readField(4, &pos);
-        pos += 20; // reserved + scratch pad
-        if(errorChecking)
+        for(uint64_t idx = 0; idx < max_entries; idx++)
         {
-            if(cache_type == 2)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "symbolic links are unsupported");
-            }
+            readChunkElement(&pos, idx, &array, chunks);
         }
-
-        /* Read Link Name */
-        uint64_t link_name_addr = heap_data_addr + link_name_offset;
-        uint8_t link_name[STR_BUFF_SIZE];
-        int i = 0;
-        while(true)
+    }
+    else
+    {
+        /* Read Bitmap of Initialized Pages */
+        uint64_t num_pages = (max_entries + array.page_nelmts - 1) / array.page_nelmts;
+        uint64_t bitmap_size = (num_pages + 7) / 8;
+        uint8_t* page_init = new uint8_t [bitmap_size];
+        try
         {
-            if(i >= STR_BUFF_SIZE)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "link name string exceeded maximum length: %d, 0x%lx\n", i, (unsigned long)pos);
-            }
+            readByteArray(page_init, bitmap_size, &pos);
+            pos += 4; // checksum of data block prefix
 
-            uint8_t c = (uint8_t)readField(1, &link_name_addr);
-            link_name[i++] = c;
-
-            if(c == 0)
+            /* Read Entries of Each Initialized Page */
+            uint64_t page_size = (array.page_nelmts * array.entry_size) + 4; // entries and checksum
+            for(uint64_t p = 0; p < num_pages; p++)
             {
-                break;
+                if(page_init[p / 8] & (0x80 >> (p % 8)))
+                {
+                    uint64_t page_pos = pos + (p * page_size);
+                    uint64_t last = MIN((p + 1) * array.page_nelmts, max_entries);
+                    for(uint64_t idx = p * array.page_nelmts; idx < last; idx++)
+                    {
+                        readChunkElement(&page_pos, idx, &array, chunks);
+                    }
+                }
             }
         }
-        link_name[i] = '\0';
-        if(verbose)
-        {
-            print2term("Link Name:                                                       %s\n", link_name);
-            print2term("Object Header Address:                                           0x%lx\n", obj_hdr_addr);
-        }
-
-        /* Process Link */
-        if(dlvl < datasetPath.length())
+        catch(const RunTimeException&)
         {
-            if(StringLib::match((const char*)link_name, datasetPath[dlvl]))
-            {
-                highestDataLevel = dlvl + 1;
-                readObjHdr(obj_hdr_addr, highestDataLevel);
-                break; // dataset found
-            }
+            delete [] page_init;
+            throw;
         }
+        delete [] page_init;
     }
-
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
 }
 
 /*----------------------------------------------------------------------------
- * readObjHdr
+ * readExtensibleArray
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readObjHdr (uint64_t pos, int dlvl)
+void H5FileBuffer::readExtensibleArray (uint64_t pos, List<chunk_entry_t>* chunks)
 {
     uint64_t starting_position = pos;
 
-    /* Peek at Version / Process Version 1 */
-    uint64_t peeking_position = pos;
-    uint8_t peek = readField(1, &peeking_position);
-    if(peek == 1) return readObjHdrV1(starting_position, dlvl);
-
-    /* Read Object Header */
+    /* Check Signature and Version */
     if(!errorChecking)
     {
-        pos += 5; // move past signature and version
+        pos += 5;
     }
     else
     {
-        uint64_t signature = readField(4, &pos);
-        if(signature != H5_OHDR_SIGNATURE_LE)
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_EAHD_SIGNATURE_LE)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header signature: 0x%llX", (unsigned long long)signature);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array header signature: 0x%llX", (unsigned long long)signature);
         }
 
-        uint64_t version = readField(1, &pos);
-        if(version != 2)
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header version: %d", (int)version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array header version: %d", (int)version);
         }
     }
 
-    /* Read Option Time Fields */
-    uint8_t obj_hdr_flags = (uint8_t)readField(1, &pos);
-    if(obj_hdr_flags & FILE_STATS_BIT)
+    /* Read Header */
+    array_info_t array;
+    array.filtered          = (readField(1, &pos) == 1); // client id
+    array.entry_size        = (int)readField(1, &pos);
+    int max_nelmts_bits     = (int)readField(1, &pos);
+    uint64_t iblk_elmts     = readField(1, &pos);
+    uint64_t dblk_min_elmts = readField(1, &pos);
+    uint64_t sblk_min_ptrs  = readField(1, &pos);
+    int dblk_page_bits      = (int)readField(1, &pos);
+    pos += metaData.lengthsize * 4; // super block and data block statistics
+    uint64_t max_idx_set    = readField(metaData.lengthsize, &pos);
+    pos += metaData.lengthsize; // number of elements realized
+    uint64_t iblk_addr      = readField(metaData.offsetsize, &pos);
+    array.arr_off_size      = (max_nelmts_bits + 7) / 8;
+    array.page_nelmts       = 1LLU << dblk_page_bits;
+
+    /* Unlimited Dimension Varies Slowest in Linear Chunk Index */
+    array.unlimited = 0;
+    for(int d = 0; d < metaData.ndims; d++)
     {
-        if(!verbose)
+        if(H5_INVALID(metaData.maxdims[d]))
         {
-            pos += 16; // move past time fields
+            array.unlimited = d;
+            break;
         }
-        else
-        {
-            uint64_t access_time         = readField(4, &pos);
-            uint64_t modification_time   = readField(4, &pos);
-            uint64_t change_time         = readField(4, &pos);
-            uint64_t birth_time          = readField(4, &pos);
+    }
 
-            print2term("\n----------------\n");
-            print2term("Object Information [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-            print2term("----------------\n");
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Extensible Array: 0x%lx\n", (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Filtered:                                                        %d\n", (int)array.filtered);
+        print2term("Entry Size:                                                      %d\n", array.entry_size);
+        print2term("Index Block Elements:                                            %lu\n", (unsigned long)iblk_elmts);
+        print2term("Data Block Minimum Elements:                                     %lu\n", (unsigned long)dblk_min_elmts);
+        print2term("Maximum Index Set:                                               %lu\n", (unsigned long)max_idx_set);
+        print2term("Index Block Address:                                             0x%lx\n", (unsigned long)iblk_addr);
+    }
 
-            TimeLib::gmt_time_t access_gmt = TimeLib::gettime(access_time * TIME_MILLISECS_IN_A_SECOND);
-            print2term("Access Time:                                                     %d:%d:%d:%d:%d\n", access_gmt.year, access_gmt.doy, access_gmt.hour, access_gmt.minute, access_gmt.second);
+    if(H5_INVALID(iblk_addr) || max_idx_set == 0) return; // no chunks allocated
 
-            TimeLib::gmt_time_t modification_gmt = TimeLib::gettime(modification_time * TIME_MILLISECS_IN_A_SECOND);
-            print2term("Modification Time:                                               %d:%d:%d:%d:%d\n", modification_gmt.year, modification_gmt.doy, modification_gmt.hour, modification_gmt.minute, modification_gmt.second);
+    if(dblk_min_elmts == 0 || sblk_min_ptrs == 0)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array parameters: %lu, %lu", (unsigned long)dblk_min_elmts, (unsigned long)sblk_min_ptrs);
+    }
 
-            TimeLib::gmt_time_t change_gmt = TimeLib::gettime(change_time * TIME_MILLISECS_IN_A_SECOND);
-            print2term("Change Time:                                                     %d:%d:%d:%d:%d\n", change_gmt.year, change_gmt.doy, change_gmt.hour, change_gmt.minute, change_gmt.second);
+    /* Calculate Layout of Super Blocks
+     *  super block u holds 2^floor(u/2) data blocks of 2^floor((u+1)/2) * dblk_min_elmts
+     *  elements; the data blocks of the first super blocks are addressed directly from
+     *  the index block */
+    int nsblks = 1 + (max_nelmts_bits - highestBit(dblk_min_elmts));
+    int iblk_nsblks = 2 * highestBit(sblk_min_ptrs);
+    uint64_t iblk_ndblks = 2 * (sblk_min_ptrs - 1);
 
-            TimeLib::gmt_time_t birth_gmt = TimeLib::gettime(birth_time * TIME_MILLISECS_IN_A_SECOND);
-            print2term("Birth Time:                                                      %d:%d:%d:%d:%d\n", birth_gmt.year, birth_gmt.doy, birth_gmt.hour, birth_gmt.minute, birth_gmt.second);
+    /* Check Index Block Signature */
+    pos = iblk_addr;
+    if(errorChecking)
+    {
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_EAIB_SIGNATURE_LE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array index block signature: 0x%llX", (unsigned long long)signature);
         }
     }
+    pos = iblk_addr + 6 + metaData.offsetsize; // signature, version, client id, header address
 
-    /* Optional Phase Attributes */
-    if(obj_hdr_flags & STORE_CHANGE_PHASE_BIT)
+    /* Read Elements of Index Block */
+    uint64_t dblk_addrs_pos = pos + (iblk_elmts * array.entry_size);
+    uint64_t sblk_addrs_pos = dblk_addrs_pos + (iblk_ndblks * metaData.offsetsize);
+    for(uint64_t idx = 0; idx < iblk_elmts && idx < max_idx_set; idx++)
     {
-        if(!verbose)
+        readChunkElement(&pos, idx, &array, chunks);
+    }
+
+    /* Read Data Blocks of Each Super Block */
+    uint64_t idx = iblk_elmts;
+    for(int u = 0; u < nsblks && idx < max_idx_set; u++)
+    {
+        uint64_t ndblks = 1LLU << (u / 2);
+        uint64_t dblk_nelmts = (1LLU << ((u + 1) / 2)) * dblk_min_elmts;
+
+        if(u < iblk_nsblks)
         {
-            pos += 4; // move past phase attributes
+            /* Data Blocks Addressed from Index Block */
+            for(uint64_t b = 0; b < ndblks && idx < max_idx_set; b++)
+            {
+                uint64_t dblk_addr = readField(metaData.offsetsize, &dblk_addrs_pos);
+                if(!H5_INVALID(dblk_addr))
+                {
+                    readEADataBlock(dblk_addr, idx, dblk_nelmts, &array, NULL, 0, chunks);
+                }
+                idx += dblk_nelmts;
+            }
         }
         else
         {
-            uint64_t max_compact_attr = readField(2, &pos); (void)max_compact_attr;
-            uint64_t max_dense_attr = readField(2, &pos); (void)max_dense_attr;
-        }
-    }
+            /* Data Blocks Addressed from Super Block */
+            uint64_t sblk_addr = readField(metaData.offsetsize, &sblk_addrs_pos);
+            if(H5_INVALID(sblk_addr))
+            {
+                idx += ndblks * dblk_nelmts;
+                continue;
+            }
 
-    /* Read Header Messages */
-    uint64_t size_of_chunk0 = readField(1 << (obj_hdr_flags & SIZE_OF_CHUNK_0_MASK), &pos);
-    uint64_t end_of_hdr = pos + size_of_chunk0;
-    pos += readMessages (pos, end_of_hdr, obj_hdr_flags, dlvl);
+            uint64_t sblk_pos = sblk_addr;
+            if(errorChecking)
+            {
+                uint32_t signature = (uint32_t)readField(4, &sblk_pos);
+                if(signature != H5_EASB_SIGNATURE_LE)
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array super block signature: 0x%llX", (unsigned long long)signature);
+                }
+            }
+            sblk_pos = sblk_addr + 6 + metaData.offsetsize + array.arr_off_size; // signature, version, client id, header address, block offset
 
-    /* Verify Checksum */
-    uint64_t check_sum = readField(4, &pos);
-    if(errorChecking)
-    {
-        (void)check_sum;
-    }
+            /* Read Bitmap of Initialized Data Block Pages */
+            uint64_t dblk_npages = (dblk_nelmts > array.page_nelmts) ? (dblk_nelmts / array.page_nelmts) : 0;
+            uint8_t* page_init = NULL;
+            try
+            {
+                if(dblk_npages > 0)
+                {
+                    uint64_t bitmap_size = ((ndblks * dblk_npages) + 7) / 8;
+                    page_init = new uint8_t [bitmap_size];
+                    readByteArray(page_init, bitmap_size, &sblk_pos);
+                }
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+                for(uint64_t b = 0; b < ndblks && idx < max_idx_set; b++)
+                {
+                    uint64_t dblk_addr = readField(metaData.offsetsize, &sblk_pos);
+                    if(!H5_INVALID(dblk_addr))
+                    {
+                        readEADataBlock(dblk_addr, idx, dblk_nelmts, &array, page_init, b * dblk_npages, chunks);
+                    }
+                    idx += dblk_nelmts;
+                }
+            }
+            catch(const RunTimeException&)
+            {
+                if(page_init) delete [] page_init;
+                throw;
+            }
+            if(page_init) delete [] page_init;
+        }
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readMessages
+ * readEADataBlock
+ *
+ *  reads the elements of an extensible array data block starting at linear
+ *  chunk index idx; pages not set in the page bitmap were never written
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readMessages (uint64_t pos, uint64_t end, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::readEADataBlock (uint64_t pos, uint64_t idx, uint64_t nelmts, const array_info_t* array, const uint8_t* page_init, uint64_t page_bit, List<chunk_entry_t>* chunks)
 {
     uint64_t starting_position = pos;
 
-    while(pos < end)
+    /* Check Signature */
+    if(errorChecking)
     {
-        /* Read Message Info */
-        uint8_t     msg_type    = (uint8_t)readField(1, &pos);
-        uint16_t    msg_size    = (uint16_t)readField(2, &pos);
-        uint8_t     msg_flags   = (uint8_t)readField(1, &pos); (void)msg_flags;
-
-        if(hdr_flags & ATTR_CREATION_TRACK_BIT)
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_EADB_SIGNATURE_LE)
         {
-            uint64_t msg_order = (uint8_t)readField(2, &pos); (void)msg_order;
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid extensible array data block signature: 0x%llX", (unsigned long long)signature);
         }
+    }
+    pos = starting_position + 6 + metaData.offsetsize + array->arr_off_size; // signature, version, client id, header address, block offset
 
-        /* Read Each Message */
-        int bytes_read = readMessage((msg_type_t)msg_type, msg_size, pos, hdr_flags, dlvl);
-        if(errorChecking && (bytes_read != msg_size))
+    /* Read Elements */
+    if(nelmts <= array->page_nelmts)
+    {
+        for(uint64_t e = 0; e < nelmts; e++)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "header message different size than specified: %d != %d", bytes_read, msg_size);
+            readChunkElement(&pos, idx + e, array, chunks);
         }
-
-        /* Check if Dataset Found */
-        if(highestDataLevel > dlvl)
+    }
+    else
+    {
+        pos += 4; // checksum of data block prefix
+        uint64_t npages = nelmts / array->page_nelmts;
+        uint64_t page_size = (array->page_nelmts * array->entry_size) + 4; // elements and checksum
+        for(uint64_t p = 0; p < npages; p++)
         {
-            pos = end; // go directly to end of header
-            break; // dataset found
-        }
+            uint64_t bit = page_bit + p;
+            if(page_init && !(page_init[bit / 8] & (0x80 >> (bit % 8))))
+            {
+                continue;
+            }
 
-        /* Update Position */
-        pos += bytes_read;
+            uint64_t page_pos = pos + (p * page_size);
+            for(uint64_t e = 0; e < array->page_nelmts; e++)
+            {
+                readChunkElement(&page_pos, idx + (p * array->page_nelmts) + e, array, chunks);
+            }
+        }
     }
+}
 
-    /* Check Size */
-    if(errorChecking)
+/*----------------------------------------------------------------------------
+ * readChunkElement
+ *
+ *  reads one fixed or extensible array element and adds the chunk it
+ *  addresses, if allocated, to the list
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::readChunkElement (uint64_t* pos, uint64_t idx, const array_info_t* array, List<chunk_entry_t>* chunks)
+{
+    chunk_entry_t chunk;
+    LocalLib::set(&chunk, 0, sizeof(chunk));
+
+    chunk.address = readField(metaData.offsetsize, pos);
+    if(array->filtered)
     {
-        if(pos != end)
+        int size_len = array->entry_size - metaData.offsetsize - 4;
+        if(size_len < 1 || size_len > 8)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "did not read correct number of bytes: %lu != %lu", (unsigned long)pos, (unsigned long)end);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid chunk array entry size: %d", array->entry_size);
         }
+        chunk.chunk_size = (uint32_t)readField(size_len, pos);
+        chunk.filter_mask = (uint32_t)readField(4, pos);
+    }
+    else
+    {
+        chunk.chunk_size = metaData.chunkelements * metaData.elementsize;
     }
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+    if(!H5_INVALID(chunk.address) && chunkSlice(idx, array->unlimited, chunk.slice))
+    {
+        chunks->add(chunk);
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readObjHdrV1
+ * readBTreeV2
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readObjHdrV1 (uint64_t pos, int dlvl)
+void H5FileBuffer::readBTreeV2 (uint64_t pos, List<chunk_entry_t>* chunks)
 {
+    static const int CHUNK_RECORD_TYPE          = 10;
+    static const int FILTERED_CHUNK_RECORD_TYPE = 11;
+    static const int NODE_PREFIX_SIZE           = 10; // signature, version, type, checksum
+
     uint64_t starting_position = pos;
 
-    /* Read Version */
+    /* Check Signature and Version */
     if(!errorChecking)
     {
-        pos += 2;
+        pos += 5;
     }
     else
     {
-        uint8_t version = (uint8_t)readField(1, &pos);
-        if(version != 1)
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_BTHD_SIGNATURE_LE)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header version: %d", (int)version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid b-tree v2 header signature: 0x%llX", (unsigned long long)signature);
         }
 
-        uint8_t reserved0 = (uint8_t)readField(1, &pos);
-        if(reserved0 != 0)
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved field: %d", (int)reserved0);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid b-tree v2 header version: %d", (int)version);
         }
     }
 
-    /* Read Number of Header Messages */
-    if(!verbose)
-    {
-        pos += 2;
-    }
-    else
+    /* Read Header */
+    int type            = (int)readField(1, &pos);
+    uint32_t node_size  = (uint32_t)readField(4, &pos);
+    int record_size     = (int)readField(2, &pos);
+    int depth           = (int)readField(2, &pos);
+    pos += 2; // split and merge percents
+    uint64_t root_addr  = readField(metaData.offsetsize, &pos);
+    uint64_t root_nrec  = readField(2, &pos);
+
+    if(verbose)
     {
         print2term("\n----------------\n");
-        print2term("Object Information V1 [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("B-Tree V2: 0x%lx\n", (unsigned long)starting_position);
         print2term("----------------\n");
-
-        uint16_t num_hdr_msgs = (uint16_t)readField(2, &pos);
-        print2term("Number of Header Messages:                                       %d\n", (int)num_hdr_msgs);
+        print2term("Type:                                                            %d\n", type);
+        print2term("Node Size:                                                       %u\n", (unsigned int)node_size);
+        print2term("Record Size:                                                     %d\n", record_size);
+        print2term("Depth:                                                           %d\n", depth);
+        print2term("Root Node Address:                                               0x%lx\n", (unsigned long)root_addr);
     }
 
-    /* Read Object Reference Count */
-    if(!verbose)
+    if(type != CHUNK_RECORD_TYPE && type != FILTERED_CHUNK_RECORD_TYPE)
     {
-        pos += 4;
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid b-tree v2 record type for chunks: %d", type);
     }
-    else
+    else if(depth > MAX_BTREE_V2_DEPTH || record_size <= 0)
     {
-        uint32_t obj_ref_count = (uint32_t)readField(4, &pos);
-        print2term("Object Reference Count:                                          %d\n", (int)obj_ref_count);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported b-tree v2: depth %d, record size %d", depth, record_size);
     }
 
-    /* Read Object Header Size */
-    uint64_t obj_hdr_size = readField(metaData.lengthsize, &pos);
-    uint64_t end_of_hdr = pos + obj_hdr_size;
-    if(verbose)
+    if(H5_INVALID(root_addr) || root_nrec == 0) return; // no chunks allocated
+
+    /* Calculate Sizes of Child Node Pointer Fields
+     *  the number of records field is sized for the most records a leaf holds, and
+     *  the total number of records field (below depth 1) for the most records the
+     *  subtree of the child holds */
+    btree_v2_info_t tree;
+    tree.record_size = record_size;
+    tree.filtered = (type == FILTERED_CHUNK_RECORD_TYPE);
+    uint64_t max_nrec = (node_size - NODE_PREFIX_SIZE) / record_size;
+    uint64_t cum_max_nrec = max_nrec;
+    tree.max_nrec_size = (highestBit(max_nrec) / 8) + 1;
+    tree.total_nrec_size[0] = 0;
+    for(int d = 1; d <= depth; d++)
     {
-        print2term("Object Header Size:                                              %d\n", (int)obj_hdr_size);
-        print2term("End of Header:                                                   0x%lx\n", (unsigned long)end_of_hdr);
+        int ptr_size = metaData.offsetsize + tree.max_nrec_size + tree.total_nrec_size[d - 1];
+        max_nrec = (node_size - (NODE_PREFIX_SIZE + ptr_size)) / (record_size + ptr_size);
+        cum_max_nrec = ((max_nrec + 1) * cum_max_nrec) + max_nrec;
+        tree.total_nrec_size[d] = (highestBit(cum_max_nrec) / 8) + 1;
     }
 
-    /* Read Header Messages */
-    pos += readMessagesV1(pos, end_of_hdr, H5CORO_CUSTOM_V1_FLAG, dlvl);
-
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
-}
+    /* Read Nodes */
+    readBTreeV2Node(root_addr, depth, root_nrec, &tree, chunks);
+}
 
 /*----------------------------------------------------------------------------
- * readMessagesV1
+ * readBTreeV2Node
+ *
+ *  visits children and records in key order so chunks are listed sorted
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readMessagesV1 (uint64_t pos, uint64_t end, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::readBTreeV2Node (uint64_t pos, int depth, uint64_t nrec, const btree_v2_info_t* tree, List<chunk_entry_t>* chunks)
 {
-    static const int SIZE_OF_V1_PREFIX = 8;
-
-    uint64_t starting_position = pos;
-
-    while(pos < (end - SIZE_OF_V1_PREFIX))
+    /* Check Signature */
+    if(errorChecking)
     {
-        uint16_t    msg_type    = (uint16_t)readField(2, &pos);
-        uint16_t    msg_size    = (uint16_t)readField(2, &pos);
-        uint8_t     msg_flags   = (uint8_t)readField(1, &pos); (void)msg_flags;
+        uint64_t sig_pos = pos;
+        uint32_t signature = (uint32_t)readField(4, &sig_pos);
+        uint32_t expected = (depth > 0) ? H5_BTIN_SIGNATURE_LE : H5_BTLF_SIGNATURE_LE;
+        if(signature != expected)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid b-tree v2 node signature: 0x%llX", (unsigned long long)signature);
+        }
+    }
+    uint64_t records_pos = pos + 6; // signature, version, type
 
-        /* Reserved Bytes */
-        if(!errorChecking)
+    if(depth == 0)
+    {
+        for(uint64_t r = 0; r < nrec; r++)
         {
-            pos += 3;
+            readBTreeV2Record(records_pos + (r * tree->record_size), tree, chunks);
         }
-        else
+    }
+    else
+    {
+        /* Child Node Pointers Follow Records */
+        uint64_t ptr_pos = records_pos + (nrec * tree->record_size);
+        for(uint64_t c = 0; c <= nrec; c++)
         {
-            uint8_t  reserved1 = (uint8_t)readField(1, &pos);
-            uint16_t reserved2 = (uint16_t)readField(2, &pos);
-            if((reserved1 != 0) && (reserved2 != 0))
+            uint64_t child_addr = readField(metaData.offsetsize, &ptr_pos);
+            uint64_t child_nrec = readField(tree->max_nrec_size, &ptr_pos);
+            ptr_pos += (depth > 1) ? tree->total_nrec_size[depth - 1] : 0;
+
+            readBTreeV2Node(child_addr, depth - 1, child_nrec, tree, chunks);
+            if(c < nrec)
             {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved fields: %d, %d", (int)reserved1, (int)reserved2);
+                readBTreeV2Record(records_pos + (c * tree->record_size), tree, chunks);
             }
         }
+    }
+}
 
-        /* Read Each Message */
-        int bytes_read = readMessage((msg_type_t)msg_type, msg_size, pos, hdr_flags, dlvl);
+/*----------------------------------------------------------------------------
+ * readBTreeV2Record
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::readBTreeV2Record (uint64_t pos, const btree_v2_info_t* tree, List<chunk_entry_t>* chunks)
+{
+    chunk_entry_t chunk;
+    LocalLib::set(&chunk, 0, sizeof(chunk));
 
-        /* Handle 8-byte Alignment of Messages */
-        if((bytes_read % 8) > 0) bytes_read += 8 - (bytes_read % 8);
-        if(errorChecking && (bytes_read != msg_size))
+    chunk.address = readField(metaData.offsetsize, &pos);
+    if(tree->filtered)
+    {
+        int size_len = tree->record_size - metaData.offsetsize - 4 - (metaData.ndims * 8);
+        if(size_len < 1 || size_len > 8)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "message of type %d at position 0x%lx different size than specified: %d != %d", (int)msg_type, (unsigned long)pos, bytes_read, msg_size);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid b-tree v2 chunk record size: %d", tree->record_size);
         }
+        chunk.chunk_size = (uint32_t)readField(size_len, &pos);
+        chunk.filter_mask = (uint32_t)readField(4, &pos);
+    }
+    else
+    {
+        chunk.chunk_size = metaData.chunkelements * metaData.elementsize;
+    }
 
-        /* Check if Dataset Found */
-        if(highestDataLevel > dlvl)
-        {
-            pos = end; // go directly to end of header
-            break; // dataset found
-        }
+    /* Scaled Offsets are in Units of Chunks */
+    for(int d = 0; d < metaData.ndims; d++)
+    {
+        chunk.slice[d] = readField(8, &pos) * metaData.chunkdims[d];
+    }
 
-        /* Update Position */
-        pos += bytes_read;
+    if(!H5_INVALID(chunk.address))
+    {
+        chunks->add(chunk);
     }
+}
 
-    /* Move Past Gap */
-    if(pos < end) pos = end;
+/*----------------------------------------------------------------------------
+ * chunkSlice
+ *
+ *  converts a linear chunk index of a fixed array, extensible array, or
+ *  implicit index into the element offset of the chunk in each dimension;
+ *  the index is in row order over the chunks spanning the maximum dimensions,
+ *  with the unlimited dimension (if any) moved to vary slowest; returns false
+ *  if the chunk lies outside the current dimensions
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::chunkSlice (uint64_t idx, int unlimited, uint64_t* slice)
+{
+    int ndims = metaData.ndims;
 
-    /* Check Size */
-    if(errorChecking)
+    /* Order Dimensions from Slowest to Fastest Varying */
+    int order[MAX_NDIMS];
+    int n = 0;
+    if(unlimited >= 0) order[n++] = unlimited;
+    for(int d = 0; d < ndims; d++)
     {
-        if(pos != end)
+        if(d != unlimited) order[n++] = d;
+    }
+
+    /* Peel Off Chunk Coordinates from Fastest Varying Dimension */
+    for(int i = ndims - 1; i >= 0; i--)
+    {
+        int d = order[i];
+        uint64_t coord = idx;
+        if(i > 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "did not read correct number of bytes: %lu != %lu", (unsigned long)pos, (unsigned long)end);
+            uint64_t max_chunks = (metaData.maxdims[d] + metaData.chunkdims[d] - 1) / metaData.chunkdims[d];
+            coord = idx % max_chunks;
+            idx /= max_chunks;
         }
+        slice[d] = coord * metaData.chunkdims[d];
+        if(slice[d] >= metaData.dimensions[d]) return false;
     }
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+    return true;
 }
 
 /*----------------------------------------------------------------------------
- * readMessage
+ * readChunks
+ *
+ *  binary searches the chunk index for the first chunk overlapping the row
+ *  window and reads each chunk from there through the end of the window
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readMessage (msg_type_t msg_type, uint64_t size, uint64_t pos, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::readChunks (const chunk_index_t* index, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset)
 {
-    switch(msg_type)
+    uint64_t data_key1 = datasetStartRow;
+    uint64_t data_key2 = datasetStartRow + datasetNumRows - 1;
+    uint64_t chunk_rows = (metaData.ndims > 0) ? metaData.chunkdims[0] : 1;
+
+    /* Find First Chunk Ending after Start of Window */
+    int64_t lo = 0;
+    int64_t hi = index->num_chunks;
+    while(lo < hi)
     {
-        case DATASPACE_MSG:     return readDataspaceMsg(pos, hdr_flags, dlvl);
-        case LINK_INFO_MSG:     return readLinkInfoMsg(pos, hdr_flags, dlvl);
-        case DATATYPE_MSG:      return readDatatypeMsg(pos, hdr_flags, dlvl);
-        case FILL_VALUE_MSG:    return readFillValueMsg(pos, hdr_flags, dlvl);
-        case LINK_MSG:          return readLinkMsg(pos, hdr_flags, dlvl);
-        case DATA_LAYOUT_MSG:   return readDataLayoutMsg(pos, hdr_flags, dlvl);
-        case FILTER_MSG:        return readFilterMsg(pos, hdr_flags, dlvl);
-#ifdef H5CORO_ATTRIBUTE_SUPPORT
-        case ATTRIBUTE_MSG:     return readAttributeMsg(pos, hdr_flags, dlvl, size);
-#endif
-        case HEADER_CONT_MSG:   return readHeaderContMsg(pos, hdr_flags, dlvl);
-        case SYMBOL_TABLE_MSG:  return readSymbolTableMsg(pos, hdr_flags, dlvl);
+        int64_t mid = lo + ((hi - lo) / 2);
+        if((index->chunks[mid].slice[0] + chunk_rows) <= data_key1) lo = mid + 1;
+        else hi = mid;
+    }
 
-        default:
+    /* Read Chunks Starting before End of Window */
+    for(int64_t c = lo; c < index->num_chunks && index->chunks[c].slice[0] <= data_key2; c++)
+    {
+        const chunk_entry_t* chunk = &index->chunks[c];
+
+        /* Skip Chunks with No Elements in Hyperslab Selection */
+        if(datasetSlabDims > 0)
         {
-            if(verbose)
+            bool included = true;
+            for(int d = 0; included && d < metaData.ndims; d++)
             {
-                print2term("Skipped Message [%d]: 0x%x, %d, 0x%lx\n", dlvl, (int)msg_type, (int)size, (unsigned long)pos);
+                included = slabIntersects(d, chunk->slice[d], chunk->slice[d] + metaData.chunkdims[d]);
             }
-
-            return size;
+            if(!included) continue;
         }
+
+        readChunk(chunk, buffer, buffer_size, buffer_offset);
     }
 }
 
 /*----------------------------------------------------------------------------
- * readDataspaceMsg
+ * readChunk
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readDataspaceMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::readChunk (const chunk_entry_t* chunk, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset)
 {
-    (void)hdr_flags;
-
-    static const int MAX_DIM_PRESENT    = 0x1;
-    static const int PERM_INDEX_PRESENT = 0x2;
-
-    uint64_t starting_position = pos;
-
-    uint8_t version         = (uint8_t)readField(1, &pos);
-    uint8_t dimensionality  = (uint8_t)readField(1, &pos);
-    uint8_t flags           = (uint8_t)readField(1, &pos);
-    pos += 5; // go past reserved bytes
-
-    if(errorChecking)
+    /* Calculate Chunk Location */
+    uint64_t chunk_offset = 0;
+    for(int i = 0; i < metaData.ndims; i++)
     {
-        if(version != 1)
+        uint64_t slice_size = chunk->slice[i] * metaData.typesize;
+        for(int k = 0; k < i; k++)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid dataspace version: %d", (int)version);
+            slice_size *= metaData.chunkdims[k];
         }
+        for(int j = i + 1; j < metaData.ndims; j++)
+        {
+            slice_size *= metaData.dimensions[j];
+        }
+        chunk_offset += slice_size;
+    }
 
-        if(flags & PERM_INDEX_PRESENT)
+    /* Calculate Buffer Index - offset into data buffer to put chunked data */
+    uint64_t buffer_index = 0;
+    if(chunk_offset > buffer_offset)
+    {
+        buffer_index = chunk_offset - buffer_offset;
+        if(buffer_index >= buffer_size)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported permutation indexes");
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid location to read data: %ld, %lu", (unsigned long)chunk_offset, (unsigned long)buffer_offset);
         }
+    }
 
-        if(dimensionality > MAX_NDIMS)
+    /* Calculate Chunk Index - offset into chunk buffer to read from */
+    uint64_t chunk_index = 0;
+    if(buffer_offset > chunk_offset)
+    {
+        chunk_index = buffer_offset - chunk_offset;
+        if((int64_t)chunk_index >= dataChunkBufferSize)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported number of dimensions: %d", dimensionality);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid location to read chunk: %ld, %lu", (unsigned long)chunk_offset, (unsigned long)buffer_offset);
         }
     }
 
-    if(verbose)
+    /* Calculate Chunk Bytes - number of bytes to read from chunk buffer */
+    int64_t chunk_bytes = dataChunkBufferSize - chunk_index;
+    if(chunk_bytes < 0)
     {
-        print2term("\n----------------\n");
-        print2term("Dataspace Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("Version:                                                         %d\n", (int)version);
-        print2term("Dimensionality:                                                  %d\n", (int)dimensionality);
-        print2term("Flags:                                                           0x%x\n", (int)flags);
+        throw RunTimeException(CRITICAL, RTE_ERROR, "no bytes of chunk data to read: %ld, %lu", (long)chunk_bytes, (unsigned long)chunk_index);
+    }
+    else if((buffer_index + chunk_bytes) > buffer_size)
+    {
+        chunk_bytes = buffer_size - buffer_index;
     }
 
-    /* Read and Populate Data Dimensions */
-    uint64_t num_elements = 0;
-    metaData.ndims = MIN(dimensionality, MAX_NDIMS);
-    if(metaData.ndims > 0)
+    /* Display Info */
+    if(verbose && H5_EXTRA_DEBUG)
     {
-        num_elements = 1;
-        for(int d = 0; d < metaData.ndims; d++)
+        print2term("Chunk Offset:                                                    %ld (%ld)\n", (unsigned long)chunk_offset, (unsigned long)(chunk_offset/metaData.typesize));
+        print2term("Buffer Index:                                                    %ld (%ld)\n", (unsigned long)buffer_index, (unsigned long)(buffer_index/metaData.typesize));
+        print2term("Buffer Bytes:                                                    %ld (%ld)\n", (unsigned long)chunk_bytes, (unsigned long)(chunk_bytes/metaData.typesize));
+    }
+
+    /* Read Chunk */
+    if(metaData.filter[DEFLATE_FILTER])
+    {
+        uint64_t chunk_addr = chunk->address;
+
+        /* Check Current Node Chunk Size */
+        if(chunk->chunk_size > (dataChunkBufferSize * FILTER_SIZE_SCALE))
         {
-            metaData.dimensions[d] = readField(metaData.lengthsize, &pos);
-            num_elements *= metaData.dimensions[d];
-            if(verbose)
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Compressed chunk size exceeds buffer: %u > %lu", chunk->chunk_size, (unsigned long)dataChunkBufferSize);
+        }
+
+        if(inflateParallel)
+        {
+            /* Read Data into Request Buffer and Hand Off to Inflate Pool */
+            uint8_t* input = new uint8_t [chunk->chunk_size];
+            try
             {
-                print2term("Dimension %d:                                                     %lu\n", (int)metaData.ndims, (unsigned long)metaData.dimensions[d]);
+                ioRequest(&chunk_addr, chunk->chunk_size, input, dataSizeHint, true);
+            }
+            catch(const RunTimeException& io_error)
+            {
+                delete [] input;
+                throw;
             }
+            inflateDispatch(input, chunk->chunk_size, &buffer[buffer_index], chunk_index, chunk_bytes);
         }
-
-        /* Skip Over Maximum Dimensions */
-        if(flags & MAX_DIM_PRESENT)
+        else
         {
-            int skip_bytes = metaData.ndims * metaData.lengthsize;
-            pos += skip_bytes;
+            /* Read Data into Chunk Filter Buffer (holds the compressed data) */
+            ioRequest(&chunk_addr, chunk->chunk_size, dataChunkFilterBuffer, dataSizeHint, true);
+            inflateProcess(dataChunkFilterBuffer, chunk->chunk_size, &buffer[buffer_index], chunk_index, chunk_bytes, dataChunkBuffer);
         }
-    }
 
-    if(verbose)
-    {
-        print2term("Number of Elements:                                              %lu\n", (unsigned long)num_elements);
+        /* Handle Caching */
+        dataSizeHint = IO_CACHE_L1_LINESIZE;
     }
+    else /* no supported filters */
+    {
+        if(errorChecking)
+        {
+            if(metaData.filter[SHUFFLE_FILTER])
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "shuffle filter unsupported on uncompressed chunk");
+            }
+            else if(dataChunkBufferSize != chunk->chunk_size)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "mismatch in chunk size: %lu, %lu", (unsigned long)chunk->chunk_size, (unsigned long)dataChunkBufferSize);
+            }
+        }
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+        /* Read Data into Data Buffer
+         *  large reads go straight into the buffer unless already cached,
+         *  as the data is unlikely to be read again */
+        uint64_t chunk_offset_addr = chunk->address + chunk_index;
+        ioRequest(&chunk_offset_addr, chunk_bytes, &buffer[buffer_index], dataSizeHint, chunk_bytes < IO_DIRECT_THRESHOLD);
+        dataSizeHint = IO_CACHE_L1_LINESIZE;
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readLinkInfoMsg
+ * chunkIndexAcquire
+ *
+ *  returns the chunk index of the dataset from the index repository, or
+ *  builds it from the chunk b-tree and adds it to the repository; the index
+ *  is referenced and must be returned with chunkIndexRelease
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readLinkInfoMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+H5FileBuffer::chunk_index_t* H5FileBuffer::chunkIndexAcquire (void)
 {
-    static const int MAX_CREATE_PRESENT_BIT     = 0x01;
-    static const int CREATE_ORDER_PRESENT_BIT   = 0x02;
-
-    uint64_t starting_position = pos;
-
-    uint64_t version = readField(1, &pos);
-    uint64_t flags = readField(1, &pos);
+    uint64_t index_key = metaGetKey(metaData.url);
+    chunk_index_t* index = NULL;
 
-    if(errorChecking)
+    /* Look Up Index */
+    metaMutex.lock();
     {
-        if(version != 0)
+        if(indexRepo.find(index_key, index_repo_t::MATCH_EXACTLY, &index, true))
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link info version: %d", (int)version);
+            if(StringLib::match(index->url, metaData.url, MAX_META_NAME_SIZE) && index->address == metaData.address)
+            {
+                index->refs++;
+            }
+            else
+            {
+                index = NULL;
+            }
+        }
+        else
+        {
+            index = NULL;
         }
     }
+    metaMutex.unlock();
 
-    if(verbose)
-    {
-        print2term("\n----------------\n");
-        print2term("Link Information Message [%d], 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-    }
+    if(index) return index;
 
-    /* Read Maximum Creation Index (number of elements in group) */
-    if(flags & MAX_CREATE_PRESENT_BIT)
+    /* Build Index from Chunk Index of Dataset */
+    List<chunk_entry_t> chunks;
+    readChunkIndex(&chunks);
+
+    index = new chunk_index_t;
+    LocalLib::copy(index->url, metaData.url, MAX_META_NAME_SIZE);
+    index->address = metaData.address;
+    index->num_chunks = chunks.length();
+    index->chunks = new chunk_entry_t [index->num_chunks > 0 ? index->num_chunks : 1];
+    index->refs = 1;
+    bool sorted = true;
+    for(int64_t c = 0; c < index->num_chunks; c++)
     {
-        uint64_t max_create_index = readField(8, &pos);
-        if(verbose)
-        {
-            print2term("Maximum Creation Index:                                          %lu\n", (unsigned long)max_create_index);
-        }
+        index->chunks[c] = chunks[c];
+        if(c > 0 && index->chunks[c].slice[0] < index->chunks[c - 1].slice[0]) sorted = false;
     }
 
-    /* Read Heap and Name Offsets */
-    uint64_t heap_address = readField(metaData.offsetsize, &pos);
-    uint64_t name_index = readField(metaData.offsetsize, &pos);
-    if(verbose)
+    /* Sort Chunks Indexed in Another Order (e.g. extensible array along a later dimension) */
+    if(!sorted)
     {
-        print2term("Heap Address:                                                    %lX\n", (unsigned long)heap_address);
-        print2term("Name Index:                                                      %lX\n", (unsigned long)name_index);
+        int ndims = metaData.ndims;
+        std::sort(&index->chunks[0], &index->chunks[index->num_chunks], [ndims](const chunk_entry_t& a, const chunk_entry_t& b) {
+            for(int d = 0; d < ndims; d++)
+            {
+                if(a.slice[d] != b.slice[d]) return a.slice[d] < b.slice[d];
+            }
+            return false;
+        });
     }
 
-    if(flags & CREATE_ORDER_PRESENT_BIT)
+    /* Add Index to Repository (repository holds its own reference) */
+    metaMutex.lock();
     {
-        uint64_t create_order_index = readField(8, &pos);
-        if(verbose)
+        chunk_index_t* existing = NULL;
+        if(!indexRepo.find(index_key, index_repo_t::MATCH_EXACTLY, &existing))
         {
-            print2term("Creation Order Index:                                            %lX\n", (unsigned long)create_order_index);
+            /* Remove Oldest Index if Repository is Full */
+            if(indexRepo.isfull())
+            {
+                chunk_index_t* oldest = NULL;
+                uint64_t oldest_key = indexRepo.first(&oldest);
+                indexRepo.remove(oldest_key);
+                if(--oldest->refs == 0)
+                {
+                    delete [] oldest->chunks;
+                    delete oldest;
+                }
+            }
+
+            if(indexRepo.add(index_key, index))
+            {
+                index->refs++;
+            }
         }
     }
+    metaMutex.unlock();
 
-    /* Follow Heap Address if Provided */
-    if((int)heap_address != -1)
+    return index;
+}
+
+/*----------------------------------------------------------------------------
+ * chunkIndexRelease
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::chunkIndexRelease (chunk_index_t* index)
+{
+    bool unused = false;
+    metaMutex.lock();
     {
-        readFractalHeap(LINK_MSG, heap_address, hdr_flags, dlvl);
+        unused = (--index->refs == 0);
     }
+    metaMutex.unlock();
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+    if(unused)
+    {
+        delete [] index->chunks;
+        delete index;
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readDatatypeMsg
+ * readBTreeNodeV1
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readDatatypeMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+H5FileBuffer::btree_node_t H5FileBuffer::readBTreeNodeV1 (int ndims, uint64_t* pos)
 {
-    (void)hdr_flags;
-
-    uint64_t starting_position = pos;
+    btree_node_t node;
 
-    /* Read Message Info */
-    uint64_t version_class = readField(4, &pos);
-    metaData.typesize = (int)readField(4, &pos);
-    uint64_t version = (version_class & 0xF0) >> 4;
-    uint64_t databits = version_class >> 8;
+    /* Read Key */
+    node.chunk_size = (uint32_t)readField(4, pos);
+    node.filter_mask = (uint32_t)readField(4, pos);
+    for(int d = 0; d < ndims; d++)
+    {
+        node.slice[d] = readField(8, pos);
+    }
 
+    /* Read Trailing Zero */
+    uint64_t trailing_zero = readField(8, pos);
     if(errorChecking)
     {
-        if(version != 1)
+        if(trailing_zero % metaData.typesize != 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid datatype version: %d", (int)version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "key did not include a trailing zero: %lu", trailing_zero);
+        }
+        else if(verbose && H5_EXTRA_DEBUG)
+        {
+            print2term("Trailing Zero:                                                   %d\n", (int)trailing_zero);
         }
     }
 
-    /* Set Data Type */
-    metaData.type = (data_type_t)(version_class & 0x0F);
-    if(verbose)
+    /* Set Node Key */
+    if(ndims > 0)   node.row_key = node.slice[0];
+    else            node.row_key = 0;
+
+    /* Return Copy of Node */
+    return node;
+}
+
+/*----------------------------------------------------------------------------
+ * readSymbolTable
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readSymbolTable (uint64_t pos, uint64_t heap_data_addr, int dlvl)
+{
+    uint64_t starting_position = pos;
+
+    /* Check Signature and Version */
+    if(!errorChecking)
     {
-        print2term("\n----------------\n");
-        print2term("Datatype Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("Version:                                                         %d\n", (int)version);
-        print2term("Data Class:                                                      %d, %s\n", (int)metaData.type, type2str(metaData.type));
-        print2term("Data Size:                                                       %d\n", metaData.typesize);
+        pos += 6;
     }
-
-    /* Read Data Class Properties */
-    switch(metaData.type)
+    else
     {
-        case FIXED_POINT_TYPE:
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_SNOD_SIGNATURE_LE)
         {
-            metaData.signedval = ((databits & 0x08) >> 3) == 1;
-
-            if(!verbose)
-            {
-                pos += 4;
-            }
-            else
-            {
-                unsigned int byte_order = databits & 0x1;
-                unsigned int pad_type   = (databits & 0x06) >> 1;
-
-                uint16_t bit_offset     = (uint16_t)readField(2, &pos);
-                uint16_t bit_precision  = (uint16_t)readField(2, &pos);
-
-                print2term("Byte Order:                                                      %d\n", (int)byte_order);
-                print2term("Pading Type:                                                     %d\n", (int)pad_type);
-                print2term("Signed Value:                                                    %d\n", (int)metaData.signedval);
-                print2term("Bit Offset:                                                      %d\n", (int)bit_offset);
-                print2term("Bit Precision:                                                   %d\n", (int)bit_precision);
-            }
-            break;
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid symbol table signature: 0x%llX", (unsigned long long)signature);
         }
 
-        case FLOATING_POINT_TYPE:
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 1)
         {
-            if(!verbose)
-            {
-                pos += 12;
-            }
-            else
-            {
-                unsigned int byte_order = ((databits & 0x40) >> 5) | (databits & 0x1);
-                unsigned int pad_type = (databits & 0x0E) >> 1;
-                unsigned int mant_norm = (databits & 0x30) >> 4;
-                unsigned int sign_loc = (databits & 0xFF00) >> 8;
-
-                uint16_t bit_offset     = (uint16_t)readField(2, &pos);
-                uint16_t bit_precision  = (uint16_t)readField(2, &pos);
-                uint8_t  exp_location   =  (uint8_t)readField(1, &pos);
-                uint8_t  exp_size       =  (uint8_t)readField(1, &pos);
-                uint8_t  mant_location  =  (uint8_t)readField(1, &pos);
-                uint8_t  mant_size      =  (uint8_t)readField(1, &pos);
-                uint32_t exp_bias       = (uint32_t)readField(4, &pos);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect version of symbole table: %d", (int)version);
+        }
 
-                print2term("Byte Order:                                                      %d\n", (int)byte_order);
-                print2term("Pading Type:                                                     %d\n", (int)pad_type);
-                print2term("Mantissa Normalization:                                          %d\n", (int)mant_norm);
-                print2term("Sign Location:                                                   %d\n", (int)sign_loc);
-                print2term("Bit Offset:                                                      %d\n", (int)bit_offset);
-                print2term("Bit Precision:                                                   %d\n", (int)bit_precision);
-                print2term("Exponent Location:                                               %d\n", (int)exp_location);
-                print2term("Exponent Size:                                                   %d\n", (int)exp_size);
-                print2term("Mantissa Location:                                               %d\n", (int)mant_location);
-                print2term("Mantissa Size:                                                   %d\n", (int)mant_size);
-                print2term("Exponent Bias:                                                   %d\n", (int)exp_bias);
-            }
-            break;
+        uint8_t reserved0 = (uint8_t)readField(1, &pos);
+        if(reserved0 != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect reserved value: %d", (int)reserved0);
         }
+    }
 
-        case VARIABLE_LENGTH_TYPE:
+    /* Read Symbols */
+    uint16_t num_symbols = (uint16_t)readField(2, &pos);
+    for(int s = 0; s < num_symbols; s++)
+    {
+        /* Read Symbol Entry */
+        uint64_t link_name_offset = readField(metaData.offsetsize, &pos);
+        uint64_t obj_hdr_addr = readField(metaData.offsetsize, &pos);
+        uint32_t cache_type = (uint32_t)readField(4, &pos);
+        pos += 20; // reserved + scratch pad
+        if(errorChecking)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "variable length data types require reading a global heap, which is not yet supported");
-#if 0
-            if(verbose)
+            if(cache_type == 2)
             {
-                unsigned int vt_type = databits & 0xF; // variable length type
-                unsigned int padding = (databits & 0xF0) >> 4;
-                unsigned int charset = (databits & 0xF00) >> 8;
-
-                const char* vt_type_str = "unknown";
-                if(vt_type == 0) vt_type_str = "Sequence";
-                else if(vt_type == 1) vt_type_str = "String";
-
-                const char* padding_str = "unknown";
-                if(padding == 0) padding_str = "Null Terminate";
-                else if(padding == 1) padding_str = "Null Pad";
-                else if(padding == 2) padding_str = "Space Pad";
-
-                const char* charset_str = "unknown";
-                if(charset == 0) charset_str = "ASCII";
-                else if(charset == 1) charset_str = "UTF-8";
-
-                print2term("Variable Type:                                                   %d %s\n", (int)vt_type, vt_type_str);
-                print2term("Padding Type:                                                    %d %s\n", (int)padding, padding_str);
-                print2term("Character Set:                                                   %d %s\n", (int)charset, charset_str);
+                throw RunTimeException(CRITICAL, RTE_ERROR, "symbolic links are unsupported");
             }
-            pos += readDatatypeMsg (pos, hdr_flags, dlvl);
-            break;
-#endif
         }
 
-        case STRING_TYPE:
+        /* Read Link Name */
+        uint64_t link_name_addr = heap_data_addr + link_name_offset;
+        uint8_t link_name[STR_BUFF_SIZE];
+        int i = 0;
+        while(true)
         {
-            if(verbose)
+            if(i >= STR_BUFF_SIZE)
             {
-                unsigned int padding = databits & 0x0F;
-                unsigned int charset = (databits & 0xF0) >> 4;
-
-                const char* padding_str = "unknown";
-                if(padding == 0) padding_str = "Null Terminate";
-                else if(padding == 1) padding_str = "Null Pad";
-                else if(padding == 2) padding_str = "Space Pad";
+                throw RunTimeException(CRITICAL, RTE_ERROR, "link name string exceeded maximum length: %d, 0x%lx\n", i, (unsigned long)pos);
+            }
 
-                const char* charset_str = "unknown";
-                if(charset == 0) charset_str = "ASCII";
-                else if(charset == 1) charset_str = "UTF-8";
+            uint8_t c = (uint8_t)readField(1, &link_name_addr);
+            link_name[i++] = c;
 
-                print2term("Padding Type:                                                    %d %s\n", (int)padding, padding_str);
-                print2term("Character Set:                                                   %d %s\n", (int)charset, charset_str);
+            if(c == 0)
+            {
+                break;
             }
-            break;
+        }
+        link_name[i] = '\0';
+        if(verbose)
+        {
+            print2term("Link Name:                                                       %s\n", link_name);
+            print2term("Object Header Address:                                           0x%lx\n", obj_hdr_addr);
         }
 
-        default:
+        /* Process Link */
+        if(dlvl < datasetPath.length())
         {
-            if(errorChecking)
+            if(StringLib::match((const char*)link_name, datasetPath[dlvl]))
             {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported datatype: %d", (int)metaData.type);
+                highestDataLevel = dlvl + 1;
+                readObjHdr(obj_hdr_addr, highestDataLevel);
+                break; // dataset found
             }
-            break;
+        }
+        else if(groupLinks)
+        {
+            groupLinks->add(StringLib::duplicate((const char*)link_name));
         }
     }
 
@@ -2308,377 +3815,395 @@ int H5FileBuffer::readDatatypeMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
 }
 
 /*----------------------------------------------------------------------------
- * readFillValueMsg
+ * readObjHdr
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readFillValueMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+int H5FileBuffer::readObjHdr (uint64_t pos, int dlvl)
 {
-    (void)hdr_flags;
-
     uint64_t starting_position = pos;
 
-    uint64_t version = readField(1, &pos);
-
-    if(errorChecking)
-    {
-        if(version != 2)
-        {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid fill value version: %d", (int)version);
-        }
-    }
+    /* Peek at Version / Process Version 1 */
+    uint64_t peeking_position = pos;
+    uint8_t peek = readField(1, &peeking_position);
+    if(peek == 1) return readObjHdrV1(starting_position, dlvl);
 
-    if(!verbose)
+    /* Read Object Header */
+    if(!errorChecking)
     {
-        pos += 2;
+        pos += 5; // move past signature and version
     }
     else
     {
-        uint8_t space_allocation_time = (uint8_t)readField(1, &pos);
-        uint8_t fill_value_write_time = (uint8_t)readField(1, &pos);
-
-        print2term("\n----------------\n");
-        print2term("Fill Value Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("Space Allocation Time:                                           %d\n", (int)space_allocation_time);
-        print2term("Fill Value Write Time:                                           %d\n", (int)fill_value_write_time);
-    }
-
-    uint8_t fill_value_defined = (uint8_t)readField(1, &pos);
-    if(fill_value_defined)
-    {
-        metaData.fillsize = (int)readField(4, &pos);
-        if(verbose)
+        uint64_t signature = readField(4, &pos);
+        if(signature != H5_OHDR_SIGNATURE_LE)
         {
-            print2term("Fill Value Size:                                                 %d\n", metaData.fillsize);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header signature: 0x%llX", (unsigned long long)signature);
         }
 
-        if(metaData.fillsize > 0)
+        uint64_t version = readField(1, &pos);
+        if(version != 2)
         {
-            uint64_t fill_value = readField(metaData.fillsize, &pos);
-            metaData.fill.fill_ll = fill_value;
-            if(verbose)
-            {
-                print2term("Fill Value:                                                      0x%llX\n", (unsigned long long)fill_value);
-            }
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header version: %d", (int)version);
         }
     }
 
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
-}
+    /* Read Option Time Fields */
+    uint8_t obj_hdr_flags = (uint8_t)readField(1, &pos);
+    if(obj_hdr_flags & FILE_STATS_BIT)
+    {
+        if(!verbose)
+        {
+            pos += 16; // move past time fields
+        }
+        else
+        {
+            uint64_t access_time         = readField(4, &pos);
+            uint64_t modification_time   = readField(4, &pos);
+            uint64_t change_time         = readField(4, &pos);
+            uint64_t birth_time          = readField(4, &pos);
 
-/*----------------------------------------------------------------------------
- * readLinkMsg
- *----------------------------------------------------------------------------*/
-int H5FileBuffer::readLinkMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
-{
-    (void)hdr_flags;
+            print2term("\n----------------\n");
+            print2term("Object Information [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+            print2term("----------------\n");
 
-    static const int SIZE_OF_LEN_OF_NAME_MASK   = 0x03;
-    static const int CREATE_ORDER_PRESENT_BIT   = 0x04;
-    static const int LINK_TYPE_PRESENT_BIT      = 0x08;
-    static const int CHAR_SET_PRESENT_BIT       = 0x10;
+            TimeLib::gmt_time_t access_gmt = TimeLib::gettime(access_time * TIME_MILLISECS_IN_A_SECOND);
+            print2term("Access Time:                                                     %d:%d:%d:%d:%d\n", access_gmt.year, access_gmt.doy, access_gmt.hour, access_gmt.minute, access_gmt.second);
 
-    uint64_t starting_position = pos;
+            TimeLib::gmt_time_t modification_gmt = TimeLib::gettime(modification_time * TIME_MILLISECS_IN_A_SECOND);
+            print2term("Modification Time:                                               %d:%d:%d:%d:%d\n", modification_gmt.year, modification_gmt.doy, modification_gmt.hour, modification_gmt.minute, modification_gmt.second);
 
-    uint64_t version = readField(1, &pos);
-    uint64_t flags = readField(1, &pos);
+            TimeLib::gmt_time_t change_gmt = TimeLib::gettime(change_time * TIME_MILLISECS_IN_A_SECOND);
+            print2term("Change Time:                                                     %d:%d:%d:%d:%d\n", change_gmt.year, change_gmt.doy, change_gmt.hour, change_gmt.minute, change_gmt.second);
 
-    if(errorChecking)
+            TimeLib::gmt_time_t birth_gmt = TimeLib::gettime(birth_time * TIME_MILLISECS_IN_A_SECOND);
+            print2term("Birth Time:                                                      %d:%d:%d:%d:%d\n", birth_gmt.year, birth_gmt.doy, birth_gmt.hour, birth_gmt.minute, birth_gmt.second);
+        }
+    }
+
+    /* Optional Phase Attributes */
+    if(obj_hdr_flags & STORE_CHANGE_PHASE_BIT)
     {
-        if(version != 1)
+        if(!verbose)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link version: %d", (int)version);
+            pos += 4; // move past phase attributes
+        }
+        else
+        {
+            uint64_t max_compact_attr = readField(2, &pos); (void)max_compact_attr;
+            uint64_t max_dense_attr = readField(2, &pos); (void)max_dense_attr;
         }
     }
 
-    if(verbose)
+    /* Read Header Messages */
+    uint64_t size_of_chunk0 = readField(1 << (obj_hdr_flags & SIZE_OF_CHUNK_0_MASK), &pos);
+    uint64_t end_of_hdr = pos + size_of_chunk0;
+    pos += readMessages (pos, end_of_hdr, obj_hdr_flags, dlvl);
+
+    /* Verify Checksum */
+    uint64_t check_sum = readField(4, &pos);
+    if(errorChecking)
     {
-        print2term("\n----------------\n");
-        print2term("Link Message [%d]: 0x%x, 0x%lx\n", dlvl, (unsigned)flags, (unsigned long)starting_position);
-        print2term("----------------\n");
+        (void)check_sum;
     }
 
-    /* Read Link Type */
-    uint8_t link_type = 0; // default to hard link
-    if(flags & LINK_TYPE_PRESENT_BIT)
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readMessages
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readMessages (uint64_t pos, uint64_t end, uint8_t hdr_flags, int dlvl)
+{
+    uint64_t starting_position = pos;
+
+    while(pos < end)
     {
-        link_type = readField(1, &pos);
-        if(verbose)
+        /* Read Message Info */
+        uint8_t     msg_type    = (uint8_t)readField(1, &pos);
+        uint16_t    msg_size    = (uint16_t)readField(2, &pos);
+        uint8_t     msg_flags   = (uint8_t)readField(1, &pos); (void)msg_flags;
+
+        if(hdr_flags & ATTR_CREATION_TRACK_BIT)
         {
-            print2term("Link Type:                                                       %lu\n", (unsigned long)link_type);
+            uint64_t msg_order = (uint8_t)readField(2, &pos); (void)msg_order;
         }
-    }
 
-    /* Read Creation Order */
-    if(flags & CREATE_ORDER_PRESENT_BIT)
-    {
-        uint64_t create_order = readField(8, &pos);
-        if(verbose)
+        /* Read Each Message */
+        int bytes_read = readMessage((msg_type_t)msg_type, msg_size, pos, hdr_flags, dlvl);
+        if(errorChecking && (bytes_read != msg_size))
         {
-            print2term("Creation Order:                                                  %lX\n", (unsigned long)create_order);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "header message different size than specified: %d != %d", bytes_read, msg_size);
         }
-    }
 
-    /* Read Character Set */
-    if(flags & CHAR_SET_PRESENT_BIT)
-    {
-        uint8_t char_set = readField(1, &pos);
-        if(verbose)
+        /* Check if Dataset Found */
+        if(highestDataLevel > dlvl)
         {
-            print2term("Character Set:                                                   %lu\n", (unsigned long)char_set);
+            pos = end; // go directly to end of header
+            break; // dataset found
         }
-    }
 
-    /* Read Link Name */
-    int link_name_len_of_len = 1 << (flags & SIZE_OF_LEN_OF_NAME_MASK);
-    if(errorChecking && (link_name_len_of_len > 8))
-    {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link name length of length: %d", (int)link_name_len_of_len);
+        /* Update Position */
+        pos += bytes_read;
     }
 
-    uint64_t link_name_len = readField(link_name_len_of_len, &pos);
-    if(verbose)
+    /* Check Size */
+    if(errorChecking)
     {
-        print2term("Link Name Length:                                                %lu\n", (unsigned long)link_name_len);
+        if(pos != end)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "did not read correct number of bytes: %lu != %lu", (unsigned long)pos, (unsigned long)end);
+        }
     }
 
-    uint8_t link_name[STR_BUFF_SIZE];
-    readByteArray(link_name, link_name_len, &pos);
-    link_name[link_name_len] = '\0';
-    if(verbose)
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readObjHdrV1
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readObjHdrV1 (uint64_t pos, int dlvl)
+{
+    uint64_t starting_position = pos;
+
+    /* Read Version */
+    if(!errorChecking)
     {
-        print2term("Link Name:                                                       %s\n", link_name);
+        pos += 2;
     }
-
-    /* Process Link Type */
-    if(link_type == 0) // hard link
+    else
     {
-        uint64_t object_header_addr = readField(metaData.offsetsize, &pos);
-        if(verbose)
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 1)
         {
-            print2term("Hard Link - Object Header Address:                               0x%lx\n", object_header_addr);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header version: %d", (int)version);
         }
 
-        if(dlvl < datasetPath.length())
+        uint8_t reserved0 = (uint8_t)readField(1, &pos);
+        if(reserved0 != 0)
         {
-            if(StringLib::match((const char*)link_name, datasetPath[dlvl]))
-            {
-                highestDataLevel = dlvl + 1;
-                readObjHdr(object_header_addr, highestDataLevel);
-            }
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved field: %d", (int)reserved0);
         }
     }
-    else if(link_type == 1) // soft link
+
+    /* Read Number of Header Messages */
+    if(!verbose)
     {
-        uint16_t soft_link_len = readField(2, &pos);
-        uint8_t soft_link[STR_BUFF_SIZE];
-        readByteArray(soft_link, soft_link_len, &pos);
-        soft_link[soft_link_len] = '\0';
-        if(verbose)
-        {
-            print2term("Soft Link:                                                       %s\n", soft_link);
-        }
+        pos += 2;
     }
-    else if(link_type == 64) // external link
+    else
     {
-        uint16_t ext_link_len = readField(2, &pos);
-        uint8_t ext_link[STR_BUFF_SIZE];
-        readByteArray(ext_link, ext_link_len, &pos);
-        ext_link[ext_link_len] = '\0';
-        if(verbose)
-        {
-            print2term("External Link:                                                   %s\n", ext_link);
-        }
+        print2term("\n----------------\n");
+        print2term("Object Information V1 [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+
+        uint16_t num_hdr_msgs = (uint16_t)readField(2, &pos);
+        print2term("Number of Header Messages:                                       %d\n", (int)num_hdr_msgs);
     }
-    else if(errorChecking)
+
+    /* Read Object Reference Count */
+    if(!verbose)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link type: %d", link_type);
+        pos += 4;
+    }
+    else
+    {
+        uint32_t obj_ref_count = (uint32_t)readField(4, &pos);
+        print2term("Object Reference Count:                                          %d\n", (int)obj_ref_count);
+    }
+
+    /* Read Object Header Size */
+    uint64_t obj_hdr_size = readField(metaData.lengthsize, &pos);
+    uint64_t end_of_hdr = pos + obj_hdr_size;
+    if(verbose)
+    {
+        print2term("Object Header Size:                                              %d\n", (int)obj_hdr_size);
+        print2term("End of Header:                                                   0x%lx\n", (unsigned long)end_of_hdr);
     }
 
+    /* Read Header Messages */
+    pos += readMessagesV1(pos, end_of_hdr, H5CORO_CUSTOM_V1_FLAG, dlvl);
+
     /* Return Bytes Read */
     uint64_t ending_position = pos;
     return ending_position - starting_position;
 }
 
 /*----------------------------------------------------------------------------
- * readDataLayoutMsg
+ * readMessagesV1
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readDataLayoutMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+int H5FileBuffer::readMessagesV1 (uint64_t pos, uint64_t end, uint8_t hdr_flags, int dlvl)
 {
-    (void)hdr_flags;
+    static const int SIZE_OF_V1_PREFIX = 8;
 
     uint64_t starting_position = pos;
 
-    /* Read Message Info */
-    uint64_t version = readField(1, &pos);
-    metaData.layout = (layout_t)readField(1, &pos);
-
-    if(errorChecking)
+    while(pos < (end - SIZE_OF_V1_PREFIX))
     {
-        if(version != 3)
+        uint16_t    msg_type    = (uint16_t)readField(2, &pos);
+        uint16_t    msg_size    = (uint16_t)readField(2, &pos);
+        uint8_t     msg_flags   = (uint8_t)readField(1, &pos); (void)msg_flags;
+
+        /* Reserved Bytes */
+        if(!errorChecking)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data layout version: %d", (int)version);
+            pos += 3;
+        }
+        else
+        {
+            uint8_t  reserved1 = (uint8_t)readField(1, &pos);
+            uint16_t reserved2 = (uint16_t)readField(2, &pos);
+            if((reserved1 != 0) && (reserved2 != 0))
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved fields: %d, %d", (int)reserved1, (int)reserved2);
+            }
         }
-    }
 
-    if(verbose)
-    {
-        print2term("\n----------------\n");
-        print2term("Data Layout Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("Version:                                                         %d\n", (int)version);
-        print2term("Layout:                                                          %d, %s\n", (int)metaData.layout, layout2str(metaData.layout));
-    }
+        /* Read Each Message */
+        int bytes_read = readMessage((msg_type_t)msg_type, msg_size, pos, hdr_flags, dlvl);
 
-    /* Read Layout Classes */
-    switch(metaData.layout)
-    {
-        case COMPACT_LAYOUT:
+        /* Handle 8-byte Alignment of Messages */
+        if((bytes_read % 8) > 0) bytes_read += 8 - (bytes_read % 8);
+        if(errorChecking && (bytes_read != msg_size))
         {
-            metaData.size = (uint16_t)readField(2, &pos);
-            metaData.address = pos;
-            pos += metaData.size;
-            break;
+            throw RunTimeException(CRITICAL, RTE_ERROR, "message of type %d at position 0x%lx different size than specified: %d != %d", (int)msg_type, (unsigned long)pos, bytes_read, msg_size);
         }
 
-        case CONTIGUOUS_LAYOUT:
+        /* Check if Dataset Found */
+        if(highestDataLevel > dlvl)
         {
-            metaData.address = readField(metaData.offsetsize, &pos);
-            metaData.size = readField(metaData.lengthsize, &pos);
-            break;
+            pos = end; // go directly to end of header
+            break; // dataset found
         }
 
-        case CHUNKED_LAYOUT:
-        {
-            /* Read Number of Dimensions */
-            int chunk_num_dim = (int)readField(1, &pos) - 1; // dimensionality is plus one over actual number of dimensions
-            chunk_num_dim = MIN(chunk_num_dim, MAX_NDIMS);
-            if(errorChecking)
-            {
-                if((metaData.ndims != UNKNOWN_VALUE) && (chunk_num_dim != metaData.ndims))
-                {
-                    throw RunTimeException(CRITICAL, RTE_ERROR, "number of chunk dimensions does not match data dimensions: %d != %d", chunk_num_dim, metaData.ndims);
-                }
-            }
-
-            /* Read Address of B-Tree */
-            metaData.address = readField(metaData.offsetsize, &pos);
+        /* Update Position */
+        pos += bytes_read;
+    }
 
-            /* Read Dimensions */
-            if(chunk_num_dim > 0)
-            {
-                metaData.chunkelements = 1;
-                for(int d = 0; d < chunk_num_dim; d++)
-                {
-                    metaData.chunkdims[d] = (uint32_t)readField(4, &pos);
-                    metaData.chunkelements *= metaData.chunkdims[d];
-                }
-            }
+    /* Move Past Gap */
+    if(pos < end) pos = end;
 
-            /* Read Size of Data Element */
-            metaData.elementsize = (int)readField(4, &pos);
+    /* Check Size */
+    if(errorChecking)
+    {
+        if(pos != end)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "did not read correct number of bytes: %lu != %lu", (unsigned long)pos, (unsigned long)end);
+        }
+    }
 
-            /* Display Data Attributes */
-            if(verbose)
-            {
-                print2term("Chunk Element Size:                                              %d\n", (int)metaData.elementsize);
-                print2term("Number of Chunked Dimensions:                                    %d\n", (int)chunk_num_dim);
-                for(int d = 0; d < chunk_num_dim; d++)
-                {
-                    print2term("Chunk Dimension %d:                                               %d\n", d, (int)metaData.chunkdims[d]);
-                }
-            }
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
 
-            break;
-        }
+/*----------------------------------------------------------------------------
+ * readMessage
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readMessage (msg_type_t msg_type, uint64_t size, uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    switch(msg_type)
+    {
+        case DATASPACE_MSG:     return readDataspaceMsg(pos, hdr_flags, dlvl);
+        case LINK_INFO_MSG:     return readLinkInfoMsg(pos, hdr_flags, dlvl);
+        case DATATYPE_MSG:      return readDatatypeMsg(pos, hdr_flags, dlvl);
+        case FILL_VALUE_MSG:    return readFillValueMsg(pos, hdr_flags, dlvl);
+        case LINK_MSG:          return readLinkMsg(pos, hdr_flags, dlvl);
+        case DATA_LAYOUT_MSG:   return readDataLayoutMsg(pos, hdr_flags, dlvl);
+        case FILTER_MSG:        return readFilterMsg(pos, hdr_flags, dlvl);
+#ifdef H5CORO_ATTRIBUTE_SUPPORT
+        case ATTRIBUTE_MSG:     return readAttributeMsg(pos, hdr_flags, dlvl, size);
+#endif
+        case HEADER_CONT_MSG:   return readHeaderContMsg(pos, hdr_flags, dlvl);
+        case SYMBOL_TABLE_MSG:  return readSymbolTableMsg(pos, hdr_flags, dlvl);
+        case FILE_SPACE_INFO_MSG: return readFileSpaceInfoMsg(pos, hdr_flags, dlvl);
 
         default:
         {
-            if(errorChecking)
+            if(verbose)
             {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data layout: %d", (int)metaData.layout);
+                print2term("Skipped Message [%d]: 0x%x, %d, 0x%lx\n", dlvl, (int)msg_type, (int)size, (unsigned long)pos);
             }
+
+            return size;
         }
     }
-
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
 }
 
 /*----------------------------------------------------------------------------
- * readFilterMsg
+ * readDataspaceMsg
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readFilterMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+int H5FileBuffer::readDataspaceMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
 {
     (void)hdr_flags;
 
+    static const int MAX_DIM_PRESENT    = 0x1;
+    static const int PERM_INDEX_PRESENT = 0x2;
+
     uint64_t starting_position = pos;
 
-    /* Read Message Info */
-    uint64_t version = readField(1, &pos);
-    uint32_t num_filters = (uint32_t)readField(1, &pos);
-    pos += 6; // move past reserved bytes
+    uint8_t version         = (uint8_t)readField(1, &pos);
+    uint8_t dimensionality  = (uint8_t)readField(1, &pos);
+    uint8_t flags           = (uint8_t)readField(1, &pos);
+    pos += (version == 1) ? 5 : 1; // go past reserved bytes (version 1) or dataspace type (version 2)
 
     if(errorChecking)
     {
-        if(version != 1)
+        if(version != 1 && version != 2)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid filter version: %d", (int)version);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid dataspace version: %d", (int)version);
+        }
+
+        if(flags & PERM_INDEX_PRESENT)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported permutation indexes");
+        }
+
+        if(dimensionality > MAX_NDIMS)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported number of dimensions: %d", dimensionality);
         }
     }
 
     if(verbose)
     {
         print2term("\n----------------\n");
-        print2term("Filter Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("Dataspace Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
         print2term("----------------\n");
         print2term("Version:                                                         %d\n", (int)version);
-        print2term("Number of Filters:                                               %d\n", (int)num_filters);
+        print2term("Dimensionality:                                                  %d\n", (int)dimensionality);
+        print2term("Flags:                                                           0x%x\n", (int)flags);
     }
 
-    /* Read Filters */
-    for(int f = 0; f < (int)num_filters; f++)
+    /* Read and Populate Data Dimensions */
+    uint64_t num_elements = 0;
+    metaData.ndims = MIN(dimensionality, MAX_NDIMS);
+    if(metaData.ndims > 0)
     {
-        /* Read Filter Description */
-        filter_t filter             = (filter_t)readField(2, &pos);
-        uint16_t name_len           = (uint16_t)readField(2, &pos);
-        uint16_t flags              = (uint16_t)readField(2, &pos);
-        uint16_t num_parms          = (uint16_t)readField(2, &pos);
-
-        /* Read Name */
-        uint8_t filter_name[STR_BUFF_SIZE];
-        readByteArray(filter_name, name_len, &pos);
-        filter_name[name_len] = '\0';
-
-        /* Display */
-        if(verbose)
+        num_elements = 1;
+        for(int d = 0; d < metaData.ndims; d++)
         {
-            print2term("Filter Identification Value:                                     %d\n", (int)filter);
-            print2term("Flags:                                                           0x%x\n", (int)flags);
-            print2term("Number Client Data Values:                                       %d\n", (int)num_parms);
-            print2term("Filter Name:                                                     %s\n", filter_name);
+            metaData.dimensions[d] = readField(metaData.lengthsize, &pos);
+            num_elements *= metaData.dimensions[d];
+            if(verbose)
+            {
+                print2term("Dimension %d:                                                     %lu\n", (int)metaData.ndims, (unsigned long)metaData.dimensions[d]);
+            }
         }
 
-        /* Set Filter */
-        if(filter < NUM_FILTERS)
-        {
-            metaData.filter[filter] = true;
-        }
-        else
+        /* Read Maximum Dimensions */
+        for(int d = 0; d < metaData.ndims; d++)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid filter specified: %d", (int)filter);
+            if(flags & MAX_DIM_PRESENT) metaData.maxdims[d] = readField(metaData.lengthsize, &pos);
+            else                        metaData.maxdims[d] = metaData.dimensions[d];
         }
+    }
 
-        /* Client Data */
-        pos += num_parms * 4;
-
-        /* Handle Padding */
-        if(num_parms % 2 == 1)
-        {
-            pos += 4;
-        }
+    if(verbose)
+    {
+        print2term("Number of Elements:                                              %lu\n", (unsigned long)num_elements);
     }
 
     /* Return Bytes Read */
@@ -2687,852 +4212,2513 @@ int H5FileBuffer::readFilterMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
 }
 
 /*----------------------------------------------------------------------------
- * readAttributeMsg
+ * readLinkInfoMsg
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readAttributeMsg (uint64_t pos, uint8_t hdr_flags, int dlvl, uint64_t size)
+int H5FileBuffer::readLinkInfoMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
 {
-    (void)hdr_flags;
+    static const int MAX_CREATE_PRESENT_BIT     = 0x01;
+    static const int CREATE_ORDER_PRESENT_BIT   = 0x02;
 
     uint64_t starting_position = pos;
 
-    /* Read Message Info */
     uint64_t version = readField(1, &pos);
+    uint64_t flags = readField(1, &pos);
 
-    /* Error Check Info */
     if(errorChecking)
     {
-        uint64_t reserved0 = readField(1, &pos);
-
-        if(version != 1)
-        {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid attribute version: %d", (int)version);
-        }
-        else if(reserved0 != 0)
+        if(version != 0)
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved field: %d", (int)reserved0);
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link info version: %d", (int)version);
         }
     }
-    else
+
+    if(verbose)
     {
-        pos += 1;
+        print2term("\n----------------\n");
+        print2term("Link Information Message [%d], 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
     }
 
-    /* Get Sizes */
-    uint64_t name_size = readField(2, &pos);
-    uint64_t datatype_size = readField(2, &pos);
-    uint64_t dataspace_size = readField(2, &pos);
+    /* Read Maximum Creation Index (number of elements in group) */
+    if(flags & MAX_CREATE_PRESENT_BIT)
+    {
+        uint64_t max_create_index = readField(8, &pos);
+        if(verbose)
+        {
+            print2term("Maximum Creation Index:                                          %lu\n", (unsigned long)max_create_index);
+        }
+    }
 
-    /* Read Attribute Name */
-    if(name_size > STR_BUFF_SIZE)
+    /* Read Heap and Name Offsets */
+    uint64_t heap_address = readField(metaData.offsetsize, &pos);
+    uint64_t name_index = readField(metaData.offsetsize, &pos);
+    if(verbose)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "attribute name string exceeded maximum length: %lu, 0x%lx\n", (unsigned long)name_size, (unsigned long)pos);
+        print2term("Heap Address:                                                    %lX\n", (unsigned long)heap_address);
+        print2term("Name Index:                                                      %lX\n", (unsigned long)name_index);
     }
-    uint8_t attr_name[STR_BUFF_SIZE];
-    readByteArray(attr_name, name_size, &pos);
-    pos += (8 - (name_size % 8)) % 8; // align to next 8-byte boundary
 
-    if(errorChecking)
+    if(flags & CREATE_ORDER_PRESENT_BIT)
     {
-        if(attr_name[name_size - 1] != '\0')
+        uint64_t create_order_index = readField(8, &pos);
+        if(verbose)
         {
-            attr_name[name_size -1] = '\0';
-            throw RunTimeException(CRITICAL, RTE_ERROR, "attribute name string is not null terminated: %s, 0x%lx\n", attr_name, (unsigned long)pos);
+            print2term("Creation Order Index:                                            %lX\n", (unsigned long)create_order_index);
         }
     }
-    else
+
+    /* Follow Heap Address if Provided */
+    if((int)heap_address != -1)
     {
-        attr_name[name_size -1] = '\0';
+        readFractalHeap(LINK_MSG, heap_address, hdr_flags, dlvl);
     }
 
-    /* Display Attribute Message Information */
-    if(verbose)
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readDatatypeMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readDatatypeMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    /* Read Message Info */
+    uint64_t version_class = readField(4, &pos);
+    metaData.typesize = (int)readField(4, &pos);
+    uint64_t version = (version_class & 0xF0) >> 4;
+    uint64_t databits = version_class >> 8;
+
+    if(errorChecking)
+    {
+        if(version != 1)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid datatype version: %d", (int)version);
+        }
+    }
+
+    /* Set Data Type */
+    metaData.type = (data_type_t)(version_class & 0x0F);
+    if(verbose)
     {
         print2term("\n----------------\n");
-        print2term("Attribute Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("Datatype Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
         print2term("----------------\n");
         print2term("Version:                                                         %d\n", (int)version);
-        print2term("Name:                                                            %s\n", (const char*)attr_name);
-        print2term("Message Size:                                                    %d\n", (int)size);
-        print2term("Datatype Message Bytes:                                          %d\n", (int)datatype_size);
-        print2term("Dataspace Message Bytes:                                         %d\n", (int)dataspace_size);
+        print2term("Data Class:                                                      %d, %s\n", (int)metaData.type, type2str(metaData.type));
+        print2term("Data Size:                                                       %d\n", metaData.typesize);
+    }
+
+    /* Read Data Class Properties */
+    switch(metaData.type)
+    {
+        case FIXED_POINT_TYPE:
+        {
+            metaData.signedval = ((databits & 0x08) >> 3) == 1;
+
+            if(!verbose)
+            {
+                pos += 4;
+            }
+            else
+            {
+                unsigned int byte_order = databits & 0x1;
+                unsigned int pad_type   = (databits & 0x06) >> 1;
+
+                uint16_t bit_offset     = (uint16_t)readField(2, &pos);
+                uint16_t bit_precision  = (uint16_t)readField(2, &pos);
+
+                print2term("Byte Order:                                                      %d\n", (int)byte_order);
+                print2term("Pading Type:                                                     %d\n", (int)pad_type);
+                print2term("Signed Value:                                                    %d\n", (int)metaData.signedval);
+                print2term("Bit Offset:                                                      %d\n", (int)bit_offset);
+                print2term("Bit Precision:                                                   %d\n", (int)bit_precision);
+            }
+            break;
+        }
+
+        case FLOATING_POINT_TYPE:
+        {
+            if(!verbose)
+            {
+                pos += 12;
+            }
+            else
+            {
+                unsigned int byte_order = ((databits & 0x40) >> 5) | (databits & 0x1);
+                unsigned int pad_type = (databits & 0x0E) >> 1;
+                unsigned int mant_norm = (databits & 0x30) >> 4;
+                unsigned int sign_loc = (databits & 0xFF00) >> 8;
+
+                uint16_t bit_offset     = (uint16_t)readField(2, &pos);
+                uint16_t bit_precision  = (uint16_t)readField(2, &pos);
+                uint8_t  exp_location   =  (uint8_t)readField(1, &pos);
+                uint8_t  exp_size       =  (uint8_t)readField(1, &pos);
+                uint8_t  mant_location  =  (uint8_t)readField(1, &pos);
+                uint8_t  mant_size      =  (uint8_t)readField(1, &pos);
+                uint32_t exp_bias       = (uint32_t)readField(4, &pos);
+
+                print2term("Byte Order:                                                      %d\n", (int)byte_order);
+                print2term("Pading Type:                                                     %d\n", (int)pad_type);
+                print2term("Mantissa Normalization:                                          %d\n", (int)mant_norm);
+                print2term("Sign Location:                                                   %d\n", (int)sign_loc);
+                print2term("Bit Offset:                                                      %d\n", (int)bit_offset);
+                print2term("Bit Precision:                                                   %d\n", (int)bit_precision);
+                print2term("Exponent Location:                                               %d\n", (int)exp_location);
+                print2term("Exponent Size:                                                   %d\n", (int)exp_size);
+                print2term("Mantissa Location:                                               %d\n", (int)mant_location);
+                print2term("Mantissa Size:                                                   %d\n", (int)mant_size);
+                print2term("Exponent Bias:                                                   %d\n", (int)exp_bias);
+            }
+            break;
+        }
+
+        case VARIABLE_LENGTH_TYPE:
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "variable length data types require reading a global heap, which is not yet supported");
+#if 0
+            if(verbose)
+            {
+                unsigned int vt_type = databits & 0xF; // variable length type
+                unsigned int padding = (databits & 0xF0) >> 4;
+                unsigned int charset = (databits & 0xF00) >> 8;
+
+                const char* vt_type_str = "unknown";
+                if(vt_type == 0) vt_type_str = "Sequence";
+                else if(vt_type == 1) vt_type_str = "String";
+
+                const char* padding_str = "unknown";
+                if(padding == 0) padding_str = "Null Terminate";
+                else if(padding == 1) padding_str = "Null Pad";
+                else if(padding == 2) padding_str = "Space Pad";
+
+                const char* charset_str = "unknown";
+                if(charset == 0) charset_str = "ASCII";
+                else if(charset == 1) charset_str = "UTF-8";
+
+                print2term("Variable Type:                                                   %d %s\n", (int)vt_type, vt_type_str);
+                print2term("Padding Type:                                                    %d %s\n", (int)padding, padding_str);
+                print2term("Character Set:                                                   %d %s\n", (int)charset, charset_str);
+            }
+            pos += readDatatypeMsg (pos, hdr_flags, dlvl);
+            break;
+#endif
+        }
+
+        case STRING_TYPE:
+        {
+            if(verbose)
+            {
+                unsigned int padding = databits & 0x0F;
+                unsigned int charset = (databits & 0xF0) >> 4;
+
+                const char* padding_str = "unknown";
+                if(padding == 0) padding_str = "Null Terminate";
+                else if(padding == 1) padding_str = "Null Pad";
+                else if(padding == 2) padding_str = "Space Pad";
+
+                const char* charset_str = "unknown";
+                if(charset == 0) charset_str = "ASCII";
+                else if(charset == 1) charset_str = "UTF-8";
+
+                print2term("Padding Type:                                                    %d %s\n", (int)padding, padding_str);
+                print2term("Character Set:                                                   %d %s\n", (int)charset, charset_str);
+            }
+            break;
+        }
+
+        default:
+        {
+            if(errorChecking)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported datatype: %d", (int)metaData.type);
+            }
+            break;
+        }
+    }
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readFillValueMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readFillValueMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    uint64_t version = readField(1, &pos);
+
+    if(errorChecking)
+    {
+        if(version != 2 && version != 3)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid fill value version: %d", (int)version);
+        }
+    }
+
+    /* Version 3 Packs Times and Defined Flag into One Byte */
+    if(version == 3)
+    {
+        static const uint8_t FILL_VALUE_DEFINED_BIT = 0x20;
+
+        uint8_t flags = (uint8_t)readField(1, &pos);
+        if(verbose)
+        {
+            print2term("\n----------------\n");
+            print2term("Fill Value Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+            print2term("----------------\n");
+            print2term("Flags:                                                           0x%x\n", (int)flags);
+        }
+
+        if(flags & FILL_VALUE_DEFINED_BIT)
+        {
+            metaData.fillsize = (int)readField(4, &pos);
+            if(metaData.fillsize > 0)
+            {
+                metaData.fill.fill_ll = readField(metaData.fillsize, &pos);
+            }
+        }
+
+        uint64_t ending_position = pos;
+        return ending_position - starting_position;
+    }
+
+    if(!verbose)
+    {
+        pos += 2;
+    }
+    else
+    {
+        uint8_t space_allocation_time = (uint8_t)readField(1, &pos);
+        uint8_t fill_value_write_time = (uint8_t)readField(1, &pos);
+
+        print2term("\n----------------\n");
+        print2term("Fill Value Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Space Allocation Time:                                           %d\n", (int)space_allocation_time);
+        print2term("Fill Value Write Time:                                           %d\n", (int)fill_value_write_time);
+    }
+
+    uint8_t fill_value_defined = (uint8_t)readField(1, &pos);
+    if(fill_value_defined)
+    {
+        metaData.fillsize = (int)readField(4, &pos);
+        if(verbose)
+        {
+            print2term("Fill Value Size:                                                 %d\n", metaData.fillsize);
+        }
+
+        if(metaData.fillsize > 0)
+        {
+            uint64_t fill_value = readField(metaData.fillsize, &pos);
+            metaData.fill.fill_ll = fill_value;
+            if(verbose)
+            {
+                print2term("Fill Value:                                                      0x%llX\n", (unsigned long long)fill_value);
+            }
+        }
+    }
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readLinkMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readLinkMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    static const int SIZE_OF_LEN_OF_NAME_MASK   = 0x03;
+    static const int CREATE_ORDER_PRESENT_BIT   = 0x04;
+    static const int LINK_TYPE_PRESENT_BIT      = 0x08;
+    static const int CHAR_SET_PRESENT_BIT       = 0x10;
+
+    uint64_t starting_position = pos;
+
+    uint64_t version = readField(1, &pos);
+    uint64_t flags = readField(1, &pos);
+
+    if(errorChecking)
+    {
+        if(version != 1)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link version: %d", (int)version);
+        }
+    }
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Link Message [%d]: 0x%x, 0x%lx\n", dlvl, (unsigned)flags, (unsigned long)starting_position);
+        print2term("----------------\n");
+    }
+
+    /* Read Link Type */
+    uint8_t link_type = 0; // default to hard link
+    if(flags & LINK_TYPE_PRESENT_BIT)
+    {
+        link_type = readField(1, &pos);
+        if(verbose)
+        {
+            print2term("Link Type:                                                       %lu\n", (unsigned long)link_type);
+        }
+    }
+
+    /* Read Creation Order */
+    if(flags & CREATE_ORDER_PRESENT_BIT)
+    {
+        uint64_t create_order = readField(8, &pos);
+        if(verbose)
+        {
+            print2term("Creation Order:                                                  %lX\n", (unsigned long)create_order);
+        }
+    }
+
+    /* Read Character Set */
+    if(flags & CHAR_SET_PRESENT_BIT)
+    {
+        uint8_t char_set = readField(1, &pos);
+        if(verbose)
+        {
+            print2term("Character Set:                                                   %lu\n", (unsigned long)char_set);
+        }
+    }
+
+    /* Read Link Name */
+    int link_name_len_of_len = 1 << (flags & SIZE_OF_LEN_OF_NAME_MASK);
+    if(errorChecking && (link_name_len_of_len > 8))
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link name length of length: %d", (int)link_name_len_of_len);
+    }
+
+    uint64_t link_name_len = readField(link_name_len_of_len, &pos);
+    if(verbose)
+    {
+        print2term("Link Name Length:                                                %lu\n", (unsigned long)link_name_len);
+    }
+
+    uint8_t link_name[STR_BUFF_SIZE];
+    readByteArray(link_name, link_name_len, &pos);
+    link_name[link_name_len] = '\0';
+    if(verbose)
+    {
+        print2term("Link Name:                                                       %s\n", link_name);
+    }
+
+    /* Process Link Type */
+    if(link_type == 0) // hard link
+    {
+        uint64_t object_header_addr = readField(metaData.offsetsize, &pos);
+        if(verbose)
+        {
+            print2term("Hard Link - Object Header Address:                               0x%lx\n", object_header_addr);
+        }
+
+        if(dlvl < datasetPath.length())
+        {
+            if(StringLib::match((const char*)link_name, datasetPath[dlvl]))
+            {
+                highestDataLevel = dlvl + 1;
+                readObjHdr(object_header_addr, highestDataLevel);
+            }
+        }
+        else if(groupLinks)
+        {
+            groupLinks->add(StringLib::duplicate((const char*)link_name));
+        }
+    }
+    else if(link_type == 1) // soft link
+    {
+        uint16_t soft_link_len = readField(2, &pos);
+        uint8_t soft_link[STR_BUFF_SIZE];
+        readByteArray(soft_link, soft_link_len, &pos);
+        soft_link[soft_link_len] = '\0';
+        if(verbose)
+        {
+            print2term("Soft Link:                                                       %s\n", soft_link);
+        }
+    }
+    else if(link_type == 64) // external link
+    {
+        uint16_t ext_link_len = readField(2, &pos);
+        uint8_t ext_link[STR_BUFF_SIZE];
+        readByteArray(ext_link, ext_link_len, &pos);
+        ext_link[ext_link_len] = '\0';
+        if(verbose)
+        {
+            print2term("External Link:                                                   %s\n", ext_link);
+        }
+    }
+    else if(errorChecking)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid link type: %d", link_type);
+    }
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readDataLayoutMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readDataLayoutMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    /* Read Message Info */
+    uint64_t version = readField(1, &pos);
+    metaData.layout = (layout_t)readField(1, &pos);
+
+    if(errorChecking)
+    {
+        if(version != 3 && version != 4)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data layout version: %d", (int)version);
+        }
+    }
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Data Layout Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Version:                                                         %d\n", (int)version);
+        print2term("Layout:                                                          %d, %s\n", (int)metaData.layout, layout2str(metaData.layout));
+    }
+
+    /* Read Layout Classes */
+    switch(metaData.layout)
+    {
+        case COMPACT_LAYOUT:
+        {
+            metaData.size = (uint16_t)readField(2, &pos);
+            metaData.address = pos;
+            pos += metaData.size;
+            break;
+        }
+
+        case CONTIGUOUS_LAYOUT:
+        {
+            metaData.address = readField(metaData.offsetsize, &pos);
+            metaData.size = readField(metaData.lengthsize, &pos);
+            break;
+        }
+
+        case CHUNKED_LAYOUT:
+        {
+            /* Read Flags (version 4) */
+            uint8_t chunk_flags = (version >= 4) ? (uint8_t)readField(1, &pos) : 0;
+
+            /* Read Number of Dimensions */
+            int chunk_num_dim = (int)readField(1, &pos) - 1; // dimensionality is plus one over actual number of dimensions
+            chunk_num_dim = MIN(chunk_num_dim, MAX_NDIMS);
+            if(errorChecking)
+            {
+                if((metaData.ndims != UNKNOWN_VALUE) && (chunk_num_dim != metaData.ndims))
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "number of chunk dimensions does not match data dimensions: %d != %d", chunk_num_dim, metaData.ndims);
+                }
+            }
+
+            /* Read Address of B-Tree (version 3) and Size of Dimension Fields */
+            int dim_size_len = 4;
+            if(version < 4)
+            {
+                metaData.address = readField(metaData.offsetsize, &pos);
+            }
+            else
+            {
+                dim_size_len = (int)readField(1, &pos);
+            }
+
+            /* Read Dimensions */
+            if(chunk_num_dim > 0)
+            {
+                metaData.chunkelements = 1;
+                for(int d = 0; d < chunk_num_dim; d++)
+                {
+                    metaData.chunkdims[d] = (uint32_t)readField(dim_size_len, &pos);
+                    metaData.chunkelements *= metaData.chunkdims[d];
+                }
+            }
+
+            /* Read Size of Data Element */
+            metaData.elementsize = (int)readField(dim_size_len, &pos);
+
+            /* Read Chunk Index (version 4) */
+            if(version >= 4)
+            {
+                static const uint8_t SINGLE_INDEX_WITH_FILTER = 0x02;
+
+                metaData.chunkindex = (chunk_index_type_t)readField(1, &pos);
+                switch(metaData.chunkindex)
+                {
+                    case SINGLE_CHUNK_INDEX:
+                    {
+                        if(chunk_flags & SINGLE_INDEX_WITH_FILTER)
+                        {
+                            metaData.singlesize = readField(metaData.lengthsize, &pos);
+                            metaData.singlemask = (uint32_t)readField(4, &pos);
+                        }
+                        break;
+                    }
+                    case IMPLICIT_INDEX:            break;
+                    case FIXED_ARRAY_INDEX:         pos += 1; break; // page bits, repeated in array header
+                    case EXTENSIBLE_ARRAY_INDEX:    pos += 5; break; // creation parameters, repeated in array header
+                    case BTREE_V2_INDEX:            pos += 6; break; // node size, split and merge percents, repeated in tree header
+                    default:
+                    {
+                        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid chunk index type: %d", (int)metaData.chunkindex);
+                    }
+                }
+
+                /* Read Address of Chunk Index */
+                metaData.address = readField(metaData.offsetsize, &pos);
+            }
+
+            /* Display Data Attributes */
+            if(verbose)
+            {
+                print2term("Chunk Element Size:                                              %d\n", (int)metaData.elementsize);
+                print2term("Chunk Index Type:                                                %d\n", (int)metaData.chunkindex);
+                print2term("Number of Chunked Dimensions:                                    %d\n", (int)chunk_num_dim);
+                for(int d = 0; d < chunk_num_dim; d++)
+                {
+                    print2term("Chunk Dimension %d:                                               %d\n", d, (int)metaData.chunkdims[d]);
+                }
+            }
+
+            break;
+        }
+
+        default:
+        {
+            if(errorChecking)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data layout: %d", (int)metaData.layout);
+            }
+        }
+    }
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readFilterMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readFilterMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    /* Read Message Info */
+    uint64_t version = readField(1, &pos);
+    uint32_t num_filters = (uint32_t)readField(1, &pos);
+    if(version == 1) pos += 6; // move past reserved bytes
+
+    if(errorChecking)
+    {
+        if(version != 1 && version != 2)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid filter version: %d", (int)version);
+        }
+    }
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Filter Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Version:                                                         %d\n", (int)version);
+        print2term("Number of Filters:                                               %d\n", (int)num_filters);
+    }
+
+    /* Read Filters */
+    for(int f = 0; f < (int)num_filters; f++)
+    {
+        /* Read Filter Description */
+        filter_t filter             = (filter_t)readField(2, &pos);
+        uint16_t name_len           = (version == 1 || filter >= 256) ? (uint16_t)readField(2, &pos) : 0; // version 2 omits names of predefined filters
+        uint16_t flags              = (uint16_t)readField(2, &pos);
+        uint16_t num_parms          = (uint16_t)readField(2, &pos);
+
+        /* Read Name */
+        uint8_t filter_name[STR_BUFF_SIZE];
+        if(name_len >= STR_BUFF_SIZE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "filter name too long: %d", (int)name_len);
+        }
+        if(name_len > 0) readByteArray(filter_name, name_len, &pos);
+        filter_name[name_len] = '\0';
+
+        /* Display */
+        if(verbose)
+        {
+            print2term("Filter Identification Value:                                     %d\n", (int)filter);
+            print2term("Flags:                                                           0x%x\n", (int)flags);
+            print2term("Number Client Data Values:                                       %d\n", (int)num_parms);
+            print2term("Filter Name:                                                     %s\n", filter_name);
+        }
+
+        /* Set Filter */
+        if(filter < NUM_FILTERS)
+        {
+            metaData.filter[filter] = true;
+        }
+        else
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid filter specified: %d", (int)filter);
+        }
+
+        /* Client Data */
+        pos += num_parms * 4;
+
+        /* Handle Padding (version 1 only) */
+        if(version == 1 && num_parms % 2 == 1)
+        {
+            pos += 4;
+        }
+    }
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readAttributeMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readAttributeMsg (uint64_t pos, uint8_t hdr_flags, int dlvl, uint64_t size)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    /* Read Message Info */
+    uint64_t version = readField(1, &pos);
+
+    /* Error Check Info */
+    if(errorChecking)
+    {
+        uint64_t reserved0 = readField(1, &pos);
+
+        if(version != 1)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid attribute version: %d", (int)version);
+        }
+        else if(reserved0 != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid reserved field: %d", (int)reserved0);
+        }
+    }
+    else
+    {
+        pos += 1;
+    }
+
+    /* Get Sizes */
+    uint64_t name_size = readField(2, &pos);
+    uint64_t datatype_size = readField(2, &pos);
+    uint64_t dataspace_size = readField(2, &pos);
+
+    /* Read Attribute Name */
+    if(name_size > STR_BUFF_SIZE)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "attribute name string exceeded maximum length: %lu, 0x%lx\n", (unsigned long)name_size, (unsigned long)pos);
+    }
+    uint8_t attr_name[STR_BUFF_SIZE];
+    readByteArray(attr_name, name_size, &pos);
+    pos += (8 - (name_size % 8)) % 8; // align to next 8-byte boundary
+
+    if(errorChecking)
+    {
+        if(attr_name[name_size - 1] != '\0')
+        {
+            attr_name[name_size -1] = '\0';
+            throw RunTimeException(CRITICAL, RTE_ERROR, "attribute name string is not null terminated: %s, 0x%lx\n", attr_name, (unsigned long)pos);
+        }
+    }
+    else
+    {
+        attr_name[name_size -1] = '\0';
+    }
+
+    /* Display Attribute Message Information */
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Attribute Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Version:                                                         %d\n", (int)version);
+        print2term("Name:                                                            %s\n", (const char*)attr_name);
+        print2term("Message Size:                                                    %d\n", (int)size);
+        print2term("Datatype Message Bytes:                                          %d\n", (int)datatype_size);
+        print2term("Dataspace Message Bytes:                                         %d\n", (int)dataspace_size);
+    }
+
+    /* Shortcut Out if Not Desired Attribute */
+    if( ((dlvl + 1) != datasetPath.length()) ||
+        !StringLib::match((const char*)attr_name, datasetPath[dlvl]) )
+    {
+        return size;
+    }
+    else
+    {
+        highestDataLevel = dlvl + 1;
+    }
+
+    /* Read Datatype Message */
+    int datatype_bytes_read = readDatatypeMsg(pos, hdr_flags, dlvl);
+    if(errorChecking && datatype_bytes_read > (int)datatype_size)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read expected bytes for datatype message: %d > %d\n", (int)datatype_bytes_read, (int)datatype_size);
+    }
+    else
+    {
+        pos += datatype_bytes_read;
+        pos += (8 - (datatype_bytes_read % 8)) % 8; // align to next 8-byte boundary
+    }
+
+    /* Read Dataspace Message */
+    int dataspace_bytes_read = readDataspaceMsg(pos, hdr_flags, dlvl);
+    if(errorChecking && dataspace_bytes_read > (int)dataspace_size)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read expected bytes for dataspace message: %d > %d\n", (int)dataspace_bytes_read, (int)dataspace_size);
+    }
+    else
+    {
+        pos += dataspace_bytes_read;
+        pos += (8 - (dataspace_bytes_read % 8)) % 8; // align to next 8-byte boundary
+    }
+
+    /* Calculate Meta Data */
+    metaData.layout = CONTIGUOUS_LAYOUT;
+    LocalLib::set(metaData.filter, 0, sizeof(metaData.filter));
+    metaData.address = pos;
+    metaData.size = size - (pos - starting_position);
+
+    /* Move to End of Data */
+    pos += metaData.size;
+
+    /* Return Bytes Read */
+    uint64_t ending_position = pos;
+    return ending_position - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * readHeaderContMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readHeaderContMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    uint64_t starting_position = pos;
+
+    /* Continuation Info */
+    uint64_t hc_offset = readField(metaData.offsetsize, &pos);
+    uint64_t hc_length = readField(metaData.lengthsize, &pos);
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Header Continuation Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Offset:                                                          0x%lx\n", (unsigned long)hc_offset);
+        print2term("Length:                                                          %lu\n", (unsigned long)hc_length);
+    }
+
+    /* Read Continuation Block */
+    pos = hc_offset; // go to continuation block
+    if(hdr_flags & H5CORO_CUSTOM_V1_FLAG)
+    {
+       uint64_t end_of_chdr = hc_offset + hc_length;
+       pos += readMessagesV1 (pos, end_of_chdr, hdr_flags, dlvl);
+    }
+    else
+    {
+        /* Read Continuation Header */
+        if(errorChecking)
+        {
+            uint64_t signature = readField(4, &pos);
+            if(signature != H5_OCHK_SIGNATURE_LE)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header continuation signature: 0x%llX", (unsigned long long)signature);
+            }
+        }
+
+        /* Read Continuation Header Messages */
+        uint64_t end_of_chdr = hc_offset + hc_length - 4; // leave 4 bytes for checksum below
+        pos += readMessages (pos, end_of_chdr, hdr_flags, dlvl);
+
+        /* Verify Checksum */
+        uint64_t check_sum = readField(4, &pos);
+        if(errorChecking)
+        {
+            (void)check_sum;
+        }
+    }
+
+    /* Return Bytes Read */
+    return metaData.offsetsize + metaData.lengthsize;
+}
+
+/*----------------------------------------------------------------------------
+ * readSymbolTableMsg
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readSymbolTableMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    uint64_t starting_position = pos;
+
+    /* Symbol Table Info */
+    uint64_t btree_addr = readField(metaData.offsetsize, &pos);
+    uint64_t heap_addr = readField(metaData.offsetsize, &pos);
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Symbol Table Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("B-Tree Address:                                                  0x%lx\n", (unsigned long)btree_addr);
+        print2term("Heap Address:                                                    0x%lx\n", (unsigned long)heap_addr);
+    }
+
+    /* Read Heap Info */
+    pos = heap_addr;
+    if(!errorChecking)
+    {
+        pos += 24;
+    }
+    else
+    {
+        uint32_t signature = (uint32_t)readField(4, &pos);
+        if(signature != H5_HEAP_SIGNATURE_LE)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid heap signature: 0x%llX", (unsigned long long)signature);
+        }
+
+        uint8_t version = (uint8_t)readField(1, &pos);
+        if(version != 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect version of heap: %d", version);
+        }
+
+        pos += 19;
+    }
+    uint64_t head_data_addr = readField(metaData.offsetsize, &pos);
+
+    /* Go to Left-Most Node */
+    pos = btree_addr;
+    while(true)
+    {
+        /* Read Header Info */
+        if(!errorChecking)
+        {
+            pos += 5;
+        }
+        else
+        {
+            uint32_t signature = (uint32_t)readField(4, &pos);
+            if(signature != H5_TREE_SIGNATURE_LE)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid group b-tree signature: 0x%llX", (unsigned long long)signature);
+            }
+
+            uint8_t node_type = (uint8_t)readField(1, &pos);
+            if(node_type != 0)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "only group b-trees supported: %d", node_type);
+            }
+        }
+
+        /* Read Branch Info */
+        uint8_t node_level = (uint8_t)readField(1, &pos);
+        if(node_level == 0)
+        {
+            break;
+        }
+        else
+        {
+            pos += 2 + (2 * metaData.offsetsize) + metaData.lengthsize; // skip entries used, sibling addresses, and first key
+            pos = readField(metaData.offsetsize, &pos); // read and go to first child
+        }
+    }
+
+    /* Traverse Children Left to Right */
+    while(true)
+    {
+        uint16_t entries_used = (uint16_t)readField(2, &pos);
+        uint64_t left_sibling = readField(metaData.offsetsize, &pos); (void)left_sibling;
+        uint64_t right_sibling = readField(metaData.offsetsize, &pos);
+        uint64_t key0 = readField(metaData.lengthsize, &pos); (void)key0;
+        if(verbose && H5_EXTRA_DEBUG)
+        {
+            print2term("Entries Used:                                                    %d\n", (int)entries_used);
+            print2term("Left Sibling:                                                    0x%lx\n", (unsigned long)left_sibling);
+            print2term("Right Sibling:                                                   0x%lx\n", (unsigned long)right_sibling);
+            print2term("First Key:                                                       %ld\n", (unsigned long)key0);
+        }
+
+        /* Loop Through Entries in Current Node */
+        for(int entry = 0; entry < entries_used; entry++)
+        {
+            uint64_t symbol_table_addr = readField(metaData.offsetsize, &pos);
+            readSymbolTable(symbol_table_addr, head_data_addr, dlvl);
+            pos += metaData.lengthsize; // skip next key;
+            if(highestDataLevel > dlvl) break; // dataset found
+        }
+
+        /* Exit Loop or Go to Next Node */
+        if(H5_INVALID(right_sibling) || (highestDataLevel > dlvl))
+        {
+            break;
+        }
+        else
+        {
+            pos = right_sibling;
+        }
+
+        /* Read Header Info */
+        if(!errorChecking)
+        {
+            pos += 6;
+        }
+        else
+        {
+            uint32_t signature = (uint32_t)readField(4, &pos);
+            if(signature != H5_TREE_SIGNATURE_LE)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid group b-tree signature: 0x%llX", (unsigned long long)signature);
+            }
+
+            uint8_t node_type = (uint8_t)readField(1, &pos);
+            if(node_type != 0)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "only group b-trees supported: %d", node_type);
+            }
+
+            uint8_t node_level = (uint8_t)readField(1, &pos);
+            if(node_level != 0)
+            {
+                throw RunTimeException(CRITICAL, RTE_ERROR, "traversed to non-leaf node: %d", node_level);
+            }
+        }
+    }
+
+    /* Return Bytes Read */
+    return metaData.offsetsize + metaData.offsetsize;
+}
+
+/*----------------------------------------------------------------------------
+ * readFileSpaceInfoMsg
+ *
+ *  found in the superblock extension; records the page size when the file
+ *  was written with the paged file space strategy
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::readFileSpaceInfoMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+{
+    (void)hdr_flags;
+
+    static const int PAGE_STRATEGY = 1;
+
+    uint64_t starting_position = pos;
+
+    uint8_t version = (uint8_t)readField(1, &pos);
+    if(errorChecking && version != 1)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid file space info version: %d", (int)version);
+    }
+
+    /* File Space Info */
+    uint8_t strategy = (uint8_t)readField(1, &pos);
+    uint8_t persist = (uint8_t)readField(1, &pos);
+    uint64_t threshold = readField(metaData.lengthsize, &pos);
+    uint64_t page_size = readField(metaData.lengthsize, &pos);
+    pos += 2; // page end metadata threshold
+    pos += metaData.offsetsize; // end of allocated space before free space managers
+
+    if(strategy == PAGE_STRATEGY && page_size > 0)
+    {
+        ioPageSize = page_size;
+    }
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("File Space Info Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
+        print2term("----------------\n");
+        print2term("Strategy:                                                        %d\n", (int)strategy);
+        print2term("Persisting Free Space:                                           %d\n", (int)persist);
+        print2term("Free Space Threshold:                                            %lu\n", (unsigned long)threshold);
+        print2term("Page Size:                                                       %lu\n", (unsigned long)page_size);
+    }
+
+    /* Skip Addresses of Persisted Free Space Managers (one per page type) */
+    if(persist) pos += 12 * metaData.offsetsize;
+
+    /* Return Bytes Read */
+    return pos - starting_position;
+}
+
+/*----------------------------------------------------------------------------
+ * initMeta
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::initMeta (const char* url)
+{
+    LocalLib::copy(metaData.url, url, MAX_META_NAME_SIZE);
+    metaData.type           = UNKNOWN_TYPE;
+    metaData.typesize       = UNKNOWN_VALUE;
+    metaData.fill.fill_ll   = 0LL;
+    metaData.fillsize       = 0;
+    metaData.ndims          = UNKNOWN_VALUE;
+    metaData.chunkelements  = 0;
+    metaData.elementsize    = 0;
+    metaData.offsetsize     = 0;
+    metaData.lengthsize     = 0;
+    metaData.layout         = UNKNOWN_LAYOUT;
+    metaData.chunkindex     = BTREE_V1_INDEX;
+    metaData.singlesize     = 0;
+    metaData.singlemask     = 0;
+    metaData.address        = 0;
+    metaData.size           = 0;
+    for(int f = 0; f < NUM_FILTERS; f++)
+    {
+        metaData.filter[f]  = INVALID_FILTER;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * parseDataset
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::parseDataset (void)
+{
+    assert(datasetName);
+
+    /* Get Pointer to First Group in Dataset */
+    const char* gptr; // group pointer
+    if(datasetName[0] == '/')   gptr = &datasetName[1];
+    else                        gptr = &datasetName[0];
+
+    /* Build Path to Dataset */
+    while(*gptr != '\0')                            // empty path is the root group
+    {
+        datasetPath.add(gptr);                      // add group to dataset path
+        char* nptr = StringLib::find(gptr, '/');    // look for next group marker
+        if(nptr == NULL) break;                     // if not found, then exit
+        *nptr = '\0';                               // terminate group string
+        gptr = nptr + 1;                            // go to start of next group
+    }
+
+    if(verbose)
+    {
+        print2term("\n----------------\n");
+        print2term("Dataset: ");
+        for(int g = 0; g < datasetPath.length(); g++)
+        {
+            print2term("/%s", datasetPath[g]);
+        }
+        print2term("\n----------------\n");
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * type2str
+ *----------------------------------------------------------------------------*/
+const char* H5FileBuffer::type2str (data_type_t datatype)
+{
+    switch(datatype)
+    {
+        case FIXED_POINT_TYPE:      return "FIXED_POINT_TYPE";
+        case FLOATING_POINT_TYPE:   return "FLOATING_POINT_TYPE";
+        case TIME_TYPE:             return "TIME_TYPE";
+        case STRING_TYPE:           return "STRING_TYPE";
+        case BIT_FIELD_TYPE:        return "BIT_FIELD_TYPE";
+        case OPAQUE_TYPE:           return "OPAQUE_TYPE";
+        case COMPOUND_TYPE:         return "COMPOUND_TYPE";
+        case REFERENCE_TYPE:        return "REFERENCE_TYPE";
+        case ENUMERATED_TYPE:       return "ENUMERATED_TYPE";
+        case VARIABLE_LENGTH_TYPE:  return "VARIABLE_LENGTH_TYPE";
+        case ARRAY_TYPE:            return "ARRAY_TYPE";
+        default:                    return "UNKNOWN_TYPE";
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * layout2str
+ *----------------------------------------------------------------------------*/
+const char* H5FileBuffer::layout2str (layout_t layout)
+{
+    switch(layout)
+    {
+        case COMPACT_LAYOUT:    return "COMPACT_LAYOUT";
+        case CONTIGUOUS_LAYOUT: return "CONTIGUOUS_LAYOUT";
+        case CHUNKED_LAYOUT:    return "CHUNKED_LAYOUT";
+        default:                return "UNKNOWN_LAYOUT";
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * highestBit
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::highestBit (uint64_t value)
+{
+    int bit = 0;
+    while(value >>= 1) bit++;
+    return bit;
+}
+
+/*----------------------------------------------------------------------------
+ * inflateChunk
+ *----------------------------------------------------------------------------*/
+int H5FileBuffer::inflateChunk (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_size)
+{
+#ifdef H5CORO_LIBDEFLATE
+    /* Allocate Decompressor */
+    struct libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+    if(!decompressor)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to allocate libdeflate decompressor");
     }
 
-    /* Shortcut Out if Not Desired Attribute */
-    if( ((dlvl + 1) != datasetPath.length()) ||
-        !StringLib::match((const char*)attr_name, datasetPath[dlvl]) )
+    /* Decompress Chunk in One Shot */
+    size_t actual_size = 0;
+    enum libdeflate_result result = libdeflate_zlib_decompress(decompressor, input, input_size, output, output_size, &actual_size);
+    libdeflate_free_decompressor(decompressor);
+
+    /* Check Decompression Complete */
+    if(result != LIBDEFLATE_SUCCESS)
     {
-        return size;
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to inflate chunk with libdeflate: %d", (int)result);
     }
-    else
+
+    return 0;
+#else
+    int status;
+    z_stream strm;
+
+    /* Initialize z_stream State */
+    strm.zalloc     = Z_NULL;
+    strm.zfree      = Z_NULL;
+    strm.opaque     = Z_NULL;
+    strm.avail_in   = 0;
+    strm.next_in    = Z_NULL;
+
+    /* Initialize z_stream */
+    status = inflateInit(&strm);
+    if(status != Z_OK)
     {
-        highestDataLevel = dlvl + 1;
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to initialize z_stream: %d", status);
     }
 
-    /* Read Datatype Message */
-    int datatype_bytes_read = readDatatypeMsg(pos, hdr_flags, dlvl);
-    if(errorChecking && datatype_bytes_read > (int)datatype_size)
+    /* Decompress Until Entire Chunk is Processed */
+    strm.avail_in = input_size;
+    strm.next_in = input;
+
+    /* Decompress Chunk */
+    do
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read expected bytes for datatype message: %d > %d\n", (int)datatype_bytes_read, (int)datatype_size);
-    }
-    else
+        strm.avail_out = output_size;
+        strm.next_out = output;
+        status = inflate(&strm, Z_NO_FLUSH);
+        if(status != Z_OK) break;
+    } while (strm.avail_out == 0);
+
+    /* Clean Up z_stream */
+    inflateEnd(&strm);
+
+    /* Check Decompression Complete */
+    if(status != Z_STREAM_END)
     {
-        pos += datatype_bytes_read;
-        pos += (8 - (datatype_bytes_read % 8)) % 8; // align to next 8-byte boundary
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to inflate entire z_stream: %d", status);
     }
 
-    /* Read Dataspace Message */
-    int dataspace_bytes_read = readDataspaceMsg(pos, hdr_flags, dlvl);
-    if(errorChecking && dataspace_bytes_read > (int)dataspace_size)
+    return 0;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * inflateProcess
+ *
+ *  inflates a compressed chunk and places the requested bytes of it into
+ *  the output; the scratch buffer must hold an entire uncompressed chunk
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::inflateProcess (uint8_t* input, uint32_t input_size, uint8_t* output, uint64_t chunk_index, int64_t chunk_bytes, uint8_t* scratch)
+{
+    if((chunk_bytes == dataChunkBufferSize) && (!metaData.filter[SHUFFLE_FILTER]))
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read expected bytes for dataspace message: %d > %d\n", (int)dataspace_bytes_read, (int)dataspace_size);
+        /* Inflate Directly into Data Buffer */
+        inflateChunk(input, input_size, output, chunk_bytes);
     }
     else
     {
-        pos += dataspace_bytes_read;
-        pos += (8 - (dataspace_bytes_read % 8)) % 8; // align to next 8-byte boundary
-    }
-
-    /* Calculate Meta Data */
-    metaData.layout = CONTIGUOUS_LAYOUT;
-    LocalLib::set(metaData.filter, 0, sizeof(metaData.filter));
-    metaData.address = pos;
-    metaData.size = size - (pos - starting_position);
+        /* Inflate into Scratch Buffer */
+        inflateChunk(input, input_size, scratch, dataChunkBufferSize);
 
-    /* Move to End of Data */
-    pos += metaData.size;
-
-    /* Return Bytes Read */
-    uint64_t ending_position = pos;
-    return ending_position - starting_position;
+        if(metaData.filter[SHUFFLE_FILTER])
+        {
+            /* Shuffle Scratch Buffer into Data Buffer */
+            shuffleChunk(scratch, dataChunkBufferSize, output, chunk_index, chunk_bytes, metaData.typesize);
+        }
+        else
+        {
+            /* Copy Scratch Buffer into Data Buffer */
+            LocalLib::copy(output, &scratch[chunk_index], chunk_bytes);
+        }
+    }
 }
 
 /*----------------------------------------------------------------------------
- * readHeaderContMsg
+ * inflateDispatch
+ *
+ *  hands ownership of the input buffer to the inflate pool; blocks while
+ *  the number of outstanding chunks for this read is at its limit
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readHeaderContMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+void H5FileBuffer::inflateDispatch (uint8_t* input, uint32_t input_size, uint8_t* output, uint64_t chunk_index, int64_t chunk_bytes)
 {
-    uint64_t starting_position = pos;
+    inflate_rqst_t rqst = {
+        .h5file         = this,
+        .input          = input,
+        .input_size     = input_size,
+        .output         = output,
+        .chunk_index    = chunk_index,
+        .chunk_bytes    = chunk_bytes
+    };
 
-    /* Continuation Info */
-    uint64_t hc_offset = readField(metaData.offsetsize, &pos);
-    uint64_t hc_length = readField(metaData.lengthsize, &pos);
+    /* Throttle Outstanding Chunks */
+    inflateCond.lock();
+    {
+        while(inflatePending >= (inflatePoolSize * INFLATE_QUEUE_FACTOR))
+        {
+            inflateCond.wait(0, SYS_TIMEOUT);
+        }
+        inflatePending++;
+    }
+    inflateCond.unlock();
 
-    if(verbose)
+    /* Post Request */
+    int post_status = inflatePub->postCopy(&rqst, sizeof(inflate_rqst_t), IO_PEND);
+    if(post_status <= 0)
     {
-        print2term("\n----------------\n");
-        print2term("Header Continuation Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("Offset:                                                          0x%lx\n", (unsigned long)hc_offset);
-        print2term("Length:                                                          %lu\n", (unsigned long)hc_length);
+        inflateCond.lock();
+        {
+            inflatePending--;
+        }
+        inflateCond.unlock();
+
+        /* Inflate on Calling Thread */
+        mlog(WARNING, "Failed to post inflate request for %s: %d", datasetPrint, post_status);
+        try
+        {
+            inflateProcess(input, input_size, output, chunk_index, chunk_bytes, dataChunkBuffer);
+        }
+        catch(const RunTimeException& e)
+        {
+            delete [] input;
+            throw;
+        }
+        delete [] input;
     }
+}
 
-    /* Read Continuation Block */
-    pos = hc_offset; // go to continuation block
-    if(hdr_flags & H5CORO_CUSTOM_V1_FLAG)
+/*----------------------------------------------------------------------------
+ * inflateWait
+ *
+ *  returns false if any of the chunks handed off to the inflate pool failed
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::inflateWait (void)
+{
+    bool status;
+    inflateCond.lock();
     {
-       uint64_t end_of_chdr = hc_offset + hc_length;
-       pos += readMessagesV1 (pos, end_of_chdr, hdr_flags, dlvl);
+        while(inflatePending > 0)
+        {
+            inflateCond.wait(0, SYS_TIMEOUT);
+        }
+        status = !inflateFailed;
     }
-    else
+    inflateCond.unlock();
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * inflateThread
+ *----------------------------------------------------------------------------*/
+void* H5FileBuffer::inflateThread (void* parm)
+{
+    (void)parm;
+
+    uint8_t* scratch = NULL;
+    int64_t scratch_size = 0;
+
+    while(inflateActive)
     {
-        /* Read Continuation Header */
-        if(errorChecking)
+        inflate_rqst_t rqst;
+        int recv_status = inflateSub->receiveCopy(&rqst, sizeof(inflate_rqst_t), SYS_TIMEOUT);
+        if(recv_status > 0)
         {
-            uint64_t signature = readField(4, &pos);
-            if(signature != H5_OCHK_SIGNATURE_LE)
+            H5FileBuffer* h5file = rqst.h5file;
+
+            /* Grow Scratch Buffer to Hold Uncompressed Chunk */
+            if(scratch_size < h5file->dataChunkBufferSize)
             {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid header continuation signature: 0x%llX", (unsigned long long)signature);
+                delete [] scratch;
+                scratch_size = h5file->dataChunkBufferSize;
+                scratch = new uint8_t [scratch_size];
             }
-        }
 
-        /* Read Continuation Header Messages */
-        uint64_t end_of_chdr = hc_offset + hc_length - 4; // leave 4 bytes for checksum below
-        pos += readMessages (pos, end_of_chdr, hdr_flags, dlvl);
+            /* Inflate Chunk */
+            bool valid = true;
+            try
+            {
+                h5file->inflateProcess(rqst.input, rqst.input_size, rqst.output, rqst.chunk_index, rqst.chunk_bytes, scratch);
+            }
+            catch(const RunTimeException& e)
+            {
+                mlog(e.level(), "Failure inflating chunk of %s: %s", h5file->datasetPrint, e.what());
+                valid = false;
+            }
+            delete [] rqst.input;
 
-        /* Verify Checksum */
-        uint64_t check_sum = readField(4, &pos);
-        if(errorChecking)
+            /* Signal Complete (h5file must not be accessed after unlock) */
+            h5file->inflateCond.lock();
+            {
+                if(!valid) h5file->inflateFailed = true;
+                h5file->inflatePending--;
+                h5file->inflateCond.signal(0, Cond::NOTIFY_ALL);
+            }
+            h5file->inflateCond.unlock();
+        }
+        else if(recv_status != MsgQ::STATE_TIMEOUT)
         {
-            (void)check_sum;
+            mlog(CRITICAL, "Failed to receive inflate request: %d", recv_status);
+            break;
         }
     }
 
-    /* Return Bytes Read */
-    return metaData.offsetsize + metaData.lengthsize;
+    delete [] scratch;
+
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------
- * readSymbolTableMsg
+ * shuffleChunk
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::readSymbolTableMsg (uint64_t pos, uint8_t hdr_flags, int dlvl)
+int H5FileBuffer::shuffleChunk (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_offset, uint32_t output_size, int type_size)
 {
-    (void)hdr_flags;
+    if(type_size <= 0 || type_size > 8)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data size to perform shuffle on: %d", type_size);
+    }
 
-    uint64_t starting_position = pos;
+    int64_t dst_index = 0;
+    int64_t shuffle_block_size = input_size / type_size;
+    int64_t num_elements = output_size / type_size;
+    int64_t start_element = output_offset / type_size;
+    int64_t element_index = start_element;
 
-    /* Symbol Table Info */
-    uint64_t btree_addr = readField(metaData.offsetsize, &pos);
-    uint64_t heap_addr = readField(metaData.offsetsize, &pos);
+    /* Vectorized Unshuffle */
+    shuffle_kernel_t kernel = (type_size > 0 && type_size <= MAX_SHUFFLE_TYPESIZE) ? shuffleKernels[type_size] : NULL;
+    if(kernel)
+    {
+        int64_t elements_processed = kernel(input, shuffle_block_size, output, start_element, num_elements);
+        element_index += elements_processed;
+        dst_index += elements_processed * type_size;
+    }
 
-    if(verbose)
+    /* Scalar Unshuffle (remaining elements) */
+    for(; element_index < (start_element + num_elements); element_index++)
     {
-        print2term("\n----------------\n");
-        print2term("Symbol Table Message [%d]: 0x%lx\n", dlvl, (unsigned long)starting_position);
-        print2term("----------------\n");
-        print2term("B-Tree Address:                                                  0x%lx\n", (unsigned long)btree_addr);
-        print2term("Heap Address:                                                    0x%lx\n", (unsigned long)heap_addr);
+        for(int64_t val_index = 0; val_index < type_size; val_index++)
+        {
+            int64_t src_index = (val_index * shuffle_block_size) + element_index;
+            output[dst_index++] = input[src_index];
+        }
     }
 
-    /* Read Heap Info */
-    pos = heap_addr;
-    if(!errorChecking)
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ * metaGetKey
+ *----------------------------------------------------------------------------*/
+uint64_t H5FileBuffer::metaGetKey (const char* url)
+{
+    uint64_t key_value = 0;
+    uint64_t* url_ptr = (uint64_t*)url;
+    for(int i = 0; i < MAX_META_NAME_SIZE; i+=sizeof(uint64_t))
     {
-        pos += 24;
+        key_value += *url_ptr;
+        url_ptr++;
     }
-    else
+    return key_value;
+}
+
+/*----------------------------------------------------------------------------
+ * metaGetRange
+ *
+ *  uses the meta repository to determine the byte range in the file that a
+ *  read of the dataset will need; for chunked layouts this is the same span
+ *  readDataset would prefetch; returns false if unknown
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::metaGetRange (const char* resource, const char* dataset, long startrow, long numrows, io_range_t* range)
+{
+    /* Look Up Meta Data */
+    meta_entry_t meta;
+    bool meta_found = false;
+    try
     {
-        uint32_t signature = (uint32_t)readField(4, &pos);
-        if(signature != H5_HEAP_SIGNATURE_LE)
+        char meta_url[MAX_META_NAME_SIZE];
+        metaGetUrl(meta_url, resource, dataset);
+        uint64_t meta_key = metaGetKey(meta_url);
+        if(metaRepo.find(meta_key, &meta))
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid heap signature: 0x%llX", (unsigned long long)signature);
+            meta_found = StringLib::match(meta.url, meta_url, MAX_META_NAME_SIZE);
         }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(DEBUG, "Unable to look up range of %s: %s", dataset, e.what());
+    }
 
-        uint8_t version = (uint8_t)readField(1, &pos);
-        if(version != 0)
+    if(!meta_found || meta.typesize <= 0 || meta.ndims < 0 || H5_INVALID(meta.address))
+    {
+        return false;
+    }
+
+    /* Calculate Rows */
+    uint64_t row_size = meta.typesize;
+    for(int d = 1; d < meta.ndims; d++)
+    {
+        row_size *= meta.dimensions[d];
+    }
+    uint64_t first_dimension = (meta.ndims > 0) ? meta.dimensions[0] : 1;
+    if(numrows == ALL_ROWS) numrows = first_dimension;
+    if((uint64_t)(startrow + numrows) > first_dimension)
+    {
+        return false;
+    }
+
+    /* Calculate Range */
+    uint64_t buffer_offset = row_size * startrow;
+    int64_t buffer_size = row_size * numrows;
+    if(buffer_size <= 0)
+    {
+        return false;
+    }
+    else if(meta.layout == CONTIGUOUS_LAYOUT)
+    {
+        range->pos = meta.address + buffer_offset;
+        range->size = buffer_size;
+        return true;
+    }
+    else if(meta.layout == CHUNKED_LAYOUT && buffer_offset < (uint64_t)buffer_size)
+    {
+        range->pos = meta.address;
+        range->size = buffer_offset + buffer_size;
+        return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * metaGetChunkRows
+ *
+ *  uses the meta repository to determine the number of rows spanned by each
+ *  chunk of the dataset; returns 0 if unknown or the dataset is not chunked
+ *----------------------------------------------------------------------------*/
+long H5FileBuffer::metaGetChunkRows (const char* resource, const char* dataset)
+{
+    /* Look Up Meta Data */
+    meta_entry_t meta;
+    bool meta_found = false;
+    try
+    {
+        char meta_url[MAX_META_NAME_SIZE];
+        metaGetUrl(meta_url, resource, dataset);
+        uint64_t meta_key = metaGetKey(meta_url);
+        if(metaRepo.find(meta_key, &meta))
         {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "incorrect version of heap: %d", version);
+            meta_found = StringLib::match(meta.url, meta_url, MAX_META_NAME_SIZE);
         }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(DEBUG, "Unable to look up chunks of %s: %s", dataset, e.what());
+    }
 
-        pos += 19;
+    if(!meta_found || meta.layout != CHUNKED_LAYOUT || meta.ndims <= 0)
+    {
+        return 0;
     }
-    uint64_t head_data_addr = readField(metaData.offsetsize, &pos);
 
-    /* Go to Left-Most Node */
-    pos = btree_addr;
-    while(true)
+    return (long)meta.chunkdims[0];
+}
+
+/*----------------------------------------------------------------------------
+ * listGroup
+ *
+ *  adds the names of the links held by the group to the list and returns
+ *  true, or returns false if the path names a dataset; listings are kept in
+ *  the group repository so that repeated traversals of a granule only walk
+ *  the file once
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::listGroup (const Asset* asset, const char* resource, const char* group, List<const char*>* links, io_context_t* context)
+{
+    /* Check Group Repository */
+    char meta_url[MAX_META_NAME_SIZE];
+    metaGetUrl(meta_url, resource, group);
+    uint64_t meta_key = metaGetKey(meta_url);
+    group_entry_t* entry = new group_entry_t;
+    if(groupRepo.find(meta_key, entry) && StringLib::match(entry->url, meta_url, MAX_META_NAME_SIZE))
     {
-        /* Read Header Info */
-        if(!errorChecking)
+        const char* name = entry->names;
+        for(int i = 0; i < entry->num_links; i++)
         {
-            pos += 5;
+            links->add(StringLib::duplicate(name));
+            name += StringLib::size(name) + 1;
         }
-        else
-        {
-            uint32_t signature = (uint32_t)readField(4, &pos);
-            if(signature != H5_TREE_SIGNATURE_LE)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid group b-tree signature: 0x%llX", (unsigned long long)signature);
-            }
+        bool is_group = entry->group;
+        delete entry;
+        return is_group;
+    }
 
-            uint8_t node_type = (uint8_t)readField(1, &pos);
-            if(node_type != 0)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "only group b-trees supported: %d", node_type);
-            }
-        }
+    /* Walk File to Group */
+    bool is_group;
+    try
+    {
+        info_t info;
+        H5FileBuffer h5file(&info, context, asset, resource, group, 0, 0, false, false, true, NULL, 0, links);
+        is_group = (h5file.metaData.layout == UNKNOWN_LAYOUT);
+    }
+    catch(const RunTimeException&)
+    {
+        delete entry;
+        throw;
+    }
 
-        /* Read Branch Info */
-        uint8_t node_level = (uint8_t)readField(1, &pos);
-        if(node_level == 0)
+    /* Add Listing to Group Repository */
+    LocalLib::copy(entry->url, meta_url, MAX_META_NAME_SIZE);
+    entry->group = is_group;
+    entry->num_links = links->length();
+    long offset = 0;
+    for(int i = 0; i < links->length() && offset >= 0; i++)
+    {
+        long len = StringLib::size((*links)[i]) + 1;
+        if(offset + len <= GROUP_NAMES_SIZE)
         {
-            break;
+            LocalLib::copy(&entry->names[offset], (*links)[i], len);
+            offset += len;
         }
         else
         {
-            pos += 2 + (2 * metaData.offsetsize) + metaData.lengthsize; // skip entries used, sibling addresses, and first key
-            pos = readField(metaData.offsetsize, &pos); // read and go to first child
+            offset = -1; // listing too large to be held
         }
     }
-
-    /* Traverse Children Left to Right */
-    while(true)
+    if(offset >= 0)
     {
-        uint16_t entries_used = (uint16_t)readField(2, &pos);
-        uint64_t left_sibling = readField(metaData.offsetsize, &pos); (void)left_sibling;
-        uint64_t right_sibling = readField(metaData.offsetsize, &pos);
-        uint64_t key0 = readField(metaData.lengthsize, &pos); (void)key0;
-        if(verbose && H5_EXTRA_DEBUG)
-        {
-            print2term("Entries Used:                                                    %d\n", (int)entries_used);
-            print2term("Left Sibling:                                                    0x%lx\n", (unsigned long)left_sibling);
-            print2term("Right Sibling:                                                   0x%lx\n", (unsigned long)right_sibling);
-            print2term("First Key:                                                       %ld\n", (unsigned long)key0);
-        }
+        groupRepo.add(meta_key, *entry, true);
+    }
+    delete entry;
 
-        /* Loop Through Entries in Current Node */
-        for(int entry = 0; entry < entries_used; entry++)
-        {
-            uint64_t symbol_table_addr = readField(metaData.offsetsize, &pos);
-            readSymbolTable(symbol_table_addr, head_data_addr, dlvl);
-            pos += metaData.lengthsize; // skip next key;
-            if(highestDataLevel > dlvl) break; // dataset found
-        }
+    return is_group;
+}
 
-        /* Exit Loop or Go to Next Node */
-        if(H5_INVALID(right_sibling) || (highestDataLevel > dlvl))
-        {
-            break;
-        }
-        else
+/*----------------------------------------------------------------------------
+ * metaGetUrl
+ *----------------------------------------------------------------------------*/
+void H5FileBuffer::metaGetUrl (char* url, const char* resource, const char* dataset)
+{
+    /* Prepare File Name */
+    const char* filename_ptr = resource;
+    const char* char_ptr = resource;
+    while(*char_ptr)
+    {
+        if(*char_ptr == '/')
         {
-            pos = right_sibling;
+            filename_ptr = char_ptr + 1;
         }
 
-        /* Read Header Info */
-        if(!errorChecking)
-        {
-            pos += 6;
-        }
-        else
-        {
-            uint32_t signature = (uint32_t)readField(4, &pos);
-            if(signature != H5_TREE_SIGNATURE_LE)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid group b-tree signature: 0x%llX", (unsigned long long)signature);
-            }
+        char_ptr++;
+    }
 
-            uint8_t node_type = (uint8_t)readField(1, &pos);
-            if(node_type != 0)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "only group b-trees supported: %d", node_type);
-            }
+    /* Prepare Dataset Name */
+    const char* dataset_name_ptr = dataset;
+    if(dataset[0] == '/') dataset_name_ptr++;
 
-            uint8_t node_level = (uint8_t)readField(1, &pos);
-            if(node_level != 0)
-            {
-                throw RunTimeException(CRITICAL, RTE_ERROR, "traversed to non-leaf node: %d", node_level);
-            }
-        }
+    /* Build URL */
+    LocalLib::set(url, 0, MAX_META_NAME_SIZE);
+    StringLib::format(url, MAX_META_NAME_SIZE, "%s/%s", filename_ptr, dataset_name_ptr);
+
+    /* Check URL Fits (at least 2 null terminators) */
+    if(url[MAX_META_NAME_SIZE - 2] != '\0')
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "truncated meta repository url: %s", url);
     }
+}
 
-    /* Return Bytes Read */
-    return metaData.offsetsize + metaData.offsetsize;
+/*----------------------------------------------------------------------------
+ * metaWriteEntry
+ *
+ *  meta repository iterator used by metaSave; stops the walk on a write error
+ *----------------------------------------------------------------------------*/
+bool H5FileBuffer::metaWriteEntry (uint64_t key, const meta_entry_t& entry, void* parm)
+{
+    fileptr_t fp = (fileptr_t)parm;
+    return (fwrite(&key, sizeof(key), 1, fp) == 1) && (fwrite(&entry, sizeof(entry), 1, fp) == 1);
 }
 
+/******************************************************************************
+ * HDF5 LITE LIBRARY
+ ******************************************************************************/
+
+Publisher*   H5Coro::rqstPub;
+Subscriber*  H5Coro::rqstSub;
+bool         H5Coro::readerActive;
+Thread**     H5Coro::readerPids;
+int          H5Coro::threadPoolSize;
+LatencyHistogram* H5Coro::readLatency = NULL;
+Dictionary<H5Coro::shared_read_t*> H5Coro::sharedReads;
+Mutex        H5Coro::sharedMutex;
+
 /*----------------------------------------------------------------------------
- * parseDataset
+ * init
  *----------------------------------------------------------------------------*/
-void H5FileBuffer::parseDataset (void)
+void H5Coro::init (int num_threads, int num_inflaters)
 {
-    assert(datasetName);
+    H5FileBuffer::initCache();
+    H5FileBuffer::initInflaters(num_inflaters);
+    H5FileBuffer::initShuffle();
 
-    /* Get Pointer to First Group in Dataset */
-    const char* gptr; // group pointer
-    if(datasetName[0] == '/')   gptr = &datasetName[1];
-    else                        gptr = &datasetName[0];
+    readLatency = new LatencyHistogram("h5coro", "read");
+    rqstPub = new Publisher(NULL);
 
-    /* Build Path to Dataset */
-    while(true)
+    if(num_threads > 0)
     {
-        datasetPath.add(gptr);                      // add group to dataset path
-        char* nptr = StringLib::find(gptr, '/');    // look for next group marker
-        if(nptr == NULL) break;                     // if not found, then exit
-        *nptr = '\0';                               // terminate group string
-        gptr = nptr + 1;                            // go to start of next group
+        readerActive = true;
+        rqstSub = new Subscriber(*rqstPub);
+        threadPoolSize = num_threads;
+        readerPids = new Thread* [threadPoolSize];
+        Thread::attr_t attr = {.name = "h5.reader", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
+        for(int t = 0; t < threadPoolSize; t++)
+        {
+            readerPids[t] = new Thread(reader_thread, NULL, attr);
+        }
+    }
+    else
+    {
+        readerActive = false;
+        rqstSub = NULL;
+        threadPoolSize = 0;
+        readerPids = NULL;
     }
+}
 
-    if(verbose)
+/*----------------------------------------------------------------------------
+ * deinit
+ *----------------------------------------------------------------------------*/
+void H5Coro::deinit (void)
+{
+    if(readerActive)
     {
-        print2term("\n----------------\n");
-        print2term("Dataset: ");
-        for(int g = 0; g < datasetPath.length(); g++)
+        readerActive = false;
+        for(int t = 0; t < threadPoolSize; t++)
         {
-            print2term("/%s", datasetPath[g]);
+            delete readerPids[t];
         }
-        print2term("\n----------------\n");
+        if(readerPids) delete [] readerPids;
+        if(rqstSub) delete rqstSub;
     }
+
+    if(rqstPub) delete rqstPub;
+    delete readLatency;
+    readLatency = NULL;
+
+    H5FileBuffer::deinitInflaters();
+    H5FileBuffer::deinitCache();
 }
 
 /*----------------------------------------------------------------------------
- * type2str
+ * read
  *----------------------------------------------------------------------------*/
-const char* H5FileBuffer::type2str (data_type_t datatype)
+H5Coro::info_t H5Coro::read (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context, bool _meta_only)
 {
-    switch(datatype)
+    LatencyHistogram::Sample sample(readLatency);
+    info_t info;
+
+    /* Start Trace */
+    uint32_t parent_trace_id = EventLib::grabId();
+    uint32_t trace_id = start_trace(INFO, parent_trace_id, "h5coro_read", "{\"asset\":\"%s\", \"resource\":\"%s\", \"dataset\":\"%s\"}", asset->getName(), resource, datasetname);
+
+    /* Start Readahead of Sibling Datasets */
+    if(context && !_meta_only)
     {
-        case FIXED_POINT_TYPE:      return "FIXED_POINT_TYPE";
-        case FLOATING_POINT_TYPE:   return "FLOATING_POINT_TYPE";
-        case TIME_TYPE:             return "TIME_TYPE";
-        case STRING_TYPE:           return "STRING_TYPE";
-        case BIT_FIELD_TYPE:        return "BIT_FIELD_TYPE";
-        case OPAQUE_TYPE:           return "OPAQUE_TYPE";
-        case COMPOUND_TYPE:         return "COMPOUND_TYPE";
-        case REFERENCE_TYPE:        return "REFERENCE_TYPE";
-        case ENUMERATED_TYPE:       return "ENUMERATED_TYPE";
-        case VARIABLE_LENGTH_TYPE:  return "VARIABLE_LENGTH_TYPE";
-        case ARRAY_TYPE:            return "ARRAY_TYPE";
-        default:                    return "UNKNOWN_TYPE";
+        readaheadTrigger(asset, resource, datasetname, startrow, numrows, context);
+    }
+
+    /* Open Resource and Read Dataset */
+    H5FileBuffer h5file(&info, context, asset, resource, datasetname, startrow, numrows, true, H5_VERBOSE, _meta_only);
+    if(info.data)
+    {
+        translate(&info, valtype, col, datasetname);
     }
+    else if(!_meta_only)
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read dataset: %s", datasetname);
+    }
+
+    /* Stop Trace */
+    stop_trace(INFO, trace_id);
+
+    /* Log Info Message */
+    mlog(DEBUG, "Read %d elements (%ld bytes) from %s/%s", info.elements, info.datasize, asset->getName(), datasetname);
+
+    /* Return Info */
+    return info;
 }
 
 /*----------------------------------------------------------------------------
- * layout2str
+ * translate
+ *
+ *  extracts the requested column and converts the values to the requested
+ *  type, replacing the data buffer in the info structure
  *----------------------------------------------------------------------------*/
-const char* H5FileBuffer::layout2str (layout_t layout)
+void H5Coro::translate (info_t* info, RecordObject::valType_t valtype, long col, const char* datasetname)
 {
-    switch(layout)
+    bool data_valid = true;
+
+    /* Perform Column Translation */
+    if((info->numcols > 1) && (col != ALL_COLS))
     {
-        case COMPACT_LAYOUT:    return "COMPACT_LAYOUT";
-        case CONTIGUOUS_LAYOUT: return "CONTIGUOUS_LAYOUT";
-        case CHUNKED_LAYOUT:    return "CHUNKED_LAYOUT";
-        default:                return "UNKNOWN_LAYOUT";
+        /* Allocate Column Buffer */
+        int64_t tbuf_size = info->datasize / info->numcols;
+        uint8_t* tbuf = new uint8_t [tbuf_size];
+
+        /* Copy Column into Buffer */
+        int64_t tbuf_row_size = info->datasize / info->numrows;
+        int64_t tbuf_col_size = tbuf_row_size / info->numcols;
+        for(int row = 0; row < info->numrows; row++)
+        {
+            int64_t tbuf_offset = (row * tbuf_col_size);
+            int64_t data_offset = (row * tbuf_row_size) + (col * tbuf_col_size);
+            LocalLib::copy(&tbuf[tbuf_offset], &info->data[data_offset], tbuf_col_size);
+        }
+
+        /* Switch Buffers */
+        delete [] info->data;
+        info->data = tbuf;
+        info->datasize = tbuf_size;
+        info->elements = info->elements / info->numcols;
+    }
+
+    /* Perform Type Translation */
+    if(valtype == RecordObject::INTEGER || valtype == RecordObject::REAL)
+    {
+        int64_t value_size = (valtype == RecordObject::INTEGER) ? sizeof(int) : sizeof(double);
+        uint8_t* tbuf = new uint8_t [value_size * info->elements];
+        data_valid = convert(info->datatype, info->data, valtype, tbuf, info->elements);
+
+        /* Switch Buffers */
+        delete [] info->data;
+        info->data = tbuf;
+        info->datasize = value_size * info->elements;
+    }
+
+    /* Check Data Valid */
+    if(!data_valid)
+    {
+        delete [] info->data;
+        info->data = NULL;
+        info->datasize = 0;
+        throw RunTimeException(CRITICAL, RTE_ERROR, "data translation failed for %s: [%d,%d] %d --> %d", datasetname, info->numcols, info->typesize, (int)info->datatype, (int)valtype);
     }
 }
 
 /*----------------------------------------------------------------------------
- * highestBit
+ * convert
+ *
+ *  converts elements of a dataset type into the values of valtype (int for
+ *  INTEGER, double for REAL) written directly into the caller's buffer;
+ *  returns false if the conversion is not supported
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::highestBit (uint64_t value)
+bool H5Coro::convert (RecordObject::fieldType_t src_type, const uint8_t* src, RecordObject::valType_t valtype, uint8_t* dst, int64_t num_elements)
 {
-    int bit = 0;
-    while(value >>= 1) bit++;
-    return bit;
+    if(valtype == RecordObject::INTEGER)    return convertFrom<int>(src_type, src, dst, num_elements);
+    else if(valtype == RecordObject::REAL)  return convertFrom<double>(src_type, src, dst, num_elements);
+    else                                    return false;
 }
 
 /*----------------------------------------------------------------------------
- * inflateChunk
+ * readRows
+ *
+ *  reads only the given row ranges of a dataset and returns them laid out
+ *  as the contiguous span [startrow, startrow + numrows) would be; rows of
+ *  the span not covered by a range are zero filled and are never read from
+ *  the resource; the ranges must be sorted, non-overlapping, and fall inside
+ *  the span
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::inflateChunk (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_size)
+H5Coro::info_t H5Coro::readRows (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, const row_range_t* ranges, int num_ranges, context_t* context)
 {
-    int status;
-    z_stream strm;
-
-    /* Initialize z_stream State */
-    strm.zalloc     = Z_NULL;
-    strm.zfree      = Z_NULL;
-    strm.opaque     = Z_NULL;
-    strm.avail_in   = 0;
-    strm.next_in    = Z_NULL;
+    /* Check Ranges */
+    long prev_end = startrow;
+    for(int r = 0; r < num_ranges; r++)
+    {
+        if(ranges[r].startrow < prev_end || ranges[r].numrows <= 0 || (ranges[r].startrow + ranges[r].numrows) > (startrow + numrows))
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid row range %d of %s: %ld, %ld", r, datasetname, ranges[r].startrow, ranges[r].numrows);
+        }
+        prev_end = ranges[r].startrow + ranges[r].numrows;
+    }
 
-    /* Initialize z_stream */
-    status = inflateInit(&strm);
-    if(status != Z_OK)
+    /* Single Range Covering Span Needs No Scatter */
+    if(num_ranges == 1 && ranges[0].startrow == startrow && ranges[0].numrows == numrows)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to initialize z_stream: %d", status);
+        return read(asset, resource, datasetname, valtype, col, startrow, numrows, context);
     }
 
-    /* Decompress Until Entire Chunk is Processed */
-    strm.avail_in = input_size;
-    strm.next_in = input;
+    info_t info;
+    info.data = NULL;
+    info.numrows = numrows;
 
-    /* Decompress Chunk */
-    do
+    try
     {
-        strm.avail_out = output_size;
-        strm.next_out = output;
-        status = inflate(&strm, Z_NO_FLUSH);
-        if(status != Z_OK) break;
-    } while (strm.avail_out == 0);
+        for(int r = 0; r < num_ranges; r++)
+        {
+            info_t range_info = read(asset, resource, datasetname, valtype, col, ranges[r].startrow, ranges[r].numrows, context);
+            uint64_t row_size = range_info.numrows > 0 ? range_info.datasize / range_info.numrows : 0;
 
-    /* Clean Up z_stream */
-    inflateEnd(&strm);
+            /* Allocate Span on First Range */
+            if(info.data == NULL)
+            {
+                info.typesize = range_info.typesize;
+                info.datatype = range_info.datatype;
+                info.numcols = range_info.numcols;
+                info.datasize = row_size * numrows;
+                info.elements = (range_info.numrows > 0 ? range_info.elements / range_info.numrows : 0) * numrows;
+                info.data = new uint8_t [info.datasize > 0 ? info.datasize : 1];
+                LocalLib::set(info.data, 0, info.datasize);
+            }
 
-    /* Check Decompression Complete */
-    if(status != Z_STREAM_END)
+            /* Scatter Range into Span */
+            uint64_t offset = (ranges[r].startrow - startrow) * row_size;
+            if(range_info.data)
+            {
+                if(offset + range_info.datasize <= info.datasize)
+                {
+                    LocalLib::copy(&info.data[offset], range_info.data, range_info.datasize);
+                }
+                delete [] range_info.data;
+            }
+        }
+    }
+    catch(const RunTimeException&)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to inflate entire z_stream: %d", status);
+        if(info.data) delete [] info.data;
+        throw;
     }
 
-    return 0;
+    /* No Ranges - Empty Result */
+    if(info.data == NULL)
+    {
+        info.elements = 0;
+        info.typesize = 0;
+        info.datasize = 0;
+        info.datatype = RecordObject::INVALID_FIELD;
+        info.numcols = 0;
+        info.numrows = 0;
+    }
+
+    return info;
 }
 
 /*----------------------------------------------------------------------------
- * shuffleChunk
+ * readSlab
+ *
+ *  reads a hyperslab selection given as a start, stride, and count for each
+ *  of the first ndims dimensions (remaining dimensions are read in full);
+ *  only chunks holding selected elements are read from the resource and the
+ *  result contains only the selected elements in row order, with numrows and
+ *  numcols set to the counts of the first two dimensions
  *----------------------------------------------------------------------------*/
-int H5FileBuffer::shuffleChunk (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_offset, uint32_t output_size, int type_size)
+H5Coro::info_t H5Coro::readSlab (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, const slice_t* slab, int ndims, context_t* context)
 {
-    if(errorChecking)
+    LatencyHistogram::Sample sample(readLatency);
+    info_t info;
+
+    if(slab == NULL || ndims <= 0)
     {
-        if(type_size < 0 || type_size > 8)
-        {
-            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid data size to perform shuffle on: %d", type_size);
-        }
+        throw RunTimeException(CRITICAL, RTE_ERROR, "empty selection for %s", datasetname);
     }
 
-    int64_t dst_index = 0;
-    int64_t shuffle_block_size = input_size / type_size;
-    int64_t num_elements = output_size / type_size;
-    int64_t start_element = output_offset / type_size;
-    for(int64_t element_index = start_element; element_index < (start_element + num_elements); element_index++)
+    /* Start Trace */
+    uint32_t parent_trace_id = EventLib::grabId();
+    uint32_t trace_id = start_trace(INFO, parent_trace_id, "h5coro_read", "{\"asset\":\"%s\", \"resource\":\"%s\", \"dataset\":\"%s\"}", asset->getName(), resource, datasetname);
+
+    /* Open Resource and Read Selection */
+    H5FileBuffer h5file(&info, context, asset, resource, datasetname, 0, ALL_ROWS, true, H5_VERBOSE, false, slab, ndims);
+    if(info.data)
     {
-        for(int64_t val_index = 0; val_index < type_size; val_index++)
-        {
-            int64_t src_index = (val_index * shuffle_block_size) + element_index;
-            output[dst_index++] = input[src_index];
-        }
+        translate(&info, valtype, ALL_COLS, datasetname);
+    }
+    else
+    {
+        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read dataset: %s", datasetname);
     }
 
-    return 0;
+    /* Stop Trace */
+    stop_trace(INFO, trace_id);
+
+    /* Log Info Message */
+    mlog(DEBUG, "Read %d elements (%ld bytes) from %s/%s", info.elements, info.datasize, asset->getName(), datasetname);
+
+    /* Return Info */
+    return info;
 }
 
 /*----------------------------------------------------------------------------
- * metaGetKey
+ * traverse
+ *
+ *  walks the file breadth first from the starting group, listing the groups
+ *  of each level concurrently; the objects found are added to the list when
+ *  one is provided, otherwise they are printed as a tree
  *----------------------------------------------------------------------------*/
-uint64_t H5FileBuffer::metaGetKey (const char* url)
+bool H5Coro::traverse (const Asset* asset, const char* resource, int max_depth, const char* start_group, List<object_t>* objects)
 {
-    uint64_t key_value = 0;
-    uint64_t* url_ptr = (uint64_t*)url;
-    for(int i = 0; i < MAX_META_NAME_SIZE; i+=sizeof(uint64_t))
+    bool status = true;
+
+    List<object_t> local_objects;
+    if(!objects) objects = &local_objects;
+
+    /* Start at Group */
+    object_t start;
+    StringLib::copy(start.path, start_group ? start_group : "/", H5CORO_MAXIMUM_NAME_SIZE);
+    start.depth = 0;
+    start.group = true;
+
+    /* Walk One Level at a Time */
+    List<object_t> level;
+    level.add(start);
+    while(level.length() > 0)
+    {
+        int num_paths = level.length();
+        const char** paths = new const char* [num_paths];
+        bool* groups = new bool [num_paths];
+        List<const char*>** links = new List<const char*>* [num_paths];
+        for(int i = 0; i < num_paths; i++)
+        {
+            paths[i] = level[i].path;
+            groups[i] = false;
+            links[i] = NULL;
+        }
+
+        /* List Groups of Level */
+        traverse_level_t work;
+        work.asset = asset;
+        work.resource = resource;
+        work.paths = paths;
+        work.groups = groups;
+        work.links = links;
+        work.num_paths = num_paths;
+        work.next = 0;
+        int num_threads = MIN(num_paths, MAX_TRAVERSE_THREADS);
+        if(num_threads == 1)
+        {
+            traverse_thread(&work);
+        }
+        else
+        {
+            Thread** workers = new Thread* [num_threads];
+            for(int t = 0; t < num_threads; t++) workers[t] = new Thread(traverse_thread, &work);
+            for(int t = 0; t < num_threads; t++) delete workers[t]; // joins worker
+            delete [] workers;
+        }
+
+        /* Collect Objects and Build Next Level */
+        List<object_t> next_level;
+        for(int i = 0; i < num_paths; i++)
+        {
+            object_t& obj = level[i];
+            if(!links[i])
+            {
+                status = false;
+                continue;
+            }
+
+            obj.group = groups[i];
+            if(obj.depth > 0) objects->add(obj);
+
+            if(obj.group && obj.depth < max_depth)
+            {
+                for(int l = 0; l < links[i]->length(); l++)
+                {
+                    object_t child;
+                    const char* sep = (obj.path[StringLib::size(obj.path) - 1] == '/') ? "" : "/";
+                    StringLib::format(child.path, H5CORO_MAXIMUM_NAME_SIZE, "%s%s%s", obj.path, sep, (*links[i])[l]);
+                    child.depth = obj.depth + 1;
+                    child.group = false;
+                    next_level.add(child);
+                }
+            }
+
+            for(int l = 0; l < links[i]->length(); l++) delete [] (*links[i])[l];
+            delete links[i];
+        }
+        delete [] paths;
+        delete [] groups;
+        delete [] links;
+
+        level = next_level;
+    }
+
+    /* Display Tree */
+    if(objects == &local_objects)
     {
-        key_value += *url_ptr;
-        url_ptr++;
+        for(int i = 0; i < local_objects.length(); i++)
+        {
+            const object_t& obj = local_objects[i];
+            const char* name = StringLib::find(obj.path, '/', false);
+            print2term("%*s%s%s\n", (obj.depth - 1) * 4, "", name ? name + 1 : obj.path, obj.group ? "/" : "");
+        }
     }
-    return key_value;
+
+    /* Return Status */
+    return status;
 }
 
 /*----------------------------------------------------------------------------
- * metaGetUrl
+ * traverse_thread
  *----------------------------------------------------------------------------*/
-void H5FileBuffer::metaGetUrl (char* url, const char* resource, const char* dataset)
+void* H5Coro::traverse_thread (void* parm)
 {
-    /* Prepare File Name */
-    const char* filename_ptr = resource;
-    const char* char_ptr = resource;
-    while(*char_ptr)
+    traverse_level_t* work = (traverse_level_t*)parm;
+    context_t context;
+
+    int i;
+    while((i = work->next++) < work->num_paths)
     {
-        if(*char_ptr == '/')
+        List<const char*>* links = new List<const char*>;
+        try
         {
-            filename_ptr = char_ptr + 1;
+            work->groups[i] = H5FileBuffer::listGroup(work->asset, work->resource, work->paths[i], links, &context);
+            work->links[i] = links;
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failed to traverse %s: %s", work->paths[i], e.what());
+            for(int l = 0; l < links->length(); l++) delete [] (*links)[l];
+            delete links;
         }
-
-        char_ptr++;
     }
 
-    /* Prepare Dataset Name */
-    const char* dataset_name_ptr = dataset;
-    if(dataset[0] == '/') dataset_name_ptr++;
+    return NULL;
+}
 
-    /* Build URL */
-    LocalLib::set(url, 0, MAX_META_NAME_SIZE);
-    StringLib::format(url, MAX_META_NAME_SIZE, "%s/%s", filename_ptr, dataset_name_ptr);
+/*----------------------------------------------------------------------------
+ * readp
+ *----------------------------------------------------------------------------*/
+H5Future* H5Coro::readp (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context)
+{
+    read_rqst_t rqst = {
+        .asset          = asset,
+        .resource       = StringLib::duplicate(resource),
+        .datasetname    = StringLib::duplicate(datasetname),
+        .valtype        = valtype,
+        .col            = col,
+        .startrow       = startrow,
+        .numrows        = numrows,
+        .ranges         = NULL,
+        .num_ranges     = 0,
+        .slab           = NULL,
+        .slab_ndims     = 0,
+        .context        = context,
+        .h5f            = new H5Future(),
+        .account        = RequestAccount::share(),
+        .sharedkey      = NULL
+    };
 
-    /* Check URL Fits (at least 2 null terminators) */
-    if(url[MAX_META_NAME_SIZE - 2] != '\0')
+    int post_status = rqstPub->postCopy(&rqst, sizeof(read_rqst_t), IO_CHECK);
+    if(post_status <= 0)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "truncated meta repository url: %s", url);
+        mlog(CRITICAL, "Failed to post read request for %s/%s: %d", resource, datasetname, post_status);
+        delete [] rqst.resource;
+        delete [] rqst.datasetname;
+        delete rqst.h5f;
+        if(rqst.account) rqst.account->release();
+        return NULL;
+    }
+    else
+    {
+        return rqst.h5f;
     }
 }
 
-/******************************************************************************
- * HDF5 LITE LIBRARY
- ******************************************************************************/
-
-Publisher*   H5Coro::rqstPub;
-Subscriber*  H5Coro::rqstSub;
-bool         H5Coro::readerActive;
-Thread**     H5Coro::readerPids;
-int          H5Coro::threadPoolSize;
-
 /*----------------------------------------------------------------------------
- * init
+ * readpShared
+ *
+ *  like readp, but a read identical to one already in flight does not go to
+ *  the file; it attaches to the read in flight and is completed with a copy
+ *  of its results, so concurrent readers of the same dataset share one read
  *----------------------------------------------------------------------------*/
-void H5Coro::init (int num_threads)
+H5Future* H5Coro::readpShared (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context)
 {
-    rqstPub = new Publisher(NULL);
+    SafeString key("%s:%s:%s:%d:%ld:%ld:%ld", asset->getName(), resource, datasetname, (int)valtype, col, startrow, numrows);
 
-    if(num_threads > 0)
+    /* Attach to Read in Flight */
+    H5Future* follower = NULL;
+    sharedMutex.lock();
     {
-        readerActive = true;
-        rqstSub = new Subscriber(*rqstPub);
-        threadPoolSize = num_threads;
-        readerPids = new Thread* [threadPoolSize];
-        for(int t = 0; t < threadPoolSize; t++)
+        shared_read_t* followers = NULL;
+        if(sharedReads.find(key.getString(), &followers))
         {
-            readerPids[t] = new Thread(reader_thread, NULL);
+            follower = new H5Future();
+            followers->add(follower);
         }
+        else
+        {
+            followers = new shared_read_t;
+            sharedReads.add(key.getString(), followers);
+        }
+    }
+    sharedMutex.unlock();
+
+    if(follower)
+    {
+        return follower;
+    }
+
+    /* Lead Read */
+    read_rqst_t rqst = {
+        .asset          = asset,
+        .resource       = StringLib::duplicate(resource),
+        .datasetname    = StringLib::duplicate(datasetname),
+        .valtype        = valtype,
+        .col            = col,
+        .startrow       = startrow,
+        .numrows        = numrows,
+        .ranges         = NULL,
+        .num_ranges     = 0,
+        .slab           = NULL,
+        .slab_ndims     = 0,
+        .context        = context,
+        .h5f            = new H5Future(),
+        .account        = RequestAccount::share(),
+        .sharedkey      = StringLib::duplicate(key.getString())
+    };
+
+    int post_status = rqstPub->postCopy(&rqst, sizeof(read_rqst_t), IO_CHECK);
+    if(post_status <= 0)
+    {
+        mlog(CRITICAL, "Failed to post shared read request for %s/%s: %d", resource, datasetname, post_status);
+        finishShared(rqst.sharedkey, NULL, false);
+        delete [] rqst.resource;
+        delete [] rqst.datasetname;
+        delete [] rqst.sharedkey;
+        delete rqst.h5f;
+        if(rqst.account) rqst.account->release();
+        return NULL;
     }
     else
     {
-        readerActive = false;
-        rqstSub = NULL;
-        threadPoolSize = 0;
-        readerPids = NULL;
+        return rqst.h5f;
     }
 }
 
 /*----------------------------------------------------------------------------
- * deinit
+ * readpRows
  *----------------------------------------------------------------------------*/
-void H5Coro::deinit (void)
+H5Future* H5Coro::readpRows (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, const row_range_t* ranges, int num_ranges, context_t* context)
 {
-    if(readerActive)
+    /* Copy Ranges into Request */
+    row_range_t* rqst_ranges = new row_range_t [num_ranges > 0 ? num_ranges : 1];
+    for(int r = 0; r < num_ranges; r++) rqst_ranges[r] = ranges[r];
+
+    read_rqst_t rqst = {
+        .asset          = asset,
+        .resource       = StringLib::duplicate(resource),
+        .datasetname    = StringLib::duplicate(datasetname),
+        .valtype        = valtype,
+        .col            = col,
+        .startrow       = startrow,
+        .numrows        = numrows,
+        .ranges         = rqst_ranges,
+        .num_ranges     = num_ranges,
+        .slab           = NULL,
+        .slab_ndims     = 0,
+        .context        = context,
+        .h5f            = new H5Future(),
+        .account        = RequestAccount::share(),
+        .sharedkey      = NULL
+    };
+
+    int post_status = rqstPub->postCopy(&rqst, sizeof(read_rqst_t), IO_CHECK);
+    if(post_status <= 0)
+    {
+        mlog(CRITICAL, "Failed to post read request for %s/%s: %d", resource, datasetname, post_status);
+        delete [] rqst.resource;
+        delete [] rqst.datasetname;
+        delete [] rqst.ranges;
+        delete rqst.h5f;
+        if(rqst.account) rqst.account->release();
+        return NULL;
+    }
+    else
     {
-        readerActive = false;
-        for(int t = 0; t < threadPoolSize; t++)
-        {
-            delete readerPids[t];
-        }
-        if(readerPids) delete [] readerPids;
-        if(rqstSub) delete rqstSub;
+        return rqst.h5f;
     }
-
-    if(rqstPub) delete rqstPub;
 }
 
 /*----------------------------------------------------------------------------
- * read
+ * readpSlab
  *----------------------------------------------------------------------------*/
-H5Coro::info_t H5Coro::read (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context, bool _meta_only)
+H5Future* H5Coro::readpSlab (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, const slice_t* slab, int ndims, context_t* context)
 {
-    info_t info;
+    /* Copy Selection into Request */
+    slice_t* rqst_slab = new slice_t [ndims > 0 ? ndims : 1];
+    for(int d = 0; d < ndims; d++) rqst_slab[d] = slab[d];
 
-    /* Start Trace */
-    uint32_t parent_trace_id = EventLib::grabId();
-    uint32_t trace_id = start_trace(INFO, parent_trace_id, "h5coro_read", "{\"asset\":\"%s\", \"resource\":\"%s\", \"dataset\":\"%s\"}", asset->getName(), resource, datasetname);
+    read_rqst_t rqst = {
+        .asset          = asset,
+        .resource       = StringLib::duplicate(resource),
+        .datasetname    = StringLib::duplicate(datasetname),
+        .valtype        = valtype,
+        .col            = ALL_COLS,
+        .startrow       = 0,
+        .numrows        = ALL_ROWS,
+        .ranges         = NULL,
+        .num_ranges     = 0,
+        .slab           = rqst_slab,
+        .slab_ndims     = ndims,
+        .context        = context,
+        .h5f            = new H5Future(),
+        .account        = RequestAccount::share(),
+        .sharedkey      = NULL
+    };
 
-    /* Open Resource and Read Dataset */
-    H5FileBuffer h5file(&info, context, asset, resource, datasetname, startrow, numrows, true, H5_VERBOSE, _meta_only);
-    if(info.data)
+    int post_status = rqstPub->postCopy(&rqst, sizeof(read_rqst_t), IO_CHECK);
+    if(post_status <= 0)
     {
-        bool data_valid = true;
-
-        /* Perform Column Translation */
-        if((info.numcols > 1) && (col != ALL_COLS))
-        {
-            /* Allocate Column Buffer */
-            int64_t tbuf_size = info.datasize / info.numcols;
-            uint8_t* tbuf = new uint8_t [tbuf_size];
-
-            /* Copy Column into Buffer */
-            int64_t tbuf_row_size = info.datasize / info.numrows;
-            int64_t tbuf_col_size = tbuf_row_size / info.numcols;
-            for(int row = 0; row < info.numrows; row++)
-            {
-                int64_t tbuf_offset = (row * tbuf_col_size);
-                int64_t data_offset = (row * tbuf_row_size) + (col * tbuf_col_size);
-                LocalLib::copy(&tbuf[tbuf_offset], &info.data[data_offset], tbuf_col_size);
-            }
-
-            /* Switch Buffers */
-            delete [] info.data;
-            info.data = tbuf;
-            info.datasize = tbuf_size;
-            info.elements = info.elements / info.numcols;
-        }
+        mlog(CRITICAL, "Failed to post read request for %s/%s: %d", resource, datasetname, post_status);
+        delete [] rqst.resource;
+        delete [] rqst.datasetname;
+        delete [] rqst.slab;
+        delete rqst.h5f;
+        if(rqst.account) rqst.account->release();
+        return NULL;
+    }
+    else
+    {
+        return rqst.h5f;
+    }
+}
 
-        /* Perform Integer Type Transaltion */
-        if(valtype == RecordObject::INTEGER)
+/*----------------------------------------------------------------------------
+ * readBatch
+ *
+ *  resolves the metadata of every dataset through the shared context (so
+ *  common parts of the file are only read once), coalesces the byte ranges
+ *  the reads will need into as few requests as possible and loads them into
+ *  the context, and then posts a read of each dataset; the future of each
+ *  read is returned in its request, and the number of reads posted is
+ *  returned
+ *----------------------------------------------------------------------------*/
+int H5Coro::readBatch (const Asset* asset, const char* resource, batch_rqst_t* rqsts, int num_rqsts, context_t* context)
+{
+    /* Prefetch Data Needed by Batch */
+    if(context && num_rqsts > 1)
+    {
+        H5FileBuffer::io_range_t* ranges = new H5FileBuffer::io_range_t [num_rqsts];
+        int num_ranges = 0;
+        for(int i = 0; i < num_rqsts; i++)
         {
-            /* Allocate Buffer of Integers */
-            int* tbuf = new int [info.elements];
-
-            /* Float to Int */
-            if(info.datatype == RecordObject::FLOAT)
-            {
-                float* dptr = (float*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (int)dptr[i];
-                }
-            }
-            /* Double to Int */
-            else if(info.datatype == RecordObject::DOUBLE)
-            {
-                double* dptr = (double*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (int)dptr[i];
-                }
-            }
-            /* Char to Int */
-            else if(info.datatype == RecordObject::UINT8 || info.datatype == RecordObject::INT8)
-            {
-                uint8_t* dptr = (uint8_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (int)dptr[i];
-                }
-            }
-            /* Short to Int */
-            else if(info.datatype == RecordObject::UINT16 || info.datatype == RecordObject::INT16)
-            {
-                uint16_t* dptr = (uint16_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (int)dptr[i];
-                }
-            }
-            /* Int to Int */
-            else if(info.datatype == RecordObject::UINT32 || info.datatype == RecordObject::INT32)
-            {
-                uint32_t* dptr = (uint32_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (int)dptr[i];
-                }
-            }
-            /* Long to Int */
-            else if(info.datatype == RecordObject::UINT64 || info.datatype == RecordObject::INT64)
+            batch_rqst_t* rqst = &rqsts[i];
+            try
             {
-                uint64_t* dptr = (uint64_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
+                read(asset, resource, rqst->datasetname, rqst->valtype, rqst->col, rqst->startrow, rqst->numrows, context, true);
+                if(H5FileBuffer::metaGetRange(resource, rqst->datasetname, rqst->startrow, rqst->numrows, &ranges[num_ranges]))
                 {
-                    tbuf[i] = (int)dptr[i];
+                    num_ranges++;
                 }
             }
-            else
+            catch(const RunTimeException& e)
             {
-                data_valid = false;
+                /* error is reported by the read posted below */
+                mlog(DEBUG, "Unable to resolve %s for batch: %s", rqst->datasetname, e.what());
             }
-
-            /* Switch Buffers */
-            delete [] info.data;
-            info.data = (uint8_t*)tbuf;
-            info.datasize = sizeof(int) * info.elements;
         }
 
-        /* Perform Integer Type Transaltion */
-        if(valtype == RecordObject::REAL)
+        try
         {
-            /* Allocate Buffer of Integers */
-            double* tbuf = new double [info.elements];
-
-            /* Float to Double */
-            if(info.datatype == RecordObject::FLOAT)
-            {
-                float* dptr = (float*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            /* Double to Double */
-            else if(info.datatype == RecordObject::DOUBLE)
-            {
-                double* dptr = (double*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            /* Char to Double */
-            else if(info.datatype == RecordObject::UINT8 || info.datatype == RecordObject::INT8)
-            {
-                uint8_t* dptr = (uint8_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            /* Short to Double */
-            else if(info.datatype == RecordObject::UINT16 || info.datatype == RecordObject::INT16)
-            {
-                uint16_t* dptr = (uint16_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            /* Int to Double */
-            else if(info.datatype == RecordObject::UINT32 || info.datatype == RecordObject::INT32)
-            {
-                uint32_t* dptr = (uint32_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            /* Long to Double */
-            else if(info.datatype == RecordObject::UINT64 || info.datatype == RecordObject::INT64)
-            {
-                uint64_t* dptr = (uint64_t*)info.data;
-                for(uint32_t i = 0; i < info.elements; i++)
-                {
-                    tbuf[i] = (double)dptr[i];
-                }
-            }
-            else
-            {
-                data_valid = false;
-            }
-
-            /* Switch Buffers */
-            delete [] info.data;
-            info.data = (uint8_t*)tbuf;
-            info.datasize = sizeof(double) * info.elements;
+            int num_reads = H5FileBuffer::ioPrefetch(asset, resource, context, ranges, num_ranges);
+            mlog(DEBUG, "Prefetched %d datasets of %s in %d reads", num_ranges, resource, num_reads);
         }
-
-        /* Check Data Valid */
-        if(!data_valid)
+        catch(const RunTimeException& e)
         {
-            delete [] info.data;
-            info.data = NULL;
-            info.datasize = 0;
-            throw RunTimeException(CRITICAL, RTE_ERROR, "data translation failed for %s: [%d,%d] %d --> %d", datasetname, info.numcols, info.typesize, (int)info.datatype, (int)valtype);
+            mlog(e.level(), "Failed to prefetch batch for %s: %s", resource, e.what());
         }
+
+        delete [] ranges;
     }
-    else if(!_meta_only)
+
+    /* Post Reads */
+    int num_posted = 0;
+    for(int i = 0; i < num_rqsts; i++)
     {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "failed to read dataset: %s", datasetname);
+        batch_rqst_t* rqst = &rqsts[i];
+        rqst->h5f = readp(asset, resource, rqst->datasetname, rqst->valtype, rqst->col, rqst->startrow, rqst->numrows, context);
+        if(rqst->h5f) num_posted++;
     }
 
-    /* Stop Trace */
-    stop_trace(INFO, trace_id);
+    return num_posted;
+}
 
-    /* Log Info Message */
-    mlog(DEBUG, "Read %d elements (%ld bytes) from %s/%s", info.elements, info.datasize, asset->getName(), datasetname);
+/*----------------------------------------------------------------------------
+ * readahead
+ *
+ *  registers a readahead plan with the context: datasets[0] is the trigger
+ *  and the remaining datasets are its siblings; names are relative, so a
+ *  plan of "heights/h_ph" matches a read of "/gt1l/heights/h_ph" and then
+ *  prefetches "/gt1l/<sibling>" for the same rows
+ *----------------------------------------------------------------------------*/
+void H5Coro::readahead (context_t* context, const char** datasets, int num_datasets)
+{
+    if(!context || num_datasets < 2) return;
 
-    /* Return Info */
-    return info;
+    H5FileBuffer::readahead_plan_t* plan = new H5FileBuffer::readahead_plan_t;
+    for(int i = 1; i < num_datasets; i++)
+    {
+        const char* sibling = StringLib::duplicate(datasets[i]);
+        plan->add(sibling);
+    }
+
+    context->readahead_cond.lock();
+    {
+        context->readahead_plans.add(datasets[0], plan);
+    }
+    context->readahead_cond.unlock();
 }
 
 /*----------------------------------------------------------------------------
- * traverse
+ * readaheadTrigger
+ *
+ *  when the dataset being read matches the trigger of a plan, and the rows
+ *  being read have not already been prefetched, a readahead of the sibling
+ *  datasets is started in the background
  *----------------------------------------------------------------------------*/
-bool H5Coro::traverse (const Asset* asset, const char* resource, int max_depth, const char* start_group)
+void H5Coro::readaheadTrigger (const Asset* asset, const char* resource, const char* datasetname, long startrow, long numrows, context_t* context)
 {
-    (void)max_depth;
-
-    bool status = true;
+    readahead_rqst_t* rqst = NULL;
 
-    try
+    context->readahead_cond.lock();
     {
-        /* Open File */
-        info_t data_info;
-        H5FileBuffer h5file(&data_info, NULL, asset, resource, start_group, 0, 0, true, true);
+        if(context->readahead_plans.length() > 0)
+        {
+            /* Find Plan Matching Trailing Part of Dataset Name */
+            H5FileBuffer::readahead_plan_t* plan = NULL;
+            const char* relative_name = datasetname;
+            while(*relative_name == '/') relative_name++;
+            while(relative_name && !context->readahead_plans.find(relative_name, &plan))
+            {
+                relative_name = StringLib::find(relative_name, '/');
+                if(relative_name) relative_name++;
+            }
 
-        /* Free Data */
-        if(data_info.data) delete [] data_info.data;
+            /* Issue Readahead Once per Row Span */
+            SafeString span_key("%s:%ld:%ld", datasetname, startrow, numrows);
+            if(plan && !context->readahead_issued.find(span_key.getString()))
+            {
+                bool issued = true;
+                context->readahead_issued.add(span_key.getString(), issued);
+
+                /* Build Sibling Dataset Names */
+                int prefix_len = relative_name - datasetname;
+                rqst = new readahead_rqst_t;
+                rqst->asset = asset;
+                rqst->resource = StringLib::duplicate(resource);
+                rqst->num_datasets = plan->length();
+                rqst->datasets = new const char* [rqst->num_datasets];
+                for(int i = 0; i < rqst->num_datasets; i++)
+                {
+                    SafeString sibling("%.*s%s", prefix_len, datasetname, plan->get(i));
+                    rqst->datasets[i] = sibling.getString(true);
+                }
+                rqst->startrow = startrow;
+                rqst->numrows = numrows;
+                rqst->context = context;
+                rqst->account = RequestAccount::share();
+                context->readahead_pending++;
+            }
+        }
     }
-    catch (const RunTimeException& e)
+    context->readahead_cond.unlock();
+
+    /* Start Readahead */
+    if(rqst)
     {
-        mlog(e.level(), "Failed to traverse resource: %s", e.what());
+        try
+        {
+            Thread* pid = new Thread(readahead_thread, rqst, false);
+            delete pid; // detached
+        }
+        catch(const std::exception& e)
+        {
+            mlog(CRITICAL, "Failed to start readahead of %s: %s", datasetname, e.what());
+            readahead_thread(rqst);
+        }
     }
-
-    /* Return Status */
-    return status;
 }
 
-
 /*----------------------------------------------------------------------------
- * readp
+ * finishShared
+ *
+ *  closes a shared read to new attachments and completes each future that
+ *  attached to it with its own copy of the results
  *----------------------------------------------------------------------------*/
-H5Future* H5Coro::readp (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context)
+void H5Coro::finishShared (const char* key, const info_t* info, bool valid)
 {
-    read_rqst_t rqst = {
-        .asset          = asset,
-        .resource       = StringLib::duplicate(resource),
-        .datasetname    = StringLib::duplicate(datasetname),
-        .valtype        = valtype,
-        .col            = col,
-        .startrow       = startrow,
-        .numrows        = numrows,
-        .context        = context,
-        .h5f            = new H5Future()
-    };
-
-    int post_status = rqstPub->postCopy(&rqst, sizeof(read_rqst_t), IO_CHECK);
-    if(post_status <= 0)
+    shared_read_t* followers = NULL;
+    sharedMutex.lock();
     {
-        mlog(CRITICAL, "Failed to post read request for %s/%s: %d", resource, datasetname, post_status);
-        delete [] rqst.resource;
-        delete [] rqst.datasetname;
-        delete rqst.h5f;
-        return NULL;
+        if(sharedReads.find(key, &followers))
+        {
+            sharedReads.remove(key);
+        }
     }
-    else
+    sharedMutex.unlock();
+
+    if(followers)
     {
-        return rqst.h5f;
+        for(int i = 0; i < followers->length(); i++)
+        {
+            H5Future* h5f = followers->get(i);
+            if(valid && info)
+            {
+                h5f->info = *info;
+                if(info->data)
+                {
+                    h5f->info.data = new uint8_t [info->datasize];
+                    LocalLib::copy(h5f->info.data, info->data, info->datasize);
+                }
+            }
+            h5f->finish(valid && info);
+        }
+        delete followers;
     }
 }
 
@@ -3549,10 +6735,20 @@ void* H5Coro::reader_thread (void* parm)
         int recv_status = rqstSub->receiveCopy(&rqst, sizeof(read_rqst_t), SYS_TIMEOUT);
         if(recv_status > 0)
         {
+            RequestAccount* previous = RequestAccount::attach(rqst.account);
+            bool cancellable = RequestAccount::cancellable(rqst.sharedkey == NULL); // shared reads complete for their followers
             bool valid;
             try
             {
-                rqst.h5f->info = read(rqst.asset, rqst.resource, rqst.datasetname, rqst.valtype, rqst.col, rqst.startrow, rqst.numrows, rqst.context);
+                /* Skip Reads of Cancelled Requests */
+                if(RequestAccount::cancelled())
+                {
+                    throw RunTimeException(DEBUG, RTE_ERROR, "request cancelled");
+                }
+
+                if(rqst.slab)           rqst.h5f->info = readSlab(rqst.asset, rqst.resource, rqst.datasetname, rqst.valtype, rqst.slab, rqst.slab_ndims, rqst.context);
+                else if(rqst.ranges)    rqst.h5f->info = readRows(rqst.asset, rqst.resource, rqst.datasetname, rqst.valtype, rqst.col, rqst.startrow, rqst.numrows, rqst.ranges, rqst.num_ranges, rqst.context);
+                else                    rqst.h5f->info = read(rqst.asset, rqst.resource, rqst.datasetname, rqst.valtype, rqst.col, rqst.startrow, rqst.numrows, rqst.context);
                 valid = true;
             }
             catch(const RunTimeException& e)
@@ -3564,6 +6760,20 @@ void* H5Coro::reader_thread (void* parm)
             /* Free Request */
             delete [] rqst.resource;
             delete [] rqst.datasetname;
+            if(rqst.ranges) delete [] rqst.ranges;
+            if(rqst.slab) delete [] rqst.slab;
+
+            /* Settle Account */
+            RequestAccount::cancellable(cancellable);
+            RequestAccount::detach(previous);
+            if(rqst.account) rqst.account->release();
+
+            /* Complete Attached Reads */
+            if(rqst.sharedkey)
+            {
+                finishShared(rqst.sharedkey, &rqst.h5f->info, valid);
+                delete [] rqst.sharedkey;
+            }
 
             /* Signal Complete */
             rqst.h5f->finish(valid);
@@ -3577,3 +6787,138 @@ void* H5Coro::reader_thread (void* parm)
 
     return NULL;
 }
+
+/*----------------------------------------------------------------------------
+ * readahead_thread
+ *
+ *  resolves the metadata of the sibling datasets and prefetches the byte
+ *  ranges of the requested rows into the context, coalescing them into as
+ *  few reads as possible
+ *----------------------------------------------------------------------------*/
+void* H5Coro::readahead_thread (void* parm)
+{
+    readahead_rqst_t* rqst = (readahead_rqst_t*)parm;
+    context_t* context = rqst->context;
+    RequestAccount* previous = RequestAccount::attach(rqst->account);
+
+    /* Resolve Byte Ranges of Siblings */
+    H5FileBuffer::io_range_t* ranges = new H5FileBuffer::io_range_t [rqst->num_datasets];
+    int num_ranges = 0;
+    for(int i = 0; i < rqst->num_datasets; i++)
+    {
+        try
+        {
+            read(rqst->asset, rqst->resource, rqst->datasets[i], RecordObject::DYNAMIC, ALL_COLS, rqst->startrow, rqst->numrows, context, true);
+            if(H5FileBuffer::metaGetRange(rqst->resource, rqst->datasets[i], rqst->startrow, rqst->numrows, &ranges[num_ranges]))
+            {
+                num_ranges++;
+            }
+        }
+        catch(const RunTimeException& e)
+        {
+            /* error is reported by the read of the dataset itself */
+            mlog(DEBUG, "Unable to resolve %s for readahead: %s", rqst->datasets[i], e.what());
+        }
+    }
+
+    /* Prefetch Siblings */
+    try
+    {
+        int num_reads = H5FileBuffer::ioPrefetch(rqst->asset, rqst->resource, context, ranges, num_ranges);
+        mlog(DEBUG, "Readahead of %d datasets of %s in %d reads", num_ranges, rqst->resource, num_reads);
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Failed readahead for %s: %s", rqst->resource, e.what());
+    }
+
+    /* Free Request */
+    delete [] ranges;
+    for(int i = 0; i < rqst->num_datasets; i++) delete [] rqst->datasets[i];
+    delete [] rqst->datasets;
+    delete [] rqst->resource;
+    if(rqst->account) rqst->account->release();
+    delete rqst;
+
+    /* Settle Account */
+    RequestAccount::detach(previous);
+
+    /* Signal Complete */
+    context->readahead_cond.lock();
+    {
+        context->readahead_pending--;
+        context->readahead_cond.signal(0, Cond::NOTIFY_ALL);
+    }
+    context->readahead_cond.unlock();
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * luaCache - cache([<budget in bytes>])
+ *
+ *  sets the memory budget of the process-wide cache shared by all H5Coro
+ *  reads; a budget of zero disables the cache; returns the current budget
+ *----------------------------------------------------------------------------*/
+int H5Coro::luaCache (lua_State* L)
+{
+    try
+    {
+        if(lua_gettop(L) >= 1)
+        {
+            long budget = LuaObject::getLuaInteger(L, 1);
+            H5FileBuffer::setCacheBudget(budget);
+        }
+
+        lua_pushinteger(L, H5FileBuffer::getCacheBudget());
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting h5coro cache budget: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * luaMetaSave - metasave(<filename>)
+ *----------------------------------------------------------------------------*/
+int H5Coro::luaMetaSave (lua_State* L)
+{
+    try
+    {
+        const char* filename = LuaObject::getLuaString(L, 1);
+        long count = H5FileBuffer::metaSave(filename);
+        mlog(INFO, "Saved %ld entries of h5coro meta repository to %s", count, filename);
+        lua_pushinteger(L, count);
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error saving h5coro meta repository: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * luaMetaLoad - metaload(<filename>)
+ *----------------------------------------------------------------------------*/
+int H5Coro::luaMetaLoad (lua_State* L)
+{
+    try
+    {
+        const char* filename = LuaObject::getLuaString(L, 1);
+        long count = H5FileBuffer::metaLoad(filename);
+        mlog(INFO, "Loaded %ld entries into h5coro meta repository from %s", count, filename);
+        lua_pushinteger(L, count);
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error loading h5coro meta repository: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
@@ -39,7 +39,11 @@
 #include "RecordObject.h"
 #include "List.h"
 #include "Table.h"
+#include "ConcurrentTable.h"
 #include "Asset.h"
+#include "Dictionary.h"
+#include "LatencyHistogram.h"
+#include "RequestAccount.h"
 
 /******************************************************************************
  * HDF5 DEFINES
@@ -126,6 +130,12 @@ class H5FileBuffer
 
         typedef H5Future::info_t info_t;
 
+        typedef struct {
+            long                    start;
+            long                    stride;     // step between selected elements, at least 1
+            long                    count;      // ALL_ROWS selects through the end of the dimension
+        } slice_t;
+
         /*--------------------------------------------------------------------
         * I/O Context (subclass)
         *--------------------------------------------------------------------*/
@@ -138,6 +148,13 @@ class H5FileBuffer
 
         typedef Table<cache_entry_t, uint64_t> cache_t;
 
+        typedef struct {
+            uint64_t                pos;
+            int64_t                 size;
+        } io_range_t;
+
+        typedef MgList<const char*, 16, true> readahead_plan_t;
+
         struct io_context_t
         {
             cache_t     l1; // level 1 cache
@@ -150,7 +167,14 @@ class H5FileBuffer
             long        l2_cache_replace;
             long        bytes_read;
 
+            /* Readahead */
+            MgDictionary<readahead_plan_t*> readahead_plans;    // sibling datasets keyed by the dataset that triggers them
+            Dictionary<bool>                readahead_issued;   // trigger datasets and row spans already prefetched
+            Cond                            readahead_cond;     // protects readahead state and signals completion
+            int                             readahead_pending;  // readaheads still running against the context
+
             io_context_t    (void);
+            io_context_t    (long l1_entries, long l2_entries);
             ~io_context_t   (void);
         };
 
@@ -158,9 +182,25 @@ class H5FileBuffer
         * Methods
         *--------------------------------------------------------------------*/
 
-                            H5FileBuffer        (info_t* info, io_context_t* context, const Asset* asset, const char* resource, const char* dataset, long startrow, long numrows, bool _error_checking=false, bool _verbose=false, bool _meta_only=false);
+                            H5FileBuffer        (info_t* info, io_context_t* context, const Asset* asset, const char* resource, const char* dataset, long startrow, long numrows, bool _error_checking=false, bool _verbose=false, bool _meta_only=false, const slice_t* slab=NULL, int slab_ndims=0, List<const char*>* group_links=NULL);
         virtual             ~H5FileBuffer       (void);
 
+        static void         initCache           (void);
+        static void         deinitCache         (void);
+        static void         setCacheBudget      (int64_t budget);
+        static int64_t      getCacheBudget      (void);
+        static long         metaSave            (const char* filename);
+        static long         metaLoad            (const char* filename);
+        static void         initInflaters       (int num_threads);
+        static void         deinitInflaters     (void);
+        static void         initShuffle         (void);
+        static bool         metaGetRange        (const char* resource, const char* dataset, long startrow, long numrows, io_range_t* range);
+        static long         metaGetChunkRows    (const char* resource, const char* dataset);
+        static bool         listGroup           (const Asset* asset, const char* resource, const char* group, List<const char*>* links, io_context_t* context=NULL);
+        static int          ioPrefetch          (const Asset* asset, const char* resource, io_context_t* context, io_range_t* ranges, int num_ranges);
+        static int          inflateChunk        (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_size);
+        static int          shuffleChunk        (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_offset, uint32_t output_size, int type_size);
+
     protected:
 
         /*--------------------------------------------------------------------
@@ -181,6 +221,28 @@ class H5FileBuffer
         static const long       MAX_META_STORE          = 150000;
         static const long       MAX_META_NAME_SIZE      = (H5CORO_MAXIMUM_NAME_SIZE & 0xFFF8); // forces size to multiple of 8
 
+        /*
+         * Assuming:
+         *  25 groups per granule
+         *  160 granules being catalogued at once
+         * Then:
+         *  4096 group listings of at most 4KB are held, 16MB at most
+         */
+
+        static const long       MAX_GROUP_STORE         = 4096;
+        static const int        GROUP_NAMES_SIZE        = 0x1000;
+
+        /*
+         * Assuming:
+         *  32 bytes per chunk
+         *  1000 chunks per dataset
+         * Then:
+         *  32MB of chunk indexes are held at most
+         */
+
+        static const long       MAX_INDEX_STORE         = 1024;
+        static const int        MAX_BTREE_V2_DEPTH      = 16;
+
         /*
          * Assuming:
          *  50ms of latency per read
@@ -196,6 +258,34 @@ class H5FileBuffer
         static const uint64_t   IO_CACHE_L2_MASK        = 0x7FFFFFF; // lower inverse of buffer size
         static const long       IO_CACHE_L2_ENTRIES     = 17; // cache lines per dataset
 
+        static const int64_t    IO_DIRECT_THRESHOLD     = IO_CACHE_L1_LINESIZE * 4; // reads at least this large bypass the caches
+        static const int64_t    IO_DIRECT_PART_SIZE     = IO_CACHE_L1_LINESIZE * 8; // size of each part of a direct read
+
+        static const int64_t    IO_COALESCE_GAP         = 0x40000; // bytes between ranges read through rather than split into separate requests
+        static const int64_t    IO_COALESCE_MAX_SIZE    = IO_CACHE_L2_MASK + 1; // largest coalesced request
+
+        /*
+         * Process-wide cache shared across I/O contexts:
+         *  entry keys combine a resource id in the upper bits with the file
+         *  offset in the lower bits; files larger than 16TB bypass the cache
+         */
+
+        static const long       GLOBAL_CACHE_L1_ENTRIES = 4099;
+        static const long       GLOBAL_CACHE_L2_ENTRIES = 257;
+        static const long       GLOBAL_CACHE_PENDING    = 1021;
+        static const int        GLOBAL_CACHE_ID_SHIFT   = 44;
+        static const uint64_t   GLOBAL_CACHE_POS_MASK   = 0x00000FFFFFFFFFFFLL;
+        static const uint64_t   GLOBAL_CACHE_MAX_ID     = 0xFFFFF;
+        static const uint64_t   GLOBAL_CACHE_INVALID_ID = 0;
+        static const char*      GLOBAL_CACHE_METRICS;
+
+        static const uint64_t   META_FILE_SIGNATURE     = 0x544D4F524F433548LL; // "H5COROMT"
+        static const uint32_t   META_FILE_VERSION       = 2;
+
+        static const int        INFLATE_QUEUE_FACTOR    = 4; // maximum outstanding chunks per inflater for a single read
+
+        static const int        MAX_SHUFFLE_TYPESIZE    = 8;
+
         static const long       STR_BUFF_SIZE           = 128;
         static const long       FILTER_SIZE_SCALE       = 1; // maximum factor for dataChunkFilterBuffer
 
@@ -208,6 +298,15 @@ class H5FileBuffer
         static const uint64_t   H5_TREE_SIGNATURE_LE    = 0x45455254LL; // binary tree version 1
         static const uint64_t   H5_HEAP_SIGNATURE_LE    = 0x50414548LL; // local heap
         static const uint64_t   H5_SNOD_SIGNATURE_LE    = 0x444F4E53LL; // symbol table
+        static const uint64_t   H5_FAHD_SIGNATURE_LE    = 0x44484146LL; // fixed array header
+        static const uint64_t   H5_FADB_SIGNATURE_LE    = 0x42444146LL; // fixed array data block
+        static const uint64_t   H5_EAHD_SIGNATURE_LE    = 0x44484145LL; // extensible array header
+        static const uint64_t   H5_EAIB_SIGNATURE_LE    = 0x42494145LL; // extensible array index block
+        static const uint64_t   H5_EASB_SIGNATURE_LE    = 0x42534145LL; // extensible array super block
+        static const uint64_t   H5_EADB_SIGNATURE_LE    = 0x42444145LL; // extensible array data block
+        static const uint64_t   H5_BTHD_SIGNATURE_LE    = 0x44485442LL; // binary tree version 2 header
+        static const uint64_t   H5_BTIN_SIGNATURE_LE    = 0x4E495442LL; // binary tree version 2 internal node
+        static const uint64_t   H5_BTLF_SIGNATURE_LE    = 0x464C5442LL; // binary tree version 2 leaf node
 
         /* Object Header Flags */
         static const uint8_t    SIZE_OF_CHUNK_0_MASK    = 0x03;
@@ -232,7 +331,8 @@ class H5FileBuffer
             FILTER_MSG              = 0xB,
             ATTRIBUTE_MSG           = 0xC,
             HEADER_CONT_MSG         = 0x10,
-            SYMBOL_TABLE_MSG        = 0x11
+            SYMBOL_TABLE_MSG        = 0x11,
+            FILE_SPACE_INFO_MSG     = 0x17
         } msg_type_t;
 
         typedef enum {
@@ -257,6 +357,15 @@ class H5FileBuffer
             UNKNOWN_LAYOUT          = 3
         } layout_t;
 
+        typedef enum {
+            BTREE_V1_INDEX          = 0, // layout version 3
+            SINGLE_CHUNK_INDEX      = 1,
+            IMPLICIT_INDEX          = 2,
+            FIXED_ARRAY_INDEX       = 3,
+            EXTENSIBLE_ARRAY_INDEX  = 4,
+            BTREE_V2_INDEX          = 5
+        } chunk_index_type_t;
+
         typedef enum {
             INVALID_FILTER          = 0,
             DEFLATE_FILTER          = 1,
@@ -310,13 +419,76 @@ class H5FileBuffer
             int                     offsetsize; // size of "offset" fields in h5 files
             int                     lengthsize; // size of "length" fields in h5 files
             uint64_t                dimensions[MAX_NDIMS];
+            uint64_t                maxdims[MAX_NDIMS]; // all bits set for an unlimited dimension
             uint64_t                chunkelements; // number of data elements per chunk
             uint64_t                chunkdims[MAX_NDIMS]; // dimension of each chunk
-            uint64_t                address;
+            chunk_index_type_t      chunkindex; // how chunk addresses are indexed
+            uint64_t                singlesize; // filtered size of a single chunk index, 0 when unfiltered
+            uint32_t                singlemask; // filter mask of a single chunk index
+            uint64_t                address; // contiguous data, or the chunk index
             int64_t                 size;
         } meta_entry_t;
 
-        typedef Table<meta_entry_t, uint64_t> meta_repo_t;
+        typedef ConcurrentTable<meta_entry_t, uint64_t> meta_repo_t;
+
+        typedef struct {
+            char                    url[MAX_META_NAME_SIZE];
+            bool                    group;      // false when the path names a dataset
+            int                     num_links;
+            char                    names[GROUP_NAMES_SIZE]; // link names back to back, each null terminated
+        } group_entry_t;
+
+        typedef ConcurrentTable<group_entry_t, uint64_t> group_repo_t;
+
+        typedef struct {
+            uint64_t                slice[MAX_NDIMS]; // offset of chunk in each dimension
+            uint64_t                address;
+            uint32_t                chunk_size;
+            uint32_t                filter_mask;
+        } chunk_entry_t;
+
+        typedef struct {
+            char                    url[MAX_META_NAME_SIZE];
+            uint64_t                address;    // address of the b-tree the index was built from
+            chunk_entry_t*          chunks;     // sorted by offset in first dimension
+            int64_t                 num_chunks;
+            int                     refs;       // readers of the index plus one while in the repository
+        } chunk_index_t;
+
+        typedef Table<chunk_index_t*, uint64_t> index_repo_t;
+
+        typedef struct {
+            int                     entry_size;
+            bool                    filtered;   // entries hold chunk size and filter mask
+            int                     unlimited;  // dimension varying slowest in linear chunk index, -1 for row order
+            int                     arr_off_size; // size of block offset field (extensible array)
+            uint64_t                page_nelmts;  // elements per data block page (extensible array)
+        } array_info_t;
+
+        typedef struct {
+            int                     record_size;
+            bool                    filtered;   // records hold chunk size and filter mask
+            int                     max_nrec_size; // size of number of records field in child node pointers
+            int                     total_nrec_size[MAX_BTREE_V2_DEPTH + 1]; // size of total number of records field by depth
+        } btree_v2_info_t;
+
+        typedef struct {
+            H5FileBuffer*           h5file;
+            uint8_t*                input;      // compressed chunk, owned by request
+            uint32_t                input_size;
+            uint8_t*                output;     // final location of chunk data in dataset buffer
+            uint64_t                chunk_index;// offset into uncompressed chunk to start copying from
+            int64_t                 chunk_bytes;// number of bytes to copy into output
+        } inflate_rqst_t;
+
+        typedef struct {
+            uint64_t                signature;
+            uint32_t                version;
+            uint32_t                entry_size;
+            uint64_t                num_entries;
+        } meta_file_hdr_t;
+
+        typedef int64_t (*shuffle_kernel_t) (const uint8_t* input, int64_t block_size, uint8_t* output, int64_t start_element, int64_t num_elements);
 
        /*--------------------------------------------------------------------
         * Methods
@@ -324,20 +496,43 @@ class H5FileBuffer
 
         void                tearDown            (void);
 
-        void                ioRequest           (uint64_t* pos, int64_t size, uint8_t* buffer, int64_t hint, bool cache);
+        void                ioRequest           (uint64_t* pos, int64_t size, uint8_t* buffer, int64_t hint, bool cache, bool page_aligned=false);
+        int64_t             ioReadDirect        (uint8_t* data, int64_t size, uint64_t pos);
         bool                ioCheckCache        (uint64_t pos, int64_t size, cache_t* cache, uint64_t line_mask, cache_entry_t* entry);
+        static void         ioCacheAdd          (io_context_t* context, cache_entry_t* entry);
+        bool                ioGlobalGet         (uint64_t pos, int64_t size, cache_entry_t* entry);
+        void                ioGlobalPut         (cache_entry_t* entry);
+        void                ioGlobalAbort       (void);
+        static void         ioGlobalEvict       (int64_t budget);
         static uint64_t     ioHashL1            (uint64_t key);
         static uint64_t     ioHashL2            (uint64_t key);
 
         void                readByteArray       (uint8_t* data, int64_t size, uint64_t* pos);
         uint64_t            readField           (int64_t size, uint64_t* pos);
         void                readDataset         (info_t* info);
+        void                resolveSlab         (void);
+        bool                slabIntersects      (int dim, uint64_t first, uint64_t last);
+        void                readSlabRows        (uint8_t* buffer, uint64_t row_size);
+        void                selectSlab          (info_t* info);
 
         uint64_t            readSuperblock      (void);
         int                 readFractalHeap     (msg_type_t type, uint64_t pos, uint8_t hdr_flags, int dlvl);
         int                 readDirectBlock     (heap_info_t* heap_info, int block_size, uint64_t pos, uint8_t hdr_flags, int dlvl);
         int                 readIndirectBlock   (heap_info_t* heap_info, int block_size, uint64_t pos, uint8_t hdr_flags, int dlvl);
-        int                 readBTreeV1         (uint64_t pos, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset);
+        int                 readBTreeV1         (uint64_t pos, List<chunk_entry_t>* chunks);
+        void                readChunkIndex      (List<chunk_entry_t>* chunks);
+        void                readFixedArray      (uint64_t pos, List<chunk_entry_t>* chunks);
+        void                readExtensibleArray (uint64_t pos, List<chunk_entry_t>* chunks);
+        void                readEADataBlock     (uint64_t pos, uint64_t idx, uint64_t nelmts, const array_info_t* array, const uint8_t* page_init, uint64_t page_bit, List<chunk_entry_t>* chunks);
+        void                readChunkElement    (uint64_t* pos, uint64_t idx, const array_info_t* array, List<chunk_entry_t>* chunks);
+        void                readBTreeV2         (uint64_t pos, List<chunk_entry_t>* chunks);
+        void                readBTreeV2Node     (uint64_t pos, int depth, uint64_t nrec, const btree_v2_info_t* tree, List<chunk_entry_t>* chunks);
+        void                readBTreeV2Record   (uint64_t pos, const btree_v2_info_t* tree, List<chunk_entry_t>* chunks);
+        bool                chunkSlice          (uint64_t idx, int unlimited, uint64_t* slice);
+        void                readChunks          (const chunk_index_t* index, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset);
+        void                readChunk           (const chunk_entry_t* chunk, uint8_t* buffer, uint64_t buffer_size, uint64_t buffer_offset);
+        chunk_index_t*      chunkIndexAcquire   (void);
+        static void         chunkIndexRelease   (chunk_index_t* index);
         btree_node_t        readBTreeNodeV1     (int ndims, uint64_t* pos);
         int                 readSymbolTable     (uint64_t pos, uint64_t heap_data_addr, int dlvl);
 
@@ -357,24 +552,56 @@ class H5FileBuffer
         int                 readAttributeMsg    (uint64_t pos, uint8_t hdr_flags, int dlvl, uint64_t size);
         int                 readHeaderContMsg   (uint64_t pos, uint8_t hdr_flags, int dlvl);
         int                 readSymbolTableMsg  (uint64_t pos, uint8_t hdr_flags, int dlvl);
+        int                 readFileSpaceInfoMsg(uint64_t pos, uint8_t hdr_flags, int dlvl);
 
+        void                initMeta            (const char* url);
         void                parseDataset        (void);
         const char*         type2str            (data_type_t datatype);
         const char*         layout2str          (layout_t layout);
         int                 highestBit          (uint64_t value);
-        int                 inflateChunk        (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_size);
-        int                 shuffleChunk        (uint8_t* input, uint32_t input_size, uint8_t* output, uint32_t output_offset, uint32_t output_size, int type_size);
+        void                inflateProcess      (uint8_t* input, uint32_t input_size, uint8_t* output, uint64_t chunk_index, int64_t chunk_bytes, uint8_t* scratch);
+        void                inflateDispatch     (uint8_t* input, uint32_t input_size, uint8_t* output, uint64_t chunk_index, int64_t chunk_bytes);
+        bool                inflateWait         (void);
+        static void*        inflateThread       (void* parm);
 
         static uint64_t     metaGetKey          (const char* url);
         static void         metaGetUrl          (char* url, const char* resource, const char* dataset);
+        static bool         metaWriteEntry      (uint64_t key, const meta_entry_t& entry, void* parm);
 
         /*--------------------------------------------------------------------
         * Data
         *--------------------------------------------------------------------*/
 
         /* Meta Repository */
-        static meta_repo_t  metaRepo;
-        static Mutex        metaMutex;
+        static meta_repo_t  metaRepo;           // lookups take no lock
+        static Mutex        metaMutex;          // protects index repository
+        static index_repo_t indexRepo;          // chunk indexes keyed like the meta repository
+        static group_repo_t groupRepo;          // group listings keyed like the meta repository
+
+        /* Global Cache */
+        static cache_t              globalL1;
+        static cache_t              globalL2;
+        static Table<bool,uint64_t> globalPending;
+        static Dictionary<uint64_t> globalResources;
+        static Cond                 globalCond;
+        static uint64_t             globalNextId;
+        static uint32_t             globalGeneration;
+        static int64_t              globalBudget;
+        static int64_t              globalBytes;
+        static int64_t              globalL1Bytes;
+        static int32_t              globalHitMetric;
+        static int32_t              globalMissMetric;
+        static int32_t              globalBytesMetric;
+
+        /* Shuffle Kernels (indexed by type size) */
+        static shuffle_kernel_t     shuffleKernels[MAX_SHUFFLE_TYPESIZE + 1];
+
+        /* Inflate Pool */
+        static Publisher*           inflatePub;
+        static Subscriber*          inflateSub;
+        static Thread**             inflatePids;
+        static int                  inflatePoolSize;
+        static bool                 inflateActive;
 
         /* Class Data */
         const char*         datasetName;            // holds buffer of dataset name that datasetPath points back into
@@ -382,9 +609,12 @@ class H5FileBuffer
         List<const char*>   datasetPath;
         uint64_t            datasetStartRow;
         int                 datasetNumRows;
+        slice_t             datasetSlab[MAX_NDIMS]; // hyperslab selection, resolved against the dimensions
+        int                 datasetSlabDims;        // number of dimensions in selection, 0 when reading whole rows
         bool                errorChecking;
         bool                verbose;
         bool                metaOnly;
+        List<const char*>*  groupLinks;             // links of the group are collected instead of reading a dataset
 
         /* I/O Management */
         Asset::IODriver*    ioDriver;
@@ -393,6 +623,10 @@ class H5FileBuffer
         io_context_t*       ioContext;
         bool                ioContextLocal;
         bool                ioPostPrefetch;
+        uint64_t            ioGlobalId;             // resource id used as upper bits of global cache keys
+        uint64_t            ioGlobalPending;        // key registered as pending in the global cache (or INVALID_KEY)
+        uint32_t            ioGlobalGeneration;     // generation of global cache the resource id was assigned in
+        uint64_t            ioPageSize;             // file space page size of paged aggregation (0 if not paged)
 
         /* File Info */
         uint8_t*            dataChunkBuffer;        // buffer for reading uncompressed chunk
@@ -401,6 +635,12 @@ class H5FileBuffer
         int                 highestDataLevel;       // high water mark for traversing dataset path
         int64_t             dataSizeHint;
 
+        /* Parallel Inflate */
+        bool                inflateParallel;        // chunks are handed off to the inflate pool
+        Cond                inflateCond;            // signals when an outstanding chunk completes
+        int                 inflatePending;         // number of outstanding chunks
+        bool                inflateFailed;          // set when any outstanding chunk fails
+
         /* Meta Info */
         meta_entry_t        metaData;
 };
@@ -417,6 +657,7 @@ struct H5Coro
 
     static const long ALL_ROWS = H5FileBuffer::ALL_ROWS;
     static const long ALL_COLS = -1L;
+    static const int MAX_TRAVERSE_THREADS = 8; // groups of one level listed concurrently
 
     /*--------------------------------------------------------------------
      * Typedefs
@@ -424,6 +665,28 @@ struct H5Coro
 
     typedef H5Future::info_t info_t;
     typedef H5FileBuffer::io_context_t context_t;
+    typedef H5FileBuffer::slice_t slice_t;
+
+    typedef struct {
+        char                    path[H5CORO_MAXIMUM_NAME_SIZE];
+        int                     depth;      // below the starting group
+        bool                    group;
+    } object_t;
+
+    typedef struct {
+        const Asset*            asset;
+        const char*             resource;
+        const char**            paths;      // objects of one level of the traversal
+        bool*                   groups;     // set by workers
+        List<const char*>**     links;      // set by workers, NULL when the object could not be read
+        int                     num_paths;
+        std::atomic<int>        next;       // next path to be claimed by a worker
+    } traverse_level_t;
+
+    typedef struct {
+        long                    startrow;
+        long                    numrows;
+    } row_range_t;
 
     typedef struct {
         const Asset*            asset;
@@ -433,21 +696,66 @@ struct H5Coro
         long                    col;
         long                    startrow;
         long                    numrows;
+        row_range_t*            ranges;     // owned by request, NULL for a contiguous read
+        int                     num_ranges;
+        slice_t*                slab;       // owned by request, NULL when not a hyperslab read
+        int                     slab_ndims;
         context_t*              context;
         H5Future*               h5f;
+        RequestAccount*         account;    // referenced, NULL when not read for a request
+        const char*             sharedkey;  // owned by request, NULL when not a shared read
     } read_rqst_t;
 
+    typedef List<H5Future*> shared_read_t; // futures attached to a shared read in flight
+
+    typedef struct {
+        const char*             datasetname;
+        RecordObject::valType_t valtype;
+        long                    col;
+        long                    startrow;
+        long                    numrows;
+        H5Future*               h5f;        // populated by readBatch
+    } batch_rqst_t;
+
+    typedef struct {
+        const Asset*            asset;
+        const char*             resource;
+        const char**            datasets;
+        int                     num_datasets;
+        long                    startrow;
+        long                    numrows;
+        context_t*              context;
+        RequestAccount*         account;    // referenced, NULL when not read for a request
+    } readahead_rqst_t;
+
     /*--------------------------------------------------------------------
      * Methods
      *--------------------------------------------------------------------*/
 
-    static void         init            (int num_threads);
+    static void         init            (int num_threads, int num_inflaters=0);
     static void         deinit          (void);
     static info_t       read            (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context=NULL, bool _meta_only=false);
-    static bool         traverse        (const Asset* asset, const char* resource, int max_depth, const char* start_group);
+    static info_t       readRows        (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, const row_range_t* ranges, int num_ranges, context_t* context=NULL);
+    static info_t       readSlab        (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, const slice_t* slab, int ndims, context_t* context=NULL);
+    static bool         traverse        (const Asset* asset, const char* resource, int max_depth, const char* start_group, List<object_t>* objects=NULL);
+    static void*        traverse_thread (void* parm);
 
     static H5Future*    readp           (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context=NULL);
+    static H5Future*    readpRows       (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, const row_range_t* ranges, int num_ranges, context_t* context=NULL);
+    static H5Future*    readpSlab       (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, const slice_t* slab, int ndims, context_t* context=NULL);
+    static H5Future*    readpShared     (const Asset* asset, const char* resource, const char* datasetname, RecordObject::valType_t valtype, long col, long startrow, long numrows, context_t* context=NULL);
+    static int          readBatch       (const Asset* asset, const char* resource, batch_rqst_t* rqsts, int num_rqsts, context_t* context);
+    static void         readahead       (context_t* context, const char** datasets, int num_datasets);
+    static void         readaheadTrigger(const Asset* asset, const char* resource, const char* datasetname, long startrow, long numrows, context_t* context);
+    static void         finishShared    (const char* key, const info_t* info, bool valid);
+    static void         translate       (info_t* info, RecordObject::valType_t valtype, long col, const char* datasetname);
+    static bool         convert         (RecordObject::fieldType_t src_type, const uint8_t* src, RecordObject::valType_t valtype, uint8_t* dst, int64_t num_elements);
     static void*        reader_thread   (void* parm);
+    static void*        readahead_thread(void* parm);
+
+    static int          luaCache        (lua_State* L);
+    static int          luaMetaSave     (lua_State* L);
+    static int          luaMetaLoad     (lua_State* L);
 
     /*--------------------------------------------------------------------
      * Data
@@ -458,6 +766,9 @@ struct H5Coro
     static bool         readerActive;
     static Thread**     readerPids; // thread pool
     static int          threadPoolSize;
+    static LatencyHistogram* readLatency;
+    static Dictionary<shared_read_t*> sharedReads; // keyed by asset, resource, dataset and selection
+    static Mutex        sharedMutex;
 };
 
 #endif  /* __h5coro__ */
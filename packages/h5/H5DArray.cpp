@@ -136,51 +136,47 @@ H5DArray::type_t H5DArray::elementType (void)
  *----------------------------------------------------------------------------*/
 uint64_t H5DArray::serialize (uint8_t* buffer, int32_t start_element, uint32_t num_elements)
 {
-    /* Serialize Elements of Array */
-    if(h5f->info.typesize == 8)
+    int typesize = h5f->info.typesize;
+    if(typesize != 1 && typesize != 2 && typesize != 4 && typesize != 8)
     {
-        uint64_t* src = (uint64_t*)h5f->info.data;
-        uint64_t* dst = (uint64_t*)buffer;
-        for(uint32_t i = start_element; (i < h5f->info.elements) && (i < (start_element + num_elements)); i++)
-        {
-            *dst++ = src[i];
-        }
-    }
-    else if(h5f->info.typesize == 4)
-    {
-        uint32_t* src = (uint32_t*)h5f->info.data;
-        uint32_t* dst = (uint32_t*)buffer;
-        for(uint32_t i = start_element; (i < h5f->info.elements) && (i < (start_element + num_elements)); i++)
-        {
-            *dst++ = src[i];
-        }
+        throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid typesize of %d for %s when trying to serialize", typesize, name);
     }
-    else if(h5f->info.typesize == 2)
+
+    /* Serialize Elements of Array (elements are contiguous) */
+    int64_t elements_available = h5f->info.elements - start_element;
+    if(elements_available < 0) elements_available = 0;
+    uint64_t elements_copied = MIN(elements_available, num_elements);
+    if(elements_copied > 0)
     {
-        uint16_t* src = (uint16_t*)h5f->info.data;
-        uint16_t* dst = (uint16_t*)buffer;
-        for(uint32_t i = start_element; (i < h5f->info.elements) && (i < (start_element + num_elements)); i++)
-        {
-            *dst++ = src[i];
-        }
+        LocalLib::copy(buffer, &h5f->info.data[(int64_t)start_element * typesize], elements_copied * typesize);
     }
-    else if(h5f->info.typesize == 1)
+
+    /* Return Number of Bytes Serialized */
+    return elements_copied * typesize;
+}
+
+/*----------------------------------------------------------------------------
+ * convert
+ *
+ *  converts elements of the array into values of valtype (int for INTEGER,
+ *  double for REAL) written directly into the caller's buffer; returns the
+ *  number of bytes written
+ *----------------------------------------------------------------------------*/
+uint64_t H5DArray::convert (uint8_t* buffer, RecordObject::valType_t valtype, int32_t start_element, uint32_t num_elements)
+{
+    int64_t elements_available = h5f->info.elements - start_element;
+    if(elements_available < 0) elements_available = 0;
+    uint64_t elements_converted = MIN(elements_available, num_elements);
+    if(elements_converted > 0)
     {
-        uint8_t* src = (uint8_t*)h5f->info.data;
-        uint8_t* dst = (uint8_t*)buffer;
-        for(uint32_t i = start_element; (i < h5f->info.elements) && (i < (start_element + num_elements)); i++)
+        const uint8_t* src = &h5f->info.data[(int64_t)start_element * h5f->info.typesize];
+        if(!H5Coro::convert(h5f->info.datatype, src, valtype, buffer, elements_converted))
         {
-            *dst++ = src[i];
+            throw RunTimeException(CRITICAL, RTE_ERROR, "Unable to convert type %d of %s to %d", (int)h5f->info.datatype, name, (int)valtype);
         }
     }
-    else
-    {
-        throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid typesize of %d for %s when trying to serialize", h5f->info.typesize, name);
-    }
 
-    /* Return Number of Bytes Serialized */
-    int64_t elements_available = h5f->info.elements - start_element;
-    if(elements_available < 0) elements_available = 0;
-    uint64_t elements_copied = MIN(elements_available, num_elements);
-    return elements_copied * h5f->info.typesize;
+    /* Return Number of Bytes Converted */
+    int value_size = (valtype == RecordObject::INTEGER) ? sizeof(int) : sizeof(double);
+    return elements_converted * value_size;
 }
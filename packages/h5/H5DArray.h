@@ -69,6 +69,7 @@ class H5DArray
         int         elementSize     (void);
         type_t      elementType     (void);
         uint64_t    serialize       (uint8_t* buffer, int32_t start_element, uint32_t num_elements);
+        uint64_t    convert         (uint8_t* buffer, RecordObject::valType_t valtype, int32_t start_element, uint32_t num_elements);
 
         /*--------------------------------------------------------------------
          * Data
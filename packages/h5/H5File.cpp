@@ -55,6 +55,8 @@ const RecordObject::fieldDef_t H5File::recDef[] = {
     {"datatype",RecordObject::UINT32,   offsetof(h5file_t, datatype),1,             NULL, NATIVE_FLAGS},
     {"elements",RecordObject::UINT32,   offsetof(h5file_t, elements),1,             NULL, NATIVE_FLAGS},
     {"size",    RecordObject::UINT32,   offsetof(h5file_t, size),    1,             NULL, NATIVE_FLAGS},
+    {"startrow",RecordObject::UINT64,   offsetof(h5file_t, startrow),1,             NULL, NATIVE_FLAGS},
+    {"numrows", RecordObject::UINT64,   offsetof(h5file_t, numrows), 1,             NULL, NATIVE_FLAGS},
     {"data",    RecordObject::UINT8,    sizeof(h5file_t),            0,             NULL, NATIVE_FLAGS}
 };
 
@@ -129,7 +131,14 @@ void* H5File::readThread (void* parm)
     try
     {
         /* Read Dataset */
-        results = H5Coro::read(info->h5file->asset, info->h5file->resource, info->dataset, info->valtype, info->col, info->startrow, info->numrows, &(info->h5file->context));
+        if(info->slab_ndims > 0)
+        {
+            results = H5Coro::readSlab(info->h5file->asset, info->h5file->resource, info->dataset, info->valtype, info->slab, info->slab_ndims, &(info->h5file->context));
+        }
+        else
+        {
+            results = H5Coro::read(info->h5file->asset, info->h5file->resource, info->dataset, info->valtype, info->col, info->startrow, info->numrows, &(info->h5file->context));
+        }
     }
     catch (const RunTimeException& e)
     {
@@ -149,6 +158,8 @@ void* H5File::readThread (void* parm)
         rec_data->datatype = (uint32_t)results.datatype;
         rec_data->elements = results.elements;
         rec_data->size = results.datasize;
+        rec_data->startrow = (info->slab_ndims > 0) ? info->slab[0].start : info->startrow;
+        rec_data->numrows = results.numrows;
 
         /* Post Record */
         unsigned char* rec_buf;
@@ -174,6 +185,14 @@ void* H5File::readThread (void* parm)
 
 /*----------------------------------------------------------------------------
  * luaRead - :read(<table of datasets>, <output q>)
+ *
+ *  each dataset entry is {dataset=<name>, [valtype], [col], [startrow], [numrows], [shards]}
+ *  or {dataset=<name>, [valtype], slab={{<start>, <stride>, <count>}, ...}} to
+ *  read a hyperslab selection, one entry per leading dimension
+ *
+ *  when shards is greater than one, the row range is split on chunk boundaries
+ *  into up to that many parts which are read concurrently and posted as they
+ *  complete; each record carries the startrow and numrows it holds
  *----------------------------------------------------------------------------*/
 int H5File::luaRead (lua_State* L)
 {
@@ -202,8 +221,10 @@ int H5File::luaRead (lua_State* L)
             for(int i = 0; i < num_datasets; i++)
             {
                 const char* dataset;
-                long col, startrow, numrows;
+                long col, startrow, numrows, shards;
                 RecordObject::valType_t valtype;
+                H5Coro::slice_t slab[H5FileBuffer::MAX_NDIMS];
+                int slab_ndims = 0;
 
                 /* Get Dataset Entry */
                 lua_rawgeti(L, tbl_index, i+1);
@@ -228,23 +249,91 @@ int H5File::luaRead (lua_State* L)
                     lua_getfield(L, -1, "numrows");
                     numrows = getLuaInteger(L, -1, true, H5Coro::ALL_ROWS);
                     lua_pop(L, 1);
+
+                    lua_getfield(L, -1, "shards");
+                    shards = getLuaInteger(L, -1, true, 1);
+                    lua_pop(L, 1);
+
+                    lua_getfield(L, -1, "slab");
+                    if(lua_istable(L, -1))
+                    {
+                        slab_ndims = lua_rawlen(L, -1);
+                        if(slab_ndims <= 0 || slab_ndims > H5FileBuffer::MAX_NDIMS)
+                        {
+                            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid number of slab dimensions for %s: %d", dataset, slab_ndims);
+                        }
+                        for(int d = 0; d < slab_ndims; d++)
+                        {
+                            lua_rawgeti(L, -1, d+1);
+                            lua_rawgeti(L, -1, 1);
+                            slab[d].start = getLuaInteger(L, -1, true, 0);
+                            lua_pop(L, 1);
+                            lua_rawgeti(L, -1, 2);
+                            slab[d].stride = getLuaInteger(L, -1, true, 1);
+                            lua_pop(L, 1);
+                            lua_rawgeti(L, -1, 3);
+                            slab[d].count = getLuaInteger(L, -1, true, H5Coro::ALL_ROWS);
+                            lua_pop(L, 2);
+                        }
+                    }
+                    lua_pop(L, 1);
                 }
                 else
                 {
                     throw RunTimeException(CRITICAL, RTE_ERROR, "expecting dataset entry");
                 }
 
-                /* Start Thread */
-                dataset_info_t* info = new dataset_info_t;
-                info->dataset = StringLib::duplicate(dataset);
-                info->valtype = valtype;
-                info->col = col;
-                info->startrow = startrow;
-                info->numrows = numrows;
-                info->outqname = StringLib::duplicate(outq_name);
-                info->h5file = lua_obj;
-                Thread* pid = new Thread(readThread, info);
-                pids.add(pid);
+                /* Split Row Range into Shards */
+                bool sharded = false;
+                long shard_rows = 0;
+                long chunk_rows = 0;
+                if(shards > 1 && slab_ndims == 0)
+                {
+                    if(shards > MAX_SHARDS) shards = MAX_SHARDS;
+                    try
+                    {
+                        H5Coro::info_t meta = H5Coro::read(lua_obj->asset, lua_obj->resource, dataset, valtype, col, startrow, numrows, &lua_obj->context, true);
+                        numrows = meta.numrows;
+                        shard_rows = (numrows + shards - 1) / shards;
+                        chunk_rows = H5FileBuffer::metaGetChunkRows(lua_obj->resource, dataset);
+                        sharded = shard_rows > 0;
+                    }
+                    catch(const RunTimeException& e)
+                    {
+                        /* error is reported by the unsharded read */
+                        mlog(DEBUG, "Unable to shard %s: %s", dataset, e.what());
+                    }
+                }
+
+                /* Start Threads */
+                long shard_start = startrow;
+                do
+                {
+                    long shard_numrows = numrows;
+                    if(sharded)
+                    {
+                        /* end each shard on a chunk boundary so no chunk is read twice */
+                        long shard_end = shard_start + shard_rows;
+                        if(chunk_rows > 1) shard_end = ((shard_end + chunk_rows - 1) / chunk_rows) * chunk_rows;
+                        if(shard_end > startrow + numrows) shard_end = startrow + numrows;
+                        shard_numrows = shard_end - shard_start;
+                    }
+
+                    dataset_info_t* info = new dataset_info_t;
+                    info->dataset = StringLib::duplicate(dataset);
+                    info->valtype = valtype;
+                    info->col = col;
+                    info->startrow = shard_start;
+                    info->numrows = shard_numrows;
+                    for(int d = 0; d < slab_ndims; d++) info->slab[d] = slab[d];
+                    info->slab_ndims = slab_ndims;
+                    info->outqname = StringLib::duplicate(outq_name);
+                    info->h5file = lua_obj;
+                    Thread* pid = new Thread(readThread, info);
+                    pids.add(pid);
+
+                    shard_start += shard_numrows;
+                } while(sharded && shard_start < startrow + numrows);
 
                 /* Clean up stack */
                 lua_pop(L, 1);
@@ -271,7 +360,7 @@ int H5File::luaRead (lua_State* L)
         }
 
         /* Status Complete */
-        mlog(INFO, "Finished reading %d datasets from %s", pids.length(), lua_obj->asset->getName());
+        mlog(INFO, "Finished %d dataset reads from %s", pids.length(), lua_obj->asset->getName());
 
         /* Terminate Data */
         Publisher outQ(outq_name);
@@ -284,10 +373,14 @@ int H5File::luaRead (lua_State* L)
 
 /*----------------------------------------------------------------------------
  * luaTraverse - :dir([<max depth>], [<starting group>])
+ *
+ *  returns the status and a table of the objects found keyed by path, with
+ *  each value being either "group" or "dataset"
  *----------------------------------------------------------------------------*/
 int H5File::luaTraverse (lua_State* L)
 {
-    bool  status = false;
+    bool status = false;
+    int num_rets = 1;
 
     try
     {
@@ -296,10 +389,21 @@ int H5File::luaTraverse (lua_State* L)
 
         /* Get Parameters */
         uint32_t max_depth = getLuaInteger(L, 2, true, 32);
-        const char* group_path = getLuaString(L, 3, true, NULL);
+        const char* group_path = getLuaString(L, 3, true, "/");
 
         /* Traverse File */
-        status = H5Coro::traverse(lua_obj->asset, lua_obj->resource, max_depth, group_path);
+        List<H5Coro::object_t> objects;
+        status = H5Coro::traverse(lua_obj->asset, lua_obj->resource, max_depth, group_path, &objects);
+
+        /* Return Objects */
+        lua_newtable(L);
+        for(int i = 0; i < objects.length(); i++)
+        {
+            lua_pushstring(L, objects[i].path);
+            lua_pushstring(L, objects[i].group ? "group" : "dataset");
+            lua_settable(L, -3);
+        }
+        num_rets++;
     }
     catch(const RunTimeException& e)
     {
@@ -307,7 +411,7 @@ int H5File::luaTraverse (lua_State* L)
     }
 
     /* Return Status */
-    return returnLuaStatus(L, status);
+    return returnLuaStatus(L, status, num_rets);
 }
 
 /*----------------------------------------------------------------------------
@@ -55,6 +55,7 @@ class H5File: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int MAX_NAME_STR = H5CORO_MAXIMUM_NAME_SIZE;
+        static const int MAX_SHARDS = 64;
 
         static const char* ObjectType;
         static const char* LuaMetaName;
@@ -72,6 +73,8 @@ class H5File: public LuaObject
             uint32_t    datatype; // RecordObject::valType_t
             uint32_t    elements; // number of values
             uint32_t    size; // total size in bytes
+            uint64_t    startrow; // first row of dataset contained in record
+            uint64_t    numrows; // number of rows contained in record
         } h5file_t;
 
         /*--------------------------------------------------------------------
@@ -93,6 +96,8 @@ class H5File: public LuaObject
             long                    col;
             long                    startrow;
             long                    numrows;
+            H5Coro::slice_t         slab[H5FileBuffer::MAX_NDIMS];
+            int                     slab_ndims; // 0 when not a hyperslab read
             const char*             outqname;
             H5File*                 h5file;
         } dataset_info_t;
@@ -46,6 +46,10 @@
 #define H5CORO_THREAD_POOL_SIZE 128
 #endif
 
+#ifndef H5CORO_INFLATE_POOL_SIZE
+#define H5CORO_INFLATE_POOL_SIZE 0 // chunks inflated on reading thread
+#endif
+
 /******************************************************************************
  * LOCAL FUNCTIONS
  ******************************************************************************/
@@ -58,6 +62,9 @@ int h5_open (lua_State *L)
     static const struct luaL_Reg h5_functions[] = {
         {"file",        H5File::luaCreate},
         {"dataset",     H5DatasetDevice::luaCreate},
+        {"cache",       H5Coro::luaCache},
+        {"metasave",    H5Coro::luaMetaSave},
+        {"metaload",    H5Coro::luaMetaLoad},
         {NULL,          NULL}
     };
 
@@ -78,7 +85,7 @@ extern "C" {
 void inith5 (void)
 {
     /* Initialize Modules */
-    H5Coro::init(H5CORO_THREAD_POOL_SIZE);
+    H5Coro::init(H5CORO_THREAD_POOL_SIZE, H5CORO_INFLATE_POOL_SIZE);
     H5DArray::init();
     H5DatasetDevice::init();
     H5File::init();
@@ -58,6 +58,7 @@ CommandableObject* CcsdsFileWriter::createObject(CommandProcessor* cmd_proc, con
     const char* prefix = StringLib::checkNullStr(argv[1]);
     const char* stream = StringLib::checkNullStr(argv[2]);
     const char* maxstr = NULL; // argv[3]
+    const char* iostr = NULL; // argv[4]
 
     if(format == INVALID)
     {
@@ -78,7 +79,7 @@ CommandableObject* CcsdsFileWriter::createObject(CommandProcessor* cmd_proc, con
     }
 
     unsigned long filesize = CcsdsFileWriter::FILE_MAX_SIZE;
-    if(argc == 4)
+    if(argc >= 4)
     {
         maxstr = argv[3];
         if(!StringLib::str2ulong(maxstr, &filesize))
@@ -88,7 +89,19 @@ CommandableObject* CcsdsFileWriter::createObject(CommandProcessor* cmd_proc, con
         }
     }
 
-    return new CcsdsFileWriter(cmd_proc, name, format, prefix, stream, filesize);
+    File::io_t io = File::CACHED;
+    if(argc >= 5)
+    {
+        iostr = argv[4];
+        io = File::str2io(iostr);
+        if(io != File::CACHED && io != File::ASYNC && io != File::DIRECT)
+        {
+            mlog(CRITICAL, "Error: invalid file i/o: %s", iostr);
+            return NULL;
+        }
+    }
+
+    return new CcsdsFileWriter(cmd_proc, name, format, prefix, stream, filesize, io);
 }
 
 /*----------------------------------------------------------------------------
@@ -122,7 +135,7 @@ const char* CcsdsFileWriter::fmt2str(CcsdsFileWriter::fmt_t _fmt)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-CcsdsFileWriter::CcsdsFileWriter(CommandProcessor* cmd_proc, const char* obj_name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _maxFileSize):
+CcsdsFileWriter::CcsdsFileWriter(CommandProcessor* cmd_proc, const char* obj_name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _maxFileSize, File::io_t _io):
     CcsdsMsgProcessor(cmd_proc, obj_name, TYPE, inq_name)
 {
     assert(_prefix);
@@ -141,6 +154,7 @@ CcsdsFileWriter::CcsdsFileWriter(CommandProcessor* cmd_proc, const char* obj_nam
     fileCount = 0;
     fileBytesWritten = 0;
     maxFileSize = _maxFileSize;
+    io = _io;
 
     registerCommand("FLUSH", (cmdFunc_t)&CcsdsFileWriter::flushCmd,  0,  "");
 
@@ -191,8 +205,9 @@ bool CcsdsFileWriter::openNewFile(void)
     /* Open New File */
     if(outfp != NULL) fclose(outfp);
     StringLib::format(filename, FILENAME_MAX_CHARS, "%s_%ld.out", prefix, fileCount);
-    if(isBinary())  outfp = fopen((const char*)filename, "wb");
-    else            outfp = fopen((const char*)filename, "w");
+    if(io == File::ASYNC || io == File::DIRECT) outfp = AsyncFile::open(filename, io == File::DIRECT, maxFileSize);
+    else if(isBinary())                         outfp = fopen((const char*)filename, "wb");
+    else                                        outfp = fopen((const char*)filename, "w");
     if(outfp == NULL)
     {
     	mlog(CRITICAL, "Error opening file: %s, err: %s", filename, LocalLib::err2str(errno));
@@ -37,6 +37,7 @@
  ******************************************************************************/
 
 #include "MsgQ.h"
+#include "File.h"
 #include "CcsdsMsgProcessor.h"
 
 /******************************************************************************
@@ -92,12 +93,13 @@ class CcsdsFileWriter: public CcsdsMsgProcessor
         unsigned long       fileCount;
         unsigned long       fileBytesWritten;
         unsigned int        maxFileSize;
+        File::io_t          io;
 
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
 
-                        CcsdsFileWriter     (CommandProcessor* cmd_proc, const char* name, fmt_t fmt, const char* _prefix, const char* inq_name, unsigned int _maxFileSize=FILE_MAX_SIZE);
+                        CcsdsFileWriter     (CommandProcessor* cmd_proc, const char* name, fmt_t fmt, const char* _prefix, const char* inq_name, unsigned int _maxFileSize=FILE_MAX_SIZE, File::io_t _io=File::CACHED);
         virtual         ~CcsdsFileWriter    (void);
 
         virtual bool    openNewFile         (void);
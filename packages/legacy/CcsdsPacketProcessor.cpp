@@ -115,21 +115,16 @@ CcsdsPacketProcessor::CcsdsPacketProcessor(CommandProcessor* cmd_proc, const cha
     	numWorkerThreads = num_workers;
     }
 
-    /* Create and Start Parser Threads */
-    pubAvailQ = new Publisher(NULL, freeWorker, numWorkerThreads, sizeof(workerThread_t));
-    subAvailQ = new Subscriber(*pubAvailQ);
+    /* Create and Start Worker Threads - each with its own ordered queue */
+    pendingBatches = 0;
     workerThreads = new Thread* [numWorkerThreads];
     workerThreadPool = new workerThread_t[numWorkerThreads];
     for(int i = 0; i < numWorkerThreads; i++)
     {
         workerThreadPool[i].msgproc = this;
-        workerThreadPool[i].processor = NULL;
-        workerThreadPool[i].segments = NULL;
-        workerThreadPool[i].numpkts = 0;
-        workerThreadPool[i].availq = pubAvailQ;
-
+        workerThreadPool[i].pubq = new Publisher(NULL);
+        workerThreadPool[i].subq = new Subscriber(*workerThreadPool[i].pubq);
         workerThreads[i] = new Thread(workerThread, &workerThreadPool[i]);
-        pubAvailQ->postRef(&workerThreadPool[i], sizeof(workerThread_t));
     }
 
     /* Initialize Packet Parsing Data */
@@ -140,6 +135,7 @@ CcsdsPacketProcessor::CcsdsPacketProcessor(CommandProcessor* cmd_proc, const cha
         pktProcessor[i].segments = NULL;
         pktProcessor[i].intpkts = 0;
         pktProcessor[i].intperiod = 1;
+        pktProcessor[i].worker = i % numWorkerThreads; // all batches of an apid go to one worker, keeping them in order
     }
 
     /* Register Current Values */
@@ -168,17 +164,30 @@ CcsdsPacketProcessor::~CcsdsPacketProcessor(void)
     workersActive = false; // stop workers
     stop(); // stop processor
 
-    if(resetProcessing())
+    /* Join Workers */
+    for(int i = 0; i < numWorkerThreads; i++)
     {
-        delete pubAvailQ;
-        delete subAvailQ;
-        for(int i = 0; i < numWorkerThreads; i++)
+        delete workerThreads[i];
+    }
+    delete [] workerThreads;
+
+    /* Free Batches Never Processed */
+    for(int i = 0; i < numWorkerThreads; i++)
+    {
+        Subscriber::msgRef_t ref;
+        while(workerThreadPool[i].subq->receiveRef(ref, IO_CHECK) > 0)
         {
-            delete workerThreads[i];
+            deleteSegments(((workBatch_t*)ref.data)->segments);
+            workerThreadPool[i].subq->dereference(ref);
+            pendingBatches--;
         }
-        delete [] workerThreads;
-        delete [] workerThreadPool;
+        delete workerThreadPool[i].subq;
+        delete workerThreadPool[i].pubq;
     }
+    delete [] workerThreadPool;
+
+    /* Free Stored Packets */
+    resetProcessing();
 }
 
 /*----------------------------------------------------------------------------
@@ -401,18 +410,25 @@ void* CcsdsPacketProcessor::workerThread (void* parm)
     while(worker->msgproc->workersActive)
     {
         /* Wait for Work to Do */
-        while(!worker->runsem.take(SYS_TIMEOUT) && worker->msgproc->workersActive);
-        if(!worker->msgproc->workersActive) break;
+        Subscriber::msgRef_t ref;
+        int status = worker->subq->receiveRef(ref, SYS_TIMEOUT);
+        if(status == MsgQ::STATE_TIMEOUT) continue;
+        else if(status <= 0)
+        {
+            mlog(CRITICAL, "Failed (%d) to receive work ...exiting thread!", status);
+            break;
+        }
+        workBatch_t* batch = (workBatch_t*)ref.data;
 
         /* Process Packet Segments */
-        if(worker->processor->processSegments(*(worker->segments), worker->numpkts) == false)
+        if(batch->processor->processSegments(*(batch->segments), batch->numpkts) == false)
         {
-            mlog(ERROR, "%s failed to process packet, packet dropped", worker->processor->getName());
+            mlog(ERROR, "%s failed to process packet, packet dropped", batch->processor->getName());
             if(worker->msgproc->dumpErrors)
             {
-                for(int s = 0; s < worker->segments->length(); s++)
+                for(int s = 0; s < batch->segments->length(); s++)
                 {
-                    CcsdsPacket* seg = worker->segments->get(s);
+                    CcsdsPacket* seg = batch->segments->get(s);
                     int seglen = seg->getLEN();
                     unsigned char* segbuf = seg->getBuffer();
                     print2term("[%d]: ", seglen);
@@ -423,20 +439,9 @@ void* CcsdsPacketProcessor::workerThread (void* parm)
         }
 
         /* Delete Packets */
-        for(int s = 0; s < worker->segments->length(); s++)
-        {
-            delete worker->segments->get(s); // deletes malloc'ed CcsdsPacket in processMsg
-        }
-        delete worker->segments; // deletes malloc'ed List<CcsdsPacket*> in processMsg
-        worker->segments = NULL; // informs resetProcessing() that segments has been freed
-
-        /* Make Available Again */
-        int status = worker->availq->postRef(worker, sizeof(workerThread_t));
-        if(status <= 0)
-        {
-            mlog(CRITICAL, "Failed to post available worker ...exiting thread!");
-            break;
-        }
+        deleteSegments(batch->segments);
+        worker->subq->dereference(ref);
+        worker->msgproc->pendingBatches--; // informs resetProcessing() that batch has been freed
     }
 
     return NULL;
@@ -459,22 +464,11 @@ bool CcsdsPacketProcessor::processMsg (unsigned char* msg, int bytes)
         return true; // packet still handled, no need to kill self
     }
 
-    /* Create Packet */
-    CcsdsSpacePacket* pkt = NULL;
-    try
-    {
-        pkt = new CcsdsSpacePacket(msg, bytes, true); // memory allocated here
-    }
-    catch (RunTimeException& e)
-    {
-        mlog(e.level(), "Unable to create CCSDS packet from buffer: %s", e.what());
-        return false;
-    }
-
-    /* Pull Out CCSDS Header Parameters */
-    uint16_t apid = pkt->getAPID();
-    uint16_t len  = pkt->getLEN();
-    CcsdsSpacePacket::seg_flags_t seg = pkt->getSEQFLG();
+    /* Pull Out CCSDS Header Parameters (in place) */
+    CcsdsSpacePacket view(msg, bytes, false);
+    uint16_t apid = view.getAPID();
+    uint16_t len  = view.getLEN();
+    CcsdsSpacePacket::seg_flags_t seg = view.getSEQFLG();
 
     /* Check if Enabled */
     if(pktProcessor[apid].enable)
@@ -486,6 +480,9 @@ bool CcsdsPacketProcessor::processMsg (unsigned char* msg, int bytes)
             return true; // packet still handled, no need to kill self
         }
 
+        /* Copy Packet - only segments that are buffered outlive the message */
+        CcsdsSpacePacket* pkt = new CcsdsSpacePacket(msg, bytes, true); // memory allocated here
+
         /* Buffer Segment */
         if(pktProcessor[apid].segments == NULL)
         {
@@ -511,29 +508,27 @@ bool CcsdsPacketProcessor::processMsg (unsigned char* msg, int bytes)
                     cmdProc->setCurrentValue(getName(), latencyKey, (void*)&latency, sizeof(latency));
                 }
 
-                /* Grab Available Worker */
-                Subscriber::msgRef_t ref;
-                int status = subAvailQ->receiveRef(ref, 5000); // wait for five seconds
-                if(status > 0)
+                /* Queue Batch to Worker Affinitized to APID */
+                workBatch_t batch;
+                batch.processor = pktProcessor[apid].processor;
+                batch.segments  = pktProcessor[apid].segments;
+                batch.numpkts   = pktProcessor[apid].intperiod;
+                Publisher* pubq = workerThreadPool[pktProcessor[apid].worker].pubq;
+                pendingBatches++;
+                int status = MsgQ::STATE_TIMEOUT;
+                while(isActive() && status == MsgQ::STATE_TIMEOUT)
                 {
-                    subAvailQ->dereference(ref, false); // free up memory in message queue, but don't delete the worker
-                    workerThread_t* worker = (workerThread_t*)ref.data;
-
-                    /* Configure Worker */
-                    worker->processor   = pktProcessor[apid].processor;
-                    worker->segments    = pktProcessor[apid].segments;
-                    worker->numpkts     = pktProcessor[apid].intperiod;
-
-                    /* Reset Segment List */
-                    pktProcessor[apid].segments = NULL;
-
-                    /* Kick Off Worker */
-                    worker->runsem.give();
+                    status = pubq->postCopy(&batch, sizeof(batch), SYS_TIMEOUT);
                 }
-                else
+                if(status <= 0)
                 {
-                    mlog(CRITICAL, "%s failed to get available worker!", getName());
+                    mlog(CRITICAL, "%s failed (%d) to queue packets for APID %04X to worker!", getName(), status, apid);
+                    deleteSegments(batch.segments);
+                    pendingBatches--;
                 }
+
+                /* Reset Segment List */
+                pktProcessor[apid].segments = NULL;
             }
         }
     }
@@ -575,27 +570,24 @@ bool CcsdsPacketProcessor::resetProcessing (void)
 
     /* Wait for all workers to finish */
     int worker_check = 5;
-    while( (worker_check-- > 0) && (subAvailQ->getCount() != numWorkerThreads)) LocalLib::sleep(1);
+    while( (worker_check-- > 0) && (pendingBatches > 0) && workersActive) LocalLib::sleep(1);
 
     /* Clear out stored packets in parsers */
-    if(subAvailQ->getCount() == numWorkerThreads)
+    if(pendingBatches == 0 || !workersActive)
     {
         for(int apid = 0; apid < CCSDS_NUM_APIDS; apid++)
         {
-            if(pktProcessor[apid].enable && pktProcessor[apid].segments)
+            if(pktProcessor[apid].segments)
             {
-                for(int seg=0; seg < pktProcessor[apid].segments->length(); seg++)
-                {
-                    delete pktProcessor[apid].segments->get(seg);
-                }
-                pktProcessor[apid].segments->clear();
-                delete pktProcessor[apid].segments;
+                deleteSegments(pktProcessor[apid].segments);
+                pktProcessor[apid].segments = NULL;
+                pktProcessor[apid].intpkts = 0;
             }
         }
     }
     else
     {
-        mlog(CRITICAL, "unable to flush packet queue as all workers did not complete in time allowed: %d of %d", subAvailQ->getCount(), numWorkerThreads);
+        mlog(CRITICAL, "unable to flush packet queue as workers did not complete in time allowed: %d batches outstanding", pendingBatches.load());
         return false;
     }
 
@@ -603,13 +595,13 @@ bool CcsdsPacketProcessor::resetProcessing (void)
 }
 
 /*----------------------------------------------------------------------------
- * freeWorker
+ * deleteSegments
  *----------------------------------------------------------------------------*/
-void CcsdsPacketProcessor::freeWorker (void* obj, void* parm)
+void CcsdsPacketProcessor::deleteSegments (List<CcsdsSpacePacket*>* segments)
 {
-    (void)parm;
-    workerThread_t* worker = (workerThread_t*)obj;
-
-    // -- DO NOT DELETE ... this memory is deallocated in the delete [] of workerThreadPool
-    (void) worker;
+    for(int s = 0; s < segments->length(); s++)
+    {
+        delete segments->get(s); // deletes malloc'ed CcsdsPacket in processMsg
+    }
+    delete segments; // deletes malloc'ed List<CcsdsPacket*> in processMsg
 }
@@ -44,6 +44,8 @@
 #include "Dictionary.h"
 #include "CcsdsPacket.h"
 
+#include <atomic>
+
 /******************************************************************************
  * CCSDS PACKET PROCESSOR CLASS
  ******************************************************************************/
@@ -82,16 +84,19 @@ class CcsdsPacketProcessor: public CcsdsMsgProcessor
             List<CcsdsSpacePacket*>*    segments;   // allocated at run time
             int                         intpkts;    // full packets (not segments))
             int                         intperiod;  // full packets (not segments))
+            int                         worker;     // index of worker thread the apid is affinitized to
         } pktProcessor_t;
 
         typedef struct {
-            CcsdsPacketProcessor*       msgproc;
             CcsdsProcessorModule*       processor;
             List<CcsdsSpacePacket*>*    segments;   // passed from pktProcessor_t
             unsigned int                numpkts;
-            unsigned int                tries;      // 0 is infinite
-            Sem                         runsem;
-            Publisher*                  availq;
+        } workBatch_t;
+
+        typedef struct {
+            CcsdsPacketProcessor*       msgproc;
+            Publisher*                  pubq;       // batches for apids affinitized to worker, in order
+            Subscriber*                 subq;
         } workerThread_t;
 
         /*--------------------------------------------------------------------
@@ -100,6 +105,7 @@ class CcsdsPacketProcessor: public CcsdsMsgProcessor
 
         int             numWorkerThreads;
         bool            workersActive;
+        std::atomic<int> pendingBatches;  // posted to workers but not yet processed
 
         bool            cmdFlush;
         bool            autoFlush;
@@ -113,9 +119,6 @@ class CcsdsPacketProcessor: public CcsdsMsgProcessor
         workerThread_t* workerThreadPool; // dynamically allocated array of worker threads
         pktProcessor_t  pktProcessor[CCSDS_NUM_APIDS];
 
-        Subscriber*     subAvailQ;
-        Publisher*      pubAvailQ;
-
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -137,7 +140,7 @@ class CcsdsPacketProcessor: public CcsdsMsgProcessor
         bool            handleTimeout           (void); // OVERLOAD
         bool            resetProcessing         (void);
 
-        static void     freeWorker              (void* obj, void* parm);
+        static void     deleteSegments          (List<CcsdsSpacePacket*>* segments);
 };
 
 #endif  /* __ccsds_packet_processor__ */
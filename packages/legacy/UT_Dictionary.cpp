@@ -66,6 +66,9 @@ UT_Dictionary::UT_Dictionary(CommandProcessor* cmd_proc, const char* obj_name):
     /* Register Commands */
     registerCommand("FUNCTIONAL_TEST", (cmdFunc_t)&UT_Dictionary::functionalUnitTestCmd, 1, "<set name>");
     registerCommand("ITERATOR_TEST", (cmdFunc_t)&UT_Dictionary::iteratorUnitTestCmd, 1, "<set name>");
+    registerCommand("FLAT_FUNCTIONAL_TEST", (cmdFunc_t)&UT_Dictionary::flatFunctionalUnitTestCmd, 1, "<set name>");
+    registerCommand("FLAT_ITERATOR_TEST", (cmdFunc_t)&UT_Dictionary::flatIteratorUnitTestCmd, 1, "<set name>");
+    registerCommand("BENCHMARK", (cmdFunc_t)&UT_Dictionary::benchmarkCmd, -1, "<set name> [<iterations>]");
     registerCommand("ADD_WORD_SET", (cmdFunc_t)&UT_Dictionary::addWordSetCmd, 3, "<set name> <filename> <num words in set>");
 }
 
@@ -94,35 +97,113 @@ int UT_Dictionary::functionalUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
 {
     (void)argc;
 
-    Dictionary<long> d1;
+    return functionalTest<Dictionary<long>>(argv[0]);
+}
 
-    long seq;
-    int hash_size;
-    int max_chain;
-    int num_entries;
+/*----------------------------------------------------------------------------
+ * flatFunctionalUnitTestCmd  -
+ *----------------------------------------------------------------------------*/
+int UT_Dictionary::flatFunctionalUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
 
-    bool failure=false;
+    return functionalTest<FlatDictionary<long>>(argv[0]);
+}
 
-    /* Start Timer */
-    int64_t start_time = TimeLib::gettimems();
+/*----------------------------------------------------------------------------
+ * iteratorUnitTestCmd  -
+ *----------------------------------------------------------------------------*/
+int UT_Dictionary::iteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
 
-    /* Get Word List */
-    const char* wordset_name = argv[0];
-    List<SafeString*>* wordlist_ptr;
+    return iteratorTest<Dictionary<long>>(argv[0]);
+}
+
+/*----------------------------------------------------------------------------
+ * flatIteratorUnitTestCmd  -
+ *----------------------------------------------------------------------------*/
+int UT_Dictionary::flatIteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+
+    return iteratorTest<FlatDictionary<long>>(argv[0]);
+}
+
+/*----------------------------------------------------------------------------
+ * benchmarkCmd  -
+ *
+ *  times add, find, and remove of every word in the set for both dictionary
+ *  implementations
+ *----------------------------------------------------------------------------*/
+int UT_Dictionary::benchmarkCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    if(argc < 1)
+    {
+        print2term("[%d] ERROR: must supply word set name\n", __LINE__);
+        return -1;
+    }
+
+    long iterations = 1;
+    if(argc > 1 && (!StringLib::str2long(argv[1], &iterations) || iterations <= 0))
+    {
+        print2term("[%d] ERROR: invalid number of iterations %s\n", __LINE__, argv[1]);
+        return -1;
+    }
+
+    if(benchmark<Dictionary<long>>("Dictionary", argv[0], iterations) != 0) return -1;
+    if(benchmark<FlatDictionary<long>>("FlatDictionary", argv[0], iterations) != 0) return -1;
+
+    return 0;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * getWordSet  -
+ *----------------------------------------------------------------------------*/
+List<SafeString*>* UT_Dictionary::getWordSet (const char* wordset_name)
+{
     try
     {
-        wordlist_ptr = (List<SafeString*>*)wordsets[wordset_name];
+        List<SafeString*>* wordlist_ptr = (List<SafeString*>*)wordsets[wordset_name];
         if(wordlist_ptr->length() <= 0)
         {
             print2term("[%d] ERROR: word set %s is empty!\n", __LINE__, wordset_name);
-            return -1;
+            return NULL;
         }
+        return wordlist_ptr;
     }
     catch(RunTimeException& e)
     {
         print2term("[%d] ERROR: unable to locate word set %s: %s\n", __LINE__, wordset_name, e.what());
-        return -1;
+        return NULL;
     }
+}
+
+/*----------------------------------------------------------------------------
+ * functionalTest  -
+ *----------------------------------------------------------------------------*/
+template <class D>
+int UT_Dictionary::functionalTest (const char* wordset_name)
+{
+    D d1;
+
+    long seq;
+    int hash_size;
+    int max_chain;
+    int num_entries;
+
+    bool failure=false;
+
+    /* Start Timer */
+    int64_t start_time = TimeLib::gettimems();
+
+    /* Get Word List */
+    List<SafeString*>* wordlist_ptr = getWordSet(wordset_name);
+    if(!wordlist_ptr) return -1;
 
     /* Get Number of Words */
     List<SafeString*>& wordset = *wordlist_ptr;
@@ -293,33 +374,18 @@ int UT_Dictionary::functionalUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
 }
 
 /*----------------------------------------------------------------------------
- * iteratorUnitTestCmd  -
+ * iteratorTest  -
  *----------------------------------------------------------------------------*/
-int UT_Dictionary::iteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+template <class D>
+int UT_Dictionary::iteratorTest (const char* wordset_name)
 {
-    (void)argc;
-
-    Dictionary<long> d1;
+    D d1;
     long seq, sum;
     bool failure=false;
 
     /* Get Word List */
-    const char* wordset_name = argv[0];
-    List<SafeString*>* wordlist_ptr;
-    try
-    {
-        wordlist_ptr = (List<SafeString*>*)wordsets[wordset_name];
-        if(wordlist_ptr->length() <= 0)
-        {
-            print2term("[%d] ERROR: word set %s is empty!\n", __LINE__, wordset_name);
-            return -1;
-        }
-    }
-    catch(RunTimeException& e)
-    {
-        print2term("[%d] ERROR: unable to locate word set %s: %s\n", __LINE__, wordset_name, e.what());
-        return -1;
-    }
+    List<SafeString*>* wordlist_ptr = getWordSet(wordset_name);
+    if(!wordlist_ptr) return -1;
 
     /* Get Word Set */
     List<SafeString*>& wordset = *wordlist_ptr;
@@ -381,7 +447,7 @@ int UT_Dictionary::iteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
     /* Iterate via Iterator Through Dictionary */
     tsum = 0;
     {
-        Dictionary<long>::Iterator iterator(d1);
+        typename D::Iterator iterator(d1);
         for(int i = 0; i < iterator.length; i++)
         {
             tsum += iterator[i].value;
@@ -400,6 +466,68 @@ int UT_Dictionary::iteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
     else        return 0;
 }
 
+/*----------------------------------------------------------------------------
+ * benchmark  -
+ *----------------------------------------------------------------------------*/
+template <class D>
+int UT_Dictionary::benchmark (const char* dictionary_name, const char* wordset_name, long iterations)
+{
+    bool failure = false;
+
+    /* Get Word List */
+    List<SafeString*>* wordlist_ptr = getWordSet(wordset_name);
+    if(!wordlist_ptr) return -1;
+    List<SafeString*>& wordset = *wordlist_ptr;
+    int numwords = wordset.length();
+
+    int64_t add_time = 0;
+    int64_t find_time = 0;
+    int64_t remove_time = 0;
+
+    for(long n = 0; n < iterations; n++)
+    {
+        D d1;
+
+        /* Add Entries */
+        int64_t start_time = TimeLib::gettimems();
+        for(int i = 0; i < numwords; i++)
+        {
+            long seq = i;
+            if(!d1.add(wordset[i]->getString(), seq)) failure = true;
+        }
+        int64_t add_stop = TimeLib::gettimems();
+
+        /* Find Entries */
+        for(int i = 0; i < numwords; i++)
+        {
+            if(!d1.find(wordset[i]->getString())) failure = true;
+        }
+        int64_t find_stop = TimeLib::gettimems();
+
+        /* Remove Entries */
+        for(int i = 0; i < numwords; i++)
+        {
+            if(!d1.remove(wordset[i]->getString())) failure = true;
+        }
+        int64_t remove_stop = TimeLib::gettimems();
+
+        add_time += add_stop - start_time;
+        find_time += find_stop - add_stop;
+        remove_time += remove_stop - find_stop;
+    }
+
+    print2term("%s [%s x %ld]: add %.3lf, find %.3lf, remove %.3lf seconds\n", dictionary_name, wordset_name, iterations,
+                (double)add_time / 1000.0, (double)find_time / 1000.0, (double)remove_time / 1000.0);
+
+    if(failure)
+    {
+        print2term("[%d] ERROR: %s failed benchmark operations on word set %s\n", __LINE__, dictionary_name, wordset_name);
+        return -1;
+    }
+
+    return 0;
+}
+
 /*----------------------------------------------------------------------------
  * addWordSetCmd  -
  *----------------------------------------------------------------------------*/
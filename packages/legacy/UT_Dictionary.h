@@ -35,6 +35,7 @@
 #include "List.h"
 #include "StringLib.h"
 #include "Dictionary.h"
+#include "FlatDictionary.h"
 #include "CommandableObject.h"
 #include "OsApi.h"
 
@@ -75,8 +76,16 @@ class UT_Dictionary: public CommandableObject
 
         int functionalUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
         int iteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
+        int flatFunctionalUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
+        int flatIteratorUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
+        int benchmarkCmd (int argc, char argv[][MAX_CMD_SIZE]);
         int addWordSetCmd (int argc, char argv[][MAX_CMD_SIZE]);
         int createWordSet (const char* name, const char* filename);
+
+        List<SafeString*>* getWordSet (const char* wordset_name);
+        template <class D> int functionalTest (const char* wordset_name);
+        template <class D> int iteratorTest (const char* wordset_name);
+        template <class D> int benchmark (const char* dictionary_name, const char* wordset_name, long iterations);
 };
 
 #endif  /* __ut_dictionary__ */
@@ -34,6 +34,7 @@
  ******************************************************************************/
 
 #include <stdlib.h>
+#include <string>
 #include "UT_List.h"
 #include "core.h"
 
@@ -75,6 +76,7 @@ UT_List::UT_List(CommandProcessor* cmd_proc, const char* obj_name):
     registerCommand("ADD_REMOVE", (cmdFunc_t)&UT_List::testAddRemove,  0, "");
     registerCommand("DUPLICATES", (cmdFunc_t)&UT_List::testDuplicates, 0, "");
     registerCommand("SORT",       (cmdFunc_t)&UT_List::testSort,       0, "");
+    registerCommand("ARRAY_LIST", (cmdFunc_t)&UT_List::testArrayList,  0, "");
 }
 
 /*----------------------------------------------------------------------------
@@ -260,3 +262,75 @@ int UT_List::testSort(int argc, char argv[][MAX_CMD_SIZE])
 
     return failures == 0 ? 0 : -1;
 }
+
+/*--------------------------------------------------------------------------------------
+ * testArrayList
+ *--------------------------------------------------------------------------------------*/
+int UT_List::testArrayList(int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+    (void)argv;
+
+    failures = 0;
+
+    // add and remove (mirrors testAddRemove)
+    ArrayList<int> mylist(4);
+    for(int i = 0; i < 75; i++) mylist.add(i);
+    ut_assert(mylist.length() == 75, "failed length check %d\n", mylist.length());
+    for(int i = 0; i < 75; i++) ut_assert(mylist[i] == i, "failed to add %d\n", i);
+    for(int i = 66; i >= 0; i -= 11) mylist.remove(i);
+    ut_assert(mylist.length() == 68, "failed length check %d\n", mylist.length());
+    int j = 0;
+    for(int i = 0; i < 75; i++)
+    {
+        if(i % 11 == 0) continue;
+        ut_assert(mylist[j++] == i, "failed to keep %d\n", i);
+    }
+    ut_assert(!mylist.remove(68), "removed out of range index\n");
+
+    // contiguous iteration
+    long sum = 0;
+    for(int v: mylist) sum += v;
+    ut_assert(sum == (74 * 75 / 2) - (0 + 11 + 22 + 33 + 44 + 55 + 66), "failed to iterate, sum = %ld\n", sum);
+    ut_assert(mylist.end() - mylist.begin() == mylist.length(), "failed contiguous range\n");
+
+    // reserve
+    ArrayList<int> reserved;
+    reserved.reserve(1000);
+    int* storage = reserved.begin();
+    for(int i = 0; i < 1000; i++) reserved.add(i);
+    ut_assert(reserved.begin() == storage, "reallocated after reserve\n");
+    ut_assert(reserved.capacity() == 1000, "failed capacity check %d\n", reserved.capacity());
+
+    // sort
+    ArrayList<int> sorted;
+    for(int i = 0; i < 20; i++) sorted.add((i * 7) % 20);
+    sorted.sort();
+    for(int i = 0; i < 20; i++) ut_assert(sorted[i] == i, "failed to sort %d\n", i);
+
+    // non-pod elements and moves
+    ArrayList<std::string> strlist(2);
+    std::string word("sliderule");
+    strlist.add(word);
+    strlist.add(std::string("icesat2"));
+    for(int i = 0; i < 100; i++) strlist.add(strlist[0]); // grows while adding an element of itself
+    ut_assert(word == "sliderule", "moved from lvalue\n");
+    ut_assert(strlist[1] == "icesat2", "failed to move in rvalue\n");
+    ut_assert(strlist[101] == "sliderule", "failed to add own element\n");
+    strlist.remove(0);
+    ut_assert(strlist[0] == "icesat2", "failed to shift strings\n");
+    ArrayList<std::string> copied(strlist);
+    ArrayList<std::string> moved(std::move(strlist));
+    ut_assert(copied.length() == 101 && moved.length() == 101, "failed copy/move %d %d\n", copied.length(), moved.length());
+    ut_assert(strlist.length() == 0, "moved from list not empty\n");
+    strlist.add(word);
+    ut_assert(strlist.length() == 1, "failed to reuse moved from list\n");
+
+    // managed list
+    MgArrayList<int*> mglist;
+    for(int i = 0; i < 10; i++) mglist.add(new int(i));
+    mglist.remove(5);
+    ut_assert(*mglist[5] == 6, "failed managed remove\n");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -80,6 +80,7 @@ class UT_List: public CommandableObject
 	int     testAddRemove       (int argc, char argv[][MAX_CMD_SIZE]);
 	int     testDuplicates      (int argc, char argv[][MAX_CMD_SIZE]);
 	int     testSort            (int argc, char argv[][MAX_CMD_SIZE]);
+	int     testArrayList       (int argc, char argv[][MAX_CMD_SIZE]);
 };
 
 #endif  /* __ut_list__ */
@@ -69,6 +69,7 @@ UT_MsgQ::UT_MsgQ(CommandProcessor* cmd_proc, const char* obj_name):
     registerCommand("SUBSCRIBE_UNSUBSCRIBE_TEST", (cmdFunc_t)&UT_MsgQ::subscribeUnsubscribeUnitTestCmd, 0, "");
     registerCommand("PERFORMANCE_TEST", (cmdFunc_t)&UT_MsgQ::performanceUnitTestCmd, 0, "[<depth> <size>]");
     registerCommand("SUBSCRIBER_OF_OPPORTUNITY_TEST", (cmdFunc_t)&UT_MsgQ::subscriberOfOpporunityUnitTestCmd, 0, "");    
+    registerCommand("SPSC_TEST", (cmdFunc_t)&UT_MsgQ::singleProducerSingleConsumerUnitTestCmd, 0, "");
 }
 
 /*----------------------------------------------------------------------------
@@ -491,6 +492,88 @@ int UT_MsgQ::subscriberOfOpporunityUnitTestCmd (int argc, char argv[][MAX_CMD_SI
     else            return -1;
 }
 
+/*----------------------------------------------------------------------------
+ * singleProducerSingleConsumerUnitTestCmd  -
+ *----------------------------------------------------------------------------*/
+int UT_MsgQ::singleProducerSingleConsumerUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+    (void)argv;
+
+    bool test_status = true;
+
+    /* Set Unit Test Parameters */
+    parms_t unit_test_parms;
+    LocalLib::set(&unit_test_parms, 0, sizeof(unit_test_parms));
+    unit_test_parms.qname = "testq_05";
+    unit_test_parms.loopcnt = 300000;
+    unit_test_parms.qdepth = 64;
+    unit_test_parms.numpubs = 1;
+    unit_test_parms.numsubs = 1;
+
+    /* Create Subscriber and Declare Queue */
+    Subscriber* q = new Subscriber(unit_test_parms.qname, MsgQ::SUBSCRIBER_OF_CONFIDENCE, unit_test_parms.qdepth, MsgQ::CFG_SIZE_INFINITY);
+    if(!q->declareSPSC())
+    {
+        print2term("[%d] ERROR: unable to declare single producer/single consumer queue\n", __LINE__);
+        test_status = false;
+    }
+
+    /* Start Publisher */
+    Thread* pid = new Thread(spscThread, (void*)&unit_test_parms);
+
+    /* Receive Sequence - a second subscriber is attached for the middle third
+     * of the run to force the queue back onto the node chain and then removed
+     * to let the queue return to the ring */
+    Subscriber* other = NULL;
+    long expected = 0;
+    long data;
+    while(expected < unit_test_parms.loopcnt)
+    {
+        if(expected == unit_test_parms.loopcnt / 3)
+        {
+            other = new Subscriber(unit_test_parms.qname, MsgQ::SUBSCRIBER_OF_OPPORTUNITY);
+        }
+        else if(expected == (2 * unit_test_parms.loopcnt) / 3)
+        {
+            delete other;
+            other = NULL;
+        }
+
+        int status = q->receiveCopy((void*)&data, sizeof(long), SYS_TIMEOUT);
+        if(status == sizeof(long))
+        {
+            if(data != expected)
+            {
+                print2term("[%d] ERROR: out of sequence value %ld, expected %ld\n", __LINE__, data, expected);
+                test_status = false;
+                break;
+            }
+            expected++;
+        }
+        else
+        {
+            print2term("[%d] ERROR: receive failed at %ld with status %d\n", __LINE__, expected, status);
+            test_status = false;
+            break;
+        }
+    }
+
+    /* Join Publisher */
+    delete other;
+    delete q;
+    delete pid;
+    if(unit_test_parms.errorcnt != 0)
+    {
+        print2term("[%d] ERROR: publisher error count is %d\n", __LINE__, unit_test_parms.errorcnt);
+        test_status = false;
+    }
+
+    /* Return */
+    if(test_status) return 0;
+    else            return -1;
+}
+
 /*----------------------------------------------------------------------------
  * subscriberThread  -
  *----------------------------------------------------------------------------*/
@@ -734,6 +817,31 @@ void* UT_MsgQ::opportunityThread(void* parm)
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * spscThread  -
+ *----------------------------------------------------------------------------*/
+void* UT_MsgQ::spscThread(void* parm)
+{
+    parms_t* unit_test_parms = (parms_t*)parm;
+
+    Publisher* q = new Publisher(unit_test_parms->qname);
+
+    for(long data = 0; data < unit_test_parms->loopcnt; data++)
+    {
+        int status = q->postCopy((void*)&data, sizeof(long), SYS_TIMEOUT);
+        if(status <= 0)
+        {
+            print2term("[%d] ERROR: post failed at %ld with status %d\n", __LINE__, data, status);
+            unit_test_parms->errorcnt++;
+            break;
+        }
+    }
+
+    delete q;
+
+    return NULL;
+}
+
 /*----------------------------------------------------------------------------
  * randomDelay  -
  *----------------------------------------------------------------------------*/
@@ -97,11 +97,13 @@ class UT_MsgQ: public CommandableObject
         int subscribeUnsubscribeUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
         int performanceUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
         int subscriberOfOpporunityUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
+        int singleProducerSingleConsumerUnitTestCmd (int argc, char argv[][MAX_CMD_SIZE]);
 
         static void* subscriberThread (void* parm);
         static void* publisherThread (void* parm);
         static void* performanceThread (void* parm);
         static void* opportunityThread (void* parm);
+        static void* spscThread (void* parm);
 
         static void randomDelay(long max_milliseconds);
 };
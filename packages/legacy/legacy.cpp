@@ -246,7 +246,7 @@ void initlegacy (void)
 
     /* Register Default Handlers */
     cmdProc->registerHandler("CCSDS_PACKET_PROCESSOR",      CcsdsPacketProcessor::createObject,             2,  "<input stream> <number of workers>");
-    cmdProc->registerHandler("CCSDS_FILE_WRITER",           CcsdsFileWriter::createObject,                 -3,  "<RAW_BINARY|RAW_ASCII|TEXT> <prefix> <input stream> [<max file size>]");
+    cmdProc->registerHandler("CCSDS_FILE_WRITER",           CcsdsFileWriter::createObject,                 -3,  "<RAW_BINARY|RAW_ASCII|TEXT> <prefix> <input stream> [<max file size>] [<CACHED|ASYNC|DIRECT>]");
     cmdProc->registerHandler("CCSDS_FRAME_STRIPPER",        CcsdsFrameStripper::createObject,               5,  "<in stream> <out stream> <Sync Marker> <Leading Strip Size> <Fixed Frame Size>");
     cmdProc->registerHandler("CCSDS_RECORD_FILE_WRITER",    CcsdsRecordFileWriter::createObject,           -2,  "<prefix> <input stream> [[<max file size>] [<field name> ...]]");
     cmdProc->registerHandler("CFS_INTERFACE",               CfsInterface::createObject,                     6,  "<tlm stream> <cmd stream> <tlm ip addr> <tlm port> <cmd ip addr> <cmd port>");
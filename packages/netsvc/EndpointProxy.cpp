@@ -47,6 +47,14 @@
 
 const char* EndpointProxy::SERVICE = "sliderule";
 
+const double EndpointProxy::LATENCY_TOLERANCE = 2.0;
+const double EndpointProxy::BACKOFF_FACTOR = 0.7;
+const double EndpointProxy::LATENCY_FILTER = 0.1;
+
+Mutex EndpointProxy::nodeStatsMut;
+Dictionary<EndpointProxy::node_stats_t> EndpointProxy::nodeStats;
+Dictionary<const char*> EndpointProxy::nodeAffinity;
+
 const char* EndpointProxy::OBJECT_TYPE = "EndpointProxy";
 const char* EndpointProxy::LuaMetaName = "EndpointProxy";
 const struct luaL_Reg EndpointProxy::LuaMetaTable[] = {
@@ -58,7 +66,27 @@ const struct luaL_Reg EndpointProxy::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<endpoint>, <asset>, <resources>, <parameter string>, <timeout>, <outq_name>, <terminator>)
+ * deinit
+ *----------------------------------------------------------------------------*/
+void EndpointProxy::deinit (void)
+{
+    nodeStatsMut.lock();
+    {
+        const char* member;
+        const char* key = nodeAffinity.first(&member);
+        while(key != NULL)
+        {
+            delete [] member;
+            key = nodeAffinity.next(&member);
+        }
+        nodeAffinity.clear();
+        nodeStats.clear();
+    }
+    nodeStatsMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * luaCreate - create(<endpoint>, <asset>, <resources>, <parameter string>, <timeout>, <outq_name>, <terminator>, [<threads>], [<queue depth>], [<passthru>])
  *----------------------------------------------------------------------------*/
 int EndpointProxy::luaCreate (lua_State* L)
 {
@@ -100,15 +128,16 @@ int EndpointProxy::luaCreate (lua_State* L)
         int         _timeout_secs       = getLuaInteger(L, 4, true, EndpointProxy::DEFAULT_TIMEOUT); // get timeout in seconds
         const char* _outq_name          = getLuaString(L, 5); // get output queue
         bool        _send_terminator    = getLuaBoolean(L, 6, true, false); // get send terminator flag
-        long        _num_threads        = getLuaInteger(L, 7, true, LocalLib::nproc() * CPU_LOAD_FACTOR); // get number of proxy threads
+        long        _num_threads        = getLuaInteger(L, 7, true, MIN(LocalLib::nproc() * CPU_LOAD_FACTOR, MAX(_num_resources, 1))); // get number of proxy threads
         long        _rqst_queue_depth   = getLuaInteger(L, 8, true, DEFAULT_PROXY_QUEUE_DEPTH); // get depth of request queue for proxy threads
+        bool        _passthru           = getLuaBoolean(L, 9, true, false); // get passthru flag
 
         /* Check Parameters */
         if(_num_threads <= 0) throw RunTimeException(CRITICAL, RTE_ERROR, "Number of threads must be greater than zero");
         else if (_num_threads > MAX_PROXY_THREADS) throw RunTimeException(CRITICAL, RTE_ERROR, "Number of threads must be less than %d", MAX_PROXY_THREADS);
 
         /* Return Endpoint Proxy Object */
-        EndpointProxy* ep = new EndpointProxy(L, _endpoint, _resources, _num_resources, _parameters, _timeout_secs, _outq_name, _send_terminator, _num_threads, _rqst_queue_depth);
+        EndpointProxy* ep = new EndpointProxy(L, _endpoint, _resources, _num_resources, _parameters, _timeout_secs, _outq_name, _send_terminator, _num_threads, _rqst_queue_depth, _passthru);
         int retcnt = createLuaObject(L, ep);
         if(_resources) delete [] _resources;
         return retcnt;
@@ -132,7 +161,7 @@ int EndpointProxy::luaCreate (lua_State* L)
  *----------------------------------------------------------------------------*/
 EndpointProxy::EndpointProxy (lua_State* L, const char* _endpoint, const char** _resources, int _num_resources,
                               const char* _parameters, int _timeout_secs, const char* _outq_name, bool _send_terminator,
-                              int _num_threads, int _rqst_queue_depth):
+                              int _num_threads, int _rqst_queue_depth, bool _passthru):
     LuaObject(L, OBJECT_TYPE, LuaMetaName, LuaMetaTable)
 {
     assert(_resources);
@@ -144,6 +173,7 @@ EndpointProxy::EndpointProxy (lua_State* L, const char* _endpoint, const char**
     numProxyThreads = _num_threads;
     rqstQDepth = _rqst_queue_depth;
     sendTerminator = _send_terminator;
+    passthru = _passthru;
 
     /* Completion Condition */
     numResourcesComplete = 0;
@@ -154,6 +184,7 @@ EndpointProxy::EndpointProxy (lua_State* L, const char* _endpoint, const char**
     /* Create Proxy Threads */
     rqstPub = new Publisher(NULL, NULL, rqstQDepth);
     rqstSub = new Subscriber(*rqstPub);
+    ThreadBudget::reserve(numProxyThreads + 1); // proxy threads and collator
     proxyPids = new Thread* [numProxyThreads];
     for(int t = 0; t < numProxyThreads; t++)
     {
@@ -174,7 +205,19 @@ EndpointProxy::EndpointProxy (lua_State* L, const char* _endpoint, const char**
 
     /* Initialize Nodes Array */
     nodes = new OrchestratorLib::Node* [numResources];
-    LocalLib::set(nodes, 0, sizeof(OrchestratorLib::Node*)); // set all to NULL
+    LocalLib::set(nodes, 0, numResources * sizeof(OrchestratorLib::Node*)); // set all to NULL
+
+    /* Initialize Cached Results */
+    cached = new ProxyCache::entry_t* [numResources];
+    LocalLib::set(cached, 0, numResources * sizeof(ProxyCache::entry_t*)); // set all to NULL
+    canonicalParms = ProxyCache::enabled() ? ProxyCache::canonicalize(parameters) : NULL;
+
+    /* Initialize Dispatch Order */
+    rqstOrder = new int [numResources];
+    for(int i = 0; i < numResources; i++)
+    {
+        rqstOrder[i] = i;
+    }
 
     /* Start Collator Thread */
     collatorPid = new Thread(collatorThread, this);
@@ -186,13 +229,19 @@ EndpointProxy::EndpointProxy (lua_State* L, const char* _endpoint, const char**
 EndpointProxy::~EndpointProxy (void)
 {
     /* Join and Delete Threads */
-    active = false;
+    completion.lock();
+    {
+        active = false;
+        completion.signal(); // wakes collator
+    }
+    completion.unlock();
     for(int i = 0; i < numProxyThreads; i++)
     {
         delete proxyPids[i];
     }
     delete [] proxyPids;
     delete collatorPid;
+    ThreadBudget::release(numProxyThreads + 1);
 
     /* Delete Queues */
     delete rqstPub;
@@ -212,6 +261,15 @@ EndpointProxy::~EndpointProxy (void)
         if(nodes[i]) delete nodes[i];
     }
     delete [] nodes;
+    delete [] rqstOrder;
+
+    /* Release Cached Results Never Served */
+    for(int i = 0; i < numResources; i++)
+    {
+        if(cached[i]) ProxyCache::release(cached[i]);
+    }
+    delete [] cached;
+    delete [] canonicalParms;
 
     /* Delete Allocated Memory */
     delete [] endpoint;
@@ -224,7 +282,7 @@ EndpointProxy::~EndpointProxy (void)
 void* EndpointProxy::collatorThread (void* parm)
 {
     EndpointProxy* proxy = (EndpointProxy*)parm;
-    int current_resource = 0;
+    int current_resource = proxy->dispatchCached();
 
     while(proxy->active && (proxy->outQ->getSubCnt() > 0) && (current_resource < proxy->numResources))
     {
@@ -234,29 +292,34 @@ void* EndpointProxy::collatorThread (void* parm)
         OrchestratorLib::NodeList* nodes = OrchestratorLib::lock(SERVICE, num_nodes_to_request, proxy->timeout);
         if(nodes)
         {
+            int nodes_used = 0;
             for(int i = 0; i < nodes->length(); i++)
             {
-                /* Populate Request */
-                proxy->nodes[current_resource] = nodes->get(i);
+                OrchestratorLib::Node* node = nodes->get(i);
 
-                /* Post Request to Proxy Threads */
-                int status = MsgQ::STATE_TIMEOUT;
-                while(proxy->active && (status == MsgQ::STATE_TIMEOUT))
+                /* Give Back Nodes Already at Their Concurrency Limit */
+                if(!admitNode(node->member))
                 {
-                    status = proxy->rqstPub->postCopy(&current_resource, sizeof(current_resource), SYS_TIMEOUT);
-                    if(status < 0)
-                    {
-                        LuaEndpoint::generateExceptionStatus(RTE_ERROR, ERROR, proxy->outQ, NULL, "Failed (%d) to post request for %s", status, proxy->resources[current_resource]);
-                        break;
-                    }
+                    OrchestratorLib::unlock(&node->transaction, 1);
+                    delete node;
+                    continue;
                 }
 
+                /* Populate Request (preferring a resource the node processed before) */
+                proxy->assignResource(current_resource, node->member);
+                int resource = proxy->rqstOrder[current_resource];
+                proxy->nodes[resource] = node;
+                nodes_used++;
+
+                /* Post Request to Proxy Threads */
+                proxy->dispatchResource(resource);
+
                 /* Bump Current Resource */
                 current_resource++;
             }
 
             /*  If No Nodes Available */
-            if(nodes->length() <= 0)
+            if(nodes_used <= 0)
             {
                 LocalLib::sleep(0.20); // 5Hz
             }
@@ -276,7 +339,7 @@ void* EndpointProxy::collatorThread (void* parm)
     {
         while(proxy->active && (proxy->numResourcesComplete < proxy->numResources))
         {
-            proxy->completion.wait(0, SYS_TIMEOUT);
+            proxy->completion.wait(0, IO_PEND);
         }
     }
     proxy->completion.unlock();
@@ -307,22 +370,42 @@ void* EndpointProxy::proxyThread (void* parm)
         int recv_status = proxy->rqstSub->receiveCopy(&current_resource, sizeof(current_resource), SYS_TIMEOUT);
         if(recv_status > 0)
         {
-            /* Get Resource and Node */
+            /* Get Resource, Node, and Cached Result */
             const char* resource = proxy->resources[current_resource];
-            OrchestratorLib::Node* node = proxy->nodes[current_resource];
+            OrchestratorLib::Node* node = proxy->nodes[current_resource]; // NULL if served from the cache
+            ProxyCache::entry_t* entry = proxy->cached[current_resource];
+            bool owner = false; // set when this request records the result
             bool valid = false; // set to true on success
+            double latency = -1.0; // set when request is made
 
             /* Make Request */
             if(proxy->outQ->getSubCnt() > 0)
             {
                 try
                 {
-                    SafeString path("/source/%s", proxy->endpoint);
-                    SafeString data("{\"resource\": \"%s\", \"parms\": %s, \"timeout\": %d}", resource, proxy->parameters, proxy->timeout);
-                    HttpClient client(NULL, node->member);
-                    HttpClient::rsps_t rsps = client.request(EndpointObject::POST, path.getString(), data.getString(), false, proxy->outQ, proxy->timeout * 1000);
-                    if(rsps.code == EndpointObject::OK) valid = true;
-                    else throw RunTimeException(CRITICAL, RTE_ERROR, "Error code returned from request to %s: %d", node->member, (int)rsps.code);
+                    /* Join or Claim Result of Identical Request */
+                    if(!entry && proxy->canonicalParms)
+                    {
+                        char key[ProxyCache::KEY_SIZE];
+                        ProxyCache::makeKey(key, proxy->endpoint, resource, proxy->canonicalParms);
+                        entry = ProxyCache::claim(key, &owner);
+                    }
+
+                    if(entry && !owner)
+                    {
+                        /* Replay Result */
+                        valid = ProxyCache::replay(entry, proxy->outQ, &proxy->active);
+                        if(!valid) throw RunTimeException(CRITICAL, RTE_ERROR, "Identical request failed for %s", resource);
+                    }
+                    else
+                    {
+                        /* Request Resource From Node */
+                        double start = TimeLib::latchtime();
+                        HttpClient::rsps_t rsps = proxy->requestResource(node, resource, entry);
+                        latency = TimeLib::latchtime() - start;
+                        if(rsps.code == EndpointObject::OK) valid = true;
+                        else throw RunTimeException(CRITICAL, RTE_ERROR, "Error code returned from request to %s: %d", node->member, (int)rsps.code);
+                    }
                 }
                 catch(const RunTimeException& e)
                 {
@@ -330,8 +413,20 @@ void* EndpointProxy::proxyThread (void* parm)
                 }
             }
 
-            /* Unlock Node */
-            OrchestratorLib::unlock(&node->transaction, 1);
+            /* Finish With Cached Result */
+            if(entry)
+            {
+                if(owner) ProxyCache::finish(entry, valid);
+                ProxyCache::release(entry);
+                proxy->cached[current_resource] = NULL;
+            }
+
+            /* Update Node Concurrency and Unlock Node */
+            if(node)
+            {
+                updateNode(node->member, resource, valid, latency);
+                OrchestratorLib::unlock(&node->transaction, 1);
+            }
 
             /* Resource Completed */
             proxy->completion.lock();
@@ -360,3 +455,306 @@ void* EndpointProxy::proxyThread (void* parm)
 
     return NULL;
 }
+
+/*----------------------------------------------------------------------------
+ * fetchThread
+ *
+ *  makes the request into a private queue for the proxy thread recording
+ *  it, and ends the queue with an empty message
+ *----------------------------------------------------------------------------*/
+void* EndpointProxy::fetchThread (void* parm)
+{
+    fetch_t* fetch = (fetch_t*)parm;
+
+    fetch->rsps = fetch->client->request(EndpointObject::POST, fetch->path, fetch->data, true, fetch->capture, fetch->timeout, fetch->passthru);
+
+    int status = MsgQ::STATE_TIMEOUT;
+    while(status == MsgQ::STATE_TIMEOUT)
+    {
+        status = fetch->capture->postCopy("", 0, SYS_TIMEOUT);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * requestResource
+ *
+ *  streams the node's response to the output queue; when the result is
+ *  being recorded for identical requests, the response is read by a fetch
+ *  thread and every message is recorded as it is relayed
+ *----------------------------------------------------------------------------*/
+HttpClient::rsps_t EndpointProxy::requestResource (OrchestratorLib::Node* node, const char* resource, ProxyCache::entry_t* entry)
+{
+    SafeString path("/source/%s", endpoint);
+    SafeString data("{\"resource\": \"%s\", \"parms\": %s, \"timeout\": %d}", resource, parameters, timeout);
+    HttpClient* client = HttpClient::acquire(node->member); // keep-alive connection reused across resources
+    HttpClient::rsps_t rsps;
+
+    if(!entry)
+    {
+        rsps = client->request(EndpointObject::POST, path.getString(), data.getString(), true, outQ, timeout * 1000, passthru);
+    }
+    else
+    {
+        Publisher capture(NULL, Publisher::defaultFree);
+        Subscriber relay(capture);
+        fetch_t fetch = {
+            .client = client,
+            .path = path.getString(),
+            .data = data.getString(),
+            .capture = &capture,
+            .timeout = timeout * 1000,
+            .passthru = passthru,
+            .rsps = {
+                .code = EndpointObject::Service_Unavailable,
+                .response = NULL,
+                .size = 0
+            }
+        };
+        Thread* fetcher = new Thread(fetchThread, &fetch);
+
+        /* Relay Until Empty Message - drained even when inactive so the fetch thread can finish */
+        bool relaying = true;
+        while(relaying)
+        {
+            Subscriber::msgRef_t ref;
+            int recv_status = relay.receiveRef(ref, SYS_TIMEOUT);
+            if(recv_status > 0)
+            {
+                if(ref.size > 0)
+                {
+                    ProxyCache::record(entry, ref.data, ref.size);
+                    int post_status = MsgQ::STATE_TIMEOUT;
+                    while(active && post_status == MsgQ::STATE_TIMEOUT)
+                    {
+                        post_status = outQ->postCopy(ref.data, ref.size, SYS_TIMEOUT);
+                    }
+                }
+                else
+                {
+                    relaying = false;
+                }
+                relay.dereference(ref);
+            }
+            else if(recv_status != MsgQ::STATE_TIMEOUT)
+            {
+                mlog(CRITICAL, "Failed (%d) to relay response for %s", recv_status, resource);
+                relaying = false;
+            }
+        }
+
+        delete fetcher;
+        rsps = fetch.rsps;
+    }
+
+    HttpClient::release(client);
+    return rsps;
+}
+
+/*----------------------------------------------------------------------------
+ * dispatchResource
+ *
+ *  posts the resource to the proxy threads
+ *----------------------------------------------------------------------------*/
+bool EndpointProxy::dispatchResource (int resource)
+{
+    int status = MsgQ::STATE_TIMEOUT;
+    while(active && (status == MsgQ::STATE_TIMEOUT))
+    {
+        status = rqstPub->postCopy(&resource, sizeof(resource), SYS_TIMEOUT);
+        if(status < 0)
+        {
+            LuaEndpoint::generateExceptionStatus(RTE_ERROR, ERROR, outQ, NULL, "Failed (%d) to post request for %s", status, resources[resource]);
+            break;
+        }
+    }
+    return status > 0;
+}
+
+/*----------------------------------------------------------------------------
+ * dispatchCached
+ *
+ *  joins the results of identical requests that are cached or in flight,
+ *  moves those resources to the front of the dispatch order, and posts
+ *  them without a node; returns the number dispatched
+ *----------------------------------------------------------------------------*/
+int EndpointProxy::dispatchCached (void)
+{
+    int num_cached = 0;
+
+    if(canonicalParms)
+    {
+        for(int p = 0; p < numResources; p++)
+        {
+            int resource = rqstOrder[p];
+            char key[ProxyCache::KEY_SIZE];
+            ProxyCache::makeKey(key, endpoint, resources[resource], canonicalParms);
+            cached[resource] = ProxyCache::lookup(key);
+            if(cached[resource])
+            {
+                rqstOrder[p] = rqstOrder[num_cached];
+                rqstOrder[num_cached] = resource;
+                num_cached++;
+            }
+        }
+
+        for(int p = 0; p < num_cached; p++)
+        {
+            dispatchResource(rqstOrder[p]);
+        }
+    }
+
+    return num_cached;
+}
+
+/*----------------------------------------------------------------------------
+ * admitNode
+ *
+ *  reserves an in-flight request slot on the node if it is under its limit
+ *----------------------------------------------------------------------------*/
+bool EndpointProxy::admitNode (const char* member)
+{
+    bool admitted = false;
+
+    nodeStatsMut.lock();
+    {
+        node_stats_t stats;
+        if(!nodeStats.find(member, &stats))
+        {
+            stats.limit = INITIAL_NODE_CONCURRENCY;
+            stats.inflight = 0;
+            stats.latency = 0.0;
+            stats.successes = 0;
+            stats.failures = 0;
+        }
+
+        if(stats.inflight < MAX((int)stats.limit, 1))
+        {
+            stats.inflight++;
+            admitted = true;
+        }
+
+        nodeStats.add(member, stats);
+    }
+    nodeStatsMut.unlock();
+
+    return admitted;
+}
+
+/*----------------------------------------------------------------------------
+ * updateNode
+ *
+ *  releases the in-flight slot reserved by admitNode and adjusts the node's
+ *  limit: additive increase on a timely success, multiplicative decrease on a
+ *  failure or a response much slower than the node's typical response; a
+ *  negative latency means the request was never made
+ *----------------------------------------------------------------------------*/
+void EndpointProxy::updateNode (const char* member, const char* resource, bool success, double latency)
+{
+    nodeStatsMut.lock();
+    {
+        node_stats_t stats;
+        if(nodeStats.find(member, &stats))
+        {
+            if(stats.inflight > 0) stats.inflight--;
+
+            if(latency >= 0.0)
+            {
+                bool congested = !success || (stats.successes > 0 && latency > (stats.latency * LATENCY_TOLERANCE));
+                if(congested)
+                {
+                    stats.limit = MAX(stats.limit * BACKOFF_FACTOR, 1.0);
+                }
+                else
+                {
+                    stats.limit = MIN(stats.limit + (1.0 / stats.limit), (double)MAX_NODE_CONCURRENCY);
+                }
+
+                if(success)
+                {
+                    if(stats.successes == 0)    stats.latency = latency;
+                    else                        stats.latency += (latency - stats.latency) * LATENCY_FILTER;
+                    stats.successes++;
+                }
+                else
+                {
+                    stats.failures++;
+                }
+            }
+
+            nodeStats.add(member, stats);
+        }
+
+        /* Remember Node That Processed Resource (it now has the granule cached) */
+        if(success && latency >= 0.0 && resource)
+        {
+            const char* prev_member;
+            if(nodeAffinity.find(resource, &prev_member))
+            {
+                delete [] prev_member;
+            }
+            else if(nodeAffinity.length() >= MAX_AFFINITY_ENTRIES)
+            {
+                const char* old_member;
+                const char* key = nodeAffinity.first(&old_member);
+                while(key != NULL)
+                {
+                    delete [] old_member;
+                    key = nodeAffinity.next(&old_member);
+                }
+                nodeAffinity.clear();
+            }
+            const char* affinity_member = StringLib::duplicate(member);
+            nodeAffinity.add(resource, affinity_member);
+        }
+    }
+    nodeStatsMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * preferredNode
+ *
+ *  returns a copy of the node that last processed the resource, or NULL
+ *----------------------------------------------------------------------------*/
+const char* EndpointProxy::preferredNode (int resource)
+{
+    const char* preferred = NULL;
+
+    nodeStatsMut.lock();
+    {
+        const char* member;
+        if(nodeAffinity.find(resources[resource], &member))
+        {
+            preferred = StringLib::duplicate(member);
+        }
+    }
+    nodeStatsMut.unlock();
+
+    return preferred;
+}
+
+/*----------------------------------------------------------------------------
+ * assignResource
+ *
+ *  moves a pending resource that the node processed before into the given
+ *  dispatch position, searching a limited window of pending resources; the
+ *  order is left unchanged if none is found
+ *----------------------------------------------------------------------------*/
+void EndpointProxy::assignResource (int position, const char* member)
+{
+    int window_end = MIN(position + AFFINITY_WINDOW, numResources);
+    for(int p = position; p < window_end; p++)
+    {
+        const char* preferred = preferredNode(rqstOrder[p]);
+        bool match = preferred && StringLib::match(preferred, member);
+        if(preferred) delete [] preferred;
+        if(match)
+        {
+            int resource = rqstOrder[p];
+            rqstOrder[p] = rqstOrder[position];
+            rqstOrder[position] = resource;
+            break;
+        }
+    }
+}
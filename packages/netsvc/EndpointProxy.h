@@ -40,6 +40,8 @@
 #include "MsgQ.h"
 #include "OsApi.h"
 #include "OrchestratorLib.h"
+#include "ProxyCache.h"
+#include "HttpClient.h"
 
 /******************************************************************************
  * ATL03 READER
@@ -59,6 +61,14 @@ class EndpointProxy: public LuaObject
         static const int DEFAULT_PROXY_QUEUE_DEPTH = 1000;
         static const int MAX_PROXY_THREADS = 1000;
         static const int DEFAULT_TIMEOUT = 600; // seconds
+        static const int INITIAL_NODE_CONCURRENCY = 4; // in-flight requests allowed to a node before anything is learned about it
+        static const int MAX_NODE_CONCURRENCY = 64;
+        static const int AFFINITY_WINDOW = 64; // pending resources searched for one last served by a node
+        static const int MAX_AFFINITY_ENTRIES = 0x10000;
+
+        static const double LATENCY_TOLERANCE; // multiple of a node's typical latency treated as congestion
+        static const double BACKOFF_FACTOR; // applied to a node's limit on congestion
+        static const double LATENCY_FILTER; // weight of each new sample in a node's typical latency
 
         static const char* SERVICE;
 
@@ -70,14 +80,43 @@ class EndpointProxy: public LuaObject
          * Methods
          *--------------------------------------------------------------------*/
 
+        static void deinit (void);
         static int luaCreate (lua_State* L);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Concurrency Control For Worker Node (AIMD) */
+        typedef struct {
+            double              limit;          // allowed in-flight requests
+            int                 inflight;       // requests currently in flight
+            double              latency;        // filtered response time of successful requests (seconds)
+            long                successes;
+            long                failures;
+        } node_stats_t;
+
+        /* Request Made on Behalf of a Proxy Thread Recording It */
+        typedef struct {
+            HttpClient*         client;
+            const char*         path;
+            const char*         data;
+            Publisher*          capture;
+            int                 timeout;        // milliseconds
+            bool                passthru;
+            HttpClient::rsps_t  rsps;
+        } fetch_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
+        static Mutex                        nodeStatsMut;
+        static Dictionary<node_stats_t>     nodeStats;      // by node, shared by all proxies in the process
+        static Dictionary<const char*>      nodeAffinity;   // resource to node that last processed it
+
         bool                    active;
         Publisher*              rqstPub;
         Subscriber*             rqstSub;
@@ -85,6 +124,9 @@ class EndpointProxy: public LuaObject
         Thread*                 collatorPid;
         const char**            resources;
         OrchestratorLib::Node** nodes;
+        ProxyCache::entry_t**   cached;         // results joined before dispatch, served without a node
+        char*                   canonicalParms; // parameters as keyed in the cache, NULL if not cached
+        int*                    rqstOrder;      // resources in the order they are dispatched
         int                     numResources;
         int                     numResourcesComplete;
         Cond                    completion;
@@ -96,6 +138,7 @@ class EndpointProxy: public LuaObject
         int                     numProxyThreads;
         int                     rqstQDepth;
         bool                    sendTerminator;
+        bool                    passthru;       // relay node responses without decompressing them
 
         /*--------------------------------------------------------------------
          * Methods
@@ -103,11 +146,21 @@ class EndpointProxy: public LuaObject
 
                             EndpointProxy           (lua_State* L, const char* _endpoint, const char** _resources, int _num_resources,
                                                      const char* _parameters, int _timeout_secs, const char* _outq_name, bool _send_terminator,
-                                                     int _num_threads, int _rqst_queue_depth);
+                                                     int _num_threads, int _rqst_queue_depth, bool _passthru);
                             ~EndpointProxy          (void);
 
         static void*        collatorThread          (void* parm);
         static void*        proxyThread             (void* parm);
+        static void*        fetchThread             (void* parm);
+
+        HttpClient::rsps_t  requestResource         (OrchestratorLib::Node* node, const char* resource, ProxyCache::entry_t* entry);
+        bool                dispatchResource        (int resource);
+        int                 dispatchCached          (void);
+
+        static bool         admitNode               (const char* member);
+        static void         updateNode              (const char* member, const char* resource, bool success, double latency);
+        const char*         preferredNode           (int resource);
+        void                assignResource          (int position, const char* member);
 };
 
 #endif  /* __endpoint_proxy__ */
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "core.h"
+#include "JsonLib.h"
+
+#include <math.h>
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/error/en.h>
+
+/******************************************************************************
+ * TYPEDEFS
+ ******************************************************************************/
+
+typedef rapidjson::Writer<rapidjson::StringBuffer> json_writer_t;
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * encodeValue
+ *
+ *  follows the rules of scripts/extensions/json.lua: a table is an array if
+ *  it is empty or has a first element, and must then have only integer keys
+ *  with no holes; otherwise it is an object and must have only string keys.
+ *  Returns an error message or NULL on success; errors are not raised here
+ *  so that the writer is cleaned up before control returns to Lua.
+ *----------------------------------------------------------------------------*/
+static const char* encodeValue (lua_State* L, int index, json_writer_t& writer, int depth)
+{
+    if(depth > JsonLib::MAX_DEPTH) return "circular reference or nesting too deep";
+
+    switch(lua_type(L, index))
+    {
+        case LUA_TNIL:
+        {
+            writer.Null();
+            return NULL;
+        }
+
+        case LUA_TBOOLEAN:
+        {
+            writer.Bool(lua_toboolean(L, index));
+            return NULL;
+        }
+
+        case LUA_TNUMBER:
+        {
+            if(lua_isinteger(L, index))
+            {
+                writer.Int64(lua_tointeger(L, index));
+                return NULL;
+            }
+            double val = lua_tonumber(L, index);
+            if(isnan(val) || isinf(val)) return "unexpected number value";
+            writer.Double(val);
+            return NULL;
+        }
+
+        case LUA_TSTRING:
+        {
+            size_t len;
+            const char* str = lua_tolstring(L, index, &len);
+            writer.String(str, (rapidjson::SizeType)len);
+            return NULL;
+        }
+
+        case LUA_TTABLE:
+        {
+            if(!lua_checkstack(L, 3)) return "out of stack space";
+            index = lua_absindex(L, index);
+
+            /* Determine Array or Object */
+            bool is_array = (lua_rawgeti(L, index, 1) != LUA_TNIL);
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            if(lua_next(L, index) == 0)     is_array = true; // empty table
+            else                            lua_pop(L, 2);
+
+            if(is_array)
+            {
+                /* Check Keys */
+                lua_Integer n = 0;
+                lua_pushnil(L);
+                while(lua_next(L, index) != 0)
+                {
+                    bool valid = (lua_type(L, -2) == LUA_TNUMBER);
+                    lua_pop(L, 1);
+                    if(!valid)
+                    {
+                        lua_pop(L, 1);
+                        return "invalid table: mixed or invalid key types";
+                    }
+                    n++;
+                }
+                if(n != (lua_Integer)lua_rawlen(L, index)) return "invalid table: sparse array";
+
+                /* Encode Elements */
+                writer.StartArray();
+                for(lua_Integer i = 1; i <= n; i++)
+                {
+                    lua_rawgeti(L, index, i);
+                    const char* errmsg = encodeValue(L, -1, writer, depth + 1);
+                    lua_pop(L, 1);
+                    if(errmsg) return errmsg;
+                }
+                writer.EndArray();
+            }
+            else
+            {
+                /* Encode Members */
+                writer.StartObject();
+                lua_pushnil(L);
+                while(lua_next(L, index) != 0)
+                {
+                    if(lua_type(L, -2) != LUA_TSTRING)
+                    {
+                        lua_pop(L, 2);
+                        return "invalid table: mixed or invalid key types";
+                    }
+                    size_t len;
+                    const char* key = lua_tolstring(L, -2, &len);
+                    writer.Key(key, (rapidjson::SizeType)len);
+                    const char* errmsg = encodeValue(L, -1, writer, depth + 1);
+                    lua_pop(L, 1);
+                    if(errmsg)
+                    {
+                        lua_pop(L, 1);
+                        return errmsg;
+                    }
+                }
+                writer.EndObject();
+            }
+
+            return NULL;
+        }
+
+        default:
+        {
+            return "unexpected type";
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * decodeValue
+ *
+ *  pushes the value onto the Lua stack; nulls become nil, so null members
+ *  are left out of objects and null elements leave holes in arrays
+ *----------------------------------------------------------------------------*/
+static const char* decodeValue (lua_State* L, const rapidjson::Value& value, int depth)
+{
+    if(depth > JsonLib::MAX_DEPTH) return "nesting too deep";
+    if(!lua_checkstack(L, 3)) return "out of stack space";
+
+    if(value.IsNull())
+    {
+        lua_pushnil(L);
+    }
+    else if(value.IsBool())
+    {
+        lua_pushboolean(L, value.GetBool());
+    }
+    else if(value.IsNumber())
+    {
+        if(value.IsInt64()) lua_pushinteger(L, value.GetInt64());
+        else                lua_pushnumber(L, value.GetDouble());
+    }
+    else if(value.IsString())
+    {
+        lua_pushlstring(L, value.GetString(), value.GetStringLength());
+    }
+    else if(value.IsArray())
+    {
+        lua_createtable(L, value.Size(), 0);
+        lua_Integer i = 1;
+        for(rapidjson::Value::ConstValueIterator itr = value.Begin(); itr != value.End(); ++itr)
+        {
+            const char* errmsg = decodeValue(L, *itr, depth + 1);
+            if(errmsg) return errmsg;
+            lua_rawseti(L, -2, i++);
+        }
+    }
+    else if(value.IsObject())
+    {
+        lua_createtable(L, 0, value.MemberCount());
+        for(rapidjson::Value::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr)
+        {
+            lua_pushlstring(L, itr->name.GetString(), itr->name.GetStringLength());
+            const char* errmsg = decodeValue(L, itr->value, depth + 1);
+            if(errmsg) return errmsg;
+            lua_rawset(L, -3);
+        }
+    }
+    else
+    {
+        lua_pushnil(L);
+    }
+
+    return NULL;
+}
+
+/******************************************************************************
+ * JSON LIBRARY CLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * luaEncode - jsonencode(<value>) --> json string
+ *----------------------------------------------------------------------------*/
+int JsonLib::luaEncode (lua_State* L)
+{
+    const char* errmsg = NULL;
+
+    {
+        rapidjson::StringBuffer buffer;
+        json_writer_t writer(buffer);
+        errmsg = encodeValue(L, 1, writer, 0);
+        if(!errmsg) lua_pushlstring(L, buffer.GetString(), buffer.GetSize());
+    }
+
+    if(errmsg) return luaL_error(L, "%s", errmsg);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * luaDecode - jsondecode(<json string>) --> value
+ *----------------------------------------------------------------------------*/
+int JsonLib::luaDecode (lua_State* L)
+{
+    if(lua_type(L, 1) != LUA_TSTRING)
+    {
+        return luaL_error(L, "expected argument of type string, got %s", luaL_typename(L, 1));
+    }
+
+    size_t len;
+    const char* str = lua_tolstring(L, 1, &len);
+    int top = lua_gettop(L);
+    char errmsg[MAX_STR_SIZE];
+    errmsg[0] = '\0';
+
+    {
+        rapidjson::Document json;
+        json.Parse<rapidjson::kParseIterativeFlag | rapidjson::kParseFullPrecisionFlag>(str, len);
+        if(json.HasParseError())
+        {
+            StringLib::format(errmsg, MAX_STR_SIZE, "%s at character %ld", rapidjson::GetParseError_En(json.GetParseError()), (long)json.GetErrorOffset() + 1);
+        }
+        else
+        {
+            const char* decode_errmsg = decodeValue(L, json, 0);
+            if(decode_errmsg) StringLib::format(errmsg, MAX_STR_SIZE, "%s", decode_errmsg);
+        }
+    }
+
+    if(errmsg[0] != '\0')
+    {
+        lua_settop(L, top);
+        return luaL_error(L, "%s", errmsg);
+    }
+
+    return 1;
+}
@@ -38,6 +38,7 @@
 #include "core.h"
 
 #include <rapidjson/document.h>
+#include <stdlib.h>
 
 /******************************************************************************
  * ORCHESTRATOR LIBRARY CLASS
@@ -48,6 +49,8 @@
  *----------------------------------------------------------------------------*/
 
 const char* OrchestratorLib::URL = NULL;
+int64_t OrchestratorLib::lastCacheHits = 0;
+int64_t OrchestratorLib::lastCacheMisses = 0;
 
 /*----------------------------------------------------------------------------
  * init
@@ -72,8 +75,11 @@ bool OrchestratorLib::registerService (const char* service, int lifetime, const
 {
     bool status = true;
 
+    load_t load;
+    getLoad(&load);
+
     HttpClient orchestrator(NULL, URL);
-    SafeString rqst("{\"service\":\"%s\", \"lifetime\": %d, \"address\": \"%s\"}", service, lifetime, address);
+    SafeString rqst("{\"service\":\"%s\", \"lifetime\": %d, \"address\": \"%s\", \"load\": {\"cpu\": %.3lf, \"queue_bytes\": %ld, \"cache_hit\": %.3lf}}", service, lifetime, address, load.cpu, (long)load.queue_bytes, load.cache_hit);
 
     HttpClient::rsps_t rsps = orchestrator.request(EndpointObject::POST, "/discovery/register", rqst.getString(), false, NULL);
     if(rsps.code == EndpointObject::OK)
@@ -112,14 +118,43 @@ bool OrchestratorLib::registerService (const char* service, int lifetime, const
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * getLoad
+ *
+ *  the cache hit fraction covers the reads made since the previous call,
+ *  as reported by request accounts when their requests complete
+ *----------------------------------------------------------------------------*/
+void OrchestratorLib::getLoad (load_t* load)
+{
+    /* CPU */
+    double loadavg[1];
+    long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(getloadavg(loadavg, 1) == 1 && num_cores > 0) load->cpu = loadavg[0] / num_cores;
+    else load->cpu = 0.0;
+
+    /* Queued Data */
+    load->queue_bytes = MsgQ::totalBytes();
+
+    /* Cache Hits */
+    int64_t totals[2] = {0, 0}; // hits, misses
+    EventLib::iterateMetric(RequestAccount::METRIC_CATEGORY, cacheMetric, totals);
+    int64_t hits = totals[0] - lastCacheHits;
+    int64_t misses = totals[1] - lastCacheMisses;
+    lastCacheHits = totals[0];
+    lastCacheMisses = totals[1];
+    load->cache_hit = (hits + misses > 0) ? ((double)hits / (double)(hits + misses)) : -1.0;
+}
+
 /*----------------------------------------------------------------------------
  * lock
  *----------------------------------------------------------------------------*/
-OrchestratorLib::NodeList* OrchestratorLib::lock (const char* service, int nodes_needed, int timeout_secs, bool verbose)
+OrchestratorLib::NodeList* OrchestratorLib::lock (const char* service, int nodes_needed, int timeout_secs, bool verbose, const char* resource)
 {
     NodeList* nodes = NULL;
     HttpClient orchestrator(NULL, URL);
-    SafeString rqst("{\"service\":\"%s\", \"nodesNeeded\": %d, \"timeout\": %d}", service, nodes_needed, timeout_secs);
+    SafeString rqst("{\"service\":\"%s\", \"nodesNeeded\": %d, \"timeout\": %d", service, nodes_needed, timeout_secs);
+    if(resource) rqst += SafeString(", \"resource\":\"%s\"", resource);
+    rqst += "}";
 
     HttpClient::rsps_t rsps = orchestrator.request(EndpointObject::POST, "/discovery/lock", rqst.getString(), false, NULL);
     if(rsps.code == EndpointObject::OK)
@@ -257,6 +292,23 @@ bool OrchestratorLib::health (void)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * cacheMetric
+ *----------------------------------------------------------------------------*/
+void OrchestratorLib::cacheMetric (const EventLib::metric_t& metric, int32_t index, void* parm)
+{
+    (void)index;
+    int64_t* totals = (int64_t*)parm;
+    if(StringLib::match(metric.name, RequestAccount::COUNTER_NAMES[RequestAccount::CACHE_HITS]))
+    {
+        totals[0] = (int64_t)metric.value;
+    }
+    else if(StringLib::match(metric.name, RequestAccount::COUNTER_NAMES[RequestAccount::CACHE_MISSES]))
+    {
+        totals[1] = (int64_t)metric.value;
+    }
+}
+
 /*----------------------------------------------------------------------------
  * luaUrl - orchurl(<URL>)
  *----------------------------------------------------------------------------*/
@@ -317,8 +369,9 @@ int OrchestratorLib::luaLock(lua_State* L)
         int nodes_needed    = LuaObject::getLuaInteger(L, 2);
         int timeout_secs    = LuaObject::getLuaInteger(L, 3);
         bool verbose        = LuaObject::getLuaBoolean(L, 4, true, false);
+        const char* resource = LuaObject::getLuaString(L, 5, true, NULL);
 
-        nodes = lock(service, nodes_needed, timeout_secs, verbose);
+        nodes = lock(service, nodes_needed, timeout_secs, verbose, resource);
 
         lua_newtable(L);
         for(int i = 0; i < nodes->length(); i++)
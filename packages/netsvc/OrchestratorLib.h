@@ -67,6 +67,13 @@ class OrchestratorLib
 
         typedef List<Node*> NodeList;
 
+        /* Load Reported with Registration */
+        typedef struct {
+            double  cpu;            // one minute load average per core
+            int64_t queue_bytes;    // data held on message queues
+            double  cache_hit;      // fraction of h5 reads served from a cache since last report, -1 if none
+        } load_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -75,9 +82,10 @@ class OrchestratorLib
         static void         deinit              (void);
 
         static bool         registerService     (const char* service, int lifetime, const char* address, bool verbose=false);
-        static NodeList*    lock                (const char* service, int nodes_needed, int timeout_secs, bool verbose=false);
+        static NodeList*    lock                (const char* service, int nodes_needed, int timeout_secs, bool verbose=false, const char* resource=NULL);
         static bool         unlock              (long transactions[], int num_transactions, bool verbose=false);
         static bool         health              (void);
+        static void         getLoad             (load_t* load);
 
         static int          luaUrl              (lua_State* L);
         static int          luaRegisterService  (lua_State* L);
@@ -90,6 +98,13 @@ class OrchestratorLib
          *--------------------------------------------------------------------*/
 
         static const char* URL;
+
+    private:
+
+        static int64_t      lastCacheHits;
+        static int64_t      lastCacheMisses;
+
+        static void         cacheMetric         (const EventLib::metric_t& metric, int32_t index, void* parm);
 };
 
 #endif  /* __orchestrator_lib__ */
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "core.h"
+#include "ProxyCache.h"
+#include "EndpointProxy.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * canonicalize
+ *
+ *  writes the value with object members sorted by name and no whitespace
+ *----------------------------------------------------------------------------*/
+static void canonicalize (const rapidjson::Value& value, rapidjson::Writer<rapidjson::StringBuffer>& writer)
+{
+    if(value.IsObject())
+    {
+        /* Sort Members by Name */
+        int num_members = value.MemberCount();
+        const rapidjson::Value::Member** members = new const rapidjson::Value::Member* [num_members + 1];
+        int i = 0;
+        for(rapidjson::Value::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr)
+        {
+            const rapidjson::Value::Member* member = &(*itr);
+            int j = i++;
+            while(j > 0 && strcmp(members[j-1]->name.GetString(), member->name.GetString()) > 0)
+            {
+                members[j] = members[j-1];
+                j--;
+            }
+            members[j] = member;
+        }
+
+        /* Write Members */
+        writer.StartObject();
+        for(i = 0; i < num_members; i++)
+        {
+            writer.Key(members[i]->name.GetString(), members[i]->name.GetStringLength());
+            canonicalize(members[i]->value, writer);
+        }
+        writer.EndObject();
+
+        delete [] members;
+    }
+    else if(value.IsArray())
+    {
+        writer.StartArray();
+        for(rapidjson::Value::ConstValueIterator itr = value.Begin(); itr != value.End(); ++itr)
+        {
+            canonicalize(*itr, writer);
+        }
+        writer.EndArray();
+    }
+    else
+    {
+        value.Accept(writer);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * fnv1a - 64-bit hash continued from the previous field
+ *----------------------------------------------------------------------------*/
+static uint64_t fnv1a (uint64_t hash, const char* str, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)str[i];
+        hash *= 0x100000001B3ULL;
+    }
+    hash *= 0x100000001B3ULL; // hashes a null byte to separate consecutive fields
+    return hash;
+}
+
+/******************************************************************************
+ * PROXY CACHE CLASS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Static Data
+ *----------------------------------------------------------------------------*/
+
+Cond ProxyCache::cacheCond(1, "proxy.cache");
+Dictionary<ProxyCache::entry_t*> ProxyCache::entries;
+long ProxyCache::maxBytes = 0; // disabled until configured
+long ProxyCache::cachedBytes = 0;
+long ProxyCache::useCount = 0;
+long ProxyCache::hits = 0;
+long ProxyCache::misses = 0;
+long ProxyCache::coalesced = 0;
+
+/*----------------------------------------------------------------------------
+ * deinit
+ *----------------------------------------------------------------------------*/
+void ProxyCache::deinit (void)
+{
+    cacheCond.lock();
+    {
+        entry_t* entry;
+        const char* key = entries.first(&entry);
+        while(key != NULL)
+        {
+            destroy(entry);
+            key = entries.next(&entry);
+        }
+        entries.clear();
+        cachedBytes = 0;
+    }
+    cacheCond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * luaCache - cache([<max bytes>])
+ *
+ *  sets the size of the cache when supplied, zero disables it; returns the
+ *  state of the cache
+ *----------------------------------------------------------------------------*/
+int ProxyCache::luaCache (lua_State* L)
+{
+    try
+    {
+        long max_bytes = LuaObject::getLuaInteger(L, 1, true, -1);
+
+        cacheCond.lock();
+        {
+            if(max_bytes >= 0)
+            {
+                maxBytes = max_bytes;
+                evict(0);
+            }
+
+            lua_newtable(L);
+            LuaEngine::setAttrNum(L, "max", maxBytes);
+            LuaEngine::setAttrNum(L, "bytes", cachedBytes);
+            LuaEngine::setAttrInt(L, "entries", entries.length());
+            LuaEngine::setAttrNum(L, "hits", hits);
+            LuaEngine::setAttrNum(L, "misses", misses);
+            LuaEngine::setAttrNum(L, "coalesced", coalesced);
+        }
+        cacheCond.unlock();
+
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error configuring proxy cache: %s", e.what());
+        return LuaObject::returnLuaStatus(L, false);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * enabled
+ *----------------------------------------------------------------------------*/
+bool ProxyCache::enabled (void)
+{
+    return maxBytes > 0;
+}
+
+/*----------------------------------------------------------------------------
+ * canonicalize
+ *
+ *  returns an allocated copy of the json parameters with members sorted and
+ *  whitespace removed, or NULL if they are not valid json and so the request
+ *  cannot be cached
+ *----------------------------------------------------------------------------*/
+char* ProxyCache::canonicalize (const char* parameters)
+{
+    rapidjson::Document json;
+    json.Parse(parameters);
+    if(json.HasParseError()) return NULL;
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    ::canonicalize(json, writer);
+
+    char* canonical_parms = new char [buffer.GetSize() + 1];
+    LocalLib::copy(canonical_parms, buffer.GetString(), buffer.GetSize());
+    canonical_parms[buffer.GetSize()] = '\0';
+    return canonical_parms;
+}
+
+/*----------------------------------------------------------------------------
+ * makeKey
+ *----------------------------------------------------------------------------*/
+void ProxyCache::makeKey (char* key, const char* endpoint, const char* resource, const char* canonical_parms)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hash = fnv1a(hash, endpoint, StringLib::size(endpoint));
+    hash = fnv1a(hash, resource, StringLib::size(resource));
+    hash = fnv1a(hash, canonical_parms, StringLib::size(canonical_parms, EndpointProxy::MAX_REQUEST_PARAMETER_SIZE));
+    StringLib::format(key, KEY_SIZE, "%016lX", (unsigned long)hash);
+}
+
+/*----------------------------------------------------------------------------
+ * lookup
+ *
+ *  joins the entry for the key if one is in flight or cached, else NULL
+ *----------------------------------------------------------------------------*/
+ProxyCache::entry_t* ProxyCache::lookup (const char* key)
+{
+    entry_t* entry = NULL;
+
+    cacheCond.lock();
+    {
+        if(maxBytes > 0 && entries.find(key, &entry))
+        {
+            entry->refs++;
+            if(entry->complete)
+            {
+                hits++;
+            }
+            else
+            {
+                entry->waiters++;
+                coalesced++;
+            }
+        }
+        else
+        {
+            entry = NULL;
+        }
+    }
+    cacheCond.unlock();
+
+    return entry;
+}
+
+/*----------------------------------------------------------------------------
+ * claim
+ *
+ *  joins the entry for the key, or creates it with the caller as the owner
+ *  that must record and finish it; NULL if the cache is disabled
+ *----------------------------------------------------------------------------*/
+ProxyCache::entry_t* ProxyCache::claim (const char* key, bool* owner)
+{
+    *owner = false;
+
+    entry_t* entry = lookup(key);
+    if(entry) return entry;
+
+    cacheCond.lock();
+    {
+        if(maxBytes > 0 && entries.find(key, &entry))
+        {
+            /* Created Since Lookup */
+            entry->refs++;
+            entry->waiters++;
+            coalesced++;
+        }
+        else if(maxBytes > 0)
+        {
+            entry = new entry_t;
+            StringLib::copy(entry->key, key, KEY_SIZE);
+            entry->bytes = 0;
+            entry->lastUsed = ++useCount;
+            entry->refs = 1;
+            entry->waiters = 0;
+            entry->recording = true;
+            entry->complete = false;
+            entry->valid = false;
+            entry->cached = true;
+            entries.add(key, entry);
+            misses++;
+            *owner = true;
+        }
+    }
+    cacheCond.unlock();
+
+    return entry;
+}
+
+/*----------------------------------------------------------------------------
+ * record
+ *
+ *  appends a copy of a message of the result; a result that outgrows its
+ *  share of the cache is dropped unless requests are already waiting on it
+ *----------------------------------------------------------------------------*/
+void ProxyCache::record (entry_t* entry, const void* data, int size)
+{
+    cacheCond.lock();
+    {
+        if(entry->recording && entry->waiters == 0 && (entry->bytes + size) > (maxBytes / MAX_ENTRY_FRACTION))
+        {
+            for(int i = 0; i < entry->messages.length(); i++)
+            {
+                delete [] entry->messages[i].data;
+            }
+            entry->messages.clear();
+            entry->bytes = 0;
+            entry->recording = false;
+            unlink(entry);
+        }
+
+        if(entry->recording)
+        {
+            msg_t msg = {
+                .data = new uint8_t [size],
+                .size = size
+            };
+            LocalLib::copy(msg.data, data, size);
+            entry->messages.add(msg);
+            entry->bytes += size;
+            cacheCond.signal();
+        }
+    }
+    cacheCond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * finish
+ *
+ *  completes the entry, keeping it in the cache if it is valid and fits
+ *----------------------------------------------------------------------------*/
+void ProxyCache::finish (entry_t* entry, bool valid)
+{
+    cacheCond.lock();
+    {
+        if(entry->cached)
+        {
+            if(valid && entry->recording && entry->bytes <= (maxBytes / MAX_ENTRY_FRACTION))
+            {
+                evict(entry->bytes);
+                cachedBytes += entry->bytes;
+                entry->lastUsed = ++useCount;
+            }
+            else
+            {
+                unlink(entry);
+            }
+        }
+
+        entry->valid = valid;
+        entry->complete = true;
+        cacheCond.signal();
+    }
+    cacheCond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * replay
+ *
+ *  posts the messages of the result to the queue as they are recorded;
+ *  returns true if the whole of a valid result was posted
+ *----------------------------------------------------------------------------*/
+bool ProxyCache::replay (entry_t* entry, Publisher* outq, const bool* active)
+{
+    bool status = false;
+    int index = 0;
+
+    cacheCond.lock();
+    {
+        entry->lastUsed = ++useCount;
+
+        while(*active)
+        {
+            if(index < entry->messages.length())
+            {
+                /* Post Next Message - data persists while the entry is referenced */
+                msg_t msg = entry->messages[index++];
+                cacheCond.unlock();
+                int post_status = MsgQ::STATE_TIMEOUT;
+                while(*active && post_status == MsgQ::STATE_TIMEOUT)
+                {
+                    post_status = outq->postCopy(msg.data, msg.size, SYS_TIMEOUT);
+                }
+                cacheCond.lock();
+                if(post_status <= 0)
+                {
+                    mlog(ERROR, "Failed (%d) to post cached result %s", post_status, entry->key);
+                    break;
+                }
+            }
+            else if(entry->complete)
+            {
+                status = entry->valid;
+                break;
+            }
+            else
+            {
+                cacheCond.wait(0, SYS_TIMEOUT);
+            }
+        }
+    }
+    cacheCond.unlock();
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *----------------------------------------------------------------------------*/
+void ProxyCache::release (entry_t* entry)
+{
+    cacheCond.lock();
+    {
+        entry->refs--;
+        if(entry->refs <= 0 && !entry->cached)
+        {
+            destroy(entry);
+        }
+    }
+    cacheCond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * evict
+ *
+ *  removes least recently used completed entries until the bytes needed
+ *  fit; must be called with the lock held
+ *----------------------------------------------------------------------------*/
+void ProxyCache::evict (long bytes_needed)
+{
+    while(cachedBytes > 0 && (cachedBytes + bytes_needed) > maxBytes)
+    {
+        entry_t* oldest = NULL;
+        entry_t* entry;
+        const char* key = entries.first(&entry);
+        while(key != NULL)
+        {
+            if(entry->complete && (!oldest || entry->lastUsed < oldest->lastUsed))
+            {
+                oldest = entry;
+            }
+            key = entries.next(&entry);
+        }
+
+        if(!oldest) break;
+        unlink(oldest);
+        if(oldest->refs <= 0) destroy(oldest);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * unlink
+ *
+ *  removes the entry from the cache so that no new requests find it; must
+ *  be called with the lock held
+ *----------------------------------------------------------------------------*/
+void ProxyCache::unlink (entry_t* entry)
+{
+    if(entry->cached)
+    {
+        entries.remove(entry->key);
+        if(entry->complete) cachedBytes -= entry->bytes;
+        entry->cached = false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * destroy
+ *----------------------------------------------------------------------------*/
+void ProxyCache::destroy (entry_t* entry)
+{
+    for(int i = 0; i < entry->messages.length(); i++)
+    {
+        delete [] entry->messages[i].data;
+    }
+    delete entry;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __proxy_cache__
+#define __proxy_cache__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "LuaEngine.h"
+#include "MsgQ.h"
+#include "OsApi.h"
+#include "List.h"
+#include "Dictionary.h"
+
+/******************************************************************************
+ * PROXY CACHE CLASS
+ ******************************************************************************/
+
+/*
+ * Results of proxied requests, keyed by a hash of the endpoint, resource, and
+ * canonicalized request parameters.  An entry is created by the first request
+ * for a key and records the messages it streams; identical requests that
+ * arrive while it is in flight, or after it completed, replay those messages
+ * instead of executing.  Completed entries are kept up to a byte limit and
+ * evicted least recently used first.
+ */
+class ProxyCache
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int KEY_SIZE = 17; // 64-bit hash in hex plus terminator
+        static const int MAX_ENTRY_FRACTION = 4; // a single result may use at most this fraction of the cache
+
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            uint8_t*    data;
+            int         size;
+        } msg_t;
+
+        typedef struct {
+            char        key[KEY_SIZE];
+            List<msg_t> messages;
+            long        bytes;
+            long        lastUsed;
+            int         refs;       // owner and waiters using the entry
+            int         waiters;    // requests coalesced onto the entry
+            bool        recording;  // false once the result outgrew the cache and no one waits on it
+            bool        complete;
+            bool        valid;
+            bool        cached;     // findable by new requests
+        } entry_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void     deinit      (void);
+        static int      luaCache    (lua_State* L);
+
+        static bool     enabled     (void);
+        static char*    canonicalize(const char* parameters);
+        static void     makeKey     (char* key, const char* endpoint, const char* resource, const char* canonical_parms);
+        static entry_t* lookup      (const char* key);
+        static entry_t* claim       (const char* key, bool* owner);
+        static void     record      (entry_t* entry, const void* data, int size);
+        static void     finish      (entry_t* entry, bool valid);
+        static bool     replay      (entry_t* entry, Publisher* outq, const bool* active);
+        static void     release     (entry_t* entry);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static Cond                 cacheCond;
+        static Dictionary<entry_t*> entries;
+        static long                 maxBytes;
+        static long                 cachedBytes;
+        static long                 useCount;
+        static long                 hits;
+        static long                 misses;
+        static long                 coalesced;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void     evict       (long bytes_needed);
+        static void     unlink      (entry_t* entry);
+        static void     destroy     (entry_t* entry);
+};
+
+#endif  /* __proxy_cache__ */
@@ -55,6 +55,7 @@ int netsvc_open (lua_State* L)
         {"get",         CurlLib::luaGet},
         {"post",        CurlLib::luaPost},
         {"proxy",       EndpointProxy::luaCreate},
+        {"cache",       ProxyCache::luaCache},
         {"orchurl",     OrchestratorLib::luaUrl},
         {"orchreg",     OrchestratorLib::luaRegisterService},
         {"orchlock",    OrchestratorLib::luaLock},
@@ -65,6 +66,8 @@ int netsvc_open (lua_State* L)
         {"pslogin",     ProvisioningSystemLib::luaLogin},
         {"psvalidate",  ProvisioningSystemLib::luaValidate},
         {"psauth",      ProvisioningSystemLib::Authenticator::luaCreate},
+        {"jsonencode",  JsonLib::luaEncode},
+        {"jsondecode",  JsonLib::luaDecode},
         {NULL,          NULL}
     };
 
@@ -98,6 +101,8 @@ void initnetsvc (void)
 
 void deinitnetsvc (void)
 {
+    EndpointProxy::deinit();
+    ProxyCache::deinit();
     ProvisioningSystemLib::deinit();
     OrchestratorLib::deinit();
     CurlLib::deinit();
@@ -38,8 +38,10 @@
 
 #include "CurlLib.h"
 #include "EndpointProxy.h"
+#include "ProxyCache.h"
 #include "OrchestratorLib.h"
 #include "ProvisioningSystemLib.h"
+#include "JsonLib.h"
 
 /******************************************************************************
  * PROTOTYPES
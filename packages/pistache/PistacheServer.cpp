@@ -145,9 +145,14 @@ PistacheServer::PistacheServer(lua_State* L,  Address addr, size_t num_threads):
     Routes::Get(router, "/source/:name", Routes::bind(&PistacheServer::sourceHandler, this));
     Routes::Post(router, "/source/:name", Routes::bind(&PistacheServer::engineHandler, this));
 
-    /* Create Server Thread */
+    /* Create Server and Stream Threads */
     active = true;
     serverPid = new Thread(serverThread, this);
+    streamPids = new Thread* [numThreads];
+    for(size_t t = 0; t < numThreads; t++)
+    {
+        streamPids[t] = new Thread(streamThread, this);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -158,6 +163,12 @@ PistacheServer::~PistacheServer(void)
     active = false;
     delete serverPid;
 
+    /* Stop Stream Threads and Finish Outstanding Requests */
+    streamCond.signal();
+    for(size_t t = 0; t < numThreads; t++) delete streamPids[t];
+    delete [] streamPids;
+    for(int i = 0; i < streamQ.length(); i++) finishStream(streamQ[i]);
+
     mlog(CRITICAL, "Shutting down HTTP endpoints on port %s", httpEndpoint->getPort().toString().c_str());
     httpEndpoint->shutdown();
 }
@@ -240,35 +251,20 @@ void PistacheServer::sourceHandler (const Rest::Request& request, Http::Response
     response.headers().add<Http::Header::Server>(serverHead.getString());
     response.headers().add<Http::Header::ContentType>(MIME(Text, Plain));
 
-    /* Launch Engine */
-    const char* script_pathname = sanitize(script_name.c_str());
-    LuaEngine* engine = new LuaEngine(script_pathname, request.body().c_str(), trace_id, NULL, true);
-    bool status = engine->executeEngine(MAX_RESPONSE_TIME_MS);
-
-    /* Send Response */
-    if(status)
-    {
-        const char* result = engine->getResult();
-        if(result)
-        {
-            response.send(Http::Code::Ok, result);
-        }
-        else
-        {
-            response.send(Http::Code::Not_Found, "Not Found");
-        }
-    }
-    else
-    {
-        response.send(Http::Code::Request_Timeout, "Request Timeout");
-    }
-
-    /* Clean Up */
-    delete engine;
-    delete [] script_pathname;
-
-    /* Stop Trace */
-    stop_trace(CRITICAL, trace_id);
+    /* Launch Engine
+     *  the result is sent by a stream thread once the script completes so
+     *  that this worker thread is free to serve other connections */
+    stream_t* s = new stream_t;
+    StringLib::copy(s->id_str, id_str, REQUEST_ID_LEN);
+    s->script_pathname = sanitize(script_name.c_str());
+    s->engine = new LuaEngine(s->script_pathname, request.body().c_str(), trace_id, NULL, true);
+    s->trace_id = trace_id;
+    s->deadline = TimeLib::latchtime() + (MAX_RESPONSE_TIME_MS / 1000.0);
+    s->writer = new Http::ResponseWriter(std::move(response));
+    s->stream = NULL;
+    s->rspq = NULL;
+    s->engine->executeEngine(IO_CHECK);
+    queueStream(s);
 }
 
 /*----------------------------------------------------------------------------
@@ -293,53 +289,128 @@ void PistacheServer::engineHandler (const Rest::Request& request, Http::Response
     response.headers().add<Http::Header::ContentType>(MIME(Application, OctetStream));
 
     /* Create Engine */
-    const char* script_pathname = sanitize(script_name.c_str());
-    LuaEngine* engine = new LuaEngine(script_pathname, request.body().c_str(), trace_id, NULL, true);
+    stream_t* s = new stream_t;
+    StringLib::copy(s->id_str, id_str, REQUEST_ID_LEN);
+    s->script_pathname = sanitize(script_name.c_str());
+    s->engine = new LuaEngine(s->script_pathname, request.body().c_str(), trace_id, NULL, true);
+    s->trace_id = trace_id;
+    s->deadline = 0.0;
+    s->writer = NULL;
 
     /* Supply and Setup Request Queue */
-    engine->setString(RESPONSE_QUEUE, id_str);
-    Subscriber rspq(id_str);
+    s->engine->setString(RESPONSE_QUEUE, id_str);
+    s->rspq = new Subscriber(id_str);
 
     /* Execute Engine
      *  the call to execute the script returns immediately (due to IO_CHECK) at which point
      *  the lua state context is locked and cannot be accessed until the script completes */
-    engine->executeEngine(IO_CHECK);
+    s->engine->executeEngine(IO_CHECK);
 
     /* Stream Response
-     *  The response is read from the response queue until both the script completes and
-     *  there are no more messages left in the message queue; the only exception is if
-     *  the termination message is received (size = 0), then the response is immediately
-     *  finished. */
-    int status = MsgQ::STATE_OKAY;
-    auto stream = response.stream(Http::Code::Ok);
-    while(engine->isActive() || status == MsgQ::STATE_OKAY)
+     *  the response queue is drained by the stream threads as data arrives,
+     *  so this worker thread is free to serve other connections */
+    s->stream = new Http::ResponseStream(response.stream(Http::Code::Ok));
+    queueStream(s);
+}
+
+/*----------------------------------------------------------------------------
+ * queueStream
+ *----------------------------------------------------------------------------*/
+void PistacheServer::queueStream (stream_t* s)
+{
+    streamCond.lock();
+    {
+        streamQ.add(s);
+        streamCond.signal(0, Cond::NOTIFY_ONE);
+    }
+    streamCond.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * serviceStream
+ *
+ *  writes what is available for the request without blocking longer than
+ *  the timeout; returns true when the response is complete.  The response
+ *  of an engine request is read from the response queue until both the
+ *  script completes and there are no more messages left in the queue; the
+ *  only exception is if the termination message is received (size = 0),
+ *  then the response is immediately finished.
+ *----------------------------------------------------------------------------*/
+bool PistacheServer::serviceStream (stream_t* s, int timeout, bool* progress)
+{
+    *progress = false;
+
+    /* Source Request */
+    if(s->writer)
+    {
+        if(s->engine->isActive())
+        {
+            if(TimeLib::latchtime() < s->deadline) return false;
+            s->writer->send(Http::Code::Request_Timeout, "Request Timeout");
+        }
+        else
+        {
+            const char* result = s->engine->getResult();
+            if(result)  s->writer->send(Http::Code::Ok, result);
+            else        s->writer->send(Http::Code::Not_Found, "Not Found");
+        }
+        *progress = true;
+        return true;
+    }
+
+    /* Engine Request */
+    bool engine_active = s->engine->isActive(); // sampled before the queue so no message is missed
+    for(int w = 0; w < MAX_STREAM_WRITES; w++)
     {
         Subscriber::msgRef_t ref;
-        status = rspq.receiveRef(ref, SYS_TIMEOUT);
+        int status = s->rspq->receiveRef(ref, w == 0 ? timeout : IO_CHECK);
         if(status == MsgQ::STATE_OKAY)
         {
             bool done = false;
-            if(ref.size > 0) stream.write((const char*)ref.data, ref.size);
+            if(ref.size > 0) s->stream->write((const char*)ref.data, ref.size);
             else done = true;
-            rspq.dereference(ref);
-            if(done) break;
+            s->rspq->dereference(ref);
+            *progress = true;
+            if(done) return true;
         }
-        else if(status != MsgQ::STATE_TIMEOUT)
+        else if(status == MsgQ::STATE_TIMEOUT)
+        {
+            if(*progress) s->stream->flush();
+            return !engine_active;
+        }
+        else
         {
-            mlog(CRITICAL, "%s error streaming data: %d", id_str, status);
-            break;
+            mlog(CRITICAL, "%s error streaming data: %d", s->id_str, status);
+            return true;
         }
     }
 
+    s->stream->flush();
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * finishStream
+ *----------------------------------------------------------------------------*/
+void PistacheServer::finishStream (stream_t* s)
+{
     /* End Response */
-    stream.ends();
+    if(s->stream)
+    {
+        s->stream->ends();
+        delete s->stream;
+    }
+    delete s->writer;
 
     /* Clean Up */
-    delete engine;
-    delete [] script_pathname;
+    delete s->rspq;
+    delete s->engine;
+    delete [] s->script_pathname;
 
     /* Stop Trace */
-    stop_trace(CRITICAL, trace_id);
+    stop_trace(CRITICAL, s->trace_id);
+
+    delete s;
 }
 
 /*----------------------------------------------------------------------------
@@ -362,6 +433,69 @@ void* PistacheServer::serverThread (void* parm)
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * streamThread
+ *
+ *  services outstanding requests in turn; a thread waits on a response
+ *  queue only when it holds the only outstanding request, and otherwise
+ *  rests briefly after a request that had nothing to write
+ *----------------------------------------------------------------------------*/
+void* PistacheServer::streamThread (void* parm)
+{
+    PistacheServer* server = (PistacheServer*)parm;
+
+    while(server->active)
+    {
+        /* Take Next Request */
+        stream_t* s = NULL;
+        bool alone = false;
+        server->streamCond.lock();
+        {
+            if(server->streamQ.length() == 0)
+            {
+                server->streamCond.wait(0, SYS_TIMEOUT);
+            }
+            if(server->streamQ.length() > 0)
+            {
+                s = server->streamQ[0];
+                server->streamQ.remove(0);
+                alone = server->streamQ.length() == 0;
+            }
+        }
+        server->streamCond.unlock();
+        if(!s) continue;
+
+        /* Service Request */
+        bool progress = false;
+        bool complete = true;
+        try
+        {
+            complete = server->serviceStream(s, alone ? STREAM_POLL_MS : IO_CHECK, &progress);
+        }
+        catch(const std::exception& e)
+        {
+            mlog(CRITICAL, "%s failed to write response: %s", s->id_str, e.what());
+        }
+
+        /* Finish or Return Request */
+        if(complete)
+        {
+            server->finishStream(s);
+        }
+        else
+        {
+            server->streamCond.lock();
+            {
+                server->streamQ.add(s);
+                if(!progress && !alone) server->streamCond.wait(0, STREAM_POLL_MS / 4);
+            }
+            server->streamCond.unlock();
+        }
+    }
+
+    return NULL;
+}
+
 /*----------------------------------------------------------------------------
  * luaRoute - :route(<action>, <url>, <route handler>)
  *----------------------------------------------------------------------------*/
@@ -62,6 +62,8 @@ class PistacheServer: public LuaObject
 
         static const int REQUEST_ID_LEN = MAX_STR_SIZE;
         static const int MAX_RESPONSE_TIME_MS = 5000;
+        static const int STREAM_POLL_MS = 10; // wait on a response queue when only one request is outstanding
+        static const int MAX_STREAM_WRITES = 16; // messages written per request before moving to the next one
         static const char* RESPONSE_QUEUE;
 
         /*--------------------------------------------------------------------
@@ -82,6 +84,18 @@ class PistacheServer: public LuaObject
             INVALID
         } verb_t;
 
+        /* Outstanding Request */
+        typedef struct {
+            char                    id_str[REQUEST_ID_LEN];
+            const char*             script_pathname;
+            LuaEngine*              engine;
+            uint32_t                trace_id;
+            double                  deadline;   // source requests time out
+            Http::ResponseWriter*   writer;     // source requests: sends result of script
+            Http::ResponseStream*   stream;     // engine requests: streams response queue
+            Subscriber*             rspq;
+        } stream_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -113,6 +127,9 @@ class PistacheServer: public LuaObject
 
         bool                            active;
         Thread*                         serverPid;
+        Thread**                        streamPids;     // complete requests off of the http worker threads
+        List<stream_t*>                 streamQ;        // outstanding requests, serviced in turn
+        Cond                            streamCond;
         std::shared_ptr<Http::Endpoint> httpEndpoint;
         Rest::Router                    router;
 
@@ -125,7 +142,12 @@ class PistacheServer: public LuaObject
         void            sourceHandler       (const Rest::Request& request, Http::ResponseWriter response);
         void            engineHandler       (const Rest::Request& request, Http::ResponseWriter response);
 
+        void            queueStream         (stream_t* s);
+        bool            serviceStream       (stream_t* s, int timeout, bool* progress);
+        void            finishStream        (stream_t* s);
+
         static void*    serverThread        (void* parm);
+        static void*    streamThread        (void* parm);
         static int      luaRoute            (lua_State* L);
 };
 
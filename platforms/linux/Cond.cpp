@@ -37,8 +37,9 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <poll.h>
-#include <pthread.h>
+#include <time.h>
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -47,14 +48,16 @@
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Cond::Cond(int num_sigs): Mutex()
+Cond::Cond(int num_sigs, const char* _name): Mutex(_name)
 {
     assert(num_sigs > 0);
     numSigs = num_sigs;
-    condId = new pthread_cond_t[numSigs];
+    sequence = new uint32_t[numSigs];
+    waiters = new uint32_t[numSigs];
     for(int i = 0; i < numSigs; i++)
     {
-        pthread_cond_init(&condId[i], NULL);
+        sequence[i] = 0;
+        waiters[i] = 0;
     }
 }
 
@@ -63,11 +66,8 @@ Cond::Cond(int num_sigs): Mutex()
  *----------------------------------------------------------------------------*/
 Cond::~Cond()
 {
-    for(int i = 0; i < numSigs; i++)
-    {
-        pthread_cond_destroy(&condId[i]);
-    }
-    delete [] condId;
+    delete [] sequence;
+    delete [] waiters;
 }
 
 /*----------------------------------------------------------------------------
@@ -76,49 +76,55 @@ Cond::~Cond()
 void Cond::signal(int sig, notify_t notify)
 {
     assert(sig < numSigs);
-    if(notify == NOTIFY_ALL)    pthread_cond_broadcast(&condId[sig]);
-    else                        pthread_cond_signal(&condId[sig]);
+    __atomic_add_fetch(&sequence[sig], 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&waiters[sig], __ATOMIC_SEQ_CST) > 0)
+    {
+        futexWake(&sequence[sig], notify == NOTIFY_ALL ? INT_MAX : 1);
+    }
 }
 
 /*----------------------------------------------------------------------------
  * wait
+ *
+ *  the lock is released in full while waiting, however many times the
+ *  calling thread holds it, and reacquired to the same depth
  *----------------------------------------------------------------------------*/
 bool Cond::wait(int sig, int timeout_ms)
 {
     assert(sig < numSigs);
-    
-    int status;
 
-    /* Perform Wait */
-    if(timeout_ms == IO_PEND)
-    {
-        /* Block Forever until Success */
-        status = pthread_cond_wait(&condId[sig], &mutexId);
-    }
-    else if(timeout_ms > 0)
-    {
-        /* Build Time Structure */
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_sec  += (time_t) (timeout_ms / 1000);
-        ts.tv_nsec +=  (timeout_ms % 1000) * 1000000L;
-        if(ts.tv_nsec  >= 1000000000L)
-        {
-            ts.tv_nsec -= 1000000000L;
-            ts.tv_sec++;
-        }
+    // note that NON-BLOKCING CHECK is an error since the
+    // conditional does not support a non-blocking attempt
+    if(timeout_ms != IO_PEND && timeout_ms <= 0) return false;
 
-        /* Block on Timed Wait */
-        status = pthread_cond_timedwait(&condId[sig], &mutexId, &ts);
-    }
-    else // timeout_ms = 0
+    /* Build Relative Timeout */
+    struct timespec ts;
+    struct timespec* timeout = NULL;
+    if(timeout_ms != IO_PEND)
     {
-        // note that NON-BLOKCING CHECK is an error since the pthread
-        // conditional does not support a non-blocking attempt
-        status = PARM_ERR_RC;
+        ts.tv_sec = (time_t)(timeout_ms / 1000);
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        timeout = &ts;
     }
 
+    /* Release Lock */
+    long me = owner;
+    int saved_depth = depth;
+    __atomic_add_fetch(&waiters[sig], 1, __ATOMIC_SEQ_CST);
+    uint32_t seq = __atomic_load_n(&sequence[sig], __ATOMIC_SEQ_CST);
+    depth = 0;
+    __atomic_store_n(&owner, 0, __ATOMIC_RELAXED);
+    release();
+
+    /* Perform Wait */
+    int status = futexWait(&sequence[sig], seq, timeout);
+
+    /* Reacquire Lock */
+    acquire();
+    __atomic_store_n(&owner, me, __ATOMIC_RELAXED);
+    depth = saved_depth;
+    __atomic_sub_fetch(&waiters[sig], 1, __ATOMIC_SEQ_CST);
+
     /* Return Status */
-    if(status == 0) return true;
-    else            return false;
+    return status != ETIMEDOUT;
 }
@@ -38,10 +38,15 @@
 
 #include "Mutex.h"
 
-#include <pthread.h>
+#include <stdint.h>
 
 /******************************************************************************
  * CONDITION CLASS
+ *
+ *  Each signal is a futex sequence number: a waiter samples it while holding
+ *  the lock and sleeps only if no signal has bumped it since, so a signal
+ *  between releasing the lock and sleeping is never lost.  Signalling a
+ *  condition nobody waits on does not enter the kernel.
  ******************************************************************************/
 
 class Cond: public Mutex
@@ -53,7 +58,7 @@ class Cond: public Mutex
             NOTIFY_ALL
         } notify_t;
         
-        Cond (int num_sigs=1);
+        Cond (int num_sigs=1, const char* _name=NULL);
         ~Cond (void);
 
         void signal (int sig=0, notify_t notify=NOTIFY_ALL);
@@ -62,7 +67,8 @@ class Cond: public Mutex
     private:
 
         int numSigs;
-        pthread_cond_t* condId;
+        uint32_t* sequence;
+        uint32_t* waiters;
 };
 
 #endif  /* __condition__ */
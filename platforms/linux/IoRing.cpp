@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include "OsApi.h"
+#include "IoRing.h"
+
+#include <atomic>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+/* reads (IORING_OP_READ) and probing arrived with the same kernel headers */
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup)
+#define IO_RING_SUPPORTED
+#endif
+
+/******************************************************************************
+ * PRIVATE TYPES
+ ******************************************************************************/
+
+struct IoRing::batch_t {
+    Cond                    cond;
+    int                     remaining;
+};
+
+struct IoRing::op_t {
+    read_t*                 read;
+    batch_t*                batch;
+};
+
+#ifdef IO_RING_SUPPORTED
+
+struct IoRing::ring_t {
+    int                     fd;
+    unsigned                entries;
+    void*                   sq_ptr;
+    size_t                  sq_size;
+    void*                   cq_ptr;
+    size_t                  cq_size;
+    struct io_uring_sqe*    sqes;
+    size_t                  sqes_size;
+    unsigned*               sq_tail;
+    unsigned*               sq_mask;
+    unsigned*               sq_array;
+    unsigned*               cq_head;
+    unsigned*               cq_tail;
+    unsigned*               cq_mask;
+    struct io_uring_cqe*    cqes;
+    Cond                    sq_cond;    // protects submission state below
+    unsigned                inflight;   // submitted and not yet reaped
+    unsigned                pending;    // queued and not yet submitted
+    std::atomic<bool>       active;
+    Thread*                 pid;
+};
+
+#else
+
+struct IoRing::ring_t {
+    std::atomic<bool>       active;
+};
+
+#endif
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+IoRing::ring_t* IoRing::ring = NULL;
+
+static Mutex initMut;
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+#ifdef IO_RING_SUPPORTED
+
+static int io_uring_setup (unsigned entries, struct io_uring_params* p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter (int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int io_uring_register (int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+#endif
+
+/******************************************************************************
+ * PUBLIC METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * init
+ *
+ *  returns whether the ring is active; io_uring is commonly unavailable in
+ *  containers (seccomp) and older kernels, which is not an error
+ *----------------------------------------------------------------------------*/
+bool IoRing::init (int entries)
+{
+#ifdef IO_RING_SUPPORTED
+    initMut.lock();
+    {
+        if(ring == NULL)
+        {
+            struct io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            int fd = io_uring_setup(entries, &params);
+            if(fd < 0)
+            {
+                dlog("io_uring unavailable: %s", strerror(errno));
+            }
+            else
+            {
+                /* Check Reads are Supported */
+                const int num_probe_ops = 256;
+                size_t probe_size = sizeof(struct io_uring_probe) + (num_probe_ops * sizeof(struct io_uring_probe_op));
+                struct io_uring_probe* probe = (struct io_uring_probe*)new uint8_t [probe_size];
+                memset(probe, 0, probe_size);
+                bool supported = (io_uring_register(fd, IORING_REGISTER_PROBE, probe, num_probe_ops) == 0) &&
+                                 (probe->last_op >= IORING_OP_READ) &&
+                                 (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+                delete [] (uint8_t*)probe;
+
+                /* Map Rings */
+                ring_t* r = new ring_t;
+                r->fd = fd;
+                r->entries = params.sq_entries;
+                r->sq_size = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+                r->cq_size = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+                if(params.features & IORING_FEAT_SINGLE_MMAP) r->sq_size = r->cq_size = MAX(r->sq_size, r->cq_size);
+                r->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+                r->sq_ptr = supported ? mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING) : MAP_FAILED;
+                r->cq_ptr = MAP_FAILED;
+                r->sqes = (struct io_uring_sqe*)MAP_FAILED;
+                if(r->sq_ptr != MAP_FAILED)
+                {
+                    if(params.features & IORING_FEAT_SINGLE_MMAP) r->cq_ptr = r->sq_ptr;
+                    else r->cq_ptr = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                    r->sqes = (struct io_uring_sqe*)mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+                }
+
+                if(r->sq_ptr != MAP_FAILED && r->cq_ptr != MAP_FAILED && r->sqes != MAP_FAILED)
+                {
+                    uint8_t* sq = (uint8_t*)r->sq_ptr;
+                    uint8_t* cq = (uint8_t*)r->cq_ptr;
+                    r->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+                    r->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+                    r->sq_array = (unsigned*)(sq + params.sq_off.array);
+                    r->cq_head = (unsigned*)(cq + params.cq_off.head);
+                    r->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+                    r->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+                    r->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+                    r->inflight = 0;
+                    r->pending = 0;
+                    r->active = true;
+                    ring = r;
+                    r->pid = new Thread(completionThread, r);
+                }
+                else
+                {
+                    if(!supported) dlog("io_uring does not support reads on this kernel");
+                    else dlog("Failed to map io_uring: %s", strerror(errno));
+                    if(r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_size);
+                    if(r->cq_ptr != MAP_FAILED && r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_size);
+                    if(r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_size);
+                    close(fd);
+                    delete r;
+                }
+            }
+        }
+    }
+    initMut.unlock();
+#else
+    (void)entries;
+#endif
+
+    return isActive();
+}
+
+/*----------------------------------------------------------------------------
+ * deinit
+ *
+ *  must only be called once no more reads can be issued
+ *----------------------------------------------------------------------------*/
+void IoRing::deinit (void)
+{
+#ifdef IO_RING_SUPPORTED
+    initMut.lock();
+    {
+        ring_t* r = ring;
+        if(r)
+        {
+            /* Wake Completion Thread with a No-Op */
+            r->active = false;
+            r->sq_cond.lock();
+            {
+                while(r->inflight + r->pending >= r->entries)
+                {
+                    if(r->pending > 0) flush();
+                    else r->sq_cond.wait(0, SYS_TIMEOUT);
+                }
+
+                unsigned tail = *r->sq_tail;
+                unsigned index = tail & *r->sq_mask;
+                struct io_uring_sqe* sqe = &r->sqes[index];
+                memset(sqe, 0, sizeof(struct io_uring_sqe));
+                sqe->opcode = IORING_OP_NOP;
+                sqe->user_data = 0;
+                r->sq_array[index] = index;
+                __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+                r->pending++;
+                flush();
+            }
+            r->sq_cond.unlock();
+            delete r->pid;
+
+            /* Unmap Rings */
+            munmap(r->sqes, r->sqes_size);
+            if(r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_size);
+            munmap(r->sq_ptr, r->sq_size);
+            close(r->fd);
+            ring = NULL;
+            delete r;
+        }
+    }
+    initMut.unlock();
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * isActive
+ *----------------------------------------------------------------------------*/
+bool IoRing::isActive (void)
+{
+    return ring && ring->active;
+}
+
+/*----------------------------------------------------------------------------
+ * read
+ *----------------------------------------------------------------------------*/
+int64_t IoRing::read (int fd, void* buf, int64_t size, uint64_t offset)
+{
+    read_t rd = {
+        .fd = fd,
+        .buf = buf,
+        .size = size,
+        .offset = offset,
+        .result = 0
+    };
+    readv(&rd, 1);
+    return rd.result;
+}
+
+/*----------------------------------------------------------------------------
+ * readv
+ *
+ *  the reads are queued together and submitted with one system call; blocks
+ *  until all of them complete
+ *----------------------------------------------------------------------------*/
+void IoRing::readv (read_t* reads, int num_reads)
+{
+    if(num_reads <= 0) return;
+
+    /* Fall Back to System Calls */
+    if(!isActive())
+    {
+        for(int i = 0; i < num_reads; i++)
+        {
+            ssize_t ret = pread(reads[i].fd, reads[i].buf, reads[i].size, reads[i].offset);
+            reads[i].result = (ret >= 0) ? ret : -errno;
+        }
+        return;
+    }
+
+    /* Build Operations */
+    batch_t batch;
+    batch.remaining = num_reads;
+    op_t local_ops[8];
+    op_t* ops = (num_reads <= 8) ? local_ops : new op_t [num_reads];
+    for(int i = 0; i < num_reads; i++)
+    {
+        ops[i].read = &reads[i];
+        ops[i].batch = &batch;
+    }
+
+    /* Submit and Wait for Completions */
+    submit(ops, num_reads);
+    batch.cond.lock();
+    {
+        while(batch.remaining > 0)
+        {
+            batch.cond.wait(0, SYS_TIMEOUT);
+        }
+    }
+    batch.cond.unlock();
+
+    if(ops != local_ops) delete [] ops;
+}
+
+/******************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * completionThread
+ *----------------------------------------------------------------------------*/
+void* IoRing::completionThread (void* parm)
+{
+#ifdef IO_RING_SUPPORTED
+    ring_t* r = (ring_t*)parm;
+
+    bool running = true;
+    while(running)
+    {
+        /* Wait for a Completion */
+        int ret = io_uring_enter(r->fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if(ret < 0 && errno != EINTR)
+        {
+            dlog("Failed to wait on io_uring completions: %s", strerror(errno));
+            LocalLib::performIOTimeout();
+        }
+
+        /* Reap Completions */
+        unsigned reaped = 0;
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        while(head != tail)
+        {
+            struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+            op_t* op = (op_t*)cqe->user_data;
+            if(op)
+            {
+                batch_t* batch = op->batch;
+                batch->cond.lock();
+                {
+                    op->read->result = cqe->res;
+                    if(--batch->remaining == 0) batch->cond.signal();
+                }
+                batch->cond.unlock();
+            }
+            else
+            {
+                running = false; // no-op posted by deinit
+            }
+            head++;
+            reaped++;
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+
+        /* Free Submission Slots */
+        if(reaped > 0)
+        {
+            r->sq_cond.lock();
+            {
+                r->inflight -= reaped;
+                r->sq_cond.signal();
+            }
+            r->sq_cond.unlock();
+        }
+    }
+#else
+    (void)parm;
+#endif
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * submit
+ *
+ *  no more operations are in flight than there are submission entries, which
+ *  keeps the completion ring (twice the size) from overflowing
+ *----------------------------------------------------------------------------*/
+void IoRing::submit (op_t* ops, int num_ops)
+{
+#ifdef IO_RING_SUPPORTED
+    ring_t* r = ring;
+    r->sq_cond.lock();
+    {
+        for(int i = 0; i < num_ops; i++)
+        {
+            /* Wait for a Free Slot (submitting what is queued so slots can free up) */
+            while(r->inflight + r->pending >= r->entries)
+            {
+                if(r->pending > 0) flush();
+                else r->sq_cond.wait(0, SYS_TIMEOUT);
+            }
+
+            /* Queue Read */
+            read_t* rd = ops[i].read;
+            unsigned tail = *r->sq_tail;
+            unsigned index = tail & *r->sq_mask;
+            struct io_uring_sqe* sqe = &r->sqes[index];
+            memset(sqe, 0, sizeof(struct io_uring_sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = rd->fd;
+            sqe->addr = (uint64_t)(uintptr_t)rd->buf;
+            sqe->len = (uint32_t)MIN(rd->size, MAX_READ_SIZE);
+            sqe->off = rd->offset;
+            sqe->user_data = (uint64_t)(uintptr_t)&ops[i];
+            r->sq_array[index] = index;
+            __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+            r->pending++;
+        }
+
+        /* Submit Batch */
+        flush();
+    }
+    r->sq_cond.unlock();
+#else
+    (void)ops;
+    (void)num_ops;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * flush
+ *
+ *  submits the queued entries; must be called with the submission lock held
+ *----------------------------------------------------------------------------*/
+void IoRing::flush (void)
+{
+#ifdef IO_RING_SUPPORTED
+    ring_t* r = ring;
+    while(r->pending > 0)
+    {
+        int ret = io_uring_enter(r->fd, r->pending, 0, 0);
+        if(ret > 0)
+        {
+            r->pending -= ret;
+            r->inflight += ret;
+        }
+        else if(ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+            dlog("Failed to submit to io_uring: %s", strerror(errno));
+            LocalLib::performIOTimeout();
+        }
+    }
+#endif
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the University of Washington nor the names of its 
+ *    contributors may be used to endorse or promote products derived from this 
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __io_ring__
+#define __io_ring__
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************
+ * IO RING CLASS
+ *
+ *  Process wide io_uring instance.  Callers queue reads into the submission
+ *  ring and block until a completion thread reaps their results; a batch of
+ *  reads is submitted with a single system call.  The ring is only started
+ *  on request, and only when the kernel supports it, so callers must check
+ *  isActive and fall back to ordinary system calls.
+ ******************************************************************************/
+
+class IoRing
+{
+    public:
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const int DEFAULT_ENTRIES = 256;
+        static const int64_t MAX_READ_SIZE = 0x40000000; // larger reads complete short
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            int         fd;
+            void*       buf;
+            int64_t     size;
+            uint64_t    offset;
+            int64_t     result; // bytes read, or negative errno
+        } read_t;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static bool     init        (int entries=DEFAULT_ENTRIES);
+        static void     deinit      (void);
+        static bool     isActive    (void);
+        static int64_t  read        (int fd, void* buf, int64_t size, uint64_t offset);
+        static void     readv       (read_t* reads, int num_reads);
+
+    private:
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        struct ring_t;
+        struct batch_t;
+        struct op_t;
+
+        /*--------------------------------------------------------------------
+         * Data
+         *--------------------------------------------------------------------*/
+
+        static ring_t* ring;
+
+        /*--------------------------------------------------------------------
+         * Methods
+         *--------------------------------------------------------------------*/
+
+        static void*    completionThread    (void* parm);
+        static void     submit              (op_t* ops, int num_ops);
+        static void     flush               (void);
+};
+
+#endif  /* __io_ring__ */
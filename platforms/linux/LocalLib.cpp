@@ -51,6 +51,8 @@
 #include <errno.h>
 #include <byteswap.h>
 #include <sys/sysinfo.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************
  * STATIC DATA
@@ -335,6 +337,55 @@ double LocalLib::memusage (void)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * mapfile
+ *
+ *  maps the entire file read-only; pages are shared by every process that
+ *  maps the same file, returns NULL on error
+ *----------------------------------------------------------------------------*/
+const void* LocalLib::mapfile (const char* path, size_t* size)
+{
+    *size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+
+    struct stat sb;
+    if(fstat(fd, &sb) != 0 || sb.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* addr = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // mapping holds its own reference
+    if(addr == MAP_FAILED) return NULL;
+
+    *size = sb.st_size;
+    return addr;
+}
+
+/*----------------------------------------------------------------------------
+ * unmapfile
+ *----------------------------------------------------------------------------*/
+void LocalLib::unmapfile (const void* addr, size_t size)
+{
+    if(addr) munmap(const_cast<void*>(addr), size);
+}
+
+/*----------------------------------------------------------------------------
+ * filetime
+ *
+ *  returns the last modification time of the file in nanoseconds, or -1 if
+ *  the file cannot be accessed
+ *----------------------------------------------------------------------------*/
+int64_t LocalLib::filetime (const char* path)
+{
+    struct stat sb;
+    if(stat(path, &sb) != 0) return -1;
+    return ((int64_t)sb.st_mtim.tv_sec * 1000000000LL) + (int64_t)sb.st_mtim.tv_nsec;
+}
+
 /*----------------------------------------------------------------------------
  * setIOMaxsize
  *----------------------------------------------------------------------------*/
@@ -72,6 +72,9 @@ class LocalLib
         static double       swaplf              (double val);
         static int          nproc               (void);
         static double       memusage            (void);
+        static const void*  mapfile             (const char* path, size_t* size); // read-only, shared between processes
+        static void         unmapfile           (const void* addr, size_t size);
+        static int64_t      filetime            (const char* path); // modification time, -1 on error
         static bool         setIOMaxsize        (int maxsize);
         static int          getIOMaxsize        (void);
         static void         setIOTimeout        (int timeout);
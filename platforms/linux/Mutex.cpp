@@ -36,7 +36,37 @@
 #include "OsApi.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/******************************************************************************
+ * MACROS
+ ******************************************************************************/
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax() __asm__ __volatile__("yield")
+#else
+#define cpu_relax() do {} while(0)
+#endif
+
+/* counters are written by the lock holder and read by anyone scraping them */
+#define bump(counter, value) __atomic_store_n(&(counter), (counter) + (value), __ATOMIC_RELAXED)
+
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+pthread_mutex_t Mutex::registryLock = PTHREAD_MUTEX_INITIALIZER;
+Mutex* Mutex::registry = NULL;
+Mutex::stats_t Mutex::retired[MAX_LOCK_NAMES];
+int Mutex::numRetired = 0;
+bool Mutex::multiCore = sysconf(_SC_NPROCESSORS_ONLN) > 1; // spinning is pointless on one cpu
 
 /******************************************************************************
  * PUBLIC METHODS
@@ -45,12 +75,31 @@
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Mutex::Mutex()
+Mutex::Mutex(const char* _name)
 {
-    pthread_mutexattr_t attr;
-    pthread_mutexattr_init(&attr);
-    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-    pthread_mutex_init(&mutexId, &attr);
+    state = 0;
+    owner = 0;
+    depth = 0;
+    spinEstimate = 0;
+    name = _name;
+    prev = NULL;
+    next = NULL;
+    acquired = 0;
+    contended = 0;
+    parked = 0;
+    spins = 0;
+
+    /* Register Named Lock */
+    if(name)
+    {
+        pthread_mutex_lock(&registryLock);
+        {
+            next = registry;
+            if(registry) registry->prev = this;
+            registry = this;
+        }
+        pthread_mutex_unlock(&registryLock);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -58,7 +107,20 @@ Mutex::Mutex()
  *----------------------------------------------------------------------------*/
 Mutex::~Mutex()
 {
-    pthread_mutex_destroy(&mutexId); 
+    /* Unregister Named Lock - its counts are kept under its name */
+    if(name)
+    {
+        stats_t stats;
+        getStats(&stats);
+        pthread_mutex_lock(&registryLock);
+        {
+            if(prev) prev->next = next;
+            else     registry = next;
+            if(next) next->prev = prev;
+            accumulate(retired, &numRetired, MAX_LOCK_NAMES, &stats);
+        }
+        pthread_mutex_unlock(&registryLock);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -66,7 +128,16 @@ Mutex::~Mutex()
  *----------------------------------------------------------------------------*/
 void Mutex::lock(void)
 {
-    pthread_mutex_lock(&mutexId); 
+    long me = self();
+    if(__atomic_load_n(&owner, __ATOMIC_RELAXED) == me)
+    {
+        depth++;
+        return;
+    }
+
+    acquire();
+    __atomic_store_n(&owner, me, __ATOMIC_RELAXED);
+    depth = 1;
 }
 
 /*----------------------------------------------------------------------------
@@ -74,5 +145,167 @@ void Mutex::lock(void)
  *----------------------------------------------------------------------------*/
 void Mutex::unlock(void)
 {
-    pthread_mutex_unlock(&mutexId); 
+    assert(owner == self());
+    if(--depth > 0) return;
+    __atomic_store_n(&owner, 0, __ATOMIC_RELAXED);
+    release();
+}
+
+/*----------------------------------------------------------------------------
+ * getStats
+ *----------------------------------------------------------------------------*/
+void Mutex::getStats(stats_t* stats)
+{
+    stats->name = name;
+    stats->acquired = __atomic_load_n(&acquired, __ATOMIC_RELAXED);
+    stats->contended = __atomic_load_n(&contended, __ATOMIC_RELAXED);
+    stats->parked = __atomic_load_n(&parked, __ATOMIC_RELAXED);
+    stats->spins = __atomic_load_n(&spins, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------------------------
+ * getNamedStats
+ *
+ *  sums the counters of every named lock by name, live and destroyed;
+ *  returns the number of names filled in
+ *----------------------------------------------------------------------------*/
+int Mutex::getNamedStats(stats_t* stats, int max_stats)
+{
+    int num_stats = 0;
+    pthread_mutex_lock(&registryLock);
+    {
+        for(int i = 0; i < numRetired; i++)
+        {
+            accumulate(stats, &num_stats, max_stats, &retired[i]);
+        }
+        for(Mutex* m = registry; m; m = m->next)
+        {
+            stats_t live;
+            m->getStats(&live);
+            accumulate(stats, &num_stats, max_stats, &live);
+        }
+    }
+    pthread_mutex_unlock(&registryLock);
+    return num_stats;
+}
+
+/******************************************************************************
+ * PROTECTED METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * acquire
+ *
+ *  state follows the usual three state futex lock: a waiter swaps in 2 so
+ *  that the releasing thread knows to wake someone.  The spin limit tracks
+ *  a running average of the spins that previously succeeded and decays when
+ *  spinning fails, so locks held longer than a spin is worth sleep quickly.
+ *----------------------------------------------------------------------------*/
+void Mutex::acquire(void)
+{
+    /* Fast Path */
+    uint32_t c = 0;
+    if(__atomic_compare_exchange_n(&state, &c, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        bump(acquired, 1);
+        return;
+    }
+
+    /* Spin */
+    int limit = multiCore ? MIN(spinEstimate * 2 + 10, MAX_SPINS) : 0;
+    int n = 0;
+    bool locked = false;
+    while(n < limit)
+    {
+        n++;
+        cpu_relax();
+        c = 0;
+        if(__atomic_load_n(&state, __ATOMIC_RELAXED) == 0 &&
+           __atomic_compare_exchange_n(&state, &c, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            locked = true;
+            break;
+        }
+    }
+
+    /* Park */
+    if(!locked)
+    {
+        c = __atomic_exchange_n(&state, 2, __ATOMIC_ACQUIRE);
+        while(c != 0)
+        {
+            futexWait(&state, 2, NULL);
+            c = __atomic_exchange_n(&state, 2, __ATOMIC_ACQUIRE);
+        }
+        bump(parked, 1);
+    }
+
+    /* Update Counters (lock is held) */
+    if(locked)  spinEstimate += (n - spinEstimate) / 8;
+    else        spinEstimate -= spinEstimate / 8;
+    bump(acquired, 1);
+    bump(contended, 1);
+    bump(spins, n);
+}
+
+/*----------------------------------------------------------------------------
+ * release
+ *----------------------------------------------------------------------------*/
+void Mutex::release(void)
+{
+    if(__atomic_exchange_n(&state, 0, __ATOMIC_RELEASE) == 2)
+    {
+        futexWake(&state, 1);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * self
+ *----------------------------------------------------------------------------*/
+long Mutex::self(void)
+{
+    static thread_local long tid = 0;
+    if(tid == 0) tid = Thread::getId();
+    return tid;
+}
+
+/*----------------------------------------------------------------------------
+ * futexWait - returns 0 when woken (or spuriously), else errno
+ *----------------------------------------------------------------------------*/
+int Mutex::futexWait(uint32_t* addr, uint32_t val, const struct timespec* timeout)
+{
+    long ret = syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, timeout, NULL, 0);
+    if(ret == 0) return 0;
+    if(errno == EAGAIN || errno == EINTR) return 0;
+    return errno;
+}
+
+/*----------------------------------------------------------------------------
+ * futexWake
+ *----------------------------------------------------------------------------*/
+void Mutex::futexWake(uint32_t* addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/*----------------------------------------------------------------------------
+ * accumulate
+ *----------------------------------------------------------------------------*/
+void Mutex::accumulate(stats_t* stats, int* num_stats, int max_stats, const stats_t* add)
+{
+    int i = 0;
+    while(i < *num_stats && strcmp(stats[i].name, add->name) != 0) i++;
+    if(i == *num_stats)
+    {
+        if(*num_stats >= max_stats) return;
+        stats[i] = *add;
+        (*num_stats)++;
+    }
+    else
+    {
+        stats[i].acquired += add->acquired;
+        stats[i].contended += add->contended;
+        stats[i].parked += add->parked;
+        stats[i].spins += add->spins;
+    }
 }
@@ -37,24 +37,72 @@
  ******************************************************************************/
 
 #include <pthread.h>
+#include <stdint.h>
 
 /******************************************************************************
  * MUTUAL EXCLUSION (MUTEX) CLASS
+ *
+ *  Recursive lock built on a futex.  An uncontended lock and unlock are a
+ *  single atomic operation each; a contended lock spins for a while, adapting
+ *  to how long the lock is usually held, before parking in the kernel.
+ *
+ *  Locks given a name are registered so their contention counters can be
+ *  scraped; every lock sharing a name is reported together, including those
+ *  already destroyed.  The name must outlive the lock.
  ******************************************************************************/
 
 class Mutex
 {
     public:
 
-        Mutex (void);
+        static const int MAX_SPINS = 200;
+        static const int MAX_LOCK_NAMES = 64;
+
+        typedef struct {
+            const char* name;
+            uint64_t    acquired;   // locks taken, not counting recursion
+            uint64_t    contended;  // locks found held by another thread
+            uint64_t    parked;     // locks that slept in the kernel
+            uint64_t    spins;      // iterations spent spinning
+        } stats_t;
+
+        Mutex (const char* _name=NULL);
         ~Mutex (void);
 
         void lock (void);
         void unlock (void);
 
+        void getStats (stats_t* stats);
+        static int getNamedStats (stats_t* stats, int max_stats);
+
     protected:
 
-        pthread_mutex_t mutexId;
+        uint32_t    state;      // 0: unlocked, 1: locked, 2: locked with waiters
+        long        owner;
+        int         depth;
+        int         spinEstimate;
+        const char* name;
+        Mutex*      prev;
+        Mutex*      next;
+
+        /* Counters - written only by the thread holding the lock */
+        uint64_t    acquired;
+        uint64_t    contended;
+        uint64_t    parked;
+        uint64_t    spins;
+
+        static pthread_mutex_t  registryLock;
+        static Mutex*           registry;
+        static stats_t          retired[MAX_LOCK_NAMES];
+        static int              numRetired;
+        static bool             multiCore;
+
+        void        acquire         (void);
+        void        release         (void);
+        static long self            (void);
+        static int  futexWait       (uint32_t* addr, uint32_t val, const struct timespec* timeout);
+        static void futexWake       (uint32_t* addr, int count);
+        static void accumulate      (stats_t* stats, int* num_stats, int max_stats, const stats_t* add);
 };
 
 #endif  /* __mutex__ */
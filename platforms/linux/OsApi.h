@@ -176,5 +176,6 @@ CompileTimeAssert(sizeof(bool)==1, TypeboolWrongSize);
 #include "LocalLib.h"
 #include "SockLib.h"
 #include "TTYLib.h"
+#include "IoRing.h"
 
 #endif  /* __osapi__ */
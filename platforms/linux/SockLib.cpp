@@ -55,6 +55,9 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <linux/errqueue.h>
 #include <exception>
 
 /******************************************************************************
@@ -310,6 +313,116 @@ int SockLib::socksend(int fd, const void* buf, int size, int timeout)
     return c;
 }
 
+/*----------------------------------------------------------------------------
+ * socksendv
+ *
+ *  non-blocking gather send of the iovecs; returns the number of bytes sent,
+ *  TIMEOUT_RC when the socket is full, or an error code.  When zerocopy is
+ *  set (and sockzerocopy succeeded on the socket) the kernel sends from the
+ *  buffers in place, so they must not be freed or modified until sockzcreap
+ *  reports the send complete; every send that returns bytes consumes one
+ *  completion id, starting at zero
+ *----------------------------------------------------------------------------*/
+int SockLib::socksendv(int fd, const struct iovec* iov, int iovcnt, bool zerocopy)
+{
+    if(fd == INVALID_RC) return TIMEOUT_RC;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec*)iov;
+    msg.msg_iovlen = iovcnt;
+
+    int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+    #ifdef MSG_ZEROCOPY
+    if(zerocopy) flags |= MSG_ZEROCOPY;
+    #else
+    (void)zerocopy;
+    #endif
+
+    int c = sendmsg(fd, &msg, flags);
+    if(c < 0)
+    {
+        if(errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) // ENOBUFS: zerocopy notification limit
+        {
+            c = TIMEOUT_RC;
+        }
+        else
+        {
+            dlog("Failed (%d) to send vectored data to socket: %s", c, strerror(errno));
+            c = SOCK_ERR_RC;
+        }
+    }
+
+    /* Return Results */
+    return c;
+}
+
+/*----------------------------------------------------------------------------
+ * sockzerocopy
+ *
+ *  enables MSG_ZEROCOPY sends on the socket
+ *----------------------------------------------------------------------------*/
+int SockLib::sockzerocopy(int fd)
+{
+    #ifdef SO_ZEROCOPY
+    int optval = 1;
+    if(setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)) < 0)
+    {
+        dlog("Failed to set SO_ZEROCOPY option on socket, %s", strerror(errno));
+        return SOCK_ERR_RC;
+    }
+    return 0;
+    #else
+    (void)fd;
+    return SOCK_ERR_RC;
+    #endif
+}
+
+/*----------------------------------------------------------------------------
+ * sockzcreap
+ *
+ *  drains the zerocopy completion notifications from the socket's error
+ *  queue; *completed is advanced to one past the highest completed id
+ *  (completions are reported in order); returns the number of notifications
+ *----------------------------------------------------------------------------*/
+int SockLib::sockzcreap(int fd, uint32_t* completed)
+{
+    int count = 0;
+
+    #ifdef SO_ZEROCOPY
+    while(true)
+    {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if(recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break; // queue empty
+
+        for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+               (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+            {
+                struct sock_extended_err* serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+                if(serr->ee_errno == 0 && serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+                {
+                    uint32_t next = serr->ee_data + 1; // ee_info..ee_data is the completed range
+                    if((int32_t)(next - *completed) > 0) *completed = next;
+                    count++;
+                }
+            }
+        }
+    }
+    #else
+    (void)fd;
+    (void)completed;
+    #endif
+
+    return count;
+}
+
 /*----------------------------------------------------------------------------
  * sockrecv
  *----------------------------------------------------------------------------*/
@@ -358,6 +471,161 @@ int SockLib::sockrecv(int fd, void* buf, int size, int timeout)
     return c;
 }
 
+/*----------------------------------------------------------------------------
+ * sockrecvbatch
+ *
+ *  receives up to n datagrams with a single recvmmsg call; sizes[i] holds the
+ *  size of bufs[i] on entry and the length of the datagram received into it
+ *  on return; returns the number of datagrams received, or an error code
+ *----------------------------------------------------------------------------*/
+int SockLib::sockrecvbatch(int fd, void** bufs, int* sizes, int n, int timeout)
+{
+    int c = TIMEOUT_RC;
+    int revents = POLLIN;
+
+    if(timeout != IO_CHECK)
+    {
+        /* Build Poll Structure */
+        struct pollfd polllist[1];
+        polllist[0].fd = fd;
+        polllist[0].events = POLLIN | POLLHUP;
+        polllist[0].revents = 0;
+
+        /* Poll */
+        int activity = 1;
+        do activity = poll(polllist, 1, timeout);
+        while(activity == -1 && (errno == EINTR || errno == EAGAIN));
+
+        /* Set Activity */
+        revents = polllist[0].revents;
+    }
+
+    /* Perform Receive */
+    if(revents & POLLIN)
+    {
+        struct mmsghdr msgs[MAX_DGRAM_BATCH];
+        struct iovec iovs[MAX_DGRAM_BATCH];
+        int num_msgs = MIN(n, MAX_DGRAM_BATCH);
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * num_msgs);
+        for(int i = 0; i < num_msgs; i++)
+        {
+            iovs[i].iov_base = bufs[i];
+            iovs[i].iov_len = sizes[i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        c = recvmmsg(fd, msgs, num_msgs, MSG_DONTWAIT, NULL);
+        if(c > 0)
+        {
+            for(int i = 0; i < c; i++)
+            {
+                sizes[i] = msgs[i].msg_len;
+            }
+        }
+        else if(c == 0)
+        {
+            c = SHUTDOWN_RC;
+        }
+        else if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            c = TIMEOUT_RC;
+        }
+        else
+        {
+            if(timeout != IO_CHECK) dlog("Failed (%d) to receive datagrams from ready socket [0x%0X]: %s", c, revents, strerror(errno));
+            c = SOCK_ERR_RC;
+        }
+    }
+    else if(revents & POLLHUP)
+    {
+        c = SHUTDOWN_RC;
+    }
+
+    /* Return Results */
+    return c;
+}
+
+/*----------------------------------------------------------------------------
+ * socksendbatch
+ *
+ *  sends up to n datagrams with a single sendmmsg call; returns the number of
+ *  datagrams sent, which may be fewer than n, or an error code
+ *----------------------------------------------------------------------------*/
+int SockLib::socksendbatch(int fd, const void** bufs, const int* sizes, int n, int timeout)
+{
+    int activity = 1;
+    int revents = POLLOUT;
+    int c = TIMEOUT_RC;
+
+    /* Check Sock */
+    if(fd == INVALID_RC)
+    {
+        if(timeout != IO_CHECK) LocalLib::performIOTimeout();
+        return TIMEOUT_RC;
+    }
+
+    if(timeout != IO_CHECK)
+    {
+        /* Build Poll Structure */
+        struct pollfd polllist[1];
+        polllist[0].fd = fd;
+        polllist[0].events = POLLOUT | POLLHUP;
+        polllist[0].revents = 0;
+
+        /* Poll */
+        do activity = poll(polllist, 1, timeout);
+        while(activity == -1 && (errno == EINTR || errno == EAGAIN));
+
+        /* Set Activity */
+        if(activity > 0)    revents = polllist[0].revents;
+        else                revents = 0;
+    }
+
+    /* Perform Send */
+    if(revents & POLLHUP)
+    {
+        c = SHUTDOWN_RC;
+    }
+    else if(revents & POLLOUT)
+    {
+        struct mmsghdr msgs[MAX_DGRAM_BATCH];
+        struct iovec iovs[MAX_DGRAM_BATCH];
+        int num_msgs = MIN(n, MAX_DGRAM_BATCH);
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * num_msgs);
+        for(int i = 0; i < num_msgs; i++)
+        {
+            iovs[i].iov_base = (void*)bufs[i];
+            iovs[i].iov_len = sizes[i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        c = sendmmsg(fd, msgs, num_msgs, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if(c == 0)
+        {
+            c = SHUTDOWN_RC;
+        }
+        else if(c < 0)
+        {
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                c = TIMEOUT_RC;
+            }
+            else
+            {
+                if(timeout != IO_CHECK) dlog("Failed (%d) to send datagrams to ready socket [0x%0X]: %s", c, revents, strerror(errno));
+                c = SOCK_ERR_RC;
+            }
+        }
+    }
+
+    /* Return Results */
+    return c;
+}
+
 /*----------------------------------------------------------------------------
  * sockinfo
  *
@@ -487,8 +755,19 @@ int SockLib::startserver(const char* ip_addr, int port, int max_num_connections,
                         int error = 0;
                         socklen_t errlen = sizeof(error);
                         getsockopt(polllist[i].fd, SOL_SOCKET, SO_ERROR, (void *)&error, &errlen);
-                        dlog("Poll error (%d) detected [0x%X] on server socket <%d>: %s", error, polllist[i].revents, polllist[i].fd, strerror(error));
-                        cb_stat = -1; // treat like a callback error or disconnect
+                        if(error != 0)
+                        {
+                            dlog("Poll error (%d) detected [0x%X] on server socket <%d>: %s", error, polllist[i].revents, polllist[i].fd, strerror(error));
+                            cb_stat = -1; // treat like a callback error or disconnect
+                        }
+                        else
+                        {
+                            /* Error Queue Notification (e.g. zerocopy completion) */
+                            int actevents = IO_ALIVE_FLAG;
+                            if(polllist[i].revents & POLLIN) actevents |= IO_READ_FLAG;
+                            if(polllist[i].revents & POLLOUT) actevents |= IO_WRITE_FLAG;
+                            cb_stat = on_act(polllist[i].fd, actevents, parm);
+                        }
                     }
                     else if(polllist[i].revents & POLLNVAL)
                     {
@@ -637,6 +916,263 @@ int SockLib::startserver(const char* ip_addr, int port, int max_num_connections,
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * startepollserver
+ *
+ *  Same call-back interface as startserver, but the sockets are registered
+ *  once with an edge-triggered epoll instance instead of being rebuilt into
+ *  a poll list and scanned on every wakeup.  Because edges are reported only
+ *  once, readiness is latched per connection and cleared when a check of the
+ *  socket after the call-back shows it is no longer ready.  Setting reuse_port
+ *  allows several threads to each run a server on the same port, with the
+ *  kernel distributing the new connections between them.
+ *----------------------------------------------------------------------------*/
+int SockLib::startepollserver(const char* ip_addr, int port, int max_num_connections, onPollHandler_t on_poll, onActiveHandler_t on_act, bool* active, void* parm, bool* listening, bool reuse_port)
+{
+    int status = 0;
+
+    /* Initialize Connection Variables */
+    int num_connections = 0;
+    epoll_conn_t** connlist = new epoll_conn_t* [max_num_connections];
+    struct epoll_event* events = new struct epoll_event [EPOLL_MAX_EVENTS];
+    bool listener_ready = false;
+    bool busy = false;
+
+    /* Create Epoll Instance */
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd < 0)
+    {
+        dlog("Failed to create epoll instance for %s:%d, %s", ip_addr ? ip_addr : "0.0.0.0", port, strerror(errno));
+        delete [] connlist;
+        delete [] events;
+        return -1;
+    }
+
+    /* Create Listen Socket */
+    int listen_socket = sockcreate(SOCK_STREAM, ip_addr, port, true, NULL, reuse_port);
+    if(listen_socket >= 0)
+    {
+        /* Make Socket a Non-Blocking Listen Socket */
+        struct epoll_event listen_event;
+        listen_event.events = EPOLLIN | EPOLLET;
+        listen_event.data.ptr = NULL; // identifies the listener
+        if((listen(listen_socket, SOMAXCONN) == 0) &&
+           (socknonblock(listen_socket) == 0) &&
+           (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_socket, &listen_event) == 0))
+        {
+            listener_ready = true; // connections may have queued before registration
+            if(listening) *listening = true;
+        }
+        else
+        {
+            dlog("Failed to establish listen socket bound to %s:%d, %s", ip_addr ? ip_addr : "0.0.0.0", port, strerror(errno));
+            sockclose(listen_socket);
+            listen_socket = INVALID_RC;
+            status = -1;
+        }
+    }
+    else
+    {
+        dlog("Unable to establish socket server on %s:%d, failed to create listen socket", ip_addr ? ip_addr : "0.0.0.0", port);
+        listen_socket = INVALID_RC;
+        status = -1;
+    }
+
+    if(listen_socket != INVALID_RC)
+    {
+        try
+        {
+            /* Loop While Active */
+            while(*active)
+            {
+                /* Wait for Edges (do not block if latched work is outstanding) */
+                int num_events = 0;
+                do num_events = epoll_wait(epoll_fd, events, EPOLL_MAX_EVENTS, busy ? 0 : 100); // 10Hz
+                while(num_events == -1 && (errno == EINTR || errno == EAGAIN));
+
+                /* Latch Readiness */
+                for(int e = 0; e < num_events; e++)
+                {
+                    epoll_conn_t* conn = (epoll_conn_t*)events[e].data.ptr;
+                    if(conn == NULL)
+                    {
+                        listener_ready = true;
+                        continue;
+                    }
+                    if(events[e].events & EPOLLIN)  conn->readable = true;
+                    if(events[e].events & EPOLLOUT) conn->writable = true;
+                    if(events[e].events & EPOLLHUP) conn->hungup = true;
+                    if(events[e].events & EPOLLERR) conn->error = true;
+                }
+
+                /* Handle Existing Connections */
+                busy = false;
+                int i = 0;
+                while(i < num_connections)
+                {
+                    epoll_conn_t* conn = connlist[i];
+                    int cb_stat = 0;
+
+                    if(conn->error)
+                    {
+                        /* Check Error (error queue notifications, e.g. zerocopy completions, leave it clear) */
+                        int error = 0;
+                        socklen_t errlen = sizeof(error);
+                        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, (void *)&error, &errlen);
+                        if(error != 0)
+                        {
+                            dlog("Epoll error (%d) detected on server socket <%d>: %s", error, conn->fd, strerror(error));
+                            cb_stat = -1; // treat like a callback error or disconnect
+                        }
+                        conn->error = false;
+                    }
+
+                    if(cb_stat == 0)
+                    {
+                        /* Call Back for Active Connection */
+                        short wanted = 0;
+                        on_poll(conn->fd, &wanted, parm);
+                        int actevents = IO_ALIVE_FLAG;
+                        if((wanted & IO_READ_FLAG) && conn->readable) actevents |= IO_READ_FLAG;
+                        if((wanted & IO_WRITE_FLAG) && conn->writable) actevents |= IO_WRITE_FLAG;
+                        cb_stat = on_act(conn->fd, actevents, parm);
+
+                        /* Refresh Latched Readiness of Sockets that did I/O */
+                        if((cb_stat >= 0) && (actevents & (IO_READ_FLAG | IO_WRITE_FLAG)))
+                        {
+                            struct pollfd pfd = {conn->fd, POLLIN | POLLOUT, 0};
+                            if(poll(&pfd, 1, 0) >= 0)
+                            {
+                                conn->readable = (pfd.revents & POLLIN) != 0;
+                                conn->writable = (pfd.revents & POLLOUT) != 0;
+                                if(pfd.revents & POLLHUP) conn->hungup = true;
+                            }
+                        }
+
+                        /* Check for Work that Can Proceed Without a New Edge */
+                        if(cb_stat >= 0)
+                        {
+                            wanted = 0;
+                            on_poll(conn->fd, &wanted, parm);
+                            if(((wanted & IO_READ_FLAG) && conn->readable) ||
+                               ((wanted & IO_WRITE_FLAG) && conn->writable))
+                            {
+                                busy = true;
+                            }
+                        }
+                    }
+
+                    /* Handle Disconnections */
+                    if((cb_stat < 0) || conn->hungup)
+                    {
+                        /* Call Back for Disconnect */
+                        on_act(conn->fd, IO_DISCONNECT_FLAG, parm);
+                        sockclose(conn->fd); // closing removes it from the epoll set
+                        delete conn;
+
+                        /* Remove from List (order does not matter) */
+                        connlist[i] = connlist[--num_connections];
+                    }
+                    else
+                    {
+                        i++;
+                    }
+                }
+
+                /* Handle New Connections (edge triggered, so accept until drained) */
+                while(listener_ready && (num_connections < max_num_connections))
+                {
+                    client_address_t    client_address;
+                    socklen_t           address_length = sizeof(socket_address_t);
+
+                    int client_socket = accept(listen_socket, &client_address, &address_length);
+                    if(client_socket == -1)
+                    {
+                        if(errno == EAGAIN || errno == EWOULDBLOCK) listener_ready = false;
+                        else if(errno != EINTR && errno != ECONNABORTED)
+                        {
+                            dlog("Failed to accept connection on %s:%d, %s", ip_addr ? ip_addr : "0.0.0.0", port, strerror(errno));
+                            listener_ready = false;
+                        }
+                        continue;
+                    }
+
+                    /* Set Non-Blocking */
+                    if(socknonblock(client_socket) != 0)
+                    {
+                        dlog("Failed to set socket to non-blocking %s:%d", ip_addr ? ip_addr : "0.0.0.0", port);
+                        SockLib::sockclose(client_socket);
+                        continue;
+                    }
+
+                    /* Call On Activity Call-Back */
+                    if(on_act(client_socket, IO_CONNECT_FLAG, parm) < 0)
+                    {
+                        SockLib::sockclose(client_socket);
+                        continue;
+                    }
+
+                    /* Register Connection */
+                    epoll_conn_t* conn = new epoll_conn_t;
+                    conn->fd = client_socket;
+                    conn->readable = false;
+                    conn->writable = false;
+                    conn->hungup = false;
+                    conn->error = false;
+                    struct epoll_event client_event;
+                    client_event.events = EPOLLIN | EPOLLOUT | EPOLLET; // hang ups and errors are always reported
+                    client_event.data.ptr = conn;
+                    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_socket, &client_event) == 0)
+                    {
+                        connlist[num_connections++] = conn;
+                        busy = true; // make sure first pass over connection happens right away
+                    }
+                    else
+                    {
+                        dlog("Failed to register connection on %s:%d, %s", ip_addr ? ip_addr : "0.0.0.0", port, strerror(errno));
+                        on_act(client_socket, IO_DISCONNECT_FLAG, parm);
+                        SockLib::sockclose(client_socket);
+                        delete conn;
+                    }
+                }
+            }
+        }
+        catch(const std::exception& e)
+        {
+            dlog("Caught fatal exception, aborting http server thread: %s", e.what());
+            status = -1;
+        }
+
+        /* Close Listening Socket */
+        sockclose(listen_socket);
+        if(listening) *listening = false;
+    }
+
+    /* Disconnect Existing Connections */
+    for(int i = 0; i < num_connections; i++)
+    {
+        try
+        {
+            on_act(connlist[i]->fd, IO_DISCONNECT_FLAG, parm);
+        }
+        catch(const std::exception& e)
+        {
+            dlog("Caught exception on disconnect: %s", e.what());
+            status = -1;
+        }
+        sockclose(connlist[i]->fd);
+        delete connlist[i];
+    }
+
+    /* Clean Up Allocated Memory */
+    close(epoll_fd);
+    delete [] connlist;
+    delete [] events;
+
+    /* Return Status */
+    return status;
+}
+
 /*----------------------------------------------------------------------------
  * startclient
  *----------------------------------------------------------------------------*/
@@ -770,7 +1306,7 @@ const char* SockLib::sockipv4 (void)
 /*----------------------------------------------------------------------------
  * sockcreate
  *----------------------------------------------------------------------------*/
-int SockLib::sockcreate(int type, const char* ip_addr, int port, bool is_server, bool* block)
+int SockLib::sockcreate(int type, const char* ip_addr, int port, bool is_server, bool* block, bool reuse_port)
 {
     struct addrinfo     hints, *result, *rp;
     int                 sock = INVALID_RC;
@@ -813,7 +1349,7 @@ int SockLib::sockcreate(int type, const char* ip_addr, int port, bool is_server,
         if(is_server)
         {
             /* Set Reuse Option on Listen Socket */
-            if(sockreuse(sock) < 0)
+            if(sockreuse(sock, reuse_port) < 0)
             {
                 dlog("Failed to set reuse on socket %s:%s, %s", host, serv, strerror(errno));
                 close(sock);
@@ -924,7 +1460,7 @@ int SockLib::sockkeepalive(int socket_fd, int idle, int cnt, int intvl)
 /*----------------------------------------------------------------------------
  * sockreuse
  *----------------------------------------------------------------------------*/
-int SockLib::sockreuse(int socket_fd)
+int SockLib::sockreuse(int socket_fd, bool reuse_port)
 {
     int         optval;
     socklen_t   optlen = sizeof(optval);
@@ -936,6 +1472,15 @@ int SockLib::sockreuse(int socket_fd)
         return SOCK_ERR_RC;
     }
 
+    if(reuse_port) // allow multiple listeners to bind to the same port
+    {
+        if(setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, &optval, optlen) < 0)
+        {
+            dlog("Failed to set SO_REUSEPORT option on socket, %s", strerror(errno));
+            return SOCK_ERR_RC;
+        }
+    }
+
     return 0;
 }
 
@@ -32,6 +32,12 @@
 #ifndef __sock_lib__
 #define __sock_lib__
 
+/******************************************************************************
+ * FORWARD DECLARATIONS
+ ******************************************************************************/
+
+struct iovec;
+
 /******************************************************************************
  * SOCKET LIBRARY CLASS
  ******************************************************************************/
@@ -49,6 +55,8 @@ class SockLib
         static const int PORT_STR_LEN = 16;
         static const int HOST_STR_LEN = 64;
         static const int SERV_STR_LEN = 64;
+        static const int EPOLL_MAX_EVENTS = 256; // events returned per wakeup
+        static const int MAX_DGRAM_BATCH = 256; // datagrams per recvmmsg/sendmmsg call
 
         static void         init                (void); // initializes library
         static void         deinit              (void); // de-initializes library
@@ -56,24 +64,38 @@ class SockLib
         static int          sockstream          (const char* ip_addr, int port, bool is_server, bool* block);
         static int          sockdatagram        (const char* ip_addr, int port, bool is_server, bool* block, const char* multicast_group);
         static int          socksend            (int fd, const void* buf, int size, int timeout);
+        static int          socksendv           (int fd, const struct iovec* iov, int iovcnt, bool zerocopy=false);
+        static int          sockzerocopy        (int fd);
+        static int          sockzcreap          (int fd, uint32_t* completed);
         static int          sockrecv            (int fd, void* buf, int size, int timeout);
+        static int          sockrecvbatch       (int fd, void** bufs, int* sizes, int n, int timeout);
+        static int          socksendbatch       (int fd, const void** bufs, const int* sizes, int n, int timeout);
         static int          sockinfo            (int fd, char** local_ipaddr, int* local_port, char** remote_ipaddr, int* remote_port);
         static void         sockclose           (int fd);
         static int          startserver         (const char* ip_addr, int port, int max_num_connections, onPollHandler_t on_poll, onActiveHandler_t on_act, bool* active, void* parm, bool* listening=NULL);
+        static int          startepollserver    (const char* ip_addr, int port, int max_num_connections, onPollHandler_t on_poll, onActiveHandler_t on_act, bool* active, void* parm, bool* listening=NULL, bool reuse_port=false);
         static int          startclient         (const char* ip_addr, int port, int max_num_connections, onPollHandler_t on_poll, onActiveHandler_t on_act, bool* active, void* parm, bool* connected=NULL);
         static const char*  sockhost            (void);
         static const char*  sockipv4            (void);
 
     private:
 
+        typedef struct {
+            int             fd;
+            bool            readable; // latched from edge, cleared once drained
+            bool            writable; // latched from edge, cleared once full
+            bool            hungup;
+            bool            error;
+        } epoll_conn_t;
+
         static bool         signal_exit;
         static char         local_host_name[HOST_STR_LEN];
         static char         ipv4[IPV4_STR_LEN];
 
-        static int          sockcreate          (int type, const char* ip_addr, int port, bool is_server, bool* block);
+        static int          sockcreate          (int type, const char* ip_addr, int port, bool is_server, bool* block, bool reuse_port=false);
         static int          sockoptions         (int socket_fd, bool reuse, bool tcp);
         static int          sockkeepalive       (int socket_fd, int idle=60, int cnt=12, int intvl=5);
-        static int          sockreuse           (int socket_fd);
+        static int          sockreuse           (int socket_fd, bool reuse_port=false);
         static int          socknonblock        (int socket_fd);
         static int          sockmulticast       (int socket_fd, const char* group);
 };
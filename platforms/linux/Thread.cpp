@@ -39,6 +39,7 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -55,6 +56,17 @@
 #define gettid() syscall(SYS_gettid)
 #endif
 
+/******************************************************************************
+ * STATIC DATA
+ ******************************************************************************/
+
+pthread_once_t Thread::topologyOnce = PTHREAD_ONCE_INIT;
+int Thread::numNodes = 0;
+cpu_set_t Thread::nodeCpus[MAX_NODES];
+cpu_set_t Thread::processCpus;
+int Thread::nodeCursor = 0;
+Thread::placement_t Thread::placement = PLACE_ANY;
+
 /*****************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -65,15 +77,16 @@
 Thread::Thread(thread_func_t function, void* parm, bool _join)
 {
     join = _join;
-    pthread_attr_t pthread_attr;
-    pthread_attr_init(&pthread_attr);
-    if(!join) pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_DETACHED);
-    int ret = pthread_create(&threadId, &pthread_attr, function, parm);
-    if(ret != 0)
-    {
-        dlog("Failed to create thread (%d): %s", ret, strerror(ret));
-        throw std::runtime_error("pthread_create failed");
-    }
+    create(function, parm, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * Constructor
+ *----------------------------------------------------------------------------*/
+Thread::Thread(thread_func_t function, void* parm, const attr_t& attr, bool _join)
+{
+    join = _join;
+    create(function, parm, &attr);
 }
 
 /*----------------------------------------------------------------------------
@@ -122,3 +135,237 @@ void* Thread::getGlobal (key_t key)
 {
     return pthread_getspecific((pthread_key_t)key);
 }
+
+/*----------------------------------------------------------------------------
+ * getNumNodes
+ *
+ *  a machine without numa reports a single node holding every cpu
+ *----------------------------------------------------------------------------*/
+int Thread::getNumNodes (void)
+{
+    pthread_once(&topologyOnce, loadTopology);
+    return numNodes;
+}
+
+/*----------------------------------------------------------------------------
+ * getNode - node of the cpu the calling thread is running on
+ *----------------------------------------------------------------------------*/
+int Thread::getNode (void)
+{
+    pthread_once(&topologyOnce, loadTopology);
+    int cpu = sched_getcpu();
+    if(cpu >= 0 && cpu < CPU_SETSIZE)
+    {
+        for(int node = 0; node < numNodes; node++)
+        {
+            if(CPU_ISSET(cpu, &nodeCpus[node])) return node;
+        }
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ * nextNode - round robin over the nodes
+ *----------------------------------------------------------------------------*/
+int Thread::nextNode (void)
+{
+    pthread_once(&topologyOnce, loadTopology);
+    unsigned cursor = (unsigned)__atomic_fetch_add(&nodeCursor, 1, __ATOMIC_RELAXED);
+    return (int)(cursor % (unsigned)numNodes);
+}
+
+/*----------------------------------------------------------------------------
+ * bindNode
+ *
+ *  restricts the calling thread to the cpus of a node, or with ANY_NODE
+ *  restores the affinity the process started with; threads it creates
+ *  afterwards inherit the binding, and pages it first touches are placed
+ *  on the node by the kernel's default memory policy
+ *----------------------------------------------------------------------------*/
+bool Thread::bindNode (int node)
+{
+    pthread_once(&topologyOnce, loadTopology);
+    if(node != ANY_NODE && (node < 0 || node >= numNodes)) return false;
+    const cpu_set_t* cpus = (node == ANY_NODE) ? &processCpus : &nodeCpus[node];
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), cpus);
+    if(ret != 0)
+    {
+        dlog("Failed to bind thread to node %d (%d): %s", node, ret, strerror(ret));
+        return false;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * setPlacement
+ *----------------------------------------------------------------------------*/
+void Thread::setPlacement (placement_t policy)
+{
+    placement = policy;
+}
+
+/*----------------------------------------------------------------------------
+ * getPlacement
+ *----------------------------------------------------------------------------*/
+Thread::placement_t Thread::getPlacement (void)
+{
+    return placement;
+}
+
+/*****************************************************************************
+ * PRIVATE METHODS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * create
+ *----------------------------------------------------------------------------*/
+void Thread::create(thread_func_t function, void* parm, const attr_t* attr)
+{
+    pthread_attr_t pthread_attr;
+    pthread_attr_init(&pthread_attr);
+    if(!join) pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_DETACHED);
+
+    if(attr)
+    {
+        /* Stack Size */
+        if(attr->stack_size > 0)
+        {
+            int ret = pthread_attr_setstacksize(&pthread_attr, attr->stack_size);
+            if(ret != 0) dlog("Failed to set thread stack size to %ld (%d): %s", (long)attr->stack_size, ret, strerror(ret));
+        }
+
+        /* CPU Affinity */
+        const cpu_set_t* cpus = attr->cpus;
+        if(!cpus && attr->node != ANY_NODE)
+        {
+            if(attr->node >= 0 && attr->node < getNumNodes()) cpus = &nodeCpus[attr->node];
+            else dlog("Ignoring invalid numa node %d for thread", attr->node);
+        }
+        if(cpus)
+        {
+            int ret = pthread_attr_setaffinity_np(&pthread_attr, sizeof(cpu_set_t), cpus);
+            if(ret != 0) dlog("Failed to set thread affinity (%d): %s", ret, strerror(ret));
+        }
+    }
+
+    /* Name - set by the thread itself so it is in place before any of its work runs */
+    void* start_parm = parm;
+    thread_func_t start_function = function;
+    if(attr && attr->name)
+    {
+        start_t* start = new start_t;
+        start->function = function;
+        start->parm = parm;
+        snprintf(start->name, sizeof(start->name), "%s", attr->name);
+        start_parm = start;
+        start_function = startThread;
+    }
+
+    int ret = pthread_create(&threadId, &pthread_attr, start_function, start_parm);
+    if(ret == EINVAL && attr && attr->cpus)
+    {
+        /* Retry Without Affinity - cpu set holds no cpus the process can use */
+        dlog("Failed to create thread on requested cpus, creating it without affinity");
+        pthread_attr_destroy(&pthread_attr);
+        pthread_attr_init(&pthread_attr);
+        if(!join) pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_DETACHED);
+        if(attr->stack_size > 0) pthread_attr_setstacksize(&pthread_attr, attr->stack_size);
+        ret = pthread_create(&threadId, &pthread_attr, start_function, start_parm);
+    }
+    pthread_attr_destroy(&pthread_attr);
+
+    if(ret != 0)
+    {
+        if(start_parm != parm) delete (start_t*)start_parm;
+        dlog("Failed to create thread (%d): %s", ret, strerror(ret));
+        throw std::runtime_error("pthread_create failed");
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * startThread
+ *----------------------------------------------------------------------------*/
+void* Thread::startThread (void* parm)
+{
+    start_t* start = (start_t*)parm;
+    thread_func_t function = start->function;
+    void* function_parm = start->parm;
+    pthread_setname_np(pthread_self(), start->name);
+    delete start;
+    return function(function_parm);
+}
+
+/*----------------------------------------------------------------------------
+ * loadTopology
+ *
+ *  nodes are read from sysfs rather than through libnuma; only cpus the
+ *  process is allowed to run on are kept, and nodes left without any are
+ *  dropped so that every node index can be bound to
+ *----------------------------------------------------------------------------*/
+void Thread::loadTopology (void)
+{
+    CPU_ZERO(&processCpus);
+    if(sched_getaffinity(0, sizeof(cpu_set_t), &processCpus) != 0)
+    {
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &processCpus);
+    }
+
+    numNodes = 0;
+    for(int node = 0; node < MAX_NODES * 4 && numNodes < MAX_NODES; node++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* fp = fopen(path, "r");
+        if(!fp) continue;
+
+        char list[1024];
+        bool valid = fgets(list, sizeof(list), fp) != NULL;
+        fclose(fp);
+
+        cpu_set_t cpus;
+        if(valid && parseCpuList(list, &cpus))
+        {
+            CPU_AND(&cpus, &cpus, &processCpus);
+            if(CPU_COUNT(&cpus) > 0)
+            {
+                nodeCpus[numNodes++] = cpus;
+            }
+        }
+    }
+
+    if(numNodes == 0)
+    {
+        nodeCpus[0] = processCpus;
+        numNodes = 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * parseCpuList - e.g. "0-15,32-47"
+ *----------------------------------------------------------------------------*/
+bool Thread::parseCpuList (const char* list, cpu_set_t* cpus)
+{
+    CPU_ZERO(cpus);
+    const char* p = list;
+    while(*p && *p != '\n')
+    {
+        char* end = NULL;
+        long first = strtol(p, &end, 10);
+        if(end == p) return false;
+        long last = first;
+        p = end;
+        if(*p == '-')
+        {
+            p++;
+            last = strtol(p, &end, 10);
+            if(end == p) return false;
+            p = end;
+        }
+        for(long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+        {
+            if(cpu >= 0) CPU_SET(cpu, cpus);
+        }
+        if(*p == ',') p++;
+    }
+    return true;
+}
@@ -37,6 +37,8 @@
  ******************************************************************************/
 
 #include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
 
 /******************************************************************************
  * THREAD CLASS
@@ -50,7 +52,24 @@ class Thread
 
         typedef void* (*thread_func_t) (void* parm);
 
+        static const int ANY_NODE = -1;
+        static const int MAX_NODES = 64;
+        static const int MAX_NAME_LEN = 15; // longer names are truncated
+
+        typedef enum {
+            PLACE_ANY   = 0,    // threads run wherever the scheduler puts them
+            PLACE_NODE  = 1     // each request runs on one numa node, round robin
+        } placement_t;
+
+        typedef struct {
+            const char*         name;       // NULL inherits the creator's name
+            int                 node;       // ANY_NODE inherits the creator's affinity
+            const cpu_set_t*    cpus;       // NULL for the node's cpus; overrides node
+            size_t              stack_size; // 0 for the system default
+        } attr_t;
+
         Thread (thread_func_t function, void* parm, bool _join=true);
+        Thread (thread_func_t function, void* parm, const attr_t& attr, bool _join=true);
         ~Thread (void); // performs join
 
         static long         getId               (void);
@@ -58,10 +77,35 @@ class Thread
         static int          setGlobal           (key_t key, void* value);
         static void*        getGlobal           (key_t key);
 
+        static int          getNumNodes         (void);
+        static int          getNode             (void);
+        static int          nextNode            (void);
+        static bool         bindNode            (int node);
+        static void         setPlacement        (placement_t policy);
+        static placement_t  getPlacement        (void);
+
     private:
 
+        typedef struct {
+            thread_func_t       function;
+            void*               parm;
+            char                name[MAX_NAME_LEN + 1];
+        } start_t;
+
+        static pthread_once_t   topologyOnce;
+        static int              numNodes;
+        static cpu_set_t        nodeCpus[MAX_NODES];
+        static cpu_set_t        processCpus;
+        static int              nodeCursor;
+        static placement_t      placement;
+
         pthread_t threadId;
         bool join;
+
+        void                create              (thread_func_t function, void* parm, const attr_t* attr);
+        static void*        startThread         (void* parm);
+        static void         loadTopology        (void);
+        static bool         parseCpuList        (const char* list, cpu_set_t* cpus);
 };
 
 #endif  /* __thread__ */
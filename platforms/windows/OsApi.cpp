@@ -117,7 +117,7 @@ Thread::~Thread()
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Mutex::Mutex()
+Mutex::Mutex(const char* _name)
 {
     InitializeCriticalSectionAndSpinCount(&mutexId, 0x00000400);
 }
@@ -153,7 +153,7 @@ void Mutex::unlock(void)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Cond::Cond(int num_sigs): Mutex()
+Cond::Cond(int num_sigs, const char* _name): Mutex(_name)
 {
     assert(num_sigs > 0);
     numSigs = num_sigs;
@@ -147,7 +147,7 @@ class Mutex
 {
     public:
 
-        Mutex (void);
+        Mutex (const char* _name=NULL); // name is unused
         ~Mutex (void);
 
         void lock (void);
@@ -171,7 +171,7 @@ class Cond : public Mutex
             NOTIFY_ALL
         } notify_t;
 
-        Cond    (int num_sigs = 1);
+        Cond    (int num_sigs = 1, const char* _name = NULL);
         ~Cond   (void);
 
         void signal(int sig = 0, notify_t notify = NOTIFY_ALL);
@@ -131,9 +131,9 @@ void ArcticDemStripsRaster::getIndexBbox(bbox_t &bbox, double lon, double lat)
 
 
 /*----------------------------------------------------------------------------
- * findRasters
+ * getFeatureRaster
  *----------------------------------------------------------------------------*/
-bool ArcticDemStripsRaster::findRasters(OGRPoint& p)
+bool ArcticDemStripsRaster::getFeatureRaster(OGRFeature* feature, raster_info_t& rinfo)
 {
     /*
      * Could get date from filename but will read from geojson index file instead.
@@ -146,89 +146,64 @@ bool ArcticDemStripsRaster::findRasters(OGRPoint& p)
      *
      */
 
-    bool foundFile = false;
-
     const std::string fileToken  = "arcticdem";
     const std::string vsisPath   = "/vsis3/pgc-opendata-dems/";
     const char* demField         = "dem";
     const int DATES_CNT          = 2;
     const char* dates[DATES_CNT] = {"start_datetime", "end_datetime"};
-    try
-    {
-        rastersList->clear();
 
-        /* For now assume the first layer has the feature we need */
-        layer->ResetReading();
-        while (OGRFeature* feature = layer->GetNextFeature())
-        {
-            OGRGeometry *geo = feature->GetGeometryRef();
-            CHECKPTR(geo);
+    const char *fname = feature->GetFieldAsString(demField);
+    if (fname == NULL)
+        return false;
+
+    std::string fileName(fname);
+    std::size_t pos = fileName.find(fileToken);
+    if (pos == std::string::npos)
+        throw RunTimeException(DEBUG, RTE_ERROR, "Could not find marker %s in file", fileToken.c_str());
+
+    fileName = vsisPath + fileName.substr(pos);
+
+    rinfo.fileName = fileName;
+    bzero(&rinfo.gmtDate, sizeof(TimeLib::gmt_time_t));
 
-            if(!geo->Contains(&p)) continue;
+    const std::string endToken    = "_dem.tif";
+    const std::string newEndToken = "_bitmask.tif";
+    pos = fileName.rfind(endToken);
+    if (pos != std::string::npos)
+    {
+        fileName.replace(pos, endToken.length(), newEndToken.c_str());
+    } else fileName.clear();
+    rinfo.auxFileName = fileName;
+
+    double gpsTime = 0;
+    for(int i=0; i<DATES_CNT; i++)
+    {
+        TimeLib::gmt_time_t gmtDate;
+        int year, month, day, hour, minute, second, timeZone;
+        bzero(&gmtDate, sizeof(TimeLib::gmt_time_t));
+        year = month = day = hour = minute = second = timeZone = 0;
 
-            const char *fname = feature->GetFieldAsString(demField);
-            if (fname)
+        int j = feature->GetFieldIndex(dates[i]);
+        if(feature->GetFieldAsDateTime(j, &year, &month, &day, &hour, &minute, &second, &timeZone))
+        {
+            /* Time Zone flag: 100 is GMT, 1 is localtime, 0 unknown */
+            if(timeZone == 100)
             {
-                std::string fileName(fname);
-                std::size_t pos = fileName.find(fileToken);
-                if (pos == std::string::npos)
-                    throw RunTimeException(DEBUG, RTE_ERROR, "Could not find marker %s in file", fileToken.c_str());
-
-                fileName = vsisPath + fileName.substr(pos);
-                foundFile = true; /* There may be more than one file.. */
-
-                raster_info_t rinfo;
-                rinfo.fileName = fileName;
-                bzero(&rinfo.gmtDate, sizeof(TimeLib::gmt_time_t));
-
-                const std::string endToken    = "_dem.tif";
-                const std::string newEndToken = "_bitmask.tif";
-                pos = fileName.rfind(endToken);
-                if (pos != std::string::npos)
-                {
-                    fileName.replace(pos, endToken.length(), newEndToken.c_str());
-                } else fileName.clear();
-                rinfo.auxFileName = fileName;
-
-                double gpsTime = 0;
-                for(int i=0; i<DATES_CNT; i++)
-                {
-                    TimeLib::gmt_time_t gmtDate;
-                    int year, month, day, hour, minute, second, timeZone;
-                    bzero(&gmtDate, sizeof(TimeLib::gmt_time_t));
-                    year = month = day = hour = minute = second = timeZone = 0;
-
-                    int j = feature->GetFieldIndex(dates[i]);
-                    if(feature->GetFieldAsDateTime(j, &year, &month, &day, &hour, &minute, &second, &timeZone))
-                    {
-                        /* Time Zone flag: 100 is GMT, 1 is localtime, 0 unknown */
-                        if(timeZone == 100)
-                        {
-                            gmtDate.year        = year;
-                            gmtDate.doy         = TimeLib::dayofyear(year, month, day);
-                            gmtDate.hour        = hour;
-                            gmtDate.minute      = minute;
-                            gmtDate.second      = second;
-                            gmtDate.millisecond = 0;
-                        }
-                        else mlog(ERROR, "Unsuported time zone in raster date (TMZ is not GMT)");
-                    }
-                    /* mlog(DEBUG, "%d:%d:%d:%d:%d:%d  %s", year, month, day, hour, minute, second, rinfo.fileName.c_str()); */
-                    gpsTime += static_cast<double>(TimeLib::gmt2gpstime(gmtDate));
-                }
-                rinfo.gmtDate = TimeLib::gps2gmttime(static_cast<int64_t>(gpsTime/DATES_CNT));
-                rastersList->add(rinfo);
+                gmtDate.year        = year;
+                gmtDate.doy         = TimeLib::dayofyear(year, month, day);
+                gmtDate.hour        = hour;
+                gmtDate.minute      = minute;
+                gmtDate.second      = second;
+                gmtDate.millisecond = 0;
             }
-            OGRFeature::DestroyFeature(feature);
+            else mlog(ERROR, "Unsuported time zone in raster date (TMZ is not GMT)");
         }
-        mlog(DEBUG, "Found %d rasters for (%.2lf, %.2lf)", rastersList->length(), p.getX(), p.getY());
-    }
-    catch (const RunTimeException &e)
-    {
-        mlog(e.level(), "Error getting time from raster feature file: %s", e.what());
+        /* mlog(DEBUG, "%d:%d:%d:%d:%d:%d  %s", year, month, day, hour, minute, second, rinfo.fileName.c_str()); */
+        gpsTime += static_cast<double>(TimeLib::gmt2gpstime(gmtDate));
     }
+    rinfo.gmtDate = TimeLib::gps2gmttime(static_cast<int64_t>(gpsTime/DATES_CNT));
 
-    return foundFile;
+    return true;
 }
 
 
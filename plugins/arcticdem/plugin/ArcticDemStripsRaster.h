@@ -68,7 +68,7 @@ class ArcticDemStripsRaster: public VctRaster
 ;
         void    getIndexFile          (std::string& file, double lon=0, double lat=0 );
         void    getIndexBbox          (bbox_t& bbox, double lon=0, double lat=0);
-        bool    findRasters           (OGRPoint &p);
+        bool    getFeatureRaster      (OGRFeature* feature, raster_info_t& rinfo);
 };
 
 #endif  /* __arcticdem_strips_raster__ */
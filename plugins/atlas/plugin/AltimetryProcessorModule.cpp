@@ -58,7 +58,7 @@ const char* AltimetryProcessorModule::alignHistKey             = "alignHist";
 /*----------------------------------------------------------------------------
  * Constructor  -
  *----------------------------------------------------------------------------*/
-AltimetryProcessorModule::AltimetryProcessorModule(CommandProcessor* cmd_proc, const char* obj_name, int _pce, AltimetryHistogram::type_t _type, const char* histq_name):
+AltimetryProcessorModule::AltimetryProcessorModule(CommandProcessor* cmd_proc, const char* obj_name, int _pce, AltimetryHistogram::type_t _type, const char* histq_name, int num_workers):
     CcsdsProcessorModule(cmd_proc, obj_name),
     pce(_pce),
     type(_type)
@@ -68,6 +68,34 @@ AltimetryProcessorModule::AltimetryProcessorModule(CommandProcessor* cmd_proc, c
     /* Create MsgQ */
     histQ = new Publisher(histq_name);
 
+    /* Initialize Number of Workers */
+    if(num_workers < 0 || num_workers > MAX_HIST_WORKERS)
+    {
+        mlog(CRITICAL, "invalid number of histogram workers specified: %d, setting to %d", num_workers, DEFAULT_HIST_WORKERS);
+        numHistWorkers = DEFAULT_HIST_WORKERS;
+    }
+    else
+    {
+        numHistWorkers = num_workers;
+    }
+
+    /* Create and Start Histogram Workers - each with its own ordered queue */
+    nextSeq = 0;
+    nextPost = 0;
+    workersActive = true;
+    histWorkers = NULL;
+    if(numHistWorkers > 0)
+    {
+        histWorkers = new histWorker_t[numHistWorkers];
+        for(int i = 0; i < numHistWorkers; i++)
+        {
+            histWorkers[i].module = this;
+            histWorkers[i].pubq = new Publisher(NULL);
+            histWorkers[i].subq = new Subscriber(*histWorkers[i].pubq);
+            histWorkers[i].pid = new Thread(histWorkerThread, &histWorkers[i]);
+        }
+    }
+
     /* Initialize Parameters */
     alignHistograms        = false;
     fullColumnIntegration  = false;
@@ -93,6 +121,36 @@ AltimetryProcessorModule::AltimetryProcessorModule(CommandProcessor* cmd_proc, c
  *----------------------------------------------------------------------------*/
 AltimetryProcessorModule::~AltimetryProcessorModule(void)
 {
+    /* Join Workers */
+    workersActive = false;
+    for(int i = 0; i < numHistWorkers; i++)
+    {
+        delete histWorkers[i].pid;
+    }
+
+    /* Free Histograms Never Processed */
+    for(int i = 0; i < numHistWorkers; i++)
+    {
+        Subscriber::msgRef_t ref;
+        while(histWorkers[i].subq->receiveRef(ref, IO_CHECK) > 0)
+        {
+            delete ((histJob_t*)ref.data)->hist;
+            histWorkers[i].subq->dereference(ref);
+        }
+        delete histWorkers[i].subq;
+        delete histWorkers[i].pubq;
+    }
+    delete [] histWorkers;
+
+    /* Free Histograms Never Posted */
+    AltimetryHistogram* hist;
+    long seq = completedHists.first(&hist);
+    while(seq != (long)INVALID_KEY)
+    {
+        delete hist;
+        seq = completedHists.next(&hist);
+    }
+
     if(majorFrameProcName) delete [] majorFrameProcName;
     delete histQ;
 }
@@ -112,6 +170,12 @@ CommandableObject* AltimetryProcessorModule::createObject(CommandProcessor* cmd_
     AtlasHistogram::type_t  type        = AtlasHistogram::str2type(argv[0]);
     const char*             histq_name  = StringLib::checkNullStr(argv[1]);
     int                     pce         = (int)strtol(argv[2], NULL, 0) - 1;
+    int                     num_workers = DEFAULT_HIST_WORKERS;
+
+    if(argc > 3)
+    {
+        num_workers = (int)strtol(argv[3], NULL, 0);
+    }
 
     if(pce < 0 || pce >= NUM_PCES)
     {
@@ -131,7 +195,7 @@ CommandableObject* AltimetryProcessorModule::createObject(CommandProcessor* cmd_
         return NULL;
     }
 
-    return new AltimetryProcessorModule(cmd_proc, name, pce, type, histq_name);
+    return new AltimetryProcessorModule(cmd_proc, name, pce, type, histq_name, num_workers);
 }
 
 /******************************************************************************
@@ -251,56 +315,29 @@ bool AltimetryProcessorModule::parseAltHist(List<CcsdsSpacePacket*>& segments, i
         }
     }
 
-    /* Process Entire Packet */
-    bool sigfound = hist->calcAttributes(0.0, trueRulerClkPeriod);
-    if(!sigfound)
-    {
-        mlog(WARNING, "[%08lX]: could not find signal in altimetric histogram data", hist->getMajorFrameCounter());
-    }
-
-    /* Use Major Frame Data */
-    if(mfdata_ptr != NULL)
+    /* Collect Major Frame Checks */
+    histJob_t job;
+    job.hist        = hist;
+    job.mfvalid     = mfdata_ptr != NULL;
+    job.checkrw     = job.mfvalid && numpkts == 1; // only works if not integrating
+    job.txcnt       = job.mfvalid ? mfdata.TxPulsesInMajorFrame : 0;
+    job.dfc_rws     = 0.0;
+    job.dfc_rww     = 0.0;
+    job.pkt_errors  = pkt_errors;
+    if(job.checkrw)
     {
-        /* Set Transmit Count */
-        hist->setTransmitCount(mfdata.TxPulsesInMajorFrame);
-
-        if(numpkts == 1) // only works if not integrating
-        {
-            /* Check Range Window Start */
-            double dfc_rws = 0.0;
-            if      (type == AtlasHistogram::SAL)   dfc_rws = mfdata.StrongAltimetricRangeWindowStart * trueRulerClkPeriod;
-            else if (type == AtlasHistogram::WAL)   dfc_rws = mfdata.WeakAltimetricRangeWindowStart * trueRulerClkPeriod;
+        if      (type == AtlasHistogram::SAL)   job.dfc_rws = mfdata.StrongAltimetricRangeWindowStart * trueRulerClkPeriod;
+        else if (type == AtlasHistogram::WAL)   job.dfc_rws = mfdata.WeakAltimetricRangeWindowStart * trueRulerClkPeriod;
 
-            if(dfc_rws != hist->getRangeWindowStart())
-            {
-                mlog(ERROR, "[%08lX]: %s alimteric range window start did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), hist->getRangeWindowStart(), dfc_rws);
-                pkt_errors++;
-            }
-
-            /* Check Range Window Width */
-            double dfc_rww = 0.0;
-            if      (type == AtlasHistogram::SAL)   dfc_rww = mfdata.StrongAltimetricRangeWindowWidth * trueRulerClkPeriod;
-            else if (type == AtlasHistogram::WAL)   dfc_rww = mfdata.WeakAltimetricRangeWindowWidth * trueRulerClkPeriod;
-
-            if(dfc_rww != hist->getRangeWindowWidth())
-            {
-                mlog(ERROR, "[%08lX]: %s alimteric range window width did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), hist->getRangeWindowWidth(), dfc_rww);
-                pkt_errors++;
-            }
-        }
+        if      (type == AtlasHistogram::SAL)   job.dfc_rww = mfdata.StrongAltimetricRangeWindowWidth * trueRulerClkPeriod;
+        else if (type == AtlasHistogram::WAL)   job.dfc_rww = mfdata.WeakAltimetricRangeWindowWidth * trueRulerClkPeriod;
     }
 
     /* Copy In Stats */
-    hist->setPktErrors(pkt_errors);
     hist->setPktBytes(pkt_bytes);
 
-    /* Post Histogram */
-    unsigned char* buffer; // reference to serial buffer
-    int size = hist->serialize(&buffer, RecordObject::REFERENCE);
-    histQ->postCopy(buffer, size);
-    delete hist;
-
-    return true;
+    /* Find Signal and Post Histogram */
+    return submitHistogram(job, numpkts);
 }
 
 /*----------------------------------------------------------------------------
@@ -368,56 +405,181 @@ bool AltimetryProcessorModule::parseAtmHist(List<CcsdsSpacePacket*>& segments, i
         }
     }
 
-    /* Process Packet */
+    /* Collect Major Frame Checks */
+    histJob_t job;
+    job.hist        = hist;
+    job.mfvalid     = mfdata_ptr != NULL;
+    job.checkrw     = job.mfvalid && numpkts == 1; // only works if not integrating
+    job.txcnt       = job.mfvalid ? mfdata.TxPulsesInMajorFrame : 0;
+    job.dfc_rws     = 0.0;
+    job.dfc_rww     = 0.0;
+    job.pkt_errors  = pkt_errors;
+    if(job.checkrw)
+    {
+        if      (type == AtlasHistogram::SAM)   job.dfc_rws = (mfdata.StrongAtmosphericRangeWindowStart + 13) * trueRulerClkPeriod;
+        else if (type == AtlasHistogram::WAM)   job.dfc_rws = (mfdata.WeakAtmosphericRangeWindowStart + 13) * trueRulerClkPeriod;
+
+        if      (type == AtlasHistogram::SAM)   job.dfc_rww = (mfdata.StrongAtmosphericRangeWindowWidth + 1) * trueRulerClkPeriod;
+        else if (type == AtlasHistogram::WAM)   job.dfc_rww = (mfdata.WeakAtmosphericRangeWindowWidth + 1) * trueRulerClkPeriod;
+    }
+
+    /* Copy In Stats */
+    hist->setPktBytes(pkt_bytes);
+
+    /* Find Signal and Post Histogram */
+    return submitHistogram(job, numpkts);
+}
+
+/*----------------------------------------------------------------------------
+ * submitHistogram  - hands built histogram to the worker keyed by its major
+ *                    frame; signal finding runs there and the result is
+ *                    posted in the order histograms were built
+ *----------------------------------------------------------------------------*/
+bool AltimetryProcessorModule::submitHistogram(histJob_t& job, int numpkts)
+{
+    /* Assign Sequence */
+    postMut.lock();
+    {
+        job.seq = nextSeq++;
+    }
+    postMut.unlock();
+
+    /* Process Inline */
+    if(numHistWorkers == 0)
+    {
+        completeHistogram(job);
+        return true;
+    }
+
+    /* Queue Job to Worker Keyed by Major Frame */
+    long mfc = job.hist->getMajorFrameCounter() / MAX(numpkts, 1);
+    Publisher* pubq = histWorkers[mfc % numHistWorkers].pubq;
+    int status = MsgQ::STATE_TIMEOUT;
+    while(workersActive && status == MsgQ::STATE_TIMEOUT)
+    {
+        status = pubq->postCopy(&job, sizeof(job), SYS_TIMEOUT);
+    }
+    if(status <= 0)
+    {
+        mlog(CRITICAL, "%s failed (%d) to queue histogram [%08lX] to worker", getName(), status, job.hist->getMajorFrameCounter());
+        postHistogram(NULL, job.seq); // keeps later histograms from waiting on this one
+        delete job.hist;
+        return false;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------
+ * completeHistogram  - finds signal, checks range window against hardware,
+ *                      and posts histogram
+ *----------------------------------------------------------------------------*/
+void AltimetryProcessorModule::completeHistogram(histJob_t& job)
+{
+    AltimetryHistogram* hist = job.hist;
+    bool altimetric = (type == AtlasHistogram::SAL || type == AtlasHistogram::WAL);
+
+    /* Process Entire Packet */
     bool sigfound = hist->calcAttributes(0.0, trueRulerClkPeriod);
     if(!sigfound)
     {
-        mlog(WARNING, "[%08lX]: could not find signal in atmospheric histogram data", hist->getMajorFrameCounter());
+        mlog(WARNING, "[%08lX]: could not find signal in %s histogram data", hist->getMajorFrameCounter(), altimetric ? "altimetric" : "atmospheric");
     }
 
     /* Use Major Frame Data */
-    if(mfdata_ptr != NULL)
+    if(job.mfvalid)
     {
         /* Set Transmit Count */
-        hist->setTransmitCount(mfdata.TxPulsesInMajorFrame);
+        hist->setTransmitCount(job.txcnt);
 
-        if(numpkts == 1) // only works if not integrating
+        if(job.checkrw)
         {
             /* Check Range Window Start */
-            double dfc_rws = 0.0;
-            if      (type == AtlasHistogram::SAM)   dfc_rws = (mfdata.StrongAtmosphericRangeWindowStart + 13) * trueRulerClkPeriod;
-            else if (type == AtlasHistogram::WAM)   dfc_rws = (mfdata.WeakAtmosphericRangeWindowStart + 13) * trueRulerClkPeriod;
-
-            if(dfc_rws != hist->getRangeWindowStart())
+            if(job.dfc_rws != hist->getRangeWindowStart())
             {
-                mlog(ERROR, "[%08lX]: %s atmospheric range window start did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), hist->getRangeWindowStart(), dfc_rws);
-                pkt_errors++;
+                mlog(ERROR, "[%08lX]: %s %s range window start did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), altimetric ? "alimteric" : "atmospheric", hist->getRangeWindowStart(), job.dfc_rws);
+                job.pkt_errors++;
             }
 
             /* Check Range Window Width */
-            double dfc_rww = 0.0;
-            if      (type == AtlasHistogram::SAM)   dfc_rww = (mfdata.StrongAtmosphericRangeWindowWidth + 1) * trueRulerClkPeriod;
-            else if (type == AtlasHistogram::WAM)   dfc_rww = (mfdata.WeakAtmosphericRangeWindowWidth + 1) * trueRulerClkPeriod;
-
-            if(dfc_rww != hist->getRangeWindowWidth())
+            if(job.dfc_rww != hist->getRangeWindowWidth())
             {
-                mlog(ERROR, "[%08lX]: %s atmospheric range window width did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), hist->getRangeWindowWidth(), dfc_rww);
-                pkt_errors++;
+                mlog(ERROR, "[%08lX]: %s %s range window width did not match value reported by hardware, FSW: %.1lf, DFC: %.1lf", hist->getMajorFrameCounter(), AtlasHistogram::type2str(type), altimetric ? "alimteric" : "atmospheric", hist->getRangeWindowWidth(), job.dfc_rww);
+                job.pkt_errors++;
             }
         }
     }
 
     /* Copy In Stats */
-    hist->setPktErrors(pkt_errors);
-    hist->setPktBytes(pkt_bytes);
+    hist->setPktErrors(job.pkt_errors);
 
     /* Post Histogram */
-    unsigned char* buffer; // reference to serial buffer
-    int size = hist->serialize(&buffer, RecordObject::REFERENCE);
-    histQ->postCopy(buffer, size);
-    delete hist;
+    postHistogram(hist, job.seq);
+}
 
-    return true;
+/*----------------------------------------------------------------------------
+ * postHistogram  - posts histogram once every histogram before it has been
+ *                  posted, holding it until then; a NULL histogram marks a
+ *                  sequence that was dropped
+ *----------------------------------------------------------------------------*/
+void AltimetryProcessorModule::postHistogram(AltimetryHistogram* hist, long seq)
+{
+    postMut.lock();
+    {
+        /* Hold Until Its Turn */
+        if(seq != nextPost)
+        {
+            completedHists.add(seq, hist);
+            hist = NULL;
+            seq = -1;
+        }
+
+        /* Post In Order */
+        while(seq == nextPost)
+        {
+            if(hist)
+            {
+                unsigned char* buffer; // reference to serial buffer
+                int size = hist->serialize(&buffer, RecordObject::REFERENCE);
+                histQ->postCopy(buffer, size);
+                delete hist;
+            }
+            nextPost++;
+
+            /* Get Next Held Histogram */
+            seq = completedHists.first(&hist);
+            if(seq == nextPost) completedHists.remove(seq);
+        }
+    }
+    postMut.unlock();
+}
+
+/*----------------------------------------------------------------------------
+ * histWorkerThread  -
+ *----------------------------------------------------------------------------*/
+void* AltimetryProcessorModule::histWorkerThread(void* parm)
+{
+    histWorker_t* worker = (histWorker_t*)parm;
+
+    while(worker->module->workersActive)
+    {
+        /* Wait for Histogram */
+        Subscriber::msgRef_t ref;
+        int status = worker->subq->receiveRef(ref, SYS_TIMEOUT);
+        if(status == MsgQ::STATE_TIMEOUT) continue;
+        else if(status <= 0)
+        {
+            mlog(CRITICAL, "Failed (%d) to receive histogram ...exiting thread!", status);
+            break;
+        }
+
+        /* Find Signal and Post */
+        histJob_t* job = (histJob_t*)ref.data;
+        worker->module->completeHistogram(*job);
+        worker->subq->dereference(ref);
+    }
+
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------
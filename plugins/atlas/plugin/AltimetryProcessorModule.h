@@ -50,6 +50,8 @@ class AltimetryProcessorModule: public CcsdsProcessorModule
         static const int    NUM_ALT_BINS_PER_PKT    = 500;
         static const int    NUM_ATM_BINS_PER_PKT    = 467;
         static const int    NUM_ALT_SEGS_PER_PKT    = 4;
+        static const int    DEFAULT_HIST_WORKERS    = 4;
+        static const int    MAX_HIST_WORKERS        = 16;
 
         static const double ALT_BINSIZE;
         static const double ATM_BINSIZE;
@@ -62,18 +64,47 @@ class AltimetryProcessorModule: public CcsdsProcessorModule
          * Methods
          *--------------------------------------------------------------------*/
 
-                        AltimetryProcessorModule  (CommandProcessor* cmd_proc, const char* obj_name, int _pce, AltimetryHistogram::type_t _type, const char* histq_name);
+                        AltimetryProcessorModule  (CommandProcessor* cmd_proc, const char* obj_name, int _pce, AltimetryHistogram::type_t _type, const char* histq_name, int num_workers=DEFAULT_HIST_WORKERS);
                         ~AltimetryProcessorModule (void);
 
         static  CommandableObject* createObject (CommandProcessor* cmd_proc, const char* name, int argc, char argv[][MAX_CMD_SIZE]);
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        typedef struct {
+            AltimetryHistogram*         hist;
+            long                        seq;        // order histogram is posted in
+            bool                        mfvalid;    // major frame data associated with histogram
+            bool                        checkrw;    // compare range window to hardware (only when not integrating)
+            int                         txcnt;
+            double                      dfc_rws;    // range window start reported by hardware
+            double                      dfc_rww;    // range window width reported by hardware
+            int                         pkt_errors;
+        } histJob_t;
+
+        typedef struct {
+            AltimetryProcessorModule*   module;
+            Publisher*                  pubq;       // jobs for major frames keyed to worker
+            Subscriber*                 subq;
+            Thread*                     pid;
+        } histWorker_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
         Publisher*                  histQ;  // output histograms
+        int                         numHistWorkers;     // zero processes histograms inline
+        bool                        workersActive;
+        histWorker_t*               histWorkers;
+        Mutex                       postMut;
+        long                        nextSeq;            // assigned to next histogram built
+        long                        nextPost;           // sequence of next histogram to post
+        Ordering<AltimetryHistogram*, long> completedHists; // finished out of order, waiting to be posted
         int                         pce;
         AltimetryHistogram::type_t  type;
 
@@ -89,6 +120,11 @@ class AltimetryProcessorModule: public CcsdsProcessorModule
         bool    processSegments     (List<CcsdsSpacePacket*>& segments, int numpkts);
         bool    parseAltHist        (List<CcsdsSpacePacket*>& segments, int numpkts);
         bool    parseAtmHist        (List<CcsdsSpacePacket*>& segments, int numpkts);
+        bool    submitHistogram     (histJob_t& job, int numpkts);
+        void    completeHistogram   (histJob_t& job);
+        void    postHistogram       (AltimetryHistogram* hist, long seq);
+
+        static void* histWorkerThread (void* parm);
 
         int     alignHistsCmd       (int argc, char argv[][MAX_CMD_SIZE]);
         int     fullColumnModeCmd   (int argc, char argv[][MAX_CMD_SIZE]);
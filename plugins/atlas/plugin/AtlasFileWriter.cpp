@@ -52,8 +52,8 @@
 /*----------------------------------------------------------------------------
  * Constructor  -
  *----------------------------------------------------------------------------*/
-AtlasFileWriter::AtlasFileWriter(CommandProcessor* cmd_proc, const char* obj_name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _max_file_size):
-    CcsdsFileWriter(cmd_proc, obj_name, CcsdsFileWriter::USER_DEFINED, _prefix, inq_name, _max_file_size)
+AtlasFileWriter::AtlasFileWriter(CommandProcessor* cmd_proc, const char* obj_name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _max_file_size, File::io_t _io):
+    CcsdsFileWriter(cmd_proc, obj_name, CcsdsFileWriter::USER_DEFINED, _prefix, inq_name, _max_file_size, _io)
 {
     fmt = _fmt;
 }
@@ -83,13 +83,24 @@ CommandableObject* AtlasFileWriter::createObject(CommandProcessor* cmd_proc, con
     }
 
     unsigned int filesize = CcsdsFileWriter::FILE_MAX_SIZE;
-    if(argc == 4)
+    if(argc >= 4)
     {
         mlog(WARNING, "Truncating file size to maximum allowed: %d", CcsdsFileWriter::FILE_MAX_SIZE);
         filesize = (unsigned int)strtol(argv[3], NULL, 0);
     }
 
-    return new AtlasFileWriter(cmd_proc, name, format, prefix, stream, filesize);
+    File::io_t io = File::CACHED;
+    if(argc >= 5)
+    {
+        io = File::str2io(argv[4]);
+        if(io != File::CACHED && io != File::ASYNC && io != File::DIRECT)
+        {
+            mlog(CRITICAL, "Error: invalid file i/o specified for atlas file writer %s: %s", name, argv[4]);
+            return NULL;
+        }
+    }
+
+    return new AtlasFileWriter(cmd_proc, name, format, prefix, stream, filesize, io);
 }
 
 /*----------------------------------------------------------------------------
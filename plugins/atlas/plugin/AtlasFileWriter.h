@@ -55,7 +55,7 @@ class AtlasFileWriter: public CcsdsFileWriter
             INVALID
         } fmt_t;
 
-                                    AtlasFileWriter     (CommandProcessor* cmd_proc, const char* name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _max_file_size=FILE_MAX_SIZE);
+                                    AtlasFileWriter     (CommandProcessor* cmd_proc, const char* name, fmt_t _fmt, const char* _prefix, const char* inq_name, unsigned int _max_file_size=FILE_MAX_SIZE, File::io_t _io=File::CACHED);
         virtual                     ~AtlasFileWriter    (void);
 
         static CommandableObject*   createObject        (CommandProcessor* cmd_proc, const char* name, int argc, char argv[][MAX_CMD_SIZE]);
@@ -104,6 +104,12 @@ AtlasHistogram::AtlasHistogram(const char* _rec_type, type_t _type,
     hist->pktErrors       = 0;
     hist->ignoreStartBin  = 0;
     hist->ignoreStopBin   = 0;
+
+    /* Initialize Running Aggregates */
+    sumSquares      = 0;
+    minValue        = INT_MAX;
+    maxValue        = 0;
+    extremaStale    = false;
 }
 
 /*----------------------------------------------------------------------------
@@ -120,14 +126,10 @@ bool AtlasHistogram::setBin(int bin, int val)
 {
     if(bin < MAX_HIST_SIZE && bin >= 0)
     {
-        hist->sum -= hist->bins[bin];
+        int oldval = hist->bins[bin];
         hist->bins[bin] = val;
-        hist->sum += hist->bins[bin];
-
-        if(bin >= hist->size)
-        {
-            hist->size = bin + 1;
-        }
+        hist->sum += val - oldval;
+        updateStats(bin, oldval, val);
 
         return true;
     }
@@ -142,13 +144,10 @@ bool AtlasHistogram::addBin(int bin, int val)
 {
     if(bin < MAX_HIST_SIZE && bin >= 0)
     {
+        int oldval = hist->bins[bin];
         hist->bins[bin] += val;
         hist->sum += val;
-
-        if(bin >= hist->size)
-        {
-            hist->size = bin + 1;
-        }
+        updateStats(bin, oldval, hist->bins[bin]);
 
         return true;
     }
@@ -163,13 +162,9 @@ bool AtlasHistogram::incBin(int bin)
 {
     if(bin < MAX_HIST_SIZE && bin >= 0)
     {
-        hist->bins[bin]++;
+        int oldval = hist->bins[bin]++;
         hist->sum++;
-
-        if(bin >= hist->size)
-        {
-            hist->size = bin + 1;
-        }
+        updateStats(bin, oldval, oldval + 1);
 
         return true;
     }
@@ -199,17 +194,16 @@ double AtlasHistogram::getMean(void)
  *----------------------------------------------------------------------------*/
 double AtlasHistogram::getStdev(void)
 {
-    double diffsum = 0.0;
-    double mean = getMean();
-
-    for(int i = 0; i < hist->size; i++)
+    if(hist->size > 1)
     {
-        double diff = hist->bins[i] - mean;
-        diffsum += diff * diff;
+        double n = (double)hist->size;
+        double sum = (double)hist->sum;
+        double diffsum = (double)sumSquares - ((sum * sum) / n);
+        if(diffsum < 0.0) diffsum = 0.0; // guard against rounding
+        return sqrt(diffsum / (n - 1.0));
     }
 
-    if(hist->size > 1)    return sqrt(diffsum / (hist->size - 1));
-    else                return 0.0;
+    return 0.0;
 }
 
 /*----------------------------------------------------------------------------
@@ -219,6 +213,13 @@ int AtlasHistogram::getMin(int start, int stop)
 {
     if(stop < start) stop = hist->size;
 
+    /* Whole Histogram */
+    if(start == 0 && stop == hist->size)
+    {
+        if(extremaStale) refreshStats();
+        return minValue;
+    }
+
     long minval = INT_MAX;
     for(int i = start; i < stop; i++)
     {
@@ -238,6 +239,13 @@ int AtlasHistogram::getMax(int start, int stop)
 {
     if(stop < start) stop = hist->size;
 
+    /* Whole Histogram */
+    if(start == 0 && stop == hist->size)
+    {
+        if(extremaStale) refreshStats();
+        return maxValue;
+    }
+
     long maxval = 0;
     for(int i = start; i < stop; i++)
     {
@@ -278,6 +286,8 @@ void AtlasHistogram::scale(double _scale)
     {
         hist->bins[i] = (int)(hist->bins[i] * _scale);
     }
+
+    refreshStats();
 }
 
 /*----------------------------------------------------------------------------
@@ -289,6 +299,8 @@ void AtlasHistogram::addScalar(int scalar)
     {
         hist->bins[i] += scalar;
     }
+
+    refreshStats();
 }
 
 /*----------------------------------------------------------------------------
@@ -451,19 +463,44 @@ bool AtlasHistogram::calcAttributes(double sigwid, double bincal)
 
     int filter_width_bins;
 
-    /* Calculate Maximum Bins */
+    /* Calculate Filter Width Size */
+    if(sigwid == 0.0)
+    {
+        filter_width_bins = (int)ceil(HISTOGRAM_DEFAULT_FILTER_WIDTH / hist->binSize);
+    }
+    else
+    {
+        filter_width_bins = (int)round(sigwid / hist->binSize);
+    }
+
+    /* Initialize Maximum Bins */
     for(int i = 0; i < NUM_MAX_BINS; i++)
     {
         hist->maxVal[i] = 0;
         hist->maxBin[i] = 0;
     }
 
+    /*
+     * Single pass over the bins that ranks the maximum bins, refreshes the
+     * running aggregates, and slides the signal filter window (the window
+     * sum ending at bin i is for the window starting at i - width + 1)
+     */
+    int64_t sum = 0;
+    int64_t sum_sq = 0;
+    int min_val = INT_MAX;
+    int max_val = 0;
+    int maxval = 0;
+    int maxbin = 0;
+    int window = 0;
     for(int i = 0; i < hist->size; i++)
     {
+        int val = hist->bins[i];
+
+        /* Maximum Bins */
         int rank = NUM_MAX_BINS;
         for(int j = 0; j < NUM_MAX_BINS; j++)
         {
-            if(hist->bins[i] > hist->maxVal[(NUM_MAX_BINS - 1) - j])
+            if(val > hist->maxVal[(NUM_MAX_BINS - 1) - j])
             {
                 rank--;
             }
@@ -481,44 +518,49 @@ bool AtlasHistogram::calcAttributes(double sigwid, double bincal)
                 hist->maxBin[k] = hist->maxBin[k - 1];
             }
 
-            hist->maxVal[rank] = hist->bins[i];
+            hist->maxVal[rank] = val;
             hist->maxBin[rank] = i;
         }
-    }
 
-    /* Calculate Filter Width Size */
-    if(sigwid == 0.0)
-    {
-        filter_width_bins = (int)ceil(HISTOGRAM_DEFAULT_FILTER_WIDTH / hist->binSize);
-    }
-    else
-    {
-        filter_width_bins = (int)round(sigwid / hist->binSize);
-    }
+        /* Aggregates */
+        sum += val;
+        sum_sq += (int64_t)val * val;
+        if(val < min_val) min_val = val;
+        if(val > max_val) max_val = val;
 
-    /* Calculate Signal Bin and Sum */
-    int maxval = 0;
-    int maxbin = 0;
-    int nsize = hist->size - filter_width_bins + 1;
-    for(int n = 0; n < nsize; n++)
-    {
-        int sum = 0;
-        for(int m = 0; m < filter_width_bins; m++)
+        /* Signal Filter Window */
+        if(filter_width_bins > 0)
         {
-            int b = n + m;
-            if(b < hist->ignoreStartBin || b >= hist->ignoreStopBin)
+            if(i < hist->ignoreStartBin || i >= hist->ignoreStopBin)
             {
-                sum += hist->bins[b];
+                window += val;
             }
-        }
 
-        if(sum > maxval)
-        {
-            maxval = sum;
-            maxbin = n;
+            int n = i - filter_width_bins + 1;
+            if(n > 0)
+            {
+                int b = n - 1; // bin leaving the window
+                if(b < hist->ignoreStartBin || b >= hist->ignoreStopBin)
+                {
+                    window -= hist->bins[b];
+                }
+            }
+
+            if(n >= 0 && window > maxval)
+            {
+                maxval = window;
+                maxbin = n;
+            }
         }
     }
 
+    /* Update Running Aggregates */
+    hist->sum       = (int)sum;
+    sumSquares      = sum_sq;
+    minValue        = min_val;
+    maxValue        = max_val;
+    extremaStale    = false;
+
     /* First Pass Signal Width (start and stop) */
     long begin_sigbin       = maxbin;
     long end_sigbin         = maxbin + filter_width_bins;
@@ -589,6 +631,62 @@ bool AtlasHistogram::calcAttributes(double sigwid, double bincal)
     return true;
 }
 
+/*----------------------------------------------------------------------------
+ * updateStats  -
+ *
+ *   Notes: maintains the running aggregates for a single bin change and grows
+ *          the histogram size; callers are responsible for hist->sum
+ *----------------------------------------------------------------------------*/
+void AtlasHistogram::updateStats(int bin, int oldval, int newval)
+{
+    sumSquares += ((int64_t)newval * newval) - ((int64_t)oldval * oldval);
+
+    if(bin >= hist->size)
+    {
+        /* Growing - skipped bins are empty */
+        if(bin > hist->size && minValue > 0) minValue = 0;
+        if(newval < minValue) minValue = newval;
+        if(newval > maxValue) maxValue = newval;
+        hist->size = bin + 1;
+    }
+    else
+    {
+        if(newval > maxValue)                               maxValue = newval;
+        else if(oldval == maxValue && newval < oldval)      extremaStale = true;
+
+        if(newval < minValue)                               minValue = newval;
+        else if(oldval == minValue && newval > oldval)      extremaStale = true;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * refreshStats  -
+ *
+ *   Notes: recomputes all running aggregates in a single pass
+ *----------------------------------------------------------------------------*/
+void AtlasHistogram::refreshStats(void)
+{
+    int64_t sum = 0;
+    int64_t sum_sq = 0;
+    int minval = INT_MAX;
+    int maxval = 0;
+
+    for(int i = 0; i < hist->size; i++)
+    {
+        int val = hist->bins[i];
+        sum += val;
+        sum_sq += (int64_t)val * val;
+        if(val < minval) minval = val;
+        if(val > maxval) maxval = val;
+    }
+
+    hist->sum       = (int)sum;
+    sumSquares      = sum_sq;
+    minValue        = minval;
+    maxValue        = maxval;
+    extremaStale    = false;
+}
+
 /*----------------------------------------------------------------------------
  * defineHistogram  -
  *----------------------------------------------------------------------------*/
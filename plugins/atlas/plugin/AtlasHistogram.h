@@ -185,11 +185,20 @@ class AtlasHistogram: public RecordObject
 
         hist_t* hist;
 
+        /* Running Aggregates over [0, size) */
+        int64_t sumSquares;
+        int     minValue;
+        int     maxValue;
+        bool    extremaStale;   // min/max must be rescanned
+
         /*--------------------------------------------------------------------
          * Method
          *--------------------------------------------------------------------*/
 
         static recordDefErr_t   defineHistogram     (const char* rec_type, int data_size, fieldDef_t* fields, int num_fields);
+
+        void                    updateStats         (int bin, int oldval, int newval);
+        void                    refreshStats        (void);
 };
 
 #endif  /* __atlas_histogram__ */
@@ -592,6 +592,13 @@ HstvsSimulator::HstvsSimulator(CommandProcessor* cmd_proc, const char* obj_name,
     tepDelay = TEP_DELAY_DEFAULT;
     tepStrength = 0.0; // set by command
 
+    /* Load Test Initialization */
+    loadWorkers     = NULL;
+    numLoadWorkers  = 0;
+    loadActive      = false;
+    loadRate        = 0.0;
+    loadDuration    = 0.0;
+
     /* Initialize PED Encoder */
     PedEncoder.generateTables( 14, Mode14bit_NumberExponentBits, NUMBER_14BIT_MODES, Mode14bit_PedModeCommandBits );
 
@@ -605,6 +612,8 @@ HstvsSimulator::HstvsSimulator(CommandProcessor* cmd_proc, const char* obj_name,
     registerCommand("NUMBER_CHANNELS",   (cmdFunc_t)&HstvsSimulator::setNumberChannelsCmd,    2, "<number of strong channels 1 - 16 | 0: dynamic> <number of weak channels 1 - 4 | 0: dynamic>");
     registerCommand("OVERRIDE_CH_MASK",  (cmdFunc_t)&HstvsSimulator::overrideChannelMaskCmd, -1, "<ENABLE <mask> | DISABLE>");
     registerCommand("CONFIGURE_TEP",     (cmdFunc_t)&HstvsSimulator::configureTepCmd,         1, "<ENABLE | DISABLE>");
+    registerCommand("LOAD_TEST",         (cmdFunc_t)&HstvsSimulator::loadTestCmd,            -5, "<output stream> <major frames per second per apid | 0: unthrottled> <seconds | 0: until stopped> <returns per shot> <apid> [<apid> ...]");
+    registerCommand("STOP_LOAD_TEST",    (cmdFunc_t)&HstvsSimulator::stopLoadTestCmd,         0, "");
 }
 
 /*----------------------------------------------------------------------------
@@ -612,6 +621,7 @@ HstvsSimulator::HstvsSimulator(CommandProcessor* cmd_proc, const char* obj_name,
  *----------------------------------------------------------------------------*/
 HstvsSimulator::~HstvsSimulator(void)
 {
+    stopLoadTest();
     delete histQ;
 }
 
@@ -1081,6 +1091,248 @@ void HstvsSimulator::generateCommands(void)
     }
 }
 
+/*----------------------------------------------------------------------------
+ *  buildLoadTags -
+ *
+ *   Notes: Builds the time tag stream of one major frame - a transmit tag per
+ *          shot followed by its returns - from the simulator's random number
+ *          generator; returns the number of bytes written to tags.
+ *----------------------------------------------------------------------------*/
+int HstvsSimulator::buildLoadTags(unsigned char* tags, int returns)
+{
+    int i = 0;
+
+    for(int shot = 0; shot < SHOTS_PER_MAJOR_FRAME; shot++)
+    {
+        /* Transmit Tag - channel 24, leading coarse at shot rate */
+        uint32_t txtag = (24U << 27) | (((shot * 10) & 0x3FFF) << 7) | (uint32_t)(rgvsRandom() * MAX_FINE_COUNT);
+        tags[i++] = (unsigned char)(txtag >> 24);
+        tags[i++] = (unsigned char)(txtag >> 16);
+        tags[i++] = (unsigned char)(txtag >> 8);
+        tags[i++] = (unsigned char)(txtag);
+
+        /* Return Tags - random channel, edge, and time within the downlink band */
+        uint32_t prevtag = 0;
+        for(int r = 0; r < returns; r++)
+        {
+            uint32_t rxtag;
+            do
+            {
+                uint32_t channel = 1 + (uint32_t)(rgvsRandom() * NUM_RX_CHANNELS);
+                uint32_t toggle  = rgvsRandom() < 0.5 ? 1 : 0;
+                uint32_t coarse  = (uint32_t)(rgvsRandom() * (LOAD_DLB_WIDTH / 2));
+                uint32_t fine    = (uint32_t)(rgvsRandom() * MAX_FINE_COUNT);
+                rxtag = (channel << 19) | (toggle << 18) | (coarse << 7) | fine;
+            } while(rxtag == prevtag); // repeated tags are flagged as errors
+            prevtag = rxtag;
+
+            tags[i++] = (unsigned char)(rxtag >> 16);
+            tags[i++] = (unsigned char)(rxtag >> 8);
+            tags[i++] = (unsigned char)(rxtag);
+        }
+    }
+
+    return i;
+}
+
+/*----------------------------------------------------------------------------
+ *  buildLoadTemplate -
+ *
+ *   Notes: Lays out every segment of a major frame for the worker's apid so
+ *          that the worker only patches the sequence counts, time, major
+ *          frame counter, and AMET before posting.  Tags are never split
+ *          across segments since the time tag processor parses each segment
+ *          on its own.
+ *----------------------------------------------------------------------------*/
+void HstvsSimulator::buildLoadTemplate(load_worker_t* worker, const unsigned char* tags, int tag_bytes)
+{
+    const int hdrsize = CcsdsSpacePacket::CCSDS_TLMPAY_OFFSET;
+    const int maxdata = LOAD_SEGMENT_SIZE - hdrsize;
+
+    /* Count Segments */
+    int numsegs = 1;
+    int segdata = maxdata;
+    for(int t = 0; t < tag_bytes;)
+    {
+        int tagsize = ((tags[t] & 0xF8) >> 3) >= 24 ? 4 : 3;
+        if(segdata + tagsize > maxdata)
+        {
+            numsegs++;
+            segdata = 0;
+        }
+        segdata += tagsize;
+        t += tagsize;
+    }
+
+    /* Allocate Template */
+    worker->framebytes  = LOAD_START_SEG_SIZE + ((numsegs - 1) * hdrsize) + tag_bytes;
+    worker->buffer      = new unsigned char[worker->framebytes];
+    worker->segs        = new const void* [numsegs];
+    worker->sizes       = new int [numsegs];
+    worker->numsegs     = numsegs;
+    LocalLib::set(worker->buffer, 0, worker->framebytes);
+
+    /* Start Segment */
+    unsigned char* hdr = worker->buffer;
+    hdr[24] = (unsigned char)(LOAD_CAL_VALUE >> 8);     // calibration rising
+    hdr[25] = (unsigned char)(LOAD_CAL_VALUE);
+    hdr[26] = (unsigned char)(LOAD_CAL_VALUE >> 8);     // calibration falling
+    hdr[27] = (unsigned char)(LOAD_CAL_VALUE);
+    hdr[31] = (unsigned char)(LOAD_DLB_WIDTH >> 8);     // strong range window width
+    hdr[32] = (unsigned char)(LOAD_DLB_WIDTH);
+    hdr[36] = (unsigned char)(LOAD_DLB_WIDTH >> 8);     // weak range window width
+    hdr[37] = (unsigned char)(LOAD_DLB_WIDTH);
+    hdr[38] = 0;                                        // one downlink band, all channels enabled, starting at zero
+    hdr[44] = (unsigned char)(LOAD_DLB_WIDTH >> 8);
+    hdr[45] = (unsigned char)(LOAD_DLB_WIDTH);
+    worker->segs[0]  = hdr;
+    worker->sizes[0] = LOAD_START_SEG_SIZE;
+
+    /* Tag Segments */
+    int offset = LOAD_START_SEG_SIZE;
+    int t = 0;
+    for(int s = 1; s < numsegs; s++)
+    {
+        int start = t;
+        while(t < tag_bytes)
+        {
+            int tagsize = ((tags[t] & 0xF8) >> 3) >= 24 ? 4 : 3;
+            if((t - start) + tagsize > maxdata) break;
+            t += tagsize;
+        }
+
+        worker->segs[s]  = &worker->buffer[offset];
+        worker->sizes[s] = hdrsize + (t - start);
+        LocalLib::copy(&worker->buffer[offset + hdrsize], &tags[start], t - start);
+        offset += worker->sizes[s];
+    }
+
+    /* Primary Headers */
+    for(int s = 0; s < numsegs; s++)
+    {
+        CcsdsSpacePacket seg((unsigned char*)worker->segs[s], worker->sizes[s], false);
+        seg.initPkt(worker->apid, worker->sizes[s], false);
+        seg.setSHDR(true);
+        if(s == 0)                  seg.setSEQFLG(CcsdsSpacePacket::SEG_START);
+        else if(s == numsegs - 1)   seg.setSEQFLG(CcsdsSpacePacket::SEG_STOP);
+        else                        seg.setSEQFLG(CcsdsSpacePacket::SEG_CONTINUE);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ *  stopLoadTest -
+ *----------------------------------------------------------------------------*/
+void HstvsSimulator::stopLoadTest(void)
+{
+    if(loadWorkers == NULL) return;
+
+    /* Join Workers */
+    loadActive = false;
+    for(int w = 0; w < numLoadWorkers; w++)
+    {
+        delete loadWorkers[w].pid;
+    }
+
+    /* Report and Free Workers */
+    long frames = 0;
+    double bytes = 0.0;
+    double elapsed = 0.0;
+    for(int w = 0; w < numLoadWorkers; w++)
+    {
+        frames  += loadWorkers[w].frames;
+        bytes   += (double)loadWorkers[w].frames * loadWorkers[w].framebytes;
+        elapsed  = MAX(elapsed, loadWorkers[w].elapsed);
+
+        delete loadWorkers[w].outQ;
+        delete [] loadWorkers[w].buffer;
+        delete [] loadWorkers[w].segs;
+        delete [] loadWorkers[w].sizes;
+    }
+    delete [] loadWorkers;
+    loadWorkers = NULL;
+
+    if(elapsed > 0.0)
+    {
+        mlog(INFO, "%s load test posted %ld major frames in %.3lf seconds: %.1lf frames/sec, %.1lf Mbps", getName(), frames, elapsed, frames / elapsed, (bytes * 8.0) / (elapsed * 1000000.0));
+    }
+
+    numLoadWorkers = 0;
+}
+
+/*----------------------------------------------------------------------------
+ *  loadWorkerThread -
+ *
+ *   Notes: Posts the worker's major frame template at the configured rate,
+ *          patching only the fields that change from frame to frame.  The
+ *          rate is held against the start of the test so that a late post
+ *          is made up for on the next frame rather than lost.
+ *----------------------------------------------------------------------------*/
+void* HstvsSimulator::loadWorkerThread(void* parm)
+{
+    load_worker_t*  worker  = (load_worker_t*)parm;
+    HstvsSimulator* sim     = worker->sim;
+    unsigned char*  hdr     = (unsigned char*)worker->segs[0];
+    uint32_t        mfc     = 0;
+    uint64_t        amet    = 0;
+    int             seq     = 0;
+    double          start   = TimeLib::latchtime();
+
+    while(sim->loadActive)
+    {
+        /* Patch Time */
+        CcsdsSpacePacket view(hdr, worker->sizes[0], false);
+        view.setCdsTime(TimeLib::gettimems() / 1000.0);
+
+        /* Patch Sequence Counts and Secondary Headers */
+        for(int s = 0; s < worker->numsegs; s++)
+        {
+            unsigned char* seg = (unsigned char*)worker->segs[s];
+            seg[2] = (seg[2] & 0xC0) | ((seq >> 8) & 0x3F);
+            seg[3] = seq & 0xFF;
+            seq = (seq + 1) & 0x3FFF;
+            if(s > 0) LocalLib::copy(&seg[CcsdsSpacePacket::CCSDS_SECHDR_OFFSET], &hdr[CcsdsSpacePacket::CCSDS_SECHDR_OFFSET], 6);
+        }
+
+        /* Patch Major Frame Counter and AMET */
+        for(int b = 0; b < 4; b++) hdr[12 + b] = (unsigned char)(mfc >> (8 * (3 - b)));
+        for(int b = 0; b < 8; b++) hdr[16 + b] = (unsigned char)(amet >> (8 * (7 - b)));
+
+        /* Post Major Frame */
+        int posted = 0;
+        while(sim->loadActive && posted < worker->numsegs)
+        {
+            int status = worker->outQ->postCopyBatch(&worker->segs[posted], &worker->sizes[posted], worker->numsegs - posted, SYS_TIMEOUT);
+            if(status > 0)
+            {
+                posted += status;
+            }
+            else if(status != MsgQ::STATE_TIMEOUT)
+            {
+                mlog(CRITICAL, "Load test worker for %04X failed (%d) to post major frame %u, exiting", worker->apid, status, (unsigned int)mfc);
+                break;
+            }
+        }
+        if(posted < worker->numsegs) break;
+
+        worker->frames++;
+        mfc++;
+        amet += LOAD_AMET_PER_MF;
+
+        /* Rate Control */
+        double now = TimeLib::latchtime();
+        if(sim->loadDuration > 0.0 && (now - start) >= sim->loadDuration) break;
+        if(sim->loadRate > 0.0)
+        {
+            double next = start + (worker->frames / sim->loadRate);
+            if(next > now) LocalLib::sleep(next - now);
+        }
+    }
+
+    worker->elapsed = TimeLib::latchtime() - start;
+
+    return NULL;
+}
+
 /*----------------------------------------------------------------------------
  *  generateCmd -
  *----------------------------------------------------------------------------*/
@@ -1248,3 +1500,100 @@ int HstvsSimulator::configureTepCmd (int argc, char argv[][MAX_CMD_SIZE])
 
     return 0;
 }
+
+/*----------------------------------------------------------------------------
+ *  loadTestCmd -
+ *
+ *   Notes: One worker thread per apid; flight data rate is 50 major frames
+ *          per second per apid.
+ *----------------------------------------------------------------------------*/
+int HstvsSimulator::loadTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    const char* outq_name   = argv[0];
+    double      rate        = strtod(argv[1], NULL);
+    double      duration    = strtod(argv[2], NULL);
+    long        returns     = strtol(argv[3], NULL, 0);
+    int         num_workers = argc - 4;
+
+    if(rate < 0.0 || duration < 0.0)
+    {
+        mlog(CRITICAL, "Invalid load test rate or duration: %lf, %lf", rate, duration);
+        return -1;
+    }
+    else if(returns < 0 || returns > MAX_LOAD_RETURNS)
+    {
+        mlog(CRITICAL, "Returns per shot must be in range [0,%d]", MAX_LOAD_RETURNS);
+        return -1;
+    }
+    else if(num_workers > MAX_LOAD_WORKERS)
+    {
+        mlog(CRITICAL, "Number of apids exceeds maximum of %d", MAX_LOAD_WORKERS);
+        return -1;
+    }
+
+    /* Collect Apids */
+    uint16_t apids[MAX_LOAD_WORKERS];
+    for(int w = 0; w < num_workers; w++)
+    {
+        long apid = strtol(argv[4 + w], NULL, 0);
+        if(apid < 0 || apid >= CCSDS_NUM_APIDS)
+        {
+            mlog(CRITICAL, "Invalid apid supplied: %s", argv[4 + w]);
+            return -1;
+        }
+        apids[w] = (uint16_t)apid;
+    }
+
+    /* Stop Previous Test */
+    stopLoadTest();
+
+    /* Build Time Tags of a Major Frame */
+    unsigned char* tags = new unsigned char[SHOTS_PER_MAJOR_FRAME * (4 + (returns * 3))];
+    int tag_bytes = buildLoadTags(tags, returns);
+
+    /* Create Workers */
+    loadRate        = rate;
+    loadDuration    = duration;
+    loadActive      = true;
+    numLoadWorkers  = num_workers;
+    loadWorkers     = new load_worker_t [num_workers];
+    for(int w = 0; w < num_workers; w++)
+    {
+        loadWorkers[w].sim      = this;
+        loadWorkers[w].outQ     = new Publisher(outq_name);
+        loadWorkers[w].apid     = apids[w];
+        loadWorkers[w].frames   = 0;
+        loadWorkers[w].elapsed  = 0.0;
+        buildLoadTemplate(&loadWorkers[w], tags, tag_bytes);
+    }
+    delete [] tags;
+
+    /* Start Workers */
+    for(int w = 0; w < num_workers; w++)
+    {
+        loadWorkers[w].pid = new Thread(loadWorkerThread, &loadWorkers[w]);
+    }
+
+    mlog(INFO, "%s started load test of %d apids, %d segments of %d bytes per major frame", getName(), num_workers, loadWorkers[0].numsegs, loadWorkers[0].framebytes);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ *  stopLoadTestCmd -
+ *----------------------------------------------------------------------------*/
+int HstvsSimulator::stopLoadTestCmd (int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+    (void)argv;
+
+    if(loadWorkers == NULL)
+    {
+        mlog(CRITICAL, "No load test running");
+        return -1;
+    }
+
+    stopLoadTest();
+
+    return 0;
+}
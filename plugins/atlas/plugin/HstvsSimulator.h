@@ -247,6 +247,14 @@ class HstvsSimulator: public CommandableObject
          * Constants
          *--------------------------------------------------------------------*/
 
+        static const int MAX_LOAD_WORKERS       = 16;
+        static const int MAX_LOAD_RETURNS       = 1000;     // returns per shot the time tag processor can hold
+        static const int LOAD_SEGMENT_SIZE      = 4096;     // bytes in a generated time tag segment, including headers
+        static const int LOAD_START_SEG_SIZE    = 46;       // primary + secondary header, time tag header, one downlink band
+        static const int LOAD_DLB_WIDTH         = 1000;     // coarse counts
+        static const int LOAD_CAL_VALUE         = 0x3700;   // ruler clock / fine count calibration, scaled by 256
+        static const int LOAD_AMET_PER_MF       = 2000000;  // 20ms of 10ns ruler clock ticks
+
         static const char* TYPE;
 
         /*--------------------------------------------------------------------
@@ -268,6 +276,28 @@ class HstvsSimulator: public CommandableObject
         static const unsigned long StrongChannelOutMask[NUM_STRONG_RX_CHANNELS + 1];
         static const unsigned long WeakChannelOutMask[NUM_WEAK_RX_CHANNELS + 1];
 
+        /*--------------------------------------------------------------------
+         * Typedefs
+         *--------------------------------------------------------------------*/
+
+        /* Load Test Worker
+         * Each worker owns one apid so that the
+         * segments of its major frames are never
+         * interleaved with another worker's */
+        typedef struct {
+            HstvsSimulator*     sim;
+            Publisher*          outQ;
+            Thread*             pid;
+            uint16_t            apid;
+            unsigned char*      buffer;     // major frame template, segments back to back
+            const void**        segs;       // start of each segment in buffer
+            int*                sizes;      // size of each segment
+            int                 numsegs;
+            int                 framebytes;
+            long                frames;     // major frames posted
+            double              elapsed;    // seconds
+        } load_worker_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -288,6 +318,12 @@ class HstvsSimulator: public CommandableObject
 
         PedProbabilityEncoder PedEncoder;
 
+        load_worker_t*      loadWorkers;
+        int                 numLoadWorkers;
+        bool                loadActive;
+        double              loadRate;                   // major frames per second per worker, 0 is unthrottled
+        double              loadDuration;               // seconds, 0 runs until stopped
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -304,6 +340,10 @@ class HstvsSimulator: public CommandableObject
         void    writeCommandOutput          (int64_t met, double prob_curve[NUM_SPOTS][NUM_PROB_BINS_IN_15KM],  int32_t start_bin, int32_t num_bins);
         void    populateProbCurve           (test_input_t* input, double prob_curve[NUM_SPOTS][NUM_PROB_BINS_IN_15KM], int32_t start_bin, int32_t num_bins);
         void    generateCommands            (void);
+        int     buildLoadTags               (unsigned char* tags, int returns);
+        void    buildLoadTemplate           (load_worker_t* worker, const unsigned char* tags, int tag_bytes);
+        void    stopLoadTest                (void);
+        static void* loadWorkerThread       (void* parm);
 
         int     generateCmd                 (int argc, char argv[][MAX_CMD_SIZE]);
         int     loadCmd                     (int argc, char argv[][MAX_CMD_SIZE]);
@@ -312,6 +352,8 @@ class HstvsSimulator: public CommandableObject
         int     setNumberChannelsCmd        (int argc, char argv[][MAX_CMD_SIZE]);
         int     overrideChannelMaskCmd      (int argc, char argv[][MAX_CMD_SIZE]);
         int     configureTepCmd             (int argc, char argv[][MAX_CMD_SIZE]);
+        int     loadTestCmd                 (int argc, char argv[][MAX_CMD_SIZE]);
+        int     stopLoadTestCmd             (int argc, char argv[][MAX_CMD_SIZE]);
 };
 
 #endif  /* __hstvs_simulator__ */
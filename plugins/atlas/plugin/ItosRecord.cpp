@@ -842,6 +842,78 @@ bool Field::populate (unsigned char* pkt)
     return false;
 }
 
+/*----------------------------------------------------------------------------
+ * store  -
+ *
+ *   Notes: virtual, sets an element from raw bits extracted by a decoder
+ *----------------------------------------------------------------------------*/
+bool Field::store (int element, unsigned long raw, unsigned char* pkt)
+{
+    (void)element;
+    (void)raw;
+    (void)pkt;
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * compile  -
+ *
+ *   Notes: appends one decode operation per element that reproduces the
+ *          extraction done by populate; fields that cannot be expressed as
+ *          a shift and mask (strings, oversized or out of bounds elements)
+ *          get a single generic operation that calls populate
+ *----------------------------------------------------------------------------*/
+void Field::compile (List<decode_op_t>& ops, int pkt_len)
+{
+    bool compilable = (fieldType == INTEGER || fieldType == UNSIGNED || fieldType == FLOAT) &&
+                      (lengthInBits > 0) && (lengthInBits <= (int)(sizeof(unsigned long) * 8));
+
+    /* Check Bounds of Every Element */
+    for(int n = 0; compilable && n < numElements; n++)
+    {
+        int bits_to_lsb = (lengthInBits * (n + 1)) + offsetInBits;
+        int byte_index = (bits_to_lsb - 1) / 8;
+        if(byte_index >= pkt_len || byte_index < 0)
+        {
+            compilable = false;
+        }
+    }
+
+    if(!compilable)
+    {
+        decode_op_t op = { this, 0, 0, 0, 0, 0, 0, true };
+        ops.add(op);
+        return;
+    }
+
+    /* Build Operation per Element */
+    for(int n = 0; n < numElements; n++)
+    {
+        int bits_to_lsb = (lengthInBits * (n + 1)) + offsetInBits;
+        int num_bytes = (lengthInBits + 7) / 8;
+        int top_bits = lengthInBits - ((num_bytes - 1) * 8);
+
+        decode_op_t op;
+        op.field        = this;
+        op.element      = n;
+        op.byte_index   = (bits_to_lsb - 1) / 8;
+        op.num_bytes    = num_bytes;
+        op.top_mask     = (1UL << top_bits) - 1;
+        op.last         = (n == (numElements - 1));
+        if(fieldType == INTEGER)
+        {
+            op.right_shift  = (8 - (bits_to_lsb % 8)) % 8;
+            op.left_shift   = 0;
+        }
+        else
+        {
+            op.right_shift  = 0;
+            op.left_shift   = bits_to_lsb % 8;
+        }
+        ops.add(op);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * calcAttributes  -
  *
@@ -1040,14 +1112,8 @@ bool IntegerField::populate (unsigned char* pkt)
             }
 
             /* Set Value */
-            long candidate = (long)_value;
-            if(!rangeChecking || (candidate >= minRange && candidate <= maxRange))
+            if(!store(n, _value, pkt))
             {
-                value[n] = candidate;
-            }
-            else
-            {
-                mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %ld [%ld, %ld]", record->getName(), CCSDS_GET_SID(pkt), candidate, minRange, maxRange);
                 status = false;
             }
         }
@@ -1056,6 +1122,24 @@ bool IntegerField::populate (unsigned char* pkt)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * store  -
+ *
+ *   Notes: virtual
+ *----------------------------------------------------------------------------*/
+bool IntegerField::store (int element, unsigned long raw, unsigned char* pkt)
+{
+    long candidate = (long)raw;
+    if(!rangeChecking || (candidate >= minRange && candidate <= maxRange))
+    {
+        value[element] = candidate;
+        return true;
+    }
+
+    mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %ld [%ld, %ld]", record->getName(), CCSDS_GET_SID(pkt), candidate, minRange, maxRange);
+    return false;
+}
+
 /******************************************************************************
  * UNSIGNED INTEGER FIELD SUBCLASS
  ******************************************************************************/
@@ -1227,13 +1311,8 @@ bool UnsignedField::populate (unsigned char* pkt)
             }
 
             /* Set Value */
-            if(!rangeChecking || (_value >= minRange && _value <= maxRange))
+            if(!store(n, _value, pkt))
             {
-                value[n] = _value;
-            }
-            else
-            {
-                mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %lu [%lu, %lu]", record->getName(), CCSDS_GET_SID(pkt), _value, minRange, maxRange);
                 status = false;
             }
         }
@@ -1242,6 +1321,23 @@ bool UnsignedField::populate (unsigned char* pkt)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * store  -
+ *
+ *   Notes: virtual
+ *----------------------------------------------------------------------------*/
+bool UnsignedField::store (int element, unsigned long raw, unsigned char* pkt)
+{
+    if(!rangeChecking || (raw >= minRange && raw <= maxRange))
+    {
+        value[element] = raw;
+        return true;
+    }
+
+    mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %lu [%lu, %lu]", record->getName(), CCSDS_GET_SID(pkt), raw, minRange, maxRange);
+    return false;
+}
+
 /******************************************************************************
  *FLOAT FIELD SUBCLASS
  ******************************************************************************/
@@ -1415,14 +1511,8 @@ bool FloatField::populate (unsigned char* pkt)
             }
 
             /* Set Value */
-            double* candidate = (double*)&_value;
-            if(!rangeChecking || (*candidate >= minRange && *candidate <= maxRange))
-            {
-                value[n] = *candidate;
-            }
-            else
+            if(!store(n, _value, pkt))
             {
-                mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %lf [%lf, %lf]", record->getName(), CCSDS_GET_SID(pkt), *candidate, minRange, maxRange);
                 status = false;
             }
         }
@@ -1431,6 +1521,24 @@ bool FloatField::populate (unsigned char* pkt)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * store  -
+ *
+ *   Notes: virtual
+ *----------------------------------------------------------------------------*/
+bool FloatField::store (int element, unsigned long raw, unsigned char* pkt)
+{
+    double* candidate = (double*)&raw;
+    if(!rangeChecking || (*candidate >= minRange && *candidate <= maxRange))
+    {
+        value[element] = *candidate;
+        return true;
+    }
+
+    mlog(ERROR, "Failed to populate field %s from packet %04X due to out of bounds input %lf [%lf, %lf]", record->getName(), CCSDS_GET_SID(pkt), *candidate, minRange, maxRange);
+    return false;
+}
+
 /******************************************************************************
  * STRING FIELD SUBCLASS
  ******************************************************************************/
@@ -1705,6 +1813,12 @@ Packet::Packet(packet_type_t _packet_type, bool _populate, const char* _apid_des
 
     packetApidDesignation = StringLib::duplicate(_apid_designation);
 
+    useDecoder      = true;
+    decoderStale    = true;
+    decodeOps       = NULL;
+    numDecodeOps    = 0;
+    decodeApid      = INVALID_APID;
+
     if(_populate)
     {
         Record* ccsdsVersion        = new Record(false, "U12", "ccsdsVersion");
@@ -1752,6 +1866,7 @@ Packet::~Packet(void)
     for(int i = 0; i < orphanRecs.length(); i++) orphanFree(orphanRecs[i]);
     if(name) delete [] name;
     if(packetApidDesignation) delete [] packetApidDesignation;
+    clearDecoder();
 }
 
 /*----------------------------------------------------------------------------
@@ -1768,6 +1883,9 @@ void Packet::addField ( Record*             record,
 {
     assert(record != NULL);
 
+    /* Invalidate Decoder */
+    decoderStale = true;
+
     /* Check for Array */
     int num_elements = record->getNumArrayElements();
 
@@ -2109,6 +2227,13 @@ Packet* Packet::duplicate(void)
  *----------------------------------------------------------------------------*/
 bool Packet::populate(unsigned char* pkt)
 {
+    /* Use Compiled Decoder */
+    if(useDecoder)
+    {
+        if(decoderStale) buildDecoder();
+        if(decodeOps != NULL) return decode(pkt);
+    }
+
     /* Check APID */
     const char* apid_str = getProperty(packetApidDesignation, "value", 0);
     long apid = 0;
@@ -2148,6 +2273,16 @@ bool Packet::populate(unsigned char* pkt)
     return status;
 }
 
+/*----------------------------------------------------------------------------
+ * setDecoder  -
+ *
+ *   Notes: selects between the compiled decoder and walking the fields
+ *----------------------------------------------------------------------------*/
+void Packet::setDecoder(bool enable)
+{
+    useDecoder = enable;
+}
+
 /*----------------------------------------------------------------------------
  * isName  -
  *----------------------------------------------------------------------------*/
@@ -2194,6 +2329,8 @@ void Packet::setDeclaration(Record* dec)
  *----------------------------------------------------------------------------*/
 bool Packet::setProperty(const char* field_name, const char* property_name, const char* value, int index)
 {
+    decoderStale = true; // property may change the apid or field layout
+
     for(int i = 0; i < fields.length(); i++)
     {
         Field* field = fields[i];
@@ -2368,6 +2505,121 @@ void Packet::orphanFree(Record* orphan)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * buildDecoder  -
+ *
+ *   Notes: PRIVATE METHOD, flattens the payload fields into decode operations
+ *----------------------------------------------------------------------------*/
+void Packet::buildDecoder (void)
+{
+    clearDecoder();
+    decoderStale = false;
+
+    /* Resolve APID */
+    const char* apid_str = getProperty(packetApidDesignation, "value", 0);
+    long apid = 0;
+    bool apid_valid = (apid_str != NULL) && StringLib::str2long(apid_str, &apid);
+    if(apid_str) delete [] apid_str;
+    if(!apid_valid) return; // generic path reports the malformed apid
+
+    /* Compile Fields */
+    List<Field::decode_op_t> ops;
+    for(int f = 0; f < fields.length(); f++)
+    {
+        Field* field = fields[f];
+        if(field->isPayload())
+        {
+            field->compile(ops, numBytes);
+        }
+    }
+
+    /* Flatten Operations */
+    numDecodeOps = ops.length();
+    decodeOps = new Field::decode_op_t [numDecodeOps + 1]; // never zero length
+    for(int o = 0; o < numDecodeOps; o++)
+    {
+        decodeOps[o] = ops[o];
+    }
+    decodeApid = apid;
+}
+
+/*----------------------------------------------------------------------------
+ * clearDecoder  -
+ *
+ *   Notes: PRIVATE METHOD
+ *----------------------------------------------------------------------------*/
+void Packet::clearDecoder (void)
+{
+    if(decodeOps) delete [] decodeOps;
+    decodeOps = NULL;
+    numDecodeOps = 0;
+    decodeApid = INVALID_APID;
+}
+
+/*----------------------------------------------------------------------------
+ * decode  -
+ *
+ *   Notes: PRIVATE METHOD, equivalent to walking the fields in populate
+ *----------------------------------------------------------------------------*/
+bool Packet::decode (unsigned char* pkt)
+{
+    /* Check APID */
+    if(decodeApid != CCSDS_GET_APID(pkt))
+    {
+        mlog(WARNING, "Unable to populate packet %s from packet %04X as APIDs do not match! (expected: %04X)", name, CCSDS_GET_APID(pkt), (uint16_t)decodeApid);
+        return false;
+    }
+
+    /* Check Length */
+    if(numBytes != CCSDS_GET_LEN(pkt))
+    {
+        mlog(WARNING, "Unable to populate packet %s from packet %04X as length does not match! (expected: %d, actual: %d)", name, CCSDS_GET_APID(pkt), numBytes, CCSDS_GET_LEN(pkt));
+        return false;
+    }
+
+    /* Run Operations */
+    bool status = true;
+    bool field_status = true;
+    for(int o = 0; o < numDecodeOps; o++)
+    {
+        const Field::decode_op_t* op = &decodeOps[o];
+
+        if(op->num_bytes == 0)
+        {
+            field_status = op->field->populate(pkt);
+        }
+        else
+        {
+            unsigned long raw = 0;
+            for(int i = 0; i < op->num_bytes; i++)
+            {
+                unsigned long b = pkt[op->byte_index - i];
+                if(i == 0) b >>= op->right_shift;
+                if(i == (op->num_bytes - 1)) b &= op->top_mask;
+                raw |= b << (i * 8);
+            }
+            raw <<= op->left_shift;
+
+            if(!op->field->store(op->element, raw, pkt))
+            {
+                field_status = false;
+            }
+        }
+
+        if(op->last)
+        {
+            if(!field_status)
+            {
+                mlog(ERROR, "Unable to populate packet %s with field %s", name, op->field->getName());
+                status = false;
+            }
+            field_status = true;
+        }
+    }
+
+    return status;
+}
+
 /******************************************************************************
  * COMMAND PACKET CLASS
  ******************************************************************************/
@@ -176,6 +176,17 @@ namespace Itos
                 STRING,
             } field_type_t;
 
+            typedef struct {
+                Field*          field;
+                int             element;
+                int             byte_index;     // byte holding the least significant bits of the element
+                int             num_bytes;      // zero means the field is populated generically
+                int             right_shift;    // applied to the least significant byte
+                int             left_shift;     // applied to the assembled value
+                unsigned long   top_mask;       // applied to the most significant byte
+                bool            last;           // last element of the field
+            } decode_op_t;
+
             /* -------------------------- */
             /* Methods                    */
             /* -------------------------- */
@@ -222,6 +233,9 @@ namespace Itos
             virtual bool            _setProperty        (const char* property, const char* _value, int index);
             virtual const char*     _getProperty        (const char* property, int index);
             virtual bool            populate            (unsigned char* pkt);
+            virtual bool            store               (int element, unsigned long raw, unsigned char* pkt);
+
+                    void            compile             (List<decode_op_t>& ops, int pkt_len);
 
             /* -------------------------- */
             /* Constants                  */
@@ -291,6 +305,7 @@ namespace Itos
             bool            _setProperty    (const char* property, const char* _value, int index);
             const char*     _getProperty    (const char* property, int index);
             bool            populate        (unsigned char* pkt);
+            bool            store           (int element, unsigned long raw, unsigned char* pkt);
 
         private:
 
@@ -336,6 +351,7 @@ namespace Itos
             bool            _setProperty    (const char* property, const char* _value, int index);
             const char*     _getProperty    (const char* property, int index);
             bool            populate        (unsigned char* pkt);
+            bool            store           (int element, unsigned long raw, unsigned char* pkt);
 
         private:
 
@@ -381,6 +397,7 @@ namespace Itos
             bool            _setProperty    (const char* property, const char* _value, int index);
             const char*     _getProperty    (const char* property, int index);
             bool            populate        (unsigned char* pkt);
+            bool            store           (int element, unsigned long raw, unsigned char* pkt);
 
         private:
 
@@ -525,6 +542,7 @@ namespace Itos
                     void        calcAttributes      (void);
                     Packet*     duplicate           (void);
                     bool        populate            (unsigned char* pkt);
+                    void        setDecoder          (bool enable);
 
                     bool        isName              (const char* namestr);
                     bool        isType              (packet_type_t type);
@@ -585,6 +603,20 @@ namespace Itos
             /* -------------------------- */
 
             char* packetApidDesignation;
+
+            bool                    useDecoder;         // populate through the compiled decoder
+            bool                    decoderStale;       // decoder must be rebuilt before next use
+            Field::decode_op_t*     decodeOps;          // flat list of field extractions, NULL if not compiled
+            int                     numDecodeOps;
+            long                    decodeApid;
+
+            /* -------------------------- */
+            /* Methods                    */
+            /* -------------------------- */
+
+            void        buildDecoder        (void);
+            void        clearDecoder        (void);
+            bool        decode              (unsigned char* pkt);
     };
 
     /*************************************************
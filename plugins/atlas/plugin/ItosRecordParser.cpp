@@ -182,6 +182,8 @@ ItosRecordParser::ItosRecordParser(CommandProcessor* cmd_proc, const char* obj_n
     registerCommand("REPORT_USER_EDITABLE",  (cmdFunc_t)&ItosRecordParser::makeEditableCmd,     1, "<ENABLE|DISABLE>");
     registerCommand("REPORT_REMOTE_CONTENT", (cmdFunc_t)&ItosRecordParser::useRemoteContentCmd, 1, "<ENABLE|DISABLE>");
     registerCommand("LIST",                  (cmdFunc_t)&ItosRecordParser::listCmd,             1, "<packet name>");
+    registerCommand("USE_DECODERS",          (cmdFunc_t)&ItosRecordParser::useDecodersCmd,      1, "<ENABLE|DISABLE>");
+    registerCommand("BENCHMARK_DECODE",      (cmdFunc_t)&ItosRecordParser::benchmarkDecodeCmd,  2, "<packet name> <iterations>");
 }
 
 /*----------------------------------------------------------------------------
@@ -2726,3 +2728,80 @@ int ItosRecordParser::listCmd(int argc, char argv[][MAX_CMD_SIZE])
 
     return 0;
 }
+
+/*----------------------------------------------------------------------------
+ * useDecodersCmd  -
+ *
+ *   Notes: Command Processor Command
+ *----------------------------------------------------------------------------*/
+int ItosRecordParser::useDecodersCmd(int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+
+    bool enable;
+    if(!StringLib::str2bool(argv[0], &enable)) return -1;
+
+    for(int p = 0; p < packets.length(); p++)
+    {
+        packets[p]->setDecoder(enable);
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ * benchmarkDecodeCmd  -
+ *
+ *   Notes: Command Processor Command, times populating a packet from its own
+ *          default values by walking the fields and through the compiled decoder
+ *----------------------------------------------------------------------------*/
+int ItosRecordParser::benchmarkDecodeCmd(int argc, char argv[][MAX_CMD_SIZE])
+{
+    (void)argc;
+
+    const char* pktname = argv[0];
+    long iterations = 0;
+    if(!StringLib::str2long(argv[1], &iterations) || iterations <= 0)
+    {
+        mlog(CRITICAL, "Invalid number of iterations: %s", argv[1]);
+        return -1;
+    }
+
+    Packet* packet = findPacket(pktname);
+    if(packet == NULL)
+    {
+        mlog(CRITICAL, "Unable to find packet: %s", pktname);
+        return -1;
+    }
+
+    /* Build Packet from Default Values */
+    int num_bytes = packet->getNumBytes();
+    unsigned char* pkt = (unsigned char*)packet->serialize(Packet::BINARY_FMT, num_bytes);
+    pkt[4] = (unsigned char)((num_bytes - 7) >> 8); // serialized length is the total length, header holds length - 7
+    pkt[5] = (unsigned char)((num_bytes - 7) & 0xFF);
+
+    /* Time Both Paths */
+    double elapsed[2] = { 0.0, 0.0 };
+    bool status = true;
+    for(int mode = 0; mode < 2; mode++)
+    {
+        packet->setDecoder(mode == 1);
+        double start = TimeLib::latchtime();
+        for(long i = 0; i < iterations; i++)
+        {
+            status = packet->populate(pkt) && status;
+        }
+        elapsed[mode] = TimeLib::latchtime() - start;
+    }
+    packet->setDecoder(true);
+    delete [] pkt;
+
+    /* Report Results */
+    for(int mode = 0; mode < 2; mode++)
+    {
+        double rate = (elapsed[mode] > 0.0) ? (iterations / elapsed[mode]) : 0.0;
+        print2term("%-8s %ld packets in %.3lf seconds (%.1lf packets/sec, %.1lf MB/sec)\n", mode == 0 ? "generic" : "compiled", iterations, elapsed[mode], rate, (rate * num_bytes) / 1000000.0);
+    }
+
+    return status ? 0 : -1;
+}
@@ -135,6 +135,8 @@ class ItosRecordParser: public CommandableObject
         int                     makeEditableCmd         (int argc, char argv[][MAX_CMD_SIZE]);
         int                     useRemoteContentCmd     (int argc, char argv[][MAX_CMD_SIZE]);
         int                     listCmd                 (int argc, char argv[][MAX_CMD_SIZE]);
+        int                     useDecodersCmd          (int argc, char argv[][MAX_CMD_SIZE]);
+        int                     benchmarkDecodeCmd      (int argc, char argv[][MAX_CMD_SIZE]);
 };
 
 #endif  /* __itos_record_parser__ */
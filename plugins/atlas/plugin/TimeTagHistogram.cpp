@@ -152,13 +152,9 @@ bool TimeTagHistogram::binTag(int bin, tag_t* tag)
         }
 
         tags[bin]->add(tag);
-        tt->hist.bins[bin]++;
+        int oldval = tt->hist.bins[bin]++;
         tt->hist.sum++;
-
-        if(bin >= tt->hist.size)
-        {
-            tt->hist.size = bin + 1;
-        }
+        updateStats(bin, oldval, oldval + 1);
 
         tt->downlinkBandsTagCnt[tag->band]++;
 
@@ -168,6 +164,73 @@ bool TimeTagHistogram::binTag(int bin, tag_t* tag)
     return false;
 }
 
+/*----------------------------------------------------------------------------
+ * binTags  -
+ *
+ *  Bins a batch of tags; counts are accumulated round-robin into NUM_BIN_LANES
+ *  sub-histograms so that repeated hits on the same bin (the surface return)
+ *  do not serialize on a single counter, and the touched range is merged into
+ *  the histogram at the end.  The lanes buffer is NUM_BIN_LANES * MAX_HIST_SIZE
+ *  counters that must be zero on entry and are left zeroed on return.
+ *----------------------------------------------------------------------------*/
+int TimeTagHistogram::binTags(const int* bins, tag_t** tag_list, int count, int32_t* lanes)
+{
+    int32_t band_cnt[MAX_NUM_DLBS] = { 0 };
+    int lo = MAX_HIST_SIZE;
+    int hi = -1;
+    int binned = 0;
+
+    /* Accumulate Lanes */
+    for(int t = 0; t < count; t++)
+    {
+        int bin = bins[t];
+        if(bin < MAX_HIST_SIZE && bin >= 0)
+        {
+            if(tags[bin] == NULL)
+            {
+                tags[bin] = new List<tag_t*>();
+            }
+
+            tags[bin]->add(tag_list[t]);
+            lanes[((binned & (NUM_BIN_LANES - 1)) * MAX_HIST_SIZE) + bin]++;
+            band_cnt[tag_list[t]->band]++;
+            binned++;
+
+            if(bin < lo) lo = bin;
+            if(bin > hi) hi = bin;
+        }
+    }
+
+    /* Merge Lanes */
+    if(binned > 0)
+    {
+        tt->hist.sum += binned;
+        for(int b = lo; b <= hi; b++)
+        {
+            int delta = 0;
+            for(int l = 0; l < NUM_BIN_LANES; l++)
+            {
+                delta += lanes[(l * MAX_HIST_SIZE) + b];
+                lanes[(l * MAX_HIST_SIZE) + b] = 0;
+            }
+
+            if(delta > 0)
+            {
+                int oldval = tt->hist.bins[b];
+                tt->hist.bins[b] = oldval + delta;
+                updateStats(b, oldval, oldval + delta);
+            }
+        }
+
+        for(int d = 0; d < MAX_NUM_DLBS; d++)
+        {
+            tt->downlinkBandsTagCnt[d] += band_cnt[d];
+        }
+    }
+
+    return binned;
+}
+
 /*----------------------------------------------------------------------------
  * setPktStats  -
  *----------------------------------------------------------------------------*/
@@ -49,6 +49,7 @@ class TimeTagHistogram: public AtlasHistogram
          *--------------------------------------------------------------------*/
 
         static const char* rec_type;
+        static const int NUM_BIN_LANES = 4; // sub-histograms used by binTags
 
         /*--------------------------------------------------------------------
          * Typedefs
@@ -88,6 +89,7 @@ class TimeTagHistogram: public AtlasHistogram
                                 ~TimeTagHistogram   (void);
 
         bool                    binTag              (int bin, tag_t* tag);
+        int                     binTags             (const int* bins, tag_t** tag_list, int count, int32_t* lanes);
         void                    setPktStats         (const stat_t* stats);
         void                    incChCount          (int index);
         tag_t*                  getTag              (int bin, int offset);
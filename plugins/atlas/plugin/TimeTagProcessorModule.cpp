@@ -278,6 +278,10 @@ TimeTagProcessorModule::TimeTagProcessorModule(CommandProcessor* cmd_proc, const
     /* Initialize Streams */
     histQ   = new Publisher(histq_name);
 
+    /* Initialize Binning Lanes */
+    binLanes = new int32_t [TimeTagHistogram::NUM_BIN_LANES * AtlasHistogram::MAX_HIST_SIZE];
+    memset(binLanes, 0, sizeof(int32_t) * TimeTagHistogram::NUM_BIN_LANES * AtlasHistogram::MAX_HIST_SIZE);
+
     /* Initialize Time Tag Histogram Record Definitions */
     TimeTagHistogram::defineHistogram();
 
@@ -304,6 +308,7 @@ TimeTagProcessorModule::TimeTagProcessorModule(CommandProcessor* cmd_proc, const
 TimeTagProcessorModule::~TimeTagProcessorModule(void)
 {
     delete histQ;
+    delete [] binLanes;
 
     if(majorFrameProcName)  delete [] majorFrameProcName;
     if(timeProcName)        delete [] timeProcName;
@@ -375,6 +380,7 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
     shot_data_t*        shot_data                   = NULL;
     mfdata_t*           mfdata_ptr                  = NULL;
     TimeTagHistogram*   hist[NUM_SPOTS]             = { NULL, NULL };
+    int                 batch_cnt[NUM_SPOTS]        = { 0, 0 };
 
     /* Uninitialized Data */
     mfdata_t            mfdata;
@@ -383,6 +389,21 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
     List<shot_data_t*>  shot_data_list;
     dlb_t               dlb[MAX_NUM_DLBS];
     char                gps_str[128];
+    int                 bin_batch[NUM_SPOTS][BIN_BATCH_SIZE];
+    rxPulse_t*          tag_batch[NUM_SPOTS][BIN_BATCH_SIZE];
+
+    /* Bins Pending Return Tags into Histograms */
+    auto flush_bins = [&](void)
+    {
+        for(int s = 0; s < NUM_SPOTS; s++)
+        {
+            if(batch_cnt[s] > 0)
+            {
+                hist[s]->binTags(bin_batch[s], tag_batch[s], batch_cnt[s], binLanes);
+                batch_cnt[s] = 0;
+            }
+        }
+    };
 
     /* Initialize Packet Stats */
     memset(&pkt_stat, 0, sizeof(pktStat_t));
@@ -571,8 +592,8 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
             while(i < len)
             {
                 /* Read Channel */
-                long id = parseInt(pktbuf + i, 1);
-                long channel = (parseInt(pktbuf + i, 1) & 0xF8) >> 3;
+                long id = pktbuf[i];
+                long channel = (id & 0xF8) >> 3;
                 long channel_index = channel - 1;
 
                 /* Check for Empty Packet */
@@ -594,6 +615,7 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                         {
                             if(mfc == BuildUpMfcCount)
                             {
+                                flush_bins();
                                 for(int s = 0; s < NUM_SPOTS; s++)
                                 {
                                     hist[s]->setTransmitCount(shot_data_list.length()); // needed for calculating the signal attributes
@@ -611,7 +633,7 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                     shot_data->rx_index             = 0;
                     shot_data->truncated            = false;
 
-                    shot_data->tx.tag               = parseInt(pktbuf + i, 4); i += 4;
+                    shot_data->tx.tag               = ((uint32_t)pktbuf[i] << 24) | ((uint32_t)pktbuf[i+1] << 16) | ((uint32_t)pktbuf[i+2] << 8) | (uint32_t)pktbuf[i+3]; i += 4;
                     shot_data->tx.width             = (shot_data->tx.tag  & 0x10000000) >> 28;
                     shot_data->tx.trailing_fine     = (shot_data->tx.tag  & 0x0FE00000) >> 21;
                     shot_data->tx.leading_coarse    = ((shot_data->tx.tag & 0x001FFF80) >> 7) + TransmitPulseCoarseCorrection;
@@ -645,6 +667,7 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                     if(shot_data->rx_index == MAX_RX_PER_SHOT)
                     {
                         mlog(ERROR, "All statistics are invalid! Unable to allocate new rx pulse - reusing memory!");
+                        flush_bins(); // pending tags reference the memory being reused
                         shot_data->rx_index = 0;
                     }
 
@@ -652,7 +675,7 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                     rxPulse_t* rx = &(shot_data->rx[shot_data->rx_index]);
 
                     /* Read Time Tag */
-                    rx->tag     = parseInt(pktbuf + i, 3); i += 3;
+                    rx->tag     = ((uint32_t)pktbuf[i] << 16) | ((uint32_t)pktbuf[i+1] << 8) | (uint32_t)pktbuf[i+2]; i += 3;
                     rx->toggle  = (rx->tag & 0x040000) >> 18;
                     rx->band    = (rx->tag & 0x020000) >> 17;
                     rx->coarse  = ((rx->tag & 0x01FF80) >> 7) + ReturnPulseCoarseCorrection;
@@ -850,7 +873,9 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                         {
                             mf_ch_stat.rx_cnt[channel_index]++;
                             mf_ch_stat.cell_cnts[channel_index][rx->fine]++;
-                            hist[spot]->binTag(return_bin, rx);
+                            bin_batch[spot][batch_cnt[spot]] = return_bin;
+                            tag_batch[spot][batch_cnt[spot]] = rx;
+                            if(++batch_cnt[spot] == BIN_BATCH_SIZE) flush_bins();
                             shot_data->rx_list[rx->toggle][channel_index].add(rx);
                             shot_data->rx_index++;
                         }
@@ -876,6 +901,9 @@ bool TimeTagProcessorModule::processSegments(List<CcsdsSpacePacket*>& segments,
                     pkt_stat.pkt_errors++;
                 }
             }
+
+            /* Bin Remaining Tags in Segment */
+            flush_bins();
         }
 
         /* Process Last Segment Checks */
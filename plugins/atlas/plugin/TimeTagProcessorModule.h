@@ -180,6 +180,7 @@ class TimeTagProcessorModule: public CcsdsProcessorModule
         static const int    MAX_RX_PER_SHOT                 = 1000;
         static const int    MAX_STAT_NAME_SIZE              = 128;
         static const int    GRANULE_HIST_SIZE               = 2000;
+        static const int    BIN_BATCH_SIZE                  = 256;    // return tags binned at a time per spot
         static const double DEFAULT_10NS_PERIOD;
         static const double DEFAULT_SIGNAL_WIDTH;
         static const double DEFAULT_GPS_TOLERANCE;
@@ -301,6 +302,8 @@ class TimeTagProcessorModule: public CcsdsProcessorModule
 
         Publisher*      histQ;    // output histograms
 
+        int32_t*        binLanes; // zeroed sub-histogram scratch for TimeTagHistogram::binTags
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -48,10 +48,10 @@ void initatlas (void)
     extern CommandProcessor* cmdProc;
 
     /* Register SigView Handlers */
-    cmdProc->registerHandler("ATLAS_FILE_WRITER",        AtlasFileWriter::createObject,             -3,  "<format: SCI_PKT, SCI_CH, SCI_TX, HISTO, CCSDS_STAT, CCSDS_INFO, META, CHANNEL, ACVPT, TIMEDIAG, TIMESTAT> <file prefix including path> <input stream>");
+    cmdProc->registerHandler("ATLAS_FILE_WRITER",        AtlasFileWriter::createObject,             -3,  "<format: SCI_PKT, SCI_CH, SCI_TX, HISTO, CCSDS_STAT, CCSDS_INFO, META, CHANNEL, ACVPT, TIMEDIAG, TIMESTAT> <file prefix including path> <input stream> [<max file size>] [<CACHED|ASYNC|DIRECT>]");
     cmdProc->registerHandler("ITOS_RECORD_PARSER",       ItosRecordParser::createObject,             0,  "", true);
     cmdProc->registerHandler("TIME_TAG_PROCESSOR",       TimeTagProcessorModule::createObject,       2,  "<histogram stream> <pce: 1,2,3>", true);
-    cmdProc->registerHandler("ALTIMETRY_PROCESSOR",      AltimetryProcessorModule::createObject,     3,  "<histogram type: SAL, WAL, SAM, WAM, ATM> <histogram stream> <pce: 1,2,3>", true);
+    cmdProc->registerHandler("ALTIMETRY_PROCESSOR",      AltimetryProcessorModule::createObject,     -3, "<histogram type: SAL, WAL, SAM, WAM, ATM> <histogram stream> <pce: 1,2,3> [<histogram workers>]", true);
     cmdProc->registerHandler("MAJOR_FRAME_PROCESSOR",    MajorFrameProcessorModule::createObject,    0,  "", true);
     cmdProc->registerHandler("TIME_PROCESSOR",           TimeProcessorModule::createObject,          0,  "", true);
     cmdProc->registerHandler("LASER_PROCESSOR",          LaserProcessorModule::createObject,         0,  "", true);
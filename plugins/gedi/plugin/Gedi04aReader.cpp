@@ -157,22 +157,21 @@ Gedi04aReader::Gedi04aReader (lua_State* L, Asset* _asset, const char* _resource
 
     /* Initialize Readers */
     active = true;
-    numComplete = 0;
-    LocalLib::set(readerPid, 0, sizeof(readerPid));
+    regionPid = NULL;
+    numBeams = 0;
+    chunks = NULL;
+    numChunks = 0;
+    nextChunk = 0;
 
     /* PRocess Resource */
     try
     {
-        /* Read Beam Data */
+        /* Select Beams */
         if(parms->beam == GediParms::ALL_BEAMS)
         {
-            threadCount = GediParms::NUM_BEAMS;
             for(int b = 0; b < GediParms::NUM_BEAMS; b++)
             {
-                info_t* info = new info_t;
-                info->reader = this;
-                info->beam = GediParms::BEAM_NUMBER[b];
-                readerPid[b] = new Thread(subsettingThread, info);
+                beams[numBeams++] = {this, GediParms::BEAM_NUMBER[b], NULL};
             }
         }
         else if(parms->beam == GediParms::BEAM0000 ||
@@ -184,16 +183,16 @@ Gedi04aReader::Gedi04aReader (lua_State* L, Asset* _asset, const char* _resource
                 parms->beam == GediParms::BEAM1000 ||
                 parms->beam == GediParms::BEAM1011)
         {
-            threadCount = 1;
-            info_t* info = new info_t;
-            info->reader = this;
-            info->beam = parms->beam;
-            subsettingThread(info);
+            beams[numBeams++] = {this, parms->beam, NULL};
         }
         else
         {
             throw RunTimeException(CRITICAL, RTE_ERROR, "Invalid beam specified <%d>, must be 0, 1, 2, 3, 5, 6, 8, 11, or -1 for all", parms->beam);
         }
+
+        /* Start Region Prepass (spawns the workers) */
+        ThreadBudget::reserve(1);
+        regionPid = new Thread(regionThread, this);
     }
     catch(const RunTimeException& e)
     {
@@ -217,10 +216,9 @@ Gedi04aReader::~Gedi04aReader (void)
 {
     active = false;
 
-    for(int b = 0; b < GediParms::NUM_BEAMS; b++)
-    {
-        if(readerPid[b]) delete readerPid[b];
-    }
+    if(regionPid) delete regionPid;
+
+    delete [] chunks;
 
     delete outQ;
 
@@ -240,13 +238,22 @@ Gedi04aReader::Region::Region (info_t* info):
     inclusion_mask  (NULL),
     inclusion_ptr   (NULL)
 {
-    /* Join Reads */
-    lat_lowestmode.join(info->reader->read_timeout_ms, true);
-    lon_lowestmode.join(info->reader->read_timeout_ms, true);
-
     /* Initialize Region */
     first_footprint = 0;
     num_footprints = H5Coro::ALL_ROWS;
+}
+
+/*----------------------------------------------------------------------------
+ * Region::subset
+ *
+ *  joins the geolocation reads issued by the constructor and finds the
+ *  footprints of the beam inside the region of interest
+ *----------------------------------------------------------------------------*/
+void Gedi04aReader::Region::subset (info_t* info)
+{
+    /* Join Reads */
+    lat_lowestmode.join(info->reader->read_timeout_ms, true);
+    lon_lowestmode.join(info->reader->read_timeout_ms, true);
 
     /* Determine Spatial Extent */
     if(info->reader->parms->raster != NULL)
@@ -288,6 +295,8 @@ Gedi04aReader::Region::~Region (void)
 void Gedi04aReader::Region::cleanup (void)
 {
     if(inclusion_mask) delete [] inclusion_mask;
+    inclusion_mask = NULL;
+    inclusion_ptr = NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -309,6 +318,7 @@ void Gedi04aReader::Region::polyregion (info_t* info)
     {
         projected_poly[i] = MathLib::coord2point(poly_iterator[i], projection);
     }
+    MathLib::poly_t* poly = MathLib::polycreate(projected_poly, points_in_polygon);
 
     /* Find First and Last Footprints in Polygon */
     bool first_footprint_found = false;
@@ -323,7 +333,7 @@ void Gedi04aReader::Region::polyregion (info_t* info)
         MathLib::point_t footprint_point = MathLib::coord2point(footprint_coord, projection);
 
         /* Test Inclusion */
-        if(MathLib::inpoly(projected_poly, points_in_polygon, footprint_point))
+        if(MathLib::inpoly(poly, footprint_point))
         {
             inclusion = true;
         }
@@ -353,6 +363,7 @@ void Gedi04aReader::Region::polyregion (info_t* info)
     }
 
     /* Delete Projected Polygon */
+    MathLib::polydelete(poly);
     delete [] projected_poly;
 }
 
@@ -366,15 +377,16 @@ void Gedi04aReader::Region::rasterregion (info_t* info)
     inclusion_mask = new bool [lat_lowestmode.size];
     inclusion_ptr = inclusion_mask;
 
+    /* Check Inclusion of All Footprints */
+    info->reader->parms->raster->includes(&lon_lowestmode[0], &lat_lowestmode[0], lat_lowestmode.size, inclusion_mask);
+
     /* Loop Throuh Segments */
     bool first_footprint_found = false;
     long last_footprint = 0;
     int footprint = 0;
     while(footprint < lat_lowestmode.size)
     {
-        /* Check Inclusion */
-        bool inclusion = info->reader->parms->raster->includes(lon_lowestmode[footprint], lat_lowestmode[footprint]);
-        inclusion_mask[footprint] = inclusion;
+        bool inclusion = inclusion_mask[footprint];
 
         /* If Coordinate Is In Raster */
         if(inclusion)
@@ -408,16 +420,16 @@ void Gedi04aReader::Region::rasterregion (info_t* info)
 /*----------------------------------------------------------------------------
  * Gedi04a::Constructor
  *----------------------------------------------------------------------------*/
-Gedi04aReader::Gedi04a::Gedi04a (info_t* info, Region& region):
-    shot_number     (info->reader->asset, info->reader->resource, SafeString("%s/shot_number",      GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    delta_time      (info->reader->asset, info->reader->resource, SafeString("%s/delta_time",       GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    agbd            (info->reader->asset, info->reader->resource, SafeString("%s/agbd",             GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    elev_lowestmode (info->reader->asset, info->reader->resource, SafeString("%s/elev_lowestmode",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    solar_elevation (info->reader->asset, info->reader->resource, SafeString("%s/solar_elevation",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    degrade_flag    (info->reader->asset, info->reader->resource, SafeString("%s/degrade_flag",     GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    l2_quality_flag (info->reader->asset, info->reader->resource, SafeString("%s/l2_quality_flag",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    l4_quality_flag (info->reader->asset, info->reader->resource, SafeString("%s/l4_quality_flag",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints),
-    surface_flag    (info->reader->asset, info->reader->resource, SafeString("%s/surface_flag",     GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, region.first_footprint, region.num_footprints)
+Gedi04aReader::Gedi04a::Gedi04a (info_t* info, long first_footprint, long num_footprints):
+    shot_number     (info->reader->asset, info->reader->resource, SafeString("%s/shot_number",      GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    delta_time      (info->reader->asset, info->reader->resource, SafeString("%s/delta_time",       GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    agbd            (info->reader->asset, info->reader->resource, SafeString("%s/agbd",             GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    elev_lowestmode (info->reader->asset, info->reader->resource, SafeString("%s/elev_lowestmode",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    solar_elevation (info->reader->asset, info->reader->resource, SafeString("%s/solar_elevation",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    degrade_flag    (info->reader->asset, info->reader->resource, SafeString("%s/degrade_flag",     GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    l2_quality_flag (info->reader->asset, info->reader->resource, SafeString("%s/l2_quality_flag",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    l4_quality_flag (info->reader->asset, info->reader->resource, SafeString("%s/l4_quality_flag",  GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints),
+    surface_flag    (info->reader->asset, info->reader->resource, SafeString("%s/surface_flag",     GediParms::beam2group(info->beam)).getString(), &info->reader->context, 0, first_footprint, num_footprints)
 {
 
     /* Join Hardcoded Reads */
@@ -461,155 +473,315 @@ void Gedi04aReader::postRecordBatch (stats_t* local_stats)
 }
 
 /*----------------------------------------------------------------------------
- * subsettingThread
+ * partitionCount
+ *
+ *  number of workers subsetting the footprints of the granule; zero sizes
+ *  the workers to the node
  *----------------------------------------------------------------------------*/
-void* Gedi04aReader::subsettingThread (void* parm)
+int Gedi04aReader::partitionCount (void)
 {
-    /* Get Thread Info */
-    info_t* info = (info_t*)parm;
-    Gedi04aReader* reader = info->reader;
-    GediParms* parms = reader->parms;
-    stats_t local_stats = {0, 0, 0, 0, 0};
+    if(parms->partitions > 0) return parms->partitions;
+    return MAX(1, LocalLib::nproc());
+}
 
-    /* Start Trace */
-    uint32_t trace_id = start_trace(INFO, reader->traceId, "gedi04a_reader", "{\"asset\":\"%s\", \"resource\":\"%s\", \"beam\":%d}", reader->asset->getName(), reader->resource, info->beam);
-    EventLib::stashId (trace_id); // set thread specific trace id for H5Coro
+/*----------------------------------------------------------------------------
+ * acquireWorkers
+ *
+ *  takes the workers for the chunk pool out of the node's thread budget;
+ *  an explicit partition count is honored, otherwise the request gets the
+ *  share of the unused budget its priority allows
+ *----------------------------------------------------------------------------*/
+int Gedi04aReader::acquireWorkers (int max_workers)
+{
+    int wanted = MIN(partitionCount(), max_workers);
+    if(wanted <= 0) return 0;
+    if(parms->partitions > 0)
+    {
+        ThreadBudget::reserve(wanted);
+        return wanted;
+    }
+    return ThreadBudget::acquire(wanted, parms->priority);
+}
 
-    try
+/*----------------------------------------------------------------------------
+ * planChunks
+ *
+ *  splits the subsetted footprints of every beam into contiguous chunks
+ *  sized so each worker gets about one chunk, but never so small that the
+ *  per chunk dataset reads dominate
+ *----------------------------------------------------------------------------*/
+void Gedi04aReader::planChunks (long total_footprints)
+{
+    int num_workers = partitionCount();
+    long chunk_size = MAX(MIN_CHUNK_FOOTPRINTS, (total_footprints + num_workers - 1) / num_workers);
+
+    /* Count Chunks */
+    numChunks = 0;
+    for(int b = 0; b < numBeams; b++)
     {
-        /* Subset to Region of Interest */
-        Region region(info);
+        if(!beams[b].region) continue;
+        numChunks += (beams[b].region->num_footprints + chunk_size - 1) / chunk_size;
+    }
+
+    /* Populate Chunks */
+    chunks = new chunk_t [numChunks];
+    int c = 0;
+    for(int b = 0; b < numBeams; b++)
+    {
+        if(!beams[b].region) continue;
+        long num_footprints = beams[b].region->num_footprints;
+        for(long first = 0; first < num_footprints; first += chunk_size)
+        {
+            chunks[c++] = {&beams[b], first, MIN(chunk_size, num_footprints - first)};
+        }
+    }
+    nextChunk = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * subsetChunk
+ *----------------------------------------------------------------------------*/
+void Gedi04aReader::subsetChunk (chunk_t* chunk, stats_t* local_stats)
+{
+    info_t* info = chunk->info;
+    Region& region = *info->region;
+
+    /* Read GEDI Datasets */
+    Gedi04a gedi04a(info, region.first_footprint + chunk->first, chunk->count);
 
-        /* Read GEDI Datasets */
-        Gedi04a gedi04a(info, region);
+    /* Increment Read Statistics */
+    local_stats->footprints_read += chunk->count;
 
-        /* Increment Read Statistics */
-        local_stats.footprints_read = region.num_footprints;
+    /* Traverse All Footprints In Chunk */
+    for(long footprint = 0; active && footprint < chunk->count; footprint++)
+    {
+        long region_footprint = chunk->first + footprint;
 
-        /* Traverse All Footprints In Dataset */
-        for(long footprint = 0; reader->active && footprint < region.num_footprints; footprint++)
+        /* Check Degrade Filter */
+        if(parms->degrade_filter != GediParms::DEGRADE_UNFILTERED)
         {
-            /* Check Degrade Filter */
-            if(parms->degrade_filter != GediParms::DEGRADE_UNFILTERED)
+            if(gedi04a.degrade_flag[footprint] != parms->degrade_filter)
             {
-                if(gedi04a.degrade_flag[footprint] != parms->degrade_filter)
-                {
-                    local_stats.footprints_filtered++;
-                    continue;
-                }
+                local_stats->footprints_filtered++;
+                continue;
             }
+        }
 
-            /* Check L2 Quality Filter */
-            if(parms->l2_quality_filter != GediParms::L2QLTY_UNFILTERED)
+        /* Check L2 Quality Filter */
+        if(parms->l2_quality_filter != GediParms::L2QLTY_UNFILTERED)
+        {
+            if(gedi04a.l2_quality_flag[footprint] != parms->l2_quality_filter)
             {
-                if(gedi04a.l2_quality_flag[footprint] != parms->l2_quality_filter)
-                {
-                    local_stats.footprints_filtered++;
-                    continue;
-                }
+                local_stats->footprints_filtered++;
+                continue;
             }
+        }
 
-            /* Check L4 Quality Filter */
-            if(parms->l4_quality_filter != GediParms::L4QLTY_UNFILTERED)
+        /* Check L4 Quality Filter */
+        if(parms->l4_quality_filter != GediParms::L4QLTY_UNFILTERED)
+        {
+            if(gedi04a.l4_quality_flag[footprint] != parms->l4_quality_filter)
             {
-                if(gedi04a.l4_quality_flag[footprint] != parms->l4_quality_filter)
-                {
-                    local_stats.footprints_filtered++;
-                    continue;
-                }
+                local_stats->footprints_filtered++;
+                continue;
             }
+        }
 
-            /* Check Surface Filter */
-            if(parms->surface_filter != GediParms::SURFACE_UNFILTERED)
+        /* Check Surface Filter */
+        if(parms->surface_filter != GediParms::SURFACE_UNFILTERED)
+        {
+            if(gedi04a.surface_flag[footprint] != parms->surface_filter)
             {
-                if(gedi04a.surface_flag[footprint] != parms->surface_filter)
-                {
-                    local_stats.footprints_filtered++;
-                    continue;
-                }
+                local_stats->footprints_filtered++;
+                continue;
             }
+        }
 
-            /* Check Region */
-            if(region.inclusion_ptr)
+        /* Check Region */
+        if(region.inclusion_ptr)
+        {
+            if(!region.inclusion_ptr[region_footprint])
             {
-                if(!region.inclusion_ptr[footprint])
-                {
-                    continue;
-                }
+                continue;
             }
+        }
 
-            reader->threadMut.lock();
+        threadMut.lock();
+        {
+            /* Populate Entry in Batch Structure */
+            footprint_t* fp     = &batchData->footprint[batchIndex];
+            fp->shot_number     = gedi04a.shot_number[footprint];
+            fp->delta_time      = gedi04a.delta_time[footprint];
+            fp->latitude        = region.lat_lowestmode[region_footprint];
+            fp->longitude       = region.lon_lowestmode[region_footprint];
+            fp->agbd            = gedi04a.agbd[footprint];
+            fp->elevation       = gedi04a.elev_lowestmode[footprint];
+            fp->solar_elevation = gedi04a.solar_elevation[footprint];
+            fp->beam            = info->beam;
+            fp->flags           = 0;
+            if(gedi04a.degrade_flag[footprint])     fp->flags |= DEGRADE_FLAG;
+            if(gedi04a.l2_quality_flag[footprint])  fp->flags |= L2_QUALITY_FLAG;
+            if(gedi04a.l4_quality_flag[footprint])  fp->flags |= L4_QUALITY_FLAG;
+            if(gedi04a.surface_flag[footprint])     fp->flags |= SURFACE_FLAG;
+
+            /* Send Record */
+            batchIndex++;
+            if(batchIndex >= BATCH_SIZE)
             {
-                /* Populate Entry in Batch Structure */
-                footprint_t* fp     = &reader->batchData->footprint[reader->batchIndex];
-                fp->shot_number     = gedi04a.shot_number[footprint];
-                fp->delta_time      = gedi04a.delta_time[footprint];
-                fp->latitude        = region.lat_lowestmode[footprint];
-                fp->longitude       = region.lon_lowestmode[footprint];
-                fp->agbd            = gedi04a.agbd[footprint];
-                fp->elevation       = gedi04a.elev_lowestmode[footprint];
-                fp->solar_elevation = gedi04a.solar_elevation[footprint];
-                fp->beam            = info->beam;
-                fp->flags           = 0;
-                if(gedi04a.degrade_flag[footprint])     fp->flags |= DEGRADE_FLAG;
-                if(gedi04a.l2_quality_flag[footprint])  fp->flags |= L2_QUALITY_FLAG;
-                if(gedi04a.l4_quality_flag[footprint])  fp->flags |= L4_QUALITY_FLAG;
-                if(gedi04a.surface_flag[footprint])     fp->flags |= SURFACE_FLAG;
-
-                /* Send Record */
-                reader->batchIndex++;
-                if(reader->batchIndex >= BATCH_SIZE)
-                {
-                    reader->postRecordBatch(&local_stats);
-                    reader->batchIndex = 0;
-                }
+                postRecordBatch(local_stats);
+                batchIndex = 0;
             }
-            reader->threadMut.unlock();
         }
+        threadMut.unlock();
     }
-    catch(const RunTimeException& e)
+}
+
+/*----------------------------------------------------------------------------
+ * regionThread
+ *
+ *  reads the geolocation of every beam concurrently and subsets each beam
+ *  once, then hands the subsetted footprints to a pool of chunk workers
+ *----------------------------------------------------------------------------*/
+void* Gedi04aReader::regionThread (void* parm)
+{
+    Gedi04aReader* reader = (Gedi04aReader*)parm;
+
+    /* Start Trace */
+    uint32_t trace_id = start_trace(INFO, reader->traceId, "gedi04a_region", "{\"asset\":\"%s\", \"resource\":\"%s\"}", reader->asset->getName(), reader->resource);
+    EventLib::stashId (trace_id); // set thread specific trace id for H5Coro
+    RequestAccount* previous = RequestAccount::attach(reader->account);
+
+    /* Issue Geolocation Reads for All Beams */
+    for(int b = 0; b < reader->numBeams; b++)
+    {
+        info_t* info = &reader->beams[b];
+        try
+        {
+            info->region = new Region(info);
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failure during processing of resource %s beam %d: %s", reader->resource, info->beam, e.what());
+            LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), reader->resource);
+        }
+    }
+
+    /* Subset Each Beam to Region of Interest */
+    long total_footprints = 0;
+    for(int b = 0; b < reader->numBeams; b++)
+    {
+        info_t* info = &reader->beams[b];
+        if(!info->region) continue;
+        try
+        {
+            info->region->subset(info);
+            total_footprints += info->region->num_footprints;
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failure during processing of resource %s beam %d: %s", reader->resource, info->beam, e.what());
+            LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), reader->resource);
+            delete info->region;
+            info->region = NULL;
+        }
+    }
+
+    /* Subset Chunks with Pool of Workers */
+    reader->planChunks(total_footprints);
+    int num_workers = reader->acquireWorkers(reader->numChunks);
+    Thread** pids = new Thread* [num_workers];
+    for(int w = 0; w < num_workers; w++)
     {
-        mlog(e.level(), "Failure during processing of resource %s beam %d: %s", reader->resource, info->beam, e.what());
-        LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), reader->resource);
+        pids[w] = new Thread(chunkThread, reader);
     }
+    for(int w = 0; w < num_workers; w++)
+    {
+        delete pids[w]; // joins
+    }
+    delete [] pids;
+    ThreadBudget::release(num_workers);
+
+    /* Settle Account before Completion is Signaled */
+    RequestAccount::detach(previous);
 
     /* Handle Global Reader Updates */
     reader->threadMut.lock();
     {
-        /* Count Completion */
-        reader->numComplete++;
-
         /* Send Final Record Batch */
-        if(reader->numComplete == reader->threadCount)
+        mlog(INFO, "Completed processing resource %s", reader->resource);
+        if(reader->batchIndex > 0)
         {
-            mlog(INFO, "Completed processing resource %s", info->reader->resource);
-            if(reader->batchIndex > 0)
-            {
-                reader->postRecordBatch(&local_stats);
-            }
+            reader->postRecordBatch(&reader->stats);
+        }
+
+        /* Indicate End of Data */
+        if(reader->sendTerminator) reader->outQ->postCopy("", 0);
+        reader->signalComplete();
+    }
+    reader->threadMut.unlock();
+
+    /* Clean Up Regions */
+    for(int b = 0; b < reader->numBeams; b++)
+    {
+        delete reader->beams[b].region;
+        reader->beams[b].region = NULL;
+    }
+
+    /* Stop Trace */
+    stop_trace(INFO, trace_id);
+
+    /* Return */
+    ThreadBudget::release(1);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * chunkThread
+ *----------------------------------------------------------------------------*/
+void* Gedi04aReader::chunkThread (void* parm)
+{
+    Gedi04aReader* reader = (Gedi04aReader*)parm;
+    stats_t local_stats = {0, 0, 0, 0, 0};
+    RequestAccount* previous = RequestAccount::attach(reader->account);
+
+    /* Subset Chunks Until None Are Left */
+    int c;
+    while(reader->active && (c = reader->nextChunk++) < reader->numChunks)
+    {
+        chunk_t* chunk = &reader->chunks[c];
+        info_t* info = chunk->info;
+
+        /* Start Trace */
+        uint32_t trace_id = start_trace(INFO, reader->traceId, "gedi04a_reader", "{\"asset\":\"%s\", \"resource\":\"%s\", \"beam\":%d, \"first\":%ld}", reader->asset->getName(), reader->resource, info->beam, chunk->first);
+        EventLib::stashId (trace_id); // set thread specific trace id for H5Coro
+
+        try
+        {
+            reader->subsetChunk(chunk, &local_stats);
+        }
+        catch(const RunTimeException& e)
+        {
+            mlog(e.level(), "Failure during processing of resource %s beam %d: %s", reader->resource, info->beam, e.what());
+            LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), reader->resource);
         }
 
-        /* Update Statistics */
+        /* Stop Trace */
+        stop_trace(INFO, trace_id);
+    }
+
+    /* Update Statistics */
+    reader->threadMut.lock();
+    {
         reader->stats.footprints_read += local_stats.footprints_read;
         reader->stats.footprints_filtered += local_stats.footprints_filtered;
         reader->stats.footprints_sent += local_stats.footprints_sent;
         reader->stats.footprints_dropped += local_stats.footprints_dropped;
         reader->stats.footprints_retried += local_stats.footprints_retried;
-
-        /* Indicate End of Data */
-        if(reader->numComplete == reader->threadCount)
-        {
-            if(reader->sendTerminator) reader->outQ->postCopy("", 0);
-            reader->signalComplete();
-        }
     }
     reader->threadMut.unlock();
 
-    /* Clean Up Info */
-    delete info;
-
-    /* Stop Trace */
-    stop_trace(INFO, trace_id);
+    /* Settle Account */
+    RequestAccount::detach(previous);
 
     /* Return */
     return NULL;
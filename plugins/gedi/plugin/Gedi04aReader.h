@@ -61,6 +61,7 @@ class Gedi04aReader: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int BATCH_SIZE = 256;
+        static const long MIN_CHUNK_FOOTPRINTS = 8192;
 
         static const char* fpRecType;
         static const RecordObject::fieldDef_t fpRecDef[];
@@ -125,11 +126,21 @@ class Gedi04aReader: public LuaObject
          * Types
          *--------------------------------------------------------------------*/
 
+        class Region;
+
         typedef struct {
             Gedi04aReader*  reader;
             int             beam;
+            Region*         region;     // set by region prepass, NULL if beam not subsetted
         } info_t;
 
+        /* Contiguous Run of Footprints in a Beam */
+        typedef struct {
+            info_t*         info;
+            long            first;      // first footprint, relative to region
+            long            count;
+        } chunk_t;
+
         /* Region Subclass */
         class Region
         {
@@ -138,6 +149,7 @@ class Gedi04aReader: public LuaObject
                 Region              (info_t* info);
                 ~Region             (void);
 
+                void subset         (info_t* info);
                 void cleanup        (void);
                 void polyregion     (info_t* info);
                 void rasterregion   (info_t* info);
@@ -157,7 +169,7 @@ class Gedi04aReader: public LuaObject
         {
             public:
 
-                Gedi04a             (info_t* info, Region& region);
+                Gedi04a             (info_t* info, long first_footprint, long num_footprints);
                 ~Gedi04a            (void);
 
                 H5Array<uint64_t>   shot_number;
@@ -176,10 +188,13 @@ class Gedi04aReader: public LuaObject
          *--------------------------------------------------------------------*/
 
         bool                active;
-        Thread*             readerPid[GediParms::NUM_BEAMS];
+        Thread*             regionPid;
         Mutex               threadMut;
-        int                 threadCount;
-        int                 numComplete;
+        info_t              beams[GediParms::NUM_BEAMS];
+        int                 numBeams;
+        chunk_t*            chunks;
+        int                 numChunks;
+        std::atomic<int>    nextChunk;
         Asset*              asset;
         const char*         resource;
         bool                sendTerminator;
@@ -199,7 +214,12 @@ class Gedi04aReader: public LuaObject
                             Gedi04aReader           (lua_State* L, Asset* _asset, const char* _resource, const char* outq_name, GediParms* _parms, bool _send_terminator=true);
                             ~Gedi04aReader          (void);
         void                postRecordBatch         (stats_t* local_stats);
-        static void*        subsettingThread        (void* parm);
+        int                 partitionCount          (void);
+        int                 acquireWorkers          (int max_workers);
+        void                planChunks              (long total_footprints);
+        void                subsetChunk             (chunk_t* chunk, stats_t* local_stats);
+        static void*        regionThread            (void* parm);
+        static void*        chunkThread             (void* parm);
         static int          luaStats                (lua_State* L);
 };
 
@@ -55,6 +55,8 @@ const char* GediParms::RQST_TIMEOUT     = "rqst-timeout";
 const char* GediParms::NODE_TIMEOUT     = "node-timeout";
 const char* GediParms::READ_TIMEOUT     = "read-timeout";
 const char* GediParms::GLOBAL_TIMEOUT   = "timeout";
+const char* GediParms::PARTITIONS       = "partitions";
+const char* GediParms::PRIORITY         = "priority";
 
 const uint8_t GediParms::BEAM_NUMBER[NUM_BEAMS] = {0, 1, 2, 3, 5, 6, 8, 11};
 
@@ -126,7 +128,9 @@ GediParms::GediParms(lua_State* L, int index):
     surface_filter              (SURFACE_UNFILTERED),
     rqst_timeout                (DEFAULT_RQST_TIMEOUT),
     node_timeout                (DEFAULT_NODE_TIMEOUT),
-    read_timeout                (DEFAULT_READ_TIMEOUT)
+    read_timeout                (DEFAULT_READ_TIMEOUT),
+    partitions                  (0),
+    priority                    (ThreadBudget::NORMAL_PRIORITY)
 {
     bool provided = false;
 
@@ -205,6 +209,18 @@ GediParms::GediParms(lua_State* L, int index):
         surface_filter = (surface_t)LuaObject::getLuaInteger(L, -1, true, surface_filter, &provided);
         if(provided) mlog(DEBUG, "Setting %s to %d", GediParms::SURFACE_FLAG, surface_filter);
         lua_pop(L, 1);
+
+        /* Partitions */
+        lua_getfield(L, index, GediParms::PARTITIONS);
+        partitions = LuaObject::getLuaInteger(L, -1, true, partitions, &provided);
+        if(provided) mlog(DEBUG, "Setting %s to %d", GediParms::PARTITIONS, partitions);
+        lua_pop(L, 1);
+
+        /* Priority */
+        lua_getfield(L, index, GediParms::PRIORITY);
+        priority = LuaObject::getLuaInteger(L, -1, true, priority, &provided);
+        if(provided) mlog(DEBUG, "Setting %s to %d", GediParms::PRIORITY, priority);
+        lua_pop(L, 1);
     }
     catch(const RunTimeException& e)
     {
@@ -113,6 +113,8 @@ class GediParms: public LuaObject
         static const char* NODE_TIMEOUT;
         static const char* READ_TIMEOUT;
         static const char* GLOBAL_TIMEOUT; // sets all timeouts at once
+        static const char* PARTITIONS;
+        static const char* PRIORITY;
 
         static const int DEFAULT_RQST_TIMEOUT       = 600; // seconds
         static const int DEFAULT_NODE_TIMEOUT       = 600; // seconds
@@ -145,6 +147,8 @@ class GediParms: public LuaObject
         int                     rqst_timeout;                   // total time in seconds for request to be processed
         int                     node_timeout;                   // time in seconds for a single node to work on a distributed request (used for proxied requests)
         int                     read_timeout;                   // time in seconds for a single read of an asset to take
+        int                     partitions;                     // workers subsetting the footprints of a granule (0 to size to the node)
+        int                     priority;                       // share of the node thread budget the request may take (ThreadBudget::priority_t)
 
     private:
 
@@ -43,7 +43,7 @@ end
 local flatten = false
 if parms[arrow.PARMS] then
     local output_parms = arrow.parms(parms[arrow.PARMS])
-    if output_parms:isparquet() then
+    if output_parms:isparquet() or output_parms:isarrow() then
         flatten = true
     end
 end
@@ -35,7 +35,7 @@ local output_dispatch = nil
 if parms[arrow.PARMS] then
     local output_parms = arrow.parms(parms[arrow.PARMS])
     -- Parquet Writer --
-    if output_parms:isparquet() then
+    if output_parms:isparquet() or output_parms:isarrow() then
         rsps_from_nodes = rspq .. "-parquet"
         terminate_proxy_stream = true
         local except_pub = core.publish(rspq)
@@ -48,27 +48,35 @@ if parms[arrow.PARMS] then
     end
 end
 
+-- Pack Parameters --
+-- parameters are parsed once here and sent to each node as a packed blob
+local rqst_parms = icesat2.parms(parms)
+if rqst_parms then
+    parms["packed_parms"] = rqst_parms:pack()
+    parms["poly"] = nil
+end
+
 -- Proxy Request --
-local proxy = netsvc.proxy("atl03s", resources, json.encode(parms), node_timeout, rsps_from_nodes, terminate_proxy_stream)
+-- node records go straight to the client unless a local dispatcher needs them
+local passthru = not terminate_proxy_stream
+local proxy = netsvc.proxy("atl03s", resources, json.encode(parms), node_timeout, rsps_from_nodes, terminate_proxy_stream, nil, nil, passthru)
 
 -- Wait Until Proxy Completes --
-local duration = 0
-local interval = 10 < timeout and 10 or timeout -- seconds
-while (userlog:numsubs() > 0) and not proxy:waiton(interval * 1000) do
-    duration = duration + interval
-    if timeout >= 0 and duration >= timeout then
-        userlog:sendlog(core.ERROR, string.format("proxy request <%s> timed-out after %d seconds", rspq, duration))
-        do return end
-    end
+-- waiton returns as soon as the proxy completes, the client disconnects, or the timeout expires
+local start = time.latch()
+local function remaining_ms ()
+    if timeout < 0 then return core.PEND end
+    return math.max(math.floor((timeout - (time.latch() - start)) * 1000), 0)
+end
+if not proxy:waiton(remaining_ms(), rspq) and (userlog:numsubs() > 0) then
+    userlog:sendlog(core.ERROR, string.format("proxy request <%s> timed-out after %d seconds", rspq, time.latch() - start))
+    do return end
 end
 
 -- Wait Until Dispatch Completion --
 if terminate_proxy_stream then
-    while (userlog:numsubs() > 0) and not output_dispatch:waiton(interval * 1000) do
-        duration = duration + interval
-        if timeout >= 0 and duration >= timeout then
-            userlog:sendlog(core.ERROR, string.format("proxy dispatch <%s> timed-out after %d seconds", rspq, duration))
-            do return end
-        end
+    if not output_dispatch:waiton(remaining_ms(), rspq) and (userlog:numsubs() > 0) then
+        userlog:sendlog(core.ERROR, string.format("proxy dispatch <%s> timed-out after %d seconds", rspq, time.latch() - start))
+        do return end
     end
 end
@@ -16,6 +16,8 @@
 -- NOTES:       1. The rqst is provided by arg[1] which is a json object provided by caller
 --              2. The rspq is the system provided output queue name string
 --              3. The output is a raw binary blob containing serialized 'atl06rec' and 'atl06rec.elevation' RecordObjects
+--              4. When parms["grid"] = {cellsize=<cell size>, epsg=<crs>, field=<elevation field>, hist_min=<min>, hist_max=<max>, sketch=<true|false>}
+--                 is supplied, the elevations are binned and a 'gridrec' of per cell statistics is returned instead
 --
 
 local json = require("json")
@@ -55,10 +57,31 @@ local rqst_parms = icesat2.parms(parms)
 local except_pub = core.publish(rspq)
 atl06_disp:attach(except_pub, "exceptrec") -- exception records
 atl06_disp:attach(except_pub, "extrec") -- ancillary records
+atl06_disp:attach(except_pub, "extrec.packed") -- packed ancillary records
+
+-- Grid Output --
+-- elevations are binned into a grid on the node and only the grid is returned
+local grid_disp = nil
+local atl06_outq = rspq
+if parms["grid"] then
+    local grid_parms = parms["grid"]
+    local atl06_rec_type = parms["compact"] and "atl06rec-compact" or "atl06rec"
+    local elevation_rec_type = parms["compact"] and "atl06rec-compact.elevation" or "atl06rec.elevation"
+    local grid = geo.grid(rspq, elevation_rec_type, "lon", "lat", grid_parms["field"] or "h_mean", grid_parms["cellsize"] or 0, grid_parms["epsg"], grid_parms["hist_min"], grid_parms["hist_max"], grid_parms["sketch"])
+    if not grid then
+        userlog:sendlog(core.ERROR, string.format("request <%s> failed to create grid for %s", rspq, resource))
+        do return end
+    end
+    atl06_outq = rspq .. "-grid"
+    grid_disp = core.dispatcher(atl06_outq, 1)
+    grid_disp:attach(grid, atl06_rec_type)
+    grid_disp:attach(except_pub, "exceptrec") -- exception records
+    grid_disp:run()
+end
 
 -- ATL06 Dispatch Algorithm --
-local atl06_algo = icesat2.atl06(rspq, rqst_parms)
-atl06_disp:attach(atl06_algo, "atl03rec")
+local atl06_algo = icesat2.atl06(atl06_outq, rqst_parms)
+atl06_disp:attach(atl06_algo, "atl03rec.columnar")
 
 -- Raster Sampler --
 local sampler_disp = nil
@@ -89,7 +112,7 @@ atl06_disp:run()
 userlog:sendlog(core.INFO, string.format("request <%s> atl06 processing initiated on %s ...", rspq, resource))
 
 -- ATL03 Reader --
-local atl03_reader = icesat2.atl03(asset, resource, recq, rqst_parms, true)
+local atl03_reader = icesat2.atl03(asset, resource, recq, rqst_parms, true, false, true) -- columnar extents
 
 -- Wait Until Reader Completion --
 while (userlog:numsubs() > 0) and not atl03_reader:waiton(interval * 1000) do
@@ -117,6 +140,20 @@ while (userlog:numsubs() > 0) and not atl06_disp:waiton(interval * 1000) do
     userlog:sendlog(core.INFO, string.format("request <%s> ... continuing to process ATL03 records (after %d seconds)", rspq, duration))
 end
 
+-- Wait Until Grid Dispatch Completion --
+if grid_disp then
+    grid_disp:aot() -- aborts on next timeout, then posts the grid
+    while (userlog:numsubs() > 0) and not grid_disp:waiton(interval * 1000) do
+        duration = duration + interval
+        -- Check for Timeout --
+        if timeout >= 0 and duration >= timeout then
+            userlog:sendlog(core.ERROR, string.format("request <%s> timed-out after %d seconds", rspq, duration))
+            do return end
+        end
+        userlog:sendlog(core.INFO, string.format("request <%s> ... continuing to grid ATL06 records (after %d seconds)", rspq, duration))
+    end
+end
+
 -- Wait Until Sampler Dispatch Completion --
 if sampler_disp then
     sampler_disp:aot() -- aborts on next timeout
@@ -0,0 +1,58 @@
+--
+-- ENDPOINT:    /source/atl0608p
+--
+-- PURPOSE:     fan out combined atl06 and atl08 requests to multiple back-end servers and collect responses
+--
+-- INPUT:       rqst
+--              {
+--                  "resources":    ["<url of hdf5 file or object>", ...],
+--                  "parms":        {<table of parameters>},
+--              }
+--
+--              rspq - output queue to stream results
+--
+-- OUTPUT:      stream of responses
+--
+
+local json = require("json")
+
+-- Create User Status --
+local userlog = msg.publish(rspq)
+
+-- Request Parameters --
+local rqst = json.decode(arg[1])
+local resources = rqst["resources"]
+local parms = rqst["parms"]
+local timeout = parms["rqst-timeout"] or parms["timeout"] or icesat2.RQST_TIMEOUT
+local node_timeout = parms["node-timeout"] or parms["timeout"] or icesat2.NODE_TIMEOUT
+
+-- Check Output Options --
+-- the combined stream carries two record types, which a single parquet builder cannot hold
+if parms[arrow.PARMS] then
+    userlog:sendlog(core.ERROR, string.format("proxy request <%s> does not support arrow output for combined atl06 and atl08 products", rspq))
+    do return end
+end
+
+-- Pack Parameters --
+-- parameters are parsed once here and sent to each node as a packed blob
+local rqst_parms = icesat2.parms(parms)
+if rqst_parms then
+    parms["packed_parms"] = rqst_parms:pack()
+    parms["poly"] = nil
+end
+
+-- Proxy Request --
+-- node records go straight to the client
+local proxy = netsvc.proxy("atl0608", resources, json.encode(parms), node_timeout, rspq, false, nil, nil, true)
+
+-- Wait Until Proxy Completes --
+-- waiton returns as soon as the proxy completes, the client disconnects, or the timeout expires
+local start = time.latch()
+local function remaining_ms ()
+    if timeout < 0 then return core.PEND end
+    return math.max(math.floor((timeout - (time.latch() - start)) * 1000), 0)
+end
+if not proxy:waiton(remaining_ms(), rspq) and (userlog:numsubs() > 0) then
+    userlog:sendlog(core.ERROR, string.format("proxy request <%s> timed-out after %d seconds", rspq, time.latch() - start))
+    do return end
+end
@@ -55,10 +55,11 @@ local rqst_parms = icesat2.parms(parms)
 local except_pub = core.publish(rspq)
 atl08_disp:attach(except_pub, "exceptrec") -- exception records
 atl08_disp:attach(except_pub, "extrec") -- ancillary records
+atl08_disp:attach(except_pub, "extrec.packed") -- packed ancillary records
 
 -- ATL08 Dispatch Algorithm --
 local atl08_algo = icesat2.atl08(rspq, rqst_parms)
-atl08_disp:attach(atl08_algo, "atl03rec")
+atl08_disp:attach(atl08_algo, "atl03rec.columnar")
 
 -- Raster Sampler --
 local sampler_disp = nil
@@ -89,7 +90,7 @@ atl08_disp:run()
 userlog:sendlog(core.INFO, string.format("request <%s> atl08 processing initiated on %s ...", rspq, resource))
 
 -- ATL03 Reader --
-local atl03_reader = icesat2.atl03(asset, resource, recq, rqst_parms, true)
+local atl03_reader = icesat2.atl03(asset, resource, recq, rqst_parms, true, false, true) -- columnar extents
 
 -- Wait Until Reader Completion --
 while (userlog:numsubs() > 0) and not atl03_reader:waiton(interval * 1000) do
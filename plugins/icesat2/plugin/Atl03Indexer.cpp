@@ -34,6 +34,7 @@
  ******************************************************************************/
 
 #include "core.h"
+#include "h5.h"
 #include "icesat2.h"
 
 /******************************************************************************
@@ -52,6 +53,18 @@ const RecordObject::fieldDef_t Atl03Indexer::recDef[] = {
     {"cycle",   RecordObject::UINT32,   offsetof(index_t, cycle),   1,                              NULL, NATIVE_FLAGS},
     {"rgt",     RecordObject::UINT32,   offsetof(index_t, rgt),     1,                              NULL, NATIVE_FLAGS},
 };
+const char* Atl03Indexer::DATASETS[NUM_DATASETS] = {
+    "/ancillary_data/atlas_sdp_gps_epoch",
+    "/ancillary_data/start_delta_time",
+    "/ancillary_data/end_delta_time",
+    "/orbit_info/cycle_number",
+    "/orbit_info/rgt",
+    "/gt3r/geolocation/reference_photon_lat",
+    "/gt3r/geolocation/reference_photon_lon",
+    "/gt1l/geolocation/reference_photon_lat",
+    "/gt1l/geolocation/reference_photon_lon"
+};
+
 const char* Atl03Indexer::OBJECT_TYPE = "Atl03Indexer";
 const char* Atl03Indexer::LuaMetaName = "Atl03Indexer";
 const struct luaL_Reg Atl03Indexer::LuaMetaTable[] = {
@@ -193,6 +206,11 @@ Atl03Indexer::~Atl03Indexer (void)
 
 /*----------------------------------------------------------------------------
  * indexerThread
+ *
+ *  each thread takes up to GRANULES_IN_FLIGHT resources at a time and posts
+ *  the reads for all of them before waiting on the first, so the reads of
+ *  many granules are outstanding at once; a granule that fails to index is
+ *  reported and skipped
  *----------------------------------------------------------------------------*/
 void* Atl03Indexer::indexerThread (void* parm)
 {
@@ -203,102 +221,60 @@ void* Atl03Indexer::indexerThread (void* parm)
     /* Start Trace */
     uint32_t trace_id = start_trace(CRITICAL, indexer->traceId, "atl03_indexer", "{\"tag\":\"%s\"}", indexer->getName());
     EventLib::stashId (trace_id); // set thread specific trace id for H5Lib
+    RequestAccount* previous = RequestAccount::attach(indexer->account);
 
-    /* Build Prefix */
-    char prefix[MAX_STR_SIZE];
-    StringLib::format(prefix, MAX_STR_SIZE, "%s://%s/", indexer->asset->getFormat(), indexer->asset->getPath());
-
-    /* Initialize Context */
-    H5Coro::context_t* context = NULL;
+    /* Granules Being Indexed */
+    granule_t granules[GRANULES_IN_FLIGHT];
 
-    try
+    while(!complete && indexer->active)
     {
-        while(!complete)
+        int num_granules = 0;
+
+        /* Get Next Resources in List */
+        indexer->resourceMut.lock();
         {
-            const char* resource_name = NULL;
+            while(num_granules < GRANULES_IN_FLIGHT && indexer->resourceEntry < indexer->resources->length())
+            {
+                granule_t* granule = &granules[num_granules++];
+                LocalLib::set(granule, 0, sizeof(granule_t));
+                granule->resource = indexer->resources->get(indexer->resourceEntry);
+                indexer->resourceEntry++;
+            }
+        }
+        indexer->resourceMut.unlock();
+        complete = (num_granules == 0);
 
-            /* Get Next Resource in List */
-            indexer->resourceMut.lock();
+        /* Post Reads for Every Granule */
+        for(int g = 0; g < num_granules; g++)
+        {
+            try
             {
-                if(indexer->resourceEntry < indexer->resources->length())
-                {
-                    resource_name = indexer->resources->get(indexer->resourceEntry);
-                    indexer->resourceEntry++;
-                }
-                else
-                {
-                    complete = true;
-                }
+                indexer->startGranule(&granules[g]);
             }
-            indexer->resourceMut.unlock();
+            catch(const RunTimeException& e)
+            {
+                mlog(e.level(), "Unable to read %s in %s: %s", granules[g].resource, indexer->getName(), e.what());
+                freeGranule(&granules[g]);
+            }
+        }
 
-            /* Index Resource */
-            if(resource_name)
+        /* Index Granules as Reads Complete */
+        for(int g = 0; g < num_granules; g++)
+        {
+            try
+            {
+                if(granules[g].context) indexer->finishGranule(&granules[g]);
+            }
+            catch(const RunTimeException& e)
             {
-                /* Create Context */
-                context = new H5Coro::context_t;
-
-                /* Read Data from HDF5 File */
-                H5Array<double>     sdp_gps_epoch       (indexer->asset, resource_name, "/ancillary_data/atlas_sdp_gps_epoch", context);
-                H5Array<double>     start_delta_time    (indexer->asset, resource_name, "/ancillary_data/start_delta_time", context);
-                H5Array<double>     end_delta_time      (indexer->asset, resource_name, "/ancillary_data/end_delta_time", context);
-                H5Array<int8_t>     cycle               (indexer->asset, resource_name, "/orbit_info/cycle_number", context);
-                H5Array<uint16_t>   rgt                 (indexer->asset, resource_name, "/orbit_info/rgt", context);
-                H5Array<double>     gt3r_lat            (indexer->asset, resource_name, "/gt3r/geolocation/reference_photon_lat", context, 0, 0, 1);
-                H5Array<double>     gt3r_lon            (indexer->asset, resource_name, "/gt3r/geolocation/reference_photon_lon", context, 0, 0, 1);
-                H5Array<double>     gt1l_lat            (indexer->asset, resource_name, "/gt1l/geolocation/reference_photon_lat", context);
-                H5Array<double>     gt1l_lon            (indexer->asset, resource_name, "/gt1l/geolocation/reference_photon_lon", context);
-
-                /* Join Reads */
-                sdp_gps_epoch.join(H5_READ_TIMEOUT_MS, true);
-                start_delta_time.join(H5_READ_TIMEOUT_MS, true);
-                end_delta_time.join(H5_READ_TIMEOUT_MS, true);
-                cycle.join(H5_READ_TIMEOUT_MS, true);
-                rgt.join(H5_READ_TIMEOUT_MS, true);
-                gt3r_lat.join(H5_READ_TIMEOUT_MS, true);
-                gt3r_lon.join(H5_READ_TIMEOUT_MS, true);
-                gt1l_lat.join(H5_READ_TIMEOUT_MS, true);
-                gt1l_lon.join(H5_READ_TIMEOUT_MS, true);
-
-                /* Clean Up Context */
-                delete context;
-                context = NULL;
-
-                /* Allocate Record */
-                RecordObject record(recType);
-                index_t* index = (index_t*)record.getRecordData();
-
-                /* Copy In Fields */
-                StringLib::copy(index->name, resource_name, Asset::RESOURCE_NAME_LENGTH);
-                index->t0       = sdp_gps_epoch[0] + start_delta_time[0];
-                index->t1       = sdp_gps_epoch[0] + end_delta_time[0];
-                index->lat0     = gt3r_lat[0];
-                index->lon0     = gt3r_lon[0];  // TODO: verify this vs gt1l_lon
-                index->lat1     = gt1l_lat[gt1l_lat.size - 1];
-                index->lon1     = gt1l_lon[gt1l_lat.size - 1]; // TODO: verify this vs gt3r_lon
-                index->cycle    = cycle[0];
-                index->rgt      = rgt[0];
-
-                /* Post Segment Record */
-                uint8_t* rec_buf = NULL;
-                int rec_bytes = record.serialize(&rec_buf, RecordObject::REFERENCE);
-                int post_status = MsgQ::STATE_ERROR;
-                while(indexer->active && (post_status = indexer->outQ->postCopy(rec_buf, rec_bytes, SYS_TIMEOUT)) <= 0)
-                {
-                    mlog(DEBUG, "Atl03 indexer failed to post to stream %s: %d", indexer->outQ->getName(), post_status);
-                }
-
-                /* Free Record */
+                mlog(e.level(), "Unable to index %s in %s: %s", granules[g].resource, indexer->getName(), e.what());
             }
+            freeGranule(&granules[g]);
         }
     }
-    catch(const RunTimeException& e)
-    {
-        mlog(e.level(), "Unable to process resources in %s: %s", indexer->getName(), e.what());
-    }
 
-    /* Free Context */
-    if(context) delete context;
+    /* Settle Account before Completion is Signaled */
+    RequestAccount::detach(previous);
 
     /* Count Completion */
     indexer->threadMut.lock();
@@ -320,6 +296,109 @@ void* Atl03Indexer::indexerThread (void* parm)
     return NULL;
 }
 
+/*----------------------------------------------------------------------------
+ * startGranule
+ *
+ *  only the first row of gt3r and the last row of gt1l are needed, so the
+ *  number of rows in gt1l is read from its metadata (which is then cached
+ *  in the context) and the reads are issued as one batch so the blocks
+ *  they need are fetched with as few ranged requests as possible
+ *----------------------------------------------------------------------------*/
+void Atl03Indexer::startGranule (granule_t* granule)
+{
+    granule->context = new H5Coro::context_t;
+
+    /* Locate Last Row of Ground Track */
+    H5Coro::info_t meta = H5Coro::read(asset, granule->resource, DATASETS[GT1L_LAT], RecordObject::REAL, 0, 0, H5Coro::ALL_ROWS, granule->context, true);
+    if(meta.data) delete [] meta.data;
+    if(meta.numrows <= 0) throw RunTimeException(ERROR, RTE_ERROR, "no rows in %s", DATASETS[GT1L_LAT]);
+    long last_row = meta.numrows - 1;
+
+    /* Build Batch */
+    for(int d = 0; d < NUM_DATASETS; d++)
+    {
+        H5Coro::batch_rqst_t* rqst = &granule->rqsts[d];
+        rqst->datasetname = DATASETS[d];
+        rqst->valtype     = RecordObject::REAL;
+        rqst->col         = 0;
+        rqst->startrow    = 0;
+        rqst->numrows     = H5Coro::ALL_ROWS;
+        rqst->h5f         = NULL;
+    }
+    granule->rqsts[GT3R_LAT].numrows = 1;
+    granule->rqsts[GT3R_LON].numrows = 1;
+    granule->rqsts[GT1L_LAT].startrow = last_row;
+    granule->rqsts[GT1L_LAT].numrows = 1;
+    granule->rqsts[GT1L_LON].startrow = last_row;
+    granule->rqsts[GT1L_LON].numrows = 1;
+
+    /* Post Reads */
+    int num_posted = H5Coro::readBatch(asset, granule->resource, granule->rqsts, NUM_DATASETS, granule->context);
+    if(num_posted != NUM_DATASETS) throw RunTimeException(CRITICAL, RTE_ERROR, "posted %d of %d reads", num_posted, NUM_DATASETS);
+}
+
+/*----------------------------------------------------------------------------
+ * finishGranule
+ *----------------------------------------------------------------------------*/
+void Atl03Indexer::finishGranule (granule_t* granule)
+{
+    /* Join Reads */
+    double values[NUM_DATASETS];
+    for(int d = 0; d < NUM_DATASETS; d++)
+    {
+        H5Future* h5f = granule->rqsts[d].h5f;
+        H5Future::rc_t rc = h5f->wait(H5_READ_TIMEOUT_MS);
+        switch(rc)
+        {
+            case H5Future::COMPLETE:    break;
+            case H5Future::TIMEOUT:     throw RunTimeException(ERROR, RTE_TIMEOUT, "H5Future read timeout on %s", DATASETS[d]);
+            default:                    throw RunTimeException(ERROR, RTE_ERROR, "H5Future read failure on %s", DATASETS[d]);
+        }
+        if(h5f->info.elements < 1) throw RunTimeException(ERROR, RTE_ERROR, "no data read from %s", DATASETS[d]);
+        values[d] = ((double*)h5f->info.data)[0];
+    }
+
+    /* Allocate Record */
+    RecordObject record(recType);
+    index_t* index = (index_t*)record.getRecordData();
+
+    /* Copy In Fields */
+    StringLib::copy(index->name, granule->resource, Asset::RESOURCE_NAME_LENGTH);
+    index->t0       = values[SDP_GPS_EPOCH] + values[START_DELTA_TIME];
+    index->t1       = values[SDP_GPS_EPOCH] + values[END_DELTA_TIME];
+    index->lat0     = values[GT3R_LAT];
+    index->lon0     = values[GT3R_LON];  // TODO: verify this vs gt1l_lon
+    index->lat1     = values[GT1L_LAT];
+    index->lon1     = values[GT1L_LON]; // TODO: verify this vs gt3r_lon
+    index->cycle    = (int)values[CYCLE];
+    index->rgt      = (int)values[RGT];
+
+    /* Post Segment Record */
+    uint8_t* rec_buf = NULL;
+    int rec_bytes = record.serialize(&rec_buf, RecordObject::REFERENCE);
+    int post_status = MsgQ::STATE_ERROR;
+    while(active && (post_status = outQ->postCopy(rec_buf, rec_bytes, SYS_TIMEOUT)) <= 0)
+    {
+        mlog(DEBUG, "Atl03 indexer failed to post to stream %s: %d", outQ->getName(), post_status);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * freeGranule
+ *
+ *  futures are deleted before the context since outstanding reads use it
+ *----------------------------------------------------------------------------*/
+void Atl03Indexer::freeGranule (granule_t* granule)
+{
+    for(int d = 0; d < NUM_DATASETS; d++)
+    {
+        if(granule->rqsts[d].h5f) delete granule->rqsts[d].h5f;
+        granule->rqsts[d].h5f = NULL;
+    }
+    if(granule->context) delete granule->context;
+    granule->context = NULL;
+}
+
 /*----------------------------------------------------------------------------
  * freeResources
  *----------------------------------------------------------------------------*/
@@ -41,6 +41,7 @@
 #include "MsgQ.h"
 #include "Asset.h"
 #include "OsApi.h"
+#include "H5Coro.h"
 
 /******************************************************************************
  * ATL03 READER
@@ -71,7 +72,8 @@ class Atl03Indexer: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int DEFAULT_NUM_THREADS = 4;
-        static const int MAX_NUM_THREADS = 40;
+        static const int MAX_NUM_THREADS = 200;
+        static const int GRANULES_IN_FLIGHT = 8; // granules with reads outstanding per thread
         static const int H5_READ_TIMEOUT_MS = 30000; // 30 seconds
 
         static const char* recType;
@@ -91,6 +93,35 @@ class Atl03Indexer: public LuaObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        typedef enum {
+            SDP_GPS_EPOCH       = 0,
+            START_DELTA_TIME    = 1,
+            END_DELTA_TIME      = 2,
+            CYCLE               = 3,
+            RGT                 = 4,
+            GT3R_LAT            = 5,
+            GT3R_LON            = 6,
+            GT1L_LAT            = 7,
+            GT1L_LON            = 8,
+            NUM_DATASETS        = 9
+        } dataset_t;
+
+        typedef struct {
+            const char*             resource;
+            H5Coro::context_t*      context;
+            H5Coro::batch_rqst_t    rqsts[NUM_DATASETS];
+        } granule_t;
+
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const char* DATASETS[NUM_DATASETS];
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
@@ -115,6 +146,9 @@ class Atl03Indexer: public LuaObject
                             ~Atl03Indexer       (void);
 
         static void*        indexerThread       (void* parm);
+        void                startGranule        (granule_t* granule);
+        void                finishGranule       (granule_t* granule);
+        static void         freeGranule         (granule_t* granule);
         static void         freeResources       (List<const char*>* _resources);
 
         static int          luaStats            (lua_State* L);
@@ -36,6 +36,13 @@
 #include <math.h>
 #include <float.h>
 #include <stdarg.h>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include "core.h"
 #include "h5.h"
@@ -87,6 +94,33 @@ const RecordObject::fieldDef_t Atl03Reader::exRecDef[] = {
     {"data",            RecordObject::USER,     offsetof(extent_t, photons),                        0,  phRecType, NATIVE_FLAGS} // variable length
 };
 
+const char* Atl03Reader::exColRecType = "atl03rec.columnar";
+const RecordObject::fieldDef_t Atl03Reader::exColRecDef[] = {
+    {"track",           RecordObject::UINT8,    offsetof(col_extent_t, reference_pair_track),               1,  NULL, NATIVE_FLAGS},
+    {"sc_orient",       RecordObject::UINT8,    offsetof(col_extent_t, spacecraft_orientation),             1,  NULL, NATIVE_FLAGS},
+    {"rgt",             RecordObject::UINT16,   offsetof(col_extent_t, reference_ground_track_start),       1,  NULL, NATIVE_FLAGS},
+    {"cycle",           RecordObject::UINT16,   offsetof(col_extent_t, cycle_start),                        1,  NULL, NATIVE_FLAGS},
+    {"extent_id",       RecordObject::UINT64,   offsetof(col_extent_t, extent_id),                          1,  NULL, NATIVE_FLAGS},
+    {"segment_id",      RecordObject::UINT32,   offsetof(col_extent_t, segment_id[0]),                      2,  NULL, NATIVE_FLAGS},
+    {"segment_dist",    RecordObject::DOUBLE,   offsetof(col_extent_t, segment_distance[0]),                2,  NULL, NATIVE_FLAGS}, // distance from equator
+    {"background_rate", RecordObject::DOUBLE,   offsetof(col_extent_t, background_rate[0]),                 2,  NULL, NATIVE_FLAGS},
+    {"solar_elevation", RecordObject::FLOAT,    offsetof(col_extent_t, solar_elevation[0]),                 2,  NULL, NATIVE_FLAGS},
+    {"count",           RecordObject::UINT32,   offsetof(col_extent_t, photon_count[0]),                    2,  NULL, NATIVE_FLAGS},
+    {"delta_time",      RecordObject::DOUBLE,   offsetof(col_extent_t, column_offset[COL_DELTA_TIME][0]),   2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"latitude",        RecordObject::DOUBLE,   offsetof(col_extent_t, column_offset[COL_LATITUDE][0]),     2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"longitude",       RecordObject::DOUBLE,   offsetof(col_extent_t, column_offset[COL_LONGITUDE][0]),    2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"distance",        RecordObject::DOUBLE,   offsetof(col_extent_t, column_offset[COL_X_ATC][0]),        2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"height",          RecordObject::FLOAT,    offsetof(col_extent_t, column_offset[COL_HEIGHT][0]),       2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"relief",          RecordObject::FLOAT,    offsetof(col_extent_t, column_offset[COL_RELIEF][0]),       2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"landcover",       RecordObject::UINT8,    offsetof(col_extent_t, column_offset[COL_LANDCOVER][0]),    2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"snowcover",       RecordObject::UINT8,    offsetof(col_extent_t, column_offset[COL_SNOWCOVER][0]),    2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"atl08_class",     RecordObject::UINT8,    offsetof(col_extent_t, column_offset[COL_ATL08_CLASS][0]),  2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"atl03_cnf",       RecordObject::INT8,     offsetof(col_extent_t, column_offset[COL_ATL03_CNF][0]),    2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"quality_ph",      RecordObject::INT8,     offsetof(col_extent_t, column_offset[COL_QUALITY_PH][0]),   2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"yapc_score",      RecordObject::UINT8,    offsetof(col_extent_t, column_offset[COL_YAPC_SCORE][0]),   2,  NULL, NATIVE_FLAGS | RecordObject::POINTER},
+    {"data",            RecordObject::UINT8,    offsetof(col_extent_t, data),                               0,  NULL, NATIVE_FLAGS} // variable length
+};
+
 const char* Atl03Reader::phFlatRecType = "flat03rec.photons";
 const RecordObject::fieldDef_t Atl03Reader::phFlatRecDef[] = {
     {"extent_id",   RecordObject::UINT64,   offsetof(flat_photon_t, extent_id),         1,  NULL, NATIVE_FLAGS},
@@ -121,10 +155,53 @@ const RecordObject::fieldDef_t Atl03Reader::exAncRecDef[] = {
     {"data",        RecordObject::UINT8,    offsetof(anc_extent_t, data),          0,  NULL, NATIVE_FLAGS} // variable length
 };
 
+const char* Atl03Reader::phPackedRecType = "phrec.packed"; // all photon ancillary fields of an extent
+const RecordObject::fieldDef_t Atl03Reader::phPackedRecDef[] = {
+    {"extent_id",   RecordObject::UINT64,   offsetof(anc_photon_packed_t, extent_id),       1,                  NULL, NATIVE_FLAGS},
+    {"num_fields",  RecordObject::UINT8,    offsetof(anc_photon_packed_t, num_fields),      1,                  NULL, NATIVE_FLAGS},
+    {"datatype",    RecordObject::UINT8,    offsetof(anc_photon_packed_t, data_type),       MAX_PACKED_FIELDS,  NULL, NATIVE_FLAGS},
+    {"num_elements",RecordObject::UINT32,   offsetof(anc_photon_packed_t, num_elements),    2,                  NULL, NATIVE_FLAGS},
+    {"field_offset",RecordObject::UINT32,   offsetof(anc_photon_packed_t, field_offset),    MAX_PACKED_FIELDS,  NULL, NATIVE_FLAGS},
+    {"data",        RecordObject::UINT8,    offsetof(anc_photon_packed_t, data),            0,                  NULL, NATIVE_FLAGS} // variable length
+};
+
+const char* Atl03Reader::exPackedRecType = "extrec.packed"; // all extent ancillary fields of an extent
+const RecordObject::fieldDef_t Atl03Reader::exPackedRecDef[] = {
+    {"extent_id",   RecordObject::UINT64,   offsetof(anc_extent_packed_t, extent_id),       1,                  NULL, NATIVE_FLAGS},
+    {"num_fields",  RecordObject::UINT8,    offsetof(anc_extent_packed_t, num_fields),      1,                  NULL, NATIVE_FLAGS},
+    {"datatype",    RecordObject::UINT8,    offsetof(anc_extent_packed_t, data_type),       MAX_PACKED_FIELDS,  NULL, NATIVE_FLAGS},
+    {"field_offset",RecordObject::UINT32,   offsetof(anc_extent_packed_t, field_offset),    MAX_PACKED_FIELDS,  NULL, NATIVE_FLAGS},
+    {"data",        RecordObject::UINT8,    offsetof(anc_extent_packed_t, data),            0,                  NULL, NATIVE_FLAGS} // variable length
+};
+
 const double Atl03Reader::ATL03_SEGMENT_LENGTH = 20.0; // meters
 
+/* bytes per photon of each column, ordered by photon_column_t */
+static const int PhotonColumnSize[Atl03Reader::NUM_PHOTON_COLUMNS] = {
+    sizeof(double), sizeof(double), sizeof(double), sizeof(double),
+    sizeof(float), sizeof(float),
+    sizeof(uint8_t), sizeof(uint8_t), sizeof(uint8_t), sizeof(int8_t), sizeof(int8_t), sizeof(uint8_t)
+};
+
 const char* Atl03Reader::OBJECT_TYPE = "Atl03Reader";
 const char* Atl03Reader::LuaMetaName = "Atl03Reader";
+const char* Atl03Reader::METRIC_CATEGORY = "atl03";
+LatencyHistogram* Atl03Reader::subsetLatency = NULL;
+bool Atl03Reader::sharedScan = false;
+
+/* planning walks (no EXTENT_SELECT) ignore the selection options, so they share two variants */
+#define EXTENT_VARIANT(opts) &Atl03Reader::selectExtent<((opts) & EXTENT_SELECT) ? (opts) : ((opts) & EXTENT_SEGMENTS)>
+const Atl03Reader::extent_func_t Atl03Reader::extentVariants[NUM_EXTENT_VARIANTS] = {
+    EXTENT_VARIANT(0x00), EXTENT_VARIANT(0x01), EXTENT_VARIANT(0x02), EXTENT_VARIANT(0x03),
+    EXTENT_VARIANT(0x04), EXTENT_VARIANT(0x05), EXTENT_VARIANT(0x06), EXTENT_VARIANT(0x07),
+    EXTENT_VARIANT(0x08), EXTENT_VARIANT(0x09), EXTENT_VARIANT(0x0A), EXTENT_VARIANT(0x0B),
+    EXTENT_VARIANT(0x0C), EXTENT_VARIANT(0x0D), EXTENT_VARIANT(0x0E), EXTENT_VARIANT(0x0F),
+    EXTENT_VARIANT(0x10), EXTENT_VARIANT(0x11), EXTENT_VARIANT(0x12), EXTENT_VARIANT(0x13),
+    EXTENT_VARIANT(0x14), EXTENT_VARIANT(0x15), EXTENT_VARIANT(0x16), EXTENT_VARIANT(0x17),
+    EXTENT_VARIANT(0x18), EXTENT_VARIANT(0x19), EXTENT_VARIANT(0x1A), EXTENT_VARIANT(0x1B),
+    EXTENT_VARIANT(0x1C), EXTENT_VARIANT(0x1D), EXTENT_VARIANT(0x1E), EXTENT_VARIANT(0x1F)
+};
+#undef EXTENT_VARIANT
 const struct luaL_Reg Atl03Reader::LuaMetaTable[] = {
     {"parms",       luaParms},
     {"stats",       luaStats},
@@ -136,7 +213,7 @@ const struct luaL_Reg Atl03Reader::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - create(<asset>, <resource>, <outq_name>, <parms>, <send terminator>, <flatten>)
+ * luaCreate - create(<asset>, <resource>, <outq_name>, <parms>, <send terminator>, <flatten>, <columnar>)
  *----------------------------------------------------------------------------*/
 int Atl03Reader::luaCreate (lua_State* L)
 {
@@ -152,9 +229,10 @@ int Atl03Reader::luaCreate (lua_State* L)
         parms = (Icesat2Parms*)getLuaObject(L, 4, Icesat2Parms::OBJECT_TYPE);
         bool send_terminator = getLuaBoolean(L, 5, true, true);
         bool flatten = getLuaBoolean(L, 6, true, false);
+        bool columnar = getLuaBoolean(L, 7, true, false);
 
         /* Return Reader Object */
-        return createLuaObject(L, new Atl03Reader(L, asset, resource, outq_name, parms, send_terminator, flatten));
+        return createLuaObject(L, new Atl03Reader(L, asset, resource, outq_name, parms, send_terminator, flatten, columnar));
     }
     catch(const RunTimeException& e)
     {
@@ -165,6 +243,33 @@ int Atl03Reader::luaCreate (lua_State* L)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * luaSharedScan - sharedscan([<enable>])
+ *
+ *  when enabled, concurrent readers of the same granule and track attach to
+ *  one read of each dataset and apply their own region to it; returns the
+ *  current setting
+ *----------------------------------------------------------------------------*/
+int Atl03Reader::luaSharedScan (lua_State* L)
+{
+    try
+    {
+        if(lua_gettop(L) >= 1)
+        {
+            sharedScan = getLuaBoolean(L, 1);
+        }
+
+        lua_pushboolean(L, sharedScan);
+        return 1;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error setting shared scan mode: %s", e.what());
+        lua_pushnil(L);
+        return 1;
+    }
+}
+
 /*----------------------------------------------------------------------------
  * init
  *----------------------------------------------------------------------------*/
@@ -172,16 +277,155 @@ void Atl03Reader::init (void)
 {
     RECDEF(phRecType,       phRecDef,       sizeof(photon_t),       NULL);
     RECDEF(exRecType,       exRecDef,       sizeof(extent_t),       "extent_id");
+    RECDEF(exColRecType,    exColRecDef,    sizeof(col_extent_t),   "extent_id");
     RECDEF(phFlatRecType,   phFlatRecDef,   sizeof(flat_photon_t),  "extent_id");
     RECDEF(exFlatRecType,   exFlatRecDef,   1,                      NULL);
     RECDEF(phAncRecType,    phAncRecDef,    sizeof(anc_photon_t),   "extent_id");
     RECDEF(exAncRecType,    exAncRecDef,    sizeof(anc_extent_t),   "extent_id");
+    RECDEF(phPackedRecType, phPackedRecDef, sizeof(anc_photon_packed_t), "extent_id");
+    RECDEF(exPackedRecType, exPackedRecDef, sizeof(anc_extent_packed_t), "extent_id");
+
+    subsetLatency = new LatencyHistogram(METRIC_CATEGORY, "subset");
+}
+
+/*----------------------------------------------------------------------------
+ * columnsSize
+ *----------------------------------------------------------------------------*/
+int Atl03Reader::columnsSize (uint32_t num_photons)
+{
+    int size = 0;
+    for(int c = 0; c < NUM_PHOTON_COLUMNS; c++)
+    {
+        size += PhotonColumnSize[c] * num_photons;
+    }
+    return size;
+}
+
+/*----------------------------------------------------------------------------
+ * bindColumns
+ *
+ *  lays out the photon columns back to back in buffer (widest first so each
+ *  column stays aligned); buffer must hold columnsSize(num_photons) bytes
+ *  and be aligned to a double
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::bindColumns (uint8_t* buffer, uint32_t num_photons, photon_columns_t* columns)
+{
+    uint8_t* column[NUM_PHOTON_COLUMNS];
+    for(int c = 0; c < NUM_PHOTON_COLUMNS; c++)
+    {
+        column[c] = buffer;
+        buffer += PhotonColumnSize[c] * num_photons;
+    }
+
+    columns->delta_time     = (double*)column[COL_DELTA_TIME];
+    columns->latitude       = (double*)column[COL_LATITUDE];
+    columns->longitude      = (double*)column[COL_LONGITUDE];
+    columns->x_atc          = (double*)column[COL_X_ATC];
+    columns->height         = (float*)column[COL_HEIGHT];
+    columns->relief         = (float*)column[COL_RELIEF];
+    columns->landcover      = (uint8_t*)column[COL_LANDCOVER];
+    columns->snowcover      = (uint8_t*)column[COL_SNOWCOVER];
+    columns->atl08_class    = (uint8_t*)column[COL_ATL08_CLASS];
+    columns->atl03_cnf      = (int8_t*)column[COL_ATL03_CNF];
+    columns->quality_ph     = (int8_t*)column[COL_QUALITY_PH];
+    columns->yapc_score     = (uint8_t*)column[COL_YAPC_SCORE];
+}
+
+/*----------------------------------------------------------------------------
+ * setColumns
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::setColumns (photon_columns_t* columns, uint32_t index, const photon_t* photon)
+{
+    columns->delta_time[index]  = photon->delta_time;
+    columns->latitude[index]    = photon->latitude;
+    columns->longitude[index]   = photon->longitude;
+    columns->x_atc[index]       = photon->distance;
+    columns->height[index]      = photon->height;
+    columns->relief[index]      = photon->relief;
+    columns->landcover[index]   = photon->landcover;
+    columns->snowcover[index]   = photon->snowcover;
+    columns->atl08_class[index] = photon->atl08_class;
+    columns->atl03_cnf[index]   = photon->atl03_cnf;
+    columns->quality_ph[index]  = photon->quality_ph;
+    columns->yapc_score[index]  = photon->yapc_score;
+}
+
+/*----------------------------------------------------------------------------
+ * getExtent
+ *
+ *  copies the attributes of an extent or columnar extent record into extent
+ *  (leaving the photon offsets zero) and points columns at its photons; a
+ *  columnar record is used in place and NULL is returned, otherwise the
+ *  photons are transposed into a buffer the caller must delete
+ *----------------------------------------------------------------------------*/
+uint8_t* Atl03Reader::getExtent (RecordObject* record, extent_t* extent, photon_columns_t* columns)
+{
+    if(record->isRecordType(exColRecType))
+    {
+        col_extent_t* col_extent = (col_extent_t*)record->getRecordData();
+
+        /* Copy Attributes */
+        for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+        {
+            extent->valid[t]                = col_extent->valid[t];
+            extent->segment_id[t]           = col_extent->segment_id[t];
+            extent->segment_distance[t]     = col_extent->segment_distance[t];
+            extent->extent_length[t]        = col_extent->extent_length[t];
+            extent->spacecraft_velocity[t]  = col_extent->spacecraft_velocity[t];
+            extent->background_rate[t]      = col_extent->background_rate[t];
+            extent->solar_elevation[t]      = col_extent->solar_elevation[t];
+            extent->photon_count[t]         = col_extent->photon_count[t];
+            extent->photon_offset[t]        = 0;
+        }
+        extent->reference_pair_track            = col_extent->reference_pair_track;
+        extent->spacecraft_orientation          = col_extent->spacecraft_orientation;
+        extent->reference_ground_track_start    = col_extent->reference_ground_track_start;
+        extent->cycle_start                     = col_extent->cycle_start;
+        extent->extent_id                       = col_extent->extent_id;
+
+        /* Point to Columns */
+        uint8_t* base = (uint8_t*)col_extent;
+        columns->delta_time     = (double*)(base + col_extent->column_offset[COL_DELTA_TIME][Icesat2Parms::RPT_L]);
+        columns->latitude       = (double*)(base + col_extent->column_offset[COL_LATITUDE][Icesat2Parms::RPT_L]);
+        columns->longitude      = (double*)(base + col_extent->column_offset[COL_LONGITUDE][Icesat2Parms::RPT_L]);
+        columns->x_atc          = (double*)(base + col_extent->column_offset[COL_X_ATC][Icesat2Parms::RPT_L]);
+        columns->height         = (float*)(base + col_extent->column_offset[COL_HEIGHT][Icesat2Parms::RPT_L]);
+        columns->relief         = (float*)(base + col_extent->column_offset[COL_RELIEF][Icesat2Parms::RPT_L]);
+        columns->landcover      = (uint8_t*)(base + col_extent->column_offset[COL_LANDCOVER][Icesat2Parms::RPT_L]);
+        columns->snowcover      = (uint8_t*)(base + col_extent->column_offset[COL_SNOWCOVER][Icesat2Parms::RPT_L]);
+        columns->atl08_class    = (uint8_t*)(base + col_extent->column_offset[COL_ATL08_CLASS][Icesat2Parms::RPT_L]);
+        columns->atl03_cnf      = (int8_t*)(base + col_extent->column_offset[COL_ATL03_CNF][Icesat2Parms::RPT_L]);
+        columns->quality_ph     = (int8_t*)(base + col_extent->column_offset[COL_QUALITY_PH][Icesat2Parms::RPT_L]);
+        columns->yapc_score     = (uint8_t*)(base + col_extent->column_offset[COL_YAPC_SCORE][Icesat2Parms::RPT_L]);
+
+        return NULL;
+    }
+    else
+    {
+        extent_t* ph_extent = (extent_t*)record->getRecordData();
+
+        /* Copy Attributes */
+        LocalLib::copy(extent, ph_extent, sizeof(extent_t));
+        extent->photon_offset[Icesat2Parms::RPT_L] = 0;
+        extent->photon_offset[Icesat2Parms::RPT_R] = 0;
+
+        /* Transpose Photons */
+        uint32_t num_photons = ph_extent->photon_count[Icesat2Parms::RPT_L] + ph_extent->photon_count[Icesat2Parms::RPT_R];
+        uint8_t* buffer = new uint8_t [columnsSize(num_photons)];
+        bindColumns(buffer, num_photons, columns);
+        for(uint32_t p = 0; p < num_photons; p++)
+        {
+            setColumns(columns, p, &ph_extent->photons[p]);
+        }
+
+        return buffer;
+    }
 }
 
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Atl03Reader::Atl03Reader (lua_State* L, Asset* _asset, const char* _resource, const char* outq_name, Icesat2Parms* _parms, bool _send_terminator, bool _flatten):
+Atl03Reader::Atl03Reader (lua_State* L, Asset* _asset, const char* _resource, const char* outq_name, Icesat2Parms* _parms, bool _send_terminator, bool _flatten, bool _columnar):
     LuaObject(L, OBJECT_TYPE, LuaMetaName, LuaMetaTable),
     read_timeout_ms(_parms->read_timeout * 1000)
 {
@@ -195,6 +439,7 @@ Atl03Reader::Atl03Reader (lua_State* L, Asset* _asset, const char* _resource, co
     resource = StringLib::duplicate(_resource);
     parms = _parms;
     flatten = _flatten;
+    columnar = _columnar;
 
     /* Generate ATL08 Resource Name */
     SafeString atl08_resource("%s", resource);
@@ -220,6 +465,12 @@ Atl03Reader::Atl03Reader (lua_State* L, Asset* _asset, const char* _resource, co
     /* Read Global Resource Information */
     try
     {
+        /* Register Readahead of Track Datasets (read together for the same rows) */
+        const char* segment_plan[] = {"geolocation/velocity_sc", "geolocation/delta_time", "geolocation/segment_id", "geolocation/segment_dist_x", "geolocation/solar_elevation"};
+        const char* photon_plan[] = {"heights/dist_ph_along", "heights/h_ph", "heights/signal_conf_ph", "heights/quality_ph", "heights/lat_ph", "heights/lon_ph", "heights/delta_time"};
+        H5Coro::readahead(&context, segment_plan, sizeof(segment_plan) / sizeof(const char*));
+        H5Coro::readahead(&context, photon_plan, sizeof(photon_plan) / sizeof(const char*));
+
         /* Read ATL03 Global Data */
         sc_orient = NULL;
         sc_orient = new H5Array<int8_t> (asset, resource, "/orbit_info/sc_orient", &context);
@@ -238,13 +489,15 @@ Atl03Reader::Atl03Reader (lua_State* L, Asset* _asset, const char* _resource, co
         {
             threadCount = Icesat2Parms::NUM_TRACKS;
 
-            /* Create Readers */
+            /* Create Readers (inherit the node of the request) */
+            Thread::attr_t attr = {.name = "atl03.subset", .node = Thread::ANY_NODE, .cpus = NULL, .stack_size = 0};
             for(int t = 0; t < Icesat2Parms::NUM_TRACKS; t++)
             {
                 info_t* info = new info_t;
                 info->reader = this;
                 info->track = t + 1;
-                readerPid[t] = new Thread(subsettingThread, info);
+                ThreadBudget::reserve(1);
+                readerPid[t] = new Thread(subsettingThread, info, attr);
             }
         }
         else if(parms->track >= 1 && parms->track <= 3)
@@ -300,16 +553,87 @@ Atl03Reader::~Atl03Reader (void)
     asset->releaseLuaObject();
 }
 
+/*----------------------------------------------------------------------------
+ * directAsset
+ *
+ *  asset the track arrays read through directly; in shared scan mode the
+ *  arrays are created without reads (NULL asset) and then attached to shared
+ *  whole-track reads via readShared
+ *----------------------------------------------------------------------------*/
+const Asset* Atl03Reader::directAsset (info_t* info)
+{
+    return sharedScan ? NULL : info->reader->asset;
+}
+
+/*----------------------------------------------------------------------------
+ * selectedAsset
+ *
+ *  asset the photon columns that are only needed for selected photons read
+ *  through directly; NULL when their reads wait for the photon selection
+ *  (see Atl03Data::readSelected) or are shared whole-track reads
+ *----------------------------------------------------------------------------*/
+const Asset* Atl03Reader::selectedAsset (info_t* info)
+{
+    return (sharedScan || pushdownFilters(info->reader->parms)) ? NULL : info->reader->asset;
+}
+
+/*----------------------------------------------------------------------------
+ * pushdownFilters
+ *
+ *  true when the signal confidence or photon quality filters exclude any
+ *  photons, in which case they are applied before the photon columns are read
+ *----------------------------------------------------------------------------*/
+bool Atl03Reader::pushdownFilters (const Icesat2Parms* parms)
+{
+    for(int cnf = Icesat2Parms::CNF_POSSIBLE_TEP; cnf <= Icesat2Parms::CNF_SURFACE_HIGH; cnf++)
+    {
+        if(!parms->atl03_cnf[cnf + Icesat2Parms::SIGNAL_CONF_OFFSET]) return true;
+    }
+
+    for(int quality = Icesat2Parms::QUALITY_NOMINAL; quality <= Icesat2Parms::QUALITY_POSSIBLE_TEP; quality++)
+    {
+        if(!parms->quality_ph[quality]) return true;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * readShared
+ *
+ *  attaches both pair tracks of the array to a whole-track read shared with
+ *  any other reader of the same granule and track; the caller trims the
+ *  arrays to its region once joined
+ *----------------------------------------------------------------------------*/
+template <class T>
+void Atl03Reader::readShared (info_t* info, GTArray<T>& array, long col)
+{
+    for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+    {
+        array.gt[t].h5f = H5Coro::readpShared(info->reader->asset, info->reader->resource, array.gt[t].name, RecordObject::DYNAMIC, col, 0, H5Coro::ALL_ROWS, &info->reader->context);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * Region::Constructor
  *----------------------------------------------------------------------------*/
 Atl03Reader::Region::Region (info_t* info):
-    segment_lat    (info->reader->asset, info->reader->resource, info->track, "geolocation/reference_photon_lat", &info->reader->context),
-    segment_lon    (info->reader->asset, info->reader->resource, info->track, "geolocation/reference_photon_lon", &info->reader->context),
-    segment_ph_cnt (info->reader->asset, info->reader->resource, info->track, "geolocation/segment_ph_cnt",       &info->reader->context),
+    segment_lat    (directAsset(info), info->reader->resource, info->track, "geolocation/reference_photon_lat", &info->reader->context),
+    segment_lon    (directAsset(info), info->reader->resource, info->track, "geolocation/reference_photon_lon", &info->reader->context),
+    segment_ph_cnt (directAsset(info), info->reader->resource, info->track, "geolocation/segment_ph_cnt",       &info->reader->context),
     inclusion_mask {NULL, NULL},
-    inclusion_ptr  {NULL, NULL}
+    inclusion_ptr  {NULL, NULL},
+    photon_ranges  {NULL, NULL},
+    num_photon_ranges {0, 0}
 {
+    /* Attach to Shared Reads */
+    if(sharedScan)
+    {
+        readShared(info, segment_lat, 0);
+        readShared(info, segment_lon, 0);
+        readShared(info, segment_ph_cnt, 0);
+    }
+
     /* Join Reads */
     segment_lat.join(info->reader->read_timeout_ms, true);
     segment_lon.join(info->reader->read_timeout_ms, true);
@@ -349,6 +673,9 @@ Atl03Reader::Region::Region (info_t* info):
     segment_lat.trim(first_segment);
     segment_lon.trim(first_segment);
     segment_ph_cnt.trim(first_segment);
+
+    /* Determine Photon Rows Inside Region */
+    photonranges();
 }
 
 /*----------------------------------------------------------------------------
@@ -367,6 +694,11 @@ void Atl03Reader::Region::cleanup (void)
     for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
     {
         if(inclusion_mask[t]) delete [] inclusion_mask[t];
+        if(photon_ranges[t]) delete [] photon_ranges[t];
+        inclusion_mask[t] = NULL;
+        inclusion_ptr[t] = NULL;
+        photon_ranges[t] = NULL;
+        num_photon_ranges[t] = 0;
     }
 }
 
@@ -389,59 +721,79 @@ void Atl03Reader::Region::polyregion (info_t* info)
     {
         projected_poly[i] = MathLib::coord2point(poly_iterator[i], projection);
     }
+    MathLib::poly_t* poly = MathLib::polycreate(projected_poly, points_in_polygon);
 
-    /* Find First Segment In Polygon */
+    /* Find First and Last Segment In Polygon */
     bool first_segment_found[Icesat2Parms::NUM_PAIR_TRACKS] = {false, false};
-    bool last_segment_found[Icesat2Parms::NUM_PAIR_TRACKS] = {false, false};
     for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
     {
-        int segment = 0;
-        while(segment < segment_ph_cnt[t].size)
+        /* Check Size */
+        if(segment_ph_cnt[t].size <= 0)
         {
-            bool inclusion = false;
+            continue;
+        }
+
+        /* Allocate Inclusion Mask */
+        inclusion_mask[t] = new bool [segment_ph_cnt[t].size];
+        inclusion_ptr[t] = inclusion_mask[t];
 
-            /* Project Segment Coordinate */
-            MathLib::coord_t segment_coord = {segment_lon[t][segment], segment_lat[t][segment]};
-            MathLib::point_t segment_point = MathLib::coord2point(segment_coord, projection);
+        /* Test Inclusion of All Segments */
+        MathLib::point_t* segment_points = new MathLib::point_t [segment_ph_cnt[t].size];
+        MathLib::coord2point(&segment_lon[t][0], &segment_lat[t][0], segment_points, segment_ph_cnt[t].size, projection);
+        MathLib::inpolybatch(poly, segment_points, segment_ph_cnt[t].size, inclusion_mask[t]);
+        delete [] segment_points;
 
-            /* Test Inclusion */
-            if(MathLib::inpoly(projected_poly, points_in_polygon, segment_point))
+        /* Loop Through Segments */
+        long curr_num_photons = 0;
+        long last_segment = 0;
+        int segment = 0;
+        while(segment < segment_ph_cnt[t].size)
+        {
+            if(segment_ph_cnt[t][segment] == 0)
             {
-                inclusion = true;
+                /* Segments without photons are never included */
+                inclusion_mask[t][segment] = false;
             }
-
-            /* Check First Segment */
-            if(!first_segment_found[t])
+            else
             {
-                /* If Coordinate Is In Polygon */
-                if(inclusion && segment_ph_cnt[t][segment] != 0)
-                {
-                    /* Set First Segment */
-                    first_segment_found[t] = true;
-                    first_segment[t] = segment;
+                bool inclusion = inclusion_mask[t][segment];
 
-                    /* Include Photons From First Segment */
-                    num_photons[t] = segment_ph_cnt[t][segment];
-                }
-                else
-                {
-                    /* Update Photon Index */
-                    first_photon[t] += segment_ph_cnt[t][segment];
-                }
-            }
-            else if(!last_segment_found[t])
-            {
-                /* If Coordinate Is NOT In Polygon */
-                if(!inclusion && segment_ph_cnt[t][segment] != 0)
+                /* Check For First Segment */
+                if(!first_segment_found[t])
                 {
-                    /* Set Last Segment */
-                    last_segment_found[t] = true;
-                    break; // full extent found!
+                    /* If Coordinate Is In Polygon */
+                    if(inclusion)
+                    {
+                        first_segment_found[t] = true;
+
+                        /* Set First Segment */
+                        first_segment[t] = segment;
+                        last_segment = segment;
+
+                        /* Include Photons From First Segment */
+                        curr_num_photons = segment_ph_cnt[t][segment];
+                        num_photons[t] = curr_num_photons;
+                    }
+                    else
+                    {
+                        /* Update Photon Index */
+                        first_photon[t] += segment_ph_cnt[t][segment];
+                    }
                 }
                 else
                 {
-                    /* Update Photon Index */
-                    num_photons[t] += segment_ph_cnt[t][segment];
+                    /* Update Photon Count */
+                    curr_num_photons += segment_ph_cnt[t][segment];
+
+                    /* If Coordinate Is In Polygon */
+                    if(inclusion)
+                    {
+                        /* Update Number of Photons to Current Count */
+                        num_photons[t] = curr_num_photons;
+
+                        /* Update Last Segment */
+                        last_segment = segment;
+                    }
                 }
             }
 
@@ -452,11 +804,15 @@ void Atl03Reader::Region::polyregion (info_t* info)
         /* Set Number of Segments */
         if(first_segment_found[t])
         {
-            num_segments[t] = segment - first_segment[t];
+            num_segments[t] = last_segment - first_segment[t] + 1;
+
+            /* Trim Inclusion Mask */
+            inclusion_ptr[t] = &inclusion_mask[t][first_segment[t]];
         }
     }
 
     /* Delete Projected Polygon */
+    MathLib::polydelete(poly);
     delete [] projected_poly;
 }
 
@@ -479,17 +835,23 @@ void Atl03Reader::Region::rasterregion (info_t* info)
         inclusion_mask[t] = new bool [segment_ph_cnt[t].size];
         inclusion_ptr[t] = inclusion_mask[t];
 
+        /* Check Inclusion of All Segments */
+        info->reader->parms->raster->includes(&segment_lon[t][0], &segment_lat[t][0], segment_ph_cnt[t].size, inclusion_mask[t]);
+
         /* Loop Throuh Segments */
         long curr_num_photons = 0;
         long last_segment = 0;
         int segment = 0;
         while(segment < segment_ph_cnt[t].size)
         {
-            if(segment_ph_cnt[t][segment] != 0)
+            if(segment_ph_cnt[t][segment] == 0)
             {
-                /* Check Inclusion */
-                bool inclusion = info->reader->parms->raster->includes(segment_lon[t][segment], segment_lat[t][segment]);
-                inclusion_mask[t][segment] = inclusion;
+                /* Segments without photons are never included */
+                inclusion_mask[t][segment] = false;
+            }
+            else
+            {
+                bool inclusion = inclusion_mask[t][segment];
 
                 /* Check For First Segment */
                 if(!first_segment_found[t])
@@ -545,30 +907,109 @@ void Atl03Reader::Region::rasterregion (info_t* info)
     }
 }
 
+/*----------------------------------------------------------------------------
+ * Region::photonranges
+ *
+ *  builds the list of photon rows (absolute to the track) covered by the
+ *  included segments of the region so that the photon rate datasets only
+ *  read those rows; gaps of excluded photons smaller than MIN_RANGE_GAP are
+ *  merged into the surrounding ranges since skipping them saves no reads,
+ *  and when a single range results the track is read contiguously
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::Region::photonranges (void)
+{
+    for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+    {
+        if(!inclusion_ptr[t]) continue;
+
+        /* Build Photon Ranges */
+        List<H5Coro::row_range_t> ranges;
+        long photon = first_photon[t];
+        for(long segment = 0; segment < num_segments[t]; segment++)
+        {
+            long count = segment_ph_cnt[t][segment];
+            if(count != 0 && inclusion_ptr[t][segment])
+            {
+                int last = ranges.length() - 1;
+                long gap = (last >= 0) ? photon - (ranges[last].startrow + ranges[last].numrows) : 0;
+                if(last >= 0 && gap < MIN_RANGE_GAP)
+                {
+                    ranges[last].numrows += gap + count;
+                }
+                else
+                {
+                    H5Coro::row_range_t range = {photon, count};
+                    ranges.add(range);
+                }
+            }
+            photon += count;
+        }
+
+        /* Keep Ranges Only When Rows Are Skipped */
+        if(ranges.length() > 1)
+        {
+            num_photon_ranges[t] = ranges.length();
+            photon_ranges[t] = new H5Coro::row_range_t [num_photon_ranges[t]];
+            for(int r = 0; r < num_photon_ranges[t]; r++)
+            {
+                photon_ranges[t][r] = ranges[r];
+            }
+        }
+    }
+}
+
 /*----------------------------------------------------------------------------
  * Atl03Data::Constructor
+ *
+ *  the photon rate datasets only read the rows inside the region; the along
+ *  track distance is always read in full because it drives the extents, and
+ *  so are the heights when YAPC is run since the score of a photon depends on
+ *  its neighbors outside of the region; when the signal confidence or photon
+ *  quality filters are selective, the heights, positions, and times are read
+ *  only for the rows holding selected photons (see readSelected); in shared
+ *  scan mode every dataset is read for the whole track, once for all
+ *  concurrent readers of the track, and then trimmed to the region
  *----------------------------------------------------------------------------*/
 Atl03Reader::Atl03Data::Atl03Data (info_t* info, Region& region):
-    velocity_sc         (info->reader->asset, info->reader->resource, info->track, "geolocation/velocity_sc",     &info->reader->context, H5Coro::ALL_COLS, region.first_segment, region.num_segments),
-    segment_delta_time  (info->reader->asset, info->reader->resource, info->track, "geolocation/delta_time",      &info->reader->context, 0, region.first_segment, region.num_segments),
-    segment_id          (info->reader->asset, info->reader->resource, info->track, "geolocation/segment_id",      &info->reader->context, 0, region.first_segment, region.num_segments),
-    segment_dist_x      (info->reader->asset, info->reader->resource, info->track, "geolocation/segment_dist_x",  &info->reader->context, 0, region.first_segment, region.num_segments),
-    solar_elevation     (info->reader->asset, info->reader->resource, info->track, "geolocation/solar_elevation", &info->reader->context, 0, region.first_segment, region.num_segments),
-    dist_ph_along       (info->reader->asset, info->reader->resource, info->track, "heights/dist_ph_along",       &info->reader->context, 0, region.first_photon,  region.num_photons),
-    h_ph                (info->reader->asset, info->reader->resource, info->track, "heights/h_ph",                &info->reader->context, 0, region.first_photon,  region.num_photons),
-    signal_conf_ph      (info->reader->asset, info->reader->resource, info->track, "heights/signal_conf_ph",      &info->reader->context, info->reader->parms->surface_type, region.first_photon,  region.num_photons),
-    quality_ph          (info->reader->asset, info->reader->resource, info->track, "heights/quality_ph",          &info->reader->context, 0, region.first_photon,  region.num_photons),
-    lat_ph              (info->reader->asset, info->reader->resource, info->track, "heights/lat_ph",              &info->reader->context, 0, region.first_photon,  region.num_photons),
-    lon_ph              (info->reader->asset, info->reader->resource, info->track, "heights/lon_ph",              &info->reader->context, 0, region.first_photon,  region.num_photons),
-    delta_time          (info->reader->asset, info->reader->resource, info->track, "heights/delta_time",          &info->reader->context, 0, region.first_photon,  region.num_photons),
-    bckgrd_delta_time   (info->reader->asset, info->reader->resource, info->track, "bckgrd_atlas/delta_time",     &info->reader->context),
-    bckgrd_rate         (info->reader->asset, info->reader->resource, info->track, "bckgrd_atlas/bckgrd_rate",    &info->reader->context),
+    velocity_sc         (directAsset(info), info->reader->resource, info->track, "geolocation/velocity_sc",     &info->reader->context, H5Coro::ALL_COLS, region.first_segment, region.num_segments),
+    segment_delta_time  (directAsset(info), info->reader->resource, info->track, "geolocation/delta_time",      &info->reader->context, 0, region.first_segment, region.num_segments),
+    segment_id          (directAsset(info), info->reader->resource, info->track, "geolocation/segment_id",      &info->reader->context, 0, region.first_segment, region.num_segments),
+    segment_dist_x      (directAsset(info), info->reader->resource, info->track, "geolocation/segment_dist_x",  &info->reader->context, 0, region.first_segment, region.num_segments),
+    solar_elevation     (directAsset(info), info->reader->resource, info->track, "geolocation/solar_elevation", &info->reader->context, 0, region.first_segment, region.num_segments),
+    dist_ph_along       (directAsset(info), info->reader->resource, info->track, "heights/dist_ph_along",       &info->reader->context, 0, region.first_photon,  region.num_photons),
+    h_ph                (info->reader->parms->stages[Icesat2Parms::STAGE_YAPC] ? directAsset(info) : selectedAsset(info), info->reader->resource, info->track, "heights/h_ph",                &info->reader->context, 0, region.first_photon,  region.num_photons, info->reader->parms->stages[Icesat2Parms::STAGE_YAPC] ? NULL : region.photon_ranges, region.num_photon_ranges),
+    signal_conf_ph      (directAsset(info), info->reader->resource, info->track, "heights/signal_conf_ph",      &info->reader->context, info->reader->parms->surface_type, region.first_photon,  region.num_photons, region.photon_ranges, region.num_photon_ranges),
+    quality_ph          (directAsset(info), info->reader->resource, info->track, "heights/quality_ph",          &info->reader->context, 0, region.first_photon,  region.num_photons, region.photon_ranges, region.num_photon_ranges),
+    lat_ph              (selectedAsset(info), info->reader->resource, info->track, "heights/lat_ph",              &info->reader->context, 0, region.first_photon,  region.num_photons, region.photon_ranges, region.num_photon_ranges),
+    lon_ph              (selectedAsset(info), info->reader->resource, info->track, "heights/lon_ph",              &info->reader->context, 0, region.first_photon,  region.num_photons, region.photon_ranges, region.num_photon_ranges),
+    delta_time          (selectedAsset(info), info->reader->resource, info->track, "heights/delta_time",          &info->reader->context, 0, region.first_photon,  region.num_photons, region.photon_ranges, region.num_photon_ranges),
+    bckgrd_delta_time   (directAsset(info), info->reader->resource, info->track, "bckgrd_atlas/delta_time",     &info->reader->context),
+    bckgrd_rate         (directAsset(info), info->reader->resource, info->track, "bckgrd_atlas/bckgrd_rate",    &info->reader->context),
     anc_geo_data        (Icesat2Parms::EXPECTED_NUM_FIELDS),
     anc_ph_data         (Icesat2Parms::EXPECTED_NUM_FIELDS)
 {
     Icesat2Parms::string_list_t* geo_fields = info->reader->parms->atl03_geo_fields;
     Icesat2Parms::string_list_t* photon_fields = info->reader->parms->atl03_ph_fields;
 
+    /* Attach to Shared Whole-Track Reads */
+    if(sharedScan)
+    {
+        readShared(info, velocity_sc, H5Coro::ALL_COLS);
+        readShared(info, segment_delta_time, 0);
+        readShared(info, segment_id, 0);
+        readShared(info, segment_dist_x, 0);
+        readShared(info, solar_elevation, 0);
+        readShared(info, dist_ph_along, 0);
+        readShared(info, h_ph, 0);
+        readShared(info, signal_conf_ph, info->reader->parms->surface_type);
+        readShared(info, quality_ph, 0);
+        readShared(info, lat_ph, 0);
+        readShared(info, lon_ph, 0);
+        readShared(info, delta_time, 0);
+        readShared(info, bckgrd_delta_time, 0);
+        readShared(info, bckgrd_rate, 0);
+    }
+
     /* Read Ancillary Geolocation Fields */
     if(geo_fields)
     {
@@ -584,7 +1025,7 @@ Atl03Reader::Atl03Data::Atl03Data (info_t* info, Region& region):
                 group_name = "geophys_corr";
             }
             SafeString dataset_name("%s/%s", group_name, field_name);
-            GTDArray* array = new GTDArray(info->reader->asset, info->reader->resource, info->track, dataset_name.getString(), &info->reader->context, 0, region.first_segment, region.num_segments);
+            GTDArray* array = new GTDArray(NULL, info->reader->resource, info->track, dataset_name.getString(), &info->reader->context, 0, region.first_segment, region.num_segments);
             anc_geo_data.add(field_name, array);
         }
     }
@@ -596,11 +1037,63 @@ Atl03Reader::Atl03Data::Atl03Data (info_t* info, Region& region):
         {
             const char* field_name = (*photon_fields)[i].getString();
             SafeString dataset_name("heights/%s", field_name);
-            GTDArray* array = new GTDArray(info->reader->asset, info->reader->resource, info->track, dataset_name.getString(), &info->reader->context, 0, region.first_photon,  region.num_photons);
+            GTDArray* array = new GTDArray(NULL, info->reader->resource, info->track, dataset_name.getString(), &info->reader->context, 0, region.first_photon,  region.num_photons);
             anc_ph_data.add(field_name, array);
         }
     }
 
+    /* Post Ancillary Reads Together
+     *  the arrays above are created without reads so that all of the
+     *  ancillary datasets go through a single batch, which coalesces
+     *  their data into as few requests as possible */
+    int num_geo_fields = geo_fields ? geo_fields->length() : 0;
+    int num_ph_fields = photon_fields ? photon_fields->length() : 0;
+    int num_rqsts = (num_geo_fields + num_ph_fields) * Icesat2Parms::NUM_PAIR_TRACKS;
+    if(num_rqsts > 0)
+    {
+        H5Coro::batch_rqst_t* rqsts = new H5Coro::batch_rqst_t [num_rqsts];
+        H5DArray** targets = new H5DArray* [num_rqsts];
+        int r = 0;
+        for(int i = 0; i < num_geo_fields + num_ph_fields; i++)
+        {
+            bool geo = i < num_geo_fields;
+            GTDArray* array = geo ? anc_geo_data[(*geo_fields)[i].getString()] : anc_ph_data[(*photon_fields)[i - num_geo_fields].getString()];
+
+            /* Skip Fields Requested More than Once */
+            bool duplicate = false;
+            for(int k = 0; k < r; k++) duplicate = duplicate || (targets[k] == &array->gt[0]);
+            if(duplicate) continue;
+
+            for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+            {
+                rqsts[r].datasetname = array->gt[t].name;
+                rqsts[r].valtype = RecordObject::DYNAMIC;
+                rqsts[r].col = 0;
+                rqsts[r].startrow = geo ? region.first_segment[t] : region.first_photon[t];
+                rqsts[r].numrows = geo ? region.num_segments[t] : region.num_photons[t];
+                rqsts[r].h5f = NULL;
+                targets[r] = &array->gt[t];
+                r++;
+            }
+        }
+
+        int num_posted = r;
+        H5Coro::readBatch(info->reader->asset, info->reader->resource, rqsts, num_posted, &info->reader->context);
+        for(r = 0; r < num_posted; r++)
+        {
+            targets[r]->h5f = rqsts[r].h5f;
+        }
+
+        delete [] targets;
+        delete [] rqsts;
+    }
+
+    /* Read Photon Columns for Selected Photons */
+    if(!sharedScan && pushdownFilters(info->reader->parms))
+    {
+        readSelected(info, region);
+    }
+
     /* Join Hardcoded Reads */
     velocity_sc.join(info->reader->read_timeout_ms, true);
     segment_delta_time.join(info->reader->read_timeout_ms, true);
@@ -617,6 +1110,23 @@ Atl03Reader::Atl03Data::Atl03Data (info_t* info, Region& region):
     bckgrd_delta_time.join(info->reader->read_timeout_ms, true);
     bckgrd_rate.join(info->reader->read_timeout_ms, true);
 
+    /* Apply Region to Shared Whole-Track Reads */
+    if(sharedScan)
+    {
+        velocity_sc.trim(region.first_segment, region.num_segments);
+        segment_delta_time.trim(region.first_segment, region.num_segments);
+        segment_id.trim(region.first_segment, region.num_segments);
+        segment_dist_x.trim(region.first_segment, region.num_segments);
+        solar_elevation.trim(region.first_segment, region.num_segments);
+        dist_ph_along.trim(region.first_photon, region.num_photons);
+        h_ph.trim(region.first_photon, region.num_photons);
+        signal_conf_ph.trim(region.first_photon, region.num_photons);
+        quality_ph.trim(region.first_photon, region.num_photons);
+        lat_ph.trim(region.first_photon, region.num_photons);
+        lon_ph.trim(region.first_photon, region.num_photons);
+        delta_time.trim(region.first_photon, region.num_photons);
+    }
+
     /* Join Ancillary Geolocation Reads */
     if(geo_fields)
     {
@@ -649,6 +1159,81 @@ Atl03Reader::Atl03Data::~Atl03Data (void)
 {
 }
 
+/*----------------------------------------------------------------------------
+ * Atl03Data::readSelected
+ *
+ *  applies the signal confidence and photon quality filters to the region
+ *  and reads the heights (when not needed in full for YAPC), positions, and
+ *  times only for the rows holding selected photons; rows between selected
+ *  photons closer than a range gap are read through so that whole chunks are
+ *  either read or skipped, and rows that are skipped are zero filled
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::Atl03Data::readSelected (info_t* info, Region& region)
+{
+    Icesat2Parms* parms = info->reader->parms;
+    bool read_heights = !parms->stages[Icesat2Parms::STAGE_YAPC];
+
+    /* Join Filter Columns */
+    signal_conf_ph.join(info->reader->read_timeout_ms, true);
+    quality_ph.join(info->reader->read_timeout_ms, true);
+
+    for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+    {
+        /* Build Ranges of Selected Photons */
+        List<H5Coro::row_range_t> ranges;
+        long num_photons = signal_conf_ph[t].size;
+        long num_segments = (region.num_segments[t] >= 0) ? region.num_segments[t] : region.segment_ph_cnt[t].size;
+        long num_selected = 0;
+        long photon = 0;
+        for(long segment = 0; segment < num_segments && photon < num_photons; segment++)
+        {
+            long count = region.segment_ph_cnt[t][segment];
+            if(count > 0 && (!region.inclusion_ptr[t] || region.inclusion_ptr[t][segment]))
+            {
+                for(long p = photon; p < (photon + count) && p < num_photons; p++)
+                {
+                    /* invalid values are kept so that they are reported when the photon is processed */
+                    int8_t cnf = signal_conf_ph[t][p];
+                    int8_t quality = quality_ph[t][p];
+                    bool cnf_valid = (cnf >= Icesat2Parms::CNF_POSSIBLE_TEP) && (cnf <= Icesat2Parms::CNF_SURFACE_HIGH);
+                    bool quality_valid = (quality >= Icesat2Parms::QUALITY_NOMINAL) && (quality <= Icesat2Parms::QUALITY_POSSIBLE_TEP);
+                    if(cnf_valid && !parms->atl03_cnf[cnf + Icesat2Parms::SIGNAL_CONF_OFFSET]) continue;
+                    if(quality_valid && !parms->quality_ph[quality]) continue;
+
+                    /* Add Photon to Ranges */
+                    long row = region.first_photon[t] + p;
+                    int last = ranges.length() - 1;
+                    long gap = (last >= 0) ? row - (ranges[last].startrow + ranges[last].numrows) : 0;
+                    if(last >= 0 && gap < Region::MIN_RANGE_GAP)
+                    {
+                        ranges[last].numrows += gap + 1;
+                    }
+                    else
+                    {
+                        H5Coro::row_range_t range = {row, 1};
+                        ranges.add(range);
+                    }
+                    num_selected++;
+                }
+            }
+            photon += count;
+        }
+
+        /* Post Reads of Selected Rows */
+        int num_ranges = ranges.length();
+        H5Coro::row_range_t* selected = new H5Coro::row_range_t [num_ranges > 0 ? num_ranges : 1];
+        for(int r = 0; r < num_ranges; r++) selected[r] = ranges[r];
+        long startrow = region.first_photon[t];
+        if(read_heights) h_ph[t].h5f = H5Coro::readpRows(info->reader->asset, info->reader->resource, h_ph[t].name, RecordObject::DYNAMIC, 0, startrow, num_photons, selected, num_ranges, &info->reader->context);
+        lat_ph[t].h5f = H5Coro::readpRows(info->reader->asset, info->reader->resource, lat_ph[t].name, RecordObject::DYNAMIC, 0, startrow, num_photons, selected, num_ranges, &info->reader->context);
+        lon_ph[t].h5f = H5Coro::readpRows(info->reader->asset, info->reader->resource, lon_ph[t].name, RecordObject::DYNAMIC, 0, startrow, num_photons, selected, num_ranges, &info->reader->context);
+        delta_time[t].h5f = H5Coro::readpRows(info->reader->asset, info->reader->resource, delta_time[t].name, RecordObject::DYNAMIC, 0, startrow, num_photons, selected, num_ranges, &info->reader->context);
+        delete [] selected;
+
+        mlog(DEBUG, "Selected %ld of %ld photons in %d ranges for %s/gt%d", num_selected, num_photons, num_ranges, info->reader->resource, info->track);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * Atl08Class::Constructor
  *----------------------------------------------------------------------------*/
@@ -875,15 +1460,6 @@ Atl03Reader::YapcScore::~YapcScore (void)
  *----------------------------------------------------------------------------*/
 void Atl03Reader::YapcScore::yapcV2 (info_t* info, Region& region, Atl03Data& atl03)
 {
-    /* YAPC Hard-Coded Parameters */
-    const double MAXIMUM_HSPREAD = 15000.0; // meters
-    const double HSPREAD_BINSIZE = 1.0; // meters
-    const int MAX_KNN = 25;
-    double nearest_neighbors[MAX_KNN];
-
-    /* Shortcut to Settings */
-    Icesat2Parms::yapc_t* settings = &info->reader->parms->yapc;
-
     /* Score Photons
      *
      *   CANNOT THROW BELOW THIS POINT
@@ -895,150 +1471,174 @@ void Atl03Reader::YapcScore::yapcV2 (info_t* info, Region& region, Atl03Data& at
         gt[t] = new uint8_t [num_photons];
         LocalLib::set(gt[t], 0, num_photons);
 
-        /* Initialize Indices */
-        int32_t ph_b0 = 0; // buffer start
-        int32_t ph_b1 = 0; // buffer end
-        int32_t ph_c0 = 0; // center start
-        int32_t ph_c1 = 0; // center end
-
-        /* Loop Through Each ATL03 Segment */
-        int32_t num_segments = atl03.segment_id[t].size;
-        for(int segment_index = 0; segment_index < num_segments; segment_index++)
-        {
-            /* Determine Indices */
-            ph_b0 += segment_index > 1 ? region.segment_ph_cnt[t][segment_index - 2] : 0; // Center - 2
-            ph_c0 += segment_index > 0 ? region.segment_ph_cnt[t][segment_index - 1] : 0; // Center - 1
-            ph_c1 += region.segment_ph_cnt[t][segment_index]; // Center
-            ph_b1 += segment_index < (num_segments - 1) ? region.segment_ph_cnt[t][segment_index + 1] : 0; // Center + 1
-
-            /* Calculate N and KNN */
-            int32_t N = region.segment_ph_cnt[t][segment_index];
-            int knn = (settings->knn != 0) ? settings->knn : MAX(1, (sqrt((double)N) + 0.5) / 2);
-            knn = MIN(knn, MAX_KNN); // truncate if too large
-
-            /* Check Valid Extent (note check against knn)*/
-            if((N <= knn) || (N < info->reader->parms->minimum_photon_count)) continue;
-
-            /* Calculate Distance and Height Spread */
-            double min_h = atl03.h_ph[t][0];
-            double max_h = min_h;
-            double min_x = atl03.dist_ph_along[t][0];
-            double max_x = min_x;
-            for(int n = 1; n < N; n++)
-            {
-                double h = atl03.h_ph[t][n];
-                double x = atl03.dist_ph_along[t][n];
-                if(h < min_h) min_h = h;
-                if(h > max_h) max_h = h;
-                if(x < min_x) min_x = x;
-                if(x > max_x) max_x = x;
-            }
-            double hspread = max_h - min_h;
-            double xspread = max_x - min_x;
-
-            /* Check Window */
-            if(hspread <= 0.0 || hspread > MAXIMUM_HSPREAD || xspread <= 0.0)
-            {
-                mlog(ERROR, "Unable to perform YAPC selection due to invalid photon spread: %lf, %lf\n", hspread, xspread);
-                continue;
-            }
+        /* Score Segments */
+        partitionSegments(info, region, atl03, t, NULL, yapcV2Thread);
+    }
+}
 
-            /* Bin Photons to Calculate Height Span*/
-            int num_bins = (int)(hspread / HSPREAD_BINSIZE) + 1;
-            int8_t* bins = new int8_t [num_bins];
-            LocalLib::set(bins, 0, num_bins);
-            for(int n = 0; n < N; n++)
-            {
-                unsigned int bin = (unsigned int)((atl03.h_ph[t][n] - min_h) / HSPREAD_BINSIZE);
-                bins[bin] = 1; // mark that photon present
-            }
+/*----------------------------------------------------------------------------
+ * yapcV2Segments
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::YapcScore::yapcV2Segments (yapc_partition_t* partition)
+{
+    /* YAPC Hard-Coded Parameters */
+    const double MAXIMUM_HSPREAD = 15000.0; // meters
+    const double HSPREAD_BINSIZE = 1.0; // meters
+    const int MAX_KNN = 25;
+    double nearest_neighbors[MAX_KNN];
 
-            /* Determine Number of Bins with Photons to Calculate Height Span
-            * (and remove potential gaps in telemetry bands) */
-            int nonzero_bins = 0;
-            for(int b = 0; b < num_bins; b++) nonzero_bins += bins[b];
-            delete [] bins;
+    /* Shortcut to Settings */
+    info_t* info = partition->info;
+    Region& region = *partition->region;
+    Atl03Data& atl03 = *partition->atl03;
+    Icesat2Parms::yapc_t* settings = &info->reader->parms->yapc;
+    const int t = partition->t;
+    const int32_t* ph_offsets = partition->ph_offsets;
+
+    /* Initialize Indices (as left by the segment before the first one) */
+    int32_t num_segments = atl03.segment_id[t].size;
+    int32_t first_segment = partition->first_segment;
+    int32_t ph_b0 = first_segment > 0 ? ph_offsets[MAX(first_segment - 2, 0)] : 0; // buffer start
+    int32_t ph_b1 = first_segment > 0 ? ph_offsets[MIN(first_segment + 1, num_segments)] - ph_offsets[1] : 0; // buffer end
+    int32_t ph_c0 = first_segment > 0 ? ph_offsets[first_segment - 1] : 0; // center start
+    int32_t ph_c1 = ph_offsets[first_segment]; // center end
+
+    /* Loop Through Each ATL03 Segment */
+    for(int segment_index = first_segment; segment_index < first_segment + partition->num_segments; segment_index++)
+    {
+        /* Determine Indices */
+        ph_b0 += segment_index > 1 ? region.segment_ph_cnt[t][segment_index - 2] : 0; // Center - 2
+        ph_c0 += segment_index > 0 ? region.segment_ph_cnt[t][segment_index - 1] : 0; // Center - 1
+        ph_c1 += region.segment_ph_cnt[t][segment_index]; // Center
+        ph_b1 += segment_index < (num_segments - 1) ? region.segment_ph_cnt[t][segment_index + 1] : 0; // Center + 1
+
+        /* Calculate N and KNN */
+        int32_t N = region.segment_ph_cnt[t][segment_index];
+        int knn = (settings->knn != 0) ? settings->knn : MAX(1, (sqrt((double)N) + 0.5) / 2);
+        knn = MIN(knn, MAX_KNN); // truncate if too large
+
+        /* Check Valid Extent (note check against knn)*/
+        if((N <= knn) || (N < info->reader->parms->minimum_photon_count)) continue;
+
+        /* Calculate Distance and Height Spread */
+        double min_h = atl03.h_ph[t][0];
+        double max_h = min_h;
+        double min_x = atl03.dist_ph_along[t][0];
+        double max_x = min_x;
+        for(int n = 1; n < N; n++)
+        {
+            double h = atl03.h_ph[t][n];
+            double x = atl03.dist_ph_along[t][n];
+            if(h < min_h) min_h = h;
+            if(h > max_h) max_h = h;
+            if(x < min_x) min_x = x;
+            if(x > max_x) max_x = x;
+        }
+        double hspread = max_h - min_h;
+        double xspread = max_x - min_x;
 
-            /* Calculate Height Span */
-            double h_span = (nonzero_bins * HSPREAD_BINSIZE) / (double)N * (double)knn;
+        /* Check Window */
+        if(hspread <= 0.0 || hspread > MAXIMUM_HSPREAD || xspread <= 0.0)
+        {
+            mlog(ERROR, "Unable to perform YAPC selection due to invalid photon spread: %lf, %lf\n", hspread, xspread);
+            continue;
+        }
 
-            /* Calculate Window Parameters */
-            double half_win_x = settings->win_x / 2.0;
-            double half_win_h = (settings->win_h != 0.0) ? settings->win_h / 2.0 : h_span / 2.0;
+        /* Bin Photons to Calculate Height Span*/
+        int num_bins = (int)(hspread / HSPREAD_BINSIZE) + 1;
+        int8_t* bins = new int8_t [num_bins];
+        LocalLib::set(bins, 0, num_bins);
+        for(int n = 0; n < N; n++)
+        {
+            unsigned int bin = (unsigned int)((atl03.h_ph[t][n] - min_h) / HSPREAD_BINSIZE);
+            bins[bin] = 1; // mark that photon present
+        }
 
-            /* Calculate YAPC Score for all Photons in Center Segment */
-            for(int y = ph_c0; y < ph_c1; y++)
-            {
-                double smallest_nearest_neighbor = DBL_MAX;
-                int smallest_nearest_neighbor_index = 0;
-                int num_nearest_neighbors = 0;
+        /* Determine Number of Bins with Photons to Calculate Height Span
+        * (and remove potential gaps in telemetry bands) */
+        int nonzero_bins = 0;
+        for(int b = 0; b < num_bins; b++) nonzero_bins += bins[b];
+        delete [] bins;
 
-                /* For All Neighbors */
-                for(int x = ph_b0; x < ph_b1; x++)
-                {
-                    /* Check for Identity */
-                    if(y == x) continue;
+        /* Calculate Height Span */
+        double h_span = (nonzero_bins * HSPREAD_BINSIZE) / (double)N * (double)knn;
 
-                    /* Check Window */
-                    double delta_x = abs(atl03.dist_ph_along[t][x] - atl03.dist_ph_along[t][y]);
-                    if(delta_x > half_win_x) continue;
+        /* Calculate Window Parameters */
+        double half_win_x = settings->win_x / 2.0;
+        double half_win_h = (settings->win_h != 0.0) ? settings->win_h / 2.0 : h_span / 2.0;
 
-                    /*  Calculate Weighted Distance */
-                    double delta_h = abs(atl03.h_ph[t][x] - atl03.h_ph[t][y]);
-                    double proximity = half_win_h - delta_h;
+        /* Calculate YAPC Score for all Photons in Center Segment */
+        for(int y = ph_c0; y < ph_c1; y++)
+        {
+            double smallest_nearest_neighbor = DBL_MAX;
+            int smallest_nearest_neighbor_index = 0;
+            int num_nearest_neighbors = 0;
 
-                    /* Add to Nearest Neighbor */
-                    if(num_nearest_neighbors < knn)
-                    {
-                        /* Maintain Smallest Nearest Neighbor */
-                        if(proximity < smallest_nearest_neighbor)
-                        {
-                            smallest_nearest_neighbor = proximity;
-                            smallest_nearest_neighbor_index = num_nearest_neighbors;
-                        }
+            /* For All Neighbors */
+            for(int x = ph_b0; x < ph_b1; x++)
+            {
+                /* Check for Identity */
+                if(y == x) continue;
 
-                        /* Automatically Add Nearest Neighbor (filling up array) */
-                        nearest_neighbors[num_nearest_neighbors] = proximity;
-                        num_nearest_neighbors++;
-                    }
-                    else if(proximity > smallest_nearest_neighbor)
+                /* Check Window */
+                double delta_x = abs(atl03.dist_ph_along[t][x] - atl03.dist_ph_along[t][y]);
+                if(delta_x > half_win_x) continue;
+
+                /*  Calculate Weighted Distance */
+                double delta_h = abs(atl03.h_ph[t][x] - atl03.h_ph[t][y]);
+                double proximity = half_win_h - delta_h;
+
+                /* Add to Nearest Neighbor */
+                if(num_nearest_neighbors < knn)
+                {
+                    /* Maintain Smallest Nearest Neighbor */
+                    if(proximity < smallest_nearest_neighbor)
                     {
-                        /* Add New Nearest Neighbor (replace current largest) */
-                        nearest_neighbors[smallest_nearest_neighbor_index] = proximity;
-                        smallest_nearest_neighbor = proximity; // temporarily set
+                        smallest_nearest_neighbor = proximity;
+                        smallest_nearest_neighbor_index = num_nearest_neighbors;
+                    }
+
+                    /* Automatically Add Nearest Neighbor (filling up array) */
+                    nearest_neighbors[num_nearest_neighbors] = proximity;
+                    num_nearest_neighbors++;
+                }
+                else if(proximity > smallest_nearest_neighbor)
+                {
+                    /* Add New Nearest Neighbor (replace current largest) */
+                    nearest_neighbors[smallest_nearest_neighbor_index] = proximity;
+                    smallest_nearest_neighbor = proximity; // temporarily set
 
-                        /* Recalculate Largest Nearest Neighbor */
-                        for(int k = 0; k < knn; k++)
+                    /* Recalculate Largest Nearest Neighbor */
+                    for(int k = 0; k < knn; k++)
+                    {
+                        if(nearest_neighbors[k] < smallest_nearest_neighbor)
                         {
-                            if(nearest_neighbors[k] < smallest_nearest_neighbor)
-                            {
-                                smallest_nearest_neighbor = nearest_neighbors[k];
-                                smallest_nearest_neighbor_index = k;
-                            }
+                            smallest_nearest_neighbor = nearest_neighbors[k];
+                            smallest_nearest_neighbor_index = k;
                         }
                     }
                 }
+            }
 
-                /* Fill In Rest of Nearest Neighbors (if not already full) */
-                for(int k = num_nearest_neighbors; k < knn; k++)
-                {
-                    nearest_neighbors[k] = 0.0;
-                }
+            /* Fill In Rest of Nearest Neighbors (if not already full) */
+            for(int k = num_nearest_neighbors; k < knn; k++)
+            {
+                nearest_neighbors[k] = 0.0;
+            }
 
-                /* Calculate Inverse Sum of Distances from Nearest Neighbors */
-                double nearest_neighbor_sum = 0.0;
-                for(int k = 0; k < knn; k++)
+            /* Calculate Inverse Sum of Distances from Nearest Neighbors */
+            double nearest_neighbor_sum = 0.0;
+            for(int k = 0; k < knn; k++)
+            {
+                if(nearest_neighbors[k] > 0.0)
                 {
-                    if(nearest_neighbors[k] > 0.0)
-                    {
-                        nearest_neighbor_sum += nearest_neighbors[k];
-                    }
+                    nearest_neighbor_sum += nearest_neighbors[k];
                 }
-                nearest_neighbor_sum /= (double)knn;
-
-                /* Calculate YAPC Score of Photon */
-                gt[t][y] = (uint8_t)((nearest_neighbor_sum / half_win_h) * 0xFF);
             }
+            nearest_neighbor_sum /= (double)knn;
+
+            /* Calculate YAPC Score of Photon */
+            gt[t][y] = (uint8_t)((nearest_neighbor_sum / half_win_h) * 0xFF);
         }
     }
 }
@@ -1048,11 +1648,6 @@ void Atl03Reader::YapcScore::yapcV2 (info_t* info, Region& region, Atl03Data& at
  *----------------------------------------------------------------------------*/
 void Atl03Reader::YapcScore::yapcV3 (info_t* info, Region& region, Atl03Data& atl03)
 {
-    /* YAPC Parameters */
-    Icesat2Parms::yapc_t* settings = &info->reader->parms->yapc;
-    const double hWX = settings->win_x / 2; // meters
-    const double hWZ = settings->win_h / 2; // meters
-
     /* Score Photons
      *
      *   CANNOT THROW BELOW THIS POINT
@@ -1077,103 +1672,296 @@ void Atl03Reader::YapcScore::yapcV3 (info_t* info, Region& region, Atl03Data& at
             }
         }
 
-        /* Traverse Each Segment */
-        ph_index = 0;
-        for(int segment_index = 0; segment_index < num_segments; segment_index++)
-        {
-            /* Initialize Segment Parameters */
-            int32_t N = region.segment_ph_cnt[t][segment_index];
-            double* ph_weights = new double[N]; // local array freed below
-            int max_knn = settings->min_knn;
-            int32_t start_ph_index = ph_index;
+        /* Score Segments */
+        partitionSegments(info, region, atl03, t, ph_dist, yapcV3Thread);
 
-            /* Traverse Each Photon in Segment*/
-            for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
-            {
-                List<double> proximities;
+        /* Free Photon Distance Array */
+        delete [] ph_dist;
+    }
+}
 
-                /* Check Nearest Neighbors to Left */
-                int32_t neighbor_index = ph_index - 1;
-                while(neighbor_index >= 0)
-                {
-                    /* Check Inside Horizontal Window */
-                    double x_dist = ph_dist[ph_index] - ph_dist[neighbor_index];
-                    if(x_dist <= hWX)
-                    {
-                        /* Check Inside Vertical Window */
-                        double proximity = abs(atl03.h_ph[t][ph_index] - atl03.h_ph[t][neighbor_index]);
-                        if(proximity <= hWZ)
-                        {
-                            proximities.add(proximity);
-                        }
-                    }
+/*----------------------------------------------------------------------------
+ * yapcV3Segments
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::YapcScore::yapcV3Segments (yapc_partition_t* partition)
+{
+    Region& region = *partition->region;
+    Atl03Data& atl03 = *partition->atl03;
+    const int t = partition->t;
 
-                    /* Check for Stopping Condition: 1m Buffer Added to X Window */
-                    if(x_dist >= (hWX + 1.0)) break;
+    yapcV3Score(partition->ph_dist, &atl03.h_ph[t][0], &region.segment_ph_cnt[t][0], atl03.dist_ph_along[t].size,
+                partition->first_segment, partition->num_segments, partition->ph_offsets[partition->first_segment],
+                &partition->info->reader->parms->yapc, gt[t]);
+}
 
-                    /* Goto Next Neighor */
-                    neighbor_index--;
-                }
+/*----------------------------------------------------------------------------
+ * yapcV3Score
+ *
+ *  scores the photons of num_segments segments starting at first_segment,
+ *  where ph_index is the first photon of first_segment; when the along track
+ *  distances are ordered the window bounds slide with the photon instead of
+ *  being rescanned, and the nearest neighbors are selected instead of sorted
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::YapcScore::yapcV3Score (const double* ph_dist, const float* h_ph, const int32_t* segment_ph_cnt, int32_t num_photons,
+                                          int32_t first_segment, int32_t num_segments, int32_t ph_index,
+                                          const Icesat2Parms::yapc_t* settings, uint8_t* gt)
+{
+    /* YAPC Parameters */
+    const double hWX = settings->win_x / 2; // meters
+    const double hWZ = settings->win_h / 2; // meters
+    const double hWX_stop = hWX + 1.0; // stopping condition: 1m buffer added to x window
 
-                /* Check Nearest Neighbors to Right */
-                neighbor_index = ph_index + 1;
-                while(neighbor_index < num_photons)
-                {
-                    /* Check Inside Horizontal Window */
-                    double x_dist = ph_dist[neighbor_index] - ph_dist[ph_index];
-                    if(x_dist <= hWX)
-                    {
-                        /* Check Inside Vertical Window */
-                        double proximity = abs(atl03.h_ph[t][ph_index] - atl03.h_ph[t][neighbor_index]);
-                        if(proximity <= hWZ) // inside of height window
-                        {
-                            proximities.add(proximity);
-                        }
-                    }
+    /* Check Ordering of Distances */
+    bool ordered = true;
+    for(int32_t i = 1; i < num_photons; i++)
+    {
+        if(ph_dist[i] < ph_dist[i - 1])
+        {
+            ordered = false;
+            break;
+        }
+    }
 
-                    /* Check for Stopping Condition: 1m Buffer Added to X Window */
-                    if(x_dist >= (hWX + 1.0)) break;
+    /* Window Bounds (exclusive) */
+    int32_t left_stop = -1;
+    int32_t right_stop = 0;
+    bool bounded = false;
 
-                    /* Goto Next Neighor */
-                    neighbor_index++;
-                }
+    /* Scratch Space */
+    int32_t window_size = 0;
+    double* proximities = NULL;
 
-                /* Sort Proximities */
-                proximities.sort();
+    /* Traverse Each Segment */
+    for(int segment_index = first_segment; segment_index < first_segment + num_segments; segment_index++)
+    {
+        /* Initialize Segment Parameters */
+        int32_t N = segment_ph_cnt[segment_index];
+        double* ph_weights = new double[N]; // local array freed below
+        int max_knn = settings->min_knn;
+        int32_t start_ph_index = ph_index;
+
+        /* Traverse Each Photon in Segment*/
+        for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
+        {
+            /* Find Window Bounds */
+            if(ordered && bounded)
+            {
+                while(left_stop + 1 < ph_index && (ph_dist[ph_index] - ph_dist[left_stop + 1]) >= hWX_stop) left_stop++;
+                if(right_stop <= ph_index) right_stop = ph_index + 1;
+                while(right_stop < num_photons && (ph_dist[right_stop] - ph_dist[ph_index]) < hWX_stop) right_stop++;
+            }
+            else
+            {
+                left_stop = ph_index - 1;
+                while(left_stop >= 0 && (ph_dist[ph_index] - ph_dist[left_stop]) < hWX_stop) left_stop--;
+                right_stop = ph_index + 1;
+                while(right_stop < num_photons && (ph_dist[right_stop] - ph_dist[ph_index]) < hWX_stop) right_stop++;
+                bounded = true;
+            }
 
-                /* Calculate knn */
-                double n = sqrt(proximities.length());
-                int knn = MAX(n, settings->min_knn);
-                if(knn > max_knn) max_knn = knn;
+            /* Grow Scratch Space */
+            int32_t num_neighbors = right_stop - left_stop - 2;
+            if(num_neighbors > window_size)
+            {
+                delete [] proximities;
+                window_size = num_neighbors * 2;
+                proximities = new double[window_size];
+            }
 
-                /* Calculate Sum of Weights*/
-                int num_nearest_neighbors = MIN(knn, proximities.length());
-                double weight_sum = 0.0;
-                for(int i = 0; i < num_nearest_neighbors; i++)
-                {
-                    weight_sum += hWZ - proximities[i];
-                }
-                ph_weights[ph_in_seg_index] = weight_sum;
+            /* Calculate Proximities of Nearest Neighbors to Left and Right */
+            int32_t num_left = ph_index - left_stop - 1;
+            int num_proximities = yapcV3Window(ph_dist, h_ph, ph_index, left_stop + 1, num_left, -1.0, hWX, hWZ, proximities);
+            num_proximities += yapcV3Window(ph_dist, h_ph, ph_index, ph_index + 1, num_neighbors - num_left, 1.0, hWX, hWZ, &proximities[num_left]);
 
-                /* Go To Next Photon */
-                ph_index++;
+            /* Calculate knn */
+            double n = sqrt(num_proximities);
+            int knn = MAX(n, settings->min_knn);
+            if(knn > max_knn) max_knn = knn;
+
+            /* Select Nearest Neighbors (rejected neighbors were set to DBL_MAX) */
+            int num_nearest_neighbors = MIN(knn, num_proximities);
+            if(num_nearest_neighbors > 0)
+            {
+                std::nth_element(proximities, proximities + num_nearest_neighbors - 1, proximities + num_neighbors);
+                std::sort(proximities, proximities + num_nearest_neighbors);
             }
 
-            /* Normalize Weights */
-            for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
+            /* Calculate Sum of Weights*/
+            double weight_sum = 0.0;
+            for(int i = 0; i < num_nearest_neighbors; i++)
             {
-                double Wt = ph_weights[ph_in_seg_index] / (hWZ * max_knn);
-                gt[t][start_ph_index] = (uint8_t)(MIN(Wt * 255, 255));
-                start_ph_index++;
+                weight_sum += hWZ - proximities[i];
             }
+            ph_weights[ph_in_seg_index] = weight_sum;
 
-            /* Free Photon Weights Array */
-            delete [] ph_weights;
+            /* Go To Next Photon */
+            ph_index++;
         }
 
-        /* Free Photon Distance Array */
-        delete [] ph_dist;
+        /* Normalize Weights */
+        for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
+        {
+            double Wt = ph_weights[ph_in_seg_index] / (hWZ * max_knn);
+            gt[start_ph_index] = (uint8_t)(MIN(Wt * 255, 255));
+            start_ph_index++;
+        }
+
+        /* Free Photon Weights Array */
+        delete [] ph_weights;
     }
+
+    /* Free Scratch Space */
+    delete [] proximities;
+}
+
+/*----------------------------------------------------------------------------
+ * yapcV3Window
+ *
+ *  writes the height proximity of each of num_neighbors photons starting at
+ *  neighbor_index to the photon at ph_index, or DBL_MAX when the neighbor is
+ *  outside the window; direction is -1.0 for neighbors to the left and 1.0
+ *  for neighbors to the right so the horizontal distance keeps its sign;
+ *  returns the number of neighbors inside the window
+ *----------------------------------------------------------------------------*/
+int Atl03Reader::YapcScore::yapcV3Window (const double* ph_dist, const float* h_ph, int32_t ph_index, int32_t neighbor_index, int32_t num_neighbors,
+                                          double direction, double hWX, double hWZ, double* proximities)
+{
+    const double* x = &ph_dist[neighbor_index];
+    const float* h = &h_ph[neighbor_index];
+    int count = 0;
+    int32_t i = 0;
+
+    #if defined(__SSE2__)
+    {
+        const __m128d x0 = _mm_set1_pd(ph_dist[ph_index]);
+        const __m128 h0 = _mm_set1_ps(h_ph[ph_index]);
+        const __m128d dir = _mm_set1_pd(direction);
+        const __m128d wx = _mm_set1_pd(hWX);
+        const __m128d wz = _mm_set1_pd(hWZ);
+        const __m128d rejected = _mm_set1_pd(DBL_MAX);
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        for(; i + 2 <= num_neighbors; i += 2)
+        {
+            __m128d x_dist = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(&x[i]), x0), dir);
+            __m128 hv = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)&h[i]));
+            __m128d proximity = _mm_cvtps_pd(_mm_andnot_ps(sign, _mm_sub_ps(h0, hv)));
+            __m128d inside = _mm_and_pd(_mm_cmple_pd(x_dist, wx), _mm_cmple_pd(proximity, wz));
+            _mm_storeu_pd(&proximities[i], _mm_or_pd(_mm_and_pd(inside, proximity), _mm_andnot_pd(inside, rejected)));
+            int mask = _mm_movemask_pd(inside);
+            count += (mask & 1) + (mask >> 1);
+        }
+    }
+    #elif defined(__aarch64__)
+    {
+        const float64x2_t x0 = vdupq_n_f64(ph_dist[ph_index]);
+        const float32x2_t h0 = vdup_n_f32(h_ph[ph_index]);
+        const float64x2_t dir = vdupq_n_f64(direction);
+        const float64x2_t wx = vdupq_n_f64(hWX);
+        const float64x2_t wz = vdupq_n_f64(hWZ);
+        const float64x2_t rejected = vdupq_n_f64(DBL_MAX);
+        for(; i + 2 <= num_neighbors; i += 2)
+        {
+            float64x2_t x_dist = vmulq_f64(vsubq_f64(vld1q_f64(&x[i]), x0), dir);
+            float64x2_t proximity = vcvt_f64_f32(vabs_f32(vsub_f32(h0, vld1_f32(&h[i]))));
+            uint64x2_t inside = vandq_u64(vcleq_f64(x_dist, wx), vcleq_f64(proximity, wz));
+            vst1q_f64(&proximities[i], vbslq_f64(inside, proximity, rejected));
+            count += (int)((vgetq_lane_u64(inside, 0) & 1) + (vgetq_lane_u64(inside, 1) & 1));
+        }
+    }
+    #endif
+
+    /* Remaining Neighbors */
+    for(; i < num_neighbors; i++)
+    {
+        double x_dist = (x[i] - ph_dist[ph_index]) * direction;
+        double proximity = abs(h_ph[ph_index] - h[i]);
+        if(x_dist <= hWX && proximity <= hWZ)
+        {
+            proximities[i] = proximity;
+            count++;
+        }
+        else
+        {
+            proximities[i] = DBL_MAX;
+        }
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * partitionSegments
+ *
+ *  splits the segments of pair track t into contiguous row-spans scored
+ *  concurrently; segments are scored independently of each other so the
+ *  result is identical to scoring them in order
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::YapcScore::partitionSegments (info_t* info, Region& region, Atl03Data& atl03, int t, const double* ph_dist, Thread::thread_func_t scorer)
+{
+    int32_t num_segments = atl03.segment_id[t].size;
+    if(num_segments <= 0) return;
+
+    /* Build Photon Offsets of Each Segment */
+    int32_t* ph_offsets = new int32_t [num_segments + 1];
+    ph_offsets[0] = 0;
+    for(int32_t s = 0; s < num_segments; s++)
+    {
+        ph_offsets[s + 1] = ph_offsets[s] + region.segment_ph_cnt[t][s];
+    }
+
+    /* Build Partitions */
+    int num_partitions = info->reader->acquirePartitions(num_segments);
+    int32_t segments_per_partition = (num_segments + num_partitions - 1) / num_partitions;
+    yapc_partition_t* partitions = new yapc_partition_t [num_partitions];
+    for(int p = 0; p < num_partitions; p++)
+    {
+        partitions[p].yapc = this;
+        partitions[p].info = info;
+        partitions[p].region = &region;
+        partitions[p].atl03 = &atl03;
+        partitions[p].t = t;
+        partitions[p].first_segment = MIN(p * segments_per_partition, num_segments);
+        partitions[p].num_segments = MIN(segments_per_partition, num_segments - partitions[p].first_segment);
+        partitions[p].ph_offsets = ph_offsets;
+        partitions[p].ph_dist = ph_dist;
+    }
+
+    /* Score Partitions (first on this thread) */
+    Thread** pids = new Thread* [num_partitions];
+    for(int p = 1; p < num_partitions; p++)
+    {
+        pids[p] = partitions[p].num_segments > 0 ? new Thread(scorer, &partitions[p]) : NULL;
+    }
+    scorer(&partitions[0]);
+    for(int p = 1; p < num_partitions; p++)
+    {
+        delete pids[p]; // joins
+    }
+    info->reader->releasePartitions(num_partitions);
+
+    delete [] pids;
+    delete [] partitions;
+    delete [] ph_offsets;
+}
+
+/*----------------------------------------------------------------------------
+ * yapcV2Thread
+ *----------------------------------------------------------------------------*/
+void* Atl03Reader::YapcScore::yapcV2Thread (void* parm)
+{
+    yapc_partition_t* partition = (yapc_partition_t*)parm;
+    partition->yapc->yapcV2Segments(partition);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * yapcV3Thread
+ *----------------------------------------------------------------------------*/
+void* Atl03Reader::YapcScore::yapcV3Thread (void* parm)
+{
+    yapc_partition_t* partition = (yapc_partition_t*)parm;
+    partition->yapc->yapcV3Segments(partition);
+    return NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -1214,6 +2002,8 @@ Atl03Reader::TrackState::TrackState (Atl03Data& atl03)
     gt[Icesat2Parms::RPT_R].photon_indices    = NULL;
     gt[Icesat2Parms::RPT_R].extent_segment    = 0;
     gt[Icesat2Parms::RPT_R].extent_valid      = true;
+
+    staged = NULL;
 }
 
 /*----------------------------------------------------------------------------
@@ -1238,16 +2028,20 @@ Atl03Reader::TrackState::track_state_t& Atl03Reader::TrackState::operator[](int
  *----------------------------------------------------------------------------*/
 void* Atl03Reader::subsettingThread (void* parm)
 {
+    LatencyHistogram::Sample sample(subsetLatency);
+
     /* Get Thread Info */
     info_t* info = (info_t*)parm;
     Atl03Reader* reader = info->reader;
     Icesat2Parms* parms = reader->parms;
     stats_t local_stats = {0, 0, 0, 0, 0};
     uint32_t extent_counter = 0;
+    int num_partitions = 1;
 
     /* Start Trace */
     uint32_t trace_id = start_trace(INFO, reader->traceId, "atl03_reader", "{\"asset\":\"%s\", \"resource\":\"%s\", \"track\":%d}", info->reader->asset->getName(), info->reader->resource, info->track);
     EventLib::stashId (trace_id); // set thread specific trace id for H5Coro
+    RequestAccount* previous = RequestAccount::attach(reader->account);
 
     try
     {
@@ -1277,355 +2071,617 @@ void* Atl03Reader::subsettingThread (void* parm)
         if(parms->dist_in_seg) state.extent_length *= ATL03_SEGMENT_LENGTH;
 
         /* Traverse All Photons In Dataset */
-        while( reader->active && (!state[Icesat2Parms::RPT_L].track_complete || !state[Icesat2Parms::RPT_R].track_complete) )
+        num_partitions = reader->acquirePartitions(INT_MAX);
+        if(num_partitions == 1)
         {
-            /* Select Photons for Extent from each Track */
-            for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+            while( reader->active && !reader->isCancelled() && (!state[Icesat2Parms::RPT_L].track_complete || !state[Icesat2Parms::RPT_R].track_complete) )
             {
-                /* Skip Completed Tracks */
-                if(state[t].track_complete)
+                /* Select Photons for Extent from each Track */
+                for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
                 {
-                    state[t].extent_valid = false;
-                    continue;
+                    reader->generateExtent(info, t, state, region, atl03, atl08, yapc, true);
                 }
 
-                /* Setup Variables for Extent */
-                int32_t current_photon = state[t].ph_in;
-                int32_t current_segment = state[t].seg_in;
-                int32_t current_count = state[t].seg_ph; // number of photons in current segment already accounted for
-                bool extent_complete = false;
-                bool step_complete = false;
-
-                /* Set Extent State */
-                state[t].start_seg_portion = atl03.dist_ph_along[t][current_photon] / ATL03_SEGMENT_LENGTH;
-                state[t].extent_segment = state[t].seg_in;
-                state[t].extent_valid = true;
-                state[t].extent_photons.clear();
-
-                /* Ancillary Photon Fields */
-                if(parms->atl03_ph_fields)
-                {
-                    if(state[t].photon_indices) state[t].photon_indices->clear();
-                    else                        state[t].photon_indices = new List<int32_t>;
-                }
+                /* Create Extent Record */
+                reader->postExtent(info, extent_counter, state, atl03, &local_stats);
 
-                /* Traverse Photons Until Desired Along Track Distance Reached */
-                while(!extent_complete || !step_complete)
-                {
-                    /* Go to Photon's Segment */
-                    current_count++;
-                    while((current_segment < region.segment_ph_cnt[t].size) &&
-                          (current_count > region.segment_ph_cnt[t][current_segment]))
-                    {
-                        current_count = 1; // reset photons in segment
-                        current_segment++; // go to next segment
-                    }
+                /* Bump Extent Counter */
+                extent_counter++;
+            }
+        }
+        else
+        {
+            reader->partitionExtents(info, num_partitions, state, region, atl03, atl08, yapc, &local_stats);
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Failure during processing of resource %s track %d: %s", info->reader->resource, info->track, e.what());
+        LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), info->reader->resource);
+    }
 
-                    /* Check Current Segment */
-                    if(current_segment >= atl03.segment_dist_x[t].size)
-                    {
-                        mlog(ERROR, "Photons with no segments are detected is %s/%d     %d %ld %ld!", info->reader->resource, info->track, current_segment, atl03.segment_dist_x[t].size, region.num_segments[t]);
-                        state[t].track_complete = true;
-                        break;
-                    }
+    /* Note Abandoned Track */
+    if(reader->isCancelled())
+    {
+        mlog(INFO, "Stopped processing of resource %s track %d, request cancelled", info->reader->resource, info->track);
+    }
 
-                    /* Update Along Track Distance and Progress */
-                    double delta_distance = atl03.segment_dist_x[t][current_segment] - state[t].start_distance;
-                    double along_track_distance = delta_distance + atl03.dist_ph_along[t][current_photon];
-                    int32_t along_track_segments = current_segment - state[t].extent_segment;
+    /* Return Partition Workers to Budget */
+    reader->releasePartitions(num_partitions);
 
-                    /* Set Next Extent's First Photon */
-                    if((!step_complete) &&
-                       ((!parms->dist_in_seg && along_track_distance >= parms->extent_step) ||
-                        (parms->dist_in_seg && along_track_segments >= (int32_t)parms->extent_step)))
-                    {
-                        state[t].ph_in = current_photon;
-                        state[t].seg_in = current_segment;
-                        state[t].seg_ph = current_count - 1;
-                        step_complete = true;
-                    }
+    /* Settle Account before Completion is Signaled */
+    RequestAccount::detach(previous);
 
-                    /* Check if Photon within Extent's Length */
-                    if((!parms->dist_in_seg && along_track_distance < parms->extent_length) ||
-                       (parms->dist_in_seg && along_track_segments < parms->extent_length))
-                    {
-                        do
-                        {
-                            /* Check and Set Signal Confidence Level */
-                            int8_t atl03_cnf = atl03.signal_conf_ph[t][current_photon];
-                            if(atl03_cnf < Icesat2Parms::CNF_POSSIBLE_TEP || atl03_cnf > Icesat2Parms::CNF_SURFACE_HIGH)
-                            {
-                                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl03 signal confidence: %d", atl03_cnf);
-                            }
-                            else if(!parms->atl03_cnf[atl03_cnf + Icesat2Parms::SIGNAL_CONF_OFFSET])
-                            {
-                                break;
-                            }
+    /* Handle Global Reader Updates */
+    reader->threadMut.lock();
+    {
+        /* Update Statistics */
+        reader->stats.segments_read += local_stats.segments_read;
+        reader->stats.extents_filtered += local_stats.extents_filtered;
+        reader->stats.extents_sent += local_stats.extents_sent;
+        reader->stats.extents_dropped += local_stats.extents_dropped;
+        reader->stats.extents_retried += local_stats.extents_retried;
 
-                            /* Check and Set ATL03 Photon Quality Level */
-                            int8_t quality_ph = atl03.quality_ph[t][current_photon];
-                            if(quality_ph < Icesat2Parms::QUALITY_NOMINAL || quality_ph > Icesat2Parms::QUALITY_POSSIBLE_TEP)
-                            {
-                                throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl03 photon quality: %d", quality_ph);
-                            }
-                            else if(!parms->quality_ph[quality_ph])
-                            {
-                                break;
-                            }
+        /* Count Completion */
+        reader->numComplete++;
+        if(reader->numComplete == reader->threadCount)
+        {
+            mlog(INFO, "Completed processing resource %s", info->reader->resource);
 
-                            /* Check and Set ATL08 Classification */
-                            Icesat2Parms::atl08_classification_t atl08_class = Icesat2Parms::ATL08_UNCLASSIFIED;
-                            if(atl08[t])
-                            {
-                                atl08_class = (Icesat2Parms::atl08_classification_t)atl08[t][current_photon];
-                                if(atl08_class < 0 || atl08_class >= Icesat2Parms::NUM_ATL08_CLASSES)
-                                {
-                                    throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl08 classification: %d", atl08_class);
-                                }
-                                else if(!parms->atl08_class[atl08_class])
-                                {
-                                    break;
-                                }
-                            }
+            /* Indicate End of Data */
+            if(reader->sendTerminator) reader->outQ->postCopy("", 0);
+            reader->signalComplete();
+        }
+    }
+    reader->threadMut.unlock();
 
-                            /* Check and Set YAPC Score */
-                            uint8_t yapc_score = 0;
-                            if(yapc[t])
-                            {
-                                yapc_score = yapc[t][current_photon];
-                                if(yapc_score < parms->yapc.score)
-                                {
-                                    break;
-                                }
-                            }
+    /* Clean Up Info */
+    delete info;
 
-                            /* Check Region */
-                            if(region.inclusion_ptr[t])
-                            {
-                                if(!region.inclusion_ptr[t][current_segment])
-                                {
-                                    break;
-                                }
-                            }
+    /* Stop Trace */
+    stop_trace(INFO, trace_id);
 
-                            /* Set PhoREAL Fields */
-                            float relief = 0.0;
-                            uint8_t landcover_flag = Atl08Class::INVALID_FLAG;
-                            uint8_t snowcover_flag = Atl08Class::INVALID_FLAG;
-                            if(parms->stages[Icesat2Parms::STAGE_PHOREAL])
-                            {
-                                /* Set Relief */
-                                if(!parms->phoreal.use_abs_h)
-                                {
-                                    relief = atl08.relief[t][current_photon];
-                                }
-                                else
-                                {
-                                    relief = atl03.h_ph[t][current_photon];
-                                }
-
-                                /* Set Flags */
-                                landcover_flag = atl08.landcover[t][current_photon];
-                                snowcover_flag = atl08.snowcover[t][current_photon];
-                            }
+    /* Return Track Thread to Budget */
+    if(reader->threadCount > 1) ThreadBudget::release(1);
 
-                            /* Add Photon to Extent */
-                            photon_t ph = {
-                                .delta_time = atl03.delta_time[t][current_photon],
-                                .latitude = atl03.lat_ph[t][current_photon],
-                                .longitude = atl03.lon_ph[t][current_photon],
-                                .distance = along_track_distance - (state.extent_length / 2.0),
-                                .height = atl03.h_ph[t][current_photon],
-                                .relief = relief,
-                                .landcover = landcover_flag,
-                                .snowcover = snowcover_flag,
-                                .atl08_class = (uint8_t)atl08_class,
-                                .atl03_cnf = (int8_t)atl03_cnf,
-                                .quality_ph = (int8_t)quality_ph,
-                                .yapc_score = yapc_score
-                            };
-                            state[t].extent_photons.add(ph);
-
-                            /* Index Photon for Ancillary Fields */
-                            if(state[t].photon_indices)
-                            {
-                                state[t].photon_indices->add(current_photon);
-                            }
-                        } while(false);
-                    }
-                    else
+    /* Return */
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * partitionThread
+ *
+ *  generates a contiguous run of extents for a track from their planned
+ *  starting points, staging the records for ordered posting
+ *----------------------------------------------------------------------------*/
+void* Atl03Reader::partitionThread (void* parm)
+{
+    partition_t* partition = (partition_t*)parm;
+    info_t* info = partition->info;
+    Atl03Reader* reader = info->reader;
+    const extent_start_t* starts = partition->starts;
+
+    try
+    {
+        TrackState state(*partition->atl03);
+        state.extent_length = partition->extent_length;
+        state.staged = &partition->staged;
+
+        /* Recreate State Left Behind by Tracks Completed Before Partition */
+        uint32_t first = partition->first_extent;
+        for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+        {
+            if(!starts[(first * Icesat2Parms::NUM_PAIR_TRACKS) + t].track_complete) continue;
+
+            int64_t last_active = (int64_t)first - 1;
+            while(last_active >= 0 && starts[(last_active * Icesat2Parms::NUM_PAIR_TRACKS) + t].track_complete) last_active--;
+            if(last_active < 0) continue;
+
+            starts[(last_active * Icesat2Parms::NUM_PAIR_TRACKS) + t].restore(state[t]);
+            reader->generateExtent(info, t, state, *partition->region, *partition->atl03, *partition->atl08, *partition->yapc, true);
+        }
+
+        /* Generate Extents */
+        for(uint32_t extent = first; reader->active && !reader->isCancelled() && extent < first + partition->num_extents; extent++)
+        {
+            for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+            {
+                starts[(extent * Icesat2Parms::NUM_PAIR_TRACKS) + t].restore(state[t]);
+                reader->generateExtent(info, t, state, *partition->region, *partition->atl03, *partition->atl08, *partition->yapc, true);
+            }
+            reader->postExtent(info, extent, state, *partition->atl03, &partition->stats);
+        }
+    }
+    catch(const RunTimeException& e)
+    {
+        partition->error = new RunTimeException(e);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * generateExtent
+ *
+ *  selects the photons of the next extent for pair track t and advances the
+ *  track state to the start of the following extent; when select_photons is
+ *  false only the walk is performed (used to plan partitions)
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::generateExtent (info_t* info, int t, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc, bool select_photons)
+{
+    unsigned options = 0;
+    if(parms->dist_in_seg) options |= EXTENT_SEGMENTS;
+    if(select_photons)
+    {
+        options |= EXTENT_SELECT;
+        if(atl08[t]) options |= EXTENT_ATL08;
+        if(yapc[t]) options |= EXTENT_YAPC;
+        if(parms->stages[Icesat2Parms::STAGE_PHOREAL]) options |= EXTENT_PHOREAL;
+    }
+
+    (this->*extentVariants[options])(info, t, state, region, atl03, atl08, yapc);
+}
+
+/*----------------------------------------------------------------------------
+ * selectExtent
+ *
+ *  body of generateExtent compiled for one combination of options so that
+ *  the checks of options that are off drop out of the per-photon loop
+ *----------------------------------------------------------------------------*/
+template <unsigned OPTS>
+void Atl03Reader::selectExtent (info_t* info, int t, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc)
+{
+    const bool select_photons = (OPTS & EXTENT_SELECT) != 0;
+    const bool dist_in_seg = (OPTS & EXTENT_SEGMENTS) != 0;
+
+    /* Skip Completed Tracks */
+    if(state[t].track_complete)
+    {
+        state[t].extent_valid = false;
+        return;
+    }
+
+    /* Setup Variables for Extent */
+    int32_t current_photon = state[t].ph_in;
+    int32_t current_segment = state[t].seg_in;
+    int32_t current_count = state[t].seg_ph; // number of photons in current segment already accounted for
+    bool extent_complete = false;
+    bool step_complete = false;
+
+    /* Set Extent State */
+    state[t].start_seg_portion = atl03.dist_ph_along[t][current_photon] / ATL03_SEGMENT_LENGTH;
+    state[t].extent_segment = state[t].seg_in;
+    state[t].extent_valid = true;
+    state[t].extent_photons.clear();
+
+    /* Ancillary Photon Fields */
+    if(select_photons && parms->atl03_ph_fields)
+    {
+        if(state[t].photon_indices) state[t].photon_indices->clear();
+        else                        state[t].photon_indices = new List<int32_t>;
+    }
+
+    /* Traverse Photons Until Desired Along Track Distance Reached */
+    while(!extent_complete || !step_complete)
+    {
+        /* Go to Photon's Segment */
+        current_count++;
+        while((current_segment < region.segment_ph_cnt[t].size) &&
+              (current_count > region.segment_ph_cnt[t][current_segment]))
+        {
+            current_count = 1; // reset photons in segment
+            current_segment++; // go to next segment
+        }
+
+        /* Check Current Segment */
+        if(current_segment >= atl03.segment_dist_x[t].size)
+        {
+            mlog(ERROR, "Photons with no segments are detected is %s/%d     %d %ld %ld!", resource, info->track, current_segment, atl03.segment_dist_x[t].size, region.num_segments[t]);
+            state[t].track_complete = true;
+            break;
+        }
+
+        /* Update Along Track Distance and Progress */
+        double delta_distance = atl03.segment_dist_x[t][current_segment] - state[t].start_distance;
+        double along_track_distance = delta_distance + atl03.dist_ph_along[t][current_photon];
+        int32_t along_track_segments = current_segment - state[t].extent_segment;
+
+        /* Set Next Extent's First Photon */
+        if((!step_complete) &&
+           ((!dist_in_seg && along_track_distance >= parms->extent_step) ||
+            (dist_in_seg && along_track_segments >= (int32_t)parms->extent_step)))
+        {
+            state[t].ph_in = current_photon;
+            state[t].seg_in = current_segment;
+            state[t].seg_ph = current_count - 1;
+            step_complete = true;
+        }
+
+        /* Check if Photon within Extent's Length */
+        if((!dist_in_seg && along_track_distance < parms->extent_length) ||
+           (dist_in_seg && along_track_segments < parms->extent_length))
+        {
+            do
+            {
+                /* Planning Only Walks the Extent */
+                if(!select_photons) break;
+
+                /* Check and Set Signal Confidence Level */
+                int8_t atl03_cnf = atl03.signal_conf_ph[t][current_photon];
+                if(atl03_cnf < Icesat2Parms::CNF_POSSIBLE_TEP || atl03_cnf > Icesat2Parms::CNF_SURFACE_HIGH)
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl03 signal confidence: %d", atl03_cnf);
+                }
+                else if(!parms->atl03_cnf[atl03_cnf + Icesat2Parms::SIGNAL_CONF_OFFSET])
+                {
+                    break;
+                }
+
+                /* Check and Set ATL03 Photon Quality Level */
+                int8_t quality_ph = atl03.quality_ph[t][current_photon];
+                if(quality_ph < Icesat2Parms::QUALITY_NOMINAL || quality_ph > Icesat2Parms::QUALITY_POSSIBLE_TEP)
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl03 photon quality: %d", quality_ph);
+                }
+                else if(!parms->quality_ph[quality_ph])
+                {
+                    break;
+                }
+
+                /* Check and Set ATL08 Classification */
+                Icesat2Parms::atl08_classification_t atl08_class = Icesat2Parms::ATL08_UNCLASSIFIED;
+                if(OPTS & EXTENT_ATL08)
+                {
+                    atl08_class = (Icesat2Parms::atl08_classification_t)atl08[t][current_photon];
+                    if(atl08_class < 0 || atl08_class >= Icesat2Parms::NUM_ATL08_CLASSES)
                     {
-                        extent_complete = true;
+                        throw RunTimeException(CRITICAL, RTE_ERROR, "invalid atl08 classification: %d", atl08_class);
                     }
-
-                    /* Go to Next Photon */
-                    current_photon++;
-
-                    /* Check Current Photon */
-                    if(current_photon >= atl03.dist_ph_along[t].size)
+                    else if(!parms->atl08_class[atl08_class])
                     {
-                        state[t].track_complete = true;
                         break;
                     }
                 }
 
-                /* Save Off Segment Distance to Include in Extent Record */
-                state[t].seg_distance = state[t].start_distance + (state.extent_length / 2.0);
-
-                /* Add Step to Start Distance */
-                if(!parms->dist_in_seg)
+                /* Check and Set YAPC Score */
+                uint8_t yapc_score = 0;
+                if(OPTS & EXTENT_YAPC)
                 {
-                    state[t].start_distance += parms->extent_step; // step start distance
-
-                    /* Apply Segment Distance Correction and Update Start Segment */
-                    while( ((state[t].start_segment + 1) < atl03.segment_dist_x[t].size) &&
-                            (state[t].start_distance >= atl03.segment_dist_x[t][state[t].start_segment + 1]) )
+                    yapc_score = yapc[t][current_photon];
+                    if(yapc_score < parms->yapc.score)
                     {
-                        state[t].start_distance += atl03.segment_dist_x[t][state[t].start_segment + 1] - atl03.segment_dist_x[t][state[t].start_segment];
-                        state[t].start_distance -= ATL03_SEGMENT_LENGTH;
-                        state[t].start_segment++;
+                        break;
                     }
                 }
-                else // distance in segments
+
+                /* Check Region */
+                if(region.inclusion_ptr[t])
                 {
-                    int32_t next_segment = state[t].extent_segment + (int32_t)parms->extent_step;
-                    if(next_segment < atl03.segment_dist_x[t].size)
+                    if(!region.inclusion_ptr[t][current_segment])
                     {
-                        state[t].start_distance = atl03.segment_dist_x[t][next_segment]; // set start distance to next extent's segment distance
+                        break;
                     }
                 }
 
-                /* Check Photon Count */
-                if(state[t].extent_photons.length() < parms->minimum_photon_count)
-                {
-                    state[t].extent_valid = false;
-                }
-
-                /* Check Along Track Spread */
-                if(state[t].extent_photons.length() > 1)
+                /* Set PhoREAL Fields */
+                float relief = 0.0;
+                uint8_t landcover_flag = Atl08Class::INVALID_FLAG;
+                uint8_t snowcover_flag = Atl08Class::INVALID_FLAG;
+                if(OPTS & EXTENT_PHOREAL)
                 {
-                    int32_t last = state[t].extent_photons.length() - 1;
-                    double along_track_spread = state[t].extent_photons[last].distance - state[t].extent_photons[0].distance;
-                    if(along_track_spread < parms->along_track_spread)
+                    /* Set Relief */
+                    if(!parms->phoreal.use_abs_h)
                     {
-                        state[t].extent_valid = false;
+                        relief = atl08.relief[t][current_photon];
+                    }
+                    else
+                    {
+                        relief = atl03.h_ph[t][current_photon];
                     }
-                }
-            }
 
-            /* Create Extent Record */
-            if(state[Icesat2Parms::RPT_L].extent_valid || state[Icesat2Parms::RPT_R].extent_valid || parms->pass_invalid)
-            {
-                /* Generate Extent ID */
-                uint64_t extent_id = ((uint64_t)reader->start_rgt << 52) |
-                                     ((uint64_t)reader->start_cycle << 36) |
-                                     ((uint64_t)reader->start_region << 32) |
-                                     ((uint64_t)info->track << 30) |
-                                     (((uint64_t)extent_counter & 0xFFFFFFF) << 2) |
-                                     Icesat2Parms::EXTENT_ID_PHOTONS;
-
-                /* Build and Send Extent Record */
-                if(!reader->flatten)
-                {
-                    reader->sendExtentRecord(extent_id, info->track, state, atl03, &local_stats);
+                    /* Set Flags */
+                    landcover_flag = atl08.landcover[t][current_photon];
+                    snowcover_flag = atl08.snowcover[t][current_photon];
                 }
-                else
+
+                /* Add Photon to Extent */
+                photon_t ph = {
+                    .delta_time = atl03.delta_time[t][current_photon],
+                    .latitude = atl03.lat_ph[t][current_photon],
+                    .longitude = atl03.lon_ph[t][current_photon],
+                    .distance = along_track_distance - (state.extent_length / 2.0),
+                    .height = atl03.h_ph[t][current_photon],
+                    .relief = relief,
+                    .landcover = landcover_flag,
+                    .snowcover = snowcover_flag,
+                    .atl08_class = (uint8_t)atl08_class,
+                    .atl03_cnf = (int8_t)atl03_cnf,
+                    .quality_ph = (int8_t)quality_ph,
+                    .yapc_score = yapc_score
+                };
+                state[t].extent_photons.add(ph);
+
+                /* Index Photon for Ancillary Fields */
+                if(state[t].photon_indices)
                 {
-                    reader->sendFlatRecord (extent_id, info->track, state, atl03, &local_stats);
+                    state[t].photon_indices->add(current_photon);
                 }
+            } while(false);
+        }
+        else
+        {
+            extent_complete = true;
+        }
 
+        /* Go to Next Photon */
+        current_photon++;
 
-                /* Send Ancillary Records */
-                reader->sendAncillaryGeoRecords(extent_id, parms->atl03_geo_fields, &atl03.anc_geo_data, state, &local_stats);
-                reader->sendAncillaryPhRecords(extent_id, parms->atl03_ph_fields, &atl03.anc_ph_data, state, &local_stats);
-            }
-            else // neither pair in extent valid
-            {
-                local_stats.extents_filtered++;
-            }
+        /* Check Current Photon */
+        if(current_photon >= atl03.dist_ph_along[t].size)
+        {
+            state[t].track_complete = true;
+            break;
+        }
+    }
 
-            /* Bump Extent Counter */
-            extent_counter++;
+    /* Save Off Segment Distance to Include in Extent Record */
+    state[t].seg_distance = state[t].start_distance + (state.extent_length / 2.0);
+
+    /* Add Step to Start Distance */
+    if(!dist_in_seg)
+    {
+        state[t].start_distance += parms->extent_step; // step start distance
+
+        /* Apply Segment Distance Correction and Update Start Segment */
+        while( ((state[t].start_segment + 1) < atl03.segment_dist_x[t].size) &&
+                (state[t].start_distance >= atl03.segment_dist_x[t][state[t].start_segment + 1]) )
+        {
+            state[t].start_distance += atl03.segment_dist_x[t][state[t].start_segment + 1] - atl03.segment_dist_x[t][state[t].start_segment];
+            state[t].start_distance -= ATL03_SEGMENT_LENGTH;
+            state[t].start_segment++;
         }
     }
-    catch(const RunTimeException& e)
+    else // distance in segments
     {
-        mlog(e.level(), "Failure during processing of resource %s track %d: %s", info->reader->resource, info->track, e.what());
-        LuaEndpoint::generateExceptionStatus(e.code(), e.level(), reader->outQ, &reader->active, "%s: (%s)", e.what(), info->reader->resource);
+        int32_t next_segment = state[t].extent_segment + (int32_t)parms->extent_step;
+        if(next_segment < atl03.segment_dist_x[t].size)
+        {
+            state[t].start_distance = atl03.segment_dist_x[t][next_segment]; // set start distance to next extent's segment distance
+        }
     }
 
-    /* Handle Global Reader Updates */
-    reader->threadMut.lock();
+    /* Check Photon Count */
+    if(state[t].extent_photons.length() < parms->minimum_photon_count)
     {
-        /* Update Statistics */
-        reader->stats.segments_read += local_stats.segments_read;
-        reader->stats.extents_filtered += local_stats.extents_filtered;
-        reader->stats.extents_sent += local_stats.extents_sent;
-        reader->stats.extents_dropped += local_stats.extents_dropped;
-        reader->stats.extents_retried += local_stats.extents_retried;
+        state[t].extent_valid = false;
+    }
 
-        /* Count Completion */
-        reader->numComplete++;
-        if(reader->numComplete == reader->threadCount)
+    /* Check Along Track Spread */
+    if(state[t].extent_photons.length() > 1)
+    {
+        int32_t last = state[t].extent_photons.length() - 1;
+        double along_track_spread = state[t].extent_photons[last].distance - state[t].extent_photons[0].distance;
+        if(along_track_spread < parms->along_track_spread)
         {
-            mlog(INFO, "Completed processing resource %s", info->reader->resource);
+            state[t].extent_valid = false;
+        }
+    }
+}
 
-            /* Indicate End of Data */
-            if(reader->sendTerminator) reader->outQ->postCopy("", 0);
-            reader->signalComplete();
+/*----------------------------------------------------------------------------
+ * postExtent
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::postExtent (info_t* info, uint32_t extent_counter, TrackState& state, Atl03Data& atl03, stats_t* local_stats)
+{
+    /* Create Extent Record */
+    if(state[Icesat2Parms::RPT_L].extent_valid || state[Icesat2Parms::RPT_R].extent_valid || parms->pass_invalid)
+    {
+        /* Generate Extent ID */
+        uint64_t extent_id = ((uint64_t)start_rgt << 52) |
+                             ((uint64_t)start_cycle << 36) |
+                             ((uint64_t)start_region << 32) |
+                             ((uint64_t)info->track << 30) |
+                             (((uint64_t)extent_counter & 0xFFFFFFF) << 2) |
+                             Icesat2Parms::EXTENT_ID_PHOTONS;
+
+        /* Build and Send Extent Record */
+        if(flatten)
+        {
+            sendFlatRecord (extent_id, info->track, state, atl03, local_stats);
+        }
+        else if(columnar)
+        {
+            sendColumnarRecord(extent_id, info->track, state, atl03, local_stats);
+        }
+        else
+        {
+            sendExtentRecord(extent_id, info->track, state, atl03, local_stats);
+        }
+
+        /* Send Ancillary Records */
+        if(parms->atl03_anc_packed)
+        {
+            sendPackedGeoRecord(extent_id, parms->atl03_geo_fields, &atl03.anc_geo_data, state, local_stats);
+            sendPackedPhRecord(extent_id, parms->atl03_ph_fields, &atl03.anc_ph_data, state, local_stats);
+        }
+        else
+        {
+            sendAncillaryGeoRecords(extent_id, parms->atl03_geo_fields, &atl03.anc_geo_data, state, local_stats);
+            sendAncillaryPhRecords(extent_id, parms->atl03_ph_fields, &atl03.anc_ph_data, state, local_stats);
         }
     }
-    reader->threadMut.unlock();
+    else // neither pair in extent valid
+    {
+        local_stats->extents_filtered++;
+    }
+}
 
-    /* Clean Up Info */
-    delete info;
+/*----------------------------------------------------------------------------
+ * partitionCount
+ *
+ *  number of workers each track thread subsets with; zero sizes the
+ *  workers to the cores left over by the track threads
+ *----------------------------------------------------------------------------*/
+int Atl03Reader::partitionCount (void)
+{
+    if(parms->partitions > 0) return parms->partitions;
+    return MAX(1, LocalLib::nproc() / threadCount);
+}
 
-    /* Stop Trace */
-    stop_trace(INFO, trace_id);
+/*----------------------------------------------------------------------------
+ * acquirePartitions
+ *
+ *  takes the workers beyond the calling thread out of the node's thread
+ *  budget; an explicit partition count is honored, otherwise the request
+ *  gets the share of the unused budget its priority allows
+ *----------------------------------------------------------------------------*/
+int Atl03Reader::acquirePartitions (int max_partitions)
+{
+    int wanted = MIN(partitionCount(), max_partitions);
+    if(wanted <= 1) return 1;
+    if(parms->partitions > 0)
+    {
+        ThreadBudget::reserve(wanted - 1);
+        return wanted;
+    }
+    return ThreadBudget::acquire(wanted - 1, parms->priority) + 1;
+}
 
-    /* Return */
-    return NULL;
+/*----------------------------------------------------------------------------
+ * releasePartitions
+ *----------------------------------------------------------------------------*/
+void Atl03Reader::releasePartitions (int num_partitions)
+{
+    ThreadBudget::release(num_partitions - 1);
 }
 
 /*----------------------------------------------------------------------------
- * calculateBackground
+ * partitionExtents
+ *
+ *  plans the starting point of every extent in the track with a walk that
+ *  skips photon selection, splits the extents into contiguous partitions
+ *  generated by a pool of workers, and posts each partition's records in
+ *  order so the output stream matches sequential processing
  *----------------------------------------------------------------------------*/
-double Atl03Reader::calculateBackground (int t, TrackState& state, Atl03Data& atl03)
+void Atl03Reader::partitionExtents (info_t* info, int num_partitions, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc, stats_t* local_stats)
 {
-    double background_rate = atl03.bckgrd_rate[t][atl03.bckgrd_rate[t].size - 1];
-    while(state[t].bckgrd_in < atl03.bckgrd_rate[t].size)
+    /* Plan Extents */
+    ArrayList<extent_start_t> starts;
+    while( active && !isCancelled() && (!state[Icesat2Parms::RPT_L].track_complete || !state[Icesat2Parms::RPT_R].track_complete) )
     {
-        double curr_bckgrd_time = atl03.bckgrd_delta_time[t][state[t].bckgrd_in];
-        double segment_time = atl03.segment_delta_time[t][state[t].extent_segment];
-        if(curr_bckgrd_time >= segment_time)
+        for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
         {
-            /* Interpolate Background Rate */
-            if(state[t].bckgrd_in > 0)
-            {
-                double prev_bckgrd_time = atl03.bckgrd_delta_time[t][state[t].bckgrd_in - 1];
-                double prev_bckgrd_rate = atl03.bckgrd_rate[t][state[t].bckgrd_in - 1];
-                double curr_bckgrd_rate = atl03.bckgrd_rate[t][state[t].bckgrd_in];
+            starts.add(extent_start_t(state[t]));
+        }
+        for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+        {
+            generateExtent(info, t, state, region, atl03, atl08, yapc, false);
+        }
+    }
+    uint32_t num_extents = starts.length() / Icesat2Parms::NUM_PAIR_TRACKS;
+    if(num_extents == 0) return;
+
+    /* Start Workers */
+    num_partitions = MIN(num_partitions, (int)num_extents);
+    uint32_t extents_per_partition = (num_extents + num_partitions - 1) / num_partitions;
+    partition_t* partitions = new partition_t [num_partitions];
+    Thread** pids = new Thread* [num_partitions];
+    for(int p = 0; p < num_partitions; p++)
+    {
+        partition_t* partition = &partitions[p];
+        partition->info = info;
+        partition->region = &region;
+        partition->atl03 = &atl03;
+        partition->atl08 = &atl08;
+        partition->yapc = &yapc;
+        partition->starts = starts.begin();
+        partition->extent_length = state.extent_length;
+        partition->first_extent = MIN(p * extents_per_partition, num_extents);
+        partition->num_extents = MIN(extents_per_partition, num_extents - partition->first_extent);
+        partition->stats = {0, 0, 0, 0, 0};
+        partition->error = NULL;
+        pids[p] = partition->num_extents > 0 ? new Thread(partitionThread, partition) : NULL;
+    }
 
-                double bckgrd_run = curr_bckgrd_time - prev_bckgrd_time;
-                double bckgrd_rise = curr_bckgrd_rate - prev_bckgrd_rate;
-                double segment_to_bckgrd_delta = segment_time - prev_bckgrd_time;
+    /* Merge Workers in Order */
+    RunTimeException* error = NULL;
+    for(int p = 0; p < num_partitions; p++)
+    {
+        delete pids[p]; // joins
 
-                background_rate = ((bckgrd_rise / bckgrd_run) * segment_to_bckgrd_delta) + prev_bckgrd_rate;
-            }
-            else
-            {
-                /* Use First Background Rate (no interpolation) */
-                background_rate = atl03.bckgrd_rate[t][0];
-            }
-            break;
+        /* Post Staged Records (up to the first failure) */
+        partition_t* partition = &partitions[p];
+        for(int r = 0; r < partition->staged.length(); r++)
+        {
+            staged_rec_t& rec = partition->staged[r];
+            if(!error)  postBuffer(rec.buffer, rec.size, rec.type, local_stats);
+            else        RecordPool::release(rec.buffer);
         }
-        else
+
+        /* Accumulate Statistics */
+        local_stats->extents_filtered += partition->stats.extents_filtered;
+        local_stats->extents_sent += partition->stats.extents_sent;
+        local_stats->extents_dropped += partition->stats.extents_dropped;
+        local_stats->extents_retried += partition->stats.extents_retried;
+
+        /* Keep First Error */
+        if(partition->error)
         {
-            /* Go To Next Background Rate */
-            state[t].bckgrd_in++;
+            if(!error)  error = partition->error;
+            else        delete partition->error;
         }
     }
-    return background_rate;
+    delete [] pids;
+    delete [] partitions;
+
+    /* Report Failure */
+    if(error)
+    {
+        RunTimeException e(*error);
+        delete error;
+        throw e;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * calculateBackground
+ *
+ *  interpolates the background rate at the start of the extent; the index
+ *  of the first background row at or after the extent only moves forward and
+ *  is found by binary search, so extents that start far past the previous
+ *  one (e.g. the first extent of a subsetted region) do not walk every row
+ *----------------------------------------------------------------------------*/
+double Atl03Reader::calculateBackground (int t, TrackState& state, Atl03Data& atl03)
+{
+    const long num_bckgrd = atl03.bckgrd_rate[t].size;
+    const double* bckgrd_time = &atl03.bckgrd_delta_time[t][0];
+    const double segment_time = atl03.segment_delta_time[t][state[t].extent_segment];
+
+    /* Go To First Background Rate at or After Segment */
+    state[t].bckgrd_in = std::lower_bound(bckgrd_time + state[t].bckgrd_in, bckgrd_time + num_bckgrd, segment_time) - bckgrd_time;
+
+    if(state[t].bckgrd_in >= num_bckgrd)
+    {
+        /* Use Last Background Rate (segment past end) */
+        return atl03.bckgrd_rate[t][num_bckgrd - 1];
+    }
+    else if(state[t].bckgrd_in == 0)
+    {
+        /* Use First Background Rate (no interpolation) */
+        return atl03.bckgrd_rate[t][0];
+    }
+
+    /* Interpolate Background Rate */
+    double curr_bckgrd_time = bckgrd_time[state[t].bckgrd_in];
+    double prev_bckgrd_time = bckgrd_time[state[t].bckgrd_in - 1];
+    double prev_bckgrd_rate = atl03.bckgrd_rate[t][state[t].bckgrd_in - 1];
+    double curr_bckgrd_rate = atl03.bckgrd_rate[t][state[t].bckgrd_in];
+
+    double bckgrd_run = curr_bckgrd_time - prev_bckgrd_time;
+    double bckgrd_rise = curr_bckgrd_rate - prev_bckgrd_rate;
+    double segment_to_bckgrd_delta = segment_time - prev_bckgrd_time;
+
+    return ((bckgrd_rise / bckgrd_run) * segment_to_bckgrd_delta) + prev_bckgrd_rate;
 }
 
 /*----------------------------------------------------------------------------
@@ -1715,7 +2771,74 @@ bool Atl03Reader::sendExtentRecord (uint64_t extent_id, uint8_t track, TrackStat
     extent->photon_offset[Icesat2Parms::RPT_R] = offsetof(extent_t, photons) + (sizeof(photon_t) * extent->photon_count[Icesat2Parms::RPT_L]);
 
     /* Post Segment Record */
-    return postRecord(&record, local_stats);
+    return postRecord(&record, local_stats, state.staged);
+}
+
+/*----------------------------------------------------------------------------
+ * sendColumnarRecord
+ *----------------------------------------------------------------------------*/
+bool Atl03Reader::sendColumnarRecord (uint64_t extent_id, uint8_t track, TrackState& state, Atl03Data& atl03, stats_t* local_stats)
+{
+    /* Calculate Extent Record Size */
+    int num_photons = state[Icesat2Parms::RPT_L].extent_photons.length() + state[Icesat2Parms::RPT_R].extent_photons.length();
+    int columns_offset = (offsetof(col_extent_t, data) + sizeof(double) - 1) & ~(sizeof(double) - 1); // keep columns aligned
+    int extent_bytes = columns_offset + columnsSize(num_photons);
+
+    /* Allocate and Initialize Extent Record */
+    RecordObject record(exColRecType, extent_bytes);
+    col_extent_t* extent = (col_extent_t*)record.getRecordData();
+    extent->extent_id = extent_id;
+    extent->reference_pair_track = track;
+    extent->spacecraft_orientation = (*sc_orient)[0];
+    extent->reference_ground_track_start = start_rgt;
+    extent->cycle_start = start_cycle;
+
+    /* Lay Out Columns */
+    photon_columns_t columns;
+    uint8_t* base = (uint8_t*)extent;
+    bindColumns(base + columns_offset, num_photons, &columns);
+
+    /* Populate Extent */
+    uint32_t ph_out = 0;
+    for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+    {
+        /* Calculate Spacecraft Velocity */
+        int32_t sc_v_offset = state[t].extent_segment * 3;
+        double sc_v1 = atl03.velocity_sc[t][sc_v_offset + 0];
+        double sc_v2 = atl03.velocity_sc[t][sc_v_offset + 1];
+        double sc_v3 = atl03.velocity_sc[t][sc_v_offset + 2];
+        double spacecraft_velocity = sqrt((sc_v1*sc_v1) + (sc_v2*sc_v2) + (sc_v3*sc_v3));
+
+        /* Populate Attributes */
+        extent->valid[t]                = state[t].extent_valid;
+        extent->segment_id[t]           = calculateSegmentId(t, state, atl03);
+        extent->segment_distance[t]     = state[t].seg_distance;
+        extent->extent_length[t]        = state.extent_length;
+        extent->spacecraft_velocity[t]  = spacecraft_velocity;
+        extent->background_rate[t]      = calculateBackground(t, state, atl03);
+        extent->solar_elevation[t]      = atl03.solar_elevation[t][state[t].extent_segment];
+        extent->photon_count[t]         = state[t].extent_photons.length();
+
+        /* Set Column Pointer Fields (offsets from start of record data) */
+        uint8_t* column[NUM_PHOTON_COLUMNS] = {
+            (uint8_t*)columns.delta_time, (uint8_t*)columns.latitude, (uint8_t*)columns.longitude, (uint8_t*)columns.x_atc,
+            (uint8_t*)columns.height, (uint8_t*)columns.relief,
+            columns.landcover, columns.snowcover, columns.atl08_class, (uint8_t*)columns.atl03_cnf, (uint8_t*)columns.quality_ph, columns.yapc_score
+        };
+        for(int c = 0; c < NUM_PHOTON_COLUMNS; c++)
+        {
+            extent->column_offset[c][t] = (column[c] - base) + (PhotonColumnSize[c] * ph_out);
+        }
+
+        /* Populate Photons */
+        for(int32_t p = 0; p < state[t].extent_photons.length(); p++)
+        {
+            setColumns(&columns, ph_out++, &state[t].extent_photons[p]);
+        }
+    }
+
+    /* Post Segment Record */
+    return postRecord(&record, local_stats, state.staged);
 }
 
 /*----------------------------------------------------------------------------
@@ -1757,7 +2880,7 @@ bool Atl03Reader::sendFlatRecord (uint64_t extent_id, uint8_t track, TrackState&
     }
 
     /* Post Segment Record */
-    return postRecord(&record, local_stats);
+    return postRecord(&record, local_stats, state.staged);
 }
 
 /*----------------------------------------------------------------------------
@@ -1788,7 +2911,7 @@ bool Atl03Reader::sendAncillaryGeoRecords (uint64_t extent_id, Icesat2Parms::str
             array->serialize(&data->data[0], start_element, num_elements);
 
             /* Post Ancillary Record */
-            postRecord(&record, local_stats);
+            postRecord(&record, local_stats, state.staged);
         }
         return true;
     }
@@ -1835,7 +2958,7 @@ bool Atl03Reader::sendAncillaryPhRecords (uint64_t extent_id, Icesat2Parms::stri
             }
 
             /* Post Ancillary Record */
-            postRecord(&record, local_stats);
+            postRecord(&record, local_stats, state.staged);
         }
         return true;
     }
@@ -1845,28 +2968,162 @@ bool Atl03Reader::sendAncillaryPhRecords (uint64_t extent_id, Icesat2Parms::stri
     }
 }
 
+/*----------------------------------------------------------------------------
+ * sendPackedGeoRecord
+ *
+ *  sends every requested extent ancillary field in a single record; falls
+ *  back to a record per field when more fields are requested than fit
+ *----------------------------------------------------------------------------*/
+bool Atl03Reader::sendPackedGeoRecord (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats)
+{
+    if(field_list)
+    {
+        int num_fields = field_list->length();
+        if(num_fields > MAX_PACKED_FIELDS)
+        {
+            return sendAncillaryGeoRecords(extent_id, field_list, field_dict, state, local_stats);
+        }
+
+        /* Size Packed Record */
+        int data_size = 0;
+        for(int i = 0; i < num_fields; i++)
+        {
+            GTDArray* array = field_dict->get((*field_list)[i].getString());
+            data_size += array->gt[Icesat2Parms::RPT_L].elementSize() + array->gt[Icesat2Parms::RPT_R].elementSize();
+        }
+
+        /* Create Packed Record */
+        RecordObject record(exPackedRecType, offsetof(anc_extent_packed_t, data) + data_size);
+        anc_extent_packed_t* data = (anc_extent_packed_t*)record.getRecordData();
+        data->extent_id = extent_id;
+        data->num_fields = num_fields;
+
+        /* Populate Fields */
+        uint32_t num_elements[Icesat2Parms::NUM_PAIR_TRACKS] = {1, 1};
+        int32_t start_element[Icesat2Parms::NUM_PAIR_TRACKS] = {state[Icesat2Parms::RPT_L].extent_segment, state[Icesat2Parms::RPT_R].extent_segment};
+        uint64_t bytes_written = 0;
+        for(int i = 0; i < num_fields; i++)
+        {
+            GTDArray* array = field_dict->get((*field_list)[i].getString());
+            data->data_type[i] = array->gt[Icesat2Parms::RPT_L].elementType();
+            data->field_offset[i] = bytes_written;
+            bytes_written += array->serialize(&data->data[bytes_written], start_element, num_elements);
+        }
+
+        /* Post Packed Record */
+        return postRecord(&record, local_stats, state.staged);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * sendPackedPhRecord
+ *
+ *  sends every requested photon ancillary field in a single record; falls
+ *  back to a record per field when more fields are requested than fit
+ *----------------------------------------------------------------------------*/
+bool Atl03Reader::sendPackedPhRecord (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats)
+{
+    if(field_list)
+    {
+        int num_fields = field_list->length();
+        if(num_fields > MAX_PACKED_FIELDS)
+        {
+            return sendAncillaryPhRecords(extent_id, field_list, field_dict, state, local_stats);
+        }
+
+        /* Size Packed Record */
+        int data_size = 0;
+        for(int i = 0; i < num_fields; i++)
+        {
+            GTDArray* array = field_dict->get((*field_list)[i].getString());
+            data_size += (array->gt[Icesat2Parms::RPT_L].elementSize() * state[Icesat2Parms::RPT_L].photon_indices->length()) +
+                         (array->gt[Icesat2Parms::RPT_R].elementSize() * state[Icesat2Parms::RPT_R].photon_indices->length());
+        }
+
+        /* Create Packed Record */
+        RecordObject record(phPackedRecType, offsetof(anc_photon_packed_t, data) + data_size);
+        anc_photon_packed_t* data = (anc_photon_packed_t*)record.getRecordData();
+        data->extent_id = extent_id;
+        data->num_fields = num_fields;
+        data->num_elements[Icesat2Parms::RPT_L] = state[Icesat2Parms::RPT_L].photon_indices->length();
+        data->num_elements[Icesat2Parms::RPT_R] = state[Icesat2Parms::RPT_R].photon_indices->length();
+
+        /* Populate Fields */
+        uint64_t bytes_written = 0;
+        for(int i = 0; i < num_fields; i++)
+        {
+            GTDArray* array = field_dict->get((*field_list)[i].getString());
+            data->data_type[i] = array->gt[Icesat2Parms::RPT_L].elementType();
+            data->field_offset[i] = bytes_written;
+            for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+            {
+                for(int p = 0; p < state[t].photon_indices->length(); p++)
+                {
+                    bytes_written += array->gt[t].serialize(&data->data[bytes_written], state[t].photon_indices->get(p), 1);
+                }
+            }
+        }
+
+        /* Post Packed Record */
+        return postRecord(&record, local_stats, state.staged);
+    }
+    else
+    {
+        return false;
+    }
+}
+
 /*----------------------------------------------------------------------------
  * postRecord
  *----------------------------------------------------------------------------*/
-bool Atl03Reader::postRecord (RecordObject* record, stats_t* local_stats)
+bool Atl03Reader::postRecord (RecordObject* record, stats_t* local_stats, ArrayList<staged_rec_t>* staged)
 {
+    /* Take Record Memory (it is already in serialized form) */
     uint8_t* rec_buf = NULL;
-    int rec_bytes = record->serialize(&rec_buf, RecordObject::REFERENCE);
+    int rec_bytes = record->serialize(&rec_buf, RecordObject::TAKE_OWNERSHIP);
+
+    /* Hold for Ordered Posting */
+    if(staged)
+    {
+        staged_rec_t rec = {rec_buf, rec_bytes, record->getRecordType()};
+        staged->add(rec);
+        return true;
+    }
+
+    /* Post Record Memory Directly */
+    return postBuffer(rec_buf, rec_bytes, record->getRecordType(), local_stats);
+}
+
+/*----------------------------------------------------------------------------
+ * postBuffer
+ *----------------------------------------------------------------------------*/
+bool Atl03Reader::postBuffer (uint8_t* rec_buf, int rec_bytes, const char* rec_type, stats_t* local_stats)
+{
     int post_status = MsgQ::STATE_TIMEOUT;
-    while(active && (post_status = outQ->postCopy(rec_buf, rec_bytes, SYS_TIMEOUT)) == MsgQ::STATE_TIMEOUT)
+    while(active && !isCancelled() && (post_status = outQ->postRef(rec_buf, rec_bytes, SYS_TIMEOUT)) == MsgQ::STATE_TIMEOUT)
     {
         local_stats->extents_retried++;
     }
 
+    /* Free Record Memory if Queue Did Not Take It */
+    if(post_status <= 0)
+    {
+        RecordPool::release(rec_buf);
+    }
+
     /* Update Statistics */
-    if(post_status > 0)
+    if(post_status > 0 || post_status == MsgQ::STATE_NO_SUBSCRIBERS)
     {
         local_stats->extents_sent++;
         return true;
     }
     else
     {
-        mlog(ERROR, "Atl03 reader failed to post %s to stream %s: %d", record->getRecordType(), outQ->getName(), post_status);
+        mlog(ERROR, "Atl03 reader failed to post %s to stream %s: %d", rec_type, outQ->getName(), post_status);
         local_stats->extents_dropped++;
         return false;
     }
@@ -39,6 +39,7 @@
 #include <atomic>
 
 #include "List.h"
+#include "ArrayList.h"
 #include "LuaObject.h"
 #include "RecordObject.h"
 #include "MsgQ.h"
@@ -62,6 +63,7 @@ class Atl03Reader: public LuaObject
          *--------------------------------------------------------------------*/
 
         static const int MAX_NAME_STR = H5CORO_MAXIMUM_NAME_SIZE;
+        static const int MAX_PACKED_FIELDS = 32; // ancillary fields that fit in a packed record
 
         static const char* phRecType;
         static const RecordObject::fieldDef_t phRecDef[];
@@ -69,6 +71,9 @@ class Atl03Reader: public LuaObject
         static const char* exRecType;
         static const RecordObject::fieldDef_t exRecDef[];
 
+        static const char* exColRecType;
+        static const RecordObject::fieldDef_t exColRecDef[];
+
         static const char* phFlatRecType;
         static const RecordObject::fieldDef_t phFlatRecDef[];
 
@@ -81,6 +86,12 @@ class Atl03Reader: public LuaObject
         static const char* exAncRecType;
         static const RecordObject::fieldDef_t exAncRecDef[];
 
+        static const char* phPackedRecType;
+        static const RecordObject::fieldDef_t phPackedRecDef[];
+
+        static const char* exPackedRecType;
+        static const RecordObject::fieldDef_t exPackedRecDef[];
+
         static const char* OBJECT_TYPE;
 
         static const char* LuaMetaName;
@@ -125,6 +136,58 @@ class Atl03Reader: public LuaObject
             photon_t        photons[]; // zero length field
         } extent_t;
 
+        /* Photon Columns */
+        typedef enum {
+            COL_DELTA_TIME      = 0,
+            COL_LATITUDE        = 1,
+            COL_LONGITUDE       = 2,
+            COL_X_ATC           = 3,
+            COL_HEIGHT          = 4,
+            COL_RELIEF          = 5,
+            COL_LANDCOVER       = 6,
+            COL_SNOWCOVER       = 7,
+            COL_ATL08_CLASS     = 8,
+            COL_ATL03_CNF       = 9,
+            COL_QUALITY_PH      = 10,
+            COL_YAPC_SCORE      = 11,
+            NUM_PHOTON_COLUMNS  = 12
+        } photon_column_t;
+
+        /* Columnar Extent Record (same attributes as extent_t, photon fields stored as columns) */
+        typedef struct {
+            bool            valid[Icesat2Parms::NUM_PAIR_TRACKS];
+            uint8_t         reference_pair_track; // 1, 2, or 3
+            uint8_t         spacecraft_orientation; // sc_orient_t
+            uint16_t        reference_ground_track_start;
+            uint16_t        cycle_start;
+            uint64_t        extent_id;
+            uint32_t        segment_id[Icesat2Parms::NUM_PAIR_TRACKS];
+            double          segment_distance[Icesat2Parms::NUM_PAIR_TRACKS];
+            double          extent_length[Icesat2Parms::NUM_PAIR_TRACKS]; // meters
+            double          spacecraft_velocity[Icesat2Parms::NUM_PAIR_TRACKS]; // meters per second
+            double          background_rate[Icesat2Parms::NUM_PAIR_TRACKS]; // PE per second
+            float           solar_elevation[Icesat2Parms::NUM_PAIR_TRACKS];
+            uint32_t        photon_count[Icesat2Parms::NUM_PAIR_TRACKS];
+            uint32_t        column_offset[NUM_PHOTON_COLUMNS][Icesat2Parms::NUM_PAIR_TRACKS]; // offset from start of record data
+            uint8_t         data[]; // zero length field
+        } col_extent_t;
+
+        /* Photon Columns of an Extent (left pair track followed by right) */
+        typedef struct {
+            double*         delta_time;
+            double*         latitude;
+            double*         longitude;
+            double*         x_atc;      // dist_ph_along
+            float*          height;
+            float*          relief;
+            uint8_t*        landcover;
+            uint8_t*        snowcover;
+            uint8_t*        atl08_class;
+            int8_t*         atl03_cnf;
+            int8_t*         quality_ph;
+            uint8_t*        yapc_score;
+        } photon_columns_t;
+
         /* Flattened Photon Fields */
         typedef struct {
             uint64_t        extent_id;
@@ -154,6 +217,25 @@ class Atl03Reader: public LuaObject
             uint8_t         data[];
         } anc_extent_t;
 
+        /* Packed Photon Ancillary Record (all requested fields of an extent) */
+        typedef struct {
+            uint64_t        extent_id;
+            uint8_t         num_fields;
+            uint8_t         data_type[MAX_PACKED_FIELDS]; // RecordObject::fieldType_t, ordered by request parameter list
+            uint32_t        num_elements[Icesat2Parms::NUM_PAIR_TRACKS];
+            uint32_t        field_offset[MAX_PACKED_FIELDS]; // offset from start of data, left pair track followed by right
+            uint8_t         data[];
+        } anc_photon_packed_t;
+
+        /* Packed Extent Ancillary Record (all requested fields of an extent) */
+        typedef struct {
+            uint64_t        extent_id;
+            uint8_t         num_fields;
+            uint8_t         data_type[MAX_PACKED_FIELDS]; // RecordObject::fieldType_t, ordered by request parameter list
+            uint32_t        field_offset[MAX_PACKED_FIELDS]; // offset from start of data, left pair track followed by right
+            uint8_t         data[];
+        } anc_extent_packed_t;
+
         /* Statistics */
         typedef struct {
             uint32_t        segments_read;
@@ -167,8 +249,14 @@ class Atl03Reader: public LuaObject
          * Methods
          *--------------------------------------------------------------------*/
 
-        static int  luaCreate   (lua_State* L);
-        static void init        (void);
+        static int      luaCreate       (lua_State* L);
+        static int      luaSharedScan   (lua_State* L);
+        static void     init            (void);
+
+        static int      columnsSize     (uint32_t num_photons);
+        static void     bindColumns     (uint8_t* buffer, uint32_t num_photons, photon_columns_t* columns);
+        static void     setColumns      (photon_columns_t* columns, uint32_t index, const photon_t* photon);
+        static uint8_t* getExtent       (RecordObject* record, extent_t* extent, photon_columns_t* columns);
 
     private:
 
@@ -181,17 +269,26 @@ class Atl03Reader: public LuaObject
             int             track;
         } info_t;
 
+        typedef struct {
+            uint8_t*        buffer;             // serialized record, owned until posted
+            int             size;
+            const char*     type;
+        } staged_rec_t;
+
         /* Region Subclass */
         class Region
         {
             public:
 
+                static const long MIN_RANGE_GAP = 10000; // photons, approximately an ATL03 photon chunk
+
                 Region              (info_t* info);
                 ~Region             (void);
 
                 void cleanup        (void);
                 void polyregion     (info_t* info);
                 void rasterregion   (info_t* info);
+                void photonranges   (void);
 
                 GTArray<double>     segment_lat;
                 GTArray<double>     segment_lon;
@@ -204,6 +301,9 @@ class Atl03Reader: public LuaObject
                 long                num_segments[Icesat2Parms::NUM_PAIR_TRACKS];
                 long                first_photon[Icesat2Parms::NUM_PAIR_TRACKS];
                 long                num_photons[Icesat2Parms::NUM_PAIR_TRACKS];
+
+                H5Coro::row_range_t* photon_ranges[Icesat2Parms::NUM_PAIR_TRACKS];
+                int                 num_photon_ranges[Icesat2Parms::NUM_PAIR_TRACKS];
         };
 
         /* Atl03 Data Subclass */
@@ -214,6 +314,8 @@ class Atl03Reader: public LuaObject
                 Atl03Data           (info_t* info, Region& region);
                 ~Atl03Data          (void);
 
+                void readSelected   (info_t* info, Region& region);
+
                 /* Read Data */
                 GTArray<float>      velocity_sc;
                 GTArray<double>     segment_delta_time;
@@ -283,6 +385,31 @@ class Atl03Reader: public LuaObject
                 void yapcV2         (info_t* info, Region& region, Atl03Data& atl03);
                 void yapcV3         (info_t* info, Region& region, Atl03Data& atl03);
 
+                /* Segments Scored by One Worker */
+                typedef struct {
+                    YapcScore*      yapc;
+                    info_t*         info;
+                    Region*         region;
+                    Atl03Data*      atl03;
+                    int             t;
+                    int32_t         first_segment;
+                    int32_t         num_segments;
+                    const int32_t*  ph_offsets;     // first photon of each segment [num_segments + 1]
+                    const double*   ph_dist;        // along track photon distance (v3 only)
+                } yapc_partition_t;
+
+                void yapcV2Segments     (yapc_partition_t* partition);
+                void yapcV3Segments     (yapc_partition_t* partition);
+                void partitionSegments  (info_t* info, Region& region, Atl03Data& atl03, int t, const double* ph_dist, Thread::thread_func_t scorer);
+                static void* yapcV2Thread (void* parm);
+                static void* yapcV3Thread (void* parm);
+
+                static void yapcV3Score     (const double* ph_dist, const float* h_ph, const int32_t* segment_ph_cnt, int32_t num_photons,
+                                             int32_t first_segment, int32_t num_segments, int32_t ph_index,
+                                             const Icesat2Parms::yapc_t* settings, uint8_t* gt);
+                static int  yapcV3Window    (const double* ph_dist, const float* h_ph, int32_t ph_index, int32_t neighbor_index, int32_t num_neighbors,
+                                             double direction, double hWX, double hWZ, double* proximities);
+
                 uint8_t* operator[] (int t);
 
                 /* Generated Data */
@@ -316,18 +443,76 @@ class Atl03Reader: public LuaObject
 
                 track_state_t       gt[Icesat2Parms::NUM_PAIR_TRACKS];
                 double              extent_length;
+                ArrayList<staged_rec_t>* staged;    // records held for ordered posting, NULL to post directly
+        };
+
+        /* Starting Point of an Extent in a Pair Track (partition planning) */
+        struct extent_start_t
+        {
+            int32_t         ph_in;
+            int32_t         seg_in;
+            int32_t         seg_ph;
+            int32_t         start_segment;
+            double          start_distance;
+            bool            track_complete;
+
+            extent_start_t (void) = default;
+            explicit extent_start_t (const TrackState::track_state_t& gt):
+                ph_in(gt.ph_in), seg_in(gt.seg_in), seg_ph(gt.seg_ph), start_segment(gt.start_segment),
+                start_distance(gt.start_distance), track_complete(gt.track_complete) {}
+
+            void restore (TrackState::track_state_t& gt) const
+            {
+                gt.ph_in = ph_in;
+                gt.seg_in = seg_in;
+                gt.seg_ph = seg_ph;
+                gt.start_segment = start_segment;
+                gt.start_distance = start_distance;
+                gt.track_complete = track_complete;
+            }
         };
 
+        /* Run of Extents Generated by one Worker */
+        typedef struct {
+            info_t*                     info;
+            Region*                     region;
+            Atl03Data*                  atl03;
+            Atl08Class*                 atl08;
+            YapcScore*                  yapc;
+            const extent_start_t*       starts;         // [extent][pair track] for the whole track
+            double                      extent_length;
+            uint32_t                    first_extent;
+            uint32_t                    num_extents;
+            ArrayList<staged_rec_t>     staged;
+            stats_t                     stats;
+            RunTimeException*           error;          // set if the worker failed
+        } partition_t;
+
         /*--------------------------------------------------------------------
          * Constants
          *--------------------------------------------------------------------*/
 
         static const double ATL03_SEGMENT_LENGTH;
+        static const char*  METRIC_CATEGORY;
+
+        /* Photon Selection Options (each combination is its own selectExtent) */
+        static const unsigned EXTENT_SELECT     = 0x01; // select photons, otherwise only walk the extent
+        static const unsigned EXTENT_SEGMENTS   = 0x02; // extent length and step are in segments
+        static const unsigned EXTENT_ATL08      = 0x04; // filter on atl08 classification
+        static const unsigned EXTENT_YAPC       = 0x08; // filter on yapc score
+        static const unsigned EXTENT_PHOREAL    = 0x10; // set relief and cover flags
+        static const unsigned NUM_EXTENT_VARIANTS = 0x20;
+
+        typedef void (Atl03Reader::*extent_func_t) (info_t* info, int t, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc);
 
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
+        static LatencyHistogram* subsetLatency;
+        static const extent_func_t extentVariants[NUM_EXTENT_VARIANTS];
+        static bool         sharedScan; // readers of a track attach to shared whole-track reads
+
         bool                active;
         Thread*             readerPid[Icesat2Parms::NUM_TRACKS];
         Mutex               threadMut;
@@ -341,6 +526,7 @@ class Atl03Reader: public LuaObject
         Publisher*          outQ;
         Icesat2Parms*          parms;
         bool                flatten;
+        bool                columnar;
         stats_t             stats;
 
         H5Coro::context_t   context; // for ATL03 file
@@ -355,20 +541,40 @@ class Atl03Reader: public LuaObject
          * Methods
          *--------------------------------------------------------------------*/
 
-                            Atl03Reader             (lua_State* L, Asset* _asset, const char* _resource, const char* outq_name, Icesat2Parms* _parms, bool _send_terminator=true, bool _flatten=false);
+                            Atl03Reader             (lua_State* L, Asset* _asset, const char* _resource, const char* outq_name, Icesat2Parms* _parms, bool _send_terminator=true, bool _flatten=false, bool _columnar=false);
                             ~Atl03Reader            (void);
 
         static void*        subsettingThread        (void* parm);
+        static void*        partitionThread         (void* parm);
+
+        void                generateExtent          (info_t* info, int t, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc, bool select_photons);
+        template <unsigned OPTS>
+        void                selectExtent            (info_t* info, int t, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc);
+        void                postExtent              (info_t* info, uint32_t extent_counter, TrackState& state, Atl03Data& atl03, stats_t* local_stats);
+        int                 partitionCount          (void);
+        int                 acquirePartitions       (int max_partitions);
+        void                releasePartitions       (int num_partitions);
+        void                partitionExtents        (info_t* info, int num_partitions, TrackState& state, Region& region, Atl03Data& atl03, Atl08Class& atl08, YapcScore& yapc, stats_t* local_stats);
 
         double              calculateBackground     (int t, TrackState& state, Atl03Data& atl03);
         uint32_t            calculateSegmentId      (int t, TrackState& state, Atl03Data& atl03);
         bool                sendExtentRecord        (uint64_t extent_id, uint8_t track, TrackState& state, Atl03Data& atl03, stats_t* local_stats);
+        bool                sendColumnarRecord      (uint64_t extent_id, uint8_t track, TrackState& state, Atl03Data& atl03, stats_t* local_stats);
         bool                sendFlatRecord          (uint64_t extent_id, uint8_t track, TrackState& state, Atl03Data& atl03, stats_t* local_stats);
         bool                sendAncillaryGeoRecords (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats);
         bool                sendAncillaryPhRecords  (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats);
-        bool                postRecord              (RecordObject* record, stats_t* local_stats);
+        bool                sendPackedGeoRecord     (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats);
+        bool                sendPackedPhRecord      (uint64_t extent_id, Icesat2Parms::string_list_t* field_list, MgDictionary<GTDArray*>* field_dict, TrackState& state, stats_t* local_stats);
+        bool                postRecord              (RecordObject* record, stats_t* local_stats, ArrayList<staged_rec_t>* staged=NULL);
+        bool                postBuffer              (uint8_t* rec_buf, int rec_bytes, const char* rec_type, stats_t* local_stats);
         void                parseResource           (const char* resource, int32_t& rgt, int32_t& cycle, int32_t& region);
 
+        static const Asset* directAsset             (info_t* info);
+        static const Asset* selectedAsset           (info_t* info);
+        static bool         pushdownFilters         (const Icesat2Parms* parms);
+        template <class T>
+        static void         readShared              (info_t* info, GTArray<T>& array, long col);
+
         static int          luaParms                (lua_State* L);
         static int          luaStats                (lua_State* L);
 
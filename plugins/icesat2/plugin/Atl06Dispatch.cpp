@@ -69,6 +69,13 @@
 
 #include <math.h>
 #include <float.h>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include "core.h"
 #include "icesat2.h"
@@ -87,46 +94,51 @@ const double Atl06Dispatch::SIGMA_XMIT = 0.00000000068; // seconds
 
 const char* Atl06Dispatch::elCompactRecType = "atl06rec-compact.elevation"; // elevation measurement record
 const RecordObject::fieldDef_t Atl06Dispatch::elCompactRecDef[] = {
-    {"delta_time",              RecordObject::DOUBLE,   offsetof(elevation_compact_t, delta_time),  1,  NULL, NATIVE_FLAGS},
-    {"lat",                     RecordObject::DOUBLE,   offsetof(elevation_compact_t, latitude),    1,  NULL, NATIVE_FLAGS},
-    {"lon",                     RecordObject::DOUBLE,   offsetof(elevation_compact_t, longitude),   1,  NULL, NATIVE_FLAGS},
-    {"h_mean",                  RecordObject::DOUBLE,   offsetof(elevation_compact_t, h_mean),      1,  NULL, NATIVE_FLAGS}
+    RECFIELD(elevation_compact_t, delta_time, "delta_time"),
+    RECFIELD(elevation_compact_t, latitude, "lat"),
+    RECFIELD(elevation_compact_t, longitude, "lon"),
+    RECFIELD(elevation_compact_t, h_mean, "h_mean")
 };
 
 const char* Atl06Dispatch::atCompactRecType = "atl06rec-compact";
 const RecordObject::fieldDef_t Atl06Dispatch::atCompactRecDef[] = {
-    {"elevation",               RecordObject::USER,     offsetof(atl06_compact_t, elevation),       0,  elCompactRecType, NATIVE_FLAGS}
+    RECFIELD_VAR(atl06_compact_t, elevation, "elevation")
 };
 
 /* (Normal) Record Definitions */
 
 const char* Atl06Dispatch::elRecType = "atl06rec.elevation"; // extended elevation measurement record
 const RecordObject::fieldDef_t Atl06Dispatch::elRecDef[] = {
-    {"extent_id",               RecordObject::UINT64,   offsetof(elevation_t, extent_id),           1,  NULL, NATIVE_FLAGS},
-    {"segment_id",              RecordObject::UINT32,   offsetof(elevation_t, segment_id),          1,  NULL, NATIVE_FLAGS},
-    {"n_fit_photons",           RecordObject::INT32,    offsetof(elevation_t, photon_count),        1,  NULL, NATIVE_FLAGS},
-    {"pflags",                  RecordObject::UINT16,   offsetof(elevation_t, pflags),              1,  NULL, NATIVE_FLAGS},
-    {"rgt",                     RecordObject::UINT16,   offsetof(elevation_t, rgt),                 1,  NULL, NATIVE_FLAGS},
-    {"cycle",                   RecordObject::UINT16,   offsetof(elevation_t, cycle),               1,  NULL, NATIVE_FLAGS},
-    {"spot",                    RecordObject::UINT8,    offsetof(elevation_t, spot),                1,  NULL, NATIVE_FLAGS},
-    {"gt",                      RecordObject::UINT8,    offsetof(elevation_t, gt),                  1,  NULL, NATIVE_FLAGS},
-    {"distance",                RecordObject::DOUBLE,   offsetof(elevation_t, distance),            1,  NULL, NATIVE_FLAGS},
-    {"delta_time",              RecordObject::DOUBLE,   offsetof(elevation_t, delta_time),          1,  NULL, NATIVE_FLAGS},
-    {"lat",                     RecordObject::DOUBLE,   offsetof(elevation_t, latitude),            1,  NULL, NATIVE_FLAGS},
-    {"lon",                     RecordObject::DOUBLE,   offsetof(elevation_t, longitude),           1,  NULL, NATIVE_FLAGS},
-    {"h_mean",                  RecordObject::DOUBLE,   offsetof(elevation_t, h_mean),              1,  NULL, NATIVE_FLAGS},
-    {"dh_fit_dx",               RecordObject::DOUBLE,   offsetof(elevation_t, along_track_slope),   1,  NULL, NATIVE_FLAGS},
-    {"dh_fit_dy",               RecordObject::DOUBLE,   offsetof(elevation_t, across_track_slope),  1,  NULL, NATIVE_FLAGS},
-    {"w_surface_window_final",  RecordObject::DOUBLE,   offsetof(elevation_t, window_height),       1,  NULL, NATIVE_FLAGS},
-    {"rms_misfit",              RecordObject::DOUBLE,   offsetof(elevation_t, rms_misfit),          1,  NULL, NATIVE_FLAGS},
-    {"h_sigma",                 RecordObject::DOUBLE,   offsetof(elevation_t, h_sigma),             1,  NULL, NATIVE_FLAGS}
+    RECFIELD(elevation_t, extent_id, "extent_id"),
+    RECFIELD(elevation_t, segment_id, "segment_id"),
+    RECFIELD(elevation_t, photon_count, "n_fit_photons"),
+    RECFIELD(elevation_t, pflags, "pflags"),
+    RECFIELD(elevation_t, rgt, "rgt"),
+    RECFIELD(elevation_t, cycle, "cycle"),
+    RECFIELD(elevation_t, spot, "spot"),
+    RECFIELD(elevation_t, gt, "gt"),
+    RECFIELD(elevation_t, distance, "distance"),
+    RECFIELD(elevation_t, delta_time, "delta_time"),
+    RECFIELD(elevation_t, latitude, "lat"),
+    RECFIELD(elevation_t, longitude, "lon"),
+    RECFIELD(elevation_t, h_mean, "h_mean"),
+    RECFIELD(elevation_t, along_track_slope, "dh_fit_dx"),
+    RECFIELD(elevation_t, across_track_slope, "dh_fit_dy"),
+    RECFIELD(elevation_t, window_height, "w_surface_window_final"),
+    RECFIELD(elevation_t, rms_misfit, "rms_misfit"),
+    RECFIELD(elevation_t, h_sigma, "h_sigma")
 };
 
 const char* Atl06Dispatch::atRecType = "atl06rec";
 const RecordObject::fieldDef_t Atl06Dispatch::atRecDef[] = {
-    {"elevation",               RecordObject::USER,     offsetof(atl06_t, elevation),               0,  elRecType, NATIVE_FLAGS}
+    RECFIELD_VAR(atl06_t, elevation, "elevation")
 };
 
+/* Elevation Batches */
+
+std::atomic<long> Atl06Dispatch::numDispatches(0);
+thread_local Atl06Dispatch::batch_cache_t Atl06Dispatch::localBatch = {-1, NULL};
+
 /* Lua Functions */
 
 const char* Atl06Dispatch::LuaMetaName = "Atl06Dispatch";
@@ -140,7 +152,10 @@ const struct luaL_Reg Atl06Dispatch::LuaMetaTable[] = {
  ******************************************************************************/
 
 /*----------------------------------------------------------------------------
- * luaCreate - :atl06(<outq name>, <parms>)
+ * luaCreate - :atl06(<outq name>, <parms>, [<ordered>])
+ *
+ *  ordered: sort the elevations of each posted batch by extent id (default);
+ *  when false the elevations are posted in the order they were fitted
  *----------------------------------------------------------------------------*/
 int Atl06Dispatch::luaCreate (lua_State* L)
 {
@@ -150,9 +165,10 @@ int Atl06Dispatch::luaCreate (lua_State* L)
         /* Get Parameters */
         const char* outq_name = getLuaString(L, 1);
         parms = (Icesat2Parms*)getLuaObject(L, 2, Icesat2Parms::OBJECT_TYPE);
+        bool ordered = getLuaBoolean(L, 3, true, true);
 
         /* Create ATL06 Dispatch */
-        return createLuaObject(L, new Atl06Dispatch(L, outq_name, parms));
+        return createLuaObject(L, new Atl06Dispatch(L, outq_name, parms, ordered));
     }
     catch(const RunTimeException& e)
     {
@@ -187,7 +203,7 @@ void Atl06Dispatch::init (void)
 /*----------------------------------------------------------------------------
  * Constructor
  *----------------------------------------------------------------------------*/
-Atl06Dispatch::Atl06Dispatch (lua_State* L, const char* outq_name, Icesat2Parms* _parms):
+Atl06Dispatch::Atl06Dispatch (lua_State* L, const char* outq_name, Icesat2Parms* _parms, bool _ordered):
     DispatchObject(L, LuaMetaName, LuaMetaTable)
 {
     assert(outq_name);
@@ -195,26 +211,11 @@ Atl06Dispatch::Atl06Dispatch (lua_State* L, const char* outq_name, Icesat2Parms*
 
     /* Initialize Parameters */
     parms = _parms;
-
-    /*
-     * Note: when allocating memory for this record, the full record size is used;
-     * this extends the memory available past the one elevation provided in the
-     * definition.
-     */
-    if(!parms->compact)
-    {
-        recObj = new RecordObject(atRecType, sizeof(atl06_t));
-        recData = (atl06_t*)recObj->getRecordData();
-    }
-    else
-    {
-        recObj = new RecordObject(atCompactRecType, sizeof(atl06_compact_t));
-        recCompactData = (atl06_compact_t*)recObj->getRecordData();
-    }
+    ordered = _ordered;
+    dispatchId = numDispatches++;
 
     /* Initialize Publisher */
     outQ = new Publisher(outq_name);
-    elevationIndex = 0;
 
     /* Initialize Statistics */
     LocalLib::set(&stats, 0, sizeof(stats));
@@ -225,8 +226,12 @@ Atl06Dispatch::Atl06Dispatch (lua_State* L, const char* outq_name, Icesat2Parms*
  *----------------------------------------------------------------------------*/
 Atl06Dispatch::~Atl06Dispatch(void)
 {
+    for(int i = 0; i < batches.length(); i++)
+    {
+        delete batches[i]->recObj;
+        delete batches[i];
+    }
     delete outQ;
-    delete recObj;
     parms->releaseLuaObject();
 }
 
@@ -238,15 +243,18 @@ bool Atl06Dispatch::processRecord (RecordObject* record, okey_t key)
     (void)key;
 
     result_t result[Icesat2Parms::NUM_PAIR_TRACKS];
-    Atl03Reader::extent_t* extent = (Atl03Reader::extent_t*)record->getRecordData();
+    Atl03Reader::extent_t extent;
+    Atl03Reader::photon_columns_t columns;
+    uint8_t* buffer = Atl03Reader::getExtent(record, &extent, &columns); // accepts extent and columnar extent records
 
     /* Bump Statistics */
     stats.h5atl03_rec_cnt++;
 
     /* Execute Algorithm Stages */
-    initializationStage(extent, result); // allocates photons[]
-    if(parms->stages[Icesat2Parms::STAGE_LSF]) iterativeFitStage(extent, result);
+    initializationStage(&extent, result); // allocates photons[]
+    if(parms->stages[Icesat2Parms::STAGE_LSF]) iterativeFitStage(&extent, &columns, result);
     postResult(result); // deallocates memory
+    delete [] buffer;
 
     /* Return Status */
     return true;
@@ -257,17 +265,28 @@ bool Atl06Dispatch::processRecord (RecordObject* record, okey_t key)
  *----------------------------------------------------------------------------*/
 bool Atl06Dispatch::processTimeout (void)
 {
+    /* Flush Batch of Idle Thread */
+    batch_t* batch = getBatch(false);
+    if(batch) flushBatch(batch);
     return true;
 }
 
 /*----------------------------------------------------------------------------
  * processTermination
  *
- *  Note that RecordDispatcher will only call this once
+ *  Note that RecordDispatcher will only call this once, after all of its
+ *  threads have stopped processing records
  *----------------------------------------------------------------------------*/
 bool Atl06Dispatch::processTermination (void)
 {
-    postResult(NULL);
+    batchMutex.lock();
+    {
+        for(int i = 0; i < batches.length(); i++)
+        {
+            flushBatch(batches[i]);
+        }
+    }
+    batchMutex.unlock();
     return true;
 }
 
@@ -297,7 +316,7 @@ void Atl06Dispatch::initializationStage (Atl03Reader::extent_t* extent, result_t
             result[t].photons = new point_t[result[t].elevation.photon_count];
             for(int p = 0; p < result[t].elevation.photon_count; p++)
             {
-                result[t].photons[p].p = first_photon + p;  // extent->photons[]
+                result[t].photons[p].p = first_photon + p;  // index into photon columns
             }
             first_photon += result[t].elevation.photon_count;
         }
@@ -315,305 +334,455 @@ void Atl06Dispatch::initializationStage (Atl03Reader::extent_t* extent, result_t
 /*----------------------------------------------------------------------------
  * iterativeFitStage
  *
+ *  when both tracks of the pair are dense, the left track is handed to the
+ *  task scheduler while the right track is fitted here, so an extent that
+ *  dominates a dispatcher thread can borrow an idle core
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::iterativeFitStage (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, result_t* result)
+{
+    if(result[Icesat2Parms::RPT_L].elevation.photon_count >= MIN_TASK_PHOTONS &&
+       result[Icesat2Parms::RPT_R].elevation.photon_count >= MIN_TASK_PHOTONS)
+    {
+        fit_task_t task = {this, extent, columns, result, Icesat2Parms::RPT_L};
+        TaskScheduler::Group group;
+        group.submit(iterativeFitTask, &task);
+        iterativeFitTrack(extent, columns, result, Icesat2Parms::RPT_R);
+        group.wait();
+    }
+    else
+    {
+        for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+        {
+            iterativeFitTrack(extent, columns, result, t);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * iterativeFitTrack
+ *
  *  Note: Section 5.5 - Signal selection based on ATL03 flags
  *        Procedures 4b and after
  *----------------------------------------------------------------------------*/
-void Atl06Dispatch::iterativeFitStage (Atl03Reader::extent_t* extent, result_t* result)
+void Atl06Dispatch::iterativeFitTrack (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, result_t* result, int t)
 {
-    /* Process Tracks */
-    for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
+    /* Check Valid Extent */
+    if(extent->valid[t] && result[t].elevation.photon_count > 0)
+    {
+        result[t].provided = true;
+    }
+    else
+    {
+        // the check for photon count is redundent with the check for
+        // a valid extent, but given that the code below is invalid
+        // if the number of photons is less than or equal to zero,
+        // the check is provided explicitly
+        return;
+    }
+
+    /* Initial Conditions */
+    bool done = false;
+    bool invalid = false;
+    int iteration = 0;
+
+    /* Initial Per Track Calculations */
+    double pulses_in_extent     = (extent->extent_length[t] * PULSE_REPITITION_FREQUENCY) / extent->spacecraft_velocity[t]; // N_seg_pulses, section 5.4, procedure 1d
+    double background_density   = pulses_in_extent * extent->background_rate[t] / (SPEED_OF_LIGHT / 2.0); // BG_density, section 5.7, procedure 1c
+
+    /* Gather Photons into Contiguous Lanes */
+    point_t* photons = result[t].photons;
+    int lane_size = result[t].elevation.photon_count;
+    double* lanes = new double [lane_size * 4];
+    double* x = &lanes[0];                  // along track distance
+    double* y = &lanes[lane_size];          // height
+    double* r = &lanes[lane_size * 2];      // residual
+    double* rs = &lanes[lane_size * 3];     // residuals reordered by percentile search
+    for(int p = 0; p < lane_size; p++)
+    {
+        x[p] = columns->x_atc[photons[p].p];
+        y[p] = columns->height[photons[p].p];
+    }
+
+    /* Sums of Initial Set of Photons */
+    fit_sums_t sums;
+    lsfsums(columns, photons, lane_size, &sums);
+
+    /* Iterate Processing of Photons */
+    while(!done)
     {
-        /* Check Valid Extent */
-        if(extent->valid[t] && result[t].elevation.photon_count > 0)
+        int num_photons = result[t].elevation.photon_count;
+
+        /* Calculate Least Squares Fit */
+        lsf_t fit = lsfsolve(&sums);
+        result[t].elevation.h_mean = fit.height;
+        result[t].elevation.along_track_slope = fit.slope;
+        result[t].elevation.h_sigma = fit.y_sigma; // scaled by rms below
+
+        /* Calculate Residuals */
+        double min_r;
+        double max_r;
+        lsfresiduals(x, y, num_photons, fit.height, fit.slope, r, &min_r, &max_r);
+        LocalLib::copy(rs, r, num_photons * sizeof(double));
+
+        /* Residuals Are Only Ordered as Far as the Percentile Search Reaches */
+        order_t order = {0, 0, num_photons, num_photons, num_photons};
+
+        /* Calculate Inputs to Robust Dispersion Estimate */
+        double  background_count;       // N_BG
+        double  window_lower_bound;     // zmin
+        double  window_upper_bound;     // zmax;
+        if(iteration == 0)
         {
-            result[t].provided = true;
+            window_lower_bound  = min_r; // section 5.5, procedure 4c
+            window_upper_bound  = max_r; // section 5.5, procedure 4c
+            background_count    = background_density * (window_upper_bound - window_lower_bound); // section 5.5, procedure 4b; pe_select_mod.f90 initial_select()
         }
         else
         {
-            // the check for photon count is redundent with the check for
-            // a valid extent, but given that the code below is invalid
-            // if the number of photons is less than or equal to zero,
-            // the check is provided explicitly
-            continue;
+            background_count    = background_density * result[t].elevation.window_height; // section 5.7, procedure 2c
+            window_lower_bound  = -(result[t].elevation.window_height / 2.0); // section 5.7, procedure 2c
+            window_upper_bound  = result[t].elevation.window_height / 2.0; // section 5.7, procedure 2c
         }
 
-        /* Initial Conditions */
-        bool done = false;
-        bool invalid = false;
-        int iteration = 0;
+        /* Continued Inputs to Robust Dispersion Estimate */
+        double background_rate  = background_count / (window_upper_bound - window_lower_bound); // bckgrd, section 5.9, procedure 1a
+        double signal_count     = num_photons - background_count; // N_sig, section 5.9, procedure 1b
+        double sigma_r          = 0.0; // sigma_r
 
-        /* Initial Per Track Calculations */
-        double pulses_in_extent     = (extent->extent_length[t] * PULSE_REPITITION_FREQUENCY) / extent->spacecraft_velocity[t]; // N_seg_pulses, section 5.4, procedure 1d
-        double background_density   = pulses_in_extent * extent->background_rate[t] / (SPEED_OF_LIGHT / 2.0); // BG_density, section 5.7, procedure 1c
-
-        /* Iterate Processing of Photons */
-        while(!done)
+        /* Calculate Robust Dispersion Estimate */
+        if(signal_count <= 1)
         {
-            int num_photons = result[t].elevation.photon_count;
-
-            /* Calculate Least Squares Fit */
-            lsf_t fit = lsf(extent, result[t].photons, num_photons, false);
-            result[t].elevation.h_mean = fit.height;
-            result[t].elevation.along_track_slope = fit.slope;
-            result[t].elevation.h_sigma = fit.y_sigma; // scaled by rms below
-
-            /* Calculate Residuals */
-            for(int p = 0; p < num_photons; p++)
+            sigma_r = (window_upper_bound - window_lower_bound) / num_photons; // section 5.9, procedure 1c
+        }
+        else
+        {
+            /*
+             * Skip Percentiles Known to Pass
+             *  when no residual is below the window, every index under 0.25*N_sig - 1.5
+             *  passes the test below, and when none is above it every index over
+             *  0.75*N_sig + N_BG + 0.5 passes the test that follows; the search starts
+             *  past them so they never need to be sorted
+             */
+            int32_t i0_start = 0;
+            int32_t i1_start = num_photons - 1;
+            if(background_rate >= 0.0)
             {
-                double x = extent->photons[result[t].photons[p].p].distance;
-                double y = extent->photons[result[t].photons[p].p].height;
-                result[t].photons[p].r = y - (fit.height + (x * fit.slope));
+                if(min_r >= window_lower_bound) i0_start = MIN(MAX((int32_t)ceil((0.25 * signal_count) - 1.5), 0), num_photons);
+                if(max_r <= window_upper_bound) i1_start = MAX(MIN((int32_t)floor((0.75 * signal_count) + background_count + 0.5), num_photons - 1), -1);
             }
+            orderskip(rs, &order, i0_start, i1_start);
 
-            /* Sort Points by Residuals */
-            quicksort(result[t].photons, 0, num_photons-1);
-
-            /* Calculate Inputs to Robust Dispersion Estimate */
-            double  background_count;       // N_BG
-            double  window_lower_bound;     // zmin
-            double  window_upper_bound;     // zmax;
-            if(iteration == 0)
+            /* Find Smallest Potential Percentiles (0) */
+            int32_t i0 = i0_start;
+            while(i0 < num_photons)
             {
-                window_lower_bound  = result[t].photons[0].r; // section 5.5, procedure 4c
-                window_upper_bound  = result[t].photons[num_photons - 1].r; // section 5.5, procedure 4c
-                background_count    = background_density * (window_upper_bound - window_lower_bound); // section 5.5, procedure 4b; pe_select_mod.f90 initial_select()
+                orderlow(rs, &order, i0);
+                double spp = (0.25 * signal_count) + ((rs[i0] - window_lower_bound) * background_rate); // section 5.9, procedure 4a
+                if( (((double)i0) + 1.0 - 0.5 + 1.0) < spp )    i0++;   // +1 adjusts for 0 vs 1 based indices, -.5 rounds, +1 looks ahead
+                else                                            break;
             }
-            else
-            {
-                background_count    = background_density * result[t].elevation.window_height; // section 5.7, procedure 2c
-                window_lower_bound  = -(result[t].elevation.window_height / 2.0); // section 5.7, procedure 2c
-                window_upper_bound  = result[t].elevation.window_height / 2.0; // section 5.7, procedure 2c
-            }
-
-            /* Continued Inputs to Robust Dispersion Estimate */
-            double background_rate  = background_count / (window_upper_bound - window_lower_bound); // bckgrd, section 5.9, procedure 1a
-            double signal_count     = num_photons - background_count; // N_sig, section 5.9, procedure 1b
-            double sigma_r          = 0.0; // sigma_r
 
-            /* Calculate Robust Dispersion Estimate */
-            if(signal_count <= 1)
+            /* Find Smallest Potential Percentiles (1) */
+            int32_t i1 = i1_start;
+            while(i1 >= 0)
             {
-                sigma_r = (window_upper_bound - window_lower_bound) / num_photons; // section 5.9, procedure 1c
+                orderhigh(rs, &order, i1);
+                double spp = (0.75 * signal_count) + ((rs[i1] - window_lower_bound) * background_rate); // section 5.9, procedure 4a
+                if( (((double)i1) + 1.0 - 0.5 - 1.0) > spp )    i1--;   // +1 adjusts for 0 vs 1 based indices, -.5 rounds, +1 looks ahead
+                else                                            break;
             }
-            else
-            {
-                /* Find Smallest Potential Percentiles (0) */
-                int32_t i0 = 0;
-                while(i0 < num_photons)
-                {
-                    double spp = (0.25 * signal_count) + ((result[t].photons[i0].r - window_lower_bound) * background_rate); // section 5.9, procedure 4a
-                    if( (((double)i0) + 1.0 - 0.5 + 1.0) < spp )    i0++;   // +1 adjusts for 0 vs 1 based indices, -.5 rounds, +1 looks ahead
-                    else                                            break;
-                }
-
-                /* Find Smallest Potential Percentiles (1) */
-                int32_t i1 = num_photons - 1;
-                while(i1 >= 0)
-                {
-                    double spp = (0.75 * signal_count) + ((result[t].photons[i1].r - window_lower_bound) * background_rate); // section 5.9, procedure 4a
-                    if( (((double)i1) + 1.0 - 0.5 - 1.0) > spp )    i1--;   // +1 adjusts for 0 vs 1 based indices, -.5 rounds, +1 looks ahead
-                    else                                            break;
-                }
-
-                /* Check Need to Refind Percentiles */
-                if(i1 < i0)
-                {
-                    /* Find Spread of Central Values (0) */
-                    double spp0 = (num_photons / 2.0) - (signal_count / 4.0); // section 5.9, procedure 5a
-                    i0 = (int32_t)(spp0 + 0.5) - 1;
-
-                    /* Find Spread of Central Values (1) */
-                    double spp1 = (num_photons / 2.0) + (signal_count / 4.0); // section 5.9, procedure 5b
-                    i1 = (int32_t)(spp1 + 0.5);
-                }
 
-                /* Check Validity of Percentiles */
-                if(i0 >= 0 && i1 < num_photons)
-                {
-                    /* Calculate Robust Dispersion Estimate */
-                    sigma_r = (result[t].photons[i1].r - result[t].photons[i0].r) / RDE_SCALE_FACTOR; // section 5.9, procedure 6
-                }
-                else
-                {
-                    mlog(CRITICAL, "Out of bounds condition caught: %d, %d, %d", i0, i1, num_photons);
-                    result[t].elevation.pflags |= PFLAG_OUT_OF_BOUNDS;
-                    invalid = true;
-                }
-            }
-
-            /* Calculate Sigma Expected */
-            double se1 = pow((SPEED_OF_LIGHT / 2.0) * SIGMA_XMIT, 2);
-            double se2 = pow(SIGMA_BEAM, 2) * pow(result[t].elevation.along_track_slope, 2);
-            double sigma_expected = sqrt(se1 + se2); // sigma_expected, section 5.5, procedure 4d
-
-            /* Calculate Window Height */
-            if(sigma_r > parms->maximum_robust_dispersion) sigma_r = parms->maximum_robust_dispersion;
-            double new_window_height = MAX(MAX(parms->minimum_window, 6.0 * sigma_expected), 6.0 * sigma_r); // H_win, section 5.5, procedure 4e
-            result[t].elevation.window_height = MAX(new_window_height, 0.75 * result[t].elevation.window_height); // section 5.7, procedure 2e
-            double window_spread = result[t].elevation.window_height / 2.0;
-
-            /* Precalculate Next Iteration's Conditions (section 5.7, procedure 2h) */
-            int32_t next_num_photons = 0;
-            double x_min = DBL_MAX;
-            double x_max = -DBL_MAX;
-            for(int p = 0; p < num_photons; p++)
+            /* Check Need to Refind Percentiles */
+            if(i1 < i0)
             {
-                if(abs(result[t].photons[p].r) < window_spread)
-                {
-                    next_num_photons++;
-                    double x = extent->photons[result[t].photons[p].p].distance;
-                    if(x < x_min) x_min = x;
-                    if(x > x_max) x_max = x;
-                }
-            }
+                /* Find Spread of Central Values (0) */
+                double spp0 = (num_photons / 2.0) - (signal_count / 4.0); // section 5.9, procedure 5a
+                i0 = (int32_t)(spp0 + 0.5) - 1;
 
-            /* Check Photon Count */
-            if(next_num_photons < parms->minimum_photon_count)
-            {
-                result[t].elevation.pflags |= PFLAG_TOO_FEW_PHOTONS;
-                invalid = true;
-                done = true;
-            }
-            /* Check Spread */
-            else if((x_max - x_min) < parms->along_track_spread)
-            {
-                result[t].elevation.pflags |= PFLAG_SPREAD_TOO_SHORT;
-                invalid = true;
-                done = true;
-            }
-            /* Check Change in Number of Photons */
-            else if(next_num_photons == num_photons)
-            {
-                done = true;
+                /* Find Spread of Central Values (1) */
+                double spp1 = (num_photons / 2.0) + (signal_count / 4.0); // section 5.9, procedure 5b
+                i1 = (int32_t)(spp1 + 0.5);
             }
-            /* Check Iterations */
-            else if(++iteration >= parms->max_iterations)
+
+            /* Check Validity of Percentiles */
+            if(i0 >= 0 && i1 < num_photons)
             {
-                result[t].elevation.pflags |= PFLAG_MAX_ITERATIONS_REACHED;
-                done = true;
+                /* Calculate Robust Dispersion Estimate */
+                double r0 = orderstat(rs, &order, i0);
+                double r1 = orderstat(rs, &order, i1);
+                sigma_r = (r1 - r0) / RDE_SCALE_FACTOR; // section 5.9, procedure 6
             }
-            /* Filtered Out Photons in Results and Iterate Again (section 5.5, procedure 4f) */
             else
             {
-                int32_t ph_in = 0;
-                for(int p = 0; p < num_photons; p++)
-                {
-                    if(abs(result[t].photons[p].r) < window_spread)
-                    {
-                        result[t].photons[ph_in++] = result[t].photons[p];
-                    }
-                }
-                result[t].elevation.photon_count = ph_in;
+                mlog(CRITICAL, "Out of bounds condition caught: %d, %d, %d", i0, i1, num_photons);
+                result[t].elevation.pflags |= PFLAG_OUT_OF_BOUNDS;
+                invalid = true;
             }
         }
 
-        /*
-         *  Note: Section 3.6 - Signal, Noise, and Error Estimates
-         *        Section 5.7, procedure 5
-         */
-
-        /* Sum Deltas in Photon Heights */
-        double delta_sum = 0.0;
-        for(int p = 0; p < result[t].elevation.photon_count; p++)
+        /* Calculate Sigma Expected */
+        double se1 = pow((SPEED_OF_LIGHT / 2.0) * SIGMA_XMIT, 2);
+        double se2 = pow(SIGMA_BEAM, 2) * pow(result[t].elevation.along_track_slope, 2);
+        double sigma_expected = sqrt(se1 + se2); // sigma_expected, section 5.5, procedure 4d
+
+        /* Calculate Window Height */
+        if(sigma_r > parms->maximum_robust_dispersion) sigma_r = parms->maximum_robust_dispersion;
+        double new_window_height = MAX(MAX(parms->minimum_window, 6.0 * sigma_expected), 6.0 * sigma_r); // H_win, section 5.5, procedure 4e
+        result[t].elevation.window_height = MAX(new_window_height, 0.75 * result[t].elevation.window_height); // section 5.7, procedure 2e
+        double window_spread = result[t].elevation.window_height / 2.0;
+
+        /* Precalculate Next Iteration's Conditions (section 5.7, procedure 2h) */
+        fit_sums_t next_sums;
+        double x_min;
+        double x_max;
+        int32_t next_num_photons = lsfwindow(x, y, r, num_photons, window_spread, &next_sums, &x_min, &x_max);
+
+        /* Check Photon Count */
+        if(next_num_photons < parms->minimum_photon_count)
         {
-            delta_sum += (result[t].photons[p].r * result[t].photons[p].r);
+            result[t].elevation.pflags |= PFLAG_TOO_FEW_PHOTONS;
+            invalid = true;
+            done = true;
         }
-
-        /* Calculate RMS and Scale h_sigma */
-        if(!invalid && result[t].elevation.photon_count > 0)
+        /* Check Spread */
+        else if((x_max - x_min) < parms->along_track_spread)
+        {
+            result[t].elevation.pflags |= PFLAG_SPREAD_TOO_SHORT;
+            invalid = true;
+            done = true;
+        }
+        /* Check Change in Number of Photons */
+        else if(next_num_photons == num_photons)
         {
-            result[t].elevation.rms_misfit = sqrt(delta_sum / (double)result[t].elevation.photon_count);
-            result[t].elevation.h_sigma = result[t].elevation.rms_misfit * result[t].elevation.h_sigma;
+            done = true;
         }
+        /* Check Iterations */
+        else if(++iteration >= parms->max_iterations)
+        {
+            result[t].elevation.pflags |= PFLAG_MAX_ITERATIONS_REACHED;
+            done = true;
+        }
+        /* Filtered Out Photons in Results and Iterate Again (section 5.5, procedure 4f) */
         else
         {
-            result[t].elevation.rms_misfit = 0.0;
-            result[t].elevation.h_sigma = 0.0;
+            int32_t ph_in = 0;
+            for(int p = 0; p < num_photons; p++)
+            {
+                if(abs(r[p]) < window_spread)
+                {
+                    photons[ph_in] = photons[p];
+                    x[ph_in] = x[p];
+                    y[ph_in] = y[p];
+                    ph_in++;
+                }
+            }
+            result[t].elevation.photon_count = ph_in;
+            sums = next_sums;
         }
+    }
+
+    /* Scatter Residuals of Final Photons */
+    for(int p = 0; p < result[t].elevation.photon_count; p++)
+    {
+        photons[p].r = r[p];
+    }
+    delete [] lanes;
 
-        /* Calculate Latitude, Longitude, and GPS Time using Least Squares Fit */
-        lsf_t fit = lsf(extent, result[t].photons, result[t].elevation.photon_count, true);
-        result[t].elevation.latitude = fit.latitude;
-        result[t].elevation.longitude = fit.longitude;
-        result[t].elevation.delta_time = fit.delta_time;
+    /*
+     *  Note: Section 3.6 - Signal, Noise, and Error Estimates
+     *        Section 5.7, procedure 5
+     */
+
+    /* Sum Deltas in Photon Heights */
+    double delta_sum = 0.0;
+    for(int p = 0; p < result[t].elevation.photon_count; p++)
+    {
+        delta_sum += (result[t].photons[p].r * result[t].photons[p].r);
+    }
+
+    /* Calculate RMS and Scale h_sigma */
+    if(!invalid && result[t].elevation.photon_count > 0)
+    {
+        result[t].elevation.rms_misfit = sqrt(delta_sum / (double)result[t].elevation.photon_count);
+        result[t].elevation.h_sigma = result[t].elevation.rms_misfit * result[t].elevation.h_sigma;
+    }
+    else
+    {
+        result[t].elevation.rms_misfit = 0.0;
+        result[t].elevation.h_sigma = 0.0;
     }
+
+    /* Calculate Latitude, Longitude, and GPS Time using Least Squares Fit */
+    lsf_t fit = lsf(columns, result[t].photons, result[t].elevation.photon_count, true);
+    result[t].elevation.latitude = fit.latitude;
+    result[t].elevation.longitude = fit.longitude;
+    result[t].elevation.delta_time = fit.delta_time;
+}
+
+/*----------------------------------------------------------------------------
+ * iterativeFitTask
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::iterativeFitTask (void* parm)
+{
+    fit_task_t* task = (fit_task_t*)parm;
+    task->dispatch->iterativeFitTrack(task->extent, task->columns, task->result, task->t);
 }
 
 /*----------------------------------------------------------------------------
  * postResult
+ *
+ *  elevations are added to a batch owned by the calling thread, so no lock
+ *  is taken per segment; the batch is posted when full, when the thread
+ *  times out waiting for records, or on termination
  *----------------------------------------------------------------------------*/
 void Atl06Dispatch::postResult (result_t* result)
 {
+    batch_t* batch = getBatch(true);
+
     for(int t = 0; t < Icesat2Parms::NUM_PAIR_TRACKS; t++)
     {
-        /* Pull Out Elevation */
-        elevation_t* elevation = NULL;
-        if(result)
+        /* Copy Elevation from Results into Batch */
+        if(result[t].provided)
         {
-            if(result[t].provided)
+            elevation_t* elevation = &result[t].elevation;
+            if(!parms->compact)
             {
-                elevation = &result[t].elevation;
+                batch->recData->elevation[batch->elevationIndex++] = *elevation;
             }
             else
             {
-                stats.filtered_cnt++;
+                batch->recCompactData->elevation[batch->elevationIndex].delta_time = elevation->delta_time;
+                batch->recCompactData->elevation[batch->elevationIndex].latitude = elevation->latitude;
+                batch->recCompactData->elevation[batch->elevationIndex].longitude = elevation->longitude;
+                batch->recCompactData->elevation[batch->elevationIndex].h_mean = elevation->h_mean;
+                batch->elevationIndex++;
             }
         }
-
-        /* Copy Elevation from Results into Buffer that's Posted */
-        elevationMutex.lock();
+        else
         {
-            /* Populate Elevation */
-            if(elevation)
-            {
-                if(!parms->compact)
-                {
-                    recData->elevation[elevationIndex++] = *elevation;
-                }
-                else
-                {
-                    recCompactData->elevation[elevationIndex].delta_time = elevation->delta_time;
-                    recCompactData->elevation[elevationIndex].latitude = elevation->latitude;
-                    recCompactData->elevation[elevationIndex].longitude = elevation->longitude;
-                    recCompactData->elevation[elevationIndex].h_mean = elevation->h_mean;
-                    elevationIndex++;
-                }
-            }
+            stats.filtered_cnt++;
+        }
 
-            /* Check If ATL06 Record Should Be Posted*/
-            if((!result && elevationIndex > 0) || elevationIndex == BATCH_SIZE)
-            {
-                /* Calculate Record Size (according to number of elevations) */
-                int size;
-                if(!parms->compact) size = elevationIndex * sizeof(elevation_t);
-                else                size = elevationIndex * sizeof(elevation_compact_t);
+        /* Check If ATL06 Record Should Be Posted */
+        if(batch->elevationIndex == BATCH_SIZE)
+        {
+            flushBatch(batch);
+        }
 
-                /* Serialize Record */
-                unsigned char* buffer;
-                int bufsize = recObj->serialize(&buffer, RecordObject::REFERENCE, size);
+        /* Free Photons Array (allocated in initializationStage) */
+        if(result[t].photons)
+        {
+            delete [] result[t].photons;
+        }
+    }
+}
 
-                /* Post Record */
-                if(outQ->postCopy(buffer, bufsize, SYS_TIMEOUT) > 0)
-                {
-                    stats.post_success_cnt += elevationIndex;
-                }
-                else
-                {
-                    stats.post_dropped_cnt += elevationIndex;
-                }
+/*----------------------------------------------------------------------------
+ * getBatch
+ *
+ *  returns the batch of the calling thread; the last batch used by each
+ *  thread is cached so the list of batches is only locked the first time a
+ *  thread posts a result or when it alternates between dispatches
+ *----------------------------------------------------------------------------*/
+Atl06Dispatch::batch_t* Atl06Dispatch::getBatch (bool create)
+{
+    /* Check Thread Cache */
+    if(localBatch.dispatch_id == dispatchId)
+    {
+        return localBatch.batch;
+    }
 
-                /* Reset Elevation Index */
-                elevationIndex = 0;
+    /* Look Up Batch of Thread */
+    long thread_id = Thread::getId();
+    batch_t* batch = NULL;
+    batchMutex.lock();
+    {
+        for(int i = 0; i < batches.length(); i++)
+        {
+            if(batches[i]->thread_id == thread_id)
+            {
+                batch = batches[i];
+                break;
             }
         }
-        elevationMutex.unlock();
 
-        /* Free Photons Array (allocated in initializationStage) */
-        if(result && result[t].photons)
+        /*
+         * Note: when allocating memory for this record, the full record size is used;
+         * this extends the memory available past the one elevation provided in the
+         * definition.
+         */
+        if(!batch && create)
         {
-            delete [] result[t].photons;
+            batch = new batch_t;
+            batch->thread_id = thread_id;
+            batch->recData = NULL;
+            batch->recCompactData = NULL;
+            batch->elevationIndex = 0;
+            if(!parms->compact)
+            {
+                TypedRecord<atl06_t>* rec = new TypedRecord<atl06_t>(sizeof(atl06_t));
+                batch->recObj = rec;
+                batch->recData = rec->data();
+            }
+            else
+            {
+                TypedRecord<atl06_compact_t>* rec = new TypedRecord<atl06_compact_t>(sizeof(atl06_compact_t));
+                batch->recObj = rec;
+                batch->recCompactData = rec->data();
+            }
+            batches.add(batch);
         }
     }
+    batchMutex.unlock();
+
+    /* Cache Batch for Thread */
+    if(batch)
+    {
+        localBatch.dispatch_id = dispatchId;
+        localBatch.batch = batch;
+    }
+
+    return batch;
+}
+
+/*----------------------------------------------------------------------------
+ * flushBatch
+ *
+ *  must only be called by the thread that owns the batch, or once all
+ *  threads have stopped posting results
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::flushBatch (batch_t* batch)
+{
+    if(batch->elevationIndex <= 0) return;
+
+    /* Order Elevations (compact records carry no extent id) */
+    if(ordered && !parms->compact)
+    {
+        std::sort(&batch->recData->elevation[0], &batch->recData->elevation[batch->elevationIndex],
+                  [](const elevation_t& a, const elevation_t& b) { return a.extent_id < b.extent_id; });
+    }
+
+    /* Calculate Record Size (according to number of elevations) */
+    int size;
+    if(!parms->compact) size = batch->elevationIndex * sizeof(elevation_t);
+    else                size = batch->elevationIndex * sizeof(elevation_compact_t);
+
+    /* Serialize Record */
+    unsigned char* buffer;
+    int bufsize = batch->recObj->serialize(&buffer, RecordObject::REFERENCE, size);
+
+    /* Post Record */
+    if(outQ->postCopy(buffer, bufsize, SYS_TIMEOUT) > 0)
+    {
+        stats.post_success_cnt += batch->elevationIndex;
+    }
+    else
+    {
+        stats.post_dropped_cnt += batch->elevationIndex;
+    }
+
+    /* Reset Elevation Index */
+    batch->elevationIndex = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -682,7 +851,7 @@ int Atl06Dispatch::luaStats (lua_State* L)
  *
  *  TODO: currently no protections against divide-by-zero
  *----------------------------------------------------------------------------*/
-Atl06Dispatch::lsf_t Atl06Dispatch::lsf (Atl03Reader::extent_t* extent, point_t* array, int size, bool final)
+Atl06Dispatch::lsf_t Atl06Dispatch::lsf (const Atl03Reader::photon_columns_t* columns, point_t* array, int size, bool final)
 {
     lsf_t fit;
 
@@ -691,51 +860,32 @@ Atl06Dispatch::lsf_t Atl06Dispatch::lsf (Atl03Reader::extent_t* extent, point_t*
     fit.slope = 0.0;
     fit.y_sigma = 0.0;
 
-    /* Calculate G^T*G and GT*h*/
-    double gtg_11 = size;
-    double gtg_12_21 = 0.0;
-    double gtg_22 = 0.0;
-    for(int p = 0; p < size; p++)
+    if(!final) /* Height */
     {
-        double x = extent->photons[array[p].p].distance;
-
-        /* Perform Matrix Operation */
-        gtg_12_21 += x;
-        gtg_22 += x * x;
+        fit_sums_t sums;
+        lsfsums(columns, array, size, &sums);
+        return lsfsolve(&sums);
     }
-
-    /* Calculate (G^T*G)^-1 */
-    double det = 1.0 / ((gtg_11 * gtg_22) - (gtg_12_21 * gtg_12_21));
-    double igtg_11 = gtg_22 * det;
-    double igtg_12_21 = -1 * gtg_12_21 * det;
-    double igtg_22 = gtg_11 * det;
-
-    if(!final) /* Height */
+    else /* Latitude, Longitude, GPS Time */
     {
-        /* Calculate G^-g and m */
+        /* Calculate G^T*G */
+        double gtg_11 = size;
+        double gtg_12_21 = 0.0;
+        double gtg_22 = 0.0;
         for(int p = 0; p < size; p++)
         {
-            Atl03Reader::photon_t* ph = &extent->photons[array[p].p];
-            double x = ph->distance;
-            double y = ph->height;
+            double x = columns->x_atc[array[p].p];
 
             /* Perform Matrix Operation */
-            double gig_1 = igtg_11 + (igtg_12_21 * x);   // G^-g row 1 element
-            double gig_2 = igtg_12_21 + (igtg_22 * x);   // G^-g row 2 element
-
-            /* Calculate m */
-            fit.height += gig_1 * y;
-            fit.slope += gig_2 * y;
-
-            /* Accumulate y_sigma */
-            fit.y_sigma += gig_1 * gig_1;
+            gtg_12_21 += x;
+            gtg_22 += x * x;
         }
 
-        /* Calculate y_sigma */
-        fit.y_sigma = sqrt(fit.y_sigma);
-    }
-    else /* Latitude, Longitude, GPS Time */
-    {
+        /* Calculate (G^T*G)^-1 */
+        double det = 1.0 / ((gtg_11 * gtg_22) - (gtg_12_21 * gtg_12_21));
+        double igtg_11 = gtg_22 * det;
+        double igtg_12_21 = -1 * gtg_12_21 * det;
+
         fit.latitude = 0.0;
         fit.longitude = 0.0;
         fit.delta_time = 0.0;
@@ -746,7 +896,7 @@ Atl06Dispatch::lsf_t Atl06Dispatch::lsf (Atl03Reader::extent_t* extent, point_t*
                     assumes that there isn't a set of photons with
                     longitudes that extend for more than 30 degrees */
             double shift_lon = false;
-            double first_lon = extent->photons[array[0].p].longitude;
+            double first_lon = columns->longitude[array[0].p];
             if(first_lon < -150.0 || first_lon > 150.0)
             {
                 shift_lon = true;
@@ -755,11 +905,11 @@ Atl06Dispatch::lsf_t Atl06Dispatch::lsf (Atl03Reader::extent_t* extent, point_t*
             /* Calculate G^-g and m */
             for(int p = 0; p < size; p++)
             {
-                Atl03Reader::photon_t* ph = &extent->photons[array[p].p];
-                double x = ph->distance;
-                double lat_y = ph->latitude;
-                double lon_y = ph->longitude;
-                double gps_y = ph->delta_time;
+                uint32_t i = array[p].p;
+                double x = columns->x_atc[i];
+                double lat_y = columns->latitude[i];
+                double lon_y = columns->longitude[i];
+                double gps_y = columns->delta_time[i];
 
                 /* Shift Longitudes */
                 if(shift_lon)
@@ -791,6 +941,323 @@ Atl06Dispatch::lsf_t Atl06Dispatch::lsf (Atl03Reader::extent_t* extent, point_t*
     return fit;
 }
 
+/*----------------------------------------------------------------------------
+ * lsfsums - running sums of least squares fit
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::lsfsums (const Atl03Reader::photon_columns_t* columns, point_t* array, int size, fit_sums_t* sums)
+{
+    sums->n = size;
+    sums->sx = 0.0;
+    sums->sxx = 0.0;
+    sums->sy = 0.0;
+    sums->sxy = 0.0;
+    for(int p = 0; p < size; p++)
+    {
+        double x = columns->x_atc[array[p].p];
+        double y = columns->height[array[p].p];
+        sums->sx += x;
+        sums->sxx += x * x;
+        sums->sy += y;
+        sums->sxy += x * y;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * lsfsolve - closed form least squares fit of height
+ *
+ *  with D = det(G^T*G) = n*Sxx - Sx^2, the solution m = G^-g * z reduces to
+ *      h_mean  = (Sxx*Sy - Sx*Sxy) / D
+ *      dh/dx   = (n*Sxy - Sx*Sy) / D
+ *  and since G^-g row 1 is (Sxx - Sx*xi) / D, the sum of its squares reduces to
+ *      y_sigma = sqrt(Sxx / D)
+ *
+ *  so each iteration of the fit only needs the sums of the photons kept
+ *----------------------------------------------------------------------------*/
+Atl06Dispatch::lsf_t Atl06Dispatch::lsfsolve (const fit_sums_t* sums)
+{
+    lsf_t fit;
+
+    double det = 1.0 / ((sums->n * sums->sxx) - (sums->sx * sums->sx));
+    fit.height = ((sums->sxx * sums->sy) - (sums->sx * sums->sxy)) * det;
+    fit.slope = ((sums->n * sums->sxy) - (sums->sx * sums->sy)) * det;
+    fit.y_sigma = sqrt(sums->sxx * det);
+
+    return fit;
+}
+
+/*----------------------------------------------------------------------------
+ * lsfresiduals
+ *
+ *  residuals of the photon lanes from the fit along with their extent; runs
+ *  two photons per instruction where SSE2 or NEON is available
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::lsfresiduals (const double* x, const double* y, int size, double height, double slope, double* r, double* min_r, double* max_r)
+{
+    double lo = DBL_MAX;
+    double hi = -DBL_MAX;
+    int p = 0;
+
+    #if defined(__SSE2__)
+    {
+        const __m128d h = _mm_set1_pd(height);
+        const __m128d m = _mm_set1_pd(slope);
+        __m128d vlo = _mm_set1_pd(DBL_MAX);
+        __m128d vhi = _mm_set1_pd(-DBL_MAX);
+        for(; p + 2 <= size; p += 2)
+        {
+            __m128d rv = _mm_sub_pd(_mm_loadu_pd(&y[p]), _mm_add_pd(h, _mm_mul_pd(_mm_loadu_pd(&x[p]), m)));
+            _mm_storeu_pd(&r[p], rv);
+            vlo = _mm_min_pd(vlo, rv);
+            vhi = _mm_max_pd(vhi, rv);
+        }
+        double lane_lo[2];
+        double lane_hi[2];
+        _mm_storeu_pd(lane_lo, vlo);
+        _mm_storeu_pd(lane_hi, vhi);
+        lo = MIN(lane_lo[0], lane_lo[1]);
+        hi = MAX(lane_hi[0], lane_hi[1]);
+    }
+    #elif defined(__aarch64__)
+    {
+        const float64x2_t h = vdupq_n_f64(height);
+        const float64x2_t m = vdupq_n_f64(slope);
+        float64x2_t vlo = vdupq_n_f64(DBL_MAX);
+        float64x2_t vhi = vdupq_n_f64(-DBL_MAX);
+        for(; p + 2 <= size; p += 2)
+        {
+            float64x2_t rv = vsubq_f64(vld1q_f64(&y[p]), vaddq_f64(h, vmulq_f64(vld1q_f64(&x[p]), m)));
+            vst1q_f64(&r[p], rv);
+            vlo = vminq_f64(vlo, rv);
+            vhi = vmaxq_f64(vhi, rv);
+        }
+        lo = vminvq_f64(vlo);
+        hi = vmaxvq_f64(vhi);
+    }
+    #endif
+
+    /* Remaining Photons */
+    for(; p < size; p++)
+    {
+        r[p] = y[p] - (height + (x[p] * slope));
+        if(r[p] < lo) lo = r[p];
+        if(r[p] > hi) hi = r[p];
+    }
+
+    *min_r = lo;
+    *max_r = hi;
+}
+
+/*----------------------------------------------------------------------------
+ * lsfwindow
+ *
+ *  counts the photons whose residual is inside the window, and accumulates
+ *  their fit sums and along track extent; the photons are kept in place and
+ *  only masked, so this vectorizes the same way as lsfresiduals
+ *----------------------------------------------------------------------------*/
+int32_t Atl06Dispatch::lsfwindow (const double* x, const double* y, const double* r, int size, double spread, fit_sums_t* sums, double* x_min, double* x_max)
+{
+    int32_t count = 0;
+    double sx = 0.0;
+    double sxx = 0.0;
+    double sy = 0.0;
+    double sxy = 0.0;
+    double lo = DBL_MAX;
+    double hi = -DBL_MAX;
+    int p = 0;
+
+    #if defined(__SSE2__)
+    {
+        const __m128d w = _mm_set1_pd(spread);
+        const __m128d sign = _mm_set1_pd(-0.0);
+        const __m128d vmax = _mm_set1_pd(DBL_MAX);
+        const __m128d vmin = _mm_set1_pd(-DBL_MAX);
+        __m128d vsx = _mm_setzero_pd();
+        __m128d vsxx = _mm_setzero_pd();
+        __m128d vsy = _mm_setzero_pd();
+        __m128d vsxy = _mm_setzero_pd();
+        __m128d vlo = vmax;
+        __m128d vhi = vmin;
+        for(; p + 2 <= size; p += 2)
+        {
+            __m128d xv = _mm_loadu_pd(&x[p]);
+            __m128d inside = _mm_cmplt_pd(_mm_andnot_pd(sign, _mm_loadu_pd(&r[p])), w);
+            __m128d xi = _mm_and_pd(inside, xv);
+            __m128d yi = _mm_and_pd(inside, _mm_loadu_pd(&y[p]));
+            vsx = _mm_add_pd(vsx, xi);
+            vsxx = _mm_add_pd(vsxx, _mm_mul_pd(xi, xi));
+            vsy = _mm_add_pd(vsy, yi);
+            vsxy = _mm_add_pd(vsxy, _mm_mul_pd(xi, yi));
+            vlo = _mm_min_pd(vlo, _mm_or_pd(xi, _mm_andnot_pd(inside, vmax)));
+            vhi = _mm_max_pd(vhi, _mm_or_pd(xi, _mm_andnot_pd(inside, vmin)));
+            int mask = _mm_movemask_pd(inside);
+            count += (mask & 1) + (mask >> 1);
+        }
+        double lane[2];
+        _mm_storeu_pd(lane, vsx);   sx = lane[0] + lane[1];
+        _mm_storeu_pd(lane, vsxx);  sxx = lane[0] + lane[1];
+        _mm_storeu_pd(lane, vsy);   sy = lane[0] + lane[1];
+        _mm_storeu_pd(lane, vsxy);  sxy = lane[0] + lane[1];
+        _mm_storeu_pd(lane, vlo);   lo = MIN(lane[0], lane[1]);
+        _mm_storeu_pd(lane, vhi);   hi = MAX(lane[0], lane[1]);
+    }
+    #elif defined(__aarch64__)
+    {
+        const float64x2_t w = vdupq_n_f64(spread);
+        const float64x2_t zero = vdupq_n_f64(0.0);
+        const float64x2_t vmax = vdupq_n_f64(DBL_MAX);
+        const float64x2_t vmin = vdupq_n_f64(-DBL_MAX);
+        float64x2_t vsx = zero;
+        float64x2_t vsxx = zero;
+        float64x2_t vsy = zero;
+        float64x2_t vsxy = zero;
+        float64x2_t vlo = vmax;
+        float64x2_t vhi = vmin;
+        for(; p + 2 <= size; p += 2)
+        {
+            float64x2_t xv = vld1q_f64(&x[p]);
+            uint64x2_t inside = vcltq_f64(vabsq_f64(vld1q_f64(&r[p])), w);
+            float64x2_t xi = vbslq_f64(inside, xv, zero);
+            float64x2_t yi = vbslq_f64(inside, vld1q_f64(&y[p]), zero);
+            vsx = vaddq_f64(vsx, xi);
+            vsxx = vaddq_f64(vsxx, vmulq_f64(xi, xi));
+            vsy = vaddq_f64(vsy, yi);
+            vsxy = vaddq_f64(vsxy, vmulq_f64(xi, yi));
+            vlo = vminq_f64(vlo, vbslq_f64(inside, xv, vmax));
+            vhi = vmaxq_f64(vhi, vbslq_f64(inside, xv, vmin));
+            count += (int32_t)((vgetq_lane_u64(inside, 0) & 1) + (vgetq_lane_u64(inside, 1) & 1));
+        }
+        sx = vaddvq_f64(vsx);
+        sxx = vaddvq_f64(vsxx);
+        sy = vaddvq_f64(vsy);
+        sxy = vaddvq_f64(vsxy);
+        lo = vminvq_f64(vlo);
+        hi = vmaxvq_f64(vhi);
+    }
+    #endif
+
+    /* Remaining Photons */
+    for(; p < size; p++)
+    {
+        if(abs(r[p]) < spread)
+        {
+            count++;
+            sx += x[p];
+            sxx += x[p] * x[p];
+            sy += y[p];
+            sxy += x[p] * y[p];
+            if(x[p] < lo) lo = x[p];
+            if(x[p] > hi) hi = x[p];
+        }
+    }
+
+    sums->n = count;
+    sums->sx = sx;
+    sums->sxx = sxx;
+    sums->sy = sy;
+    sums->sxy = sxy;
+    *x_min = lo;
+    *x_max = hi;
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * orderskip
+ *
+ *  partitions off the residuals below index low and above index high, which
+ *  the percentile search is known to step over, so that they are never sorted
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::orderskip (double* array, order_t* order, int low, int high)
+{
+    if(low > 0 && low < order->size)
+    {
+        std::nth_element(&array[0], &array[low], &array[order->size]);
+        order->first = low;
+        order->lo = low;
+    }
+
+    if(high >= order->lo && high < order->size - 1)
+    {
+        std::nth_element(&array[order->lo], &array[high], &array[order->size]);
+        order->hi = high + 1;
+        order->last = high + 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * orderlow
+ *
+ *  makes sure the residual at index is in its sorted position, growing the
+ *  sorted run at the bottom of the unordered residuals geometrically: each
+ *  step selects the next block with nth_element and sorts only that block
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::orderlow (double* array, order_t* order, int index)
+{
+    if(index < order->first)
+    {
+        std::sort(&array[0], &array[order->first]);
+        order->first = 0;
+    }
+    else if(index >= order->last)
+    {
+        std::sort(&array[order->last], &array[order->size]);
+        order->last = order->size;
+    }
+    else if(index >= order->lo && index < order->hi)
+    {
+        int run = order->lo - order->first;
+        int k = MIN(order->hi - 1, MAX(index, order->lo + MAX(run, MIN_ORDER_BLOCK)));
+        std::nth_element(&array[order->lo], &array[k], &array[order->hi]);
+        std::sort(&array[order->lo], &array[k]);
+        order->lo = k + 1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * orderhigh
+ *
+ *  same as orderlow but grows the sorted run at the top of the unordered
+ *  residuals
+ *----------------------------------------------------------------------------*/
+void Atl06Dispatch::orderhigh (double* array, order_t* order, int index)
+{
+    if(index < order->first)
+    {
+        std::sort(&array[0], &array[order->first]);
+        order->first = 0;
+    }
+    else if(index >= order->last)
+    {
+        std::sort(&array[order->last], &array[order->size]);
+        order->last = order->size;
+    }
+    else if(index >= order->lo && index < order->hi)
+    {
+        int run = order->last - order->hi;
+        int k = MAX(order->lo, MIN(index, order->hi - MAX(run, MIN_ORDER_BLOCK)));
+        std::nth_element(&array[order->lo], &array[k], &array[order->hi]);
+        std::sort(&array[k + 1], &array[order->hi]);
+        order->hi = k;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * orderstat
+ *
+ *  returns the residual that would be at index if all residuals were sorted
+ *----------------------------------------------------------------------------*/
+double Atl06Dispatch::orderstat (double* array, const order_t* order, int index)
+{
+    int start = 0;
+    int end = 0;
+    if(index < order->first)                            { start = 0;            end = order->first; }
+    else if(index >= order->last)                       { start = order->last;  end = order->size; }
+    else if(index >= order->lo && index < order->hi)    { start = order->lo;    end = order->hi; }
+
+    if(start < end) std::nth_element(&array[start], &array[index], &array[end]);
+    return array[index];
+}
+
 /*----------------------------------------------------------------------------
  * quicksort
  *----------------------------------------------------------------------------*/
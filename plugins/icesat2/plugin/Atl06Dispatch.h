@@ -68,6 +68,8 @@ class Atl06Dispatch: public DispatchObject
         static const double SIGMA_XMIT;
 
         static const int BATCH_SIZE = 256;
+        static const int MIN_ORDER_BLOCK = 32; // residuals ordered at a time by percentile search
+        static const int MIN_TASK_PHOTONS = 4096; // pair tracks at least this dense are fitted concurrently
 
         static const uint16_t PFLAG_SPREAD_TOO_SHORT        = 0x0001;   // RqstParm::ALONG_TRACK_SPREAD
         static const uint16_t PFLAG_TOO_FEW_PHOTONS         = 0x0002;   // RqstParm::MIN_PHOTON_COUNT
@@ -95,8 +97,8 @@ class Atl06Dispatch: public DispatchObject
         typedef struct {
             std::atomic<uint32_t>   h5atl03_rec_cnt;
             std::atomic<uint32_t>   filtered_cnt;
-            uint32_t                post_success_cnt;
-            uint32_t                post_dropped_cnt;
+            std::atomic<uint32_t>   post_success_cnt;
+            std::atomic<uint32_t>   post_dropped_cnt;
         } stats_t;
 
         /* Compact Elevation Measurement */
@@ -166,6 +168,28 @@ class Atl06Dispatch: public DispatchObject
             double      r;  // residual
         } point_t;
 
+        /* Running Sums of Least Squares Fit */
+        typedef struct {
+            double      n;
+            double      sx;
+            double      sxx;
+            double      sy;
+            double      sxy;
+        } fit_sums_t;
+
+        /*
+         * Partial Ordering of Residuals
+         *  array[first,lo) and array[hi,last) are sorted and in their final positions,
+         *  array[0,first) and array[last,size) are only partitioned from the rest
+         */
+        typedef struct {
+            int         first;
+            int         lo;
+            int         hi;
+            int         last;
+            int         size;
+        } order_t;
+
        /* Algorithm Result */
         typedef struct {
             bool        provided;
@@ -173,17 +197,43 @@ class Atl06Dispatch: public DispatchObject
             point_t*    photons;
         } result_t;
 
+        /* Per Thread Elevation Batch */
+        typedef struct {
+            long                thread_id;
+            RecordObject*       recObj;
+            atl06_compact_t*    recCompactData;
+            atl06_t*            recData;
+            int                 elevationIndex;
+        } batch_t;
+
+        /* Last Batch Used by a Thread */
+        typedef struct {
+            long                dispatch_id;
+            batch_t*            batch;
+        } batch_cache_t;
+
+        /* Track Fit Submitted to the Task Scheduler */
+        typedef struct {
+            Atl06Dispatch*                          dispatch;
+            Atl03Reader::extent_t*                  extent;
+            const Atl03Reader::photon_columns_t*    columns;
+            result_t*                               result;
+            int                                     t;
+        } fit_task_t;
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
-        RecordObject*       recObj;
-        atl06_compact_t*    recCompactData;
-        atl06_t*            recData;
+        static std::atomic<long>            numDispatches;
+        static thread_local batch_cache_t   localBatch;
+
         Publisher*          outQ;
 
-        Mutex               elevationMutex;
-        int                 elevationIndex;
+        long                dispatchId;     // keys the thread local batch cache
+        bool                ordered;        // sort each batch by extent id before posting
+        Mutex               batchMutex;     // protects list of batches, not the batches themselves
+        List<batch_t*>      batches;
 
         Icesat2Parms*          parms;
         stats_t             stats;
@@ -192,7 +242,7 @@ class Atl06Dispatch: public DispatchObject
          * Methods
          *--------------------------------------------------------------------*/
 
-                        Atl06Dispatch                   (lua_State* L, const char* outq_name, Icesat2Parms* _parms);
+                        Atl06Dispatch                   (lua_State* L, const char* outq_name, Icesat2Parms* _parms, bool _ordered);
                         ~Atl06Dispatch                  (void);
 
         bool            processRecord                   (RecordObject* record, okey_t key) override;
@@ -200,12 +250,24 @@ class Atl06Dispatch: public DispatchObject
         bool            processTermination              (void) override;
 
         void            initializationStage             (Atl03Reader::extent_t* extent, result_t* result);
-        void            iterativeFitStage               (Atl03Reader::extent_t* extent, result_t* result);
+        void            iterativeFitStage               (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, result_t* result);
+        void            iterativeFitTrack               (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, result_t* result, int t);
+        static void     iterativeFitTask                (void* parm);
         void            postResult                      (result_t* result);
+        batch_t*        getBatch                        (bool create);
+        void            flushBatch                      (batch_t* batch);
 
         static int      luaStats                        (lua_State* L);
 
-        static lsf_t    lsf                             (Atl03Reader::extent_t* extent, point_t* array, int size, bool final);
+        static lsf_t    lsf                             (const Atl03Reader::photon_columns_t* columns, point_t* array, int size, bool final);
+        static void     lsfsums                         (const Atl03Reader::photon_columns_t* columns, point_t* array, int size, fit_sums_t* sums);
+        static lsf_t    lsfsolve                        (const fit_sums_t* sums);
+        static void     lsfresiduals                    (const double* x, const double* y, int size, double height, double slope, double* r, double* min_r, double* max_r);
+        static int32_t  lsfwindow                       (const double* x, const double* y, const double* r, int size, double spread, fit_sums_t* sums, double* x_min, double* x_max);
+        static void     orderskip                       (double* array, order_t* order, int low, int high);
+        static void     orderlow                        (double* array, order_t* order, int index);
+        static void     orderhigh                       (double* array, order_t* order, int index);
+        static double   orderstat                       (double* array, const order_t* order, int index);
         static void     quicksort                       (point_t* array, int start, int end);
         static int      quicksortpartition              (point_t* array, int start, int end);
 
@@ -213,4 +275,13 @@ class Atl06Dispatch: public DispatchObject
         friend class UT_Atl06Dispatch;
 };
 
+/******************************************************************************
+ * RECORD TYPES
+ ******************************************************************************/
+
+RECTYPE(Atl06Dispatch::elevation_compact_t, Atl06Dispatch::elCompactRecType)
+RECTYPE(Atl06Dispatch::atl06_compact_t,     Atl06Dispatch::atCompactRecType)
+RECTYPE(Atl06Dispatch::elevation_t,         Atl06Dispatch::elRecType)
+RECTYPE(Atl06Dispatch::atl06_t,             Atl06Dispatch::atRecType)
+
 #endif  /* __atl06_dispatch__ */
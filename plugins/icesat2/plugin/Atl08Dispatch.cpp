@@ -35,6 +35,7 @@
 
 #include <math.h>
 #include <float.h>
+#include <algorithm>
 
 #include "core.h"
 #include "icesat2.h"
@@ -47,42 +48,42 @@
 
 const char* Atl08Dispatch::vegRecType = "atl08rec.vegetation";
 const RecordObject::fieldDef_t Atl08Dispatch::vegRecDef[] = {
-    {"extent_id",               RecordObject::UINT64,   offsetof(vegetation_t, extent_id),              1, NULL, NATIVE_FLAGS},
-    {"segment_id",              RecordObject::UINT32,   offsetof(vegetation_t, segment_id),             1, NULL, NATIVE_FLAGS},
-    {"rgt",                     RecordObject::UINT16,   offsetof(vegetation_t, rgt),                    1, NULL, NATIVE_FLAGS},
-    {"cycle",                   RecordObject::UINT16,   offsetof(vegetation_t, cycle),                  1, NULL, NATIVE_FLAGS},
-    {"spot",                    RecordObject::UINT8,    offsetof(vegetation_t, spot),                   1, NULL, NATIVE_FLAGS},
-    {"gt",                      RecordObject::UINT8,    offsetof(vegetation_t, gt),                     1, NULL, NATIVE_FLAGS},
-    {"ph_count",                RecordObject::UINT32,   offsetof(vegetation_t, photon_count),           1, NULL, NATIVE_FLAGS},
-    {"gnd_ph_count",            RecordObject::UINT32,   offsetof(vegetation_t, ground_photon_count),    1, NULL, NATIVE_FLAGS},
-    {"veg_ph_count",            RecordObject::UINT32,   offsetof(vegetation_t, vegetation_photon_count),1, NULL, NATIVE_FLAGS},
-    {"landcover",               RecordObject::UINT8,    offsetof(vegetation_t, landcover),              1, NULL, NATIVE_FLAGS},
-    {"snowcover",               RecordObject::UINT8,    offsetof(vegetation_t, snowcover),              1, NULL, NATIVE_FLAGS},
-    {"delta_time",              RecordObject::DOUBLE,   offsetof(vegetation_t, delta_time),             1, NULL, NATIVE_FLAGS},
-    {"lat",                     RecordObject::DOUBLE,   offsetof(vegetation_t, latitude),               1, NULL, NATIVE_FLAGS},
-    {"lon",                     RecordObject::DOUBLE,   offsetof(vegetation_t, longitude),              1, NULL, NATIVE_FLAGS},
-    {"distance",                RecordObject::DOUBLE,   offsetof(vegetation_t, distance),               1, NULL, NATIVE_FLAGS},
-    {"solar_elevation",         RecordObject::FLOAT,    offsetof(vegetation_t, solar_elevation),        1, NULL, NATIVE_FLAGS},
-    {"h_te_median",             RecordObject::FLOAT,    offsetof(vegetation_t, h_te_median),            1, NULL, NATIVE_FLAGS},
-    {"h_max_canopy",            RecordObject::FLOAT,    offsetof(vegetation_t, h_max_canopy),           1, NULL, NATIVE_FLAGS},
-    {"h_min_canopy",            RecordObject::FLOAT,    offsetof(vegetation_t, h_min_canopy),           1, NULL, NATIVE_FLAGS},
-    {"h_mean_canopy",           RecordObject::FLOAT,    offsetof(vegetation_t, h_mean_canopy),          1, NULL, NATIVE_FLAGS},
-    {"h_canopy",                RecordObject::FLOAT,    offsetof(vegetation_t, h_canopy),               1, NULL, NATIVE_FLAGS},
-    {"canopy_openness",         RecordObject::FLOAT,    offsetof(vegetation_t, canopy_openness),        1, NULL, NATIVE_FLAGS},
-    {"canopy_h_metrics",        RecordObject::FLOAT,    offsetof(vegetation_t, canopy_h_metrics),       NUM_PERCENTILES, NULL, NATIVE_FLAGS}
+    RECFIELD(vegetation_t, extent_id, "extent_id"),
+    RECFIELD(vegetation_t, segment_id, "segment_id"),
+    RECFIELD(vegetation_t, rgt, "rgt"),
+    RECFIELD(vegetation_t, cycle, "cycle"),
+    RECFIELD(vegetation_t, spot, "spot"),
+    RECFIELD(vegetation_t, gt, "gt"),
+    RECFIELD(vegetation_t, photon_count, "ph_count"),
+    RECFIELD(vegetation_t, ground_photon_count, "gnd_ph_count"),
+    RECFIELD(vegetation_t, vegetation_photon_count, "veg_ph_count"),
+    RECFIELD(vegetation_t, landcover, "landcover"),
+    RECFIELD(vegetation_t, snowcover, "snowcover"),
+    RECFIELD(vegetation_t, delta_time, "delta_time"),
+    RECFIELD(vegetation_t, latitude, "lat"),
+    RECFIELD(vegetation_t, longitude, "lon"),
+    RECFIELD(vegetation_t, distance, "distance"),
+    RECFIELD(vegetation_t, solar_elevation, "solar_elevation"),
+    RECFIELD(vegetation_t, h_te_median, "h_te_median"),
+    RECFIELD(vegetation_t, h_max_canopy, "h_max_canopy"),
+    RECFIELD(vegetation_t, h_min_canopy, "h_min_canopy"),
+    RECFIELD(vegetation_t, h_mean_canopy, "h_mean_canopy"),
+    RECFIELD(vegetation_t, h_canopy, "h_canopy"),
+    RECFIELD(vegetation_t, canopy_openness, "canopy_openness"),
+    RECFIELD(vegetation_t, canopy_h_metrics, "canopy_h_metrics")
 };
 
 const char* Atl08Dispatch::batchRecType = "atl08rec";
 const RecordObject::fieldDef_t Atl08Dispatch::batchRecDef[] = {
-    {"vegetation",              RecordObject::USER,     offsetof(atl08_t, vegetation),              0,  vegRecType, NATIVE_FLAGS}
+    RECFIELD_VAR(atl08_t, vegetation, "vegetation")
 };
 
 const char* Atl08Dispatch::waveRecType = "waverec";
 const RecordObject::fieldDef_t Atl08Dispatch::waveRecDef[] = {
-    {"extent_id",               RecordObject::UINT64,   offsetof(waveform_t, extent_id),            1, NULL, NATIVE_FLAGS},
-    {"num_bins",                RecordObject::UINT16,   offsetof(waveform_t, num_bins),             1, NULL, NATIVE_FLAGS},
-    {"binsize",                 RecordObject::FLOAT,    offsetof(waveform_t, binsize),              1, NULL, NATIVE_FLAGS},
-    {"waveform",                RecordObject::FLOAT,    offsetof(waveform_t, waveform),             0, NULL, NATIVE_FLAGS}
+    RECFIELD(waveform_t, extent_id, "extent_id"),
+    RECFIELD(waveform_t, num_bins, "num_bins"),
+    RECFIELD(waveform_t, binsize, "binsize"),
+    RECFIELD_VAR(waveform_t, waveform, "waveform")
 };
 
 /* Lua Functions */
@@ -98,6 +99,8 @@ const double Atl08Dispatch::PercentileInterval[NUM_PERCENTILES] = {
     5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95
 };
 
+thread_local Atl08Dispatch::scratch_t Atl08Dispatch::localScratch;
+
 /******************************************************************************
  * PUBLIC METHODS
  ******************************************************************************/
@@ -162,8 +165,9 @@ Atl08Dispatch::Atl08Dispatch (lua_State* L, const char* outq_name, Icesat2Parms*
      * this extends the memory available past the one set of stats provided in the
      * definition.
      */
-    recObj = new RecordObject(batchRecType, sizeof(atl08_t));
-    recData = (atl08_t*)recObj->getRecordData();
+    TypedRecord<atl08_t>* rec = new TypedRecord<atl08_t>(sizeof(atl08_t));
+    recObj = rec;
+    recData = rec->data();
 
     /* Initialize Publisher */
     outQ = new Publisher(outq_name);
@@ -189,7 +193,10 @@ bool Atl08Dispatch::processRecord (RecordObject* record, okey_t key)
 
     vegetation_t result[Icesat2Parms::NUM_PAIR_TRACKS];
     waveform_t* waveform[Icesat2Parms::NUM_PAIR_TRACKS];
-    Atl03Reader::extent_t* extent = (Atl03Reader::extent_t*)record->getRecordData();
+    Atl03Reader::extent_t attributes;
+    Atl03Reader::photon_columns_t columns;
+    uint8_t* buffer = Atl03Reader::getExtent(record, &attributes, &columns); // accepts extent and columnar extent records
+    Atl03Reader::extent_t* extent = &attributes;
 
     /* Clear Results */
     LocalLib::set(result, 0, sizeof(result));
@@ -204,18 +211,21 @@ bool Atl08Dispatch::processRecord (RecordObject* record, okey_t key)
         }
 
         /* Initialize Results */
-        geolocateResult(extent, t, result);
+        geolocateResult(extent, &columns, t, result);
 
         /* Execute Algorithm Stages */
         if(parms->stages[Icesat2Parms::STAGE_PHOREAL])
         {
-            phorealAlgorithm(extent, t, result);
+            phorealAlgorithm(extent, &columns, t, result);
         }
 
         /* Post Results */
         postResult(t, result);
     }
 
+    /* Free Transposed Photons */
+    delete [] buffer;
+
     /* Return Status */
     return true;
 }
@@ -242,7 +252,7 @@ bool Atl08Dispatch::processTermination (void)
 /*----------------------------------------------------------------------------
  * geolocateResult
  *----------------------------------------------------------------------------*/
-void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, vegetation_t* result)
+void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, int t, vegetation_t* result)
 {
     /* Get Orbit Info */
     Icesat2Parms::sc_orient_t sc_orient = (Icesat2Parms::sc_orient_t)extent->spacecraft_orientation;
@@ -259,8 +269,14 @@ void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, veget
     result[t].solar_elevation = extent->solar_elevation[t];
 
     /* Determine Starting Photon and Number of Photons */
-    Atl03Reader::photon_t* ph = (Atl03Reader::photon_t*)((uint8_t*)extent + extent->photon_offset[t]);
+    uint32_t first_ph = (t == Icesat2Parms::RPT_R) ? extent->photon_count[Icesat2Parms::RPT_L] : 0;
     uint32_t num_ph = extent->photon_count[t];
+    const double* delta_time = &columns->delta_time[first_ph];
+    const double* latitude = &columns->latitude[first_ph];
+    const double* longitude = &columns->longitude[first_ph];
+    const double* distance = &columns->x_atc[first_ph];
+    const uint8_t* landcover = &columns->landcover[first_ph];
+    const uint8_t* snowcover = &columns->snowcover[first_ph];
 
     /* Calculate Geolocation Fields */
     if(num_ph == 0)
@@ -279,15 +295,15 @@ void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, veget
         double distance_min = DBL_MAX, distance_max = -DBL_MAX;
         for(uint32_t i = 0; i < num_ph; i++)
         {
-            if(ph[i].delta_time < delta_time_min)   delta_time_min  = ph[i].delta_time;
-            if(ph[i].latitude   < latitude_min)     latitude_min    = ph[i].delta_time;
-            if(ph[i].longitude  < longitude_min)    longitude_min   = ph[i].delta_time;
-            if(ph[i].distance   < distance_min)     distance_min    = ph[i].delta_time;
-
-            if(ph[i].delta_time > delta_time_max)   delta_time_max  = ph[i].delta_time;
-            if(ph[i].latitude   > latitude_max)     latitude_max    = ph[i].delta_time;
-            if(ph[i].longitude  > longitude_max)    longitude_max   = ph[i].delta_time;
-            if(ph[i].distance   > distance_max)     distance_max    = ph[i].delta_time;
+            if(delta_time[i] < delta_time_min)   delta_time_min  = delta_time[i];
+            if(latitude[i]   < latitude_min)     latitude_min    = delta_time[i];
+            if(longitude[i]  < longitude_min)    longitude_min   = delta_time[i];
+            if(distance[i]   < distance_min)     distance_min    = delta_time[i];
+
+            if(delta_time[i] > delta_time_max)   delta_time_max  = delta_time[i];
+            if(latitude[i]   > latitude_max)     latitude_max    = delta_time[i];
+            if(longitude[i]  > longitude_max)    longitude_max   = delta_time[i];
+            if(distance[i]   > distance_max)     distance_max    = delta_time[i];
         }
 
         /* Calculate Averages */
@@ -305,10 +321,10 @@ void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, veget
         double sum_distance = 0.0;
         for(uint32_t i = 0; i < num_ph; i++)
         {
-            sum_delta_time += ph[i].delta_time;
-            sum_latitude += ph[i].latitude;
-            sum_longitude += ph[i].longitude;
-            sum_distance += ph[i].distance + extent->segment_distance[t];
+            sum_delta_time += delta_time[i];
+            sum_latitude += latitude[i];
+            sum_longitude += longitude[i];
+            sum_distance += distance[i] + extent->segment_distance[t];
         }
 
         /* Calculate Averages */
@@ -322,24 +338,24 @@ void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, veget
         uint32_t center_ph = num_ph / 2;
         if(num_ph == 0) // No Photons
         {
-            result[t].delta_time = ph[0].delta_time;
-            result[t].latitude = ph[0].latitude;
-            result[t].longitude = ph[0].longitude;
-            result[t].distance = ph[0].distance + extent->segment_distance[t];
+            result[t].delta_time = delta_time[0];
+            result[t].latitude = latitude[0];
+            result[t].longitude = longitude[0];
+            result[t].distance = distance[0] + extent->segment_distance[t];
         }
         else if(num_ph % 2 == 1) // Odd Number of Photons
         {
-            result[t].delta_time = ph[center_ph].delta_time;
-            result[t].latitude = ph[center_ph].latitude;
-            result[t].longitude = ph[center_ph].longitude;
-            result[t].distance = ph[center_ph].distance + extent->segment_distance[t];
+            result[t].delta_time = delta_time[center_ph];
+            result[t].latitude = latitude[center_ph];
+            result[t].longitude = longitude[center_ph];
+            result[t].distance = distance[center_ph] + extent->segment_distance[t];
         }
         else // Even Number of Photons
         {
-            result[t].delta_time = (ph[center_ph].delta_time + ph[center_ph - 1].delta_time) / 2;
-            result[t].latitude = (ph[center_ph].latitude + ph[center_ph - 1].latitude) / 2;
-            result[t].longitude = (ph[center_ph].longitude + ph[center_ph - 1].longitude) / 2;
-            result[t].distance = ((ph[center_ph].distance + ph[center_ph - 1].distance) / 2) + extent->segment_distance[t];
+            result[t].delta_time = (delta_time[center_ph] + delta_time[center_ph - 1]) / 2;
+            result[t].latitude = (latitude[center_ph] + latitude[center_ph - 1]) / 2;
+            result[t].longitude = (longitude[center_ph] + longitude[center_ph - 1]) / 2;
+            result[t].distance = ((distance[center_ph] + distance[center_ph - 1]) / 2) + extent->segment_distance[t];
         }
     }
 
@@ -356,64 +372,54 @@ void Atl08Dispatch::geolocateResult (Atl03Reader::extent_t* extent, int t, veget
         double diff_min = DBL_MAX;
         for(uint32_t i = 0; i < num_ph; i++)
         {
-            double diff = abs(ph[i].delta_time - result[t].delta_time);
+            double diff = abs(delta_time[i] - result[t].delta_time);
             if(diff < diff_min)
             {
                 diff_min = diff;
                 center_ph = i;
             }
         }
-        result[t].landcover = ph[center_ph].landcover;
-        result[t].snowcover = ph[center_ph].snowcover;
+        result[t].landcover = landcover[center_ph];
+        result[t].snowcover = snowcover[center_ph];
     }
 }
 
 /*----------------------------------------------------------------------------
  * phorealAlgorithm
  *----------------------------------------------------------------------------*/
-void Atl08Dispatch::phorealAlgorithm (Atl03Reader::extent_t* extent, int t, vegetation_t* result)
+void Atl08Dispatch::phorealAlgorithm (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, int t, vegetation_t* result)
 {
     /* Determine Starting Photon and Number of Photons */
-    Atl03Reader::photon_t* ph = (Atl03Reader::photon_t*)((uint8_t*)extent + extent->photon_offset[t]);
+    uint32_t first_ph = (t == Icesat2Parms::RPT_R) ? extent->photon_count[Icesat2Parms::RPT_L] : 0;
     long num_ph = extent->photon_count[t];
-
-    /* Determine Number of Ground and Vegetation Photons */
+    const float* relief = &columns->relief[first_ph];
+    const uint8_t* atl08_class = &columns->atl08_class[first_ph];
+
+    /* Get Working Buffers */
+    scratch_t* scratch = getScratch(num_ph);
+    float* gnd_h = scratch->gnd_h;
+    float* veg_h = scratch->veg_h;
+    int32_t* bin_idx = scratch->bin_idx;
+    long* bins = scratch->bins;
+    float* bin_max = scratch->bin_max;
+
+    /* Gather Ground and Vegetation Photon Heights */
     long gnd_cnt = 0;
     long veg_cnt = 0;
     for(long i = 0; i < num_ph; i++)
     {
-        if(isGround(&ph[i]) || parms->phoreal.use_abs_h)
+        if(isGround(atl08_class[i]) || parms->phoreal.use_abs_h)
         {
-            gnd_cnt++;
+            gnd_h[gnd_cnt++] = relief[i];
         }
-        else if(isVegetation(&ph[i]) || parms->phoreal.use_abs_h)
+        else if(isVegetation(atl08_class[i]) || parms->phoreal.use_abs_h)
         {
-            veg_cnt++;
+            veg_h[veg_cnt++] = relief[i];
         }
     }
     result[t].ground_photon_count = gnd_cnt;
     result[t].vegetation_photon_count = veg_cnt;
 
-    /* Create Ground and Vegetation Photon Index Arrays */
-    long* gnd_index = new long [gnd_cnt];
-    long* veg_index = new long [veg_cnt];
-    long g = 0, v = 0;
-    for(long i = 0; i < num_ph; i++)
-    {
-        if(isGround(&ph[i]) || parms->phoreal.use_abs_h)
-        {
-            gnd_index[g++] = i;
-        }
-        else if(isVegetation(&ph[i]) || parms->phoreal.use_abs_h)
-        {
-            veg_index[v++] = i;
-        }
-    }
-
-    /* Sort Ground and Vegetation Photon Index Arrays */
-    quicksort(gnd_index, ph, 0, gnd_cnt - 1);
-    quicksort(veg_index, ph, 0, veg_cnt - 1);
-
     /* Determine Min,Max,Avg Heights */
     double min_h = DBL_MAX;
     double max_h = -DBL_MAX;
@@ -422,14 +428,14 @@ void Atl08Dispatch::phorealAlgorithm (Atl03Reader::extent_t* extent, int t, vege
     {
         for(long i = 0; i < veg_cnt; i++)
         {
-            sum_h += ph[veg_index[i]].relief;
-            if(ph[veg_index[i]].relief > max_h)
+            sum_h += veg_h[i];
+            if(veg_h[i] > max_h)
             {
-                max_h = ph[veg_index[i]].relief;
+                max_h = veg_h[i];
             }
-            if(ph[veg_index[i]].relief < min_h)
+            if(veg_h[i] < min_h)
             {
-                min_h = ph[veg_index[i]].relief;
+                min_h = veg_h[i];
             }
         }
     }
@@ -446,7 +452,7 @@ void Atl08Dispatch::phorealAlgorithm (Atl03Reader::extent_t* extent, int t, vege
     double std_h = 0.0;
     for(long i = 0; i < veg_cnt; i++)
     {
-        double delta = (ph[veg_index[i]].relief - result[t].h_mean_canopy);
+        double delta = (veg_h[i] - result[t].h_mean_canopy);
         std_h += delta * delta;
     }
     result[t].canopy_openness = sqrt(std_h);
@@ -465,93 +471,114 @@ void Atl08Dispatch::phorealAlgorithm (Atl03Reader::extent_t* extent, int t, vege
         num_bins = 1;
     }
 
-    /* Bin Photons */
-    long* bins = new long[num_bins];
+    /*
+     * Bin Photons
+     *
+     *  The bin of every photon is found in a branch free pass the compiler
+     *  can vectorize (heights are at or above min_h so truncation is floor),
+     *  and the counts and bin maximums are then accumulated from it; both
+     *  the waveform and the percentiles below are read from these bins
+     */
+    const double binsize = parms->phoreal.binsize;
+    const int32_t last_bin = num_bins - 1;
+    for(long i = 0; i < veg_cnt; i++)
+    {
+        int32_t bin = (int32_t)((veg_h[i] - min_h) / binsize);
+        bin_idx[i] = bin < 0 ? 0 : (bin > last_bin ? last_bin : bin);
+    }
     LocalLib::set(bins, 0, num_bins * sizeof(long));
     for(long i = 0; i < veg_cnt; i++)
     {
-        int bin = (int)floor((ph[veg_index[i]].relief - min_h) / parms->phoreal.binsize);
-        if(bin < 0) bin = 0;
-        else if(bin >= num_bins) bin = num_bins - 1;
+        int32_t bin = bin_idx[i];
+        if(bins[bin] == 0 || veg_h[i] > bin_max[bin]) bin_max[bin] = veg_h[i];
         bins[bin]++;
     }
 
-    /* Send Waveforms */
+    /* Send Waveforms - record is reused across extents and trimmed to num_bins when posted */
     if(parms->phoreal.send_waveform && num_bins > 0)
     {
-        int recsize = offsetof(waveform_t, waveform) + (num_bins * sizeof(float));
-        RecordObject waverec(waveRecType, recsize, false);
-        waveform_t* data = (waveform_t*)waverec.getRecordData();
+        if(scratch->waverec == NULL) scratch->waverec = new TypedRecord<waveform_t>(sizeof(waveform_t), false);
+        waveform_t* data = scratch->waverec->data();
         data->extent_id = extent->extent_id | Icesat2Parms::EXTENT_ID_ELEVATION | t;
         data->num_bins = num_bins;
-        data->binsize = parms->phoreal.binsize;
+        data->binsize = binsize;
         for(int b = 0; b < num_bins; b++)
         {
             data->waveform[b] = (float)((double)bins[b] / (double)num_ph);
         }
-        waverec.post(outQ);
-    }
-
-    /* Generate Cumulative Bins */
-    long* cbins = new long[num_bins];
-    cbins[0] = bins[0];
-    for(int b = 1; b < num_bins; b++)
-    {
-        cbins[b] = cbins[b - 1] + bins[b];
+        unsigned char* buffer; // reference to serial buffer
+        int size = scratch->waverec->serialize(&buffer, RecordObject::REFERENCE, offsetof(waveform_t, waveform) + (num_bins * sizeof(float)));
+        int status = MsgQ::STATE_TIMEOUT;
+        while((status = outQ->postCopy(buffer, size, SYS_TIMEOUT)) == MsgQ::STATE_TIMEOUT);
+        if(status < 0)
+        {
+            mlog(ERROR, "Failed to post %s to stream %s: %d", waveRecType, outQ->getName(), status);
+        }
     }
 
     /* Find Median Terrain Height */
     float h_te_median = 0.0;
     if(gnd_cnt > 0)
     {
+        long i0 = (gnd_cnt - 1) / 2;
+        std::nth_element(gnd_h, gnd_h + i0, gnd_h + gnd_cnt);
         if(gnd_cnt % 2 == 0) // even
         {
-            long i0 = (gnd_cnt - 1) / 2;
-            long i1 = ((gnd_cnt - 1) / 2) + 1;
-            h_te_median = (ph[gnd_index[i0]].relief + ph[gnd_index[i1]].relief) / 2.0;
+            /* nth_element leaves everything above i0 no lower than it */
+            float h1 = *std::min_element(gnd_h + i0 + 1, gnd_h + gnd_cnt);
+            h_te_median = (gnd_h[i0] + h1) / 2.0;
         }
         else // odd
         {
-            long i0 = (gnd_cnt - 1) / 2;
-            h_te_median = ph[gnd_index[i0]].relief;
+            h_te_median = gnd_h[i0];
         }
     }
     result[t].h_te_median = h_te_median;
 
-    /* Calculate Percentiles */
+    /*
+     * Calculate Percentiles
+     *
+     *  Bin membership is monotonic in height, so the photon at a cumulative
+     *  count that ends on bin b is the highest photon in the last non-empty
+     *  bin at or below b; no sort of the vegetation heights is needed.
+     */
     {
         int b = 0; // bin index
+        long cbin = bins[0]; // cumulative count through bin b
+        float top_h = bin_max[0]; // highest photon through bin b
         for(int p = 0; p < NUM_PERCENTILES; p++)
         {
             while(b < num_bins)
             {
-                double percentage = ((double)cbins[b] / (double)veg_cnt) * 100.0;
-                if(percentage >= PercentileInterval[p] && cbins[b] > 0)
+                double percentage = ((double)cbin / (double)veg_cnt) * 100.0;
+                if(percentage >= PercentileInterval[p] && cbin > 0)
                 {
-                    result[t].canopy_h_metrics[p] = ph[veg_index[cbins[b] - 1]].relief;
+                    result[t].canopy_h_metrics[p] = top_h;
                     break;
                 }
-                b++;
+                if(++b < num_bins)
+                {
+                    cbin += bins[b];
+                    if(bins[b] > 0) top_h = bin_max[b];
+                }
             }
         }
         /* Find 98th Percentile */
         while(b < num_bins)
         {
-            double percentage = ((double)cbins[b] / (double)veg_cnt) * 100.0;
-            if(percentage >= 98.0 && cbins[b] > 0)
+            double percentage = ((double)cbin / (double)veg_cnt) * 100.0;
+            if(percentage >= 98.0 && cbin > 0)
             {
-                result[t].h_canopy = ph[veg_index[cbins[b] - 1]].relief;
+                result[t].h_canopy = top_h;
                 break;
             }
-            b++;
+            if(++b < num_bins)
+            {
+                cbin += bins[b];
+                if(bins[b] > 0) top_h = bin_max[b];
+            }
         }
     }
-
-    /* Clean Up */
-    delete [] gnd_index;
-    delete [] veg_index;
-    delete [] bins;
-    delete [] cbins;
 }
 
 /*----------------------------------------------------------------------------
@@ -586,35 +613,23 @@ void Atl08Dispatch::postResult (int t, vegetation_t* result)
 }
 
 /*----------------------------------------------------------------------------
- * postResult
- *----------------------------------------------------------------------------*/
-void Atl08Dispatch::quicksort (long* index_array, Atl03Reader::photon_t* ph_array, int start, int end)
-{
-    if(start < end)
-    {
-        int partition = quicksortpartition(index_array, ph_array, start, end);
-        quicksort(index_array, ph_array, start, partition);
-        quicksort(index_array, ph_array, partition + 1, end);
-    }
-}
-
-/*----------------------------------------------------------------------------
- * postResult
+ * getScratch
+ *
+ *  returns this thread's working buffers grown to hold num_ph heights; they
+ *  are reused across extents and freed when the thread exits
  *----------------------------------------------------------------------------*/
-int Atl08Dispatch::quicksortpartition (long* index_array, Atl03Reader::photon_t* ph_array, int start, int end)
+Atl08Dispatch::scratch_t* Atl08Dispatch::getScratch (long num_ph)
 {
-    double pivot = ph_array[index_array[(start + end) / 2]].relief;
-
-    start--;
-    end++;
-    while(true)
+    scratch_t* scratch = &localScratch;
+    if(scratch->size < num_ph)
     {
-        while (ph_array[index_array[++start]].relief < pivot);
-        while (ph_array[index_array[--end]].relief > pivot);
-        if (start >= end) return end;
-
-        long tmp = index_array[start];
-        index_array[start] = index_array[end];
-        index_array[end] = tmp;
+        delete [] scratch->gnd_h;
+        delete [] scratch->veg_h;
+        delete [] scratch->bin_idx;
+        scratch->gnd_h = new float [num_ph];
+        scratch->veg_h = new float [num_ph];
+        scratch->bin_idx = new int32_t [num_ph];
+        scratch->size = num_ph;
     }
+    return scratch;
 }
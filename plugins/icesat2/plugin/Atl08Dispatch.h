@@ -133,10 +133,29 @@ class Atl08Dispatch: public DispatchObject
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Per Thread PhoREAL Working Buffers */
+        struct scratch_t {
+            float*              gnd_h;                  // heights of ground photons
+            float*              veg_h;                  // heights of vegetation photons
+            int32_t*            bin_idx;                // bin of each vegetation photon
+            long                size;                   // allocated length of each height buffer
+            long                bins[MAX_BINS];         // photon count of each bin
+            float               bin_max[MAX_BINS];      // highest photon in each bin
+            TypedRecord<waveform_t>* waverec;           // full size waveform record, posted by copy
+            scratch_t(void): gnd_h(NULL), veg_h(NULL), bin_idx(NULL), size(0), waverec(NULL) {}
+            ~scratch_t(void) { delete [] gnd_h; delete [] veg_h; delete [] bin_idx; delete waverec; }
+        };
+
         /*--------------------------------------------------------------------
          * Data
          *--------------------------------------------------------------------*/
 
+        static thread_local scratch_t localScratch;
+
         RecordObject*       recObj;
         atl08_t*            recData;
         Publisher*          outQ;
@@ -157,25 +176,32 @@ class Atl08Dispatch: public DispatchObject
         bool            processTimeout                  (void) override;
         bool            processTermination              (void) override;
 
-        void            geolocateResult                 (Atl03Reader::extent_t* extent, int t, vegetation_t* result);
-        void            phorealAlgorithm                (Atl03Reader::extent_t* extent, int t, vegetation_t* result);
+        void            geolocateResult                 (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, int t, vegetation_t* result);
+        void            phorealAlgorithm                (Atl03Reader::extent_t* extent, const Atl03Reader::photon_columns_t* columns, int t, vegetation_t* result);
         void            postResult                      (int t, vegetation_t* result);
-        static void     quicksort                       (long* index_array, Atl03Reader::photon_t* ph_array, int start, int end);
-        static int      quicksortpartition              (long* index_array, Atl03Reader::photon_t* ph_array, int start, int end);
+        static scratch_t* getScratch                    (long num_ph);
 
         /*--------------------------------------------------------------------
          * Inline Methods
          *--------------------------------------------------------------------*/
 
-        inline bool isVegetation (Atl03Reader::photon_t* ph)
+        inline bool isVegetation (uint8_t atl08_class)
         {
-            return (ph->atl08_class == Icesat2Parms::ATL08_CANOPY || ph->atl08_class == Icesat2Parms::ATL08_TOP_OF_CANOPY);
+            return (atl08_class == Icesat2Parms::ATL08_CANOPY || atl08_class == Icesat2Parms::ATL08_TOP_OF_CANOPY);
         }
 
-        inline bool isGround (Atl03Reader::photon_t* ph)
+        inline bool isGround (uint8_t atl08_class)
         {
-            return (ph->atl08_class == Icesat2Parms::ATL08_GROUND);
+            return (atl08_class == Icesat2Parms::ATL08_GROUND);
         }
 };
 
+/******************************************************************************
+ * RECORD TYPES
+ ******************************************************************************/
+
+RECTYPE(Atl08Dispatch::vegetation_t,    Atl08Dispatch::vegRecType)
+RECTYPE(Atl08Dispatch::atl08_t,         Atl08Dispatch::batchRecType)
+RECTYPE(Atl08Dispatch::waveform_t,      Atl08Dispatch::waveRecType)
+
 #endif  /* __atl08_dispatch__ */
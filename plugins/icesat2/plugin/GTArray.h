@@ -61,11 +61,11 @@ class GTArray
          * Methods
          *--------------------------------------------------------------------*/
 
-                    GTArray     (const Asset* asset, const char* resource, int track, const char* gt_dataset, H5Coro::context_t* context, long col=0, const long* prt_startrow=DefaultStartRow, const long* prt_numrows=DefaultNumRows);
+                    GTArray     (const Asset* asset, const char* resource, int track, const char* gt_dataset, H5Coro::context_t* context, long col=0, const long* prt_startrow=DefaultStartRow, const long* prt_numrows=DefaultNumRows, const H5Coro::row_range_t* const* prt_ranges=NULL, const int* prt_num_ranges=NULL);
         virtual     ~GTArray    (void);
 
         H5Array<T>& operator[]  (int t);
-        bool        trim        (long* prt_offset);
+        bool        trim        (long* prt_offset, const long* prt_count=NULL);
         bool        join        (int timeout, bool throw_exception);
 
         /*--------------------------------------------------------------------
@@ -90,11 +90,14 @@ const long GTArray<T>::DefaultNumRows[Icesat2Parms::NUM_PAIR_TRACKS] = {H5Coro::
 
 /*----------------------------------------------------------------------------
  * Constructor
+ *
+ *  optional per pair track row ranges restrict the read to those rows (see
+ *  H5Array); a NULL range list for a track reads its whole span
  *----------------------------------------------------------------------------*/
 template <class T>
-GTArray<T>::GTArray(const Asset* asset, const char* resource, int track, const char* gt_dataset, H5Coro::context_t* context, long col, const long* prt_startrow, const long* prt_numrows):
-    gt{ H5Array<T>(asset, resource, SafeString("/gt%dl/%s", track, gt_dataset).getString(), context, col, prt_startrow[Icesat2Parms::RPT_L], prt_numrows[Icesat2Parms::RPT_L]),
-        H5Array<T>(asset, resource, SafeString("/gt%dr/%s", track, gt_dataset).getString(), context, col, prt_startrow[Icesat2Parms::RPT_R], prt_numrows[Icesat2Parms::RPT_R]) }
+GTArray<T>::GTArray(const Asset* asset, const char* resource, int track, const char* gt_dataset, H5Coro::context_t* context, long col, const long* prt_startrow, const long* prt_numrows, const H5Coro::row_range_t* const* prt_ranges, const int* prt_num_ranges):
+    gt{ H5Array<T>(asset, resource, SafeString("/gt%dl/%s", track, gt_dataset).getString(), context, col, prt_startrow[Icesat2Parms::RPT_L], prt_numrows[Icesat2Parms::RPT_L], prt_ranges ? prt_ranges[Icesat2Parms::RPT_L] : NULL, prt_num_ranges ? prt_num_ranges[Icesat2Parms::RPT_L] : 0),
+        H5Array<T>(asset, resource, SafeString("/gt%dr/%s", track, gt_dataset).getString(), context, col, prt_startrow[Icesat2Parms::RPT_R], prt_numrows[Icesat2Parms::RPT_R], prt_ranges ? prt_ranges[Icesat2Parms::RPT_R] : NULL, prt_num_ranges ? prt_num_ranges[Icesat2Parms::RPT_R] : 0) }
 {
 }
 
@@ -119,10 +122,11 @@ H5Array<T>& GTArray<T>::operator[] (int t)
  * trim
  *----------------------------------------------------------------------------*/
 template <class T>
-bool GTArray<T>::trim(long* prt_offset)
+bool GTArray<T>::trim(long* prt_offset, const long* prt_count)
 {
     if(!prt_offset) return false;
-    else return (gt[Icesat2Parms::RPT_L].trim(prt_offset[Icesat2Parms::RPT_L]) && gt[Icesat2Parms::RPT_R].trim(prt_offset[Icesat2Parms::RPT_R]));
+    else if(!prt_count) return (gt[Icesat2Parms::RPT_L].trim(prt_offset[Icesat2Parms::RPT_L]) && gt[Icesat2Parms::RPT_R].trim(prt_offset[Icesat2Parms::RPT_R]));
+    else return (gt[Icesat2Parms::RPT_L].trim(prt_offset[Icesat2Parms::RPT_L], prt_count[Icesat2Parms::RPT_L]) && gt[Icesat2Parms::RPT_R].trim(prt_offset[Icesat2Parms::RPT_R], prt_count[Icesat2Parms::RPT_R]));
 }
 
 /*----------------------------------------------------------------------------
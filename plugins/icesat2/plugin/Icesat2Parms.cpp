@@ -71,6 +71,7 @@ const char* Icesat2Parms::PASS_INVALID                 = "pass_invalid";
 const char* Icesat2Parms::DISTANCE_IN_SEGMENTS         = "dist_in_seg";
 const char* Icesat2Parms::ATL03_GEO_FIELDS             = "atl03_geo_fields";
 const char* Icesat2Parms::ATL03_PH_FIELDS              = "atl03_ph_fields";
+const char* Icesat2Parms::ATL03_ANC_PACKED             = "atl03_anc_packed";
 const char* Icesat2Parms::RQST_TIMEOUT                 = "rqst-timeout";
 const char* Icesat2Parms::NODE_TIMEOUT                 = "node-timeout";
 const char* Icesat2Parms::READ_TIMEOUT                 = "read-timeout";
@@ -81,10 +82,14 @@ const char* Icesat2Parms::PHOREAL_GEOLOC               = "geoloc";
 const char* Icesat2Parms::PHOREAL_USE_ABS_H            = "use_abs_h";
 const char* Icesat2Parms::PHOREAL_WAVEFORM             = "send_waveform";
 const char* Icesat2Parms::PHOREAL_ABOVE                = "above_classifier";
+const char* Icesat2Parms::PARTITIONS                   = "partitions";
+const char* Icesat2Parms::PRIORITY                     = "priority";
+const char* Icesat2Parms::PACKED                       = "packed_parms";
 
 const char* Icesat2Parms::OBJECT_TYPE = "Icesat2Parms";
 const char* Icesat2Parms::LuaMetaName = "Icesat2Parms";
 const struct luaL_Reg Icesat2Parms::LuaMetaTable[] = {
+    {"pack",        luaPack},
     {NULL,          NULL}
 };
 
@@ -239,6 +244,7 @@ Icesat2Parms::Icesat2Parms(lua_State* L, int index):
     extent_step                 (20.0),
     atl03_geo_fields            (NULL),
     atl03_ph_fields             (NULL),
+    atl03_anc_packed            (false),
     rqst_timeout                (DEFAULT_RQST_TIMEOUT),
     node_timeout                (DEFAULT_NODE_TIMEOUT),
     read_timeout                (DEFAULT_READ_TIMEOUT),
@@ -246,12 +252,30 @@ Icesat2Parms::Icesat2Parms(lua_State* L, int index):
                                   .geoloc           = PHOREAL_MEDIAN,
                                   .use_abs_h        = false,
                                   .send_waveform    = false,
-                                  .above_classifier = false }
+                                  .above_classifier = false },
+    partitions                  (1),
+    priority                    (ThreadBudget::NORMAL_PRIORITY)
 {
     bool provided = false;
 
     try
     {
+        /* Packed Parameters (already parsed by the proxy node) */
+        lua_getfield(L, index, Icesat2Parms::PACKED);
+        const char* packed_str = LuaObject::getLuaString(L, -1, true, NULL, &provided);
+        if(provided) unpack(packed_str);
+        lua_pop(L, 1);
+
+        if(provided)
+        {
+            /* Raster (not packed, it is built from its geojson) */
+            lua_getfield(L, index, Icesat2Parms::RASTER);
+            get_lua_raster(L, -1, &provided);
+            if(provided) mlog(DEBUG, "Setting %s file for use", Icesat2Parms::RASTER);
+            lua_pop(L, 1);
+            return;
+        }
+
         /* Surface Type */
         lua_getfield(L, index, Icesat2Parms::SURFACE_TYPE);
         surface_type = (surface_type_t)LuaObject::getLuaInteger(L, -1, true, surface_type, &provided);
@@ -370,6 +394,12 @@ Icesat2Parms::Icesat2Parms(lua_State* L, int index):
         if(provided) mlog(DEBUG, "ATL03 photon field array supplied");
         lua_pop(L, 1);
 
+        /* ATL03 Packed Ancillary Flag */
+        lua_getfield(L, index, Icesat2Parms::ATL03_ANC_PACKED);
+        atl03_anc_packed = LuaObject::getLuaBoolean(L, -1, true, atl03_anc_packed, &provided);
+        if(provided) mlog(DEBUG, "Setting %s to %s", Icesat2Parms::ATL03_ANC_PACKED, atl03_anc_packed ? "true" : "false");
+        lua_pop(L, 1);
+
         /* Global Timeout */
         lua_getfield(L, index, Icesat2Parms::GLOBAL_TIMEOUT);
         int global_timeout = LuaObject::getLuaInteger(L, -1, true, 0, &provided);
@@ -402,6 +432,18 @@ Icesat2Parms::Icesat2Parms(lua_State* L, int index):
         if(provided) mlog(DEBUG, "Setting %s to %d", Icesat2Parms::READ_TIMEOUT, read_timeout);
         lua_pop(L, 1);
 
+        /* Partitions */
+        lua_getfield(L, index, Icesat2Parms::PARTITIONS);
+        partitions = LuaObject::getLuaInteger(L, -1, true, partitions, &provided);
+        if(provided) mlog(DEBUG, "Setting %s to %d", Icesat2Parms::PARTITIONS, partitions);
+        lua_pop(L, 1);
+
+        /* Priority */
+        lua_getfield(L, index, Icesat2Parms::PRIORITY);
+        priority = LuaObject::getLuaInteger(L, -1, true, priority, &provided);
+        if(provided) mlog(DEBUG, "Setting %s to %d", Icesat2Parms::PRIORITY, priority);
+        lua_pop(L, 1);
+
         /* PhoREAL */
         lua_getfield(L, index, Icesat2Parms::PHOREAL);
         get_lua_phoreal(L, -1, &provided);
@@ -445,6 +487,203 @@ void Icesat2Parms::cleanup (void)
     if(atl03_ph_fields) delete atl03_ph_fields;
 }
 
+/*----------------------------------------------------------------------------
+ * pack
+ *
+ *  returns the parsed parameters as a base64 string which workers unpack in
+ *  place of walking the parameter table again; the raster is not included
+ *----------------------------------------------------------------------------*/
+char* Icesat2Parms::pack (void)
+{
+    /* Populate Fixed Size Settings */
+    packed_t packed;
+    LocalLib::set(&packed, 0, sizeof(packed));
+    packed.magic                        = PACKED_MAGIC;
+    packed.version                      = PACKED_VERSION;
+    packed.surface_type                 = surface_type;
+    packed.pass_invalid                 = pass_invalid;
+    packed.dist_in_seg                  = dist_in_seg;
+    packed.compact                      = compact;
+    packed.atl03_anc_packed             = atl03_anc_packed;
+    LocalLib::copy(packed.atl03_cnf, atl03_cnf, sizeof(atl03_cnf));
+    LocalLib::copy(packed.quality_ph, quality_ph, sizeof(quality_ph));
+    LocalLib::copy(packed.atl08_class, atl08_class, sizeof(atl08_class));
+    LocalLib::copy(packed.stages, stages, sizeof(stages));
+    packed.yapc                         = yapc;
+    packed.track                        = track;
+    packed.max_iterations               = max_iterations;
+    packed.minimum_photon_count         = minimum_photon_count;
+    packed.along_track_spread           = along_track_spread;
+    packed.minimum_window               = minimum_window;
+    packed.maximum_robust_dispersion    = maximum_robust_dispersion;
+    packed.extent_length                = extent_length;
+    packed.extent_step                  = extent_step;
+    packed.rqst_timeout                 = rqst_timeout;
+    packed.node_timeout                 = node_timeout;
+    packed.read_timeout                 = read_timeout;
+    packed.phoreal                      = phoreal;
+    packed.partitions                   = partitions;
+    packed.priority                     = priority;
+    packed.num_points                   = polygon.length();
+    packed.num_geo_fields               = atl03_geo_fields ? atl03_geo_fields->length() : -1;
+    packed.num_ph_fields                = atl03_ph_fields ? atl03_ph_fields->length() : -1;
+
+    /* Size Buffer */
+    int size = sizeof(packed_t) + (packed.num_points * sizeof(MathLib::coord_t));
+    for(int i = 0; i < packed.num_geo_fields; i++) size += (*atl03_geo_fields)[i].getLength();
+    for(int i = 0; i < packed.num_ph_fields; i++) size += (*atl03_ph_fields)[i].getLength();
+
+    /* Serialize */
+    uint8_t* buffer = new uint8_t [size];
+    int offset = 0;
+    LocalLib::copy(&buffer[offset], &packed, sizeof(packed_t));
+    offset += sizeof(packed_t);
+    for(uint32_t p = 0; p < packed.num_points; p++)
+    {
+        LocalLib::copy(&buffer[offset], &polygon[p], sizeof(MathLib::coord_t));
+        offset += sizeof(MathLib::coord_t);
+    }
+    for(int i = 0; i < packed.num_geo_fields; i++)
+    {
+        int len = (*atl03_geo_fields)[i].getLength();
+        LocalLib::copy(&buffer[offset], (*atl03_geo_fields)[i].getString(), len);
+        offset += len;
+    }
+    for(int i = 0; i < packed.num_ph_fields; i++)
+    {
+        int len = (*atl03_ph_fields)[i].getLength();
+        LocalLib::copy(&buffer[offset], (*atl03_ph_fields)[i].getString(), len);
+        offset += len;
+    }
+
+    /* Encode */
+    char* packed_str = StringLib::b64encode(buffer, &size);
+    delete [] buffer;
+    return packed_str;
+}
+
+/*----------------------------------------------------------------------------
+ * unpack
+ *----------------------------------------------------------------------------*/
+void Icesat2Parms::unpack (const char* packed_str)
+{
+    int size = StringLib::size(packed_str, MAX_PACKED_SIZE);
+    uint8_t* buffer = StringLib::b64decode(packed_str, &size);
+
+    try
+    {
+        /* Check Fixed Size Settings */
+        packed_t packed;
+        if(size < (int)sizeof(packed_t))
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "packed parameters too small: %d", size);
+        }
+        LocalLib::copy(&packed, buffer, sizeof(packed_t));
+        if(packed.magic != PACKED_MAGIC || packed.version != PACKED_VERSION)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "unsupported packed parameters: 0x%08X, version %u", packed.magic, packed.version);
+        }
+
+        /* Apply Fixed Size Settings */
+        surface_type                = packed.surface_type;
+        pass_invalid                = packed.pass_invalid;
+        dist_in_seg                 = packed.dist_in_seg;
+        compact                     = packed.compact;
+        atl03_anc_packed            = packed.atl03_anc_packed;
+        LocalLib::copy(atl03_cnf, packed.atl03_cnf, sizeof(atl03_cnf));
+        LocalLib::copy(quality_ph, packed.quality_ph, sizeof(quality_ph));
+        LocalLib::copy(atl08_class, packed.atl08_class, sizeof(atl08_class));
+        LocalLib::copy(stages, packed.stages, sizeof(stages));
+        yapc                        = packed.yapc;
+        track                       = packed.track;
+        max_iterations              = packed.max_iterations;
+        minimum_photon_count        = packed.minimum_photon_count;
+        along_track_spread          = packed.along_track_spread;
+        minimum_window              = packed.minimum_window;
+        maximum_robust_dispersion   = packed.maximum_robust_dispersion;
+        extent_length               = packed.extent_length;
+        extent_step                 = packed.extent_step;
+        rqst_timeout                = packed.rqst_timeout;
+        node_timeout                = packed.node_timeout;
+        read_timeout                = packed.read_timeout;
+        phoreal                     = packed.phoreal;
+        partitions                  = packed.partitions;
+        priority                    = packed.priority;
+
+        /* Polygon */
+        int offset = sizeof(packed_t);
+        if((int64_t)offset + (int64_t)(packed.num_points * sizeof(MathLib::coord_t)) > (int64_t)size)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "packed parameters truncated in polygon: %u points", packed.num_points);
+        }
+        polygon.clear();
+        for(uint32_t p = 0; p < packed.num_points; p++)
+        {
+            MathLib::coord_t coord;
+            LocalLib::copy(&coord, &buffer[offset], sizeof(MathLib::coord_t));
+            polygon.add(coord);
+            offset += sizeof(MathLib::coord_t);
+        }
+
+        /* Ancillary Fields */
+        for(int l = 0; l < 2; l++)
+        {
+            int num_fields = (l == 0) ? packed.num_geo_fields : packed.num_ph_fields;
+            string_list_t** fields = (l == 0) ? &atl03_geo_fields : &atl03_ph_fields;
+
+            /* Replace Existing List */
+            if(*fields) delete *fields;
+            *fields = NULL;
+            if(num_fields < 0) continue;
+
+            string_list_t* field_list = new string_list_t;
+            *fields = field_list;
+
+            for(int i = 0; i < num_fields; i++)
+            {
+                const char* field = (const char*)&buffer[offset];
+                int len = 0;
+                while((offset + len) < size && field[len] != '\0') len++;
+                if((offset + len) >= size)
+                {
+                    throw RunTimeException(CRITICAL, RTE_ERROR, "packed parameters truncated in ancillary fields");
+                }
+                SafeString field_str("%s", field);
+                field_list->add(field_str);
+                offset += len + 1;
+            }
+        }
+    }
+    catch(const RunTimeException&)
+    {
+        delete [] buffer;
+        throw;
+    }
+
+    delete [] buffer;
+}
+
+/*----------------------------------------------------------------------------
+ * luaPack - :pack() --> base64 string of parsed parameters
+ *----------------------------------------------------------------------------*/
+int Icesat2Parms::luaPack (lua_State* L)
+{
+    Icesat2Parms* lua_obj = NULL;
+    try
+    {
+        lua_obj = (Icesat2Parms*)getLuaSelf(L, 1);
+    }
+    catch(const RunTimeException& e)
+    {
+        return luaL_error(L, "method invoked from invalid object: %s", __FUNCTION__);
+    }
+
+    char* packed_str = lua_obj->pack();
+    lua_pushstring(L, packed_str);
+    delete [] packed_str;
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * str2atl03cnf
  *----------------------------------------------------------------------------*/
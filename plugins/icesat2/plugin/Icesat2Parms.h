@@ -84,6 +84,7 @@ class Icesat2Parms: public LuaObject
         static const char* DISTANCE_IN_SEGMENTS;
         static const char* ATL03_GEO_FIELDS;
         static const char* ATL03_PH_FIELDS;
+        static const char* ATL03_ANC_PACKED;
         static const char* RQST_TIMEOUT;
         static const char* NODE_TIMEOUT;
         static const char* READ_TIMEOUT;
@@ -94,6 +95,9 @@ class Icesat2Parms: public LuaObject
         static const char* PHOREAL_USE_ABS_H;
         static const char* PHOREAL_WAVEFORM;
         static const char* PHOREAL_ABOVE;
+        static const char* PARTITIONS;
+        static const char* PRIORITY;
+        static const char* PACKED;
 
         static const int NUM_PAIR_TRACKS            = 2;
         static const int RPT_L                      = 0;
@@ -271,13 +275,64 @@ class Icesat2Parms: public LuaObject
         double                  extent_step;                    // resolution of the ATL06 extent (meters or segments if dist_in_seg is true)
         string_list_t*          atl03_geo_fields;               // list of geolocation and geophys_corr fields to associate with an extent
         string_list_t*          atl03_ph_fields;                // list of per-photon fields to associate with an extent
+        bool                    atl03_anc_packed;               // send all ancillary fields of an extent in one record
         int                     rqst_timeout;                   // total time in seconds for request to be processed
         int                     node_timeout;                   // time in seconds for a single node to work on a distributed request (used for proxied requests)
         int                     read_timeout;                   // time in seconds for a single read of an asset to take
         phoreal_t               phoreal;                        // phoreal algorithm settings
+        int                     partitions;                     // workers per track for subsetting (1 for sequential, 0 to size to the node)
+        int                     priority;                       // share of the node thread budget the request may take (ThreadBudget::priority_t)
 
     private:
 
+        /*--------------------------------------------------------------------
+         * Constants
+         *--------------------------------------------------------------------*/
+
+        static const uint32_t PACKED_MAGIC          = 0x50325349; // "IS2P"
+        static const uint32_t PACKED_VERSION        = 1;
+        static const int      MAX_PACKED_SIZE       = 0x4000000; // 64MB of base64
+
+        /*--------------------------------------------------------------------
+         * Types
+         *--------------------------------------------------------------------*/
+
+        /* Packed Parameters
+         *  fixed size settings followed by the polygon coordinates and then
+         *  the null terminated ancillary field names; only exchanged between
+         *  nodes running the same build */
+        typedef struct {
+            uint32_t                magic;
+            uint32_t                version;
+            surface_type_t          surface_type;
+            bool                    pass_invalid;
+            bool                    dist_in_seg;
+            bool                    compact;
+            bool                    atl03_anc_packed;
+            bool                    atl03_cnf[NUM_SIGNAL_CONF];
+            bool                    quality_ph[NUM_PHOTON_QUALITY];
+            bool                    atl08_class[NUM_ATL08_CLASSES];
+            bool                    stages[NUM_STAGES];
+            yapc_t                  yapc;
+            int                     track;
+            int                     max_iterations;
+            int                     minimum_photon_count;
+            double                  along_track_spread;
+            double                  minimum_window;
+            double                  maximum_robust_dispersion;
+            double                  extent_length;
+            double                  extent_step;
+            int                     rqst_timeout;
+            int                     node_timeout;
+            int                     read_timeout;
+            phoreal_t               phoreal;
+            int                     partitions;
+            int                     priority;
+            uint32_t                num_points;
+            int32_t                 num_geo_fields;     // -1 when not supplied
+            int32_t                 num_ph_fields;      // -1 when not supplied
+        } packed_t;
+
         /*--------------------------------------------------------------------
          * Methods
          *--------------------------------------------------------------------*/
@@ -298,6 +353,10 @@ class Icesat2Parms: public LuaObject
         void                    get_lua_yapc            (lua_State* L, int index, bool* provided);
         void                    get_lua_string_list     (lua_State* L, int index, string_list_t** string_list, bool* provided);
         void                    get_lua_phoreal         (lua_State* L, int index, bool* provided);
+        char*                   pack                    (void);
+        void                    unpack                  (const char* packed_str);
+
+        static int              luaPack                 (lua_State* L);
 };
 
 #endif  /* __icesat2_parms__ */
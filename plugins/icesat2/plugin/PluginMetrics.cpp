@@ -279,10 +279,7 @@ bool PluginMetrics::init (void)
         region_t* region = region2struct((regions_t)r);
 
         /* Build Polygon */
-        for(int p = 0; p < region->num_points; p++)
-        {
-            region->points[p] = MathLib::coord2point(region->coords[p], region->proj);
-        }
+        MathLib::coord2point(region->coords, region->points, region->num_points, region->proj);
 
         /* Register Metric */
         regionMetricIds[r] = EventLib::registerMetric(CATEGORY, EventLib::COUNTER, "%s.%s", region->name, REGION_METRIC);
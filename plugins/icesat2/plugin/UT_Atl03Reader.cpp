@@ -47,6 +47,7 @@ const char* UT_Atl03Reader::OBJECT_TYPE = "UT_Atl03Reader";
 
 const char* UT_Atl03Reader::LuaMetaName = "UT_Atl03Reader";
 const struct luaL_Reg UT_Atl03Reader::LuaMetaTable[] = {
+    {"yapctest",        luaYapcTest},
     {NULL,              NULL}
 };
 
@@ -89,3 +90,178 @@ UT_Atl03Reader::UT_Atl03Reader (lua_State* L):
 UT_Atl03Reader::~UT_Atl03Reader(void)
 {
 }
+
+/*----------------------------------------------------------------------------
+ * luaYapcTest - :yapctest([<num segments>], [<photons per segment>])
+ *
+ *  scores a synthetic dense track with the YAPC v3 kernel and with the
+ *  reference scalar implementation, checks the scores match, and reports
+ *  the time each took
+ *----------------------------------------------------------------------------*/
+int UT_Atl03Reader::luaYapcTest (lua_State* L)
+{
+    bool status = false;
+    double* ph_dist = NULL;
+    float* h_ph = NULL;
+    int32_t* segment_ph_cnt = NULL;
+    uint8_t* gt_kernel = NULL;
+    uint8_t* gt_reference = NULL;
+
+    try
+    {
+        /* Get Parameters */
+        int32_t num_segments = getLuaInteger(L, 2, true, 500);
+        int32_t photons_per_segment = getLuaInteger(L, 3, true, 400);
+        if(num_segments <= 0 || photons_per_segment <= 0)
+        {
+            throw RunTimeException(CRITICAL, RTE_ERROR, "invalid track size: %d x %d", num_segments, photons_per_segment);
+        }
+
+        /* Build Synthetic Track (20m segments, ground surface plus background) */
+        int32_t num_photons = num_segments * photons_per_segment;
+        ph_dist = new double [num_photons];
+        h_ph = new float [num_photons];
+        segment_ph_cnt = new int32_t [num_segments];
+        uint32_t seed = 0x5A5A5A5A;
+        int32_t ph_index = 0;
+        for(int32_t s = 0; s < num_segments; s++)
+        {
+            segment_ph_cnt[s] = photons_per_segment;
+            for(int32_t p = 0; p < photons_per_segment; p++)
+            {
+                seed = seed * 1103515245 + 12345;
+                double noise = (double)((seed >> 8) & 0xFFFF) / 65536.0;
+                ph_dist[ph_index] = (s * 20.0) + ((p * 20.0) / photons_per_segment);
+                if(p % 4 == 0)  h_ph[ph_index] = (float)(noise * 200.0); // background
+                else            h_ph[ph_index] = (float)(100.0 + (sin(ph_dist[ph_index] / 50.0) * 10.0) + noise);
+                ph_index++;
+            }
+        }
+
+        /* Score Track */
+        Icesat2Parms::yapc_t settings;
+        settings.score = 0;
+        settings.version = 3;
+        settings.knn = 0;
+        settings.min_knn = 5;
+        settings.win_h = 6.0;
+        settings.win_x = 15.0;
+        gt_kernel = new uint8_t [num_photons];
+        gt_reference = new uint8_t [num_photons];
+
+        int64_t start_time = TimeLib::gettimems();
+        Atl03Reader::YapcScore::yapcV3Score(ph_dist, h_ph, segment_ph_cnt, num_photons, 0, num_segments, 0, &settings, gt_kernel);
+        int64_t kernel_stop = TimeLib::gettimems();
+        yapcV3Reference(ph_dist, h_ph, segment_ph_cnt, num_photons, num_segments, &settings, gt_reference);
+        int64_t reference_stop = TimeLib::gettimems();
+
+        print2term("yapc v3 [%d photons]: kernel %.3lf, reference %.3lf seconds\n", num_photons,
+                    (double)(kernel_stop - start_time) / 1000.0, (double)(reference_stop - kernel_stop) / 1000.0);
+
+        /* Check Scores */
+        bool tests_passed = true;
+        for(int32_t i = 0; i < num_photons; i++)
+        {
+            if(gt_kernel[i] != gt_reference[i])
+            {
+                mlog(CRITICAL, "Failed yapc test at photon %d: %d != %d", i, gt_kernel[i], gt_reference[i]);
+                tests_passed = false;
+                break;
+            }
+        }
+
+        /* Set Status */
+        status = tests_passed;
+    }
+    catch(const RunTimeException& e)
+    {
+        mlog(e.level(), "Error executing test %s: %s", __FUNCTION__, e.what());
+    }
+
+    /* Clean Up */
+    delete [] ph_dist;
+    delete [] h_ph;
+    delete [] segment_ph_cnt;
+    delete [] gt_kernel;
+    delete [] gt_reference;
+
+    /* Return Status */
+    return returnLuaStatus(L, status);
+}
+
+/*----------------------------------------------------------------------------
+ * yapcV3Reference
+ *
+ *  scalar YAPC v3 scoring that rescans the window of every photon
+ *----------------------------------------------------------------------------*/
+void UT_Atl03Reader::yapcV3Reference (const double* ph_dist, const float* h_ph, const int32_t* segment_ph_cnt, int32_t num_photons,
+                                      int32_t num_segments, const Icesat2Parms::yapc_t* settings, uint8_t* gt)
+{
+    const double hWX = settings->win_x / 2; // meters
+    const double hWZ = settings->win_h / 2; // meters
+
+    int32_t ph_index = 0;
+    for(int segment_index = 0; segment_index < num_segments; segment_index++)
+    {
+        int32_t N = segment_ph_cnt[segment_index];
+        double* ph_weights = new double[N];
+        int max_knn = settings->min_knn;
+        int32_t start_ph_index = ph_index;
+
+        for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
+        {
+            List<double> proximities;
+
+            /* Nearest Neighbors to Left */
+            int32_t neighbor_index = ph_index - 1;
+            while(neighbor_index >= 0)
+            {
+                double x_dist = ph_dist[ph_index] - ph_dist[neighbor_index];
+                if(x_dist <= hWX)
+                {
+                    double proximity = abs(h_ph[ph_index] - h_ph[neighbor_index]);
+                    if(proximity <= hWZ) proximities.add(proximity);
+                }
+                if(x_dist >= (hWX + 1.0)) break;
+                neighbor_index--;
+            }
+
+            /* Nearest Neighbors to Right */
+            neighbor_index = ph_index + 1;
+            while(neighbor_index < num_photons)
+            {
+                double x_dist = ph_dist[neighbor_index] - ph_dist[ph_index];
+                if(x_dist <= hWX)
+                {
+                    double proximity = abs(h_ph[ph_index] - h_ph[neighbor_index]);
+                    if(proximity <= hWZ) proximities.add(proximity);
+                }
+                if(x_dist >= (hWX + 1.0)) break;
+                neighbor_index++;
+            }
+
+            /* Sum of Weights of k Nearest */
+            proximities.sort();
+            double n = sqrt(proximities.length());
+            int knn = MAX(n, settings->min_knn);
+            if(knn > max_knn) max_knn = knn;
+            int num_nearest_neighbors = MIN(knn, proximities.length());
+            double weight_sum = 0.0;
+            for(int i = 0; i < num_nearest_neighbors; i++)
+            {
+                weight_sum += hWZ - proximities[i];
+            }
+            ph_weights[ph_in_seg_index] = weight_sum;
+            ph_index++;
+        }
+
+        for(int32_t ph_in_seg_index = 0; ph_in_seg_index < N; ph_in_seg_index++)
+        {
+            double Wt = ph_weights[ph_in_seg_index] / (hWZ * max_knn);
+            gt[start_ph_index] = (uint8_t)(MIN(Wt * 255, 255));
+            start_ph_index++;
+        }
+
+        delete [] ph_weights;
+    }
+}
@@ -38,6 +38,7 @@
 
 #include "OsApi.h"
 #include "LuaObject.h"
+#include "Icesat2Parms.h"
 
 /******************************************************************************
  * ATL03 READER UNIT TEST CLASS
@@ -73,6 +74,10 @@ class UT_Atl03Reader: public LuaObject
                         ~UT_Atl03Reader         (void);
 
         static int      luaTriangleTest         (lua_State* L);
+        static int      luaYapcTest             (lua_State* L);
+
+        static void     yapcV3Reference         (const double* ph_dist, const float* h_ph, const int32_t* segment_ph_cnt, int32_t num_photons,
+                                                 int32_t num_segments, const Icesat2Parms::yapc_t* settings, uint8_t* gt);
 };
 
 #endif  /* __ut_atl03reader__ */
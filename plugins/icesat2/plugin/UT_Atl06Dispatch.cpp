@@ -108,6 +108,12 @@ int UT_Atl06Dispatch::luaLsfTest (lua_State* L)
     extent->photons[1].distance = 2.0;
     extent->photons[2].distance = 3.0;
     extent->photons[3].distance = 4.0;
+    extent->photon_count[Icesat2Parms::RPT_L] = num_photons;
+
+    /* Transpose Extent into Photon Columns */
+    Atl03Reader::extent_t attributes;
+    Atl03Reader::photon_columns_t columns;
+    uint8_t* buffer = Atl03Reader::getExtent(record, &attributes, &columns);
 
     try
     {
@@ -115,12 +121,12 @@ int UT_Atl06Dispatch::luaLsfTest (lua_State* L)
         double tolerance = 0.0000001;
 
         /* Test 1 */
-        extent->photons[0].height = 2.0;
-        extent->photons[1].height = 4.0;
-        extent->photons[2].height = 6.0;
-        extent->photons[3].height = 8.0;
+        columns.height[0] = 2.0;
+        columns.height[1] = 4.0;
+        columns.height[2] = 6.0;
+        columns.height[3] = 8.0;
         Atl06Dispatch::point_t v1[num_photons] = { {0, 0.0}, {1, 0.0}, {2, 0.0}, {3, 0.0} };
-        Atl06Dispatch::lsf_t fit1 = Atl06Dispatch::lsf(extent, v1, num_photons, false);
+        Atl06Dispatch::lsf_t fit1 = Atl06Dispatch::lsf(&columns, v1, num_photons, false);
         if(fit1.height != 0.0 || fabs(fit1.slope - 2.0) > tolerance)
         {
             mlog(CRITICAL, "Failed LSF test01: %lf, %lf", fit1.height, fit1.slope);
@@ -128,12 +134,12 @@ int UT_Atl06Dispatch::luaLsfTest (lua_State* L)
         }
 
         /* Test 2 */
-        extent->photons[0].height = 4.0;
-        extent->photons[1].height = 5.0;
-        extent->photons[2].height = 6.0;
-        extent->photons[3].height = 7.0;
+        columns.height[0] = 4.0;
+        columns.height[1] = 5.0;
+        columns.height[2] = 6.0;
+        columns.height[3] = 7.0;
         Atl06Dispatch::point_t v2[num_photons] = { {0, 0.0}, {1, 0.0}, {2, 0.0}, {3, 0.0} };
-        Atl06Dispatch::lsf_t fit2 = Atl06Dispatch::lsf(extent, v2, num_photons, false);
+        Atl06Dispatch::lsf_t fit2 = Atl06Dispatch::lsf(&columns, v2, num_photons, false);
         if(fabs(fit2.height - 3.0) > tolerance || fabs(fit2.slope - 1.0) > tolerance)
         {
             mlog(CRITICAL, "Failed LSF test02: %lf, %lf", fit2.height, fit2.slope);
@@ -149,6 +155,7 @@ int UT_Atl06Dispatch::luaLsfTest (lua_State* L)
     }
 
     /* Clean Up Extent */
+    delete [] buffer;
     delete record;
 
     /* Return Status */
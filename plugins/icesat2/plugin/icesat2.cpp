@@ -69,6 +69,7 @@ int icesat2_open (lua_State *L)
     static const struct luaL_Reg icesat2_functions[] = {
         {"parms",               Icesat2Parms::luaCreate},
         {"atl03",               Atl03Reader::luaCreate},
+        {"sharedscan",          Atl03Reader::luaSharedScan},
         {"atl03indexer",        Atl03Indexer::luaCreate},
         {"atl06",               Atl06Dispatch::luaCreate},
         {"atl08",               Atl08Dispatch::luaCreate},
@@ -14,6 +14,9 @@ runner.check(atl06_dispatch:lsftest(), "Failed lsftest")
 print('\n------------------\nTest02\n------------------')
 runner.check(atl06_dispatch:sorttest(), "Failed sorttest")
 
+print('\n------------------\nTest03\n------------------')
+runner.check(atl03_reader:yapctest(), "Failed yapctest")
+
 -- Clean Up --
 
 -- Report Results --
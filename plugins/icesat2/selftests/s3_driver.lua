@@ -32,6 +32,19 @@ local response, status = aws.s3read(test_bucket, string.format("%s/%s", test_pat
 runner.check(status == true, "failed to read file: "..test_file)
 runner.check(response == "Shakespeare")
 
+-- TEST #4: vectored range read through asynchronous engine
+local ranges = {{11, 261}, {64, 0}, {4096, 0x100000}, {128, fsize - 128}}
+local parts, status = aws.s3readv(test_bucket, string.format("%s/%s", test_path, test_file), ranges, nil, nil)
+runner.check(status == true, "failed to read ranges of file: "..test_file)
+if status then
+    runner.check(#parts == #ranges, "incorrect number of ranges returned")
+    runner.check(parts[1] == "Shakespeare")
+    for i = 2, #ranges do
+        local expected = aws.s3read(test_bucket, string.format("%s/%s", test_path, test_file), ranges[i][1], ranges[i][2], nil, nil)
+        runner.check(parts[i] == expected, string.format("range %d does not match synchronous read", i))
+    end
+end
+
 -- Clean Up --
 
 os.remove(test_file)
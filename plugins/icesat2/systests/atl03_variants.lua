@@ -0,0 +1,79 @@
+--
+-- Measures how long the atl03 reader takes to subset a granule under each of
+-- the photon selection variants (see Atl03Reader::selectExtent) and under each
+-- output format.  Every configuration is read once to warm the h5 cache and
+-- then timed over the given number of runs, so the timings are dominated by
+-- photon selection and record generation rather than by the reads.
+--
+-- Usage: sliderule atl03_variants.lua <directory> <atl03 granule> [<runs>]
+--
+--  e.g. sliderule atl03_variants.lua /data/ATLAS ATL03_20181019065445_03150111_005_01.h5 5
+--
+-- The matching ATL08 granule must sit in the same directory.  Prints a json
+-- object with the mean seconds and extents sent for each configuration.
+--
+
+local json = require("json")
+
+-- Parse Arguments --
+local directory = arg[1]
+local granule   = arg[2]
+local num_runs  = tonumber(arg[3]) or 3
+if not directory or not granule then
+    print("usage: sliderule atl03_variants.lua <directory> <atl03 granule> [<runs>]")
+    sys.quit()
+    return
+end
+
+-- Configurations --
+local base = {cnf=icesat2.CNF_SURFACE_HIGH, ats=10.0, cnt=10, len=40.0, res=20.0}
+local function with(extra)
+    local parms = {}
+    for k,v in pairs(base) do parms[k] = v end
+    for k,v in pairs(extra) do parms[k] = v end
+    return parms
+end
+local configs = {
+    {name="base",           parms=base},
+    {name="segments",       parms=with({dist_in_seg=true, len=2, res=1})},
+    {name="atl08",          parms=with({atl08_class={"atl08_ground", "atl08_canopy", "atl08_top_of_canopy"}})},
+    {name="yapc",           parms=with({yapc={score=0}})},
+    {name="phoreal",        parms=with({atl08_class={"atl08_ground", "atl08_canopy", "atl08_top_of_canopy"}, phoreal={}})},
+    {name="base_flatten",   parms=base, flatten=true},
+    {name="base_columnar",  parms=base, columnar=true},
+}
+
+-- Run a Configuration Once --
+local asset = core.asset("atl03local", "file", directory, "empty.index")
+local function run(config)
+    local rspq = "variantq"
+    local sink = core.dispatcher(rspq, 1) -- discards records so that the reader sees a subscriber
+    sink:run()
+    local parms = icesat2.parms(config.parms)
+    local start = time.latch()
+    local reader = icesat2.atl03(asset, granule, rspq, parms, true, config.flatten or false, config.columnar or false)
+    while not reader:waiton(1000) do end
+    local elapsed = time.latch() - start
+    local sent = reader:stats(false).sent
+    reader:destroy()
+    sink:destroy()
+    return elapsed, sent
+end
+
+-- Time Configurations --
+local results = {}
+for _,config in ipairs(configs) do
+    run(config) -- warm cache
+    local total = 0.0
+    local sent = 0
+    for _ = 1, num_runs do
+        local elapsed, extents = run(config)
+        total = total + elapsed
+        sent = extents
+    end
+    table.insert(results, {name=config.name, seconds=total / num_runs, extents=sent})
+end
+
+print(json.encode({granule=granule, runs=num_runs, results=results}))
+
+sys.quit()
@@ -0,0 +1,119 @@
+--
+-- Measures end-to-end throughput of the atl06p and atl03sp processing pipelines
+-- against recorded granules served by the replay driver, which imposes a fixed
+-- latency and bandwidth on every read in place of S3.  Each thread count runs
+-- that many granule pipelines concurrently, which is how the proxy endpoints
+-- fan out over granules; the granules listed are reused to fill the pipelines.
+--
+-- Usage: sliderule replay_throughput.lua <directory> <atl06|atl03> <latency ms> <bandwidth MB/s> <threads,...> <granule> [<granule> ...]
+--
+--  e.g. sliderule replay_throughput.lua /data/ATLAS atl06 50 80 1,4,16 ATL03_20181019065445_03150111_005_01.h5
+--
+-- Prints a json object with one entry per thread count containing records/s,
+-- bytes/s read through the driver, and the time spent in each stage
+--
+
+local json = require("json")
+
+-- Parse Arguments --
+local directory = arg[1]
+local mode      = arg[2] or "atl06"
+local latency   = tonumber(arg[3]) or 0
+local bandwidth = tonumber(arg[4]) or 0
+local threads   = {}
+for t in string.gmatch(arg[5] or "1", "%d+") do
+    table.insert(threads, tonumber(t))
+end
+local granules = {}
+for i = 6, #arg do
+    table.insert(granules, arg[i])
+end
+if not directory or #granules == 0 or (mode ~= "atl06" and mode ~= "atl03") then
+    print("usage: sliderule replay_throughput.lua <directory> <atl06|atl03> <latency ms> <bandwidth MB/s> <threads,...> <granule> [<granule> ...]")
+    sys.quit()
+    return
+end
+
+-- Configure Replay --
+core.replay(latency, bandwidth)
+h5.cache(0) -- granules reused across pipelines are read through the driver each time
+local asset = core.asset("replay", "replay", directory, "empty.index")
+local parms = icesat2.parms({cnf=icesat2.CNF_SURFACE_HIGH, ats=10.0, cnt=10, len=40.0, res=20.0})
+
+-- Wait on a List of Objects --
+local function waitall(objects)
+    for _,obj in ipairs(objects) do
+        while not obj:waiton(1000) do end
+    end
+end
+
+-- Run Pipelines --
+local results = {}
+for _,num_pipelines in ipairs(threads) do
+    local rspq = string.format("replayq-%d", num_pipelines)
+    local sink = core.dispatcher(rspq, 1) -- discards records so that publishers see a subscriber
+    sink:run()
+
+    core.replaystats(true)
+    local readers = {}
+    local dispatchers = {}
+    local algorithms = {}
+    local start = time.latch()
+
+    for p = 1, num_pipelines do
+        local granule = granules[((p - 1) % #granules) + 1]
+        if mode == "atl06" then
+            local recq = string.format("%s-atl03-%d", rspq, p)
+            local disp = core.dispatcher(recq)
+            local algo = icesat2.atl06(rspq, parms)
+            disp:attach(algo, "atl03rec.columnar")
+            disp:run()
+            table.insert(dispatchers, disp)
+            table.insert(algorithms, algo)
+            table.insert(readers, icesat2.atl03(asset, granule, recq, parms, true, false, true))
+        else
+            table.insert(readers, icesat2.atl03(asset, granule, rspq, parms, false))
+        end
+    end
+
+    waitall(readers)
+    local read_time = time.latch() - start
+    waitall(dispatchers)
+    local total_time = time.latch() - start
+
+    -- Collect Statistics --
+    local records = 0
+    local segments = 0
+    for _,reader in ipairs(readers) do
+        local stats = reader:stats(false)
+        segments = segments + stats.read
+        if mode == "atl03" then records = records + stats.sent end
+    end
+    for _,algo in ipairs(algorithms) do
+        records = records + algo:stats(false).posted
+    end
+    local io = core.replaystats(true)
+
+    table.insert(results, {
+        pipelines = num_pipelines,
+        records = records,
+        segments = segments,
+        bytes = io.bytes,
+        requests = io.requests,
+        records_per_sec = records / total_time,
+        bytes_per_sec = io.bytes / total_time,
+        read_time = read_time,
+        dispatch_time = total_time - read_time,
+        injected_delay = io.delay,
+        total_time = total_time
+    })
+
+    -- Clean Up --
+    for _,obj in ipairs(readers) do obj:destroy() end
+    for _,obj in ipairs(dispatchers) do obj:destroy() end
+    sink:destroy()
+end
+
+print(json.encode({mode=mode, latency_ms=latency, bandwidth_mbps=bandwidth, granules=granules, results=results}))
+
+sys.quit()
@@ -43,6 +43,15 @@ local event_format              = global.eval(cfgtbl["event_format"]) or core.FM
 local event_level               = global.eval(cfgtbl["event_level"]) or core.INFO
 local app_port                  = cfgtbl["app_port"] or 9081
 local probe_port                = cfgtbl["probe_port"] or 10081
+local app_server_threads        = cfgtbl["app_server_threads"] or 1 -- more than one shards connections with SO_REUSEPORT
+local app_server_zerocopy       = cfgtbl["app_server_zerocopy"] -- nil is no MSG_ZEROCOPY sends, otherwise minimum chunk size
+local app_endpoint_workers      = cfgtbl["app_endpoint_workers"] -- nil is default number of persistent request threads
+local app_endpoint_engines      = cfgtbl["app_endpoint_engines"] -- nil is default number of pre-warmed lua engines
+local app_stream_limit          = cfgtbl["app_stream_limit"] -- nil is no limit on streaming requests run at once
+local app_stream_queue          = cfgtbl["app_stream_queue"] -- nil is default queue depth per endpoint and user
+local app_stream_ceiling        = cfgtbl["app_stream_ceiling"] -- nil is no limit on bytes a streamed response holds unsent
+local app_stream_spill          = cfgtbl["app_stream_spill"] -- directory streamed responses spill to past the ceiling, nil waits on the client instead
+local app_stream_scheduler      = cfgtbl["app_stream_scheduler"] -- nil runs each streaming script on its own thread, otherwise threads shared by suspended scripts
 local authenticate_to_nsidc     = cfgtbl["authenticate_to_nsidc"] -- nil is false
 local authenticate_to_ornldaac  = cfgtbl["authenticate_to_ornldaac"] -- nil is false
 local register_as_service       = cfgtbl["register_as_service"] -- nil is false
@@ -55,6 +64,15 @@ local orchestrator_url          = cfgtbl["orchestrator"] or os.getenv("ORCHESTRA
 local org_name                  = cfgtbl["cluster"] or os.getenv("CLUSTER")
 local ps_url                    = cfgtbl["provisioning_system"] or os.getenv("PROVISIONING_SYSTEM")
 local ps_auth                   = cfgtbl["authenticate_to_ps"] -- nil is false
+local h5_meta_file              = cfgtbl["h5_meta_file"] -- nil is no persisted h5coro metadata
+local s3_coalesce_window        = cfgtbl["s3_coalesce_window"] -- nil is no coalescing of s3 reads
+local s3_coalesce_gap           = cfgtbl["s3_coalesce_gap"] -- nil is driver default
+local s3_hedge_percentile       = cfgtbl["s3_hedge_percentile"] -- nil is driver default, 0 is no hedging of s3 reads
+local s3_hedge_budget           = cfgtbl["s3_hedge_budget"] -- nil is driver default
+local s3_part_size              = cfgtbl["s3_part_size"] -- nil is driver default size of multipart upload parts
+local s3_upload_concurrency     = cfgtbl["s3_upload_concurrency"] -- nil is driver default
+local asset_index_background    = cfgtbl["asset_index_background"] -- nil is load asset indexes before continuing startup
+local proxy_cache_size          = cfgtbl["proxy_cache_size"] -- nil is no caching or coalescing of identical proxied requests
 
 --------------------------------------------------
 -- System Configuration
@@ -76,7 +94,27 @@ dispatcher:attach(monitor, "eventrec")
 dispatcher:run()
 
 -- Configure Assets --
-local assets = asset.loaddir(asset_directory, true)
+local assets = asset.loaddir(asset_directory, true, asset_index_background)
+
+-- Restore H5Coro Metadata --
+if __h5__ and h5_meta_file then
+    h5.metaload(h5_meta_file)
+end
+
+-- Configure S3 Request Coalescing --
+if __aws__ and s3_coalesce_window then
+    aws.s3coalesce(s3_coalesce_window, s3_coalesce_gap)
+end
+
+-- Configure S3 Request Hedging --
+if __aws__ and s3_hedge_percentile then
+    aws.s3hedge(s3_hedge_percentile, s3_hedge_budget)
+end
+
+-- Configure S3 Multipart Uploads --
+if __aws__ and s3_part_size then
+    aws.s3multipart(s3_part_size, s3_upload_concurrency)
+end
 
 -- Run IAM Role Authentication Script -
 local role_auth_script = core.script("iam_role_auth"):name("RoleAuthScript")
@@ -92,6 +130,11 @@ end
 
 -- Initialize Orchestrator --
 netsvc.orchurl(orchestrator_url)
+
+-- Configure Proxy Result Cache --
+if proxy_cache_size then
+    netsvc.cache(proxy_cache_size)
+end
 if register_as_service then
     local service_script = core.script("service_registry", "http://"..sys.ipv4()..":"..tostring(app_port)):name("ServiceScript")
 end
@@ -101,7 +144,7 @@ end
 --------------------------------------------------
 
 -- Configure Application Endpoints --
-local source_endpoint = core.endpoint(normal_mem_thresh, stream_mem_thresh):name("SourceEndpoint")
+local source_endpoint = core.endpoint(normal_mem_thresh, stream_mem_thresh, core.INFO, app_endpoint_workers, app_endpoint_engines):name("SourceEndpoint")
 for _,script in ipairs(available_scripts()) do
     local s = script:find(".lua")
     if s then
@@ -109,6 +152,15 @@ for _,script in ipairs(available_scripts()) do
         source_endpoint:metric(metric_name)
     end
 end
+if app_stream_limit then
+    source_endpoint:admission(app_stream_limit, app_stream_queue)
+end
+if app_stream_ceiling then
+    source_endpoint:ceiling(app_stream_ceiling, app_stream_spill)
+end
+if app_stream_scheduler then
+    core.scheduler(app_stream_scheduler)
+end
 
 -- Configure Provisioning System Authentication --
 netsvc.psurl(ps_url)
@@ -118,10 +170,20 @@ if ps_auth then
     source_endpoint:auth(authenticator)
 end
 
+-- Wait for Asset Indexes Loading in Background --
+if asset_index_background then
+    for _,a in pairs(assets) do
+        local _,_,_,index = a:info()
+        if index then a:waiton() end
+    end
+end
+
 -- Run Application HTTP Server --
-local app_server = core.httpd(app_port):name("AppServer")
+local app_server = core.httpd(app_port, nil, nil, app_server_threads):name("AppServer")
 app_server:metric() -- register server metrics
+if app_server_zerocopy then app_server:zerocopy(app_server_zerocopy) end
 app_server:attach(source_endpoint, "/source")
+app_server:attach(core.prometheus(1000):name("MetricEndpoint"), "/metrics") -- cached for a second across scrapers
 
 --------------------------------------------------
 -- Probe Server (internal)
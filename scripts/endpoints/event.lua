@@ -5,7 +5,7 @@
 --              {
 --                  "type":     <core.LOG | core.TRACE | core.METRIC>
 --                  "level":    "<event level string>" -OR- <event level number>
---                  "format":   <core.FMT_TEXT | core.FMT_JSON>
+--                  "format":   <core.FMT_TEXT | core.FMT_JSON | core.FMT_BINARY>
 --                  "duration": <seconds to hold connection open | 0 for indefinite>
 --              }
 --
@@ -12,7 +12,8 @@
 --                          "valtype":  <RecordObject::valType_t>,
 --                          "col":      [<column number>],
 --                          "startrow": [<row number>],
---                          "numrows":  [<total number of rows to read>]
+--                          "numrows":  [<total number of rows to read>],
+--                          "shards":   [<number of parts to read concurrently>]
 --                      },
 --                      ...
 --                  ]
@@ -25,6 +26,9 @@
 -- NOTES:       1. The arg[1] input is a json object provided by caller
 --              2. The rspq is the system provided output queue name string
 --              3. The output is a raw binary blob containing serialized 'h5dataset' RecordObjects
+--              4. A dataset read with shards > 1 is split on chunk boundaries and returned as
+--                 multiple records, in completion order; each record's startrow and numrows
+--                 fields locate its part within the dataset
 --
 
 local json = require("json")
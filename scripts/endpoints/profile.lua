@@ -0,0 +1,25 @@
+--
+-- ENDPOINT:    /source/profile
+--
+-- INPUT:       arg[1] -
+--              {
+--                  "duration":     <seconds to sample, defaults to 10>
+--                  "frequency":    <samples per second of cpu time, defaults to 99>
+--              }
+--
+-- OUTPUT:      cpu profile of the node as folded stacks (one line per unique
+--              stack, frames from root to leaf separated by semicolons, followed
+--              by the number of samples), ready for flamegraph tools
+--
+
+local json = require("json")
+local parm = json.decode(arg[1])
+local duration = parm["duration"] or 10
+local frequency = parm["frequency"] or 99
+
+local folded = sys.profile(duration, frequency)
+if not folded then
+    return json.encode({error="profile already in progress"})
+end
+
+return folded
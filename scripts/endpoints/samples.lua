@@ -9,10 +9,19 @@
 --                  "coordinates": [
 --                      [<longitude>, <latitude>],
 --                      [<longitude>, <latitude>]...
---                  ]
+--                  ] | "<parquet or arrow file path, or s3://bucket/key>"
+--                  "columns": [<longitude column>, <latitude column>]
+--                  "region": <aws region of s3 coordinates>
+--                  "asset": <asset providing credentials for s3 coordinates>
+--                  "columnar": <true|false>
 --              }
 --
--- OUTPUT:      samples
+-- OUTPUT:      samples (one list of samples per coordinate, or a table of
+--              columns with one row per sample when columnar is requested)
+--
+-- NOTES:       Coordinates given by reference are read directly into arrays
+--              (see arrow.coordinates) and are not limited by the size of
+--              the request; columnar output is recommended for them
 --
 
 local json = require("json")
@@ -20,20 +29,50 @@ local json = require("json")
 -- Request Parameters --
 local rqst = json.decode(arg[1])
 local coord = rqst["coordinates"]
+local num_points = 0
+if type(coord) == "string" then
+    if not __arrow__ then
+        return json.encode({samples={}})
+    end
+    local columns = rqst["columns"] or {}
+    coord, num_points = arrow.coordinates(coord, columns[1], columns[2], rqst["region"], rqst["asset"])
+    if not coord then
+        return json.encode({samples={}})
+    end
+else
+    num_points = #coord
+end
 
 -- Get Samples --
 local dem = geo.raster(geo.parms(rqst[geo.PARMS]))
 
+-- Sample All Coordinates --
+local columns, status = dem:samples(coord)
+if not status then
+    return json.encode({samples={}})
+elseif rqst["columnar"] then
+    return json.encode({samples=columns})
+end
+
 -- Build Table --
+local point_samples = {}
+local names = {"value", "flags", "count", "min", "max", "mean", "median", "stdev", "mad"}
+for row, point in ipairs(columns.point) do
+    local sample = {file=columns.files[columns.file[row]]}
+    for _, name in ipairs(names) do
+        if columns[name] then
+            sample[name] = columns[name][row]
+        end
+    end
+    point_samples[point] = point_samples[point] or {}
+    table.insert(point_samples[point], sample)
+end
 local samples = {}
-for _, position in ipairs(coord) do
-    local lon = position[1]
-    local lat = position[2]
-    local sample, status = dem:sample(lon, lat)
-    if status then
-        table.insert(samples, sample)
+for point = 1, num_points do
+    if point_samples[point] then
+        table.insert(samples, point_samples[point])
     end
 end
 
 -- Return Response
-return json.encode({samples=samples})
\ No newline at end of file
+return json.encode({samples=samples})
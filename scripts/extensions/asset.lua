@@ -47,39 +47,37 @@ end
 --
 --  Loads resource for each resource listed in the asset index file.
 --
---  file: name of .csv file with the following header row
+--  file: name of .csv file with the following header row, or a snapshot of an
+--        index previously written by asset:saveindex(file)
 --      resource,   t0, t1,     lat0, lat1, lon0, lon1,     [attr1, attr2, ..., attrN]
 --
 --  quiet: boolean whether to print a message for each asset loaded [optional]
+--
+--  background: boolean whether to load the index in a separate thread; use
+--              asset:waiton() to wait for the load to complete [optional]
 --------------------------------------------------------------------------------------
-local function _loadindex(asset, file, quiet)
+local function _loadindex(asset, file, quiet, background)
 
-    -- try to open index file
-    local raw_index = csv.open(file, {header=true})
-    if not raw_index then
+    -- look for index local to calling script if file not found
+    local f = io.open(file, "r")
+    if f then
+        f:close()
+    else
         if not quiet then
             print(string.format("Attempting to find index file %s", file))
         end
-        -- look for index local to calling script (if not provided)
         local info = debug.getinfo(3,'S');
         local offset = string.find(info.source, "/[^/]*$")
         local root_path = info.source:sub(2,offset)
-        local new_file = root_path..file
-        raw_index = csv.open(new_file, {header=true})
+        file = root_path..file
     end
 
-    -- check if index file found and opened
-    if not raw_index then
-        if not quiet then
-            print(string.format("Unable to open index file %s", file))
-        end
-        return false
-    end
-
-    -- load resource for each entry in index
-    for fields in raw_index:lines() do
-        loadresource(asset, fields["name"], fields, quiet)
+    -- load index natively
+    local status = asset:loadindex(file, background)
+    if not status and not quiet then
+        print(string.format("Unable to open index file %s", file))
     end
+    return status
 
 end
 
@@ -92,8 +90,11 @@ end
 --      asset,      format,     path,       index,      region,     endpoint
 --
 --  quiet: boolean whether to print a message for each asset loaded [optional]
+--
+--  background: boolean whether to load the index of each asset in its own thread;
+--              use asset:waiton() on each returned asset to wait for its index [optional]
 --------------------------------------------------------------------------------------
-local function loaddir(file, quiet)
+local function loaddir(file, quiet, background)
 
     local assets = {}
 
@@ -136,9 +137,9 @@ local function loaddir(file, quiet)
         end
         if v["index"] then
             if v["index"]:sub(1,1) == "/" then -- absolute path
-                _loadindex(assets[k], v["index"], quiet)
+                _loadindex(assets[k], v["index"], quiet, background)
             else -- relative path
-                _loadindex(assets[k], path_prefix..v["index"], quiet)
+                _loadindex(assets[k], path_prefix..v["index"], quiet, background)
             end
         end
     end
@@ -379,4 +379,16 @@ function json.decode(str)
 end
 
 
+
+-------------------------------------------------------------------------------
+-- Native Codec
+-------------------------------------------------------------------------------
+
+-- the netsvc package provides a compiled codec that follows the same rules
+if netsvc and netsvc.jsonencode and netsvc.jsondecode then
+  json.encode = netsvc.jsonencode
+  json.decode = netsvc.jsondecode
+end
+
+
 return json
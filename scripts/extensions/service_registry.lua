@@ -2,6 +2,7 @@ local default_name = "http://"..sys.ipv4()..":9081"
 local name = arg[1] or default_name
 local service = "sliderule"
 local lifetime = 120 -- seconds
+local report_interval = 15 -- seconds between registrations, each reports the current load
 local registration_state = false
 
 while sys.alive() do
@@ -15,7 +16,7 @@ while sys.alive() do
             registration_state = true
 
             -- wait until next registration time
-            local next_registration_time = time.gps() + ((lifetime / 2) * 1000)
+            local next_registration_time = time.gps() + (math.min(report_interval, lifetime / 2) * 1000)
             while sys.alive() and time.gps() < next_registration_time do
                 sys.wait(5)
             end
@@ -103,6 +103,68 @@ local r5 = i8:query({lat0=-83.2, lon0=45.0, lat1=-73.2, lon1=55.0})
 local e5 = { 1, 4, 7, 10, 13, 14, 17, 18, 21, 22, 25, 26, 29, 30, 33, 34, 37, 38, 41, 42, 45}
 check_query(r5, e5)
 
+print('\n------------------\nTest09: Query Packed Indexes\n------------------\n')
+local i9 = core.intervalindex(a2, "t0", "t1", nil, true):name("packedintervalindex"):display()
+check_query(i9:query({t0=5.0, t1=17.0}), e4)
+local o9 = core.intervalindex(a6, "t0", "t1", 2, true):name("packedoverlappingindex")
+check_query(o9:query({t0=6.0, t1=10.0}), e6)
+local p9 = core.pointindex(a2, "foot", nil, true):name("packedpointindex")
+check_query(p9:query({foot=15}), { 1, 4, 7, 10, 13, 14, 17, 18, 21, 22, 25, 26, 29, 30, 33, 34, 37, 38, 41, 42, 45, 46})
+local s9 = core.spatialindex(a8, core.SOUTH_POLAR, nil, true):name("packedspatialindex")
+check_query(s9:query({lat0=-83.2, lon0=45.0, lat1=-73.2, lon1=55.0}), e5)
+runner.check(not p9:add({foot=15}), "Packed index should not accept additions")
+
+print('\n------------------\nTest10: Save and Load Index Snapshots\n------------------\n')
+local snapshot = os.tmpname()
+runner.check(i8:save(snapshot), "Failed to save spatial index snapshot")
+local s10 = core.spatialindex(a8, core.SOUTH_POLAR, nil, true):name("loadedspatialindex")
+runner.check(s10:load(snapshot), "Failed to load spatial index snapshot")
+check_query(s10:query({lat0=-83.2, lon0=45.0, lat1=-73.2, lon1=55.0}), e5)
+runner.check(not i9:load(snapshot), "Snapshot loaded into wrong index type")
+runner.check(i9:save(snapshot), "Failed to save interval index snapshot")
+local i10 = core.intervalindex(a2, "t0", "t1")
+runner.check(i10:load(snapshot), "Failed to load interval index snapshot")
+check_query(i10:query({t0=5.0, t1=17.0}), e4)
+os.remove(snapshot)
+
+print('\n------------------\nTest11: Batch Query\n------------------\n')
+local function check_batch(index, qspans, exps)
+    local ids, offsets = index:querybatch(qspans)
+    runner.check(ids ~= nil and offsets ~= nil, "Failed to batch query")
+    runner.compare(#offsets, #qspans + 1)
+    for i, exp in ipairs(exps) do
+        local names = {}
+        for j = offsets[i] + 1, offsets[i + 1] do
+            table.insert(names, tostring(ids[j] + 1)) -- dataset1 resource names are 1-based positions
+        end
+        check_query(names, exp)
+    end
+end
+check_batch(i3, {{t0=5.0, t1=17.0}, {t0=5.0, t1=17.0}, {t0=1000.0, t1=1001.0}}, {e4, e4, {}})
+check_batch(i9, {{t0=5.0, t1=17.0}, {t0=1000.0, t1=1001.0}}, {e4, {}})
+local ids11, offsets11 = i3:querybatch({{t0=1000.0, t1=1001.0}})
+runner.compare(#ids11, 0)
+runner.compare(offsets11[2], 0)
+
+print('\n------------------\nTest12: Polygon Query\n------------------\n')
+local poly12 = {{lat=-83.2, lon=45.0}, {lat=-73.2, lon=45.0}, {lat=-73.2, lon=55.0}, {lat=-83.2, lon=55.0}, {lat=-83.2, lon=45.0}}
+check_query(i8:querypoly(poly12), e5)
+check_query(s9:querypoly(poly12), e5)
+local box12 = i8:query({lat0=-83.2, lon0=45.0, lat1=-73.2, lon1=55.0})
+runner.check(#i8:querypoly(poly12) <= #box12, "Polygon query returned more than its bounding span")
+
+print('\n------------------\nTest13: Asset Index Snapshot Loaded in Background\n------------------\n')
+local snapshot13 = os.tmpname()
+runner.check(a2:saveindex(snapshot13), "Failed to save asset index snapshot")
+local a13 = core.asset("dataset1-snapshot", "file", "/data/1", snapshot13)
+runner.check(a13:loadindex(snapshot13, true), "Failed to start background load of asset index snapshot")
+runner.check(a13:waiton(10000), "Failed to complete background load of asset index snapshot")
+local i13 = core.intervalindex(a13, "t0", "t1"):name("snapshotindex")
+check_query(i13:query({t0=5.0, t1=17.0}), e4)
+local f13 = core.pointindex(a13, "foot"):name("snapshotpointindex")
+check_query(f13:query({foot=15}), e5)
+os.remove(snapshot13)
+
 -- Clean Up --
 
 -- Report Results --
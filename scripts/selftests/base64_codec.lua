@@ -0,0 +1,50 @@
+local runner = require("test_executive")
+
+-- Base64 Codec Unit Test and Throughput --
+
+-- Known Vectors (RFC 4648) --
+
+local vectors = {
+    {"f", "Zg=="},
+    {"fo", "Zm8="},
+    {"foo", "Zm9v"},
+    {"foob", "Zm9vYg=="},
+    {"fooba", "Zm9vYmE="},
+    {"foobar", "Zm9vYmFy"},
+}
+for _,v in ipairs(vectors) do
+    runner.check(sys.b64encode(v[1]) == v[2], string.format("encode of %s: %s", v[1], sys.b64encode(v[1])))
+    runner.check(sys.b64decode(v[2]) == v[1], string.format("decode of %s: %s", v[2], sys.b64decode(v[2])))
+end
+
+-- Round Trip Every Length Across Vector Block Sizes --
+
+local valid = true
+for len = 1, 200 do
+    local bytes = {}
+    for i = 1, len do bytes[i] = string.char((i * 37 + len) & 0xFF) end
+    local data = table.concat(bytes)
+    valid = valid and sys.b64decode(sys.b64encode(data)) == data
+end
+runner.check(valid, "round trip failed")
+
+-- Throughput --
+
+local size = 0x1000000 -- 16MB
+local data = string.rep("\x00\x10\x83\x10\x51\x87\x20\x92\x8B\x30\xD3\x8F\x41\x14\x93\x51", size // 16)
+
+local start = time.latch()
+local encoded = sys.b64encode(data)
+local encode_time = time.latch() - start
+
+start = time.latch()
+local decoded = sys.b64decode(encoded)
+local decode_time = time.latch() - start
+
+runner.check(decoded == data, "large round trip failed")
+print(string.format("Base64 encode %.1f MB/s, decode %.1f MB/s", size / (encode_time * 1000000.0), size / (decode_time * 1000000.0)))
+
+-- Report Results --
+
+runner.report()
+
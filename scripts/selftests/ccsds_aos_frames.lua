@@ -0,0 +1,79 @@
+local runner = require("test_executive")
+
+-- CCSDS AOS Frame Parser Unit Test and Throughput --
+
+local num_frames = 2000
+local frame_size = 1024 -- header(6) + mpdu(2) + data + trailer(2)
+local sync = "\x1A\xCF\xFC\x1D"
+local apid = 0x100
+local vcid = 3
+
+-- Build CRC-16 Table (same polynomial as parser) --
+
+local crc_table = {}
+for b = 0, 255 do
+    local c = b
+    for _ = 1, 8 do
+        if c & 1 == 1 then c = (c >> 1) ~ 0xA001 else c = c >> 1 end
+    end
+    crc_table[b] = c
+end
+
+local function crc16(str)
+    local crc = 0
+    for i = 1, #str do
+        crc = (crc >> 8) ~ crc_table[(crc ~ str:byte(i)) & 0xFF]
+    end
+    return crc
+end
+
+-- Build Recorded Frames (one packet per frame) --
+
+local pkt_len = frame_size - 10
+local payload = string.rep("\x5A\xA5\x01\xFE", (pkt_len - 6) // 4 + 1):sub(1, pkt_len - 6)
+local frames = {}
+for f = 0, num_frames - 1 do
+    local pkt = string.pack(">I2I2I2", 0x0800 | apid, 0xC000 | (f & 0x3FFF), pkt_len - 7) .. payload
+    local hdr = string.pack(">I2I3I1I2", (1 << 14) | (0x3F << 6) | vcid, f & 0xFFFFFF, 0, 0)
+    local frame = hdr .. pkt
+    frames[#frames + 1] = sync .. frame .. string.pack(">I2", crc16(frame))
+end
+
+-- Run Frames Through Parser --
+
+local pktq = msg.subscribe("aospktq")
+local frameq = msg.publish("aosframeq")
+local parser = ccsds.parser(ccsds.aosmod(0x3F, vcid, 4, "1ACFFC1D", 0, frame_size, 6, 2), ccsds.SPACE, "aosframeq", "aospktq")
+
+local start = time.latch()
+local batch = 64
+for f = 1, num_frames, batch do
+    frameq:sendstring(table.concat(frames, "", f, math.min(f + batch - 1, num_frames)))
+end
+
+local num_pkts = 0
+local valid = true
+while num_pkts < num_frames do
+    local pkts = pktq:recvstrings(batch, 3000)
+    if #pkts == 0 then break end
+    for _,pkt in ipairs(pkts) do
+        valid = valid and #pkt == pkt_len
+    end
+    num_pkts = num_pkts + #pkts
+end
+local elapsed = time.latch() - start
+
+runner.check(num_pkts == num_frames, string.format("received %d packets, expected %d", num_pkts, num_frames))
+runner.check(valid, "received packet of incorrect length")
+print(string.format("Parsed %d AOS frames in %.3f seconds (%.1f Mbps)", num_pkts, elapsed, (num_pkts * (frame_size + #sync) * 8) / (elapsed * 1000000.0)))
+
+-- Clean Up --
+
+parser:destroy()
+frameq:destroy()
+pktq:destroy()
+
+-- Report Results --
+
+runner.report()
+
@@ -20,6 +20,31 @@ val2 = cmdoutq:recvstring(3000)
 
 runner.check(packet.comparePacket(val1, val2))
 
+-- Segmented Telemetry --
+
+tlmoutq = msg.subscribe("tlmoutq")
+tlminq = msg.publish("tlminq")
+
+tlmpacketizer = ccsds.packetizer("tlminq", "tlmoutq", 0x1C0, ccsds.TLM, 0, 32) -- 12 byte header, 20 byte payload
+
+local message = string.rep("0123456789", 5)
+tlminq:sendstring(message)
+
+local expected_flags = {0x40, 0x00, 0x80}
+local expected_lens = {32, 32, 22}
+local payload = ""
+for i = 1, 3 do
+    local pkt = tlmoutq:recvstring(3000)
+    runner.check(pkt ~= nil and #pkt == expected_lens[i], string.format("segment %d has wrong length", i))
+    if pkt then
+        runner.check((pkt:byte(3) & 0xC0) == expected_flags[i], string.format("segment %d has wrong sequence flags", i))
+        payload = payload .. pkt:sub(13)
+    end
+end
+runner.check(payload == message, "segmented payload does not match message")
+
+tlmpacketizer:destroy()
+
 -- Report Results --
 
 runner.report()
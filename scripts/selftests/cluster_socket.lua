@@ -39,6 +39,48 @@ runner.compare(message1, "HELLO WORLD 1")
 runner.compare(message2, "HELLO WORLD 2")
 runner.compare(message3, "HELLO WORLD 3")
 
+-- Gathered and Direct Read Messages --
+
+local large = string.rep("0123456789ABCDEF", 2500) -- 40000 bytes, read directly into its allocation
+local num_small = 100
+for i = 1, num_small do
+    inq:sendstring(string.format("SMALL %d", i))
+end
+runner.check(inq:sendstring(large))
+
+local smalls_in_order = true
+for i = 1, num_small do
+    local small = outq:recvstring(5000)
+    smalls_in_order = smalls_in_order and small == string.format("SMALL %d", i)
+end
+runner.check(smalls_in_order, "failed to receive small messages in order")
+
+local large_rcvd = outq:recvstring(5000)
+runner.check(large_rcvd ~= nil and #large_rcvd == #large, "failed to receive large message")
+runner.check(large_rcvd == large, "large message corrupted")
+
+-- Compressed Messages --
+
+local zserver = core.cluster(core.WRITER, core.QUEUE, "127.0.0.1", 34504, core.SERVER, "zinq", true):name("clusterZServer")
+local zclient = core.cluster(core.READER, core.QUEUE, "127.0.0.1", 34504, core.CLIENT, "zoutq"):name("clusterZClient")
+attempts = 10
+while attempts > 0 and not zclient:connected() do
+    attempts = attempts - 1
+    sys.wait(1)
+end
+
+local zinq = msg.publish("zinq")
+local zoutq = msg.subscribe("zoutq")
+runner.check(zinq:sendstring("SHORT")) -- below the compression threshold
+runner.check(zinq:sendstring(large))
+runner.check(zinq:sendstring(large))
+runner.compare(zoutq:recvstring(5000), "SHORT")
+runner.check(zoutq:recvstring(5000) == large, "first compressed message corrupted")
+runner.check(zoutq:recvstring(5000) == large, "second compressed message corrupted")
+
+zserver:destroy()
+zclient:destroy()
+
 -- Clean Up --
 
 writer:destroy()
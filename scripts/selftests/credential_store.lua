@@ -29,6 +29,12 @@ print(display2screen)
 
 runner.check(metrics["CredentialStore.mycredentials:exp_gps"]["value"] == 1306681214000, "incorrect expiration time")
 
+print('\n------------------\nTest03: Request Signing Rate\n------------------')
+
+local sign_rate = aws.s3signrate(100000)
+runner.check(sign_rate and sign_rate > 0, "failed to measure signing rate")
+print(string.format("Signed %.0f requests/s", sign_rate or 0))
+
 -- Clean Up --
 
 server:destroy()
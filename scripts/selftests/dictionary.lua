@@ -9,6 +9,10 @@ runner.command(string.format('ut_dictionary::ADD_WORD_SET large %s/english_words
 runner.command("ut_dictionary::FUNCTIONAL_TEST small")
 runner.command("ut_dictionary::FUNCTIONAL_TEST large")
 runner.command("ut_dictionary::ITERATOR_TEST small")
+runner.command("ut_dictionary::FLAT_FUNCTIONAL_TEST small")
+runner.command("ut_dictionary::FLAT_FUNCTIONAL_TEST large")
+runner.command("ut_dictionary::FLAT_ITERATOR_TEST small")
+runner.command("ut_dictionary::BENCHMARK large")
 runner.command("DELETE ut_dictionary")
 
 -- Report Results --
@@ -0,0 +1,57 @@
+local runner = require("test_executive")
+local console = require("console")
+
+-- Grid Dispatch Unit Test Setup --
+
+runner.command("DEFINE gridtest.rec NULL 24")
+runner.command("ADD_FIELD gridtest.rec lon DOUBLE 0 1 NATIVE")
+runner.command("ADD_FIELD gridtest.rec lat DOUBLE 8 1 NATIVE")
+runner.command("ADD_FIELD gridtest.rec h DOUBLE 16 1 NATIVE")
+
+local grid = geo.grid("grid_outq", "gridtest.rec", "lon", "lat", "h", 1.0, nil, 0.0, 8.0, true)
+local r = core.dispatcher("grid_inputq"):name("dispatcher")
+r:attach(grid, "gridtest.rec"):run()
+
+local inputq = msg.publish("grid_inputq")
+local outq = msg.subscribe("grid_outq")
+
+-- Send Test Records (all in one cell) --
+
+for i=1,4,1 do
+    local testrec = msg.create(string.format('gridtest.rec lon=%f lat=20.5 h=%d', 10.0 + (i / 10.0), i))
+    inputq:sendrecord(testrec)
+end
+r:aot()
+
+-- Receive Grid --
+
+local gridrec = outq:recvrecord(3000)
+if gridrec then
+    local num_cells = gridrec:getvalue("num_cells")
+    local count     = gridrec:getvalue("cells.count")
+    local mean      = gridrec:getvalue("cells.mean")
+    local m2        = gridrec:getvalue("cells.m2")
+    local min       = gridrec:getvalue("cells.min")
+    local max       = gridrec:getvalue("cells.max")
+    local q10       = gridrec:getvalue("cells.quantiles")
+    runner.check(num_cells == 1,            string.format('num_cells is incorrect: %d', num_cells))
+    runner.check(count == 4,                string.format('count is incorrect: %d', count))
+    runner.check(math.abs(mean - 2.5) < 0.0001, string.format('mean is incorrect: %f', mean))
+    runner.check(math.abs(m2 - 5.0) < 0.0001,   string.format('m2 is incorrect: %f', m2))
+    runner.check(min == 1.0,                string.format('min is incorrect: %f', min))
+    runner.check(max == 4.0,                string.format('max is incorrect: %f', max))
+    runner.check(q10 == 1.0,                string.format('10th percentile is incorrect: %f', q10))
+else
+    runner.check(false, "Timeout receiving grid")
+end
+
+-- Clean Up --
+
+r:destroy()
+grid:destroy()
+inputq:destroy()
+outq:destroy()
+
+-- Report Results --
+
+runner.report()
@@ -10,6 +10,9 @@ print('\n------------------\nTest01: File\n------------------')
 
 f1 = h5.file(asset, "h5ex_d_gzip.h5")
 runner.check(f1:dir(1, "/DS1"), "failed to traverse hdf5 file")
+local dir_status, objects = f1:dir(1)
+runner.check(dir_status, "failed to list root group of hdf5 file")
+runner.check(objects and objects["/DS1"] == "dataset", "failed to find dataset in listing of root group")
 
 rsps1 = msg.subscribe("h5testq")
 f1:read({{dataset="DS1", col=2}}, "h5testq")
@@ -90,6 +93,90 @@ end
 f:close()
 os.remove(h5_file)
 
+print('\n------------------\nTest05: Global Cache\n------------------')
+
+runner.check(h5.cache(0x1000000) == 0x1000000, "failed to set h5coro cache budget")
+
+for i=1,2 do
+    local rsps5 = msg.subscribe("h5cacheq")
+    local f5 = h5.file(asset, "h5ex_d_gzip.h5")
+    f5:read({{dataset="DS1", col=2}}, "h5cacheq")
+    local recdata5 = rsps5:recvrecord(3000)
+    runner.check(recdata5, "failed to read hdf5 file with cache enabled")
+    if recdata5 then
+        runner.check(-2 == string.unpack("i", string.char(recdata5:getvalue("data[0]"), recdata5:getvalue("data[1]"), recdata5:getvalue("data[2]"), recdata5:getvalue("data[3]"))), "failed to read hdf5 file from cache")
+        runner.check( 4 == string.unpack("i", string.char(recdata5:getvalue("data[12]"), recdata5:getvalue("data[13]"), recdata5:getvalue("data[14]"), recdata5:getvalue("data[15]"))), "failed to read hdf5 file from cache")
+    end
+    rsps5:destroy()
+    f5:destroy()
+end
+
+runner.check(h5.cache(0) == 0, "failed to disable h5coro cache")
+
+print('\n------------------\nTest06: Persisted Metadata\n------------------')
+
+local meta_file = "h5coro_selftest.meta"
+local saved = h5.metasave(meta_file)
+runner.check(saved and saved > 0, "failed to save h5coro meta repository")
+local loaded = h5.metaload(meta_file)
+runner.check(loaded == 0, "entries already in meta repository should not be reloaded") -- repository already holds every entry
+os.remove(meta_file)
+
+print('\n------------------\nTest07: Memory Mapped Files\n------------------')
+
+runner.check(core.filemode("mmap") == "mmap", "failed to set file mode")
+
+local rsps7 = msg.subscribe("h5mmapq")
+local f7 = h5.file(asset, "h5ex_d_gzip.h5")
+f7:read({{dataset="DS1", col=2}}, "h5mmapq")
+local recdata7 = rsps7:recvrecord(3000)
+runner.check(recdata7, "failed to read memory mapped hdf5 file")
+if recdata7 then
+    runner.check(-2 == string.unpack("i", string.char(recdata7:getvalue("data[0]"), recdata7:getvalue("data[1]"), recdata7:getvalue("data[2]"), recdata7:getvalue("data[3]"))), "failed to read memory mapped hdf5 file")
+    runner.check( 4 == string.unpack("i", string.char(recdata7:getvalue("data[12]"), recdata7:getvalue("data[13]"), recdata7:getvalue("data[14]"), recdata7:getvalue("data[15]"))), "failed to read memory mapped hdf5 file")
+end
+rsps7:destroy()
+f7:destroy()
+
+print('\n------------------\nTest08: io_uring Reads\n------------------')
+
+local uring_mode = core.filemode("uring") -- left unchanged where io_uring is not available
+print("File mode: "..uring_mode)
+
+local rsps8 = msg.subscribe("h5uringq")
+local f8 = h5.file(asset, "h5ex_d_gzip.h5")
+f8:read({{dataset="DS1", col=2}}, "h5uringq")
+local recdata8 = rsps8:recvrecord(3000)
+runner.check(recdata8, "failed to read hdf5 file in "..uring_mode.." mode")
+if recdata8 then
+    runner.check(-2 == string.unpack("i", string.char(recdata8:getvalue("data[0]"), recdata8:getvalue("data[1]"), recdata8:getvalue("data[2]"), recdata8:getvalue("data[3]"))), "failed to read hdf5 file in "..uring_mode.." mode")
+    runner.check( 4 == string.unpack("i", string.char(recdata8:getvalue("data[12]"), recdata8:getvalue("data[13]"), recdata8:getvalue("data[14]"), recdata8:getvalue("data[15]"))), "failed to read hdf5 file in "..uring_mode.." mode")
+end
+rsps8:destroy()
+f8:destroy()
+
+runner.check(core.filemode("pread") == "pread", "failed to restore file mode")
+
+print('\n------------------\nTest09: Hyperslab Selection\n------------------')
+
+local rsps9 = msg.subscribe("h5slabq")
+local f9 = h5.file(asset, "h5ex_d_gzip.h5")
+f9:read({{dataset="DS1", slab={{1, 3, 4}, {2, 5, 2}}}}, "h5slabq") -- rows 1,4,7,10 and columns 2,7
+local recdata9 = rsps9:recvrecord(3000)
+runner.check(recdata9, "failed to read hyperslab")
+if recdata9 then
+    local rectable9 = recdata9:tabulate()
+    runner.check(rectable9.elements == 8, string.format("unexpected number of elements: %d", rectable9.elements))
+    local expected = {0, 0, 6, 21, 12, 42, 18, 63} -- DS1[i][j] = i * j - j
+    for e = 1, #expected do
+        local b = (e - 1) * 4
+        local val = string.unpack("<i4", string.char(recdata9:getvalue(string.format("data[%d]", b)), recdata9:getvalue(string.format("data[%d]", b+1)), recdata9:getvalue(string.format("data[%d]", b+2)), recdata9:getvalue(string.format("data[%d]", b+3))))
+        runner.check(val == expected[e], string.format("unexpected value at %d: %d != %d", e, val, expected[e]))
+    end
+end
+rsps9:destroy()
+f9:destroy()
+
 -- Report Results --
 
 runner.report()
@@ -39,8 +39,35 @@ result = f:read()
 f:close()
 runner.check(result == "{ \"result\": \"Hello World\" }")
 
+print('\n------------------\nTest03: Sharded\n------------------')
+sharded_server = core.httpd(9082, nil, 16, 4):attach(endpoint, "/source"):untilup()
+for i=1,8 do
+    os.execute(string.format("curl -sS -X GET -d '%s' http://127.0.0.1:9082/source/example_source_endpoint > %s", json_object, tmpfile))
+    f = io.open(tmpfile)
+    result = f:read()
+    f:close()
+    runner.check(result == "{ \"result\": \"Hello World\" }", "request "..tostring(i))
+end
+
+print('\n------------------\nTest04: Admission\n------------------')
+runner.check(endpoint:admission(1, 4))
+endpoint:weight("anonymous", 2)
+for i=1,3 do
+    os.execute(string.format("curl -sS -X POST -d '%s' http://127.0.0.1:9081/source/example_engine_endpoint > %s", json_object, tmpfile))
+    f = io.open(tmpfile)
+    result = f:read()
+    f:close()
+    runner.check(result == "FILE", "stream "..tostring(i))
+end
+tenant = endpoint:tenants()["example_engine_endpoint:anonymous"]
+runner.check(tenant ~= nil, "no tenant for streams")
+runner.check(tenant.admitted == 4, "admitted "..tostring(tenant and tenant.admitted))
+runner.check(tenant.weight == 2 and tenant.queued == 0)
+runner.check(endpoint:admission(0))
+
 -- Clean Up --
 
+sharded_server:destroy()
 server:destroy()
 os.remove(tmpfile)
 
@@ -0,0 +1,56 @@
+local runner = require("test_executive")
+
+-- Native JSON Codec Unit Test and Throughput --
+
+-- Decode --
+
+local doc = netsvc.jsondecode('{"a": 1, "b": [1, 2.5, "x", true, false], "c": {"d": null}, "e": "\\u00e9\\n"}')
+runner.check(doc.a == 1 and math.type(doc.a) == "integer", "decode of integer")
+runner.check(#doc.b == 5 and doc.b[2] == 2.5 and doc.b[3] == "x" and doc.b[4] == true and doc.b[5] == false, "decode of array")
+runner.check(type(doc.c) == "table" and doc.c.d == nil, "decode of null member")
+runner.check(doc.e == "\xC3\xA9\n", "decode of escaped string")
+
+-- Encode --
+
+runner.check(netsvc.jsonencode({1, 2, 3}) == "[1,2,3]", "encode of array")
+runner.check(netsvc.jsonencode({}) == "[]", "encode of empty table")
+runner.check(netsvc.jsonencode({a="x\"y"}) == '{"a":"x\\"y"}', "encode of object")
+runner.check(netsvc.jsonencode(0.1) == "0.1", "encode of real")
+
+-- Errors --
+
+runner.check(not pcall(netsvc.jsondecode, '{"a": 1'), "decode of truncated document")
+runner.check(not pcall(netsvc.jsondecode, '[1] 2'), "decode of trailing garbage")
+runner.check(not pcall(netsvc.jsonencode, {1, nil, 3}), "encode of sparse array")
+runner.check(not pcall(netsvc.jsonencode, {1, a=2}), "encode of mixed keys")
+runner.check(not pcall(netsvc.jsonencode, 0/0), "encode of NaN")
+local circular = {}
+circular.self = circular
+runner.check(not pcall(netsvc.jsonencode, circular), "encode of circular reference")
+
+-- Round Trip and Throughput --
+
+local coords = {}
+for i = 1, 100000 do
+    coords[i] = {lon=-108.0 + (i * 0.00001), lat=39.0 + (i * 0.00001)}
+end
+
+local start = time.latch()
+local encoded = netsvc.jsonencode({samples=coords})
+local encode_time = time.latch() - start
+
+start = time.latch()
+local decoded = netsvc.jsondecode(encoded)
+local decode_time = time.latch() - start
+
+local valid = #decoded.samples == #coords
+for i = 1, #coords, 997 do
+    valid = valid and decoded.samples[i].lon == coords[i].lon and decoded.samples[i].lat == coords[i].lat
+end
+runner.check(valid, "round trip failed")
+print(string.format("Encoded %d coordinates in %.3f seconds, decoded in %.3f seconds", #coords, encode_time, decode_time))
+
+-- Report Results --
+
+runner.report()
+
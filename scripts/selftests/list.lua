@@ -7,6 +7,7 @@ runner.command("NEW UT_LIST ut_list")
 runner.command("ut_list::ADD_REMOVE")
 runner.command("ut_list::DUPLICATES")
 runner.command("ut_list::SORT")
+runner.command("ut_list::ARRAY_LIST")
 runner.command("DELETE ut_list")
 
 -- Report Results --
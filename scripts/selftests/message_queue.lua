@@ -6,8 +6,38 @@ runner.command("NEW UT_MSGQ ut_msgq")
 runner.command("ut_msgq::BLOCKING_RECEIVE_TEST")
 runner.command("ut_msgq::SUBSCRIBE_UNSUBSCRIBE_TEST")
 runner.command("ut_msgq::SUBSCRIBER_OF_OPPORTUNITY_TEST")
+runner.command("ut_msgq::SPSC_TEST")
 runner.command("DELETE ut_msgq")
 
+-- Batched Post and Receive --
+
+local batchsub = msg.subscribe("batchq")
+local batchpub = msg.publish("batchq")
+runner.check(batchpub:sendstrings({"one", "two", "three", "four"}) == 4, "failed to post batch of strings")
+local strs = batchsub:recvstrings(3, 1000)
+runner.check(#strs == 3 and strs[1] == "one" and strs[3] == "three", "failed to receive first batch of strings")
+strs = batchsub:recvstrings(3, 1000)
+runner.check(#strs == 1 and strs[1] == "four", "failed to receive remaining batch of strings")
+batchpub:destroy()
+batchsub:destroy()
+
+-- Columnar Post and Receive --
+
+runner.command("DEFINE columns.rec id 16")
+runner.command("ADD_FIELD columns.rec id INT32 0 1 NATIVE")
+runner.command("ADD_FIELD columns.rec value DOUBLE 8 1 NATIVE")
+
+local colsub = msg.subscribe("columnq")
+local colpub = msg.publish("columnq")
+runner.check(colpub:sendcolumns({_type="columns.rec", id={1, 2, 3}, value={0.5, 1.5, 2.5}}) == 3, "failed to post columns")
+colpub:sendrecord(msg.create("columns.rec id=4 value=3.5"))
+local cols = colsub:recvcolumns("columns.rec", 10, 1000, {"value", "id"})
+runner.check(cols._count == 4, string.format("received %d rows, expected 4", cols._count))
+runner.check(cols.id[1] == 1 and cols.id[4] == 4, "failed to receive id column")
+runner.check(cols.value[2] == 1.5 and cols.value[4] == 3.5, "failed to receive value column")
+colpub:destroy()
+colsub:destroy()
+
 -- Report Results --
 
 runner.report()
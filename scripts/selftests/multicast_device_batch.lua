@@ -0,0 +1,58 @@
+local runner = require("test_executive")
+local console = require("console")
+
+-- UdpSocket/Multicast/DeviceWriter/DeviceReader Batched Unit Test --
+
+-- create writer
+
+sockoutq = msg.publish("batchoutq")
+runner.check(sockoutq, "Failed to create socket output queue")
+
+client = core.udp("239.255.0.1", 35029, core.CLIENT)
+writer = core.writer(client, "batchoutq", 16) -- sendmmsg batches
+sys.wait(2)
+
+-- create reader
+
+sockinq = msg.subscribe("batchinq")
+runner.check(sockinq)
+
+server = core.udp("0.0.0.0", 35029, core.SERVER, "239.255.0.1")
+reader = core.reader(server, "batchinq", 16) -- recvmmsg batches
+sys.wait(2)
+
+-- send message
+
+expected_message = "Hello World"
+runner.check(sockoutq:sendstring(expected_message), "Failed to send message")
+actual_message = sockinq:recvstring(5000)
+
+-- check results
+
+print("Message: ", actual_message)
+runner.check(expected_message == actual_message, "Failed to match messages")
+
+-- send burst of messages
+
+local num_messages = 50
+for i = 1, num_messages do
+    runner.check(sockoutq:sendstring(string.format("message %d", i)), "Failed to send message")
+end
+local num_received = 0
+while num_received < num_messages do
+    local message = sockinq:recvstring(5000)
+    if not message then break end
+    num_received = num_received + 1
+    runner.check(message == string.format("message %d", num_received), string.format("Unexpected message: %s", message))
+end
+runner.check(num_received == num_messages, string.format("Received %d of %d messages", num_received, num_messages))
+
+-- clean up
+
+client:close()
+server:close()
+
+-- Report Results --
+
+runner.report()
+
@@ -53,11 +53,41 @@ end
 runner.check(expected_totals["id"] == actual_totals["test.rec.id"])
 runner.check(expected_totals["counter"] == actual_totals["test.rec.counter"])
 
+-- Partitioned Record Dispatcher --
+
+local pidmetric = core.metric("id", "pdispatcher_metricq"):name("pidmetric")
+pidmetric:pbtext(true):pbname(true)
+
+local pr = core.dispatcher("pdispatcher_inputq", 4, "FIELD_KEY", "id", core.SUBSCRIBER_OF_CONFIDENCE, true):name("pdispatcher")
+pr:attach(pidmetric, "test.rec"):run()
+
+local pinputq = msg.publish("pdispatcher_inputq")
+local pmetricq = msg.subscribe("pdispatcher_metricq")
+
+expected_total = 0
+for i=1,100,1 do
+	testrec = msg.create(string.format('test.rec id=%d counter=%d', i, i))
+	pinputq:sendrecord(testrec)
+	expected_total = expected_total + i
+end
+
+actual_total = 0
+for i=1,100,1 do
+	metric = pmetricq:recvrecord(1000)
+	if metric then
+	    actual_total = actual_total + metric:getvalue("VALUE")
+    end
+end
+
+runner.check(expected_total == actual_total)
+
 -- Clean Up --
 
 r:destroy()
 idmetric:destroy()
 countermetric:destroy()
+pr:destroy()
+pidmetric:destroy()
 
 -- Report Results --
 
@@ -0,0 +1,43 @@
+local runner = require("test_executive")
+
+-- Shared Memory Queue Unit Test --
+
+local outq = msg.subscribe("shmoutq")
+
+local shmwriter = core.shmq(core.WRITER, "selftest", 0x10000):name("shmWriter")
+local shmreader = core.shmq(core.READER, "selftest"):name("shmReader")
+local writer = core.writer(shmwriter, "shminq"):name("shmDeviceWriter")
+local reader = core.reader(shmreader, "shmoutq"):name("shmDeviceReader")
+
+runner.check(shmwriter:connected(), "shared memory queue writer not attached")
+runner.check(shmreader:connected(), "shared memory queue reader not attached")
+
+local inq = msg.publish("shminq")
+
+-- Messages Delivered In Order Across Ring Wraps --
+
+local num_msgs = 1000
+for i = 1, num_msgs do
+    inq:sendstring(string.format("MESSAGE %d ", i) .. string.rep("X", i % 500))
+end
+
+local in_order = true
+for i = 1, num_msgs do
+    local message = outq:recvstring(5000)
+    in_order = in_order and message == string.format("MESSAGE %d ", i) .. string.rep("X", i % 500)
+end
+runner.check(in_order, "failed to receive messages in order")
+
+-- Clean Up --
+
+writer:destroy()
+reader:destroy()
+shmwriter:destroy()
+shmreader:destroy()
+inq:destroy()
+outq:destroy()
+
+-- Report Results --
+
+runner.report()
+
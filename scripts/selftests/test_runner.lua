@@ -12,13 +12,16 @@ if __core__ then
     runner.script(td .. "tcp_socket.lua")
     runner.script(td .. "udp_socket.lua")
     runner.script(td .. "multicast_device_writer.lua")
+    runner.script(td .. "multicast_device_batch.lua")
     runner.script(td .. "cluster_socket.lua")
+    runner.script(td .. "shm_queue.lua")
     runner.script(td .. "monitor.lua")
     runner.script(td .. "http_server.lua")
     runner.script(td .. "http_client.lua")
     runner.script(td .. "http_faults.lua")
     runner.script(td .. "http_rqst.lua")
     runner.script(td .. "lua_script.lua")
+    runner.script(td .. "base64_codec.lua")
 end
 
 -- Run AWS Self Tests --
@@ -34,6 +37,12 @@ if __h5__ then
     runner.script(td .. "hdf5_file.lua")
 end
 
+-- Run NetSvc Self Tests --
+
+if __netsvc__ then
+    runner.script(td .. "json_codec.lua")
+end
+
 -- Run Pistache Self Tests --
 
 if __pistache__ then
@@ -46,6 +55,10 @@ if __geo__ then
     runner.script(td .. "geojson_raster.lua")
 end
 
+if __geo__ and __legacy__ then
+    runner.script(td .. "grid_dispatch.lua")
+end
+
 -- Run Legacy Self Tests --
 
 if __legacy__ then
@@ -55,6 +68,7 @@ if __legacy__ then
     runner.script(td .. "table.lua")
     runner.script(td .. "timelib.lua")
     runner.script(td .. "ccsds_packetizer.lua")
+    runner.script(td .. "ccsds_aos_frames.lua")
     runner.script(td .. "cfs_interface.lua")
     runner.script(td .. "record_dispatcher.lua")
     runner.script(td .. "limit_dispatch.lua")
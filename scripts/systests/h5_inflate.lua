@@ -0,0 +1,54 @@
+--
+-- Measures H5Coro read throughput of a compressed dataset once the file data
+-- and metadata are held in memory, which isolates the time spent inflating,
+-- unshuffling, and copying chunks.  Run against builds configured with
+-- different inflate backends (e.g. -DENABLE_H5CORO_LIBDEFLATE=ON, or zlib-ng
+-- installed as the system zlib) to compare them.
+--
+-- Usage: sliderule h5_inflate.lua [<directory> <resource> <dataset> [<iterations>]]
+--
+--  defaults to the gzip compressed selftest file; for meaningful numbers
+--  point it at a granule, e.g.
+--      sliderule h5_inflate.lua /data/ATLAS ATL03_20181019065445_03150111_005_01.h5 /gt1l/heights/h_ph 20
+--
+
+local runner = require("test_executive")
+local console = require("console")
+
+local directory  = arg[1] or "../selftests"
+local resource   = arg[2] or "h5ex_d_gzip.h5"
+local dataset    = arg[3] or "/DS1"
+local iterations = tonumber(arg[4]) or 100
+
+local asset = core.asset("local", "file", directory, "empty.index")
+local f = h5.file(asset, resource)
+local rspq = msg.subscribe("h5inflateq")
+
+-- keep file data in memory so that only the first read hits storage
+h5.cache(0x40000000)
+
+-- warm up cache and metadata repository
+f:read({{dataset=dataset}}, "h5inflateq")
+local recdata = rspq:recvrecord(30000)
+runner.check(recdata ~= nil, "failed to read dataset")
+local size = recdata and recdata:getvalue("size") or 0
+
+-- timed reads
+local start = time.latch()
+for i=1,iterations do
+    f:read({{dataset=dataset}}, "h5inflateq")
+    recdata = rspq:recvrecord(30000)
+    runner.check(recdata ~= nil, "failed to read dataset on iteration "..tostring(i))
+end
+local duration = time.latch() - start
+
+print(string.format("%s%s: %d reads of %d bytes in %.3f seconds (%.3f ms/read, %.1f MB/s)",
+    resource, dataset, iterations, size, duration, (duration * 1000.0) / iterations,
+    (size * iterations) / (duration * 1024.0 * 1024.0)))
+
+-- clean up
+h5.cache(0)
+rspq:destroy()
+f:destroy()
+
+runner.report()
@@ -0,0 +1,631 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "core.h"
+
+#ifdef __h5__
+#include "h5.h"
+#include <zlib.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define BENCH_QUEUE_NAME        "benchq"
+#define BENCH_RECORD_TYPE       "benchrec"
+#define BENCH_MSG_SIZE          256
+#define BENCH_CHUNK_SIZE        0x10000 // 64KB, typical of ICESat-2 granules
+#define BENCH_NUM_RESOURCES     20000
+#define BENCH_KEY_SIZE          24 // "key" followed by any long
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+    const char* name;
+    long        iterations;
+    double      seconds;
+    double      bytes;          // bytes processed by all iterations, zero when not meaningful
+} result_t;
+
+typedef struct {
+    long        count;          // messages posted by each producer
+    Subscriber* sub;            // consumers only
+    long        expected;       // consumers only
+    long        received;       // consumers only
+} msgq_parm_t;
+
+typedef struct {
+    int64_t     time;
+    double      latitude;
+    double      longitude;
+    float       height;
+    uint32_t    id;
+    uint16_t    counts[8];
+} bench_rec_t;
+
+/******************************************************************************
+ BENCHMARK INTERVAL INDEX CLASS
+ ******************************************************************************/
+
+/*
+ * Exposes the query path of the interval index so that it can be timed
+ * directly instead of through the Lua bindings
+ */
+class BenchIntervalIndex: public IntervalIndex
+{
+    public:
+        BenchIntervalIndex (Asset* _asset, bool _packed):
+            IntervalIndex(NULL, _asset, "t0", "t1", DEFAULT_THRESHOLD, _packed) {}
+        using IntervalIndex::query;
+};
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+static List<result_t> results;
+static const char* benchFilter = NULL;
+static double benchScale = 1.0;
+static volatile double benchSink = 0.0; // keeps the optimizer from removing timed work
+
+static const RecordObject::fieldDef_t benchRecDef[] = {
+    {"time",        RecordObject::INT64,    offsetof(bench_rec_t, time),        1,  NULL, NATIVE_FLAGS},
+    {"latitude",    RecordObject::DOUBLE,   offsetof(bench_rec_t, latitude),    1,  NULL, NATIVE_FLAGS},
+    {"longitude",   RecordObject::DOUBLE,   offsetof(bench_rec_t, longitude),   1,  NULL, NATIVE_FLAGS},
+    {"height",      RecordObject::FLOAT,    offsetof(bench_rec_t, height),      1,  NULL, NATIVE_FLAGS},
+    {"id",          RecordObject::UINT32,   offsetof(bench_rec_t, id),          1,  NULL, NATIVE_FLAGS},
+    {"counts",      RecordObject::UINT16,   offsetof(bench_rec_t, counts),      8,  NULL, NATIVE_FLAGS}
+};
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * enabled - true if the benchmark matches the filter supplied on the command line
+ */
+static bool enabled (const char* name)
+{
+    return (benchFilter == NULL) || (strstr(name, benchFilter) != NULL);
+}
+
+/*
+ * scaled - number of iterations to run after applying the command line scale
+ */
+static long scaled (long iterations)
+{
+    long n = (long)(iterations * benchScale);
+    return n > 0 ? n : 1;
+}
+
+/*
+ * record - saves the result of a benchmark
+ */
+static void record (const char* name, long iterations, double start, double bytes=0.0)
+{
+    result_t result;
+    result.name = name;
+    result.iterations = iterations;
+    result.seconds = TimeLib::latchtime() - start;
+    result.bytes = bytes;
+    results.add(result);
+    print2term("%-32s %12ld %10.3f ns/op\n", name, iterations, result.seconds * 1000000000.0 / iterations);
+}
+
+/*
+ * nextrand - deterministic pseudo-random sequence so every run does the same work
+ */
+static uint64_t nextrand (uint64_t* state)
+{
+    *state = (*state * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return *state >> 33;
+}
+
+/*
+ * msgqProducer - posts copies of a fixed size message
+ */
+static void* msgqProducer (void* parm)
+{
+    msgq_parm_t* p = (msgq_parm_t*)parm;
+    Publisher pub(BENCH_QUEUE_NAME);
+    uint8_t payload[BENCH_MSG_SIZE];
+    memset(payload, 0x5A, sizeof(payload));
+    for(long i = 0; i < p->count; i++)
+    {
+        if(pub.postCopy(payload, sizeof(payload), IO_PEND) <= 0)
+        {
+            mlog(CRITICAL, "Failed to post benchmark message %ld", i);
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * msgqConsumer - receives copies until every producer's messages have arrived
+ */
+static void* msgqConsumer (void* parm)
+{
+    msgq_parm_t* p = (msgq_parm_t*)parm;
+    uint8_t payload[BENCH_MSG_SIZE];
+    while(p->received < p->expected)
+    {
+        int status = p->sub->receiveCopy(payload, sizeof(payload), SYS_TIMEOUT);
+        if(status > 0)
+        {
+            p->received++;
+        }
+        else if(status != MsgQ::STATE_TIMEOUT)
+        {
+            mlog(CRITICAL, "Failed to receive benchmark message: %d", status);
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * benchMsgQ - every consumer is a subscriber of confidence and so receives
+ *  every message posted by every producer
+ */
+static void benchMsgQ (const char* name, int num_producers, int num_consumers, bool spsc)
+{
+    if(!enabled(name)) return;
+
+    long count = scaled(200000) / num_producers;
+    msgq_parm_t* producers = new msgq_parm_t[num_producers];
+    msgq_parm_t* consumers = new msgq_parm_t[num_consumers];
+
+    /* Subscribe Before Any Posts */
+    for(int c = 0; c < num_consumers; c++)
+    {
+        consumers[c].sub = new Subscriber(BENCH_QUEUE_NAME);
+        consumers[c].expected = count * num_producers;
+        consumers[c].received = 0;
+    }
+    if(spsc) consumers[0].sub->declareSPSC();
+
+    /* Run Producers and Consumers */
+    double start = TimeLib::latchtime();
+    {
+        Thread** pids = new Thread* [num_producers + num_consumers];
+        for(int c = 0; c < num_consumers; c++)
+        {
+            pids[c] = new Thread(msgqConsumer, &consumers[c]);
+        }
+        for(int p = 0; p < num_producers; p++)
+        {
+            producers[p].count = count;
+            pids[num_consumers + p] = new Thread(msgqProducer, &producers[p]);
+        }
+        for(int t = 0; t < num_producers + num_consumers; t++)
+        {
+            delete pids[t]; // joins
+        }
+        delete [] pids;
+    }
+    long total = count * num_producers;
+    record(name, total, start, (double)total * BENCH_MSG_SIZE);
+
+    /* Clean Up */
+    for(int c = 0; c < num_consumers; c++)
+    {
+        if(consumers[c].received != consumers[c].expected)
+        {
+            mlog(CRITICAL, "Consumer %d received %ld of %ld messages", c, consumers[c].received, consumers[c].expected);
+        }
+        delete consumers[c].sub;
+    }
+    delete [] producers;
+    delete [] consumers;
+}
+
+/*
+ * benchDictionary - add, find, and remove string keys
+ */
+static void benchDictionary (void)
+{
+    if(!enabled("dictionary")) return;
+
+    long n = scaled(100000);
+    char (*keys)[BENCH_KEY_SIZE] = new char [n][BENCH_KEY_SIZE];
+    for(long i = 0; i < n; i++) snprintf(keys[i], sizeof(keys[i]), "key%ld", i);
+
+    Dictionary<long> dictionary;
+    double start;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) dictionary.add(keys[i], i);
+    record("dictionary_add", n, start);
+
+    start = TimeLib::latchtime();
+    long sum = 0;
+    for(long i = 0; i < n; i++)
+    {
+        long value = 0;
+        if(dictionary.find(keys[i], &value)) sum += value;
+    }
+    record("dictionary_find", n, start);
+    benchSink += sum;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) dictionary.remove(keys[i]);
+    record("dictionary_remove", n, start);
+
+    delete [] keys;
+}
+
+/*
+ * benchTable - add, find, and remove scattered integer keys
+ */
+static void benchTable (void)
+{
+    if(!enabled("table")) return;
+
+    long n = scaled(100000);
+    Table<long, unsigned long> table(n);
+    double start;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) table.add((unsigned long)i * 2654435761UL, i);
+    record("table_add", n, start);
+
+    start = TimeLib::latchtime();
+    long sum = 0;
+    for(long i = 0; i < n; i++)
+    {
+        long value = 0;
+        if(table.find((unsigned long)i * 2654435761UL, Table<long, unsigned long>::MATCH_EXACTLY, &value)) sum += value;
+    }
+    record("table_find", n, start);
+    benchSink += sum;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) table.remove((unsigned long)i * 2654435761UL);
+    record("table_remove", n, start);
+}
+
+/*
+ * benchOrdering - add out of order keys, then iterate and look them up
+ */
+static void benchOrdering (void)
+{
+    if(!enabled("ordering")) return;
+
+    long n = scaled(100000);
+    unsigned long* keys = new unsigned long [n];
+    uint64_t state = 1;
+    for(long i = 0; i < n; i++) keys[i] = nextrand(&state);
+
+    Ordering<long, unsigned long> ordering;
+    double start;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) ordering.add(keys[i], i);
+    record("ordering_add", n, start);
+
+    start = TimeLib::latchtime();
+    long sum = 0;
+    long value = 0;
+    long count = 0;
+    unsigned long key = ordering.first(&value);
+    while(key != (unsigned long)INVALID_KEY)
+    {
+        sum += value;
+        count++;
+        key = ordering.next(&value);
+    }
+    record("ordering_iterate", count, start);
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++) sum += ordering.get(keys[i]);
+    record("ordering_get", n, start);
+    benchSink += sum;
+
+    delete [] keys;
+}
+
+/*
+ * benchRecordObject - field access by handle and by name, and serialization
+ */
+static void benchRecordObject (void)
+{
+    if(!enabled("record")) return;
+
+    long n = scaled(1000000);
+    RECDEF(BENCH_RECORD_TYPE, benchRecDef, sizeof(bench_rec_t), NULL);
+    RecordObject rec(BENCH_RECORD_TYPE);
+    double start;
+
+    RecordObject::field_t latitude = rec.getField("latitude");
+    RecordObject::field_t counts = rec.getField("counts");
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        rec.setValueReal(latitude, (double)i);
+        rec.setValueInteger(counts, i, i & 7);
+    }
+    record("record_field_set", n, start);
+
+    start = TimeLib::latchtime();
+    double sum = 0.0;
+    for(long i = 0; i < n; i++)
+    {
+        sum += rec.getValueReal(latitude);
+        sum += rec.getValueInteger(counts, i & 7);
+    }
+    record("record_field_get", n, start);
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        RecordObject::field_t f = rec.getField("longitude");
+        sum += f.offset;
+    }
+    record("record_field_lookup", n, start);
+    benchSink += sum;
+
+    int size = rec.getAllocatedMemory();
+    unsigned char* buffer = new unsigned char [size];
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        rec.serialize(&buffer, RecordObject::COPY, size);
+    }
+    record("record_serialize", n, start, (double)n * size);
+    delete [] buffer;
+}
+
+#ifdef __h5__
+/*
+ * benchH5Chunks - inflate and unshuffle a chunk of slowly varying doubles,
+ *  the common layout of ICESat-2 photon datasets
+ */
+static void benchH5Chunks (void)
+{
+    if(!enabled("h5")) return;
+
+    long n = scaled(2000);
+    uint8_t* raw = new uint8_t [BENCH_CHUNK_SIZE];
+    uint8_t* shuffled = new uint8_t [BENCH_CHUNK_SIZE];
+    uint8_t* output = new uint8_t [BENCH_CHUNK_SIZE];
+
+    /* Build Shuffled Chunk */
+    double* values = (double*)raw;
+    long num_values = BENCH_CHUNK_SIZE / sizeof(double);
+    for(long i = 0; i < num_values; i++) values[i] = 100.0 + (i * 0.0001);
+    for(long i = 0; i < num_values; i++)
+    {
+        for(unsigned int b = 0; b < sizeof(double); b++)
+        {
+            shuffled[(b * num_values) + i] = raw[(i * sizeof(double)) + b];
+        }
+    }
+
+    /* Compress Chunk */
+    uLongf compressed_size = compressBound(BENCH_CHUNK_SIZE);
+    uint8_t* compressed = new uint8_t [compressed_size];
+    if(compress2(compressed, &compressed_size, shuffled, BENCH_CHUNK_SIZE, 6) != Z_OK)
+    {
+        mlog(CRITICAL, "Failed to compress benchmark chunk");
+        delete [] compressed;
+        delete [] raw;
+        delete [] shuffled;
+        delete [] output;
+        return;
+    }
+
+    double start;
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        H5FileBuffer::inflateChunk(compressed, compressed_size, output, BENCH_CHUNK_SIZE);
+    }
+    record("h5_inflate_chunk", n, start, (double)n * BENCH_CHUNK_SIZE);
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        H5FileBuffer::shuffleChunk(shuffled, BENCH_CHUNK_SIZE, output, 0, BENCH_CHUNK_SIZE, sizeof(double));
+    }
+    record("h5_shuffle_chunk_8", n, start, (double)n * BENCH_CHUNK_SIZE);
+
+    start = TimeLib::latchtime();
+    for(long i = 0; i < n; i++)
+    {
+        H5FileBuffer::shuffleChunk(shuffled, BENCH_CHUNK_SIZE, output, 0, BENCH_CHUNK_SIZE, sizeof(float));
+    }
+    record("h5_shuffle_chunk_4", n, start, (double)n * BENCH_CHUNK_SIZE);
+
+    benchSink += output[0];
+
+    delete [] compressed;
+    delete [] raw;
+    delete [] shuffled;
+    delete [] output;
+}
+#endif
+
+/*
+ * benchAssetIndex - query an interval index built over a synthetic asset,
+ *  both as a tree and packed
+ */
+static void benchAssetIndex (void)
+{
+    if(!enabled("asset_index")) return;
+
+    Asset* asset = Asset::pythonCreate("benchasset", "file", "/tmp", NULL, NULL, NULL);
+    if(!asset)
+    {
+        mlog(CRITICAL, "Failed to create benchmark asset");
+        return;
+    }
+
+    /* Populate Resources */
+    uint64_t state = 1;
+    for(int i = 0; i < BENCH_NUM_RESOURCES; i++)
+    {
+        Asset::resource_t resource;
+        snprintf(resource.name, Asset::RESOURCE_NAME_LENGTH, "resource_%d.h5", i);
+        double t0 = (double)(nextrand(&state) % 1000000);
+        double t1 = t0 + (double)(nextrand(&state) % 100);
+        resource.attributes.add("t0", t0);
+        resource.attributes.add("t1", t1);
+        asset->load(resource);
+    }
+
+    /* Query Each Layout */
+    const char* names[2] = {"asset_index_query", "asset_index_query_packed"};
+    for(int packed = 0; packed < 2; packed++)
+    {
+        long n = scaled(100000);
+        BenchIntervalIndex* index = new BenchIntervalIndex(asset, packed == 1);
+        long hits = 0;
+        state = 2;
+        double start = TimeLib::latchtime();
+        for(long i = 0; i < n; i++)
+        {
+            intervalspan_t span;
+            span.t0 = (double)(nextrand(&state) % 1000000);
+            span.t1 = span.t0 + 500.0;
+            SkipOrdering<int>* list = index->query(span);
+            hits += list->length();
+            delete list;
+        }
+        record(names[packed], n, start);
+        benchSink += hits;
+
+        /* The index releases its asset on deletion, which only pairs with a
+         * reference taken through Lua, so indexes and asset are left to exit */
+    }
+}
+
+/*
+ * report - writes the results as JSON
+ */
+static bool report (const char* filename)
+{
+    FILE* fp = stdout;
+    if(filename)
+    {
+        fp = fopen(filename, "w");
+        if(!fp)
+        {
+            print2term("Failed to open %s: %s\n", filename, LocalLib::err2str(errno));
+            return false;
+        }
+    }
+
+    fprintf(fp, "{\n    \"version\": \"%s\",\n    \"scale\": %lf,\n    \"benchmarks\": [", LIBID, benchScale);
+    for(int i = 0; i < results.length(); i++)
+    {
+        const result_t& result = results[i];
+        double ns_per_op = result.seconds * 1000000000.0 / result.iterations;
+        double ops_per_sec = result.seconds > 0.0 ? result.iterations / result.seconds : 0.0;
+        double mb_per_sec = result.seconds > 0.0 ? result.bytes / (result.seconds * 1000000.0) : 0.0;
+        fprintf(fp, "%s\n        {\"name\": \"%s\", \"iterations\": %ld, \"seconds\": %lf, \"ns_per_op\": %lf, \"ops_per_sec\": %lf, \"mb_per_sec\": %lf}",
+                i > 0 ? "," : "", result.name, result.iterations, result.seconds, ns_per_op, ops_per_sec, mb_per_sec);
+    }
+    fprintf(fp, "\n    ]\n}\n");
+
+    if(fp != stdout) fclose(fp);
+    return true;
+}
+
+/******************************************************************************
+ MAIN
+ ******************************************************************************/
+
+/*
+ * benchmarks [-o <output json>] [-f <name filter>] [-s <iteration scale>]
+ */
+int main (int argc, char* argv[])
+{
+    const char* output = NULL;
+
+    /* Parse Command Line */
+    for(int i = 1; i < argc; i++)
+    {
+        if(i + 1 < argc && strcmp(argv[i], "-o") == 0)      output = argv[++i];
+        else if(i + 1 < argc && strcmp(argv[i], "-f") == 0) benchFilter = argv[++i];
+        else if(i + 1 < argc && strcmp(argv[i], "-s") == 0) benchScale = strtod(argv[++i], NULL);
+        else
+        {
+            print2term("usage: %s [-o <output json>] [-f <name filter>] [-s <iteration scale>]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    /* Initialize Packages */
+    initcore();
+    #ifdef __h5__
+        inith5();
+    #endif
+
+    /* Run Benchmarks */
+    benchMsgQ("msgq_1p1c", 1, 1, false);
+    benchMsgQ("msgq_1p1c_spsc", 1, 1, true);
+    benchMsgQ("msgq_1p4c", 1, 4, false);
+    benchMsgQ("msgq_4p1c", 4, 1, false);
+    benchMsgQ("msgq_4p4c", 4, 4, false);
+    benchDictionary();
+    benchTable();
+    benchOrdering();
+    benchRecordObject();
+    #ifdef __h5__
+        benchH5Chunks();
+    #endif
+    benchAssetIndex();
+
+    /* Write Results */
+    bool status = report(output);
+
+    /* Clean Up */
+    #ifdef __h5__
+        deinith5();
+    #endif
+    deinitcore();
+
+    return status ? 0 : -1;
+}
@@ -70,6 +70,7 @@
 #include "pyS3Cache.h"
 #include "pyCredentialStore.h"
 #include "pyPlugin.h"
+#include "pyPipeline.h"
 
 /******************************************************************************
  * Namespaces
@@ -122,7 +123,17 @@ PYBIND11_MODULE(srpybin, m)
                       const std::string &,      // format
                       const std::string &,      // path
                       const std::string &,      // region
-                      const std::string &>())   // endpoint
+                      const std::string &,      // endpoint
+                      long,                     // l1_cache_lines
+                      long>(),                  // l2_cache_lines
+            py::arg("asset"),
+            py::arg("resource"),
+            py::arg("format"),
+            py::arg("path"),
+            py::arg("region"),
+            py::arg("endpoint"),
+            py::arg("l1_cache_lines") = 0,
+            py::arg("l2_cache_lines") = 0)
 
         .def("meta", &pyH5Coro::meta, "reads meta information for dataset from file",
             py::arg("dataset"),
@@ -138,12 +149,42 @@ PYBIND11_MODULE(srpybin, m)
 
         .def("readp", &pyH5Coro::readp, "parallel read of datasets from file")
 
+        .def("read_array", &pyH5Coro::read_array, "reads dataset from file into a numpy array",
+            py::arg("dataset"),
+            py::arg("col") = 0,
+            py::arg("startrow") = 0,
+            py::arg("numrows") = -1)
+
+        .def("readp_arrays", &pyH5Coro::readp_arrays, "parallel read of datasets from file into numpy arrays")
+
+        .def("read_async", &pyH5Coro::read_async, "asynchronous read of dataset from file into a numpy array",
+            py::keep_alive<0, 1>(),
+            py::arg("dataset"),
+            py::arg("col") = 0,
+            py::arg("startrow") = 0,
+            py::arg("numrows") = -1)
+
         .def("stat", &pyH5Coro::stat, "returns statistics");
 
+    py::class_<pyH5Future>(m, "h5future")
+
+        .def("wait", &pyH5Future::wait, "waits for read to complete, returns false on timeout",
+            py::arg("timeout") = IO_PEND)
+
+        .def("done", &pyH5Future::done, "returns true if read has completed")
+
+        .def("result", &pyH5Future::result, "returns dataset as a numpy array, blocking until read completes")
+
+        .def("__await__", &pyH5Future::await, "awaitable from an asyncio event loop", py::keep_alive<0, 1>());
+
     py::class_<pyS3Cache>(m, "s3cache")
 
         .def(py::init<const std::string &,      // _cache_root
-                      const int>());            // _max_files
+                      const int>())             // _max_files
+
+        .def(py::init<const std::string &,      // _cache_root
+                      const int,                // _max_files
+                      const long>());           // _max_bytes
 
     py::class_<pyCredentialStore>(m, "credentials")
 
@@ -159,6 +200,31 @@ PYBIND11_MODULE(srpybin, m)
         .def(py::init<const std::string &,      // scriptpath
                       const std::string &>());  // scriptarg
 
+    py::class_<pyRecordBatch>(m, "recordbatch")
+
+        .def("num_rows", &pyRecordBatch::numRows, "number of rows in the batch")
+
+        .def("columns", &pyRecordBatch::columnNames, "names of the columns in the batch")
+
+        .def("__len__", &pyRecordBatch::numRows)
+
+        .def("__arrow_c_schema__", &pyRecordBatch::exportSchema, "exports schema through the Arrow C data interface")
+
+        .def("__arrow_c_array__", &pyRecordBatch::exportArray, "exports batch through the Arrow C data interface",
+            py::arg("requested_schema") = py::none());
+
+    py::class_<pyPipeline>(m, "pipeline")
+
+        .def(py::init<const std::string &,      // scriptpath
+                      const std::string &,      // rqst
+                      const std::string &>())   // rec_type
+
+        .def("next", &pyPipeline::next, "returns next batch of records produced by the pipeline",
+            py::arg("max_rows") = pyPipeline::DEFAULT_BATCH_ROWS,
+            py::arg("timeout") = IO_PEND)
+
+        .def("complete", &pyPipeline::complete, "returns true once the pipeline has finished and all records are received");
+
     py::class_<pyPlugin>(m, "plugin")
 
         .def(py::init<const std::string &>());  // full path to plugin
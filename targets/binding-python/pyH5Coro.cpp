@@ -34,6 +34,7 @@
  ******************************************************************************/
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <exception>
 
 #include "StringLib.h"
@@ -49,10 +50,81 @@
 namespace py = pybind11;
 
 /******************************************************************************
- * Static
+ * pyH5Future Class
  ******************************************************************************/
 
-Mutex pyH5Coro::pyMut;
+/*--------------------------------------------------------------------
+ * Constructor
+ *--------------------------------------------------------------------*/
+pyH5Future::pyH5Future (H5Future* _h5f, const std::string &_dataset):
+    h5f(_h5f),
+    dataset(_dataset)
+{
+}
+
+/*--------------------------------------------------------------------
+ * Destructor
+ *--------------------------------------------------------------------*/
+pyH5Future::~pyH5Future (void)
+{
+    // H5Future destructor blocks until the read completes
+    py::gil_scoped_release release;
+    delete h5f;
+}
+
+/*--------------------------------------------------------------------
+ * wait
+ *--------------------------------------------------------------------*/
+bool pyH5Future::wait (int timeout)
+{
+    H5Future::rc_t rc;
+    {
+        py::gil_scoped_release release;
+        rc = h5f->wait(timeout);
+    }
+    return rc != H5Future::TIMEOUT;
+}
+
+/*--------------------------------------------------------------------
+ * done
+ *--------------------------------------------------------------------*/
+bool pyH5Future::done (void)
+{
+    return h5f->wait(IO_CHECK) != H5Future::TIMEOUT;
+}
+
+/*--------------------------------------------------------------------
+ * result
+ *
+ *  blocks until the read completes; the data buffer is handed off to
+ *  the returned array so result can only be retrieved once
+ *--------------------------------------------------------------------*/
+py::array pyH5Future::result (void)
+{
+    H5Future::rc_t rc;
+    {
+        py::gil_scoped_release release;
+        rc = h5f->wait(IO_PEND);
+    }
+
+    if(rc != H5Future::COMPLETE) throw std::runtime_error("failed to read " + dataset);
+    if(!h5f->info.data && h5f->info.elements > 0) throw std::runtime_error("result already retrieved for " + dataset);
+
+    return pyH5Coro::toarray(&h5f->info);
+}
+
+/*--------------------------------------------------------------------
+ * await
+ *
+ *  implements __await__ by running result() on the event loop's
+ *  default executor so the loop is never blocked by the read
+ *--------------------------------------------------------------------*/
+py::object pyH5Future::await (void)
+{
+    py::object loop = py::module::import("asyncio").attr("get_event_loop")();
+    py::object fut = loop.attr("run_in_executor")(py::none(), py::cpp_function([this]() { return result(); }));
+    return fut.attr("__await__")();
+}
 
 /******************************************************************************
  * pyH5Coro Class
@@ -61,8 +133,9 @@ Mutex pyH5Coro::pyMut;
 /*--------------------------------------------------------------------
  * Constructor
  *--------------------------------------------------------------------*/
-pyH5Coro::pyH5Coro (const std::string &_asset, const std::string &_resource, const std::string &format, const std::string &path, const std::string &region, const std::string &endpoint):
-    resource(_resource)
+pyH5Coro::pyH5Coro (const std::string &_asset, const std::string &_resource, const std::string &format, const std::string &path, const std::string &region, const std::string &endpoint, long l1_cache_lines, long l2_cache_lines):
+    resource(_resource),
+    context(l1_cache_lines, l2_cache_lines)
 {
     asset = Asset::pythonCreate(_asset.c_str(), format.c_str(), path.c_str(), NULL, region.c_str(), endpoint.c_str());
     if(asset == NULL) throw std::invalid_argument("failed to create asset, likely missing driver for provided format");
@@ -87,7 +160,11 @@ py::dict pyH5Coro::meta (const std::string &datasetname, long col, long startrow
     if(numrows < 0) numrows = H5Coro::ALL_ROWS;
 
     // perform read of dataset
-    H5Coro::info_t info = H5Coro::read(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context, true);
+    H5Coro::info_t info;
+    {
+        py::gil_scoped_release release;
+        info = H5Coro::read(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context, true);
+    }
 
     // construct meta dictionary
     result["elements"] = info.elements;
@@ -112,7 +189,11 @@ py::list pyH5Coro::read (const std::string &datasetname, long col, long startrow
     if(numrows < 0) numrows = H5Coro::ALL_ROWS;
 
     // perform read of dataset
-    H5Coro::info_t info = H5Coro::read(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context);
+    H5Coro::info_t info;
+    {
+        py::gil_scoped_release release;
+        info = H5Coro::read(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context);
+    }
 
     // build dataset array
     result = tolist(&info);
@@ -132,57 +213,137 @@ const py::dict pyH5Coro::readp (const py::list& datasets)
     py::dict result;
     List<read_rqst_t*> readers;
 
-    // traverse list of datasets to read
-    for(auto entry : datasets)
-    {
-        // build request
-        read_rqst_t* rqst = new read_rqst_t;
-        rqst->dataset   = py::cast<std::string>(PyList_GetItem(entry.ptr(), 0));
-        rqst->col       = py::cast<int>(PyList_GetItem(entry.ptr(), 1));
-        rqst->startrow  = py::cast<int>(PyList_GetItem(entry.ptr(), 2));
-        rqst->numrows   = py::cast<int>(PyList_GetItem(entry.ptr(), 3));
-        rqst->file      = this;
-        rqst->e_ptr     = NULL;
+    std::exception_ptr e_ptr = NULL;
 
-        // workaround for binding to default argument value
-        if(rqst->numrows < 0) rqst->numrows = H5Coro::ALL_ROWS;
+    // start reads
+    spawn(datasets, readers);
 
-        // spawn thread
-        rqst->pid = new Thread(read_thread, rqst);
-        readers.add(rqst);
+    // wait for reads to complete
+    {
+        py::gil_scoped_release release;
+        for(int i = 0; i < readers.length(); i++)
+        {
+            delete readers[i]->pid;
+        }
     }
 
     // process results
     for(int i = 0; i < readers.length(); i++)
     {
-        // wait for read to complete
-        delete readers[i]->pid;
+        // populate result dictionary
+        if(!readers[i]->e_ptr)
+        {
+            py::str key(readers[i]->dataset);
+            result[key] = tolist(&readers[i]->info);
+        }
+        else if(!e_ptr)
+        {
+            e_ptr = readers[i]->e_ptr;
+        }
+
+        // clean up data
+        if(readers[i]->info.data) delete [] readers[i]->info.data;
+
+        // clean up request
+        delete readers[i];
+    }
+
+    // check for exceptions
+    if(e_ptr) std::rethrow_exception(e_ptr);
+
+    // return result dictionary
+    return result;
+}
+
+/*--------------------------------------------------------------------
+ * read_array
+ *
+ *  returns the dataset as a numpy array that takes ownership of the
+ *  buffer allocated by H5Coro, avoiding any copy of the data
+ *--------------------------------------------------------------------*/
+py::array pyH5Coro::read_array (const std::string &datasetname, long col, long startrow, long numrows)
+{
+    // workaround for binding to default argument value
+    if(numrows < 0) numrows = H5Coro::ALL_ROWS;
+
+    // perform read of dataset
+    H5Coro::info_t info;
+    {
+        py::gil_scoped_release release;
+        info = H5Coro::read(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context);
+    }
 
-        // check for exceptions
-        if(readers[i]->e_ptr)
+    // hand off data buffer to array
+    return toarray(&info);
+}
+
+/*--------------------------------------------------------------------
+ * readp_arrays
+ *--------------------------------------------------------------------*/
+const py::dict pyH5Coro::readp_arrays (const py::list& datasets)
+{
+    py::dict result;
+    List<read_rqst_t*> readers;
+    std::exception_ptr e_ptr = NULL;
+
+    // start reads
+    spawn(datasets, readers);
+
+    // wait for reads to complete
+    {
+        py::gil_scoped_release release;
+        for(int i = 0; i < readers.length(); i++)
         {
-            std::rethrow_exception(readers[i]->e_ptr);
+            delete readers[i]->pid;
         }
+    }
 
+    // process results
+    for(int i = 0; i < readers.length(); i++)
+    {
         // populate result dictionary
-        pyMut.lock();
+        if(!readers[i]->e_ptr)
         {
             py::str key(readers[i]->dataset);
-            result[key] = readers[i]->result;
+            result[key] = toarray(&readers[i]->info);
+        }
+        else if(!e_ptr)
+        {
+            e_ptr = readers[i]->e_ptr;
         }
-        pyMut.unlock();
 
-        // clean up data
+        // clean up data not handed off to an array
         if(readers[i]->info.data) delete [] readers[i]->info.data;
 
         // clean up request
         delete readers[i];
     }
 
+    // check for exceptions
+    if(e_ptr) std::rethrow_exception(e_ptr);
+
     // return result dictionary
     return result;
 }
 
+/*--------------------------------------------------------------------
+ * read_async
+ *
+ *  queues the read on the H5Coro reader pool and returns immediately
+ *--------------------------------------------------------------------*/
+pyH5Future* pyH5Coro::read_async (const std::string &datasetname, long col, long startrow, long numrows)
+{
+    // workaround for binding to default argument value
+    if(numrows < 0) numrows = H5Coro::ALL_ROWS;
+
+    // post read request
+    H5Future* h5f = H5Coro::readp(asset, resource.c_str(), datasetname.c_str(), RecordObject::DYNAMIC, col, startrow, numrows, &context);
+    if(!h5f) throw std::runtime_error("failed to post read request for " + datasetname);
+
+    // return future
+    return new pyH5Future(h5f, datasetname);
+}
+
 /*--------------------------------------------------------------------
  * stat
  *--------------------------------------------------------------------*/
@@ -195,6 +356,13 @@ py::dict pyH5Coro::stat (void)
     stats["l1_cache_replace"]       = context.l1_cache_replace;
     stats["l2_cache_replace"]       = context.l2_cache_replace;
     stats["bytes_read"]             = context.bytes_read;
+
+    context.mut.lock();
+    {
+        stats["l1_cache_lines"]     = context.l1.length();
+        stats["l2_cache_lines"]     = context.l2.length();
+    }
+    context.mut.unlock();
     return stats;
 }
 
@@ -299,6 +467,84 @@ py::list pyH5Coro::tolist (H5Coro::info_t* info)
     return result;
 }
 
+/*--------------------------------------------------------------------
+ * toarray
+ *
+ *  on success the array owns info->data and info->data is set to NULL
+ *--------------------------------------------------------------------*/
+py::array pyH5Coro::toarray (H5Coro::info_t* info)
+{
+    py::dtype dtype;
+    switch(info->datatype)
+    {
+        case RecordObject::DOUBLE:  dtype = py::dtype::of<double>();    break;
+        case RecordObject::FLOAT:   dtype = py::dtype::of<float>();     break;
+        case RecordObject::INT64:   dtype = py::dtype::of<int64_t>();   break;
+        case RecordObject::UINT64:  dtype = py::dtype::of<uint64_t>();  break;
+        case RecordObject::INT32:   dtype = py::dtype::of<int32_t>();   break;
+        case RecordObject::UINT32:  dtype = py::dtype::of<uint32_t>();  break;
+        case RecordObject::INT16:   dtype = py::dtype::of<int16_t>();   break;
+        case RecordObject::UINT16:  dtype = py::dtype::of<uint16_t>();  break;
+        case RecordObject::INT8:    dtype = py::dtype::of<int8_t>();    break;
+        case RecordObject::UINT8:   dtype = py::dtype::of<uint8_t>();   break;
+        case RecordObject::STRING:  dtype = py::dtype("S" + std::to_string(info->datasize > 0 ? info->datasize : 1)); break;
+        default:                    throw std::invalid_argument(std::string("unsupported data type for array: ") + RecordObject::ft2str(info->datatype));
+    }
+
+    // empty dataset
+    if(!info->data) return py::array(dtype, std::vector<py::ssize_t>{0});
+
+    // shape of array
+    std::vector<py::ssize_t> shape;
+    if(info->datatype == RecordObject::STRING)
+    {
+        shape.push_back(1);
+    }
+    else if(info->numcols > 1 && ((uint64_t)info->numrows * (uint64_t)info->numcols) == info->elements)
+    {
+        shape.push_back(info->numrows);
+        shape.push_back(info->numcols);
+    }
+    else
+    {
+        shape.push_back(info->elements);
+    }
+
+    // hand off ownership of buffer to array
+    uint8_t* data = info->data;
+    py::capsule owner(data, [](void* ptr) { delete [] static_cast<uint8_t*>(ptr); });
+    info->data = NULL;
+
+    return py::array(dtype, shape, data, owner);
+}
+
+/*--------------------------------------------------------------------
+ * spawn
+ *--------------------------------------------------------------------*/
+void pyH5Coro::spawn (const py::list& datasets, List<read_rqst_t*>& readers)
+{
+    // traverse list of datasets to read
+    for(auto entry : datasets)
+    {
+        // build request
+        read_rqst_t* rqst = new read_rqst_t;
+        rqst->dataset   = py::cast<std::string>(PyList_GetItem(entry.ptr(), 0));
+        rqst->col       = py::cast<int>(PyList_GetItem(entry.ptr(), 1));
+        rqst->startrow  = py::cast<int>(PyList_GetItem(entry.ptr(), 2));
+        rqst->numrows   = py::cast<int>(PyList_GetItem(entry.ptr(), 3));
+        rqst->info.data = NULL;
+        rqst->file      = this;
+        rqst->e_ptr     = NULL;
+
+        // workaround for binding to default argument value
+        if(rqst->numrows < 0) rqst->numrows = H5Coro::ALL_ROWS;
+
+        // spawn thread
+        rqst->pid = new Thread(read_thread, rqst);
+        readers.add(rqst);
+    }
+}
+
 /*--------------------------------------------------------------------
  * read_thread
  *--------------------------------------------------------------------*/
@@ -311,12 +557,6 @@ void* pyH5Coro::read_thread (void* parm)
         // perform read of dataset
         rqst->info = H5Coro::read(rqst->file->asset, rqst->file->resource.c_str(), rqst->dataset.c_str(), RecordObject::DYNAMIC, rqst->col, rqst->startrow, rqst->numrows, &rqst->file->context);
 
-        // build dataset array
-        pyMut.lock();
-        {
-            rqst->result = rqst->file->tolist(&rqst->info);
-        }
-        pyMut.unlock();
     }
     catch(...)
     {
@@ -37,6 +37,7 @@
  ******************************************************************************/
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <stdexcept>
 
 #include "H5Coro.h"
@@ -49,18 +50,43 @@
 
 namespace py = pybind11;
 
+/******************************************************************************
+ * pyH5Future Class
+ ******************************************************************************/
+
+class pyH5Future
+{
+    public:
+                            pyH5Future  (H5Future* _h5f, const std::string &_dataset);
+                            ~pyH5Future (void);
+        bool                wait        (int timeout);
+        bool                done        (void);
+        py::array           result      (void);
+        py::object          await       (void);
+
+    private:
+
+        H5Future*           h5f;
+        std::string         dataset;
+};
+
 /******************************************************************************
  * pyH5Coro Class
  ******************************************************************************/
 
 class pyH5Coro
 {
+    friend class pyH5Future;
+
     public:
-                            pyH5Coro    (const std::string &_asset, const std::string &_resource, const std::string &format, const std::string &path, const std::string &region, const std::string &endpoint);
+                            pyH5Coro    (const std::string &_asset, const std::string &_resource, const std::string &format, const std::string &path, const std::string &region, const std::string &endpoint, long l1_cache_lines=0, long l2_cache_lines=0);
                             ~pyH5Coro   (void);
         py::dict            meta        (const std::string &datasetname, long col, long startrow, long numrows);
         py::list            read        (const std::string &datasetname, long col, long startrow, long numrows);
         const py::dict      readp       (const py::list& datasets);
+        py::array           read_array  (const std::string &datasetname, long col, long startrow, long numrows);
+        const py::dict      readp_arrays(const py::list& datasets);
+        pyH5Future*         read_async  (const std::string &datasetname, long col, long startrow, long numrows);
         py::dict            stat        (void);
 
     private:
@@ -72,17 +98,16 @@ class pyH5Coro
             int                 numrows;
             Thread*             pid;
             H5Coro::info_t      info;
-            py::list            result;
             pyH5Coro*           file;
             std::exception_ptr  e_ptr;
         } read_rqst_t;
 
 
         py::list            tolist      (H5Coro::info_t* info);
+        static py::array    toarray     (H5Coro::info_t* info);
+        void                spawn       (const py::list& datasets, List<read_rqst_t*>& readers);
         static void*        read_thread (void* parm);
 
-        static Mutex        pyMut;
-
         std::string         resource;
         Asset*              asset;
         H5Coro::context_t   context;
@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <pybind11/pybind11.h>
+#include "core.h"
+#include "pyPipeline.h"
+
+/******************************************************************************
+ * NAMESPACES
+ ******************************************************************************/
+
+namespace py = pybind11;
+
+/******************************************************************************
+ * pyRecordBatch Class
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------
+ * Constructor
+ *
+ *  takes the column buffers, leaving _buffers empty
+ *--------------------------------------------------------------------*/
+pyRecordBatch::pyRecordBatch (const std::vector<column_t>& _columns, std::vector<std::vector<uint8_t>>& _buffers, long _num_rows):
+    columns(_columns),
+    numRowsInBatch(_num_rows),
+    exported(false)
+{
+    buffers.swap(_buffers);
+}
+
+/*--------------------------------------------------------------------
+ * Destructor
+ *--------------------------------------------------------------------*/
+pyRecordBatch::~pyRecordBatch (void)
+{
+}
+
+/*--------------------------------------------------------------------
+ * numRows
+ *--------------------------------------------------------------------*/
+long pyRecordBatch::numRows (void)
+{
+    return numRowsInBatch;
+}
+
+/*--------------------------------------------------------------------
+ * columnNames
+ *--------------------------------------------------------------------*/
+py::list pyRecordBatch::columnNames (void)
+{
+    py::list names;
+    for(const column_t& column: columns)
+    {
+        names.append(column.name);
+    }
+    return names;
+}
+
+/*--------------------------------------------------------------------
+ * exportSchema - __arrow_c_schema__
+ *
+ *  the batch is exported as a struct whose children are the columns
+ *--------------------------------------------------------------------*/
+py::object pyRecordBatch::exportSchema (void)
+{
+    int num_columns = columns.size();
+
+    ArrowSchema* schema = new ArrowSchema;
+    schema->format = "+s";
+    schema->name = StringLib::duplicate("");
+    schema->metadata = NULL;
+    schema->flags = 0;
+    schema->n_children = num_columns;
+    schema->children = new ArrowSchema* [num_columns];
+    schema->dictionary = NULL;
+    schema->release = releaseSchema;
+    schema->private_data = NULL;
+
+    for(int i = 0; i < num_columns; i++)
+    {
+        ArrowSchema* child = new ArrowSchema;
+        child->format = columns[i].format;
+        child->name = StringLib::duplicate(columns[i].name.c_str());
+        child->metadata = NULL;
+        child->flags = 0;
+        child->n_children = 0;
+        child->children = NULL;
+        child->dictionary = NULL;
+        child->release = releaseSchema;
+        child->private_data = NULL;
+        schema->children[i] = child;
+    }
+
+    return py::capsule(schema, "arrow_schema", freeSchemaCapsule);
+}
+
+/*--------------------------------------------------------------------
+ * exportArray - __arrow_c_array__
+ *
+ *  hands the column buffers off to the exported array; a batch can
+ *  therefore only be exported once
+ *--------------------------------------------------------------------*/
+py::tuple pyRecordBatch::exportArray (const py::object& requested_schema)
+{
+    (void)requested_schema; // only the native schema is supported
+
+    if(exported) throw std::runtime_error("record batch has already been exported");
+    exported = true;
+
+    int num_columns = columns.size();
+
+    ArrowArray* array = new ArrowArray;
+    array->length = numRowsInBatch;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->n_children = num_columns;
+    array->buffers = new const void* [1];
+    array->buffers[0] = NULL; // no validity bitmap
+    array->children = new ArrowArray* [num_columns];
+    array->dictionary = NULL;
+    array->release = releaseArray;
+    array->private_data = NULL;
+
+    for(int i = 0; i < num_columns; i++)
+    {
+        std::vector<uint8_t>* data = new std::vector<uint8_t>;
+        data->swap(buffers[i]);
+
+        ArrowArray* child = new ArrowArray;
+        child->length = numRowsInBatch;
+        child->null_count = 0;
+        child->offset = 0;
+        child->n_buffers = 2;
+        child->n_children = 0;
+        child->buffers = new const void* [2];
+        child->buffers[0] = NULL; // no validity bitmap
+        child->buffers[1] = data->data();
+        child->children = NULL;
+        child->dictionary = NULL;
+        child->release = releaseColumnArray;
+        child->private_data = data;
+        array->children[i] = child;
+    }
+
+    return py::make_tuple(exportSchema(), py::capsule(array, "arrow_array", freeArrayCapsule));
+}
+
+/*--------------------------------------------------------------------
+ * releaseSchema
+ *--------------------------------------------------------------------*/
+void pyRecordBatch::releaseSchema (struct ArrowSchema* schema)
+{
+    for(int64_t i = 0; i < schema->n_children; i++)
+    {
+        ArrowSchema* child = schema->children[i];
+        if(child->release) child->release(child);
+        delete child;
+    }
+    delete [] schema->children;
+    delete [] schema->name;
+    schema->release = NULL;
+}
+
+/*--------------------------------------------------------------------
+ * releaseArray
+ *--------------------------------------------------------------------*/
+void pyRecordBatch::releaseArray (struct ArrowArray* array)
+{
+    for(int64_t i = 0; i < array->n_children; i++)
+    {
+        ArrowArray* child = array->children[i];
+        if(child->release) child->release(child);
+        delete child;
+    }
+    delete [] array->children;
+    delete [] array->buffers;
+    array->release = NULL;
+}
+
+/*--------------------------------------------------------------------
+ * releaseColumnArray
+ *--------------------------------------------------------------------*/
+void pyRecordBatch::releaseColumnArray (struct ArrowArray* array)
+{
+    delete static_cast<std::vector<uint8_t>*>(array->private_data);
+    delete [] array->buffers;
+    array->release = NULL;
+}
+
+/*--------------------------------------------------------------------
+ * freeSchemaCapsule
+ *
+ *  a consumer that imports the schema moves it out and marks it
+ *  released, otherwise it is released here
+ *--------------------------------------------------------------------*/
+void pyRecordBatch::freeSchemaCapsule (PyObject* capsule)
+{
+    ArrowSchema* schema = static_cast<ArrowSchema*>(PyCapsule_GetPointer(capsule, "arrow_schema"));
+    if(schema)
+    {
+        if(schema->release) schema->release(schema);
+        delete schema;
+    }
+}
+
+/*--------------------------------------------------------------------
+ * freeArrayCapsule
+ *--------------------------------------------------------------------*/
+void pyRecordBatch::freeArrayCapsule (PyObject* capsule)
+{
+    ArrowArray* array = static_cast<ArrowArray*>(PyCapsule_GetPointer(capsule, "arrow_array"));
+    if(array)
+    {
+        if(array->release) array->release(array);
+        delete array;
+    }
+}
+
+/******************************************************************************
+ * pyPipeline Class
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------
+ * Static Data
+ *--------------------------------------------------------------------*/
+
+std::atomic<long> pyPipeline::pipelineId(0);
+
+/*--------------------------------------------------------------------
+ * Constructor
+ *--------------------------------------------------------------------*/
+pyPipeline::pyPipeline (const std::string &scriptpath, const std::string &rqst, const std::string &rec_type):
+    batchType(rec_type),
+    rowSize(0),
+    rowOffset(0),
+    rowArray(false),
+    terminated(false)
+{
+    /* Determine Columns */
+    char** field_names = NULL;
+    RecordObject::field_t** fields = NULL;
+    int num_fields = RecordObject::getRecordFields(rec_type.c_str(), &field_names, &fields);
+    if(num_fields <= 0) throw std::invalid_argument("record type not defined: " + rec_type);
+    for(int i = 0; i < num_fields; i++)
+    {
+        /* Variable Length Array of Rows */
+        if(fields[i]->type == RecordObject::USER && fields[i]->elements <= 0 && !rowArray)
+        {
+            addColumns(fields[i]->exttype, 0);
+            rowSize = RecordObject::getRecordDataSize(fields[i]->exttype);
+            rowOffset = TOBYTES(fields[i]->offset);
+            rowArray = true;
+        }
+        delete [] field_names[i];
+        delete fields[i];
+    }
+    delete [] fields;
+    delete [] field_names;
+
+    /* Single Row Records */
+    if(!rowArray)
+    {
+        addColumns(rec_type.c_str(), 0);
+        rowSize = RecordObject::getRecordDataSize(rec_type.c_str());
+    }
+
+    if(columns.empty() || rowSize <= 0) throw std::invalid_argument("no columns available in record type: " + rec_type);
+
+    /* Create Response Queue */
+    SafeString qname("pypipeline-%ld", (long)pipelineId++);
+    rspPub = new Publisher(qname.getString());
+    rspSub = new Subscriber(*rspPub);
+
+    /* Create Engine */
+    engine = new LuaEngine(scriptpath.c_str(), rqst.c_str(), ORIGIN, NULL, true);
+    engine->setString(LuaEndpoint::LUA_RESPONSE_QUEUE, qname.getString());
+    engine->setString(LuaEndpoint::LUA_REQUEST_ID, qname.getString());
+
+    /* Start Pipeline */
+    pid = new Thread(engineThread, this);
+}
+
+/*--------------------------------------------------------------------
+ * Destructor
+ *
+ *  endpoint scripts stop waiting once their response queue has no
+ *  subscribers, so removing the subscriber first shortens the join
+ *--------------------------------------------------------------------*/
+pyPipeline::~pyPipeline (void)
+{
+    py::gil_scoped_release release;
+    delete rspSub;
+    delete pid;
+    delete engine;
+    delete rspPub;
+}
+
+/*--------------------------------------------------------------------
+ * next
+ *
+ *  returns the next record batch, which holds at least max_rows rows
+ *  unless the pipeline completes first; returns None when the pipeline
+ *  has completed and all of its rows have been returned, or when no
+ *  rows arrive within the timeout (milliseconds)
+ *--------------------------------------------------------------------*/
+py::object pyPipeline::next (long max_rows, int timeout)
+{
+    int num_columns = columns.size();
+    std::vector<std::vector<uint8_t>> buffers(num_columns);
+    long num_rows = 0;
+
+    {
+        py::gil_scoped_release release;
+
+        while(!terminated && num_rows < max_rows)
+        {
+            Subscriber::msgRef_t ref;
+            int status = rspSub->receiveRef(ref, timeout);
+            if(status <= 0)
+            {
+                if(status != MsgQ::STATE_TIMEOUT) mlog(CRITICAL, "Failed (%d) to receive record on %s", status, rspSub->getName());
+                break;
+            }
+
+            if(ref.size == 0)
+            {
+                terminated = true;
+            }
+            else
+            {
+                try
+                {
+                    RecordInterface record((unsigned char*)ref.data, ref.size);
+                    if(StringLib::match(record.getRecordType(), batchType.c_str()))
+                    {
+                        /* Rows in Record */
+                        const uint8_t* rows = record.getRecordData() + rowOffset;
+                        long record_rows = 1;
+                        if(rowArray) record_rows = (record.getAllocatedDataSize() - rowOffset) / rowSize;
+
+                        /* Gather Columns */
+                        for(int c = 0; c < num_columns; c++)
+                        {
+                            const pyRecordBatch::column_t& column = columns[c];
+                            std::vector<uint8_t>& buffer = buffers[c];
+                            size_t start = buffer.size();
+                            buffer.resize(start + (record_rows * column.size));
+                            uint8_t* dst = &buffer[start];
+                            const uint8_t* src = rows + column.offset;
+                            for(long r = 0; r < record_rows; r++)
+                            {
+                                memcpy(dst, src, column.size);
+                                dst += column.size;
+                                src += rowSize;
+                            }
+                        }
+                        num_rows += record_rows;
+                    }
+                }
+                catch(const RunTimeException& e)
+                {
+                    mlog(e.level(), "Failed to process record in pipeline: %s", e.what());
+                }
+            }
+
+            rspSub->dereference(ref);
+        }
+    }
+
+    if(num_rows == 0) return py::none();
+    return py::cast(new pyRecordBatch(columns, buffers, num_rows), py::return_value_policy::take_ownership);
+}
+
+/*--------------------------------------------------------------------
+ * complete
+ *--------------------------------------------------------------------*/
+bool pyPipeline::complete (void)
+{
+    return terminated;
+}
+
+/*--------------------------------------------------------------------
+ * addColumns
+ *
+ *  flattens nested records; offsets are bytes from the start of the row
+ *--------------------------------------------------------------------*/
+void pyPipeline::addColumns (const char* row_type, int offset)
+{
+    char** field_names = NULL;
+    RecordObject::field_t** fields = NULL;
+    int num_fields = RecordObject::getRecordFields(row_type, &field_names, &fields);
+    for(int i = 0; i < num_fields; i++)
+    {
+        RecordObject::field_t* field = fields[i];
+        const char* format = NULL;
+        switch(field->type)
+        {
+            case RecordObject::INT8:    format = "c";   break;
+            case RecordObject::INT16:   format = "s";   break;
+            case RecordObject::INT32:   format = "i";   break;
+            case RecordObject::INT64:   format = "l";   break;
+            case RecordObject::UINT8:   format = "C";   break;
+            case RecordObject::UINT16:  format = "S";   break;
+            case RecordObject::UINT32:  format = "I";   break;
+            case RecordObject::UINT64:  format = "L";   break;
+            case RecordObject::FLOAT:   format = "f";   break;
+            case RecordObject::DOUBLE:  format = "g";   break;
+            case RecordObject::TIME8:   format = "tdm"; break; // matches ParquetBuilder
+            case RecordObject::USER:    addColumns(field->exttype, offset + TOBYTES(field->offset)); break;
+            default:                    break;
+        }
+
+        if(format && ((field->flags & (RecordObject::POINTER | RecordObject::BIGENDIAN)) == NATIVE_FLAGS))
+        {
+            pyRecordBatch::column_t column;
+            column.name     = field_names[i];
+            column.type     = field->type;
+            column.offset   = offset + TOBYTES(field->offset);
+            column.size     = RecordObject::FIELD_TYPE_BYTES[field->type];
+            column.format   = format;
+            columns.push_back(column);
+        }
+
+        delete [] field_names[i];
+        delete fields[i];
+    }
+    if(fields) delete [] fields;
+    if(field_names) delete [] field_names;
+}
+
+/*--------------------------------------------------------------------
+ * engineThread
+ *--------------------------------------------------------------------*/
+void* pyPipeline::engineThread (void* parm)
+{
+    pyPipeline* pipeline = (pyPipeline*)parm;
+
+    /* Execute Endpoint Script */
+    pipeline->engine->executeEngine(IO_PEND);
+
+    /* Signal Completion */
+    pipeline->rspPub->postCopy("", 0);
+
+    return NULL;
+}
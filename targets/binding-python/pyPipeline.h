@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2021, University of Washington
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the University of Washington nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF WASHINGTON AND CONTRIBUTORS
+ * “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE UNIVERSITY OF WASHINGTON OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __py_pipeline__
+#define __py_pipeline__
+
+/*
+ * pyPipeline runs a server endpoint script (e.g. atl06.lua) inside the Python
+ * process and hands the records it produces back to Python as Arrow record
+ * batches through the Arrow C data interface.  The script is executed by a
+ * local LuaEngine exactly as the server would execute it, but its response
+ * queue is subscribed to directly, so no HTTP request is made and no record
+ * is serialized to or parsed from a byte stream.
+ *
+ * Each record batch is built from records of the supplied batch record type.
+ * When that type holds a variable length array of another record type (e.g.
+ * atl06rec holds atl06rec.elevation), the rows of the batch are the elements
+ * of that array; otherwise each record is a single row.  Only fixed width
+ * native fields become columns, matching the columns ParquetBuilder writes.
+ *
+ * Batches are returned as objects implementing the Arrow PyCapsule interface
+ * (__arrow_c_schema__ and __arrow_c_array__) so that pyarrow.record_batch()
+ * and other Arrow consumers can import them without copying.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <pybind11/pybind11.h>
+#include <vector>
+#include <string>
+
+#include "LuaEngine.h"
+#include "MsgQ.h"
+#include "RecordObject.h"
+#include "OsApi.h"
+
+/******************************************************************************
+ * NAMESPACES
+ ******************************************************************************/
+
+namespace py = pybind11;
+
+/******************************************************************************
+ * ARROW C DATA INTERFACE
+ ******************************************************************************/
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif  /* ARROW_C_DATA_INTERFACE */
+
+/******************************************************************************
+ * pyRecordBatch Class
+ ******************************************************************************/
+
+class pyRecordBatch
+{
+    public:
+
+        typedef struct {
+            std::string                 name;
+            RecordObject::fieldType_t   type;
+            int                         offset;     // bytes into row
+            int                         size;       // bytes
+            const char*                 format;     // arrow format string
+        } column_t;
+
+                            pyRecordBatch       (const std::vector<column_t>& _columns, std::vector<std::vector<uint8_t>>& _buffers, long _num_rows);
+                            ~pyRecordBatch      (void);
+        long                numRows             (void);
+        py::list            columnNames         (void);
+        py::object          exportSchema        (void);
+        py::tuple           exportArray         (const py::object& requested_schema);
+
+    private:
+
+        static void         releaseSchema       (struct ArrowSchema* schema);
+        static void         releaseArray        (struct ArrowArray* array);
+        static void         releaseColumnArray  (struct ArrowArray* array);
+        static void         freeSchemaCapsule   (PyObject* capsule);
+        static void         freeArrayCapsule    (PyObject* capsule);
+
+        std::vector<column_t>               columns;
+        std::vector<std::vector<uint8_t>>   buffers;
+        long                                numRowsInBatch;
+        bool                                exported;
+};
+
+/******************************************************************************
+ * pyPipeline Class
+ ******************************************************************************/
+
+class pyPipeline
+{
+    public:
+
+        static const long   DEFAULT_BATCH_ROWS = 65536;
+
+                            pyPipeline          (const std::string &scriptpath, const std::string &rqst, const std::string &rec_type);
+                            ~pyPipeline         (void);
+        py::object          next                (long max_rows, int timeout);
+        bool                complete            (void);
+
+    private:
+
+        void                addColumns          (const char* row_type, int offset);
+        static void*        engineThread        (void* parm);
+
+        static std::atomic<long> pipelineId;
+
+        std::vector<pyRecordBatch::column_t> columns;
+        std::string         batchType;
+        int                 rowSize;            // bytes per row
+        int                 rowOffset;          // bytes from start of record to first row
+        bool                rowArray;
+        bool                terminated;
+        LuaEngine*          engine;
+        Publisher*          rspPub;
+        Subscriber*         rspSub;
+        Thread*             pid;
+};
+
+#endif /* __py_pipeline__ */
@@ -55,6 +55,14 @@ pyS3Cache::pyS3Cache (const std::string &_cache_root, const int _max_files)
     S3CacheIODriver::createCache(_cache_root.c_str(), _max_files);
 }
 
+/*--------------------------------------------------------------------
+ * Constructor
+ *--------------------------------------------------------------------*/
+pyS3Cache::pyS3Cache (const std::string &_cache_root, const int _max_files, const long _max_bytes)
+{
+    S3CacheIODriver::createCache(_cache_root.c_str(), _max_files, _max_bytes);
+}
+
 /*--------------------------------------------------------------------
  * Destructor
  *--------------------------------------------------------------------*/
@@ -53,6 +53,7 @@ class pyS3Cache
 {
     public:
         pyS3Cache   (const std::string &_cache_root, const int _max_files);
+        pyS3Cache   (const std::string &_cache_root, const int _max_files, const long _max_bytes);
         ~pyS3Cache  (void);
 };
 
@@ -63,20 +63,139 @@ package.path = package.path .. ';/usr/local/etc/haproxy/?.lua'
 local json = require("json")
 local prettyprint = require("prettyprint")
 
+--
+-- Constants
+--
+MaxLocksPerNode = 3
+ScrubInterval = 1 -- second(s)
+MaxTimeout = 600 -- second(s)
+RingReplicas = 16 -- points on the hash ring per member
+QueueBytesFull = 1024 * 1024 * 1024 -- queued bytes at which a member counts as fully loaded
+CacheBonus = 0.5 -- load forgiven for a member whose reads all hit its caches
+MaxLoadPenalty = 2 -- load penalty of a fully loaded member, in locks
+
+--
+-- Lock Queues
+--
+--  Members of each service bucketed by their number of locks, so the least
+--  locked member is found without sorting the registry
+--
+--  {
+--      "<service>":
+--      {
+--          "buckets": {[<locks>]: ["<address>", ..], ..},
+--          "position": {"<address>": <index in its bucket>, ..},
+--          "ring": [{"hash": <hash>, "address": "<address>"}, ..] or nil when stale
+--      }
+--  }
+--
+LockQueues = {}
+
 --
 -- Local Functions
 --
-local function sort_by_locks(registry)
-    local addresses = {}
-    local num_addresses = 0
-    for address,_ in pairs(registry) do
-        table.insert(addresses, address)
-        num_addresses = num_addresses + 1
+local function get_queue(service)
+    local queue = LockQueues[service]
+    if queue == nil then
+        queue = {buckets = {}, position = {}, ring = nil}
+        LockQueues[service] = queue
+    end
+    return queue
+end
+
+local function queue_add(queue, address, locks)
+    local bucket = queue.buckets[locks]
+    if bucket == nil then
+        bucket = {}
+        queue.buckets[locks] = bucket
+    end
+    table.insert(bucket, address)
+    queue.position[address] = #bucket
+end
+
+local function queue_remove(queue, address, locks)
+    local bucket = queue.buckets[locks]
+    local index = queue.position[address]
+    if bucket == nil or index == nil then return end
+    -- swap with last entry of bucket so removal is constant time
+    local last = bucket[#bucket]
+    bucket[index] = last
+    queue.position[last] = index
+    bucket[#bucket] = nil
+    queue.position[address] = nil
+end
+
+local function set_locks(member, locks)
+    local queue = get_queue(member["service"])
+    queue_remove(queue, member["address"], member["locks"])
+    member["locks"] = locks
+    queue_add(queue, member["address"], locks)
+end
+
+local function load_penalty(member)
+    -- extra locks a member is treated as holding for its reported load,
+    -- from -CacheBonus (idle with hot caches) to MaxLoadPenalty (saturated)
+    local load = member["load"]
+    if load == nil then return 0 end
+    local cpu = math.min(math.max(load["cpu"] or 0, 0), 1)
+    local queued = math.min((load["queue_bytes"] or 0) / QueueBytesFull, 1)
+    local cache_hit = math.max(load["cache_hit"] or -1, 0)
+    return ((cpu + queued) * MaxLoadPenalty / 2) - (CacheBonus * cache_hit)
+end
+
+local function least_loaded(queue, service_registry, max_locks)
+    -- returns member with the fewest locks once weighted by load; only the
+    -- buckets within MaxLoadPenalty of the least locked bucket can hold it
+    local best_address = nil
+    local best_score = nil
+    local first = nil
+    for locks = 0, max_locks - 1 do
+        local bucket = queue.buckets[locks]
+        if bucket ~= nil and #bucket > 0 then
+            first = first or locks
+            if locks > first + MaxLoadPenalty + CacheBonus then break end
+            for _,address in ipairs(bucket) do
+                local score = locks + load_penalty(service_registry[address])
+                if best_score == nil or score < best_score then
+                    best_address = address
+                    best_score = score
+                end
+            end
+        end
+    end
+    return best_address
+end
+
+local function hash_string(str)
+    -- 32-bit FNV-1a
+    local hash = 2166136261
+    for i = 1, #str do
+        hash = ((hash ~ str:byte(i)) * 16777619) & 0xFFFFFFFF
+    end
+    return hash
+end
+
+local function build_ring(queue)
+    local ring = {}
+    for address,_ in pairs(queue.position) do
+        for replica = 1, RingReplicas do
+            table.insert(ring, {hash = hash_string(address .. "#" .. replica), address = address})
+        end
+    end
+    table.sort(ring, function(point1, point2) return point1.hash < point2.hash end)
+    queue.ring = ring
+    return ring
+end
+
+local function ring_start(ring, hash)
+    -- binary search for first point at or after hash, wrapping to the first point
+    local lo, hi = 1, #ring
+    while lo <= hi do
+        local mid = (lo + hi) // 2
+        if ring[mid].hash < hash then lo = mid + 1 else hi = mid - 1 end
     end
-    table.sort(addresses, function(address1, address2)
-        return registry[address1]["locks"] < registry[address2]["locks"]
-    end)
-    return addresses, num_addresses
+    if lo > #ring then lo = 1 end
+    return lo
 end
 
 --
@@ -91,6 +210,7 @@ end
 --              "expiration":   <expiration time in seconds>,
 --              "address":      "<address 1>",
 --              "locks":        <number of active locks>,
+--              "load":         {"cpu": <load per core>, "queue_bytes": <bytes>, "cache_hit": <fraction or -1>} or nil
 --          }
 --          ..
 --          "<address n>":
@@ -145,13 +265,6 @@ StatData = {
     memberCounts = {}
 }
 
---
--- Constants
---
-MaxLocksPerNode = 3
-ScrubInterval = 1 -- second(s)
-MaxTimeout = 600 -- second(s)
-
 --
 -- API: /discovery/register
 --
@@ -162,6 +275,7 @@ MaxTimeout = 600 -- second(s)
 --      "service": "<service to join>",
 --      "lifetime": <duration that registry lasts in seconds>
 --      "address": "<public hostname or ip address of member>",
+--      "load": {"cpu": <load per core>, "queue_bytes": <bytes>, "cache_hit": <fraction or -1>} (optional)
 --  }
 --
 --  OUTPUT:
@@ -183,15 +297,21 @@ local function api_register(applet)
         service = service,
         expiration = os.time() + lifetime,
         address = address,
-        locks = 0
+        locks = 0,
+        load = request["load"]
     }
 
     -- update service catalog
     local service_registry = ServiceCatalog[service]
+    local queue = get_queue(service)
     if service_registry == nil then                             -- if first time service is registered
         ServiceCatalog[service] = {}                            -- register service by adding it to catalog
-    elseif service_registry[address] ~= nil then                -- if service already registered
-        member["locks"] = service_registry[address]["locks"]    -- preserve number of locks for member
+    end
+    if ServiceCatalog[service][address] ~= nil then             -- if service already registered
+        member["locks"] = ServiceCatalog[service][address]["locks"] -- preserve number of locks for member
+    else
+        queue_add(queue, address, 0)                            -- new member has no locks
+        queue.ring = nil                                        -- membership changed
     end
     ServiceCatalog[service][address] = member
 
@@ -210,11 +330,18 @@ end
 --
 --  Returns up to requested number of nodes for processing a request
 --
+--  Nodes are handed out least locked first, with the load each node last
+--  reported counting as up to MaxLoadPenalty extra locks.  When a resource
+--  is supplied, nodes are instead taken from the hash ring starting at the
+--  resource, so the same resource lands on the same node (skipping nodes at
+--  capacity or fully loaded).
+--
 --  INPUT:
 --  {
 --      "service": "<service>",
 --      "nodesNeeded": <number>,
---      "timeout": <seconds>
+--      "timeout": <seconds>,
+--      "resource": "<name of resource>" (optional)
 --  }
 --
 --  OUTPUT:
@@ -231,53 +358,62 @@ local function api_lock(applet)
     local service = request["service"]
     local nodesNeeded = request["nodesNeeded"]
     local timeout = request["timeout"] < MaxTimeout and request["timeout"] or MaxTimeout
+    local resource = request["resource"]
     local expiration = os.time() + timeout
 
     -- initialize error count
     local error_count = 0
 
-    -- loop through service registry and return addresses with least locks
+    -- lock member and register transaction
     local member_list = {} -- list of member addresses returned
     local transaction_list = {} -- list of transaction ids returned
     local service_registry = ServiceCatalog[service]
-    if service_registry ~= nil then
-        local sorted_addresses, num_adresses = sort_by_locks(service_registry)
-        if num_adresses > 0 then
-            local i = 1
-            while nodesNeeded > 0 do
-                -- check if end of list
-                if i > num_adresses then i = 1 end
-                -- pull out member
-                local address = sorted_addresses[i]
-                local member = service_registry[address]
-                -- check if number of locks exceeds max
-                if member["locks"] >= MaxLocksPerNode then
-                    if i == 1 then break -- full capacity
-                    else i = 0 end -- go back to beginning of sorted list (goes to 1 below)
-                else
-                    -- create transaction
-                    local transaction = {
-                        service_registry,
-                        address,
-                        expiration
-                    }
-                    -- lock member
-                    nodesNeeded = nodesNeeded - 1 -- need one less node now
-                    member["locks"] = member["locks"] + 1 -- member has one more lock
-                    table.insert(member_list, string.format('"%s"', member["address"])) -- populate member list that gets returned
-                    table.insert(transaction_list, TransactionId) -- populate list of transaction ids that get returned
-                    TransactionTable[TransactionId] = transaction -- register transaction
-                    TransactionId = TransactionId + 1
+    local function lock_member(address)
+        local member = service_registry[address]
+        local transaction = {
+            service_registry,
+            address,
+            expiration
+        }
+        nodesNeeded = nodesNeeded - 1 -- need one less node now
+        set_locks(member, member["locks"] + 1) -- member has one more lock
+        table.insert(member_list, string.format('"%s"', member["address"])) -- populate member list that gets returned
+        table.insert(transaction_list, TransactionId) -- populate list of transaction ids that get returned
+        TransactionTable[TransactionId] = transaction -- register transaction
+        TransactionId = TransactionId + 1
+    end
+
+    -- hand out members with least locks (or nearest on hash ring to resource)
+    if service_registry == nil then
+        core.log(core.err, string.format("Service %s not found", service))
+        error_count = error_count + 1
+    elseif next(service_registry) ~= nil then
+        local queue = get_queue(service)
+        if resource ~= nil then
+            local ring = queue.ring or build_ring(queue)
+            local start = ring_start(ring, hash_string(resource))
+            local visited = {}
+            local i = start
+            repeat
+                local address = ring[i].address
+                if nodesNeeded <= 0 then break end
+                if not visited[address] then
+                    visited[address] = true
+                    local member = service_registry[address]
+                    if member["locks"] < MaxLocksPerNode and load_penalty(member) < MaxLoadPenalty then
+                        lock_member(address)
+                    end
                 end
-                -- goto next entry in address list
-                i = i + 1
-            end
-        else
-            core.log(core.err, string.format("No addresses found in registry %s", service))
-            error_count = error_count + 1
+                i = (i % #ring) + 1
+            until i == start
+        end
+        while nodesNeeded > 0 do
+            local address = least_loaded(queue, service_registry, MaxLocksPerNode)
+            if address == nil then break end -- full capacity
+            lock_member(address)
         end
     else
-        core.log(core.err, string.format("Service %s not found", service))
+        core.log(core.err, string.format("No addresses found in registry %s", service))
         error_count = error_count + 1
     end
 
@@ -333,7 +469,7 @@ local function api_unlock(applet)
             if member ~= nil then
                 -- unlock member
                 if member["locks"] > 0 then
-                    member["locks"] = member["locks"] - 1
+                    set_locks(member, member["locks"] - 1)
                 else
                     core.log(core.err, string.format("Transaction %d unlocked on address %s with no locks", id, address))
                     error_count = error_count + 1
@@ -489,7 +625,10 @@ local function backgroud_scrubber()
                 end
             end
             -- delete (expire) members
+            local queue = get_queue(service)
             for _,address in pairs(members_to_delete) do
+                queue_remove(queue, address, service_registry[address]["locks"])
+                queue.ring = nil
                 service_registry[address] = nil
             end
             -- set member count
@@ -511,7 +650,7 @@ local function backgroud_scrubber()
                 -- decrement associated lock
                 if member ~= nil then
                     if member["locks"] > 0 then
-                        member["locks"] = member["locks"] - 1
+                        set_locks(member, member["locks"] - 1)
                     else
                         core.log(core.err, string.format("Transaction %d timed-out on %s with no locks", id, address))
                     end
@@ -538,21 +677,17 @@ end
 local function orchestrator_next_node(txn, service)
     local service_registry = ServiceCatalog[service]
     if service_registry ~= nil then
-        -- sort members by number of locks
-        local sorted_addresses, num_addresses = sort_by_locks(service_registry)
-        if num_addresses > 0 then
-            -- get set of nodes with same minimal number of locks
-            local min_num_locks = service_registry[sorted_addresses[1]]["locks"]
-            local num_members_with_min_locks = 1
-            local i = 2
-            while i <= num_addresses do
-                if service_registry[sorted_addresses[i]]["locks"] <= min_num_locks then
-                    num_members_with_min_locks = num_members_with_min_locks + 1
-                end
-                i = i + 1
+        -- get node with fewest locks weighted by load (no limit on locks)
+        local queue = get_queue(service)
+        local max_locks = 0
+        for locks,members in pairs(queue.buckets) do
+            if #members > 0 and locks >= max_locks then
+                max_locks = locks + 1
             end
-            -- choose address randomly from set of minimally locked members
-            return sorted_addresses[math.random(1, num_members_with_min_locks)]
+        end
+        local address = least_loaded(queue, service_registry, max_locks)
+        if address ~= nil then
+            return address
         else
             core.log(core.err, string.format("No nodes available on service %s", service))
         end